@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <schifra/core/galois_field/field.hpp>
+#include <schifra/core/galois_field/field_registry.hpp>
+#include <schifra/reed_solomon/schifra_reed_solomon_rs_codec.hpp>
+
+namespace dna {
+    // Immutable state of an (n, k) DNA Reed-Solomon code: the GF(2^8) field
+    // and the codec with its generator and decoder tables. The codec is only
+    // ever read, so any number of encoders and decoders on any threads can
+    // share one context.
+    class DNACodecContext {
+    public:
+        // Process-wide context for (n, k), built on first use and shared by
+        // every later caller while any of them still holds it
+        static std::shared_ptr<const DNACodecContext> shared(std::size_t n, std::size_t k);
+        
+        DNACodecContext(std::size_t n, std::size_t k);
+        
+        DNACodecContext(const DNACodecContext&) = delete;
+        DNACodecContext& operator=(const DNACodecContext&) = delete;
+        
+        const schifra::galois::field& field() const { return *field_; }
+        const schifra::reed_solomon::rs_codec& codec() const { return *codec_; }
+        
+        std::size_t n() const { return n_; }
+        std::size_t k() const { return k_; }
+        std::size_t t() const { return (n_ - k_) / 2; }
+        
+    private:
+        std::size_t n_;  // Total length (data + ECC)
+        std::size_t k_;  // Data length
+        
+        // Shared with every other user of the same field
+        schifra::galois::field_registry::field_ptr field_;
+        std::unique_ptr<const schifra::reed_solomon::rs_codec> codec_;
+    };
+}
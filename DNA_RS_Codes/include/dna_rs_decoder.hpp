@@ -1,19 +1,25 @@
 #pragma once
 
-#include <schifra_galois_field.hpp>
-#include <schifra_galois_field_polynomial.hpp>
-#include <schifra_sequential_root_generator_polynomial_creator.hpp>
-#include <schifra_reed_solomon_decoder.hpp>
-#include <schifra_reed_solomon_block.hpp>
-#include <schifra_reed_solomon_util.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
 
+#include "dna_codec_context.hpp"
 #include "dna_utils.hpp"
 
 namespace dna {
     class DNAReedSolomonDecoder {
     public:
+        // Use the process-wide shared context of the (n, k) code
         DNAReedSolomonDecoder(std::size_t n, std::size_t k);
         
+        // Use the given context, shared with any other encoder or decoder
+        explicit DNAReedSolomonDecoder(std::shared_ptr<const DNACodecContext> context);
+        
+        const std::shared_ptr<const DNACodecContext>& context() const { return context_; }
+        
+        // Decode the k * 4 data bases of a codeword with its n - k ECC symbols
         std::string decode(const std::string& corrupted_dna, const std::vector<uint8_t>& ecc_symbols);
         
     private:
@@ -21,7 +27,7 @@ namespace dna {
         std::size_t k_;  // Data length
         std::size_t t_;  // Number of errors that can be corrected
         
-        schifra::galois::field field_;
-        std::unique_ptr<schifra::reed_solomon::decoder<255, 223>> decoder_;
+        // Field and codec, immutable and shared across instances
+        std::shared_ptr<const DNACodecContext> context_;
     };
 }
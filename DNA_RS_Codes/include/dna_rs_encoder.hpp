@@ -5,20 +5,22 @@
 #include <memory>
 #include <stdexcept>
 
-#include <schifra_galois_field.hpp>
-#include <schifra_galois_field_polynomial.hpp>
-#include <schifra_sequential_root_generator_polynomial_creator.hpp>
-#include <schifra_reed_solomon_encoder.hpp>
-#include <schifra_reed_solomon_block.hpp>
-#include <schifra_reed_solomon_util.hpp>
-
+#include "dna_codec_context.hpp"
 #include "dna_utils.hpp"
 
 namespace dna {
     class DNAReedSolomonEncoder {
     public:
+        // Use the process-wide shared context of the (n, k) code
         DNAReedSolomonEncoder(std::size_t n, std::size_t k);
         
+        // Use the given context, shared with any other encoder or decoder
+        explicit DNAReedSolomonEncoder(std::shared_ptr<const DNACodecContext> context);
+        
+        const std::shared_ptr<const DNACodecContext>& context() const { return context_; }
+        
+        // Encode up to k * 4 bases, packed 4 per symbol; the returned DNA is
+        // the k data symbols as k * 4 bases, padded with A
         std::pair<std::string, std::vector<uint8_t>> encode(const std::string& dna);
         
     private:
@@ -26,8 +28,7 @@ namespace dna {
         std::size_t k_;  // Data length
         std::size_t t_;  // Number of errors that can be corrected
         
-        schifra::galois::field field_;
-        schifra::galois::field_polynomial generator_polynomial_;
-        std::unique_ptr<schifra::reed_solomon::encoder<255, 223>> encoder_;
+        // Field and codec, immutable and shared across instances
+        std::shared_ptr<const DNACodecContext> context_;
     };
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -12,12 +13,19 @@ namespace dna {
     // Number to DNA base mapping
     constexpr char NUM_TO_BASE[4] = {'A', 'C', 'G', 'T'};
     
-    // Convert DNA sequence to binary representation
+    // Bases packed into one GF(256) symbol, 2 bits each
+    constexpr std::size_t BASES_PER_SYMBOL = 4;
+    
+    // Convert DNA sequence to binary representation, 4 bases per byte with
+    // the first base in the top two bits; a final partial byte is padded with A
     std::vector<uint8_t> dna_to_binary(const std::string& dna);
     
-    // Convert binary representation back to DNA sequence
+    // Convert binary representation back to DNA sequence, 4 bases per byte
     std::string binary_to_dna(const std::vector<uint8_t>& binary);
     
+    // Same, keeping only the first base_count bases
+    std::string binary_to_dna(const std::vector<uint8_t>& binary, std::size_t base_count);
+    
     // Validate DNA sequence
     bool is_valid_dna(const std::string& dna);
     
@@ -0,0 +1,36 @@
+#include "dna_codec_context.hpp"
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace dna {
+    DNACodecContext::DNACodecContext(std::size_t n, std::size_t k)
+        : n_(n), k_(k),
+          field_(schifra::galois::shared_field(8, schifra::galois::primitive_polynomial_size06,
+                                               schifra::galois::primitive_polynomial06)) {
+        
+        // An (n, k) code with n - k roots starting at alpha^120
+        codec_ = std::make_unique<const schifra::reed_solomon::rs_codec>(*field_, n_, k_, 120);
+        
+        if (!codec_->valid()) {
+            throw std::invalid_argument("Invalid Reed-Solomon code parameters");
+        }
+    }
+    
+    std::shared_ptr<const DNACodecContext> DNACodecContext::shared(std::size_t n, std::size_t k) {
+        static std::mutex mutex;
+        static std::map<std::pair<std::size_t, std::size_t>, std::weak_ptr<const DNACodecContext>> contexts;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        std::weak_ptr<const DNACodecContext>& slot = contexts[std::make_pair(n, k)];
+        std::shared_ptr<const DNACodecContext> context = slot.lock();
+        if (!context) {
+            context = std::make_shared<const DNACodecContext>(n, k);
+            slot = context;
+        }
+        return context;
+    }
+}
@@ -1,14 +1,19 @@
 #include "dna_rs_decoder.hpp"
-#include <cstring>
+
+#include <utility>
 
 namespace dna {
     DNAReedSolomonDecoder::DNAReedSolomonDecoder(std::size_t n, std::size_t k)
-        : n_(n), k_(k), t_((n - k) / 2),
-          field_(8, schifra::galois::primitive_polynomial_size06,
-                schifra::galois::primitive_polynomial06) {
+        : DNAReedSolomonDecoder(DNACodecContext::shared(n, k)) {
+    }
+    
+    DNAReedSolomonDecoder::DNAReedSolomonDecoder(std::shared_ptr<const DNACodecContext> context)
+        : n_(context ? context->n() : 0), k_(context ? context->k() : 0), t_(context ? context->t() : 0),
+          context_(std::move(context)) {
         
-        // Create decoder
-        decoder_ = std::make_unique<schifra::reed_solomon::decoder<255, 223>>(field_, 120);
+        if (!context_) {
+            throw std::invalid_argument("Missing codec context");
+        }
     }
     
     std::string DNAReedSolomonDecoder::decode(const std::string& corrupted_dna, const std::vector<uint8_t>& ecc_symbols) {
@@ -16,23 +21,22 @@ namespace dna {
             throw std::invalid_argument("Invalid DNA sequence");
         }
         
-        // Convert corrupted DNA to binary
-        std::vector<uint8_t> binary_data = dna_to_binary(corrupted_dna);
-        
-        // Create RS block
-        schifra::reed_solomon::block<255, 223> block;
+        if ((corrupted_dna.size() != k_ * BASES_PER_SYMBOL) || (ecc_symbols.size() != n_ - k_)) {
+            throw std::invalid_argument("Codeword length does not match the code");
+        }
         
-        // Copy corrupted data and ECC symbols to block
-        memcpy(&block[0], binary_data.data(), k_);
-        memcpy(&block[k_], ecc_symbols.data(), n_ - k_);
+        // Convert corrupted DNA to binary, 4 bases per symbol, and append the ECC symbols
+        std::vector<uint8_t> codeword = dna_to_binary(corrupted_dna);
+        codeword.reserve(n_);
+        codeword.insert(codeword.end(), ecc_symbols.begin(), ecc_symbols.end());
         
         // Decode
-        if (!decoder_->decode(block)) {
+        if (!context_->codec().decode(schifra::utils::span<uint8_t>(codeword.data(), codeword.size()))) {
             throw std::runtime_error("Decoding failed");
         }
         
         // Extract corrected data
-        std::vector<uint8_t> corrected_data(&block[0], &block[k_]);
+        std::vector<uint8_t> corrected_data(codeword.begin(), codeword.begin() + k_);
         
         // Convert back to DNA
         return binary_to_dna(corrected_data);
@@ -27,23 +27,83 @@ namespace dna {
         return NUM_TO_BASE[num];
     }
 
+    namespace {
+        // Base code of every byte, 0xFF for anything but A, C, G, T
+        struct base_code_table {
+            uint8_t code[256];
+            
+            base_code_table() {
+                for (int i = 0; i < 256; ++i) code[i] = 0xFF;
+                for (uint8_t num = 0; num < 4; ++num) {
+                    code[static_cast<unsigned char>(NUM_TO_BASE[num])] = num;
+                }
+            }
+        };
+        
+        // The 4 bases every byte unpacks to
+        struct symbol_bases_table {
+            char bases[256][BASES_PER_SYMBOL];
+            
+            symbol_bases_table() {
+                for (int symbol = 0; symbol < 256; ++symbol) {
+                    for (std::size_t i = 0; i < BASES_PER_SYMBOL; ++i) {
+                        bases[symbol][i] = NUM_TO_BASE[(symbol >> (6 - 2 * i)) & 3];
+                    }
+                }
+            }
+        };
+        
+        const base_code_table& base_codes() {
+            static const base_code_table table;
+            return table;
+        }
+        
+        const symbol_bases_table& symbol_bases() {
+            static const symbol_bases_table table;
+            return table;
+        }
+    }
+
     std::vector<uint8_t> dna_to_binary(const std::string& dna) {
-        if (!is_valid_dna(dna)) {
-            throw std::invalid_argument("Invalid DNA sequence");
+        const uint8_t* code = base_codes().code;
+        std::vector<uint8_t> binary((dna.size() + BASES_PER_SYMBOL - 1) / BASES_PER_SYMBOL);
+        
+        uint8_t invalid = 0;
+        std::size_t i = 0;
+        for (std::size_t s = 0; s < binary.size(); ++s) {
+            uint8_t symbol = 0;
+            for (std::size_t j = 0; j < BASES_PER_SYMBOL; ++j, ++i) {
+                const uint8_t num = (i < dna.size()) ? code[static_cast<unsigned char>(dna[i])] : 0;
+                invalid |= num;
+                symbol = static_cast<uint8_t>((symbol << 2) | (num & 3));
+            }
+            binary[s] = symbol;
         }
         
-        std::vector<uint8_t> binary;
-        for (char base : dna) {
-            binary.push_back(base_to_num(base));
+        // Only an invalid base sets the bits above the 2 bit codes
+        if (invalid & ~3) {
+            throw std::invalid_argument("Invalid DNA sequence");
         }
         return binary;
     }
 
     std::string binary_to_dna(const std::vector<uint8_t>& binary) {
-        std::string dna;
-        for (uint8_t num : binary) {
-            if (num > 3) throw std::invalid_argument("Invalid binary value");
-            dna.push_back(num_to_base(num));
+        return binary_to_dna(binary, binary.size() * BASES_PER_SYMBOL);
+    }
+
+    std::string binary_to_dna(const std::vector<uint8_t>& binary, std::size_t base_count) {
+        if (base_count > binary.size() * BASES_PER_SYMBOL) {
+            throw std::invalid_argument("Invalid binary value");
+        }
+        
+        const symbol_bases_table& table = symbol_bases();
+        std::string dna(base_count, 'A');
+        const std::size_t whole = base_count / BASES_PER_SYMBOL;
+        for (std::size_t s = 0; s < whole; ++s) {
+            dna.replace(s * BASES_PER_SYMBOL, BASES_PER_SYMBOL, table.bases[binary[s]], BASES_PER_SYMBOL);
+        }
+        for (std::size_t i = whole * BASES_PER_SYMBOL; i < base_count; ++i) {
+            dna[i] = table.bases[binary[whole]][i % BASES_PER_SYMBOL];
         }
         return dna;
     }
@@ -3,10 +3,100 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "schifra/dna_storage.hpp"
 
 // Using RS(15,11) which can correct up to 2 symbol errors
 using dna_storage_type = schifra::dna_storage<15, 4, 11>;  // n=15, k=11, t=2
+using block_type = schifra::reed_solomon::block<15, 4>;
+
+// RS(15,11) geometry of the GPU encoder
+constexpr size_t kCodeLength = 15;
+constexpr size_t kFecLength = 4;
+constexpr size_t kDataLength = 11;
+
+// Products g_j * x of the generator coefficients g_0..g_3 (g(x) is monic,
+// x^4 + g_3 x^3 + ... + g_0) with every GF(2^4) symbol x, at [j * 16 + x].
+// Filled on the host from the same field and generator polynomial as
+// dna_storage::encode, so that the GPU parity is bit-exact with it.
+__constant__ unsigned char c_generator_mul[kFecLength * 16];
+
+// GF(2^4) arithmetic for the decoder, filled on the host from the same
+// field and decoder parameters as dna_storage::decode (uploadDecoderTables)
+struct GF16Tables {
+    unsigned char mul[16 * 16];        // a * b at [a * 16 + b]
+    unsigned char inv[16];             // 1 / a, inv[0] unused
+    unsigned char alpha[16];           // alpha^i, alpha[15] = alpha^15 = 1
+    unsigned char root_exponent[16];   // the decoder's Forney numerator scale per error location
+};
+
+__constant__ GF16Tables c_gf16;
+
+// Decoder outcome of a codeword, the same fields a schifra block has after
+// decoder<15,4>::decode, error holding a block_type::error_t value
+struct GPUBlockStatus {
+    unsigned int errors_detected;
+    unsigned int errors_corrected;
+    unsigned int zero_numerators;
+    bool unrecoverable;
+    int error;
+};
+
+// Outcome of a product code matrix (see decodeProducts): the symbols
+// corrected by its row and column passes, the rows given as erased, and
+// the rows and columns that were still not codewords after the last pass
+struct GPUProductStatus {
+    unsigned int row_corrections;
+    unsigned int column_corrections;
+    unsigned int erased_rows;
+    unsigned int failed_rows;
+    unsigned int failed_columns;
+};
+
+// Throw on a failed CUDA call
+inline void checkCuda(cudaError_t status, const char* what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(status));
+    }
+}
+
+// Base i of a sequence packed 4 bases per byte, base i in bits 2(i % 4) of
+// byte i / 4, A=0 C=1 G=2 T=3
+__host__ __device__ inline unsigned char unpackBase(const unsigned char* packed, size_t i) {
+    return (packed[i >> 2] >> ((i & 3) << 1)) & 3;
+}
+
+// Systematic RS(15,11) parity of 11 data symbols: the remainder of
+// data(x) * x^4 by g(x), data[0] being the highest degree coefficient,
+// computed by the usual LFSR. fec[0] is the x^3 coefficient, the order the
+// Schifra encoder appends them in.
+__host__ __device__ inline void rsParity(const unsigned char* data, unsigned char* fec,
+                                         const unsigned char* generator_mul) {
+    unsigned char reg[kFecLength] = {0, 0, 0, 0};
+
+    for (size_t i = 0; i < kDataLength; ++i) {
+        const unsigned char feedback = data[i] ^ reg[0];
+        for (size_t j = 0; j + 1 < kFecLength; ++j) {
+            reg[j] = reg[j + 1] ^ generator_mul[(kFecLength - 1 - j) * 16 + feedback];
+        }
+        reg[kFecLength - 1] = generator_mul[feedback];
+    }
+
+    for (size_t j = 0; j < kFecLength; ++j) {
+        fec[j] = reg[j];
+    }
+}
 
 // Structure to hold chunk information
 struct DNAChunk {
@@ -15,62 +105,521 @@ struct DNAChunk {
     size_t index;  // Used for maintaining order
 };
 
-// Structure for GPU memory management
-struct GPUChunkBuffer {
-    char* data;
-    size_t* indices;  // Array to store chunk indices
-    size_t num_chunks;
-};
+// Device function to encode a single chunk: the 11 data bases starting at
+// base first of the packed input, written as the 15 base strand that
+// dna_storage::encode returns (data, then each ECC symbol mod 4 as a base)
+// and the 4 ECC symbols
+__device__ void encodeChunk(const unsigned char* packed_input, size_t first, char* output, unsigned char* ecc,
+                            const unsigned char* generator_mul) {
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    unsigned char data[kDataLength];
+    unsigned char fec[kFecLength];
 
-// Device function to encode a single chunk
-__device__ void encodeChunk(char* input, char* output, size_t k) {
-    // Simple encoding: copy input and add parity symbols
-    for (int i = 0; i < k; ++i) {
-        output[i] = input[i];
+    for (size_t i = 0; i < kDataLength; ++i) {
+        data[i] = unpackBase(packed_input, first + i);
+        output[i] = bases[data[i]];
     }
-    
-    // Add parity symbols (simplified for demonstration)
-    for (int i = k; i < 15; ++i) {
-        output[i] = 'N';  // Placeholder for parity symbols
+
+    rsParity(data, fec, generator_mul);
+
+    for (size_t i = 0; i < kFecLength; ++i) {
+        ecc[i] = fec[i];
+        output[kDataLength + i] = bases[fec[i] & 3];
     }
 }
 
-// Device function to decode a single chunk
-__device__ void decodeChunk(char* input, char* output, size_t k) {
-    // Simple decoding: copy data symbols and ignore parity
-    for (int i = 0; i < k; ++i) {
-        output[i] = input[i];
+// Symbol of a validated base, upper or lower case: A=0 C=1 G=2 T=3
+__host__ __device__ inline unsigned char baseSymbol(char base) {
+    const unsigned char c = static_cast<unsigned char>(base);
+    return static_cast<unsigned char>(((c >> 1) ^ (c >> 2)) & 3);
+}
+
+// Received codeword of a strand: the 11 data bases as symbols followed by
+// its 4 ECC symbols, as dna_storage::decode loads the block
+__host__ __device__ inline void loadCodeword(const char* strand, const unsigned char* ecc, unsigned char* codeword) {
+    for (size_t i = 0; i < kDataLength; ++i) {
+        codeword[i] = baseSymbol(strand[i]);
+    }
+    for (size_t i = 0; i < kFecLength; ++i) {
+        codeword[kDataLength + i] = ecc[i];
     }
 }
 
-// CUDA kernel for parallel encoding
-__global__ void encodeChunksKernel(char* input_chunks, char* output_chunks, 
-                                 size_t* chunk_indices, size_t chunk_size, 
-                                 size_t num_chunks) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    if (idx >= num_chunks) return;
+// Syndromes S_k = r(alpha^(k+1)) of a codeword, codeword[0] being the
+// highest degree coefficient of r(x). Returns whether any is non-zero.
+__host__ __device__ inline bool rsSyndromes(const unsigned char* codeword, unsigned char* syndrome,
+                                            const GF16Tables& gf) {
+    unsigned char flag = 0;
+    for (size_t k = 0; k < kFecLength; ++k) {
+        const unsigned char* mul_root = gf.mul + gf.alpha[k + 1] * 16;
+        unsigned char acc = 0;
+        for (size_t i = 0; i < kCodeLength; ++i) {
+            acc = mul_root[acc] ^ codeword[i];
+        }
+        syndrome[k] = acc;
+        flag |= acc;
+    }
+    return flag != 0;
+}
 
-    // Each thread processes one chunk
-    char* input_chunk = input_chunks + (idx * chunk_size);
-    char* output_chunk = output_chunks + (idx * 15); // n=15 encoded size
+// Value of the polynomial poly of degree deg at x
+__host__ __device__ inline unsigned char polyEval(const unsigned char* poly, int deg, unsigned char x,
+                                                  const GF16Tables& gf) {
+    unsigned char acc = 0;
+    for (int i = deg; i >= 0; --i) {
+        acc = gf.mul[acc * 16 + x] ^ poly[i];
+    }
+    return acc;
+}
 
-    // Encode the chunk
-    encodeChunk(input_chunk, output_chunk, chunk_size);
+// Degree of the polynomial poly of at most size coefficients, -1 if zero
+__host__ __device__ inline int polyDegree(const unsigned char* poly, int size) {
+    int deg = size - 1;
+    while (deg >= 0 && poly[deg] == 0) --deg;
+    return deg;
 }
 
-// CUDA kernel for parallel decoding
-__global__ void decodeChunksKernel(char* input_chunks, char* output_chunks,
-                                 size_t* chunk_indices, size_t chunk_size, 
-                                 size_t num_chunks) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x;
+// Correct a codeword with non-zero syndromes, step for step as
+// decoder<15,4>::decode does without erasures (Berlekamp-Massey, Chien
+// search, Forney), so that the corrected symbols and the status, including
+// the partial corrections left by its failure paths, are identical
+__host__ __device__ inline void rsCorrect(unsigned char* codeword, const unsigned char* syndrome,
+                                          const GF16Tables& gf, GPUBlockStatus& status) {
+    constexpr int kPolySize = 2 * kFecLength + 2;
+
+    status.errors_detected = 0;
+    status.errors_corrected = 0;
+    status.zero_numerators = 0;
+    status.unrecoverable = false;
+    status.error = block_type::e_no_error;
+
+    // Berlekamp-Massey, lambda starting at 1 and the previous lambda at x
+    unsigned char lambda[kPolySize] = {1};
+    unsigned char previous[kPolySize] = {0, 1};
+    int lambda_deg = 0;
+    int i_mark = -1;
+    int l = 0;
+
+    for (int round = 0; round < static_cast<int>(kFecLength); ++round) {
+        const int upper_bound = (l < lambda_deg) ? l : lambda_deg;
+        unsigned char discrepancy = 0;
+        for (int i = 0; i <= upper_bound && i <= round; ++i) {
+            discrepancy ^= gf.mul[lambda[i] * 16 + syndrome[round - i]];
+        }
+
+        if (discrepancy != 0) {
+            unsigned char tau[kPolySize];
+            for (int i = 0; i < kPolySize; ++i) {
+                tau[i] = lambda[i] ^ gf.mul[discrepancy * 16 + previous[i]];
+            }
+
+            if (l < round - i_mark) {
+                const int tmp = round - i_mark;
+                i_mark = round - l;
+                l = tmp;
+                const unsigned char inverse = gf.inv[discrepancy];
+                for (int i = 0; i < kPolySize; ++i) {
+                    previous[i] = gf.mul[lambda[i] * 16 + inverse];
+                }
+            }
+
+            for (int i = 0; i < kPolySize; ++i) {
+                lambda[i] = tau[i];
+            }
+            lambda_deg = polyDegree(lambda, kPolySize);
+        }
+
+        for (int i = kPolySize - 1; i > 0; --i) {
+            previous[i] = previous[i - 1];
+        }
+        previous[0] = 0;
+    }
+
+    // Chien search over alpha^1..alpha^15, stopping at deg(lambda) roots
+    int locations[kCodeLength];
+    int location_count = 0;
+    for (int i = 1; i <= static_cast<int>(kCodeLength); ++i) {
+        if (polyEval(lambda, lambda_deg, gf.alpha[i], gf) == 0) {
+            locations[location_count++] = i;
+            if (location_count == lambda_deg) break;
+        }
+    }
+
+    if (location_count == 0) {
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error1;
+        return;
+    }
+    if (2 * location_count > static_cast<int>(kFecLength)) {
+        status.errors_detected = location_count;
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error2;
+        return;
+    }
+    status.errors_detected = location_count;
+
+    // Forney: omega = lambda * S mod x^4, magnitudes omega(X) / lambda'(X)
+    unsigned char omega[kFecLength];
+    for (int k = 0; k < static_cast<int>(kFecLength); ++k) {
+        unsigned char acc = 0;
+        for (int i = 0; i <= k && i <= lambda_deg; ++i) {
+            acc ^= gf.mul[lambda[i] * 16 + syndrome[k - i]];
+        }
+        omega[k] = acc;
+    }
+
+    unsigned char derivative[kPolySize] = {0};
+    for (int i = 0; i < lambda_deg; i += 2) {
+        derivative[i] = lambda[i + 1];
+    }
+    const int derivative_deg = polyDegree(derivative, kPolySize);
+
+    for (int i = 0; i < location_count; ++i) {
+        const int location = locations[i];
+        const unsigned char x = gf.alpha[location];
+        const unsigned char numerator =
+            gf.mul[polyEval(omega, kFecLength - 1, x, gf) * 16 + gf.root_exponent[location]];
+        const unsigned char denominator = polyEval(derivative, derivative_deg, x, gf);
+
+        if (numerator != 0) {
+            if (denominator != 0) {
+                codeword[location - 1] ^= gf.mul[numerator * 16 + gf.inv[denominator]];
+                ++status.errors_corrected;
+            } else {
+                status.unrecoverable = true;
+                status.error = block_type::e_decoder_error3;
+                return;
+            }
+        } else {
+            ++status.zero_numerators;
+        }
+    }
+
+    if (lambda_deg != location_count) {
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error4;
+    }
+}
+
+// Correct a codeword whose erased symbols are at positions[0..count),
+// count at most 4, with Forney over the erasure locator polynomial. The
+// corrections are only kept by the caller if the syndromes are zero
+// afterwards: errors besides the erasures are not corrected.
+__host__ __device__ inline void rsCorrectErasures(unsigned char* codeword, const unsigned char* syndrome,
+                                                  const int* positions, int count,
+                                                  const GF16Tables& gf, GPUBlockStatus& status) {
+    constexpr int kPolySize = kFecLength + 1;
+
+    status.errors_detected = count;
+    status.errors_corrected = 0;
+    status.zero_numerators = 0;
+    status.unrecoverable = false;
+    status.error = block_type::e_no_error;
+
+    // gamma = prod (1 - X x), X = alpha^(14 - p) the locator of position p
+    unsigned char gamma[kPolySize] = {1};
+    for (int j = 0; j < count; ++j) {
+        const unsigned char x = gf.alpha[kCodeLength - 1 - positions[j]];
+        for (int i = j + 1; i > 0; --i) {
+            gamma[i] ^= gf.mul[gamma[i - 1] * 16 + x];
+        }
+    }
+
+    unsigned char omega[kFecLength];
+    for (int k = 0; k < static_cast<int>(kFecLength); ++k) {
+        unsigned char acc = 0;
+        for (int i = 0; i <= k && i <= count; ++i) {
+            acc ^= gf.mul[gamma[i] * 16 + syndrome[k - i]];
+        }
+        omega[k] = acc;
+    }
+
+    unsigned char derivative[kPolySize] = {0};
+    for (int i = 0; i < count; i += 2) {
+        derivative[i] = gamma[i + 1];
+    }
+    const int derivative_deg = polyDegree(derivative, kPolySize);
+
+    for (int j = 0; j < count; ++j) {
+        const int location = positions[j] + 1;
+        const unsigned char x = gf.alpha[location];
+        const unsigned char numerator =
+            gf.mul[polyEval(omega, kFecLength - 1, x, gf) * 16 + gf.root_exponent[location]];
+        const unsigned char denominator = polyEval(derivative, derivative_deg, x, gf);
+
+        if (denominator == 0) {
+            status.unrecoverable = true;
+            status.error = block_type::e_decoder_error3;
+            return;
+        }
+        if (numerator != 0) {
+            codeword[positions[j]] ^= gf.mul[numerator * 16 + gf.inv[denominator]];
+            ++status.errors_corrected;
+        } else {
+            ++status.zero_numerators;
+        }
+    }
+}
+
+// Row pass of a product code: decode the 15 symbol row in place, errors
+// only. An erased or uncorrectable row is left as it is and reported as
+// failed, to be an erasure of the column pass. Returns whether the row is
+// a codeword, adding the symbols corrected to corrected.
+__host__ __device__ inline bool decodeProductRow(unsigned char* row, bool erased, const GF16Tables& gf,
+                                                 unsigned int& corrected) {
+    if (erased) return false;
+
+    unsigned char syndrome[kFecLength];
+    if (!rsSyndromes(row, syndrome, gf)) return true;
+
+    unsigned char codeword[kCodeLength];
+    for (size_t i = 0; i < kCodeLength; ++i) codeword[i] = row[i];
+
+    GPUBlockStatus result;
+    rsCorrect(codeword, syndrome, gf, result);
+    if (result.unrecoverable || rsSyndromes(codeword, syndrome, gf)) return false;
+
+    for (size_t i = 0; i < kCodeLength; ++i) row[i] = codeword[i];
+    corrected += result.errors_corrected;
+    return true;
+}
+
+// Column pass of a product code: decode the column of rows symbols at
+// column[0], column[stride], ..., a RS(15,11) codeword shortened by
+// 15 - rows leading zero symbols. Rows flagged in row_failed are its
+// erasures: with up to 4 of them they are recovered, otherwise the column
+// is decoded for errors only. Nothing is written unless the result is a
+// codeword that keeps the shortened symbols zero. Returns whether it is.
+__host__ __device__ inline bool decodeProductColumn(unsigned char* column, size_t stride, size_t rows,
+                                                    const unsigned char* row_failed, const GF16Tables& gf,
+                                                    unsigned int& corrected) {
+    const size_t pad = kCodeLength - rows;
+
+    unsigned char codeword[kCodeLength];
+    int erasures[kCodeLength];
+    int erasure_count = 0;
+    for (size_t i = 0; i < pad; ++i) codeword[i] = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        codeword[pad + r] = column[r * stride];
+        if (row_failed[r]) erasures[erasure_count++] = static_cast<int>(pad + r);
+    }
+
+    unsigned char syndrome[kFecLength];
+    if (!rsSyndromes(codeword, syndrome, gf)) return true;
+    if (erasure_count > static_cast<int>(kFecLength)) return false;
+
+    GPUBlockStatus result;
+    if (erasure_count == 0) {
+        rsCorrect(codeword, syndrome, gf, result);
+    } else {
+        rsCorrectErasures(codeword, syndrome, erasures, erasure_count, gf, result);
+    }
+    if (result.unrecoverable || rsSyndromes(codeword, syndrome, gf)) return false;
+    for (size_t i = 0; i < pad; ++i) {
+        if (codeword[i] != 0) return false;
+    }
+
+    for (size_t r = 0; r < rows; ++r) column[r * stride] = codeword[pad + r];
+    corrected += result.errors_corrected;
+    return true;
+}
+
+// Copy the GF(2^4) tables into shared memory for the block
+__device__ inline void stageTables(GF16Tables& shared_tables) {
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(&c_gf16);
+    unsigned char* target = reinterpret_cast<unsigned char*>(&shared_tables);
+    for (unsigned int i = threadIdx.x; i < sizeof(GF16Tables); i += blockDim.x) {
+        target[i] = source[i];
+    }
+    __syncthreads();
+}
+
+// Write the data symbols of a codeword as bases, 'N' for a symbol a
+// miscorrection left outside the alphabet (dna_storage::decode throws there)
+__host__ __device__ inline void storeData(const unsigned char* codeword, char* decoded) {
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    for (size_t i = 0; i < kDataLength; ++i) {
+        decoded[i] = (codeword[i] < 4) ? bases[codeword[i]] : 'N';
+    }
+}
+
+// CUDA kernel for parallel encoding: one codeword per thread, read from
+// the 2 bit packed input. The generator product table is staged in shared
+// memory, as the threads of a warp look up different entries and constant
+// memory would serialise them.
+__global__ void encodeChunksKernel(const unsigned char* packed_input, char* output_chunks,
+                                   unsigned char* ecc_chunks, size_t num_chunks) {
+    __shared__ unsigned char generator_mul[kFecLength * 16];
+    for (unsigned int i = threadIdx.x; i < kFecLength * 16; i += blockDim.x) {
+        generator_mul[i] = c_generator_mul[i];
+    }
+    __syncthreads();
+
+    const size_t idx = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
     if (idx >= num_chunks) return;
 
-    // Each thread processes one chunk
-    char* input_chunk = input_chunks + (idx * 15); // n=15 encoded size
-    char* output_chunk = output_chunks + (idx * chunk_size);
+    encodeChunk(packed_input, idx * kDataLength, output_chunks + idx * kCodeLength,
+                ecc_chunks + idx * kFecLength, generator_mul);
+}
+
+// First decoding phase, over every codeword: compute the syndromes, store
+// clean codewords straight away, and append dirty ones with their
+// syndromes to a compacted list. Appends are aggregated per warp, one
+// atomic per warp with each lane writing at its rank in the ballot.
+__global__ void syndromeKernel(const char* strands, const unsigned char* ecc, size_t num_chunks,
+                               char* decoded, GPUBlockStatus* status,
+                               unsigned int* dirty_chunks, unsigned int* dirty_syndromes,
+                               unsigned int* dirty_count) {
+    __shared__ GF16Tables gf;
+    stageTables(gf);
+
+    const size_t idx = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    const bool active = idx < num_chunks;
+
+    unsigned char codeword[kCodeLength];
+    unsigned char syndrome[kFecLength];
+    bool dirty = false;
+
+    if (active) {
+        loadCodeword(strands + idx * kCodeLength, ecc + idx * kFecLength, codeword);
+        dirty = rsSyndromes(codeword, syndrome, gf);
+        if (!dirty) {
+            storeData(codeword, decoded + idx * kDataLength);
+            status[idx] = GPUBlockStatus{0, 0, 0, false, block_type::e_no_error};
+        }
+    }
+
+    const unsigned int lane = threadIdx.x & 31;
+    const unsigned int dirty_mask = __ballot_sync(0xffffffffu, dirty);
+    if (dirty_mask == 0) return;
+
+    unsigned int base = 0;
+    if (lane == static_cast<unsigned int>(__ffs(dirty_mask) - 1)) {
+        base = atomicAdd(dirty_count, static_cast<unsigned int>(__popc(dirty_mask)));
+    }
+    base = __shfl_sync(0xffffffffu, base, __ffs(dirty_mask) - 1);
+
+    if (dirty) {
+        const unsigned int slot = base + __popc(dirty_mask & ((1u << lane) - 1));
+        dirty_chunks[slot] = static_cast<unsigned int>(idx);
+        dirty_syndromes[slot] = syndrome[0] | (syndrome[1] << 4) | (syndrome[2] << 8) | (syndrome[3] << 12);
+    }
+}
+
+// Second decoding phase, over the compacted dirty codewords only: run
+// Berlekamp-Massey, Chien and Forney and store the corrected data. The
+// dirty count is read on the device, so the kernel is launched for the
+// whole batch behind the first phase without a host round trip; blocks
+// past the count exit at once.
+__global__ void correctKernel(const char* strands, const unsigned char* ecc,
+                              const unsigned int* dirty_chunks, const unsigned int* dirty_syndromes,
+                              const unsigned int* dirty_count, char* decoded, GPUBlockStatus* status) {
+    const unsigned int num_dirty = *dirty_count;
+    if (blockIdx.x * blockDim.x >= num_dirty) return;
+
+    __shared__ GF16Tables gf;
+    stageTables(gf);
+
+    const unsigned int slot = blockIdx.x * blockDim.x + threadIdx.x;
+    if (slot >= num_dirty) return;
+
+    const size_t idx = dirty_chunks[slot];
+    const unsigned int packed_syndrome = dirty_syndromes[slot];
+    unsigned char syndrome[kFecLength];
+    for (size_t k = 0; k < kFecLength; ++k) {
+        syndrome[k] = (packed_syndrome >> (4 * k)) & 0xf;
+    }
+
+    unsigned char codeword[kCodeLength];
+    loadCodeword(strands + idx * kCodeLength, ecc + idx * kFecLength, codeword);
+
+    GPUBlockStatus result;
+    rsCorrect(codeword, syndrome, gf, result);
+
+    storeData(codeword, decoded + idx * kDataLength);
+    status[idx] = result;
+}
+
+// Product code matrices processed per block of transposeKernel
+constexpr size_t kTransposeMatrices = 16;
+
+// Transpose num_matrices matrices of rows x cols symbols each from in into
+// cols x rows matrices at out. A block stages kTransposeMatrices matrices in
+// shared memory, so both the reads and the writes are contiguous.
+__global__ void transposeKernel(const unsigned char* in, unsigned char* out, size_t num_matrices,
+                                size_t rows, size_t cols) {
+    __shared__ unsigned char tile[kTransposeMatrices * kCodeLength * kCodeLength];
+
+    const size_t first = static_cast<size_t>(blockIdx.x) * kTransposeMatrices;
+    if (first >= num_matrices) return;
+
+    const size_t size = rows * cols;
+    const size_t count = ((num_matrices - first < kTransposeMatrices) ? num_matrices - first : kTransposeMatrices) * size;
+    in += first * size;
+    out += first * size;
+
+    for (size_t i = threadIdx.x; i < count; i += blockDim.x) {
+        tile[i] = in[i];
+    }
+    __syncthreads();
+
+    // Element j of an output matrix is (j / rows, j % rows), input (j % rows, j / rows)
+    for (size_t i = threadIdx.x; i < count; i += blockDim.x) {
+        const size_t base = i - i % size;
+        const size_t j = i % size;
+        out[i] = tile[base + (j % rows) * cols + j / rows];
+    }
+}
+
+// Row pass over every row of the batch, one row per thread. erased, the
+// rows given as erased, is only passed on the first pass. row_failed
+// receives the rows the column pass is to treat as erasures.
+__global__ void productRowKernel(unsigned char* matrices, size_t num_rows, size_t rows,
+                                 const unsigned char* erased, unsigned char* row_failed,
+                                 GPUProductStatus* status) {
+    __shared__ GF16Tables gf;
+    stageTables(gf);
+
+    const size_t idx = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (idx >= num_rows) return;
+
+    unsigned int corrected = 0;
+    const bool ok = decodeProductRow(matrices + idx * kCodeLength, erased && erased[idx], gf, corrected);
+    row_failed[idx] = ok ? 0 : 1;
+    if (corrected) atomicAdd(&status[idx / rows].row_corrections, corrected);
+}
+
+// Column pass over every column of the batch, one column per thread, on
+// the transposed matrices so each column is contiguous
+__global__ void productColumnKernel(unsigned char* transposed, size_t num_matrices, size_t rows,
+                                    const unsigned char* row_failed, unsigned char* column_failed,
+                                    GPUProductStatus* status) {
+    __shared__ GF16Tables gf;
+    stageTables(gf);
+
+    const size_t idx = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (idx >= num_matrices * kCodeLength) return;
+
+    const size_t matrix = idx / kCodeLength;
+    unsigned int corrected = 0;
+    const bool ok = decodeProductColumn(transposed + idx * rows, 1, rows, row_failed + matrix * rows, gf,
+                                        corrected);
+    column_failed[idx] = ok ? 0 : 1;
+    if (corrected) atomicAdd(&status[matrix].column_corrections, corrected);
+}
+
+// Count the rows and columns of every matrix left failed by the last passes
+__global__ void productSummaryKernel(size_t num_matrices, size_t rows, const unsigned char* row_failed,
+                                     const unsigned char* column_failed, GPUProductStatus* status) {
+    const size_t matrix = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (matrix >= num_matrices) return;
 
-    // Decode the chunk
-    decodeChunk(input_chunk, output_chunk, chunk_size);
+    unsigned int failed_rows = 0;
+    unsigned int failed_columns = 0;
+    for (size_t r = 0; r < rows; ++r) failed_rows += row_failed[matrix * rows + r];
+    for (size_t c = 0; c < kCodeLength; ++c) failed_columns += column_failed[matrix * kCodeLength + c];
+    status[matrix].failed_rows = failed_rows;
+    status[matrix].failed_columns = failed_columns;
 }
 
 // CUDA kernel for introducing errors
@@ -89,135 +638,1966 @@ __global__ void introduceErrorsKernel(char* chunks, size_t* chunk_indices,
     chunk[5] = (chunk[5] == 'G') ? 'T' : 'G';
 }
 
+// Encoder and decoder tables, built from the same GF(2^4) field, sequential
+// root generator and decoder parameters as dna_storage::encode and decode
+struct HostCodeTables {
+    unsigned char generator_mul[kFecLength * 16];
+    GF16Tables gf;
+
+    HostCodeTables() {
+        schifra::galois::field field(4, schifra::galois::primitive_polynomial_size01,
+                                     schifra::galois::primitive_polynomial01);
+        schifra::galois::field_polynomial generator(field);
+        if (!schifra::make_sequential_root_generator_polynomial(field, 1, kFecLength, generator) ||
+            generator.deg() != static_cast<int>(kFecLength) || generator[kFecLength].poly() != 1) {
+            throw std::runtime_error("Failed to create generator polynomial");
+        }
+
+        for (size_t j = 0; j < kFecLength; ++j) {
+            for (size_t x = 0; x < 16; ++x) {
+                generator_mul[j * 16 + x] = static_cast<unsigned char>(
+                    field.mul(generator[j].poly(), static_cast<schifra::galois::field_symbol>(x)));
+            }
+        }
+
+        const int gen_initial_index = 1;
+        for (int a = 0; a < 16; ++a) {
+            for (int b = 0; b < 16; ++b) {
+                gf.mul[a * 16 + b] = static_cast<unsigned char>(field.mul(a, b));
+            }
+            gf.inv[a] = static_cast<unsigned char>(a ? field.div(1, a) : 0);
+            gf.alpha[a] = static_cast<unsigned char>(field.alpha(a));
+            gf.root_exponent[a] = static_cast<unsigned char>(
+                field.exp(field.alpha(static_cast<int>(kCodeLength) - a), 1 - gen_initial_index));
+        }
+    }
+};
+
+// Host counterpart of encodeChunksKernel over validated 11 base chunks
+inline void encodeChunksHost(const char* input, size_t num_chunks, char* strands, unsigned char* ecc,
+                             const HostCodeTables& tables) {
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    for (size_t c = 0; c < num_chunks; ++c) {
+        unsigned char data[kDataLength];
+        unsigned char fec[kFecLength];
+        char* strand = strands + c * kCodeLength;
+
+        for (size_t i = 0; i < kDataLength; ++i) {
+            data[i] = baseSymbol(input[c * kDataLength + i]);
+            strand[i] = bases[data[i]];
+        }
+        rsParity(data, fec, tables.generator_mul);
+        for (size_t i = 0; i < kFecLength; ++i) {
+            ecc[c * kFecLength + i] = fec[i];
+            strand[kDataLength + i] = bases[fec[i] & 3];
+        }
+    }
+}
+
+// Host counterpart of the two decoding kernels over validated strands.
+// Returns the number of codewords that had non-zero syndromes.
+inline size_t decodeChunksHost(const char* strands, const unsigned char* ecc, size_t num_chunks,
+                               char* decoded, GPUBlockStatus* status, const HostCodeTables& tables) {
+    size_t dirty = 0;
+    for (size_t c = 0; c < num_chunks; ++c) {
+        unsigned char codeword[kCodeLength];
+        unsigned char syndrome[kFecLength];
+        loadCodeword(strands + c * kCodeLength, ecc + c * kFecLength, codeword);
+
+        if (rsSyndromes(codeword, syndrome, tables.gf)) {
+            rsCorrect(codeword, syndrome, tables.gf, status[c]);
+            ++dirty;
+        } else {
+            status[c] = GPUBlockStatus{0, 0, 0, false, block_type::e_no_error};
+        }
+        storeData(codeword, decoded + c * kDataLength);
+    }
+    return dirty;
+}
+
+// Encode a product code matrix of rows x 15 symbols in place: the first
+// rows - 4 rows hold 11 data symbols each, every row receives its 4 parity
+// symbols and the last 4 rows the column parity of the shortened column code
+inline void encodeProductHost(unsigned char* matrix, size_t rows, const HostCodeTables& tables) {
+    const size_t pad = kCodeLength - rows;
+    for (size_t r = 0; r + kFecLength < rows; ++r) {
+        rsParity(matrix + r * kCodeLength, matrix + r * kCodeLength + kDataLength, tables.generator_mul);
+    }
+    for (size_t c = 0; c < kCodeLength; ++c) {
+        unsigned char data[kDataLength] = {0};
+        unsigned char fec[kFecLength];
+        for (size_t r = 0; r + kFecLength < rows; ++r) {
+            data[pad + r] = matrix[r * kCodeLength + c];
+        }
+        rsParity(data, fec, tables.generator_mul);
+        for (size_t j = 0; j < kFecLength; ++j) {
+            matrix[(rows - kFecLength + j) * kCodeLength + c] = fec[j];
+        }
+    }
+}
+
+// Host counterpart of decodeProducts for one matrix, the same passes over
+// the matrix in place, columns read with a stride instead of transposed
+inline void decodeProductHost(unsigned char* matrix, size_t rows, const unsigned char* erased,
+                              size_t iterations, GPUProductStatus& status, const HostCodeTables& tables) {
+    unsigned char row_failed[kCodeLength];
+    unsigned char column_failed[kCodeLength] = {0};
+    status = GPUProductStatus{0, 0, 0, 0, 0};
+    for (size_t r = 0; erased && r < rows; ++r) status.erased_rows += erased[r] ? 1 : 0;
+
+    for (size_t pass = 0; pass <= iterations; ++pass) {
+        for (size_t r = 0; r < rows; ++r) {
+            const bool row_erased = (pass == 0) && erased && erased[r];
+            row_failed[r] = decodeProductRow(matrix + r * kCodeLength, row_erased, tables.gf,
+                                             status.row_corrections) ? 0 : 1;
+        }
+        if (pass == iterations) break;
+        for (size_t c = 0; c < kCodeLength; ++c) {
+            column_failed[c] = decodeProductColumn(matrix + c, kCodeLength, rows, row_failed, tables.gf,
+                                                   status.column_corrections) ? 0 : 1;
+        }
+    }
+
+    for (size_t r = 0; r < rows; ++r) status.failed_rows += row_failed[r];
+    for (size_t c = 0; c < kCodeLength; ++c) status.failed_columns += column_failed[c];
+}
+
+// Number of batches kept in flight by the pipelined encoder and decoder: while
+// one batch runs its kernels, the next is copied in and the previous copied out
+constexpr size_t kPipelineDepth = 3;
+
+// Run num_chunks chunks through the kPipelineDepth slots in batches of
+// batch_chunks: stage(slot) grows the slot's buffers, fills its pinned
+// input for slot.first and slot.count and queues its copies and kernels on
+// the slot's stream, and collect(slot) takes its results out of the pinned
+// buffers once the stream is done. A slot is only waited for when it is
+// needed again, so the transfers and kernels of consecutive batches
+// overlap; batches are staged and collected in order.
+template <typename Slot, typename Stage, typename Collect>
+void runSlotPipeline(Slot (&slots)[kPipelineDepth], size_t num_chunks, size_t batch_chunks,
+                     Stage stage, Collect collect) {
+    batch_chunks = std::max<size_t>(batch_chunks, 1);
+    size_t batch = 0;
+
+    try {
+        for (size_t first = 0; first < num_chunks; first += batch_chunks, ++batch) {
+            Slot& slot = slots[batch % kPipelineDepth];
+            if (slot.busy) {
+                checkCuda(cudaStreamSynchronize(slot.stream), "cudaStreamSynchronize");
+                slot.busy = false;
+                collect(slot);
+            }
+
+            slot.first = first;
+            slot.count = std::min(batch_chunks, num_chunks - first);
+            stage(slot);
+            slot.busy = true;
+        }
+
+        for (size_t i = 0; i < kPipelineDepth; ++i) {
+            Slot& slot = slots[(batch + i) % kPipelineDepth];
+            if (slot.busy) {
+                checkCuda(cudaStreamSynchronize(slot.stream), "cudaStreamSynchronize");
+                slot.busy = false;
+                collect(slot);
+            }
+        }
+    } catch (...) {
+        for (Slot& slot : slots) {
+            cudaStreamSynchronize(slot.stream);
+            slot.busy = false;
+        }
+        throw;
+    }
+}
+
+// Pinned host staging and device buffers of one pipeline stage, on its own
+// stream. They are kept across calls and only ever grown.
+struct PipelineSlot {
+    cudaStream_t stream = nullptr;
+    size_t capacity = 0;  // chunks
+
+    // Pinned host staging
+    unsigned char* h_packed = nullptr;
+    char* h_strands = nullptr;
+    unsigned char* h_ecc = nullptr;
+    char* h_decoded = nullptr;
+    GPUBlockStatus* h_status = nullptr;
+    unsigned int* h_dirty_count = nullptr;
+
+    // Device buffers
+    unsigned char* d_packed = nullptr;
+    char* d_strands = nullptr;
+    unsigned char* d_ecc = nullptr;
+    char* d_decoded = nullptr;
+    GPUBlockStatus* d_status = nullptr;
+    unsigned int* d_dirty_chunks = nullptr;
+    unsigned int* d_dirty_syndromes = nullptr;
+    unsigned int* d_dirty_count = nullptr;
+
+    // Product code matrices: pinned staging, and on the device the matrices
+    // and their transposes, which the row and column passes alternate over
+    size_t product_capacity = 0;  // symbols
+    unsigned char* h_matrices = nullptr;
+    unsigned char* h_erased = nullptr;
+    GPUProductStatus* h_product_status = nullptr;
+    unsigned char* d_matrices = nullptr;
+    unsigned char* d_transposed = nullptr;
+    unsigned char* d_erased = nullptr;
+    unsigned char* d_row_failed = nullptr;
+    unsigned char* d_column_failed = nullptr;
+    GPUProductStatus* d_product_status = nullptr;
+
+    // Batch in flight: its first chunk and chunk count
+    size_t first = 0;
+    size_t count = 0;
+    bool busy = false;
+};
+
 class ParallelDNAStorage {
 private:
     dna_storage_type dna_storage;
+    int device;
+    size_t multiprocessors;
     size_t num_cuda_cores;
     size_t batch_size;
+    PipelineSlot slots[kPipelineDepth];
+
+    // Make this object's device current on the calling thread
+    void selectDevice() const {
+        checkCuda(cudaSetDevice(device), "cudaSetDevice");
+    }
+
+    // Upload the encoder and decoder tables to constant memory
+    static void uploadCodeTables() {
+        const HostCodeTables tables;
+        checkCuda(cudaMemcpyToSymbol(c_generator_mul, tables.generator_mul, sizeof(tables.generator_mul)),
+                  "cudaMemcpyToSymbol");
+        checkCuda(cudaMemcpyToSymbol(c_gf16, &tables.gf, sizeof(tables.gf)), "cudaMemcpyToSymbol");
+    }
+
+    // Release the product code buffers of a slot
+    static void freeProductBuffers(PipelineSlot& slot) {
+        cudaFreeHost(slot.h_matrices);
+        cudaFreeHost(slot.h_erased);
+        cudaFreeHost(slot.h_product_status);
+        cudaFree(slot.d_matrices);
+        cudaFree(slot.d_transposed);
+        cudaFree(slot.d_erased);
+        cudaFree(slot.d_row_failed);
+        cudaFree(slot.d_column_failed);
+        cudaFree(slot.d_product_status);
+
+        slot.product_capacity = 0;
+        slot.h_matrices = slot.h_erased = nullptr;
+        slot.h_product_status = slot.d_product_status = nullptr;
+        slot.d_matrices = slot.d_transposed = slot.d_erased = slot.d_row_failed = slot.d_column_failed = nullptr;
+    }
+
+    // Grow the product code buffers of a slot to hold num_matrices matrices
+    // of up to 15 x 15 symbols
+    static void reserveProductSlot(PipelineSlot& slot, size_t num_matrices) {
+        const size_t symbols = num_matrices * kCodeLength * kCodeLength;
+        if (slot.product_capacity >= symbols) return;
+
+        freeProductBuffers(slot);
+
+        const size_t row_count = num_matrices * kCodeLength;
+        checkCuda(cudaMallocHost(&slot.h_matrices, symbols), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_erased, row_count), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_product_status, num_matrices * sizeof(GPUProductStatus)), "cudaMallocHost");
+        checkCuda(cudaMalloc(&slot.d_matrices, symbols), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_transposed, symbols), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_erased, row_count), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_row_failed, row_count), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_column_failed, num_matrices * kCodeLength), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_product_status, num_matrices * sizeof(GPUProductStatus)), "cudaMalloc");
+        slot.product_capacity = symbols;
+    }
+
+    // Release the buffers of a slot, keeping its stream
+    static void freeSlotBuffers(PipelineSlot& slot) {
+        freeProductBuffers(slot);
+        cudaFreeHost(slot.h_packed);
+        cudaFreeHost(slot.h_strands);
+        cudaFreeHost(slot.h_ecc);
+        cudaFreeHost(slot.h_decoded);
+        cudaFreeHost(slot.h_status);
+        cudaFreeHost(slot.h_dirty_count);
+        cudaFree(slot.d_packed);
+        cudaFree(slot.d_strands);
+        cudaFree(slot.d_ecc);
+        cudaFree(slot.d_decoded);
+        cudaFree(slot.d_status);
+        cudaFree(slot.d_dirty_chunks);
+        cudaFree(slot.d_dirty_syndromes);
+        cudaFree(slot.d_dirty_count);
+
+        const cudaStream_t stream = slot.stream;
+        slot = PipelineSlot();
+        slot.stream = stream;
+    }
+
+    // Grow the buffers of a slot to hold num_chunks chunks. Buffers are only
+    // reallocated when a batch outgrows them, so repeated calls reuse them.
+    static void reserveSlot(PipelineSlot& slot, size_t num_chunks) {
+        if (slot.capacity >= num_chunks) return;
+
+        freeSlotBuffers(slot);
+
+        const size_t packed_bytes = (num_chunks * kDataLength + 3) / 4;
+        checkCuda(cudaMallocHost(&slot.h_packed, packed_bytes), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_strands, num_chunks * kCodeLength), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_ecc, num_chunks * kFecLength), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_decoded, num_chunks * kDataLength), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_status, num_chunks * sizeof(GPUBlockStatus)), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_dirty_count, sizeof(unsigned int)), "cudaMallocHost");
+        checkCuda(cudaMalloc(&slot.d_packed, packed_bytes), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_strands, num_chunks * kCodeLength), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_ecc, num_chunks * kFecLength), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_decoded, num_chunks * kDataLength), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_status, num_chunks * sizeof(GPUBlockStatus)), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_chunks, num_chunks * sizeof(unsigned int)), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_syndromes, num_chunks * sizeof(unsigned int)), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_count, sizeof(unsigned int)), "cudaMalloc");
+        slot.capacity = num_chunks;
+    }
+
+    // Pack count bases 4 per byte in the layout unpackBase reads
+    static void packBases(const char* bases, size_t count, unsigned char* packed) {
+        std::fill(packed, packed + (count + 3) / 4, static_cast<unsigned char>(0));
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char code;
+            switch (bases[i]) {
+                case 'A': case 'a': code = 0; break;
+                case 'C': case 'c': code = 1; break;
+                case 'G': case 'g': code = 2; break;
+                case 'T': case 't': code = 3; break;
+                default: throw std::invalid_argument("Invalid DNA base in input");
+            }
+            packed[i >> 2] |= static_cast<unsigned char>(code << ((i & 3) << 1));
+        }
+    }
 
-    // Allocate GPU memory for chunks
-    GPUChunkBuffer allocateGPUBuffer(size_t num_chunks, size_t chunk_size) {
-        GPUChunkBuffer buffer;
-        buffer.num_chunks = num_chunks;
-        
-        // Allocate memory for chunk data
-        cudaMalloc(&buffer.data, num_chunks * chunk_size);
-        
-        // Allocate memory for chunk indices
-        cudaMalloc(&buffer.indices, num_chunks * sizeof(size_t));
-        
-        return buffer;
+    // Queue the encoding of num_chunks packed chunks on stream into 15 base
+    // strands at output and their ECC symbols at ecc, all device buffers
+    static void launchEncoder(const unsigned char* packed, size_t num_chunks, char* output,
+                              unsigned char* ecc, cudaStream_t stream) {
+        if (num_chunks == 0) return;
+
+        dim3 blockDim(256);
+        dim3 gridDim((num_chunks + blockDim.x - 1) / blockDim.x);
+        encodeChunksKernel<<<gridDim, blockDim, 0, stream>>>(packed, output, ecc, num_chunks);
+        checkCuda(cudaGetLastError(), "encodeChunksKernel");
+    }
+
+    // Queue the decoding of num_chunks strands (15 bases each) with their ECC
+    // symbols on stream, into 11 data bases per chunk and a status per chunk,
+    // using the dirty list buffers of slot. The number of codewords that had
+    // non-zero syndromes is left in slot.d_dirty_count.
+    static void launchDecoder(const char* strands, const unsigned char* ecc, size_t num_chunks,
+                              char* decoded, GPUBlockStatus* status, PipelineSlot& slot) {
+        checkCuda(cudaMemsetAsync(slot.d_dirty_count, 0, sizeof(unsigned int), slot.stream), "cudaMemsetAsync");
+        if (num_chunks == 0) return;
+
+        dim3 blockDim(256);
+        dim3 gridDim((num_chunks + blockDim.x - 1) / blockDim.x);
+        syndromeKernel<<<gridDim, blockDim, 0, slot.stream>>>(strands, ecc, num_chunks, decoded, status,
+                                                              slot.d_dirty_chunks, slot.d_dirty_syndromes,
+                                                              slot.d_dirty_count);
+        checkCuda(cudaGetLastError(), "syndromeKernel");
+        correctKernel<<<gridDim, blockDim, 0, slot.stream>>>(strands, ecc, slot.d_dirty_chunks,
+                                                             slot.d_dirty_syndromes, slot.d_dirty_count,
+                                                             decoded, status);
+        checkCuda(cudaGetLastError(), "correctKernel");
     }
 
-    // Free GPU memory
-    void freeGPUBuffer(GPUChunkBuffer& buffer) {
-        if (buffer.data) cudaFree(buffer.data);
-        if (buffer.indices) cudaFree(buffer.indices);
-        buffer.data = nullptr;
-        buffer.indices = nullptr;
+    // runSlotPipeline over this object's slots
+    template <typename Stage, typename Collect>
+    void runPipeline(size_t num_chunks, size_t batch_chunks, Stage stage, Collect collect) {
+        runSlotPipeline(slots, num_chunks, batch_chunks, stage, collect);
     }
 
 public:
-    ParallelDNAStorage() {
+    // Run on CUDA device device_id; the code tables, streams and buffers
+    // all live on it, and every call makes it current first
+    explicit ParallelDNAStorage(int device_id = 0) : device(device_id) {
+        selectDevice();
+
         // Get number of CUDA cores
         cudaDeviceProp prop;
-        cudaGetDeviceProperties(&prop, 0);
+        checkCuda(cudaGetDeviceProperties(&prop, device), "cudaGetDeviceProperties");
+        multiprocessors = prop.multiProcessorCount;
         num_cuda_cores = prop.multiProcessorCount * prop.maxThreadsPerMultiProcessor;
         batch_size = num_cuda_cores; // Process one chunk per CUDA core
+
+        uploadCodeTables();
+
+        for (PipelineSlot& slot : slots) {
+            checkCuda(cudaStreamCreateWithFlags(&slot.stream, cudaStreamNonBlocking), "cudaStreamCreate");
+        }
     }
 
-    // Split input into chunks
-    std::vector<DNAChunk> splitIntoChunks(const std::string& input, size_t chunk_size) {
-        std::vector<DNAChunk> chunks;
-        size_t num_chunks = input.length() / chunk_size;
-        
-        for (size_t i = 0; i < num_chunks; ++i) {
-            DNAChunk chunk;
-            chunk.data = new char[chunk_size];
-            chunk.size = chunk_size;
-            chunk.index = i;  // Set chunk index for ordering
-            
-            // Copy chunk data
-            std::copy(input.begin() + (i * chunk_size),
-                     input.begin() + ((i + 1) * chunk_size),
-                     chunk.data);
-            
-            chunks.push_back(chunk);
+    ~ParallelDNAStorage() {
+        cudaSetDevice(device);
+        for (PipelineSlot& slot : slots) {
+            if (slot.stream) cudaStreamSynchronize(slot.stream);
+            freeSlotBuffers(slot);
+            if (slot.stream) cudaStreamDestroy(slot.stream);
         }
-        
-        return chunks;
     }
 
-    // Process chunks in parallel
-    std::string processParallel(const std::string& input) {
-        // Split input into chunks of size k=11
-        auto chunks = splitIntoChunks(input, 11);
-        
-        // Allocate GPU buffers
-        GPUChunkBuffer input_buffer = allocateGPUBuffer(chunks.size(), 11);
-        GPUChunkBuffer output_buffer = allocateGPUBuffer(chunks.size(), 15);
-        
-        // Copy input chunks to device with their indices
-        std::vector<size_t> indices(chunks.size());
-        for (size_t i = 0; i < chunks.size(); ++i) {
-            indices[i] = chunks[i].index;
-            cudaMemcpy(input_buffer.data + (i * 11), chunks[i].data, 11, cudaMemcpyHostToDevice);
-        }
-        cudaMemcpy(input_buffer.indices, indices.data(), indices.size() * sizeof(size_t), cudaMemcpyHostToDevice);
-        
-        // Calculate grid and block dimensions
-        dim3 blockDim(256);
-        dim3 gridDim((chunks.size() + blockDim.x - 1) / blockDim.x);
-        
-        // Launch encoding kernel
-        encodeChunksKernel<<<gridDim, blockDim>>>(input_buffer.data, output_buffer.data, 
-                                                 input_buffer.indices, 11, chunks.size());
-        cudaDeviceSynchronize();
-        
-        // Introduce errors in encoded chunks
-        introduceErrorsKernel<<<gridDim, blockDim>>>(output_buffer.data, output_buffer.indices, 
-                                                    chunks.size());
-        cudaDeviceSynchronize();
-        
-        // Launch decoding kernel
-        decodeChunksKernel<<<gridDim, blockDim>>>(output_buffer.data, input_buffer.data,
-                                                 output_buffer.indices, 11, chunks.size());
-        cudaDeviceSynchronize();
-        
-        // Copy results back to host in order
-        std::string result;
-        result.resize(input.length());
-        
-        // Create a temporary buffer for ordered results
-        std::vector<char> ordered_buffer(input.length());
-        
-        // Copy all chunks back
-        for (size_t i = 0; i < chunks.size(); ++i) {
-            cudaMemcpy(&ordered_buffer[i * 11], input_buffer.data + (i * 11), 
-                      11, cudaMemcpyDeviceToHost);
-        }
-        
-        // Copy indices back
-        std::vector<size_t> ordered_indices(chunks.size());
-        cudaMemcpy(ordered_indices.data(), input_buffer.indices, 
-                   chunks.size() * sizeof(size_t), cudaMemcpyDeviceToHost);
-        
-        // Reorder chunks based on their indices
-        for (size_t i = 0; i < chunks.size(); ++i) {
-            size_t original_index = ordered_indices[i];
-            std::copy(ordered_buffer.begin() + (i * 11),
-                     ordered_buffer.begin() + ((i + 1) * 11),
-                     result.begin() + (original_index * 11));
-        }
-        
-        // Cleanup
-        freeGPUBuffer(input_buffer);
-        freeGPUBuffer(output_buffer);
-        
-        for (auto& chunk : chunks) {
-            delete[] chunk.data;
-        }
-        
-        return result;
+    ParallelDNAStorage(const ParallelDNAStorage&) = delete;
+    ParallelDNAStorage& operator=(const ParallelDNAStorage&) = delete;
+
+    // Chunks per pipelined batch, one chunk per CUDA core by default
+    void setBatchSize(size_t chunks) { batch_size = std::max<size_t>(chunks, 1); }
+    size_t batchSize() const { return batch_size; }
+
+    int deviceId() const { return device; }
+    size_t multiprocessorCount() const { return multiprocessors; }
+
+    // Encode input, a whole number of 11 base chunks, on the GPU. strands
+    // receives the 15 base strand of every chunk back to back and ecc its 4
+    // ECC symbols, the same strand and ECC dna_storage::encode returns for
+    // it (data bases are written upper case).
+    void encodeParallel(const std::string& input, std::string& strands, std::vector<uint8_t>& ecc) {
+        if (input.length() % kDataLength != 0) {
+            throw std::invalid_argument("Input length must be a multiple of 11 bases");
+        }
+
+        const size_t num_chunks = input.length() / kDataLength;
+        strands.assign(num_chunks * kCodeLength, 'A');
+        ecc.assign(num_chunks * kFecLength, 0);
+        encodeChunks(input.data(), num_chunks, num_chunks ? &strands[0] : nullptr, ecc.data());
+    }
+
+    // encodeParallel over num_chunks chunks at input into caller buffers of
+    // num_chunks * 15 bases and num_chunks * 4 symbols
+    void encodeChunks(const char* input, size_t num_chunks, char* strands, uint8_t* ecc) {
+        if (num_chunks == 0) return;
+        selectDevice();
+
+        runPipeline(num_chunks, batch_size,
+            [&](PipelineSlot& slot) {
+                reserveSlot(slot, slot.count);
+                const size_t bases = slot.count * kDataLength;
+                const size_t packed_bytes = (bases + 3) / 4;
+                packBases(input + slot.first * kDataLength, bases, slot.h_packed);
+
+                checkCuda(cudaMemcpyAsync(slot.d_packed, slot.h_packed, packed_bytes,
+                                          cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+                launchEncoder(slot.d_packed, slot.count, slot.d_strands, slot.d_ecc, slot.stream);
+                checkCuda(cudaMemcpyAsync(slot.h_strands, slot.d_strands, slot.count * kCodeLength,
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.h_ecc, slot.d_ecc, slot.count * kFecLength,
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+            },
+            [&](const PipelineSlot& slot) {
+                std::copy(slot.h_strands, slot.h_strands + slot.count * kCodeLength,
+                          strands + slot.first * kCodeLength);
+                std::copy(slot.h_ecc, slot.h_ecc + slot.count * kFecLength, ecc + slot.first * kFecLength);
+            });
     }
-}; 
\ No newline at end of file
+
+    // Check strands (15 bases each) and their 4 ECC symbols each for decoding
+    static void validateStrands(const std::string& strands, const std::vector<uint8_t>& ecc) {
+        if (strands.length() % kCodeLength != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of 15 bases");
+        }
+        if (ecc.size() != strands.length() / kCodeLength * kFecLength) {
+            throw std::invalid_argument("ECC must hold 4 symbols per strand");
+        }
+        if (strands.find_first_not_of("ACGTacgt") != std::string::npos) {
+            throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters");
+        }
+        if (std::any_of(ecc.begin(), ecc.end(), [](uint8_t symbol) { return symbol > 15; })) {
+            throw std::invalid_argument("ECC symbols must be GF(16) symbols");
+        }
+    }
+
+    // Decode strands (15 bases each, back to back) with their 4 ECC symbols
+    // each on the GPU. decoded receives the 11 data bases of every chunk and
+    // status the state a schifra block is left in by the CPU decoder for it;
+    // where that fails the data is left as the decoder left it, as the
+    // block's is. Returns the number of chunks that needed correcting.
+    size_t decodeParallel(const std::string& strands, const std::vector<uint8_t>& ecc,
+                          std::string& decoded, std::vector<GPUBlockStatus>& status) {
+        validateStrands(strands, ecc);
+        const size_t num_chunks = strands.length() / kCodeLength;
+
+        decoded.assign(num_chunks * kDataLength, 'A');
+        status.assign(num_chunks, GPUBlockStatus{0, 0, 0, false, block_type::e_no_error});
+        return decodeChunks(strands.data(), ecc.data(), num_chunks, num_chunks ? &decoded[0] : nullptr,
+                            status.data());
+    }
+
+    // decodeParallel over num_chunks validated strands and their ECC into
+    // caller buffers of num_chunks * 11 bases and num_chunks statuses
+    size_t decodeChunks(const char* strands, const uint8_t* ecc, size_t num_chunks,
+                        char* decoded, GPUBlockStatus* status) {
+        if (num_chunks == 0) return 0;
+        selectDevice();
+        size_t dirty = 0;
+
+        runPipeline(num_chunks, batch_size,
+            [&](PipelineSlot& slot) {
+                reserveSlot(slot, slot.count);
+                std::copy(strands + slot.first * kCodeLength,
+                          strands + (slot.first + slot.count) * kCodeLength, slot.h_strands);
+                std::copy(ecc + slot.first * kFecLength, ecc + (slot.first + slot.count) * kFecLength, slot.h_ecc);
+
+                checkCuda(cudaMemcpyAsync(slot.d_strands, slot.h_strands, slot.count * kCodeLength,
+                                          cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.d_ecc, slot.h_ecc, slot.count * kFecLength,
+                                          cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+                launchDecoder(slot.d_strands, slot.d_ecc, slot.count, slot.d_decoded, slot.d_status, slot);
+                checkCuda(cudaMemcpyAsync(slot.h_decoded, slot.d_decoded, slot.count * kDataLength,
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.h_status, slot.d_status, slot.count * sizeof(GPUBlockStatus),
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.h_dirty_count, slot.d_dirty_count, sizeof(unsigned int),
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+            },
+            [&](const PipelineSlot& slot) {
+                std::copy(slot.h_decoded, slot.h_decoded + slot.count * kDataLength,
+                          decoded + slot.first * kDataLength);
+                std::copy(slot.h_status, slot.h_status + slot.count, status + slot.first);
+                dirty += *slot.h_dirty_count;
+            });
+
+        return dirty;
+    }
+
+    // Decode num_matrices product code matrices in place on the GPU. Each is
+    // rows x 15 symbols (rows from 5 to 15), row after row: every row a
+    // RS(15,11) codeword, 11 symbols then 4 parity, as loadCodeword builds
+    // from a strand and its ECC, and every column a RS(15,11) codeword
+    // shortened to rows symbols, rows - 4 then 4 parity (encodeProductHost).
+    // With the strands of an oligo pool as rows the columns are its outer
+    // code across strands, and erased_rows, if given, flags the rows of
+    // every matrix that were lost (dropped strands) as erasures.
+    //
+    // A batch of matrices is copied to the device once and stays there for
+    // iterations rounds of a row pass, a transpose, a column pass over the
+    // now contiguous columns (the rows that failed their pass being its
+    // erasures) and a transpose back, then a last row pass, before the
+    // matrices and a status per matrix come back.
+    void decodeProducts(uint8_t* matrices, size_t num_matrices, size_t rows, const uint8_t* erased_rows,
+                        GPUProductStatus* status, size_t iterations = 2) {
+        if (rows <= kFecLength || rows > kCodeLength) {
+            throw std::invalid_argument("Product code matrices must have 5 to 15 rows");
+        }
+        if (std::any_of(matrices, matrices + num_matrices * rows * kCodeLength,
+                        [](uint8_t symbol) { return symbol > 15; })) {
+            throw std::invalid_argument("Product code symbols must be GF(16) symbols");
+        }
+        if (num_matrices == 0) return;
+        selectDevice();
+
+        const size_t matrix_size = rows * kCodeLength;
+        const dim3 blockDim(256);
+
+        runPipeline(num_matrices, batch_size / rows,
+            [&](PipelineSlot& slot) {
+                reserveProductSlot(slot, slot.count);
+                const size_t row_count = slot.count * rows;
+                const size_t symbols = slot.count * matrix_size;
+
+                std::copy(matrices + slot.first * matrix_size, matrices + slot.first * matrix_size + symbols,
+                          slot.h_matrices);
+                for (size_t m = 0; m < slot.count; ++m) {
+                    GPUProductStatus& matrix_status = slot.h_product_status[m];
+                    matrix_status = GPUProductStatus{0, 0, 0, 0, 0};
+                    for (size_t r = 0; r < rows; ++r) {
+                        const size_t row = (slot.first + m) * rows + r;
+                        slot.h_erased[m * rows + r] = (erased_rows && erased_rows[row]) ? 1 : 0;
+                        matrix_status.erased_rows += slot.h_erased[m * rows + r];
+                    }
+                }
+
+                checkCuda(cudaMemcpyAsync(slot.d_matrices, slot.h_matrices, symbols,
+                                          cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.d_erased, slot.h_erased, row_count,
+                                          cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.d_product_status, slot.h_product_status,
+                                          slot.count * sizeof(GPUProductStatus), cudaMemcpyHostToDevice,
+                                          slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemsetAsync(slot.d_column_failed, 0, slot.count * kCodeLength, slot.stream),
+                          "cudaMemsetAsync");
+
+                const dim3 rowGrid((row_count + blockDim.x - 1) / blockDim.x);
+                const dim3 columnGrid((slot.count * kCodeLength + blockDim.x - 1) / blockDim.x);
+                const dim3 transposeGrid((slot.count + kTransposeMatrices - 1) / kTransposeMatrices);
+
+                for (size_t pass = 0; pass <= iterations; ++pass) {
+                    productRowKernel<<<rowGrid, blockDim, 0, slot.stream>>>(
+                        slot.d_matrices, row_count, rows, (pass == 0) ? slot.d_erased : nullptr,
+                        slot.d_row_failed, slot.d_product_status);
+                    checkCuda(cudaGetLastError(), "productRowKernel");
+                    if (pass == iterations) break;
+
+                    transposeKernel<<<transposeGrid, blockDim, 0, slot.stream>>>(
+                        slot.d_matrices, slot.d_transposed, slot.count, rows, kCodeLength);
+                    checkCuda(cudaGetLastError(), "transposeKernel");
+                    productColumnKernel<<<columnGrid, blockDim, 0, slot.stream>>>(
+                        slot.d_transposed, slot.count, rows, slot.d_row_failed, slot.d_column_failed,
+                        slot.d_product_status);
+                    checkCuda(cudaGetLastError(), "productColumnKernel");
+                    transposeKernel<<<transposeGrid, blockDim, 0, slot.stream>>>(
+                        slot.d_transposed, slot.d_matrices, slot.count, kCodeLength, rows);
+                    checkCuda(cudaGetLastError(), "transposeKernel");
+                }
+
+                const dim3 summaryGrid((slot.count + blockDim.x - 1) / blockDim.x);
+                productSummaryKernel<<<summaryGrid, blockDim, 0, slot.stream>>>(
+                    slot.count, rows, slot.d_row_failed, slot.d_column_failed, slot.d_product_status);
+                checkCuda(cudaGetLastError(), "productSummaryKernel");
+
+                checkCuda(cudaMemcpyAsync(slot.h_matrices, slot.d_matrices, symbols,
+                                          cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+                checkCuda(cudaMemcpyAsync(slot.h_product_status, slot.d_product_status,
+                                          slot.count * sizeof(GPUProductStatus), cudaMemcpyDeviceToHost,
+                                          slot.stream), "cudaMemcpyAsync");
+            },
+            [&](const PipelineSlot& slot) {
+                std::copy(slot.h_matrices, slot.h_matrices + slot.count * matrix_size,
+                          matrices + slot.first * matrix_size);
+                std::copy(slot.h_product_status, slot.h_product_status + slot.count, status + slot.first);
+            });
+    }
+
+    // decodeProducts over a vector of matrices back to back, erased_rows
+    // empty or one flag per row of them
+    void decodeProducts(std::vector<uint8_t>& matrices, size_t rows, const std::vector<uint8_t>& erased_rows,
+                        std::vector<GPUProductStatus>& status, size_t iterations = 2) {
+        const size_t matrix_size = rows * kCodeLength;
+        if (matrix_size == 0 || matrices.size() % matrix_size != 0) {
+            throw std::invalid_argument("Matrices must be a whole number of rows x 15 symbols");
+        }
+        const size_t num_matrices = matrices.size() / matrix_size;
+        if (!erased_rows.empty() && erased_rows.size() != num_matrices * rows) {
+            throw std::invalid_argument("Erased rows must hold one flag per row");
+        }
+
+        status.assign(num_matrices, GPUProductStatus{0, 0, 0, 0, 0});
+        decodeProducts(matrices.data(), num_matrices, rows, erased_rows.empty() ? nullptr : erased_rows.data(),
+                       status.data(), iterations);
+    }
+
+    // Split input into chunks
+    std::vector<DNAChunk> splitIntoChunks(const std::string& input, size_t chunk_size) {
+        std::vector<DNAChunk> chunks;
+        size_t num_chunks = input.length() / chunk_size;
+
+        for (size_t i = 0; i < num_chunks; ++i) {
+            DNAChunk chunk;
+            chunk.data = new char[chunk_size];
+            chunk.size = chunk_size;
+            chunk.index = i;  // Set chunk index for ordering
+
+            // Copy chunk data
+            std::copy(input.begin() + (i * chunk_size),
+                     input.begin() + ((i + 1) * chunk_size),
+                     chunk.data);
+
+            chunks.push_back(chunk);
+        }
+
+        return chunks;
+    }
+
+    // Encode the whole chunks of the input, damage every encoded strand and
+    // decode it back, all on the device through the pipeline buffers; the
+    // bases past the last whole chunk are left as zero
+    std::string processParallel(const std::string& input) {
+        const size_t num_chunks = input.length() / kDataLength;
+        std::string result(input.length(), '\0');
+        if (num_chunks == 0) return result;
+
+        selectDevice();
+        PipelineSlot& slot = slots[0];
+        reserveSlot(slot, num_chunks);
+
+        const size_t bases = num_chunks * kDataLength;
+        packBases(input.data(), bases, slot.h_packed);
+        checkCuda(cudaMemcpyAsync(slot.d_packed, slot.h_packed, (bases + 3) / 4,
+                                  cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+
+        // Encode, introduce errors in the encoded chunks, then decode them
+        launchEncoder(slot.d_packed, num_chunks, slot.d_strands, slot.d_ecc, slot.stream);
+
+        dim3 blockDim(256);
+        dim3 gridDim((num_chunks + blockDim.x - 1) / blockDim.x);
+        introduceErrorsKernel<<<gridDim, blockDim, 0, slot.stream>>>(slot.d_strands, nullptr, num_chunks);
+        checkCuda(cudaGetLastError(), "introduceErrorsKernel");
+
+        launchDecoder(slot.d_strands, slot.d_ecc, num_chunks, slot.d_decoded, slot.d_status, slot);
+
+        checkCuda(cudaMemcpyAsync(slot.h_decoded, slot.d_decoded, bases, cudaMemcpyDeviceToHost, slot.stream),
+                  "cudaMemcpyAsync");
+        checkCuda(cudaStreamSynchronize(slot.stream), "cudaStreamSynchronize");
+
+        std::copy(slot.h_decoded, slot.h_decoded + bases, result.begin());
+        return result;
+    }
+};
+
+// Shards encode and decode batches over several CUDA devices, each with its
+// own ParallelDNAStorage and so its own streams, pinned staging and device
+// buffers. A batch is cut into one contiguous range per device, sized by
+// the device's multiprocessor count, and every range is run by its own host
+// thread straight into its slice of the output, so the results come back
+// merged in order.
+class MultiGPUDNAStorage {
+public:
+    // Use the given devices, or every visible device when none are given
+    explicit MultiGPUDNAStorage(std::vector<int> device_ids = std::vector<int>()) {
+        if (device_ids.empty()) {
+            int count = 0;
+            checkCuda(cudaGetDeviceCount(&count), "cudaGetDeviceCount");
+            for (int i = 0; i < count; ++i) device_ids.push_back(i);
+        }
+        if (device_ids.empty()) {
+            throw std::runtime_error("No CUDA device available");
+        }
+
+        size_t total = 0;
+        for (int id : device_ids) {
+            devices.emplace_back(new ParallelDNAStorage(id));
+            total += devices.back()->multiprocessorCount();
+        }
+        for (const auto& device : devices) {
+            shares.push_back(total ? static_cast<double>(device->multiprocessorCount()) / total
+                                   : 1.0 / devices.size());
+        }
+    }
+
+    MultiGPUDNAStorage(const MultiGPUDNAStorage&) = delete;
+    MultiGPUDNAStorage& operator=(const MultiGPUDNAStorage&) = delete;
+
+    size_t deviceCount() const { return devices.size(); }
+    ParallelDNAStorage& device(size_t index) { return *devices[index]; }
+
+    // Chunks all devices take in one round of pipelined batches
+    size_t batchSize() const {
+        size_t total = 0;
+        for (const auto& device : devices) total += device->batchSize();
+        return total;
+    }
+
+    // ParallelDNAStorage::encodeParallel over all devices
+    void encodeParallel(const std::string& input, std::string& strands, std::vector<uint8_t>& ecc) {
+        if (input.length() % kDataLength != 0) {
+            throw std::invalid_argument("Input length must be a multiple of 11 bases");
+        }
+
+        const size_t num_chunks = input.length() / kDataLength;
+        strands.assign(num_chunks * kCodeLength, 'A');
+        ecc.assign(num_chunks * kFecLength, 0);
+
+        forEachShard(num_chunks, [&](ParallelDNAStorage& device, size_t first, size_t count) {
+            device.encodeChunks(input.data() + first * kDataLength, count,
+                                &strands[first * kCodeLength], ecc.data() + first * kFecLength);
+            return size_t(0);
+        });
+    }
+
+    // ParallelDNAStorage::decodeParallel over all devices
+    size_t decodeParallel(const std::string& strands, const std::vector<uint8_t>& ecc,
+                          std::string& decoded, std::vector<GPUBlockStatus>& status) {
+        ParallelDNAStorage::validateStrands(strands, ecc);
+        const size_t num_chunks = strands.length() / kCodeLength;
+
+        decoded.assign(num_chunks * kDataLength, 'A');
+        status.assign(num_chunks, GPUBlockStatus{0, 0, 0, false, block_type::e_no_error});
+
+        return forEachShard(num_chunks, [&](ParallelDNAStorage& device, size_t first, size_t count) {
+            return device.decodeChunks(strands.data() + first * kCodeLength, ecc.data() + first * kFecLength,
+                                       count, &decoded[first * kDataLength], status.data() + first);
+        });
+    }
+
+private:
+    // Run shard(device, first, count) for each device's range of num_chunks,
+    // the first on the calling thread, and return the sum of their results.
+    // The first failure is rethrown once every shard has finished.
+    template <typename Shard>
+    size_t forEachShard(size_t num_chunks, Shard shard) {
+        if (num_chunks == 0) return 0;
+
+        std::vector<size_t> bounds(devices.size() + 1, 0);
+        double cumulative = 0;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            cumulative += shares[i];
+            bounds[i + 1] = (i + 1 == devices.size()) ? num_chunks
+                          : std::min(num_chunks, static_cast<size_t>(cumulative * num_chunks + 0.5));
+        }
+
+        std::vector<size_t> results(devices.size(), 0);
+        std::vector<std::exception_ptr> failures(devices.size());
+        auto run = [&](size_t i) {
+            try {
+                if (bounds[i + 1] > bounds[i]) {
+                    results[i] = shard(*devices[i], bounds[i], bounds[i + 1] - bounds[i]);
+                }
+            } catch (...) {
+                failures[i] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < devices.size(); ++i) {
+            threads.emplace_back(run, i);
+        }
+        run(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        size_t total = 0;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            if (failures[i]) std::rethrow_exception(failures[i]);
+            total += results[i];
+        }
+        return total;
+    }
+
+    std::vector<std::unique_ptr<ParallelDNAStorage>> devices;
+    std::vector<double> shares;
+};
+
+// Work a HybridDNAScheduler runs: encode data, a whole number of 11 base
+// chunks, or decode data, 15 base strands back to back, with their 4 ECC
+// symbols each in ecc
+enum class DNAJobKind { encode, decode };
+
+struct DNAJob {
+    DNAJobKind kind = DNAJobKind::encode;
+    std::string data;
+    std::vector<uint8_t> ecc;
+};
+
+// Outcome of a DNAJob: output holds the strands and ecc their ECC symbols
+// for an encode job, or output the decoded data bases with a status per
+// chunk and the count of chunks that needed correcting for a decode job
+struct DNAJobResult {
+    std::string output;
+    std::vector<uint8_t> ecc;
+    std::vector<GPUBlockStatus> status;
+    size_t dirty = 0;
+    bool on_gpu = false;
+};
+
+enum class DNAEngine { cpu, gpu };
+
+// Routes DNA batches to a pool of CPU workers or to the GPU pipelines of a
+// MultiGPUDNAStorage over every visible device, whichever is expected to finish the batch first given
+// the chunks already queued on it and its measured throughput. Throughput
+// is remeasured on every completed batch, and an engine left unused for a
+// while is handed the next batch so its estimate cannot go stale. Batches
+// routed to the CPU are split across the workers; batches queued for the
+// GPU are coalesced per kind into one pipelined call. Without a usable
+// device everything runs on the CPU. Both engines produce the same output.
+class HybridDNAScheduler {
+public:
+    explicit HybridDNAScheduler(size_t cpu_workers = 0, bool use_gpu = true)
+        : worker_count_(cpu_workers ? cpu_workers
+                                    : std::max<unsigned int>(std::thread::hardware_concurrency(), 2) - 1) {
+        if (use_gpu) {
+            try {
+                gpu_.reset(new MultiGPUDNAStorage());
+            } catch (const std::exception&) {
+                gpu_.reset();
+            }
+        }
+
+        calibrateCpu();
+        for (size_t k = 0; k < 2; ++k) {
+            // Optimistic until measured, so the GPU gets the first large batches
+            gpu_rate_[k] = cpu_rate_[k] * worker_count_ * 8;
+            gpu_latency_[k] = 1e-4;
+        }
+
+        for (size_t i = 0; i < worker_count_; ++i) {
+            workers_.emplace_back([this] { cpuWorker(); });
+        }
+        if (gpu_) {
+            workers_.emplace_back([this] { gpuWorker(); });
+        }
+    }
+
+    ~HybridDNAScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cpu_ready_.notify_all();
+        gpu_ready_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    HybridDNAScheduler(const HybridDNAScheduler&) = delete;
+    HybridDNAScheduler& operator=(const HybridDNAScheduler&) = delete;
+
+    // Queue a batch. Invalid input throws here; the future carries the result
+    // or a failure of the engine that ran it.
+    std::future<DNAJobResult> submit(DNAJob job) {
+        size_t chunks;
+        if (job.kind == DNAJobKind::encode) {
+            if (job.data.length() % kDataLength != 0) {
+                throw std::invalid_argument("Input length must be a multiple of 11 bases");
+            }
+            if (job.data.find_first_not_of("ACGTacgt") != std::string::npos) {
+                throw std::invalid_argument("Invalid DNA base in input");
+            }
+            chunks = job.data.length() / kDataLength;
+        } else {
+            ParallelDNAStorage::validateStrands(job.data, job.ecc);
+            chunks = job.data.length() / kCodeLength;
+        }
+
+        auto state = std::make_shared<JobState>();
+        state->job = std::move(job);
+        state->chunks = chunks;
+        std::future<DNAJobResult> future = state->promise.get_future();
+
+        if (chunks == 0) {
+            state->promise.set_value(DNAJobResult());
+            return future;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (route(state->job.kind, chunks) == DNAEngine::gpu) {
+            gpu_queued_ += chunks;
+            gpu_queue_.push_back(state);
+            lock.unlock();
+            gpu_ready_.notify_one();
+        } else {
+            prepareCpuOutput(*state);
+            const size_t pieces = (chunks + kCpuPieceChunks - 1) / kCpuPieceChunks;
+            state->pieces_left = pieces;
+            state->start = Clock::now();
+            for (size_t p = 0; p < pieces; ++p) {
+                const size_t first = p * kCpuPieceChunks;
+                cpu_queue_.push_back(CpuPiece{state, first, std::min(kCpuPieceChunks, chunks - first)});
+            }
+            cpu_queued_ += chunks;
+            lock.unlock();
+            cpu_ready_.notify_all();
+        }
+        return future;
+    }
+
+    // Current throughput estimate of an engine, in chunks per second (for
+    // the CPU, of all workers together)
+    double throughput(DNAEngine engine, DNAJobKind kind) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t k = static_cast<size_t>(kind);
+        return engine == DNAEngine::cpu ? cpu_rate_[k] * worker_count_ : (gpu_ ? gpu_rate_[k] : 0.0);
+    }
+
+    bool hasGpu() const { return static_cast<bool>(gpu_); }
+    size_t cpuWorkers() const { return worker_count_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Chunks a CPU worker takes at a time
+    static constexpr size_t kCpuPieceChunks = 4096;
+    // Most chunks the GPU worker coalesces into one call
+    static constexpr size_t kGpuCoalesceChunks = size_t(1) << 22;
+    // Submissions after which an unused engine is handed a batch again
+    static constexpr size_t kExploreInterval = 64;
+    // Weight of a new measurement in the throughput estimates
+    static constexpr double kSmoothing = 0.25;
+
+    struct JobState {
+        DNAJob job;
+        size_t chunks = 0;
+        DNAJobResult result;
+        std::promise<DNAJobResult> promise;
+        // CPU only: pieces still running, and the first failure
+        size_t pieces_left = 0;
+        std::exception_ptr failure;
+        Clock::time_point start;
+    };
+
+    struct CpuPiece {
+        std::shared_ptr<JobState> state;
+        size_t first;
+        size_t count;
+    };
+
+    // Pick the engine expected to finish chunks more chunks first, counting
+    // what is already queued on each; call with mutex_ held
+    DNAEngine route(DNAJobKind kind, size_t chunks) {
+        if (!gpu_) return DNAEngine::cpu;
+
+        const size_t k = static_cast<size_t>(kind);
+        ++submissions_;
+        if (submissions_ - last_use_[0] > kExploreInterval && cpu_queued_ == 0) return use(DNAEngine::cpu);
+        if (submissions_ - last_use_[1] > kExploreInterval && gpu_queued_ == 0) return use(DNAEngine::gpu);
+
+        const double worker_rate = cpu_rate_[k];
+        const size_t pieces = (chunks + kCpuPieceChunks - 1) / kCpuPieceChunks;
+        const double cpu_eta = std::max((cpu_queued_ + chunks) / (worker_rate * worker_count_),
+                                        chunks / (worker_rate * std::min(pieces, worker_count_)));
+        const double gpu_eta = gpu_latency_[k] + (gpu_queued_ + chunks) / gpu_rate_[k];
+
+        return use(cpu_eta <= gpu_eta ? DNAEngine::cpu : DNAEngine::gpu);
+    }
+
+    DNAEngine use(DNAEngine engine) {
+        last_use_[static_cast<size_t>(engine)] = submissions_;
+        return engine;
+    }
+
+    static void prepareCpuOutput(JobState& state) {
+        DNAJobResult& result = state.result;
+        if (state.job.kind == DNAJobKind::encode) {
+            result.output.assign(state.chunks * kCodeLength, 'A');
+            result.ecc.assign(state.chunks * kFecLength, 0);
+        } else {
+            result.output.assign(state.chunks * kDataLength, 'A');
+            result.status.resize(state.chunks);
+        }
+    }
+
+    // Time the host codec on a small batch for the first CPU estimates
+    void calibrateCpu() {
+        const size_t chunks = 1024;
+        std::string input(chunks * kDataLength, 'A');
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = "ACGT"[(i * 2654435761u >> 7) & 3];
+        }
+        std::string strands(chunks * kCodeLength, 'A');
+        std::vector<uint8_t> ecc(chunks * kFecLength);
+        std::string decoded(chunks * kDataLength, 'A');
+        std::vector<GPUBlockStatus> status(chunks);
+
+        Clock::time_point start = Clock::now();
+        encodeChunksHost(input.data(), chunks, &strands[0], ecc.data(), tables_);
+        cpu_rate_[0] = chunks / std::max(seconds(start), 1e-6);
+
+        for (size_t c = 0; c < chunks; c += 2) {
+            strands[c * kCodeLength + 3] = strands[c * kCodeLength + 3] == 'A' ? 'C' : 'A';
+        }
+        start = Clock::now();
+        decodeChunksHost(strands.data(), ecc.data(), chunks, &decoded[0], status.data(), tables_);
+        cpu_rate_[1] = chunks / std::max(seconds(start), 1e-6);
+    }
+
+    static double seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void cpuWorker() {
+        for ( ; ; ) {
+            CpuPiece piece;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cpu_ready_.wait(lock, [this] { return stopping_ || !cpu_queue_.empty(); });
+                if (cpu_queue_.empty()) return;
+                piece = std::move(cpu_queue_.front());
+                cpu_queue_.pop_front();
+            }
+
+            JobState& state = *piece.state;
+            const Clock::time_point start = Clock::now();
+            size_t dirty = 0;
+            std::exception_ptr failure;
+
+            try {
+                DNAJobResult& result = state.result;
+                if (state.job.kind == DNAJobKind::encode) {
+                    encodeChunksHost(state.job.data.data() + piece.first * kDataLength, piece.count,
+                                     &result.output[piece.first * kCodeLength],
+                                     result.ecc.data() + piece.first * kFecLength, tables_);
+                } else {
+                    dirty = decodeChunksHost(state.job.data.data() + piece.first * kCodeLength,
+                                             state.job.ecc.data() + piece.first * kFecLength, piece.count,
+                                             &result.output[piece.first * kDataLength],
+                                             result.status.data() + piece.first, tables_);
+                }
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            const double elapsed = seconds(start);
+            bool finished;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const size_t k = static_cast<size_t>(state.job.kind);
+                if (elapsed > 0) {
+                    cpu_rate_[k] += kSmoothing * (piece.count / elapsed - cpu_rate_[k]);
+                }
+                cpu_queued_ -= piece.count;
+                state.result.dirty += dirty;
+                if (failure && !state.failure) state.failure = failure;
+                finished = --state.pieces_left == 0;
+            }
+
+            if (finished) {
+                if (state.failure) {
+                    state.promise.set_exception(state.failure);
+                } else {
+                    state.promise.set_value(std::move(state.result));
+                }
+            }
+        }
+    }
+
+    void gpuWorker() {
+        for ( ; ; ) {
+            std::vector<std::shared_ptr<JobState>> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                gpu_ready_.wait(lock, [this] { return stopping_ || !gpu_queue_.empty(); });
+                if (gpu_queue_.empty()) return;
+
+                // Take the oldest batch and every queued batch of its kind that fits
+                const DNAJobKind kind = gpu_queue_.front()->job.kind;
+                size_t chunks = 0;
+                for (auto it = gpu_queue_.begin(); it != gpu_queue_.end(); ) {
+                    if ((*it)->job.kind == kind &&
+                        (batch.empty() || chunks + (*it)->chunks <= kGpuCoalesceChunks)) {
+                        chunks += (*it)->chunks;
+                        batch.push_back(std::move(*it));
+                        it = gpu_queue_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+            runOnGpu(batch);
+        }
+    }
+
+    void runOnGpu(std::vector<std::shared_ptr<JobState>>& batch) {
+        const DNAJobKind kind = batch.front()->job.kind;
+        size_t chunks = 0;
+        for (const auto& state : batch) chunks += state->chunks;
+
+        const Clock::time_point start = Clock::now();
+        try {
+            if (kind == DNAJobKind::encode) {
+                std::string input;
+                input.reserve(chunks * kDataLength);
+                for (const auto& state : batch) input += state->job.data;
+
+                std::string strands;
+                std::vector<uint8_t> ecc;
+                gpu_->encodeParallel(input, strands, ecc);
+
+                size_t first = 0;
+                for (const auto& state : batch) {
+                    DNAJobResult& result = state->result;
+                    result.output.assign(strands, first * kCodeLength, state->chunks * kCodeLength);
+                    result.ecc.assign(ecc.begin() + first * kFecLength,
+                                      ecc.begin() + (first + state->chunks) * kFecLength);
+                    first += state->chunks;
+                }
+            } else {
+                std::string strands;
+                std::vector<uint8_t> ecc;
+                strands.reserve(chunks * kCodeLength);
+                ecc.reserve(chunks * kFecLength);
+                for (const auto& state : batch) {
+                    strands += state->job.data;
+                    ecc.insert(ecc.end(), state->job.ecc.begin(), state->job.ecc.end());
+                }
+
+                std::string decoded;
+                std::vector<GPUBlockStatus> status;
+                gpu_->decodeParallel(strands, ecc, decoded, status);
+
+                size_t first = 0;
+                for (const auto& state : batch) {
+                    DNAJobResult& result = state->result;
+                    result.output.assign(decoded, first * kDataLength, state->chunks * kDataLength);
+                    result.status.assign(status.begin() + first, status.begin() + first + state->chunks);
+                    result.dirty = 0;
+                    for (const GPUBlockStatus& s : result.status) {
+                        if (s.errors_detected || s.unrecoverable) ++result.dirty;
+                    }
+                    first += state->chunks;
+                }
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                gpu_queued_ -= chunks;
+            }
+            for (const auto& state : batch) {
+                state->promise.set_exception(std::current_exception());
+            }
+            return;
+        }
+
+        const double elapsed = seconds(start);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const size_t k = static_cast<size_t>(kind);
+            // Large calls measure the transfer and kernel rate, every call
+            // what is left of its time as the fixed launch cost
+            if (chunks >= gpu_->batchSize() && elapsed > 0) {
+                gpu_rate_[k] += kSmoothing * (chunks / elapsed - gpu_rate_[k]);
+            }
+            const double latency = std::max(elapsed - chunks / gpu_rate_[k], 0.0);
+            gpu_latency_[k] += kSmoothing * (latency - gpu_latency_[k]);
+            gpu_queued_ -= chunks;
+        }
+
+        for (const auto& state : batch) {
+            state->result.on_gpu = true;
+            state->promise.set_value(std::move(state->result));
+        }
+    }
+
+    const HostCodeTables tables_;
+    const size_t worker_count_;
+    std::unique_ptr<MultiGPUDNAStorage> gpu_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cpu_ready_;
+    std::condition_variable gpu_ready_;
+    std::deque<CpuPiece> cpu_queue_;
+    std::deque<std::shared_ptr<JobState>> gpu_queue_;
+    size_t cpu_queued_ = 0;
+    size_t gpu_queued_ = 0;
+    bool stopping_ = false;
+
+    // Per job kind (encode, decode): chunks per second of one CPU worker and
+    // of the GPU, and the GPU's fixed cost per call in seconds
+    double cpu_rate_[2] = {0, 0};
+    double gpu_rate_[2] = {0, 0};
+    double gpu_latency_[2] = {0, 0};
+    size_t submissions_ = 0;
+    size_t last_use_[2] = {0, 0};
+
+    std::vector<std::thread> workers_;
+};
+
+// GF(2^8) file coding
+//
+// The archival format of schifra::reed_solomon::file_encoder and
+// file_decoder for RS(255, 255 - FecLength) codes: every block of
+// 255 - FecLength file bytes is followed by its FecLength parity bytes, the
+// last block holding only what is left of the file (encoded zero padded).
+// ParallelRSFileCoder writes and reads it bit-exact with those classes for
+// the same field, generator polynomial and generator initial index.
+
+constexpr size_t kFileCodeLength = 255;
+
+// Codewords per thread block of the file kernels, one per thread, staged
+// through shared memory so that global memory is read and written whole
+constexpr unsigned int kFileThreads = 64;
+
+// Codewords per pipelined batch of ParallelRSFileCoder by default, about
+// 16 MB of codewords
+constexpr size_t kFileBatchBlocks = 65536;
+
+// GF(2^8) arithmetic of the file decoder, from the same field and decoder
+// parameters as decoder<255, FecLength>::decode
+struct GF256Tables {
+    unsigned char exp[512];            // alpha^i, twice over so a sum of two logs needs no reduction
+    unsigned char log[256];            // log[0] unused
+    unsigned char root_exponent[256];  // the decoder's Forney numerator scale per error location
+};
+
+__host__ __device__ inline unsigned char gf256Mul(unsigned char a, unsigned char b, const GF256Tables& gf) {
+    return (a && b) ? gf.exp[gf.log[a] + gf.log[b]] : 0;
+}
+
+__host__ __device__ inline unsigned char gf256Inv(unsigned char a, const GF256Tables& gf) {
+    return gf.exp[255 - gf.log[a]];
+}
+
+// Encoder and decoder tables of a RS(255, 255 - FecLength) code. The
+// product tables turn the encoder's and the syndromes' inner loop into one
+// lookup per symbol, as c_generator_mul does for RS(15,11).
+template <size_t FecLength>
+struct GF256FileTables {
+    GF256Tables gf;
+    unsigned char generator_mul[FecLength * 256];  // g_j * x at [j * 256 + x]
+    unsigned char syndrome_mul[FecLength * 256];   // x * alpha^(initial index + k) at [k * 256 + x]
+
+    GF256FileTables(const schifra::galois::field& field, const schifra::galois::field_polynomial& generator,
+                    unsigned int gen_initial_index) {
+        if (field.size() != kFileCodeLength) {
+            throw std::invalid_argument("File coding needs a GF(2^8) field");
+        }
+        if (generator.deg() != static_cast<int>(FecLength) || generator[FecLength].poly() != 1) {
+            throw std::invalid_argument("Generator polynomial must be monic of degree " + std::to_string(FecLength));
+        }
+
+        for (size_t i = 0; i < 512; ++i) {
+            gf.exp[i] = static_cast<unsigned char>(field.alpha(static_cast<schifra::galois::field_symbol>(i % 255)));
+        }
+        gf.log[0] = 0;
+        for (int x = 1; x < 256; ++x) {
+            gf.log[x] = static_cast<unsigned char>(field.index(x));
+        }
+        for (int i = 0; i < 256; ++i) {
+            gf.root_exponent[i] = static_cast<unsigned char>(
+                field.exp(field.alpha(static_cast<int>(kFileCodeLength) - i), 1 - static_cast<int>(gen_initial_index)));
+        }
+
+        for (size_t j = 0; j < FecLength; ++j) {
+            const schifra::galois::field_symbol root = field.alpha((gen_initial_index + j) % kFileCodeLength);
+            for (int x = 0; x < 256; ++x) {
+                generator_mul[j * 256 + x] = static_cast<unsigned char>(field.mul(generator[j].poly(), x));
+                syndrome_mul[j * 256 + x] = static_cast<unsigned char>(field.mul(x, root));
+            }
+        }
+    }
+};
+
+// rsParity for RS(255, 255 - FecLength): the remainder of data(x) *
+// x^FecLength by g(x), fec[0] the highest degree coefficient
+template <size_t FecLength>
+__host__ __device__ inline void rsParity256(const unsigned char* data, unsigned char* fec,
+                                            const unsigned char* generator_mul) {
+    unsigned char reg[FecLength] = {0};
+
+    for (size_t i = 0; i < kFileCodeLength - FecLength; ++i) {
+        const unsigned char feedback = data[i] ^ reg[0];
+#pragma unroll
+        for (size_t j = 0; j + 1 < FecLength; ++j) {
+            reg[j] = reg[j + 1] ^ generator_mul[(FecLength - 1 - j) * 256 + feedback];
+        }
+        reg[FecLength - 1] = generator_mul[feedback];
+    }
+
+    for (size_t j = 0; j < FecLength; ++j) {
+        fec[j] = reg[j];
+    }
+}
+
+// rsSyndromes for RS(255, 255 - FecLength), S_k = r(alpha^(initial index + k))
+template <size_t FecLength>
+__host__ __device__ inline bool rsSyndromes256(const unsigned char* codeword, unsigned char* syndrome,
+                                               const unsigned char* syndrome_mul) {
+    unsigned char flag = 0;
+    for (size_t k = 0; k < FecLength; ++k) {
+        const unsigned char* mul_root = syndrome_mul + k * 256;
+        unsigned char acc = 0;
+        for (size_t i = 0; i < kFileCodeLength; ++i) {
+            acc = mul_root[acc] ^ codeword[i];
+        }
+        syndrome[k] = acc;
+        flag |= acc;
+    }
+    return flag != 0;
+}
+
+// polyEval over GF(2^8)
+__host__ __device__ inline unsigned char polyEval256(const unsigned char* poly, int deg, unsigned char x,
+                                                     const GF256Tables& gf) {
+    unsigned char acc = 0;
+    for (int i = deg; i >= 0; --i) {
+        acc = gf256Mul(acc, x, gf) ^ poly[i];
+    }
+    return acc;
+}
+
+// rsCorrect for RS(255, 255 - FecLength): the steps of
+// decoder<255, FecLength>::decode without erasures, with the same
+// corrections and status
+template <size_t FecLength>
+__host__ __device__ inline void rsCorrect256(unsigned char* codeword, const unsigned char* syndrome,
+                                             const GF256Tables& gf, GPUBlockStatus& status) {
+    constexpr int kPolySize = 2 * FecLength + 2;
+
+    status.errors_detected = 0;
+    status.errors_corrected = 0;
+    status.zero_numerators = 0;
+    status.unrecoverable = false;
+    status.error = block_type::e_no_error;
+
+    // Berlekamp-Massey, lambda starting at 1 and the previous lambda at x
+    unsigned char lambda[kPolySize] = {1};
+    unsigned char previous[kPolySize] = {0, 1};
+    int lambda_deg = 0;
+    int i_mark = -1;
+    int l = 0;
+
+    for (int round = 0; round < static_cast<int>(FecLength); ++round) {
+        const int upper_bound = (l < lambda_deg) ? l : lambda_deg;
+        unsigned char discrepancy = 0;
+        for (int i = 0; i <= upper_bound && i <= round; ++i) {
+            discrepancy ^= gf256Mul(lambda[i], syndrome[round - i], gf);
+        }
+
+        if (discrepancy != 0) {
+            unsigned char tau[kPolySize];
+            for (int i = 0; i < kPolySize; ++i) {
+                tau[i] = lambda[i] ^ gf256Mul(discrepancy, previous[i], gf);
+            }
+
+            if (l < round - i_mark) {
+                const int tmp = round - i_mark;
+                i_mark = round - l;
+                l = tmp;
+                const unsigned char inverse = gf256Inv(discrepancy, gf);
+                for (int i = 0; i < kPolySize; ++i) {
+                    previous[i] = gf256Mul(lambda[i], inverse, gf);
+                }
+            }
+
+            for (int i = 0; i < kPolySize; ++i) {
+                lambda[i] = tau[i];
+            }
+            lambda_deg = polyDegree(lambda, kPolySize);
+        }
+
+        for (int i = kPolySize - 1; i > 0; --i) {
+            previous[i] = previous[i - 1];
+        }
+        previous[0] = 0;
+    }
+
+    // Chien search over alpha^1..alpha^255, stopping at deg(lambda) roots
+    int locations[kPolySize];
+    int location_count = 0;
+    for (int i = 1; i <= static_cast<int>(kFileCodeLength) && location_count < lambda_deg; ++i) {
+        if (polyEval256(lambda, lambda_deg, gf.exp[i], gf) == 0) {
+            locations[location_count++] = i;
+        }
+    }
+
+    if (location_count == 0) {
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error1;
+        return;
+    }
+    if (2 * location_count > static_cast<int>(FecLength)) {
+        status.errors_detected = location_count;
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error2;
+        return;
+    }
+    status.errors_detected = location_count;
+
+    // Forney: omega = lambda * S mod x^FecLength, magnitudes omega(X) / lambda'(X)
+    unsigned char omega[FecLength];
+    for (int k = 0; k < static_cast<int>(FecLength); ++k) {
+        unsigned char acc = 0;
+        for (int i = 0; i <= k && i <= lambda_deg; ++i) {
+            acc ^= gf256Mul(lambda[i], syndrome[k - i], gf);
+        }
+        omega[k] = acc;
+    }
+
+    unsigned char derivative[kPolySize] = {0};
+    for (int i = 0; i < lambda_deg; i += 2) {
+        derivative[i] = lambda[i + 1];
+    }
+    const int derivative_deg = polyDegree(derivative, kPolySize);
+
+    for (int i = 0; i < location_count; ++i) {
+        const int location = locations[i];
+        const unsigned char x = gf.exp[location];
+        const unsigned char numerator =
+            gf256Mul(polyEval256(omega, FecLength - 1, x, gf), gf.root_exponent[location], gf);
+        const unsigned char denominator = polyEval256(derivative, derivative_deg, x, gf);
+
+        if (numerator != 0) {
+            if (denominator != 0) {
+                codeword[location - 1] ^= gf256Mul(numerator, gf256Inv(denominator, gf), gf);
+                ++status.errors_corrected;
+            } else {
+                status.unrecoverable = true;
+                status.error = block_type::e_decoder_error3;
+                return;
+            }
+        } else {
+            ++status.zero_numerators;
+        }
+    }
+
+    if (lambda_deg != location_count) {
+        status.unrecoverable = true;
+        status.error = block_type::e_decoder_error4;
+    }
+}
+
+// Copy count runs of length bytes, back to back at source, into shared
+// memory at kFileCodeLength bytes apart, the whole block reading in turn
+__device__ inline void stageBlocks(const unsigned char* source, size_t length, unsigned int count,
+                                   unsigned char* stage) {
+    for (size_t i = threadIdx.x; i < count * length; i += blockDim.x) {
+        stage[(i / length) * kFileCodeLength + i % length] = source[i];
+    }
+}
+
+// The reverse of stageBlocks
+__device__ inline void unstageBlocks(const unsigned char* stage, size_t length, unsigned int count,
+                                     unsigned char* target) {
+    for (size_t i = threadIdx.x; i < count * length; i += blockDim.x) {
+        target[i] = stage[(i / length) * kFileCodeLength + i % length];
+    }
+}
+
+// Encode num_blocks blocks of 255 - FecLength data bytes each, back to back
+// at data, into 255 byte codewords at codewords. Launched with
+// kFileThreads threads per block, one codeword per thread.
+template <size_t FecLength>
+__global__ void encodeFileKernel(const unsigned char* data, unsigned char* codewords, size_t num_blocks,
+                                 const GF256FileTables<FecLength>* tables) {
+    constexpr size_t kData = kFileCodeLength - FecLength;
+    __shared__ unsigned char generator_mul[FecLength * 256];
+    __shared__ unsigned char stage[kFileThreads * kFileCodeLength];
+
+    const size_t first = static_cast<size_t>(blockIdx.x) * kFileThreads;
+    if (first >= num_blocks) return;
+    const unsigned int count = static_cast<unsigned int>(
+        (num_blocks - first < kFileThreads) ? num_blocks - first : kFileThreads);
+
+    for (unsigned int i = threadIdx.x; i < FecLength * 256; i += blockDim.x) {
+        generator_mul[i] = tables->generator_mul[i];
+    }
+    stageBlocks(data + first * kData, kData, count, stage);
+    __syncthreads();
+
+    if (threadIdx.x < count) {
+        unsigned char* codeword = stage + threadIdx.x * kFileCodeLength;
+        rsParity256<FecLength>(codeword, codeword + kData, generator_mul);
+    }
+    __syncthreads();
+
+    unstageBlocks(stage, kFileCodeLength, count, codewords + first * kFileCodeLength);
+}
+
+// First file decoding phase, over every codeword: compute the syndromes,
+// write the data of every codeword out and the status of the clean ones,
+// and append the dirty ones with their syndromes to a compacted list, one
+// atomic per warp as syndromeKernel does
+template <size_t FecLength>
+__global__ void fileSyndromeKernel(const unsigned char* codewords, size_t num_blocks, unsigned char* decoded,
+                                   GPUBlockStatus* status, unsigned int* dirty_blocks,
+                                   unsigned char* dirty_syndromes, unsigned int* dirty_count,
+                                   const GF256FileTables<FecLength>* tables) {
+    constexpr size_t kData = kFileCodeLength - FecLength;
+    __shared__ unsigned char syndrome_mul[FecLength * 256];
+    __shared__ unsigned char stage[kFileThreads * kFileCodeLength];
+
+    const size_t first = static_cast<size_t>(blockIdx.x) * kFileThreads;
+    if (first >= num_blocks) return;
+    const unsigned int count = static_cast<unsigned int>(
+        (num_blocks - first < kFileThreads) ? num_blocks - first : kFileThreads);
+
+    for (unsigned int i = threadIdx.x; i < FecLength * 256; i += blockDim.x) {
+        syndrome_mul[i] = tables->syndrome_mul[i];
+    }
+    stageBlocks(codewords + first * kFileCodeLength, kFileCodeLength, count, stage);
+    __syncthreads();
+
+    const size_t idx = first + threadIdx.x;
+    unsigned char syndrome[FecLength];
+    bool dirty = false;
+
+    if (threadIdx.x < count) {
+        dirty = rsSyndromes256<FecLength>(stage + threadIdx.x * kFileCodeLength, syndrome, syndrome_mul);
+        if (!dirty) {
+            status[idx] = GPUBlockStatus{0, 0, 0, false, block_type::e_no_error};
+        }
+    }
+    unstageBlocks(stage, kData, count, decoded + first * kData);
+
+    const unsigned int lane = threadIdx.x & 31;
+    const unsigned int dirty_mask = __ballot_sync(0xffffffffu, dirty);
+    if (dirty_mask == 0) return;
+
+    unsigned int base = 0;
+    if (lane == static_cast<unsigned int>(__ffs(dirty_mask) - 1)) {
+        base = atomicAdd(dirty_count, static_cast<unsigned int>(__popc(dirty_mask)));
+    }
+    base = __shfl_sync(0xffffffffu, base, __ffs(dirty_mask) - 1);
+
+    if (dirty) {
+        const unsigned int slot = base + __popc(dirty_mask & ((1u << lane) - 1));
+        dirty_blocks[slot] = static_cast<unsigned int>(idx);
+        for (size_t k = 0; k < FecLength; ++k) {
+            dirty_syndromes[slot * FecLength + k] = syndrome[k];
+        }
+    }
+}
+
+// Second file decoding phase, over the compacted dirty codewords only, as
+// correctKernel: Berlekamp-Massey, Chien and Forney on the GF(2^8) tables
+// staged in shared memory, then the data and status of the codeword
+template <size_t FecLength>
+__global__ void fileCorrectKernel(const unsigned char* codewords, const unsigned int* dirty_blocks,
+                                  const unsigned char* dirty_syndromes, const unsigned int* dirty_count,
+                                  unsigned char* decoded, GPUBlockStatus* status,
+                                  const GF256FileTables<FecLength>* tables) {
+    constexpr size_t kData = kFileCodeLength - FecLength;
+    const unsigned int num_dirty = *dirty_count;
+    if (blockIdx.x * blockDim.x >= num_dirty) return;
+
+    __shared__ GF256Tables gf;
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(&tables->gf);
+    unsigned char* target = reinterpret_cast<unsigned char*>(&gf);
+    for (unsigned int i = threadIdx.x; i < sizeof(GF256Tables); i += blockDim.x) {
+        target[i] = source[i];
+    }
+    __syncthreads();
+
+    const unsigned int slot = blockIdx.x * blockDim.x + threadIdx.x;
+    if (slot >= num_dirty) return;
+
+    const size_t idx = dirty_blocks[slot];
+    unsigned char codeword[kFileCodeLength];
+    unsigned char syndrome[FecLength];
+    for (size_t i = 0; i < kFileCodeLength; ++i) {
+        codeword[i] = codewords[idx * kFileCodeLength + i];
+    }
+    for (size_t k = 0; k < FecLength; ++k) {
+        syndrome[k] = dirty_syndromes[slot * FecLength + k];
+    }
+
+    GPUBlockStatus result;
+    rsCorrect256<FecLength>(codeword, syndrome, gf, result);
+
+    for (size_t i = 0; i < kData; ++i) {
+        decoded[idx * kData + i] = codeword[i];
+    }
+    status[idx] = result;
+}
+
+// Outcome of a ParallelRSFileCoder file pass: the blocks coded and, when
+// decoding, those that had non-zero syndromes and those of them that could
+// not be corrected
+struct GPUFileStats {
+    size_t blocks;
+    size_t dirty_blocks;
+    size_t failed_blocks;
+};
+
+// Pinned host staging and device buffers of one ParallelRSFileCoder
+// pipeline stage, on its own stream, kept across calls and only ever grown
+struct FileSlot {
+    cudaStream_t stream = nullptr;
+    size_t capacity = 0;  // blocks
+
+    // Pinned host staging: data to encode or codewords to decode in, and
+    // codewords or decoded data out
+    unsigned char* h_in = nullptr;
+    unsigned char* h_out = nullptr;
+    GPUBlockStatus* h_status = nullptr;
+    unsigned int* h_dirty_count = nullptr;
+
+    // Device buffers
+    unsigned char* d_in = nullptr;
+    unsigned char* d_out = nullptr;
+    GPUBlockStatus* d_status = nullptr;
+    unsigned int* d_dirty_blocks = nullptr;
+    unsigned char* d_dirty_syndromes = nullptr;
+    unsigned int* d_dirty_count = nullptr;
+
+    // Batch in flight: its first block and block count
+    size_t first = 0;
+    size_t count = 0;
+    bool busy = false;
+};
+
+// RS(255, 255 - FecLength) file and block coding on a CUDA device, eg:
+// the RS(255,223) of encoder<255,32> and file_encoder<255,32>.
+//
+// Encoding runs one codeword per thread through the generator product
+// table in shared memory. Decoding is syndrome first: every codeword's
+// syndromes are computed and its data written out, and only the codewords
+// with errors go through a second kernel for Berlekamp-Massey, Chien and
+// Forney. Batches stream through kPipelineDepth pinned slots as those of
+// ParallelDNAStorage do; encodeFile() and decodeFile() read the file
+// straight into the pinned staging and write it out of it, so reading,
+// transfers, kernels and writing of consecutive batches overlap.
+template <size_t FecLength>
+class ParallelRSFileCoder {
+public:
+    static_assert(FecLength > 0 && FecLength <= 64, "File coding supports 1 to 64 parity symbols");
+
+    static constexpr size_t code_length = kFileCodeLength;
+    static constexpr size_t fec_length = FecLength;
+    static constexpr size_t data_length = kFileCodeLength - FecLength;
+
+    // The code of field (GF(2^8)), the monic generator polynomial of degree
+    // FecLength and gen_initial_index, as given to encoder<255, FecLength>
+    // and decoder<255, FecLength>, on CUDA device device_id
+    ParallelRSFileCoder(const schifra::galois::field& field, const schifra::galois::field_polynomial& generator,
+                        unsigned int gen_initial_index, int device_id = 0)
+        : device(device_id), batch_size(kFileBatchBlocks) {
+        const GF256FileTables<FecLength> tables(field, generator, gen_initial_index);
+
+        selectDevice();
+        checkCuda(cudaMalloc(&d_tables, sizeof(tables)), "cudaMalloc");
+        checkCuda(cudaMemcpy(d_tables, &tables, sizeof(tables), cudaMemcpyHostToDevice), "cudaMemcpy");
+
+        for (FileSlot& slot : slots) {
+            checkCuda(cudaStreamCreateWithFlags(&slot.stream, cudaStreamNonBlocking), "cudaStreamCreate");
+        }
+    }
+
+    ~ParallelRSFileCoder() {
+        cudaSetDevice(device);
+        for (FileSlot& slot : slots) {
+            if (slot.stream) cudaStreamSynchronize(slot.stream);
+            freeSlotBuffers(slot);
+            if (slot.stream) cudaStreamDestroy(slot.stream);
+        }
+        cudaFree(d_tables);
+    }
+
+    ParallelRSFileCoder(const ParallelRSFileCoder&) = delete;
+    ParallelRSFileCoder& operator=(const ParallelRSFileCoder&) = delete;
+
+    // Codewords per pipelined batch
+    void setBatchSize(size_t blocks) { batch_size = std::max<size_t>(blocks, 1); }
+    size_t batchSize() const { return batch_size; }
+
+    int deviceId() const { return device; }
+
+    // Encode num_blocks blocks of data_length bytes, back to back at data,
+    // into num_blocks codewords of 255 bytes at codewords, data then parity
+    // as encoder<255, FecLength>::encode leaves a block
+    void encodeBlocks(const uint8_t* data, size_t num_blocks, uint8_t* codewords) {
+        if (num_blocks == 0) return;
+        selectDevice();
+
+        runSlotPipeline(slots, num_blocks, batch_size,
+            [&](FileSlot& slot) {
+                reserveSlot(slot, slot.count);
+                std::copy(data + slot.first * data_length, data + (slot.first + slot.count) * data_length,
+                          slot.h_in);
+                queueEncode(slot);
+            },
+            [&](const FileSlot& slot) {
+                std::copy(slot.h_out, slot.h_out + slot.count * code_length, codewords + slot.first * code_length);
+            });
+    }
+
+    // Decode num_blocks codewords of 255 bytes at codewords into their
+    // data_length data bytes each at data, and the state a block is left
+    // in by decoder<255, FecLength>::decode at status. Where that fails the
+    // data is as the decoder left it. Returns the number of codewords that
+    // had non-zero syndromes.
+    size_t decodeBlocks(const uint8_t* codewords, size_t num_blocks, uint8_t* data, GPUBlockStatus* status) {
+        if (num_blocks == 0) return 0;
+        selectDevice();
+        size_t dirty = 0;
+
+        runSlotPipeline(slots, num_blocks, batch_size,
+            [&](FileSlot& slot) {
+                reserveSlot(slot, slot.count);
+                std::copy(codewords + slot.first * code_length,
+                          codewords + (slot.first + slot.count) * code_length, slot.h_in);
+                queueDecode(slot);
+            },
+            [&](const FileSlot& slot) {
+                std::copy(slot.h_out, slot.h_out + slot.count * data_length, data + slot.first * data_length);
+                std::copy(slot.h_status, slot.h_status + slot.count, status + slot.first);
+                dirty += *slot.h_dirty_count;
+            });
+
+        return dirty;
+    }
+
+    // Encode input_path into output_path in the format of file_encoder
+    GPUFileStats encodeFile(const std::string& input_path, const std::string& output_path) {
+        std::ifstream input;
+        std::ofstream output;
+        const size_t size = openFiles(input_path, output_path, input, output);
+        const size_t num_blocks = (size + data_length - 1) / data_length;
+        selectDevice();
+
+        runSlotPipeline(slots, num_blocks, batch_size,
+            [&](FileSlot& slot) {
+                reserveSlot(slot, slot.count);
+                const size_t bytes = std::min(slot.count * data_length, size - slot.first * data_length);
+                readInput(input, slot.h_in, bytes, input_path);
+                std::fill(slot.h_in + bytes, slot.h_in + slot.count * data_length, static_cast<unsigned char>(0));
+                queueEncode(slot);
+            },
+            [&](const FileSlot& slot) {
+                const size_t bytes = std::min(slot.count * data_length, size - slot.first * data_length);
+                const size_t whole = bytes / data_length;
+                writeOutput(output, slot.h_out, whole * code_length, output_path);
+
+                // The last block of the file, short of data
+                if (whole < slot.count) {
+                    const unsigned char* codeword = slot.h_out + whole * code_length;
+                    writeOutput(output, codeword, bytes - whole * data_length, output_path);
+                    writeOutput(output, codeword + data_length, fec_length, output_path);
+                }
+            });
+
+        return GPUFileStats{num_blocks, 0, 0};
+    }
+
+    // Decode input_path, written by file_encoder or encodeFile, into
+    // output_path as file_decoder does. The data of a block that cannot be
+    // corrected is written as the decoder left it rather than dropped, and
+    // counted in the stats' failed_blocks.
+    GPUFileStats decodeFile(const std::string& input_path, const std::string& output_path) {
+        std::ifstream input;
+        std::ofstream output;
+        const size_t size = openFiles(input_path, output_path, input, output);
+        const size_t tail = size % code_length;
+        if (tail != 0 && tail <= fec_length) {
+            throw std::invalid_argument("Input file ends in a block of " + std::to_string(tail) +
+                                        " bytes, no longer than its parity");
+        }
+        const size_t num_blocks = size / code_length + (tail ? 1 : 0);
+        selectDevice();
+        GPUFileStats stats{num_blocks, 0, 0};
+
+        runSlotPipeline(slots, num_blocks, batch_size,
+            [&](FileSlot& slot) {
+                reserveSlot(slot, slot.count);
+                const size_t bytes = std::min(slot.count * code_length, size - slot.first * code_length);
+                readInput(input, slot.h_in, bytes, input_path);
+
+                // The last block of the file: data zero padded, parity moved to the end
+                if (bytes < slot.count * code_length) {
+                    unsigned char* codeword = slot.h_in + (slot.count - 1) * code_length;
+                    const size_t data_bytes = bytes - (slot.count - 1) * code_length - fec_length;
+                    std::memmove(codeword + data_length, codeword + data_bytes, fec_length);
+                    std::fill(codeword + data_bytes, codeword + data_length, static_cast<unsigned char>(0));
+                }
+                queueDecode(slot);
+            },
+            [&](const FileSlot& slot) {
+                const size_t bytes = std::min(slot.count * code_length, size - slot.first * code_length);
+                const size_t short_bytes = slot.count * code_length - bytes;
+                writeOutput(output, slot.h_out, slot.count * data_length - short_bytes, output_path);
+
+                stats.dirty_blocks += *slot.h_dirty_count;
+                for (size_t i = 0; i < slot.count; ++i) {
+                    if (slot.h_status[i].unrecoverable) ++stats.failed_blocks;
+                }
+            });
+
+        return stats;
+    }
+
+private:
+    void selectDevice() const {
+        checkCuda(cudaSetDevice(device), "cudaSetDevice");
+    }
+
+    // Open both files, returning the size of the input
+    static size_t openFiles(const std::string& input_path, const std::string& output_path,
+                            std::ifstream& input, std::ofstream& output) {
+        input.open(input_path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("Cannot open input file: " + input_path);
+        }
+        output.open(output_path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::runtime_error("Cannot open output file: " + output_path);
+        }
+
+        input.seekg(0, std::ios::end);
+        const size_t size = static_cast<size_t>(input.tellg());
+        input.seekg(0, std::ios::beg);
+        return size;
+    }
+
+    static void readInput(std::ifstream& input, unsigned char* target, size_t bytes, const std::string& path) {
+        if (!input.read(reinterpret_cast<char*>(target), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("Failed reading input file: " + path);
+        }
+    }
+
+    static void writeOutput(std::ofstream& output, const unsigned char* source, size_t bytes, const std::string& path) {
+        if (!output.write(reinterpret_cast<const char*>(source), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("Failed writing output file: " + path);
+        }
+    }
+
+    static void freeSlotBuffers(FileSlot& slot) {
+        cudaFreeHost(slot.h_in);
+        cudaFreeHost(slot.h_out);
+        cudaFreeHost(slot.h_status);
+        cudaFreeHost(slot.h_dirty_count);
+        cudaFree(slot.d_in);
+        cudaFree(slot.d_out);
+        cudaFree(slot.d_status);
+        cudaFree(slot.d_dirty_blocks);
+        cudaFree(slot.d_dirty_syndromes);
+        cudaFree(slot.d_dirty_count);
+
+        const cudaStream_t stream = slot.stream;
+        slot = FileSlot();
+        slot.stream = stream;
+    }
+
+    // Grow the buffers of a slot to hold num_blocks codewords
+    static void reserveSlot(FileSlot& slot, size_t num_blocks) {
+        if (slot.capacity >= num_blocks) return;
+
+        freeSlotBuffers(slot);
+
+        const size_t bytes = num_blocks * code_length;
+        checkCuda(cudaMallocHost(&slot.h_in, bytes), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_out, bytes), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_status, num_blocks * sizeof(GPUBlockStatus)), "cudaMallocHost");
+        checkCuda(cudaMallocHost(&slot.h_dirty_count, sizeof(unsigned int)), "cudaMallocHost");
+        checkCuda(cudaMalloc(&slot.d_in, bytes), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_out, bytes), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_status, num_blocks * sizeof(GPUBlockStatus)), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_blocks, num_blocks * sizeof(unsigned int)), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_syndromes, num_blocks * fec_length), "cudaMalloc");
+        checkCuda(cudaMalloc(&slot.d_dirty_count, sizeof(unsigned int)), "cudaMalloc");
+        slot.capacity = num_blocks;
+    }
+
+    // Queue the encoding of the slot's data blocks in h_in into codewords in h_out
+    void queueEncode(FileSlot& slot) {
+        const dim3 blockDim(kFileThreads);
+        const dim3 gridDim((slot.count + kFileThreads - 1) / kFileThreads);
+
+        checkCuda(cudaMemcpyAsync(slot.d_in, slot.h_in, slot.count * data_length,
+                                  cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+        encodeFileKernel<FecLength><<<gridDim, blockDim, 0, slot.stream>>>(slot.d_in, slot.d_out, slot.count,
+                                                                          d_tables);
+        checkCuda(cudaGetLastError(), "encodeFileKernel");
+        checkCuda(cudaMemcpyAsync(slot.h_out, slot.d_out, slot.count * code_length,
+                                  cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+    }
+
+    // Queue the decoding of the slot's codewords in h_in into data in h_out,
+    // statuses in h_status and the dirty codeword count in h_dirty_count
+    void queueDecode(FileSlot& slot) {
+        const dim3 blockDim(kFileThreads);
+        const dim3 gridDim((slot.count + kFileThreads - 1) / kFileThreads);
+
+        checkCuda(cudaMemsetAsync(slot.d_dirty_count, 0, sizeof(unsigned int), slot.stream), "cudaMemsetAsync");
+        checkCuda(cudaMemcpyAsync(slot.d_in, slot.h_in, slot.count * code_length,
+                                  cudaMemcpyHostToDevice, slot.stream), "cudaMemcpyAsync");
+        fileSyndromeKernel<FecLength><<<gridDim, blockDim, 0, slot.stream>>>(
+            slot.d_in, slot.count, slot.d_out, slot.d_status, slot.d_dirty_blocks, slot.d_dirty_syndromes,
+            slot.d_dirty_count, d_tables);
+        checkCuda(cudaGetLastError(), "fileSyndromeKernel");
+        fileCorrectKernel<FecLength><<<gridDim, blockDim, 0, slot.stream>>>(
+            slot.d_in, slot.d_dirty_blocks, slot.d_dirty_syndromes, slot.d_dirty_count, slot.d_out,
+            slot.d_status, d_tables);
+        checkCuda(cudaGetLastError(), "fileCorrectKernel");
+        checkCuda(cudaMemcpyAsync(slot.h_out, slot.d_out, slot.count * data_length,
+                                  cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+        checkCuda(cudaMemcpyAsync(slot.h_status, slot.d_status, slot.count * sizeof(GPUBlockStatus),
+                                  cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+        checkCuda(cudaMemcpyAsync(slot.h_dirty_count, slot.d_dirty_count, sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync");
+    }
+
+    int device;
+    size_t batch_size;
+    GF256FileTables<FecLength>* d_tables = nullptr;
+    FileSlot slots[kPipelineDepth];
+};
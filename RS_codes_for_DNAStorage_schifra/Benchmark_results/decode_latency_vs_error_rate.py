@@ -0,0 +1,34 @@
+
+import csv
+import sys
+
+import matplotlib.pyplot as plt
+
+# CSV written by: parallel_sequence_benchmark --sweep [--csv=file]
+csv_file = sys.argv[1] if len(sys.argv) > 1 else 'decode_latency_vs_error_rate.csv'
+
+latency = {}
+with open(csv_file) as f:
+    for row in csv.DictReader(f):
+        if int(row['blocks']) == 0:
+            continue
+        series = latency.setdefault(row['class'], {'rate': [], 'p50': [], 'p99': [], 'p999': []})
+        series['rate'].append(float(row['error_rate']))
+        series['p50'].append(float(row['p50_ns']))
+        series['p99'].append(float(row['p99_ns']))
+        series['p999'].append(float(row['p999_ns']))
+
+fig, axes = plt.subplots(1, 3, figsize=(15, 5), sharey=True)
+
+for ax, percentile in zip(axes, ['p50', 'p99', 'p999']):
+    for latency_class, series in latency.items():
+        ax.plot(series['rate'], series[percentile], marker='o', label=latency_class)
+    ax.set_xscale('symlog', linthresh=0.001)
+    ax.set_xlabel('Error Injection Rate (per base)')
+    ax.set_title(percentile + ' Decode Latency')
+    ax.grid(True, linestyle='--', alpha=0.7)
+
+axes[0].set_ylabel('Latency (ns)')
+axes[0].legend()
+plt.tight_layout()
+plt.show()
@@ -0,0 +1,90 @@
+"""
+Runs the workload of schifra_compare through the pure Python Reed-Solomon
+implementation of RS_codes_main, so it can be reported alongside the
+Schifra engines.
+
+    python3 rs_codes_main_compare.py <workload file> <RS_codes_main directory>
+
+The workload file, written by schifra_compare, holds a "blocks n k" header
+and then one line per block: the k data symbols (bases as 0..3), a '|', and
+the k data symbols as received, ie: with the errors of the block. Each
+block is encoded over GF(2^4), its data replaced by the received symbols,
+and decoded. One line of totals and per block latencies, in nanoseconds,
+is printed:
+
+    blocks=.. encode_ns=.. decode_ns=.. encode_p50=.. encode_p99=..
+    decode_p50=.. decode_p99=.. failures=..
+
+A block counts as a failure when the decoder raises or returns data other
+than the block as encoded.
+"""
+
+import sys
+import time
+
+
+def percentile(samples, p):
+    if not samples:
+        return 0
+    index = min(len(samples) - 1, int(len(samples) * p / 100.0))
+    return samples[index]
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: rs_codes_main_compare.py <workload file> <RS_codes_main directory>\n")
+        return 1
+
+    sys.path.insert(0, sys.argv[2])
+    import RS_codes as rs
+
+    with open(sys.argv[1]) as f:
+        blocks, n, k = (int(v) for v in f.readline().split())
+        workload = []
+        for _ in range(blocks):
+            data, received = f.readline().split('|')
+            workload.append(([int(v) for v in data.split()], [int(v) for v in received.split()]))
+
+    # GF(2^4) over x^4 + x + 1, as the DNA codecs of Schifra
+    rs.init_tables(prim=0x13, generator=2, c_exp=4)
+    nsym = n - k
+    gen = rs.rs_generator_poly(nsym)
+
+    clock = time.perf_counter_ns
+    encode_times = []
+    decode_times = []
+    codewords = []
+
+    for data, _ in workload:
+        start = clock()
+        codeword = rs.rs_encode_msg(data, nsym, gen=gen)
+        encode_times.append(clock() - start)
+        codewords.append(codeword)
+
+    failures = 0
+    for (data, received), codeword in zip(workload, codewords):
+        message = received + codeword[k:]
+        start = clock()
+        try:
+            corrected, _ = rs.rs_correct_msg(message, nsym)
+        except rs.ReedSolomonError:
+            corrected = None
+        decode_times.append(clock() - start)
+        if corrected != data:
+            failures += 1
+
+    encode_ns = sum(encode_times)
+    decode_ns = sum(decode_times)
+    encode_times.sort()
+    decode_times.sort()
+
+    print("blocks=%d encode_ns=%d decode_ns=%d encode_p50=%d encode_p99=%d decode_p50=%d decode_p99=%d failures=%d" %
+          (blocks, encode_ns, decode_ns,
+           percentile(encode_times, 50), percentile(encode_times, 99),
+           percentile(decode_times, 50), percentile(decode_times, 99),
+           failures))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
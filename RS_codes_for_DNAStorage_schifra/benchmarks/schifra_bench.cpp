@@ -0,0 +1,1177 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Microbenchmarks of the individual kernels: field arithmetic,
+                region multiply-add (per backend), the RS(255,223) LFSR
+                and compile time encoders, the syndrome, Berlekamp-Massey,
+                Chien search and Forney stages of the decoder, full and
+                batch decodes, the block interleaver, the CRC-32 variants
+                and the in-band DNA strand codecs over GF(2^4), GF(2^6)
+                and GF(2^8).
+
+                Each benchmark is warmed up, calibrated to an iteration
+                count filling the sample time, then sampled repeatedly.
+                The per operation min, median, mean and standard deviation
+                are printed, and optionally written as JSON or CSV. With
+                --perf (or SCHIFRA_PERF_COUNTERS=1) the hardware counters
+                of the sampled runs are reported too, as cycles per byte,
+                IPC and L1d/LLC/branch misses per operation, and with
+                --energy (or SCHIFRA_ENERGY=1) the RAPL package and DRAM
+                energy as joules per MB, or per operation for benchmarks
+                without a byte count:
+
+                schifra_bench [--filter=substring] [--repetitions=n]
+                              [--sample-time=ms] [--warmup=ms] [--perf]
+                              [--energy]
+                              [--json=file] [--csv=file] [--list]
+                              [--store=directory] [--baseline=file]
+                              [--threshold=percent] [--alpha=p]
+
+                The JSON is tagged with the host, revision, region backend
+                and cpu features, and holds the samples of every
+                benchmark. --store keeps it in a directory of runs as
+                <host>_<revision>_<time>.json. --baseline compares the run
+                with a stored one (see schifra_bench_store.hpp): a median
+                more than --threshold percent (default 5) slower, with a
+                Mann-Whitney p-value below --alpha (default 0.01), is a
+                regression, and any regression exits with status 2. Two
+                stored runs are compared without running anything by:
+
+                schifra_bench --compare=baseline.json,current.json
+
+                With --tune the executor and pipeline settings of
+                RS(255,223) are tuned for the host instead, and stored in
+                the tuning file (see schifra_reed_solomon_tuning.hpp).
+
+                schifra_bench --tune
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "schifra/dna_storage.hpp"
+#include "schifra/dna_storage_gf2m.hpp"
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_autotuner.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_fixed_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_interleaving.hpp"
+#include "schifra/utils/schifra_cpu_features.hpp"
+#include "schifra/utils/schifra_batch_arena.hpp"
+#include "schifra/utils/schifra_crc.hpp"
+#include "schifra/utils/schifra_energy_meter.hpp"
+#include "schifra/utils/schifra_perf_counters.hpp"
+
+#include "schifra_bench_store.hpp"
+
+#ifndef SCHIFRA_BENCH_REVISION
+#define SCHIFRA_BENCH_REVISION "unknown"
+#endif
+
+
+namespace bench
+{
+   typedef std::chrono::steady_clock clock_type;
+   typedef schifra::utils::perf_counters perf_counters;
+   typedef schifra::utils::energy_meter  energy_meter;
+
+   template <typename T>
+   inline void do_not_optimize(const T& value)
+   {
+      #if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : "r,m"(value) : "memory");
+      #else
+      static volatile T sink;
+      sink = value;
+      #endif
+   }
+
+   struct options
+   {
+      options()
+      : repetitions(15),
+        sample_time_ms(10.0),
+        warmup_ms(50.0),
+        list_only(false),
+        tune(false),
+        perf(perf_counters::requested()),
+        energy(energy_meter::requested()),
+        threshold(0.05),
+        alpha(0.01)
+      {}
+
+      std::string filter;
+      std::size_t repetitions;
+      double      sample_time_ms;
+      double      warmup_ms;
+      std::string json_file;
+      std::string csv_file;
+      bool        list_only;
+      bool        tune;
+      bool        perf;
+      bool        energy;
+      std::string store_dir;
+      std::string baseline_file;
+      std::string compare_files;
+      double      threshold;
+      double      alpha;
+   };
+
+   struct result
+   {
+      std::string name;
+      std::size_t bytes;
+      std::size_t iterations;
+      std::size_t repetitions;
+      double      min_ns;
+      double      median_ns;
+      double      mean_ns;
+      double      stddev_ns;
+      double      max_ns;
+
+      /* Per operation time of each repetition, ascending */
+      std::vector<double> samples_ns;
+
+      /* Counters summed over all sampled operations */
+      perf_counters::reading perf;
+      double                 operations;
+
+      /* Package-wide energy over all sampled operations */
+      energy_meter::reading  energy;
+
+      /* Throughput at the median, zero for benchmarks without a byte count */
+      inline double mbps() const
+      {
+         return (0 == bytes || 0.0 == median_ns) ? 0.0 : (bytes / median_ns) * 1000.0;
+      }
+
+      inline double per_op(const perf_counters::event_t event) const
+      {
+         return perf.per(event, operations);
+      }
+
+      /* Cycles per byte, or per operation for benchmarks without a byte count */
+      inline double cycles_per_unit() const
+      {
+         return perf.per(perf_counters::e_cycles, operations * ((0 == bytes) ? 1 : bytes));
+      }
+
+      /* Joules per MB, or per operation for benchmarks without a byte count */
+      inline double joules_per_unit() const
+      {
+         return energy.per(operations * ((0 == bytes) ? 1.0 : bytes / 1.0e6));
+      }
+   };
+
+   /* op() is one operation, bytes the amount of data it processes */
+   struct benchmark
+   {
+      std::string           name;
+      std::size_t           bytes;
+      std::function<void()> op;
+   };
+
+   inline double run_batch(const benchmark& b, const std::size_t iterations)
+   {
+      const clock_type::time_point start = clock_type::now();
+
+      for (std::size_t i = 0; i < iterations; ++i)
+      {
+         b.op();
+      }
+
+      return std::chrono::duration<double,std::nano>(clock_type::now() - start).count();
+   }
+
+   inline result measure(const benchmark& b, const options& opt, perf_counters* counters, energy_meter* meter)
+   {
+      /* Warmup: caches, branch predictors, lazily built tables, cpu clocks */
+      const clock_type::time_point warmup_end = clock_type::now() +
+                                                std::chrono::duration_cast<clock_type::duration>(
+                                                   std::chrono::duration<double,std::milli>(opt.warmup_ms));
+      do
+      {
+         b.op();
+      }
+      while (clock_type::now() < warmup_end);
+
+      /* Calibration: double the batch until it fills the sample time */
+      const double sample_ns  = opt.sample_time_ms * 1.0e6;
+      std::size_t  iterations = 1;
+
+      while ((run_batch(b, iterations) < sample_ns) && (iterations < (std::size_t(1) << 40)))
+      {
+         iterations <<= 1;
+      }
+
+      std::vector<double> samples(opt.repetitions);
+
+      if (counters)
+      {
+         counters->reset();
+         counters->start();
+      }
+
+      if (meter)
+      {
+         meter->reset();
+         meter->start();
+      }
+
+      for (std::size_t r = 0; r < opt.repetitions; ++r)
+      {
+         samples[r] = run_batch(b, iterations) / iterations;
+      }
+
+      if (meter)
+         meter->stop();
+
+      if (counters)
+         counters->stop();
+
+      std::sort(samples.begin(), samples.end());
+
+      result res;
+
+      res.name        = b.name;
+      res.bytes       = b.bytes;
+      res.iterations  = iterations;
+      res.repetitions = opt.repetitions;
+      res.min_ns      = samples.front();
+      res.max_ns      = samples.back();
+      res.median_ns   = (samples.size() & 1) ? samples[samples.size() / 2] :
+                                               (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0;
+      res.mean_ns     = 0.0;
+
+      for (std::size_t r = 0; r < samples.size(); ++r)
+      {
+         res.mean_ns += samples[r];
+      }
+
+      res.mean_ns /= samples.size();
+
+      double variance = 0.0;
+
+      for (std::size_t r = 0; r < samples.size(); ++r)
+      {
+         variance += (samples[r] - res.mean_ns) * (samples[r] - res.mean_ns);
+      }
+
+      res.stddev_ns = (samples.size() > 1) ? std::sqrt(variance / (samples.size() - 1)) : 0.0;
+
+      res.samples_ns = samples;
+      res.operations = static_cast<double>(iterations) * opt.repetitions;
+
+      if (counters)
+         res.perf = counters->totals();
+
+      if (meter)
+         res.energy = meter->totals();
+
+      return res;
+   }
+
+   inline std::string json_escape(const std::string& s)
+   {
+      std::string out;
+
+      for (std::size_t i = 0; i < s.size(); ++i)
+      {
+         if (('"' == s[i]) || ('\\' == s[i]))
+            out += '\\';
+
+         out += s[i];
+      }
+
+      return out;
+   }
+
+   inline std::string cpu_description()
+   {
+      const schifra::utils::cpu_features& cpu = schifra::utils::host_cpu_features();
+
+      std::string s;
+
+      if (cpu.ssse3   ) s += "ssse3 ";
+      if (cpu.sse42   ) s += "sse4.2 ";
+      if (cpu.pclmul  ) s += "pclmul ";
+      if (cpu.avx2    ) s += "avx2 ";
+      if (cpu.avx512bw) s += "avx512bw ";
+      if (cpu.gfni    ) s += "gfni ";
+      if (cpu.vpclmul ) s += "vpclmul ";
+      if (cpu.neon    ) s += "neon ";
+      if (cpu.pmull   ) s += "pmull ";
+      if (cpu.crc32   ) s += "crc32 ";
+      if (cpu.sve     ) s += "sve ";
+      if (cpu.sve2    ) s += "sve2 ";
+
+      if (!s.empty())
+         s.erase(s.size() - 1);
+
+      return s;
+   }
+
+   /* The run as the result store holds it */
+   inline store::run stored_run(const std::vector<result>& results)
+   {
+      store::run run;
+
+      run.revision       = SCHIFRA_BENCH_REVISION;
+      run.host           = store::host_name();
+      run.timestamp      = store::timestamp();
+      run.cpu_features   = cpu_description();
+      run.region_backend = schifra::galois::region::backend_name(schifra::galois::region::best_backend());
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         store::entry e;
+
+         e.name       = results[i].name;
+         e.median_ns  = results[i].median_ns;
+         e.samples_ns = results[i].samples_ns;
+
+         run.entries.push_back(e);
+      }
+
+      return run;
+   }
+
+   inline bool write_json(const std::string& file_name, const std::vector<result>& results, const store::run& run)
+   {
+      std::ofstream out(file_name.c_str());
+
+      out << std::setprecision(6) << std::fixed;
+      out << "{\n";
+      out << "  \"context\": {\n";
+      out << "    \"revision\": \""       << json_escape(run.revision)       << "\",\n";
+      out << "    \"host\": \""           << json_escape(run.host)           << "\",\n";
+      out << "    \"timestamp\": \""      << run.timestamp                   << "\",\n";
+      out << "    \"cpu_features\": \""   << run.cpu_features                << "\",\n";
+      out << "    \"region_backend\": \"" << json_escape(run.region_backend) << "\"\n";
+      out << "  },\n";
+      out << "  \"benchmarks\": [\n";
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const result& r = results[i];
+
+         out << "    {"
+             << "\"name\": \""       << json_escape(r.name) << "\", "
+             << "\"bytes\": "        << r.bytes       << ", "
+             << "\"iterations\": "   << r.iterations  << ", "
+             << "\"repetitions\": "  << r.repetitions << ", "
+             << "\"min_ns\": "       << r.min_ns      << ", "
+             << "\"median_ns\": "    << r.median_ns   << ", "
+             << "\"mean_ns\": "      << r.mean_ns     << ", "
+             << "\"stddev_ns\": "    << r.stddev_ns   << ", "
+             << "\"max_ns\": "       << r.max_ns      << ", "
+             << "\"mbps\": "         << r.mbps() << ", "
+             << "\"samples_ns\": [";
+
+         for (std::size_t s = 0; s < r.samples_ns.size(); ++s)
+         {
+            out << ((0 == s) ? "" : ", ") << r.samples_ns[s];
+         }
+
+         out << "]";
+
+         if (r.perf.any())
+         {
+            const char* const names[perf_counters::e_event_count] =
+                                 { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+            for (std::size_t e = 0; e < perf_counters::e_event_count; ++e)
+            {
+               if (r.perf.valid[e])
+                  out << ", \"" << names[e] << "_per_op\": " << r.per_op(static_cast<perf_counters::event_t>(e));
+            }
+
+            if (r.perf.valid[perf_counters::e_cycles] && (0 != r.bytes))
+               out << ", \"cycles_per_byte\": " << r.cycles_per_unit();
+
+            if (r.perf.valid[perf_counters::e_cycles] && r.perf.valid[perf_counters::e_instructions])
+               out << ", \"ipc\": " << r.perf.ipc();
+         }
+
+         if (r.energy.any())
+         {
+            out << ", \"" << ((0 != r.bytes) ? "joules_per_mb" : "joules_per_op") << "\": " << r.joules_per_unit()
+                << ", \"package_joules\": " << r.energy.joules[energy_meter::e_package]
+                << ", \"dram_joules\": "    << r.energy.joules[energy_meter::e_dram];
+         }
+
+         out << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+      }
+
+      out << "  ]\n";
+      out << "}\n";
+
+      return static_cast<bool>(out);
+   }
+
+   inline void write_csv(const std::string& file_name, const std::vector<result>& results)
+   {
+      std::ofstream out(file_name.c_str());
+
+      out << std::setprecision(6) << std::fixed;
+      out << "revision,name,bytes,iterations,repetitions,min_ns,median_ns,mean_ns,stddev_ns,max_ns,mbps,"
+             "cycles_per_byte,ipc,l1d_misses_per_op,llc_misses_per_op,branch_misses_per_op,joules_per_mb\n";
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const result& r = results[i];
+
+         out << SCHIFRA_BENCH_REVISION << ","
+             << r.name        << ","
+             << r.bytes       << ","
+             << r.iterations  << ","
+             << r.repetitions << ","
+             << r.min_ns      << ","
+             << r.median_ns   << ","
+             << r.mean_ns     << ","
+             << r.stddev_ns   << ","
+             << r.max_ns      << ","
+             << r.mbps()      << ",";
+
+         /* Note: Counters that were not collected are left empty */
+         if (r.perf.valid[perf_counters::e_cycles] && (0 != r.bytes)) out << r.cycles_per_unit();
+         out << ",";
+         if (r.perf.valid[perf_counters::e_cycles] && r.perf.valid[perf_counters::e_instructions]) out << r.perf.ipc();
+         out << ",";
+         if (r.perf.valid[perf_counters::e_l1d_misses   ]) out << r.per_op(perf_counters::e_l1d_misses   );
+         out << ",";
+         if (r.perf.valid[perf_counters::e_llc_misses   ]) out << r.per_op(perf_counters::e_llc_misses   );
+         out << ",";
+         if (r.perf.valid[perf_counters::e_branch_misses]) out << r.per_op(perf_counters::e_branch_misses);
+         out << ",";
+         if (r.energy.any() && (0 != r.bytes)) out << r.joules_per_unit();
+         out << "\n";
+      }
+   }
+
+   inline void print(const result& r)
+   {
+      std::cout << std::left  << std::setw(40) << r.name
+                << std::right << std::setw(12) << std::fixed << std::setprecision(1) << r.median_ns
+                << std::setw(12) << r.min_ns
+                << std::setw(9)  << std::setprecision(2) << ((0.0 == r.mean_ns) ? 0.0 : 100.0 * r.stddev_ns / r.mean_ns) << "%"
+                << std::setw(12) << std::setprecision(1) << r.mbps();
+
+      if (r.perf.any())
+      {
+         std::cout << std::setw(10) << std::setprecision(2) << r.cycles_per_unit()
+                   << std::setw(7)  << r.perf.ipc()
+                   << std::setw(10) << r.per_op(perf_counters::e_l1d_misses)
+                   << std::setw(10) << r.per_op(perf_counters::e_llc_misses)
+                   << std::setw(10) << r.per_op(perf_counters::e_branch_misses);
+      }
+
+      if (r.energy.any())
+      {
+         std::cout << std::setw(12) << std::setprecision(6) << r.joules_per_unit()
+                   << ((0 != r.bytes) ? " J/MB" : " J/op");
+      }
+
+      std::cout << std::endl;
+   }
+
+} // namespace bench
+
+
+namespace
+{
+   const std::size_t code_length = 255;
+   const std::size_t fec_length  =  32;
+   const std::size_t data_length = code_length - fec_length;
+
+   const std::size_t generator_polynomial_index = 120;
+
+   typedef schifra::reed_solomon::encoder<code_length,fec_length,data_length> encoder_t;
+   typedef schifra::reed_solomon::fixed_code<code_length,fec_length>::encoder_type fixed_encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length,data_length> decoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length,data_length,schifra::galois::field_symbol,
+                                          schifra::reed_solomon::euclidean_solver> euclidean_decoder_t;
+   typedef decoder_t::block_type block_t;
+
+   /*
+      The decoding stages are protected members of the decoder, the probe
+      exposes each of them so they can be timed in isolation.
+   */
+   class decoder_probe : public decoder_t
+   {
+   public:
+
+      decoder_probe(const schifra::galois::field& field, const unsigned int gen_initial_index)
+      : decoder_t(field, gen_initial_index)
+      {}
+
+      inline int syndrome(const block_t& rsblock, received_polynomial& received, syndrome_polynomial& syndrome) const
+      {
+         load_message(received, rsblock);
+         return compute_syndrome(received, syndrome);
+      }
+
+      inline void berlekamp_massey(locator_polynomial& lambda, const syndrome_polynomial& syndrome) const
+      {
+         modified_berlekamp_massey_algorithm(lambda, syndrome, 0);
+      }
+
+      inline void euclidean(locator_polynomial& lambda, const syndrome_polynomial& syndrome) const
+      {
+         euclidean_algorithm(lambda, syndrome, 0);
+      }
+
+      inline void chien(const locator_polynomial& lambda, std::vector<int>& roots) const
+      {
+         find_roots(lambda, roots);
+      }
+
+      inline bool forney(const std::vector<int>& roots, const locator_polynomial& lambda,
+                         const syndrome_polynomial& syndrome, block_t& rsblock) const
+      {
+         return forney_algorithm(roots, lambda, syndrome, rsblock);
+      }
+   };
+
+   struct block_stack
+   {
+      block_t rows[code_length];
+   };
+
+   /*
+      In-band strand encode and decode of a 64Ki base sequence through
+      Storage::encode_strands()/decode_strands(), decoding clean strands
+      and strands with one base error each.
+   */
+   template <typename Storage>
+   void add_strand_benchmarks(std::vector<bench::benchmark>& list, const std::string& name, std::mt19937& rng)
+   {
+      typedef typename Storage::sequence_buffer buffer_t;
+
+      const std::size_t length = 64 * 1024;
+      const char        bases[] = "ACGT";
+
+      std::shared_ptr<const Storage> storage(new Storage);
+      std::shared_ptr<std::string>   sequence(new std::string(length, 'A'));
+
+      for (std::size_t i = 0; i < length; ++i)
+      {
+         (*sequence)[i] = bases[rng() & 3];
+      }
+
+      std::shared_ptr<buffer_t> encoded(new buffer_t);
+      storage->encode_strands(*sequence, *encoded);
+
+      std::shared_ptr<std::string> clean  (new std::string(encoded->dna));
+      std::shared_ptr<std::string> corrupt(new std::string(encoded->dna));
+
+      for (std::size_t i = 0; i < corrupt->size(); i += Storage::strand_length())
+      {
+         char& base = (*corrupt)[i + (rng() % Storage::strand_length())];
+         base = (base == 'A') ? 'C' : 'A';
+      }
+
+      std::shared_ptr<buffer_t> output(new buffer_t);
+
+      bench::benchmark encode = { "dna/" + name + "/encode_strands", length,
+                                  [storage, sequence, output]()
+                                  {
+                                     bench::do_not_optimize(storage->encode_strands(*sequence, *output));
+                                  } };
+
+      bench::benchmark decode_clean = { "dna/" + name + "/decode_strands_clean", length,
+                                        [storage, clean, output]()
+                                        {
+                                           bench::do_not_optimize(storage->decode_strands(*clean, length, *output));
+                                        } };
+
+      bench::benchmark decode_errors = { "dna/" + name + "/decode_strands_1_error", length,
+                                         [storage, corrupt, output]()
+                                         {
+                                            bench::do_not_optimize(storage->decode_strands(*corrupt, length, *output));
+                                         } };
+
+      list.push_back(encode);
+      list.push_back(decode_clean);
+      list.push_back(decode_errors);
+   }
+
+   /*
+      encode_batch() of 4096 sequences, results on the heap and, reset
+      every batch, in a batch_arena.
+   */
+   void add_batch_arena_benchmarks(std::vector<bench::benchmark>& list, std::mt19937& rng)
+   {
+      typedef schifra::dna_storage<15,4,11> storage_t;
+
+      const std::size_t count   = 4096;
+      const char        bases[] = "ACGT";
+
+      std::shared_ptr<const storage_t> storage(new storage_t);
+      std::shared_ptr<std::vector<std::string> > sequences(new std::vector<std::string>(count, std::string(storage_t::data_length(), 'A')));
+
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         for (std::size_t j = 0; j < storage_t::data_length(); ++j)
+         {
+            (*sequences)[i][j] = bases[rng() & 3];
+         }
+      }
+
+      std::shared_ptr<schifra::utils::batch_arena> arena(new schifra::utils::batch_arena);
+
+      bench::benchmark heap = { "dna/gf16_rs15_11/encode_batch_4096", count * storage_t::data_length(),
+                                [storage, sequences]()
+                                {
+                                   bench::do_not_optimize(storage->encode_batch(*sequences).size());
+                                } };
+
+      bench::benchmark arena_batch = { "dna/gf16_rs15_11/encode_batch_4096_arena", count * storage_t::data_length(),
+                                       [storage, sequences, arena]()
+                                       {
+                                          {
+                                             std::pmr::vector<std::pmr::string> batch(sequences->begin(), sequences->end(), arena.get());
+                                             bench::do_not_optimize(storage->encode_batch(batch).size());
+                                          }
+                                          arena->reset();
+                                       } };
+
+      list.push_back(heap);
+      list.push_back(arena_batch);
+   }
+
+   std::vector<bench::benchmark> create_benchmarks(const schifra::galois::field& field,
+                                                   const encoder_t& encoder,
+                                                   const decoder_probe& decoder)
+   {
+      std::vector<bench::benchmark> list;
+
+      std::mt19937 rng(0x5C41F7A);
+
+      /* Field arithmetic over 4096 operand pairs */
+      {
+         std::shared_ptr<std::vector<schifra::galois::field_symbol> > a(new std::vector<schifra::galois::field_symbol>(4096));
+         std::shared_ptr<std::vector<schifra::galois::field_symbol> > b(new std::vector<schifra::galois::field_symbol>(4096));
+
+         for (std::size_t i = 0; i < a->size(); ++i)
+         {
+            (*a)[i] = rng() & 0xFF;
+            (*b)[i] = 1 + (rng() % 255);
+         }
+
+         bench::benchmark mul = { "field/mul/4096", a->size(),
+                                  [&field, a, b]()
+                                  {
+                                     schifra::galois::field_symbol acc = 0;
+
+                                     for (std::size_t i = 0; i < a->size(); ++i)
+                                     {
+                                        acc ^= field.mul((*a)[i], (*b)[i]);
+                                     }
+
+                                     bench::do_not_optimize(acc);
+                                  } };
+
+         bench::benchmark div = { "field/div/4096", a->size(),
+                                  [&field, a, b]()
+                                  {
+                                     schifra::galois::field_symbol acc = 0;
+
+                                     for (std::size_t i = 0; i < a->size(); ++i)
+                                     {
+                                        acc ^= field.div((*a)[i], (*b)[i]);
+                                     }
+
+                                     bench::do_not_optimize(acc);
+                                  } };
+
+         list.push_back(mul);
+         list.push_back(div);
+      }
+
+      /* Region multiply-add over 64KiB, once per backend the cpu supports */
+      {
+         namespace region = schifra::galois::region;
+
+         const std::size_t length = 64 * 1024;
+
+         std::shared_ptr<std::vector<std::uint8_t> > src(new std::vector<std::uint8_t>(length));
+         std::shared_ptr<std::vector<std::uint8_t> > dst(new std::vector<std::uint8_t>(length));
+
+         for (std::size_t i = 0; i < length; ++i)
+         {
+            (*src)[i] = static_cast<std::uint8_t>(rng());
+         }
+
+         std::shared_ptr<region::multiplier> m(new region::multiplier(region::make_multiplier(field, 0x8E)));
+
+         const region::backend_t backends[] = { region::e_scalar, region::e_ssse3, region::e_avx2, region::e_avx512,
+                                                region::e_gfni_avx2, region::e_gfni_avx512, region::e_neon, region::e_sve };
+
+         for (std::size_t i = 0; i < sizeof(backends) / sizeof(region::backend_t); ++i)
+         {
+            const region::backend_t backend = backends[i];
+
+            if (!region::backend_supported(backend))
+               continue;
+
+            bench::benchmark b = { std::string("region/mul_add/") + region::backend_name(backend), length,
+                                   [backend, m, src, dst]()
+                                   {
+                                      region::force_backend(backend);
+                                      region::mul_add(*m, src->data(), dst->data(), src->size());
+                                      bench::do_not_optimize(dst->data());
+                                   } };
+
+            list.push_back(b);
+         }
+      }
+
+      /* RS(255,223) encoder and decoder stages, decoding 16 symbol errors */
+      {
+         std::shared_ptr<block_t> clean(new block_t);
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            clean->data[i] = rng() & 0xFF;
+         }
+
+         encoder.encode(*clean);
+
+         std::shared_ptr<block_t> corrupt(new block_t(*clean));
+
+         for (std::size_t i = 0; i < fec_length / 2; ++i)
+         {
+            corrupt->data[(i * 13) % code_length] ^= 1 + (rng() % 255);
+         }
+
+         std::shared_ptr<decoder_t::received_polynomial> received(new decoder_t::received_polynomial(field));
+         std::shared_ptr<decoder_t::syndrome_polynomial> syndrome(new decoder_t::syndrome_polynomial(field));
+         std::shared_ptr<decoder_t::locator_polynomial>  lambda  (new decoder_t::locator_polynomial (field, schifra::galois::field_symbol(1)));
+         std::shared_ptr<std::vector<int> >              roots   (new std::vector<int>);
+
+         decoder.syndrome(*corrupt, *received, *syndrome);
+         decoder.berlekamp_massey(*lambda, *syndrome);
+         decoder.chien(*lambda, *roots);
+
+         bench::benchmark encode = { "rs255_223/lfsr_encode", data_length,
+                                     [&encoder, clean]()
+                                     {
+                                        encoder.encode(*clean);
+                                        bench::do_not_optimize(clean->data[code_length - 1]);
+                                     } };
+
+         std::shared_ptr<const fixed_encoder_t> fixed(new fixed_encoder_t);
+
+         bench::benchmark fixed_encode = { "rs255_223/fixed_encode", data_length,
+                                           [fixed, clean]()
+                                           {
+                                              fixed->encode(*clean);
+                                              bench::do_not_optimize(clean->data[code_length - 1]);
+                                           } };
+
+         bench::benchmark synd = { "rs255_223/syndrome", code_length,
+                                   [&decoder, corrupt]()
+                                   {
+                                      decoder_t::received_polynomial r(decoder.field());
+                                      decoder_t::syndrome_polynomial s(decoder.field());
+                                      bench::do_not_optimize(decoder.syndrome(*corrupt, r, s));
+                                   } };
+
+         bench::benchmark bm = { "rs255_223/berlekamp_massey", 0,
+                                 [&decoder, syndrome]()
+                                 {
+                                    decoder_t::locator_polynomial l(decoder.field(), schifra::galois::field_symbol(1));
+                                    decoder.berlekamp_massey(l, *syndrome);
+                                    bench::do_not_optimize(l[0]);
+                                 } };
+
+         bench::benchmark euclid = { "rs255_223/euclidean", 0,
+                                     [&decoder, syndrome]()
+                                     {
+                                        decoder_t::locator_polynomial l(decoder.field(), schifra::galois::field_symbol(1));
+                                        decoder.euclidean(l, *syndrome);
+                                        bench::do_not_optimize(l[0]);
+                                     } };
+
+         std::shared_ptr<std::vector<int> > scratch(new std::vector<int>);
+
+         bench::benchmark chien = { "rs255_223/chien", 0,
+                                    [&decoder, lambda, scratch]()
+                                    {
+                                       decoder.chien(*lambda, *scratch);
+                                       bench::do_not_optimize(scratch->size());
+                                    } };
+
+         /* Note: Each call flips the corrections in and out of the block */
+         std::shared_ptr<block_t> target(new block_t(*corrupt));
+
+         bench::benchmark forney = { "rs255_223/forney", 0,
+                                     [&decoder, roots, lambda, syndrome, target]()
+                                     {
+                                        decoder.forney(*roots, *lambda, *syndrome, *target);
+                                        bench::do_not_optimize(target->data[0]);
+                                     } };
+
+         bench::benchmark decode = { "rs255_223/decode_16_errors", code_length,
+                                     [&decoder, corrupt]()
+                                     {
+                                        block_t b(*corrupt);
+                                        bench::do_not_optimize(decoder.decode(b));
+                                     } };
+
+         std::shared_ptr<const euclidean_decoder_t> euclidean_decoder(new euclidean_decoder_t(field, generator_polynomial_index));
+
+         bench::benchmark decode_euclid = { "rs255_223/decode_16_errors_euclidean", code_length,
+                                            [euclidean_decoder, corrupt]()
+                                            {
+                                               block_t b(*corrupt);
+                                               bench::do_not_optimize(euclidean_decoder->decode(b));
+                                            } };
+
+         std::shared_ptr<std::vector<block_t> > batch(new std::vector<block_t>(64, *clean));
+
+         bench::benchmark decode_batch = { "rs255_223/decode_batch_clean_64", 64 * code_length,
+                                           [&decoder, batch]()
+                                           {
+                                              bench::do_not_optimize(decoder.decode_batch(batch->data(), batch->size()));
+                                           } };
+
+         list.push_back(encode);
+         list.push_back(fixed_encode);
+         list.push_back(synd);
+         list.push_back(bm);
+         list.push_back(euclid);
+         list.push_back(chien);
+         list.push_back(forney);
+         list.push_back(decode);
+         list.push_back(decode_euclid);
+         list.push_back(decode_batch);
+      }
+
+      /* Full stack interleave of 255 RS(255,223) blocks */
+      {
+         std::shared_ptr<block_stack> stack(new block_stack);
+
+         for (std::size_t r = 0; r < code_length; ++r)
+         {
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               stack->rows[r].data[i] = rng() & 0xFF;
+            }
+         }
+
+         bench::benchmark interleave = { "interleave/255x255", code_length * code_length,
+                                         [stack]()
+                                         {
+                                            schifra::reed_solomon::interleave<code_length,fec_length>(stack->rows);
+                                            bench::do_not_optimize(stack->rows[0].data[0]);
+                                         } };
+
+         list.push_back(interleave);
+      }
+
+      /* CRC-32 over 1MiB */
+      {
+         typedef schifra::crc32 crc32;
+
+         const std::size_t length = 1024 * 1024;
+
+         std::shared_ptr<std::vector<unsigned char> > data(new std::vector<unsigned char>(length));
+
+         for (std::size_t i = 0; i < length; ++i)
+         {
+            (*data)[i] = static_cast<unsigned char>(rng());
+         }
+
+         const struct { const char* name; crc32::crc32_t key; crc32::slicing_mode mode; } variants[] =
+                  {
+                     { "crc32/zlib/slice_by_1"   , crc32::zlib_key  , crc32::e_slice_by_1  },
+                     { "crc32/zlib/slice_by_16"  , crc32::zlib_key  , crc32::e_slice_by_16 },
+                     { "crc32/zlib/hardware"     , crc32::zlib_key  , crc32::e_hardware    },
+                     { "crc32/crc32c/hardware"   , crc32::crc32c_key, crc32::e_hardware    }
+                  };
+
+         for (std::size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); ++i)
+         {
+            std::shared_ptr<crc32> crc(new crc32(variants[i].key, 0xFFFFFFFF, variants[i].mode));
+
+            bench::benchmark b = { variants[i].name, length,
+                                   [crc, data]()
+                                   {
+                                      bench::do_not_optimize(crc->process(0xFFFFFFFF, data->data(), data->size()));
+                                   } };
+
+            list.push_back(b);
+         }
+      }
+
+      /* In-band strands, 2/3/4 bases per symbol */
+      add_strand_benchmarks<schifra::dna_storage<15,4,11> >        (list, "gf16_rs15_11"  , rng);
+      add_strand_benchmarks<schifra::dna_storage_gf64<63,12> >    (list, "gf64_rs63_51"  , rng);
+      add_strand_benchmarks<schifra::dna_storage_gf256<255,32> >  (list, "gf256_rs255_223", rng);
+
+      /* Batch results on the heap and in an arena */
+      add_batch_arena_benchmarks(list, rng);
+
+      return list;
+   }
+
+   bool parse_options(int argc, char* argv[], bench::options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg(argv[i]);
+         const std::size_t eq    = arg.find('=');
+         const std::string key   = arg.substr(0, eq);
+         const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+         if      ("--filter"      == key) opt.filter         = value;
+         else if ("--repetitions" == key) opt.repetitions    = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--sample-time" == key) opt.sample_time_ms = std::atof(value.c_str());
+         else if ("--warmup"      == key) opt.warmup_ms      = std::atof(value.c_str());
+         else if ("--json"        == key) opt.json_file      = value;
+         else if ("--csv"         == key) opt.csv_file       = value;
+         else if ("--list"        == key) opt.list_only      = true;
+         else if ("--perf"        == key) opt.perf           = true;
+         else if ("--energy"      == key) opt.energy         = true;
+         else if ("--tune"        == key) opt.tune           = true;
+         else if ("--store"       == key) opt.store_dir      = value;
+         else if ("--baseline"    == key) opt.baseline_file  = value;
+         else if ("--compare"     == key) opt.compare_files  = value;
+         else if ("--threshold"   == key) opt.threshold      = std::max(0.0, std::atof(value.c_str()) / 100.0);
+         else if ("--alpha"       == key) opt.alpha          = std::atof(value.c_str());
+         else
+         {
+            std::cout << "schifra_bench - Error: unknown option " << arg << std::endl;
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+   bench::options opt;
+
+   if (!parse_options(argc, argv, opt))
+      return 1;
+
+   /* Two stored runs, nothing measured */
+   if (!opt.compare_files.empty())
+   {
+      const std::size_t comma = opt.compare_files.find(',');
+
+      bench::store::run baseline;
+      bench::store::run current;
+
+      if (
+           (std::string::npos == comma) ||
+           !bench::store::load(opt.compare_files.substr(0, comma), baseline) ||
+           !bench::store::load(opt.compare_files.substr(comma + 1), current)
+         )
+      {
+         std::cout << "schifra_bench - Error: --compare needs two readable result files." << std::endl;
+         return 1;
+      }
+
+      const std::vector<bench::store::comparison> comparisons = bench::store::compare(baseline, current, opt.threshold, opt.alpha);
+
+      return (0 == bench::store::report(baseline, current, comparisons)) ? 0 : 2;
+   }
+
+   const schifra::galois::field field(8,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            generator_polynomial_index,
+                                                            fec_length,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   if (opt.tune)
+   {
+      schifra::reed_solomon::autotuner<code_length,fec_length> tuner(field, generator_polynomial, generator_polynomial_index);
+
+      const schifra::reed_solomon::tuning::profile settings = tuner.tune();
+
+      std::cout << "threads: "     << settings.threads
+                << "  grain: "     << settings.grain
+                << "  buffer: "    << settings.buffer_size
+                << "  executor: "  << std::fixed << std::setprecision(1) << (tuner.executor_rate() / 1000000.0) << " MB/s"
+                << "  pipeline: "  << (tuner.pipeline_rate() / 1000000.0) << " MB/s" << std::endl;
+
+      if (!schifra::reed_solomon::tuning::save(schifra::reed_solomon::tuning::profile_path(), code_length, fec_length, settings))
+      {
+         std::cout << "schifra_bench - Error: tuning file could not be written." << std::endl;
+         return 1;
+      }
+
+      return 0;
+   }
+
+   const encoder_t     encoder(field, generator_polynomial);
+   const decoder_probe decoder(field, generator_polynomial_index);
+
+   const std::vector<bench::benchmark> list = create_benchmarks(field, encoder, decoder);
+
+   std::vector<bench::result> results;
+
+   /* Counters of the main thread, which runs every benchmark */
+   std::unique_ptr<bench::perf_counters> counters;
+
+   if (opt.perf && !opt.list_only)
+   {
+      counters.reset(new bench::perf_counters);
+
+      if (!counters->available())
+      {
+         std::cout << "schifra_bench - Warning: hardware performance counters are unavailable." << std::endl;
+         counters.reset();
+      }
+   }
+
+   /* RAPL counts whole packages, the other threads of the host included */
+   std::unique_ptr<bench::energy_meter> meter;
+
+   if (opt.energy && !opt.list_only)
+   {
+      meter.reset(new bench::energy_meter);
+
+      if (!meter->available())
+      {
+         std::cout << "schifra_bench - Warning: RAPL energy counters are unavailable." << std::endl;
+         meter.reset();
+      }
+   }
+
+   if (!opt.list_only)
+   {
+      std::cout << "revision: " << SCHIFRA_BENCH_REVISION << "  cpu: " << bench::cpu_description() << std::endl;
+      std::cout << std::left  << std::setw(40) << "benchmark"
+                << std::right << std::setw(12) << "median(ns)"
+                << std::setw(12) << "min(ns)"
+                << std::setw(10) << "cv"
+                << std::setw(12) << "MB/s";
+
+      if (counters)
+      {
+         std::cout << std::setw(10) << "cyc/B"
+                   << std::setw(7)  << "IPC"
+                   << std::setw(10) << "L1d/op"
+                   << std::setw(10) << "LLC/op"
+                   << std::setw(10) << "brmis/op";
+      }
+
+      if (meter)
+         std::cout << std::setw(12) << "energy";
+
+      std::cout << std::endl;
+   }
+
+   for (std::size_t i = 0; i < list.size(); ++i)
+   {
+      if (!opt.filter.empty() && (std::string::npos == list[i].name.find(opt.filter)))
+         continue;
+
+      if (opt.list_only)
+      {
+         std::cout << list[i].name << std::endl;
+         continue;
+      }
+
+      results.push_back(bench::measure(list[i], opt, counters.get(), meter.get()));
+      bench::print(results.back());
+   }
+
+   schifra::galois::region::dispatcher::instance().reset();
+
+   if (opt.list_only)
+      return 0;
+
+   const bench::store::run current = bench::stored_run(results);
+
+   if (!opt.json_file.empty())
+      bench::write_json(opt.json_file, results, current);
+
+   if (!opt.csv_file.empty())
+      bench::write_csv(opt.csv_file, results);
+
+   if (!opt.store_dir.empty())
+   {
+      const std::string file_name = bench::store::path(opt.store_dir, current);
+
+      if (!bench::write_json(file_name, results, current))
+         std::cout << "schifra_bench - Error: " << file_name << " could not be written." << std::endl;
+      else
+         std::cout << "stored: " << file_name << std::endl;
+   }
+
+   if (!opt.baseline_file.empty())
+   {
+      bench::store::run baseline;
+
+      if (!bench::store::load(opt.baseline_file, baseline))
+      {
+         std::cout << "schifra_bench - Error: baseline " << opt.baseline_file << " could not be read." << std::endl;
+         return 1;
+      }
+
+      const std::vector<bench::store::comparison> comparisons = bench::store::compare(baseline, current, opt.threshold, opt.alpha);
+
+      if (0 != bench::store::report(baseline, current, comparisons))
+         return 2;
+   }
+
+   return 0;
+}
@@ -0,0 +1,621 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Result store of schifra_bench. A run is kept as the JSON
+                file of --json, tagged with the host, revision, region
+                backend and cpu features, and holding the per repetition
+                samples of every benchmark. Two runs are compared
+                benchmark by benchmark with the Mann-Whitney U test on
+                their samples: a benchmark regressed when its median is
+                more than threshold slower and the difference is
+                significant at alpha.
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_BENCH_STORE_HPP
+#define INCLUDE_SCHIFRA_BENCH_STORE_HPP
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+namespace bench
+{
+
+   namespace store
+   {
+
+      /* One benchmark of a stored run */
+      struct entry
+      {
+         std::string         name;
+         double              median_ns;
+         std::vector<double> samples_ns;
+      };
+
+      /* A stored run and what it was recorded on */
+      struct run
+      {
+         std::string        revision;
+         std::string        host;
+         std::string        timestamp;
+         std::string        cpu_features;
+         std::string        region_backend;
+         std::vector<entry> entries;
+      };
+
+      inline std::string host_name()
+      {
+         #if defined(__unix__) || defined(__APPLE__)
+         char name[256] = { 0 };
+
+         if ((0 == ::gethostname(name, sizeof(name) - 1)) && (0 != name[0]))
+            return name;
+         #endif
+
+         const char* env = std::getenv("COMPUTERNAME");
+
+         return env ? env : "unknown";
+      }
+
+      /* Now, as ISO 8601 UTC */
+      inline std::string timestamp()
+      {
+         const std::time_t now = std::time(0);
+
+         std::tm utc;
+
+         #if defined(_WIN32)
+         gmtime_s(&utc, &now);
+         #else
+         gmtime_r(&now, &utc);
+         #endif
+
+         char buffer[32];
+
+         std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+         return buffer;
+      }
+
+      /* File of a run in the store directory: <host>_<revision>_<time>.json */
+      inline std::string path(const std::string& directory, const run& r)
+      {
+         std::string name = r.host + "_" + r.revision + "_" + r.timestamp + ".json";
+
+         for (std::size_t i = 0; i < name.size(); ++i)
+         {
+            if ((':' == name[i]) || ('/' == name[i]) || ('\\' == name[i]) || (' ' == name[i]))
+               name[i] = '-';
+         }
+
+         return directory.empty() ? name : (directory + "/" + name);
+      }
+
+      /*
+         Reader of the JSON written by schifra_bench: objects, arrays,
+         strings (with \" and \\ escapes), numbers, true/false/null.
+         Only the fields of a run are kept, everything else is skipped.
+      */
+      class reader
+      {
+      public:
+
+         explicit reader(const std::string& text)
+         : text_(text),
+           pos_(0)
+         {}
+
+         bool parse(run& r)
+         {
+            skip_space();
+
+            if (!expect('{'))
+               return false;
+
+            return parse_members([&](const std::string& key)
+                                 {
+                                    if ("context" == key)
+                                       return parse_context(r);
+                                    else if ("benchmarks" == key)
+                                       return parse_benchmarks(r);
+                                    else
+                                       return skip_value();
+                                 });
+         }
+
+      private:
+
+         template <typename Member>
+         bool parse_members(const Member& member)
+         {
+            skip_space();
+
+            if (peek('}'))
+            {
+               ++pos_;
+               return true;
+            }
+
+            for ( ; ; )
+            {
+               std::string key;
+
+               skip_space();
+
+               if (!parse_string(key) || !expect(':') || !member(key))
+                  return false;
+
+               skip_space();
+
+               if (peek(','))
+               {
+                  ++pos_;
+                  continue;
+               }
+
+               return expect('}');
+            }
+         }
+
+         template <typename Element>
+         bool parse_elements(const Element& element)
+         {
+            skip_space();
+
+            if (!expect('['))
+               return false;
+
+            skip_space();
+
+            if (peek(']'))
+            {
+               ++pos_;
+               return true;
+            }
+
+            for ( ; ; )
+            {
+               skip_space();
+
+               if (!element())
+                  return false;
+
+               skip_space();
+
+               if (peek(','))
+               {
+                  ++pos_;
+                  continue;
+               }
+
+               return expect(']');
+            }
+         }
+
+         bool parse_context(run& r)
+         {
+            skip_space();
+
+            if (!expect('{'))
+               return false;
+
+            return parse_members([&](const std::string& key)
+                                 {
+                                    skip_space();
+
+                                    if      ("revision"       == key) return parse_string(r.revision      );
+                                    else if ("host"           == key) return parse_string(r.host          );
+                                    else if ("timestamp"      == key) return parse_string(r.timestamp     );
+                                    else if ("cpu_features"   == key) return parse_string(r.cpu_features  );
+                                    else if ("region_backend" == key) return parse_string(r.region_backend);
+                                    else                              return skip_value();
+                                 });
+         }
+
+         bool parse_benchmarks(run& r)
+         {
+            return parse_elements([&]()
+                                  {
+                                     entry e;
+                                     e.median_ns = 0.0;
+
+                                     if (!expect('{'))
+                                        return false;
+
+                                     const bool parsed = parse_members([&](const std::string& key)
+                                                         {
+                                                            skip_space();
+
+                                                            if ("name" == key)
+                                                               return parse_string(e.name);
+                                                            else if ("median_ns" == key)
+                                                               return parse_number(e.median_ns);
+                                                            else if ("samples_ns" == key)
+                                                               return parse_elements([&]()
+                                                                      {
+                                                                         double v = 0.0;
+                                                                         const bool number = parse_number(v);
+                                                                         e.samples_ns.push_back(v);
+                                                                         return number;
+                                                                      });
+                                                            else
+                                                               return skip_value();
+                                                         });
+
+                                     if (parsed)
+                                        r.entries.push_back(e);
+
+                                     return parsed;
+                                  });
+         }
+
+         bool parse_string(std::string& value)
+         {
+            value.clear();
+
+            if (!expect('"'))
+               return false;
+
+            while (pos_ < text_.size())
+            {
+               const char c = text_[pos_++];
+
+               if ('"' == c)
+                  return true;
+               else if ('\\' == c)
+               {
+                  if (pos_ == text_.size())
+                     break;
+
+                  value += text_[pos_++];
+               }
+               else
+                  value += c;
+            }
+
+            return false;
+         }
+
+         bool parse_number(double& value)
+         {
+            const char* begin = text_.c_str() + pos_;
+            char*       end   = 0;
+
+            value = std::strtod(begin, &end);
+
+            if (end == begin)
+               return false;
+
+            pos_ += static_cast<std::size_t>(end - begin);
+
+            return true;
+         }
+
+         bool skip_value()
+         {
+            skip_space();
+
+            if (pos_ >= text_.size())
+               return false;
+
+            const char c = text_[pos_];
+
+            if ('{' == c)
+            {
+               ++pos_;
+               return parse_members([&](const std::string&) { return skip_value(); });
+            }
+            else if ('[' == c)
+               return parse_elements([&]() { return skip_value(); });
+            else if ('"' == c)
+            {
+               std::string ignored;
+               return parse_string(ignored);
+            }
+            else if (('t' == c) || ('f' == c) || ('n' == c))
+            {
+               while ((pos_ < text_.size()) && std::isalpha(static_cast<unsigned char>(text_[pos_])))
+                  ++pos_;
+
+               return true;
+            }
+            else
+            {
+               double ignored;
+               return parse_number(ignored);
+            }
+         }
+
+         inline void skip_space()
+         {
+            while ((pos_ < text_.size()) && std::isspace(static_cast<unsigned char>(text_[pos_])))
+               ++pos_;
+         }
+
+         inline bool peek(const char c) const
+         {
+            return (pos_ < text_.size()) && (c == text_[pos_]);
+         }
+
+         inline bool expect(const char c)
+         {
+            skip_space();
+
+            if (!peek(c))
+               return false;
+
+            ++pos_;
+
+            return true;
+         }
+
+         const std::string& text_;
+         std::size_t        pos_;
+      };
+
+      inline bool load(const std::string& file_name, run& r)
+      {
+         std::ifstream in(file_name.c_str());
+
+         if (!in)
+            return false;
+
+         const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+         r = run();
+
+         return reader(text).parse(r);
+      }
+
+      /*
+         Two sided p-value of the Mann-Whitney U test of a against b, by
+         the normal approximation with tie and continuity corrections,
+         fair from about 8 samples each. 1 when either is empty or every
+         sample is equal.
+      */
+      inline double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b)
+      {
+         const std::size_t n1 = a.size();
+         const std::size_t n2 = b.size();
+         const std::size_t n  = n1 + n2;
+
+         if ((0 == n1) || (0 == n2))
+            return 1.0;
+
+         std::vector<std::pair<double,bool> > pooled;
+
+         pooled.reserve(n);
+
+         for (std::size_t i = 0; i < n1; ++i) pooled.push_back(std::make_pair(a[i], true ));
+         for (std::size_t i = 0; i < n2; ++i) pooled.push_back(std::make_pair(b[i], false));
+
+         std::sort(pooled.begin(), pooled.end());
+
+         double rank_sum_a = 0.0;
+         double ties       = 0.0;
+
+         for (std::size_t i = 0; i < n; )
+         {
+            std::size_t j = i;
+
+            while ((j < n) && (pooled[j].first == pooled[i].first))
+               ++j;
+
+            /* Ranks i + 1 .. j share their average */
+            const double rank = (i + 1 + j) / 2.0;
+            const double t    = static_cast<double>(j - i);
+
+            for (std::size_t k = i; k < j; ++k)
+            {
+               if (pooled[k].second)
+                  rank_sum_a += rank;
+            }
+
+            ties += t * t * t - t;
+            i     = j;
+         }
+
+         const double u     = rank_sum_a - n1 * (n1 + 1) / 2.0;
+         const double mu    = n1 * n2 / 2.0;
+         const double sigma = std::sqrt((n1 * n2 / 12.0) * ((n + 1) - ties / (static_cast<double>(n) * (n - 1))));
+
+         if (!(sigma > 0.0))
+            return 1.0;
+
+         const double z = std::max(0.0, std::abs(u - mu) - 0.5) / sigma;
+
+         return std::erfc(z / std::sqrt(2.0));
+      }
+
+      enum verdict_t
+      {
+         e_unchanged   = 0,
+         e_regression  = 1,
+         e_improvement = 2,
+         e_added       = 3,
+         e_removed     = 4
+      };
+
+      struct comparison
+      {
+         std::string name;
+         double      baseline_ns;
+         double      current_ns;
+         double      change;
+         double      p_value;
+         verdict_t   verdict;
+      };
+
+      inline const char* verdict_name(const verdict_t verdict)
+      {
+         switch (verdict)
+         {
+            case e_regression  : return "REGRESSION";
+            case e_improvement : return "improvement";
+            case e_added       : return "new";
+            case e_removed     : return "missing";
+            default            : return "";
+         }
+      }
+
+      /*
+         Benchmarks of current against those of baseline of the same name.
+         threshold is the relative slowdown (or speedup) of the median
+         below which a difference is ignored however significant, eg:
+         0.05, and alpha the significance level, eg: 0.01.
+      */
+      inline std::vector<comparison> compare(const run& baseline, const run& current,
+                                             const double threshold, const double alpha)
+      {
+         std::map<std::string, const entry*> previous;
+
+         for (std::size_t i = 0; i < baseline.entries.size(); ++i)
+         {
+            previous[baseline.entries[i].name] = &baseline.entries[i];
+         }
+
+         std::vector<comparison> result;
+
+         for (std::size_t i = 0; i < current.entries.size(); ++i)
+         {
+            const entry& e = current.entries[i];
+
+            comparison c;
+
+            c.name        = e.name;
+            c.baseline_ns = 0.0;
+            c.current_ns  = e.median_ns;
+            c.change      = 0.0;
+            c.p_value     = 1.0;
+            c.verdict     = e_added;
+
+            const std::map<std::string, const entry*>::iterator it = previous.find(e.name);
+
+            if (previous.end() != it)
+            {
+               const entry& b = *it->second;
+
+               c.baseline_ns = b.median_ns;
+               c.change      = (b.median_ns > 0.0) ? (e.median_ns / b.median_ns - 1.0) : 0.0;
+               c.p_value     = mann_whitney_p(b.samples_ns, e.samples_ns);
+               c.verdict     = e_unchanged;
+
+               if (c.p_value < alpha)
+               {
+                  if      (c.change >  threshold) c.verdict = e_regression;
+                  else if (c.change < -threshold) c.verdict = e_improvement;
+               }
+
+               previous.erase(it);
+            }
+
+            result.push_back(c);
+         }
+
+         for (std::map<std::string, const entry*>::const_iterator it = previous.begin(); it != previous.end(); ++it)
+         {
+            comparison c;
+
+            c.name        = it->first;
+            c.baseline_ns = it->second->median_ns;
+            c.current_ns  = 0.0;
+            c.change      = 0.0;
+            c.p_value     = 1.0;
+            c.verdict     = e_removed;
+
+            result.push_back(c);
+         }
+
+         return result;
+      }
+
+      /* Prints the comparison, returns the number of regressions */
+      inline std::size_t report(const run& baseline, const run& current, const std::vector<comparison>& comparisons)
+      {
+         std::cout << "baseline: " << baseline.revision << " on " << baseline.host
+                   << " (" << baseline.region_backend << ", " << baseline.timestamp << ")" << std::endl;
+         std::cout << "current : " << current.revision << " on " << current.host
+                   << " (" << current.region_backend << ", " << current.timestamp << ")" << std::endl;
+
+         /* Note: Runs of different machines or backends measure different things */
+         if ((baseline.host != current.host) ||
+             (baseline.region_backend != current.region_backend) ||
+             (baseline.cpu_features != current.cpu_features))
+         {
+            std::cout << "Warning: the runs were recorded on different hosts or backends." << std::endl;
+         }
+
+         std::cout << std::left  << std::setw(40) << "benchmark"
+                   << std::right << std::setw(14) << "baseline(ns)"
+                   << std::setw(14) << "current(ns)"
+                   << std::setw(10) << "change"
+                   << std::setw(10) << "p"
+                   << "  " << std::endl;
+
+         std::size_t regressions = 0;
+
+         for (std::size_t i = 0; i < comparisons.size(); ++i)
+         {
+            const comparison& c = comparisons[i];
+
+            std::cout << std::left  << std::setw(40) << c.name
+                      << std::right << std::fixed
+                      << std::setw(14) << std::setprecision(1) << c.baseline_ns
+                      << std::setw(14) << c.current_ns
+                      << std::setw(9)  << std::setprecision(2) << (100.0 * c.change) << "%"
+                      << std::setw(10) << std::setprecision(4) << c.p_value
+                      << "  " << verdict_name(c.verdict) << std::endl;
+
+            if (e_regression == c.verdict)
+               ++regressions;
+         }
+
+         std::cout << regressions << " regression(s)" << std::endl;
+
+         return regressions;
+      }
+
+   } // namespace store
+
+} // namespace bench
+
+
+#endif
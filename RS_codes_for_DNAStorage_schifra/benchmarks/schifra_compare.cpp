@@ -0,0 +1,913 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Comparative benchmark of the RS(15,11) DNA workload of
+                parallel_sequence_benchmark across every engine able to
+                run it:
+
+                  schifra/scalar          reed_solomon::encoder/decoder,
+                                          one block_type at a time (the
+                                          baseline)
+                  schifra/general_codec   the runtime fec_length codec
+                  dna/algebraic           dna_storage::encode()/decode()
+                  dna/table               dna_storage with the syndrome
+                                          table decoder
+                  dna/batch_simd          encode_batch()/decode_batch(),
+                                          GF(2^4) shuffle kernels
+                  dna/batch_bitsliced     encode_batch()/decode_batch(),
+                                          bitsliced engine
+                  isa-l/gf256             ec_encode_data() of the same
+                                          blocks, when built with ISA-L
+                  python/RS_codes_main    the pure Python implementation,
+                                          run as a subprocess
+
+                Every engine encodes the same blocks and decodes the same
+                received blocks (data bases with --errors base errors
+                each, the original ECC symbols), blocks at a time for the
+                batch engines and one at a time for the others. The
+                throughput of each is reported relative to the baseline,
+                with the p50/p99 latency of a call (one block, or one
+                batch) and the number of blocks decoded to anything but
+                their data. ISA-L only encodes: its decoder recovers
+                erasures, not errors. With --energy (or SCHIFRA_ENERGY
+                set) the RAPL package and DRAM energy of the timed
+                repetitions is reported too, in joules per MB of data
+                bases encoded and decoded.
+
+                schifra_compare [--blocks=n] [--batch=n] [--errors=0..2]
+                                [--repetitions=n] [--seed=n]
+                                [--python-blocks=n] [--no-python]
+                                [--filter=substring] [--energy]
+                                [--json=file]
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "schifra/dna_storage.hpp"
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_general_codec.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+#include "schifra/utils/schifra_energy_meter.hpp"
+#include "schifra/utils/schifra_latency_histogram.hpp"
+
+#if defined(SCHIFRA_COMPARE_ISAL)
+#include <isa-l/erasure_code.h>
+#endif
+
+#ifndef SCHIFRA_BENCH_REVISION
+#define SCHIFRA_BENCH_REVISION "unknown"
+#endif
+
+
+namespace
+{
+   /* RS(15,11) over GF(2^4), as parallel_sequence_benchmark */
+   const std::size_t code_length = 15;
+   const std::size_t fec_length  =  4;
+   const std::size_t data_length = code_length - fec_length;
+
+   typedef schifra::dna_storage<code_length,fec_length,data_length>           storage_t;
+   typedef schifra::reed_solomon::encoder<code_length,fec_length,data_length> encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length,data_length> decoder_t;
+   typedef schifra::reed_solomon::general_codec<code_length,fec_length>       general_codec_t;
+   typedef schifra::reed_solomon::block<code_length,fec_length>               block_t;
+   typedef schifra::utils::latency_histogram                                  latency_histogram;
+   typedef schifra::utils::energy_meter                                       energy_meter;
+   typedef std::chrono::steady_clock                                          clock_type;
+
+   struct options
+   {
+      options()
+      : blocks(1 << 16),
+        batch(256),
+        errors(1),
+        repetitions(5),
+        seed(0x5C41F7A),
+        python_blocks(2048),
+        python(true),
+        energy(energy_meter::requested())
+      {}
+
+      std::size_t   blocks;
+      std::size_t   batch;
+      std::size_t   errors;
+      std::size_t   repetitions;
+      std::uint32_t seed;
+      std::size_t   python_blocks;
+      bool          python;
+      bool          energy;
+      std::string   filter;
+      std::string   json_file;
+   };
+
+   /*
+      The blocks every engine runs: data holds the data bases of each
+      block, received the same with the errors, ecc the ECC symbols of
+      data. Per block strings, the received ones being whole strands, are
+      kept too, so the string based APIs are not charged for building
+      their arguments.
+   */
+   struct workload
+   {
+      std::size_t                            blocks;
+      std::string                            data;
+      std::string                            received;
+      std::vector<std::uint8_t>              ecc;
+      std::vector<std::string>               data_sequences;
+      std::vector<std::string>               received_sequences;
+      std::vector<std::vector<std::uint8_t>> ecc_sets;
+   };
+
+   workload make_workload(const storage_t& storage, const options& opt)
+   {
+      const char bases[] = "ACGT";
+
+      std::mt19937 rng(opt.seed);
+
+      workload w;
+
+      w.blocks = opt.blocks;
+      w.data.resize(w.blocks * data_length);
+      w.ecc.resize(w.blocks * fec_length);
+
+      for (std::size_t i = 0; i < w.data.size(); ++i)
+      {
+         w.data[i] = bases[rng() & 3];
+      }
+
+      w.received = w.data;
+
+      for (std::size_t b = 0; b < w.blocks; ++b)
+      {
+         std::size_t position[data_length];
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            position[i] = i;
+         }
+
+         for (std::size_t e = 0; e < opt.errors; ++e)
+         {
+            std::swap(position[e], position[e + rng() % (data_length - e)]);
+
+            char& base = w.received[b * data_length + position[e]];
+            base = bases[(schifra::utils::dna::base_to_symbol(base) + 1 + rng() % 3) & 3];
+         }
+
+         const std::string block = w.data.substr(b * data_length, data_length);
+         const std::pair<std::string, std::vector<std::uint8_t> > encoded = storage.encode(block);
+
+         std::copy(encoded.second.begin(), encoded.second.end(), w.ecc.begin() + b * fec_length);
+
+         w.data_sequences.push_back(block);
+         w.received_sequences.push_back(w.received.substr(b * data_length, data_length) + encoded.first.substr(data_length));
+         w.ecc_sets.push_back(encoded.second);
+      }
+
+      return w;
+   }
+
+   /*
+      encode(first, count) encodes blocks [first, first + count) of the
+      workload, decode(first, count, out) decodes their received bases
+      into out. Either may be empty when the engine lacks it.
+   */
+   struct engine
+   {
+      std::string name;
+      std::size_t batch;
+      std::function<void(std::size_t, std::size_t)>        encode;
+      std::function<void(std::size_t, std::size_t, char*)> decode;
+   };
+
+   /* Totals and per call latencies of one operation of one engine */
+   struct measurement
+   {
+      measurement()
+      : available(false),
+        blocks(0),
+        ns(0.0),
+        p50_ns(0),
+        p99_ns(0),
+        failures(0)
+      {}
+
+      bool                  available;
+      std::size_t           blocks;
+      double                ns;
+      std::uint64_t         p50_ns;
+      std::uint64_t         p99_ns;
+      std::size_t           failures;
+      energy_meter::reading energy;
+      double                energy_mb;
+
+      /* Data bases per microsecond */
+      inline double mbps() const
+      {
+         return (!available || (0.0 == ns)) ? 0.0 : (blocks * data_length / ns) * 1000.0;
+      }
+
+      /* Joules per MB of data bases, over every timed repetition */
+      inline double joules_per_mb() const
+      {
+         return energy.per(energy_mb);
+      }
+   };
+
+   struct result
+   {
+      std::string name;
+      std::size_t batch;
+      measurement encode;
+      measurement decode;
+   };
+
+   /*
+      Runs op over the workload in calls of batch blocks, repetitions
+      times after an untimed pass. The time is that of the median
+      repetition, the latencies those of every timed call. When meter
+      is given, it runs across the timed repetitions.
+   */
+   template <typename Op>
+   measurement run(const workload& w, const std::size_t batch, const std::size_t repetitions, energy_meter* meter, const Op& op)
+   {
+      latency_histogram   latency;
+      std::vector<double> totals;
+
+      for (std::size_t r = 0; r <= repetitions; ++r)
+      {
+         double total = 0.0;
+
+         if (meter && (1 == r))
+         {
+            meter->reset();
+            meter->start();
+         }
+
+         for (std::size_t first = 0; first < w.blocks; first += batch)
+         {
+            const std::size_t count = std::min(batch, w.blocks - first);
+
+            const clock_type::time_point start = clock_type::now();
+            op(first, count);
+            const double ns = std::chrono::duration<double,std::nano>(clock_type::now() - start).count();
+
+            total += ns;
+
+            if (r > 0)
+               latency.record(static_cast<std::uint64_t>(ns));
+         }
+
+         if (r > 0)
+            totals.push_back(total);
+      }
+
+      if (meter)
+         meter->stop();
+
+      std::sort(totals.begin(), totals.end());
+
+      measurement m;
+
+      m.available = true;
+      m.blocks    = w.blocks;
+      m.ns        = totals[totals.size() / 2];
+      m.p50_ns    = latency.percentile(50.0);
+      m.p99_ns    = latency.percentile(99.0);
+      m.energy_mb = (w.blocks * data_length * repetitions) / 1000000.0;
+
+      if (meter)
+         m.energy = meter->totals();
+
+      return m;
+   }
+
+   result measure(const engine& e, const workload& w, const options& opt, energy_meter* meter)
+   {
+      result res;
+
+      res.name  = e.name;
+      res.batch = e.batch;
+
+      if (e.encode)
+      {
+         res.encode = run(w, e.batch, opt.repetitions, meter,
+                          [&e](std::size_t first, std::size_t count) { e.encode(first, count); });
+      }
+
+      if (e.decode)
+      {
+         std::string decoded(w.data.size(), 'A');
+
+         res.decode = run(w, e.batch, opt.repetitions, meter,
+                          [&e, &decoded](std::size_t first, std::size_t count)
+                          {
+                             e.decode(first, count, &decoded[first * data_length]);
+                          });
+
+         for (std::size_t b = 0; b < w.blocks; ++b)
+         {
+            if (0 != decoded.compare(b * data_length, data_length, w.data, b * data_length, data_length))
+               ++res.decode.failures;
+         }
+      }
+
+      return res;
+   }
+
+   inline void load_data(const workload& w, const std::size_t b, block_t& block)
+   {
+      for (std::size_t i = 0; i < data_length; ++i)
+      {
+         block.data[i] = schifra::utils::dna::base_to_symbol(w.data[b * data_length + i]);
+      }
+   }
+
+   inline void load_received(const workload& w, const std::size_t b, block_t& block)
+   {
+      for (std::size_t i = 0; i < data_length; ++i)
+      {
+         block.data[i] = schifra::utils::dna::base_to_symbol(w.received[b * data_length + i]);
+      }
+
+      for (std::size_t i = 0; i < fec_length; ++i)
+      {
+         block.data[data_length + i] = w.ecc[b * fec_length + i];
+      }
+   }
+
+   inline void store_data(const block_t& block, char* out)
+   {
+      for (std::size_t i = 0; i < data_length; ++i)
+      {
+         out[i] = schifra::utils::dna::symbol_to_base(static_cast<std::uint8_t>(block.data[i]));
+      }
+   }
+
+   /* schifra/scalar and schifra/general_codec, one block_type at a time */
+   template <typename Encoder, typename Decoder>
+   engine block_engine(const std::string& name,
+                       std::shared_ptr<const Encoder> encoder,
+                       std::shared_ptr<const Decoder> decoder,
+                       const workload& w)
+   {
+      std::shared_ptr<std::vector<schifra::galois::field_symbol> > parity(
+         new std::vector<schifra::galois::field_symbol>(w.blocks * fec_length));
+
+      engine e;
+
+      e.name   = name;
+      e.batch  = 1;
+      e.encode = [encoder, parity, &w](std::size_t first, std::size_t count)
+                 {
+                    block_t block;
+
+                    for (std::size_t b = first; b < first + count; ++b)
+                    {
+                       load_data(w, b, block);
+                       encoder->encode(block);
+                       std::copy(block.data + data_length, block.data + code_length, parity->begin() + b * fec_length);
+                    }
+                 };
+      e.decode = [decoder, &w](std::size_t first, std::size_t count, char* out)
+                 {
+                    block_t block;
+
+                    for (std::size_t b = first; b < first + count; ++b, out += data_length)
+                    {
+                       load_received(w, b, block);
+                       decoder->decode(block);
+                       store_data(block, out);
+                    }
+                 };
+
+      return e;
+   }
+
+   /* dna/algebraic and dna/table, dna_storage::encode()/decode() per block */
+   engine storage_engine(const std::string& name, std::shared_ptr<const storage_t> storage, const workload& w)
+   {
+      engine e;
+
+      e.name   = name;
+      e.batch  = 1;
+      e.encode = [storage, &w](std::size_t first, std::size_t count)
+                 {
+                    for (std::size_t b = first; b < first + count; ++b)
+                    {
+                       const std::pair<std::string, std::vector<std::uint8_t> > encoded = storage->encode(w.data_sequences[b]);
+                       (void)encoded;
+                    }
+                 };
+      e.decode = [storage, &w](std::size_t first, std::size_t count, char* out)
+                 {
+                    for (std::size_t b = first; b < first + count; ++b, out += data_length)
+                    {
+                       try
+                       {
+                          const std::string decoded = storage->decode(w.received_sequences[b], w.ecc_sets[b]);
+                          std::memcpy(out, decoded.data(), data_length);
+                       }
+                       catch (const std::exception&)
+                       {
+                          std::memcpy(out, w.received_sequences[b].data(), data_length);
+                       }
+                    }
+                 };
+
+      return e;
+   }
+
+   /* dna/batch_*, encode_batch()/decode_batch() of batch blocks per call */
+   engine batch_engine(const std::string& name,
+                       std::shared_ptr<const storage_t> storage,
+                       const storage_t::batch_engine kind,
+                       const std::size_t batch,
+                       const workload& w)
+   {
+      typedef std::vector<std::string>               sequences_t;
+      typedef std::vector<std::vector<std::uint8_t>> ecc_sets_t;
+
+      /* The argument of every call, built up front */
+      std::shared_ptr<std::vector<sequences_t> > data    (new std::vector<sequences_t>);
+      std::shared_ptr<std::vector<sequences_t> > received(new std::vector<sequences_t>);
+      std::shared_ptr<std::vector<ecc_sets_t> >  ecc     (new std::vector<ecc_sets_t>);
+
+      for (std::size_t first = 0; first < w.blocks; first += batch)
+      {
+         const std::size_t last = std::min(first + batch, w.blocks);
+
+         data    ->push_back(sequences_t(w.data_sequences.begin() + first, w.data_sequences.begin() + last));
+         received->push_back(sequences_t(w.received_sequences.begin() + first, w.received_sequences.begin() + last));
+         ecc     ->push_back(ecc_sets_t(w.ecc_sets.begin() + first, w.ecc_sets.begin() + last));
+      }
+
+      engine e;
+
+      e.name   = name;
+      e.batch  = batch;
+      e.encode = [storage, kind, batch, data](std::size_t first, std::size_t)
+                 {
+                    const std::size_t encoded = storage->encode_batch((*data)[first / batch], kind).size();
+                    (void)encoded;
+                 };
+      e.decode = [storage, kind, batch, received, ecc](std::size_t first, std::size_t count, char* out)
+                 {
+                    const std::vector<std::string> decoded = storage->decode_batch((*received)[first / batch], (*ecc)[first / batch], kind);
+
+                    for (std::size_t b = 0; b < count; ++b, out += data_length)
+                    {
+                       std::memcpy(out, decoded[b].data(), data_length);
+                    }
+                 };
+
+      return e;
+   }
+
+   #if defined(SCHIFRA_COMPARE_ISAL)
+   /*
+      ISA-L's RS(15,11) over GF(2^8): each call transposes batch blocks of
+      data bases into the k planar buffers ec_encode_data() takes, one
+      byte per block, and computes the fec_length parity buffers.
+   */
+   engine isal_engine(const std::size_t batch, const workload& w)
+   {
+      struct state
+      {
+         std::vector<unsigned char> matrix;
+         std::vector<unsigned char> tables;
+         std::vector<unsigned char> data;
+         std::vector<unsigned char> parity;
+      };
+
+      std::shared_ptr<state> s(new state);
+
+      s->matrix.resize(code_length * data_length);
+      s->tables.resize(data_length * fec_length * 32);
+      s->data  .resize(data_length * batch);
+      s->parity.resize(fec_length  * batch);
+
+      gf_gen_rs_matrix(s->matrix.data(), code_length, data_length);
+      ec_init_tables(data_length, fec_length, s->matrix.data() + data_length * data_length, s->tables.data());
+
+      engine e;
+
+      e.name   = "isa-l/gf256";
+      e.batch  = batch;
+      e.encode = [s, batch, &w](std::size_t first, std::size_t count)
+                 {
+                    unsigned char* data  [data_length];
+                    unsigned char* parity[fec_length ];
+
+                    for (std::size_t i = 0; i < data_length; ++i)
+                    {
+                       data[i] = s->data.data() + i * batch;
+
+                       for (std::size_t b = 0; b < count; ++b)
+                       {
+                          data[i][b] = schifra::utils::dna::base_to_symbol(w.data[(first + b) * data_length + i]);
+                       }
+                    }
+
+                    for (std::size_t i = 0; i < fec_length; ++i)
+                    {
+                       parity[i] = s->parity.data() + i * batch;
+                    }
+
+                    ec_encode_data(static_cast<int>(count), data_length, fec_length, s->tables.data(), data, parity);
+                 };
+
+      return e;
+   }
+   #endif
+
+   #if defined(SCHIFRA_COMPARE_PYTHON) && defined(SCHIFRA_COMPARE_SCRIPT) && defined(SCHIFRA_COMPARE_RS_CODES_MAIN) && \
+       (defined(__unix__) || defined(__APPLE__))
+   #define SCHIFRA_COMPARE_WITH_PYTHON
+
+   inline std::uint64_t field_value(const std::string& line, const std::string& key)
+   {
+      const std::size_t at = line.find(key + "=");
+
+      return (std::string::npos == at) ? 0 : std::strtoull(line.c_str() + at + key.size() + 1, 0, 10);
+   }
+
+   /*
+      python/RS_codes_main: the first blocks of the workload are written
+      to a file for rs_codes_main_compare.py, which times its encode and
+      decode of each (see the script). The interpreter is started once,
+      so its start up is not counted.
+   */
+   bool run_python(const workload& w, const std::size_t blocks, result& res)
+   {
+      std::ostringstream path;
+      path << "/tmp/schifra_compare_" << ::getpid() << ".txt";
+
+      {
+         std::ofstream out(path.str().c_str());
+
+         out << blocks << ' ' << code_length << ' ' << data_length << '\n';
+
+         for (std::size_t b = 0; b < blocks; ++b)
+         {
+            for (std::size_t i = 0; i < data_length; ++i)
+               out << int(schifra::utils::dna::base_to_symbol(w.data[b * data_length + i])) << ' ';
+
+            out << '|';
+
+            for (std::size_t i = 0; i < data_length; ++i)
+               out << ' ' << int(schifra::utils::dna::base_to_symbol(w.received[b * data_length + i]));
+
+            out << '\n';
+         }
+
+         if (!out)
+            return false;
+      }
+
+      const std::string command = std::string("\"") + SCHIFRA_COMPARE_PYTHON + "\" \"" + SCHIFRA_COMPARE_SCRIPT + "\" \"" +
+                                  path.str() + "\" \"" + SCHIFRA_COMPARE_RS_CODES_MAIN + "\"";
+
+      std::string line;
+
+      if (FILE* pipe = ::popen(command.c_str(), "r"))
+      {
+         char buffer[512];
+
+         while (std::fgets(buffer, sizeof(buffer), pipe))
+         {
+            line += buffer;
+         }
+
+         if (0 != ::pclose(pipe))
+            line.clear();
+      }
+
+      std::remove(path.str().c_str());
+
+      if (std::string::npos == line.find("blocks="))
+         return false;
+
+      res.name  = "python/RS_codes_main";
+      res.batch = 1;
+
+      res.encode.available = true;
+      res.encode.blocks    = static_cast<std::size_t>(field_value(line, "blocks"));
+      res.encode.ns        = static_cast<double>(field_value(line, "encode_ns"));
+      res.encode.p50_ns    = field_value(line, "encode_p50");
+      res.encode.p99_ns    = field_value(line, "encode_p99");
+
+      res.decode.available = true;
+      res.decode.blocks    = res.encode.blocks;
+      res.decode.ns        = static_cast<double>(field_value(line, "decode_ns"));
+      res.decode.p50_ns    = field_value(line, "decode_p50");
+      res.decode.p99_ns    = field_value(line, "decode_p99");
+      res.decode.failures  = static_cast<std::size_t>(field_value(line, "failures"));
+
+      return true;
+   }
+   #endif
+
+   inline double relative(const measurement& m, const measurement& baseline)
+   {
+      return (0.0 == baseline.mbps()) ? 0.0 : m.mbps() / baseline.mbps();
+   }
+
+   void print_header(const bool energy)
+   {
+      std::cout << std::left  << std::setw(24) << "engine"
+                << std::right << std::setw(7)  << "batch"
+                << std::setw(12) << "enc MB/s" << std::setw(8) << "x"
+                << std::setw(12) << "enc p50us" << std::setw(12) << "enc p99us"
+                << std::setw(12) << "dec MB/s" << std::setw(8) << "x"
+                << std::setw(12) << "dec p50us" << std::setw(12) << "dec p99us"
+                << std::setw(10) << "failures";
+
+      if (energy)
+         std::cout << std::setw(11) << "enc J/MB" << std::setw(11) << "dec J/MB";
+
+      std::cout << std::endl;
+   }
+
+   void print_energy(const measurement& m)
+   {
+      if (m.available && m.energy.any())
+         std::cout << std::setw(11) << std::setprecision(4) << m.joules_per_mb();
+      else
+         std::cout << std::setw(11) << "-";
+   }
+
+   void print_measurement(const measurement& m, const measurement& baseline)
+   {
+      if (!m.available)
+      {
+         std::cout << std::setw(12) << "-" << std::setw(8) << "-" << std::setw(12) << "-" << std::setw(12) << "-";
+         return;
+      }
+
+      std::cout << std::fixed
+                << std::setw(12) << std::setprecision(1) << m.mbps()
+                << std::setw(8)  << std::setprecision(2) << relative(m, baseline)
+                << std::setw(12) << std::setprecision(3) << (m.p50_ns / 1000.0)
+                << std::setw(12) << (m.p99_ns / 1000.0);
+   }
+
+   void print(const result& r, const result& baseline, const bool energy)
+   {
+      std::cout << std::left  << std::setw(24) << r.name
+                << std::right << std::setw(7)  << r.batch;
+
+      print_measurement(r.encode, baseline.encode);
+      print_measurement(r.decode, baseline.decode);
+
+      if (r.decode.available)
+         std::cout << std::setw(10) << r.decode.failures;
+      else
+         std::cout << std::setw(10) << "-";
+
+      if (energy)
+      {
+         print_energy(r.encode);
+         print_energy(r.decode);
+      }
+
+      std::cout << std::endl;
+   }
+
+   void write_json_measurement(std::ofstream& out, const char* name, const measurement& m, const measurement& baseline)
+   {
+      out << "\"" << name << "\": ";
+
+      if (!m.available)
+      {
+         out << "null";
+         return;
+      }
+
+      out << "{"
+          << "\"blocks\": "   << m.blocks   << ", "
+          << "\"ns\": "       << m.ns       << ", "
+          << "\"mbps\": "     << m.mbps()   << ", "
+          << "\"relative\": " << relative(m, baseline) << ", "
+          << "\"p50_ns\": "   << m.p50_ns   << ", "
+          << "\"p99_ns\": "   << m.p99_ns   << ", "
+          << "\"failures\": " << m.failures;
+
+      if (m.energy.any())
+      {
+         out << ", \"joules_per_mb\": " << m.joules_per_mb()
+             << ", \"package_joules\": " << m.energy.joules[energy_meter::e_package]
+             << ", \"dram_joules\": "    << m.energy.joules[energy_meter::e_dram];
+      }
+
+      out << "}";
+   }
+
+   void write_json(const std::string& file_name, const options& opt, const std::vector<result>& results)
+   {
+      std::ofstream out(file_name.c_str());
+
+      out << std::setprecision(6) << std::fixed;
+      out << "{\n";
+      out << "  \"context\": {\n";
+      out << "    \"revision\": \"" << SCHIFRA_BENCH_REVISION << "\",\n";
+      out << "    \"code\": \"RS(" << code_length << "," << data_length << ")\",\n";
+      out << "    \"blocks\": "      << opt.blocks      << ",\n";
+      out << "    \"errors\": "      << opt.errors      << ",\n";
+      out << "    \"seed\": "        << opt.seed        << "\n";
+      out << "  },\n";
+      out << "  \"engines\": [\n";
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const result& r = results[i];
+
+         out << "    {\"name\": \"" << r.name << "\", \"batch\": " << r.batch << ", ";
+         write_json_measurement(out, "encode", r.encode, results.front().encode);
+         out << ", ";
+         write_json_measurement(out, "decode", r.decode, results.front().decode);
+         out << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+      }
+
+      out << "  ]\n";
+      out << "}\n";
+   }
+
+   bool parse_options(int argc, char* argv[], options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg(argv[i]);
+         const std::size_t eq    = arg.find('=');
+         const std::string key   = arg.substr(0, eq);
+         const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+         if      ("--blocks"        == key) opt.blocks        = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--batch"         == key) opt.batch         = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--errors"        == key) opt.errors        = std::min<std::size_t>(fec_length / 2, std::strtoul(value.c_str(), 0, 10));
+         else if ("--repetitions"   == key) opt.repetitions   = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--seed"          == key) opt.seed          = static_cast<std::uint32_t>(std::strtoul(value.c_str(), 0, 10));
+         else if ("--python-blocks" == key) opt.python_blocks = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--no-python"     == key) opt.python        = false;
+         else if ("--filter"        == key) opt.filter        = value;
+         else if ("--energy"        == key) opt.energy        = true;
+         else if ("--json"          == key) opt.json_file     = value;
+         else
+         {
+            std::cout << "schifra_compare - Error: unknown option " << arg << std::endl;
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+   options opt;
+
+   if (!parse_options(argc, argv, opt))
+      return 1;
+
+   const schifra::galois::field field(4,
+                                      schifra::galois::primitive_polynomial_size01,
+                                      schifra::galois::primitive_polynomial01);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            storage_t::generator_polynomial_index,
+                                                            fec_length,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   std::shared_ptr<const storage_t> storage(new storage_t);
+   std::shared_ptr<const storage_t> table_storage(new storage_t(storage_t::decode_engine::table));
+
+   const workload w = make_workload(*storage, opt);
+
+   std::vector<engine> engines;
+
+   engines.push_back(block_engine("schifra/scalar",
+                                  std::shared_ptr<const encoder_t>(new encoder_t(field, generator_polynomial)),
+                                  std::shared_ptr<const decoder_t>(new decoder_t(field, storage_t::generator_polynomial_index)),
+                                  w));
+
+   std::shared_ptr<const general_codec_t> general(new general_codec_t(field, storage_t::generator_polynomial_index));
+
+   engines.push_back(block_engine("schifra/general_codec", general, general, w));
+   engines.push_back(storage_engine("dna/algebraic", storage, w));
+   engines.push_back(storage_engine("dna/table", table_storage, w));
+   engines.push_back(batch_engine("dna/batch_simd", storage, storage_t::batch_engine::simd, opt.batch, w));
+   engines.push_back(batch_engine("dna/batch_bitsliced", storage, storage_t::batch_engine::bitsliced, opt.batch, w));
+
+   #if defined(SCHIFRA_COMPARE_ISAL)
+   engines.push_back(isal_engine(opt.batch, w));
+   #endif
+
+   std::cout << "revision: " << SCHIFRA_BENCH_REVISION
+             << "  workload: RS(" << code_length << "," << data_length << ") x " << opt.blocks
+             << " blocks, " << opt.errors << " error(s) per block, seed " << opt.seed << std::endl;
+
+   std::unique_ptr<energy_meter> meter;
+
+   if (opt.energy)
+   {
+      meter.reset(new energy_meter);
+
+      if (meter->available())
+         std::cout << "energy: RAPL via " << meter->source() << ", package-wide" << std::endl;
+      else
+      {
+         std::cout << "schifra_compare - Warning: RAPL energy counters are unavailable." << std::endl;
+         meter.reset();
+      }
+   }
+
+   print_header(opt.energy);
+
+   std::vector<result> results;
+
+   for (std::size_t i = 0; i < engines.size(); ++i)
+   {
+      /* The baseline always runs, the others are relative to it */
+      if ((0 != i) && !opt.filter.empty() && (std::string::npos == engines[i].name.find(opt.filter)))
+         continue;
+
+      results.push_back(measure(engines[i], w, opt, meter.get()));
+      print(results.back(), results.front(), opt.energy);
+   }
+
+   #if defined(SCHIFRA_COMPARE_WITH_PYTHON)
+   if (opt.python && (opt.filter.empty() || (std::string::npos != std::string("python/RS_codes_main").find(opt.filter))))
+   {
+      result python;
+
+      if (run_python(w, std::min(opt.blocks, opt.python_blocks), python))
+      {
+         results.push_back(python);
+         print(results.back(), results.front(), opt.energy);
+      }
+      else
+         std::cout << "schifra_compare - Warning: python/RS_codes_main could not be run." << std::endl;
+   }
+   #endif
+
+   if (!opt.json_file.empty())
+      write_json(opt.json_file, opt, results);
+
+   return 0;
+}
@@ -0,0 +1,636 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: End-to-end benchmark of the DNA storage pipeline, from a
+                seeded dataset to its reconstruction:
+
+                  generate     dataset bytes from (seed, segment)
+                  encode       addressed_pool_codec: address field, inner
+                               RS(15,11) strand code, outer Cauchy code
+                  channel      strand dropout, Poisson coverage of reads
+                               with base substitutions, reads shuffled
+                  cluster      read_clusterer, reads grouped by strand
+                  consensus    per group vote, address decode to a slot
+                  inner        inner decode of every slot
+                  outer        stripe rebuild by the outer code
+                  reconstruct  bases back to bytes, checked against the
+                               dataset
+
+                Each scale (eg: 1MB, 100GB) is run as segments of
+                --segment bytes, each an independent pool, so memory stays
+                that of one segment whatever the scale. The dataset and
+                channel of segment s follow from (seed, s) alone, so a run
+                is reproduced exactly by its seed and parameters. The
+                throughput of every stage, in dataset MB/s, and the final
+                recovery rate (bytes reconstructed correctly) are printed
+                per scale, and optionally written as JSON:
+
+                schifra_pipeline_bench [--sizes=1MB,10MB,...] [--segment=size]
+                                       [--seed=n] [--coverage=x] [--dropout=p]
+                                       [--substitution=p] [--data-strands=n]
+                                       [--parity-strands=n] [--threads=n]
+                                       [--json=file]
+
+                Sizes take a K/M/G/T suffix (powers of 1000, B optional).
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "schifra/dna_oligo_address.hpp"
+#include "schifra/dna_oligo_pool.hpp"
+#include "schifra/dna_read_clustering.hpp"
+#include "schifra/dna_storage.hpp"
+#include "schifra/utils/schifra_channel_simulator.hpp"
+#include "schifra/utils/schifra_dna_consensus.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+
+#ifndef SCHIFRA_BENCH_REVISION
+#define SCHIFRA_BENCH_REVISION "unknown"
+#endif
+
+
+namespace
+{
+   typedef schifra::dna_storage<15,4,11>                  inner_t;
+   typedef schifra::addressed_pool_codec<inner_t>         codec_t;
+   typedef codec_t::pool_stats                            pool_stats;
+   typedef schifra::utils::channel::channel_simulator     channel_simulator;
+   typedef schifra::utils::channel::xoshiro256pp          generator_t;
+   typedef std::chrono::steady_clock                      clock_type;
+
+   enum stage_t
+   {
+      e_generate,
+      e_encode,
+      e_channel,
+      e_cluster,
+      e_consensus,
+      e_inner,
+      e_outer,
+      e_reconstruct,
+      e_stage_count
+   };
+
+   const char* const stage_names[e_stage_count] =
+                        {
+                           "generate", "encode", "channel", "cluster",
+                           "consensus", "inner", "outer", "reconstruct"
+                        };
+
+   struct options
+   {
+      options()
+      : segment(1000000),
+        seed(1),
+        coverage(5.0),
+        dropout(0.01),
+        substitution(0.005),
+        data_strands(200),
+        parity_strands(30),
+        threads(0)
+      {}
+
+      std::vector<std::uint64_t> sizes;
+      std::uint64_t              segment;
+      std::uint64_t              seed;
+      double                     coverage;
+      double                     dropout;
+      double                     substitution;
+      std::size_t                data_strands;
+      std::size_t                parity_strands;
+      std::size_t                threads;
+      std::string                json_file;
+   };
+
+   /* Totals of one scale, over all of its segments */
+   struct scale_result
+   {
+      std::uint64_t size            = 0;
+      std::size_t   segments        = 0;
+      double        seconds[e_stage_count] = {};
+
+      std::uint64_t strands         = 0;
+      std::uint64_t strands_lost    = 0;
+      std::uint64_t reads           = 0;
+      std::uint64_t substitutions   = 0;
+      std::uint64_t groups          = 0;
+      std::uint64_t unaddressed     = 0;
+      std::uint64_t inner_corrected = 0;
+      std::uint64_t inner_failed    = 0;
+      std::uint64_t erasures        = 0;
+      std::uint64_t stripes         = 0;
+      std::uint64_t stripes_failed  = 0;
+      std::uint64_t recovered_bytes = 0;
+
+      inline double total_seconds() const
+      {
+         double total = 0.0;
+
+         for (std::size_t s = 0; s < e_stage_count; ++s)
+         {
+            total += seconds[s];
+         }
+
+         return total;
+      }
+
+      /* Dataset bytes per microsecond through stage s */
+      inline double mbps(const std::size_t s) const
+      {
+         return (0.0 == seconds[s]) ? 0.0 : (size / seconds[s]) / 1.0e6;
+      }
+
+      inline double recovery_rate() const
+      {
+         return (0 == size) ? 0.0 : static_cast<double>(recovered_bytes) / size;
+      }
+   };
+
+   /* Generator of segment s, independent of every other segment's */
+   inline std::uint64_t segment_seed(const std::uint64_t seed, const std::uint64_t segment, const std::uint64_t purpose)
+   {
+      std::uint64_t state = seed ^ (segment * 0xD1B54A32D192ED03ULL) ^ (purpose * 0x9E3779B97F4A7C15ULL);
+      return schifra::utils::channel::splitmix64(state);
+   }
+
+   /* Poisson draw of mean lambda (Knuth), from the simulator's stream */
+   inline std::size_t poisson(channel_simulator& channel, const double lambda)
+   {
+      const double limit = std::exp(-lambda);
+
+      std::size_t k = 0;
+      double      p = channel.unit();
+
+      while (p > limit)
+      {
+         ++k;
+         p *= channel.unit();
+      }
+
+      return k;
+   }
+
+   class stage_timer
+   {
+   public:
+
+      stage_timer(scale_result& result, const stage_t stage)
+      : result_(result),
+        stage_(stage),
+        start_(clock_type::now())
+      {}
+
+     ~stage_timer()
+      {
+         result_.seconds[stage_] += std::chrono::duration<double>(clock_type::now() - start_).count();
+      }
+
+   private:
+
+      scale_result&          result_;
+      const stage_t          stage_;
+      clock_type::time_point start_;
+   };
+
+   void run_segment(const codec_t& codec,
+                    const schifra::read_clusterer& clusterer,
+                    const options& opt,
+                    const std::uint64_t segment,
+                    const std::size_t size,
+                    scale_result& result)
+   {
+      const std::size_t strand_length = codec_t::strand_length();
+      const std::size_t inner_length  = inner_t::strand_length();
+
+      /* Dataset */
+      std::vector<std::uint8_t> data(size);
+      {
+         stage_timer timer(result, e_generate);
+
+         generator_t generator(segment_seed(opt.seed, segment, 0));
+
+         for (std::size_t i = 0; i < size; i += 8)
+         {
+            const std::uint64_t word = generator();
+
+            for (std::size_t j = 0; (j < 8) && ((i + j) < size); ++j)
+            {
+               data[i + j] = static_cast<std::uint8_t>(word >> (8 * j));
+            }
+         }
+      }
+
+      /* Strands */
+      std::vector<std::string> strands;
+      {
+         stage_timer timer(result, e_encode);
+         strands = codec.encode(data.data(), data.size());
+      }
+
+      result.strands += strands.size();
+
+      /* Reads: each strand survives synthesis with 1 - dropout, and is then
+         read a Poisson number of times, each read with its substitutions */
+      std::vector<std::string> reads;
+      {
+         stage_timer timer(result, e_channel);
+
+         schifra::utils::channel::channel_model model;
+         model.substitution_rate = opt.substitution;
+
+         channel_simulator channel(model, segment_seed(opt.seed, segment, 1));
+
+         reads.reserve(static_cast<std::size_t>(strands.size() * opt.coverage * 1.1));
+
+         for (std::size_t i = 0; i < strands.size(); ++i)
+         {
+            if (channel.unit() <= opt.dropout)
+            {
+               ++result.strands_lost;
+               continue;
+            }
+
+            const std::size_t copies = poisson(channel, opt.coverage);
+
+            if (0 == copies)
+               ++result.strands_lost;
+
+            for (std::size_t c = 0; c < copies; ++c)
+            {
+               reads.push_back(strands[i]);
+               result.substitutions += channel.corrupt_bases(&reads.back()[0], strand_length).substitutions;
+            }
+         }
+
+         /* Sequencing returns reads in no particular order */
+         for (std::size_t i = reads.size(); i > 1; --i)
+         {
+            std::swap(reads[i - 1], reads[channel.bounded(i)]);
+         }
+      }
+
+      result.reads += reads.size();
+
+      strands = std::vector<std::string>();
+
+      /* Groups of reads by strand */
+      std::vector<std::string_view> views(reads.begin(), reads.end());
+      schifra::read_groups groups;
+      {
+         stage_timer timer(result, e_cluster);
+         groups = clusterer.cluster(views.data(), views.size());
+      }
+
+      result.groups += groups.groups();
+
+      /* A consensus strand per group, into the slot its address names. Of
+         two groups naming one slot, eg: a strand's reads split in two, the
+         larger is kept. */
+      const std::size_t pool_strands = codec.pool_strands(size);
+
+      std::vector<std::string> slots(pool_strands);
+      {
+         stage_timer timer(result, e_consensus);
+
+         const schifra::strand_address_codec address;
+
+         std::vector<std::size_t>   slot_reads(pool_strands, 0);
+         std::vector<std::uint16_t> votes(4 * strand_length);
+         std::string                consensus(strand_length, 'A');
+
+         for (std::size_t g = 0; g < groups.groups(); ++g)
+         {
+            std::fill(votes.begin(), votes.end(), 0);
+
+            for (const std::uint32_t* r = groups.begin(g); r != groups.end(g); ++r)
+            {
+               if (views[*r].size() == strand_length)
+                  schifra::utils::dna::add_votes(views[*r].data(), nullptr, strand_length, votes.data());
+            }
+
+            schifra::utils::dna::call_consensus(votes.data(), strand_length, &consensus[0], nullptr);
+
+            std::uint32_t id = 0;
+
+            if (!address.decode(consensus.data(), id) || (id >= pool_strands))
+            {
+               ++result.unaddressed;
+               continue;
+            }
+
+            if (groups.size(g) > slot_reads[id])
+            {
+               slot_reads[id] = groups.size(g);
+               slots[id].assign(consensus, codec_t::address_bases, inner_length);
+            }
+         }
+      }
+
+      reads = std::vector<std::string>();
+      views = std::vector<std::string_view>();
+
+      /* Inner and outer decode, timed apart by the pool codec */
+      pool_stats stats;
+
+      const std::string bases = codec.pool().decode(slots, 4 * size, stats);
+
+      result.seconds[e_inner] += stats.inner_time;
+      result.seconds[e_outer] += stats.outer_time;
+      result.inner_corrected  += stats.inner_corrected;
+      result.inner_failed     += stats.inner_failed;
+      result.erasures         += stats.erasures();
+      result.stripes          += pool_strands / codec.pool().stripe_strands();
+      result.stripes_failed   += stats.stripes_failed;
+
+      /* Bytes, 4 bases each, checked against the dataset */
+      {
+         stage_timer timer(result, e_reconstruct);
+
+         for (std::size_t i = 0; i < size; ++i)
+         {
+            std::uint8_t byte = 0;
+
+            if (schifra::utils::dna::pack_bases(bases.data() + 4 * i, 4, &byte) && (byte == data[i]))
+               ++result.recovered_bytes;
+         }
+      }
+   }
+
+   scale_result run_scale(const codec_t& codec, const schifra::read_clusterer& clusterer,
+                          const options& opt, const std::uint64_t size)
+   {
+      scale_result result;
+
+      result.size = size;
+
+      for (std::uint64_t offset = 0; offset < size; offset += opt.segment)
+      {
+         run_segment(codec, clusterer, opt, offset / opt.segment,
+                     static_cast<std::size_t>(std::min<std::uint64_t>(opt.segment, size - offset)), result);
+
+         ++result.segments;
+      }
+
+      return result;
+   }
+
+   std::string format_size(const std::uint64_t size)
+   {
+      const char* const suffix[] = { "B", "KB", "MB", "GB", "TB" };
+
+      std::size_t   s = 0;
+      std::uint64_t v = size;
+
+      while ((s < 4) && (v >= 1000) && (0 == (v % 1000)))
+      {
+         v /= 1000;
+         ++s;
+      }
+
+      return std::to_string(v) + suffix[s];
+   }
+
+   void print(const scale_result& r)
+   {
+      std::cout << format_size(r.size) << " in " << r.segments << " segment(s), "
+                << std::fixed << std::setprecision(3) << r.total_seconds() << " s" << std::endl;
+
+      for (std::size_t s = 0; s < e_stage_count; ++s)
+      {
+         std::cout << "   " << std::left << std::setw(14) << stage_names[s]
+                   << std::right << std::setw(12) << std::setprecision(3) << r.seconds[s] << " s"
+                   << std::setw(12) << std::setprecision(1) << r.mbps(s) << " MB/s" << std::endl;
+      }
+
+      std::cout << "   strands: "         << r.strands
+                << "  lost: "             << r.strands_lost
+                << "  reads: "            << r.reads
+                << "  substitutions: "    << r.substitutions << std::endl
+                << "   groups: "          << r.groups
+                << "  unaddressed: "      << r.unaddressed
+                << "  inner corrected: "  << r.inner_corrected
+                << "  inner failed: "     << r.inner_failed
+                << "  erasures: "         << r.erasures << std::endl
+                << "   stripes: "         << r.stripes
+                << "  stripes failed: "   << r.stripes_failed
+                << "  recovered: "        << r.recovered_bytes << "/" << r.size
+                << " (" << std::setprecision(6) << (100.0 * r.recovery_rate()) << "%)" << std::endl;
+   }
+
+   void write_json(const std::string& file_name, const options& opt, const std::vector<scale_result>& results)
+   {
+      std::ofstream out(file_name.c_str());
+
+      out << std::setprecision(6) << std::fixed;
+      out << "{\n";
+      out << "  \"context\": {\n";
+      out << "    \"revision\": \""      << SCHIFRA_BENCH_REVISION << "\",\n";
+      out << "    \"seed\": "            << opt.seed           << ",\n";
+      out << "    \"segment\": "         << opt.segment        << ",\n";
+      out << "    \"coverage\": "        << opt.coverage       << ",\n";
+      out << "    \"dropout\": "         << opt.dropout        << ",\n";
+      out << "    \"substitution\": "    << opt.substitution   << ",\n";
+      out << "    \"data_strands\": "    << opt.data_strands   << ",\n";
+      out << "    \"parity_strands\": "  << opt.parity_strands << "\n";
+      out << "  },\n";
+      out << "  \"scales\": [\n";
+
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const scale_result& r = results[i];
+
+         out << "    {\"size\": " << r.size << ", \"segments\": " << r.segments
+             << ", \"seconds\": " << r.total_seconds() << ", \"stages\": {";
+
+         for (std::size_t s = 0; s < e_stage_count; ++s)
+         {
+            out << ((0 == s) ? "" : ", ")
+                << "\"" << stage_names[s] << "\": {\"seconds\": " << r.seconds[s] << ", \"mbps\": " << r.mbps(s) << "}";
+         }
+
+         out << "}, "
+             << "\"strands\": "         << r.strands         << ", "
+             << "\"strands_lost\": "    << r.strands_lost    << ", "
+             << "\"reads\": "           << r.reads           << ", "
+             << "\"substitutions\": "   << r.substitutions   << ", "
+             << "\"groups\": "          << r.groups          << ", "
+             << "\"unaddressed\": "     << r.unaddressed     << ", "
+             << "\"inner_corrected\": " << r.inner_corrected << ", "
+             << "\"inner_failed\": "    << r.inner_failed    << ", "
+             << "\"erasures\": "        << r.erasures        << ", "
+             << "\"stripes\": "         << r.stripes         << ", "
+             << "\"stripes_failed\": "  << r.stripes_failed  << ", "
+             << "\"recovered_bytes\": " << r.recovered_bytes << ", "
+             << "\"recovery_rate\": "   << r.recovery_rate()
+             << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+      }
+
+      out << "  ]\n";
+      out << "}\n";
+   }
+
+   /* 1MB, 2.5GB, 100G, 4096: powers of 1000 */
+   bool parse_size(const std::string& value, std::uint64_t& size)
+   {
+      char* end = 0;
+
+      const double number = std::strtod(value.c_str(), &end);
+
+      std::string suffix(end);
+
+      if (!suffix.empty() && (('B' == suffix.back()) || ('b' == suffix.back())))
+         suffix.erase(suffix.size() - 1);
+
+      double scale = 1.0;
+
+      if      (suffix.empty()                     ) scale = 1.0;
+      else if (("K" == suffix) || ("k" == suffix)) scale = 1.0e3;
+      else if (("M" == suffix) || ("m" == suffix)) scale = 1.0e6;
+      else if (("G" == suffix) || ("g" == suffix)) scale = 1.0e9;
+      else if (("T" == suffix) || ("t" == suffix)) scale = 1.0e12;
+      else
+         return false;
+
+      if (!(number > 0.0) || (end == value.c_str()))
+         return false;
+
+      size = static_cast<std::uint64_t>(number * scale);
+
+      return (size > 0);
+   }
+
+   bool parse_options(int argc, char* argv[], options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg(argv[i]);
+         const std::size_t eq    = arg.find('=');
+         const std::string key   = arg.substr(0, eq);
+         const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+         bool valid = true;
+
+         if ("--sizes" == key)
+         {
+            std::size_t begin = 0;
+
+            while (valid && (begin <= value.size()))
+            {
+               const std::size_t comma = std::min(value.find(',', begin), value.size());
+
+               std::uint64_t size = 0;
+
+               valid = parse_size(value.substr(begin, comma - begin), size);
+
+               if (valid)
+                  opt.sizes.push_back(size);
+
+               begin = comma + 1;
+            }
+         }
+         else if ("--segment"         == key) valid = parse_size(value, opt.segment);
+         else if ("--seed"            == key) opt.seed           = std::strtoull(value.c_str(), 0, 10);
+         else if ("--coverage"        == key) opt.coverage       = std::max(0.0, std::atof(value.c_str()));
+         else if ("--dropout"         == key) opt.dropout        = std::min(1.0, std::max(0.0, std::atof(value.c_str())));
+         else if ("--substitution"    == key) opt.substitution   = std::min(1.0, std::max(0.0, std::atof(value.c_str())));
+         else if ("--data-strands"    == key) opt.data_strands   = std::strtoul(value.c_str(), 0, 10);
+         else if ("--parity-strands"  == key) opt.parity_strands = std::strtoul(value.c_str(), 0, 10);
+         else if ("--threads"         == key) opt.threads        = std::strtoul(value.c_str(), 0, 10);
+         else if ("--json"            == key) opt.json_file      = value;
+         else
+         {
+            std::cout << "schifra_pipeline_bench - Error: unknown option " << arg << std::endl;
+            return false;
+         }
+
+         if (!valid)
+         {
+            std::cout << "schifra_pipeline_bench - Error: invalid size in " << arg << std::endl;
+            return false;
+         }
+      }
+
+      if (opt.sizes.empty())
+         opt.sizes.push_back(1000000);
+
+      return true;
+   }
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+   options opt;
+
+   if (!parse_options(argc, argv, opt))
+      return 1;
+
+   try
+   {
+      const codec_t codec(opt.data_strands, opt.parity_strands, opt.threads);
+
+      schifra::read_cluster_params params;
+      params.threads = opt.threads;
+      params.seed    = opt.seed;
+
+      const schifra::read_clusterer clusterer(params);
+
+      std::cout << "revision: " << SCHIFRA_BENCH_REVISION
+                << "  seed: " << opt.seed
+                << "  coverage: " << opt.coverage
+                << "  dropout: " << opt.dropout
+                << "  substitution: " << opt.substitution
+                << "  outer: " << opt.data_strands << "+" << opt.parity_strands << std::endl;
+
+      std::vector<scale_result> results;
+
+      for (std::size_t i = 0; i < opt.sizes.size(); ++i)
+      {
+         results.push_back(run_scale(codec, clusterer, opt, opt.sizes[i]));
+         print(results.back());
+      }
+
+      if (!opt.json_file.empty())
+         write_json(opt.json_file, opt, results);
+   }
+   catch (const std::exception& e)
+   {
+      std::cout << "schifra_pipeline_bench - Error: " << e.what() << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
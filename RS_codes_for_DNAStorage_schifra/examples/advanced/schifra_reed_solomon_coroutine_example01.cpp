@@ -0,0 +1,197 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: This example will demonstrate the use of the Reed-Solomon
+                coroutine API. Many small encode then decode requests are
+                awaited concurrently through an async_codec, which batches
+                them onto the codec executor's workers, and a file is then
+                encoded and decoded with the awaitable file pipelines.
+                Requires C++20 coroutine support.
+*/
+
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_coroutines.hpp"
+
+
+#if defined(SCHIFRA_COROUTINES)
+
+/* Reed Solomon Code Parameters */
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+const std::size_t request_count         = 256;
+const std::size_t codewords_per_request =   4;
+
+typedef schifra::reed_solomon::async_codec<code_length,fec_length> async_codec_t;
+
+using schifra::reed_solomon::codec_task;
+
+codec_task<bool> round_trip(async_codec_t& codec, std::vector<unsigned char>& buffer)
+{
+   const std::size_t count = buffer.size() / code_length;
+
+   const std::size_t encoded = co_await codec.async_encode(&buffer[0], count);
+
+   if (encoded != count)
+      co_return false;
+
+   const std::vector<unsigned char> original = buffer;
+
+   /* Corrupt fec_length / 2 symbols of every codeword */
+   for (std::size_t c = 0; c < count; ++c)
+   {
+      for (std::size_t e = 0; e < fec_length / 2; ++e)
+      {
+         buffer[c * code_length + ((e * 13 + c) % code_length)] ^= 0x5A;
+      }
+   }
+
+   const std::size_t decoded = co_await codec.async_decode(&buffer[0], count);
+
+   if (decoded != count)
+      co_return false;
+
+   co_return (buffer == original);
+}
+
+codec_task<std::size_t> run_requests(async_codec_t& codec, std::vector<std::vector<unsigned char> >& buffers)
+{
+   std::vector<codec_task<bool> > tasks;
+
+   for (std::size_t i = 0; i < buffers.size(); ++i)
+   {
+      tasks.push_back(round_trip(codec, buffers[i]));
+   }
+
+   const std::vector<bool> results = co_await schifra::reed_solomon::when_all(std::move(tasks));
+
+   std::size_t passed = 0;
+
+   for (std::size_t i = 0; i < results.size(); ++i)
+   {
+      if (results[i])
+         ++passed;
+   }
+
+   co_return passed;
+}
+
+codec_task<bool> run_files(const schifra::reed_solomon::encoder<code_length,fec_length>& encoder,
+                           const schifra::reed_solomon::decoder<code_length,fec_length>& decoder)
+{
+   /* Note: Awaited into locals, some compilers mishandle co_await within conditions */
+   const bool encoded = co_await schifra::reed_solomon::async_encode_file<code_length,fec_length>(encoder, "input.dat", "output.schifra");
+
+   if (!encoded)
+      co_return false;
+
+   co_return co_await schifra::reed_solomon::async_decode_file<code_length,fec_length>(decoder, "output.schifra", "output.dat");
+}
+
+int main()
+{
+   /* Finite Field Parameters */
+   const std::size_t field_descriptor                =   8;
+   const std::size_t generator_polynomial_index      = 120;
+   const std::size_t generator_polynomial_root_count = fec_length;
+
+   /* Instantiate Finite Field and Generator Polynomials */
+   const schifra::galois::field field(field_descriptor,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            generator_polynomial_index,
+                                                            generator_polynomial_root_count,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   schifra::reed_solomon::codec_executor<code_length,fec_length> executor(field,
+                                                                          generator_polynomial,
+                                                                          generator_polynomial_index);
+
+   async_codec_t codec(executor);
+
+   std::vector<std::vector<unsigned char> > buffers(request_count);
+
+   for (std::size_t i = 0; i < buffers.size(); ++i)
+   {
+      buffers[i].resize(codewords_per_request * code_length);
+
+      for (std::size_t j = 0; j < buffers[i].size(); ++j)
+      {
+         buffers[i][j] = static_cast<unsigned char>((j * 31 + i) & 0xFF);
+      }
+   }
+
+   const std::size_t passed = schifra::reed_solomon::sync_wait(run_requests(codec, buffers));
+
+   std::cout << "Requests: " << codec.requests()
+             << "  Batches: " << codec.batches()
+             << "  Passed: "  << passed << "/" << request_count << std::endl;
+
+   {
+      std::ofstream input("input.dat", std::ios::binary);
+
+      for (std::size_t i = 0; i < 64 * data_length; ++i)
+      {
+         input.put(static_cast<char>(i * 7));
+      }
+   }
+
+   const schifra::reed_solomon::encoder<code_length,fec_length> encoder(field, generator_polynomial);
+   const schifra::reed_solomon::decoder<code_length,fec_length> decoder(field, generator_polynomial_index);
+
+   const bool files = schifra::reed_solomon::sync_wait(run_files(encoder, decoder));
+
+   std::cout << "File round trip: " << (files ? "passed" : "failed") << std::endl;
+
+   return ((request_count == passed) && files) ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+   std::cout << "Coroutine support (C++20) is not available." << std::endl;
+   return 0;
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+/*
+   Description: This example will demonstrate the use of the Reed-Solomon
+                codec_daemon, a long running process holding warm codecs
+                and worker threads, by short lived client processes. The
+                parent runs the daemon and forks clients, which encode and
+                decode through the daemon's shared memory ring buffers
+                rather than building codecs of their own.
+*/
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_daemon.hpp"
+#include "schifra/utils/schifra_utilities.hpp"
+
+
+/* Reed Solomon Code Parameters */
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+const std::size_t client_count   = 4;
+const std::size_t codeword_count = 4096;
+
+const char* const daemon_name = "/schifra-rs255-example";
+
+int run_client(const std::size_t id)
+{
+   schifra::reed_solomon::codec_client<code_length,fec_length> client(daemon_name);
+
+   if (!client.valid())
+      return 1;
+
+   std::vector<unsigned char> codewords(codeword_count * code_length, 0);
+
+   for (std::size_t i = 0; i < codewords.size(); ++i)
+   {
+      codewords[i] = static_cast<unsigned char>((i * 31 + id) & 0xFF);
+   }
+
+   schifra::utils::timer timer;
+   timer.start();
+
+   if (client.encode(&codewords[0], codeword_count) != codeword_count)
+   {
+      std::cout << "Error - Critical encoding failure!" << std::endl;
+      return 1;
+   }
+
+   const std::vector<unsigned char> encoded = codewords;
+
+   /* Corrupt fec_length / 2 symbols of every codeword */
+   for (std::size_t c = 0; c < codeword_count; ++c)
+   {
+      for (std::size_t e = 0; e < fec_length / 2; ++e)
+      {
+         codewords[c * code_length + ((e * 13 + c) % code_length)] ^= 0x5A;
+      }
+   }
+
+   if ((client.decode(&codewords[0], codeword_count) != codeword_count) || (codewords != encoded))
+   {
+      std::cout << "Error - Error correction failed!" << std::endl;
+      return 1;
+   }
+
+   timer.stop();
+
+   std::cout << "Client: " << id
+             << "  Codewords: " << codeword_count
+             << "  Data Rate: " << ((2.0 * codeword_count * data_length) * 8.0) / (1048576.0 * timer.time()) << "Mbps"
+             << "  Time: " << timer.time() << "sec" << std::endl;
+
+   return 0;
+}
+
+int main()
+{
+   /* Finite Field Parameters */
+   const std::size_t field_descriptor                =   8;
+   const std::size_t generator_polynomial_index      = 120;
+   const std::size_t generator_polynomial_root_count = fec_length;
+
+   /* Instantiate Finite Field and Generator Polynomials */
+   const schifra::galois::field field(field_descriptor,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            generator_polynomial_index,
+                                                            generator_polynomial_root_count,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   /* Instantiate the daemon, one worker per hardware thread */
+   schifra::reed_solomon::codec_daemon<code_length,fec_length> daemon(field,
+                                                                      generator_polynomial,
+                                                                      generator_polynomial_index,
+                                                                      daemon_name);
+
+   if (!daemon.valid())
+      return 1;
+
+   std::thread dispatcher([&daemon]() { daemon.run(); });
+
+   std::vector<pid_t> clients;
+
+   for (std::size_t i = 0; i < client_count; ++i)
+   {
+      const pid_t pid = fork();
+
+      if (0 == pid)
+      {
+         const int result = run_client(i);
+         std::cout.flush();
+         _exit(result);
+      }
+
+      clients.push_back(pid);
+   }
+
+   int result = 0;
+
+   for (std::size_t i = 0; i < clients.size(); ++i)
+   {
+      int status = 0;
+
+      if ((clients[i] < 0) || (waitpid(clients[i], &status, 0) < 0) || !WIFEXITED(status) || (0 != WEXITSTATUS(status)))
+         result = 1;
+   }
+
+   daemon.stop();
+   dispatcher.join();
+
+   std::cout << "Jobs: " << daemon.jobs() << std::endl;
+
+   return result;
+}
@@ -0,0 +1,172 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+/*
+   Description: This example will demonstrate the use of the Reed-Solomon
+                codec_server, a TCP front-end to a codec executor, by
+                codec_remote_client connections. The server runs in its
+                own thread, and client threads each stream buffers to it
+                to be encoded, then decoded after being corrupted, with
+                batches of every connection pipelined on the workers.
+*/
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_server.hpp"
+#include "schifra/utils/schifra_utilities.hpp"
+
+
+/* Reed Solomon Code Parameters */
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+const std::size_t client_count   = 4;
+const std::size_t codeword_count = 16384;
+
+bool run_client(const unsigned short port, const std::size_t id)
+{
+   schifra::reed_solomon::codec_remote_client<code_length,fec_length> client("127.0.0.1", port);
+
+   if (!client.valid())
+      return false;
+
+   std::vector<unsigned char> data     (codeword_count * data_length, 0);
+   std::vector<unsigned char> codewords(codeword_count * code_length, 0);
+   std::vector<unsigned char> decoded  (codeword_count * data_length, 0);
+
+   for (std::size_t i = 0; i < data.size(); ++i)
+   {
+      data[i] = static_cast<unsigned char>((i * 31 + id) & 0xFF);
+   }
+
+   schifra::utils::timer timer;
+   timer.start();
+
+   if (client.encode(&data[0], codeword_count, &codewords[0]) != codeword_count)
+   {
+      std::cout << "Error - Critical encoding failure!" << std::endl;
+      return false;
+   }
+
+   /* Corrupt fec_length / 2 symbols of every codeword */
+   for (std::size_t c = 0; c < codeword_count; ++c)
+   {
+      for (std::size_t e = 0; e < fec_length / 2; ++e)
+      {
+         codewords[c * code_length + ((e * 13 + c) % code_length)] ^= 0x5A;
+      }
+   }
+
+   if ((client.decode(&codewords[0], codeword_count, &decoded[0]) != codeword_count) || (decoded != data))
+   {
+      std::cout << "Error - Error correction failed!" << std::endl;
+      return false;
+   }
+
+   timer.stop();
+
+   std::cout << "Client: " << id
+             << "  Codewords: " << codeword_count
+             << "  Data Rate: " << ((2.0 * codeword_count * data_length) * 8.0) / (1048576.0 * timer.time()) << "Mbps"
+             << "  Time: " << timer.time() << "sec" << std::endl;
+
+   return true;
+}
+
+int main()
+{
+   /* Finite Field Parameters */
+   const std::size_t field_descriptor                =   8;
+   const std::size_t generator_polynomial_index      = 120;
+   const std::size_t generator_polynomial_root_count = fec_length;
+
+   /* Instantiate Finite Field and Generator Polynomials */
+   const schifra::galois::field field(field_descriptor,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            generator_polynomial_index,
+                                                            generator_polynomial_root_count,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   /* Instantiate the server on a port picked by the system, loopback only */
+   schifra::reed_solomon::codec_server<code_length,fec_length> server(field,
+                                                                      generator_polynomial,
+                                                                      generator_polynomial_index,
+                                                                      0,
+                                                                      0,
+                                                                      schifra::reed_solomon::codec_server<code_length,fec_length>::default_max_batch,
+                                                                      schifra::reed_solomon::codec_server<code_length,fec_length>::default_window,
+                                                                      "127.0.0.1");
+
+   if (!server.valid())
+      return 1;
+
+   std::thread acceptor([&server]() { server.run(); });
+
+   std::atomic<std::size_t> failures(0);
+
+   std::vector<std::thread> clients;
+
+   for (std::size_t i = 0; i < client_count; ++i)
+   {
+      clients.push_back(std::thread([&server, &failures, i]()
+                                    {
+                                       if (!run_client(server.port(), i))
+                                          ++failures;
+                                    }));
+   }
+
+   for (std::size_t i = 0; i < clients.size(); ++i)
+   {
+      clients[i].join();
+   }
+
+   server.stop();
+   acceptor.join();
+
+   std::cout << "Connections: " << server.connections()
+             << "  Batches: "   << server.batches()
+             << "  Codewords: " << server.codewords() << std::endl;
+
+   return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: This example will demonstrate the use of the Reed-Solomon
+                encoder and decoder in a threaded context through the
+                codec_executor, a persistent pool of worker threads each
+                owning its own codec. Batches of blocks are submitted, and
+                the returned futures report how many were processed.
+*/
+
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/utils/schifra_error_processes.hpp"
+#include "schifra/utils/schifra_utilities.hpp"
+
+
+const std::size_t round_count = 100;
+
+int main()
+{
+   /* Reed Solomon Code Parameters */
+   const std::size_t code_length = 255;
+   const std::size_t fec_length  =  32;
+   const std::size_t data_length = code_length - fec_length;
+
+   /* Finite Field Parameters */
+   const std::size_t field_descriptor                =   8;
+   const std::size_t generator_polynomial_index      = 120;
+   const std::size_t generator_polynomial_root_count = fec_length;
+
+   /* Instantiate Finite Field and Generator Polynomials */
+   const schifra::galois::field field(field_descriptor,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (
+        !schifra::make_sequential_root_generator_polynomial(field,
+                                                            generator_polynomial_index,
+                                                            generator_polynomial_root_count,
+                                                            generator_polynomial)
+      )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return 1;
+   }
+
+   typedef schifra::reed_solomon::codec_executor<code_length,fec_length> executor_type;
+   typedef executor_type::block_type                                     block_type;
+
+   /* Instantiate the executor, one worker per hardware thread */
+   executor_type executor(field, generator_polynomial, generator_polynomial_index);
+
+   std::vector<std::string> message_list;
+
+   for (unsigned int c = 0; c < 256; ++c)
+   {
+      message_list.push_back(std::string(data_length, static_cast<unsigned char>(c)));
+   }
+
+   std::vector<block_type> block_list(message_list.size());
+
+   for (std::size_t i = 0; i < message_list.size(); ++i)
+   {
+      for (std::size_t j = 0; j < data_length; ++j)
+      {
+         block_list[i].data[j] = static_cast<unsigned char>(message_list[i][j]);
+      }
+   }
+
+   if (executor.encode(&block_list[0], block_list.size()).get() != block_list.size())
+   {
+      std::cout << "Error - Critical encoding failure!" << std::endl;
+      return 1;
+   }
+
+   const std::vector<block_type> encoded_list = block_list;
+
+   schifra::utils::timer timer;
+   timer.start();
+
+   for (std::size_t k = 0; k < round_count; ++k)
+   {
+      block_list = encoded_list;
+
+      for (std::size_t i = 0; i < block_list.size(); ++i)
+      {
+         schifra::corrupt_message_all_errors00(block_list[i], 0, 3);
+      }
+
+      if (executor.decode(&block_list[0], block_list.size()).get() != block_list.size())
+      {
+         std::cout << "Error - Critical decoding failure!" << std::endl;
+         return 1;
+      }
+   }
+
+   timer.stop();
+
+   for (std::size_t i = 0; i < block_list.size(); ++i)
+   {
+      if (!schifra::is_block_equivelent(block_list[i], message_list[i]))
+      {
+         std::cout << "Error - Error correction failed!" << std::endl;
+         return 1;
+      }
+   }
+
+   const double blocks_decoded = static_cast<double>(round_count * block_list.size());
+
+   std::cout << "Threads: " << executor.threads()
+             << "  Blocks Decoded: " << blocks_decoded
+             << "  Data Rate: " << ((blocks_decoded * data_length) * 8.0) / (1048576.0 * timer.time()) << "Mbps"
+             << "  Time: " << timer.time() << "sec" << std::endl;
+
+   return 0;
+}
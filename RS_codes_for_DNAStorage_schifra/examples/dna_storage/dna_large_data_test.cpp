@@ -28,21 +28,6 @@ std::vector<std::string> split_into_blocks(const std::string& input, size_t bloc
     return blocks;
 }
 
-// Function to pad the last block if needed
-std::string pad_block(std::string block, size_t target_size) {
-    if (block.size() >= target_size) return block;
-    
-    // Use 'A' as padding character (must be a valid DNA base: A, C, G, or T)
-    block.append(target_size - block.size(), 'A');
-    return block;
-}
-
-// Function to remove padding from the last block
-std::string remove_padding(const std::string& block, size_t original_size) {
-    if (block.size() <= original_size) return block;
-    return block.substr(0, original_size);
-}
-
 // Function to introduce random errors into a DNA sequence
 std::string introduce_errors(const std::string& sequence, size_t error_count) {
     if (error_count == 0) return sequence;
@@ -75,10 +60,13 @@ bool process_block(const std::string& original_block,
                   size_t error_count,
                   std::string& decoded_sequence) {
     try {
-        dna_storage_type dna_storage;
+        static const dna_storage_type dna_storage;
         
         // Encode the block
-        auto [encoded_dna, ecc] = dna_storage.encode(original_block);
+        // A short last block is encoded as a shortened codeword, its
+        // padding virtual
+        const bool tail = original_block.size() < BLOCK_SIZE;
+        auto [encoded_dna, ecc] = tail ? dna_storage.encode_tail(original_block) : dna_storage.encode(original_block);
         
         // Introduce errors (but ensure we don't exceed the maximum correctable errors)
         size_t max_errors = ECC_SYMBOLS / 2;  // RS can correct t = (n-k)/2 errors
@@ -86,7 +74,7 @@ bool process_block(const std::string& original_block,
         std::string corrupted = introduce_errors(encoded_dna, errors_to_introduce);
         
         // Decode and correct errors
-        std::string corrected = dna_storage.decode(corrupted, ecc);
+        std::string corrected = tail ? dna_storage.decode_tail(corrupted, ecc) : dna_storage.decode(corrupted, ecc);
         
         // Store the decoded block (without ECC symbols)
         decoded_sequence = corrected.substr(0, original_block.size());
@@ -111,13 +99,7 @@ bool process_dna_sequence(const std::string& input_sequence,
     // Process each block
     bool all_blocks_processed = true;
     for (size_t i = 0; i < blocks.size(); ++i) {
-        std::string original_block = blocks[i];
-        bool is_last_block = (i == blocks.size() - 1);
-        
-        // Pad the last block if needed
-        if (is_last_block && original_block.size() < BLOCK_SIZE) {
-            original_block = pad_block(original_block, BLOCK_SIZE);
-        }
+        const std::string& original_block = blocks[i];
         
         // Process the block
         std::string decoded_block;
@@ -128,11 +110,6 @@ bool process_dna_sequence(const std::string& input_sequence,
             break;
         }
         
-        // Remove padding from the last block
-        if (is_last_block && blocks[i].size() < BLOCK_SIZE) {
-            decoded_block = remove_padding(decoded_block, blocks[i].size());
-        }
-        
         decoded_blocks.push_back(decoded_block);
     }
     
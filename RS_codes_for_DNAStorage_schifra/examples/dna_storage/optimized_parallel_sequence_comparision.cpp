@@ -102,7 +102,7 @@
                    size_t error_count,
                    std::string& decoded_sequence) {
      try {
-         dna_storage_type dna_storage;
+         static const dna_storage_type dna_storage;
          auto [encoded_dna, ecc] = dna_storage.encode(std::string(original_block));
          size_t max_errors = ECC_SYMBOLS / 2;
          size_t errors_to_introduce = std::min(error_count, max_errors);
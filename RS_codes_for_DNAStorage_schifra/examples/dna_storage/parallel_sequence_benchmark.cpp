@@ -5,6 +5,14 @@
  * - Comprehensive benchmarking with warmup runs
  * - Thread scaling analysis
  * - Error injection and correction tracking
+ * - Per-block decode latency histograms (p50/p90/p99/p999) by error count
+ * - Error injection rate sweep with CSV output (--sweep [--csv=file])
+ * - Reproducible error injection (--seed=N), see schifra_channel_simulator.hpp
+ * - Hardware performance counters per case (--perf or SCHIFRA_PERF_COUNTERS=1)
+ * - RAPL package/DRAM energy in J/MB per case and thread count
+ *   (--energy or SCHIFRA_ENERGY=1)
+ * - Thread scaling with pinning and NUMA placement
+ *   (--scaling [--pin=compact|scatter|none] [--numa-node=N] [--errors=N] [--csv=file])
  * - Memory-efficient processing
  */
 
@@ -19,11 +27,17 @@
 #include <algorithm>
 #include <omp.h>
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <unistd.h>
 #include <fstream>
 #include <sstream>
 #include "../../include/schifra/dna_storage.hpp"
+#include "../../include/schifra/utils/schifra_channel_simulator.hpp"
+#include "../../include/schifra/utils/schifra_latency_histogram.hpp"
+#include "../../include/schifra/utils/schifra_perf_counters.hpp"
+#include "../../include/schifra/utils/schifra_energy_meter.hpp"
+#include "../../include/schifra/utils/schifra_cpu_topology.hpp"
 
 // Using RS(15,11) which can correct up to 2 symbol errors
 constexpr size_t BLOCK_SIZE = 11;  // k = 11
@@ -31,6 +45,34 @@ constexpr size_t CODE_LENGTH = 15;  // n = 15
 constexpr size_t ECC_SYMBOLS = CODE_LENGTH - BLOCK_SIZE;  // 4 ECC symbols
 
 using dna_storage_type = schifra::dna_storage<CODE_LENGTH, ECC_SYMBOLS, BLOCK_SIZE>;
+using latency_histogram = schifra::utils::latency_histogram;
+using perf_counters = schifra::utils::perf_counters;
+using energy_meter = schifra::utils::energy_meter;
+
+// Set by --perf or SCHIFRA_PERF_COUNTERS=1
+bool collect_perf_counters = perf_counters::requested();
+
+// Set by --energy or SCHIFRA_ENERGY=1. RAPL counts whole packages, so the
+// one meter is read by the main thread around each parallel run.
+bool collect_energy = energy_meter::requested();
+std::unique_ptr<energy_meter> energy;
+
+// Decode latency classes: blocks decoded with 0, 1 or 2 symbol errors in
+// their data, and blocks that failed to decode or were miscorrected
+enum LatencyClass { LATENCY_0_ERRORS, LATENCY_1_ERROR, LATENCY_2_ERRORS, LATENCY_UNCORRECTABLE, LATENCY_CLASSES };
+
+const char* const LATENCY_CLASS_NAMES[LATENCY_CLASSES] = { "0_errors", "1_error", "2_errors", "uncorrectable" };
+
+// Per-block decode latencies in nanoseconds, one histogram per class
+struct LatencyStats {
+    latency_histogram classes[LATENCY_CLASSES];
+
+    void merge(const LatencyStats& other) {
+        for (int c = 0; c < LATENCY_CLASSES; ++c) {
+            classes[c].merge(other.classes[c]);
+        }
+    }
+};
 
 // Structure to store benchmarking results
 struct BenchmarkResult {
@@ -41,6 +83,9 @@ struct BenchmarkResult {
     double throughput = 0.0;              // in MB/s
     int num_threads = 1;
     size_t sequence_length = 0;
+    LatencyStats decode_latency;
+    perf_counters::reading perf;          // summed over all worker threads
+    energy_meter::reading energy;         // package-wide, over the parallel run
     
     // Calculate average block processing time
     double avg_block_processing_time() const {
@@ -71,36 +116,59 @@ std::string pad_block(std::string block, size_t target_size) {
     return block;
 }
 
-// Thread-safe function to introduce random errors into a DNA sequence
+// Seed of the error injectors, --seed=N for reproducible runs
+std::uint64_t error_seed = std::random_device{}();
+
+// Per thread error injector: stream i of error_seed on OpenMP thread i, so
+// that a seeded run repeats for a given thread count
+schifra::utils::channel::channel_simulator& thread_channel() {
+    thread_local schifra::utils::channel::channel_simulator channel(
+        schifra::utils::channel::channel_model(), error_seed, static_cast<std::uint64_t>(omp_get_thread_num()));
+    return channel;
+}
+
+// Thread-safe function to substitute error_count distinct bases of a DNA sequence
 std::string introduce_errors(const std::string& sequence, size_t error_count) {
     if (error_count == 0) return sequence;
     
     std::string corrupted = sequence;
-    thread_local std::random_device rd;
-    thread_local std::mt19937 gen(rd());
-    std::uniform_int_distribution<> pos_dist(0, sequence.length() - 1);
-    std::string bases = "ACGT";
+    thread_channel().corrupt_bases_fixed(&corrupted[0], corrupted.size(), corrupted.size(), 1, error_count);
+    return corrupted;
+}
+
+// Thread-safe function to substitute each base with probability error_rate
+std::string introduce_errors_at_rate(const std::string& sequence, double error_rate) {
+    if (error_rate <= 0.0) return sequence;
     
-    for (size_t i = 0; i < error_count; ++i) {
-        size_t pos = pos_dist(gen);
-        char original = corrupted[pos];
-        char new_base;
-        
-        // Ensure we pick a different base
-        do {
-            new_base = bases[gen() % 4];
-        } while (new_base == original);
-        
-        corrupted[pos] = new_base;
+    schifra::utils::channel::channel_simulator& channel = thread_channel();
+    if (channel.model().substitution_rate != error_rate) {
+        schifra::utils::channel::channel_model model;
+        model.substitution_rate = error_rate;
+        channel.set_model(model);
     }
     
+    std::string corrupted = sequence;
+    channel.corrupt_bases(&corrupted[0], corrupted.size());
     return corrupted;
 }
 
-// Process DNA sequence with benchmarking
+// Symbol errors decode() has to correct: only the data bases are decoded,
+// the ECC travels as symbols
+size_t count_data_errors(const std::string& encoded, const std::string& corrupted) {
+    size_t errors = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        errors += (encoded[i] != corrupted[i]);
+    }
+    return errors;
+}
+
+// Process DNA sequence with benchmarking. A negative error_rate injects
+// errors_per_block errors per block, otherwise every base is substituted
+// with probability error_rate.
 BenchmarkResult process_dna_sequence_benchmark(const std::string& input_sequence, 
                                              size_t errors_per_block,
-                                             int num_threads = 0) {
+                                             int num_threads = 0,
+                                             double error_rate = -1.0) {
     BenchmarkResult result;
     result.sequence_length = input_sequence.length();
     
@@ -124,11 +192,29 @@ BenchmarkResult process_dna_sequence_benchmark(const std::string& input_sequence
     std::vector<std::string> decoded_blocks(blocks.size());
     std::vector<BlockStats> block_stats(blocks.size());
     
+    // One set of latency histograms per thread, merged afterwards
+    std::vector<LatencyStats> thread_latency(omp_get_max_threads());
+    
+    if (energy) {
+        energy->reset();
+        energy->start();
+    }
+    
     // Process blocks in parallel
-    #pragma omp parallel for schedule(dynamic, 32)
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        try {
-            dna_storage_type dna_storage;
+    #pragma omp parallel
+    {
+        // Counters follow the thread that opens them, so each thread has its own
+        std::unique_ptr<perf_counters> counters;
+        if (collect_perf_counters) {
+            counters.reset(new perf_counters);
+            counters->start();
+        }
+        
+        dna_storage_type dna_storage;
+        
+        #pragma omp for schedule(dynamic, 32)
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            LatencyStats& latency = thread_latency[omp_get_thread_num()];
             BlockStats stats;
             
             // Pad block if needed
@@ -137,21 +223,42 @@ BenchmarkResult process_dna_sequence_benchmark(const std::string& input_sequence
                 original_block = pad_block(original_block, BLOCK_SIZE);
             }
             
-            // Encode
+            // Encode, through the status returning API: failures are
+            // routine at high error rates and cost no stack unwinding
+            std::string encoded_dna(CODE_LENGTH, 'A');
+            std::uint8_t ecc[ECC_SYMBOLS];
             auto encode_start = std::chrono::high_resolution_clock::now();
-            auto [encoded_dna, ecc] = dna_storage.encode(original_block);
+            const auto encoded = dna_storage.try_encode(original_block, &encoded_dna[0], ecc);
             auto encode_end = std::chrono::high_resolution_clock::now();
+            if (!encoded) {
+                #pragma omp critical
+                std::cerr << "Error encoding block " << i << std::endl;
+                continue;
+            }
             
             // Introduce errors
             size_t max_errors = ECC_SYMBOLS / 2;
             size_t errors_to_introduce = std::min(errors_per_block, max_errors);
-            std::string corrupted = introduce_errors(encoded_dna, errors_to_introduce);
+            std::string corrupted = (error_rate < 0.0) ? introduce_errors(encoded_dna, errors_to_introduce)
+                                                       : introduce_errors_at_rate(encoded_dna, error_rate);
+            const size_t data_errors = count_data_errors(encoded_dna, corrupted);
             
             // Decode
+            std::string corrected(BLOCK_SIZE, 'A');
             auto decode_start = std::chrono::high_resolution_clock::now();
-            std::string corrected = dna_storage.decode(corrupted, ecc);
+            const auto decoded = dna_storage.try_decode(corrupted, ecc, &corrected[0]);
             auto decode_end = std::chrono::high_resolution_clock::now();
             
+            const auto decode_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(decode_end - decode_start).count();
+            const int latency_class = (!decoded || (corrected != original_block)) ? LATENCY_UNCORRECTABLE
+                                                                                   : static_cast<int>(std::min<size_t>(data_errors, 2));
+            latency.classes[latency_class].record(static_cast<std::uint64_t>(decode_ns));
+            
+            // A failed decode is an uncorrectable block, not an error
+            if (!decoded) {
+                continue;
+            }
+            
             // Update timing stats
             stats.encoding_time = std::chrono::duration<double, std::milli>(
                 encode_end - encode_start).count();
@@ -161,14 +268,24 @@ BenchmarkResult process_dna_sequence_benchmark(const std::string& input_sequence
             // Store results
             block_stats[i] = stats;
             decoded_blocks[i] = corrected.substr(0, blocks[i].size());
-            
-        } catch (const std::exception& e) {
-            // Handle error for this block
+        }
+        
+        if (counters) {
+            counters->stop();
             #pragma omp critical
-            std::cerr << "Error processing block: " << e.what() << std::endl;
+            result.perf.merge(counters->totals());
         }
     }
     
+    if (energy) {
+        energy->stop();
+        result.energy = energy->totals();
+    }
+    
+    for (const auto& latency : thread_latency) {
+        result.decode_latency.merge(latency);
+    }
+    
     // Aggregate timing results
     for (const auto& stats : block_stats) {
         result.total_encoding_time += stats.encoding_time;
@@ -187,6 +304,26 @@ BenchmarkResult process_dna_sequence_benchmark(const std::string& input_sequence
     return result;
 }
 
+// Function to print the decode latency percentiles of each error class
+void print_latency_report(const LatencyStats& latency) {
+    std::cout << "Decode latency (ns):" << std::endl;
+    std::cout << "  " << std::left << std::setw(15) << "class"
+              << std::right << std::setw(10) << "blocks"
+              << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "p999"
+              << std::setw(10) << "max" << std::endl;
+    
+    for (int c = 0; c < LATENCY_CLASSES; ++c) {
+        const latency_histogram& h = latency.classes[c];
+        if (h.count() == 0) continue;
+        std::cout << "  " << std::left << std::setw(15) << LATENCY_CLASS_NAMES[c]
+                  << std::right << std::setw(10) << h.count()
+                  << std::setw(10) << h.percentile(50.0) << std::setw(10) << h.percentile(90.0)
+                  << std::setw(10) << h.percentile(99.0) << std::setw(10) << h.percentile(99.9)
+                  << std::setw(10) << h.max() << std::endl;
+    }
+}
+
 // Function to print benchmark results
 void print_benchmark_results(const BenchmarkResult& result, const std::string& label = "") {
     if (!label.empty()) {
@@ -209,13 +346,25 @@ void print_benchmark_results(const BenchmarkResult& result, const std::string& l
               << result.avg_block_processing_time() << " ms/block" << std::endl;
     std::cout << "Throughput:                " << std::fixed << std::setprecision(2) 
               << result.throughput << " MB/s" << std::endl;
+    print_latency_report(result.decode_latency);
+    if (collect_perf_counters) {
+        std::cout << std::flush;
+        result.perf.print(stdout, static_cast<double>(result.sequence_length), "base");
+    }
+    if (collect_energy) {
+        // Every base is encoded and decoded within the one run, so the
+        // joules are those of a MB encoded plus decoded
+        std::cout << std::flush;
+        result.energy.print(stdout, result.sequence_length / (1024.0 * 1024.0), "MB");
+    }
 }
 
 // Function to run a single benchmark case with warmup and multiple runs
 BenchmarkResult run_benchmark_case(const std::string& sequence, 
                                  size_t errors_per_block,
                                  int num_threads,
-                                 const std::string& label = "") {
+                                 const std::string& label = "",
+                                 double error_rate = -1.0) {
     const int WARMUP_RUNS = 1;
     const int BENCHMARK_RUNS = 3;
     
@@ -224,14 +373,14 @@ BenchmarkResult run_benchmark_case(const std::string& sequence,
     
     // Warmup runs
     for (int i = 0; i < WARMUP_RUNS; ++i) {
-        (void)process_dna_sequence_benchmark(sequence, errors_per_block, num_threads);
+        (void)process_dna_sequence_benchmark(sequence, errors_per_block, num_threads, error_rate);
     }
     
     // Benchmark runs
     for (int run = 0; run < BENCHMARK_RUNS; ++run) {
         auto start = std::chrono::high_resolution_clock::now();
         BenchmarkResult result = process_dna_sequence_benchmark(
-            sequence, errors_per_block, num_threads);
+            sequence, errors_per_block, num_threads, error_rate);
         auto end = std::chrono::high_resolution_clock::now();
         
         double total_time = std::chrono::duration<double, std::milli>(end - start).count();
@@ -332,8 +481,258 @@ void run_comprehensive_benchmarks() {
     }
 }
 
+// Function to sweep per-base error injection rates, writing one CSV row per
+// rate and latency class (see Benchmark_results/decode_latency_vs_error_rate.py)
+void run_error_rate_sweep(const std::string& csv_file) {
+    std::cout << "=== Decode Latency vs Error Injection Rate ===" << std::endl;
+    
+    const std::vector<double> error_rates = {0.0, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2};
+    const std::string sequence = generate_random_dna(1000000);
+    
+    std::ofstream csv(csv_file);
+    if (!csv) {
+        throw std::runtime_error("Cannot create " + csv_file);
+    }
+    csv << "error_rate,class,blocks,fraction,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,throughput_mbps\n";
+    
+    for (double rate : error_rates) {
+        auto result = run_benchmark_case(sequence, 0, 0, "", rate);
+        
+        std::cout << "\n=== Error rate " << std::defaultfloat << rate << " per base ===" << std::endl;
+        print_benchmark_results(result);
+        
+        for (int c = 0; c < LATENCY_CLASSES; ++c) {
+            const latency_histogram& h = result.decode_latency.classes[c];
+            csv << rate << "," << LATENCY_CLASS_NAMES[c] << "," << h.count() << ","
+                << (result.total_blocks ? static_cast<double>(h.count()) / result.total_blocks : 0.0) << ","
+                << h.mean() << "," << h.percentile(50.0) << "," << h.percentile(90.0) << ","
+                << h.percentile(99.0) << "," << h.percentile(99.9) << "," << h.max() << ","
+                << result.throughput << "\n";
+        }
+    }
+    
+    std::cout << "\nWrote " << csv_file << std::endl;
+}
+
+// Thread scaling of codeword decoding with controlled placement. Codewords
+// (data and parity symbols, 1 byte each) are encoded once into a flat
+// buffer whose pages are first touched by a thread pinned to numa_node, so
+// the buffer lives on that node. Each thread count up to all hardware
+// threads then decodes the whole buffer, threads pinned in the given order,
+// and the best of three runs is reported: throughput, speedup and parallel
+// efficiency against one thread, and the bandwidth drawn by the threads of
+// each socket.
+void run_scaling_benchmark_pinned(schifra::utils::cpu_topology::placement_t placement,
+                                  int numa_node,
+                                  size_t errors_per_block,
+                                  const std::string& csv_file) {
+    using schifra::utils::cpu_topology;
+    using schifra::utils::logical_cpu;
+    
+    const cpu_topology topology;
+    const std::vector<logical_cpu> order = topology.order(placement);
+    const size_t sockets = topology.socket_count();
+    
+    std::cout << "=== Thread Scaling (pinning: " << cpu_topology::placement_name(placement)
+              << ", NUMA node: " << (numa_node < 0 ? std::string("any") : std::to_string(numa_node)) << ") ===" << std::endl;
+    std::cout << "Hardware threads: " << order.size() << ", sockets: " << sockets << std::endl;
+    std::cout << "Pin order:";
+    for (const auto& cpu : order) {
+        std::cout << " " << cpu.id << "(s" << cpu.socket << "c" << cpu.core << "n" << cpu.node << ")";
+    }
+    std::cout << std::endl;
+    
+    const size_t codeword_count = 1 << 19;
+    const size_t bytes = codeword_count * CODE_LENGTH;
+    
+    // Not value-initialised: the pages are first touched by the filler thread
+    std::unique_ptr<std::uint8_t[]> buffer(new std::uint8_t[bytes]);
+    const dna_storage_type dna_storage;
+    
+    auto fill = [&]() {
+        std::mt19937 gen(12345);
+        for (size_t c = 0; c < codeword_count; ++c) {
+            std::uint8_t* codeword = buffer.get() + c * CODE_LENGTH;
+            for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                codeword[i] = static_cast<std::uint8_t>(gen() & 3);
+            }
+            dna_storage.encode(schifra::utils::span<const std::uint8_t>(codeword, BLOCK_SIZE),
+                               schifra::utils::span<std::uint8_t>(codeword + BLOCK_SIZE, ECC_SYMBOLS));
+            for (size_t e = 0; e < std::min(errors_per_block, ECC_SYMBOLS / 2); ++e) {
+                codeword[(c + e * 5) % BLOCK_SIZE] ^= 1;
+            }
+        }
+    };
+    
+    if (numa_node >= 0) {
+        const int cpu = topology.first_cpu_of_node(numa_node);
+        if (cpu < 0) {
+            throw std::invalid_argument("No usable cpu on NUMA node " + std::to_string(numa_node));
+        }
+        std::thread filler([&]() {
+            cpu_topology::pin_current_thread(cpu);
+            fill();
+        });
+        filler.join();
+    } else {
+        fill();
+    }
+    
+    std::vector<int> thread_counts;
+    for (int t = 1; t < static_cast<int>(order.size()); t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(static_cast<int>(order.size()));
+    
+    std::ofstream csv(csv_file);
+    if (!csv) {
+        throw std::runtime_error("Cannot create " + csv_file);
+    }
+    csv << "placement,numa_node,threads,time_ms,throughput_mbps,speedup,efficiency,socket,socket_threads,socket_bandwidth_mbps,joules_per_mb\n";
+    
+    std::cout << "Threads\tTime(ms)\tMB/s\tSpeedup\tEfficiency\t" << (energy ? "J/MB\t" : "") << "Per-socket MB/s" << std::endl;
+    
+    double single_thread_mbps = 0.0;
+    
+    for (int t : thread_counts) {
+        omp_set_num_threads(t);
+        
+        double best_ms = std::numeric_limits<double>::max();
+        std::vector<size_t> best_socket_bytes(sockets, 0);
+        std::vector<int> socket_threads(sockets, 0);
+        energy_meter::reading best_energy;
+        
+        // One warmup run, then the best of three
+        for (int run = 0; run < 4; ++run) {
+            std::vector<size_t> thread_bytes(t, 0);
+            std::vector<int> thread_socket(t, 0);
+            std::atomic<size_t> failures(0);
+            
+            if (energy) {
+                energy->reset();
+                energy->start();
+            }
+            
+            const auto start = std::chrono::high_resolution_clock::now();
+            
+            #pragma omp parallel
+            {
+                const int tid = omp_get_thread_num();
+                const logical_cpu& cpu = order[tid % order.size()];
+                if (placement != cpu_topology::e_none) {
+                    cpu_topology::pin_current_thread(cpu.id);
+                }
+                thread_socket[tid] = cpu.socket;
+                
+                size_t local_bytes = 0;
+                std::uint8_t codeword[CODE_LENGTH];
+                
+                #pragma omp for schedule(static)
+                for (size_t c = 0; c < codeword_count; ++c) {
+                    std::copy(buffer.get() + c * CODE_LENGTH, buffer.get() + (c + 1) * CODE_LENGTH, codeword);
+                    if (!dna_storage.try_decode(schifra::utils::span<std::uint8_t>(codeword, CODE_LENGTH))) {
+                        ++failures;
+                    }
+                    local_bytes += CODE_LENGTH;
+                }
+                
+                thread_bytes[tid] = local_bytes;
+            }
+            
+            const double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            
+            if (energy) {
+                energy->stop();
+            }
+            
+            if (failures != 0) {
+                throw std::runtime_error("Decoding failed in the scaling benchmark");
+            }
+            
+            if (run > 0 && ms < best_ms) {
+                best_ms = ms;
+                if (energy) {
+                    best_energy = energy->totals();
+                }
+                std::fill(best_socket_bytes.begin(), best_socket_bytes.end(), 0);
+                std::fill(socket_threads.begin(), socket_threads.end(), 0);
+                for (int i = 0; i < t; ++i) {
+                    best_socket_bytes[thread_socket[i]] += thread_bytes[i];
+                    ++socket_threads[thread_socket[i]];
+                }
+            }
+        }
+        
+        const double mbps = (bytes / (1024.0 * 1024.0)) / (best_ms / 1000.0);
+        if (t == 1) single_thread_mbps = mbps;
+        const double speedup = (single_thread_mbps > 0.0) ? mbps / single_thread_mbps : 0.0;
+        const double efficiency = speedup / t;
+        // Decoded MB, as throughput
+        const double joules_per_mb = best_energy.per(bytes / (1024.0 * 1024.0));
+        
+        std::cout << t << "\t" << std::fixed << std::setprecision(2) << best_ms << "\t\t" << mbps
+                  << "\t" << speedup << "x\t" << (efficiency * 100.0) << "%\t\t";
+        if (energy) {
+            std::cout << std::setprecision(4) << joules_per_mb << "\t" << std::setprecision(2);
+        }
+        
+        for (size_t sock = 0; sock < sockets; ++sock) {
+            const double socket_mbps = (best_socket_bytes[sock] / (1024.0 * 1024.0)) / (best_ms / 1000.0);
+            std::cout << "s" << sock << ":" << socket_mbps << " ";
+            csv << cpu_topology::placement_name(placement) << "," << numa_node << "," << t << ","
+                << best_ms << "," << mbps << "," << speedup << "," << efficiency << ","
+                << sock << "," << socket_threads[sock] << "," << socket_mbps << ",";
+            if (best_energy.any()) {
+                csv << joules_per_mb;
+            }
+            csv << "\n";
+        }
+        std::cout << std::endl;
+    }
+    
+    std::cout << "\nWrote " << csv_file << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     try {
+        bool sweep = false;
+        bool scaling = false;
+        schifra::utils::cpu_topology::placement_t placement = schifra::utils::cpu_topology::e_compact;
+        int numa_node = -1;
+        size_t scaling_errors = 1;
+        std::string csv_file;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--sweep") {
+                sweep = true;
+            } else if (arg == "--scaling") {
+                scaling = true;
+            } else if (arg == "--pin=compact") {
+                placement = schifra::utils::cpu_topology::e_compact;
+            } else if (arg == "--pin=scatter") {
+                placement = schifra::utils::cpu_topology::e_scatter;
+            } else if (arg == "--pin=none") {
+                placement = schifra::utils::cpu_topology::e_none;
+            } else if (arg.rfind("--numa-node=", 0) == 0) {
+                numa_node = std::stoi(arg.substr(12));
+            } else if (arg.rfind("--errors=", 0) == 0) {
+                scaling_errors = std::stoul(arg.substr(9));
+            } else if (arg == "--perf") {
+                collect_perf_counters = true;
+            } else if (arg == "--energy") {
+                collect_energy = true;
+            } else if (arg.rfind("--csv=", 0) == 0) {
+                csv_file = arg.substr(6);
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                error_seed = std::stoull(arg.substr(7));
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [--sweep] [--scaling [--pin=compact|scatter|none]"
+                          << " [--numa-node=N] [--errors=N]] [--csv=file] [--perf] [--energy] [--seed=N]" << std::endl;
+                return 1;
+            }
+        }
+        
         // Print system and OpenMP information
         std::cout << "=== System Information ===" << std::endl;
         std::cout << "CPU Cores: " << sysconf(_SC_NPROCESSORS_ONLN) << std::endl;
@@ -344,9 +743,30 @@ int main(int argc, char* argv[]) {
             return 1;
         #endif
         
+        if (collect_energy) {
+            energy.reset(new energy_meter);
+            if (energy->available()) {
+                std::cout << "Energy: RAPL via " << energy->source() << " (package-wide)" << std::endl;
+            } else {
+                std::cout << "Energy: RAPL counters unavailable" << std::endl;
+                energy.reset();
+            }
+        }
+        
         // Configure OpenMP
         omp_set_dynamic(0);  // Disable dynamic adjustment of threads
         
+        if (sweep) {
+            run_error_rate_sweep(csv_file.empty() ? "decode_latency_vs_error_rate.csv" : csv_file);
+            return 0;
+        }
+        
+        if (scaling) {
+            run_scaling_benchmark_pinned(placement, numa_node, scaling_errors,
+                                         csv_file.empty() ? "thread_scaling.csv" : csv_file);
+            return 0;
+        }
+        
         // Run comprehensive benchmarks
         run_comprehensive_benchmarks();
         
@@ -81,10 +81,11 @@ void process_blocks_parallel(const std::vector<std::string>& blocks,
                            int num_threads) {
     omp_set_num_threads(num_threads);
     
+    const dna_storage_type dna_storage;
+    
     #pragma omp parallel for schedule(dynamic)
     for (size_t i = 0; i < blocks.size(); ++i) {
         try {
-            dna_storage_type dna_storage;
             std::string block = blocks[i];
             bool is_last_block = (i == blocks.size() - 1);
             
@@ -25,6 +25,7 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <chrono>
 #include <cstdint>
 
 #include "schifra/dna_storage.hpp"
@@ -39,6 +40,8 @@ void print_help() {
               << "\nCommands:\n"
               << "  encode <input_file> <output_file>  Encode a file with DNA storage\n"
               << "  decode <input_file> <output_file>  Decode a file with DNA storage\n"
+              << "  reads <fasta|fastq> <output_file> [min_quality]\n"
+              << "                                    Decode in-band strands from sequencer reads\n"
               << "  example                           Run a simple example\n";
 }
 
@@ -113,6 +116,40 @@ void process_file(const std::string& input_file,
     }
 }
 
+// Decode the in-band strands of a FASTA/FASTQ file, one strand per read,
+// FASTQ bases below min_quality being passed to the decoder as erasures
+void process_reads(const std::string& input_file,
+                   const std::string& output_file,
+                   std::uint8_t min_quality) {
+    std::ifstream input(input_file, std::ios::binary);
+    std::ofstream output(output_file, std::ios::binary);
+    if (!input || !output) {
+        std::cerr << "Error: Cannot open " << (!input ? input_file : output_file) << "\n";
+        std::exit(1);
+    }
+
+    try {
+        dna_storage_type dna_storage;
+        dna_storage_type::sequence_buffer out;
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t decoded = dna_storage.decode_fastq(input, out, min_quality);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        output.write(out.dna.data(), static_cast<std::streamsize>(out.dna.size()));
+
+        std::cout << "Reads:         " << out.blocks() << "\n"
+                  << "Decoded:       " << decoded << "\n"
+                  << "Corrected:     " << out.count(dna_storage_type::block_status::corrected) << "\n"
+                  << "Uncorrectable: " << out.count(dna_storage_type::block_status::uncorrectable) << "\n"
+                  << "Invalid:       " << out.count(dna_storage_type::block_status::invalid) << "\n"
+                  << "Time:          " << std::fixed << std::setprecision(3) << elapsed.count() << " s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::exit(1);
+    }
+}
+
 int main(int argc, char* argv[]) {
     // Parse command line arguments
     if (argc < 2) {
@@ -145,6 +182,16 @@ int main(int argc, char* argv[]) {
         std::string output_file = argv[3];
         
         process_file(input_file, output_file, command == "encode");
+    } else if (command == "reads") {
+        if (argc < 4) {
+            std::cerr << "Error: Missing input/output file arguments\n";
+            print_help();
+            return 1;
+        }
+
+        const std::uint8_t min_quality = (argc > 4) ? static_cast<std::uint8_t>(std::stoi(argv[4])) : 20;
+
+        process_reads(argv[2], argv[3], min_quality);
     } else {
         std::cerr << "Error: Unknown command '" << command << "'\n";
         print_help();
@@ -30,7 +30,9 @@
 #include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_file_encoder.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_file_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_file_interleaved_codec.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_file_interleaver.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_parallel_file_codec.hpp"
 #include "schifra/utils/schifra_error_processes.hpp"
 #include "schifra/utils/schifra_fileio.hpp"
 
@@ -48,6 +50,10 @@
    5. Deinterleave the file
    6. Reed-Solomon decode the file attempting to correct all encountered errors
    7. Compare the original file to the final output file
+   8. Repeat steps 2 to 7 with the fused encode+interleave and deinterleave+decode
+      stages, which never write the intermediate files
+   9. Repeat steps 2 to 7 once more with the parallel forms of the fused
+      stages, stacks being interleaved and decoded by worker threads
 */
 
 void create_file(const std::string& file_name, const std::size_t file_size)
@@ -77,6 +83,10 @@ int main()
    const std::string interleaved_output_file_name   = "output.intr";
    const std::string deinterleaved_output_file_name = "output.deintr";
    const std::string rsdecoded_file_name            = "output.rsdec";
+   const std::string fused_output_file_name         = "output.fintr";
+   const std::string fused_decoded_file_name        = "output.fdec";
+   const std::string parallel_output_file_name      = "output.pintr";
+   const std::string parallel_decoded_file_name     = "output.pdec";
 
    const schifra::galois::field field(field_descriptor,
                                       schifra::galois::primitive_polynomial_size06,
@@ -143,5 +153,63 @@ int main()
       return 1;
    }
 
+   schifra::reed_solomon::file_interleaved_encoder<code_length,fec_length>
+                          (
+                            encoder,
+                            input_file_name,
+                            fused_output_file_name,
+                            stack_size
+                          );
+
+   schifra::corrupt_file_with_burst_errors
+            (
+              fused_output_file_name,
+              10,
+              code_length * (fec_length >> 1)
+            );
+
+   schifra::reed_solomon::file_interleaved_decoder<code_length,fec_length>
+                          (
+                            decoder,
+                            fused_output_file_name,
+                            fused_decoded_file_name,
+                            stack_size
+                          );
+
+   if (!schifra::fileio::files_identical(input_file_name, fused_decoded_file_name))
+   {
+      std::cout << "ERROR - Input file and fused decoded file are not equivelent!" << std::endl;
+      return 1;
+   }
+
+   schifra::reed_solomon::parallel_file_interleaved_encoder<code_length,fec_length>
+                          (
+                            encoder,
+                            input_file_name,
+                            parallel_output_file_name,
+                            stack_size
+                          );
+
+   schifra::corrupt_file_with_burst_errors
+            (
+              parallel_output_file_name,
+              10,
+              code_length * (fec_length >> 1)
+            );
+
+   schifra::reed_solomon::parallel_file_interleaved_decoder<code_length,fec_length>
+                          (
+                            decoder,
+                            parallel_output_file_name,
+                            parallel_decoded_file_name,
+                            stack_size
+                          );
+
+   if (!schifra::fileio::files_identical(input_file_name, parallel_decoded_file_name))
+   {
+      std::cout << "ERROR - Input file and parallel decoded file are not equivelent!" << std::endl;
+      return 1;
+   }
+
    return 0;
 }
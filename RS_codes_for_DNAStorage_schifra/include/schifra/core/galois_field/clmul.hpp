@@ -0,0 +1,188 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_CLMUL_HPP
+#define INCLUDE_SCHIFRA_GALOIS_CLMUL_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_CLMUL_X86
+   #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_AES)
+   #define SCHIFRA_CLMUL_PMULL
+   #include <arm_neon.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      /*
+         Table-free multiplication for GF(2^m), m <= 16, using a carry-less
+         multiply followed by a Barrett reduction:
+
+            p = a * b                        (degree <= 2m - 2)
+            q = ((p >> m) * mu) >> m         mu = floor(x^2m / P)
+            r = (p ^ (q * P)) mod x^m
+
+         This needs no memory at all, which makes it the fast path for
+         random access multiplies in compact GF(2^16) fields where the
+         log/antilog tables no longer fit in L1 or L2.
+      */
+      class clmul_multiplier
+      {
+      public:
+
+         explicit clmul_multiplier(const field& gfield)
+         : power_(gfield.pwr()),
+           mask_ (gfield.size()),
+           poly_ (0),
+           mu_   (0),
+           hardware_(false)
+         {
+            for (unsigned int i = 0; i <= power_; ++i)
+            {
+               poly_ |= static_cast<std::uint32_t>(gfield.prim_poly_term(i) & 1) << i;
+            }
+
+            /* mu = x^2m / P, by long division */
+            std::uint64_t rem = static_cast<std::uint64_t>(1) << (2 * power_);
+
+            for (int i = static_cast<int>(power_); i >= 0; --i)
+            {
+               if (rem & (static_cast<std::uint64_t>(1) << (i + power_)))
+               {
+                  mu_  |= static_cast<std::uint32_t>(1) << i;
+                  rem ^= static_cast<std::uint64_t>(poly_) << i;
+               }
+            }
+
+            const utils::cpu_features& cpu = utils::host_cpu_features();
+
+            #if defined(SCHIFRA_CLMUL_X86)
+            hardware_ = cpu.pclmul;
+            #elif defined(SCHIFRA_CLMUL_PMULL)
+            hardware_ = cpu.pmull;
+            #else
+            (void)cpu;
+            #endif
+         }
+
+         inline bool hardware() const
+         {
+            return hardware_;
+         }
+
+         inline field_symbol mul(const field_symbol a, const field_symbol b) const
+         {
+            #if defined(SCHIFRA_CLMUL_X86)
+            if (hardware_)
+               return mul_pclmul(a, b);
+            #elif defined(SCHIFRA_CLMUL_PMULL)
+            if (hardware_)
+               return mul_pmull(a, b);
+            #endif
+
+            return reduce(clmul_portable(static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b)));
+         }
+
+         /* dst[i] ^= c * src[i] over 16-bit symbols */
+         inline void mul_add(const field_symbol c, const std::uint16_t* src, std::uint16_t* dst, const std::size_t length) const
+         {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               dst[i] ^= static_cast<std::uint16_t>(mul(c, src[i]));
+            }
+         }
+
+      private:
+
+         static inline std::uint64_t clmul_portable(std::uint32_t a, const std::uint32_t b)
+         {
+            std::uint64_t result = 0;
+            std::uint64_t shifted = b;
+
+            while (a)
+            {
+               if (a & 1) result ^= shifted;
+               shifted <<= 1;
+               a >>= 1;
+            }
+
+            return result;
+         }
+
+         inline field_symbol reduce(const std::uint64_t p) const
+         {
+            const std::uint64_t q = clmul_portable(static_cast<std::uint32_t>(p >> power_), mu_) >> power_;
+            return static_cast<field_symbol>((p ^ clmul_portable(static_cast<std::uint32_t>(q), poly_)) & mask_);
+         }
+
+         #if defined(SCHIFRA_CLMUL_X86)
+         __attribute__((target("pclmul,sse4.1")))
+         inline field_symbol mul_pclmul(const field_symbol a, const field_symbol b) const
+         {
+            const __m128i va = _mm_cvtsi32_si128(a);
+            const __m128i vb = _mm_cvtsi32_si128(b);
+            const __m128i vm = _mm_cvtsi32_si128(static_cast<int>(mu_));
+            const __m128i vp = _mm_cvtsi32_si128(static_cast<int>(poly_));
+
+            const __m128i p  = _mm_clmulepi64_si128(va, vb, 0x00);
+            const __m128i q  = _mm_srli_epi64(_mm_clmulepi64_si128(_mm_srli_epi64(p, power_), vm, 0x00), power_);
+            const __m128i r  = _mm_xor_si128(p, _mm_clmulepi64_si128(q, vp, 0x00));
+
+            return static_cast<field_symbol>(static_cast<unsigned int>(_mm_cvtsi128_si32(r)) & mask_);
+         }
+         #endif
+
+         #if defined(SCHIFRA_CLMUL_PMULL)
+         inline field_symbol mul_pmull(const field_symbol a, const field_symbol b) const
+         {
+            const std::uint64_t p = static_cast<std::uint64_t>(vmull_p64(static_cast<poly64_t>(a), static_cast<poly64_t>(b)));
+            const std::uint64_t q = static_cast<std::uint64_t>(vmull_p64(static_cast<poly64_t>(p >> power_), static_cast<poly64_t>(mu_))) >> power_;
+            const std::uint64_t r = p ^ static_cast<std::uint64_t>(vmull_p64(static_cast<poly64_t>(q), static_cast<poly64_t>(poly_)));
+
+            return static_cast<field_symbol>(r & mask_);
+         }
+         #endif
+
+         unsigned int  power_;
+         unsigned int  mask_;
+         std::uint32_t poly_;
+         std::uint32_t mu_;
+         bool          hardware_;
+      };
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
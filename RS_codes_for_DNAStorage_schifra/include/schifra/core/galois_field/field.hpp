@@ -30,6 +30,30 @@
 #include <limits>
 #include <string>
 
+#include "schifra/utils/schifra_aligned_allocator.hpp"
+#include "schifra/utils/schifra_memory_accounting.hpp"
+
+
+/*
+   Fields of power above SCHIFRA_GFLUT_MAX_POWER do not allocate the full
+   (field_size + 1)^2 mul/div/exp tables, which for GF(2^16) would need
+   tens of GB. They run in compact mode instead: log/antilog tables with
+   a doubled antilog range, so no normalisation is needed per operation.
+*/
+#ifndef SCHIFRA_GFLUT_MAX_POWER
+   #define SCHIFRA_GFLUT_MAX_POWER 12
+#endif
+
+/*
+   Distance in symbols at which the batch multiplies of compact fields
+   prefetch the log table entries of their operands, 0 for none. Worth
+   setting (eg: 16) where the GF(2^16) tables, 768KB, do not fit in L2;
+   where they do, the prefetches only cost issue slots.
+*/
+#ifndef SCHIFRA_GFLUT_PREFETCH
+   #define SCHIFRA_GFLUT_PREFETCH 0
+#endif
+
 
 namespace schifra
 {
@@ -45,6 +69,16 @@ namespace schifra
       public:
 
          field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly);
+
+         /*
+            As above, but the mul/div/exp/inverse tables are taken as they
+            are from lut, which must hold what lut() of an equal field
+            built with the same LINEAR_EXP_LUT setting holds. The memory
+            is only read, and must outlive the field (eg: a read-only
+            mapping of a table image).
+         */
+         field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly, const char* lut);
+
         ~field();
 
          bool operator==(const field& gf) const;
@@ -75,6 +109,11 @@ namespace schifra
             return field_size_;
          }
 
+         inline bool compact() const
+         {
+            return compact_;
+         }
+
          inline field_symbol add(const field_symbol& a, const field_symbol& b) const
          {
             return (a ^ b);
@@ -104,7 +143,12 @@ namespace schifra
          inline field_symbol mul(const field_symbol& a, const field_symbol& b) const
          {
             #if !defined(NO_GFLUT)
-               return mul_table_[a][b];
+               if (!compact_)
+                  return mul_table_[a][b];
+               else if ((a == 0) || (b == 0))
+                  return 0;
+               else
+                  return alpha_to_[index_of_[a] + index_of_[b]];
             #else
                if ((a == 0) || (b == 0))
                   return 0;
@@ -116,7 +160,12 @@ namespace schifra
          inline field_symbol div(const field_symbol& a, const field_symbol& b) const
          {
             #if !defined(NO_GFLUT)
-               return div_table_[a][b];
+               if (!compact_)
+                  return div_table_[a][b];
+               else if ((a == 0) || (b == 0))
+                  return 0;
+               else
+                  return alpha_to_[index_of_[a] - index_of_[b] + static_cast<field_symbol>(field_size_)];
             #else
                if ((a == 0) || (b == 0))
                   return 0;
@@ -128,7 +177,16 @@ namespace schifra
          inline field_symbol exp(const field_symbol& a, int n) const
          {
             #if !defined(NO_GFLUT)
-               if (n >= 0)
+               if (compact_)
+               {
+                  if (a == 0)
+                     return 0;
+
+                  while (n < 0) n += field_size_;
+
+                  return (n ? alpha_to_[(index_of_[a] * static_cast<long long>(n)) % field_size_] : 1);
+               }
+               else if (n >= 0)
                   return exp_table_[a][n & field_size_];
                else
                {
@@ -158,8 +216,8 @@ namespace schifra
          inline field_symbol* const linear_exp(const field_symbol& a) const
          {
             #if !defined(NO_GFLUT)
-               static const field_symbol upper_bound = 2 * field_size_;
-               if ((a >= 0) && (a <= upper_bound))
+               const field_symbol upper_bound = 2 * field_size_;
+               if ((0 != linear_exp_table_) && (a >= 0) && (a <= upper_bound))
                   return linear_exp_table_[a];
                else
                   return reinterpret_cast<field_symbol*>(0);
@@ -178,11 +236,130 @@ namespace schifra
             #endif
          }
 
+         /*
+            Batched multiplies over arrays of symbols, r may alias a or b:
+
+               mul_batch      : r[i]  = a[i].b[i]
+               scale_batch    : r[i]  = a[i].c
+               scale_add_batch: r[i] ^= a[i].c
+
+            For the kernels of compact fields, whose tables are hundreds of
+            KB: the lookups of an element do not depend on those of the
+            others, and zero operands are masked rather than branched on,
+            so the loads of successive elements overlap instead of each
+            waiting out a cache miss as a chain of mul() calls does.
+         */
+         inline void mul_batch(const field_symbol* a, const field_symbol* b, field_symbol* r, const std::size_t n) const
+         {
+            #if !defined(NO_GFLUT)
+            if (compact_)
+            {
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                  prefetch_index(a, i, n);
+
+                  const field_symbol x    = index_of_[a[i]];
+                  const field_symbol y    = index_of_[b[i]];
+                  const field_symbol zero = ((x | y) < 0) ? -1 : 0;
+
+                  r[i] = alpha_to_[(x + y) & ~zero] & ~zero;
+               }
+
+               return;
+            }
+            #endif
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               r[i] = mul(a[i], b[i]);
+            }
+         }
+
+         inline void scale_batch(const field_symbol* a, const field_symbol c, field_symbol* r, const std::size_t n) const
+         {
+            #if !defined(NO_GFLUT)
+            if (compact_ && (0 != c))
+            {
+               const field_symbol y = index_of_[c];
+
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                  prefetch_index(a, i, n);
+
+                  const field_symbol x    = index_of_[a[i]];
+                  const field_symbol zero = (x < 0) ? -1 : 0;
+
+                  r[i] = alpha_to_[(x + y) & ~zero] & ~zero;
+               }
+
+               return;
+            }
+            #endif
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               r[i] = mul(a[i], c);
+            }
+         }
+
+         inline void scale_add_batch(const field_symbol* a, const field_symbol c, field_symbol* r, const std::size_t n) const
+         {
+            if (0 == c)
+               return;
+
+            #if !defined(NO_GFLUT)
+            if (compact_)
+            {
+               const field_symbol y = index_of_[c];
+
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                  prefetch_index(a, i, n);
+
+                  const field_symbol x    = index_of_[a[i]];
+                  const field_symbol zero = (x < 0) ? -1 : 0;
+
+                  r[i] ^= alpha_to_[(x + y) & ~zero] & ~zero;
+               }
+
+               return;
+            }
+            #endif
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               r[i] ^= mul(a[i], c);
+            }
+         }
+
          inline unsigned int prim_poly_term(const unsigned int index) const
          {
             return prim_poly_[index];
          }
 
+         inline std::size_t prim_poly_degree() const
+         {
+            return prim_poly_deg_;
+         }
+
+         /* The mul/div/exp/inverse tables as one block, null in compact mode */
+         inline const char* lut() const
+         {
+            return buffer_;
+         }
+
+         inline std::size_t lut_size() const
+         {
+            return buffer_size_;
+         }
+
+         /*
+            Touch every table of the field from the calling thread, eg: a
+            worker before its first request, optionally locking them in
+            RAM. false when the lock was refused, see utils::prefault().
+         */
+         bool warm_up(const bool lock = false) const;
+
          friend std::ostream& operator << (std::ostream& os, const field& gf);
 
       private:
@@ -191,6 +368,16 @@ namespace schifra
          field(const field& gfield);
          field& operator=(const field& gfield);
 
+         inline void prefetch_index(const field_symbol* a, const std::size_t i, const std::size_t n) const
+         {
+            #if (SCHIFRA_GFLUT_PREFETCH > 0) && (defined(__GNUC__) || defined(__clang__))
+            if ((i + SCHIFRA_GFLUT_PREFETCH) < n)
+               __builtin_prefetch(index_of_ + a[i + SCHIFRA_GFLUT_PREFETCH]);
+            #else
+            (void)a; (void)i; (void)n;
+            #endif
+         }
+
          void         generate_field(const unsigned int* prim_poly_);
          field_symbol gen_mul       (const field_symbol& a, const field_symbol& b) const;
          field_symbol gen_div       (const field_symbol& a, const field_symbol& b) const;
@@ -209,6 +396,7 @@ namespace schifra
          unsigned int   power_;
          std::size_t    prim_poly_deg_;
          unsigned int   field_size_;
+         bool           compact_;
          unsigned int   prim_poly_hash_;
          unsigned int*  prim_poly_;
          field_symbol*  alpha_to_;    // aka exponential or anti-log
@@ -219,37 +407,79 @@ namespace schifra
          field_symbol** exp_table_;
          field_symbol** linear_exp_table_;
          char*          buffer_;
+         std::size_t    buffer_size_;
+         bool           owns_buffer_;
+         utils::table_memory memory_;  // hook buffer_ came from
+         utils::memory::charge charge_; // bytes of the tables
       };
 
-      field::field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly)
+      inline field::field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly)
+      : field(pwr, primpoly_deg, primitive_poly, 0)
+      {}
+
+      inline field::field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly, const char* lut)
       : power_(pwr),
         prim_poly_deg_(primpoly_deg),
-        field_size_((1 << power_) - 1)
+        field_size_((1 << power_) - 1),
+        #if !defined(NO_GFLUT)
+        compact_(pwr > SCHIFRA_GFLUT_MAX_POWER),
+        #else
+        compact_(false),
+        #endif
+        buffer_(0),
+        buffer_size_(0),
+        owns_buffer_(0 == lut),
+        memory_(utils::table_memory_hook()),
+        charge_(utils::memory::e_field_tables)
       {
-         alpha_to_    = new field_symbol [field_size_ + 1];
+         /*
+            Note: In compact mode alpha_to_ holds two periods of the antilog
+                  table, so index(a) + index(b) and index(a) - index(b) +
+                  field_size can index it directly.
+         */
+         alpha_to_    = new field_symbol [compact_ ? (2 * (field_size_ + 1)) : (field_size_ + 1)];
          index_of_    = new field_symbol [field_size_ + 1];
 
          #if !defined(NO_GFLUT)
 
-         #ifdef LINEAR_EXP_LUT
-         static const std::size_t buffer_size = ((6 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
-         #else
-         static const std::size_t buffer_size = ((4 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
-         #endif
-
-         buffer_ = new char[buffer_size];
-         std::size_t offset = 0;
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&mul_table_);
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&div_table_);
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&exp_table_);
+         if (compact_)
+         {
+            buffer_           = 0;
+            mul_table_        = 0;
+            div_table_        = 0;
+            exp_table_        = 0;
+            linear_exp_table_ = 0;
+            mul_inverse_      = new field_symbol [(field_size_ + 1) * 2];
+         }
+         else
+         {
+            #ifdef LINEAR_EXP_LUT
+            const std::size_t buffer_size = ((6 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
+            #else
+            const std::size_t buffer_size = ((4 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
+            #endif
 
-         #ifdef LINEAR_EXP_LUT
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1) * 2,offset,&linear_exp_table_);
-         #else
-         linear_exp_table_ = 0;
-         #endif
+            /*
+               Note: The mul/div/exp tables are looked up at random, so the
+                     buffer comes from the table memory hook: cache line
+                     aligned, and with SCHIFRA_HUGE_PAGE_TABLES backed by
+                     2MB pages to take the TLB pressure off the lookups.
+            */
+            buffer_      = owns_buffer_ ? static_cast<char*>(memory_.allocate(buffer_size)) : const_cast<char*>(lut);
+            buffer_size_ = buffer_size;
+            std::size_t offset = 0;
+            offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&mul_table_);
+            offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&div_table_);
+            offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&exp_table_);
+
+            #ifdef LINEAR_EXP_LUT
+            offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1) * 2,offset,&linear_exp_table_);
+            #else
+            linear_exp_table_ = 0;
+            #endif
 
-         offset = create_array(buffer_,(field_size_ + 1) * 2,offset,&mul_inverse_);
+            offset = create_array(buffer_,(field_size_ + 1) * 2,offset,&mul_inverse_);
+         }
 
          #else
 
@@ -278,9 +508,31 @@ namespace schifra
          }
 
          generate_field(primitive_poly);
+
+         std::size_t table_bytes = (compact_ ? (3 * (field_size_ + 1)) : (2 * (field_size_ + 1))) * sizeof(field_symbol);
+
+         #if !defined(NO_GFLUT)
+
+         if (compact_)
+            table_bytes += (field_size_ + 1) * 2 * sizeof(field_symbol);
+         else
+         {
+            #ifdef LINEAR_EXP_LUT
+            table_bytes += 4 * (field_size_ + 1) * sizeof(field_symbol*);
+            #else
+            table_bytes += 3 * (field_size_ + 1) * sizeof(field_symbol*);
+            #endif
+
+            if (owns_buffer_)
+               table_bytes += buffer_size_;
+         }
+
+         #endif
+
+         charge_.resize(table_bytes);
       }
 
-      field::~field()
+      inline field::~field()
       {
          if (0 !=  alpha_to_) { delete [] alpha_to_;  alpha_to_  = 0; }
          if (0 !=  index_of_) { delete [] index_of_;  index_of_  = 0; }
@@ -288,6 +540,8 @@ namespace schifra
 
          #if !defined(NO_GFLUT)
 
+         if (compact_ && (0 != mul_inverse_)) { delete [] mul_inverse_; mul_inverse_ = 0; }
+
          if (0 != mul_table_) { delete [] mul_table_; mul_table_ = 0; }
          if (0 != div_table_) { delete [] div_table_; div_table_ = 0; }
          if (0 != exp_table_) { delete [] exp_table_; exp_table_ = 0; }
@@ -296,9 +550,34 @@ namespace schifra
          if (0 != linear_exp_table_) { delete [] linear_exp_table_; linear_exp_table_ = 0; }
          #endif
 
-         if (0 != buffer_) { delete [] buffer_; buffer_ = 0; }
+         if (owns_buffer_ && (0 != buffer_)) { memory_.deallocate(buffer_, buffer_size_); buffer_ = 0; }
+
+         #endif
+      }
+
+      inline bool field::warm_up(const bool lock) const
+      {
+         const std::size_t row_count = field_size_ + 1;
+
+         bool locked = utils::prefault(alpha_to_, (compact_ ? (2 * row_count) : row_count) * sizeof(field_symbol), lock);
+
+         locked = utils::prefault(index_of_, row_count * sizeof(field_symbol), lock) && locked;
+
+         #if !defined(NO_GFLUT)
+
+         if (compact_)
+            locked = utils::prefault(mul_inverse_, 2 * row_count * sizeof(field_symbol), lock) && locked;
+         else
+         {
+            locked = utils::prefault(buffer_   , buffer_size_                     , lock) && locked;
+            locked = utils::prefault(mul_table_, row_count * sizeof(field_symbol*), lock) && locked;
+            locked = utils::prefault(div_table_, row_count * sizeof(field_symbol*), lock) && locked;
+            locked = utils::prefault(exp_table_, row_count * sizeof(field_symbol*), lock) && locked;
+         }
 
          #endif
+
+         return locked;
       }
 
       inline bool field::operator==(const field& gf) const
@@ -358,6 +637,26 @@ namespace schifra
 
          #if !defined(NO_GFLUT)
 
+           if (compact_)
+           {
+              for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
+              {
+                 alpha_to_[field_size_ + i] = alpha_to_[i];
+              }
+
+              for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
+              {
+                 mul_inverse_[i] = gen_inverse(i);
+                 mul_inverse_[i + (field_size_ + 1)] = mul_inverse_[i];
+              }
+
+              return;
+           }
+
+           /* Tables taken from a lut image are complete already */
+           if (!owns_buffer_)
+              return;
+
            for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
            {
               for (field_symbol j = 0; j < static_cast<field_symbol>(field_size_ + 1); ++j)
@@ -416,27 +715,27 @@ namespace schifra
          return alpha_to_[normalize(field_size_ - index_of_[val])];
       }
 
-      std::size_t field::create_array(char buffer[],
-                                      const std::size_t& length,
-                                      const std::size_t offset,
-                                      field_symbol** array)
+      inline std::size_t field::create_array(char buffer[],
+                                             const std::size_t& length,
+                                             const std::size_t offset,
+                                             field_symbol** array)
       {
          const std::size_t row_size = length * sizeof(field_symbol);
-         (*array) = new(buffer + offset)field_symbol[length];
+         (*array) = reinterpret_cast<field_symbol*>(buffer + offset);
          return row_size + offset;
       }
 
-      std::size_t field::create_2d_array(char buffer[],
-                                         std::size_t row_cnt, std::size_t col_cnt,
-                                         const std::size_t offset,
-                                         field_symbol*** array)
+      inline std::size_t field::create_2d_array(char buffer[],
+                                                std::size_t row_cnt, std::size_t col_cnt,
+                                                const std::size_t offset,
+                                                field_symbol*** array)
       {
          const std::size_t row_size = col_cnt * sizeof(field_symbol);
          char* buffer__offset = buffer + offset;
          (*array) = new field_symbol* [row_cnt];
          for (std::size_t i = 0; i < row_cnt; ++i)
          {
-            (*array)[i] = new(buffer__offset + (i * row_size))field_symbol[col_cnt];
+            (*array)[i] = reinterpret_cast<field_symbol*>(buffer__offset + (i * row_size));
          }
          return (row_cnt * row_size) + offset;
       }
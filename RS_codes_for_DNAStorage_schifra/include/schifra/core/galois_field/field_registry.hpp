@@ -0,0 +1,111 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_FIELD_REGISTRY_HPP
+#define INCLUDE_SCHIFRA_GALOIS_FIELD_REGISTRY_HPP
+
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      /*
+         Process-wide registry of immutable Galois fields keyed by
+         (power, primitive polynomial). The first request for a given
+         field builds its tables, every later request on any thread
+         receives a reference to the same instance. Fields are kept
+         alive for the lifetime of the process, so repeatedly created
+         codecs never pay for table generation more than once.
+      */
+      class field_registry
+      {
+      public:
+
+         typedef std::shared_ptr<const field> field_ptr;
+
+         static field_registry& instance()
+         {
+            static field_registry registry;
+            return registry;
+         }
+
+         field_ptr acquire(const int pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly)
+         {
+            const key_type key(pwr, std::vector<unsigned int>(primitive_poly, primitive_poly + primpoly_deg));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            field_map_t::const_iterator itr = fields_.find(key);
+
+            if (fields_.end() != itr)
+            {
+               return itr->second;
+            }
+
+            const field_ptr gfield = std::make_shared<const field>(pwr, primpoly_deg, primitive_poly);
+
+            fields_.insert(std::make_pair(key, gfield));
+
+            return gfield;
+         }
+
+         std::size_t size() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return fields_.size();
+         }
+
+      private:
+
+         typedef std::pair<int, std::vector<unsigned int> > key_type;
+         typedef std::map<key_type, field_ptr> field_map_t;
+
+         field_registry() {}
+         field_registry(const field_registry&);
+         field_registry& operator=(const field_registry&);
+
+         field_map_t        fields_;
+         mutable std::mutex mutex_;
+      };
+
+      inline field_registry::field_ptr shared_field(const int pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly)
+      {
+         return field_registry::instance().acquire(pwr, primpoly_deg, primitive_poly);
+      }
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
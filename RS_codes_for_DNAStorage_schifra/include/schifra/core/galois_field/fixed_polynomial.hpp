@@ -0,0 +1,366 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_FIXED_POLYNOMIAL_HPP
+#define INCLUDE_SCHIFRA_GALOIS_FIXED_POLYNOMIAL_HPP
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/polynomial_kernels.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      /*
+         A polynomial over a galois field whose terms live in an inline
+         array of at most capacity symbols. It never allocates, so it can
+         be used freely on the per-codeword paths of the encoder and the
+         decoder. Terms are stored lowest power first, and deg()/simplify()
+         follow the same conventions as field_polynomial, so that results
+         are bit-exact with the field_polynomial based arithmetic. The
+         arithmetic itself is that of the raw symbol kernels of
+         polynomial_kernels.hpp.
+
+         Note: Operations that would grow a polynomial past its capacity
+               are rejected and leave the destination untouched.
+      */
+      template <std::size_t capacity>
+      class fixed_polynomial
+      {
+      public:
+
+         explicit fixed_polynomial(const field& gfield)
+         : field_(&gfield),
+           size_(0)
+         {}
+
+         fixed_polynomial(const field& gfield, const unsigned int& degree)
+         : field_(&gfield),
+           size_(0)
+         {
+            resize(degree + 1);
+         }
+
+         fixed_polynomial(const field& gfield, const field_symbol& value)
+         : field_(&gfield),
+           size_(1)
+         {
+            poly_[0] = value;
+         }
+
+         explicit fixed_polynomial(const field_polynomial& polynomial)
+         : field_(&polynomial.galois_field()),
+           size_(0)
+         {
+            assign(polynomial);
+         }
+
+         inline bool assign(const field_polynomial& polynomial)
+         {
+            const std::size_t terms = static_cast<std::size_t>(polynomial.deg() + 1);
+
+            if (terms > capacity)
+               return false;
+
+            field_ = &polynomial.galois_field();
+            size_  = terms;
+
+            for (std::size_t i = 0; i < terms; ++i)
+            {
+               poly_[i] = polynomial[i].poly();
+            }
+
+            return true;
+         }
+
+         inline bool valid() const
+         {
+            return (size_ > 0);
+         }
+
+         inline int deg() const
+         {
+            return static_cast<int>(size_) - 1;
+         }
+
+         inline std::size_t size() const
+         {
+            return size_;
+         }
+
+         static inline std::size_t max_size()
+         {
+            return capacity;
+         }
+
+         inline const field& galois_field() const
+         {
+            return *field_;
+         }
+
+         inline bool resize(const std::size_t& terms)
+         {
+            if (terms > capacity)
+               return false;
+
+            if (terms > size_)
+            {
+               std::fill(poly_ + size_, poly_ + terms, field_symbol(0));
+            }
+
+            size_ = terms;
+
+            return true;
+         }
+
+         inline void clear()
+         {
+            size_ = 0;
+         }
+
+         inline field_symbol& operator[](const std::size_t& term)
+         {
+            assert(term < size_);
+            return poly_[term];
+         }
+
+         inline const field_symbol& operator[](const std::size_t& term) const
+         {
+            assert(term < size_);
+            return poly_[term];
+         }
+
+         inline field_symbol* data()
+         {
+            return poly_;
+         }
+
+         inline const field_symbol* data() const
+         {
+            return poly_;
+         }
+
+         inline void simplify()
+         {
+            size_ = poly_terms(poly_, size_);
+         }
+
+         inline field_symbol operator()(const field_symbol& x) const
+         {
+            return poly_eval(*field_, poly_, size_, x);
+         }
+
+         template <std::size_t other_capacity>
+         inline fixed_polynomial& operator+=(const fixed_polynomial<other_capacity>& polynomial)
+         {
+            if (polynomial.size() > size_)
+            {
+               if (!resize(polynomial.size()))
+                  return *this;
+            }
+
+            poly_add(poly_, polynomial.data(), polynomial.size());
+
+            simplify();
+
+            return *this;
+         }
+
+         template <std::size_t other_capacity>
+         inline fixed_polynomial& operator-=(const fixed_polynomial<other_capacity>& polynomial)
+         {
+            return (*this += polynomial);
+         }
+
+         inline fixed_polynomial& operator*=(const field_symbol& value)
+         {
+            poly_scale(*field_, poly_, size_, value, poly_);
+
+            return *this;
+         }
+
+         inline fixed_polynomial& operator/=(const field_symbol& value)
+         {
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+               poly_[i] = field_->div(poly_[i], value);
+            }
+
+            return *this;
+         }
+
+         /* Multiply by x^n */
+         inline fixed_polynomial& operator<<=(const unsigned int& n)
+         {
+            if ((size_ > 0) && (size_ + n <= capacity))
+            {
+               for (std::size_t i = size_; i > 0; --i)
+               {
+                  poly_[i - 1 + n] = poly_[i - 1];
+               }
+
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                  poly_[i] = 0;
+               }
+
+               size_ += n;
+            }
+
+            return *this;
+         }
+
+         /* Reduce modulo x^n */
+         inline fixed_polynomial& operator%=(const unsigned int& n)
+         {
+            if (size_ >= n)
+            {
+               size_ = n;
+               simplify();
+            }
+
+            return *this;
+         }
+
+         /* In place multiply by (1 + c.x) */
+         inline fixed_polynomial& mul_linear(const field_symbol& c)
+         {
+            if ((size_ > 0) && (size_ < capacity))
+            {
+               poly_[size_] = field_->mul(poly_[size_ - 1], c);
+
+               for (std::size_t i = size_ - 1; i > 0; --i)
+               {
+                  poly_[i] ^= field_->mul(poly_[i - 1], c);
+               }
+
+               ++size_;
+               simplify();
+            }
+
+            return *this;
+         }
+
+         /*
+            result = (*this * polynomial) mod x^max_terms
+
+            The product is simplified, result may not alias either operand.
+         */
+         template <std::size_t other_capacity, std::size_t result_capacity>
+         inline bool mul_into(const fixed_polynomial<other_capacity>& polynomial,
+                              fixed_polynomial<result_capacity>& result,
+                              const std::size_t& max_terms = result_capacity) const
+         {
+            if ((0 == size_) || (0 == polynomial.size()))
+            {
+               result.clear();
+               return true;
+            }
+
+            std::size_t terms = size_ + polynomial.size() - 1;
+
+            if (terms > max_terms)
+               terms = max_terms;
+
+            if (terms > result_capacity)
+               return false;
+
+            result.resize(terms);
+
+            poly_mul(*field_, poly_, size_, polynomial.data(), polynomial.size(), result.data(), terms);
+
+            result.simplify();
+
+            return true;
+         }
+
+         /*
+            remainder = *this mod divisor, computed with the same shift
+            register long division as field_polynomial::operator%=. The
+            remainder always has divisor.deg() terms and is not simplified.
+         */
+         template <std::size_t divisor_capacity, std::size_t remainder_capacity>
+         inline bool mod_into(const fixed_polynomial<divisor_capacity>& divisor,
+                              fixed_polynomial<remainder_capacity>& remainder) const
+         {
+            const int divisor_deg = divisor.deg();
+
+            if (
+                 (divisor_deg < 0)     ||
+                 (deg() < divisor_deg) ||
+                 (static_cast<std::size_t>(divisor_deg) > remainder_capacity)
+               )
+            {
+               return false;
+            }
+
+            remainder.resize(static_cast<std::size_t>(divisor_deg));
+
+            poly_mod(*field_, poly_, size_, divisor.data(), divisor.size(), remainder.data());
+
+            return true;
+         }
+
+         /* Formal derivative, result may not alias *this */
+         template <std::size_t result_capacity>
+         inline bool derivative_into(fixed_polynomial<result_capacity>& result) const
+         {
+            if (size_ <= 1)
+            {
+               result.clear();
+               result.resize(1);
+               return true;
+            }
+
+            if ((size_ - 1) > result_capacity)
+               return false;
+
+            result.resize(size_ - 1);
+
+            poly_derivative(poly_, size_, result.data());
+
+            result.simplify();
+
+            return true;
+         }
+
+      private:
+
+         const field* field_;
+         std::size_t  size_;
+         field_symbol poly_[capacity];
+      };
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,335 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_POLYNOMIAL_KERNELS_HPP
+#define INCLUDE_SCHIFRA_GALOIS_POLYNOMIAL_KERNELS_HPP
+
+
+#include <cstddef>
+
+#include "schifra/core/galois_field/field.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      /*
+         Polynomial arithmetic over contiguous arrays of raw field symbols,
+         the field being passed once per call rather than carried by every
+         term as field_element does. Terms are stored lowest power first.
+         These are the kernels under fixed_polynomial and the run time
+         rs_codec; field_polynomial keeps its field_element based operators
+         for the non critical paths (generator construction and the like).
+
+         Lengths are in terms. No kernel allocates or simplifies, the
+         callers trim trailing zero terms with poly_terms() where they need
+         to. Runs of multiplies go through the field's batch multiplies
+         (field::scale_add_batch() and co), whose lookups overlap.
+      */
+
+      /* Number of terms once trailing zero terms are dropped */
+      inline std::size_t poly_terms(const field_symbol* a, std::size_t n)
+      {
+         while ((n > 0) && (0 == a[n - 1]))
+         {
+            --n;
+         }
+
+         return n;
+      }
+
+      /* r += a, r holding at least n terms */
+      inline void poly_add(field_symbol* r, const field_symbol* a, const std::size_t n)
+      {
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            r[i] ^= a[i];
+         }
+      }
+
+      /* r = c.a, r may alias a */
+      inline void poly_scale(const field& gfield, const field_symbol* a, const std::size_t n,
+                             const field_symbol c, field_symbol* r)
+      {
+         gfield.scale_batch(a, c, r, n);
+      }
+
+      /* r += c.a */
+      inline void poly_scale_add(const field& gfield, const field_symbol* a, const std::size_t n,
+                                 const field_symbol c, field_symbol* r)
+      {
+         gfield.scale_add_batch(a, c, r, n);
+      }
+
+      /*
+         r = (a * b) mod x^max_terms, returning the number of terms written:
+         min(na + nb - 1, max_terms), or 0 when either operand is empty. r
+         may not alias either operand.
+      */
+      inline std::size_t poly_mul(const field& gfield,
+                                  const field_symbol* a, const std::size_t na,
+                                  const field_symbol* b, const std::size_t nb,
+                                  field_symbol* r, const std::size_t max_terms)
+      {
+         if ((0 == na) || (0 == nb))
+            return 0;
+
+         std::size_t terms = na + nb - 1;
+
+         if (terms > max_terms)
+            terms = max_terms;
+
+         for (std::size_t i = 0; i < terms; ++i)
+         {
+            r[i] = 0;
+         }
+
+         for (std::size_t i = 0; (i < na) && (i < terms); ++i)
+         {
+            if (0 == a[i])
+               continue;
+
+            const std::size_t upper = ((terms - i) < nb) ? (terms - i) : nb;
+
+            gfield.scale_add_batch(b, a[i], r + i, upper);
+         }
+
+         return terms;
+      }
+
+      /* In place a = a.(x + c), a holding n terms and room for one more */
+      inline void poly_mul_linear(const field& gfield, field_symbol* a, const std::size_t n, const field_symbol c)
+      {
+         if (0 == n)
+            return;
+
+         a[n] = a[n - 1];
+
+         for (std::size_t j = n - 1; j > 0; --j)
+         {
+            a[j] = a[j - 1] ^ gfield.mul(c, a[j]);
+         }
+
+         a[0] = gfield.mul(c, a[0]);
+      }
+
+      /* Below this many terms poly_mul_karatsuba() multiplies term by term */
+      const std::size_t karatsuba_threshold = 32;
+
+      /* Scratch symbols poly_mul_karatsuba() needs for n term operands */
+      inline std::size_t karatsuba_scratch(std::size_t n)
+      {
+         std::size_t total = 0;
+
+         while (n >= karatsuba_threshold)
+         {
+            const std::size_t upper = n - (n / 2);
+
+            total += 4 * upper;
+            n      = upper;
+         }
+
+         return total;
+      }
+
+      /*
+         r = a * b for two operands of n terms each, the 2n - 1 terms of
+         the product by Karatsuba's three half size products:
+
+            a0.b0 + x^h.((a0 + a1).(b0 + b1) - a0.b0 - a1.b1) + x^2h.a1.b1
+
+         scratch holds karatsuba_scratch(n) symbols. r may not alias
+         either operand.
+      */
+      inline void poly_mul_karatsuba(const field& gfield,
+                                     const field_symbol* a, const field_symbol* b, const std::size_t n,
+                                     field_symbol* r, field_symbol* scratch)
+      {
+         if (n < karatsuba_threshold)
+         {
+            poly_mul(gfield, a, n, b, n, r, 2 * n - 1);
+            return;
+         }
+
+         const std::size_t h     = n / 2;
+         const std::size_t upper = n - h;
+
+         /* a0.b0 in r[0 .. 2h - 1), a1.b1 in r[2h .. 2n - 1) */
+         poly_mul_karatsuba(gfield, a, b, h, r, scratch);
+         r[2 * h - 1] = 0;
+         poly_mul_karatsuba(gfield, a + h, b + h, upper, r + 2 * h, scratch);
+
+         field_symbol* sum_a  = scratch;
+         field_symbol* sum_b  = sum_a + upper;
+         field_symbol* middle = sum_b + upper;
+
+         for (std::size_t i = 0; i < upper; ++i)
+         {
+            sum_a[i] = a[h + i] ^ ((i < h) ? a[i] : 0);
+            sum_b[i] = b[h + i] ^ ((i < h) ? b[i] : 0);
+         }
+
+         poly_mul_karatsuba(gfield, sum_a, sum_b, upper, middle, middle + 2 * upper);
+
+         for (std::size_t i = 0; i < (2 * h - 1); ++i)
+         {
+            middle[i] ^= r[i];
+         }
+
+         for (std::size_t i = 0; i < (2 * upper - 1); ++i)
+         {
+            middle[i] ^= r[2 * h + i];
+         }
+
+         poly_add(r + h, middle, 2 * upper - 1);
+      }
+
+      /*
+         r = a mod d, d having nd terms with a non-zero leading term and
+         na >= nd. The remainder always has nd - 1 terms, computed with the
+         shift register long division of field_polynomial::operator%=.
+      */
+      inline void poly_mod(const field& gfield,
+                           const field_symbol* a, const std::size_t na,
+                           const field_symbol* d, const std::size_t nd,
+                           field_symbol* r)
+      {
+         const std::size_t m = nd - 1;
+
+         for (std::size_t j = 0; j < m; ++j)
+         {
+            r[j] = 0;
+         }
+
+         if (0 == m)
+            return;
+
+         const std::size_t  quotient_terms = na - m;
+         const field_symbol leading        = d[m];
+
+         for (std::size_t i = na; i > 0; --i)
+         {
+            const field_symbol q = (i <= quotient_terms) ? gfield.div(r[m - 1], leading) : 0;
+
+            for (std::size_t j = m - 1; j > 0; --j)
+            {
+               r[j] = r[j - 1];
+            }
+
+            r[0] = a[i - 1];
+
+            gfield.scale_add_batch(d, q, r, m);
+         }
+      }
+
+      /*
+         a(x). Terms are summed independently rather than by Horner's rule,
+         whose serial mul chain is latency bound on the log/antilog tables.
+      */
+      inline field_symbol poly_eval(const field& gfield, const field_symbol* a, const std::size_t n,
+                                    const field_symbol x)
+      {
+         field_symbol result = 0;
+
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            result ^= gfield.mul(gfield.exp(x, static_cast<int>(i)), a[i]);
+         }
+
+         return result;
+      }
+
+      /*
+         a(x0.s^p) for p in [0,count), into r: a Chien search over count
+         points in geometric progression. Term i of the sum is kept in
+         terms[i] and advanced by steps[i] = s^i per point, so a point
+         costs one batch of n independent multiplies. terms and steps are
+         n symbols of scratch each.
+      */
+      inline void poly_eval_geometric(const field& gfield, const field_symbol* a, const std::size_t n,
+                                      const field_symbol x0, const field_symbol s, const std::size_t count,
+                                      field_symbol* terms, field_symbol* steps, field_symbol* r)
+      {
+         if (0 == n)
+         {
+            for (std::size_t p = 0; p < count; ++p)
+            {
+               r[p] = 0;
+            }
+
+            return;
+         }
+
+         field_symbol x0_power = 1;
+
+         steps[0] = 1;
+
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            terms[i] = gfield.mul(a[i], x0_power);
+            x0_power = gfield.mul(x0_power, x0);
+
+            if (i > 0)
+               steps[i] = gfield.mul(steps[i - 1], s);
+         }
+
+         for (std::size_t p = 0; p < count; ++p)
+         {
+            field_symbol sum = 0;
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               sum ^= terms[i];
+            }
+
+            r[p] = sum;
+
+            gfield.mul_batch(terms, steps, terms, n);
+         }
+      }
+
+      /*
+         Formal derivative, returning its n - 1 terms (odd powers of a move
+         down, even ones vanish in characteristic 2), or 0 for n <= 1. r may
+         not alias a.
+      */
+      inline std::size_t poly_derivative(const field_symbol* a, const std::size_t n, field_symbol* r)
+      {
+         if (n <= 1)
+            return 0;
+
+         for (std::size_t i = 0; i < (n - 1); ++i)
+         {
+            r[i] = (i & 1) ? 0 : a[i + 1];
+         }
+
+         return n - 1;
+      }
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,365 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_REGION_HPP
+#define INCLUDE_SCHIFRA_GALOIS_REGION_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/core/galois_field/field.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_REGION_X86
+   #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+   #define SCHIFRA_REGION_NEON
+   #include <arm_neon.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SVE)
+   #define SCHIFRA_REGION_SVE
+   #include <arm_sve.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      namespace region
+      {
+
+         /*
+            Region arithmetic over GF(2^m) with m <= 8, one symbol per byte.
+
+            A product c * x is linear in x, so it can be split over the low
+            and high nibble of x: c * x = c * (x & 0x0F) ^ c * (x & 0xF0).
+            Each half has only 16 possible values, which is exactly one
+            16-byte shuffle table, hence a multiply of a whole vector of
+            symbols by c costs two table shuffles and an xor.
+         */
+         struct split_table
+         {
+            std::uint8_t lo[16];
+            std::uint8_t hi[16];
+         };
+
+         template <typename Field>
+         inline split_table make_split_table(const Field& gfield, const field_symbol c)
+         {
+            split_table table;
+
+            const unsigned int order = gfield.size() + 1;
+
+            for (unsigned int i = 0; i < 16; ++i)
+            {
+               table.lo[i] = (i        < order) ? static_cast<std::uint8_t>(gfield.mul(c, static_cast<field_symbol>(i     ))) : 0;
+               table.hi[i] = ((i << 4) < order) ? static_cast<std::uint8_t>(gfield.mul(c, static_cast<field_symbol>(i << 4))) : 0;
+            }
+
+            return table;
+         }
+
+         /*
+            Multiplication by a constant c is a linear map over GF(2)^m, so it
+            is an 8x8 bit matrix whatever the primitive polynomial. GFNI's
+            affine instruction applies such a matrix to every byte of a vector.
+            The matrix packs row i, the bits of x that contribute to bit i of
+            c * x, into byte (7 - i) as expected by GF2P8AFFINEQB.
+
+            Note: GF2P8MULB is hard wired to 0x11B, which is not one of the
+                  polynomials shipped with Schifra, so the affine form is used
+                  for every field.
+         */
+         template <typename Field>
+         inline std::uint64_t make_affine_matrix(const Field& gfield, const field_symbol c)
+         {
+            std::uint64_t matrix = 0;
+
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+               std::uint64_t row = 0;
+
+               for (unsigned int j = 0; (j < 8) && ((1U << j) <= gfield.size()); ++j)
+               {
+                  row |= static_cast<std::uint64_t>((gfield.mul(c, static_cast<field_symbol>(1 << j)) >> i) & 1) << j;
+               }
+
+               matrix |= row << (8 * (7 - i));
+            }
+
+            return matrix;
+         }
+
+         inline std::uint8_t affine_apply(const std::uint64_t matrix, const std::uint8_t x)
+         {
+            std::uint8_t y = 0;
+
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+               const unsigned int row = static_cast<unsigned int>((matrix >> (8 * (7 - i))) & 0xFF);
+
+               y |= static_cast<std::uint8_t>(__builtin_parity(row & x) << i);
+            }
+
+            return y;
+         }
+
+         /* dst[i] ^= c * src[i], for i in [0,length) */
+         inline void mul_add_scalar(const split_table& table,
+                                    const std::uint8_t* src,
+                                    std::uint8_t* dst,
+                                    const std::size_t length)
+         {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               dst[i] ^= table.lo[src[i] & 0x0F] ^ table.hi[src[i] >> 4];
+            }
+         }
+
+         #ifdef SCHIFRA_REGION_X86
+
+         /*
+            Note: The kernels below are compiled for their instruction set
+                  regardless of the build flags, the caller must ensure the
+                  running cpu supports it before invoking one.
+         */
+
+         __attribute__((target("ssse3")))
+         inline void mul_add_ssse3(const split_table& table,
+                                   const std::uint8_t* src,
+                                   std::uint8_t* dst,
+                                   const std::size_t length)
+         {
+            const __m128i lo   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.lo));
+            const __m128i hi   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.hi));
+            const __m128i mask = _mm_set1_epi8(0x0F);
+
+            std::size_t i = 0;
+
+            for (; (i + 16) <= length; i += 16)
+            {
+               const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+               const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+               const __m128i p = _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                                               _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(y, p));
+            }
+
+            mul_add_scalar(table, src + i, dst + i, length - i);
+         }
+
+         __attribute__((target("avx2")))
+         inline void mul_add_avx2(const split_table& table,
+                                  const std::uint8_t* src,
+                                  std::uint8_t* dst,
+                                  const std::size_t length)
+         {
+            const __m256i lo   = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.lo)));
+            const __m256i hi   = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.hi)));
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+
+            std::size_t i = 0;
+
+            for (; (i + 32) <= length; i += 32)
+            {
+               const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+               const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+               const __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                                                  _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(y, p));
+            }
+
+            mul_add_ssse3(table, src + i, dst + i, length - i);
+         }
+
+         __attribute__((target("avx512f,avx512bw")))
+         inline void mul_add_avx512(const split_table& table,
+                                    const std::uint8_t* src,
+                                    std::uint8_t* dst,
+                                    const std::size_t length)
+         {
+            std::uint8_t lo64[64];
+            std::uint8_t hi64[64];
+
+            for (std::size_t j = 0; j < 64; ++j)
+            {
+               lo64[j] = table.lo[j & 0x0F];
+               hi64[j] = table.hi[j & 0x0F];
+            }
+
+            const __m512i lo   = _mm512_loadu_si512(lo64);
+            const __m512i hi   = _mm512_loadu_si512(hi64);
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+
+            std::size_t i = 0;
+
+            for (; (i + 64) <= length; i += 64)
+            {
+               const __m512i x = _mm512_loadu_si512(src + i);
+               const __m512i y = _mm512_loadu_si512(dst + i);
+
+               const __m512i p = _mm512_xor_si512(_mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+                                                  _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi16(x, 4), mask)));
+
+               _mm512_storeu_si512(dst + i, _mm512_xor_si512(y, p));
+            }
+
+            mul_add_avx2(table, src + i, dst + i, length - i);
+         }
+
+         /* dst[i] ^= c * src[i] where matrix = make_affine_matrix(gfield,c) */
+         __attribute__((target("gfni,avx2")))
+         inline void mul_add_gfni_avx2(const std::uint64_t matrix,
+                                       const std::uint8_t* src,
+                                       std::uint8_t* dst,
+                                       const std::size_t length)
+         {
+            const __m256i a = _mm256_set1_epi64x(static_cast<long long>(matrix));
+
+            std::size_t i = 0;
+
+            for (; (i + 32) <= length; i += 32)
+            {
+               const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+               const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(y, _mm256_gf2p8affine_epi64_epi8(x, a, 0)));
+            }
+
+            for (; i < length; ++i)
+            {
+               dst[i] ^= affine_apply(matrix, src[i]);
+            }
+         }
+
+         __attribute__((target("gfni,avx512f,avx512bw")))
+         inline void mul_add_gfni_avx512(const std::uint64_t matrix,
+                                         const std::uint8_t* src,
+                                         std::uint8_t* dst,
+                                         const std::size_t length)
+         {
+            const __m512i a = _mm512_set1_epi64(static_cast<long long>(matrix));
+
+            std::size_t i = 0;
+
+            for (; (i + 64) <= length; i += 64)
+            {
+               const __m512i x = _mm512_loadu_si512(src + i);
+               const __m512i y = _mm512_loadu_si512(dst + i);
+
+               _mm512_storeu_si512(dst + i, _mm512_xor_si512(y, _mm512_gf2p8affine_epi64_epi8(x, a, 0)));
+            }
+
+            if (i < length)
+            {
+               const __mmask64 tail = (~static_cast<__mmask64>(0)) >> (64 - (length - i));
+
+               const __m512i x = _mm512_maskz_loadu_epi8(tail, src + i);
+               const __m512i y = _mm512_maskz_loadu_epi8(tail, dst + i);
+
+               _mm512_mask_storeu_epi8(dst + i, tail, _mm512_xor_si512(y, _mm512_gf2p8affine_epi64_epi8(x, a, 0)));
+            }
+         }
+
+         #endif // SCHIFRA_REGION_X86
+
+         #ifdef SCHIFRA_REGION_NEON
+
+         /* NEON is part of the AArch64 baseline, no runtime check is needed. */
+         inline void mul_add_neon(const split_table& table,
+                                  const std::uint8_t* src,
+                                  std::uint8_t* dst,
+                                  const std::size_t length)
+         {
+            const uint8x16_t lo   = vld1q_u8(table.lo);
+            const uint8x16_t hi   = vld1q_u8(table.hi);
+            const uint8x16_t mask = vdupq_n_u8(0x0F);
+
+            std::size_t i = 0;
+
+            for (; (i + 16) <= length; i += 16)
+            {
+               const uint8x16_t x = vld1q_u8(src + i);
+
+               const uint8x16_t p = veorq_u8(vqtbl1q_u8(lo, vandq_u8(x, mask)),
+                                             vqtbl1q_u8(hi, vshrq_n_u8(x, 4)));
+
+               vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), p));
+            }
+
+            mul_add_scalar(table, src + i, dst + i, length - i);
+         }
+
+         #endif // SCHIFRA_REGION_NEON
+
+         #ifdef SCHIFRA_REGION_SVE
+
+         /*
+            Vector length agnostic variant. The nibble tables are replicated
+            into every 128-bit segment, so TBL indices in [0,16) select the
+            same products at any vector length. Predicated loads and stores
+            cover the tail, hence there is no scalar remainder.
+
+            Note: Only base SVE instructions are required, so this is enabled
+                  by any of -march=armv8-a+sve, armv8-a+sve2 or armv9-a.
+         */
+         inline void mul_add_sve(const split_table& table,
+                                 const std::uint8_t* src,
+                                 std::uint8_t* dst,
+                                 const std::size_t length)
+         {
+            const svbool_t  all = svptrue_b8();
+            const svuint8_t lo  = svld1rq_u8(all, table.lo);
+            const svuint8_t hi  = svld1rq_u8(all, table.hi);
+
+            for (std::size_t i = 0; i < length; i += svcntb())
+            {
+               const svbool_t  pg = svwhilelt_b8_u64(static_cast<std::uint64_t>(i), static_cast<std::uint64_t>(length));
+               const svuint8_t x  = svld1_u8(pg, src + i);
+
+               const svuint8_t p  = sveor_u8_x(pg, svtbl_u8(lo, svand_n_u8_x(pg, x, 0x0F)),
+                                                   svtbl_u8(hi, svlsr_n_u8_x(pg, x, 4)));
+
+               svst1_u8(pg, dst + i, sveor_u8_x(pg, svld1_u8(pg, dst + i), p));
+            }
+         }
+
+         #endif // SCHIFRA_REGION_SVE
+
+      } // namespace region
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
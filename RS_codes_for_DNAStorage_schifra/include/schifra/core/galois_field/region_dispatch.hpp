@@ -0,0 +1,302 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_REGION_DISPATCH_HPP
+#define INCLUDE_SCHIFRA_GALOIS_REGION_DISPATCH_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/region.hpp"
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      namespace region
+      {
+
+         enum backend_t
+         {
+            e_scalar      = 0,
+            e_ssse3       = 1,
+            e_avx2        = 2,
+            e_avx512      = 3,
+            e_gfni_avx2   = 4,
+            e_gfni_avx512 = 5,
+            e_neon        = 6,
+            e_sve         = 7
+         };
+
+         /*
+            Everything any backend needs to multiply a region by c. Build it
+            once per constant and reuse it across regions and backends.
+         */
+         struct multiplier
+         {
+            split_table   split;
+            std::uint64_t affine;
+         };
+
+         template <typename Field>
+         inline multiplier make_multiplier(const Field& gfield, const field_symbol c)
+         {
+            multiplier m;
+            m.split  = make_split_table(gfield, c);
+            m.affine = make_affine_matrix(gfield, c);
+            return m;
+         }
+
+         typedef void (*mul_add_function_t)(const multiplier&, const std::uint8_t*, std::uint8_t*, const std::size_t);
+
+         namespace details
+         {
+            inline void mul_add_scalar(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_scalar(m.split, src, dst, length);
+            }
+
+            #ifdef SCHIFRA_REGION_X86
+            inline void mul_add_ssse3(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_ssse3(m.split, src, dst, length);
+            }
+
+            inline void mul_add_avx2(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_avx2(m.split, src, dst, length);
+            }
+
+            inline void mul_add_avx512(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_avx512(m.split, src, dst, length);
+            }
+
+            inline void mul_add_gfni_avx2(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_gfni_avx2(m.affine, src, dst, length);
+            }
+
+            inline void mul_add_gfni_avx512(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_gfni_avx512(m.affine, src, dst, length);
+            }
+            #endif
+
+            #ifdef SCHIFRA_REGION_NEON
+            inline void mul_add_neon(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_neon(m.split, src, dst, length);
+            }
+            #endif
+
+            #ifdef SCHIFRA_REGION_SVE
+            inline void mul_add_sve(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+            {
+               region::mul_add_sve(m.split, src, dst, length);
+            }
+            #endif
+
+            inline mul_add_function_t mul_add_kernel(const backend_t backend)
+            {
+               switch (backend)
+               {
+                  #ifdef SCHIFRA_REGION_X86
+                  case e_ssse3       : return mul_add_ssse3;
+                  case e_avx2        : return mul_add_avx2;
+                  case e_avx512      : return mul_add_avx512;
+                  case e_gfni_avx2   : return mul_add_gfni_avx2;
+                  case e_gfni_avx512 : return mul_add_gfni_avx512;
+                  #endif
+
+                  #ifdef SCHIFRA_REGION_NEON
+                  case e_neon        : return mul_add_neon;
+                  #endif
+
+                  #ifdef SCHIFRA_REGION_SVE
+                  case e_sve         : return mul_add_sve;
+                  #endif
+
+                  default            : return mul_add_scalar;
+               }
+            }
+
+         } // namespace details
+
+         inline const char* backend_name(const backend_t backend)
+         {
+            switch (backend)
+            {
+               case e_scalar      : return "scalar";
+               case e_ssse3       : return "ssse3";
+               case e_avx2        : return "avx2";
+               case e_avx512      : return "avx512";
+               case e_gfni_avx2   : return "gfni-avx2";
+               case e_gfni_avx512 : return "gfni-avx512";
+               case e_neon        : return "neon";
+               case e_sve         : return "sve";
+               default            : return "unknown";
+            }
+         }
+
+         /*
+            A backend is supported when it was compiled in and the running
+            cpu implements the instructions it uses.
+         */
+         inline bool backend_supported(const backend_t backend)
+         {
+            const utils::cpu_features& cpu = utils::host_cpu_features();
+
+            (void)cpu;
+
+            switch (backend)
+            {
+               case e_scalar      : return true;
+               #ifdef SCHIFRA_REGION_X86
+               case e_ssse3       : return cpu.ssse3;
+               case e_avx2        : return cpu.avx2;
+               case e_avx512      : return cpu.avx512bw;
+               case e_gfni_avx2   : return cpu.gfni && cpu.avx2;
+               case e_gfni_avx512 : return cpu.gfni && cpu.avx512bw;
+               #endif
+               #ifdef SCHIFRA_REGION_NEON
+               case e_neon        : return cpu.neon;
+               #endif
+               #ifdef SCHIFRA_REGION_SVE
+               case e_sve         : return cpu.sve;
+               #endif
+               default            : return false;
+            }
+         }
+
+         inline backend_t best_backend()
+         {
+            static const backend_t preference[] =
+                                      {
+                                        e_gfni_avx512, e_avx512, e_gfni_avx2,
+                                        e_avx2, e_ssse3, e_sve, e_neon
+                                      };
+
+            for (std::size_t i = 0; i < sizeof(preference) / sizeof(backend_t); ++i)
+            {
+               if (backend_supported(preference[i]))
+                  return preference[i];
+            }
+
+            return e_scalar;
+         }
+
+         /*
+            Process-wide binding of the region kernels. The cpu is probed and
+            the best backend bound on first use, force() rebinds to a given
+            backend (eg: for benchmarking) and reset() restores the default.
+         */
+         class dispatcher
+         {
+         public:
+
+            static dispatcher& instance()
+            {
+               static dispatcher d;
+               return d;
+            }
+
+            inline backend_t backend() const
+            {
+               return backend_.load(std::memory_order_acquire);
+            }
+
+            inline bool force(const backend_t backend)
+            {
+               if (!backend_supported(backend))
+                  return false;
+
+               bind(backend);
+
+               return true;
+            }
+
+            inline void reset()
+            {
+               bind(best_backend());
+            }
+
+            inline void mul_add(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length) const
+            {
+               mul_add_.load(std::memory_order_relaxed)(m, src, dst, length);
+            }
+
+         private:
+
+            dispatcher()
+            {
+               reset();
+            }
+
+            dispatcher(const dispatcher&);
+            dispatcher& operator=(const dispatcher&);
+
+            inline void bind(const backend_t backend)
+            {
+               mul_add_.store(details::mul_add_kernel(backend), std::memory_order_relaxed);
+               backend_.store(backend, std::memory_order_release);
+            }
+
+            std::atomic<backend_t>          backend_;
+            std::atomic<mul_add_function_t> mul_add_;
+         };
+
+         /* dst[i] ^= c * src[i] through the currently bound backend */
+         inline void mul_add(const multiplier& m, const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+         {
+            dispatcher::instance().mul_add(m, src, dst, length);
+         }
+
+         inline backend_t active_backend()
+         {
+            return dispatcher::instance().backend();
+         }
+
+         inline bool force_backend(const backend_t backend)
+         {
+            return dispatcher::instance().force(backend);
+         }
+
+         inline void reset_backend()
+         {
+            dispatcher::instance().reset();
+         }
+
+      } // namespace region
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
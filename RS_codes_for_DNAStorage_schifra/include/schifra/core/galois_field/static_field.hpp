@@ -0,0 +1,242 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_STATIC_FIELD_HPP
+#define INCLUDE_SCHIFRA_GALOIS_STATIC_FIELD_HPP
+
+
+#include <cstddef>
+
+#include "schifra/core/galois_field/field.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      namespace details
+      {
+         template <unsigned int Power, unsigned int PrimPoly>
+         struct static_field_tables
+         {
+            static constexpr unsigned int field_size = (1U << Power) - 1;
+            static constexpr unsigned int order      = field_size + 1;
+
+            field_symbol  alpha_to[order];
+            field_symbol  index_of[order];
+            unsigned char inverse [order];
+            unsigned char mul     [order * order];
+
+            static constexpr static_field_tables generate()
+            {
+               static_field_tables t = {};
+
+               unsigned int x = 1;
+
+               for (unsigned int i = 0; i < field_size; ++i)
+               {
+                  t.alpha_to[i] = static_cast<field_symbol>(x);
+                  t.index_of[x] = static_cast<field_symbol>(i);
+
+                  x <<= 1;
+
+                  if (x & order)
+                  {
+                     x ^= PrimPoly;
+                  }
+               }
+
+               t.alpha_to[field_size] = 1;
+               t.index_of[0]          = GFERROR;
+
+               for (unsigned int a = 1; a < order; ++a)
+               {
+                  t.inverse[a] = static_cast<unsigned char>(t.alpha_to[(field_size - t.index_of[a]) % field_size]);
+
+                  for (unsigned int b = 1; b < order; ++b)
+                  {
+                     t.mul[(a << Power) | b] = static_cast<unsigned char>(t.alpha_to[(t.index_of[a] + t.index_of[b]) % field_size]);
+                  }
+               }
+
+               return t;
+            }
+         };
+
+      } // namespace details
+
+      /*
+         Compile-time Galois field GF(2^Power). PrimPoly is the primitive
+         polynomial as a bit mask, bit i being the coefficient of x^i, eg:
+         x^4 + x + 1 => 0x13. All tables are generated by the compiler into
+         flat constexpr arrays, so there is no startup cost and a multiply
+         is a single load from a contiguous table.
+
+         The arithmetic interface mirrors galois::field, so templated code
+         can be written against either type.
+      */
+      template <unsigned int Power, unsigned int PrimPoly>
+      class static_field
+      {
+      public:
+
+         static_assert((Power >= 2) && (Power <= 8), "static_field supports GF(2^2) to GF(2^8)");
+         static_assert((PrimPoly >> Power) == 1, "primitive polynomial degree must equal the field power");
+
+         typedef unsigned char table_symbol;
+
+         static constexpr unsigned int power      = Power;
+         static constexpr unsigned int prim_poly  = PrimPoly;
+         static constexpr unsigned int field_size = (1U << Power) - 1;
+         static constexpr unsigned int order      = field_size + 1;
+
+         static_field()
+         {}
+
+         static constexpr field_symbol index(const field_symbol value)
+         {
+            return tables_.index_of[value];
+         }
+
+         static constexpr field_symbol alpha(const field_symbol value)
+         {
+            return tables_.alpha_to[value];
+         }
+
+         static constexpr unsigned int size()
+         {
+            return field_size;
+         }
+
+         static constexpr unsigned int pwr()
+         {
+            return power;
+         }
+
+         static constexpr unsigned int mask()
+         {
+            return field_size;
+         }
+
+         static constexpr field_symbol add(const field_symbol a, const field_symbol b)
+         {
+            return (a ^ b);
+         }
+
+         static constexpr field_symbol sub(const field_symbol a, const field_symbol b)
+         {
+            return (a ^ b);
+         }
+
+         static constexpr field_symbol normalize(field_symbol x)
+         {
+            while (x < 0)
+            {
+               x += static_cast<field_symbol>(field_size);
+            }
+
+            while (x >= static_cast<field_symbol>(field_size))
+            {
+               x -= static_cast<field_symbol>(field_size);
+               x  = (x >> power) + (x & field_size);
+            }
+
+            return x;
+         }
+
+         static constexpr field_symbol mul(const field_symbol a, const field_symbol b)
+         {
+            return tables_.mul[(a << power) | b];
+         }
+
+         static constexpr field_symbol div(const field_symbol a, const field_symbol b)
+         {
+            return ((a == 0) || (b == 0)) ? 0 : tables_.mul[(a << power) | tables_.inverse[b]];
+         }
+
+         static constexpr field_symbol exp(const field_symbol a, int n)
+         {
+            if (0 == a)
+               return 0;
+
+            while (n < 0) n += field_size;
+
+            return (n ? tables_.alpha_to[(tables_.index_of[a] * n) % field_size] : 1);
+         }
+
+         static constexpr field_symbol inverse(const field_symbol val)
+         {
+            return tables_.inverse[val];
+         }
+
+         static constexpr unsigned int prim_poly_term(const unsigned int index)
+         {
+            return (prim_poly >> index) & 1;
+         }
+
+         /*
+            Row of the flat multiplication table for a fixed multiplicand,
+            mul_row(a)[b] == mul(a,b). Intended for region kernels.
+         */
+         static constexpr const table_symbol* mul_row(const field_symbol a)
+         {
+            return tables_.mul + (a << power);
+         }
+
+         /*
+            Returns true when gfield is the same field with the same element
+            representation, ie: symbols may be exchanged freely between the two.
+         */
+         static bool equivalent(const field& gfield)
+         {
+            if (gfield.pwr() != power)
+               return false;
+
+            for (unsigned int i = 0; i < field_size; ++i)
+            {
+               if (gfield.alpha(i) != alpha(i))
+                  return false;
+            }
+
+            return true;
+         }
+
+      private:
+
+         typedef details::static_field_tables<Power, PrimPoly> tables_t;
+
+         static constexpr tables_t tables_ = tables_t::generate();
+      };
+
+      /* GF(2^4), x^4 + x + 1, same representation as primitive_polynomial01 */
+      typedef static_field<4, 0x13>  gf16_static_field;
+
+      /* GF(2^8), x^8 + x^7 + x^2 + x + 1, same representation as primitive_polynomial06 */
+      typedef static_field<8, 0x187> gf256_static_field;
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
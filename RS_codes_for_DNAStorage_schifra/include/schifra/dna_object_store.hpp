@@ -0,0 +1,464 @@
+#ifndef SCHIFRA_DNA_OBJECT_STORE_HPP
+#define SCHIFRA_DNA_OBJECT_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/utils/schifra_crc.hpp"
+#include "schifra/dna_oligo_address.hpp"
+
+namespace schifra {
+
+/**
+ * @class oligo_object_store
+ * @brief Objects, ie: keys to bytes, over one addressed oligo pool.
+ *
+ * @tparam InnerStorage The addressed_pool_codec's inner strand codec
+ *
+ * put() encodes an object into whole stripes of its own, its strand IDs
+ * following those of the object put before it, and records its key, first
+ * strand ID, strand count and size in the index. The strands it returns
+ * are what gets synthesized; objects only ever append to the pool.
+ *
+ * Sequencing gives back reads of the whole pool, or by PCR of some of its
+ * objects. set_reads() decodes their addresses once, after which get()
+ * looks a key up in the index (a hash map) and decodes the data strands of
+ * that object only, on the pool's threads, rebuilding a strand from its
+ * stripe when none of its reads decode. Its cost follows the object's
+ * size, not the pool's.
+ *
+ * get() may be called from many threads at once. Requests arriving while
+ * a batch is being served queue up, and the first caller to find the store
+ * idle serves all of them as one batch, as get_batch() does: one pass over
+ * the index under one lock, then one parallel pass over the strands of
+ * every object in it.
+ *
+ * save_index() writes the index, little endian:
+ *   header : magic "SCHIFRAO", version, data strands, parity strands,
+ *            strand length, next strand ID, object count (all 32 bit)
+ *   entry  : key length, first strand ID, strand count (32 bit), object
+ *            size (64 bit), then the key, in strand ID order
+ *   CRC-32C of the bytes before it (32 bit)
+ * load_index() reads it back into a store of the same geometry.
+ */
+template <typename InnerStorage>
+class oligo_object_store {
+public:
+    typedef addressed_pool_codec<InnerStorage> codec_type;
+    typedef typename codec_type::read_index read_index;
+
+    // Strands [first_id, first_id + strands) of the pool hold the object
+    struct object_entry {
+        std::uint32_t first_id = 0;
+        std::uint32_t strands = 0;
+        std::uint64_t size = 0;
+    };
+
+    // Outcome of one get()
+    //   ok         : the object's bytes were recovered
+    //   not_found  : no object has the key
+    //   incomplete : a strand could not be recovered, its bytes left zero
+    enum class get_status {
+        ok,
+        not_found,
+        incomplete
+    };
+
+    // Counters since construction
+    //   requests        : keys asked for through get() and get_batch()
+    //   batches         : batches they were served in
+    //   strands_decoded : inner decodes run, stripe rebuilds included
+    //   stripes_rebuilt : stripes decoded whole to rebuild a strand
+    struct store_stats {
+        std::size_t requests = 0;
+        std::size_t batches = 0;
+        std::size_t strands_decoded = 0;
+        std::size_t stripes_rebuilt = 0;
+    };
+
+    static constexpr std::uint32_t index_version = 1;
+
+    // data_strands + parity_strands must not exceed 256, as for
+    // oligo_pool_codec. threads = 0 uses every hardware thread.
+    oligo_object_store(std::size_t data_strands, std::size_t parity_strands, std::size_t threads = 0)
+    : codec_(data_strands, parity_strands, threads) {}
+
+    oligo_object_store(const oligo_object_store&) = delete;
+    oligo_object_store& operator=(const oligo_object_store&) = delete;
+
+    const codec_type& codec() const { return codec_; }
+
+    // Encode an object into the strands to add to the pool. Throws if the
+    // key is taken or the pool would run out of 32 bit strand IDs.
+    std::vector<std::string> put(const std::string& key, const std::uint8_t* data, std::size_t size) {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        if (index_.count(key) != 0) {
+            throw std::invalid_argument("Object key already stored: " + key);
+        }
+
+        std::vector<std::string> strands = codec_.encode(data, size, next_id_);
+
+        object_entry entry;
+        entry.first_id = next_id_;
+        entry.strands = static_cast<std::uint32_t>(strands.size());
+        entry.size = size;
+        index_.emplace(key, entry);
+        next_id_ += entry.strands;
+
+        return strands;
+    }
+
+    std::vector<std::string> put(const std::string& key, const std::vector<std::uint8_t>& data) {
+        return put(key, data.data(), data.size());
+    }
+
+    // Where the object of key is, false if there is none
+    bool find(const std::string& key, object_entry& entry) const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        entry = it->second;
+        return true;
+    }
+
+    std::size_t objects() const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        return index_.size();
+    }
+
+    // Strands of the pool so far, ie: the next object's first strand ID
+    std::uint32_t pool_strands() const {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        return next_id_;
+    }
+
+    // The reads of a sequencing run, replacing those of the last; their
+    // addresses are decoded here, once for every get() that follows
+    void set_reads(std::vector<std::string> reads) {
+        read_index idx = codec_.index(reads);
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        reads_.swap(reads);
+        read_index_ = std::move(idx);
+    }
+
+    // Bytes of the object of key into out, batched with the get() calls of
+    // other threads
+    get_status get(const std::string& key, std::vector<std::uint8_t>& out) const {
+        request mine;
+        mine.key = &key;
+        mine.out = &out;
+
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_.push_back(&mine);
+
+        while (!mine.done) {
+            if (serving_) {
+                served_.wait(lock);
+                continue;
+            }
+
+            serving_ = true;
+            std::vector<request*> batch;
+            batch.swap(queue_);
+            lock.unlock();
+
+            std::exception_ptr error;
+            try {
+                serve(batch.data(), batch.size());
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            for (request* r : batch) {
+                r->error = error;
+                r->done = true;
+            }
+            serving_ = false;
+            served_.notify_all();
+        }
+
+        if (mine.error) {
+            std::rethrow_exception(mine.error);
+        }
+
+        return mine.status;
+    }
+
+    // get() of many keys as one batch, out receiving one object per key
+    std::vector<get_status> get_batch(const std::vector<std::string>& keys,
+                                      std::vector<std::vector<std::uint8_t>>& out) const {
+        out.resize(keys.size());
+
+        std::vector<request> requests(keys.size());
+        std::vector<request*> batch(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            requests[i].key = &keys[i];
+            requests[i].out = &out[i];
+            batch[i] = &requests[i];
+        }
+
+        serve(batch.data(), batch.size());
+
+        std::vector<get_status> status(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            status[i] = requests[i].status;
+        }
+        return status;
+    }
+
+    store_stats statistics() const {
+        store_stats snapshot;
+        snapshot.requests = requests_.load(std::memory_order_relaxed);
+        snapshot.batches = batches_.load(std::memory_order_relaxed);
+        snapshot.strands_decoded = strands_decoded_.load(std::memory_order_relaxed);
+        snapshot.stripes_rebuilt = stripes_rebuilt_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    void save_index(std::ostream& output) const {
+        std::string bytes(index_magic, sizeof(index_magic));
+
+        {
+            std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+            std::vector<std::pair<const std::string*, const object_entry*>> entries;
+            entries.reserve(index_.size());
+            for (const auto& item : index_) {
+                entries.emplace_back(&item.first, &item.second);
+            }
+            std::sort(entries.begin(), entries.end(),
+                [](const std::pair<const std::string*, const object_entry*>& a,
+                   const std::pair<const std::string*, const object_entry*>& b) {
+                    return a.second->first_id < b.second->first_id;
+                });
+
+            put_le(bytes, index_version, 4);
+            put_le(bytes, codec_.pool().data_strands(), 4);
+            put_le(bytes, codec_.pool().parity_strands(), 4);
+            put_le(bytes, codec_type::strand_length(), 4);
+            put_le(bytes, next_id_, 4);
+            put_le(bytes, entries.size(), 4);
+
+            for (const auto& entry : entries) {
+                put_le(bytes, entry.first->size(), 4);
+                put_le(bytes, entry.second->first_id, 4);
+                put_le(bytes, entry.second->strands, 4);
+                put_le(bytes, entry.second->size, 8);
+                bytes += *entry.first;
+            }
+        }
+
+        put_le(bytes, checksum(bytes.data(), bytes.size()), 4);
+
+        if (!output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            throw std::runtime_error("Failed to write the object index");
+        }
+    }
+
+    // Replace the index with one written by save_index(). Throws, leaving
+    // the index as it was, if it is damaged or of another pool geometry.
+    void load_index(std::istream& input) {
+        const std::string bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+        const std::size_t header_size = sizeof(index_magic) + 6 * 4;
+        if ((bytes.size() < header_size + 4) || !std::equal(index_magic, index_magic + sizeof(index_magic), bytes.data())) {
+            throw std::runtime_error("Not an object index");
+        }
+        if (get_le(bytes, bytes.size() - 4, 4) != checksum(bytes.data(), bytes.size() - 4)) {
+            throw std::runtime_error("Object index checksum mismatch");
+        }
+
+        std::size_t at = sizeof(index_magic);
+        const std::uint64_t version = get_le(bytes, at, 4);
+        const std::uint64_t data_strands = get_le(bytes, at + 4, 4);
+        const std::uint64_t parity_strands = get_le(bytes, at + 8, 4);
+        const std::uint64_t strand_length = get_le(bytes, at + 12, 4);
+        const std::uint32_t next_id = static_cast<std::uint32_t>(get_le(bytes, at + 16, 4));
+        const std::uint64_t count = get_le(bytes, at + 20, 4);
+        at = header_size;
+
+        if (version != index_version) {
+            throw std::runtime_error("Unsupported object index version");
+        }
+        if ((data_strands != codec_.pool().data_strands()) || (parity_strands != codec_.pool().parity_strands()) ||
+            (strand_length != codec_type::strand_length())) {
+            throw std::runtime_error("Object index is of another pool geometry");
+        }
+
+        std::unordered_map<std::string, object_entry> index;
+        index.reserve(count);
+
+        for (std::uint64_t i = 0; i < count; ++i) {
+            if (at + 20 > bytes.size() - 4) {
+                throw std::runtime_error("Truncated object index");
+            }
+            const std::size_t key_length = get_le(bytes, at, 4);
+            object_entry entry;
+            entry.first_id = static_cast<std::uint32_t>(get_le(bytes, at + 4, 4));
+            entry.strands = static_cast<std::uint32_t>(get_le(bytes, at + 8, 4));
+            entry.size = get_le(bytes, at + 12, 8);
+            at += 20;
+
+            if ((key_length > bytes.size() - 4 - at) || (entry.strands > next_id) || (entry.first_id > next_id - entry.strands)) {
+                throw std::runtime_error("Truncated object index");
+            }
+            if (!index.emplace(bytes.substr(at, key_length), entry).second) {
+                throw std::runtime_error("Object index holds a key twice");
+            }
+            at += key_length;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        index_.swap(index);
+        next_id_ = next_id;
+    }
+
+private:
+    // One key of a batch
+    struct request {
+        const std::string* key = nullptr;
+        std::vector<std::uint8_t>* out = nullptr;
+        get_status status = get_status::not_found;
+        std::exception_ptr error;
+        bool done = false;
+    };
+
+    // Data strand of an object to retrieve, into bytes [offset, offset +
+    // payload_bytes()) of its request's output, clipped to the object
+    struct strand_job {
+        std::size_t request;
+        std::uint32_t id;
+        std::size_t offset;
+    };
+
+    static constexpr char index_magic[8] = {'S','C','H','I','F','R','A','O'};
+
+    // One pass over the index for every request, then one parallel pass
+    // over the strands of all the objects found
+    void serve(request* const* batch, std::size_t count) const {
+        const std::size_t k = codec_.pool().data_strands();
+        const std::size_t stripe = codec_.pool().stripe_strands();
+        const std::size_t payload_bytes = codec_type::payload_bytes();
+
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+        std::vector<strand_job> jobs;
+        for (std::size_t r = 0; r < count; ++r) {
+            const auto it = index_.find(*batch[r]->key);
+            if (it == index_.end()) {
+                batch[r]->status = get_status::not_found;
+                batch[r]->out->clear();
+                continue;
+            }
+
+            const object_entry& entry = it->second;
+            batch[r]->status = get_status::ok;
+            batch[r]->out->assign(static_cast<std::size_t>(entry.size), 0);
+
+            const std::size_t data_strands = static_cast<std::size_t>((entry.size + payload_bytes - 1) / payload_bytes);
+            for (std::size_t d = 0; d < data_strands; ++d) {
+                strand_job job;
+                job.request = r;
+                job.id = static_cast<std::uint32_t>(entry.first_id + (d / k) * stripe + (d % k));
+                job.offset = d * payload_bytes;
+                jobs.push_back(job);
+            }
+        }
+
+        std::vector<char> failed(jobs.size(), 0);
+
+        // A job looks up, votes on and decodes the reads of one strand, so
+        // the jobs are split 4 times finer than the pool's own strands
+        codec_.pool().parallel_for(jobs.size(), [&](std::size_t first, std::size_t last) {
+            typename codec_type::retrieve_stats stats;
+            std::vector<std::uint8_t> payload(payload_bytes);
+
+            for (std::size_t j = first; j < last; ++j) {
+                const strand_job& job = jobs[j];
+                std::vector<std::uint8_t>& out = *batch[job.request]->out;
+
+                if (codec_.retrieve_strand(reads_, read_index_, job.id, payload.data(), stats)) {
+                    std::copy(payload.begin(), payload.begin() + std::min(payload_bytes, out.size() - job.offset),
+                              out.begin() + job.offset);
+                } else {
+                    failed[j] = 1;
+                }
+            }
+
+            strands_decoded_.fetch_add(stats.strands_decoded, std::memory_order_relaxed);
+            stripes_rebuilt_.fetch_add(stats.stripes_rebuilt, std::memory_order_relaxed);
+        }, codec_type::pool_type::min_strands_per_thread / 4);
+
+        for (std::size_t j = 0; j < jobs.size(); ++j) {
+            if (failed[j]) {
+                batch[jobs[j].request]->status = get_status::incomplete;
+            }
+        }
+
+        requests_.fetch_add(count, std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void put_le(std::string& bytes, std::uint64_t value, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static std::uint64_t get_le(const std::string& bytes, std::size_t at, std::size_t size) {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[at + i])) << (8 * i);
+        }
+        return value;
+    }
+
+    static std::uint32_t checksum(const char* bytes, std::size_t size) {
+        static const schifra::crc32 crc_module(schifra::crc32::crc32c_key, 0xFFFFFFFF, schifra::crc32::e_hardware);
+        return static_cast<std::uint32_t>(crc_module.process(0xFFFFFFFF, reinterpret_cast<const unsigned char*>(bytes), size) ^ 0xFFFFFFFF);
+    }
+
+    codec_type codec_;
+
+    // Objects and reads, shared by get() and replaced by put(), set_reads()
+    // and load_index()
+    mutable std::shared_mutex index_mutex_;
+    std::unordered_map<std::string, object_entry> index_;
+    std::uint32_t next_id_ = 0;
+    std::vector<std::string> reads_;
+    read_index read_index_;
+
+    // Requests of get() waiting for the batch being served to finish
+    mutable std::mutex queue_mutex_;
+    mutable std::condition_variable served_;
+    mutable std::vector<request*> queue_;
+    mutable bool serving_ = false;
+
+    mutable std::atomic<std::size_t> requests_{0};
+    mutable std::atomic<std::size_t> batches_{0};
+    mutable std::atomic<std::size_t> strands_decoded_{0};
+    mutable std::atomic<std::size_t> stripes_rebuilt_{0};
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_OBJECT_STORE_HPP
@@ -0,0 +1,353 @@
+#ifndef SCHIFRA_DNA_OLIGO_ADDRESS_HPP
+#define SCHIFRA_DNA_OLIGO_ADDRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/utils/schifra_span.hpp"
+#include "schifra/dna_oligo_pool.hpp"
+
+namespace schifra {
+
+/**
+ * @class strand_address_codec
+ * @brief 32 bit strand ID as a 24 base address field with its own code.
+ *
+ * The ID is 8 GF(2^4) symbols (low nibble first) under RS(12,8), a code
+ * shortened from RS(15,11) with the generator of dna_storage, carried as
+ * 2 bases per symbol (low bits first), so an address survives any 2
+ * corrupted symbols independently of the payload's code.
+ */
+class strand_address_codec {
+public:
+    static constexpr std::size_t id_symbols = 8;
+    static constexpr std::size_t fec_symbols = 4;
+    static constexpr std::size_t code_symbols = id_symbols + fec_symbols;
+    static constexpr std::size_t address_bases = 2 * code_symbols;
+
+    strand_address_codec()
+    : field_(schifra::galois::shared_field(4,
+                                           schifra::galois::primitive_polynomial_size01,
+                                           schifra::galois::primitive_polynomial01)),
+      generator_(schifra::reed_solomon::shared_generator(*field_, generator_polynomial_index, fec_symbols)) {
+        if (!generator_) {
+            throw std::runtime_error("Failed to create sequential root generator");
+        }
+        encoder_ = std::make_unique<const encoder_type>(*field_, generator_);
+        decoder_ = std::make_unique<const decoder_type>(*field_, generator_polynomial_index);
+    }
+
+    // Write the address_bases bases of id, false (bases left untouched)
+    // if the address cannot be encoded
+    bool encode(std::uint32_t id, char* bases) const noexcept {
+        std::uint8_t symbols[code_symbols];
+        for (std::size_t i = 0; i < id_symbols; ++i) {
+            symbols[i] = static_cast<std::uint8_t>((id >> (4 * i)) & 0x0F);
+        }
+        if (!encoder_->encode(schifra::utils::span<const std::uint8_t>(symbols, id_symbols),
+                              schifra::utils::span<std::uint8_t>(symbols + id_symbols, fec_symbols))) {
+            return false;
+        }
+        for (std::size_t i = 0; i < code_symbols; ++i) {
+            bases[2 * i] = schifra::utils::dna::symbol_to_base(symbols[i] & 3);
+            bases[2 * i + 1] = schifra::utils::dna::symbol_to_base((symbols[i] >> 2) & 3);
+        }
+        return true;
+    }
+
+    // The id of an address, false if a base is not one of ACGTacgt or the
+    // address cannot be corrected
+    bool decode(const char* bases, std::uint32_t& id) const noexcept {
+        std::uint8_t digits[address_bases];
+        if (!schifra::utils::dna::bases_to_symbols(bases, address_bases, digits)) {
+            return false;
+        }
+        std::uint8_t symbols[code_symbols];
+        for (std::size_t i = 0; i < code_symbols; ++i) {
+            symbols[i] = static_cast<std::uint8_t>(digits[2 * i] | (digits[2 * i + 1] << 2));
+        }
+        if (!decoder_->decode(schifra::utils::span<std::uint8_t>(symbols, code_symbols))) {
+            return false;
+        }
+        id = 0;
+        for (std::size_t i = 0; i < id_symbols; ++i) {
+            id |= static_cast<std::uint32_t>(symbols[i]) << (4 * i);
+        }
+        return true;
+    }
+
+private:
+    typedef schifra::reed_solomon::encoder<15, fec_symbols> encoder_type;
+    typedef schifra::reed_solomon::decoder<15, fec_symbols> decoder_type;
+
+    static constexpr unsigned int generator_polynomial_index = 1;
+
+    schifra::galois::field_registry::field_ptr field_;
+    schifra::reed_solomon::generator_cache::generator_ptr generator_;
+    std::unique_ptr<const encoder_type> encoder_;
+    std::unique_ptr<const decoder_type> decoder_;
+};
+
+/**
+ * @class addressed_pool_codec
+ * @brief oligo_pool_codec over a file, with addressed strands for random
+ * access.
+ *
+ * Every strand is an address field (strand_address_codec) holding its
+ * strand ID, ie: its slot in the pool, followed by the inner strand. The
+ * file's bytes are 4 bases each (low bits first), so byte b lives in data
+ * strand b / payload_bytes() and the strands covering any byte range
+ * follow from the layout alone.
+ *
+ * Several files share a pool by encoding each from its own first_id, a
+ * multiple of the stripe size, so their ID ranges do not overlap and
+ * stripes stay whole (see oligo_object_store).
+ *
+ * Reads come back from sequencing in no particular order, and for PCR
+ * based random access only some of them at all. index() decodes just
+ * their addresses into a read_index, ID to reads, after which retrieve()
+ * decodes the inner code of the strands covering a byte range only. When
+ * one of them cannot be recovered from any of its reads, the other reads
+ * of its stripe are decoded too and the outer code rebuilds it.
+ */
+template <typename InnerStorage>
+class addressed_pool_codec {
+public:
+    typedef oligo_pool_codec<InnerStorage> pool_type;
+    typedef typename pool_type::pool_stats pool_stats;
+
+    // Outcome of retrieve()
+    //   strands_decoded : inner decodes run, stripe rebuilds included
+    //   stripes_rebuilt : stripes decoded whole to rebuild a strand
+    struct retrieve_stats {
+        std::size_t strands_decoded = 0;
+        std::size_t stripes_rebuilt = 0;
+    };
+
+    // Reads by strand ID, built by index()
+    class read_index {
+    public:
+        // (strand ID, read number), sorted by ID
+        typedef std::pair<std::uint32_t, std::size_t> entry;
+        typedef typename std::vector<entry>::const_iterator const_iterator;
+
+        // Reads whose address decoded, and those whose address did not
+        std::size_t addressed() const { return entries_.size(); }
+        std::size_t unaddressed() const { return unaddressed_; }
+
+        // Every entry, in ID order
+        const_iterator begin() const { return entries_.begin(); }
+        const_iterator end() const { return entries_.end(); }
+
+        // Entries of the reads carrying strand id
+        std::pair<const_iterator, const_iterator> reads(std::uint32_t id) const {
+            return std::equal_range(entries_.begin(), entries_.end(), entry(id, 0),
+                [](const entry& a, const entry& b) { return a.first < b.first; });
+        }
+
+    private:
+        friend class addressed_pool_codec;
+
+        std::vector<entry> entries_;
+        std::size_t unaddressed_ = 0;
+    };
+
+    static constexpr std::size_t address_bases = strand_address_codec::address_bases;
+    static constexpr std::size_t strand_length() { return address_bases + InnerStorage::strand_length(); }
+    static constexpr std::size_t payload_bytes() { return pool_type::payload_bytes(); }
+
+    addressed_pool_codec(std::size_t data_strands, std::size_t parity_strands, std::size_t threads = 0)
+    : pool_(data_strands, parity_strands, threads) {}
+
+    const pool_type& pool() const { return pool_; }
+
+    // Strands of the pool of a file of file_size bytes
+    std::size_t pool_strands(std::size_t file_size) const {
+        const std::size_t stripe_bytes = pool_.data_strands() * payload_bytes();
+        return std::max<std::size_t>(1, (file_size + stripe_bytes - 1) / stripe_bytes) * pool_.stripe_strands();
+    }
+
+    // ID of the data strand holding byte offset of the file
+    std::uint32_t strand_id(std::size_t offset) const {
+        const std::size_t d = offset / payload_bytes();
+        return static_cast<std::uint32_t>((d / pool_.data_strands()) * pool_.stripe_strands() + (d % pool_.data_strands()));
+    }
+
+    // IDs of the data strands covering bytes [offset, offset + length)
+    std::vector<std::uint32_t> strand_ids(std::size_t offset, std::size_t length) const {
+        std::vector<std::uint32_t> ids;
+        if (length == 0) {
+            return ids;
+        }
+        for (std::size_t d = offset / payload_bytes(); d <= (offset + length - 1) / payload_bytes(); ++d) {
+            ids.push_back(strand_id(d * payload_bytes()));
+        }
+        return ids;
+    }
+
+    // Encode a file into addressed strands, strand i carrying ID first_id + i
+    std::vector<std::string> encode(const std::uint8_t* data, std::size_t size, std::uint32_t first_id = 0) const {
+        check_first_id(first_id);
+        if (pool_strands(size) > std::size_t(std::numeric_limits<std::uint32_t>::max()) - first_id) {
+            throw std::invalid_argument("File too large for 32 bit strand IDs");
+        }
+
+        std::string sequence(4 * size, 'A');
+        if (size > 0) {
+            schifra::utils::dna::packed_dna_view(data, 0, sequence.size()).unpack(&sequence[0]);
+        }
+
+        std::vector<std::string> strands = pool_.encode(sequence);
+        for (std::size_t i = 0; i < strands.size(); ++i) {
+            std::string strand(strand_length(), 'A');
+            if (!address_.encode(static_cast<std::uint32_t>(first_id + i), &strand[0])) {
+                throw std::runtime_error("Failed to encode strand address");
+            }
+            std::copy(strands[i].begin(), strands[i].end(), strand.begin() + address_bases);
+            strands[i].swap(strand);
+        }
+        return strands;
+    }
+
+    // Strand ID of a read, false when the read is of the wrong length or
+    // its address cannot be recovered
+    bool read_id(std::string_view read, std::uint32_t& id) const {
+        return (read.size() == strand_length()) && address_.decode(read.data(), id);
+    }
+
+    // Decode the address of every read, reads of the wrong length or with
+    // an unrecoverable address left out
+    read_index index(const std::vector<std::string>& reads) const {
+        read_index result;
+        result.entries_.reserve(reads.size());
+        for (std::size_t r = 0; r < reads.size(); ++r) {
+            std::uint32_t id = 0;
+            if (read_id(reads[r], id)) {
+                result.entries_.push_back(typename read_index::entry(id, r));
+            } else {
+                ++result.unaddressed_;
+            }
+        }
+        std::sort(result.entries_.begin(), result.entries_.end());
+        return result;
+    }
+
+    // Bytes [offset, offset + length) of a file of file_size bytes, encoded
+    // from first_id, into out, decoding only the strands covering them
+    // (and, to rebuild a strand none of whose reads decode, the rest of its
+    // stripe). Returns false when a strand could not be recovered, its
+    // bytes being left zero.
+    bool retrieve(const std::vector<std::string>& reads, const read_index& idx, std::size_t file_size,
+                  std::size_t offset, std::size_t length, std::vector<std::uint8_t>& out,
+                  retrieve_stats& stats, std::uint32_t first_id = 0) const {
+        if ((offset > file_size) || (length > file_size - offset)) {
+            throw std::invalid_argument("Byte range exceeds the file");
+        }
+        check_first_id(first_id);
+
+        stats = retrieve_stats();
+        out.assign(length, 0);
+
+        bool complete = true;
+        std::vector<std::uint8_t> payload(payload_bytes());
+
+        for (const std::uint32_t id : strand_ids(offset, length)) {
+            const bool recovered = retrieve_strand(reads, idx, first_id + id, payload.data(), stats);
+
+            // Copy the part of the strand inside the range
+            const std::size_t d = (id / pool_.stripe_strands()) * pool_.data_strands() + (id % pool_.stripe_strands());
+            const std::size_t first = std::max(offset, d * payload_bytes());
+            const std::size_t last = std::min(offset + length, (d + 1) * payload_bytes());
+
+            if (recovered) {
+                std::copy(payload.begin() + (first - d * payload_bytes()), payload.begin() + (last - d * payload_bytes()),
+                          out.begin() + (first - offset));
+            } else {
+                complete = false;
+            }
+        }
+
+        return complete;
+    }
+
+    // The payload_bytes() bytes of data strand id, from its own reads, else
+    // by rebuilding its stripe from the others. False when neither works.
+    bool retrieve_strand(const std::vector<std::string>& reads, const read_index& idx, std::uint32_t id,
+                         std::uint8_t* payload, retrieve_stats& stats) const {
+        return decode_strand(reads, idx, id, payload, stats) || rebuild_strand(reads, idx, id, payload, stats);
+    }
+
+private:
+    void check_first_id(std::uint32_t first_id) const {
+        if ((first_id % pool_.stripe_strands()) != 0) {
+            throw std::invalid_argument("First strand ID must start a stripe");
+        }
+    }
+
+    // Inner decode of the reads of strand id until one decodes
+    bool decode_strand(const std::vector<std::string>& reads, const read_index& idx, std::uint32_t id,
+                       std::uint8_t* payload, retrieve_stats& stats) const {
+        char bases[InnerStorage::strand_data_length()];
+        const auto range = idx.reads(id);
+        for (auto r = range.first; r != range.second; ++r) {
+            ++stats.strands_decoded;
+            const std::string_view strand(reads[r->second].data() + address_bases, InnerStorage::strand_length());
+            if (pool_.inner().decode_strand(strand, bases) &&
+                schifra::utils::dna::pack_bases(bases, pool_type::payload_bases(), payload)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Outer decode of the stripe of strand id from one read per strand
+    bool rebuild_strand(const std::vector<std::string>& reads, const read_index& idx, std::uint32_t id,
+                        std::uint8_t* payload, retrieve_stats& stats) const {
+        const std::size_t stripe = id / pool_.stripe_strands();
+        const std::size_t position = id % pool_.stripe_strands();
+
+        // Reads that fail the inner decode come out as erasures either way,
+        // so the first read of each strand stands for it
+        std::vector<std::string> slots(pool_.stripe_strands());
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            const auto range = idx.reads(static_cast<std::uint32_t>(stripe * pool_.stripe_strands() + i));
+            if ((i != position) && (range.first != range.second)) {
+                slots[i] = reads[range.first->second].substr(address_bases);
+            }
+        }
+
+        ++stats.stripes_rebuilt;
+        stats.strands_decoded += slots.size();
+
+        pool_stats pstats;
+        const std::string sequence = pool_.decode(slots, pool_.stripe_bases(), pstats);
+        if (pstats.stripes_failed != 0) {
+            return false;
+        }
+        return schifra::utils::dna::pack_bases(sequence.data() + position * pool_type::payload_bases(),
+                                               pool_type::payload_bases(), payload);
+    }
+
+    pool_type pool_;
+    strand_address_codec address_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_OLIGO_ADDRESS_HPP
@@ -0,0 +1,386 @@
+#ifndef SCHIFRA_DNA_OLIGO_POOL_HPP
+#define SCHIFRA_DNA_OLIGO_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_cauchy_codec.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+
+namespace schifra {
+
+/**
+ * @class oligo_pool_codec
+ * @brief Two level (product) code for oligo pools: an inner Reed-Solomon
+ * code per strand and an outer erasure code across strands.
+ *
+ * @tparam InnerStorage In-band strand codec, eg: dna_storage<15,4,11> or
+ *         dna_storage_gf256<40,8>, providing strand_length(),
+ *         strand_data_length(), encode_strand() and decode_strand().
+ *
+ * The pool is cut into stripes of data_strands() data strands followed by
+ * parity_strands() outer parity strands. Row i of a stripe is strand i,
+ * protected on its own by the inner code. Column j is byte j of every
+ * strand's payload, 4 bases per GF(2^8) symbol, protected by a systematic
+ * Cauchy (MDS) code, so any data_strands() surviving strands of a stripe
+ * rebuild the others. A strand that was not read, or that the inner code
+ * could not correct, is an erasure of the outer code. The inner decoder
+ * checks its corrections against their syndromes (set_verify_corrections()),
+ * so a strand it would miscorrect is, where caught, an erasure too rather
+ * than wrong data the erasure code cannot see.
+ *
+ * The outer code works on whole bytes, so of the strand_data_length()
+ * bases of an inner strand the first payload_bases() (a multiple of 4)
+ * carry data and the rest are 'A' filler, eg: 20 of the 22 bases of an
+ * RS(15,11) in-band strand.
+ *
+ * Payloads are held shard major, byte j of strand i of stripe s at
+ * [(i * stripes + s) * payload_bytes() + j], so the outer encode is one
+ * pass of region kernels over all stripes at once, and the outer decode
+ * one pass per erasure pattern over all stripes sharing it. Inner encode
+ * and decode run on threads() threads.
+ */
+template <typename InnerStorage>
+class oligo_pool_codec {
+public:
+    typedef InnerStorage inner_type;
+
+    // Outcome of decode()
+    //   strands           : slots in the pool
+    //   dropped           : slots with no strand (or a strand of the wrong length)
+    //   inner_failed      : strands the inner code found uncorrectable or invalid
+    //   inner_suspect     : of those, strands whose correction failed the
+    //                       syndrome check
+    //   inner_corrected   : strands the inner code corrected
+    //   stripes_recovered : stripes with erasures rebuilt by the outer code
+    //   stripes_failed    : stripes with more erasures than parity strands,
+    //                       their data returned as 'N's
+    //   inner_time        : seconds spent in the inner decode
+    //   outer_time        : seconds spent grouping and rebuilding stripes
+    struct pool_stats {
+        std::size_t strands = 0;
+        std::size_t dropped = 0;
+        std::size_t inner_failed = 0;
+        std::size_t inner_suspect = 0;
+        std::size_t inner_corrected = 0;
+        std::size_t stripes_recovered = 0;
+        std::size_t stripes_failed = 0;
+        double inner_time = 0.0;
+        double outer_time = 0.0;
+
+        std::size_t erasures() const { return dropped + inner_failed; }
+    };
+
+    // Data bases per strand covered by the outer code, and their bytes
+    static constexpr std::size_t payload_bases() { return 4 * (InnerStorage::strand_data_length() / 4); }
+    static constexpr std::size_t payload_bytes() { return payload_bases() / 4; }
+
+    static_assert(payload_bytes() > 0, "Inner strands must carry at least 4 data bases");
+
+    // data_strands + parity_strands must not exceed 256, the outer code
+    // being over GF(2^8). threads = 0 uses every hardware thread.
+    oligo_pool_codec(std::size_t data_strands, std::size_t parity_strands, std::size_t threads = 0)
+    : field_(schifra::galois::shared_field(8,
+                                           schifra::galois::primitive_polynomial_size06,
+                                           schifra::galois::primitive_polynomial06)),
+      outer_(std::make_unique<const schifra::reed_solomon::cauchy_erasure_codec>(*field_, data_strands, parity_strands)),
+      threads_(threads) {
+        if (!outer_->valid()) {
+            throw std::invalid_argument("Outer code needs 1 to 255 data and parity strands, at most 256 in total");
+        }
+        if (threads_ == 0) {
+            const std::size_t hardware_threads = std::thread::hardware_concurrency();
+            threads_ = (hardware_threads > 0) ? hardware_threads : 1;
+        }
+        inner_.set_verify_corrections(true);
+    }
+
+    oligo_pool_codec(const oligo_pool_codec&) = delete;
+    oligo_pool_codec& operator=(const oligo_pool_codec&) = delete;
+
+    const inner_type& inner() const { return inner_; }
+
+    std::size_t data_strands() const { return outer_->data_shards(); }
+    std::size_t parity_strands() const { return outer_->parity_shards(); }
+    std::size_t stripe_strands() const { return outer_->total_shards(); }
+    std::size_t threads() const { return threads_; }
+
+    // Below this many strands per thread a thread costs more than it saves
+    static constexpr std::size_t min_strands_per_thread = 256;
+
+    // body(first, last) over [0, count) split across threads() threads, with
+    // at least min_per_thread items each, the first exception thrown by a
+    // thread rethrown here
+    template <typename Body>
+    void parallel_for(std::size_t count, Body body, std::size_t min_per_thread = min_strands_per_thread) const {
+        const std::size_t threads = std::min(threads_, std::max<std::size_t>(1, count / min_per_thread));
+        if (threads <= 1) {
+            body(std::size_t(0), count);
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                try {
+                    body(count * t / threads, count * (t + 1) / threads);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Sequence bases held by one stripe
+    std::size_t stripe_bases() const { return data_strands() * payload_bases(); }
+
+    // Encode a sequence into whole stripes, the last padded with 'A's.
+    // Strand i of stripe s is element s * stripe_strands() + i.
+    std::vector<std::string> encode(std::string_view dna_sequence) const {
+        const std::size_t stripes = std::max<std::size_t>(1, (dna_sequence.size() + stripe_bases() - 1) / stripe_bases());
+        const std::size_t k = data_strands();
+
+        std::vector<std::uint8_t> payload(stripe_strands() * stripes * payload_bytes());
+
+        for (std::size_t s = 0; s < stripes; ++s) {
+            for (std::size_t i = 0; i < k; ++i) {
+                const std::size_t offset = std::min(dna_sequence.size(), (s * k + i) * payload_bases());
+                const std::size_t count = std::min(payload_bases(), dna_sequence.size() - offset);
+
+                char bases[payload_bases()];
+                std::copy(dna_sequence.data() + offset, dna_sequence.data() + offset + count, bases);
+                std::fill(bases + count, bases + payload_bases(), 'A');
+
+                if (!schifra::utils::dna::pack_bases(bases, payload_bases(), shard(payload, stripes, s, i))) {
+                    throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters");
+                }
+            }
+        }
+
+        // Outer parity of every stripe in one pass
+        std::vector<const std::uint8_t*> data(k);
+        std::vector<std::uint8_t*> parity(parity_strands());
+        for (std::size_t i = 0; i < k; ++i) {
+            data[i] = shard(payload, stripes, 0, i);
+        }
+        for (std::size_t i = 0; i < parity_strands(); ++i) {
+            parity[i] = shard(payload, stripes, 0, k + i);
+        }
+        if (!outer_->encode(data.data(), parity.data(), stripes * payload_bytes())) {
+            throw std::runtime_error("Outer erasure encoding failed");
+        }
+
+        std::vector<std::string> strands(stripes * stripe_strands());
+
+        parallel_for(strands.size(), [&](std::size_t first, std::size_t last) {
+            char bases[InnerStorage::strand_data_length()];
+            std::fill(bases + payload_bases(), bases + InnerStorage::strand_data_length(), 'A');
+
+            for (std::size_t n = first; n < last; ++n) {
+                const std::size_t s = n / stripe_strands();
+                const std::size_t i = n % stripe_strands();
+
+                schifra::utils::dna::packed_dna_view(shard(payload, stripes, s, i), 0, payload_bases()).unpack(bases);
+
+                strands[n].resize(InnerStorage::strand_length());
+                if (!inner_.encode_strand(std::string_view(bases, InnerStorage::strand_data_length()), &strands[n][0])) {
+                    throw std::runtime_error("Inner Reed-Solomon encoding failed");
+                }
+            }
+        });
+
+        return strands;
+    }
+
+    // Decode a pool in slot order, as produced by encode(): an empty (or
+    // wrongly sized) slot is a lost strand. length is the length of the
+    // original sequence. Stripes with at most parity_strands() erasures are
+    // rebuilt, the data of the others comes back as 'N's.
+    std::string decode(const std::vector<std::string>& strands, std::size_t length, pool_stats& stats) const {
+        if ((strands.size() % stripe_strands()) != 0) {
+            throw std::invalid_argument("Pool size must be a multiple of " + std::to_string(stripe_strands()) + " strands");
+        }
+
+        const std::size_t stripes = strands.size() / stripe_strands();
+        const std::size_t k = data_strands();
+
+        if (length > stripes * stripe_bases()) {
+            throw std::invalid_argument("Sequence length exceeds the capacity of the pool");
+        }
+
+        stats = pool_stats();
+        stats.strands = strands.size();
+
+        std::vector<std::uint8_t> payload(stripe_strands() * stripes * payload_bytes());
+        std::vector<strand_state> state(strands.size(), strand_state::ok);
+
+        typedef std::chrono::steady_clock clock;
+        const clock::time_point inner_start = clock::now();
+
+        // Inner decode, every strand independently
+        parallel_for(strands.size(), [&](std::size_t first, std::size_t last) {
+            char bases[InnerStorage::strand_data_length()];
+
+            for (std::size_t n = first; n < last; ++n) {
+                const std::size_t s = n / stripe_strands();
+                const std::size_t i = n % stripe_strands();
+
+                if (strands[n].size() != InnerStorage::strand_length()) {
+                    state[n] = strand_state::dropped;
+                    continue;
+                }
+
+                const auto result = inner_.decode_strand(strands[n], bases);
+                if (result.error == InnerStorage::block_type::e_decoder_error5) {
+                    state[n] = strand_state::suspect;
+                } else if (!result || !schifra::utils::dna::pack_bases(bases, payload_bases(), shard(payload, stripes, s, i))) {
+                    state[n] = strand_state::failed;
+                } else if (result.errors_corrected > 0) {
+                    state[n] = strand_state::corrected;
+                }
+            }
+        });
+
+        const clock::time_point outer_start = clock::now();
+        stats.inner_time = std::chrono::duration<double>(outer_start - inner_start).count();
+
+        // Group the stripes by erasure pattern
+        std::map<schifra::reed_solomon::erasure_locations_t, std::vector<std::size_t>> patterns;
+        std::vector<bool> stripe_failed(stripes, false);
+
+        for (std::size_t s = 0; s < stripes; ++s) {
+            schifra::reed_solomon::erasure_locations_t missing;
+            for (std::size_t i = 0; i < stripe_strands(); ++i) {
+                switch (state[s * stripe_strands() + i]) {
+                case strand_state::dropped:
+                    ++stats.dropped;
+                    missing.push_back(i);
+                    break;
+                case strand_state::suspect:
+                    ++stats.inner_suspect;
+                    [[fallthrough]];
+                case strand_state::failed:
+                    ++stats.inner_failed;
+                    missing.push_back(i);
+                    break;
+                case strand_state::corrected:
+                    ++stats.inner_corrected;
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (missing.size() > parity_strands()) {
+                stripe_failed[s] = true;
+                ++stats.stripes_failed;
+            } else if (!missing.empty()) {
+                patterns[missing].push_back(s);
+            }
+        }
+
+        // Outer decode, one pass per pattern over all of its stripes
+        std::vector<std::uint8_t> gathered;
+        std::vector<std::uint8_t*> shards(stripe_strands());
+
+        for (const auto& pattern : patterns) {
+            const std::vector<std::size_t>& group = pattern.second;
+            const std::size_t group_bytes = group.size() * payload_bytes();
+
+            gathered.resize(stripe_strands() * group_bytes);
+
+            for (std::size_t i = 0; i < stripe_strands(); ++i) {
+                shards[i] = &gathered[i * group_bytes];
+                for (std::size_t g = 0; g < group.size(); ++g) {
+                    std::copy(shard(payload, stripes, group[g], i), shard(payload, stripes, group[g], i) + payload_bytes(),
+                              shards[i] + g * payload_bytes());
+                }
+            }
+
+            if (!outer_->decode(shards.data(), pattern.first, group_bytes)) {
+                throw std::runtime_error("Outer erasure decoding failed");
+            }
+
+            for (const std::size_t i : pattern.first) {
+                for (std::size_t g = 0; g < group.size(); ++g) {
+                    std::copy(shards[i] + g * payload_bytes(), shards[i] + (g + 1) * payload_bytes(),
+                              shard(payload, stripes, group[g], i));
+                }
+            }
+
+            stats.stripes_recovered += group.size();
+        }
+
+        stats.outer_time = std::chrono::duration<double>(clock::now() - outer_start).count();
+
+        std::string sequence(stripes * stripe_bases(), 'N');
+
+        for (std::size_t s = 0; s < stripes; ++s) {
+            if (stripe_failed[s]) {
+                continue;
+            }
+            for (std::size_t i = 0; i < k; ++i) {
+                schifra::utils::dna::packed_dna_view(shard(payload, stripes, s, i), 0, payload_bases())
+                    .unpack(&sequence[(s * k + i) * payload_bases()]);
+            }
+        }
+
+        sequence.resize(length);
+        return sequence;
+    }
+
+    // Outer decode of one stripe, shards[i] holding the payload_bytes()
+    // bytes of its strand i: the strands at missing, at most
+    // parity_strands() of them, are rebuilt from the others
+    bool rebuild_stripe(std::uint8_t* const* shards, const schifra::reed_solomon::erasure_locations_t& missing) const {
+        return outer_->decode(shards, missing, payload_bytes());
+    }
+
+private:
+    enum class strand_state : std::uint8_t {
+        ok,
+        corrected,
+        dropped,
+        failed,
+        suspect
+    };
+
+    // Payload of strand i of stripe s in the shard major layout
+    static std::uint8_t* shard(std::vector<std::uint8_t>& payload, std::size_t stripes, std::size_t s, std::size_t i) {
+        return &payload[(i * stripes + s) * payload_bytes()];
+    }
+
+    inner_type inner_;
+    schifra::galois::field_registry::field_ptr field_;
+    std::unique_ptr<const schifra::reed_solomon::cauchy_erasure_codec> outer_;
+    std::size_t threads_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_OLIGO_POOL_HPP
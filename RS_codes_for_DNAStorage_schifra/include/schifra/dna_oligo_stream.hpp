@@ -0,0 +1,285 @@
+#ifndef SCHIFRA_DNA_OLIGO_STREAM_HPP
+#define SCHIFRA_DNA_OLIGO_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/dna_oligo_address.hpp"
+
+namespace schifra {
+
+/**
+ * @class addressed_stream_decoder
+ * @brief Decodes a file from addressed reads as they come off a sequencer,
+ * giving out its bytes as soon as they are recovered.
+ *
+ * @tparam InnerStorage The addressed_pool_codec's inner strand codec
+ *
+ * A nanopore run emits reads continuously and in no order. push() takes a
+ * small batch of them and decodes for at most the time budget, leaving the
+ * rest queued for the next push() or poll(), so a caller on the read
+ * stream is never held up for longer than that. Each read costs an address
+ * decode, and an inner decode only when its strand is still missing, so
+ * once a strand is recovered its later reads are dropped almost for free.
+ *
+ * A recovered data strand's bytes go to the sink at once. When a stripe
+ * holds data_strands() recovered strands but still misses data, the outer
+ * code rebuilds it right away rather than waiting for more reads of its
+ * data strands. complete() turns true once every byte of the file is
+ * recovered, and push() returns it, so sequencing can be stopped then.
+ *
+ * Decoding runs on the caller's thread, latency rather than throughput
+ * being the aim; the sink is called from inside push(), poll() and drain().
+ */
+template <typename InnerStorage>
+class addressed_stream_decoder {
+public:
+    typedef addressed_pool_codec<InnerStorage> codec_type;
+    typedef typename codec_type::pool_type pool_type;
+    typedef std::chrono::steady_clock clock;
+
+    // Bytes [offset, offset + length) of the file, recovered. Called once
+    // per data strand, in the order they are recovered.
+    typedef std::function<void(std::size_t offset, const std::uint8_t* bytes, std::size_t length)> sink_type;
+
+    // Progress so far
+    //   reads              : reads taken in by push()
+    //   unaddressed        : of those, of the wrong length, with an
+    //                        unrecoverable address or one outside the file
+    //   redundant          : of strands already recovered, or of stripes
+    //                        whose data is, not decoded
+    //   inner_failed       : the inner code found uncorrectable
+    //   strands_decoded    : strands recovered from one of their reads
+    //   strands_rebuilt    : strands rebuilt by the outer code
+    //   time_to_first_byte : seconds from the first push() to the first
+    //                        bytes given out, 0 until then
+    //   time_to_complete   : seconds from the first push() to complete(),
+    //                        0 until then
+    struct stream_stats {
+        std::size_t reads = 0;
+        std::size_t unaddressed = 0;
+        std::size_t redundant = 0;
+        std::size_t inner_failed = 0;
+        std::size_t strands_decoded = 0;
+        std::size_t strands_rebuilt = 0;
+        double time_to_first_byte = 0.0;
+        double time_to_complete = 0.0;
+    };
+
+    static constexpr std::chrono::microseconds default_budget{500};
+
+    // Decoder of a file of file_size bytes encoded from first_id
+    addressed_stream_decoder(const codec_type& codec, std::size_t file_size, sink_type sink = sink_type(),
+                             std::uint32_t first_id = 0, std::chrono::microseconds budget = default_budget)
+        : codec_(codec),
+          sink_(std::move(sink)),
+          file_size_(file_size),
+          first_id_(first_id),
+          budget_(budget),
+          strands_(codec.pool_strands(file_size)),
+          needed_((file_size + codec_type::payload_bytes() - 1) / codec_type::payload_bytes()),
+          data_(file_size, 0),
+          payload_(strands_ * codec_type::payload_bytes()),
+          recovered_(strands_, false),
+          stripe_strands_(strands_ / codec.pool().stripe_strands(), 0),
+          stripe_data_(strands_ / codec.pool().stripe_strands(), 0) {
+        if ((first_id % codec.pool().stripe_strands()) != 0) {
+            throw std::invalid_argument("First strand ID must start a stripe");
+        }
+    }
+
+    // Queue a batch of reads and decode for up to the budget. Returns
+    // complete().
+    bool push(const std::string_view* reads, std::size_t count) {
+        for (std::size_t r = 0; r < count; ++r) {
+            ++stats_.reads;
+            if (reads[r].size() != codec_type::strand_length()) {
+                ++stats_.unaddressed;
+                continue;
+            }
+            queue_.append(reads[r].data(), reads[r].size());
+        }
+        return poll(budget_);
+    }
+
+    bool push(const std::vector<std::string>& reads) {
+        std::vector<std::string_view> views(reads.begin(), reads.end());
+        return push(views.data(), views.size());
+    }
+
+    // Decode queued reads for up to budget. Returns complete().
+    bool poll(std::chrono::microseconds budget) {
+        return process(true, budget);
+    }
+
+    bool poll() { return poll(budget_); }
+
+    // Decode every queued read. Returns complete().
+    bool drain() { return process(false, budget_); }
+
+    // Reads queued but not decoded yet
+    std::size_t pending() const { return (queue_.size() - head_) / codec_type::strand_length(); }
+
+    // Every byte of the file has been recovered
+    bool complete() const { return recovered_data_ == needed_; }
+
+    // Data strands of the file not recovered yet
+    std::size_t missing_strands() const { return needed_ - recovered_data_; }
+
+    // The file, its bytes not recovered yet left zero
+    const std::vector<std::uint8_t>& data() const { return data_; }
+
+    const stream_stats& stats() const { return stats_; }
+
+private:
+    // Decode queued reads, for up to budget when bounded. At least one
+    // read is decoded per call, whatever the budget.
+    bool process(bool bounded, std::chrono::microseconds budget) {
+        const clock::time_point now = clock::now();
+        if (!started_) {
+            start_ = now;
+            started_ = true;
+        }
+
+        const clock::time_point deadline = now + budget;
+        while ((pending() > 0) && !complete()) {
+            decode_read(std::string_view(queue_.data() + head_, codec_type::strand_length()));
+            head_ += codec_type::strand_length();
+            if (bounded && (clock::now() >= deadline)) {
+                break;
+            }
+        }
+
+        if (complete()) {
+            queue_.clear();
+            head_ = 0;
+        } else if (head_ >= (queue_.size() / 2)) {
+            queue_.erase(0, head_);
+            head_ = 0;
+        }
+        return complete();
+    }
+
+    void decode_read(std::string_view read) {
+        std::uint32_t id = 0;
+        if (!codec_.read_id(read, id) || (id < first_id_) || ((id - first_id_) >= strands_)) {
+            ++stats_.unaddressed;
+            return;
+        }
+
+        const std::size_t n = id - first_id_;
+        const std::size_t stripe = n / codec_.pool().stripe_strands();
+        if (recovered_[n] || (stripe_data_[stripe] == codec_.pool().data_strands())) {
+            ++stats_.redundant;
+            return;
+        }
+
+        char bases[InnerStorage::strand_data_length()];
+        const std::string_view strand(read.data() + codec_type::address_bases, InnerStorage::strand_length());
+        if (!codec_.pool().inner().decode_strand(strand, bases) ||
+            !schifra::utils::dna::pack_bases(bases, pool_type::payload_bases(), shard(n))) {
+            ++stats_.inner_failed;
+            return;
+        }
+
+        ++stats_.strands_decoded;
+        recover(n);
+
+        if ((stripe_strands_[stripe] == codec_.pool().data_strands()) &&
+            (stripe_data_[stripe] < codec_.pool().data_strands())) {
+            rebuild(stripe);
+        }
+    }
+
+    // Outer decode of a stripe holding data_strands() recovered strands
+    void rebuild(std::size_t stripe) {
+        const std::size_t first = stripe * codec_.pool().stripe_strands();
+
+        schifra::reed_solomon::erasure_locations_t missing;
+        std::vector<std::uint8_t*> shards(codec_.pool().stripe_strands());
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            shards[i] = shard(first + i);
+            if (!recovered_[first + i]) {
+                missing.push_back(i);
+            }
+        }
+
+        if (!codec_.pool().rebuild_stripe(shards.data(), missing)) {
+            return;
+        }
+
+        for (const std::size_t i : missing) {
+            ++stats_.strands_rebuilt;
+            recover(first + i);
+        }
+    }
+
+    // Mark strand n recovered, its payload being in place, and give out
+    // its bytes when it is a data strand of the file
+    void recover(std::size_t n) {
+        recovered_[n] = true;
+
+        const std::size_t stripe = n / codec_.pool().stripe_strands();
+        const std::size_t i = n % codec_.pool().stripe_strands();
+        ++stripe_strands_[stripe];
+
+        if (i >= codec_.pool().data_strands()) {
+            return;
+        }
+        ++stripe_data_[stripe];
+
+        const std::size_t d = stripe * codec_.pool().data_strands() + i;
+        if (d >= needed_) {
+            return;
+        }
+
+        const std::size_t offset = d * codec_type::payload_bytes();
+        const std::size_t length = std::min(codec_type::payload_bytes(), file_size_ - offset);
+        std::copy(shard(n), shard(n) + length, data_.begin() + offset);
+
+        ++recovered_data_;
+        if (recovered_data_ == 1) {
+            stats_.time_to_first_byte = std::chrono::duration<double>(clock::now() - start_).count();
+        }
+        if (complete()) {
+            stats_.time_to_complete = std::chrono::duration<double>(clock::now() - start_).count();
+        }
+        if (sink_) {
+            sink_(offset, data_.data() + offset, length);
+        }
+    }
+
+    std::uint8_t* shard(std::size_t n) { return &payload_[n * codec_type::payload_bytes()]; }
+
+    const codec_type& codec_;
+    sink_type sink_;
+    std::size_t file_size_;
+    std::uint32_t first_id_;
+    std::chrono::microseconds budget_;
+    std::size_t strands_;
+    std::size_t needed_;
+    std::size_t recovered_data_ = 0;
+    std::vector<std::uint8_t> data_;
+    std::vector<std::uint8_t> payload_;
+    std::vector<bool> recovered_;
+    std::vector<std::size_t> stripe_strands_;
+    std::vector<std::size_t> stripe_data_;
+    std::string queue_;
+    std::size_t head_ = 0;
+    bool started_ = false;
+    clock::time_point start_;
+    stream_stats stats_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_OLIGO_STREAM_HPP
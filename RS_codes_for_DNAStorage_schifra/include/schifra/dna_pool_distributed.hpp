@@ -0,0 +1,491 @@
+#ifndef SCHIFRA_DNA_POOL_DISTRIBUTED_HPP
+#define SCHIFRA_DNA_POOL_DISTRIBUTED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_cauchy_codec.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/dna_oligo_address.hpp"
+
+namespace schifra {
+
+// Timing of one stage of distributed_pool_decoder::decode() on one node
+//   items          : what the stage got through, eg: reads or strands
+//   bytes_sent     : to other nodes, and bytes_received from them
+struct pool_stage_stats {
+    const char* name = "";
+    double seconds = 0.0;
+    std::size_t items = 0;
+    std::size_t bytes_sent = 0;
+    std::size_t bytes_received = 0;
+
+    double items_per_second() const { return (seconds > 0.0) ? items / seconds : 0.0; }
+};
+
+/**
+ * @class distributed_pool_decoder
+ * @brief addressed_pool_codec decode of a whole pool of reads spread over
+ * the nodes of a mesh, eg: utils::tcp_mesh.
+ *
+ * @tparam InnerStorage The addressed_pool_codec's inner strand codec
+ * @tparam Mesh Provides rank(), nodes() and the all-to-all
+ *         exchange(outgoing, incoming) of utils::tcp_mesh
+ *
+ * Every node calls decode() with its own share of the reads, in any split.
+ *   partition : addresses are decoded and each read sent to the node its
+ *               strand ID hashes to, so all reads of a strand meet on one
+ *               node whichever nodes sequenced them
+ *   inner     : reads are clustered by strand ID and each strand decoded,
+ *               by consensus of its reads where the inner codec has a
+ *               multi-read decode_strand(), else read by read
+ *   shuffle   : the payload bytes of the outer code are dealt out by
+ *               column, node c owning a contiguous range of the
+ *               payload_bytes() columns of every strand, and each decoded
+ *               strand's columns sent to their owners
+ *   outer     : each node runs the outer erasure decode of every stripe
+ *               over its own columns, a strand none of whose columns
+ *               arrived being an erasure
+ *   gather    : the data columns, and the counts behind pool_stats, are
+ *               sent to rank 0, which assembles the file
+ * Each stage's work is split evenly over the nodes, the outer code being
+ * a per byte column code, so only the exchanges grow with their number.
+ */
+template <typename InnerStorage, typename Mesh>
+class distributed_pool_decoder {
+public:
+    typedef addressed_pool_codec<InnerStorage> codec_type;
+    typedef typename codec_type::pool_stats pool_stats;
+
+    // Outcome of decode(). pool is only filled in on rank 0, stages on
+    // every node for its own share.
+    //   reads       : reads handed to this node's decode()
+    //   unaddressed : of them, reads whose address could not be decoded
+    struct distributed_stats {
+        std::size_t reads = 0;
+        std::size_t unaddressed = 0;
+        pool_stats pool;
+        std::vector<pool_stage_stats> stages;
+
+        double seconds() const {
+            double total = 0.0;
+            for (const pool_stage_stats& stage : stages) {
+                total += stage.seconds;
+            }
+            return total;
+        }
+
+        void print(std::ostream& out) const {
+            for (const pool_stage_stats& stage : stages) {
+                out << "  " << stage.name << ": " << stage.seconds << " s, " << stage.items << " items ("
+                    << stage.items_per_second() << "/s), " << stage.bytes_sent << " bytes sent, "
+                    << stage.bytes_received << " bytes received\n";
+            }
+        }
+    };
+
+    distributed_pool_decoder(const codec_type& codec, Mesh& mesh)
+    : codec_(codec),
+      mesh_(mesh),
+      field_(schifra::galois::shared_field(8,
+                                           schifra::galois::primitive_polynomial_size06,
+                                           schifra::galois::primitive_polynomial06)),
+      outer_(std::make_unique<const schifra::reed_solomon::cauchy_erasure_codec>(*field_,
+                                                                                 codec.pool().data_strands(),
+                                                                                 codec.pool().parity_strands())) {
+        if (mesh_.nodes() == 0) {
+            throw std::invalid_argument("The mesh has no nodes");
+        }
+    }
+
+    distributed_pool_decoder(const distributed_pool_decoder&) = delete;
+    distributed_pool_decoder& operator=(const distributed_pool_decoder&) = delete;
+
+    // Collective decode of a file of file_size bytes, every node passing
+    // its share of the reads. On rank 0 out receives the file, the bytes
+    // of stripes that could not be rebuilt left zero, and the result is
+    // false if there were any; elsewhere out is left empty.
+    bool decode(const std::vector<std::string>& reads, std::size_t file_size,
+                std::vector<std::uint8_t>& out, distributed_stats& stats) const {
+        const std::size_t nodes = mesh_.nodes();
+        const std::size_t total = codec_.pool_strands(file_size);
+        const std::size_t stripes = total / codec_.pool().stripe_strands();
+        const std::size_t columns = column_end(mesh_.rank()) - column_begin(mesh_.rank());
+
+        stats = distributed_stats();
+        stats.reads = reads.size();
+        out.clear();
+
+        std::vector<std::string> outgoing(nodes);
+        std::vector<std::string> incoming;
+
+        // Partition reads by strand ID
+        stage_timer partition(stats, "partition", reads.size());
+        const typename codec_type::read_index idx = codec_.index(reads);
+        stats.unaddressed = idx.unaddressed();
+        {
+            const std::size_t record = 4 + InnerStorage::strand_length();
+            std::vector<std::size_t> sizes(nodes, 0);
+            for (const auto& e : idx) {
+                ++sizes[owner(e.first)];
+            }
+            for (std::size_t n = 0; n < nodes; ++n) {
+                outgoing[n].reserve(sizes[n] * record);
+            }
+            for (const auto& e : idx) {
+                if (e.first >= total) {
+                    ++stats.unaddressed;
+                    continue;
+                }
+                std::string& message = outgoing[owner(e.first)];
+                put_u32(message, e.first);
+                message.append(reads[e.second], codec_type::address_bases, InnerStorage::strand_length());
+            }
+        }
+        exchange(outgoing, incoming, partition);
+        partition.stop();
+
+        // Cluster by strand ID and decode each strand
+        stage_timer inner(stats, "inner", 0);
+        std::vector<std::pair<std::uint32_t, std::string_view>> strands;
+        for (const std::string& message : incoming) {
+            const std::size_t record = 4 + InnerStorage::strand_length();
+            for (std::size_t p = 0; p + record <= message.size(); p += record) {
+                strands.emplace_back(get_u32(message.data() + p),
+                                     std::string_view(message.data() + p + 4, InnerStorage::strand_length()));
+            }
+        }
+        std::stable_sort(strands.begin(), strands.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::vector<std::size_t> groups;
+        for (std::size_t r = 0; r < strands.size(); ++r) {
+            if ((r == 0) || (strands[r].first != strands[r - 1].first)) {
+                groups.push_back(r);
+            }
+        }
+
+        inner.stage().items = groups.size();
+        std::vector<std::uint8_t> payload(groups.size() * codec_type::payload_bytes());
+        std::vector<strand_state> state(groups.size(), strand_state::failed);
+
+        codec_.pool().parallel_for(groups.size(), [&](std::size_t first, std::size_t last) {
+            std::vector<std::string_view> group_reads;
+            for (std::size_t g = first; g < last; ++g) {
+                const std::size_t begin = groups[g];
+                const std::size_t end = (g + 1 < groups.size()) ? groups[g + 1] : strands.size();
+                group_reads.clear();
+                for (std::size_t r = begin; r < end; ++r) {
+                    group_reads.push_back(strands[r].second);
+                }
+                state[g] = decode_strand(group_reads, &payload[g * codec_type::payload_bytes()]);
+            }
+        });
+
+        std::size_t inner_failed = 0;
+        std::size_t inner_corrected = 0;
+        for (const strand_state s : state) {
+            inner_failed += (s == strand_state::failed) ? 1 : 0;
+            inner_corrected += (s == strand_state::corrected) ? 1 : 0;
+        }
+        inner.stop();
+
+        // Shuffle the decoded strands' columns to their owners
+        stage_timer shuffle(stats, "shuffle", groups.size() - inner_failed);
+        for (std::size_t n = 0; n < nodes; ++n) {
+            outgoing[n].clear();
+            outgoing[n].reserve((groups.size() - inner_failed) * (4 + column_end(n) - column_begin(n)));
+        }
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            if (state[g] == strand_state::failed) {
+                continue;
+            }
+            const std::uint8_t* bytes = &payload[g * codec_type::payload_bytes()];
+            for (std::size_t n = 0; n < nodes; ++n) {
+                put_u32(outgoing[n], strands[groups[g]].first);
+                outgoing[n].append(reinterpret_cast<const char*>(bytes) + column_begin(n), column_end(n) - column_begin(n));
+            }
+        }
+        exchange(outgoing, incoming, shuffle);
+        shuffle.stop();
+
+        // Outer decode of every stripe over this node's columns
+        const std::size_t stripe_strands = codec_.pool().stripe_strands();
+        const std::size_t k = codec_.pool().data_strands();
+
+        stage_timer outer(stats, "outer", stripes);
+        std::vector<std::uint8_t> columns_payload(total * columns);
+        std::vector<bool> present(total, false);
+
+        // Column data of strand i of stripe s, shard major as oligo_pool_codec
+        auto shard = [&](std::size_t s, std::size_t i) { return &columns_payload[(i * stripes + s) * columns]; };
+
+        for (const std::string& message : incoming) {
+            for (std::size_t p = 0; p + 4 + columns <= message.size(); p += 4 + columns) {
+                const std::uint32_t id = get_u32(message.data() + p);
+                present[id] = true;
+                std::copy(message.data() + p + 4, message.data() + p + 4 + columns,
+                          reinterpret_cast<char*>(shard(id / stripe_strands, id % stripe_strands)));
+            }
+        }
+
+        std::map<schifra::reed_solomon::erasure_locations_t, std::vector<std::size_t>> patterns;
+        std::vector<bool> stripe_failed(stripes, false);
+        std::size_t stripes_failed = 0;
+        std::size_t stripes_recovered = 0;
+
+        for (std::size_t s = 0; s < stripes; ++s) {
+            schifra::reed_solomon::erasure_locations_t missing;
+            for (std::size_t i = 0; i < stripe_strands; ++i) {
+                if (!present[s * stripe_strands + i]) {
+                    missing.push_back(i);
+                }
+            }
+            if (missing.size() > codec_.pool().parity_strands()) {
+                stripe_failed[s] = true;
+                ++stripes_failed;
+            } else if (!missing.empty()) {
+                patterns[missing].push_back(s);
+            }
+        }
+
+        std::vector<std::uint8_t> gathered;
+        std::vector<std::uint8_t*> shards(stripe_strands);
+
+        for (const auto& pattern : patterns) {
+            const std::vector<std::size_t>& group = pattern.second;
+            stripes_recovered += group.size();
+
+            if (columns == 0) {
+                continue;
+            }
+
+            const std::size_t group_bytes = group.size() * columns;
+            gathered.resize(stripe_strands * group_bytes);
+
+            for (std::size_t i = 0; i < stripe_strands; ++i) {
+                shards[i] = &gathered[i * group_bytes];
+                for (std::size_t g = 0; g < group.size(); ++g) {
+                    std::copy(shard(group[g], i), shard(group[g], i) + columns, shards[i] + g * columns);
+                }
+            }
+
+            if (!outer_->decode(shards.data(), pattern.first, group_bytes)) {
+                throw std::runtime_error("Outer erasure decoding failed");
+            }
+
+            for (const std::size_t i : pattern.first) {
+                for (std::size_t g = 0; g < group.size(); ++g) {
+                    std::copy(shards[i] + g * columns, shards[i] + (g + 1) * columns, shard(group[g], i));
+                }
+            }
+        }
+        outer.stop();
+
+        // Gather the data columns and counts on rank 0
+        stage_timer gather(stats, "gather", stripes * k);
+        for (std::size_t n = 0; n < nodes; ++n) {
+            outgoing[n].clear();
+        }
+        {
+            std::string& message = outgoing[0];
+            message.reserve(4 * 8 + stripes * k * columns);
+            put_u64(message, reads.size());
+            put_u64(message, stats.unaddressed);
+            put_u64(message, groups.size());
+            put_u64(message, inner_failed);
+            put_u64(message, inner_corrected);
+            for (std::size_t s = 0; s < stripes; ++s) {
+                for (std::size_t i = 0; i < k; ++i) {
+                    if (stripe_failed[s]) {
+                        message.append(columns, '\0');
+                    } else {
+                        message.append(reinterpret_cast<const char*>(shard(s, i)), columns);
+                    }
+                }
+            }
+        }
+        exchange(outgoing, incoming, gather);
+
+        bool complete = true;
+
+        if (mesh_.rank() == 0) {
+            std::size_t seen = 0;
+            stats.pool = pool_stats();
+            stats.pool.strands = total;
+            stats.pool.stripes_failed = stripes_failed;
+            stats.pool.stripes_recovered = stripes_recovered;
+
+            out.assign(file_size, 0);
+
+            for (std::size_t n = 0; n < nodes; ++n) {
+                const std::string& message = incoming[n];
+                const std::size_t width = column_end(n) - column_begin(n);
+                if (message.size() != 5 * 8 + stripes * k * width) {
+                    throw std::runtime_error("Malformed gather message from node " + std::to_string(n));
+                }
+                seen += get_u64(message.data() + 2 * 8);
+                stats.pool.inner_failed += get_u64(message.data() + 3 * 8);
+                stats.pool.inner_corrected += get_u64(message.data() + 4 * 8);
+
+                const char* data = message.data() + 5 * 8;
+                for (std::size_t s = 0; s < stripes; ++s) {
+                    for (std::size_t i = 0; i < k; ++i, data += width) {
+                        const std::size_t offset = (s * k + i) * codec_type::payload_bytes() + column_begin(n);
+                        if (offset < file_size) {
+                            const std::size_t count = std::min(width, file_size - offset);
+                            std::copy(data, data + count, reinterpret_cast<char*>(&out[offset]));
+                        }
+                    }
+                }
+            }
+
+            stats.pool.dropped = total - seen;
+            complete = (stripes_failed == 0);
+        }
+        gather.stop();
+
+        return complete;
+    }
+
+    // Node owning the reads of strand id
+    std::size_t owner(std::uint32_t id) const {
+        std::uint64_t x = id + 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return static_cast<std::size_t>(x % mesh_.nodes());
+    }
+
+    // Payload byte columns [column_begin(n), column_end(n)) owned by node n
+    std::size_t column_begin(std::size_t n) const { return codec_type::payload_bytes() * n / mesh_.nodes(); }
+    std::size_t column_end(std::size_t n) const { return codec_type::payload_bytes() * (n + 1) / mesh_.nodes(); }
+
+private:
+    enum class strand_state : std::uint8_t {
+        ok,
+        corrected,
+        failed
+    };
+
+    // Times a stage into stats.stages from construction to stop()
+    class stage_timer {
+    public:
+        stage_timer(distributed_stats& stats, const char* name, std::size_t items)
+        : stats_(stats),
+          index_(stats.stages.size()),
+          start_(std::chrono::steady_clock::now()) {
+            stats_.stages.emplace_back();
+            stats_.stages.back().name = name;
+            stats_.stages.back().items = items;
+        }
+
+        pool_stage_stats& stage() { return stats_.stages[index_]; }
+
+        void stop() {
+            stage().seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+
+    private:
+        distributed_stats& stats_;
+        std::size_t index_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Whether the inner codec decodes several reads of a strand by consensus
+    template <typename S, typename = void>
+    struct has_consensus : std::false_type {};
+
+    template <typename S>
+    struct has_consensus<S, std::void_t<decltype(std::declval<const S&>().decode_strand(
+        std::declval<const std::string_view*>(), std::size_t(), std::declval<char*>()))>> : std::true_type {};
+
+    // Below this many reads a consensus has no majority to call
+    static constexpr std::size_t min_consensus_reads = 3;
+
+    strand_state decode_strand(const std::vector<std::string_view>& reads, std::uint8_t* payload) const {
+        char bases[InnerStorage::strand_data_length()];
+        const InnerStorage& inner = codec_.pool().inner();
+
+        if constexpr (has_consensus<InnerStorage>::value) {
+            if (reads.size() >= min_consensus_reads) {
+                const auto result = inner.decode_strand(reads.data(), reads.size(), bases);
+                if (result && schifra::utils::dna::pack_bases(bases, codec_type::pool_type::payload_bases(), payload)) {
+                    return (result.errors_corrected > 0) ? strand_state::corrected : strand_state::ok;
+                }
+            }
+        }
+
+        for (const std::string_view read : reads) {
+            const auto result = inner.decode_strand(read, bases);
+            if (result && schifra::utils::dna::pack_bases(bases, codec_type::pool_type::payload_bases(), payload)) {
+                return (result.errors_corrected > 0) ? strand_state::corrected : strand_state::ok;
+            }
+        }
+        return strand_state::failed;
+    }
+
+    void exchange(const std::vector<std::string>& outgoing, std::vector<std::string>& incoming, stage_timer& timer) const {
+        if (!mesh_.exchange(outgoing, incoming)) {
+            throw std::runtime_error("Exchange between pool decode nodes failed");
+        }
+        for (std::size_t n = 0; n < outgoing.size(); ++n) {
+            if (n != mesh_.rank()) {
+                timer.stage().bytes_sent += outgoing[n].size();
+                timer.stage().bytes_received += incoming[n].size();
+            }
+        }
+    }
+
+    static void put_u32(std::string& out, std::uint32_t value) {
+        for (std::size_t i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static void put_u64(std::string& out, std::uint64_t value) {
+        for (std::size_t i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static std::uint32_t get_u32(const char* in) {
+        std::uint32_t value = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    static std::uint64_t get_u64(const char* in) {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    const codec_type& codec_;
+    Mesh& mesh_;
+    schifra::galois::field_registry::field_ptr field_;
+    std::unique_ptr<const schifra::reed_solomon::cauchy_erasure_codec> outer_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_POOL_DISTRIBUTED_HPP
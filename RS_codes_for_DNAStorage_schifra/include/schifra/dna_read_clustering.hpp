@@ -0,0 +1,548 @@
+#ifndef SCHIFRA_DNA_READ_CLUSTERING_HPP
+#define SCHIFRA_DNA_READ_CLUSTERING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+
+namespace schifra {
+
+// Parameters of read_clusterer
+//   kmer_length       : bases per k-mer, 1 to 31. Long enough that the
+//                       minimum k-mers of unrelated reads rarely meet
+//                       (4^k well above the number of reads) and short
+//                       enough that most survive a few errors.
+//   bands, rows       : LSH banding, bands keys per read of rows minhashes
+//                       each. Reads of k-mer Jaccard similarity J share a
+//                       band with probability 1 - (1 - J^rows)^bands, eg:
+//                       0.9 for two reads of a 120 base strand at 6% errors
+//                       with the defaults.
+//   max_edit_fraction : reads sharing a band are only merged within this
+//                       edit distance, relative to the longer read
+//   threads           : 0 uses every hardware thread
+struct read_cluster_params {
+    std::size_t kmer_length = 16;
+    std::size_t bands = 32;
+    std::size_t rows = 1;
+    double max_edit_fraction = 0.25;
+    std::size_t threads = 0;
+    std::uint64_t seed = 0x9E3779B97F4A7C15ULL;
+};
+
+// Groups of reads in CSR form: group g holds the read indices
+// members[offsets[g]] .. members[offsets[g + 1] - 1], in increasing order.
+// Groups are numbered by their first read.
+struct read_groups {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> members;
+
+    std::size_t groups() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::size_t size(std::size_t g) const { return offsets[g + 1] - offsets[g]; }
+
+    const std::uint32_t* begin(std::size_t g) const { return members.data() + offsets[g]; }
+    const std::uint32_t* end(std::size_t g) const { return members.data() + offsets[g + 1]; }
+
+    // The reads of group g, eg: for the multi-read try_decode() or
+    // decode_strand() of dna_storage. out is reused across calls.
+    void gather(std::size_t g, const std::string_view* reads, std::vector<std::string_view>& out) const {
+        out.clear();
+        for (const std::uint32_t* r = begin(g); r != end(g); ++r) {
+            out.push_back(reads[*r]);
+        }
+    }
+};
+
+// Outcome of cluster()
+//   candidate_pairs : band collisions between reads not yet in one group
+//   merged          : candidates within the edit distance, joined
+//   rejected        : candidates beyond it (LSH false positives)
+//   singletons      : groups of one read
+struct cluster_stats {
+    std::size_t reads = 0;
+    std::size_t candidate_pairs = 0;
+    std::size_t merged = 0;
+    std::size_t rejected = 0;
+    std::size_t groups = 0;
+    std::size_t singletons = 0;
+};
+
+/**
+ * @class read_clusterer
+ * @brief Groups the unordered reads of a pool by originating strand, ahead
+ * of consensus and Reed-Solomon decoding.
+ *
+ * Each read is reduced to bands() band keys, a band key hashing the rows()
+ * minhashes of the read's k-mers under that band's hash functions, so
+ * reads of one strand, which share most k-mers, are likely to agree on at
+ * least one key and unrelated reads unlikely to agree on any. Bands are
+ * processed one at a time: the keys of every read are computed, radix
+ * partitioned on their top byte and sorted, in parallel, and each read of
+ * a run of equal keys is compared, by edit distance, against the first few
+ * distinct reads of the run. Pairs within max_edit_fraction are joined in a
+ * union-find forest; a pair already joined is not compared again, so once
+ * the early bands have found a strand's reads the later ones cost little
+ * more than hashing.
+ *
+ * Nothing but the reads is compared all-pairs, and no signature is kept:
+ * memory is 16 bytes per read for the keys of the current band plus 4 for
+ * the forest, however many bands are used. Reads are referenced by index,
+ * at most 2^32 - 1 of them.
+ */
+class read_clusterer {
+public:
+    explicit read_clusterer(const read_cluster_params& params = read_cluster_params())
+    : params_(params) {
+        if ((params_.kmer_length == 0) || (params_.kmer_length > 31)) {
+            throw std::invalid_argument("K-mer length must be 1 to 31 bases");
+        }
+        if ((params_.bands == 0) || (params_.rows == 0) || (params_.rows > max_rows)) {
+            throw std::invalid_argument("Bands need 1 to " + std::to_string(max_rows) + " rows, and there must be at least one");
+        }
+        if (params_.threads == 0) {
+            const std::size_t hardware_threads = std::thread::hardware_concurrency();
+            params_.threads = (hardware_threads > 0) ? hardware_threads : 1;
+        }
+    }
+
+    const read_cluster_params& params() const { return params_; }
+
+    // Cluster count reads. Reads with no k-mer of valid bases (eg: shorter
+    // than kmer_length) are groups of their own.
+    read_groups cluster(const std::string_view* reads, std::size_t count, cluster_stats* stats = nullptr) const {
+        if (count >= std::numeric_limits<std::uint32_t>::max()) {
+            throw std::invalid_argument("At most 2^32 - 1 reads can be clustered at once");
+        }
+
+        cluster_stats counted;
+        counted.reads = count;
+
+        std::vector<std::uint32_t> parent(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            parent[i] = static_cast<std::uint32_t>(i);
+        }
+
+        std::vector<std::uint64_t> keys(count);
+        std::vector<std::uint64_t> sorted(count);
+        std::vector<std::size_t> bucket_offsets(buckets + 1);
+
+        for (std::size_t band = 0; band < params_.bands; ++band) {
+            parallel_for(count, min_reads_per_thread, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    keys[i] = (static_cast<std::uint64_t>(band_key(reads[i], band)) << 32) | i;
+                }
+            });
+
+            partition(keys, sorted, bucket_offsets);
+
+            // Sort each bucket and compare the runs of equal keys against
+            // the forest as it stood at the start of the band
+            std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> accepted(buckets);
+            std::vector<cluster_stats> bucket_counts(buckets);
+
+            parallel_for(buckets, 1, [&](std::size_t first, std::size_t last) {
+                for (std::size_t b = first; b < last; ++b) {
+                    std::uint64_t* begin = sorted.data() + bucket_offsets[b];
+                    std::uint64_t* end = sorted.data() + bucket_offsets[b + 1];
+                    std::sort(begin, end);
+                    compare_runs(reads, parent, begin, end, accepted[b], bucket_counts[b]);
+                }
+            });
+
+            for (std::size_t b = 0; b < buckets; ++b) {
+                counted.candidate_pairs += bucket_counts[b].candidate_pairs;
+                counted.rejected += bucket_counts[b].rejected;
+                for (const auto& pair : accepted[b]) {
+                    if (unite(parent, pair.first, pair.second)) {
+                        ++counted.merged;
+                    }
+                }
+            }
+        }
+
+        keys = std::vector<std::uint64_t>();
+        sorted = std::vector<std::uint64_t>();
+
+        read_groups groups = make_groups(parent);
+
+        counted.groups = groups.groups();
+        for (std::size_t g = 0; g < groups.groups(); ++g) {
+            counted.singletons += (groups.size(g) == 1) ? 1 : 0;
+        }
+        if (stats) {
+            *stats = counted;
+        }
+
+        return groups;
+    }
+
+    // cluster() of a vector of reads
+    template <typename String>
+    read_groups cluster(const std::vector<String>& reads, cluster_stats* stats = nullptr) const {
+        std::vector<std::string_view> views(reads.begin(), reads.end());
+        return cluster(views.data(), views.size(), stats);
+    }
+
+    // Whether the edit distance of a and b is at most max_edits. Myers'
+    // bit-vector algorithm, in blocks of 64 rows (Hyyro), advances a whole
+    // column of the DP per few word operations and stops as soon as the
+    // columns left cannot bring the distance back under max_edits. Bases
+    // other than ACGTacgt match nothing.
+    static bool within_edit_distance(std::string_view a, std::string_view b, std::size_t max_edits) {
+        if (a.size() > b.size()) {
+            std::swap(a, b);
+        }
+        if (b.size() - a.size() > max_edits) {
+            return false;
+        }
+        if (a.empty()) {
+            return true;
+        }
+
+        // a down the rows, b along the columns
+        const std::size_t blocks = (a.size() + 63) / 64;
+        constexpr std::size_t stack_blocks = 8;
+        std::uint64_t stack_words[6 * stack_blocks];
+        std::vector<std::uint64_t> heap_words;
+        std::uint64_t* words = stack_words;
+        if (blocks > stack_blocks) {
+            heap_words.resize(6 * blocks);
+            words = heap_words.data();
+        }
+
+        // peq[s * blocks + k]: rows of block k holding base s
+        std::uint64_t* peq = words;
+        std::uint64_t* pv = words + 4 * blocks;
+        std::uint64_t* mv = words + 5 * blocks;
+
+        std::fill(peq, peq + 4 * blocks, std::uint64_t(0));
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const std::uint8_t s = schifra::utils::dna::base_to_symbol(a[i]);
+            if (s != schifra::utils::dna::invalid_base) {
+                peq[s * blocks + (i >> 6)] |= std::uint64_t(1) << (i & 63);
+            }
+        }
+        std::fill(pv, pv + blocks, ~std::uint64_t(0));
+        std::fill(mv, mv + blocks, std::uint64_t(0));
+
+        // D[a.size()][j], followed through the bit of the last row
+        const std::uint64_t last_row = std::uint64_t(1) << ((a.size() - 1) & 63);
+        std::size_t score = a.size();
+
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            const std::uint8_t s = schifra::utils::dna::base_to_symbol(b[j]);
+            int hin = 1;
+
+            for (std::size_t k = 0; k < blocks; ++k) {
+                std::uint64_t eq = (s != schifra::utils::dna::invalid_base) ? peq[s * blocks + k] : 0;
+                const std::uint64_t negative = (hin < 0) ? 1 : 0;
+                const std::uint64_t xv = eq | mv[k];
+                eq |= negative;
+                const std::uint64_t xh = (((eq & pv[k]) + pv[k]) ^ pv[k]) | eq;
+                std::uint64_t ph = mv[k] | ~(xh | pv[k]);
+                std::uint64_t mh = pv[k] & xh;
+
+                const std::uint64_t out_bit = (k + 1 < blocks) ? (std::uint64_t(1) << 63) : last_row;
+                const int hout = ((ph & out_bit) ? 1 : 0) - ((mh & out_bit) ? 1 : 0);
+
+                ph = (ph << 1) | ((hin > 0) ? 1 : 0);
+                mh = (mh << 1) | negative;
+                pv[k] = mh | ~(xv | ph);
+                mv[k] = ph & xv;
+                hin = hout;
+            }
+
+            score = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(score) + hin);
+
+            // Each of the columns left lowers the distance by at most one
+            if (score > max_edits + (b.size() - j - 1)) {
+                return false;
+            }
+        }
+
+        return score <= max_edits;
+    }
+
+private:
+    // Radix buckets, on the top byte of the band key
+    static constexpr std::size_t buckets = 256;
+
+    // Below this many reads per thread a thread costs more than it saves
+    static constexpr std::size_t min_reads_per_thread = 4096;
+
+    // Minhashes per band
+    static constexpr std::size_t max_rows = 16;
+
+    // Distinct reads of a run of equal keys compared against
+    static constexpr std::size_t max_representatives = 4;
+
+    // Band key of a read with no k-mer, never compared
+    static constexpr std::uint32_t no_key = 0;
+
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Hash of the rows minhashes of band band of a read, never no_key
+    std::uint32_t band_key(std::string_view read, std::size_t band) const {
+        std::uint64_t minima[max_rows];
+        std::uint64_t salts[max_rows];
+
+        const std::size_t rows = params_.rows;
+        for (std::size_t r = 0; r < rows; ++r) {
+            minima[r] = std::numeric_limits<std::uint64_t>::max();
+            salts[r] = mix(params_.seed + band * params_.rows + r + 1);
+        }
+
+        const std::size_t k = params_.kmer_length;
+        const std::uint64_t kmer_mask = (std::uint64_t(1) << (2 * k)) - 1;
+        std::uint64_t kmer = 0;
+        std::size_t valid = 0;
+        bool any = false;
+
+        for (char base : read) {
+            const std::uint8_t s = schifra::utils::dna::base_to_symbol(base);
+            if (s == schifra::utils::dna::invalid_base) {
+                valid = 0;
+                continue;
+            }
+            kmer = ((kmer << 2) | s) & kmer_mask;
+            if (++valid < k) {
+                continue;
+            }
+
+            // One full mix per k-mer, then a multiply per row
+            const std::uint64_t h = mix(kmer ^ params_.seed);
+            for (std::size_t r = 0; r < rows; ++r) {
+                minima[r] = std::min<std::uint64_t>(minima[r], (h ^ salts[r]) * 0xD6E8FEB86659FD93ULL);
+            }
+            any = true;
+        }
+
+        if (!any) {
+            return no_key;
+        }
+
+        std::uint64_t key = mix(band + params_.seed);
+        for (std::size_t r = 0; r < rows; ++r) {
+            key = mix(key ^ minima[r]);
+        }
+
+        const std::uint32_t folded = static_cast<std::uint32_t>(key >> 32);
+        return (folded == no_key) ? no_key + 1 : folded;
+    }
+
+    // Stable partition of keys into sorted by their top byte, bucket b
+    // ending up at [offsets[b], offsets[b + 1])
+    void partition(const std::vector<std::uint64_t>& keys, std::vector<std::uint64_t>& sorted,
+                   std::vector<std::size_t>& offsets) const {
+        const std::size_t count = keys.size();
+        const std::size_t threads = std::min(params_.threads, std::max<std::size_t>(1, count / min_reads_per_thread));
+        std::vector<std::size_t> histogram(threads * buckets, 0);
+
+        parallel_chunks(count, threads, [&](std::size_t t, std::size_t first, std::size_t last) {
+            std::size_t* h = &histogram[t * buckets];
+            for (std::size_t i = first; i < last; ++i) {
+                ++h[keys[i] >> 56];
+            }
+        });
+
+        std::size_t total = 0;
+        for (std::size_t b = 0; b < buckets; ++b) {
+            offsets[b] = total;
+            for (std::size_t t = 0; t < threads; ++t) {
+                const std::size_t n = histogram[t * buckets + b];
+                histogram[t * buckets + b] = total;
+                total += n;
+            }
+        }
+        offsets[buckets] = total;
+
+        parallel_chunks(count, threads, [&](std::size_t t, std::size_t first, std::size_t last) {
+            std::size_t* position = &histogram[t * buckets];
+            for (std::size_t i = first; i < last; ++i) {
+                sorted[position[keys[i] >> 56]++] = keys[i];
+            }
+        });
+    }
+
+    // Root of read i, read only so that threads can share the forest
+    static std::uint32_t find(const std::vector<std::uint32_t>& parent, std::uint32_t i) {
+        while (parent[i] != i) {
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Join the trees of a and b, false when already one
+    static bool unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) {
+        a = compress(parent, a);
+        b = compress(parent, b);
+        if (a == b) {
+            return false;
+        }
+        // The lower index becomes the root, keeping the forest deterministic
+        if (a < b) {
+            parent[b] = a;
+        } else {
+            parent[a] = b;
+        }
+        return true;
+    }
+
+    static std::uint32_t compress(std::vector<std::uint32_t>& parent, std::uint32_t i) {
+        const std::uint32_t root = find(parent, i);
+        while (parent[i] != root) {
+            const std::uint32_t up = parent[i];
+            parent[i] = root;
+            i = up;
+        }
+        return root;
+    }
+
+    // Compare each read of a run of equal keys in [begin, end) with the
+    // representatives of the run, reads that matched none before it (at
+    // most max_representatives), skipping those the forest already joins
+    // it to. A run mixing strands, eg: two sharing a minimum k-mer by
+    // chance, then still joins the reads of each.
+    void compare_runs(const std::string_view* reads, const std::vector<std::uint32_t>& parent,
+                      const std::uint64_t* begin, const std::uint64_t* end,
+                      std::vector<std::pair<std::uint32_t, std::uint32_t>>& accepted, cluster_stats& counted) const {
+        std::uint32_t representatives[max_representatives];
+        std::size_t representative_count = 0;
+        std::uint64_t run_key = ~std::uint64_t(0);
+
+        for (const std::uint64_t* p = begin; p != end; ++p) {
+            const std::uint64_t key = *p >> 32;
+            if (key == no_key) {
+                continue;
+            }
+
+            const std::uint32_t b = static_cast<std::uint32_t>(*p);
+            if (key != run_key) {
+                run_key = key;
+                representatives[0] = b;
+                representative_count = 1;
+                continue;
+            }
+
+            const std::uint32_t b_root = find(parent, b);
+            bool matched = false;
+
+            for (std::size_t r = 0; (r < representative_count) && !matched; ++r) {
+                const std::uint32_t a = representatives[r];
+                if (find(parent, a) == b_root) {
+                    matched = true;
+                    break;
+                }
+
+                ++counted.candidate_pairs;
+                const std::size_t longer = std::max(reads[a].size(), reads[b].size());
+                const std::size_t max_edits = static_cast<std::size_t>(params_.max_edit_fraction * static_cast<double>(longer));
+
+                if (within_edit_distance(reads[a], reads[b], max_edits)) {
+                    accepted.emplace_back(a, b);
+                    matched = true;
+                } else {
+                    ++counted.rejected;
+                }
+            }
+
+            if (!matched && (representative_count < max_representatives)) {
+                representatives[representative_count++] = b;
+            }
+        }
+    }
+
+    // Number the trees of the forest by their root, the lowest read of each
+    static read_groups make_groups(std::vector<std::uint32_t>& parent) {
+        const std::size_t count = parent.size();
+        read_groups groups;
+
+        // parent[i] becomes the group of read i, roots being numbered in
+        // index order before any of their reads is seen
+        std::vector<std::uint32_t> group(count);
+        std::uint32_t groups_found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint32_t root = compress(parent, static_cast<std::uint32_t>(i));
+            group[i] = (root == i) ? groups_found++ : group[root];
+        }
+
+        groups.offsets.assign(groups_found + 1, 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            ++groups.offsets[group[i] + 1];
+        }
+        for (std::size_t g = 0; g < groups_found; ++g) {
+            groups.offsets[g + 1] += groups.offsets[g];
+        }
+
+        groups.members.resize(count);
+        std::vector<std::uint32_t> position(groups.offsets.begin(), groups.offsets.end() - 1);
+        for (std::size_t i = 0; i < count; ++i) {
+            groups.members[position[group[i]]++] = static_cast<std::uint32_t>(i);
+        }
+
+        return groups;
+    }
+
+    // body(first, last) over [0, count) split across the threads, with at
+    // least min_per_thread items each
+    template <typename Body>
+    void parallel_for(std::size_t count, std::size_t min_per_thread, Body body) const {
+        const std::size_t threads = std::min(params_.threads, std::max<std::size_t>(1, count / min_per_thread));
+        parallel_chunks(count, threads, [&](std::size_t, std::size_t first, std::size_t last) {
+            body(first, last);
+        });
+    }
+
+    // body(t, first, last) for thread t of threads over [0, count)
+    template <typename Body>
+    static void parallel_chunks(std::size_t count, std::size_t threads, Body body) {
+        if (threads <= 1) {
+            body(std::size_t(0), std::size_t(0), count);
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                try {
+                    body(t, count * t / threads, count * (t + 1) / threads);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    read_cluster_params params_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_READ_CLUSTERING_HPP
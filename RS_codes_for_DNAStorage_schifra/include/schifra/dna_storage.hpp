@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
 #include <stdexcept>
@@ -11,20 +12,47 @@
 #include <iomanip>
 #include <sstream>
 #include <memory>
-#include <unordered_map>
 #include <functional>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 // Schifra library includes
 #include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
 #include "schifra/core/galois_field/polynomial.hpp"
-#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_fixed_encoder.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_execution.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_bitio.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_parity_cache.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_gf16_batch.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_bitsliced.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_table_decoder.hpp"
+#include "schifra/utils/schifra_crc.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+#include "schifra/utils/schifra_dna_consensus.hpp"
+#include "schifra/utils/schifra_dna_rotation.hpp"
+#include "schifra/utils/schifra_memory_accounting.hpp"
+#include "schifra/utils/schifra_sequence_reader.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/utils/schifra_ring_queue.hpp"
+#include "schifra/utils/schifra_span.hpp"
 
 namespace schifra {
 
@@ -35,17 +63,6 @@ namespace galois {
     typedef int field_symbol;
 }
 
-namespace reed_solomon {
-    template <std::size_t code_length, std::size_t fec_length, std::size_t data_length>
-    class encoder;
-    
-    template <std::size_t code_length, std::size_t fec_length, std::size_t data_length>
-    class decoder;
-    
-    template <std::size_t code_length, std::size_t fec_length, std::size_t data_length>
-    struct block;
-}
-
 /**
  * @class dna_storage
  * @brief A class for encoding and decoding data into DNA sequences using Reed-Solomon codes.
@@ -53,6 +70,14 @@ namespace reed_solomon {
  * @tparam CodeLength Total length of the Reed-Solomon code (n).
  * @tparam FecLength Length of the error correction code (n - k).
  * @tparam DataLength Length of the data portion (k).
+ *
+ * Every codec operation is const and reentrant: the field, generator and
+ * codec tables are built once by the constructor and only read afterwards,
+ * scratch space is per call (or per thread inside the decoder), and the
+ * decode counters are atomic. One instance can therefore serve any number
+ * of threads at once, only construction, assignment, reset_counters(),
+ * set_parity_cache(), set_verify_corrections() and
+ * set_constrained_mapping() need exclusive access.
  */
 template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength = CodeLength - FecLength>
 class dna_storage {
@@ -62,6 +87,13 @@ class dna_storage {
     
 public:
     // Statistics structure for file operations
+    //
+    // Stage times are summed over every block (CPU time), processing_time is
+    // the wall time of the whole operation. Blocks decoded through
+    // decode(span, process_stats&) also land in the errors per block
+    // histogram and the per position heatmap, which show whether sequencing
+    // errors cluster at some positions of the codeword (eg: the ends of a
+    // read) and the interleaving should change to spread them.
     struct process_stats {
         std::size_t total_chunks = 0;
         std::size_t processed_chunks = 0;
@@ -70,257 +102,3095 @@ public:
         std::size_t input_size = 0;
         std::size_t output_size = 0;
         std::string status = "not_started";
-        
+
+        // Per stage times, in seconds
+        double parse_time = 0.0;
+        double codec_time = 0.0;
+        double write_time = 0.0;
+
+        // errors_per_block[k]: blocks with k symbols corrected
+        std::array<std::size_t, FecLength + 1> errors_per_block{};
+        std::size_t uncorrectable_blocks = 0;
+
+        // error_positions[i]: corrections made at codeword position i
+        std::array<std::size_t, CodeLength> error_positions{};
+
+        // Peak resident set size of the process, in bytes (0 if unknown)
+        std::size_t peak_memory = 0;
+
+        // Bytes held by each component of the library (field and decoder
+        // tables, codecs, pools, arenas, pipeline queues), now and at peak,
+        // see schifra_memory_accounting.hpp
+        schifra::utils::memory::snapshot library_memory;
+
+        // Account for a decoded block given the codeword as received and as
+        // corrected, both CodeLength symbols
+        void record_block(const std::uint8_t* received, const std::uint8_t* corrected) {
+            std::size_t errors = 0;
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                if (received[i] != corrected[i]) {
+                    ++error_positions[i];
+                    ++errors;
+                }
+            }
+            ++errors_per_block[std::min(errors, FecLength)];
+            errors_corrected += errors;
+            ++processed_chunks;
+        }
+
+        void record_uncorrectable() {
+            ++uncorrectable_blocks;
+            ++processed_chunks;
+        }
+
+        // Sample the process' peak memory, keeping the largest value seen
+        void update_peak_memory() {
+            peak_memory = std::max(peak_memory, peak_resident_memory());
+            library_memory.merge(schifra::utils::memory::totals());
+        }
+
+        // Combine the stats of another thread (or file). Counts and stage
+        // times add up; the threads ran concurrently, so wall time and peak
+        // memory are the larger of the two.
+        void merge(const process_stats& other) {
+            total_chunks += other.total_chunks;
+            processed_chunks += other.processed_chunks;
+            errors_corrected += other.errors_corrected;
+            processing_time = std::max(processing_time, other.processing_time);
+            input_size += other.input_size;
+            output_size += other.output_size;
+            parse_time += other.parse_time;
+            codec_time += other.codec_time;
+            write_time += other.write_time;
+            for (std::size_t k = 0; k < errors_per_block.size(); ++k) {
+                errors_per_block[k] += other.errors_per_block[k];
+            }
+            uncorrectable_blocks += other.uncorrectable_blocks;
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                error_positions[i] += other.error_positions[i];
+            }
+            peak_memory = std::max(peak_memory, other.peak_memory);
+            library_memory.merge(other.library_memory);
+            if (status == "not_started") {
+                status = other.status;
+            }
+        }
+
+        // Wall time if known, otherwise the sum of the stage times
+        double elapsed() const {
+            return (processing_time > 0.0) ? processing_time : (parse_time + codec_time + write_time);
+        }
+
+        double bytes_per_second() const {
+            return (elapsed() > 0.0) ? input_size / elapsed() : 0.0;
+        }
+
+        double blocks_per_second() const {
+            return (elapsed() > 0.0) ? processed_chunks / elapsed() : 0.0;
+        }
+
         std::string to_string() const {
             std::ostringstream ss;
             ss << "Process Statistics:\n"
                << "  Status: " << status << "\n"
                << "  Total chunks: " << total_chunks << "\n"
+               << "  Processed chunks: " << processed_chunks << "\n"
                << "  Errors corrected: " << errors_corrected << "\n"
                << "  Processing time: " << std::fixed << std::setprecision(2) 
                << processing_time << " seconds\n"
-               << "  Processing speed: " 
-               << (input_size / (1024.0 * 1024.0 * (processing_time > 0 ? processing_time : 1))) 
-               << " MB/s";
+               << "  Stage times: parse " << std::setprecision(4) << parse_time
+               << " s, codec " << codec_time
+               << " s, write " << write_time << " s\n"
+               << "  Processing speed: " << std::setprecision(2)
+               << (bytes_per_second() / (1024.0 * 1024.0)) << " MB/s, "
+               << blocks_per_second() << " blocks/s\n"
+               << "  Errors per block:";
+            for (std::size_t k = 0; k < errors_per_block.size(); ++k) {
+                ss << " " << k << ":" << errors_per_block[k];
+            }
+            ss << " uncorrectable:" << uncorrectable_blocks << "\n"
+               << "  Error positions:";
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                ss << " " << error_positions[i];
+            }
+            ss << "\n"
+               << "  Peak memory: " << (peak_memory / (1024.0 * 1024.0)) << " MB\n"
+               << "  Library memory: " << (library_memory.total.current / (1024.0 * 1024.0)) << " MB, peak "
+               << (library_memory.total.peak / (1024.0 * 1024.0)) << " MB (";
+            for (std::size_t i = 0; i < schifra::utils::memory::e_component_count; ++i) {
+                ss << (i ? ", " : "")
+                   << schifra::utils::memory::component_name(static_cast<schifra::utils::memory::component_t>(i)) << " "
+                   << (library_memory.components[i].peak / 1024.0) << " KB";
+            }
+            ss << ")";
             return ss.str();
         }
     };
 
+    // How the sequences given to decode_batch() were resolved
+    //   crc_passed     : data checksum matched, no syndromes computed
+    //   syndrome_clean : zero syndromes, returned as read
+    //   corrected      : went through the full decoder
+    //   duplicate      : identical to an earlier read, its result reused
+    //                    (decode_strands_unique())
+    //   zero_block     : all 'A' data and zero ECC, returned without
+    //                    taking a batch lane (decode_sequence()/decode_strands())
+    //   realigned      : reads off the strand length that decoded once an
+    //                    indel was placed (decode_ragged_reads())
+    //   resynchronized : uncorrectable reads recovered by resynchronize()
+    struct decode_counters {
+        std::size_t crc_passed = 0;
+        std::size_t syndrome_clean = 0;
+        std::size_t corrected = 0;
+        std::size_t duplicate = 0;
+        std::size_t zero_block = 0;
+        std::size_t realigned = 0;
+        std::size_t resynchronized = 0;
+    };
+
+    // How the blocks given to encode_sequence()/encode_strands() were encoded
+    //   zero_block : all 'A' data (eg: padding), given zero parity without
+    //                taking a batch lane
+    //   batched    : encoded by the batch kernels
+    struct encode_counters {
+        std::size_t zero_block = 0;
+        std::size_t batched = 0;
+    };
+
+    // Outcome of one block of encode_sequence()/decode_sequence()
+    //   ok            : encoded, or decoded with zero syndromes
+    //   corrected     : decoded after correcting errors
+    //   uncorrectable : too many errors, data returned as read
+    //   invalid       : a base was not one of ACGTacgt, block output is 'N's
+    enum class block_status : std::uint8_t {
+        ok,
+        corrected,
+        uncorrectable,
+        invalid
+    };
+
+    // Orientation an in-band strand was read in
+    //   forward : as encoded
+    //   reverse : reverse complemented, ie: read from the other DNA strand
+    //   unknown : neither orientation decoded, or both did with different data
+    enum class strand_orientation : std::uint8_t {
+        forward,
+        reverse,
+        unknown
+    };
+
+    // Caller owned output of encode_sequence()/decode_sequence(), meant to be
+    // reused across calls so that, once grown, no call allocates.
+    //   dna         : encode - the strands, CodeLength bases per block, back to back
+    //                 decode - the recovered sequence, padding removed
+    //   ecc         : encode - FecLength ECC symbols per block (input of decode)
+    //   status      : one entry per block
+    //   orientation : decode_strands_oriented() - one entry per block
+    //   copies      : decode_strands_unique() - per block, the number of
+    //                 reads with the same bases, itself included
+    struct sequence_buffer {
+        std::string dna;
+        std::vector<std::uint8_t> ecc;
+        std::vector<block_status> status;
+        std::vector<strand_orientation> orientation;
+        std::vector<std::uint32_t> copies;
+
+        std::size_t blocks() const { return status.size(); }
+
+        std::size_t count(block_status s) const {
+            return static_cast<std::size_t>(std::count(status.begin(), status.end(), s));
+        }
+
+    private:
+        friend class dna_storage;
+
+        // Planar batch scratch, see encode_batch()
+        std::vector<std::uint8_t> planar_;
+        std::vector<std::uint8_t> planar_out_;
+
+        // Block of each lane of an encode batch, see encode_sequence(), or
+        // the distinct reads of decode_strands_unique()
+        std::vector<std::uint32_t> lanes_;
+
+        // decode_strands_unique(): first read with the same bases, per
+        // read, and the hash table finding it (read + 1, 0 when empty)
+        std::vector<std::uint32_t> first_;
+        std::vector<std::uint32_t> index_;
+    };
+
+    // Reed-Solomon codec types for this code, the encoder compiled for
+    // the code when it is a fixed_code (RS(15,13) and RS(15,11))
+    typedef typename schifra::reed_solomon::select_encoder<CodeLength, FecLength>::type encoder_type;
+    typedef schifra::reed_solomon::decoder<CodeLength, FecLength> decoder_type;
+    typedef schifra::reed_solomon::block<CodeLength, FecLength>   block_type;
+    typedef schifra::reed_solomon::syndrome_table_decoder<CodeLength, FecLength> table_decoder_type;
+    typedef schifra::reed_solomon::gf16_batch_codec<CodeLength, FecLength> batch_codec_type;
+    typedef schifra::reed_solomon::parity_cache::statistics parity_cache_stats;
+
+    // Outcome of the noexcept try_encode()/try_decode()
+    //   ok             : done
+    //   invalid_base   : a base was not one of ACGTacgt, or a symbol not in [0,4)
+    //   invalid_length : wrong sequence, data or codeword length
+    //   codec_error    : the encoder or decoder failed, see error
+    enum class codec_status : std::uint8_t {
+        ok,
+        invalid_base,
+        invalid_length,
+        codec_error
+    };
+
+    // error is the block's error_t as left by the encoder/decoder (eg:
+    // e_decoder_error1 for too many errors), errors_corrected the symbols
+    // the decoder corrected, invalid_offset the offset of the first invalid
+    // base when status is invalid_base
+    struct codec_result {
+        codec_status status = codec_status::ok;
+        typename block_type::error_t error = block_type::e_no_error;
+        std::size_t errors_corrected = 0;
+        std::size_t invalid_offset = 0;
+
+        explicit operator bool() const noexcept { return status == codec_status::ok; }
+    };
+
+    // DNA sequence held at 2 bits per base
+    typedef schifra::utils::dna::packed_dna packed_dna;
+
+    // First consecutive root of the generator polynomial (alpha^1 .. alpha^FecLength)
+    static constexpr std::size_t generator_polynomial_index = 1;
+
+    // Blocks per batch kernel call in encode_sequence()/decode_sequence()
+    static constexpr std::size_t sequence_batch_lanes = 4096;
+
+    // Rotation key of set_constrained_mapping() unless given another seed
+    static constexpr std::uint32_t default_rotation_seed = 0x2F6B1D35;
+
+    // Strands run through each batch_engine by warm_up(), a full bitsliced pass
+    static constexpr std::size_t warm_up_batch = 256;
+
+    // Bitsliced engine, 256 codewords per pass, generated at compile time
+    // for the same field and generator polynomial.
+    typedef schifra::reed_solomon::bitsliced_codec<schifra::galois::gf16_static_field,
+                                                   CodeLength, FecLength,
+                                                   generator_polynomial_index,
+                                                   schifra::reed_solomon::bitslice256> bitsliced_codec_type;
+
+    // Engine used by encode_batch()/decode_batch()
+    //   simd      : table shuffles over planar bytes (gf16_batch_codec)
+    //   bitsliced : xor networks over bit planes (bitsliced_codec)
+    enum class batch_engine {
+        simd,
+        bitsliced
+    };
+
+    // Engine used by decode()
+    //   algebraic : Berlekamp-Massey, Chien search and Forney
+    //   table     : syndrome to correction lookup (FecLength <= 4), built
+    //               on the first decode
+    enum class decode_engine {
+        algebraic,
+        table
+    };
+
     // Constructor
-    dna_storage() {
+    //
+    // The field, generator polynomial, encoder and decoder are built exactly
+    // once here. encode()/decode() only use them through const references, so
+    // the per-block path performs no setup work.
+    explicit dna_storage(decode_engine engine = decode_engine::algebraic) {
         // Parameters for RS(15,11) over GF(2^4)
         const std::size_t field_descriptor = 4;
-        const std::size_t generator_polynomial_index = 0;
-        const std::size_t generator_polynomial_root_count = 4;
 
         // Instantiate Galois field for GF(2^4) with Schifra's primitive polynomial
-        field_ = std::make_unique<schifra::galois::field>(
+        // Fields are immutable, so every instance shares one table set.
+        field_ = schifra::galois::shared_field(
             field_descriptor,
             schifra::galois::primitive_polynomial_size01,
             schifra::galois::primitive_polynomial01);
 
-        // Create generator polynomial
-        generator_polynomial_ = std::make_unique<schifra::galois::field_polynomial>(*field_);
-        if (!schifra::make_sequential_root_generator_polynomial(
-                *field_,
-                generator_polynomial_index,
-                generator_polynomial_root_count,
-                *generator_polynomial_)) {
+        // Generator polynomial and its LFSR rows, shared by every instance
+        generator_ = schifra::reed_solomon::shared_generator(
+            *field_,
+            static_cast<unsigned int>(generator_polynomial_index),
+            FecLength);
+        if (!generator_) {
             throw std::runtime_error("Failed to create sequential root generator");
         }
+
+        encoder_ = std::make_unique<const encoder_type>(*field_, generator_);
+        decoder_ = std::make_unique<const decoder_type>(*field_, static_cast<unsigned int>(generator_polynomial_index));
+        batch_codec_ = std::make_unique<const batch_codec_type>(*field_, generator_->polynomial(), static_cast<unsigned int>(generator_polynomial_index));
+
+        if (engine == decode_engine::table) {
+            table_decoder_ = std::make_unique<const table_decoder_type>(*field_, static_cast<unsigned int>(generator_polynomial_index));
+            if (!table_decoder_->valid()) {
+                throw std::invalid_argument("Table decoding needs at most 4 ECC symbols");
+            }
+        }
     }
     
     ~dna_storage() = default;
     
-    // Disable copy and move
+    // Movable, eg: to be kept in containers, but not copyable. The codecs
+    // are heap allocated and keep their addresses, and a moved from
+    // instance may only be destroyed or assigned to.
     dna_storage(const dna_storage&) = delete;
     dna_storage& operator=(const dna_storage&) = delete;
-    dna_storage(dna_storage&&) = delete;
-    dna_storage& operator=(dna_storage&&) = delete;
+    dna_storage(dna_storage&&) noexcept = default;
+    dna_storage& operator=(dna_storage&&) noexcept = default;
 
     // Encode a DNA sequence with error correction
-    std::pair<std::string, std::vector<std::uint8_t>> encode(const std::string& dna_sequence) {
-        if (!validate_dna(dna_sequence)) {
-            throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters");
+    std::pair<std::string, std::vector<std::uint8_t>> encode(const std::string& dna_sequence) const {
+        std::pair<std::string, std::vector<std::uint8_t>> result(std::string(CodeLength, 'A'), std::vector<std::uint8_t>(FecLength));
+        const codec_result status = try_encode(dna_sequence, &result.first[0], result.second.data());
+        if (!status) {
+            throw_codec_error(status, DataLength, "encoding");
+        }
+        return result;
+    }
+    
+    // Decode a DNA sequence with error correction
+    std::string decode(const std::string& dna_sequence, const std::vector<std::uint8_t>& ecc_symbols) const {
+        if ((ecc_symbols.size() != FecLength) && validate_dna(dna_sequence) && (dna_sequence.length() == CodeLength)) {
+            throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(FecLength) + " symbols");
+        }
+        std::string decoded_dna(DataLength, 'A');
+        const codec_result status = try_decode(dna_sequence, ecc_symbols.data(), &decoded_dna[0]);
+        if (!status) {
+            throw_codec_error(status, CodeLength, "decoding");
+        }
+        return decoded_dna;
+    }
+
+    // Exception-free encode()
+    //
+    // Writes the CodeLength bases of the strand (the data as given, then
+    // the ECC symbols mod 4) to encoded and the FecLength ECC symbols to
+    // ecc. Nothing is allocated or thrown, so a failure costs no more than
+    // a success.
+    codec_result try_encode(std::string_view dna_sequence, char* encoded, std::uint8_t* ecc) const noexcept {
+        return encode_data(dna_sequence, DataLength, encoded, ecc);
+    }
+
+    // try_encode() of the partial last block of a sequence, 1 to DataLength
+    // bases, as a shortened codeword: the missing bases are taken as 'A's
+    // (zero symbols) without being stored, so encoded receives
+    // dna_sequence.size() + FecLength bases. The ECC is that of the block
+    // padded with 'A's.
+    codec_result try_encode_tail(std::string_view dna_sequence, char* encoded, std::uint8_t* ecc) const noexcept {
+        return encode_data(dna_sequence, dna_sequence.size(), encoded, ecc);
+    }
+
+    // Exception-free decode()
+    //
+    // dna_sequence is the CodeLength base strand, of which only the data
+    // portion is used, and ecc its FecLength ECC symbols. The DataLength
+    // corrected bases are written to decoded, or, when the block cannot be
+    // corrected, the bases as read.
+    codec_result try_decode(std::string_view dna_sequence, const std::uint8_t* ecc, char* decoded) const noexcept {
+        return decode_data(dna_sequence, DataLength, ecc, decoded);
+    }
+
+    // try_decode() of a strand of try_encode_tail(), whose data length is
+    // its own length less FecLength: that many bases are written to
+    // decoded, so the tail needs no padding removed.
+    codec_result try_decode_tail(std::string_view dna_sequence, const std::uint8_t* ecc, char* decoded) const noexcept {
+        const std::size_t length = (dna_sequence.size() > FecLength) ? dna_sequence.size() - FecLength : DataLength + 1;
+        return decode_data(dna_sequence, length, ecc, decoded);
+    }
+
+    // Throwing try_encode_tail()/try_decode_tail()
+    std::pair<std::string, std::vector<std::uint8_t>> encode_tail(const std::string& dna_sequence) const {
+        std::pair<std::string, std::vector<std::uint8_t>> result(std::string(dna_sequence.size() + FecLength, 'A'),
+                                                                 std::vector<std::uint8_t>(FecLength));
+        const codec_result status = try_encode_tail(dna_sequence, &result.first[0], result.second.data());
+        if (!status) {
+            throw_tail_error(status, "encoding");
+        }
+        return result;
+    }
+
+    std::string decode_tail(const std::string& dna_sequence, const std::vector<std::uint8_t>& ecc_symbols) const {
+        if (ecc_symbols.size() != FecLength) {
+            throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(FecLength) + " symbols");
+        }
+        std::string decoded_dna(std::min(dna_sequence.size() - std::min(dna_sequence.size(), FecLength), DataLength), 'A');
+        const codec_result status = try_decode_tail(dna_sequence, ecc_symbols.data(), &decoded_dna[0]);
+        if (!status) {
+            throw_tail_error(status, "decoding");
+        }
+        return decoded_dna;
+    }
+
+    // try_decode() of read_count reads of one strand
+    //
+    // The data bases are a per position vote of the reads (see
+    // schifra_dna_consensus.hpp), weighted by qualities[r][i] when
+    // qualities is given. Positions won by a margin below min_margin, ie:
+    // ties by default, are passed to the decoder as erasures, the least
+    // settled first and at most FecLength of them, so they cost one ECC
+    // symbol each instead of two as errors.
+    codec_result try_decode(const std::string_view* reads, std::size_t read_count, const std::uint8_t* ecc, char* decoded,
+                            const std::uint8_t* const* qualities = nullptr, std::uint16_t min_margin = 1) const noexcept {
+        codec_result result;
+        char bases[DataLength];
+        std::uint16_t margin[DataLength];
+        if (!read_consensus(reads, read_count, qualities, CodeLength, DataLength, bases, margin, result)) {
+            return result;
+        }
+
+        block_type block;
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(schifra::utils::dna::base_to_symbol(bases[i]));
+        }
+        for (std::size_t i = 0; i < FecLength; ++i) {
+            block.data[DataLength + i] = static_cast<schifra::galois::field_symbol>(ecc[i]);
         }
-        if (dna_sequence.length() != DataLength) {
+
+        return decode_consensus(block, margin, DataLength, min_margin, decoded, DataLength, 1);
+    }
+
+    // Packed counterparts of encode()/decode(): symbols are read straight out
+    // of the 2 bit packed bases and written back the same way, with no string
+    // or symbol vector in between. Results and errors match the string forms.
+    std::pair<packed_dna, std::vector<std::uint8_t>> encode(const packed_dna& dna_sequence) const {
+        if (dna_sequence.size() != DataLength) {
             throw std::invalid_argument("DNA sequence length must be exactly " + std::to_string(DataLength) + " characters");
         }
-        // Convert DNA to symbols (A=0, C=1, G=2, T=3)
-        std::vector<std::uint8_t> symbols = dna_to_symbols(dna_sequence);
-        // Create generator polynomial
-        schifra::galois::field_polynomial generator_poly(*field_);
-        if (!schifra::make_sequential_root_generator_polynomial(*field_, 1, FecLength, generator_poly)) {
-            throw std::runtime_error("Failed to create generator polynomial");
-        }
-        // Create encoder
-        typedef schifra::reed_solomon::encoder<15, 4> encoder_t;
-        schifra::reed_solomon::block<15, 4> block;
-        encoder_t rs_encoder(*field_, generator_poly);
-        // Copy data to block.data[0..DataLength-1]
+        block_type block;
         for (std::size_t i = 0; i < DataLength; ++i) {
-            block.data[i] = static_cast<schifra::galois::field_symbol>(symbols[i]);
+            block.data[i] = static_cast<schifra::galois::field_symbol>(dna_sequence.symbol(i));
         }
-        // Zero the ECC portion
         for (std::size_t i = DataLength; i < CodeLength; ++i) {
             block.data[i] = 0;
         }
-        // Encode the data
-        bool encode_ok = rs_encoder.encode(block);
-        if (!encode_ok) {
+        if (!encoder_->encode(block)) {
             throw std::runtime_error("Reed-Solomon encoding failed");
         }
-        
-        // Extract FEC symbols and convert to DNA bases
-        std::string encoded_dna = dna_sequence;  // Start with original sequence
-        std::vector<std::uint8_t> ecc_symbols(FecLength);
+
+        std::pair<packed_dna, std::vector<std::uint8_t>> result(dna_sequence, std::vector<std::uint8_t>(FecLength));
         for (std::size_t i = 0; i < FecLength; ++i) {
-            ecc_symbols[i] = static_cast<std::uint8_t>(block.data[DataLength + i]);
-            // Convert ECC symbol to DNA base (using modulo 4 to map to A,C,G,T)
-            std::uint8_t symbol = ecc_symbols[i] % 4;
-            auto it = symbol_to_dna_.find(symbol);
-            if (it != symbol_to_dna_.end()) {
-                encoded_dna += it->second;
-            } else {
-                throw std::runtime_error("Invalid symbol value in ECC: " + std::to_string(symbol));
-            }
+            result.second[i] = static_cast<std::uint8_t>(block.data[DataLength + i]);
+            result.first.push_back(static_cast<std::uint8_t>(result.second[i] % 4));
         }
-        
-        return {encoded_dna, ecc_symbols};
+        return result;
     }
-    
-    // Decode a DNA sequence with error correction
-    std::string decode(const std::string& dna_sequence, const std::vector<std::uint8_t>& ecc_symbols) {
-        if (!validate_dna(dna_sequence)) {
-            throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters");
-        }
-        if (dna_sequence.length() != CodeLength) {  // Now expecting full length including ECC
+
+    packed_dna decode(const packed_dna& dna_sequence, const std::vector<std::uint8_t>& ecc_symbols) const {
+        if (dna_sequence.size() != CodeLength) {
             throw std::invalid_argument("DNA sequence length must be exactly " + std::to_string(CodeLength) + " characters");
         }
         if (ecc_symbols.size() != FecLength) {
             throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(FecLength) + " symbols");
         }
-        
-        // Extract data portion (first DataLength characters)
-        std::string data_portion = dna_sequence.substr(0, DataLength);
-        std::vector<std::uint8_t> symbols = dna_to_symbols(data_portion);
-        
-        // Create generator polynomial
-        schifra::galois::field_polynomial generator_poly(*field_);
-        if (!schifra::make_sequential_root_generator_polynomial(*field_, 1, FecLength, generator_poly)) {
-            throw std::runtime_error("Failed to create generator polynomial");
-        }
-        
-        // Create decoder
-        schifra::reed_solomon::block<15, 4> block;
-        // Copy data to block.data[0..DataLength-1]
+        block_type block;
         for (std::size_t i = 0; i < DataLength; ++i) {
-            block.data[i] = static_cast<schifra::galois::field_symbol>(symbols[i]);
+            block.data[i] = static_cast<schifra::galois::field_symbol>(dna_sequence.symbol(i));
         }
-        // Copy FEC symbols to block.data[DataLength..CodeLength-1]
         for (std::size_t i = 0; i < FecLength; ++i) {
             block.data[DataLength + i] = static_cast<schifra::galois::field_symbol>(ecc_symbols[i]);
         }
-        
-        // Decode the data
-        schifra::reed_solomon::decoder<15, 4> rs_decoder(*field_, 1);
-        if (!rs_decoder.decode(block)) {
+        const bool decoded = table_decoder_ ? table_decoder_->decode(block) : decoder_->decode(block);
+        if (!decoded) {
             throw std::runtime_error("Reed-Solomon decoding failed");
         }
-        
-        // Convert symbols back to DNA (only the data portion)
-        std::string decoded_dna = symbols_to_dna(std::vector<std::uint8_t>(block.data, block.data + DataLength));
+
+        packed_dna decoded_dna(DataLength);
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            decoded_dna.set_symbol(i, static_cast<std::uint8_t>(block.data[i]));
+        }
         return decoded_dna;
     }
 
-    // Process a file (encode or decode)
-    process_stats process_file(
-        const std::string& input_path,
-        const std::string& output_path,
-        bool encode_mode,
-        std::function<void(double, const std::string&)> progress_callback = nullptr
-    );
+    // Encode straight from caller-owned memory
+    //
+    // data holds DataLength DNA symbols (A=0, C=1, G=2, T=3), eg: a region of
+    // an mmap'd file, and the FecLength ECC symbols are written into parity,
+    // exactly as encode() returns them. No block or string is built.
+    void encode(schifra::utils::span<const std::uint8_t> data, schifra::utils::span<std::uint8_t> parity) const {
+        if (data.size() != DataLength) {
+            throw std::invalid_argument("Data length must be exactly " + std::to_string(DataLength) + " symbols");
+        }
+        if (parity.size() != FecLength) {
+            throw std::invalid_argument("Parity length must be exactly " + std::to_string(FecLength) + " symbols");
+        }
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            if (data[i] > 3) {
+                throw std::invalid_argument("Invalid DNA symbol value: " + std::to_string(data[i]));
+            }
+        }
+        if (!encoder_->encode(data, parity)) {
+            throw std::runtime_error("Reed-Solomon encoding failed");
+        }
+    }
 
-    // Get the code parameters
-    static constexpr std::size_t code_length() { return CodeLength; }
-    static constexpr std::size_t fec_length() { return FecLength; }
-    static constexpr std::size_t data_length() { return DataLength; }
+    // Decode a caller-owned codeword in place
+    //
+    // codeword holds DataLength DNA symbols followed by the FecLength ECC
+    // symbols. Errors are corrected directly in the buffer.
+    void decode(schifra::utils::span<std::uint8_t> codeword) const {
+        if (codeword.size() != CodeLength) {
+            throw std::invalid_argument("Codeword length must be exactly " + std::to_string(CodeLength) + " symbols");
+        }
+        const bool decoded = table_decoder_ ? table_decoder_->decode(codeword) : decoder_->decode(codeword);
+        if (!decoded) {
+            throw std::runtime_error("Reed-Solomon decoding failed");
+        }
+    }
 
-private:
-    // Convert DNA string to symbol vector
-    std::vector<std::uint8_t> dna_to_symbols(const std::string& dna_sequence) const {
-        std::vector<std::uint8_t> symbols;
-        symbols.reserve(dna_sequence.size());
-        
-        for (char c : dna_sequence) {
-            char upper_c = std::toupper(static_cast<unsigned char>(c));
-            auto it = dna_to_symbol_.find(upper_c);
-            if (it != dna_to_symbol_.end()) {
-                symbols.push_back(it->second);
-            } else {
-                throw std::runtime_error("Invalid DNA character: " + std::string(1, c));
+    // Exception-free encode() of caller-owned memory
+    codec_result try_encode(schifra::utils::span<const std::uint8_t> data, schifra::utils::span<std::uint8_t> parity) const noexcept {
+        codec_result result;
+        if ((data.size() != DataLength) || (parity.size() != FecLength)) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            if (data[i] > 3) {
+                result.status = codec_status::invalid_base;
+                return result;
             }
         }
-        
-        return symbols;
+        if (!encoder_->encode(data, parity)) {
+            result.status = codec_status::codec_error;
+            result.error = block_type::e_encoder_error0;
+        }
+        return result;
     }
-    
-    std::string symbols_to_dna(const std::vector<std::uint8_t>& symbols) const {
-        std::string dna_sequence;
-        dna_sequence.reserve(symbols.size());
-        
-        for (uint8_t symbol : symbols) {
-            auto it = symbol_to_dna_.find(symbol);
-            if (it != symbol_to_dna_.end()) {
-                dna_sequence.push_back(it->second);
-            } else {
-                throw std::runtime_error("Invalid symbol value: " + std::to_string(symbol));
-            }
+
+    // Exception-free decode() of a caller-owned codeword, corrected in place
+    // when it can be and left untouched when it cannot
+    codec_result try_decode(schifra::utils::span<std::uint8_t> codeword) const noexcept {
+        codec_result result;
+        if (codeword.size() != CodeLength) {
+            result.status = codec_status::invalid_length;
+            return result;
         }
-        
-        return dna_sequence;
+
+        block_type block;
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(codeword[i]);
+        }
+        const bool decoded = table_decoder_ ? table_decoder_->decode(block) : decoder_->decode(block);
+        if (!decoded) {
+            result.status = codec_status::codec_error;
+            result.error = (block.error != block_type::e_no_error) ? block.error : block_type::e_decoder_error0;
+            return result;
+        }
+
+        result.errors_corrected = block.errors_corrected;
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            codeword[i] = static_cast<std::uint8_t>(block.data[i]);
+        }
+        return result;
     }
 
-    // Validate DNA string (only contains ACGTacgt)
-    bool validate_dna(const std::string& dna) const {
-        if (dna.empty()) {
-            return false;
+    // decode() recording the outcome in stats: codec time, the errors per
+    // block histogram and the positions corrected. Throws as decode() does,
+    // after counting the block as uncorrectable.
+    void decode(schifra::utils::span<std::uint8_t> codeword, process_stats& stats) const {
+        std::array<std::uint8_t, CodeLength> received;
+        if (codeword.size() == CodeLength) {
+            std::copy(codeword.begin(), codeword.end(), received.begin());
         }
-        
-        return std::all_of(dna.begin(), dna.end(), [](char c) {
-            return dna_to_symbol_.find(std::toupper(static_cast<unsigned char>(c))) != dna_to_symbol_.end();
-        });
+
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            decode(codeword);
+        } catch (...) {
+            stats.codec_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats.record_uncorrectable();
+            throw;
+        }
+        stats.codec_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        stats.record_block(received.data(), codeword.data());
+        stats.input_size += CodeLength;
+        stats.output_size += DataLength;
     }
-    
-    // Get current timestamp for logging
-    std::string get_timestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-        return ss.str();
+
+    // Encode many DNA sequences at once
+    //
+    // Equivalent to calling encode() on every sequence, but the parity of all
+    // sequences is computed together by the SIMD GF(2^4) batch kernels, or
+    // by the bitsliced engine.
+    std::vector<std::pair<std::string, std::vector<std::uint8_t>>> encode_batch(const std::vector<std::string>& dna_sequences,
+                                                                                batch_engine engine = batch_engine::simd) const {
+        std::vector<std::uint8_t> data(DataLength * dna_sequences.size());
+        std::vector<std::uint8_t> parity(FecLength * dna_sequences.size());
+        std::vector<std::pair<std::string, std::vector<std::uint8_t>>> result(dna_sequences.size());
+        encode_batch_into(dna_sequences, data, parity, result, engine);
+        return result;
     }
 
-    // Galois field for Reed-Solomon operations (GF(2^4))
-    std::unique_ptr<schifra::galois::field> field_;
-    std::unique_ptr<schifra::galois::field_polynomial> generator_polynomial_;
-    
-    // DNA to symbol mapping
-    static const std::unordered_map<char, std::uint8_t> dna_to_symbol_;
-    static const std::unordered_map<std::uint8_t, char> symbol_to_dna_;
-    
-    // Initialize DNA to symbol mapping
-    static std::unordered_map<char, std::uint8_t> init_dna_to_symbol() {
-        return {
-            {'A', 0}, {'a', 0},
-            {'C', 1}, {'c', 1},
-            {'G', 2}, {'g', 2},
-            {'T', 3}, {'t', 3}
-        };
+    // Decode many DNA sequences at once
+    //
+    // Syndromes of all sequences are computed together by the SIMD GF(2^4)
+    // batch kernels, or by the bitsliced engine. Error-free sequences, the common case, are returned
+    // directly; only sequences with a non-zero syndrome take the full decoder.
+    std::vector<std::string> decode_batch(const std::vector<std::string>& dna_sequences,
+                                          const std::vector<std::vector<std::uint8_t>>& ecc_symbols,
+                                          batch_engine engine = batch_engine::simd) const {
+        std::vector<std::uint8_t> codewords(CodeLength * dna_sequences.size());
+        std::vector<std::uint8_t> syndromes(FecLength * dna_sequences.size());
+        std::vector<std::string> result(dna_sequences.size());
+        decode_batch_into(dna_sequences, ecc_symbols, codewords, syndromes, result, engine);
+        return result;
     }
-    
-    // Initialize symbol to DNA mapping (uppercase only)
-    static std::unordered_map<std::uint8_t, char> init_symbol_to_dna() {
-        return {
-            {0, 'A'},
-            {1, 'C'},
-            {2, 'G'},
-            {3, 'T'}
-        };
+
+    // encode_batch()/decode_batch() of sequences held in a memory resource,
+    // eg: a schifra::utils::batch_arena reset between batches. The results,
+    // every strand, ECC set and decoded sequence in them, and the planar
+    // scratch are allocated from the resource of dna_sequences rather than
+    // the heap.
+    typedef std::pmr::vector<std::pair<std::pmr::string, std::pmr::vector<std::uint8_t>>> pmr_encoded_batch;
+
+    pmr_encoded_batch encode_batch(const std::pmr::vector<std::pmr::string>& dna_sequences,
+                                   batch_engine engine = batch_engine::simd) const {
+        std::pmr::memory_resource* resource = dna_sequences.get_allocator().resource();
+        std::pmr::vector<std::uint8_t> data(DataLength * dna_sequences.size(), resource);
+        std::pmr::vector<std::uint8_t> parity(FecLength * dna_sequences.size(), resource);
+        pmr_encoded_batch result(dna_sequences.size(), resource);
+        encode_batch_into(dna_sequences, data, parity, result, engine);
+        return result;
     }
-};
 
-// Initialize static members
-template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength>
-const std::unordered_map<char, std::uint8_t> 
-dna_storage<CodeLength, FecLength, DataLength>::dna_to_symbol_ = 
-    dna_storage<CodeLength, FecLength, DataLength>::init_dna_to_symbol();
+    std::pmr::vector<std::pmr::string> decode_batch(const std::pmr::vector<std::pmr::string>& dna_sequences,
+                                                    const std::pmr::vector<std::pmr::vector<std::uint8_t>>& ecc_symbols,
+                                                    batch_engine engine = batch_engine::simd) const {
+        std::pmr::memory_resource* resource = dna_sequences.get_allocator().resource();
+        std::pmr::vector<std::uint8_t> codewords(CodeLength * dna_sequences.size(), resource);
+        std::pmr::vector<std::uint8_t> syndromes(FecLength * dna_sequences.size(), resource);
+        std::pmr::vector<std::pmr::string> result(dna_sequences.size(), resource);
+        decode_batch_into(dna_sequences, ecc_symbols, codewords, syndromes, result, engine);
+        return result;
+    }
 
-template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength>
-const std::unordered_map<std::uint8_t, char> 
-dna_storage<CodeLength, FecLength, DataLength>::symbol_to_dna_ = 
-    dna_storage<CodeLength, FecLength, DataLength>::init_symbol_to_dna();
+    // CRC gated decode_batch()
+    //
+    // checksums[l] is data_checksum() of the data portion of sequence l as
+    // it was encoded, eg: stored in the pool's index alongside the ECC. A
+    // sequence whose data still matches it is returned without computing
+    // syndromes; only the rest go through decode_batch().
+    std::vector<std::string> decode_batch(const std::vector<std::string>& dna_sequences,
+                                          const std::vector<std::vector<std::uint8_t>>& ecc_symbols,
+                                          const std::vector<std::uint32_t>& checksums,
+                                          batch_engine engine = batch_engine::simd) const {
+        if ((dna_sequences.size() != ecc_symbols.size()) || (dna_sequences.size() != checksums.size())) {
+            throw std::invalid_argument("Number of DNA sequences, ECC symbol sets and checksums must match");
+        }
+
+        decode_counters counted;
+        std::vector<std::string> result(dna_sequences.size());
+        std::vector<std::size_t> pending;
+        std::vector<std::string> pending_sequences;
+        std::vector<std::vector<std::uint8_t>> pending_ecc;
+
+        for (std::size_t l = 0; l < dna_sequences.size(); ++l) {
+            // One pass validates the read and converts its data, which is
+            // then checksummed in its upper case form
+            const std::string& dna_sequence = dna_sequences[l];
+            std::uint8_t symbols[DataLength];
+            char bases[DataLength];
+            if ((dna_sequence.length() == CodeLength) && (convert_bases(dna_sequence, symbols) == CodeLength) &&
+                schifra::utils::dna::symbols_to_bases(symbols, DataLength, bases) &&
+                (checksum_bases(bases, DataLength) == checksums[l])) {
+                result[l].assign(bases, DataLength);
+                ++counted.crc_passed;
+            } else {
+                pending.push_back(l);
+                pending_sequences.push_back(dna_sequence);
+                pending_ecc.push_back(ecc_symbols[l]);
+            }
+        }
+
+        add_counters(counted);
+
+        if (!pending.empty()) {
+            std::vector<std::string> decoded = decode_batch(pending_sequences, pending_ecc, engine);
+            for (std::size_t p = 0; p < pending.size(); ++p) {
+                result[pending[p]] = std::move(decoded[p]);
+            }
+        }
+
+        return result;
+    }
+
+    // Encode a whole sequence of any length
+    //
+    // The sequence is split into blocks of DataLength bases, the last one
+    // padded with 'A's, and the blocks encoded sequence_batch_lanes at a
+    // time by the batch kernels into out. A block holding an invalid base
+    // is reported as such and the rest are still encoded. Returns the
+    // number of blocks encoded.
+    std::size_t encode_sequence(std::string_view dna_sequence, sequence_buffer& out,
+                                batch_engine engine = batch_engine::simd) const {
+        const std::size_t blocks = (dna_sequence.size() + DataLength - 1) / DataLength;
+
+        out.dna.resize(blocks * CodeLength);
+        out.ecc.resize(blocks * FecLength);
+        out.status.assign(blocks, block_status::ok);
+
+        encode_counters counted;
+        std::size_t encoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(DataLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            // Blocks that are invalid, all zero or in the parity cache are
+            // written out here, the others take a lane of the batch
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                const std::size_t offset = b * DataLength;
+                const std::size_t count = std::min(DataLength, dna_sequence.size() - offset);
+                char* strand = &out.dna[b * CodeLength];
+                std::uint8_t* ecc = &out.ecc[b * FecLength];
+
+                std::uint8_t symbols[DataLength] = {};
+                if (!schifra::utils::dna::bases_to_symbols(dna_sequence.data() + offset, count, symbols)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(strand, strand + CodeLength, 'N');
+                    std::fill(ecc, ecc + FecLength, std::uint8_t(0));
+                    continue;
+                }
+                if (all_zero(symbols, DataLength)) {
+                    std::fill(ecc, ecc + FecLength, std::uint8_t(0));
+                    write_sequence_block(symbols, ecc, strand);
+                    ++counted.zero_block;
+                    ++encoded;
+                    continue;
+                }
+                if (parity_cache_ && parity_cache_->lookup(symbols, ecc)) {
+                    write_sequence_block(symbols, ecc, strand);
+                    ++encoded;
+                    continue;
+                }
+
+                const std::size_t lane = out.lanes_.size();
+                out.lanes_.push_back(static_cast<std::uint32_t>(b));
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    out.planar_[i * lanes + lane] = symbols[i];
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            encode_planar(out, lanes, used, engine);
+
+            for (std::size_t l = 0; l < used; ++l) {
+                const std::size_t b = out.lanes_[l];
+                std::uint8_t* ecc = &out.ecc[b * FecLength];
+
+                std::uint8_t symbols[DataLength];
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    symbols[i] = out.planar_[i * used + l];
+                }
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    ecc[i] = out.planar_out_[i * used + l];
+                }
+                write_sequence_block(symbols, ecc, &out.dna[b * CodeLength]);
+                if (parity_cache_) {
+                    parity_cache_->insert(symbols, ecc);
+                }
+                ++encoded;
+            }
+            counted.batched += used;
+        }
+
+        add_counters(counted);
+
+        return encoded;
+    }
+
+    // Decode the output of encode_sequence()
+    //
+    // strands and ecc_symbols are out.dna and out.ecc of the encode, and
+    // length the length of the original sequence, which out.dna is trimmed
+    // to. Syndromes are computed by the batch kernels, blocks with errors go
+    // through the decoder; failing blocks are reported in out.status rather
+    // than thrown. Returns the number of blocks that decoded.
+    std::size_t decode_sequence(std::string_view strands, schifra::utils::span<const std::uint8_t> ecc_symbols,
+                                std::size_t length, sequence_buffer& out,
+                                batch_engine engine = batch_engine::simd) const {
+        decode_counters counted;
+        const std::size_t decoded = decode_sequence(strands, ecc_symbols, length, out, engine, counted, nullptr);
+        add_counters(counted);
+        return decoded;
+    }
+
+    // decode_sequence() counting into counters, and when stats is not null
+    // recording every block in it, so that concurrent callers can each
+    // keep their own
+    std::size_t decode_sequence(std::string_view strands, schifra::utils::span<const std::uint8_t> ecc_symbols,
+                                std::size_t length, sequence_buffer& out, batch_engine engine,
+                                decode_counters& counters, process_stats* stats) const {
+        const std::size_t blocks = strands.size() / CodeLength;
+
+        if ((strands.size() % CodeLength) != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of " + std::to_string(CodeLength) + " characters");
+        }
+        if (ecc_symbols.size() != blocks * FecLength) {
+            throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(FecLength) + " symbols per block");
+        }
+        if ((length > blocks * DataLength) || (length + DataLength <= blocks * DataLength)) {
+            throw std::invalid_argument("Sequence length does not match the number of blocks");
+        }
+
+        out.dna.resize(blocks * DataLength);
+        out.ecc.clear();
+        out.status.assign(blocks, block_status::ok);
+
+        std::size_t decoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(CodeLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            // Blocks that are invalid or all zero are written out here, the
+            // others take a lane of the batch
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                const std::uint8_t* ecc = ecc_symbols.data() + b * FecLength;
+                char* data = &out.dna[b * DataLength];
+
+                std::uint8_t symbols[DataLength] = {};
+                if (!schifra::utils::dna::bases_to_symbols(strands.data() + b * CodeLength, DataLength, symbols)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(data, data + DataLength, 'N');
+                    if (stats) {
+                        stats->record_uncorrectable();
+                    }
+                    continue;
+                }
+                if (all_zero(symbols, DataLength) && all_zero(ecc, FecLength)) {
+                    std::fill(data, data + DataLength, 'A');
+                    if (stats) {
+                        const std::uint8_t received[CodeLength] = {};
+                        stats->record_block(received, received);
+                    }
+                    ++counters.zero_block;
+                    ++decoded;
+                    continue;
+                }
+
+                const std::size_t lane = out.lanes_.size();
+                out.lanes_.push_back(static_cast<std::uint32_t>(b));
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    out.planar_[i * lanes + lane] = symbols[i];
+                }
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    out.planar_[(DataLength + i) * lanes + lane] = ecc[i];
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            const std::size_t dirty = syndrome_planar(out, lanes, used, engine);
+
+            for (std::size_t l = 0; l < used; ++l) {
+                const std::size_t b = out.lanes_[l];
+                char* data = &out.dna[b * DataLength];
+
+                std::uint8_t received[CodeLength];
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    received[i] = out.planar_[i * used + l];
+                }
+
+                bool clean = true;
+                for (std::size_t i = 0; (dirty != 0) && (i < FecLength); ++i) {
+                    clean = clean && (0 == out.planar_out_[i * used + l]);
+                }
+
+                if (clean) {
+                    for (std::size_t i = 0; i < DataLength; ++i) {
+                        data[i] = schifra::utils::dna::symbol_to_base(received[i]);
+                    }
+                    if (stats) {
+                        stats->record_block(received, received);
+                    }
+                    ++counters.syndrome_clean;
+                    ++decoded;
+                    continue;
+                }
+
+                block_type block;
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    block.data[i] = static_cast<schifra::galois::field_symbol>(received[i]);
+                }
+
+                ++counters.corrected;
+
+                if (table_decoder_ ? table_decoder_->decode(block) : decoder_->decode(block)) {
+                    out.status[b] = block_status::corrected;
+                    if (stats) {
+                        std::uint8_t corrected[CodeLength];
+                        for (std::size_t i = 0; i < CodeLength; ++i) {
+                            corrected[i] = static_cast<std::uint8_t>(block.data[i]);
+                        }
+                        stats->record_block(received, corrected);
+                    }
+                    ++decoded;
+                } else {
+                    out.status[b] = block_status::uncorrectable;
+                    if (stats) {
+                        stats->record_uncorrectable();
+                    }
+                    for (std::size_t i = 0; i < DataLength; ++i) {
+                        block.data[i] = static_cast<schifra::galois::field_symbol>(received[i]);
+                    }
+                }
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    data[i] = schifra::utils::dna::symbol_to_base(static_cast<std::uint8_t>(block.data[i]));
+                }
+            }
+        }
+
+        out.dna.resize(length);
+
+        return decoded;
+    }
+
+#if defined(SCHIFRA_EXECUTION_POLICIES)
+    // encode_sequence() and decode_sequence() under an execution policy
+    //
+    // The batch kernels run under every policy. par and par_unseq split
+    // the blocks, whole batches of sequence_batch_lanes at a time, over up
+    // to one thread per hardware thread, each with its own scratch; seq
+    // and unseq run on the calling thread. out is as the plain overloads
+    // leave it.
+    template <typename Policy>
+    schifra::reed_solomon::enable_if_execution_policy<Policy, std::size_t>
+    encode_sequence(Policy&&, std::string_view dna_sequence, sequence_buffer& out,
+                    batch_engine engine = batch_engine::simd) const {
+        const std::size_t blocks = (dna_sequence.size() + DataLength - 1) / DataLength;
+        const std::size_t batches = (blocks + sequence_batch_lanes - 1) / sequence_batch_lanes;
+
+        if (!schifra::reed_solomon::execution_traits_of<Policy>::parallel || (batches < 2)) {
+            return encode_sequence(dna_sequence, out, engine);
+        }
+
+        out.dna.resize(blocks * CodeLength);
+        out.ecc.resize(blocks * FecLength);
+        out.status.resize(blocks);
+
+        return schifra::reed_solomon::details::parallel_ranges(batches, 1,
+            [&](std::size_t begin, std::size_t end) {
+                const std::size_t first = begin * sequence_batch_lanes;
+                const std::size_t last = std::min(end * sequence_batch_lanes, blocks);
+                const std::size_t offset = first * DataLength;
+
+                sequence_buffer part;
+                const std::size_t encoded = encode_sequence(
+                    dna_sequence.substr(offset, std::min(last * DataLength, dna_sequence.size()) - offset), part, engine);
+
+                std::copy(part.dna.begin(), part.dna.end(), out.dna.begin() + first * CodeLength);
+                std::copy(part.ecc.begin(), part.ecc.end(), out.ecc.begin() + first * FecLength);
+                std::copy(part.status.begin(), part.status.end(), out.status.begin() + first);
+                return encoded;
+            });
+    }
+
+    template <typename Policy>
+    schifra::reed_solomon::enable_if_execution_policy<Policy, std::size_t>
+    decode_sequence(Policy&&, std::string_view strands, schifra::utils::span<const std::uint8_t> ecc_symbols,
+                    std::size_t length, sequence_buffer& out, batch_engine engine = batch_engine::simd) const {
+        const std::size_t blocks = strands.size() / CodeLength;
+        const std::size_t batches = (blocks + sequence_batch_lanes - 1) / sequence_batch_lanes;
+
+        // Malformed input goes the plain way, which reports it
+        const bool consistent = ((strands.size() % CodeLength) == 0) &&
+                                (ecc_symbols.size() == blocks * FecLength) &&
+                                (length <= blocks * DataLength) && (length + DataLength > blocks * DataLength);
+
+        if (!schifra::reed_solomon::execution_traits_of<Policy>::parallel || (batches < 2) || !consistent) {
+            return decode_sequence(strands, ecc_symbols, length, out, engine);
+        }
+
+        out.dna.resize(blocks * DataLength);
+        out.ecc.clear();
+        out.status.resize(blocks);
+
+        const std::size_t decoded = schifra::reed_solomon::details::parallel_ranges(batches, 1,
+            [&](std::size_t begin, std::size_t end) {
+                const std::size_t first = begin * sequence_batch_lanes;
+                const std::size_t last = std::min(end * sequence_batch_lanes, blocks);
+
+                sequence_buffer part;
+                decode_counters counted;
+                const std::size_t blocks_decoded = decode_sequence(
+                    strands.substr(first * CodeLength, (last - first) * CodeLength),
+                    ecc_symbols.subspan(first * FecLength, (last - first) * FecLength),
+                    std::min(length, last * DataLength) - first * DataLength, part, engine, counted, nullptr);
+                add_counters(counted);
+
+                std::copy(part.dna.begin(), part.dna.end(), out.dna.begin() + first * DataLength);
+                std::copy(part.status.begin(), part.status.end(), out.status.begin() + first);
+                return blocks_decoded;
+            });
+
+        out.dna.resize(length);
+
+        return decoded;
+    }
+#endif
+
+    // In-band strands
+    //
+    // encode() keeps data bases as symbols and maps parity symbols to bases
+    // mod 4, so the ECC has to travel next to the strand. In-band strands
+    // carry every GF(2^4) symbol, data and parity alike, as 2 bases (low
+    // bits first: A=0 C=1 G=2 T=3), so a strand of strand_length() bases
+    // holding strand_data_length() bases of data decodes on its own.
+    static constexpr std::size_t strand_length() { return 2 * CodeLength; }
+    static constexpr std::size_t strand_data_length() { return 2 * DataLength; }
+
+    // Encode strand_data_length() bases into a strand of strand_length()
+    codec_result encode_strand(std::string_view data, char* strand) const noexcept {
+        codec_result result;
+        if (data.size() != strand_data_length()) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        std::uint8_t symbols[CodeLength] = {};
+        if (!strand_to_symbols(data.data(), DataLength, symbols)) {
+            result.status = codec_status::invalid_base;
+            return result;
+        }
+        if (!encoder_->encode(schifra::utils::span<const std::uint8_t>(symbols, DataLength),
+                              schifra::utils::span<std::uint8_t>(symbols + DataLength, FecLength))) {
+            result.status = codec_status::codec_error;
+            result.error = block_type::e_encoder_error0;
+            return result;
+        }
+        write_strand(symbols, strand);
+        return result;
+    }
+
+    // Decode a strand of strand_length() bases into strand_data_length()
+    // bases of data, as read when the strand cannot be corrected
+    codec_result decode_strand(std::string_view strand, char* data) const noexcept {
+        codec_result result;
+        if (strand.size() != strand_length()) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        std::uint8_t symbols[CodeLength];
+        if (!read_strand(strand.data(), symbols)) {
+            result.status = codec_status::invalid_base;
+            return result;
+        }
+        result = try_decode(schifra::utils::span<std::uint8_t>(symbols, CodeLength));
+        symbols_to_strand(symbols, DataLength, data);
+        return result;
+    }
+
+    // decode_strand() of read_count reads of one strand, by consensus as
+    // the multi-read try_decode(). A symbol is as settled as the less
+    // settled of its 2 bases.
+    codec_result decode_strand(const std::string_view* reads, std::size_t read_count, char* data,
+                               const std::uint8_t* const* qualities = nullptr, std::uint16_t min_margin = 1) const noexcept {
+        codec_result result;
+        char bases[2 * CodeLength];
+        std::uint16_t margin[2 * CodeLength];
+        if (!read_consensus(reads, read_count, qualities, strand_length(), strand_length(), bases, margin, result)) {
+            return result;
+        }
+
+        block_type block;
+        std::uint16_t symbol_margin[CodeLength];
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(unmap_symbol(i, static_cast<std::uint8_t>(
+                schifra::utils::dna::base_to_symbol(bases[2 * i]) | (schifra::utils::dna::base_to_symbol(bases[2 * i + 1]) << 2))));
+            symbol_margin[i] = std::min(margin[2 * i], margin[2 * i + 1]);
+        }
+
+        return decode_consensus(block, symbol_margin, CodeLength, min_margin, data, DataLength, 2);
+    }
+
+    // decode_strand() of a sequenced read: quality holds its FASTQ quality
+    // characters, and symbols with a base below min_quality (Phred) are
+    // passed to the decoder as erasures, the lowest first and at most
+    // FecLength of them. A base the sequencer could not call (eg: 'N') is
+    // an erasure too rather than making the strand invalid.
+    codec_result decode_strand(std::string_view strand, std::string_view quality, char* data,
+                               std::uint8_t min_quality) const noexcept {
+        codec_result result;
+        if ((strand.size() != strand_length()) || (quality.size() != strand_length())) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+
+        block_type block;
+        std::uint16_t symbol_quality[CodeLength];
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            std::uint8_t symbol = 0;
+            std::uint16_t q = 0xFFFF;
+            for (std::size_t j = 0; j < 2; ++j) {
+                const std::uint8_t s = schifra::utils::dna::base_to_symbol(strand[2 * i + j]);
+                const std::uint16_t base_q = schifra::utils::dna::phred_score(quality[2 * i + j]);
+                if (s == schifra::utils::dna::invalid_base) {
+                    q = 0;
+                } else {
+                    symbol |= static_cast<std::uint8_t>(s << (2 * j));
+                    q = std::min(q, base_q);
+                }
+            }
+            block.data[i] = static_cast<schifra::galois::field_symbol>(unmap_symbol(i, symbol));
+            symbol_quality[i] = q;
+        }
+
+        return decode_consensus(block, symbol_quality, CodeLength, min_quality, data, DataLength, 2);
+    }
+
+    // Decode the in-band strands of a FASTA/FASTQ input, one per record,
+    // FASTQ reads through the quality aware decode_strand(). out.dna
+    // receives strand_data_length() bases per record in input order and
+    // out.status one entry per record, a read of the wrong length being
+    // invalid with 'N's as data. Throws on a malformed record. Returns the
+    // number of records that decoded.
+    std::size_t decode_reads(schifra::utils::dna::sequence_reader& reader, sequence_buffer& out,
+                             std::uint8_t min_quality = 20) const {
+        schifra::utils::dna::sequence_record record;
+
+        out.dna.clear();
+        out.ecc.clear();
+        out.status.clear();
+
+        decode_counters counted;
+        std::size_t decoded = 0;
+
+        while (reader.next(record)) {
+            const std::size_t b = out.status.size();
+            out.dna.resize((b + 1) * strand_data_length());
+            char* data = &out.dna[b * strand_data_length()];
+
+            const codec_result result = (reader.format() == schifra::utils::dna::sequence_reader::e_fastq) ?
+                decode_strand(record.sequence, record.quality, data, min_quality) :
+                decode_strand(record.sequence, data);
+
+            if ((result.status == codec_status::invalid_length) || (result.status == codec_status::invalid_base)) {
+                std::fill(data, data + strand_data_length(), 'N');
+                out.status.push_back(block_status::invalid);
+            } else if (!result) {
+                ++counted.corrected;
+                out.status.push_back(block_status::uncorrectable);
+            } else if (result.errors_corrected != 0) {
+                ++counted.corrected;
+                out.status.push_back(block_status::corrected);
+                ++decoded;
+            } else {
+                ++counted.syndrome_clean;
+                out.status.push_back(block_status::ok);
+                ++decoded;
+            }
+        }
+
+        add_counters(counted);
+
+        if (reader.malformed()) {
+            throw std::runtime_error("Malformed FASTA/FASTQ record after record " + std::to_string(reader.records()));
+        }
+
+        return decoded;
+    }
+
+    // decode_reads() of a FASTA/FASTQ stream
+    std::size_t decode_fastq(std::istream& fastq, sequence_buffer& out, std::uint8_t min_quality = 20) const {
+        schifra::utils::dna::sequence_reader reader(fastq);
+        return decode_reads(reader, out, min_quality);
+    }
+
+    // encode_sequence() producing in-band strands: the sequence is split
+    // into blocks of strand_data_length() bases, the last padded with 'A's,
+    // and out.dna receives strand_length() bases per block, out.ecc is
+    // left empty. Returns the number of blocks encoded.
+    std::size_t encode_strands(std::string_view dna_sequence, sequence_buffer& out,
+                               batch_engine engine = batch_engine::simd) const {
+        const std::size_t blocks = (dna_sequence.size() + strand_data_length() - 1) / strand_data_length();
+
+        out.dna.resize(blocks * strand_length());
+        out.ecc.clear();
+        out.status.assign(blocks, block_status::ok);
+
+        encode_counters counted;
+        std::size_t encoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(DataLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                const std::size_t offset = b * strand_data_length();
+                char* strand = &out.dna[b * strand_length()];
+
+                char bases[2 * DataLength];
+                const std::size_t count = std::min(strand_data_length(), dna_sequence.size() - offset);
+                std::copy(dna_sequence.data() + offset, dna_sequence.data() + offset + count, bases);
+                std::fill(bases + count, bases + strand_data_length(), 'A');
+
+                std::uint8_t symbols[CodeLength] = {};
+                if (!strand_to_symbols(bases, DataLength, symbols)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(strand, strand + strand_length(), 'N');
+                    continue;
+                }
+                if (all_zero(symbols, DataLength)) {
+                    write_strand(symbols, strand);
+                    ++counted.zero_block;
+                    ++encoded;
+                    continue;
+                }
+                if (parity_cache_ && parity_cache_->lookup(symbols, symbols + DataLength)) {
+                    write_strand(symbols, strand);
+                    ++encoded;
+                    continue;
+                }
+
+                const std::size_t lane = out.lanes_.size();
+                out.lanes_.push_back(static_cast<std::uint32_t>(b));
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    out.planar_[i * lanes + lane] = symbols[i];
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            encode_planar(out, lanes, used, engine);
+
+            for (std::size_t l = 0; l < used; ++l) {
+                const std::size_t b = out.lanes_[l];
+
+                std::uint8_t symbols[CodeLength];
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    symbols[i] = out.planar_[i * used + l];
+                }
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    symbols[DataLength + i] = out.planar_out_[i * used + l];
+                }
+                write_strand(symbols, &out.dna[b * strand_length()]);
+                if (parity_cache_) {
+                    parity_cache_->insert(symbols, symbols + DataLength);
+                }
+                ++encoded;
+            }
+            counted.batched += used;
+        }
+
+        add_counters(counted);
+
+        return encoded;
+    }
+
+    // Decode the output of encode_strands(): strands is out.dna of the
+    // encode, and length the length of the original sequence, which out.dna
+    // is trimmed to. Returns the number of blocks that decoded.
+    std::size_t decode_strands(std::string_view strands, std::size_t length, sequence_buffer& out,
+                               batch_engine engine = batch_engine::simd) const {
+        const std::size_t blocks = strands.size() / strand_length();
+
+        if ((strands.size() % strand_length()) != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of " + std::to_string(strand_length()) + " characters");
+        }
+        if ((length > blocks * strand_data_length()) || (length + strand_data_length() <= blocks * strand_data_length())) {
+            throw std::invalid_argument("Sequence length does not match the number of blocks");
+        }
+
+        out.dna.resize(blocks * strand_data_length());
+        out.ecc.clear();
+        out.status.assign(blocks, block_status::ok);
+
+        decode_counters counted;
+        std::size_t decoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(CodeLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                char* data = &out.dna[b * strand_data_length()];
+
+                std::uint8_t symbols[CodeLength] = {};
+                if (!read_strand(strands.data() + b * strand_length(), symbols)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(data, data + strand_data_length(), 'N');
+                    continue;
+                }
+                if (all_zero(symbols, CodeLength)) {
+                    std::fill(data, data + strand_data_length(), 'A');
+                    ++counted.zero_block;
+                    ++decoded;
+                    continue;
+                }
+
+                const std::size_t lane = out.lanes_.size();
+                out.lanes_.push_back(static_cast<std::uint32_t>(b));
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    out.planar_[i * lanes + lane] = symbols[i];
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            const std::size_t dirty = syndrome_planar(out, lanes, used, engine);
+
+            for (std::size_t l = 0; l < used; ++l) {
+                const std::size_t b = out.lanes_[l];
+                char* data = &out.dna[b * strand_data_length()];
+
+                std::uint8_t codeword[CodeLength];
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    codeword[i] = out.planar_[i * used + l];
+                }
+
+                bool clean = true;
+                for (std::size_t i = 0; (dirty != 0) && (i < FecLength); ++i) {
+                    clean = clean && (0 == out.planar_out_[i * used + l]);
+                }
+
+                if (clean) {
+                    ++counted.syndrome_clean;
+                    ++decoded;
+                } else {
+                    ++counted.corrected;
+                    if (try_decode(schifra::utils::span<std::uint8_t>(codeword, CodeLength))) {
+                        out.status[b] = block_status::corrected;
+                        ++decoded;
+                    } else {
+                        out.status[b] = block_status::uncorrectable;
+                    }
+                }
+                symbols_to_strand(codeword, DataLength, data);
+            }
+        }
+
+        add_counters(counted);
+        out.dna.resize(length);
+
+        return decoded;
+    }
+
+    // Decode reads whose lengths vary around strand_length() by indels
+    //
+    // Reads are bucketed by their length offset d, |d| <= max_offset, and
+    // each is turned into candidates of exactly strand_length() bases: the
+    // read itself when d is 0, else one per position p with the d bases at
+    // p removed (d > 0), or with -d bases inserted at p (d < 0), one
+    // candidate per choice of inserted bases, ie: every placement of one
+    // indel of that length. The candidates of whole reads fill the batch
+    // and go through the fixed length syndrome kernels together. A read
+    // takes its clean candidate, else the candidate the decoder corrects
+    // with the fewest symbols; candidates that tie on different data leave
+    // the read uncorrectable. out.dna receives strand_data_length() bases
+    // per read and out.status one entry per read. A read further off (or
+    // with more candidates than a batch holds) or holding an invalid base
+    // is invalid; an uncorrectable read off the strand length gets 'N's.
+    // Returns the number of reads that decoded.
+    std::size_t decode_ragged_reads(const std::string_view* reads, std::size_t count, sequence_buffer& out,
+                                    std::size_t max_offset = 2, batch_engine engine = batch_engine::simd) const {
+        out.dna.resize(count * strand_data_length());
+        out.ecc.clear();
+        out.status.assign(count, block_status::ok);
+
+        const std::size_t lanes = sequence_batch_lanes;
+
+        decode_counters counted;
+        std::size_t decoded = 0;
+        std::size_t next = 0;
+
+        while (next < count) {
+            out.planar_.resize(CodeLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            // Candidates of whole reads, as many reads as fit in the batch
+            for (; next < count; ++next) {
+                const std::string_view read = reads[next];
+                const std::size_t shorter = std::min(read.size(), strand_length());
+                const std::size_t offset = std::max(read.size(), strand_length()) - shorter;
+                const std::size_t fills = (read.size() < strand_length()) ? (std::size_t(1) << std::min<std::size_t>(2 * offset, 16)) : 1;
+                const std::size_t candidates = (offset == 0) ? 1 : (shorter + 1) * fills;
+                char* data = &out.dna[next * strand_data_length()];
+
+                if ((offset > max_offset) || (candidates > lanes)) {
+                    out.status[next] = block_status::invalid;
+                    std::fill(data, data + strand_data_length(), 'N');
+                    continue;
+                }
+                if (out.lanes_.size() + candidates > lanes) {
+                    break;
+                }
+
+                const std::size_t start = out.lanes_.size();
+                for (std::size_t p = 0; p < candidates; ++p) {
+                    char bases[2 * CodeLength];
+                    if (offset == 0) {
+                        std::copy(read.begin(), read.end(), bases);
+                    } else if (read.size() > strand_length()) {
+                        std::copy(read.begin(), read.begin() + p, bases);
+                        std::copy(read.begin() + p + offset, read.end(), bases + p);
+                    } else {
+                        const std::size_t at = p / fills;
+                        std::copy(read.begin(), read.begin() + at, bases);
+                        for (std::size_t i = 0; i < offset; ++i) {
+                            bases[at + i] = "ACGT"[(p % fills) >> (2 * i) & 3];
+                        }
+                        std::copy(read.begin() + at, read.end(), bases + at + offset);
+                    }
+
+                    std::uint8_t symbols[CodeLength];
+                    if (!read_strand(bases, symbols)) {
+                        break;
+                    }
+
+                    const std::size_t lane = out.lanes_.size();
+                    out.lanes_.push_back(static_cast<std::uint32_t>(next));
+                    for (std::size_t i = 0; i < CodeLength; ++i) {
+                        out.planar_[i * lanes + lane] = symbols[i];
+                    }
+                }
+
+                if (out.lanes_.size() != start + candidates) {
+                    out.lanes_.resize(start);
+                    out.status[next] = block_status::invalid;
+                    std::fill(data, data + strand_data_length(), 'N');
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            const std::size_t dirty = syndrome_planar(out, lanes, used, engine);
+
+            for (std::size_t first = 0; first < used; ) {
+                const std::size_t r = out.lanes_[first];
+                std::size_t last = first + 1;
+                while ((last < used) && (out.lanes_[last] == r)) {
+                    ++last;
+                }
+
+                if (resolve_candidates(out, used, first, last, dirty, &out.dna[r * strand_data_length()], out.status[r], counted)) {
+                    counted.realigned += (reads[r].size() != strand_length()) ? 1 : 0;
+                    ++decoded;
+                } else if (reads[r].size() != strand_length()) {
+                    std::fill(&out.dna[r * strand_data_length()], &out.dna[(r + 1) * strand_data_length()], 'N');
+                }
+
+                first = last;
+            }
+        }
+
+        add_counters(counted);
+
+        return decoded;
+    }
+
+    std::size_t decode_ragged_reads(const std::vector<std::string_view>& reads, sequence_buffer& out,
+                                    std::size_t max_offset = 2, batch_engine engine = batch_engine::simd) const {
+        return decode_ragged_reads(reads.data(), reads.size(), out, max_offset, engine);
+    }
+
+    // Resynchronization stage for the reads a decode left uncorrectable
+    //
+    // An insertion or deletion in a read of fixed length shifts every base
+    // after it, so the whole codeword fails: a deletion pulls in a base
+    // from past the strand, an insertion pushes the last base out. For
+    // each uncorrectable entry of out whose read has strand_length() bases,
+    // candidates repair one indel at every position p: the base at p
+    // deleted and one of ACGT appended, or one of ACGT inserted at p and
+    // the last base dropped. The candidates of many reads are evaluated
+    // together by the batch syndrome kernels. A read whose clean candidates
+    // agree on their data takes it, else only its candidate with the
+    // fewest non-zero syndromes goes on to the decoder. Recovered reads
+    // become corrected and their data is rewritten in out.dna (trimmed as
+    // it may be). reads are those out was decoded from, one per entry of
+    // out.status. Returns the number of reads recovered.
+    std::size_t resynchronize(const std::string_view* reads, std::size_t count, sequence_buffer& out,
+                              batch_engine engine = batch_engine::simd) const {
+        if (count != out.status.size()) {
+            throw std::invalid_argument("Reads must match the blocks of the decode");
+        }
+
+        const std::size_t lanes = sequence_batch_lanes;
+        const std::size_t candidates = 2 * 4 * strand_length();
+
+        decode_counters counted;
+        std::size_t next = 0;
+
+        while (next < count) {
+            out.planar_.resize(CodeLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+            out.lanes_.clear();
+
+            for (; (next < count) && (out.lanes_.size() + candidates <= lanes); ++next) {
+                const std::string_view read = reads[next];
+                if ((out.status[next] != block_status::uncorrectable) || (read.size() != strand_length())) {
+                    continue;
+                }
+
+                const std::size_t start = out.lanes_.size();
+                for (std::size_t c = 0; c < candidates; ++c) {
+                    const std::size_t p = c / 8;
+                    const char base = "ACGT"[c % 4];
+
+                    char bases[2 * CodeLength];
+                    std::copy(read.begin(), read.begin() + p, bases);
+                    if ((c % 8) < 4) {
+                        std::copy(read.begin() + p + 1, read.end(), bases + p);
+                        bases[strand_length() - 1] = base;
+                    } else {
+                        bases[p] = base;
+                        std::copy(read.begin() + p, read.end() - 1, bases + p + 1);
+                    }
+
+                    std::uint8_t symbols[CodeLength];
+                    if (!read_strand(bases, symbols)) {
+                        out.lanes_.resize(start);
+                        break;
+                    }
+
+                    const std::size_t lane = out.lanes_.size();
+                    out.lanes_.push_back(static_cast<std::uint32_t>(next));
+                    for (std::size_t i = 0; i < CodeLength; ++i) {
+                        out.planar_[i * lanes + lane] = symbols[i];
+                    }
+                }
+            }
+
+            const std::size_t used = out.lanes_.size();
+            const std::size_t dirty = syndrome_planar(out, lanes, used, engine);
+
+            for (std::size_t first = 0; first < used; first += candidates) {
+                const std::size_t r = out.lanes_[first];
+
+                std::uint8_t codeword[CodeLength];
+                if (!resync_candidates(out, used, first, first + candidates, dirty, codeword)) {
+                    continue;
+                }
+
+                char data[2 * DataLength];
+                symbols_to_strand(codeword, DataLength, data);
+
+                const std::size_t offset = r * strand_data_length();
+                if (offset < out.dna.size()) {
+                    std::copy(data, data + std::min(strand_data_length(), out.dna.size() - offset), &out.dna[offset]);
+                }
+                out.status[r] = block_status::corrected;
+                ++counted.resynchronized;
+            }
+        }
+
+        add_counters(counted);
+
+        return counted.resynchronized;
+    }
+
+    // resynchronize() after decode_strands() or decode_strands_unique() of
+    // strands, strand_length() bases per read back to back
+    std::size_t resynchronize(std::string_view strands, sequence_buffer& out,
+                              batch_engine engine = batch_engine::simd) const {
+        if ((strands.size() % strand_length()) != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of " + std::to_string(strand_length()) + " characters");
+        }
+
+        std::vector<std::string_view> reads(strands.size() / strand_length());
+        for (std::size_t r = 0; r < reads.size(); ++r) {
+            reads[r] = strands.substr(r * strand_length(), strand_length());
+        }
+
+        return resynchronize(reads.data(), reads.size(), out, engine);
+    }
+
+    // decode_strand() of a read in either orientation
+    //
+    // The read and its reverse complement are both checked by syndromes
+    // alone, and a read that is clean one way, the common case, is not
+    // decoded at all. A read clean both ways, eg: all 'A' or all 'T', is
+    // unknown and a codec_error unless both carry the same data. Only a
+    // read dirty both ways is decoded both ways, the orientation taken
+    // being the one that decodes with fewer corrections; when both decode
+    // equally it is unknown and the read is reported as a codec_error, as
+    // one of them is a miscorrection. data is as read (forward) when
+    // neither decodes.
+    codec_result decode_strand_oriented(std::string_view read, char* data,
+                                        strand_orientation* orientation = nullptr) const noexcept {
+        codec_result result;
+        strand_orientation found = strand_orientation::unknown;
+        if (orientation) {
+            *orientation = found;
+        }
+        if (read.size() != strand_length()) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+
+        // Forward codeword in lane 0, reverse in lane 1 of a planar pair
+        char reverse_bases[2 * CodeLength];
+        std::uint8_t forward[CodeLength];
+        std::uint8_t reverse[CodeLength];
+        schifra::utils::dna::reverse_complement(read.data(), strand_length(), reverse_bases);
+        if (!read_strand(read.data(), forward) || !read_strand(reverse_bases, reverse)) {
+            result.status = codec_status::invalid_base;
+            return result;
+        }
+
+        std::uint8_t planar[2 * CodeLength];
+        std::uint8_t syndromes[2 * FecLength];
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            planar[2 * i] = forward[i];
+            planar[2 * i + 1] = reverse[i];
+        }
+        batch_codec_->syndrome(planar, syndromes, 2);
+
+        bool forward_clean = true;
+        bool reverse_clean = true;
+        for (std::size_t i = 0; i < FecLength; ++i) {
+            forward_clean = forward_clean && (0 == syndromes[2 * i]);
+            reverse_clean = reverse_clean && (0 == syndromes[2 * i + 1]);
+        }
+
+        result = decode_either(forward, reverse, forward_clean, reverse_clean, found);
+        symbols_to_strand((found == strand_orientation::reverse) ? reverse : forward, DataLength, data);
+        if (orientation) {
+            *orientation = found;
+        }
+        return result;
+    }
+
+    // decode_strand_oriented() of many reads: reads holds strand_length()
+    // bases per read, back to back, each in either orientation, eg: the
+    // reads of one cluster or of a whole pool. The syndromes of every read
+    // and of its reverse complement are computed together by the batch
+    // kernels, and out receives strand_data_length() bases, a status and an
+    // orientation per read. Returns the number of reads that decoded.
+    std::size_t decode_strands_oriented(std::string_view reads, sequence_buffer& out,
+                                        batch_engine engine = batch_engine::simd) const {
+        if ((reads.size() % strand_length()) != 0) {
+            throw std::invalid_argument("Reads length must be a multiple of " + std::to_string(strand_length()) + " characters");
+        }
+        const std::size_t blocks = reads.size() / strand_length();
+
+        out.dna.resize(blocks * strand_data_length());
+        out.ecc.clear();
+        out.status.assign(blocks, block_status::ok);
+        out.orientation.assign(blocks, strand_orientation::forward);
+        out.copies.clear();
+
+        decode_counters counted;
+        const std::size_t decoded = decode_oriented(reads, nullptr, blocks, out, engine, counted);
+        add_counters(counted);
+
+        return decoded;
+    }
+
+    // decode_strands_oriented() decoding each distinct read once
+    //
+    // At high coverage many reads are identical. Reads are hashed and a
+    // read with the same bases (case included) as an earlier read of the
+    // call takes that read's data, status and orientation, skipping the
+    // syndrome kernels and the decoder. out.copies receives, for every
+    // read, how many reads of the call share its bases, eg: as the weight
+    // of each distinct read in a consensus. Returns the number of reads
+    // that decoded, duplicates included.
+    std::size_t decode_strands_unique(std::string_view reads, sequence_buffer& out,
+                                      batch_engine engine = batch_engine::simd) const {
+        if ((reads.size() % strand_length()) != 0) {
+            throw std::invalid_argument("Reads length must be a multiple of " + std::to_string(strand_length()) + " characters");
+        }
+        const std::size_t blocks = reads.size() / strand_length();
+        if (blocks >= 0xFFFFFFFFu) {
+            throw std::invalid_argument("Too many reads for one call");
+        }
+
+        out.dna.resize(blocks * strand_data_length());
+        out.ecc.clear();
+        out.status.assign(blocks, block_status::ok);
+        out.orientation.assign(blocks, strand_orientation::forward);
+        out.copies.assign(blocks, 1);
+        out.first_.resize(blocks);
+        out.lanes_.clear();
+
+        // Open addressing, at most half full
+        std::size_t slots = 1;
+        while (slots < 2 * blocks) {
+            slots <<= 1;
+        }
+        out.index_.assign(slots, 0);
+
+        for (std::size_t b = 0; b < blocks; ++b) {
+            const unsigned char* read = reinterpret_cast<const unsigned char*>(reads.data()) + b * strand_length();
+            std::size_t slot = schifra::reed_solomon::parity_cache::hash(read, strand_length()) & (slots - 1);
+
+            for (;; slot = (slot + 1) & (slots - 1)) {
+                if (out.index_[slot] == 0) {
+                    out.index_[slot] = static_cast<std::uint32_t>(b + 1);
+                    out.first_[b] = static_cast<std::uint32_t>(b);
+                    out.lanes_.push_back(static_cast<std::uint32_t>(b));
+                    break;
+                }
+                const std::uint32_t f = out.index_[slot] - 1;
+                if (std::memcmp(reads.data() + f * strand_length(), read, strand_length()) == 0) {
+                    out.first_[b] = f;
+                    ++out.copies[f];
+                    break;
+                }
+            }
+        }
+
+        decode_counters counted;
+        std::size_t decoded = decode_oriented(reads, out.lanes_.data(), out.lanes_.size(), out, engine, counted);
+
+        for (std::size_t b = 0; b < blocks; ++b) {
+            const std::size_t f = out.first_[b];
+            if (f == b) {
+                continue;
+            }
+            std::copy(out.dna.begin() + f * strand_data_length(), out.dna.begin() + (f + 1) * strand_data_length(),
+                      out.dna.begin() + b * strand_data_length());
+            out.status[b] = out.status[f];
+            out.orientation[b] = out.orientation[f];
+            out.copies[b] = out.copies[f];
+            if ((out.status[b] == block_status::ok) || (out.status[b] == block_status::corrected)) {
+                ++decoded;
+            }
+            ++counted.duplicate;
+        }
+
+        add_counters(counted);
+
+        return decoded;
+    }
+    // CRC-32C of the data portion (the first DataLength bases) of a
+    // sequence, case insensitive, as expected by the CRC gated decode_batch()
+    static std::uint32_t data_checksum(const std::string& dna_sequence) {
+        char bases[DataLength];
+        const std::size_t count = std::min(DataLength, dna_sequence.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            bases[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(dna_sequence[i])));
+        }
+
+        return checksum_bases(bases, count);
+    }
+
+    // Counters of decode_batch() since construction or reset_counters()
+    //
+    // Kept in relaxed atomics, so threads sharing the instance may decode
+    // while others read them; a snapshot is returned.
+    decode_counters counters() const {
+        decode_counters snapshot;
+        snapshot.crc_passed = counters_->crc_passed.load(std::memory_order_relaxed);
+        snapshot.syndrome_clean = counters_->syndrome_clean.load(std::memory_order_relaxed);
+        snapshot.corrected = counters_->corrected.load(std::memory_order_relaxed);
+        snapshot.duplicate = counters_->duplicate.load(std::memory_order_relaxed);
+        snapshot.zero_block = counters_->zero_block.load(std::memory_order_relaxed);
+        snapshot.realigned = counters_->realigned.load(std::memory_order_relaxed);
+        snapshot.resynchronized = counters_->resynchronized.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+    void reset_counters() {
+        counters_->crc_passed.store(0, std::memory_order_relaxed);
+        counters_->syndrome_clean.store(0, std::memory_order_relaxed);
+        counters_->corrected.store(0, std::memory_order_relaxed);
+        counters_->duplicate.store(0, std::memory_order_relaxed);
+        counters_->zero_block.store(0, std::memory_order_relaxed);
+        counters_->realigned.store(0, std::memory_order_relaxed);
+        counters_->resynchronized.store(0, std::memory_order_relaxed);
+        counters_->encoded_zero_block.store(0, std::memory_order_relaxed);
+        counters_->encoded_batched.store(0, std::memory_order_relaxed);
+    }
+
+    // Counters of encode_sequence()/encode_strands() since construction or
+    // reset_counters(), kept as those of counters()
+    encode_counters encode_statistics() const {
+        encode_counters snapshot;
+        snapshot.zero_block = counters_->encoded_zero_block.load(std::memory_order_relaxed);
+        snapshot.batched = counters_->encoded_batched.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // Cache of the parity of repeated data blocks (reference genomes,
+    // padding, repeated headers) for encode_sequence(), encode_strands()
+    // and so process_file(): a block met before takes its parity from the
+    // cache instead of a batch lane. Each thread keeps up to
+    // entries_per_thread blocks, least recently used evicted first; 0
+    // turns the cache off. The output is the same either way.
+    void set_parity_cache(std::size_t entries_per_thread) {
+        parity_cache_.reset(entries_per_thread ?
+                            new schifra::reed_solomon::parity_cache(DataLength, FecLength, entries_per_thread) : nullptr);
+    }
+
+    // Hits, misses and evictions of the parity cache over every thread,
+    // all zero when it is off
+    parity_cache_stats parity_cache_statistics() const {
+        return parity_cache_ ? parity_cache_->stats() : parity_cache_stats();
+    }
+
+    // Check every correction of the algebraic decoder against the syndromes
+    // it was derived from, see decoder::verify_corrections(): a block whose
+    // corrections leave a non-zero syndrome is returned uncorrectable with
+    // error e_decoder_error5, so an outer code takes it as an erasure. Off
+    // by default. The table decoder only applies exact syndrome matches and
+    // is unaffected. Not to be called while other threads use the instance.
+    void set_verify_corrections(bool enabled) {
+        auto decoder = std::make_unique<decoder_type>(*field_, static_cast<unsigned int>(generator_polynomial_index));
+        decoder->verify_corrections(enabled);
+        decoder_ = std::move(decoder);
+    }
+
+    // Constrained mapping of the strand API (encode_strand(s) and every
+    // decode of strands or reads): each strand is rotated base by base by
+    // a key drawn from seed, see schifra_dna_rotation.hpp, after encoding
+    // and rotated back before decoding. Constant data, eg: the padding of
+    // a last block, no longer comes out as homopolymers. Strands only
+    // decode with the mapping (and seed) they were encoded with. Off by
+    // default; not to be called while other threads use the instance.
+    void set_constrained_mapping(bool enabled, std::uint32_t seed = default_rotation_seed) {
+        std::uint8_t key[2 * CodeLength];
+        schifra::utils::dna::make_rotation_key(strand_length(), seed, key);
+
+        strand_map_.fill(0);
+        for (std::size_t i = 0; enabled && (i < strand_length()); ++i) {
+            strand_map_[i / 4] |= static_cast<std::uint8_t>(key[i] << (2 * (i % 4)));
+        }
+        for (std::size_t i = 0; i < strand_map_.size(); ++i) {
+            strand_unmap_[i] = schifra::utils::dna::inverse_rotation(strand_map_[i]);
+        }
+        constrained_ = enabled;
+    }
+
+    bool constrained_mapping() const { return constrained_; }
+
+    // Warm up every codec of this instance from the calling thread, eg: on
+    // each worker before it serves its first request. The field, encoder
+    // and decoder tables are touched (and locked in RAM with lock), then a
+    // strand is encoded and decoded with an error through decode(), ie: the
+    // algebraic or table decoder, and a batch through each batch_engine,
+    // so that the first real request pays no page faults, cold misses or
+    // lazily built state. Returns false when a lock was refused.
+    //
+    // The warm up decodes are counted by counters(), reset_counters()
+    // afterwards if they must not be.
+    bool warm_up(bool lock = false) const {
+        bool locked = encoder_->warm_up(lock);
+        locked = decoder_->warm_up(lock) && locked;
+
+        static const char bases[] = "ACGT";
+        std::string data(DataLength, 'A');
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            data[i] = bases[i % 4];
+        }
+
+        const std::pair<std::string, std::vector<std::uint8_t>> encoded = encode(data);
+        std::string received = encoded.first;
+        if (FecLength >= 2) {
+            received[0] = (received[0] == 'A') ? 'C' : 'A';
+        }
+        decode(received, encoded.second);
+
+        const std::vector<std::string> batch(warm_up_batch, data);
+        for (const batch_engine engine : {batch_engine::simd, batch_engine::bitsliced}) {
+            const std::vector<std::pair<std::string, std::vector<std::uint8_t>>> strands = encode_batch(batch, engine);
+            std::vector<std::string> sequences;
+            std::vector<std::vector<std::uint8_t>> ecc_sets;
+            for (const std::pair<std::string, std::vector<std::uint8_t>>& strand : strands) {
+                sequences.push_back(strand.first);
+                ecc_sets.push_back(strand.second);
+            }
+            sequences[0] = received;
+            decode_batch(sequences, ecc_sets, engine);
+        }
+        return locked;
+    }
+
+    // Process a file (encode or decode)
+    //
+    // Streams the input through a bounded pipeline: this thread parses it
+    // into chunks of file_chunk_blocks blocks, one worker per hardware
+    // thread encodes or decodes them through encode_sequence() /
+    // decode_sequence(), and a writer thread writes them in input order,
+    // holding back chunks that finish early. Chunks are recycled from a
+    // fixed pool, so memory does not grow with the file. progress_callback
+    // is only ever called from the writer thread.
+    //
+    // Encode input is FASTA or plain text (whitespace is ignored), and each
+    // record is written as its '>' header line if any, one line per block
+    // of the strand and its ECC symbols in hex, then ";length=<bases>".
+    // Decode takes that back and writes the records, FASTA headers kept,
+    // at file_line_width bases per line. Blocks with invalid bases or too
+    // many errors are counted as uncorrectable and do not stop the run.
+    process_stats process_file(
+        const std::string& input_path,
+        const std::string& output_path,
+        bool encode_mode,
+        std::function<void(double, const std::string&)> progress_callback = nullptr
+    ) const;
+
+    // Get the code parameters
+    static constexpr std::size_t code_length() { return CodeLength; }
+    static constexpr std::size_t fec_length() { return FecLength; }
+    static constexpr std::size_t data_length() { return DataLength; }
+
+private:
+    // Pipeline unit of process_file(), part of a single record
+    struct file_chunk {
+        std::size_t index = 0;
+        bool first = false;                 // first chunk of its record
+        bool last = false;                  // last chunk, record_length is set
+        bool has_header = false;
+        std::string header;
+        std::string input;                  // encode: bases, decode: strands
+        std::vector<std::uint8_t> ecc;      // decode only
+        std::size_t length = 0;             // decode: bases to recover
+        std::size_t record_length = 0;
+        std::size_t input_end = 0;          // input bytes parsed up to this chunk
+        std::string output;
+        process_stats stats;
+
+        void reset(std::size_t chunk_index) {
+            index = chunk_index;
+            first = last = has_header = false;
+            header.clear();
+            input.clear();
+            ecc.clear();
+            length = record_length = input_end = 0;
+            output.clear();
+            stats = process_stats();
+        }
+    };
+
+    // Blocks per process_file() chunk, a multiple of file_line_width so
+    // that every chunk but a record's last ends on a whole output line
+    static constexpr std::size_t file_line_width = 60;
+    static constexpr std::size_t file_chunk_blocks = file_line_width * 64;
+
+    void encode_file_chunk(file_chunk& chunk, sequence_buffer& buffer) const {
+        encode_sequence(chunk.input, buffer);
+
+        chunk.output.reserve(buffer.blocks() * (CodeLength + FecLength + 2) + chunk.header.size() + 32);
+        if (chunk.first && chunk.has_header) {
+            chunk.output += '>';
+            chunk.output += chunk.header;
+            chunk.output += '\n';
+        }
+        for (std::size_t b = 0; b < buffer.blocks(); ++b) {
+            chunk.output.append(buffer.dna, b * CodeLength, CodeLength);
+            chunk.output += '\t';
+            for (std::size_t i = 0; i < FecLength; ++i) {
+                chunk.output += "0123456789ABCDEF"[buffer.ecc[b * FecLength + i] & 0x0F];
+            }
+            chunk.output += '\n';
+            if (buffer.status[b] == block_status::invalid) {
+                chunk.stats.record_uncorrectable();
+            } else {
+                ++chunk.stats.processed_chunks;
+            }
+        }
+        if (chunk.last) {
+            chunk.output += ";length=" + std::to_string(chunk.record_length) + "\n";
+        }
+        chunk.stats.total_chunks += buffer.blocks();
+    }
+
+    void decode_file_chunk(file_chunk& chunk, sequence_buffer& buffer, decode_counters& counters) const {
+        decode_sequence(chunk.input, schifra::utils::span<const std::uint8_t>(chunk.ecc.data(), chunk.ecc.size()),
+                        chunk.length, buffer, batch_engine::simd, counters, &chunk.stats);
+
+        chunk.output.reserve(buffer.dna.size() + buffer.dna.size() / file_line_width + chunk.header.size() + 4);
+        if (chunk.first && chunk.has_header) {
+            chunk.output += '>';
+            chunk.output += chunk.header;
+            chunk.output += '\n';
+        }
+        for (std::size_t i = 0; i < buffer.dna.size(); i += file_line_width) {
+            chunk.output.append(buffer.dna, i, file_line_width);
+            chunk.output += '\n';
+        }
+        chunk.stats.total_chunks += buffer.blocks();
+    }
+
+    // Body of decode_strands_oriented() over blocks reads, read order[i]
+    // (or i without order) at index i, into out sized for every read
+    std::size_t decode_oriented(std::string_view reads, const std::uint32_t* order, std::size_t blocks,
+                                sequence_buffer& out, batch_engine engine, decode_counters& counted) const {
+        std::size_t decoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            // Lane l holds read order[first + l] forward, lane lanes + l reversed
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+            const std::size_t both = 2 * lanes;
+
+            out.planar_.resize(CodeLength * both);
+            out.planar_out_.resize(FecLength * both);
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = order ? order[first + l] : first + l;
+                const char* read = reads.data() + b * strand_length();
+
+                char reverse_bases[2 * CodeLength];
+                std::uint8_t forward[CodeLength] = {};
+                std::uint8_t reverse[CodeLength] = {};
+                schifra::utils::dna::reverse_complement(read, strand_length(), reverse_bases);
+                if (!read_strand(read, forward) || !read_strand(reverse_bases, reverse)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(forward, forward + CodeLength, std::uint8_t(0));
+                    std::fill(reverse, reverse + CodeLength, std::uint8_t(0));
+                }
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    out.planar_[i * both + l] = forward[i];
+                    out.planar_[i * both + lanes + l] = reverse[i];
+                }
+            }
+
+            if (engine == batch_engine::bitsliced) {
+                bitsliced_codec_type::syndrome(out.planar_.data(), out.planar_out_.data(), both);
+            } else {
+                batch_codec_->syndrome(out.planar_.data(), out.planar_out_.data(), both);
+            }
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = order ? order[first + l] : first + l;
+                char* data = &out.dna[b * strand_data_length()];
+
+                if (out.status[b] == block_status::invalid) {
+                    out.orientation[b] = strand_orientation::unknown;
+                    std::fill(data, data + strand_data_length(), 'N');
+                    continue;
+                }
+
+                std::uint8_t forward[CodeLength];
+                std::uint8_t reverse[CodeLength];
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    forward[i] = out.planar_[i * both + l];
+                    reverse[i] = out.planar_[i * both + lanes + l];
+                }
+
+                bool forward_clean = true;
+                bool reverse_clean = true;
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    forward_clean = forward_clean && (0 == out.planar_out_[i * both + l]);
+                    reverse_clean = reverse_clean && (0 == out.planar_out_[i * both + lanes + l]);
+                }
+
+                const codec_result result = decode_either(forward, reverse, forward_clean, reverse_clean, out.orientation[b]);
+                if (forward_clean || reverse_clean) {
+                    if (result) {
+                        ++counted.syndrome_clean;
+                        ++decoded;
+                    } else {
+                        out.status[b] = block_status::uncorrectable;
+                    }
+                } else {
+                    ++counted.corrected;
+                    if (result) {
+                        out.status[b] = block_status::corrected;
+                        ++decoded;
+                    } else {
+                        out.status[b] = block_status::uncorrectable;
+                    }
+                }
+                symbols_to_strand((out.orientation[b] == strand_orientation::reverse) ? reverse : forward, DataLength, data);
+            }
+        }
+
+        return decoded;
+    }
+
+    // Encode the first used lanes of the planar batch in out, laid out at a
+    // stride of lanes, after closing the rows up to a stride of used
+    void encode_planar(sequence_buffer& out, std::size_t lanes, std::size_t used, batch_engine engine) const {
+        if (used == 0) {
+            return;
+        }
+        if (used < lanes) {
+            for (std::size_t i = 1; i < DataLength; ++i) {
+                std::memmove(&out.planar_[i * used], &out.planar_[i * lanes], used);
+            }
+        }
+
+        if (engine == batch_engine::bitsliced) {
+            bitsliced_codec_type::encode(out.planar_.data(), out.planar_out_.data(), used);
+        } else if (!batch_codec_->encode(out.planar_.data(), out.planar_out_.data(), used)) {
+            throw std::runtime_error("Reed-Solomon encoding failed");
+        }
+    }
+
+    // Candidates [first, last) of one read of decode_ragged_reads(), lanes
+    // of the planar batch in out at a stride of used. The clean candidates,
+    // else those the decoder corrects with the fewest symbols, must agree
+    // on their data, which is written to data. status is set; when no
+    // candidate decodes the first one's data is written as read. Returns
+    // true when the read decoded.
+    bool resolve_candidates(const sequence_buffer& out, std::size_t used, std::size_t first, std::size_t last,
+                            std::size_t dirty, char* data, block_status& status, decode_counters& counted) const {
+        std::uint8_t codeword[CodeLength];
+        std::uint8_t best[CodeLength];
+        bool found = false;
+        bool ambiguous = false;
+
+        for (std::size_t c = first; c < last; ++c) {
+            bool clean = true;
+            for (std::size_t i = 0; (dirty != 0) && (i < FecLength); ++i) {
+                clean = clean && (0 == out.planar_out_[i * used + c]);
+            }
+            if (!clean) {
+                continue;
+            }
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                codeword[i] = out.planar_[i * used + c];
+            }
+            ambiguous = ambiguous || (found && !std::equal(codeword, codeword + DataLength, best));
+            std::copy(codeword, codeword + CodeLength, best);
+            found = true;
+        }
+
+        if (found && !ambiguous) {
+            symbols_to_strand(best, DataLength, data);
+            ++counted.syndrome_clean;
+            return true;
+        }
+
+        ++counted.corrected;
+
+        std::size_t best_corrected = FecLength + 1;
+
+        for (std::size_t c = first; (c < last) && !found; ++c) {
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                codeword[i] = out.planar_[i * used + c];
+            }
+            const codec_result result = try_decode(schifra::utils::span<std::uint8_t>(codeword, CodeLength));
+            if (result && (result.errors_corrected < best_corrected)) {
+                best_corrected = result.errors_corrected;
+                ambiguous = false;
+                std::copy(codeword, codeword + CodeLength, best);
+            } else if (result && (result.errors_corrected == best_corrected)) {
+                ambiguous = ambiguous || !std::equal(codeword, codeword + DataLength, best);
+            }
+        }
+
+        if (found || ambiguous || (best_corrected > FecLength)) {
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                best[i] = out.planar_[i * used + first];
+            }
+            symbols_to_strand(best, DataLength, data);
+            status = block_status::uncorrectable;
+            return false;
+        }
+
+        symbols_to_strand(best, DataLength, data);
+        status = block_status::corrected;
+
+        return true;
+    }
+
+    // Candidates [first, last) of one read of resynchronize(): clean
+    // candidates agreeing on their data win, else the candidate with the
+    // fewest non-zero syndromes is the only one decoded. Writes codeword
+    // and returns true when it holds.
+    bool resync_candidates(const sequence_buffer& out, std::size_t used, std::size_t first, std::size_t last,
+                           std::size_t dirty, std::uint8_t* codeword) const {
+        std::size_t best = last;
+        std::size_t best_weight = FecLength + 1;
+        bool ambiguous = false;
+
+        for (std::size_t c = first; c < last; ++c) {
+            std::size_t weight = 0;
+            for (std::size_t i = 0; (dirty != 0) && (i < FecLength); ++i) {
+                weight += (0 != out.planar_out_[i * used + c]) ? 1 : 0;
+            }
+            if (weight < best_weight) {
+                best = c;
+                best_weight = weight;
+            } else if ((weight == 0) && (best_weight == 0)) {
+                for (std::size_t i = 0; (i < DataLength) && !ambiguous; ++i) {
+                    ambiguous = (out.planar_[i * used + c] != out.planar_[i * used + best]);
+                }
+            }
+        }
+
+        if ((best == last) || ambiguous) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            codeword[i] = out.planar_[i * used + best];
+        }
+
+        return (best_weight == 0) || static_cast<bool>(try_decode(schifra::utils::span<std::uint8_t>(codeword, CodeLength)));
+    }
+
+    // Syndromes of the first used lanes of the planar codewords in out,
+    // laid out at a stride of lanes, after closing the rows up to a stride
+    // of used. Returns the number of lanes with a non-zero syndrome.
+    std::size_t syndrome_planar(sequence_buffer& out, std::size_t lanes, std::size_t used, batch_engine engine) const {
+        if (used == 0) {
+            return 0;
+        }
+        if (used < lanes) {
+            for (std::size_t i = 1; i < CodeLength; ++i) {
+                std::memmove(&out.planar_[i * used], &out.planar_[i * lanes], used);
+            }
+        }
+
+        return (engine == batch_engine::bitsliced) ?
+            bitsliced_codec_type::syndrome(out.planar_.data(), out.planar_out_.data(), used) :
+            batch_codec_->syndrome(out.planar_.data(), out.planar_out_.data(), used);
+    }
+
+    // True when the count symbols are all zero, ie: 'A' bases, whose
+    // parity and syndromes are zero. ORs 8 symbols at a time.
+    static bool all_zero(const std::uint8_t* symbols, std::size_t count) noexcept {
+        std::uint64_t bits = 0;
+        std::size_t i = 0;
+        for (; i + sizeof(bits) <= count; i += sizeof(bits)) {
+            std::uint64_t word;
+            std::memcpy(&word, symbols + i, sizeof(word));
+            bits |= word;
+        }
+        for (; i < count; ++i) {
+            bits |= symbols[i];
+        }
+        return bits == 0;
+    }
+
+    // Strand of encode_sequence(): the data symbols as bases, then the ECC
+    // symbols mod 4
+    static void write_sequence_block(const std::uint8_t* symbols, const std::uint8_t* ecc, char* strand) {
+        for (std::size_t i = 0; i < DataLength; ++i) {
+            strand[i] = schifra::utils::dna::symbol_to_base(symbols[i]);
+        }
+        for (std::size_t i = 0; i < FecLength; ++i) {
+            strand[DataLength + i] = schifra::utils::dna::symbol_to_base(ecc[i] % 4);
+        }
+    }
+
+    // Body of encode_batch(), data and parity being planar scratch of
+    // DataLength and FecLength symbols per sequence and result sized to
+    // the sequences
+    template <typename Sequences, typename Buffer, typename Result>
+    void encode_batch_into(const Sequences& dna_sequences, Buffer& data, Buffer& parity, Result& result,
+                           batch_engine engine) const {
+        const std::size_t lanes = dna_sequences.size();
+
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const std::string_view dna_sequence(dna_sequences[l]);
+            std::uint8_t symbols[DataLength];
+            check_bases(dna_sequence, convert_bases(dna_sequence, symbols), l);
+            if (dna_sequence.length() != DataLength) {
+                throw std::invalid_argument("DNA sequence length must be exactly " + std::to_string(DataLength) + " characters");
+            }
+            for (std::size_t i = 0; i < DataLength; ++i) {
+                data[i * lanes + l] = symbols[i];
+            }
+        }
+
+        if (engine == batch_engine::bitsliced) {
+            bitsliced_codec_type::encode(data.data(), parity.data(), lanes);
+        } else if (!batch_codec_->encode(data.data(), parity.data(), lanes)) {
+            throw std::runtime_error("Reed-Solomon encoding failed");
+        }
+
+        for (std::size_t l = 0; l < lanes; ++l) {
+            auto& encoded_dna = result[l].first;
+            auto& ecc_symbols = result[l].second;
+            encoded_dna.reserve(CodeLength);
+            encoded_dna.assign(dna_sequences[l].data(), DataLength);
+            ecc_symbols.resize(FecLength);
+            for (std::size_t i = 0; i < FecLength; ++i) {
+                ecc_symbols[i] = parity[i * lanes + l];
+                encoded_dna += schifra::utils::dna::symbol_to_base(ecc_symbols[i] % 4);
+            }
+        }
+    }
+
+    // Body of decode_batch(), codewords and syndromes being planar scratch
+    // of CodeLength and FecLength symbols per sequence and result sized to
+    // the sequences
+    template <typename Sequences, typename EccSets, typename Buffer, typename Result>
+    void decode_batch_into(const Sequences& dna_sequences, const EccSets& ecc_symbols, Buffer& codewords, Buffer& syndromes,
+                           Result& result, batch_engine engine) const {
+        if (dna_sequences.size() != ecc_symbols.size()) {
+            throw std::invalid_argument("Number of DNA sequences and ECC symbol sets must match");
+        }
+
+        const std::size_t lanes = dna_sequences.size();
+
+        for (std::size_t l = 0; l < lanes; ++l) {
+            const std::string_view dna_sequence(dna_sequences[l]);
+            std::uint8_t symbols[DataLength];
+            check_bases(dna_sequence, convert_bases(dna_sequence, symbols), l);
+            if (dna_sequence.length() != CodeLength) {
+                throw std::invalid_argument("DNA sequence length must be exactly " + std::to_string(CodeLength) + " characters");
+            }
+            if (ecc_symbols[l].size() != FecLength) {
+                throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(FecLength) + " symbols");
+            }
+            for (std::size_t i = 0; i < DataLength; ++i) {
+                codewords[i * lanes + l] = symbols[i];
+            }
+            for (std::size_t i = 0; i < FecLength; ++i) {
+                codewords[(DataLength + i) * lanes + l] = ecc_symbols[l][i];
+            }
+        }
+
+        const std::size_t dirty = (engine == batch_engine::bitsliced) ?
+            bitsliced_codec_type::syndrome(codewords.data(), syndromes.data(), lanes) :
+            batch_codec_->syndrome(codewords.data(), syndromes.data(), lanes);
+
+        decode_counters counted;
+        for (std::size_t l = 0; l < lanes; ++l) {
+            bool clean = true;
+            for (std::size_t i = 0; (dirty != 0) && (i < FecLength); ++i) {
+                clean = clean && (0 == syndromes[i * lanes + l]);
+            }
+
+            result[l].resize(DataLength);
+            if (clean) {
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    result[l][i] = schifra::utils::dna::symbol_to_base(codewords[i * lanes + l]);
+                }
+                ++counted.syndrome_clean;
+            } else {
+                const codec_result status = try_decode(dna_sequences[l], ecc_symbols[l].data(), &result[l][0]);
+                if (!status) {
+                    throw_codec_error(status, CodeLength, "decoding");
+                }
+                ++counted.corrected;
+            }
+        }
+
+        add_counters(counted);
+    }
+
+    // try_encode() of length data bases, the rest of the block being
+    // virtual zero padding
+    codec_result encode_data(std::string_view dna_sequence, std::size_t length, char* encoded, std::uint8_t* ecc) const noexcept {
+        codec_result result;
+        std::uint8_t symbols[DataLength];
+        const std::size_t invalid = convert_bases(dna_sequence, symbols);
+        if (dna_sequence.empty() || (invalid != dna_sequence.size())) {
+            result.status = codec_status::invalid_base;
+            result.invalid_offset = invalid;
+            return result;
+        }
+        if ((dna_sequence.size() != length) || (length > DataLength)) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+
+        block_type block;
+        for (std::size_t i = 0; i < length; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(symbols[i]);
+        }
+        for (std::size_t i = length; i < CodeLength; ++i) {
+            block.data[i] = 0;
+        }
+        if (!encoder_->encode(block)) {
+            result.status = codec_status::codec_error;
+            result.error = block.error;
+            return result;
+        }
+
+        std::copy(dna_sequence.begin(), dna_sequence.end(), encoded);
+        for (std::size_t i = 0; i < FecLength; ++i) {
+            ecc[i] = static_cast<std::uint8_t>(block.data[DataLength + i]);
+            encoded[length + i] = schifra::utils::dna::symbol_to_base(ecc[i] % 4);
+        }
+        return result;
+    }
+
+    // try_decode() of a strand of length data bases and FecLength ECC
+    // bases. A correction landing in the virtual padding means the block
+    // had more errors than the code corrects, and fails it.
+    codec_result decode_data(std::string_view dna_sequence, std::size_t length, const std::uint8_t* ecc, char* decoded) const noexcept {
+        codec_result result;
+        std::uint8_t symbols[DataLength];
+        const std::size_t invalid = convert_bases(dna_sequence, symbols);
+        if (dna_sequence.empty() || (invalid != dna_sequence.size())) {
+            result.status = codec_status::invalid_base;
+            result.invalid_offset = invalid;
+            return result;
+        }
+        if ((length > DataLength) || (dna_sequence.size() != length + FecLength)) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+
+        block_type block;
+        for (std::size_t i = 0; i < length; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(symbols[i]);
+        }
+        for (std::size_t i = length; i < DataLength; ++i) {
+            block.data[i] = 0;
+        }
+        for (std::size_t i = 0; i < FecLength; ++i) {
+            block.data[DataLength + i] = static_cast<schifra::galois::field_symbol>(ecc[i]);
+        }
+
+        bool decoded_ok = table_decoder_ ? table_decoder_->decode(block) : decoder_->decode(block);
+        if (decoded_ok && (block.error == block_type::e_no_error)) {
+            for (std::size_t i = length; i < DataLength; ++i) {
+                decoded_ok = decoded_ok && (block.data[i] == 0);
+            }
+            if (!decoded_ok) {
+                block.error = block_type::e_decoder_error1;
+            }
+        }
+        if (!decoded_ok) {
+            result.status = codec_status::codec_error;
+            result.error = (block.error != block_type::e_no_error) ? block.error : block_type::e_decoder_error0;
+            for (std::size_t i = 0; i < length; ++i) {
+                decoded[i] = schifra::utils::dna::symbol_to_base(symbols[i]);
+            }
+            return result;
+        }
+
+        result.errors_corrected = block.errors_corrected;
+        for (std::size_t i = 0; i < length; ++i) {
+            decoded[i] = schifra::utils::dna::symbol_to_base(static_cast<std::uint8_t>(block.data[i]));
+        }
+        return result;
+    }
+
+    // throw_codec_error() of try_encode_tail()/try_decode_tail()
+    [[noreturn]] static void throw_tail_error(const codec_result& result, const char* operation) {
+        if (result.status == codec_status::invalid_length) {
+            throw std::invalid_argument("DNA sequence tail must hold 1 to " + std::to_string(DataLength) + " data bases");
+        }
+        throw_codec_error(result, 0, operation);
+    }
+
+    // Throws what encode()/decode() throw for a failed try_encode() /
+    // try_decode(), length being the expected sequence length
+    [[noreturn]] static void throw_codec_error(const codec_result& result, std::size_t length, const char* operation) {
+        switch (result.status) {
+        case codec_status::invalid_base:
+            throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters (offset " +
+                                        std::to_string(result.invalid_offset) + ")");
+        case codec_status::invalid_length:
+            throw std::invalid_argument("DNA sequence length must be exactly " + std::to_string(length) + " characters");
+        default:
+            throw std::runtime_error(std::string("Reed-Solomon ") + operation + " failed");
+        }
+    }
+
+    // Orientation of a read given its codeword both ways and whether their
+    // syndromes are zero, decoding (in place) only when neither is. The
+    // codeword of the orientation found holds the result. A read that is a
+    // codeword both ways, eg: all 'A' (zero) and all 'T', is unknown and a
+    // codec_error unless both carry the same data.
+    codec_result decode_either(std::uint8_t* forward, std::uint8_t* reverse, bool forward_clean, bool reverse_clean,
+                               strand_orientation& orientation) const noexcept {
+        codec_result result;
+        if (forward_clean && reverse_clean) {
+            if (std::equal(forward, forward + DataLength, reverse)) {
+                orientation = strand_orientation::forward;
+                return result;
+            }
+            orientation = strand_orientation::unknown;
+            result.status = codec_status::codec_error;
+            result.error = block_type::e_decoder_error0;
+            return result;
+        }
+        if (forward_clean) {
+            orientation = strand_orientation::forward;
+            return result;
+        }
+        if (reverse_clean) {
+            orientation = strand_orientation::reverse;
+            return result;
+        }
+
+        std::uint8_t reverse_decoded[CodeLength];
+        std::copy(reverse, reverse + CodeLength, reverse_decoded);
+
+        const codec_result forward_result = try_decode(schifra::utils::span<std::uint8_t>(forward, CodeLength));
+        const codec_result reverse_result = try_decode(schifra::utils::span<std::uint8_t>(reverse_decoded, CodeLength));
+
+        if (forward_result && (!reverse_result || (forward_result.errors_corrected < reverse_result.errors_corrected))) {
+            orientation = strand_orientation::forward;
+            return forward_result;
+        }
+        if (reverse_result && (!forward_result || (reverse_result.errors_corrected < forward_result.errors_corrected))) {
+            std::copy(reverse_decoded, reverse_decoded + CodeLength, reverse);
+            orientation = strand_orientation::reverse;
+            return reverse_result;
+        }
+
+        orientation = strand_orientation::unknown;
+        result.status = codec_status::codec_error;
+        result.error = forward_result ? block_type::e_decoder_error0 : forward_result.error;
+        return result;
+    }
+
+    // Consensus of the first count bases of read_count reads of length
+    // bases each, false (with result set) when there are no reads or one
+    // has the wrong length
+    static bool read_consensus(const std::string_view* reads, std::size_t read_count, const std::uint8_t* const* qualities,
+                               std::size_t length, std::size_t count, char* bases, std::uint16_t* margin,
+                               codec_result& result) noexcept {
+        std::uint16_t votes[4 * 2 * CodeLength] = {};
+        if (read_count == 0) {
+            result.status = codec_status::invalid_length;
+            return false;
+        }
+        for (std::size_t r = 0; r < read_count; ++r) {
+            if (reads[r].size() != length) {
+                result.status = codec_status::invalid_length;
+                return false;
+            }
+            schifra::utils::dna::add_votes(reads[r].data(), qualities ? qualities[r] : nullptr, count, votes);
+        }
+        schifra::utils::dna::call_consensus(votes, count, bases, margin);
+        return true;
+    }
+
+    // Decode a consensus block, the symbols among the first count whose
+    // margin is below min_margin being erasures (the lowest margins, at
+    // most FecLength of them), and write its DataLength data symbols as
+    // symbol_bases bases each
+    codec_result decode_consensus(block_type& block, const std::uint16_t* margin, std::size_t count, std::uint16_t min_margin,
+                                  char* data, std::size_t data_symbols, std::size_t symbol_bases) const noexcept {
+        codec_result result;
+        schifra::reed_solomon::erasure_mask<CodeLength> erasures;
+        for (std::size_t e = 0; e < FecLength; ++e) {
+            std::size_t lowest = count;
+            for (std::size_t i = 0; i < count; ++i) {
+                if ((margin[i] < min_margin) && !erasures.test(i) && ((lowest == count) || (margin[i] < margin[lowest]))) {
+                    lowest = i;
+                }
+            }
+            if (lowest == count) {
+                break;
+            }
+            erasures.set(lowest);
+        }
+
+        std::uint8_t symbols[CodeLength];
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            symbols[i] = static_cast<std::uint8_t>(block.data[i]);
+        }
+
+        if (decoder_->decode(block, erasures)) {
+            result.errors_corrected = block.errors_corrected;
+            for (std::size_t i = 0; i < CodeLength; ++i) {
+                symbols[i] = static_cast<std::uint8_t>(block.data[i]);
+            }
+        } else {
+            result.status = codec_status::codec_error;
+            result.error = (block.error != block_type::e_no_error) ? block.error : block_type::e_decoder_error0;
+        }
+
+        if (symbol_bases == 1) {
+            for (std::size_t i = 0; i < data_symbols; ++i) {
+                data[i] = schifra::utils::dna::symbol_to_base(symbols[i]);
+            }
+        } else {
+            symbols_to_strand(symbols, data_symbols, data);
+        }
+        return result;
+    }
+
+    // count GF(2^4) symbols from 2 * count bases of an in-band strand,
+    // false if a base is not one of ACGTacgt. The 2 bit packed bases are
+    // the symbols as nibbles, low first, so both ways go through the
+    // packed form.
+    static bool strand_to_symbols(const char* bases, std::size_t count, std::uint8_t* symbols) noexcept {
+        std::uint8_t packed[(CodeLength + 1) / 2];
+        if (!schifra::utils::dna::pack_bases(bases, 2 * count, packed)) {
+            return false;
+        }
+        schifra::reed_solomon::bitio::unpack_symbols<4>(packed, symbols, count);
+        return true;
+    }
+
+    static void symbols_to_strand(const std::uint8_t* symbols, std::size_t count, char* bases) noexcept {
+        std::uint8_t packed[(CodeLength + 1) / 2];
+        schifra::reed_solomon::bitio::pack_symbols<4>(symbols, count, packed);
+        schifra::utils::dna::packed_dna_view(packed, 0, 2 * count).unpack(bases);
+    }
+
+    // strand_to_symbols() and symbols_to_strand() of whole strands through
+    // the constrained mapping, which rotates the packed form: one SWAR
+    // word per strand
+    bool read_strand(const char* bases, std::uint8_t* symbols) const noexcept {
+        std::uint8_t packed[(CodeLength + 1) / 2] = {};
+        if (!schifra::utils::dna::pack_bases(bases, strand_length(), packed)) {
+            return false;
+        }
+        if (constrained_) {
+            schifra::utils::dna::rotate_symbols(packed, strand_unmap_.data(), sizeof(packed), packed);
+        }
+        schifra::reed_solomon::bitio::unpack_symbols<4>(packed, symbols, CodeLength);
+        return true;
+    }
+
+    void write_strand(const std::uint8_t* symbols, char* bases) const noexcept {
+        std::uint8_t packed[(CodeLength + 1) / 2] = {};
+        schifra::reed_solomon::bitio::pack_symbols<4>(symbols, CodeLength, packed);
+        if (constrained_) {
+            schifra::utils::dna::rotate_symbols(packed, strand_map_.data(), sizeof(packed), packed);
+        }
+        schifra::utils::dna::packed_dna_view(packed, 0, strand_length()).unpack(bases);
+    }
+
+    // Symbol i of a strand read base by base, mapped back
+    std::uint8_t unmap_symbol(std::size_t i, std::uint8_t symbol) const noexcept {
+        return constrained_ ? schifra::utils::dna::rotate_symbol(symbol, (strand_unmap_[i / 2] >> (4 * (i % 2))) & 0x0F) : symbol;
+    }
+
+    // Convert DNA string to symbol vector
+    // Converts and validates the whole read in one pass (see
+    // schifra_dna_alphabet.hpp), which stops at the offending base
+    std::vector<std::uint8_t> dna_to_symbols(const std::string& dna_sequence) const {
+        std::vector<std::uint8_t> symbols(dna_sequence.size());
+
+        const std::size_t invalid = schifra::utils::dna::first_invalid_base(dna_sequence.data(), dna_sequence.size(), symbols.data());
+        if (invalid != dna_sequence.size()) {
+            throw std::runtime_error("Invalid DNA character: " + std::string(1, dna_sequence[invalid]));
+        }
+
+        return symbols;
+    }
+    
+    std::string symbols_to_dna(const std::vector<std::uint8_t>& symbols) const {
+        std::string dna_sequence(symbols.size(), 'A');
+
+        if (!schifra::utils::dna::symbols_to_bases(symbols.data(), symbols.size(), &dna_sequence[0])) {
+            for (std::uint8_t symbol : symbols) {
+                if (symbol > 3) {
+                    throw std::runtime_error("Invalid symbol value: " + std::to_string(symbol));
+                }
+            }
+        }
+
+        return dna_sequence;
+    }
+
+    // Validate the whole of bases, converting its first DataLength (or
+    // fewer) into symbols on the way, and return the offset of the first
+    // invalid base, or bases.size()
+    static std::size_t convert_bases(std::string_view bases, std::uint8_t* symbols) noexcept {
+        const std::size_t head = std::min(DataLength, bases.size());
+        const std::size_t invalid = schifra::utils::dna::first_invalid_base(bases.data(), head, symbols);
+        if (invalid != head) {
+            return invalid;
+        }
+        return head + schifra::utils::dna::first_invalid_base(bases.data() + head, bases.size() - head, nullptr);
+    }
+
+    // Throws for sequence l of a batch unless invalid, its convert_bases(),
+    // is the end of the sequence
+    static void check_bases(std::string_view dna_sequence, std::size_t invalid, std::size_t l) {
+        if (dna_sequence.empty() || (invalid != dna_sequence.size())) {
+            throw std::invalid_argument("Invalid DNA sequence: must contain only A, C, G, T characters (sequence " +
+                                        std::to_string(l) + ", offset " + std::to_string(invalid) + ")");
+        }
+    }
+
+    // CRC-32C of count upper case bases, see data_checksum()
+    static std::uint32_t checksum_bases(const char* bases, std::size_t count) {
+        static const schifra::crc32 crc_module(schifra::crc32::crc32c_key, 0xFFFFFFFF, schifra::crc32::e_hardware);
+        return static_cast<std::uint32_t>(crc_module.process(0xFFFFFFFF, reinterpret_cast<const unsigned char*>(bases), count) ^ 0xFFFFFFFF);
+    }
+
+    // Validate DNA string (only contains ACGTacgt)
+    bool validate_dna(const std::string& dna) const {
+        if (dna.empty()) {
+            return false;
+        }
+
+        return schifra::utils::dna::valid_bases(dna.data(), dna.size());
+    }
+    
+    // Peak resident set size of the process in bytes, 0 where unavailable
+    static std::size_t peak_resident_memory() {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+            return static_cast<std::size_t>(usage.ru_maxrss);         // bytes
+#else
+            return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    // Get current timestamp for logging
+    std::string get_timestamp() const {
+        auto now = std::chrono::system_clock::now();
+        auto in_time_t = std::chrono::system_clock::to_time_t(now);
+        
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
+        return ss.str();
+    }
+
+    // Galois field for Reed-Solomon operations (GF(2^4))
+    std::shared_ptr<const schifra::galois::field> field_;
+    schifra::reed_solomon::generator_cache::generator_ptr generator_;
+
+    // Persistent codec instances, built once in the constructor
+    std::unique_ptr<const encoder_type> encoder_;
+    std::unique_ptr<const decoder_type> decoder_;
+    std::unique_ptr<const batch_codec_type> batch_codec_;
+    std::unique_ptr<const table_decoder_type> table_decoder_;  // Only for decode_engine::table
+    std::unique_ptr<schifra::reed_solomon::parity_cache> parity_cache_;  // Only after set_parity_cache()
+
+    // Packed rotation key of the strands and its inverse, see set_constrained_mapping()
+    std::array<std::uint8_t, (CodeLength + 1) / 2> strand_map_{};
+    std::array<std::uint8_t, (CodeLength + 1) / 2> strand_unmap_{};
+    bool constrained_ = false;
+
+    // Behind a pointer so that the instance stays movable
+    struct atomic_counters {
+        std::atomic<std::size_t> crc_passed{0};
+        std::atomic<std::size_t> syndrome_clean{0};
+        std::atomic<std::size_t> corrected{0};
+        std::atomic<std::size_t> duplicate{0};
+        std::atomic<std::size_t> zero_block{0};
+        std::atomic<std::size_t> realigned{0};
+        std::atomic<std::size_t> resynchronized{0};
+        std::atomic<std::size_t> encoded_zero_block{0};
+        std::atomic<std::size_t> encoded_batched{0};
+    };
+    std::unique_ptr<atomic_counters> counters_ = std::make_unique<atomic_counters>();
+
+    void add_counters(const decode_counters& counted) const {
+        counters_->crc_passed.fetch_add(counted.crc_passed, std::memory_order_relaxed);
+        counters_->syndrome_clean.fetch_add(counted.syndrome_clean, std::memory_order_relaxed);
+        counters_->corrected.fetch_add(counted.corrected, std::memory_order_relaxed);
+        counters_->duplicate.fetch_add(counted.duplicate, std::memory_order_relaxed);
+        counters_->zero_block.fetch_add(counted.zero_block, std::memory_order_relaxed);
+        counters_->realigned.fetch_add(counted.realigned, std::memory_order_relaxed);
+        counters_->resynchronized.fetch_add(counted.resynchronized, std::memory_order_relaxed);
+    }
+
+    void add_counters(const encode_counters& counted) const {
+        counters_->encoded_zero_block.fetch_add(counted.zero_block, std::memory_order_relaxed);
+        counters_->encoded_batched.fetch_add(counted.batched, std::memory_order_relaxed);
+    }
+};
+
+template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength>
+typename dna_storage<CodeLength, FecLength, DataLength>::process_stats
+dna_storage<CodeLength, FecLength, DataLength>::process_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    bool encode_mode,
+    std::function<void(double, const std::string&)> progress_callback) const {
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+
+    std::ifstream input(input_path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Cannot open input file: " + input_path);
+    }
+    std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("Cannot open output file: " + output_path);
+    }
+
+    process_stats stats;
+    stats.status = "processing";
+    input.seekg(0, std::ios::end);
+    stats.input_size = static_cast<std::size_t>(input.tellg());
+    input.seekg(0, std::ios::beg);
+
+    const std::size_t hardware_threads = std::thread::hardware_concurrency();
+    const std::size_t threads = (hardware_threads > 0) ? hardware_threads : 1;
+    const std::string stage = encode_mode ? "Encoding" : "Decoding";
+
+    std::vector<file_chunk> chunks(2 * threads + 2);
+    schifra::utils::mpmc_ring<file_chunk*> free_chunks(chunks.size());
+    schifra::utils::mpmc_ring<file_chunk*> work(chunks.size());
+    schifra::utils::mpmc_ring<file_chunk*> done(chunks.size());
+    for (file_chunk& chunk : chunks) {
+        free_chunks.push(&chunk);
+    }
+
+    std::vector<decode_counters> worker_counters(threads);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            sequence_buffer buffer;
+            file_chunk* chunk = nullptr;
+            while (work.pop(chunk)) {
+                const clock::time_point chunk_start = clock::now();
+                try {
+                    if (encode_mode) {
+                        encode_file_chunk(*chunk, buffer);
+                    } else {
+                        decode_file_chunk(*chunk, buffer, worker_counters[t]);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                chunk->stats.codec_time += std::chrono::duration<double>(clock::now() - chunk_start).count();
+                done.push(chunk);
+            }
+        });
+    }
+
+    bool write_failed = false;
+
+    std::thread writer([&]() {
+        std::map<std::size_t, file_chunk*> pending;
+        std::size_t next = 0;
+        file_chunk* chunk = nullptr;
+        while (done.pop(chunk)) {
+            pending[chunk->index] = chunk;
+            while (!pending.empty() && (pending.begin()->first == next)) {
+                file_chunk* ready = pending.begin()->second;
+                pending.erase(pending.begin());
+                ++next;
+
+                const clock::time_point write_start = clock::now();
+                if (!output.write(ready->output.data(), static_cast<std::streamsize>(ready->output.size()))) {
+                    write_failed = true;
+                }
+                ready->stats.write_time += std::chrono::duration<double>(clock::now() - write_start).count();
+                ready->stats.output_size += ready->output.size();
+
+                stats.merge(ready->stats);
+                if (progress_callback) {
+                    progress_callback((stats.input_size > 0) ? static_cast<double>(ready->input_end) / stats.input_size : 1.0, stage);
+                }
+                free_chunks.push(ready);
+            }
+        }
+    });
+
+    // Parser state: the chunk being filled and the record it belongs to
+    std::size_t next_index = 0;
+    std::size_t consumed = 0;
+    file_chunk* current = nullptr;
+    bool in_record = false;
+    bool record_first = false;
+    bool record_has_header = false;
+    std::string record_header;
+    std::size_t record_bases = 0;
+
+    auto fill = [&]() {
+        if (!current) {
+            free_chunks.pop(current);
+            current->reset(next_index++);
+            current->first = record_first;
+            current->has_header = record_has_header;
+            current->header = record_header;
+            record_first = false;
+        }
+        return current;
+    };
+
+    auto submit = [&]() {
+        current->input_end = consumed;
+        work.push(current);
+        current = nullptr;
+    };
+
+    auto start_record = [&](const std::string& header, bool has_header) {
+        in_record = true;
+        record_first = true;
+        record_has_header = has_header;
+        record_header = header;
+        record_bases = 0;
+    };
+
+    // Parse time includes waits for a free chunk, ie: time the reader
+    // was held back by the workers or the writer
+    const clock::time_point parse_start = clock::now();
+    double parse_time = 0.0;
+
+    try {
+
+        if (encode_mode) {
+            // 0: sequence, 1: header line, 2: comment line
+            int mode = 0;
+            bool line_start = true;
+            std::string header;
+            std::vector<char> read_buffer(1 << 16);
+
+            auto finish_record = [&]() {
+                if (in_record) {
+                    fill()->last = true;
+                    current->record_length = record_bases;
+                    submit();
+                    in_record = false;
+                }
+            };
+
+            while (input) {
+                input.read(read_buffer.data(), static_cast<std::streamsize>(read_buffer.size()));
+                const std::size_t count = static_cast<std::size_t>(input.gcount());
+                for (std::size_t i = 0; i < count; ++i) {
+                    const char c = read_buffer[i];
+                    ++consumed;
+                    if (c == '\n') {
+                        if (mode == 1) {
+                            start_record(header, true);
+                        }
+                        mode = 0;
+                        line_start = true;
+                        continue;
+                    }
+                    if (line_start && (c == '>')) {
+                        finish_record();
+                        header.clear();
+                        mode = 1;
+                    } else if (line_start && (c == ';')) {
+                        mode = 2;
+                    } else if ((mode == 1) && (c != '\r')) {
+                        header += c;
+                    } else if ((mode == 0) && !std::isspace(static_cast<unsigned char>(c))) {
+                        if (!in_record) {
+                            start_record(std::string(), false);
+                        }
+                        fill()->input += c;
+                        ++record_bases;
+                        if (current->input.size() == file_chunk_blocks * DataLength) {
+                            submit();
+                        }
+                    }
+                    line_start = false;
+                }
+            }
+            if (mode == 1) {
+                start_record(header, true);
+            }
+            finish_record();
+        } else {
+            std::string line;
+            std::size_t record_blocks = 0;
+
+            auto malformed = [&](const std::string& reason) {
+                return std::runtime_error("Malformed encoded file " + input_path + ": " + reason);
+            };
+
+            while (std::getline(input, line)) {
+                consumed += line.size() + 1;
+                if (!line.empty() && (line.back() == '\r')) {
+                    line.pop_back();
+                }
+                if (line.empty()) {
+                    continue;
+                }
+                if (line[0] == '>') {
+                    if (in_record) {
+                        throw malformed("record without a length line");
+                    }
+                    start_record(line.substr(1), true);
+                    record_blocks = 0;
+                    continue;
+                }
+                if (line[0] == ';') {
+                    if (line.compare(0, 8, ";length=") != 0) {
+                        continue;
+                    }
+                    if (!in_record) {
+                        start_record(std::string(), false);
+                        record_blocks = 0;
+                    }
+                    const std::size_t length = static_cast<std::size_t>(std::stoull(line.substr(8)));
+                    if ((length > record_blocks * DataLength) || (length + DataLength <= record_blocks * DataLength)) {
+                        throw malformed("length " + std::to_string(length) + " does not match " +
+                                        std::to_string(record_blocks) + " blocks");
+                    }
+                    fill()->last = true;
+                    current->record_length = length;
+                    current->length = length - (record_blocks - current->input.size() / CodeLength) * DataLength;
+                    submit();
+                    in_record = false;
+                    continue;
+                }
+
+                const std::size_t ecc_start = line.find_first_not_of(" \t", CodeLength);
+                if ((line.size() < CodeLength) || (line.find_first_of(" \t") != CodeLength) ||
+                    (ecc_start == std::string::npos) || (line.size() - ecc_start != FecLength)) {
+                    throw malformed("expected " + std::to_string(CodeLength) + " bases and " +
+                                    std::to_string(FecLength) + " ECC digits, got '" + line.substr(0, 64) + "'");
+                }
+                if (!in_record) {
+                    start_record(std::string(), false);
+                    record_blocks = 0;
+                }
+                fill()->input.append(line, 0, CodeLength);
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    const unsigned char digit = static_cast<unsigned char>(line[ecc_start + i]);
+                    if (!std::isxdigit(digit)) {
+                        throw malformed("invalid ECC digit in '" + line + "'");
+                    }
+                    current->ecc.push_back(static_cast<std::uint8_t>(std::isdigit(digit) ? (digit - '0') : (std::toupper(digit) - 'A' + 10)));
+                }
+                ++record_blocks;
+                if (current->ecc.size() == file_chunk_blocks * FecLength) {
+                    current->length = file_chunk_blocks * DataLength;
+                    submit();
+                }
+            }
+            if (in_record) {
+                throw malformed("record without a length line");
+            }
+        }
+
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+
+    // A chunk left half filled by a parse error still has to go through,
+    // the writer releases chunks strictly in order
+    if (current) {
+        submit();
+    }
+
+    parse_time = std::chrono::duration<double>(clock::now() - parse_start).count();
+
+    work.close();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    done.close();
+    writer.join();
+
+    for (const decode_counters& c : worker_counters) {
+        add_counters(c);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (write_failed || !output.flush()) {
+        throw std::runtime_error("Failed writing output file: " + output_path);
+    }
+
+    stats.parse_time = parse_time;
+    stats.processing_time = std::chrono::duration<double>(clock::now() - start).count();
+    stats.status = "completed";
+    stats.update_peak_memory();
+    return stats;
+}
+
+#if defined(SCHIFRA_EXTERN_TEMPLATES)
+// Compiled into the schifra_dna_storage library, see src/dna_storage.cpp
+extern template class dna_storage<15, 4, 11>;
+#endif
 
 } // namespace schifra
 
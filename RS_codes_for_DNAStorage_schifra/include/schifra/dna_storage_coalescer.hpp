@@ -0,0 +1,269 @@
+#ifndef SCHIFRA_DNA_STORAGE_COALESCER_HPP
+#define SCHIFRA_DNA_STORAGE_COALESCER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace schifra {
+
+/**
+ * @class dna_request_coalescer
+ * @brief Gathers single block encode()/decode() requests of many threads
+ * into encode_batch()/decode_batch() calls.
+ *
+ * @tparam Storage The codec, eg: dna_storage<15,4,11>
+ *
+ * encode() and decode() queue a request and return at once with a future
+ * of what dna_storage::encode()/decode() would have returned or thrown. A
+ * flusher thread hands the queued requests to the batch kernels once
+ * max_batch of them are waiting, or once the oldest has waited window,
+ * and completes each future on its own. A window of zero sends whatever
+ * queued up while the previous batch ran, so batches only grow with the
+ * load and a lone request is not held back.
+ *
+ * A batch that throws, ie: one of its requests has an invalid base, a
+ * wrong length or too many errors, is retried one request at a time so
+ * that only the failing requests see the exception. Requests still queued
+ * when the coalescer is destroyed are completed first.
+ */
+template <typename Storage>
+class dna_request_coalescer {
+public:
+    typedef typename Storage::batch_engine batch_engine;
+    typedef std::pair<std::string, std::vector<std::uint8_t>> encoded_type;
+
+    explicit dna_request_coalescer(const Storage& storage,
+                                   std::chrono::microseconds window = std::chrono::microseconds(50),
+                                   std::size_t max_batch = 256,
+                                   batch_engine engine = batch_engine::simd)
+        : storage_(storage),
+          window_(std::max(window, std::chrono::microseconds(0))),
+          max_batch_(std::max<std::size_t>(max_batch, 1)),
+          engine_(engine) {
+        flusher_ = std::thread([this]() { run(); });
+    }
+
+    dna_request_coalescer(const dna_request_coalescer&) = delete;
+    dna_request_coalescer& operator=(const dna_request_coalescer&) = delete;
+
+    ~dna_request_coalescer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        flusher_.join();
+    }
+
+    // Queue the encode() of dna_sequence
+    std::future<encoded_type> encode(std::string dna_sequence) {
+        encode_request request;
+        request.dna_sequence = std::move(dna_sequence);
+        std::future<encoded_type> result = request.promise.get_future();
+        enqueue(encode_queue_, std::move(request));
+        return result;
+    }
+
+    // Queue the decode() of dna_sequence and its ECC symbols
+    std::future<std::string> decode(std::string dna_sequence, std::vector<std::uint8_t> ecc_symbols) {
+        decode_request request;
+        request.dna_sequence = std::move(dna_sequence);
+        request.ecc_symbols = std::move(ecc_symbols);
+        std::future<std::string> result = request.promise.get_future();
+        enqueue(decode_queue_, std::move(request));
+        return result;
+    }
+
+    // Requests queued and batch kernel calls made since construction, the
+    // average batch being their ratio
+    std::size_t requests() const { return requests_.load(std::memory_order_relaxed); }
+    std::size_t batches() const { return batches_.load(std::memory_order_relaxed); }
+
+    std::chrono::microseconds window() const { return window_; }
+    std::size_t max_batch() const { return max_batch_; }
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    struct encode_request {
+        std::string dna_sequence;
+        std::promise<encoded_type> promise;
+    };
+
+    struct decode_request {
+        std::string dna_sequence;
+        std::vector<std::uint8_t> ecc_symbols;
+        std::promise<std::string> promise;
+    };
+
+    // Requests waiting for a batch, oldest the arrival of the first
+    template <typename Request>
+    struct request_queue {
+        std::vector<Request> requests;
+        clock::time_point oldest;
+    };
+
+    template <typename Request>
+    void enqueue(request_queue<Request>& queue, Request&& request) {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                throw std::logic_error("dna_request_coalescer is shutting down");
+            }
+            if (queue.requests.empty()) {
+                queue.oldest = clock::now();
+                wake = true;
+            }
+            queue.requests.push_back(std::move(request));
+            wake = wake || (queue.requests.size() == max_batch_);
+        }
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        // The flusher only needs to hear of the first request of a batch,
+        // which starts its window, and of the one that fills it
+        if (wake) {
+            wake_.notify_one();
+        }
+    }
+
+    template <typename Request>
+    bool ready(const request_queue<Request>& queue, clock::time_point now) const {
+        return !queue.requests.empty() &&
+               ((queue.requests.size() >= max_batch_) || (now - queue.oldest >= window_));
+    }
+
+    void run() {
+        std::vector<encode_request> encodes;
+        std::vector<decode_request> decodes;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            const clock::time_point now = clock::now();
+            const bool encode_ready = ready(encode_queue_, now);
+            const bool decode_ready = ready(decode_queue_, now);
+
+            if (encode_ready || decode_ready || stop_) {
+                // Everything queued is taken, a backlog that built up while
+                // the last batches ran going out max_batch_ at a time
+                if (encode_ready || stop_) {
+                    encodes.swap(encode_queue_.requests);
+                }
+                if (decode_ready || stop_) {
+                    decodes.swap(decode_queue_.requests);
+                }
+                if (encodes.empty() && decodes.empty()) {
+                    return;  // Stopping with nothing left
+                }
+
+                lock.unlock();
+                for (std::size_t i = 0; i < encodes.size(); i += max_batch_) {
+                    flush_encodes(&encodes[i], std::min(max_batch_, encodes.size() - i));
+                }
+                for (std::size_t i = 0; i < decodes.size(); i += max_batch_) {
+                    flush_decodes(&decodes[i], std::min(max_batch_, decodes.size() - i));
+                }
+                encodes.clear();
+                decodes.clear();
+                lock.lock();
+                continue;
+            }
+
+            // Sleep until a window closes or a request arrives
+            clock::time_point deadline = clock::time_point::max();
+            if (!encode_queue_.requests.empty()) {
+                deadline = std::min(deadline, encode_queue_.oldest + window_);
+            }
+            if (!decode_queue_.requests.empty()) {
+                deadline = std::min(deadline, decode_queue_.oldest + window_);
+            }
+            if (deadline == clock::time_point::max()) {
+                wake_.wait(lock);
+            } else {
+                wake_.wait_until(lock, deadline);
+            }
+        }
+    }
+
+    void flush_encodes(encode_request* batch, std::size_t count) {
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        sequences_.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            sequences_.push_back(std::move(batch[i].dna_sequence));
+        }
+
+        try {
+            std::vector<encoded_type> encoded = storage_.encode_batch(sequences_, engine_);
+            for (std::size_t i = 0; i < count; ++i) {
+                batch[i].promise.set_value(std::move(encoded[i]));
+            }
+        } catch (...) {
+            for (std::size_t i = 0; i < count; ++i) {
+                try {
+                    batch[i].promise.set_value(storage_.encode(sequences_[i]));
+                } catch (...) {
+                    batch[i].promise.set_exception(std::current_exception());
+                }
+            }
+        }
+    }
+
+    void flush_decodes(decode_request* batch, std::size_t count) {
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        sequences_.clear();
+        ecc_sets_.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            sequences_.push_back(std::move(batch[i].dna_sequence));
+            ecc_sets_.push_back(std::move(batch[i].ecc_symbols));
+        }
+
+        try {
+            std::vector<std::string> decoded = storage_.decode_batch(sequences_, ecc_sets_, engine_);
+            for (std::size_t i = 0; i < count; ++i) {
+                batch[i].promise.set_value(std::move(decoded[i]));
+            }
+        } catch (...) {
+            for (std::size_t i = 0; i < count; ++i) {
+                try {
+                    batch[i].promise.set_value(storage_.decode(sequences_[i], ecc_sets_[i]));
+                } catch (...) {
+                    batch[i].promise.set_exception(std::current_exception());
+                }
+            }
+        }
+    }
+
+    const Storage& storage_;
+    const std::chrono::microseconds window_;
+    const std::size_t max_batch_;
+    const batch_engine engine_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    request_queue<encode_request> encode_queue_;
+    request_queue<decode_request> decode_queue_;
+    bool stop_ = false;
+
+    // Flusher thread only, kept to reuse their capacity
+    std::vector<std::string> sequences_;
+    std::vector<std::vector<std::uint8_t>> ecc_sets_;
+
+    std::atomic<std::size_t> requests_{0};
+    std::atomic<std::size_t> batches_{0};
+    std::thread flusher_;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_STORAGE_COALESCER_HPP
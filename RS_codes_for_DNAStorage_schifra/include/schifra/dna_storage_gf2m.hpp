@@ -0,0 +1,499 @@
+#ifndef SCHIFRA_DNA_STORAGE_GF2M_HPP
+#define SCHIFRA_DNA_STORAGE_GF2M_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_fixed_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_gf256_batch.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+namespace schifra {
+
+// Field of a dna_storage_gf2m with SymbolBases bases per symbol, ie:
+// GF(2^(2 * SymbolBases)), and the first root of its generator polynomial
+template <std::size_t SymbolBases>
+struct dna_symbol_field;
+
+// GF(2^6), x^6 + x + 1
+template <>
+struct dna_symbol_field<3> {
+    static constexpr std::size_t generator_polynomial_index = 1;
+    static const unsigned int* primitive_polynomial() { return schifra::galois::primitive_polynomial03; }
+    static constexpr std::size_t primitive_polynomial_size = schifra::galois::primitive_polynomial_size03;
+};
+
+// GF(2^8), x^8 + x^7 + x^2 + x + 1, alpha^120 as in the Schifra GF(2^8) examples
+template <>
+struct dna_symbol_field<4> {
+    static constexpr std::size_t generator_polynomial_index = 120;
+    static const unsigned int* primitive_polynomial() { return schifra::galois::primitive_polynomial06; }
+    static constexpr std::size_t primitive_polynomial_size = schifra::galois::primitive_polynomial_size06;
+};
+
+/**
+ * @class dna_storage_gf2m
+ * @brief dna_storage over GF(2^(2 * SymbolBases)): every symbol is
+ * SymbolBases bases.
+ *
+ * @tparam SymbolBases Bases per symbol, 3 for GF(2^6) or 4 for GF(2^8).
+ * @tparam CodeLength Total length of the Reed-Solomon code (n), at most
+ *         the field size (63 or 255).
+ * @tparam FecLength Length of the error correction code (n - k).
+ * @tparam DataLength Length of the data portion (k).
+ *
+ * A GF(2^4) code is limited to 15 symbols, ie: 30 bases of in-band strand.
+ * Wider symbols (low bits first: A=0 C=1 G=2 T=3) allow longer codes:
+ * RS(63,k) over GF(2^6) spans a 189 base oligo in one codeword, and with
+ * 4 bases per symbol a strand is exactly the 2 bit packed form of its
+ * symbols, up to RS(255,223). Shortened codes, eg: RS(40,32) for 160 base
+ * strands, run on the natural length encoder and decoder with a virtual
+ * zero prefix. Strands are always in-band: data and parity symbols are
+ * all carried as bases.
+ *
+ * Batch operations run on gf256_batch_codec, ie: on the region kernels
+ * (SSSE3/AVX2/AVX512/GFNI or NEON/SVE), whose nibble tables and affine
+ * matrices serve any field up to GF(2^8). As for dna_storage, every codec
+ * operation is const and one instance can serve any number of threads at
+ * once.
+ */
+template <std::size_t SymbolBases, std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength = CodeLength - FecLength>
+class dna_storage_gf2m {
+    typedef dna_symbol_field<SymbolBases> field_type;
+
+public:
+    // Bits per symbol and natural length of codes over the field
+    static constexpr std::size_t symbol_bits = 2 * SymbolBases;
+    static constexpr std::size_t natural_length = (std::size_t(1) << symbol_bits) - 1;
+
+private:
+    static_assert(CodeLength > FecLength, "CodeLength must be greater than FecLength");
+    static_assert(CodeLength - FecLength == DataLength, "CodeLength - FecLength must equal DataLength");
+    static_assert(CodeLength <= natural_length, "CodeLength must not exceed the field size");
+
+public:
+
+    // Reed-Solomon codec types for this code, shortened from the natural one.
+    // The encoder is compiled for the natural code when it is a fixed_code.
+    typedef typename schifra::reed_solomon::select_encoder<natural_length, FecLength>::type encoder_type;
+    typedef schifra::reed_solomon::decoder<natural_length, FecLength> decoder_type;
+    typedef schifra::reed_solomon::block<CodeLength, FecLength>       block_type;
+    typedef schifra::reed_solomon::gf256_batch_codec<CodeLength, FecLength> batch_codec_type;
+
+    // Outcome of the noexcept codec operations, as in dna_storage
+    //   ok             : done
+    //   invalid_base   : a base was not one of ACGTacgt
+    //   invalid_length : wrong strand, data or codeword length
+    //   codec_error    : the encoder or decoder failed, see error
+    enum class codec_status : std::uint8_t {
+        ok,
+        invalid_base,
+        invalid_length,
+        codec_error
+    };
+
+    struct codec_result {
+        codec_status status = codec_status::ok;
+        typename block_type::error_t error = block_type::e_no_error;
+        std::size_t errors_corrected = 0;
+
+        explicit operator bool() const noexcept { return status == codec_status::ok; }
+    };
+
+    // Outcome of one block of encode_strands()/decode_strands()
+    //   ok            : encoded, or decoded with zero syndromes
+    //   corrected     : decoded after correcting errors
+    //   uncorrectable : too many errors, data returned as read
+    //   invalid       : a base was not one of ACGTacgt, block output is 'N's
+    enum class block_status : std::uint8_t {
+        ok,
+        corrected,
+        uncorrectable,
+        invalid
+    };
+
+    // Caller owned output of encode_strands()/decode_strands(), meant to be
+    // reused across calls so that, once grown, no call allocates.
+    //   dna    : encode - the strands, strand_length() bases per block
+    //            decode - the recovered sequence, padding removed
+    //   status : one entry per block
+    struct sequence_buffer {
+        std::string dna;
+        std::vector<block_status> status;
+
+        std::size_t blocks() const { return status.size(); }
+
+        std::size_t count(block_status s) const {
+            return static_cast<std::size_t>(std::count(status.begin(), status.end(), s));
+        }
+
+    private:
+        friend class dna_storage_gf2m;
+
+        // Planar batch scratch, and the symbols corrected per block
+        std::vector<std::uint8_t> planar_;
+        std::vector<std::uint8_t> planar_out_;
+        std::vector<std::uint8_t> errata_;
+    };
+
+    // First consecutive root of the generator polynomial
+    static constexpr std::size_t generator_polynomial_index = field_type::generator_polynomial_index;
+
+    // Blocks per batch kernel call in encode_strands()/decode_strands()
+    static constexpr std::size_t sequence_batch_lanes = 2048;
+
+    static constexpr std::size_t symbol_bases = SymbolBases;
+
+    static constexpr std::size_t strand_length() { return symbol_bases * CodeLength; }
+    static constexpr std::size_t strand_data_length() { return symbol_bases * DataLength; }
+
+    // Constructor
+    //
+    // The field, generator polynomial and codecs are built once here and
+    // shared with every other instance through the field registry and the
+    // generator cache.
+    dna_storage_gf2m() {
+        field_ = schifra::galois::shared_field(
+            static_cast<int>(symbol_bits),
+            field_type::primitive_polynomial_size,
+            field_type::primitive_polynomial());
+
+        generator_ = schifra::reed_solomon::shared_generator(
+            *field_,
+            static_cast<unsigned int>(generator_polynomial_index),
+            FecLength);
+        if (!generator_) {
+            throw std::runtime_error("Failed to create sequential root generator");
+        }
+
+        encoder_ = std::make_unique<const encoder_type>(*field_, generator_);
+        decoder_ = std::make_unique<const decoder_type>(*field_, static_cast<unsigned int>(generator_polynomial_index));
+        batch_codec_ = std::make_unique<const batch_codec_type>(*field_, generator_->polynomial(), static_cast<unsigned int>(generator_polynomial_index));
+        if (!batch_codec_->valid()) {
+            throw std::runtime_error("Failed to create batch codec");
+        }
+    }
+
+    ~dna_storage_gf2m() = default;
+
+    // Movable, not copyable, see dna_storage
+    dna_storage_gf2m(const dna_storage_gf2m&) = delete;
+    dna_storage_gf2m& operator=(const dna_storage_gf2m&) = delete;
+    dna_storage_gf2m(dna_storage_gf2m&&) noexcept = default;
+    dna_storage_gf2m& operator=(dna_storage_gf2m&&) noexcept = default;
+
+    // Check the corrections of the algebraic decoder, as in dna_storage:
+    // decode_strand()/try_decode() report a block whose corrections leave a
+    // non-zero syndrome as uncorrectable (e_decoder_error5). Off by default.
+    // Not to be called while other threads use the instance.
+    void set_verify_corrections(bool enabled) {
+        auto decoder = std::make_unique<decoder_type>(*field_, static_cast<unsigned int>(generator_polynomial_index));
+        decoder->verify_corrections(enabled);
+        decoder_ = std::move(decoder);
+    }
+
+    // Encode DataLength symbols into FecLength parity symbols
+    codec_result try_encode(schifra::utils::span<const std::uint8_t> data, schifra::utils::span<std::uint8_t> parity) const noexcept {
+        codec_result result;
+        if ((data.size() != DataLength) || (parity.size() != FecLength)) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        if (!encoder_->encode(data, parity)) {
+            result.status = codec_status::codec_error;
+            result.error = block_type::e_encoder_error0;
+        }
+        return result;
+    }
+
+    // Decode a CodeLength symbol codeword in place, left untouched when it
+    // cannot be corrected
+    codec_result try_decode(schifra::utils::span<std::uint8_t> codeword) const noexcept {
+        codec_result result;
+        if (codeword.size() != CodeLength) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+
+        block_type block;
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            block.data[i] = static_cast<schifra::galois::field_symbol>(codeword[i]);
+        }
+        if (!decode_block(block)) {
+            result.status = codec_status::codec_error;
+            result.error = (block.error != block_type::e_no_error) ? block.error : block_type::e_decoder_error0;
+            return result;
+        }
+
+        result.errors_corrected = block.errors_corrected;
+        for (std::size_t i = 0; i < CodeLength; ++i) {
+            codeword[i] = static_cast<std::uint8_t>(block.data[i]);
+        }
+        return result;
+    }
+
+    // Encode strand_data_length() bases into a strand of strand_length()
+    codec_result encode_strand(std::string_view data, char* strand) const noexcept {
+        codec_result result;
+        if (data.size() != strand_data_length()) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        std::uint8_t symbols[CodeLength];
+        if (!strand_to_symbols(data.data(), strand_data_length(), symbols)) {
+            result.status = codec_status::invalid_base;
+            return result;
+        }
+        result = try_encode(schifra::utils::span<const std::uint8_t>(symbols, DataLength),
+                            schifra::utils::span<std::uint8_t>(symbols + DataLength, FecLength));
+        if (result) {
+            symbols_to_strand(symbols, CodeLength, strand);
+        }
+        return result;
+    }
+
+    // Decode a strand of strand_length() bases into strand_data_length()
+    // bases of data, as read when the strand cannot be corrected
+    codec_result decode_strand(std::string_view strand, char* data) const noexcept {
+        codec_result result;
+        if (strand.size() != strand_length()) {
+            result.status = codec_status::invalid_length;
+            return result;
+        }
+        std::uint8_t symbols[CodeLength];
+        if (!strand_to_symbols(strand.data(), strand_length(), symbols)) {
+            result.status = codec_status::invalid_base;
+            return result;
+        }
+        result = try_decode(schifra::utils::span<std::uint8_t>(symbols, CodeLength));
+        symbols_to_strand(symbols, DataLength, data);
+        return result;
+    }
+
+    // Split a sequence into blocks of strand_data_length() bases, the last
+    // padded with 'A's, and encode them sequence_batch_lanes at a time on
+    // the batch codec. out.dna receives strand_length() bases per block.
+    // Returns the number of blocks encoded.
+    std::size_t encode_strands(std::string_view dna_sequence, sequence_buffer& out) const {
+        const std::size_t blocks = (dna_sequence.size() + strand_data_length() - 1) / strand_data_length();
+
+        out.dna.resize(blocks * strand_length());
+        out.status.assign(blocks, block_status::ok);
+
+        std::size_t encoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(DataLength * lanes);
+            out.planar_out_.resize(FecLength * lanes);
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                const std::size_t offset = b * strand_data_length();
+                const std::size_t count = std::min(strand_data_length(), dna_sequence.size() - offset);
+
+                std::uint8_t symbols[DataLength];
+                bool valid = true;
+                if (count == strand_data_length()) {
+                    valid = strand_to_symbols(dna_sequence.data() + offset, count, symbols);
+                } else {
+                    char bases[symbol_bases * DataLength];
+                    std::copy(dna_sequence.data() + offset, dna_sequence.data() + offset + count, bases);
+                    std::fill(bases + count, bases + strand_data_length(), 'A');
+                    valid = strand_to_symbols(bases, strand_data_length(), symbols);
+                }
+                if (!valid) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(symbols, symbols + DataLength, std::uint8_t(0));
+                }
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    out.planar_[i * lanes + l] = symbols[i];
+                }
+            }
+
+            if (!batch_codec_->encode(out.planar_.data(), out.planar_out_.data(), lanes)) {
+                throw std::runtime_error("Reed-Solomon encoding failed");
+            }
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                char* strand = &out.dna[b * strand_length()];
+
+                if (out.status[b] == block_status::invalid) {
+                    std::fill(strand, strand + strand_length(), 'N');
+                    continue;
+                }
+
+                std::uint8_t symbols[CodeLength];
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    symbols[i] = out.planar_[i * lanes + l];
+                }
+                for (std::size_t i = 0; i < FecLength; ++i) {
+                    symbols[DataLength + i] = out.planar_out_[i * lanes + l];
+                }
+                symbols_to_strand(symbols, CodeLength, strand);
+                ++encoded;
+            }
+        }
+
+        return encoded;
+    }
+
+    // Decode the output of encode_strands(): strands is out.dna of the
+    // encode, and length the length of the original sequence, which out.dna
+    // is trimmed to. Blocks are decoded on the batch codec, which computes
+    // the syndromes of a whole batch at once and runs Berlekamp-Massey only
+    // for the blocks whose syndromes are not zero. Returns the number of
+    // blocks that decoded.
+    std::size_t decode_strands(std::string_view strands, std::size_t length, sequence_buffer& out) const {
+        const std::size_t blocks = strands.size() / strand_length();
+
+        if ((strands.size() % strand_length()) != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of " + std::to_string(strand_length()) + " characters");
+        }
+        if ((length > blocks * strand_data_length()) || (length + strand_data_length() <= blocks * strand_data_length())) {
+            throw std::invalid_argument("Sequence length does not match the number of blocks");
+        }
+
+        out.dna.resize(blocks * strand_data_length());
+        out.status.assign(blocks, block_status::ok);
+
+        std::size_t decoded = 0;
+
+        for (std::size_t first = 0; first < blocks; first += sequence_batch_lanes) {
+            const std::size_t lanes = std::min(sequence_batch_lanes, blocks - first);
+
+            out.planar_.resize(CodeLength * lanes);
+            out.errata_.resize(lanes);
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+
+                std::uint8_t symbols[CodeLength];
+                if (!strand_to_symbols(strands.data() + b * strand_length(), strand_length(), symbols)) {
+                    out.status[b] = block_status::invalid;
+                    std::fill(symbols, symbols + CodeLength, std::uint8_t(0));
+                }
+                for (std::size_t i = 0; i < CodeLength; ++i) {
+                    out.planar_[i * lanes + l] = symbols[i];
+                }
+            }
+
+            batch_codec_->decode(out.planar_.data(), lanes, schifra::reed_solomon::erasure_locations_t(), out.errata_.data());
+
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const std::size_t b = first + l;
+                char* data = &out.dna[b * strand_data_length()];
+
+                if (out.status[b] == block_status::invalid) {
+                    std::fill(data, data + strand_data_length(), 'N');
+                    continue;
+                }
+
+                if (out.errata_[l] == batch_codec_type::uncorrectable) {
+                    out.status[b] = block_status::uncorrectable;
+                } else {
+                    if (out.errata_[l] > 0) {
+                        out.status[b] = block_status::corrected;
+                    }
+                    ++decoded;
+                }
+
+                std::uint8_t codeword[DataLength];
+                for (std::size_t i = 0; i < DataLength; ++i) {
+                    codeword[i] = out.planar_[i * lanes + l];
+                }
+                symbols_to_strand(codeword, DataLength, data);
+            }
+        }
+
+        out.dna.resize(length);
+
+        return decoded;
+    }
+
+private:
+    // Natural blocks decode as such, shortened ones with the virtual zero
+    // prefix skipped by the decoder
+    bool decode_block(block_type& block) const noexcept {
+        if constexpr (CodeLength == natural_length) {
+            return decoder_->decode(block);
+        } else {
+            return decoder_->decode_shortened(block, schifra::reed_solomon::erasure_locations_t());
+        }
+    }
+
+    // count bases of a strand into count / SymbolBases symbols, false if a
+    // base is not one of ACGTacgt. 4 base symbols are the packed bases as they stand.
+    static bool strand_to_symbols(const char* bases, std::size_t count, std::uint8_t* symbols) noexcept {
+        if constexpr (SymbolBases == 4) {
+            return schifra::utils::dna::pack_bases(bases, count, symbols);
+        } else {
+            std::uint8_t digits[SymbolBases * CodeLength];
+            if (!schifra::utils::dna::bases_to_symbols(bases, count, digits)) {
+                return false;
+            }
+            for (std::size_t i = 0; i < count / SymbolBases; ++i) {
+                std::uint8_t s = 0;
+                for (std::size_t j = 0; j < SymbolBases; ++j) {
+                    s |= static_cast<std::uint8_t>(digits[SymbolBases * i + j] << (2 * j));
+                }
+                symbols[i] = s;
+            }
+            return true;
+        }
+    }
+
+    // count symbols as SymbolBases * count bases
+    static void symbols_to_strand(const std::uint8_t* symbols, std::size_t count, char* bases) noexcept {
+        if constexpr (SymbolBases == 4) {
+            schifra::utils::dna::packed_dna_view(symbols, 0, symbol_bases * count).unpack(bases);
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                for (std::size_t j = 0; j < SymbolBases; ++j) {
+                    bases[SymbolBases * i + j] = schifra::utils::dna::symbol_to_base(static_cast<std::uint8_t>(symbols[i] >> (2 * j)));
+                }
+            }
+        }
+    }
+
+    schifra::galois::field_registry::field_ptr field_;
+    schifra::reed_solomon::generator_cache::generator_ptr generator_;
+    std::unique_ptr<const encoder_type> encoder_;
+    std::unique_ptr<const decoder_type> decoder_;
+    std::unique_ptr<const batch_codec_type> batch_codec_;
+};
+
+// 3 bases per GF(2^6) symbol, codes up to RS(63,k)
+template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength = CodeLength - FecLength>
+using dna_storage_gf64 = dna_storage_gf2m<3, CodeLength, FecLength, DataLength>;
+
+// 4 bases per GF(2^8) symbol, codes up to RS(255,k)
+template <std::size_t CodeLength, std::size_t FecLength, std::size_t DataLength = CodeLength - FecLength>
+using dna_storage_gf256 = dna_storage_gf2m<4, CodeLength, FecLength, DataLength>;
+
+#if defined(SCHIFRA_EXTERN_TEMPLATES)
+// Compiled into the schifra_dna_storage library, see src/dna_storage.cpp
+extern template class dna_storage_gf2m<3, 63, 12, 51>;
+extern template class dna_storage_gf2m<4, 255, 32, 223>;
+#endif
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_STORAGE_GF2M_HPP
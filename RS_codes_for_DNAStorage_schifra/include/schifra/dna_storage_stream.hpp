@@ -0,0 +1,261 @@
+#ifndef SCHIFRA_DNA_STORAGE_STREAM_HPP
+#define SCHIFRA_DNA_STORAGE_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Schifra library includes
+#include "schifra/utils/schifra_span.hpp"
+
+namespace schifra {
+
+// Layout of a stream of dna_storage blocks
+//   sequence : encode_sequence()/decode_sequence(), CodeLength bases and
+//              FecLength ECC symbols per block
+//   strands  : encode_strands()/decode_strands(), in-band strands of
+//              strand_length() bases
+enum class dna_stream_format {
+    sequence,
+    strands
+};
+
+/**
+ * @class dna_stream_encoder
+ * @brief encode_sequence()/encode_strands() of a sequence of any length,
+ * given in pieces, in bounded memory.
+ *
+ * @tparam Storage The codec, eg: dna_storage<15,4,11>
+ *
+ * Bases written are gathered into a window of window_blocks blocks, and
+ * every full window is encoded and handed to the sink, which sees the
+ * window's sequence_buffer (strands, ECC symbols for the sequence format,
+ * and status) and must copy out what it keeps before returning. finish()
+ * encodes the last, partial window, its last block padded with 'A's as by
+ * encode_sequence(). The window and the codec's buffers are reused, so
+ * memory stays at about window_blocks blocks whatever the input length,
+ * and the output is that of one encode_sequence()/encode_strands() of the
+ * whole sequence, cut into windows.
+ */
+template <typename Storage>
+class dna_stream_encoder {
+public:
+    typedef typename Storage::sequence_buffer sequence_buffer;
+    typedef typename Storage::batch_engine batch_engine;
+    typedef std::function<void(const sequence_buffer& window)> sink_type;
+
+    dna_stream_encoder(const Storage& storage, sink_type sink,
+                       dna_stream_format format = dna_stream_format::sequence,
+                       std::size_t window_blocks = Storage::sequence_batch_lanes,
+                       batch_engine engine = batch_engine::simd)
+        : storage_(storage),
+          sink_(std::move(sink)),
+          format_(format),
+          engine_(engine),
+          block_bases_((format == dna_stream_format::sequence) ? Storage::data_length() : Storage::strand_data_length()),
+          window_bases_(std::max<std::size_t>(window_blocks, 1) * block_bases_) {
+        if (!sink_) {
+            throw std::invalid_argument("dna_stream_encoder needs a sink");
+        }
+        pending_.reserve(window_bases_);
+    }
+
+    // Append bases to the sequence, encoding every window that fills
+    void write(std::string_view bases) {
+        while (!bases.empty()) {
+            const std::size_t take = std::min(window_bases_ - pending_.size(), bases.size());
+            pending_.append(bases.data(), take);
+            bases.remove_prefix(take);
+            if (pending_.size() == window_bases_) {
+                flush();
+            }
+        }
+    }
+
+    // Encode what is left. The encoder may then start a new sequence.
+    void finish() {
+        if (!pending_.empty()) {
+            flush();
+        }
+    }
+
+    // Bases written and blocks handed to the sink, since construction
+    std::size_t bases() const { return bases_; }
+    std::size_t blocks() const { return blocks_; }
+
+    // Blocks encoded, ie: not invalid
+    std::size_t encoded() const { return encoded_; }
+
+private:
+    void flush() {
+        encoded_ += (format_ == dna_stream_format::sequence) ?
+            storage_.encode_sequence(pending_, out_, engine_) :
+            storage_.encode_strands(pending_, out_, engine_);
+        bases_ += pending_.size();
+        blocks_ += out_.blocks();
+        pending_.clear();
+        sink_(out_);
+    }
+
+    const Storage& storage_;
+    sink_type sink_;
+    dna_stream_format format_;
+    batch_engine engine_;
+    std::size_t block_bases_;
+    std::size_t window_bases_;
+    std::string pending_;
+    sequence_buffer out_;
+    std::size_t bases_ = 0;
+    std::size_t blocks_ = 0;
+    std::size_t encoded_ = 0;
+};
+
+/**
+ * @class dna_stream_decoder
+ * @brief decode_sequence()/decode_strands() of the output of a
+ * dna_stream_encoder, given in pieces, in bounded memory.
+ *
+ * @tparam Storage The codec, eg: dna_storage<15,4,11>
+ *
+ * Blocks written are decoded window_blocks at a time and each window's
+ * sequence_buffer (recovered bases and status) handed to the sink. The
+ * last block written is held back until finish(), which is given the
+ * length of the original sequence and trims the padding off it. With the
+ * sequence format every write() holds whole blocks, strands and their ECC
+ * symbols together; in-band strands may be cut anywhere.
+ */
+template <typename Storage>
+class dna_stream_decoder {
+public:
+    typedef typename Storage::sequence_buffer sequence_buffer;
+    typedef typename Storage::batch_engine batch_engine;
+    typedef std::function<void(const sequence_buffer& window)> sink_type;
+
+    dna_stream_decoder(const Storage& storage, sink_type sink,
+                       dna_stream_format format = dna_stream_format::sequence,
+                       std::size_t window_blocks = Storage::sequence_batch_lanes,
+                       batch_engine engine = batch_engine::simd)
+        : storage_(storage),
+          sink_(std::move(sink)),
+          format_(format),
+          engine_(engine),
+          window_blocks_(std::max<std::size_t>(window_blocks, 1)),
+          block_length_((format == dna_stream_format::sequence) ? Storage::code_length() : Storage::strand_length()),
+          block_bases_((format == dna_stream_format::sequence) ? Storage::data_length() : Storage::strand_data_length()) {
+        if (!sink_) {
+            throw std::invalid_argument("dna_stream_decoder needs a sink");
+        }
+        pending_.reserve((window_blocks_ + 1) * block_length_);
+        pending_ecc_.reserve((window_blocks_ + 1) * Storage::fec_length());
+    }
+
+    // Append in-band strands (strands format), cut anywhere
+    void write(std::string_view strands) {
+        if (format_ != dna_stream_format::strands) {
+            throw std::logic_error("The sequence format is written with its ECC symbols");
+        }
+        while (!strands.empty()) {
+            const std::size_t take = std::min(capacity() - pending_.size(), strands.size());
+            pending_.append(strands.data(), take);
+            strands.remove_prefix(take);
+            drain();
+        }
+    }
+
+    // Append whole blocks of strands and their ECC symbols (sequence format)
+    void write(std::string_view strands, schifra::utils::span<const std::uint8_t> ecc_symbols) {
+        if (format_ != dna_stream_format::sequence) {
+            throw std::logic_error("In-band strands carry no ECC symbols");
+        }
+        const std::size_t blocks = strands.size() / block_length_;
+        if ((strands.size() % block_length_) != 0) {
+            throw std::invalid_argument("Strands length must be a multiple of " + std::to_string(block_length_) + " characters");
+        }
+        if (ecc_symbols.size() != blocks * Storage::fec_length()) {
+            throw std::invalid_argument("ECC symbols length must be exactly " + std::to_string(Storage::fec_length()) + " symbols per block");
+        }
+
+        for (std::size_t b = 0; b < blocks;) {
+            const std::size_t take = std::min(capacity() / block_length_ - pending_blocks(), blocks - b);
+            pending_.append(strands.data() + b * block_length_, take * block_length_);
+            pending_ecc_.insert(pending_ecc_.end(),
+                                ecc_symbols.data() + b * Storage::fec_length(),
+                                ecc_symbols.data() + (b + take) * Storage::fec_length());
+            b += take;
+            drain();
+        }
+    }
+
+    // Decode what is left, length being the length of the whole original
+    // sequence. The decoder may then start a new sequence.
+    void finish(std::size_t length) {
+        if ((pending_.size() % block_length_) != 0) {
+            throw std::invalid_argument("Strands end inside a block");
+        }
+        const std::size_t blocks = pending_blocks();
+        if ((length < bases_) || (length - bases_ > blocks * block_bases_) ||
+            ((blocks > 0) && (length - bases_ <= (blocks - 1) * block_bases_))) {
+            throw std::invalid_argument("Sequence length does not match the number of blocks");
+        }
+        if (blocks > 0) {
+            decode(blocks, length - bases_);
+        }
+        bases_ = 0;
+    }
+
+    // Blocks handed to the sink and those of them that decoded, since
+    // construction
+    std::size_t blocks() const { return blocks_; }
+    std::size_t decoded() const { return decoded_; }
+
+private:
+    std::size_t capacity() const { return (window_blocks_ + 1) * block_length_; }
+    std::size_t pending_blocks() const { return pending_.size() / block_length_; }
+
+    // Decode whole windows while a block is left over for finish()
+    void drain() {
+        while (pending_blocks() > window_blocks_) {
+            decode(window_blocks_, window_blocks_ * block_bases_);
+        }
+    }
+
+    // Decode the first count pending blocks into length bases
+    void decode(std::size_t count, std::size_t length) {
+        const std::string_view strands(pending_.data(), count * block_length_);
+        if (format_ == dna_stream_format::sequence) {
+            decoded_ += storage_.decode_sequence(strands,
+                                                 schifra::utils::span<const std::uint8_t>(pending_ecc_.data(), count * Storage::fec_length()),
+                                                 length, out_, engine_);
+            pending_ecc_.erase(pending_ecc_.begin(), pending_ecc_.begin() + count * Storage::fec_length());
+        } else {
+            decoded_ += storage_.decode_strands(strands, length, out_, engine_);
+        }
+        pending_.erase(0, count * block_length_);
+        bases_ += length;
+        blocks_ += count;
+        sink_(out_);
+    }
+
+    const Storage& storage_;
+    sink_type sink_;
+    dna_stream_format format_;
+    batch_engine engine_;
+    std::size_t window_blocks_;
+    std::size_t block_length_;
+    std::size_t block_bases_;
+    std::string pending_;
+    std::vector<std::uint8_t> pending_ecc_;
+    sequence_buffer out_;
+    std::size_t bases_ = 0;    // of the current sequence
+    std::size_t blocks_ = 0;
+    std::size_t decoded_ = 0;
+};
+
+} // namespace schifra
+
+#endif // SCHIFRA_DNA_STORAGE_STREAM_HPP
@@ -0,0 +1,500 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_ADDITIVE_FFT_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_ADDITIVE_FFT_CODEC_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Systematic Reed-Solomon erasure codec for long codes over GF(2^m),
+         m <= 16, eg: outer codes across tens of thousands of oligos in the
+         compact GF(2^16) field, encoding and decoding in O(n log n) with
+         the additive FFT of Lin, Chung and Han over their novel polynomial
+         basis, rather than the O(n.fec) shift register encoder and the
+         O(n.t) Chien search of rs_codec.
+
+         The evaluation points are the field elements themselves, point i
+         being i in the polynomial basis. With m the smallest power of two
+         of at least fec_length, the parity occupies points 0 .. m - 1 and
+         the data points m .. m + data_length - 1, in cosets of m points.
+         Over the n points of the enclosing power of two domain the
+         codewords are the evaluations of the polynomials of degree below
+         n - m, an RS(n, n - m) code, shortened by the unused data points
+         (held at zero) and punctured to its first fec_length parity
+         symbols, so it remains MDS: any fec_length erasures are
+         recoverable.
+
+            encode : parity = FFT(sum over data cosets of IFFT(coset))
+            decode : with L(x) the erasure locator, L(x).C(x) is
+                     interpolated from the surviving symbols, formally
+                     differentiated, and the erasures read off as
+                     (L.C)'(x) / L'(x). L is evaluated everywhere at once
+                     in the log domain, as a Walsh-Hadamard convolution of
+                     the erasure pattern with the log table.
+
+         Codewords are data_length() data symbols followed by fec_length()
+         parity symbols. Unlike rs_codec only erasures are corrected, there
+         is no error location.
+
+         Note: The codec is invalid unless m.(1 + ceil(data_length / m))
+               points fit in the field, eg: in GF(2^16) 4000 parity symbols
+               (m = 4096) leave room for up to 61440 data symbols.
+      */
+      class additive_fft_codec
+      {
+      public:
+
+         typedef std::uint16_t symbol_type;
+
+         additive_fft_codec(const galois::field& field,
+                            const std::size_t data_length,
+                            const std::size_t fec_length)
+         : field_(field),
+           data_length_(data_length),
+           fec_length_(fec_length),
+           chunk_length_(1),
+           domain_length_(1),
+           modulus_(field.size()),
+           valid_(false)
+         {
+            if ((0 == data_length) || (0 == fec_length) || (field.pwr() > 16))
+               return;
+
+            while (chunk_length_ < fec_length_)
+            {
+               chunk_length_ <<= 1;
+            }
+
+            const std::size_t chunks = 1 + (data_length_ + chunk_length_ - 1) / chunk_length_;
+
+            while (domain_length_ < (chunks * chunk_length_))
+            {
+               domain_length_ <<= 1;
+            }
+
+            if (domain_length_ > (static_cast<std::size_t>(field.size()) + 1))
+               return;
+
+            create_tables();
+
+            valid_ = true;
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline const galois::field& field() const { return field_;                      }
+         inline std::size_t code_length()    const { return data_length_ + fec_length_;  }
+         inline std::size_t data_length()    const { return data_length_;                }
+         inline std::size_t fec_length()     const { return fec_length_;                 }
+
+         /* Transform size of the encoder, the parity rounded up to a power of two */
+         inline std::size_t chunk_length()   const { return chunk_length_;               }
+
+         /* Transform size of the decoder */
+         inline std::size_t domain_length()  const { return domain_length_;              }
+
+         /*
+            Write the fec_length parity symbols of data to parity. data may
+            be shorter than data_length(), the missing trailing symbols
+            being zero.
+         */
+         bool encode(const utils::span<const symbol_type>& data, const utils::span<symbol_type>& parity) const
+         {
+            if (!valid_ || data.empty() || (data.size() > data_length_) || (parity.size() != fec_length_))
+               return false;
+
+            workspace& ws = thread_workspace();
+
+            const std::size_t m    = chunk_length_;
+            const symbol_type mask = static_cast<symbol_type>(field_.mask());
+
+            ws.accumulator.assign(m, 0);
+            ws.work.resize(m);
+
+            for (std::size_t offset = 0; offset < data.size(); offset += m)
+            {
+               const std::size_t count = std::min(m, data.size() - offset);
+
+               for (std::size_t i = 0; i < count; ++i)
+               {
+                  ws.work[i] = data[offset + i] & mask;
+               }
+
+               std::fill(ws.work.begin() + count, ws.work.end(), symbol_type(0));
+
+               ifft(ws.work.data(), m, m + offset);
+
+               for (std::size_t i = 0; i < m; ++i)
+               {
+                  ws.accumulator[i] ^= ws.work[i];
+               }
+            }
+
+            fft(ws.accumulator.data(), m, 0);
+
+            std::copy(ws.accumulator.begin(), ws.accumulator.begin() + fec_length_, parity.begin());
+
+            return true;
+         }
+
+         /*
+            Rebuild the erased symbols of a codeword of code_length()
+            symbols in place, erasure positions being codeword indices.
+            Returns false, leaving the codeword untouched, when there are
+            more than fec_length() erasures or one is out of range.
+
+            Note: Erasure positions must be unique.
+         */
+         bool decode(const utils::span<symbol_type>& codeword, const erasure_locations_t& erasures) const
+         {
+            if (!valid_ || (codeword.size() != code_length()) || (erasures.size() > fec_length_))
+               return false;
+            else if (erasures.empty())
+               return true;
+
+            workspace& ws = thread_workspace();
+
+            const std::size_t n    = domain_length_;
+            const std::size_t m    = chunk_length_;
+            const symbol_type mask = static_cast<symbol_type>(field_.mask());
+
+            /* Erasure pattern over the domain, the punctured parity included */
+            std::vector<unsigned int>& locator = ws.locator;
+
+            locator.assign(n, 0);
+
+            std::fill(locator.begin() + fec_length_, locator.begin() + m, 1u);
+
+            for (std::size_t i = 0; i < erasures.size(); ++i)
+            {
+               if (erasures[i] >= code_length())
+                  return false;
+
+               locator[point(erasures[i])] = 1;
+            }
+
+            /*
+               log L(i) at the surviving points, log L'(i) at the erased
+               ones: sum over erasures e of log(i + e), log(0) taken as 0.
+            */
+            walsh_hadamard(locator.data(), n);
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               locator[i] = static_cast<unsigned int>((static_cast<unsigned long long>(locator[i]) * log_walsh_[i]) % modulus_);
+            }
+
+            walsh_hadamard(locator.data(), n);
+
+            /* L.C at every point, zero at the erasures */
+            std::vector<symbol_type>& work = ws.work;
+
+            work.assign(n, 0);
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               work[i] = codeword[data_length_ + i] & mask;
+            }
+
+            for (std::size_t i = 0; i < data_length_; ++i)
+            {
+               work[m + i] = codeword[i] & mask;
+            }
+
+            for (std::size_t i = 0; i < erasures.size(); ++i)
+            {
+               work[point(erasures[i])] = 0;
+            }
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               work[i] = mul_log(work[i], locator[i]);
+            }
+
+            ifft(work.data(), n, 0);
+
+            formal_derivative(work.data(), n);
+
+            fft(work.data(), n, 0);
+
+            for (std::size_t i = 0; i < erasures.size(); ++i)
+            {
+               const std::size_t p = point(erasures[i]);
+
+               codeword[erasures[i]] = mul_log(work[p], (modulus_ - locator[p]) % modulus_);
+            }
+
+            return true;
+         }
+
+      private:
+
+         additive_fft_codec(const additive_fft_codec&);
+         additive_fft_codec& operator=(const additive_fft_codec&);
+
+         struct workspace
+         {
+            std::vector<symbol_type>  work;
+            std::vector<symbol_type>  accumulator;
+            std::vector<unsigned int> locator;
+         };
+
+         static inline workspace& thread_workspace()
+         {
+            static thread_local workspace ws;
+            return ws;
+         }
+
+         /* Evaluation point of codeword position i */
+         inline std::size_t point(const std::size_t i) const
+         {
+            return (i < data_length_) ? (chunk_length_ + i) : (i - data_length_);
+         }
+
+         /* x.alpha^log_c, log_c being modulus_ for a zero factor */
+         inline symbol_type mul_log(const symbol_type x, const unsigned int log_c) const
+         {
+            if ((0 == x) || (log_c >= modulus_))
+               return 0;
+
+            unsigned int e = static_cast<unsigned int>(field_.index(x)) + log_c;
+
+            if (e >= modulus_)
+               e -= modulus_;
+
+            return static_cast<symbol_type>(field_.alpha(static_cast<galois::field_symbol>(e)));
+         }
+
+         /*
+            Evaluate the size coefficients of data, in the novel basis, at
+            points offset .. offset + size - 1 (offset a multiple of size).
+            Layer j pairs terms 2^j apart, the twiddle of the block at r
+            being s_j(r), the j-th normalised subspace polynomial.
+         */
+         void fft(symbol_type* data, const std::size_t size, const std::size_t offset) const
+         {
+            for (std::size_t dist = size >> 1; dist > 0; dist >>= 1)
+            {
+               for (std::size_t r = 0; r < size; r += (dist << 1))
+               {
+                  const unsigned int twiddle = skew_log_[offset + r + dist - 1];
+
+                  for (std::size_t i = r; i < (r + dist); ++i)
+                  {
+                     data[i]        ^= mul_log(data[i + dist], twiddle);
+                     data[i + dist] ^= data[i];
+                  }
+               }
+            }
+         }
+
+         /* Inverse of fft(), from the values at the points to the coefficients */
+         void ifft(symbol_type* data, const std::size_t size, const std::size_t offset) const
+         {
+            for (std::size_t dist = 1; dist < size; dist <<= 1)
+            {
+               for (std::size_t r = 0; r < size; r += (dist << 1))
+               {
+                  const unsigned int twiddle = skew_log_[offset + r + dist - 1];
+
+                  for (std::size_t i = r; i < (r + dist); ++i)
+                  {
+                     data[i + dist] ^= data[i];
+                     data[i]        ^= mul_log(data[i + dist], twiddle);
+                  }
+               }
+            }
+         }
+
+         /*
+            Derivative in the novel basis: X_i is the product of the s_j
+            of the set bits j of i, and each s_j' is a constant (s_j is
+            linearised), so X_i' is the sum of s_j'.X_(i - 2^j).
+         */
+         void formal_derivative(symbol_type* data, const std::size_t size) const
+         {
+            for (std::size_t r = 0; r < size; ++r)
+            {
+               symbol_type sum = 0;
+
+               for (std::size_t j = 0; (std::size_t(1) << j) < size; ++j)
+               {
+                  const std::size_t bit = std::size_t(1) << j;
+
+                  if ((0 == (r & bit)) && ((r + bit) < size))
+                  {
+                     sum ^= mul_log(data[r + bit], derivative_log_[j]);
+                  }
+               }
+
+               data[r] = sum;
+            }
+         }
+
+         /* Walsh-Hadamard transform modulo the multiplicative group order */
+         void walsh_hadamard(unsigned int* data, const std::size_t size) const
+         {
+            for (std::size_t dist = 1; dist < size; dist <<= 1)
+            {
+               for (std::size_t r = 0; r < size; r += (dist << 1))
+               {
+                  for (std::size_t i = r; i < (r + dist); ++i)
+                  {
+                     const unsigned int a = data[i];
+                     const unsigned int b = data[i + dist];
+
+                     data[i]        = (a + b) % modulus_;
+                     data[i + dist] = (a + modulus_ - b) % modulus_;
+                  }
+               }
+            }
+         }
+
+         void create_tables()
+         {
+            const galois::field& gf = field_;
+
+            std::size_t levels = 0;
+
+            while ((std::size_t(1) << levels) < domain_length_)
+            {
+               ++levels;
+            }
+
+            /*
+               subspace[j][b] = S_j(2^b), S_j the unnormalised subspace
+               polynomial vanishing on 0 .. 2^j - 1:
+                  S_0(x) = x, S_(j+1)(x) = S_j(x).(S_j(x) + S_j(2^j))
+               S_j is linearised, so S_j(r) is the sum of S_j(2^b) over
+               the set bits b of r.
+            */
+            std::vector<std::vector<galois::field_symbol> > subspace(levels, std::vector<galois::field_symbol>(levels, 0));
+
+            for (std::size_t b = 0; b < levels; ++b)
+            {
+               subspace[0][b] = static_cast<galois::field_symbol>(1u << b);
+            }
+
+            for (std::size_t j = 0; (j + 1) < levels; ++j)
+            {
+               for (std::size_t b = 0; b < levels; ++b)
+               {
+                  subspace[j + 1][b] = gf.mul(subspace[j][b], subspace[j][b] ^ subspace[j][j]);
+               }
+            }
+
+            /* Twiddle of layer j for the block at r, at r + 2^j - 1 */
+            skew_log_.assign(domain_length_, modulus_);
+
+            for (std::size_t j = 0; j < levels; ++j)
+            {
+               const galois::field_symbol normal = subspace[j][j];
+               const std::size_t          dist   = std::size_t(1) << j;
+
+               for (std::size_t r = 0; r < domain_length_; r += (dist << 1))
+               {
+                  galois::field_symbol value = 0;
+
+                  for (std::size_t b = j + 1; b < levels; ++b)
+                  {
+                     if (r & (std::size_t(1) << b))
+                        value ^= subspace[j][b];
+                  }
+
+                  value = gf.div(value, normal);
+
+                  skew_log_[r + dist - 1] = (0 == value) ? modulus_ : static_cast<unsigned int>(gf.index(value));
+               }
+            }
+
+            /* s_j' = S_j' / S_j(2^j), with S_0' = 1 and S_(j+1)' = S_j(2^j).S_j' */
+            derivative_log_.resize(levels);
+
+            galois::field_symbol slope = 1;
+
+            for (std::size_t j = 0; j < levels; ++j)
+            {
+               derivative_log_[j] = static_cast<unsigned int>(gf.index(gf.div(slope, subspace[j][j])));
+               slope = gf.mul(slope, subspace[j][j]);
+            }
+
+            /* Walsh-Hadamard transform of the log table, scaled by 1 / n */
+            log_walsh_.resize(domain_length_);
+
+            log_walsh_[0] = 0;
+
+            for (std::size_t i = 1; i < domain_length_; ++i)
+            {
+               log_walsh_[i] = static_cast<unsigned int>(gf.index(static_cast<galois::field_symbol>(i)));
+            }
+
+            walsh_hadamard(log_walsh_.data(), domain_length_);
+
+            unsigned long long inverse = 1;
+
+            for (std::size_t i = 0; i < levels; ++i)
+            {
+               inverse = (inverse * ((modulus_ + 1) / 2)) % modulus_;
+            }
+
+            for (std::size_t i = 0; i < domain_length_; ++i)
+            {
+               log_walsh_[i] = static_cast<unsigned int>((log_walsh_[i] * inverse) % modulus_);
+            }
+         }
+
+         const galois::field&      field_;
+         const std::size_t         data_length_;
+         const std::size_t         fec_length_;
+         std::size_t               chunk_length_;
+         std::size_t               domain_length_;
+         const unsigned int        modulus_;
+         bool                      valid_;
+         std::vector<unsigned int> skew_log_;
+         std::vector<unsigned int> derivative_log_;
+         std::vector<unsigned int> log_walsh_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,314 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_AUTOTUNER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_AUTOTUNER_HPP
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_stream_codec.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_tuning.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Find the settings that decode fastest on the host. Over
+         sample_size bytes of codewords, a quarter of them carrying
+         fec_length / 2 symbol errors, two grids are timed, each point
+         best of repetitions runs:
+
+            codec_executor   every thread count of thread_grid with every
+                             grain of grain_grid, decoding the codewords
+                             as one batch.
+
+            pipelines        every thread count of thread_grid with every
+                             buffer size of buffer_grid, running the
+                             stream_decoder pipeline (that of
+                             parallel_file_decoder, without the file I/O)
+                             over the encoded sample.
+
+         tune() returns the fastest profile. tune_and_save() also stores
+         it with tuning::save(), after which executors and pipelines of
+         the code use it by default. load_or_tune() tunes only when the
+         code has no stored profile yet, eg: on the first run on a host.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class autotuner
+      {
+      public:
+
+         static constexpr std::size_t data_length = code_length - fec_length;
+
+         typedef codec_executor<code_length,fec_length>   executor_type;
+         typedef encoder<code_length,fec_length>          encoder_type;
+         typedef decoder<code_length,fec_length>          decoder_type;
+         typedef stream_encoder<code_length,fec_length>   stream_encoder_type;
+         typedef stream_decoder<code_length,fec_length>   stream_decoder_type;
+
+         static constexpr std::size_t default_sample_size = 4 * 1024 * 1024;
+         static constexpr std::size_t default_repetitions = 3;
+
+         autotuner(const galois::field&            field,
+                   const galois::field_polynomial& generator,
+                   const unsigned int              gen_initial_index,
+                   const std::size_t               sample_size = default_sample_size,
+                   const std::size_t               repetitions = default_repetitions)
+         : field_(field),
+           generator_(generator),
+           gen_initial_index_(gen_initial_index),
+           sample_size_(std::max<std::size_t>(code_length, sample_size)),
+           repetitions_(std::max<std::size_t>(1, repetitions)),
+           executor_rate_(0.0),
+           pipeline_rate_(0.0)
+         {}
+
+         /* 1, 2, 4, ... hardware threads */
+         static inline std::vector<std::size_t> default_thread_grid()
+         {
+            const std::size_t hardware_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+            std::vector<std::size_t> grid;
+
+            for (std::size_t t = 1; t < hardware_threads; t *= 2)
+            {
+               grid.push_back(t);
+            }
+
+            grid.push_back(hardware_threads);
+
+            return grid;
+         }
+
+         static inline std::vector<std::size_t> default_grain_grid()
+         {
+            return std::vector<std::size_t>({ 32, 64, 128, 256, 512, 1024 });
+         }
+
+         static inline std::vector<std::size_t> default_buffer_grid()
+         {
+            return std::vector<std::size_t>({ 256 * 1024, 512 * 1024, 1024 * 1024, 2 * 1024 * 1024, 4 * 1024 * 1024, 8 * 1024 * 1024 });
+         }
+
+         inline tuning::profile tune()
+         {
+            return tune(default_thread_grid(), default_grain_grid(), default_buffer_grid());
+         }
+
+         tuning::profile tune(const std::vector<std::size_t>& thread_grid,
+                              const std::vector<std::size_t>& grain_grid,
+                              const std::vector<std::size_t>& buffer_grid)
+         {
+            tuning::profile best = { 0, 0, 0 };
+
+            executor_rate_ = 0.0;
+            pipeline_rate_ = 0.0;
+
+            make_sample();
+
+            std::vector<unsigned char> codewords(codewords_.size());
+
+            for (std::size_t t = 0; t < thread_grid.size(); ++t)
+            {
+               for (std::size_t g = 0; g < grain_grid.size(); ++g)
+               {
+                  executor_type executor(field_, generator_, gen_initial_index_, thread_grid[t], grain_grid[g]);
+
+                  double fastest = 0.0;
+
+                  for (std::size_t r = 0; r < repetitions_; ++r)
+                  {
+                     codewords = codewords_;
+
+                     const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                     executor.decode_buffer(&codewords[0], codewords.size() / code_length).get();
+
+                     fastest = std::max(fastest, rate(start, codewords.size()));
+                  }
+
+                  if (fastest > executor_rate_)
+                  {
+                     executor_rate_ = fastest;
+                     best.grain     = grain_grid[g];
+                  }
+               }
+            }
+
+            const decoder_type decoder(field_, gen_initial_index_);
+
+            for (std::size_t t = 0; t < thread_grid.size(); ++t)
+            {
+               for (std::size_t b = 0; b < buffer_grid.size(); ++b)
+               {
+                  double fastest = 0.0;
+
+                  for (std::size_t r = 0; r < repetitions_; ++r)
+                  {
+                     std::istringstream in(stream_);
+                     std::ostringstream out;
+
+                     const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                     stream_decoder_type run(decoder, in, out, thread_grid[t], buffer_grid[b]);
+
+                     fastest = std::max(fastest, rate(start, stream_.size()));
+                  }
+
+                  if (fastest > pipeline_rate_)
+                  {
+                     pipeline_rate_   = fastest;
+                     best.threads     = thread_grid[t];
+                     best.buffer_size = buffer_grid[b];
+                  }
+               }
+            }
+
+            return best;
+         }
+
+         /* Tune, and store the profile in path */
+         inline bool tune_and_save(const std::string& path = tuning::profile_path())
+         {
+            return tuning::save(path, code_length, fec_length, tune());
+         }
+
+         /* The stored profile of the code, tuned and stored first when there is none */
+         static inline tuning::profile load_or_tune(const galois::field&            field,
+                                                    const galois::field_polynomial& generator,
+                                                    const unsigned int              gen_initial_index,
+                                                    const std::string&              path = tuning::profile_path())
+         {
+            tuning::profile settings;
+
+            if (tuning::load(path, code_length, fec_length, settings))
+               return settings;
+
+            autotuner tuner(field, generator, gen_initial_index);
+
+            settings = tuner.tune();
+
+            tuning::save(path, code_length, fec_length, settings);
+
+            return settings;
+         }
+
+         /* Bytes of codewords decoded per second at the best point of each grid */
+         inline double executor_rate() const
+         {
+            return executor_rate_;
+         }
+
+         inline double pipeline_rate() const
+         {
+            return pipeline_rate_;
+         }
+
+      private:
+
+         autotuner(const autotuner&);
+         autotuner& operator=(const autotuner&);
+
+         static inline double rate(const std::chrono::steady_clock::time_point& start, const std::size_t bytes)
+         {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            return (seconds > 0.0) ? (static_cast<double>(bytes) / seconds) : 0.0;
+         }
+
+         /*
+            Encode random data into whole codewords, once back to back for
+            the executor and once as a stream_encoder stream, then corrupt
+            a quarter of the codewords of each the same way.
+         */
+         void make_sample()
+         {
+            const std::size_t count = sample_size_ / code_length;
+
+            std::mt19937 rng(0x5C41F4A);
+
+            std::string data(count * data_length, '\0');
+
+            for (std::size_t i = 0; i < data.size(); ++i)
+            {
+               data[i] = static_cast<char>(rng() & 0xFF);
+            }
+
+            const encoder_type encoder(field_, generator_);
+
+            {
+               std::istringstream in(data);
+               std::ostringstream out;
+
+               stream_encoder_type run(encoder, in, out, 1);
+
+               stream_ = out.str();
+            }
+
+            codewords_.assign(stream_.begin(), stream_.begin() + count * code_length);
+
+            for (std::size_t c = 0; c < count; c += 4)
+            {
+               for (std::size_t e = 0; e < std::max<std::size_t>(1, fec_length / 2); ++e)
+               {
+                  const std::size_t position = c * code_length + (rng() % code_length);
+                  const unsigned char error  = static_cast<unsigned char>(1 + (rng() % field_.size()));
+
+                  codewords_[position] ^= error;
+                  stream_[position]     = static_cast<char>(codewords_[position]);
+               }
+            }
+         }
+
+         const galois::field&            field_;
+         const galois::field_polynomial& generator_;
+         const unsigned int              gen_initial_index_;
+         const std::size_t               sample_size_;
+         const std::size_t               repetitions_;
+         std::vector<unsigned char>      codewords_;
+         std::string                     stream_;
+         double                          executor_rate_;
+         double                          pipeline_rate_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -24,7 +24,24 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_BITIO_HPP
 
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <vector>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_BITIO_X86
+   #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+   #define SCHIFRA_BITIO_NEON
+   #include <arm_neon.h>
+#endif
 
 
 namespace schifra
@@ -36,157 +53,679 @@ namespace schifra
       namespace bitio
       {
 
-         template <std::size_t symbol_bit_count> class convert_data_to_symbol;
-
-         template <>
-         class convert_data_to_symbol<2>
+         /*
+            Bulk conversion between bytes and symbols of 2, 4, 8, 16 or 24
+            bits. Symbols are packed low bits first: symbol i of a 2 or 4
+            bit stream is bits [i * bits, (i + 1) * bits) of the stream,
+            ie: the low nibble of a byte is its first 4 bit symbol, and a 16
+            or 24 bit symbol is its bytes little endian.
+
+            unpack_symbols() reads (count * bits + 7) / 8 bytes into count
+            symbols, pack_symbols() writes them back from the low bits of
+            count symbols, the unused high bits of a partial last byte set
+            to zero. Whole vectors of bytes go through SSSE3/AVX2 (runtime
+            dispatched) or NEON shuffles, for symbols of one byte as well
+            as for galois::field_symbol, the tail through scalar code.
+         */
+         namespace details
          {
-         public:
+            template <std::size_t bits>
+            struct symbol_width
+            {
+               static_assert((2 == bits) || (4 == bits) || (8 == bits) || (16 == bits) || (24 == bits),
+                             "bitio: symbols of 2, 4, 8, 16 or 24 bits");
 
-            template <typename BitBlock>
-            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
+               static const std::size_t bytes = (bits >= 8) ? (bits / 8) : 1;
+               static const std::size_t per_byte = (bits >= 8) ? 1 : (8 / bits);
+               static const std::uint32_t mask = (bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1);
+            };
+
+            /* Symbols [first, count), first on a byte boundary */
+            template <std::size_t bits, typename symbol_t>
+            inline void unpack_scalar(const unsigned char* data, symbol_t* symbols, std::size_t first, const std::size_t count)
             {
-               const BitBlock* d_it = &  data[0];
-               int*            s_it = &symbol[0];
+               typedef symbol_width<bits> width;
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, s_it+=4)
+               if (bits < 8)
+               {
+                  for ( ; first < count; ++first)
+                  {
+                     const std::size_t bit = first * bits;
+                     symbols[first] = static_cast<symbol_t>((data[bit >> 3] >> (bit & 7)) & width::mask);
+                  }
+               }
+               else
                {
-                  (* s_it     ) =  (*d_it)       & 0x03;
-                  (*(s_it + 1)) = ((*d_it) >> 2) & 0x03;
-                  (*(s_it + 2)) = ((*d_it) >> 4) & 0x03;
-                  (*(s_it + 3)) = ((*d_it) >> 6) & 0x03;
+                  for ( ; first < count; ++first)
+                  {
+                     const unsigned char* d = data + first * width::bytes;
+                     std::uint32_t value = 0;
+
+                     for (std::size_t b = 0; b < width::bytes; ++b)
+                     {
+                        value |= static_cast<std::uint32_t>(d[b]) << (8 * b);
+                     }
+
+                     symbols[first] = static_cast<symbol_t>(value);
+                  }
                }
             }
-         };
 
-         template <>
-         class convert_data_to_symbol<4>
-         {
-         public:
+            template <std::size_t bits, typename symbol_t>
+            inline void pack_scalar(const symbol_t* symbols, std::size_t first, const std::size_t count, unsigned char* data)
+            {
+               typedef symbol_width<bits> width;
 
-            template <typename BitBlock>
-            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
+               if (bits < 8)
+               {
+                  for ( ; first < count; ++first)
+                  {
+                     const std::size_t bit = first * bits;
+
+                     if (0 == (bit & 7))
+                        data[bit >> 3] = 0;
+
+                     data[bit >> 3] |= static_cast<unsigned char>((static_cast<std::uint32_t>(symbols[first]) & width::mask) << (bit & 7));
+                  }
+               }
+               else
+               {
+                  for ( ; first < count; ++first)
+                  {
+                     const std::uint32_t value = static_cast<std::uint32_t>(symbols[first]);
+                     unsigned char*      d     = data + first * width::bytes;
+
+                     for (std::size_t b = 0; b < width::bytes; ++b)
+                     {
+                        d[b] = static_cast<unsigned char>(value >> (8 * b));
+                     }
+                  }
+               }
+            }
+
+            #if defined(SCHIFRA_BITIO_X86)
+
+            /*
+               Byte symbol kernels, 32 bytes of packed data per step. Each
+               returns the number of symbols done, always whole bytes.
+            */
+            __attribute__((target("avx2")))
+            inline std::size_t unpack4_avx2(const unsigned char* data, std::uint8_t* symbols, const std::size_t count)
             {
-               const BitBlock* d_it = &  data[0];
-               int*            s_it = &symbol[0];
+               const __m256i low = _mm256_set1_epi8(0x0F);
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, s_it+=2)
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
                {
-                  (* s_it     ) =  (*d_it)       & 0x0F;
-                  (*(s_it + 1)) = ((*d_it) >> 4) & 0x0F;
+                  const __m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + (i >> 1)));
+                  const __m256i lo = _mm256_and_si256(x, low);
+                  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), low);
+                  const __m256i a  = _mm256_unpacklo_epi8(lo, hi);
+                  const __m256i b  = _mm256_unpackhi_epi8(lo, hi);
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i +  0), _mm256_permute2x128_si256(a, b, 0x20));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i + 32), _mm256_permute2x128_si256(a, b, 0x31));
                }
+
+               return i;
             }
-         };
 
-         template <>
-         class convert_data_to_symbol<8>
-         {
-         public:
+            __attribute__((target("avx2")))
+            inline std::size_t unpack2_avx2(const unsigned char* data, std::uint8_t* symbols, const std::size_t count)
+            {
+               const __m256i low = _mm256_set1_epi8(0x03);
 
-            template <typename BitBlock>
-            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
+               std::size_t i = 0;
+
+               for ( ; (i + 128) <= count; i += 128)
+               {
+                  const __m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + (i >> 2)));
+                  const __m256i c0 = _mm256_and_si256(x, low);
+                  const __m256i c1 = _mm256_and_si256(_mm256_srli_epi16(x, 2), low);
+                  const __m256i c2 = _mm256_and_si256(_mm256_srli_epi16(x, 4), low);
+                  const __m256i c3 = _mm256_and_si256(_mm256_srli_epi16(x, 6), low);
+                  const __m256i a0 = _mm256_unpacklo_epi8(c0, c1);
+                  const __m256i a1 = _mm256_unpackhi_epi8(c0, c1);
+                  const __m256i b0 = _mm256_unpacklo_epi8(c2, c3);
+                  const __m256i b1 = _mm256_unpackhi_epi8(c2, c3);
+                  const __m256i r0 = _mm256_unpacklo_epi16(a0, b0);
+                  const __m256i r1 = _mm256_unpackhi_epi16(a0, b0);
+                  const __m256i r2 = _mm256_unpacklo_epi16(a1, b1);
+                  const __m256i r3 = _mm256_unpackhi_epi16(a1, b1);
+
+                  /* Per 128 bit lane r0..r3 hold its bytes 0-3, 4-7, 8-11 and 12-15 */
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i +  0), _mm256_permute2x128_si256(r0, r1, 0x20));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i + 32), _mm256_permute2x128_si256(r2, r3, 0x20));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i + 64), _mm256_permute2x128_si256(r0, r1, 0x31));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i + 96), _mm256_permute2x128_si256(r2, r3, 0x31));
+               }
+
+               return i;
+            }
+
+            /* Symbol pairs (a, b) to a + (b << shift), 16 bit lanes */
+            __attribute__((target("avx2")))
+            inline __m256i merge_pairs_avx2(const __m256i x, const __m256i mask, const __m256i weights)
+            {
+               return _mm256_maddubs_epi16(_mm256_and_si256(x, mask), weights);
+            }
+
+            __attribute__((target("avx2")))
+            inline __m256i pack_words_avx2(const __m256i a, const __m256i b)
+            {
+               return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            }
+
+            __attribute__((target("avx2")))
+            inline std::size_t pack4_avx2(const std::uint8_t* symbols, const std::size_t count, unsigned char* data)
             {
-               const BitBlock* d_it = &  data[0];
-               int*            s_it = &symbol[0];
+               const __m256i mask    = _mm256_set1_epi8(0x0F);
+               const __m256i weights = _mm256_set1_epi16(0x1001);
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, ++s_it)
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
                {
-                  (*s_it) =  (*d_it) & 0xFF;
+                  const __m256i p0 = merge_pairs_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(symbols + i +  0)), mask, weights);
+                  const __m256i p1 = merge_pairs_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(symbols + i + 32)), mask, weights);
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + (i >> 1)), pack_words_avx2(p0, p1));
                }
+
+               return i;
             }
-         };
 
-         template <>
-         class convert_data_to_symbol<16>
-         {
-         public:
+            __attribute__((target("avx2")))
+            inline std::size_t pack2_avx2(const std::uint8_t* symbols, const std::size_t count, unsigned char* data)
+            {
+               const __m256i mask     = _mm256_set1_epi8(0x03);
+               const __m256i weights2 = _mm256_set1_epi16(0x0401);
+               const __m256i weights4 = _mm256_set1_epi16(0x1001);
+               const __m256i all      = _mm256_set1_epi8(static_cast<char>(0xFF));
 
-            template <typename BitBlock>
-            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
+               std::size_t i = 0;
+
+               for ( ; (i + 128) <= count; i += 128)
+               {
+                  const __m256i* s = reinterpret_cast<const __m256i*>(symbols + i);
+
+                  /* Pairs of 2 bit symbols to nibbles, then pairs of nibbles to bytes */
+                  const __m256i n0 = pack_words_avx2(merge_pairs_avx2(_mm256_loadu_si256(s + 0), mask, weights2),
+                                                     merge_pairs_avx2(_mm256_loadu_si256(s + 1), mask, weights2));
+                  const __m256i n1 = pack_words_avx2(merge_pairs_avx2(_mm256_loadu_si256(s + 2), mask, weights2),
+                                                     merge_pairs_avx2(_mm256_loadu_si256(s + 3), mask, weights2));
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + (i >> 2)),
+                                      pack_words_avx2(merge_pairs_avx2(n0, all, weights4),
+                                                      merge_pairs_avx2(n1, all, weights4)));
+               }
+
+               return i;
+            }
+
+            /* count int symbols from bytes, 8 per step */
+            __attribute__((target("avx2")))
+            inline std::size_t widen8_avx2(const std::uint8_t* bytes, int* symbols, const std::size_t count)
             {
-               const BitBlock* d_it = &  data[0];
-               int*            s_it = &symbol[0];
+               std::size_t i = 0;
 
-               for (std::size_t i = 0; i < data_length; i+=2, d_it+=2, ++s_it)
+               for ( ; (i + 8) <= count; i += 8)
                {
-                  (*s_it)  = (*d_it) & 0x000000FF;
-                  (*s_it) |= (static_cast<int>((*(d_it + 1))) << 8) & 0x0000FF00;
+                  const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + i));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i), _mm256_cvtepu8_epi32(x));
                }
+
+               return i;
             }
-         };
 
-         template <>
-         class convert_data_to_symbol<24>
-         {
-         public:
+            /* count int symbols to bytes (their low 8 bits), 32 per step */
+            __attribute__((target("avx2")))
+            inline std::size_t narrow8_avx2(const int* symbols, std::uint8_t* bytes, const std::size_t count)
+            {
+               const __m256i mask  = _mm256_set1_epi32(0xFF);
+               const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
 
-            template <typename BitBlock>
-            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const __m256i* s = reinterpret_cast<const __m256i*>(symbols + i);
+
+                  const __m256i a = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(s + 0), mask),
+                                                        _mm256_and_si256(_mm256_loadu_si256(s + 1), mask));
+                  const __m256i b = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(s + 2), mask),
+                                                        _mm256_and_si256(_mm256_loadu_si256(s + 3), mask));
+
+                  /* Lanes hold 4 byte groups of s0 s1 s2 s3 (low halves) then the high halves */
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + i),
+                                      _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), order));
+               }
+
+               return i;
+            }
+
+            __attribute__((target("avx2")))
+            inline std::size_t unpack16_avx2(const unsigned char* data, int* symbols, const std::size_t count)
             {
-               BitBlock* d_it = &  data[0];
-               int*      s_it = &symbol[0];
+               std::size_t i = 0;
 
-               for (std::size_t i = 0; i < data_length; i+=3, d_it+=3, ++s_it)
+               for ( ; (i + 8) <= count; i += 8)
                {
-                  (*s_it) |= (*d_it) & 0x000000FF;
-                  (*s_it) |= (static_cast<int>((*(d_it + 1))) <<  8) & 0x0000FF00;
-                  (*s_it) |= (static_cast<int>((*(d_it + 2))) << 16) & 0x00FF0000;
+                  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * i));
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i), _mm256_cvtepu16_epi32(x));
                }
+
+               return i;
             }
-         };
 
-         template <std::size_t symbol_bit_count> class convert_symbol_to_data;
+            __attribute__((target("avx2")))
+            inline std::size_t pack16_avx2(const int* symbols, const std::size_t count, unsigned char* data)
+            {
+               const __m256i mask = _mm256_set1_epi32(0xFFFF);
 
-         template <>
-         class convert_symbol_to_data<4>
-         {
-         public:
+               std::size_t i = 0;
 
-            template <typename BitBlock>
-            convert_symbol_to_data(const int symbol[], BitBlock data[], const std::size_t data_length)
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  const __m256i* s = reinterpret_cast<const __m256i*>(symbols + i);
+
+                  const __m256i words = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(s + 0), mask),
+                                                            _mm256_and_si256(_mm256_loadu_si256(s + 1), mask));
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + 2 * i), _mm256_permute4x64_epi64(words, 0xD8));
+               }
+
+               return i;
+            }
+
+            /* 4 symbols from 12 bytes per step, reading 16 */
+            __attribute__((target("ssse3")))
+            inline std::size_t unpack24_ssse3(const unsigned char* data, int* symbols, const std::size_t count)
             {
-               BitBlock*  d_it = &  data[0];
-               const int* s_it = &symbol[0];
+               const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+
+               std::size_t i = 0;
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, ++s_it)
+               for ( ; (i + 6) <= count; i += 4)
                {
-                  (*d_it)  =        (*s_it) & 0x0000000F;
-                  (*d_it) |= ((*(s_it + 1)) & 0x0000000F) << 4;
+                  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 3 * i));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(symbols + i), _mm_shuffle_epi8(x, spread));
                }
+
+               return i;
             }
-         };
 
-         template <>
-         class convert_symbol_to_data<8>
+            /* 4 symbols to 12 bytes per step, writing 16 */
+            __attribute__((target("ssse3")))
+            inline std::size_t pack24_ssse3(const int* symbols, const std::size_t count, unsigned char* data)
+            {
+               const __m128i gather = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 6) <= count; i += 4)
+               {
+                  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(symbols + i));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(data + 3 * i), _mm_shuffle_epi8(x, gather));
+               }
+
+               return i;
+            }
+
+            #elif defined(SCHIFRA_BITIO_NEON)
+
+            inline std::size_t unpack4_neon(const unsigned char* data, std::uint8_t* symbols, const std::size_t count)
+            {
+               const uint8x16_t low = vdupq_n_u8(0x0F);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const uint8x16_t x = vld1q_u8(data + (i >> 1));
+                  uint8x16x2_t     s;
+
+                  s.val[0] = vandq_u8(x, low);
+                  s.val[1] = vshrq_n_u8(x, 4);
+
+                  vst2q_u8(symbols + i, s);
+               }
+
+               return i;
+            }
+
+            inline std::size_t unpack2_neon(const unsigned char* data, std::uint8_t* symbols, const std::size_t count)
+            {
+               const uint8x16_t low = vdupq_n_u8(0x03);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
+               {
+                  const uint8x16_t x = vld1q_u8(data + (i >> 2));
+                  uint8x16x4_t     s;
+
+                  s.val[0] = vandq_u8(x, low);
+                  s.val[1] = vandq_u8(vshrq_n_u8(x, 2), low);
+                  s.val[2] = vandq_u8(vshrq_n_u8(x, 4), low);
+                  s.val[3] = vshrq_n_u8(x, 6);
+
+                  vst4q_u8(symbols + i, s);
+               }
+
+               return i;
+            }
+
+            inline std::size_t pack4_neon(const std::uint8_t* symbols, const std::size_t count, unsigned char* data)
+            {
+               const uint8x16_t low = vdupq_n_u8(0x0F);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const uint8x16x2_t s = vld2q_u8(symbols + i);
+
+                  vst1q_u8(data + (i >> 1), vorrq_u8(vandq_u8(s.val[0], low), vshlq_n_u8(s.val[1], 4)));
+               }
+
+               return i;
+            }
+
+            inline std::size_t pack2_neon(const std::uint8_t* symbols, const std::size_t count, unsigned char* data)
+            {
+               const uint8x16_t low = vdupq_n_u8(0x03);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
+               {
+                  const uint8x16x4_t s = vld4q_u8(symbols + i);
+
+                  const uint8x16_t lo = vorrq_u8(vandq_u8(s.val[0], low), vshlq_n_u8(vandq_u8(s.val[1], low), 2));
+                  const uint8x16_t hi = vorrq_u8(vshlq_n_u8(vandq_u8(s.val[2], low), 4), vshlq_n_u8(s.val[3], 6));
+
+                  vst1q_u8(data + (i >> 2), vorrq_u8(lo, hi));
+               }
+
+               return i;
+            }
+
+            inline std::size_t widen8_neon(const std::uint8_t* bytes, int* symbols, const std::size_t count)
+            {
+               std::size_t i = 0;
+
+               for ( ; (i + 8) <= count; i += 8)
+               {
+                  const uint16x8_t x = vmovl_u8(vld1_u8(bytes + i));
+
+                  vst1q_s32(symbols + i + 0, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16 (x))));
+                  vst1q_s32(symbols + i + 4, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(x))));
+               }
+
+               return i;
+            }
+
+            inline std::size_t narrow8_neon(const int* symbols, std::uint8_t* bytes, const std::size_t count)
+            {
+               std::size_t i = 0;
+
+               for ( ; (i + 8) <= count; i += 8)
+               {
+                  const uint16x4_t a = vmovn_u32(vreinterpretq_u32_s32(vld1q_s32(symbols + i + 0)));
+                  const uint16x4_t b = vmovn_u32(vreinterpretq_u32_s32(vld1q_s32(symbols + i + 4)));
+
+                  vst1_u8(bytes + i, vmovn_u16(vcombine_u16(a, b)));
+               }
+
+               return i;
+            }
+
+            #endif
+
+            /* Byte symbols: whole vectors through the kernels above, returns symbols done */
+            template <std::size_t bits>
+            inline std::size_t unpack_vector(const unsigned char* data, std::uint8_t* symbols, const std::size_t count)
+            {
+               #if defined(SCHIFRA_BITIO_X86)
+               if (utils::host_cpu_features().avx2)
+               {
+                  if (2 == bits) return unpack2_avx2(data, symbols, count);
+                  if (4 == bits) return unpack4_avx2(data, symbols, count);
+               }
+               #elif defined(SCHIFRA_BITIO_NEON)
+               if (2 == bits) return unpack2_neon(data, symbols, count);
+               if (4 == bits) return unpack4_neon(data, symbols, count);
+               #endif
+
+               if (8 == bits)
+               {
+                  std::memcpy(symbols, data, count);
+                  return count;
+               }
+
+               (void)data; (void)symbols;
+
+               return 0;
+            }
+
+            template <std::size_t bits>
+            inline std::size_t pack_vector(const std::uint8_t* symbols, const std::size_t count, unsigned char* data)
+            {
+               #if defined(SCHIFRA_BITIO_X86)
+               if (utils::host_cpu_features().avx2)
+               {
+                  if (2 == bits) return pack2_avx2(symbols, count, data);
+                  if (4 == bits) return pack4_avx2(symbols, count, data);
+               }
+               #elif defined(SCHIFRA_BITIO_NEON)
+               if (2 == bits) return pack2_neon(symbols, count, data);
+               if (4 == bits) return pack4_neon(symbols, count, data);
+               #endif
+
+               if (8 == bits)
+               {
+                  std::memcpy(data, symbols, count);
+                  return count;
+               }
+
+               (void)symbols; (void)data;
+
+               return 0;
+            }
+
+            /* Symbols of 2 to 8 bits into ints go through a byte buffer in L1, widened */
+            static const std::size_t staging_symbols = 1024;
+
+            inline std::size_t widen8(const std::uint8_t* bytes, int* symbols, const std::size_t count)
+            {
+               std::size_t i = 0;
+
+               #if defined(SCHIFRA_BITIO_X86)
+               if (utils::host_cpu_features().avx2)
+                  i = widen8_avx2(bytes, symbols, count);
+               #elif defined(SCHIFRA_BITIO_NEON)
+               i = widen8_neon(bytes, symbols, count);
+               #endif
+
+               for ( ; i < count; ++i)
+               {
+                  symbols[i] = bytes[i];
+               }
+
+               return count;
+            }
+
+            inline std::size_t narrow8(const int* symbols, std::uint8_t* bytes, const std::size_t count)
+            {
+               std::size_t i = 0;
+
+               #if defined(SCHIFRA_BITIO_X86)
+               if (utils::host_cpu_features().avx2)
+                  i = narrow8_avx2(symbols, bytes, count);
+               #elif defined(SCHIFRA_BITIO_NEON)
+               i = narrow8_neon(symbols, bytes, count);
+               #endif
+
+               for ( ; i < count; ++i)
+               {
+                  bytes[i] = static_cast<std::uint8_t>(symbols[i]);
+               }
+
+               return count;
+            }
+
+            template <std::size_t bits>
+            inline std::size_t unpack_vector(const unsigned char* data, int* symbols, const std::size_t count)
+            {
+               #if defined(SCHIFRA_BITIO_X86)
+               if (16 == bits) return utils::host_cpu_features().avx2  ? unpack16_avx2 (data, symbols, count) : 0;
+               if (24 == bits) return utils::host_cpu_features().ssse3 ? unpack24_ssse3(data, symbols, count) : 0;
+               #endif
+
+               if (bits > 8)
+                  return 0;
+
+               typedef symbol_width<bits> width;
+
+               /* Whole bytes only, so that the scalar tail starts on a byte boundary */
+               const std::size_t whole = count - (count % width::per_byte);
+
+               std::uint8_t staging[staging_symbols];
+
+               for (std::size_t i = 0; i < whole; i += staging_symbols)
+               {
+                  const std::size_t n    = std::min(staging_symbols, whole - i);
+                  const std::size_t done = unpack_vector<bits>(data + (i * bits) / 8, staging, n);
+
+                  unpack_scalar<bits>(data + (i * bits) / 8, staging, done, n);
+                  widen8(staging, symbols + i, n);
+               }
+
+               return whole;
+            }
+
+            template <std::size_t bits>
+            inline std::size_t pack_vector(const int* symbols, const std::size_t count, unsigned char* data)
+            {
+               #if defined(SCHIFRA_BITIO_X86)
+               if (16 == bits) return utils::host_cpu_features().avx2  ? pack16_avx2 (symbols, count, data) : 0;
+               if (24 == bits) return utils::host_cpu_features().ssse3 ? pack24_ssse3(symbols, count, data) : 0;
+               #endif
+
+               if (bits > 8)
+                  return 0;
+
+               typedef symbol_width<bits> width;
+
+               const std::size_t whole = count - (count % width::per_byte);
+
+               std::uint8_t staging[staging_symbols];
+
+               for (std::size_t i = 0; i < whole; i += staging_symbols)
+               {
+                  const std::size_t n = std::min(staging_symbols, whole - i);
+
+                  narrow8(symbols + i, staging, n);
+
+                  const std::size_t done = pack_vector<bits>(staging, n, data + (i * bits) / 8);
+
+                  pack_scalar<bits>(staging, done, n, data + (i * bits) / 8);
+               }
+
+               return whole;
+            }
+
+            /* Any other symbol type is converted by the scalar code alone */
+            template <std::size_t bits, typename symbol_t>
+            inline std::size_t unpack_vector(const unsigned char*, symbol_t*, const std::size_t)
+            {
+               return 0;
+            }
+
+            template <std::size_t bits, typename symbol_t>
+            inline std::size_t pack_vector(const symbol_t*, const std::size_t, unsigned char*)
+            {
+               return 0;
+            }
+
+         } // namespace details
+
+         template <std::size_t symbol_bit_count, typename symbol_t>
+         inline void unpack_symbols(const unsigned char* data, symbol_t* symbols, const std::size_t count)
+         {
+            const std::size_t done = details::unpack_vector<symbol_bit_count>(data, symbols, count);
+            details::unpack_scalar<symbol_bit_count>(data, symbols, done, count);
+         }
+
+         template <std::size_t symbol_bit_count, typename symbol_t>
+         inline void pack_symbols(const symbol_t* symbols, const std::size_t count, unsigned char* data)
+         {
+            const std::size_t done = details::pack_vector<symbol_bit_count>(symbols, count, data);
+            details::pack_scalar<symbol_bit_count>(symbols, done, count, data);
+         }
+
+         /*
+            The classes below convert data_length bytes of data (BitBlock
+            holding one byte each) to or from data_length * 8 / bits
+            symbols, through unpack_symbols() and pack_symbols().
+         */
+         template <std::size_t symbol_bit_count>
+         class convert_data_to_symbol
          {
          public:
+
             template <typename BitBlock>
-            convert_symbol_to_data(const int symbol[], BitBlock data[], const std::size_t data_length)
+            convert_data_to_symbol(const BitBlock data[], const std::size_t data_length, int symbol[])
             {
-               BitBlock*  d_it = &  data[0];
-               const int* s_it = &symbol[0];
+               typedef details::symbol_width<symbol_bit_count> width;
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, ++s_it)
+               const std::size_t count = (data_length * 8) / symbol_bit_count;
+
+               if (1 == sizeof(BitBlock))
+                  unpack_symbols<symbol_bit_count>(reinterpret_cast<const unsigned char*>(data), symbol, count);
+               else
                {
-                  (*d_it) = static_cast<BitBlock>((*s_it) & 0xFF);
+                  /* Wider BitBlocks are truncated to bytes first */
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     std::uint32_t value = 0;
+
+                     for (std::size_t b = 0; b < width::bytes; ++b)
+                     {
+                        const std::size_t bit = i * symbol_bit_count + 8 * b;
+                        value |= ((static_cast<std::uint32_t>(data[bit >> 3]) & 0xFF) >> (bit & 7)) << (8 * b);
+                     }
+
+                     symbol[i] = static_cast<int>(value & width::mask);
+                  }
                }
             }
          };
 
-         template <>
-         class convert_symbol_to_data<16>
+         template <std::size_t symbol_bit_count>
+         class convert_symbol_to_data
          {
          public:
 
             template <typename BitBlock>
             convert_symbol_to_data(const int symbol[], BitBlock data[], const std::size_t data_length)
             {
-               BitBlock*  d_it = &  data[0];
-               const int* s_it = &symbol[0];
+               const std::size_t count = (data_length * 8) / symbol_bit_count;
 
-               for (std::size_t i = 0; i < data_length; ++i, ++d_it, ++s_it)
+               if (1 == sizeof(BitBlock))
+                  pack_symbols<symbol_bit_count>(symbol, count, reinterpret_cast<unsigned char*>(data));
+               else
                {
-                  (*d_it) = (*s_it) & 0xFFFF;
+                  std::vector<unsigned char> bytes(data_length);
+
+                  pack_symbols<symbol_bit_count>(symbol, count, bytes.data());
+
+                  for (std::size_t i = 0; i < data_length; ++i)
+                  {
+                     data[i] = static_cast<BitBlock>(bytes[i]);
+                  }
                }
             }
          };
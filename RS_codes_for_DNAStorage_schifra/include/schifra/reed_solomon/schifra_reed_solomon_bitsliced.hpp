@@ -0,0 +1,494 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_BITSLICED_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_BITSLICED_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/static_field.hpp"
+
+#if defined(__SSE2__)
+   #include <emmintrin.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         A machine word of 64 * words bits. Bit k of a word belongs to
+         codeword (lane) k, so one xor of two words adds the same bit
+         plane of 64 * words codewords.
+      */
+      template <std::size_t words>
+      struct bitslice_word
+      {
+         static constexpr std::size_t lanes = 64 * words;
+
+         std::uint64_t w[words];
+
+         static inline bitslice_word zero()
+         {
+            bitslice_word r;
+
+            for (std::size_t i = 0; i < words; ++i)
+            {
+               r.w[i] = 0;
+            }
+
+            return r;
+         }
+
+         inline bitslice_word& operator^=(const bitslice_word& x)
+         {
+            for (std::size_t i = 0; i < words; ++i)
+            {
+               w[i] ^= x.w[i];
+            }
+
+            return *this;
+         }
+
+         inline bitslice_word& operator|=(const bitslice_word& x)
+         {
+            for (std::size_t i = 0; i < words; ++i)
+            {
+               w[i] |= x.w[i];
+            }
+
+            return *this;
+         }
+
+         inline bool test(const std::size_t lane) const
+         {
+            return (0 != ((w[lane >> 6] >> (lane & 63)) & 1));
+         }
+      };
+
+      typedef bitslice_word<1> bitslice64;
+      typedef bitslice_word<4> bitslice256;
+      typedef bitslice_word<8> bitslice512;
+
+      namespace details
+      {
+         template <typename Field, std::size_t fec_length>
+         struct bitsliced_generator
+         {
+            galois::field_symbol g[fec_length + 1];
+
+            /* g(x) = (x + alpha^i)(x + alpha^(i+1))...(x + alpha^(i+fec_length-1)) */
+            static constexpr bitsliced_generator make(const std::size_t initial_index)
+            {
+               bitsliced_generator r = {};
+
+               r.g[0] = 1;
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  const galois::field_symbol root = Field::alpha(static_cast<galois::field_symbol>(initial_index + k));
+
+                  for (std::size_t j = k + 1; j > 0; --j)
+                  {
+                     r.g[j] = r.g[j - 1] ^ Field::mul(r.g[j], root);
+                  }
+
+                  r.g[0] = Field::mul(r.g[0], root);
+               }
+
+               return r;
+            }
+         };
+
+         /*
+            Multiplication by a constant c is linear over GF(2): output bit
+            r is the xor of the input bits b for which bit r of c * 2^b is
+            set. The returned value is that set of input bits.
+         */
+         template <typename Field>
+         constexpr unsigned int bitsliced_mul_mask(const galois::field_symbol c, const unsigned int r)
+         {
+            unsigned int mask = 0;
+
+            for (unsigned int b = 0; b < Field::power; ++b)
+            {
+               if ((Field::mul(c, static_cast<galois::field_symbol>(1U << b)) >> r) & 1)
+               {
+                  mask |= (1U << b);
+               }
+            }
+
+            return mask;
+         }
+
+      } // namespace details
+
+      /*
+         Bitsliced encoder and syndrome computation for short Reed-Solomon
+         codes over a compile-time field (eg: RS(15,11) over GF(2^4)).
+
+         A symbol of 64 * words codewords is held as Field::power words,
+         one per bit plane. Every multiplication by a generator coefficient
+         or by a syndrome root is a fixed xor network, generated by the
+         compiler from the generator polynomial, so there are no table
+         lookups at all.
+
+         The generator is the one make_sequential_root_generator_polynomial
+         builds for gen_initial_index, and results are bit-exact with the
+         reed_solomon::encoder and the syndrome of reed_solomon::decoder
+         over the equivalent galois::field.
+      */
+      template <typename Field,
+                std::size_t code_length,
+                std::size_t fec_length,
+                std::size_t gen_initial_index,
+                typename Word = bitslice256>
+      class bitsliced_codec
+      {
+      public:
+
+         static_assert(code_length <= Field::field_size, "code length exceeds field size");
+         static_assert((fec_length > 0) && (fec_length < code_length), "invalid fec length");
+
+         typedef Word word_type;
+
+         static constexpr std::size_t data_length = code_length - fec_length;
+         static constexpr std::size_t power       = Field::power;
+         static constexpr std::size_t lanes       = Word::lanes;
+
+         /* One symbol of every lane, bit plane b in plane[b] */
+         struct symbol
+         {
+            Word plane[power];
+         };
+
+         /*
+            data  : [data_length] sliced data symbols
+            parity: [fec_length ] sliced parity symbols, parity[i] being
+                    block::fec(i) of every lane
+         */
+         static inline void encode(const symbol* data, symbol* parity)
+         {
+            symbol reg[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               clear(reg[k]);
+            }
+
+            for (std::size_t j = 0; j < data_length; ++j)
+            {
+               symbol feedback = data[j];
+
+               add(feedback, reg[fec_length - 1]);
+
+               shift<fec_length - 1>(reg, feedback);
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               parity[i] = reg[fec_length - 1 - i];
+            }
+         }
+
+         /*
+            codeword: [code_length] sliced codeword symbols
+            syndrome: [fec_length ] sliced syndromes, written
+
+            Returns the mask of lanes with a non-zero syndrome.
+         */
+         static inline Word syndrome(const symbol* codeword, symbol* syndrome)
+         {
+            evaluate<0>(codeword, syndrome);
+
+            Word dirty = Word::zero();
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               for (std::size_t b = 0; b < power; ++b)
+               {
+                  dirty |= syndrome[i].plane[b];
+               }
+            }
+
+            return dirty;
+         }
+
+         /*
+            Slice count <= lanes codewords of n symbols from a planar
+            byte layout, where symbol j of lane l is src[j * stride + l].
+            Lanes at or beyond count are zero.
+
+            Note: Eight lanes at a time, bit b of eight bytes is gathered
+                  into one byte by a single multiply, as the products of
+                  the magic constant never overlap.
+         */
+         static inline void pack(const std::uint8_t* src, const std::size_t stride,
+                                 const std::size_t count, const std::size_t n,
+                                 symbol* dst)
+         {
+            const std::size_t full = fast_path() ? (count & ~static_cast<std::size_t>(7)) : 0;
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+               clear(dst[j]);
+
+               const std::uint8_t* row = src + j * stride;
+
+               std::size_t l = 0;
+
+               #if defined(__SSE2__)
+               /* sixteen lanes at a time, pmovmskb gathers bit 7 of every byte */
+               for (; (l + 16) <= full; l += 16)
+               {
+                  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + l));
+
+                  for (std::size_t b = 0; b < power; ++b)
+                  {
+                     const std::uint64_t bits = static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_slli_epi16(x, static_cast<int>(7 - b))) & 0xFFFF);
+
+                     dst[j].plane[b].w[l >> 6] |= bits << (l & 63);
+                  }
+               }
+               #endif
+
+               for (; l < full; l += 8)
+               {
+                  std::uint64_t x;
+                  std::memcpy(&x, row + l, sizeof(x));
+
+                  for (std::size_t b = 0; b < power; ++b)
+                  {
+                     const std::uint64_t bits = (((x >> b) & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+
+                     dst[j].plane[b].w[l >> 6] |= bits << (l & 63);
+                  }
+               }
+
+               for (l = full; l < count; ++l)
+               {
+                  const std::uint64_t s = row[l];
+
+                  for (std::size_t b = 0; b < power; ++b)
+                  {
+                     dst[j].plane[b].w[l >> 6] |= ((s >> b) & 1) << (l & 63);
+                  }
+               }
+            }
+         }
+
+         /* Inverse of pack, only the first count lanes are written */
+         static inline void unpack(const symbol* src, const std::size_t n, const std::size_t count,
+                                   std::uint8_t* dst, const std::size_t stride)
+         {
+            const std::size_t full = fast_path() ? (count & ~static_cast<std::size_t>(7)) : 0;
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+               std::uint8_t* row = dst + j * stride;
+
+               for (std::size_t l = 0; l < full; l += 8)
+               {
+                  std::uint64_t x = 0;
+
+                  for (std::size_t b = 0; b < power; ++b)
+                  {
+                     /* spread eight bits, one to each byte, then normalise each byte to 0/1 */
+                     const std::uint64_t bits   = (src[j].plane[b].w[l >> 6] >> (l & 63)) & 0xFF;
+                     const std::uint64_t spread = (bits * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+
+                     x |= (((spread + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL) << b;
+                  }
+
+                  std::memcpy(row + l, &x, sizeof(x));
+               }
+
+               for (std::size_t l = full; l < count; ++l)
+               {
+                  unsigned int s = 0;
+
+                  for (std::size_t b = 0; b < power; ++b)
+                  {
+                     s |= static_cast<unsigned int>((src[j].plane[b].w[l >> 6] >> (l & 63)) & 1) << b;
+                  }
+
+                  row[l] = static_cast<std::uint8_t>(s);
+               }
+            }
+         }
+
+         /*
+            Planar byte interfaces, identical in layout to gf16_batch_codec:
+            symbol j of lane l at buffer[j * lanes + l], any number of lanes.
+         */
+         static inline void encode(const std::uint8_t* data, std::uint8_t* parity, const std::size_t count)
+         {
+            symbol sliced_data  [data_length];
+            symbol sliced_parity[fec_length ];
+
+            for (std::size_t l = 0; l < count; l += lanes)
+            {
+               const std::size_t n = ((count - l) < lanes) ? (count - l) : lanes;
+
+               pack(data + l, count, n, data_length, sliced_data);
+               encode(sliced_data, sliced_parity);
+               unpack(sliced_parity, fec_length, n, parity + l, count);
+            }
+         }
+
+         static inline std::size_t syndrome(const std::uint8_t* codeword, std::uint8_t* syndromes, const std::size_t count)
+         {
+            symbol sliced_codeword[code_length];
+            symbol sliced_syndrome[fec_length ];
+
+            std::size_t dirty_lanes = 0;
+
+            for (std::size_t l = 0; l < count; l += lanes)
+            {
+               const std::size_t n = ((count - l) < lanes) ? (count - l) : lanes;
+
+               pack(codeword + l, count, n, code_length, sliced_codeword);
+
+               const Word dirty = syndrome(sliced_codeword, sliced_syndrome);
+
+               unpack(sliced_syndrome, fec_length, n, syndromes + l, count);
+
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                  if (dirty.test(i))
+                     ++dirty_lanes;
+               }
+            }
+
+            return dirty_lanes;
+         }
+
+         static constexpr galois::field_symbol generator(const std::size_t i)
+         {
+            return generator_.g[i];
+         }
+
+      private:
+
+         typedef details::bitsliced_generator<Field, fec_length> generator_t;
+
+         static constexpr generator_t generator_ = generator_t::make(gen_initial_index);
+
+         /* The multiply based (un)packing assumes little endian byte order */
+         static constexpr bool fast_path()
+         {
+            #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+            return true;
+            #else
+            return false;
+            #endif
+         }
+
+         static inline void clear(symbol& s)
+         {
+            for (std::size_t b = 0; b < power; ++b)
+            {
+               s.plane[b] = Word::zero();
+            }
+         }
+
+         static inline void add(symbol& s, const symbol& x)
+         {
+            for (std::size_t b = 0; b < power; ++b)
+            {
+               s.plane[b] ^= x.plane[b];
+            }
+         }
+
+         template <unsigned int mask, std::size_t... B>
+         static inline void select_add(const symbol& x, Word& out, std::index_sequence<B...>)
+         {
+            ((((mask >> B) & 1) ? (void)(out ^= x.plane[B]) : (void)0), ...);
+         }
+
+         /* out += c * x */
+         template <galois::field_symbol c, std::size_t... R>
+         static inline void mul_add(const symbol& x, symbol& out, std::index_sequence<R...>)
+         {
+            (select_add<details::bitsliced_mul_mask<Field>(c, static_cast<unsigned int>(R))>(x, out.plane[R], std::make_index_sequence<power>()), ...);
+         }
+
+         template <galois::field_symbol c>
+         static inline void mul_add(const symbol& x, symbol& out)
+         {
+            mul_add<c>(x, out, std::make_index_sequence<power>());
+         }
+
+         /* reg[k] = reg[k - 1] + g[k] * feedback, for k = K..0 */
+         template <std::size_t K>
+         static inline void shift(symbol* reg, const symbol& feedback)
+         {
+            if constexpr (K > 0)
+            {
+               reg[K] = reg[K - 1];
+               mul_add<generator_.g[K]>(feedback, reg[K]);
+               shift<K - 1>(reg, feedback);
+            }
+            else
+            {
+               clear(reg[0]);
+               mul_add<generator_.g[0]>(feedback, reg[0]);
+            }
+         }
+
+         /* syndrome[I] = codeword(alpha^(gen_initial_index + I)), by Horner's rule */
+         template <std::size_t I>
+         static inline void evaluate(const symbol* codeword, symbol* syndrome)
+         {
+            if constexpr (I < fec_length)
+            {
+               constexpr galois::field_symbol root = Field::alpha(static_cast<galois::field_symbol>(gen_initial_index + I));
+
+               symbol s = codeword[0];
+
+               for (std::size_t j = 1; j < code_length; ++j)
+               {
+                  symbol t = codeword[j];
+                  mul_add<root>(s, t);
+                  s = t;
+               }
+
+               syndrome[I] = s;
+
+               evaluate<I + 1>(codeword, syndrome);
+            }
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
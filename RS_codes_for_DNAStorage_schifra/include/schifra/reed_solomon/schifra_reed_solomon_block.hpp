@@ -24,8 +24,11 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_BLOCK_HPP
 
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "schifra/core/galois_field/field.hpp"
 #include "schifra/utils/schifra_ecc_traits.hpp"
@@ -37,15 +40,23 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      /*
+         Note: symbol_t is the storage type of a codeword symbol. It defaults
+         to galois::field_symbol (int), but any unsigned type wide enough to
+         hold an element of the field may be used, eg: std::uint8_t for
+         GF(2^8) or std::uint16_t for GF(2^16), which shrinks the block by a
+         factor of 4 or 2 respectively.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
       struct block
       {
       public:
 
-         typedef galois::field_symbol symbol_type;
+         typedef symbol_t symbol_type;
          typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
          typedef traits::symbol<code_length> symbol;
-         typedef block<code_length,fec_length,data_length> block_t;
+         typedef block<code_length,fec_length,data_length,symbol_t> block_t;
 
          enum error_t
          {
@@ -56,7 +67,8 @@ namespace schifra
             e_decoder_error1 = 4,
             e_decoder_error2 = 5,
             e_decoder_error3 = 6,
-            e_decoder_error4 = 7
+            e_decoder_error4 = 7,
+            e_decoder_error5 = 8
          };
 
          block()
@@ -80,31 +92,31 @@ namespace schifra
 
             for (std::size_t i = 0; i < data_length; ++i)
             {
-               data[i] = static_cast<galois::field_symbol>(_data[i]);
+               data[i] = static_cast<symbol_type>(_data[i]);
             }
 
             for (std::size_t i = 0; i < fec_length; ++i)
             {
-               data[i + data_length] = static_cast<galois::field_symbol>(_fec[i]);
+               data[i + data_length] = static_cast<symbol_type>(_fec[i]);
             }
          }
 
-         galois::field_symbol& operator[](const std::size_t& index)
+         symbol_type& operator[](const std::size_t& index)
          {
             return data[index];
          }
 
-         const galois::field_symbol& operator[](const std::size_t& index) const
+         const symbol_type& operator[](const std::size_t& index) const
          {
             return data[index];
          }
 
-         galois::field_symbol& operator()(const std::size_t& index)
+         symbol_type& operator()(const std::size_t& index)
          {
             return operator[](index);
          }
 
-         galois::field_symbol& fec(const std::size_t& index)
+         symbol_type& fec(const std::size_t& index)
          {
             return data[data_length + index];
          }
@@ -150,7 +162,7 @@ namespace schifra
          {
             for (std::size_t i = 0; i < code_length; ++i)
             {
-               data[i] = value;
+               data[i] = static_cast<symbol_type>(value);
             }
          }
 
@@ -158,7 +170,7 @@ namespace schifra
          {
             for (std::size_t i = 0; i < data_length; ++i)
             {
-               data[i] = value;
+               data[i] = static_cast<symbol_type>(value);
             }
          }
 
@@ -166,7 +178,7 @@ namespace schifra
          {
             for (std::size_t i = 0; i < fec_length; ++i)
             {
-               data[data_length + i] = value;
+               data[data_length + i] = static_cast<symbol_type>(value);
             }
          }
 
@@ -202,6 +214,7 @@ namespace schifra
                case e_decoder_error2 : return "Decoder Failure - Too Many Errors/Erasures";
                case e_decoder_error3 : return "Decoder Failure - Invalid Symbol Correction";
                case e_decoder_error4 : return "Decoder Failure - Invalid Codeword Correction";
+               case e_decoder_error5 : return "Decoder Failure - Suspect Correction, Non-zero Syndrome";
                default               : return "Invalid Error Code";
             }
          }
@@ -211,11 +224,12 @@ namespace schifra
          std::size_t  zero_numerators;
          bool           unrecoverable;
          error_t                error;
-         galois::field_symbol data[code_length];
+         symbol_type          data[code_length];
       };
 
-      template <std::size_t code_length, std::size_t fec_length>
-      inline void copy(const block<code_length,fec_length>& src_block, block<code_length,fec_length>& dest_block)
+      template <std::size_t code_length, std::size_t fec_length, typename symbol_t>
+      inline void copy(const block<code_length,fec_length,code_length - fec_length,symbol_t>& src_block,
+                             block<code_length,fec_length,code_length - fec_length,symbol_t>& dest_block)
       {
          for (std::size_t index = 0; index < code_length; ++index)
          {
@@ -223,29 +237,29 @@ namespace schifra
          }
       }
 
-      template <typename T, std::size_t code_length, std::size_t fec_length>
-      inline void copy(const T src_data[], block<code_length,fec_length>& dest_block)
+      template <typename T, std::size_t code_length, std::size_t fec_length, typename symbol_t>
+      inline void copy(const T src_data[], block<code_length,fec_length,code_length - fec_length,symbol_t>& dest_block)
       {
          for (std::size_t index = 0; index < (code_length - fec_length); ++index, ++src_data)
          {
-            dest_block.data[index] = static_cast<typename block<code_length,fec_length>::symbol_type>(*src_data);
+            dest_block.data[index] = static_cast<symbol_t>(*src_data);
          }
       }
 
-      template <typename T, std::size_t code_length, std::size_t fec_length>
+      template <typename T, std::size_t code_length, std::size_t fec_length, typename symbol_t>
       inline void copy(const T src_data[],
                        const std::size_t& src_length,
-                       block<code_length,fec_length>& dest_block)
+                       block<code_length,fec_length,code_length - fec_length,symbol_t>& dest_block)
       {
          for (std::size_t index = 0; index < src_length; ++index, ++src_data)
          {
-            dest_block.data[index] = static_cast<typename block<code_length,fec_length>::symbol_type>(*src_data);
+            dest_block.data[index] = static_cast<symbol_t>(*src_data);
          }
       }
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t stack_size>
-      inline void copy(const block<code_length,fec_length>  src_block_stack[stack_size],
-                             block<code_length,fec_length> dest_block_stack[stack_size])
+      template <std::size_t code_length, std::size_t fec_length, std::size_t stack_size, typename symbol_t>
+      inline void copy(const block<code_length,fec_length,code_length - fec_length,symbol_t>  src_block_stack[stack_size],
+                             block<code_length,fec_length,code_length - fec_length,symbol_t> dest_block_stack[stack_size])
       {
          for (std::size_t row = 0; row < stack_size; ++row)
          {
@@ -253,10 +267,10 @@ namespace schifra
          }
       }
 
-      template <typename T, std::size_t code_length, std::size_t fec_length, std::size_t stack_size>
+      template <typename T, std::size_t code_length, std::size_t fec_length, std::size_t stack_size, typename symbol_t>
       inline bool copy(const T src_data[],
                        const std::size_t src_length,
-                       block<code_length,fec_length> dest_block_stack[stack_size])
+                       block<code_length,fec_length,code_length - fec_length,symbol_t> dest_block_stack[stack_size])
       {
          const std::size_t data_length = code_length - fec_length;
 
@@ -280,8 +294,8 @@ namespace schifra
          return true;
       }
 
-      template <typename T, std::size_t code_length, std::size_t fec_length>
-      inline void full_copy(const block<code_length,fec_length>& src_block,
+      template <typename T, std::size_t code_length, std::size_t fec_length, typename symbol_t>
+      inline void full_copy(const block<code_length,fec_length,code_length - fec_length,symbol_t>& src_block,
                             T dest_data[])
       {
          for (std::size_t i = 0; i < code_length; ++i, ++dest_data)
@@ -290,8 +304,8 @@ namespace schifra
          }
       }
 
-      template <typename T, std::size_t code_length, std::size_t fec_length, std::size_t stack_size>
-      inline void copy(const block<code_length,fec_length> src_block_stack[stack_size],
+      template <typename T, std::size_t code_length, std::size_t fec_length, std::size_t stack_size, typename symbol_t>
+      inline void copy(const block<code_length,fec_length,code_length - fec_length,symbol_t> src_block_stack[stack_size],
                        T dest_data[])
       {
          const std::size_t data_length = code_length - fec_length;
@@ -305,8 +319,8 @@ namespace schifra
          }
       }
 
-      template <std::size_t code_length, std::size_t fec_length>
-      inline std::ostream& operator<<(std::ostream& os, const block<code_length,fec_length>& rs_block)
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length, typename symbol_t>
+      inline std::ostream& operator<<(std::ostream& os, const block<code_length,fec_length,data_length,symbol_t>& rs_block)
       {
          for (std::size_t i = 0; i < code_length; ++i)
          {
@@ -373,8 +387,299 @@ namespace schifra
          }
       }
 
+      /*
+         Decode results of a batch of codewords held apart from their
+         symbols, so that codewords can sit back to back in a dense buffer
+         and a batch decoder touches one byte per clean codeword instead of
+         the status members of each block. error[b] is the block::error_t
+         of codeword b (e_no_error once it decoded) and corrected[b] the
+         number of symbols corrected in it.
+      */
+      struct batch_status
+      {
+         void reset(const std::size_t count)
+         {
+            error    .assign(count, 0);
+            corrected.assign(count, 0);
+         }
+
+         inline std::size_t size() const
+         {
+            return error.size();
+         }
+
+         inline bool unrecoverable(const std::size_t b) const
+         {
+            return (0 != error[b]);
+         }
+
+         std::vector<std::uint8_t>  error;
+         std::vector<std::uint16_t> corrected;
+      };
+
       typedef std::vector<std::size_t> erasure_locations_t;
 
+      /*
+         The erasure positions of a block of code_length symbols as a bit
+         mask, bit i standing for block[i]. Unlike an erasure_locations_t
+         it lives inline, so passing erasures for every block costs no
+         allocation, and duplicate positions cannot occur.
+      */
+      template <std::size_t code_length>
+      class erasure_mask
+      {
+      public:
+
+         static constexpr std::size_t word_count = (code_length + 63) / 64;
+
+         erasure_mask()
+         {
+            clear();
+         }
+
+         explicit erasure_mask(const erasure_locations_t& erasure_list)
+         {
+            clear();
+
+            for (std::size_t i = 0; i < erasure_list.size(); ++i)
+            {
+               set(erasure_list[i]);
+            }
+         }
+
+         inline void clear()
+         {
+            for (std::size_t i = 0; i < word_count; ++i)
+            {
+               word_[i] = 0;
+            }
+         }
+
+         inline void set(const std::size_t& position)
+         {
+            if (position < code_length)
+               word_[position / 64] |= static_cast<std::uint64_t>(1) << (position % 64);
+         }
+
+         inline void reset(const std::size_t& position)
+         {
+            if (position < code_length)
+               word_[position / 64] &= ~(static_cast<std::uint64_t>(1) << (position % 64));
+         }
+
+         inline bool test(const std::size_t& position) const
+         {
+            return (position < code_length) && (0 != (word_[position / 64] & (static_cast<std::uint64_t>(1) << (position % 64))));
+         }
+
+         inline bool empty() const
+         {
+            std::uint64_t any = 0;
+
+            for (std::size_t i = 0; i < word_count; ++i)
+            {
+               any |= word_[i];
+            }
+
+            return (0 == any);
+         }
+
+         inline std::size_t size() const
+         {
+            std::size_t count = 0;
+
+            for (std::size_t i = 0; i < word_count; ++i)
+            {
+               count += popcount(word_[i]);
+            }
+
+            return count;
+         }
+
+         /* Calls f(position) for every erased position, in increasing order */
+         template <typename Function>
+         inline void for_each(Function f) const
+         {
+            for (std::size_t i = 0; i < word_count; ++i)
+            {
+               for (std::uint64_t w = word_[i]; 0 != w; w &= (w - 1))
+               {
+                  f(64 * i + lowest_bit(w));
+               }
+            }
+         }
+
+         inline const std::uint64_t* words() const
+         {
+            return word_;
+         }
+
+      private:
+
+         static inline std::size_t popcount(std::uint64_t w)
+         {
+            #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_popcountll(w));
+            #else
+            std::size_t count = 0;
+            for (; 0 != w; w &= (w - 1)) ++count;
+            return count;
+            #endif
+         }
+
+         static inline std::size_t lowest_bit(const std::uint64_t w)
+         {
+            #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_ctzll(w));
+            #else
+            std::size_t index = 0;
+            while (0 == (w & (static_cast<std::uint64_t>(1) << index))) ++index;
+            return index;
+            #endif
+         }
+
+         std::uint64_t word_[word_count];
+      };
+
+      /*
+         The parity symbols, by index in block::fec(i) order, left out of
+         stored codewords. A codeword of RS(n,k) punctured by p symbols is
+         stored as its n - p remaining symbols and decoded with the p
+         missing ones as erasures, ie: as an RS(n - p,k) code correcting
+         (fec_length - p) / 2 errors. One encoder and decoder so serve
+         every rate from k / n to k / (k + 1), the redundancy of a dataset
+         being chosen at run time. Any p parity symbols may be punctured,
+         the punctured code is MDS whichever they are.
+      */
+      class puncture_mask
+      {
+      public:
+
+         puncture_mask()
+         : fec_length_(0)
+         {}
+
+         /* Nothing punctured */
+         explicit puncture_mask(const std::size_t fec_length)
+         : fec_length_(fec_length),
+           punctured_(fec_length, false)
+         {
+            update();
+         }
+
+         /* The last count parity symbols punctured */
+         static inline puncture_mask tail(const std::size_t fec_length, const std::size_t count)
+         {
+            puncture_mask mask(fec_length);
+
+            for (std::size_t i = (count < fec_length) ? (fec_length - count) : 0; i < fec_length; ++i)
+            {
+               mask.puncture(i);
+            }
+
+            return mask;
+         }
+
+         inline bool puncture(const std::size_t index)
+         {
+            if (index >= fec_length_)
+               return false;
+
+            punctured_[index] = true;
+            update();
+
+            return true;
+         }
+
+         inline bool punctured(const std::size_t index) const
+         {
+            return (index < fec_length_) && punctured_[index];
+         }
+
+         inline std::size_t fec_length() const
+         {
+            return fec_length_;
+         }
+
+         inline std::size_t punctured_count() const
+         {
+            return fec_length_ - kept_.size();
+         }
+
+         inline std::size_t kept_count() const
+         {
+            return kept_.size();
+         }
+
+         /* Stored length of a codeword of code_length symbols */
+         inline std::size_t stored_length(const std::size_t code_length) const
+         {
+            return code_length - punctured_count();
+         }
+
+         /* The kept symbols of fec_length parity symbols, in order */
+         template <typename T, typename U>
+         inline void compress(const T* parity, U* kept) const
+         {
+            for (std::size_t i = 0; i < kept_.size(); ++i)
+            {
+               kept[i] = static_cast<U>(parity[kept_[i]]);
+            }
+         }
+
+         /* fec_length parity symbols from the kept ones, the punctured ones zero */
+         template <typename T, typename U>
+         inline void expand(const T* kept, U* parity) const
+         {
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               parity[i] = 0;
+            }
+
+            for (std::size_t i = 0; i < kept_.size(); ++i)
+            {
+               parity[kept_[i]] = static_cast<U>(kept[i]);
+            }
+         }
+
+         /* Appends the punctured positions of a codeword whose parity starts at data_length */
+         inline void erasures(const std::size_t data_length, erasure_locations_t& erasure_list) const
+         {
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               if (punctured_[i])
+                  erasure_list.push_back(data_length + i);
+            }
+         }
+
+         template <std::size_t code_length>
+         inline void erasures(const std::size_t data_length, erasure_mask<code_length>& erasure_list) const
+         {
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               if (punctured_[i])
+                  erasure_list.set(data_length + i);
+            }
+         }
+
+      private:
+
+         inline void update()
+         {
+            kept_.clear();
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               if (!punctured_[i])
+                  kept_.push_back(i);
+            }
+         }
+
+         std::size_t              fec_length_;
+         std::vector<bool>        punctured_;
+         std::vector<std::size_t> kept_;
+      };
+
    } // namespace reed_solomon
 
 } // namepsace schifra
@@ -0,0 +1,270 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_BLOCK_STACK_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_BLOCK_STACK_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/utils/schifra_span.hpp"
+#include "schifra/utils/schifra_transpose.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         A stack of row_count codewords held as one column-major symbol
+         matrix, symbol i of row r living at data()[i * row_count + r], with
+         the per-row decoding status kept apart from the symbols. Each
+         column(i) is therefore the same symbol position of every row, laid
+         out contiguously, which is the planar layout the multi-codeword
+         kernels (eg: gf16_batch_codec with lanes = row_count and symbol_t =
+         std::uint8_t) work on directly: the data symbols are data() and the
+         parity symbols data() + data_length * row_count.
+
+         The same buffer read in row-major order is the stack interleaved
+         as interleave() does for an array of blocks, so interleaved_row()
+         is a view without any copy, while interleave()/deinterleave() turn
+         the stack itself over with a blocked transpose.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count,
+                typename symbol_t = galois::field_symbol>
+      class block_stack
+      {
+      public:
+
+         static const std::size_t data_length = code_length - fec_length;
+
+         typedef symbol_t                                               symbol_type;
+         typedef block<code_length,fec_length,data_length,symbol_t>     block_type;
+         typedef typename block_type::error_t                           error_t;
+
+         struct row_status
+         {
+            row_status()
+            : errors_detected (0),
+              errors_corrected(0),
+              zero_numerators (0),
+              unrecoverable(false),
+              error(block_type::e_no_error)
+            {}
+
+            std::size_t errors_detected;
+            std::size_t errors_corrected;
+            std::size_t zero_numerators;
+            bool        unrecoverable;
+            error_t     error;
+         };
+
+         block_stack()
+         : symbols_(code_length * row_count, symbol_type(0)),
+           status_ (row_count)
+         {
+            traits::validate_reed_solomon_block_parameters<code_length,fec_length,data_length>();
+         }
+
+         static inline std::size_t rows()
+         {
+            return row_count;
+         }
+
+         inline symbol_type& operator()(const std::size_t& row, const std::size_t& index)
+         {
+            return symbols_[index * row_count + row];
+         }
+
+         inline const symbol_type& operator()(const std::size_t& row, const std::size_t& index) const
+         {
+            return symbols_[index * row_count + row];
+         }
+
+         /* Symbol index of every row, row_count contiguous symbols */
+         inline symbol_type* column(const std::size_t& index)
+         {
+            return &symbols_[index * row_count];
+         }
+
+         inline const symbol_type* column(const std::size_t& index) const
+         {
+            return &symbols_[index * row_count];
+         }
+
+         inline symbol_type* data()
+         {
+            return symbols_.data();
+         }
+
+         inline const symbol_type* data() const
+         {
+            return symbols_.data();
+         }
+
+         inline row_status& status(const std::size_t& row)
+         {
+            return status_[row];
+         }
+
+         inline const row_status& status(const std::size_t& row) const
+         {
+            return status_[row];
+         }
+
+         /*
+            Row r of the interleaved stack, ie: row r of what interleave()
+            produces for the equivalent array of blocks.
+         */
+         inline utils::span<symbol_type> interleaved_row(const std::size_t& row)
+         {
+            return utils::span<symbol_type>(&symbols_[row * code_length], code_length);
+         }
+
+         inline utils::span<const symbol_type> interleaved_row(const std::size_t& row) const
+         {
+            return utils::span<const symbol_type>(&symbols_[row * code_length], code_length);
+         }
+
+         void load(const block_type (&blocks)[row_count])
+         {
+            for (std::size_t r = 0; r < row_count; ++r)
+            {
+               load_row(r, blocks[r]);
+            }
+         }
+
+         void store(block_type (&blocks)[row_count]) const
+         {
+            for (std::size_t r = 0; r < row_count; ++r)
+            {
+               store_row(r, blocks[r]);
+            }
+         }
+
+         inline void load_row(const std::size_t& row, const block_type& rsblock)
+         {
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               symbols_[i * row_count + row] = rsblock[i];
+            }
+
+            row_status& s      = status_[row];
+            s.errors_detected  = rsblock.errors_detected;
+            s.errors_corrected = rsblock.errors_corrected;
+            s.zero_numerators  = rsblock.zero_numerators;
+            s.unrecoverable    = rsblock.unrecoverable;
+            s.error            = rsblock.error;
+         }
+
+         inline void store_row(const std::size_t& row, block_type& rsblock) const
+         {
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               rsblock[i] = symbols_[i * row_count + row];
+            }
+
+            const row_status& s      = status_[row];
+            rsblock.errors_detected  = s.errors_detected;
+            rsblock.errors_corrected = s.errors_corrected;
+            rsblock.zero_numerators  = s.zero_numerators;
+            rsblock.unrecoverable    = s.unrecoverable;
+            rsblock.error            = s.error;
+         }
+
+         /*
+            Load an interleaved array of blocks, the stack then holds them
+            deinterleaved, as deinterleave() would leave the array.
+         */
+         void load_interleaved(const block_type (&blocks)[row_count])
+         {
+            for (std::size_t r = 0; r < row_count; ++r)
+            {
+               std::copy(blocks[r].data, blocks[r].data + code_length, &symbols_[r * code_length]);
+            }
+         }
+
+         /* Store the stack interleaved, as interleave() would leave the array */
+         void store_interleaved(block_type (&blocks)[row_count]) const
+         {
+            for (std::size_t r = 0; r < row_count; ++r)
+            {
+               std::copy(&symbols_[r * code_length], &symbols_[r * code_length] + code_length, blocks[r].data);
+            }
+         }
+
+         /*
+            Note: As with the block array versions, only the symbols move,
+                  the row status is left as is.
+         */
+         inline void interleave()
+         {
+            transpose(row_count, code_length);
+         }
+
+         inline void deinterleave()
+         {
+            transpose(code_length, row_count);
+         }
+
+         inline void clear_status()
+         {
+            std::fill(status_.begin(), status_.end(), row_status());
+         }
+
+      private:
+
+         /*
+            Replace the row-major height x width matrix held in symbols_ by
+            its transpose.
+         */
+         void transpose(const std::size_t height, const std::size_t width)
+         {
+            scratch_.resize(symbols_.size());
+
+            const symbol_type* src = symbols_.data();
+                  symbol_type* dst = scratch_.data();
+
+            utils::transpose<symbol_type>(height, width,
+                                          [&](const std::size_t r) { return src + (r * width ); },
+                                          [&](const std::size_t c) { return dst + (c * height); });
+
+            symbols_.swap(scratch_);
+         }
+
+         std::vector<symbol_type> symbols_;
+         std::vector<symbol_type> scratch_;
+         std::vector<row_status>  status_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
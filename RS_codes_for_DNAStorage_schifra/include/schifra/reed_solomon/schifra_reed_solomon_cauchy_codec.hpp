@@ -0,0 +1,407 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CAUCHY_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CAUCHY_CODEC_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/region.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Systematic k + m erasure code over byte regions, in the manner of
+         ISA-L's ec_encode_data. Shards 0..k-1 hold the data, shards
+         k..k+m-1 the parity, and any k of the k + m shards recover the
+         rest. Parity row i is the Cauchy row 1 / (x_i + y_j) with
+         x_i = k + i and y_j = j, so every k x k submatrix of [I ; C] is
+         invertible (MDS) as long as k + m does not exceed the 2^w elements
+         of the field.
+
+         Shards are independent of the codeword layout, they can be any
+         length and every byte is one GF(2^w) symbol (w <= 8), all of the
+         arithmetic being galois::region multiply-accumulate kernels.
+
+         The decode matrix of a failure pattern is the inverse of the k x k
+         submatrix of the surviving rows used for recovery, which costs
+         O(k^3) to obtain. It is kept, along with its region multipliers,
+         in a small LRU cache keyed by the missing shard set, so that
+         repeated recovery with one pattern (eg: a whole pool or storage
+         node lost) is only the region products.
+      */
+      class cauchy_erasure_codec
+      {
+      public:
+
+         /* Bytes of each shard processed per pass, sized to keep the outputs in L1 */
+         static constexpr std::size_t chunk_size = 8192;
+
+         cauchy_erasure_codec(const galois::field& gfield,
+                              const std::size_t data_shards,
+                              const std::size_t parity_shards,
+                              const std::size_t pattern_cache_size = 8)
+         : field_(gfield),
+           data_shards_(data_shards),
+           parity_shards_(parity_shards),
+           valid_((gfield.pwr() <= 8) &&
+                  (data_shards   > 0)  &&
+                  (parity_shards > 0)  &&
+                  ((data_shards + parity_shards) <= (gfield.size() + 1))),
+           pattern_cache_size_((0 == pattern_cache_size) ? 1 : pattern_cache_size),
+           pattern_clock_(0)
+         {
+            if (valid_)
+            {
+               create_encode_matrix();
+            }
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline std::size_t data_shards() const
+         {
+            return data_shards_;
+         }
+
+         inline std::size_t parity_shards() const
+         {
+            return parity_shards_;
+         }
+
+         inline std::size_t total_shards() const
+         {
+            return data_shards_ + parity_shards_;
+         }
+
+         /* Coefficient of data shard j in parity shard i */
+         inline galois::field_symbol coefficient(const std::size_t i, const std::size_t j) const
+         {
+            return encode_matrix_[i * data_shards_ + j];
+         }
+
+         /*
+            data  : data_shards pointers to length bytes each
+            parity: parity_shards pointers to length bytes each, written
+         */
+         inline bool encode(const std::uint8_t* const* data, std::uint8_t* const* parity, const std::size_t length) const
+         {
+            if (!valid_)
+               return false;
+
+            matrix_multiply(encode_multiplier_.data(), parity_shards_, data, parity, length);
+
+            return true;
+         }
+
+         /*
+            shards : total_shards pointers to length bytes each, the shards
+                     listed in missing are rebuilt in place from the others.
+
+            Note: 1. Missing shard indices must be unique.
+                  2. Missing shard indices must be below total_shards().
+                  3. At most parity_shards shards may be missing.
+                  There are NO exceptions to these rules!
+         */
+         bool decode(std::uint8_t* const* shards, const erasure_locations_t& missing, const std::size_t length) const
+         {
+            if (!valid_ || (missing.size() > parity_shards_))
+               return false;
+            else if (missing.empty())
+               return true;
+
+            for (std::size_t i = 0; i < missing.size(); ++i)
+            {
+               if (missing[i] >= total_shards())
+                  return false;
+            }
+
+            const std::shared_ptr<const recovery_pattern> pattern = lookup_pattern(missing);
+
+            if (!pattern)
+               return false;
+
+            std::vector<const std::uint8_t*> source(data_shards_);
+            std::vector<std::uint8_t*>       target(pattern->missing.size());
+
+            for (std::size_t i = 0; i < data_shards_; ++i)
+            {
+               source[i] = shards[pattern->source[i]];
+            }
+
+            for (std::size_t i = 0; i < pattern->missing.size(); ++i)
+            {
+               target[i] = shards[pattern->missing[i]];
+            }
+
+            matrix_multiply(pattern->multiplier.data(), target.size(), source.data(), target.data(), length);
+
+            return true;
+         }
+
+      private:
+
+         cauchy_erasure_codec(const cauchy_erasure_codec&);
+         cauchy_erasure_codec& operator=(const cauchy_erasure_codec&);
+
+         /*
+            Rows of the decode matrix, one per missing shard, each taking
+            the data_shards surviving shards listed in source.
+         */
+         struct recovery_pattern
+         {
+            erasure_locations_t                     missing;
+            std::vector<std::size_t>                source;
+            std::vector<galois::region::multiplier> multiplier;
+         };
+
+         struct cache_entry
+         {
+            std::shared_ptr<const recovery_pattern> pattern;
+            unsigned long long                      last_used;
+         };
+
+         void create_encode_matrix()
+         {
+            encode_matrix_.resize(parity_shards_ * data_shards_);
+            encode_multiplier_.reserve(parity_shards_ * data_shards_);
+
+            for (std::size_t i = 0; i < parity_shards_; ++i)
+            {
+               for (std::size_t j = 0; j < data_shards_; ++j)
+               {
+                  const galois::field_symbol x = static_cast<galois::field_symbol>(data_shards_ + i);
+                  const galois::field_symbol y = static_cast<galois::field_symbol>(j);
+
+                  encode_matrix_[i * data_shards_ + j] = field_.inverse(field_.add(x, y));
+                  encode_multiplier_.push_back(galois::region::make_multiplier(field_, encode_matrix_[i * data_shards_ + j]));
+               }
+            }
+         }
+
+         /* Row r of the generator matrix [I ; C] */
+         inline galois::field_symbol generator(const std::size_t r, const std::size_t j) const
+         {
+            if (r < data_shards_)
+               return (r == j) ? 1 : 0;
+            else
+               return encode_matrix_[(r - data_shards_) * data_shards_ + j];
+         }
+
+         std::shared_ptr<const recovery_pattern> lookup_pattern(const erasure_locations_t& missing) const
+         {
+            erasure_locations_t key = missing;
+            std::sort(key.begin(), key.end());
+
+            std::lock_guard<std::mutex> lock(pattern_mutex_);
+
+            std::size_t victim = 0;
+
+            for (std::size_t i = 0; i < pattern_cache_.size(); ++i)
+            {
+               if (pattern_cache_[i].pattern->missing == key)
+               {
+                  pattern_cache_[i].last_used = ++pattern_clock_;
+                  return pattern_cache_[i].pattern;
+               }
+               else if (pattern_cache_[i].last_used < pattern_cache_[victim].last_used)
+                  victim = i;
+            }
+
+            std::shared_ptr<recovery_pattern> pattern = std::make_shared<recovery_pattern>();
+
+            if (!create_pattern(key, *pattern))
+               return std::shared_ptr<const recovery_pattern>();
+
+            if (pattern_cache_.size() < pattern_cache_size_)
+            {
+               victim = pattern_cache_.size();
+               pattern_cache_.push_back(cache_entry());
+            }
+
+            pattern_cache_[victim].pattern   = pattern;
+            pattern_cache_[victim].last_used = ++pattern_clock_;
+
+            return pattern;
+         }
+
+         bool create_pattern(const erasure_locations_t& key, recovery_pattern& pattern) const
+         {
+            const std::size_t k = data_shards_;
+
+            if (std::adjacent_find(key.begin(), key.end()) != key.end())
+               return false;
+
+            pattern.missing = key;
+            pattern.source.clear();
+
+            for (std::size_t r = 0, m = 0; (r < total_shards()) && (pattern.source.size() < k); ++r)
+            {
+               if ((m < key.size()) && (key[m] == r))
+                  ++m;
+               else
+                  pattern.source.push_back(r);
+            }
+
+            /*
+               Gauss-Jordan inversion of the surviving rows: matrix is held
+               as [A | I] with A the k x k submatrix of [I ; C].
+            */
+            std::vector<galois::field_symbol> matrix(k * 2 * k, 0);
+
+            for (std::size_t i = 0; i < k; ++i)
+            {
+               for (std::size_t j = 0; j < k; ++j)
+               {
+                  matrix[i * 2 * k + j] = generator(pattern.source[i], j);
+               }
+
+               matrix[i * 2 * k + k + i] = 1;
+            }
+
+            for (std::size_t c = 0; c < k; ++c)
+            {
+               std::size_t pivot = c;
+
+               while ((pivot < k) && (0 == matrix[pivot * 2 * k + c]))
+               {
+                  ++pivot;
+               }
+
+               if (pivot == k)
+                  return false;
+
+               if (pivot != c)
+               {
+                  std::swap_ranges(matrix.begin() + pivot * 2 * k,
+                                   matrix.begin() + (pivot + 1) * 2 * k,
+                                   matrix.begin() + c * 2 * k);
+               }
+
+               const galois::field_symbol scale = field_.inverse(matrix[c * 2 * k + c]);
+
+               for (std::size_t j = 0; j < 2 * k; ++j)
+               {
+                  matrix[c * 2 * k + j] = field_.mul(matrix[c * 2 * k + j], scale);
+               }
+
+               for (std::size_t i = 0; i < k; ++i)
+               {
+                  const galois::field_symbol factor = matrix[i * 2 * k + c];
+
+                  if ((i == c) || (0 == factor))
+                     continue;
+
+                  for (std::size_t j = 0; j < 2 * k; ++j)
+                  {
+                     matrix[i * 2 * k + j] ^= field_.mul(factor, matrix[c * 2 * k + j]);
+                  }
+               }
+            }
+
+            /*
+               A missing data shard d is row d of the inverse, a missing
+               parity shard is its generator row times the inverse.
+            */
+            pattern.multiplier.clear();
+            pattern.multiplier.reserve(key.size() * k);
+
+            for (std::size_t m = 0; m < key.size(); ++m)
+            {
+               for (std::size_t j = 0; j < k; ++j)
+               {
+                  galois::field_symbol value = 0;
+
+                  for (std::size_t t = 0; t < k; ++t)
+                  {
+                     value ^= field_.mul(generator(key[m], t), matrix[t * 2 * k + k + j]);
+                  }
+
+                  pattern.multiplier.push_back(galois::region::make_multiplier(field_, value));
+               }
+            }
+
+            return true;
+         }
+
+         /*
+            output[i] = sum_j coefficient[i][j] * input[j], chunked so the
+            outputs stay cache resident while the inputs stream through.
+         */
+         inline void matrix_multiply(const galois::region::multiplier* multiplier,
+                                     const std::size_t outputs,
+                                     const std::uint8_t* const* input,
+                                     std::uint8_t* const* output,
+                                     const std::size_t length) const
+         {
+            for (std::size_t offset = 0; offset < length; offset += chunk_size)
+            {
+               const std::size_t size = std::min(chunk_size, length - offset);
+
+               for (std::size_t i = 0; i < outputs; ++i)
+               {
+                  std::memset(output[i] + offset, 0, size);
+
+                  for (std::size_t j = 0; j < data_shards_; ++j)
+                  {
+                     galois::region::mul_add(multiplier[i * data_shards_ + j], input[j] + offset, output[i] + offset, size);
+                  }
+               }
+            }
+         }
+
+         const galois::field&                               field_;
+         const std::size_t                                  data_shards_;
+         const std::size_t                                  parity_shards_;
+         const bool                                         valid_;
+         std::vector<galois::field_symbol>                  encode_matrix_;
+         std::vector<galois::region::multiplier>            encode_multiplier_;
+         const std::size_t                                  pattern_cache_size_;
+         mutable std::vector<cache_entry>                   pattern_cache_;
+         mutable unsigned long long                         pattern_clock_;
+         mutable std::mutex                                 pattern_mutex_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
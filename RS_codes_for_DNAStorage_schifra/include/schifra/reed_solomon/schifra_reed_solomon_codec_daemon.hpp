@@ -0,0 +1,807 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_DAEMON_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_DAEMON_HPP
+
+
+#if defined(__linux__)
+
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Shared memory layout of a codec_daemon, through which its clients
+         hand it jobs. The region, named by the daemon, holds a header,
+         then channels of ring_slots slots each, one channel per
+         connected client, then the slots' payloads of slot_size bytes:
+         codewords of code_length symbols (one byte each), data then
+         parity, back to back. Jobs are encoded or decoded in place in
+         the payload, so codewords never go through a socket or pipe.
+
+         A slot goes free -> submitted (client) -> running -> done
+         (daemon) -> free (client). The client bumps the header's doorbell
+         after submitting, the daemon sets done once every codeword of
+         the job has been processed, and each side sleeps on the futex
+         of the word it waits for, only being woken when it said it is
+         sleeping.
+      */
+      namespace codec_ipc
+      {
+
+         static constexpr std::uint64_t magic      = 0x5343484946524144ULL; /* "SCHIFRAD" */
+         static constexpr std::uint32_t version    = 1;
+         static constexpr std::size_t   line_size  = 64;
+
+         enum operation
+         {
+            e_encode = 1,
+            e_decode = 2
+         };
+
+         enum slot_state
+         {
+            e_free      = 0,
+            e_submitted = 1,
+            e_running   = 2,
+            e_done      = 3
+         };
+
+         struct alignas(line_size) region_header
+         {
+            std::uint64_t              magic;
+            std::uint32_t              version;
+            std::uint32_t              code_length;
+            std::uint32_t              fec_length;
+            std::uint32_t              channels;
+            std::uint32_t              ring_slots;
+            std::uint32_t              slot_size;
+            std::uint32_t              daemon_pid;
+            std::atomic<std::uint32_t> running;
+
+            alignas(line_size) std::atomic<std::uint32_t> doorbell;
+            std::atomic<std::uint32_t>                    daemon_sleeping;
+         };
+
+         struct alignas(line_size) channel_header
+         {
+            std::atomic<std::uint32_t> owner;
+         };
+
+         struct alignas(line_size) slot_header
+         {
+            std::atomic<std::uint32_t> state;
+            std::atomic<std::uint32_t> client_waiting;
+            std::uint32_t              operation;
+            std::uint32_t              count;
+            std::uint32_t              succeeded;
+            std::uint32_t              error;
+         };
+
+         inline std::size_t channel_offset(const std::size_t channel, const std::size_t ring_slots)
+         {
+            return sizeof(region_header) + channel * (sizeof(channel_header) + ring_slots * sizeof(slot_header));
+         }
+
+         inline std::size_t slot_offset(const std::size_t channel, const std::size_t slot, const std::size_t ring_slots)
+         {
+            return channel_offset(channel, ring_slots) + sizeof(channel_header) + slot * sizeof(slot_header);
+         }
+
+         inline std::size_t payload_offset(const std::size_t channel,
+                                           const std::size_t slot,
+                                           const std::size_t channels,
+                                           const std::size_t ring_slots,
+                                           const std::size_t slot_size)
+         {
+            return channel_offset(channels, ring_slots) + (channel * ring_slots + slot) * slot_size;
+         }
+
+         inline std::size_t region_size(const std::size_t channels, const std::size_t ring_slots, const std::size_t slot_size)
+         {
+            return payload_offset(channels, 0, channels, ring_slots, slot_size);
+         }
+
+         /* Process shared futex wait on word while it holds expected, for at most timeout_ms */
+         inline void futex_wait(std::atomic<std::uint32_t>& word, const std::uint32_t expected, const long timeout_ms)
+         {
+            timespec timeout;
+
+            timeout.tv_sec  = timeout_ms / 1000;
+            timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, 0, 0);
+         }
+
+         inline void futex_wake(std::atomic<std::uint32_t>& word)
+         {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, 0, 0, 0);
+         }
+
+         inline bool process_alive(const std::uint32_t pid)
+         {
+            return (0 == ::kill(static_cast<pid_t>(pid), 0)) || (EPERM == errno);
+         }
+
+      } // namespace codec_ipc
+
+      /*
+         Long running encode/decode service for short lived local
+         processes. The daemon creates the shared memory region name (eg:
+         "/schifra-rs255"), keeps a codec_executor of threads warm workers
+         (0 for the tuned or hardware count), and run() dispatches the
+         jobs codec_client processes submit until stop() is called. A job
+         is split over the workers as an executor batch is, and its
+         codewords are processed where the client wrote them.
+
+         Channels whose client died are reclaimed once none of their jobs
+         are in flight. The region is created with mode 0600, so only
+         processes of the daemon's user can connect.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class codec_daemon
+      {
+      public:
+
+         typedef codec_executor<code_length,fec_length> executor_type;
+         typedef typename executor_type::context        context;
+
+         static constexpr std::size_t default_channels   = 16;
+         static constexpr std::size_t default_ring_slots = 8;
+         static constexpr std::size_t default_slot_size  = 1024 * 1024;
+
+         codec_daemon(const galois::field&            field,
+                      const galois::field_polynomial& generator,
+                      const unsigned int              gen_initial_index,
+                      const std::string&              name,
+                      const std::size_t               threads    = 0,
+                      const std::size_t               channels   = default_channels,
+                      const std::size_t               ring_slots = default_ring_slots,
+                      const std::size_t               slot_size  = default_slot_size)
+         : name_(name),
+           channels_(std::max<std::size_t>(1, channels)),
+           ring_slots_(std::max<std::size_t>(1, ring_slots)),
+           slot_size_(std::max<std::size_t>(code_length, slot_size)),
+           size_(codec_ipc::region_size(channels_, ring_slots_, slot_size_)),
+           region_(0),
+           executor_(field, generator, gen_initial_index, threads),
+           remaining_(new std::atomic<std::size_t>[channels_ * ring_slots_]),
+           succeeded_(new std::atomic<std::size_t>[channels_ * ring_slots_]),
+           jobs_(0)
+         {
+            /* Note: A region left behind by a daemon that died is replaced */
+            shm_unlink(name_.c_str());
+
+            const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+            if (fd < 0)
+            {
+               std::cout << "reed_solomon::codec_daemon() - Error: shared memory region could not be created." << std::endl;
+               return;
+            }
+
+            void* region = MAP_FAILED;
+
+            if (0 == ftruncate(fd, static_cast<off_t>(size_)))
+               region = mmap(0, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            ::close(fd);
+
+            if (MAP_FAILED == region)
+            {
+               std::cout << "reed_solomon::codec_daemon() - Error: shared memory region could not be mapped." << std::endl;
+               shm_unlink(name_.c_str());
+               return;
+            }
+
+            region_ = static_cast<unsigned char*>(region);
+
+            codec_ipc::region_header* h = new (region_) codec_ipc::region_header;
+
+            for (std::size_t c = 0; c < channels_; ++c)
+            {
+               new (region_ + codec_ipc::channel_offset(c, ring_slots_)) codec_ipc::channel_header;
+
+               channel(c).owner.store(0, std::memory_order_relaxed);
+
+               for (std::size_t s = 0; s < ring_slots_; ++s)
+               {
+                  new (region_ + codec_ipc::slot_offset(c, s, ring_slots_)) codec_ipc::slot_header;
+
+                  slot(c, s).state         .store(codec_ipc::e_free, std::memory_order_relaxed);
+                  slot(c, s).client_waiting.store(0, std::memory_order_relaxed);
+               }
+            }
+
+            h->version         = codec_ipc::version;
+            h->code_length     = static_cast<std::uint32_t>(code_length);
+            h->fec_length      = static_cast<std::uint32_t>(fec_length);
+            h->channels        = static_cast<std::uint32_t>(channels_);
+            h->ring_slots      = static_cast<std::uint32_t>(ring_slots_);
+            h->slot_size       = static_cast<std::uint32_t>(slot_size_);
+            h->daemon_pid      = static_cast<std::uint32_t>(getpid());
+            h->running         .store(1, std::memory_order_relaxed);
+            h->doorbell        .store(0, std::memory_order_relaxed);
+            h->daemon_sleeping .store(0, std::memory_order_relaxed);
+
+            /* Note: Clients only use a region once its magic is in place */
+            std::atomic_thread_fence(std::memory_order_release);
+
+            h->magic = codec_ipc::magic;
+         }
+
+        ~codec_daemon()
+         {
+            if (0 == region_)
+               return;
+
+            stop();
+
+            /* Note: Jobs still on the workers write to the region */
+            executor_.wait();
+
+            munmap(region_, size_);
+            shm_unlink(name_.c_str());
+         }
+
+         inline bool valid() const
+         {
+            return (0 != region_);
+         }
+
+         /* Jobs dispatched so far */
+         inline std::size_t jobs() const
+         {
+            return jobs_.load(std::memory_order_relaxed);
+         }
+
+         /* Dispatch jobs until stop() is called, from any thread */
+         void run()
+         {
+            if (0 == region_)
+               return;
+
+            codec_ipc::region_header& h = header();
+
+            std::chrono::steady_clock::time_point last_reclaim = std::chrono::steady_clock::now();
+
+            while (h.running.load(std::memory_order_acquire))
+            {
+               const std::uint32_t ring = h.doorbell.load(std::memory_order_seq_cst);
+
+               bool dispatched = false;
+
+               for (std::size_t c = 0; c < channels_; ++c)
+               {
+                  if (0 == channel(c).owner.load(std::memory_order_acquire))
+                     continue;
+
+                  for (std::size_t s = 0; s < ring_slots_; ++s)
+                  {
+                     std::uint32_t expected = codec_ipc::e_submitted;
+
+                     if (slot(c, s).state.compare_exchange_strong(expected, codec_ipc::e_running, std::memory_order_acq_rel))
+                     {
+                        dispatch(c, s);
+                        dispatched = true;
+                     }
+                  }
+               }
+
+               if (std::chrono::steady_clock::now() - last_reclaim > std::chrono::seconds(1))
+               {
+                  reclaim();
+                  last_reclaim = std::chrono::steady_clock::now();
+               }
+
+               if (dispatched)
+                  continue;
+
+               h.daemon_sleeping.store(1, std::memory_order_seq_cst);
+
+               if (ring == h.doorbell.load(std::memory_order_seq_cst))
+                  codec_ipc::futex_wait(h.doorbell, ring, 100);
+
+               h.daemon_sleeping.store(0, std::memory_order_relaxed);
+            }
+         }
+
+         inline void stop()
+         {
+            if (0 == region_)
+               return;
+
+            header().running.store(0, std::memory_order_release);
+            header().doorbell.fetch_add(1, std::memory_order_seq_cst);
+
+            codec_ipc::futex_wake(header().doorbell);
+         }
+
+      private:
+
+         codec_daemon(const codec_daemon&);
+         codec_daemon& operator=(const codec_daemon&);
+
+         inline codec_ipc::region_header& header()
+         {
+            return *reinterpret_cast<codec_ipc::region_header*>(region_);
+         }
+
+         inline codec_ipc::channel_header& channel(const std::size_t c)
+         {
+            return *reinterpret_cast<codec_ipc::channel_header*>(region_ + codec_ipc::channel_offset(c, ring_slots_));
+         }
+
+         inline codec_ipc::slot_header& slot(const std::size_t c, const std::size_t s)
+         {
+            return *reinterpret_cast<codec_ipc::slot_header*>(region_ + codec_ipc::slot_offset(c, s, ring_slots_));
+         }
+
+         inline void complete(codec_ipc::slot_header& sh, const std::size_t succeeded, const std::uint32_t error)
+         {
+            sh.succeeded = static_cast<std::uint32_t>(succeeded);
+            sh.error     = error;
+
+            sh.state.store(codec_ipc::e_done, std::memory_order_seq_cst);
+
+            if (sh.client_waiting.load(std::memory_order_seq_cst))
+               codec_ipc::futex_wake(sh.state);
+         }
+
+         void dispatch(const std::size_t c, const std::size_t s)
+         {
+            codec_ipc::slot_header& sh = slot(c, s);
+
+            const std::size_t   count     = sh.count;
+            const std::uint32_t operation = sh.operation;
+
+            jobs_.fetch_add(1, std::memory_order_relaxed);
+
+            if (
+                 (count > (slot_size_ / code_length)) ||
+                 ((codec_ipc::e_encode != operation) && (codec_ipc::e_decode != operation))
+               )
+            {
+               complete(sh, 0, 1);
+               return;
+            }
+
+            if (0 == count)
+            {
+               complete(sh, 0, 0);
+               return;
+            }
+
+            const std::size_t index = c * ring_slots_ + s;
+
+            remaining_[index].store(count, std::memory_order_relaxed);
+            succeeded_[index].store(0    , std::memory_order_relaxed);
+
+            unsigned char* codewords = region_ + codec_ipc::payload_offset(c, s, channels_, ring_slots_, slot_size_);
+
+            executor_.submit_range(count,
+                                   [this, &sh, index, codewords, operation](const context& ctx, const std::size_t begin, const std::size_t end)
+                                   {
+                                      std::size_t succeeded = 0;
+
+                                      for (std::size_t b = begin; b < end; ++b)
+                                      {
+                                         unsigned char* codeword = codewords + (b * code_length);
+
+                                         const bool result = (codec_ipc::e_encode == operation) ?
+                                                             ctx.encoder.encode(utils::span<const unsigned char>(codeword, code_length - fec_length),
+                                                                                utils::span<unsigned char>(codeword + (code_length - fec_length), fec_length)) :
+                                                             ctx.decoder.decode(utils::span<unsigned char>(codeword, code_length));
+
+                                         if (result)
+                                            ++succeeded;
+                                      }
+
+                                      succeeded_[index].fetch_add(succeeded, std::memory_order_relaxed);
+
+                                      if ((end - begin) == remaining_[index].fetch_sub(end - begin, std::memory_order_acq_rel))
+                                      {
+                                         complete(sh, succeeded_[index].load(std::memory_order_relaxed), 0);
+                                      }
+
+                                      return succeeded;
+                                   });
+         }
+
+         /* Free the channels of clients that exited, once none of their jobs are in flight */
+         void reclaim()
+         {
+            for (std::size_t c = 0; c < channels_; ++c)
+            {
+               const std::uint32_t owner = channel(c).owner.load(std::memory_order_acquire);
+
+               if ((0 == owner) || codec_ipc::process_alive(owner))
+                  continue;
+
+               bool busy = false;
+
+               for (std::size_t s = 0; s < ring_slots_; ++s)
+               {
+                  const std::uint32_t state = slot(c, s).state.load(std::memory_order_acquire);
+
+                  busy |= (codec_ipc::e_running == state);
+               }
+
+               if (busy)
+                  continue;
+
+               for (std::size_t s = 0; s < ring_slots_; ++s)
+               {
+                  slot(c, s).state         .store(codec_ipc::e_free, std::memory_order_relaxed);
+                  slot(c, s).client_waiting.store(0, std::memory_order_relaxed);
+               }
+
+               channel(c).owner.store(0, std::memory_order_release);
+            }
+         }
+
+         const std::string                          name_;
+         const std::size_t                          channels_;
+         const std::size_t                          ring_slots_;
+         const std::size_t                          slot_size_;
+         const std::size_t                          size_;
+         unsigned char*                             region_;
+         executor_type                              executor_;
+         std::unique_ptr<std::atomic<std::size_t>[]> remaining_;
+         std::unique_ptr<std::atomic<std::size_t>[]> succeeded_;
+         std::atomic<std::size_t>                   jobs_;
+      };
+
+      /*
+         Client of a codec_daemon. The constructor maps the daemon's region
+         and claims a free channel. Jobs go round the channel's ring of
+         slots: buffer() is the payload of the next slot, which the caller
+         fills with up to capacity() codewords and hands over with
+         submit(), which returns a ticket, and wait(ticket) blocks until
+         the daemon has processed them in place. Up to ring_slots() jobs
+         may be in flight, and a job's codewords stay readable in its slot
+         until the ring comes round to it again.
+
+         encode() and decode() run a whole buffer through the ring, copying
+         it in and out, with every slot in flight. wait() returns false
+         when the daemon rejected the job or stopped.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class codec_client
+      {
+      public:
+
+         explicit codec_client(const std::string& name)
+         : region_(0),
+           size_(0),
+           channel_(0),
+           next_(0)
+         {
+            const int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+            if (fd < 0)
+            {
+               std::cout << "reed_solomon::codec_client() - Error: daemon region could not be opened." << std::endl;
+               return;
+            }
+
+            struct stat status;
+
+            void* region = MAP_FAILED;
+
+            if ((0 == fstat(fd, &status)) && (static_cast<std::size_t>(status.st_size) >= sizeof(codec_ipc::region_header)))
+            {
+               size_  = static_cast<std::size_t>(status.st_size);
+               region = mmap(0, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+
+            ::close(fd);
+
+            if (MAP_FAILED == region)
+            {
+               std::cout << "reed_solomon::codec_client() - Error: daemon region could not be mapped." << std::endl;
+               return;
+            }
+
+            region_ = static_cast<unsigned char*>(region);
+
+            const codec_ipc::region_header& h = header();
+
+            if (
+                 (codec_ipc::magic   != h.magic)       ||
+                 (codec_ipc::version != h.version)     ||
+                 (code_length        != h.code_length) ||
+                 (fec_length         != h.fec_length)  ||
+                 (size_ < codec_ipc::region_size(h.channels, h.ring_slots, h.slot_size))
+               )
+            {
+               std::cout << "reed_solomon::codec_client() - Error: daemon region does not match the code." << std::endl;
+               release();
+               return;
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            const std::uint32_t pid = static_cast<std::uint32_t>(getpid());
+
+            for (channel_ = 0; channel_ < h.channels; ++channel_)
+            {
+               std::uint32_t expected = 0;
+
+               if (channel(channel_).owner.compare_exchange_strong(expected, pid, std::memory_order_acq_rel))
+                  return;
+            }
+
+            std::cout << "reed_solomon::codec_client() - Error: every channel of the daemon is taken." << std::endl;
+            release();
+         }
+
+        ~codec_client()
+         {
+            if (0 == region_)
+               return;
+
+            for (std::size_t s = 0; s < ring_slots(); ++s)
+            {
+               std::size_t succeeded = 0;
+
+               if (codec_ipc::e_free != slot(s).state.load(std::memory_order_acquire))
+                  wait(s, succeeded);
+            }
+
+            channel(channel_).owner.store(0, std::memory_order_release);
+
+            release();
+         }
+
+         inline bool valid() const
+         {
+            return (0 != region_);
+         }
+
+         /* Codewords per job */
+         inline std::size_t capacity() const
+         {
+            return header().slot_size / code_length;
+         }
+
+         inline std::size_t ring_slots() const
+         {
+            return header().ring_slots;
+         }
+
+         /* The payload of the next slot, its previous job being waited for first */
+         inline unsigned char* buffer()
+         {
+            std::size_t succeeded = 0;
+
+            if (codec_ipc::e_free != slot(next_).state.load(std::memory_order_acquire))
+               wait(next_, succeeded);
+
+            return payload(next_);
+         }
+
+         /* Hand the count codewords in buffer() to the daemon */
+         inline std::size_t submit(const codec_ipc::operation operation, const std::size_t count)
+         {
+            codec_ipc::region_header& h  = header();
+            codec_ipc::slot_header&   sh = slot(next_);
+
+            sh.operation = operation;
+            sh.count     = static_cast<std::uint32_t>(count);
+
+            sh.state.store(codec_ipc::e_submitted, std::memory_order_seq_cst);
+
+            h.doorbell.fetch_add(1, std::memory_order_seq_cst);
+
+            if (h.daemon_sleeping.load(std::memory_order_seq_cst))
+               codec_ipc::futex_wake(h.doorbell);
+
+            const std::size_t ticket = next_;
+
+            next_ = (next_ + 1) % ring_slots();
+
+            return ticket;
+         }
+
+         /* Wait for a job, succeeded being the codewords encoded or decoded */
+         bool wait(const std::size_t ticket, std::size_t& succeeded)
+         {
+            codec_ipc::slot_header& sh = slot(ticket);
+
+            succeeded = 0;
+
+            for (;;)
+            {
+               const std::uint32_t state = sh.state.load(std::memory_order_acquire);
+
+               if (codec_ipc::e_free == state)
+                  return false;
+               else if (codec_ipc::e_done == state)
+                  break;
+
+               sh.client_waiting.store(1, std::memory_order_seq_cst);
+
+               if (state == sh.state.load(std::memory_order_seq_cst))
+                  codec_ipc::futex_wait(sh.state, state, 100);
+
+               sh.client_waiting.store(0, std::memory_order_relaxed);
+
+               if (
+                    (state == sh.state.load(std::memory_order_acquire)) &&
+                    (!header().running.load(std::memory_order_acquire) || !codec_ipc::process_alive(header().daemon_pid))
+                  )
+               {
+                  sh.state.store(codec_ipc::e_free, std::memory_order_release);
+                  return false;
+               }
+            }
+
+            succeeded = sh.succeeded;
+
+            const bool result = (0 == sh.error);
+
+            sh.state.store(codec_ipc::e_free, std::memory_order_release);
+
+            return result;
+         }
+
+         /* Encode or decode count codewords, back to back from codewords, in place */
+         inline std::size_t encode(unsigned char* codewords, const std::size_t count)
+         {
+            return run(codec_ipc::e_encode, codewords, count);
+         }
+
+         inline std::size_t decode(unsigned char* codewords, const std::size_t count)
+         {
+            return run(codec_ipc::e_decode, codewords, count);
+         }
+
+      private:
+
+         codec_client(const codec_client&);
+         codec_client& operator=(const codec_client&);
+
+         inline codec_ipc::region_header& header() const
+         {
+            return *reinterpret_cast<codec_ipc::region_header*>(region_);
+         }
+
+         inline codec_ipc::channel_header& channel(const std::size_t c) const
+         {
+            return *reinterpret_cast<codec_ipc::channel_header*>(region_ + codec_ipc::channel_offset(c, header().ring_slots));
+         }
+
+         inline codec_ipc::slot_header& slot(const std::size_t s) const
+         {
+            return *reinterpret_cast<codec_ipc::slot_header*>(region_ + codec_ipc::slot_offset(channel_, s, header().ring_slots));
+         }
+
+         inline unsigned char* payload(const std::size_t s) const
+         {
+            const codec_ipc::region_header& h = header();
+
+            return region_ + codec_ipc::payload_offset(channel_, s, h.channels, h.ring_slots, h.slot_size);
+         }
+
+         inline void release()
+         {
+            munmap(region_, size_);
+            region_ = 0;
+         }
+
+         std::size_t run(const codec_ipc::operation operation, unsigned char* codewords, const std::size_t count)
+         {
+            if (0 == region_)
+               return 0;
+
+            struct job
+            {
+               std::size_t ticket;
+               std::size_t first;
+               std::size_t count;
+            };
+
+            std::vector<job> in_flight;
+
+            std::size_t total = 0;
+
+            for (std::size_t first = 0; (first < count) || !in_flight.empty();)
+            {
+               if ((first < count) && (in_flight.size() < ring_slots()))
+               {
+                  const std::size_t amount = std::min(capacity(), count - first);
+
+                  std::memcpy(buffer(), codewords + first * code_length, amount * code_length);
+
+                  const job j = { submit(operation, amount), first, amount };
+
+                  in_flight.push_back(j);
+
+                  first += amount;
+                  continue;
+               }
+
+               const job j = in_flight.front();
+
+               in_flight.erase(in_flight.begin());
+
+               std::size_t succeeded = 0;
+
+               wait(j.ticket, succeeded);
+
+               std::memcpy(codewords + j.first * code_length, payload(j.ticket), j.count * code_length);
+
+               total += succeeded;
+            }
+
+            return total;
+         }
+
+         unsigned char* region_;
+         std::size_t    size_;
+         std::size_t    channel_;
+         std::size_t    next_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
+
+#endif
@@ -0,0 +1,831 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_EXECUTOR_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_EXECUTOR_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_numa_replicas.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_tuning.hpp"
+#include "schifra/utils/schifra_cpu_topology.hpp"
+#include "schifra/utils/schifra_metrics.hpp"
+#include "schifra/utils/schifra_span.hpp"
+#include "schifra/utils/schifra_trace.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Scheduling class of a codec_executor batch. Workers take e_high
+         pieces, from their own deque or stolen, before any e_normal one,
+         eg: interactive strand decodes ahead of bulk pool decodes.
+      */
+      enum priority_t
+      {
+         e_high           = 0,
+         e_normal         = 1,
+         e_priority_count = 2
+      };
+
+      inline const char* priority_name(const priority_t priority)
+      {
+         switch (priority)
+         {
+            case e_high   : return "high";
+            case e_normal : return "normal";
+            default       : return "unknown";
+         }
+      }
+
+      /*
+         Shared between a submitter and the executor running its batch.
+         cancel() drops the pieces of the batch that have not started,
+         and skipped() counts the codewords left unprocessed, whether
+         cancelled or past the batch's deadline.
+      */
+      class batch_control
+      {
+      public:
+
+         batch_control()
+         : cancelled_(false),
+           skipped_(0)
+         {}
+
+         inline void cancel()
+         {
+            cancelled_.store(true, std::memory_order_release);
+         }
+
+         inline bool cancelled() const
+         {
+            return cancelled_.load(std::memory_order_acquire);
+         }
+
+         inline std::size_t skipped() const
+         {
+            return skipped_.load(std::memory_order_acquire);
+         }
+
+         inline void skip(const std::size_t amount)
+         {
+            skipped_.fetch_add(amount, std::memory_order_acq_rel);
+         }
+
+      private:
+
+         batch_control(const batch_control&);
+         batch_control& operator=(const batch_control&);
+
+         std::atomic<bool>        cancelled_;
+         std::atomic<std::size_t> skipped_;
+      };
+
+      /*
+         How a batch is scheduled. Pieces not started by the deadline are
+         skipped, as are those of a cancelled control; their codewords
+         count as failed in the batch's future. A completion, when set, is
+         called once the batch is done with what its future yields, on the
+         worker that finished it, eg: to resume a coroutine rather than
+         block a thread on the future.
+      */
+      struct batch_options
+      {
+         typedef std::chrono::steady_clock clock_type;
+
+         batch_options(const priority_t p = e_normal)
+         : priority(p),
+           deadline(clock_type::time_point::max())
+         {}
+
+         /* Deadline timeout from now */
+         template <typename Duration>
+         static inline batch_options within(const priority_t p, const Duration& timeout)
+         {
+            batch_options options(p);
+            options.deadline = clock_type::now() + std::chrono::duration_cast<clock_type::duration>(timeout);
+            return options;
+         }
+
+         priority_t                       priority;
+         clock_type::time_point           deadline;
+         std::shared_ptr<batch_control>   control;
+         std::function<void(std::size_t)> completion;
+      };
+
+      /*
+         A persistent pool of worker threads, each owning its own encoder
+         and decoder, built on the worker so that the codec tables sit in
+         memory local to it. Batches of blocks, or of codewords laid out
+         back to back in a caller owned buffer, are queued as ranges; the
+         returned future yields the number of codewords encoded or decoded
+         successfully once the whole batch is done. Arbitrary work may be
+         queued with submit(), and wait() blocks until everything queued
+         so far has run.
+
+         Decode cost is very uneven, a clean codeword stops after its
+         syndromes while a corrupted one runs the full decoder, so a batch
+         is not cut into fixed shares up front. Each worker has its own
+         deque: a batch is dealt out as one range per worker, and a worker
+         halves the range it takes, pushing the upper half back onto its
+         deque, until a piece is down to grain codewords. It then works
+         through its own deque newest first (ie: small pieces, still warm
+         in cache), while idle workers steal the oldest, largest, pieces
+         from the front of the others'. A run of corrupted codewords thus
+         ends up shared between all workers instead of stalling one.
+
+         Each deque holds one list per priority_t, and a worker takes the
+         highest class anywhere before a lower one, so a batch is only
+         preempted between its pieces: high priority work waits for at
+         most a piece of grain codewords per worker, however large the
+         bulk batches queued ahead of it. The time from submission to a
+         batch's first piece starting is kept per class, see queue_wait()
+         and export_metrics().
+
+         With a placement other than e_none each worker is pinned to a cpu
+         in that order and, rather than building its own codec, shares the
+         field tables and codec replica of its NUMA node (see
+         numa_replicas), which the first worker on the node builds.
+
+         threads and grain of 0 are those of the code's tuned profile (see
+         tuning), or one per hardware thread and default_grain when it has
+         none.
+
+         Note: The batch memory is only accessed by the workers, it must
+               stay alive and untouched until the future is ready. The
+               field must outlive the executor.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class codec_executor
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,data_length> encoder_type;
+         typedef decoder<code_length,fec_length,data_length> decoder_type;
+         typedef block<code_length,fec_length>               block_type;
+         typedef numa_replicas<code_length,fec_length,data_length> replicas_type;
+
+         /* What a task sees of the worker running it */
+         struct context
+         {
+            const encoder_type& encoder;
+            const decoder_type& decoder;
+            const std::size_t   worker;
+         };
+
+         /* Processes codewords [begin,end) of a batch, returns how many succeeded */
+         typedef std::function<std::size_t(const context&, std::size_t, std::size_t)> range_type;
+
+         static constexpr std::size_t default_grain = 256;
+
+         codec_executor(const galois::field&            field,
+                        const galois::field_polynomial& generator,
+                        const unsigned int              gen_initial_index,
+                        const std::size_t               threads = 0,
+                        const std::size_t               grain   = 0,
+                        const utils::cpu_topology::placement_t placement = utils::cpu_topology::e_none)
+         : field_(field),
+           generator_(generator),
+           gen_initial_index_(gen_initial_index),
+           grain_(tuning::grain<code_length,fec_length>(grain, default_grain)),
+           thread_count_(std::max<std::size_t>(1, (tuning::threads<code_length,fec_length>(threads) > 0) ?
+                                                  tuning::threads<code_length,fec_length>(threads)       :
+                                                  std::thread::hardware_concurrency())),
+           queues_(new worker_queue[thread_count_]),
+           next_queue_(0),
+           queued_(0),
+           sleepers_(0),
+           outstanding_(0),
+           stop_(false),
+           warm_up_generation_(0),
+           warm_up_pending_(0),
+           warm_up_lock_(false),
+           warm_up_locked_(true)
+         {
+            for (std::size_t p = 0; p < e_priority_count; ++p)
+            {
+               queue_wait_[p].reset(new utils::metrics::histogram(utils::metrics::histogram::exponential_bounds(1000, 2.0, 24)));
+               skipped_   [p].store(0, std::memory_order_relaxed);
+            }
+
+            if (utils::cpu_topology::e_none != placement)
+            {
+               replicas_.reset(new replicas_type(field_, generator_, gen_initial_index_));
+               placement_order_ = replicas_->topology().order(placement);
+            }
+
+            for (std::size_t w = 0; w < thread_count_; ++w)
+            {
+               workers_.push_back(std::thread([this, w]() { work(w); }));
+            }
+         }
+
+         /* Runs whatever is still queued, then joins the workers */
+        ~codec_executor()
+         {
+            {
+               std::lock_guard<std::mutex> lock(sleep_mutex_);
+               stop_ = true;
+            }
+
+            wake_.notify_all();
+
+            for (std::size_t w = 0; w < workers_.size(); ++w)
+            {
+               workers_[w].join();
+            }
+         }
+
+         inline std::size_t threads() const
+         {
+            return thread_count_;
+         }
+
+         inline std::size_t grain() const
+         {
+            return grain_;
+         }
+
+         inline std::future<std::size_t> encode(block_type* blocks, const std::size_t count,
+                                                const batch_options& options = batch_options())
+         {
+            return submit_range(count,
+                                [blocks](const context& ctx, const std::size_t begin, const std::size_t end)
+                                {
+                                   std::size_t encoded = 0;
+
+                                   for (std::size_t b = begin; b < end; ++b)
+                                   {
+                                      if (ctx.encoder.encode(blocks[b]))
+                                         ++encoded;
+                                   }
+
+                                   return encoded;
+                                },
+                                options);
+         }
+
+         inline std::future<std::size_t> decode(block_type* blocks, const std::size_t count,
+                                                const batch_options& options = batch_options())
+         {
+            return submit_range(count,
+                                [blocks](const context& ctx, const std::size_t begin, const std::size_t end)
+                                {
+                                   return ctx.decoder.decode_batch(blocks + begin, end - begin);
+                                },
+                                options);
+         }
+
+         /*
+            count codewords of code_length symbols each, data then parity,
+            back to back from codewords. Encoding writes the parity.
+         */
+         template <typename T>
+         inline std::future<std::size_t> encode_buffer(T* codewords, const std::size_t count,
+                                                       const batch_options& options = batch_options())
+         {
+            return submit_range(count,
+                                [codewords](const context& ctx, const std::size_t begin, const std::size_t end)
+                                {
+                                   std::size_t encoded = 0;
+
+                                   for (std::size_t b = begin; b < end; ++b)
+                                   {
+                                      T* codeword = codewords + (b * code_length);
+
+                                      if (ctx.encoder.encode(utils::span<const T>(codeword, data_length),
+                                                             utils::span<T>(codeword + data_length, fec_length)))
+                                         ++encoded;
+                                   }
+
+                                   return encoded;
+                                },
+                                options);
+         }
+
+         template <typename T>
+         inline std::future<std::size_t> decode_buffer(T* codewords, const std::size_t count,
+                                                       const batch_options& options = batch_options())
+         {
+            return submit_range(count,
+                                [codewords](const context& ctx, const std::size_t begin, const std::size_t end)
+                                {
+                                   std::size_t decoded = 0;
+
+                                   for (std::size_t b = begin; b < end; ++b)
+                                   {
+                                      if (ctx.decoder.decode(utils::span<T>(codewords + (b * code_length), code_length)))
+                                         ++decoded;
+                                   }
+
+                                   return decoded;
+                                },
+                                options);
+         }
+
+         /*
+            Queue range(ctx, begin, end) over [0,count), split and stolen
+            as the batches above are. The future yields the sum of what
+            the pieces returned, skipped pieces counting for nothing.
+         */
+         std::future<std::size_t> submit_range(const std::size_t count, const range_type& range,
+                                               const batch_options& options = batch_options())
+         {
+            std::shared_ptr<batch_state> state = std::make_shared<batch_state>(count, range, options);
+            std::future<std::size_t> result = state->promise.get_future();
+
+            if (0 == count)
+            {
+               state->promise.set_value(0);
+
+               if (options.completion)
+                  options.completion(0);
+
+               return result;
+            }
+
+            {
+               std::lock_guard<std::mutex> lock(idle_mutex_);
+               ++outstanding_;
+            }
+
+            /* One range per worker to start with, stealing balances the rest */
+            const std::size_t pieces = std::max<std::size_t>(1, std::min(threads(), (count + grain_ - 1) / grain_));
+            const std::size_t first  = next_queue_.fetch_add(pieces, std::memory_order_relaxed);
+
+            for (std::size_t p = 0; p < pieces; ++p)
+            {
+               const task piece = { state, (count * (p    )) / pieces,
+                                           (count * (p + 1)) / pieces };
+
+               push((first + p) % threads(), piece);
+            }
+
+            return result;
+         }
+
+         /* Queue function(ctx), the future rethrowing anything it throws */
+         template <typename Function>
+         std::future<void> submit(Function function)
+         {
+            std::shared_ptr<std::promise<void> > promise = std::make_shared<std::promise<void> >();
+            std::future<void> result = promise->get_future();
+
+            submit_range(1, [promise, function](const context& ctx, const std::size_t, const std::size_t) -> std::size_t
+                            {
+                               try
+                               {
+                                  function(ctx);
+                                  promise->set_value();
+                               }
+                               catch (...)
+                               {
+                                  promise->set_exception(std::current_exception());
+                               }
+
+                               return 0;
+                            });
+
+            return result;
+         }
+
+         /* Block until every batch and task queued so far has run */
+         void wait()
+         {
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            idle_.wait(lock, [this]() { return 0 == outstanding_; });
+         }
+
+         /*
+            Have every worker touch the field and codec tables it uses,
+            ie: those of its own NUMA node with a placement, and run a few
+            encodes and decodes through the batch kernels, see
+            encoder::warm_up() and decoder::warm_up(), so that the first
+            batches run at steady state speed. With lock the tables are
+            also locked in RAM. Workers busy with a batch warm up after
+            their current piece. Blocks until they all have, returns false
+            when a lock was refused.
+         */
+         bool warm_up(const bool lock = false)
+         {
+            std::lock_guard<std::mutex> serial(warm_up_mutex_);
+
+            {
+               std::lock_guard<std::mutex> guard(sleep_mutex_);
+
+               warm_up_lock_    = lock;
+               warm_up_locked_  = true;
+               warm_up_pending_ = thread_count_;
+
+               warm_up_generation_.fetch_add(1, std::memory_order_release);
+            }
+
+            wake_.notify_all();
+
+            std::unique_lock<std::mutex> guard(sleep_mutex_);
+
+            warmed_up_.wait(guard, [this]() { return 0 == warm_up_pending_; });
+
+            return warm_up_locked_;
+         }
+
+         /* Nanoseconds from submission to the first piece starting, of the batches of a class */
+         inline const utils::metrics::histogram& queue_wait(const priority_t priority) const
+         {
+            return *queue_wait_[priority];
+         }
+
+         /* Codewords of a class skipped, cancelled or past their deadline */
+         inline std::size_t skipped(const priority_t priority) const
+         {
+            return skipped_[priority].load(std::memory_order_relaxed);
+         }
+
+         /*
+            Publish the queue wait histograms and skipped codewords per
+            class through a metrics registry, read on every scrape.
+
+            Note: The executor must outlive the registry's scrapes.
+         */
+         void export_metrics(utils::metrics::registry& registry, const std::string& name = "schifra_executor")
+         {
+            registry.add_collector([this, name](std::vector<utils::metrics::sample>& samples)
+            {
+               typedef utils::metrics::registry r;
+
+               const std::string wait_family = name + "_queue_wait_nanoseconds";
+               const char*       wait_help   = "Time from submission to a batch's first piece starting";
+
+               for (std::size_t p = 0; p < e_priority_count; ++p)
+               {
+                  const std::string label = std::string("class=\"") + priority_name(static_cast<priority_t>(p)) + "\"";
+
+                  const std::vector<std::uint64_t>  counts = queue_wait_[p]->counts();
+                  const std::vector<std::uint64_t>& bounds = queue_wait_[p]->upper_bounds();
+
+                  std::uint64_t cumulative = 0;
+
+                  for (std::size_t b = 0; b < counts.size(); ++b)
+                  {
+                     cumulative += counts[b];
+
+                     const std::string le = (b < bounds.size()) ? std::to_string(bounds[b]) : std::string("+Inf");
+
+                     samples.push_back(r::make_sample(wait_family, wait_help, utils::metrics::e_histogram, wait_family + "_bucket",
+                                                      label + ",le=\"" + le + "\"", static_cast<double>(cumulative)));
+                  }
+
+                  samples.push_back(r::make_sample(wait_family, wait_help, utils::metrics::e_histogram, wait_family + "_sum",
+                                                   label, static_cast<double>(queue_wait_[p]->sum())));
+                  samples.push_back(r::make_sample(wait_family, wait_help, utils::metrics::e_histogram, wait_family + "_count",
+                                                   label, static_cast<double>(cumulative)));
+               }
+
+               for (std::size_t p = 0; p < e_priority_count; ++p)
+               {
+                  const std::string label = std::string("class=\"") + priority_name(static_cast<priority_t>(p)) + "\"";
+
+                  samples.push_back(r::make_sample(name + "_skipped_codewords_total", "Codewords cancelled or past their deadline",
+                                                   utils::metrics::e_counter, name + "_skipped_codewords_total", label,
+                                                   static_cast<double>(skipped(static_cast<priority_t>(p)))));
+               }
+            });
+         }
+
+      private:
+
+         codec_executor(const codec_executor&);
+         codec_executor& operator=(const codec_executor&);
+
+         struct batch_state
+         {
+            batch_state(const std::size_t count, const range_type& r, const batch_options& o)
+            : remaining(count),
+              succeeded(0),
+              started(false),
+              range(r),
+              options(o),
+              submitted(batch_options::clock_type::now())
+            {}
+
+            std::atomic<std::size_t>  remaining;   /* codewords not yet processed */
+            std::atomic<std::size_t>  succeeded;
+            std::atomic<bool>         started;
+            const range_type          range;
+            const batch_options       options;
+            const batch_options::clock_type::time_point submitted;
+            std::promise<std::size_t> promise;
+         };
+
+         struct task
+         {
+            std::shared_ptr<batch_state> state;
+            std::size_t                  begin;
+            std::size_t                  end;
+         };
+
+         struct alignas(64) worker_queue
+         {
+            std::mutex       mutex;
+            std::deque<task> tasks[e_priority_count];
+         };
+
+         inline void push(const std::size_t worker, const task& t)
+         {
+            {
+               std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+               queues_[worker].tasks[t.state->options.priority].push_back(t);
+               queued_.fetch_add(1, std::memory_order_release);
+            }
+
+            if (sleepers_.load(std::memory_order_acquire) > 0)
+            {
+               std::lock_guard<std::mutex> lock(sleep_mutex_);
+               wake_.notify_one();
+            }
+         }
+
+         /* The highest class task there is, own or stolen */
+         inline bool take(const std::size_t worker, task& t)
+         {
+            for (std::size_t p = 0; p < e_priority_count; ++p)
+            {
+               if (pop(worker, p, t) || steal(worker, p, t))
+                  return true;
+            }
+
+            return false;
+         }
+
+         /* Newest task of a class in the worker's own deque */
+         inline bool pop(const std::size_t worker, const std::size_t priority, task& t)
+         {
+            std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+
+            std::deque<task>& tasks = queues_[worker].tasks[priority];
+
+            if (tasks.empty())
+               return false;
+
+            t = std::move(tasks.back());
+            tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+
+            return true;
+         }
+
+         /* Oldest task of a class in the first other deque that has one */
+         inline bool steal(const std::size_t worker, const std::size_t priority, task& t)
+         {
+            for (std::size_t i = 1; i < threads(); ++i)
+            {
+               worker_queue& victim = queues_[(worker + i) % threads()];
+
+               std::lock_guard<std::mutex> lock(victim.mutex);
+
+               std::deque<task>& tasks = victim.tasks[priority];
+
+               if (tasks.empty())
+                  continue;
+
+               t = std::move(tasks.front());
+               tasks.pop_front();
+               queued_.fetch_sub(1, std::memory_order_relaxed);
+
+               return true;
+            }
+
+            return false;
+         }
+
+         void execute(const std::size_t worker, const context& ctx, task& t)
+         {
+            batch_state& state = *t.state;
+
+            const batch_options& options = state.options;
+
+            if (!state.started.load(std::memory_order_relaxed) && !state.started.exchange(true, std::memory_order_relaxed))
+            {
+               const batch_options::clock_type::time_point now = batch_options::clock_type::now();
+
+               queue_wait_[options.priority]->observe(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - state.submitted).count()));
+
+               utils::trace::complete(utils::trace::e_queue_wait, "batch queued", state.submitted, now);
+            }
+
+            const bool skip = (options.control && options.control->cancelled()) ||
+                              ((batch_options::clock_type::time_point::max() != options.deadline) &&
+                               (batch_options::clock_type::now() > options.deadline));
+
+            /* Note: A skipped piece is dropped whole rather than split */
+            while (!skip && ((t.end - t.begin) > grain_))
+            {
+               const std::size_t middle = t.begin + (t.end - t.begin) / 2;
+               const task upper = { t.state, middle, t.end };
+
+               push(worker, upper);
+
+               t.end = middle;
+            }
+
+            const std::size_t amount = t.end - t.begin;
+
+            if (skip)
+            {
+               skipped_[options.priority].fetch_add(amount, std::memory_order_relaxed);
+
+               if (options.control)
+                  options.control->skip(amount);
+            }
+            else
+            {
+               utils::trace::scope codec(utils::trace::e_codec, "executor piece", static_cast<std::int64_t>(amount));
+
+               state.succeeded.fetch_add(state.range(ctx, t.begin, t.end), std::memory_order_relaxed);
+            }
+
+            if (amount == state.remaining.fetch_sub(amount, std::memory_order_acq_rel))
+            {
+               const std::size_t succeeded = state.succeeded.load(std::memory_order_relaxed);
+
+               state.promise.set_value(succeeded);
+
+               if (options.completion)
+                  options.completion(succeeded);
+
+               std::lock_guard<std::mutex> lock(idle_mutex_);
+
+               if (0 == --outstanding_)
+                  idle_.notify_all();
+            }
+         }
+
+         void work(const std::size_t worker)
+         {
+            if (replicas_)
+            {
+               const utils::logical_cpu& cpu = placement_order_[worker % placement_order_.size()];
+
+               utils::cpu_topology::pin_current_thread(cpu.id);
+
+               const typename replicas_type::replica& local = replicas_->on_node(cpu.node);
+
+               run(worker, local.encoder, local.decoder);
+            }
+            else
+            {
+               const encoder_type encoder(field_, generator_);
+               const decoder_type decoder(field_, gen_initial_index_);
+
+               run(worker, encoder, decoder);
+            }
+         }
+
+         void warm_up(const context& ctx)
+         {
+            bool lock = false;
+
+            {
+               std::lock_guard<std::mutex> guard(sleep_mutex_);
+               lock = warm_up_lock_;
+            }
+
+            const bool encoder_locked = ctx.encoder.warm_up(lock);
+            const bool decoder_locked = ctx.decoder.warm_up(lock);
+
+            std::lock_guard<std::mutex> guard(sleep_mutex_);
+
+            warm_up_locked_ = warm_up_locked_ && encoder_locked && decoder_locked;
+
+            if (0 == --warm_up_pending_)
+               warmed_up_.notify_all();
+         }
+
+         void run(const std::size_t worker, const encoder_type& encoder, const decoder_type& decoder)
+         {
+            const context ctx = { encoder, decoder, worker };
+
+            utils::trace::set_thread_name("executor worker " + std::to_string(worker));
+
+            std::size_t warmed_up = 0;
+
+            for ( ; ; )
+            {
+               if (warm_up_generation_.load(std::memory_order_acquire) != warmed_up)
+               {
+                  warmed_up = warm_up_generation_.load(std::memory_order_acquire);
+                  warm_up(ctx);
+                  continue;
+               }
+
+               task t;
+
+               if (take(worker, t))
+               {
+                  execute(worker, ctx, t);
+                  continue;
+               }
+
+               utils::trace::scope idle(utils::trace::e_queue_wait, "idle");
+
+               std::unique_lock<std::mutex> lock(sleep_mutex_);
+
+               sleepers_.fetch_add(1, std::memory_order_acq_rel);
+
+               wake_.wait(lock, [&]()
+                          {
+                             return stop_ || (queued_.load(std::memory_order_acquire) > 0) ||
+                                    (warm_up_generation_.load(std::memory_order_acquire) != warmed_up);
+                          });
+
+               sleepers_.fetch_sub(1, std::memory_order_acq_rel);
+
+               if (stop_ && (0 == queued_.load(std::memory_order_acquire)))
+                  return;
+            }
+         }
+
+         const galois::field&            field_;
+         const galois::field_polynomial  generator_;
+         const unsigned int              gen_initial_index_;
+         const std::size_t               grain_;
+         const std::size_t               thread_count_;
+
+         std::unique_ptr<replicas_type>  replicas_;
+         std::vector<utils::logical_cpu> placement_order_;
+
+         std::unique_ptr<worker_queue[]> queues_;
+         std::vector<std::thread>        workers_;
+         std::atomic<std::size_t>        next_queue_;
+         std::atomic<std::size_t>        queued_;
+         std::atomic<std::size_t>        sleepers_;
+
+         std::mutex                      sleep_mutex_;
+         std::condition_variable         wake_;
+
+         std::mutex                      idle_mutex_;
+         std::condition_variable         idle_;
+         std::size_t                     outstanding_;
+         bool                            stop_;
+
+         /* A warm_up() is a new generation, each worker warming up once per generation */
+         std::mutex                      warm_up_mutex_;
+         std::condition_variable         warmed_up_;
+         std::atomic<std::size_t>        warm_up_generation_;
+         std::size_t                     warm_up_pending_;
+         bool                            warm_up_lock_;
+         bool                            warm_up_locked_;
+
+         std::unique_ptr<utils::metrics::histogram> queue_wait_[e_priority_count];
+         std::atomic<std::size_t>                   skipped_   [e_priority_count];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,903 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_SERVER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_SERVER_HPP
+
+
+#if defined(__linux__)
+
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/utils/schifra_bounded_queue.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Wire protocol of a codec_server. Every message is a frame header
+         of eight little endian 32 bit words, then its payload. On connect
+         the server sends a hello frame giving the largest batch it takes
+         (count) and the batches a connection may have in flight (value).
+         A request frame carries count codewords to encode (their data,
+         count * data_length bytes) or to decode (count * code_length
+         bytes), and its reply, in request order, the encoded codewords
+         or the decoded data, value being the codewords that succeeded.
+         A request the server cannot take gets a reply with status set
+         and no payload, after which the server closes the connection.
+      */
+      namespace codec_net
+      {
+
+         static constexpr std::uint32_t magic       = 0x4E535253; /* "SRSN" */
+         static constexpr std::size_t   header_size = 8 * sizeof(std::uint32_t);
+
+         enum operation
+         {
+            e_hello  = 0,
+            e_encode = 1,
+            e_decode = 2
+         };
+
+         enum status
+         {
+            e_ok              = 0,
+            e_bad_frame       = 1,
+            e_code_mismatch   = 2,
+            e_batch_too_large = 3
+         };
+
+         struct frame
+         {
+            std::uint32_t magic;
+            std::uint32_t operation;
+            std::uint32_t count;
+            std::uint32_t sequence;
+            std::uint32_t value;
+            std::uint32_t status;
+            std::uint32_t code_length;
+            std::uint32_t fec_length;
+         };
+
+         inline void store(const frame& f, unsigned char* buffer)
+         {
+            const std::uint32_t words[] = { f.magic, f.operation, f.count, f.sequence, f.value, f.status, f.code_length, f.fec_length };
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               for (std::size_t j = 0; j < 4; ++j)
+               {
+                  buffer[i * 4 + j] = static_cast<unsigned char>((words[i] >> (8 * j)) & 0xFF);
+               }
+            }
+         }
+
+         inline void load(const unsigned char* buffer, frame& f)
+         {
+            std::uint32_t words[8];
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               words[i] = 0;
+
+               for (std::size_t j = 0; j < 4; ++j)
+               {
+                  words[i] |= static_cast<std::uint32_t>(buffer[i * 4 + j]) << (8 * j);
+               }
+            }
+
+            f.magic       = words[0];
+            f.operation   = words[1];
+            f.count       = words[2];
+            f.sequence    = words[3];
+            f.value       = words[4];
+            f.status      = words[5];
+            f.code_length = words[6];
+            f.fec_length  = words[7];
+         }
+
+         /*
+            Send or receive all of iov[0,count), IOV_MAX vectors at a time,
+            advancing the vectors past what was transferred. Sends never
+            raise SIGPIPE, a peer that went away just fails the call.
+         */
+         inline bool transfer(const int fd, ::iovec* iov, std::size_t count, const bool send)
+         {
+            while ((count > 0) && (0 == iov->iov_len))
+            {
+               ++iov;
+               --count;
+            }
+
+            while (count > 0)
+            {
+               ::msghdr message;
+
+               std::memset(&message, 0, sizeof(message));
+
+               message.msg_iov    = iov;
+               message.msg_iovlen = std::min<std::size_t>(count, IOV_MAX);
+
+               const ssize_t n = send ? ::sendmsg(fd, &message, MSG_NOSIGNAL) :
+                                        ::recvmsg(fd, &message, MSG_WAITALL);
+
+               if (n < 0)
+               {
+                  if (EINTR == errno)
+                     continue;
+
+                  return false;
+               }
+               else if (0 == n)
+                  return false;
+
+               std::size_t done = static_cast<std::size_t>(n);
+
+               while ((count > 0) && (done >= iov->iov_len))
+               {
+                  done -= iov->iov_len;
+                  ++iov;
+                  --count;
+               }
+
+               if (count > 0)
+               {
+                  iov->iov_base = static_cast<unsigned char*>(iov->iov_base) + done;
+                  iov->iov_len -= done;
+               }
+            }
+
+            return true;
+         }
+
+         inline void no_delay(const int fd)
+         {
+            const int on = 1;
+
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+         }
+
+      } // namespace codec_net
+
+      /*
+         TCP front-end of a codec_executor, serving codec_remote_client
+         connections so that ingestion hosts can hand their ECC to
+         dedicated codec nodes. run() accepts connections on port (0 for
+         one picked by the system, see port()) until stop() is called.
+
+         Each connection has a reader, which takes request frames into
+         batch buffers and submits them to the shared executor, and a
+         writer, which sends back the replies in order as the batches
+         complete, so that batches of every connection are on the workers
+         at once. A connection holds window batch buffers of up to
+         max_batch codewords: while all of them are in flight its reader
+         stops reading, the socket's receive window fills, and the client
+         is held back by TCP itself rather than by the server buffering.
+
+         Payloads go between the socket and the batch buffers with
+         scatter/gather I/O, no staging copies: data to encode is read
+         straight into the data part of each codeword, and decoded data
+         is sent straight from it.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class codec_server
+      {
+      public:
+
+         typedef codec_executor<code_length,fec_length> executor_type;
+
+         static constexpr std::size_t data_length       = code_length - fec_length;
+         static constexpr std::size_t default_max_batch = 4096;
+         static constexpr std::size_t default_window    = 4;
+
+         codec_server(const galois::field&            field,
+                      const galois::field_polynomial& generator,
+                      const unsigned int              gen_initial_index,
+                      const unsigned short            port,
+                      const std::size_t               threads   = 0,
+                      const std::size_t               max_batch = default_max_batch,
+                      const std::size_t               window    = default_window,
+                      const std::string&              address   = "")
+         : max_batch_(std::max<std::size_t>(1, max_batch)),
+           window_(std::max<std::size_t>(1, window)),
+           listen_fd_(-1),
+           port_(0),
+           running_(true),
+           executor_(field, generator, gen_initial_index, threads),
+           connections_served_(0),
+           batches_(0),
+           codewords_(0)
+         {
+            ::addrinfo hints;
+
+            std::memset(&hints, 0, sizeof(hints));
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags    = AI_PASSIVE;
+
+            ::addrinfo* addresses = 0;
+
+            const std::string service = std::to_string(port);
+
+            if (0 != ::getaddrinfo(address.empty() ? 0 : address.c_str(), service.c_str(), &hints, &addresses))
+            {
+               std::cout << "reed_solomon::codec_server() - Error: address could not be resolved." << std::endl;
+               return;
+            }
+
+            for (::addrinfo* a = addresses; (0 != a) && (listen_fd_ < 0); a = a->ai_next)
+            {
+               const int fd = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+
+               if (fd < 0)
+                  continue;
+
+               const int on = 1;
+
+               ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+               if ((0 == ::bind(fd, a->ai_addr, a->ai_addrlen)) && (0 == ::listen(fd, SOMAXCONN)))
+                  listen_fd_ = fd;
+               else
+                  ::close(fd);
+            }
+
+            ::freeaddrinfo(addresses);
+
+            if (listen_fd_ < 0)
+            {
+               std::cout << "reed_solomon::codec_server() - Error: could not listen on the port." << std::endl;
+               return;
+            }
+
+            ::sockaddr_storage bound;
+            ::socklen_t        length = sizeof(bound);
+
+            if (0 == ::getsockname(listen_fd_, reinterpret_cast< ::sockaddr*>(&bound), &length))
+            {
+               if (AF_INET6 == bound.ss_family)
+                  port_ = ntohs(reinterpret_cast< ::sockaddr_in6*>(&bound)->sin6_port);
+               else
+                  port_ = ntohs(reinterpret_cast< ::sockaddr_in*>(&bound)->sin_port);
+            }
+         }
+
+        ~codec_server()
+         {
+            stop();
+            close_connections();
+
+            if (listen_fd_ >= 0)
+               ::close(listen_fd_);
+         }
+
+         inline bool valid() const
+         {
+            return (listen_fd_ >= 0);
+         }
+
+         inline unsigned short port() const
+         {
+            return port_;
+         }
+
+         /* Connections accepted, batches and codewords processed so far */
+         inline std::size_t connections() const
+         {
+            return connections_served_.load(std::memory_order_relaxed);
+         }
+
+         inline std::size_t batches() const
+         {
+            return batches_.load(std::memory_order_relaxed);
+         }
+
+         inline std::size_t codewords() const
+         {
+            return codewords_.load(std::memory_order_relaxed);
+         }
+
+         /* Serve connections until stop() is called, from any thread */
+         void run()
+         {
+            if (listen_fd_ < 0)
+               return;
+
+            while (running_.load(std::memory_order_acquire))
+            {
+               const int fd = ::accept4(listen_fd_, 0, 0, SOCK_CLOEXEC);
+
+               if (fd < 0)
+               {
+                  if ((EINTR == errno) || (ECONNABORTED == errno))
+                     continue;
+
+                  break;
+               }
+
+               codec_net::no_delay(fd);
+
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               reap();
+
+               if (!running_.load(std::memory_order_acquire))
+               {
+                  ::close(fd);
+                  break;
+               }
+
+               connections_.push_back(std::unique_ptr<connection>(new connection(*this, fd)));
+
+               connections_served_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            close_connections();
+         }
+
+         /* Stop accepting and drop every connection, batches in flight are finished first */
+         inline void stop()
+         {
+            running_.store(false, std::memory_order_release);
+
+            if (listen_fd_ >= 0)
+               ::shutdown(listen_fd_, SHUT_RDWR);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (typename std::list<std::unique_ptr<connection> >::iterator i = connections_.begin(); i != connections_.end(); ++i)
+            {
+               ::shutdown((*i)->fd, SHUT_RDWR);
+            }
+         }
+
+      private:
+
+         codec_server(const codec_server&);
+         codec_server& operator=(const codec_server&);
+
+         struct batch
+         {
+            codec_net::frame           request;
+            std::uint32_t              status;
+            std::vector<unsigned char> codewords;
+            std::vector< ::iovec>      iov;
+            std::future<std::size_t>   result;
+         };
+
+         struct connection
+         {
+            connection(codec_server& server, const int socket)
+            : fd(socket),
+              free_batches(server.window_),
+              submitted(server.window_),
+              done(false)
+            {
+               for (std::size_t i = 0; i < server.window_; ++i)
+               {
+                  batches.push_back(std::unique_ptr<batch>(new batch));
+                  batches.back()->codewords.resize(server.max_batch_ * code_length);
+                  batches.back()->iov.reserve(server.max_batch_ + 1);
+                  free_batches.push(batches.back().get());
+               }
+
+               reader = std::thread([this, &server]() { server.read_requests(*this); });
+               writer = std::thread([this, &server]() { server.write_replies(*this); });
+            }
+
+           ~connection()
+            {
+               ::shutdown(fd, SHUT_RDWR);
+
+               reader.join();
+               writer.join();
+
+               ::close(fd);
+            }
+
+            const int                            fd;
+            std::vector<std::unique_ptr<batch> > batches;
+            utils::bounded_queue<batch*>         free_batches;
+            utils::bounded_queue<batch*>         submitted;
+            std::atomic<bool>                    done;
+            std::thread                          reader;
+            std::thread                          writer;
+         };
+
+         inline codec_net::frame make_frame(const std::uint32_t operation,
+                                            const std::uint32_t count,
+                                            const std::uint32_t sequence,
+                                            const std::uint32_t value,
+                                            const std::uint32_t status) const
+         {
+            const codec_net::frame f = { codec_net::magic, operation, count, sequence, value, status,
+                                         static_cast<std::uint32_t>(code_length),
+                                         static_cast<std::uint32_t>(fec_length) };
+            return f;
+         }
+
+         void read_requests(connection& c)
+         {
+            unsigned char header[codec_net::header_size];
+
+            codec_net::store(make_frame(codec_net::e_hello, static_cast<std::uint32_t>(max_batch_), 0, static_cast<std::uint32_t>(window_), codec_net::e_ok), header);
+
+            ::iovec hello = { header, sizeof(header) };
+
+            batch* b = 0;
+
+            if (!codec_net::transfer(c.fd, &hello, 1, true))
+            {
+               c.submitted.close();
+               return;
+            }
+
+            /* Note: pop() blocks while window batches are in flight, which is the backpressure */
+            while (c.free_batches.pop(b))
+            {
+               ::iovec h = { header, sizeof(header) };
+
+               if (!codec_net::transfer(c.fd, &h, 1, false))
+                  break;
+
+               codec_net::load(header, b->request);
+
+               b->status = validate(b->request);
+
+               if (codec_net::e_ok != b->status)
+               {
+                  c.submitted.push(b);
+                  break;
+               }
+
+               const std::size_t count = b->request.count;
+
+               unsigned char* codewords = &b->codewords[0];
+
+               b->iov.clear();
+
+               if (codec_net::e_encode == b->request.operation)
+               {
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     const ::iovec v = { codewords + i * code_length, data_length };
+                     b->iov.push_back(v);
+                  }
+               }
+               else
+               {
+                  const ::iovec v = { codewords, count * code_length };
+                  b->iov.push_back(v);
+               }
+
+               if (!codec_net::transfer(c.fd, b->iov.data(), b->iov.size(), false))
+                  break;
+
+               b->result = (codec_net::e_encode == b->request.operation) ?
+                           executor_.encode_buffer(codewords, count) :
+                           executor_.decode_buffer(codewords, count);
+
+               c.submitted.push(b);
+            }
+
+            c.submitted.close();
+         }
+
+         void write_replies(connection& c)
+         {
+            unsigned char header[codec_net::header_size];
+
+            bool connected = true;
+
+            batch* b = 0;
+
+            while (c.submitted.pop(b))
+            {
+               const std::size_t succeeded = b->result.valid() ? b->result.get() : 0;
+
+               const bool        ok    = (codec_net::e_ok == b->status);
+               const std::size_t count = ok ? b->request.count : 0;
+
+               if (ok)
+               {
+                  batches_  .fetch_add(1    , std::memory_order_relaxed);
+                  codewords_.fetch_add(count, std::memory_order_relaxed);
+               }
+
+               codec_net::store(make_frame(b->request.operation,
+                                           static_cast<std::uint32_t>(count),
+                                           b->request.sequence,
+                                           static_cast<std::uint32_t>(succeeded),
+                                           b->status), header);
+
+               b->iov.clear();
+
+               const ::iovec h = { header, sizeof(header) };
+               b->iov.push_back(h);
+
+               unsigned char* codewords = &b->codewords[0];
+
+               if (codec_net::e_encode == b->request.operation)
+               {
+                  const ::iovec v = { codewords, count * code_length };
+                  b->iov.push_back(v);
+               }
+               else
+               {
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     const ::iovec v = { codewords + i * code_length, data_length };
+                     b->iov.push_back(v);
+                  }
+               }
+
+               /* Note: Once the peer is gone, batches are only drained so their buffers are idle */
+               if (connected && !codec_net::transfer(c.fd, b->iov.data(), b->iov.size(), true))
+               {
+                  connected = false;
+                  ::shutdown(c.fd, SHUT_RDWR);
+               }
+
+               c.free_batches.push(b);
+            }
+
+            ::shutdown(c.fd, SHUT_RDWR);
+
+            c.done.store(true, std::memory_order_release);
+         }
+
+         inline std::uint32_t validate(const codec_net::frame& f) const
+         {
+            if (
+                 (codec_net::magic != f.magic) ||
+                 ((codec_net::e_encode != f.operation) && (codec_net::e_decode != f.operation))
+               )
+               return codec_net::e_bad_frame;
+            else if ((code_length != f.code_length) || (fec_length != f.fec_length))
+               return codec_net::e_code_mismatch;
+            else if (f.count > max_batch_)
+               return codec_net::e_batch_too_large;
+            else
+               return codec_net::e_ok;
+         }
+
+         /* Join the connections whose client went away, the caller holding mutex_ */
+         inline void reap()
+         {
+            typename std::list<std::unique_ptr<connection> >::iterator i = connections_.begin();
+
+            while (i != connections_.end())
+            {
+               if ((*i)->done.load(std::memory_order_acquire))
+                  i = connections_.erase(i);
+               else
+                  ++i;
+            }
+         }
+
+         inline void close_connections()
+         {
+            std::list<std::unique_ptr<connection> > connections;
+
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               connections.swap(connections_);
+            }
+
+            connections.clear();
+         }
+
+         const std::size_t                       max_batch_;
+         const std::size_t                       window_;
+         int                                     listen_fd_;
+         unsigned short                          port_;
+         std::atomic<bool>                       running_;
+         executor_type                           executor_;
+         std::mutex                              mutex_;
+         std::list<std::unique_ptr<connection> > connections_;
+         std::atomic<std::size_t>                connections_served_;
+         std::atomic<std::size_t>                batches_;
+         std::atomic<std::size_t>                codewords_;
+      };
+
+      /*
+         Client of a codec_server. The constructor connects to host:port
+         and takes the server's batch limits from its hello. encode()
+         sends the data of count codewords, data_length bytes each back
+         to back, and receives their codewords, decode() sends count
+         codewords and receives their corrected data. Both split the
+         buffer into batches of up to batch codewords and keep as many
+         in flight as the server's window allows, receiving each reply
+         straight into the output buffer.
+
+         Both return the codewords that were encoded or decoded, and
+         invalidate the client when the connection fails.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class codec_remote_client
+      {
+      public:
+
+         static constexpr std::size_t data_length = code_length - fec_length;
+
+         codec_remote_client(const std::string&   host,
+                             const unsigned short port,
+                             const std::size_t    batch = 1024)
+         : fd_(-1),
+           batch_(std::max<std::size_t>(1, batch)),
+           window_(1),
+           sequence_(0)
+         {
+            ::addrinfo hints;
+
+            std::memset(&hints, 0, sizeof(hints));
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            ::addrinfo* addresses = 0;
+
+            const std::string service = std::to_string(port);
+
+            if (0 != ::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses))
+            {
+               std::cout << "reed_solomon::codec_remote_client() - Error: host could not be resolved." << std::endl;
+               return;
+            }
+
+            for (::addrinfo* a = addresses; (0 != a) && (fd_ < 0); a = a->ai_next)
+            {
+               const int fd = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+
+               if (fd < 0)
+                  continue;
+
+               if (0 == ::connect(fd, a->ai_addr, a->ai_addrlen))
+                  fd_ = fd;
+               else
+                  ::close(fd);
+            }
+
+            ::freeaddrinfo(addresses);
+
+            if (fd_ < 0)
+            {
+               std::cout << "reed_solomon::codec_remote_client() - Error: could not connect to the server." << std::endl;
+               return;
+            }
+
+            codec_net::no_delay(fd_);
+
+            unsigned char header[codec_net::header_size];
+
+            ::iovec h = { header, sizeof(header) };
+
+            codec_net::frame hello;
+
+            if (codec_net::transfer(fd_, &h, 1, false))
+            {
+               codec_net::load(header, hello);
+
+               if (
+                    (codec_net::magic     == hello.magic)       &&
+                    (codec_net::e_hello   == hello.operation)   &&
+                    (code_length          == hello.code_length) &&
+                    (fec_length           == hello.fec_length)  &&
+                    (hello.count > 0) && (hello.value > 0)
+                  )
+               {
+                  batch_  = std::min<std::size_t>(batch_, hello.count);
+                  window_ = hello.value;
+                  return;
+               }
+            }
+
+            std::cout << "reed_solomon::codec_remote_client() - Error: server does not serve the code." << std::endl;
+            disconnect();
+         }
+
+        ~codec_remote_client()
+         {
+            disconnect();
+         }
+
+         inline bool valid() const
+         {
+            return (fd_ >= 0);
+         }
+
+         /* Codewords per batch and batches in flight */
+         inline std::size_t batch() const
+         {
+            return batch_;
+         }
+
+         inline std::size_t window() const
+         {
+            return window_;
+         }
+
+         inline std::size_t encode(const unsigned char* data, const std::size_t count, unsigned char* codewords)
+         {
+            return run(codec_net::e_encode, data, count, codewords);
+         }
+
+         inline std::size_t decode(const unsigned char* codewords, const std::size_t count, unsigned char* data)
+         {
+            return run(codec_net::e_decode, codewords, count, data);
+         }
+
+      private:
+
+         codec_remote_client(const codec_remote_client&);
+         codec_remote_client& operator=(const codec_remote_client&);
+
+         inline void disconnect()
+         {
+            if (fd_ >= 0)
+            {
+               ::close(fd_);
+               fd_ = -1;
+            }
+         }
+
+         std::size_t run(const codec_net::operation operation,
+                         const unsigned char*       input,
+                         const std::size_t          count,
+                         unsigned char*             output)
+         {
+            if (fd_ < 0)
+               return 0;
+
+            const std::size_t input_size  = (codec_net::e_encode == operation) ? data_length : code_length;
+            const std::size_t output_size = (codec_net::e_encode == operation) ? code_length : data_length;
+
+            unsigned char header[codec_net::header_size];
+
+            std::size_t total     = 0;
+            std::size_t sent      = 0;
+            std::size_t received  = 0;
+            std::size_t in_flight = 0;
+
+            std::uint32_t first_sequence = sequence_;
+
+            /*
+               Note: Never more batches in flight than the server's window,
+               so it always reads what is sent and the two sides cannot
+               block each other with full socket buffers.
+            */
+            while (received < count)
+            {
+               if ((sent < count) && (in_flight < window_))
+               {
+                  const std::size_t amount = std::min(batch_, count - sent);
+
+                  const codec_net::frame f = { codec_net::magic,
+                                               static_cast<std::uint32_t>(operation),
+                                               static_cast<std::uint32_t>(amount),
+                                               sequence_++,
+                                               0,
+                                               codec_net::e_ok,
+                                               static_cast<std::uint32_t>(code_length),
+                                               static_cast<std::uint32_t>(fec_length) };
+
+                  codec_net::store(f, header);
+
+                  ::iovec iov[2] =
+                     {
+                        { header, sizeof(header) },
+                        { const_cast<unsigned char*>(input + sent * input_size), amount * input_size }
+                     };
+
+                  if (!codec_net::transfer(fd_, iov, 2, true))
+                     break;
+
+                  sent += amount;
+                  ++in_flight;
+
+                  continue;
+               }
+
+               ::iovec h = { header, sizeof(header) };
+
+               codec_net::frame reply;
+
+               if (!codec_net::transfer(fd_, &h, 1, false))
+                  break;
+
+               codec_net::load(header, reply);
+
+               const std::size_t amount = std::min(batch_, count - received);
+
+               if (
+                    (codec_net::magic != reply.magic)    ||
+                    (codec_net::e_ok  != reply.status)   ||
+                    (amount           != reply.count)    ||
+                    (first_sequence   != reply.sequence)
+                  )
+               {
+                  std::cout << "reed_solomon::codec_remote_client::run() - Error: server rejected the batch." << std::endl;
+                  break;
+               }
+
+               ::iovec payload = { output + received * output_size, amount * output_size };
+
+               if (!codec_net::transfer(fd_, &payload, 1, false))
+                  break;
+
+               total    += reply.value;
+               received += amount;
+               --in_flight;
+               ++first_sequence;
+            }
+
+            if (received < count)
+               disconnect();
+
+            return total;
+         }
+
+         int           fd_;
+         std::size_t   batch_;
+         std::size_t   window_;
+         std::uint32_t sequence_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
+
+#endif
@@ -0,0 +1,1360 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_VALIDATOR_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CODEC_VALIDATOR_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/utils/schifra_ecc_traits.hpp"
+#include "schifra/utils/schifra_error_processes.hpp"
+#include "schifra/utils/schifra_utilities.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         The patterns of a validator are numbered, stage by stage, in the
+         order the stages run them. A shard owns every count'th pattern
+         from index, so a validator may be run as several shards at once,
+         each keeping its own counts and failure log. The shards of a
+         given count together run exactly the patterns of a serial run,
+         whatever threads they end up on.
+      */
+      struct validation_shard
+      {
+         validation_shard(const std::size_t shard_index = 0, const std::size_t shard_count = 1)
+         : index(shard_index),
+           count(shard_count),
+           processed(0),
+           failures(0)
+         {}
+
+         inline bool owns(const std::size_t pattern) const
+         {
+            return (pattern % count) == index;
+         }
+
+         const std::size_t  index;
+         const std::size_t  count;
+         unsigned int       processed;
+         unsigned int       failures;
+         std::ostringstream log;
+      };
+
+      template <std::size_t code_length,
+                std::size_t fec_length,
+                typename encoder_type = encoder<code_length,fec_length>,
+                typename decoder_type = decoder<code_length,fec_length>,
+                std::size_t data_length = code_length - fec_length>
+      class codec_validator
+      {
+      public:
+
+         typedef block<code_length,fec_length> block_type;
+         typedef validation_shard              shard_state;
+
+         codec_validator(const galois::field& gf,
+                         const unsigned int gpii,
+                         const std::string& msg)
+         : field_(gf),
+           generator_polynomial_(galois::field_polynomial(field_)),
+           message(msg),
+           genpoly_initial_index_(gpii),
+           blocks_processed_(0),
+           block_failures_(0)
+         {
+            traits::equivalent_encoder_decoder<encoder_type,decoder_type>();
+
+            if (
+                 !make_sequential_root_generator_polynomial(field_,
+                                                            genpoly_initial_index_,
+                                                            fec_length,
+                                                            generator_polynomial_)
+               )
+            {
+               return;
+            }
+
+            rs_encoder_ = std::make_shared<const encoder_type>(field_,generator_polynomial_);
+            rs_decoder_ = std::make_shared<const decoder_type>(field_,genpoly_initial_index_);
+
+            prepare();
+         }
+
+         /* Validate msg with the (immutable) encoder and decoder of codec */
+         codec_validator(const codec_validator& codec, const std::string& msg)
+         : field_(codec.field_),
+           generator_polynomial_(codec.generator_polynomial_),
+           rs_encoder_(codec.rs_encoder_),
+           rs_decoder_(codec.rs_decoder_),
+           message(msg),
+           genpoly_initial_index_(codec.genpoly_initial_index_),
+           blocks_processed_(0),
+           block_failures_(0)
+         {
+            prepare();
+         }
+
+         bool execute()
+         {
+            schifra::utils::timer timer;
+            timer.start();
+
+            shard_state shard;
+
+            bool result = execute(shard);
+
+            timer.stop();
+
+            double time = timer.time();
+
+            blocks_processed_ += shard.processed;
+            block_failures_   += shard.failures;
+
+            std::cout << shard.log.str();
+
+            print_codec_properties();
+            std::cout << "Blocks decoded: "       << blocks_processed_ <<
+                         "\tDecoding Failures: "  << block_failures_   <<
+                         "\tRate: "               << ((blocks_processed_ * data_length) * 8.0) / (1048576.0 * time) << "Mbps" << std::endl;
+            /*
+              Note: The throughput rate is not only the throughput of reed solomon
+                    encoding and decoding, but also that of the steps needed to add
+                    simulated transmission errors to the reed solomon block such as
+                    the calculation of the positions and additions of errors and
+                    erasures to the reed solomon block, which normally in a true
+                    data transmission medium would not be taken into consideration.
+            */
+            return result;
+         }
+
+         /*
+            Run the patterns shard owns, logging failures to shard.log. Any
+            number of distinct shards may be run concurrently.
+         */
+         bool execute(shard_state& shard) const
+         {
+            return stage1(shard) &&
+                   stage2(shard) &&
+                   stage3(shard) &&
+                   stage4(shard) &&
+                   stage5(shard) &&
+                   stage6(shard) &&
+                   stage7(shard) &&
+                   stage8(shard) &&
+                   stage9(shard) &&
+                  stage10(shard) &&
+                  stage11(shard) &&
+                  stage12(shard) ;
+         }
+
+         void print_codec_properties(std::ostream& stream = std::cout) const
+         {
+            stream << "Codec: RS(" << code_length << "," << data_length << "," << fec_length <<") ";
+         }
+
+      private:
+
+         void prepare()
+         {
+            if (!rs_encoder_->encode(message,rs_block_original))
+            {
+               std::cout << "codec_validator() - ERROR: Encoding process failed!" << std::endl;
+               return;
+            }
+
+            /* Seeds the global rand(), hence here rather than in the shards */
+            generate_error_index((fec_length >> 1),random_error_index_,0xA5A5A5A5);
+         }
+
+         bool stage1(shard_state& shard) const
+         {
+            /* Burst Error Only Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            for (std::size_t error_count = 1; error_count <= (fec_length >> 1); ++error_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_all_errors
+                  (
+                    rs_block,
+                    error_count,
+                    start_position,
+                    1
+                  );
+
+                  if (!rs_decoder_->decode(rs_block))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage1() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage1() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage1() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != error_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage1() - Error In The Number Of Detected Errors! Errors Detected: " << rs_block.errors_detected << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_corrected != error_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage1() - Error In The Number Of Corrected Errors! Errors Corrected: " << rs_block.errors_corrected << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage2(shard_state& shard) const
+         {
+            /* Burst Erasure Only Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_all_erasures
+                  (
+                    rs_block,
+                    erasure_list,
+                    erasure_count,
+                    start_position,
+                    1
+                  );
+
+                  if (!rs_decoder_->decode(rs_block,erasure_list))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage2() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     shard.log << "stage2() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage2() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != erasure_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage2() - Error In The Number Of Detected Errors! Errors Detected: " << rs_block.errors_detected << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_corrected != erasure_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage2() - Error In The Number Of Corrected Errors! Errors Corrected: " << rs_block.errors_corrected << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+                  erasure_list.clear();
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage3(shard_state& shard) const
+         {
+            /* Consecutive Burst Erasure and Error Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_errors_erasures
+                  (
+                    rs_block,
+                    error_mode::erasures_errors,
+                    start_position,erasure_count,
+                    erasure_list
+                  );
+
+                  if (!rs_decoder_->decode(rs_block,erasure_list))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage3() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage3() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage3() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+                  erasure_list.clear();
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage4(shard_state& shard) const
+         {
+            /* Consecutive Burst Error and Erasure Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_errors_erasures
+                  (
+                    rs_block,
+                    error_mode::errors_erasures,
+                    start_position,
+                    erasure_count,
+                    erasure_list
+                  );
+
+                  if (!rs_decoder_->decode(rs_block,erasure_list))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage4() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage4() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage4() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+                  erasure_list.clear();
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage5(shard_state& shard) const
+         {
+            /* Distanced Burst Erasure and Error Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t between_distance = 1; between_distance <= 10; ++between_distance)
+            {
+               for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+               {
+                  for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+                  {
+                     if (!shard.owns(pattern++))
+                        continue;
+
+                     block_type rs_block = rs_block_original;
+
+                     corrupt_message_errors_erasures
+                     (
+                       rs_block,
+                       error_mode::erasures_errors,
+                       start_position,
+                       erasure_count,
+                       erasure_list,
+                       between_distance
+                     );
+
+                     if (!rs_decoder_->decode(rs_block,erasure_list))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage5() - Decoding Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (!is_block_equivelent(rs_block,message))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage5() - Error Correcting Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected != rs_block.errors_corrected)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage5() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                        ++shard.failures;
+                     }
+
+                     ++shard.processed;
+                     erasure_list.clear();
+                  }
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage6(shard_state& shard) const
+         {
+            /* Distanced Burst Error and Erasure Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t between_distance = 1; between_distance <= 10; ++between_distance)
+            {
+               for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+               {
+                  for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+                  {
+                     if (!shard.owns(pattern++))
+                        continue;
+
+                     block_type rs_block = rs_block_original;
+
+                     corrupt_message_errors_erasures
+                     (
+                       rs_block,
+                       error_mode::errors_erasures,
+                       start_position,
+                       erasure_count,
+                       erasure_list,between_distance
+                     );
+
+                     if (!rs_decoder_->decode(rs_block,erasure_list))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage6() - Decoding Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (!is_block_equivelent(rs_block,message))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage6() - Error Correcting Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected != rs_block.errors_corrected)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage6() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                        ++shard.failures;
+                     }
+
+                     ++shard.processed;
+                     erasure_list.clear();
+                  }
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage7(shard_state& shard) const
+         {
+            /*  Intermittent Error Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            for (std::size_t error_count = 1; error_count < (fec_length >> 1); ++error_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  for (std::size_t scale = 1; scale < 5; ++scale)
+                  {
+                     if (!shard.owns(pattern++))
+                        continue;
+
+                     block_type rs_block = rs_block_original;
+
+                     corrupt_message_all_errors
+                     (
+                       rs_block,
+                       error_count,
+                       start_position,
+                       scale
+                     );
+
+                     if (!rs_decoder_->decode(rs_block))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage7() - Decoding Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (!is_block_equivelent(rs_block,message))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage7() - Error Correcting Failure! start position: " << start_position << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected != rs_block.errors_corrected)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage7() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected != error_count)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage7() - Error In The Number Of Detected Errors! Errors Detected: " << rs_block.errors_detected << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_corrected != error_count)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage7() - Error In The Number Of Corrected Errors! Errors Corrected: " << rs_block.errors_corrected << std::endl;
+                        ++shard.failures;
+                     }
+
+                     ++shard.processed;
+                  }
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage8(shard_state& shard) const
+         {
+            /* Intermittent Erasure Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  for (std::size_t scale = 4; scale < 5; ++scale)
+                  {
+                     if (!shard.owns(pattern++))
+                        continue;
+
+                     block_type rs_block = rs_block_original;
+
+                     corrupt_message_all_erasures
+                     (
+                       rs_block,
+                       erasure_list,
+                       erasure_count,
+                       start_position,
+                       scale
+                     );
+
+                     if (!rs_decoder_->decode(rs_block,erasure_list))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage8() - Decoding Failure! start position: " << start_position << "\t scale: " << scale << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (!is_block_equivelent(rs_block,message))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage8() - Error Correcting Failure! start position: " << start_position << "\t scale: " << scale <<std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected != (rs_block.errors_corrected + rs_block.zero_numerators))
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage8() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_detected > erasure_count)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage8() - Error In The Number Of Detected Errors! Errors Detected: " << rs_block.errors_detected << std::endl;
+                        ++shard.failures;
+                     }
+                     else if (rs_block.errors_corrected > erasure_count)
+                     {
+                        print_codec_properties(shard.log);
+                        shard.log << "stage8() - Error In The Number Of Corrected Errors! Errors Corrected: " << rs_block.errors_corrected << std::endl;
+                        ++shard.failures;
+                     }
+                     ++shard.processed;
+                     erasure_list.clear();
+                  }
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage9(shard_state& shard) const
+         {
+            /* Burst Interleaved Error and Erasure Combinations */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            erasure_locations_t erasure_list;
+
+            for (std::size_t erasure_count = 1; erasure_count <= fec_length; ++erasure_count)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_interleaved_errors_erasures
+                  (
+                    rs_block,
+                    start_position,
+                    erasure_count,
+                    erasure_list
+                  );
+
+                  if (!rs_decoder_->decode(rs_block,erasure_list))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage9() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage9() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage9() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+                  ++shard.processed;
+                  erasure_list.clear();
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage10(shard_state& shard) const
+         {
+            /* Segmented Burst Errors */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+            {
+               for (std::size_t distance_between_blocks = 0; distance_between_blocks < 5; ++distance_between_blocks)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_all_errors_segmented
+                  (
+                    rs_block,
+                    start_position,
+                    distance_between_blocks
+                  );
+
+                  if (!rs_decoder_->decode(rs_block))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage10() - Decoding Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage10() - Error Correcting Failure! start position: " << start_position << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage10() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage11(shard_state& shard) const
+         {
+            /* No Errors */
+
+            if (!shard.owns(0))
+               return true;
+
+            const std::size_t initial_failure_count = shard.failures;
+
+            block_type rs_block = rs_block_original;
+
+            if (!rs_decoder_->decode(rs_block))
+            {
+               print_codec_properties(shard.log);
+               shard.log << "stage11() - Decoding Failure!" << std::endl;
+               ++shard.failures;
+            }
+            else if (!is_block_equivelent(rs_block,message))
+            {
+               print_codec_properties(shard.log);
+               shard.log << "stage11() - Error Correcting Failure!" << std::endl;
+               ++shard.failures;
+            }
+            else if (rs_block.errors_detected != 0)
+            {
+               print_codec_properties(shard.log);
+               shard.log << "stage11() - Error Correcting Failure!" << std::endl;
+               ++shard.failures;
+            }
+            else if (rs_block.errors_corrected != 0)
+            {
+               print_codec_properties(shard.log);
+               shard.log << "stage11() - Error Correcting Failure!" << std::endl;
+               ++shard.failures;
+            }
+            else if (rs_block.unrecoverable)
+            {
+               print_codec_properties(shard.log);
+               shard.log << "stage11() - Error Correcting Failure!" << std::endl;
+               ++shard.failures;
+            }
+
+            ++shard.processed;
+
+            return (shard.failures == initial_failure_count);
+         }
+
+         bool stage12(shard_state& shard) const
+         {
+            /* Random Errors Only */
+
+            const std::size_t initial_failure_count = shard.failures;
+            std::size_t pattern = 0;
+
+            for (std::size_t error_count = 1; error_count <= (fec_length >> 1); ++error_count)
+            {
+               for (std::size_t error_index = 0; error_index < error_index_size; ++error_index)
+               {
+                  if (!shard.owns(pattern++))
+                     continue;
+
+                  block_type rs_block = rs_block_original;
+
+                  corrupt_message_all_errors_at_index
+                  (
+                    rs_block,
+                    error_count,
+                    error_index,
+                    random_error_index_
+                  );
+
+                  if (!rs_decoder_->decode(rs_block))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage12() - Decoding Failure! error index: " << error_index << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (!is_block_equivelent(rs_block,message))
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage12() - Error Correcting Failure! error index: " << error_index << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != rs_block.errors_corrected)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage12() - Discrepancy between the number of errors detected and corrected. [" << rs_block.errors_detected << "," << rs_block.errors_corrected << "]" << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_detected != error_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage12() - Error In The Number Of Detected Errors! Errors Detected: " << rs_block.errors_detected << std::endl;
+                     ++shard.failures;
+                  }
+                  else if (rs_block.errors_corrected != error_count)
+                  {
+                     print_codec_properties(shard.log);
+                     shard.log << "stage12() - Error In The Number Of Corrected Errors! Errors Corrected: " << rs_block.errors_corrected << std::endl;
+                     ++shard.failures;
+                  }
+
+                  ++shard.processed;
+               }
+            }
+
+            return (shard.failures == initial_failure_count);
+         }
+
+      protected:
+
+         codec_validator() {}
+
+      private:
+
+         codec_validator(const codec_validator&);
+         const codec_validator& operator=(const codec_validator&);
+
+         const galois::field& field_;
+         galois::field_polynomial generator_polynomial_;
+         std::shared_ptr<const encoder_type> rs_encoder_;
+         std::shared_ptr<const decoder_type> rs_decoder_;
+         block_type rs_block_original;
+         const std::string&  message;
+         const unsigned int genpoly_initial_index_;
+         std::vector<std::size_t> random_error_index_;
+         unsigned int blocks_processed_;
+         unsigned int block_failures_;
+      };
+
+      template <std::size_t data_length>
+      void create_messages(std::vector<std::string>& message_list, const bool full_test_set = false)
+      {
+         /* Various message bit patterns */
+
+         message_list.clear();
+
+         if (full_test_set)
+         {
+            for (std::size_t i = 0; i < 256; ++i)
+            {
+               message_list.push_back(std::string(data_length, static_cast<unsigned char>(i)));
+            }
+         }
+         else
+         {
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x00)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xAA)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xA5)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xAC)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xCA)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x5A)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xCC)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xF0)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x0F)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xFF)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x92)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x6D)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x77)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0x7A)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xA7)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xE5)));
+            message_list.push_back(std::string(data_length,static_cast<unsigned char>(0xEB)));
+         }
+
+         std::string tmp_str = std::string(data_length,static_cast<unsigned char>(0x00));
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            tmp_str[i] = static_cast<unsigned char>(i);
+         }
+
+         message_list.push_back(tmp_str);
+
+         for (int i = data_length - 1; i >= 0; --i)
+         {
+            tmp_str[i] = static_cast<unsigned char>(i);
+         }
+
+         message_list.push_back(tmp_str);
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            tmp_str[i] = (((i & 0x01) == 1) ? static_cast<unsigned char>(i) : 0x00);
+         }
+
+         message_list.push_back(tmp_str);
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            tmp_str[i] = (((i & 0x01) == 0) ? static_cast<unsigned char>(i) : 0x00);
+         }
+
+         message_list.push_back(tmp_str);
+
+         for (int i = data_length - 1; i >= 0; --i)
+         {
+            tmp_str[i] = (((i & 0x01) == 1) ? static_cast<unsigned char>(i) : 0x00);
+         }
+
+         message_list.push_back(tmp_str);
+
+         for (int i = data_length - 1; i >= 0; --i)
+         {
+            tmp_str[i] = (((i & 0x01) == 0) ? static_cast<unsigned char>(i) : 0x00);
+         }
+
+         message_list.push_back(tmp_str);
+
+         tmp_str = std::string(data_length,static_cast<unsigned char>(0x00));
+
+         for (std::size_t i = 0; i < (data_length >> 1); ++i)
+         {
+               tmp_str[i] = static_cast<unsigned char>(0xFF);
+         }
+
+         message_list.push_back(tmp_str);
+
+         tmp_str = std::string(data_length,static_cast<unsigned char>(0xFF));
+
+         for (std::size_t i = 0; i < (data_length >> 1); ++i)
+         {
+            tmp_str[i] = static_cast<unsigned char>(0x00);
+         }
+
+         message_list.push_back(tmp_str);
+      }
+
+      /*
+         Validates a set of codes at once. Every (code, message, shard)
+         triple is a job, and the jobs of all the codes are handed out to
+         threads as they free up, so neither small codes nor the tail of a
+         large one leave threads idle. Shards split the patterns of every
+         message deterministically (see validation_shard), so the blocks
+         run and failures found depend on the shard count only, never on
+         the thread count. Failure logs and per code results are printed
+         in code, message and shard order once every job has run; until
+         then progress is reported every progress_interval seconds (0 for
+         none).
+      */
+      class validation_suite
+      {
+      public:
+
+         static const std::size_t default_shards = 16;
+
+         explicit validation_suite(const std::size_t threads           = 0,
+                                   const std::size_t shards            = default_shards,
+                                   const double      progress_interval = 10.0)
+         : threads_((threads > 0) ? threads : std::max<std::size_t>(1, std::thread::hardware_concurrency())),
+           shards_((shards > 0) ? shards : 1),
+           progress_interval_(progress_interval)
+         {}
+
+         template <std::size_t field_descriptor,
+                   std::size_t gen_poly_index,
+                   std::size_t code_length,
+                   std::size_t fec_length,
+                   typename encoder_type = encoder<code_length,fec_length>,
+                   typename decoder_type = decoder<code_length,fec_length> >
+         void add(const std::size_t prim_poly_size, const unsigned int prim_poly[])
+         {
+            codes_.push_back(std::unique_ptr<code_set>(
+               new code_set_impl<field_descriptor,gen_poly_index,code_length,fec_length,encoder_type,decoder_type>
+                  (prim_poly_size, prim_poly, shards_)));
+         }
+
+         template <std::size_t field_descriptor,
+                   std::size_t gen_poly_index,
+                   std::size_t code_length,
+                   std::size_t fec_length>
+         void add_shortened(const std::size_t prim_poly_size, const unsigned int prim_poly[])
+         {
+            add<field_descriptor,gen_poly_index,code_length,fec_length,
+                shortened_encoder<code_length,fec_length>,
+                shortened_decoder<code_length,fec_length> >(prim_poly_size, prim_poly);
+         }
+
+         inline std::size_t threads() const
+         {
+            return threads_;
+         }
+
+         bool run()
+         {
+            std::vector<std::pair<std::size_t,std::size_t> > jobs;
+
+            for (std::size_t c = 0; c < codes_.size(); ++c)
+            {
+               for (std::size_t j = 0; j < codes_[c]->jobs(); ++j)
+               {
+                  jobs.push_back(std::make_pair(c, j));
+               }
+            }
+
+            std::atomic<std::size_t>   next_job(0);
+            std::atomic<std::size_t>   jobs_done(0);
+            std::atomic<std::uint64_t> blocks_done(0);
+            std::mutex                 mutex;
+            std::condition_variable    finished;
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> workers;
+
+            for (std::size_t t = 0; t < threads_; ++t)
+            {
+               workers.push_back(std::thread([&]()
+                                 {
+                                    for (std::size_t i = next_job++; i < jobs.size(); i = next_job++)
+                                    {
+                                       code_set& code = *codes_[jobs[i].first];
+
+                                       blocks_done += code.run_job(jobs[i].second);
+
+                                       if ((++jobs_done) == jobs.size())
+                                       {
+                                          std::lock_guard<std::mutex> lock(mutex);
+                                          finished.notify_all();
+                                       }
+                                    }
+                                 }));
+            }
+
+            {
+               std::unique_lock<std::mutex> lock(mutex);
+
+               while (jobs_done < jobs.size())
+               {
+                  if (progress_interval_ <= 0.0)
+                  {
+                     finished.wait(lock);
+                     continue;
+                  }
+
+                  finished.wait_for(lock, std::chrono::duration<double>(progress_interval_));
+
+                  if (jobs_done < jobs.size())
+                  {
+                     const double elapsed = seconds_since(start);
+
+                     std::cout << "validation_suite - " << jobs_done << "/" << jobs.size() << " jobs "
+                               << "(" << (100.0 * jobs_done) / jobs.size() << "%)\t"
+                               << "Blocks: " << blocks_done << "\t"
+                               << "Throughput: " << blocks_done / elapsed << " blocks/s" << std::endl;
+                  }
+               }
+            }
+
+            for (std::size_t t = 0; t < workers.size(); ++t)
+            {
+               workers[t].join();
+            }
+
+            const double elapsed = seconds_since(start);
+
+            bool result = true;
+
+            for (std::size_t c = 0; c < codes_.size(); ++c)
+            {
+               result = codes_[c]->report(std::cout) && result;
+            }
+
+            std::cout << "validation_suite - Codes: "  << codes_.size() <<
+                         "\tBlocks decoded: "          << blocks_done   <<
+                         "\tTime: "                    << elapsed << "s"
+                         "\tThroughput: "              << blocks_done / elapsed << " blocks/s"
+                         " (" << threads_ << " threads)" << std::endl;
+
+            return result;
+         }
+
+      private:
+
+         static inline double seconds_since(const std::chrono::steady_clock::time_point& start)
+         {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         }
+
+         struct code_set
+         {
+            virtual ~code_set() {}
+
+            virtual std::size_t jobs() const = 0;
+
+            /* Returns the number of blocks the job decoded */
+            virtual std::size_t run_job(const std::size_t job) = 0;
+
+            /* Prints the failure logs and results, returns true when all jobs passed */
+            virtual bool report(std::ostream& stream) const = 0;
+         };
+
+         template <std::size_t field_descriptor,
+                   std::size_t gen_poly_index,
+                   std::size_t code_length,
+                   std::size_t fec_length,
+                   typename encoder_type,
+                   typename decoder_type>
+         class code_set_impl : public code_set
+         {
+         public:
+
+            static const std::size_t data_length = code_length - fec_length;
+
+            typedef codec_validator<code_length,fec_length,encoder_type,decoder_type> validator_type;
+
+            code_set_impl(const std::size_t prim_poly_size, const unsigned int prim_poly[], const std::size_t shards)
+            : field_(field_descriptor,prim_poly_size,prim_poly),
+              shard_count_(shards)
+            {
+               create_messages<data_length>(messages_);
+
+               /* One encoder and decoder, shared by the validators of every message */
+               for (std::size_t i = 0; i < messages_.size(); ++i)
+               {
+                  validators_.push_back(std::unique_ptr<validator_type>(
+                     (0 == i) ? new validator_type(field_, gen_poly_index, messages_[i]) :
+                                new validator_type(*validators_[0], messages_[i])));
+
+                  for (std::size_t s = 0; s < shard_count_; ++s)
+                  {
+                     shards_.push_back(std::unique_ptr<validation_shard>(new validation_shard(s, shard_count_)));
+                  }
+               }
+
+               passed_ .resize(shards_.size(), 0);
+               seconds_.resize(shards_.size(), 0.0);
+            }
+
+            std::size_t jobs() const
+            {
+               return shards_.size();
+            }
+
+            std::size_t run_job(const std::size_t job)
+            {
+               schifra::utils::timer timer;
+               timer.start();
+
+               validation_shard& shard = *shards_[job];
+
+               passed_[job] = validators_[job / shard_count_]->execute(shard) ? 1 : 0;
+
+               timer.stop();
+
+               seconds_[job] = timer.time();
+
+               return shard.processed;
+            }
+
+            bool report(std::ostream& stream) const
+            {
+               std::uint64_t processed = 0;
+               std::uint64_t failures  = 0;
+               double        seconds   = 0.0;
+               bool          result    = true;
+
+               for (std::size_t j = 0; j < shards_.size(); ++j)
+               {
+                  stream << shards_[j]->log.str();
+
+                  processed += shards_[j]->processed;
+                  failures  += shards_[j]->failures;
+                  seconds   += seconds_[j];
+                  result     = result && passed_[j];
+               }
+
+               validators_[0]->print_codec_properties(stream);
+
+               /* Rate is per thread, see codec_validator::execute() */
+               stream << "Messages: "            << messages_.size() <<
+                         "\tBlocks decoded: "    << processed        <<
+                         "\tDecoding Failures: " << failures         <<
+                         "\tRate: "              << ((seconds > 0.0) ? ((processed * data_length) * 8.0) / (1048576.0 * seconds) : 0.0) << "Mbps" << std::endl;
+
+               return result;
+            }
+
+         private:
+
+            const galois::field                           field_;
+            const std::size_t                             shard_count_;
+            std::vector<std::string>                      messages_;
+            std::vector<std::unique_ptr<validator_type> > validators_;
+            std::vector<std::unique_ptr<validation_shard> > shards_;
+            std::vector<char>                             passed_;
+            std::vector<double>                           seconds_;
+         };
+
+         const std::size_t                        threads_;
+         const std::size_t                        shards_;
+         const double                             progress_interval_;
+         std::vector<std::unique_ptr<code_set> >  codes_;
+      };
+
+      template <std::size_t field_descriptor, std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+      inline bool codec_validation_test(const std::size_t prim_poly_size,const unsigned int prim_poly[], const std::size_t threads = 0)
+      {
+         validation_suite suite(threads);
+         suite.add<field_descriptor,gen_poly_index,code_length,fec_length>(prim_poly_size,prim_poly);
+         return suite.run();
+      }
+
+      template <std::size_t field_descriptor,
+                std::size_t gen_poly_index,
+                std::size_t code_length,
+                std::size_t fec_length>
+      inline bool shortened_codec_validation_test(const std::size_t prim_poly_size,const unsigned int prim_poly[], const std::size_t threads = 0)
+      {
+         validation_suite suite(threads);
+         suite.add_shortened<field_descriptor,gen_poly_index,code_length,fec_length>(prim_poly_size,prim_poly);
+         return suite.run();
+      }
+
+      inline void add_codec_validation_test00(validation_suite& suite)
+      {
+         suite.add<8,120,255,  2>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255,  4>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255,  6>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 10>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 12>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 14>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 16>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 18>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 20>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 22>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 24>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 32>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 64>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 80>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255, 96>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+         suite.add<8,120,255,128>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+      }
+
+      inline void add_codec_validation_test01(validation_suite& suite)
+      {
+         suite.add_shortened<8,120,126,14>(galois::primitive_polynomial_size06,galois::primitive_polynomial06); /* Intelsat 1 RS Code */
+         suite.add_shortened<8,120,194,16>(galois::primitive_polynomial_size06,galois::primitive_polynomial06); /* Intelsat 2 RS Code */
+         suite.add_shortened<8,120,219,18>(galois::primitive_polynomial_size06,galois::primitive_polynomial06); /* Intelsat 3 RS Code */
+         suite.add_shortened<8,120,225,20>(galois::primitive_polynomial_size06,galois::primitive_polynomial06); /* Intelsat 4 RS Code */
+         suite.add_shortened<8,  1,204,16>(galois::primitive_polynomial_size05,galois::primitive_polynomial05); /* DBV/MPEG-2 TSP RS Code */
+         suite.add_shortened<8,  1,104,27>(galois::primitive_polynomial_size05,galois::primitive_polynomial05); /* Magnetic Storage Outer RS Code */
+         suite.add_shortened<8,  1,204,12>(galois::primitive_polynomial_size05,galois::primitive_polynomial05); /* Magnetic Storage Inner RS Code */
+         suite.add_shortened<8,120, 72,10>(galois::primitive_polynomial_size06,galois::primitive_polynomial06); /* VDL Mode 3 RS Code */
+      }
+
+      inline bool codec_validation_test00(const std::size_t threads = 0)
+      {
+         validation_suite suite(threads);
+         add_codec_validation_test00(suite);
+         return suite.run();
+      }
+
+      inline bool codec_validation_test01(const std::size_t threads = 0)
+      {
+         validation_suite suite(threads);
+         add_codec_validation_test01(suite);
+         return suite.run();
+      }
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,542 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CONTAINER_REMOTE_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CONTAINER_REMOTE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra_reed_solomon_file_container.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace container
+      {
+
+         #if defined(__unix__) || defined(__APPLE__)
+
+         /*
+            range_reader of an object behind an HTTP/1.1 server, eg: an
+            S3 compatible object store, reading each range with a GET
+            carrying a Range header. The ranges of one read() are fetched
+            concurrently over up to connections keep-alive connections,
+            which are pooled across reads. A server answering with the
+            whole object (200 rather than 206) fails the read and has its
+            connection dropped at once, so an object is never downloaded
+            whole.
+
+            url is "http://host[:port]/path". headers are sent as given
+            with every request, eg: "Authorization: ..." for a store that
+            is not public, as computed by the caller. TLS is not spoken;
+            an https endpoint is reached through a local proxy, or with a
+            presigned URL served over plain HTTP.
+         */
+         class http_range_reader : public range_reader
+         {
+         public:
+
+            static constexpr std::size_t default_connections = 8;
+
+            http_range_reader(const std::string&              url,
+                              const std::size_t               connections = default_connections,
+                              const std::vector<std::string>& headers     = std::vector<std::string>(),
+                              const std::chrono::seconds      timeout     = std::chrono::seconds(30))
+            : connections_(std::max<std::size_t>(1, connections)),
+              timeout_(timeout),
+              valid_(false),
+              requests_(0),
+              bytes_(0)
+            {
+               if (!parse_url(url))
+               {
+                  std::cout << "reed_solomon::http_range_reader() - Error: invalid URL, expected http://host[:port]/path." << std::endl;
+                  return;
+               }
+
+               for (std::size_t i = 0; i < headers.size(); ++i)
+               {
+                  extra_headers_ += headers[i] + "\r\n";
+               }
+
+               valid_ = true;
+            }
+
+           ~http_range_reader()
+            {
+               for (std::size_t i = 0; i < idle_.size(); ++i)
+               {
+                  ::close(idle_[i]);
+               }
+            }
+
+            inline bool valid() const
+            {
+               return valid_;
+            }
+
+            /* GETs issued and body bytes received since construction */
+            inline std::size_t requests() const
+            {
+               return requests_.load(std::memory_order_relaxed);
+            }
+
+            inline std::size_t bytes() const
+            {
+               return bytes_.load(std::memory_order_relaxed);
+            }
+
+            using range_reader::read;
+
+            bool read(const std::uint64_t offset, const std::size_t size, unsigned char* data)
+            {
+               const range r = { offset, size, data };
+
+               return valid_ && fetch(r);
+            }
+
+            bool read(const range* ranges, const std::size_t count)
+            {
+               if (!valid_)
+                  return false;
+
+               const std::size_t workers = std::min(connections_, count);
+
+               if (workers <= 1)
+               {
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     if (!fetch(ranges[i]))
+                        return false;
+                  }
+
+                  return true;
+               }
+
+               std::atomic<std::size_t> next(0);
+               std::atomic<bool>        failed(false);
+
+               const auto work = [&]()
+                                 {
+                                    for (std::size_t i = next++; (i < count) && !failed; i = next++)
+                                    {
+                                       if (!fetch(ranges[i]))
+                                          failed = true;
+                                    }
+                                 };
+
+               std::vector<std::thread> threads;
+
+               for (std::size_t t = 1; t < workers; ++t)
+               {
+                  threads.push_back(std::thread(work));
+               }
+
+               work();
+
+               for (std::size_t t = 0; t < threads.size(); ++t)
+               {
+                  threads[t].join();
+               }
+
+               return !failed;
+            }
+
+         private:
+
+            http_range_reader(const http_range_reader&);
+            http_range_reader& operator=(const http_range_reader&);
+
+            bool parse_url(const std::string& url)
+            {
+               const std::string scheme = "http://";
+
+               if (0 != url.compare(0, scheme.size(), scheme))
+                  return false;
+
+               const std::size_t path_start = url.find('/', scheme.size());
+
+               std::string authority = url.substr(scheme.size(), (std::string::npos == path_start) ? std::string::npos : path_start - scheme.size());
+
+               path_ = (std::string::npos == path_start) ? std::string("/") : url.substr(path_start);
+
+               const std::size_t colon = authority.rfind(':');
+
+               if ((std::string::npos != colon) && (std::string::npos == authority.find(']', colon)))
+               {
+                  host_ = authority.substr(0, colon);
+                  port_ = authority.substr(colon + 1);
+               }
+               else
+               {
+                  host_ = authority;
+                  port_ = "80";
+               }
+
+               host_header_ = authority;
+
+               if (!host_.empty() && ('[' == host_[0]) && (']' == host_[host_.size() - 1]))
+                  host_ = host_.substr(1, host_.size() - 2);
+
+               return !host_.empty() && !port_.empty();
+            }
+
+            int connect()
+            {
+               ::addrinfo hints;
+
+               std::memset(&hints, 0, sizeof(hints));
+
+               hints.ai_family   = AF_UNSPEC;
+               hints.ai_socktype = SOCK_STREAM;
+
+               ::addrinfo* addresses = 0;
+
+               if (0 != ::getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses))
+                  return -1;
+
+               int fd = -1;
+
+               for (::addrinfo* a = addresses; (0 != a) && (fd < 0); a = a->ai_next)
+               {
+                  fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+                  if ((fd >= 0) && (0 != ::connect(fd, a->ai_addr, a->ai_addrlen)))
+                  {
+                     ::close(fd);
+                     fd = -1;
+                  }
+               }
+
+               ::freeaddrinfo(addresses);
+
+               if (fd < 0)
+                  return -1;
+
+               const int on = 1;
+
+               ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+               ::timeval tv;
+
+               tv.tv_sec  = static_cast<long>(timeout_.count());
+               tv.tv_usec = 0;
+
+               ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+               ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+               return fd;
+            }
+
+            /* A pooled connection if any, else a new one */
+            int acquire(bool& reused)
+            {
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  if (!idle_.empty())
+                  {
+                     const int fd = idle_.back();
+
+                     idle_.pop_back();
+                     reused = true;
+
+                     return fd;
+                  }
+               }
+
+               reused = false;
+
+               return connect();
+            }
+
+            void release(const int fd)
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               if (idle_.size() < connections_)
+                  idle_.push_back(fd);
+               else
+                  ::close(fd);
+            }
+
+            /*
+               One ranged GET. A pooled connection the server has since
+               closed fails before any response, and is retried once on a
+               new connection.
+            */
+            bool fetch(const range& r)
+            {
+               if (0 == r.size)
+                  return true;
+
+               for (std::size_t attempt = 0; attempt < 2; ++attempt)
+               {
+                  bool reused = false;
+
+                  const int fd = acquire(reused);
+
+                  if (fd < 0)
+                  {
+                     std::cout << "reed_solomon::http_range_reader() - Error: could not connect to " << host_ << ":" << port_ << "." << std::endl;
+                     return false;
+                  }
+
+                  bool responded  = false;
+                  bool keep_alive = false;
+
+                  if (get(fd, r, responded, keep_alive))
+                  {
+                     if (keep_alive)
+                        release(fd);
+                     else
+                        ::close(fd);
+
+                     ++requests_;
+                     bytes_ += r.size;
+
+                     return true;
+                  }
+
+                  ::close(fd);
+
+                  if (responded || !reused)
+                     return false;
+               }
+
+               return false;
+            }
+
+            static inline bool send_all(const int fd, const char* data, std::size_t size)
+            {
+               while (size > 0)
+               {
+                  #if defined(MSG_NOSIGNAL)
+                  const ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+                  #else
+                  const ssize_t sent = ::send(fd, data, size, 0);
+                  #endif
+
+                  if (sent < 0)
+                  {
+                     if (EINTR == errno)
+                        continue;
+
+                     return false;
+                  }
+
+                  data += sent;
+                  size -= static_cast<std::size_t>(sent);
+               }
+
+               return true;
+            }
+
+            static inline bool receive_all(const int fd, unsigned char* data, std::size_t size)
+            {
+               while (size > 0)
+               {
+                  const ssize_t received = ::recv(fd, data, size, 0);
+
+                  if (received <= 0)
+                  {
+                     if ((received < 0) && (EINTR == errno))
+                        continue;
+
+                     return false;
+                  }
+
+                  data += received;
+                  size -= static_cast<std::size_t>(received);
+               }
+
+               return true;
+            }
+
+            static inline std::string lower(std::string s)
+            {
+               for (std::size_t i = 0; i < s.size(); ++i)
+               {
+                  s[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(s[i])));
+               }
+
+               return s;
+            }
+
+            bool get(const int fd, const range& r, bool& responded, bool& keep_alive)
+            {
+               const std::string request = "GET " + path_ + " HTTP/1.1\r\n"
+                                           "Host: " + host_header_ + "\r\n"
+                                           "Range: bytes=" + std::to_string(r.offset) + "-" + std::to_string(r.offset + r.size - 1) + "\r\n" +
+                                           extra_headers_ +
+                                           "\r\n";
+
+               if (!send_all(fd, request.data(), request.size()))
+                  return false;
+
+               /* Response head, with whatever of the body arrived with it */
+               std::string head;
+               char        buffer[4096];
+               std::size_t head_end = std::string::npos;
+
+               while (std::string::npos == (head_end = head.find("\r\n\r\n")))
+               {
+                  const ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+
+                  if (received <= 0)
+                  {
+                     if ((received < 0) && (EINTR == errno))
+                        continue;
+
+                     return false;
+                  }
+
+                  responded = true;
+
+                  head.append(buffer, static_cast<std::size_t>(received));
+
+                  if (head.size() > 65536)
+                     return false;
+               }
+
+               const std::string body = head.substr(head_end + 4);
+
+               head = lower(head.substr(0, head_end + 2));
+
+               const int status = (head.size() > 12) ? std::atoi(head.c_str() + 9) : 0;
+
+               if (206 != status)
+               {
+                  if (200 == status)
+                     std::cout << "reed_solomon::http_range_reader() - Error: server ignored the range request." << std::endl;
+                  else
+                     std::cout << "reed_solomon::http_range_reader() - Error: HTTP status " << status << " for " << path_ << "." << std::endl;
+
+                  return false;
+               }
+
+               const std::string content_length = header_value(head, "content-length");
+               const std::string content_range  = header_value(head, "content-range");
+
+               if (
+                    content_length.empty()                                                              ||
+                    (std::strtoull(content_length.c_str(), 0, 10) != r.size)                            ||
+                    (0 != content_range.compare(0, 6, "bytes "))                                        ||
+                    (std::strtoull(content_range.c_str() + 6, 0, 10) != r.offset)                       ||
+                    (body.size() > r.size)
+                  )
+               {
+                  std::cout << "reed_solomon::http_range_reader() - Error: unexpected range in the response for " << path_ << "." << std::endl;
+                  return false;
+               }
+
+               std::memcpy(r.data, body.data(), body.size());
+
+               if (!receive_all(fd, r.data + body.size(), r.size - body.size()))
+                  return false;
+
+               keep_alive = (std::string::npos == header_value(head, "connection").find("close")) &&
+                            (0 != head.compare(0, 8, "http/1.0"));
+
+               return true;
+            }
+
+            /* Value of a header of a lower cased response head, or "" */
+            static inline std::string header_value(const std::string& head, const std::string& name)
+            {
+               const std::string key = "\r\n" + name + ":";
+
+               const std::size_t position = head.find(key);
+
+               if (std::string::npos == position)
+                  return std::string();
+
+               std::size_t begin = position + key.size();
+               std::size_t end   = head.find("\r\n", begin);
+
+               while ((begin < end) && (' ' == head[begin]))
+               {
+                  ++begin;
+               }
+
+               while ((end > begin) && (' ' == head[end - 1]))
+               {
+                  --end;
+               }
+
+               return head.substr(begin, end - begin);
+            }
+
+            std::string                host_;
+            std::string                port_;
+            std::string                host_header_;
+            std::string                path_;
+            std::string                extra_headers_;
+            const std::size_t          connections_;
+            const std::chrono::seconds timeout_;
+            bool                       valid_;
+            std::mutex                 mutex_;
+            std::vector<int>           idle_;
+            std::atomic<std::size_t>   requests_;
+            std::atomic<std::size_t>   bytes_;
+         };
+
+         #endif
+
+      } // namespace container
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+
+#endif
@@ -0,0 +1,755 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_COROUTINES_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_COROUTINES_HPP
+
+
+/* Note: Only compiled as C++20 or later, C++17 translation units see nothing of it */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+
+#define SCHIFRA_COROUTINES
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_parallel_file_codec.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      template <typename T = void>
+      class codec_task;
+
+      namespace details
+      {
+
+         struct task_promise_base
+         {
+            struct final_awaiter
+            {
+               inline bool await_ready() const noexcept
+               {
+                  return false;
+               }
+
+               /* Symmetric transfer to whoever awaited the task */
+               template <typename Promise>
+               inline std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+               {
+                  const std::coroutine_handle<> continuation = handle.promise().continuation;
+
+                  return continuation ? continuation : std::noop_coroutine();
+               }
+
+               inline void await_resume() const noexcept {}
+            };
+
+            inline std::suspend_always initial_suspend() const noexcept
+            {
+               return std::suspend_always();
+            }
+
+            inline final_awaiter final_suspend() const noexcept
+            {
+               return final_awaiter();
+            }
+
+            inline void unhandled_exception() noexcept
+            {
+               error = std::current_exception();
+            }
+
+            std::coroutine_handle<> continuation;
+            std::exception_ptr      error;
+         };
+
+         template <typename T>
+         struct task_promise : public task_promise_base
+         {
+            inline codec_task<T> get_return_object() noexcept;
+
+            inline void return_value(T v)
+            {
+               value = std::move(v);
+            }
+
+            inline T result()
+            {
+               if (error)
+                  std::rethrow_exception(error);
+
+               return std::move(*value);
+            }
+
+            std::optional<T> value;
+         };
+
+         template <>
+         struct task_promise<void> : public task_promise_base
+         {
+            inline codec_task<void> get_return_object() noexcept;
+
+            inline void return_void() const noexcept {}
+
+            inline void result()
+            {
+               if (error)
+                  std::rethrow_exception(error);
+            }
+         };
+
+         /* Started at once and never awaited, frees itself when done */
+         struct detached_task
+         {
+            struct promise_type
+            {
+               inline detached_task get_return_object() const noexcept { return detached_task();  }
+               inline std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+               inline std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+               inline void return_void() const noexcept {}
+               inline void unhandled_exception() const noexcept { std::terminate(); }
+            };
+         };
+
+      } // namespace details
+
+      /*
+         Lazily started coroutine yielding a T. co_await starts it and
+         resumes the awaiter when it returns, rethrowing what it threw;
+         sync_wait() runs one to completion from plain code.
+      */
+      template <typename T>
+      class codec_task
+      {
+      public:
+
+         typedef details::task_promise<T>                promise_type;
+         typedef std::coroutine_handle<promise_type>    handle_type;
+
+         explicit codec_task(const handle_type handle) noexcept
+         : handle_(handle)
+         {}
+
+         codec_task(codec_task&& task) noexcept
+         : handle_(std::exchange(task.handle_, handle_type()))
+         {}
+
+         codec_task& operator=(codec_task&& task) noexcept
+         {
+            if (this != &task)
+            {
+               if (handle_)
+                  handle_.destroy();
+
+               handle_ = std::exchange(task.handle_, handle_type());
+            }
+
+            return *this;
+         }
+
+        ~codec_task()
+         {
+            if (handle_)
+               handle_.destroy();
+         }
+
+         struct awaiter
+         {
+            inline bool await_ready() const noexcept
+            {
+               return !handle || handle.done();
+            }
+
+            inline std::coroutine_handle<> await_suspend(const std::coroutine_handle<> continuation) noexcept
+            {
+               handle.promise().continuation = continuation;
+
+               return handle;
+            }
+
+            inline T await_resume()
+            {
+               return handle.promise().result();
+            }
+
+            handle_type handle;
+         };
+
+         inline awaiter operator co_await() const noexcept
+         {
+            return awaiter { handle_ };
+         }
+
+      private:
+
+         codec_task(const codec_task&) = delete;
+         codec_task& operator=(const codec_task&) = delete;
+
+         handle_type handle_;
+      };
+
+      namespace details
+      {
+         template <typename T>
+         inline codec_task<T> task_promise<T>::get_return_object() noexcept
+         {
+            return codec_task<T>(std::coroutine_handle<task_promise<T> >::from_promise(*this));
+         }
+
+         inline codec_task<void> task_promise<void>::get_return_object() noexcept
+         {
+            return codec_task<void>(std::coroutine_handle<task_promise<void> >::from_promise(*this));
+         }
+
+      } // namespace details
+
+      /* Block the calling thread until task completes, returning its result */
+      template <typename T>
+      T sync_wait(codec_task<T>&& task)
+      {
+         std::mutex              mutex;
+         std::condition_variable finished;
+         bool                    done = false;
+         std::exception_ptr      error;
+         std::optional<typename std::conditional<std::is_void<T>::value, bool, T>::type> result;
+
+         auto driver = [&]() -> details::detached_task
+                       {
+                          try
+                          {
+                             if constexpr (std::is_void<T>::value)
+                                co_await task;
+                             else
+                                result = co_await task;
+                          }
+                          catch (...)
+                          {
+                             error = std::current_exception();
+                          }
+
+                          std::lock_guard<std::mutex> lock(mutex);
+                          done = true;
+                          finished.notify_all();
+                       };
+
+         driver();
+
+         std::unique_lock<std::mutex> lock(mutex);
+         finished.wait(lock, [&done]() { return done; });
+
+         if (error)
+            std::rethrow_exception(error);
+
+         if constexpr (!std::is_void<T>::value)
+            return std::move(*result);
+      }
+
+      namespace details
+      {
+         template <typename T>
+         struct when_all_state
+         {
+            typedef typename std::conditional<std::is_void<T>::value, bool, T>::type value_type;
+
+            explicit when_all_state(std::vector<codec_task<T> >& t)
+            : tasks(t),
+              results(t.size()),
+              remaining(t.size() + 1)
+            {}
+
+            inline bool await_ready() const noexcept
+            {
+               return tasks.empty();
+            }
+
+            /* Start every task, the last to finish resuming the awaiter */
+            bool await_suspend(const std::coroutine_handle<> handle)
+            {
+               continuation = handle;
+
+               for (std::size_t i = 0; i < tasks.size(); ++i)
+               {
+                  run(i);
+               }
+
+               return (1 != remaining.fetch_sub(1, std::memory_order_acq_rel));
+            }
+
+            inline void await_resume() const noexcept {}
+
+            detached_task run(const std::size_t i)
+            {
+               try
+               {
+                  if constexpr (std::is_void<T>::value)
+                     co_await tasks[i];
+                  else
+                     results[i] = co_await tasks[i];
+               }
+               catch (...)
+               {
+                  std::lock_guard<std::mutex> lock(mutex);
+
+                  if (!error)
+                     error = std::current_exception();
+               }
+
+               if (1 == remaining.fetch_sub(1, std::memory_order_acq_rel))
+                  continuation.resume();
+            }
+
+            std::vector<codec_task<T> >&             tasks;
+            std::vector<std::optional<value_type> >  results;
+            std::atomic<std::size_t>                 remaining;
+            std::coroutine_handle<>                  continuation;
+            std::mutex                               mutex;
+            std::exception_ptr                       error;
+         };
+
+      } // namespace details
+
+      /*
+         Run tasks concurrently, completing once all have, with their
+         results in order. The first exception thrown by any of them is
+         rethrown once all are done.
+      */
+      template <typename T>
+      codec_task<std::vector<T> > when_all(std::vector<codec_task<T> > tasks)
+      {
+         details::when_all_state<T> state(tasks);
+
+         co_await state;
+
+         if (state.error)
+            std::rethrow_exception(state.error);
+
+         std::vector<T> results;
+
+         results.reserve(tasks.size());
+
+         for (std::size_t i = 0; i < state.results.size(); ++i)
+         {
+            results.push_back(std::move(*state.results[i]));
+         }
+
+         co_return results;
+      }
+
+      inline codec_task<void> when_all(std::vector<codec_task<void> > tasks)
+      {
+         details::when_all_state<void> state(tasks);
+
+         co_await state;
+
+         if (state.error)
+            std::rethrow_exception(state.error);
+      }
+
+      /*
+         Coroutine front-end of a codec_executor: co_await async_encode()
+         or async_decode() suspends the coroutine, and it is resumed, by
+         default on the worker that completed its codewords, once they are
+         processed in place, the co_await yielding how many succeeded. No
+         thread blocks on a request, so one event loop thread can keep
+         network reads, disk reads and coding in flight together; pass a
+         resume function (eg: posting the handle to the loop) to have
+         coroutines continue on the loop rather than on a worker.
+
+         Requests go through the executor's own work queues and classes.
+         Small ones, under coalesce_below codewords (0 for the executor's
+         grain) with no deadline or control, are batched transparently: a
+         small request goes straight out when no batch of small requests
+         of its class is in flight, otherwise it joins the next one, which
+         leaves as soon as the one in flight completes. A burst of tiny
+         requests thus costs a handful of executor batches rather than one
+         each, while a lone request is never held back.
+
+         Note: The codewords must stay untouched until the coroutine is
+               resumed, and the async_codec must outlive its requests.
+      */
+      template <std::size_t code_length, std::size_t fec_length, typename T = unsigned char>
+      class async_codec
+      {
+      public:
+
+         typedef codec_executor<code_length,fec_length>          executor_type;
+         typedef typename executor_type::context                 context;
+         typedef std::function<void(std::coroutine_handle<>)>    resume_type;
+
+         static constexpr std::size_t data_length = code_length - fec_length;
+
+         class operation;
+
+         explicit async_codec(executor_type&      executor,
+                              const std::size_t   coalesce_below = 0,
+                              const resume_type&  resume         = resume_type())
+         : executor_(executor),
+           coalesce_below_((coalesce_below > 0) ? coalesce_below : executor.grain()),
+           resume_(resume)
+         {
+            for (std::size_t p = 0; p < e_priority_count; ++p)
+            {
+               in_flight_[p] = false;
+            }
+         }
+
+         /* count codewords back to back from codewords, data then parity, encoded in place */
+         inline operation async_encode(T* codewords, const std::size_t count, const batch_options& options = batch_options())
+         {
+            return operation(*this, true, codewords, count, options);
+         }
+
+         inline operation async_decode(T* codewords, const std::size_t count, const batch_options& options = batch_options())
+         {
+            return operation(*this, false, codewords, count, options);
+         }
+
+         /* Executor batches submitted, and requests they carried */
+         inline std::size_t batches() const
+         {
+            return batches_.load(std::memory_order_relaxed);
+         }
+
+         inline std::size_t requests() const
+         {
+            return requests_.load(std::memory_order_relaxed);
+         }
+
+         /* Awaiter of one request, it lives in the awaiting coroutine's frame */
+         class operation
+         {
+         public:
+
+            operation(async_codec& owner, const bool encode, T* codewords, const std::size_t count, const batch_options& options)
+            : owner_(owner),
+              encode_(encode),
+              codewords_(codewords),
+              count_(count),
+              options_(options),
+              succeeded_(0)
+            {}
+
+            inline bool await_ready() const noexcept
+            {
+               return (0 == count_);
+            }
+
+            inline void await_suspend(const std::coroutine_handle<> handle)
+            {
+               handle_ = handle;
+               owner_.dispatch(this);
+            }
+
+            inline std::size_t await_resume() const noexcept
+            {
+               return succeeded_.load(std::memory_order_acquire);
+            }
+
+         private:
+
+            friend class async_codec;
+
+            async_codec&               owner_;
+            const bool                 encode_;
+            T*                         codewords_;
+            const std::size_t          count_;
+            const batch_options        options_;
+            std::atomic<std::size_t>   succeeded_;
+            std::coroutine_handle<>    handle_;
+         };
+
+      private:
+
+         async_codec(const async_codec&);
+         async_codec& operator=(const async_codec&);
+
+         struct group
+         {
+            std::vector<operation*>  requests;
+            std::vector<std::size_t> offsets;   /* first codeword of each request, then the total */
+         };
+
+         inline bool coalesced(const operation* op) const
+         {
+            return (op->count_ < coalesce_below_)                                      &&
+                   !op->options_.control                                               &&
+                   (batch_options::clock_type::time_point::max() == op->options_.deadline);
+         }
+
+         void dispatch(operation* op)
+         {
+            const bool small = coalesced(op);
+
+            if (small)
+            {
+               const std::size_t p = op->options_.priority;
+
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               if (in_flight_[p])
+               {
+                  pending_[p].push_back(op);
+                  return;
+               }
+
+               in_flight_[p] = true;
+            }
+
+            std::unique_ptr<group> g(new group);
+
+            g->requests.push_back(op);
+
+            submit(std::move(g), op->options_, small);
+         }
+
+         void submit(std::unique_ptr<group> g, const batch_options& request_options, const bool coalesced)
+         {
+            g->offsets.push_back(0);
+
+            for (std::size_t i = 0; i < g->requests.size(); ++i)
+            {
+               g->offsets.push_back(g->offsets.back() + g->requests[i]->count_);
+            }
+
+            std::shared_ptr<group> shared(g.release());
+
+            batch_options options(request_options);
+
+            const priority_t priority = request_options.priority;
+
+            options.completion = [this, shared, coalesced, priority](const std::size_t)
+                                 {
+                                    complete(*shared, coalesced, priority);
+                                 };
+
+            batches_ .fetch_add(1, std::memory_order_relaxed);
+            requests_.fetch_add(shared->requests.size(), std::memory_order_relaxed);
+
+            executor_.submit_range(shared->offsets.back(),
+                                   [shared](const context& ctx, const std::size_t begin, const std::size_t end)
+                                   {
+                                      const group& g = *shared;
+
+                                      std::size_t r = std::upper_bound(g.offsets.begin(), g.offsets.end(), begin) - g.offsets.begin() - 1;
+
+                                      for (std::size_t b = begin; b < end; ++r)
+                                      {
+                                         const std::size_t last = std::min(end, g.offsets[r + 1]);
+
+                                         operation& op = *g.requests[r];
+
+                                         std::size_t succeeded = 0;
+
+                                         for ( ; b < last; ++b)
+                                         {
+                                            T* codeword = op.codewords_ + (b - g.offsets[r]) * code_length;
+
+                                            const bool result = op.encode_ ?
+                                                                ctx.encoder.encode(utils::span<const T>(codeword, data_length),
+                                                                                   utils::span<T>(codeword + data_length, fec_length)) :
+                                                                ctx.decoder.decode(utils::span<T>(codeword, code_length));
+
+                                            if (result)
+                                               ++succeeded;
+                                         }
+
+                                         op.succeeded_.fetch_add(succeeded, std::memory_order_relaxed);
+                                      }
+
+                                      return 0;
+                                   },
+                                   options);
+         }
+
+         void complete(const group& g, const bool coalesced, const priority_t priority)
+         {
+            /* Note: The next batch of small requests leaves before these resume, which may take a while */
+            if (coalesced)
+            {
+               std::unique_ptr<group> next;
+
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  if (pending_[priority].empty())
+                     in_flight_[priority] = false;
+                  else
+                  {
+                     next.reset(new group);
+                     next->requests.swap(pending_[priority]);
+                  }
+               }
+
+               if (next)
+                  submit(std::move(next), batch_options(priority), true);
+            }
+
+            for (std::size_t i = 0; i < g.requests.size(); ++i)
+            {
+               const std::coroutine_handle<> handle = g.requests[i]->handle_;
+
+               std::atomic_thread_fence(std::memory_order_release);
+
+               if (resume_)
+                  resume_(handle);
+               else
+                  handle.resume();
+            }
+         }
+
+         executor_type&           executor_;
+         const std::size_t        coalesce_below_;
+         const resume_type        resume_;
+         std::mutex               mutex_;
+         bool                     in_flight_[e_priority_count];
+         std::vector<operation*>  pending_  [e_priority_count];
+         std::atomic<std::size_t> batches_ {0};
+         std::atomic<std::size_t> requests_{0};
+      };
+
+      /*
+         Awaiter running a whole file through a parallel file pipeline
+         (Pipeline being eg: parallel_file_encoder<255,223>), resuming the
+         awaiting coroutine with its success() once done. The pipeline
+         brings its own reader, worker and writer threads, which a
+         coroutine cannot stand in for, so it runs from a thread of its
+         own while the awaiter is suspended.
+         Note: GCC 12 may end the life of an awaiter temporary within an
+         if condition early, await into a local before testing it.
+      */
+      template <typename Pipeline, typename Codec>
+      class async_file_operation
+      {
+      public:
+
+         typedef std::function<void(std::coroutine_handle<>)> resume_type;
+
+         async_file_operation(const Codec&       codec,
+                              const std::string& input_file_name,
+                              const std::string& output_file_name,
+                              const std::size_t  threads,
+                              const std::size_t  buffer_size,
+                              const resume_type& resume)
+         : codec_(codec),
+           input_file_name_(input_file_name),
+           output_file_name_(output_file_name),
+           threads_(threads),
+           buffer_size_(buffer_size),
+           resume_(resume),
+           success_(false)
+         {}
+
+         inline bool await_ready() const noexcept
+         {
+            return false;
+         }
+
+         void await_suspend(const std::coroutine_handle<> handle)
+         {
+            std::thread([this, handle]()
+                        {
+                           const Pipeline pipeline(codec_, input_file_name_, output_file_name_, threads_, buffer_size_);
+
+                           success_ = pipeline.success();
+
+                           /* Note: Copied, resuming may free this awaiter */
+                           const resume_type resume = resume_;
+
+                           if (resume)
+                              resume(handle);
+                           else
+                              handle.resume();
+                        }).detach();
+         }
+
+         inline bool await_resume() const noexcept
+         {
+            return success_;
+         }
+
+      private:
+
+         const Codec&      codec_;
+         const std::string input_file_name_;
+         const std::string output_file_name_;
+         const std::size_t threads_;
+         const std::size_t buffer_size_;
+         const resume_type resume_;
+         bool              success_;
+      };
+
+      template <std::size_t code_length, std::size_t fec_length, typename Encoder>
+      inline async_file_operation<parallel_file_encoder<code_length,fec_length>, Encoder>
+      async_encode_file(const Encoder&     encoder,
+                        const std::string& input_file_name,
+                        const std::string& output_file_name,
+                        const std::size_t  threads     = 0,
+                        const std::size_t  buffer_size = 0,
+                        const std::function<void(std::coroutine_handle<>)>& resume = std::function<void(std::coroutine_handle<>)>())
+      {
+         return async_file_operation<parallel_file_encoder<code_length,fec_length>, Encoder>(encoder, input_file_name, output_file_name, threads, buffer_size, resume);
+      }
+
+      template <std::size_t code_length, std::size_t fec_length, typename Decoder>
+      inline async_file_operation<parallel_file_decoder<code_length,fec_length>, Decoder>
+      async_decode_file(const Decoder&     decoder,
+                        const std::string& input_file_name,
+                        const std::string& output_file_name,
+                        const std::size_t  threads     = 0,
+                        const std::size_t  buffer_size = 0,
+                        const std::function<void(std::coroutine_handle<>)>& resume = std::function<void(std::coroutine_handle<>)>())
+      {
+         return async_file_operation<parallel_file_decoder<code_length,fec_length>, Decoder>(decoder, input_file_name, output_file_name, threads, buffer_size, resume);
+      }
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
+
+#endif
+
+#endif
@@ -24,11 +24,27 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_DECODER_HPP
 
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 #include "schifra/core/galois_field/field.hpp"
 #include "schifra/core/galois_field/element.hpp"
+#include "schifra/core/galois_field/fixed_polynomial.hpp"
 #include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/polynomial_kernels.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder_tables.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_instantiations.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_instrumentation.hpp"
+#include "schifra/utils/schifra_aligned_allocator.hpp"
 #include "schifra/utils/schifra_ecc_traits.hpp"
+#include "schifra/utils/schifra_object_pool.hpp"
+#include "schifra/utils/schifra_span.hpp"
 
 
 namespace schifra
@@ -36,19 +52,83 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      /*
+         Scratch storage of decoder::decode(), preallocated so that decoding
+         performs no heap allocation. A workspace may be reused across any
+         number of decodes, but must not be shared between threads. The
+         overloads taking no workspace use one thread_local instance.
+      */
+      template <std::size_t fec_length>
+      struct decoder_workspace
+      {
+         decoder_workspace()
+         {
+            error_locations  .reserve(fec_length << 1);
+            erasure_locations.reserve(fec_length);
+            parity_locations .reserve(fec_length);
+         }
+
+         std::vector<int>    error_locations;
+         erasure_locations_t erasure_locations;
+         std::vector<int>    parity_locations;
+      };
+
+      /*
+         Key equation solvers, the key_equation_solver parameter of decoder:
+
+            berlekamp_massey_solver : modified_berlekamp_massey_algorithm()
+            euclidean_solver        : euclidean_algorithm()
+
+         Both give the same error locator while the block is within
+         capacity, 2 x errors + erasures <= fec_length. Past it they may
+         give different locators, or one may fail where the other does not,
+         so uncorrectable blocks need not be reported alike. The Euclidean
+         solver runs a fixed cross multiplication step with no inversion,
+         which suits lockstep and hardware style implementations; the BMA
+         does less work per codeword. decode_batch() solves through lockstep_berlekamp_massey()
+         whatever the solver.
+      */
+      struct berlekamp_massey_solver {};
+      struct euclidean_solver {};
+
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol,
+                typename key_equation_solver = berlekamp_massey_solver>
       class decoder
       {
       public:
 
          typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
-         typedef block<code_length,fec_length> block_type;
+         typedef block<code_length,fec_length,code_length - fec_length,symbol_t> block_type;
+         typedef decoder_workspace<fec_length> workspace_type;
+
+         /*
+            Note: The working polynomials of decode() have fixed capacity, the
+                  error locator and its shifted predecessor in the BMA never
+                  grow past fec_length + 2 terms.
+         */
+         typedef galois::fixed_polynomial<code_length>    received_polynomial;
+         typedef galois::fixed_polynomial<fec_length>     syndrome_polynomial;
+         typedef galois::fixed_polynomial<fec_length + 2> locator_polynomial;
+
+         /* Largest fec_length whose error locator may be solved in closed form */
+         static constexpr std::size_t closed_form_max_fec = 4;
+
+         /* Number of dirty codewords decode_batch() runs through the BMA in lockstep */
+         static constexpr std::size_t bm_lockstep_lanes = 16;
+
+         /* Number of codewords whose syndromes batch_syndrome() evaluates per pass */
+         static constexpr std::size_t batch_syndrome_lanes = 256;
 
          decoder(const galois::field& field, const unsigned int& gen_initial_index = 0)
-         : decoder_valid_(field.size() == code_length),
+         : decoder_valid_((field.size() == code_length) &&
+                          (static_cast<unsigned long long>(std::numeric_limits<symbol_t>::max()) >= field.size())),
            field_(field),
-           X_(galois::generate_X(field_)),
-           gen_initial_index_(gen_initial_index)
+           root_exponent_table_(0),
+           syndrome_exponent_table_(0),
+           syndrome_multiplier_(0),
+           gen_initial_index_(gen_initial_index),
+           verify_corrections_(false)
          {
             if (decoder_valid_)
             {
@@ -62,6 +142,31 @@ namespace schifra
             return field_;
          }
 
+         inline unsigned int gen_initial_index() const
+         {
+            return gen_initial_index_;
+         }
+
+         /*
+            When enabled, the corrections of a decode are checked against
+            the syndromes they were derived from: the syndromes are updated
+            by the contribution of the corrected symbols alone, O(E.fec_length),
+            and must come out zero. A block failing the check is restored to
+            the symbols it was read with and reported unrecoverable, as
+            e_decoder_error5, so that an outer code can take it as an erasure
+            rather than pass a wrong correction on. Disabled by default; not
+            to be changed while other threads decode with this instance.
+         */
+         inline void verify_corrections(const bool enabled)
+         {
+            verify_corrections_ = enabled;
+         }
+
+         inline bool verify_corrections() const
+         {
+            return verify_corrections_;
+         }
+
          bool decode(block_type& rsblock) const
          {
             std::vector<std::size_t> erasure_list;
@@ -70,53 +175,853 @@ namespace schifra
 
          bool decode(block_type& rsblock, const erasure_locations_t& erasure_list) const
          {
-            if ((!decoder_valid_) || (erasure_list.size() > fec_length))
+            return decode_codeword(rsblock, erasure_list, thread_workspace());
+         }
+
+         bool decode(block_type& rsblock, workspace_type& workspace) const
+         {
+            const erasure_locations_t erasure_list;
+            return decode_codeword(rsblock, erasure_list, workspace);
+         }
+
+         bool decode(block_type& rsblock, const erasure_locations_t& erasure_list, workspace_type& workspace) const
+         {
+            return decode_codeword(rsblock, erasure_list, workspace);
+         }
+
+         /*
+            Erasures given as a bit mask over the block, no erasure list
+            needs to be built or walked on the heap.
+         */
+         bool decode(block_type& rsblock, const erasure_mask<code_length>& erasures) const
+         {
+            return decode_codeword(rsblock, erasures, thread_workspace());
+         }
+
+         bool decode(block_type& rsblock, const erasure_mask<code_length>& erasures, workspace_type& workspace) const
+         {
+            return decode_codeword(rsblock, erasures, workspace);
+         }
+
+         /*
+            Erasures only decode: the caller asserts that every symbol in
+            error is one of the erasures, eg: a column of an outer code or
+            a codeword across the rows of an erasure_channel stack. The
+            locator is built from the known positions and Forney runs on
+            them directly, without the key equation solver or the Chien
+            search, and the corrections are always checked against every
+            syndrome. A block with an error outside the erasures fails the
+            check and is returned as read, unrecoverable with
+            e_decoder_error5, for decode() to take over if need be.
+         */
+         bool decode_erasures(block_type& rsblock, const erasure_locations_t& erasure_list) const
+         {
+            return decode_codeword(rsblock, erasure_list, thread_workspace(), code_length, e_erasures_only);
+         }
+
+         bool decode_erasures(block_type& rsblock, const erasure_mask<code_length>& erasures) const
+         {
+            return decode_codeword(rsblock, erasures, thread_workspace(), code_length, e_erasures_only);
+         }
+
+         template <typename T>
+         inline bool decode_erasures(const utils::span<T>& codeword, const erasure_locations_t& erasure_list) const
+         {
+            if ((codeword.size() > code_length) || (codeword.size() <= fec_length))
+               return false;
+
+            codeword_view<T> view(codeword.data());
+
+            return decode_codeword(view, erasure_list, thread_workspace(), codeword.size(), e_erasures_only);
+         }
+
+         /*
+            Data only decode: rsblock is left as read and its data symbols,
+            corrected, are written to data, which holds data_length of them.
+            The Chien search covers the data positions, going on to the
+            parity positions only while the locator has roots left, and
+            Forney is evaluated at the data positions alone. Roots in the
+            parity still count towards the locator degree check, and with
+            verify_corrections() their values are computed for the syndrome
+            check, though never written anywhere.
+         */
+         template <typename T>
+         inline bool decode_data(const block_type& rsblock, const utils::span<T>& data) const
+         {
+            const erasure_locations_t erasure_list;
+            return decode_data(rsblock, data, erasure_list);
+         }
+
+         template <typename T>
+         inline bool decode_data(const block_type& rsblock, const utils::span<T>& data,
+                                 const erasure_locations_t& erasure_list) const
+         {
+            if (data.size() != data_length)
+               return false;
+
+            T parity[fec_length];
+
+            for (std::size_t i = 0; i < data_length; ++i)
+            {
+               data[i] = static_cast<T>(rsblock[i]);
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               parity[i] = static_cast<T>(rsblock[data_length + i]);
+            }
+
+            split_codeword_view<T> view(data.data(), parity);
+
+            return decode_codeword(view, erasure_list, thread_workspace(), code_length, e_data_only);
+         }
+
+         /*
+            Decode a caller owned codeword in place, eg: a code_length run
+            of symbols inside an mmap'd file. The symbols are laid out as in
+            block_type::data, and corrections are written straight back
+            into the span. A span shorter than code_length (but longer than
+            fec_length) is decoded as a shortened codeword. Returns false
+            when the span length is out of range or the codeword is
+            unrecoverable.
+         */
+         template <typename T>
+         inline bool decode(const utils::span<T>& codeword) const
+         {
+            const erasure_locations_t erasure_list;
+            return decode(codeword, erasure_list);
+         }
+
+         template <typename T>
+         inline bool decode(const utils::span<T>& codeword, const erasure_locations_t& erasure_list) const
+         {
+            if ((codeword.size() > code_length) || (codeword.size() <= fec_length))
+               return false;
+
+            codeword_view<T> view(codeword.data());
+
+            return decode_codeword(view, erasure_list, thread_workspace(), codeword.size());
+         }
+
+         /*
+            Decode a punctured codeword in place: its data symbols (fewer
+            than data_length for a shortened code) followed by the
+            puncture.kept_count() parity symbols puncture keeps. The
+            punctured symbols are decoded as erasures.
+         */
+         template <typename T>
+         inline bool decode(const utils::span<T>& codeword, const puncture_mask& puncture) const
+         {
+            if ((puncture.fec_length() != fec_length) || (codeword.size() <= puncture.kept_count()))
+               return false;
+
+            const std::size_t data_size = codeword.size() - puncture.kept_count();
+
+            if (data_size > (code_length - fec_length))
+               return false;
+
+            T full[code_length];
+
+            std::copy(codeword.data(), codeword.data() + data_size, full);
+            puncture.expand(codeword.data() + data_size, full + data_size);
+
+            static thread_local erasure_locations_t erasure_list;
+
+            erasure_list.clear();
+            puncture.erasures(data_size, erasure_list);
+
+            if (!decode(utils::span<T>(full, data_size + fec_length), erasure_list))
+               return false;
+
+            std::copy(full, full + data_size, codeword.data());
+            puncture.compress(full + data_size, codeword.data() + data_size);
+
+            return true;
+         }
+
+         /*
+            Decode a block whose punctured parity symbols were not stored,
+            their positions in the block being erasures whatever they hold.
+         */
+         bool decode(block_type& rsblock, const puncture_mask& puncture) const
+         {
+            if (puncture.fec_length() != fec_length)
+            {
+               rsblock.error = block_type::e_decoder_error0;
+               rsblock.unrecoverable = true;
+               return false;
+            }
+
+            erasure_mask<code_length> erasures;
+
+            puncture.erasures(code_length - fec_length, erasures);
+
+            return decode_codeword(rsblock, erasures, thread_workspace());
+         }
+
+         /*
+            Syndrome check of count blocks at once. Bit (b % 64) of
+            dirty[b / 64] is set when block b has a non-zero syndrome, ie:
+            when it needs the full decoder, and the number of such blocks is
+            returned. The syndromes are evaluated by scan_syndromes().
+         */
+         std::size_t batch_syndrome(const block_type* blocks, const std::size_t count, std::vector<std::uint64_t>& dirty) const
+         {
+            dirty.assign((count + 63) / 64, 0);
+
+            std::size_t dirty_count = 0;
+
+            scan_syndromes(blocks, count,
+                           [&](const std::size_t b, const galois::field_symbol* syndrome)
+                           {
+                              if (0 != syndrome)
+                              {
+                                 dirty[b / 64] |= static_cast<std::uint64_t>(1) << (b % 64);
+                                 ++dirty_count;
+                              }
+                           });
+
+            return dirty_count;
+         }
+
+         /*
+            Syndrome check of one block, nothing corrected: true when its
+            syndromes are all zero, ie: it is a codeword, which decode()
+            would leave as it is.
+         */
+         bool verify(const block_type& rsblock) const
+         {
+            bool clean = false;
+
+            scan_syndromes(&rsblock, 1,
+                           [&](const std::size_t, const galois::field_symbol* syndrome)
+                           {
+                              clean = (0 == syndrome);
+                           });
+
+            return clean;
+         }
+
+         /*
+            batch_syndrome() of count codewords of code_length symbols laid
+            out back to back, as taken by the dense decode_batch(), eg: the
+            codewords of a file read straight into a buffer of bytes.
+         */
+         template <typename T>
+         std::size_t verify_batch(const T* codewords, const std::size_t count, std::vector<std::uint64_t>& dirty) const
+         {
+            dirty.assign((count + 63) / 64, 0);
+
+            std::size_t dirty_count = 0;
+
+            scan_codeword_syndromes([codewords](const std::size_t b) { return codewords + (b * code_length); }, count,
+                                    [&](const std::size_t b, const galois::field_symbol* syndrome)
+                                    {
+                                       if (0 != syndrome)
+                                       {
+                                          dirty[b / 64] |= static_cast<std::uint64_t>(1) << (b % 64);
+                                          ++dirty_count;
+                                       }
+                                    });
+
+            return dirty_count;
+         }
+
+         /*
+            Decode count blocks. Blocks that batch_syndrome() finds clean
+            are only marked as such, only the dirty ones go through the
+            Berlekamp-Massey, Chien search and Forney steps of decode().
+            The syndromes of the batch pass are reused, and the
+            Berlekamp-Massey step runs on bm_lockstep_lanes dirty blocks at
+            a time, see lockstep_berlekamp_massey(). Returns the number of
+            blocks decoded successfully.
+         */
+         std::size_t decode_batch(block_type* blocks, const std::size_t count) const
+         {
+            std::size_t decoded = 0;
+
+            if (!decoder_valid_)
+            {
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  if (decode(blocks[b]))
+                     ++decoded;
+               }
+
+               return decoded;
+            }
+
+            workspace_type& workspace = thread_workspace();
+
+            std::size_t          group     [bm_lockstep_lanes];
+            galois::field_symbol syndromes [bm_lockstep_lanes][fec_length];
+            std::size_t          group_size = 0;
+
+            const auto correct = [&](const std::size_t b, const locator_polynomial& lambda, const syndrome_polynomial& syndrome)
+                                 {
+                                    return correct_errors(blocks[b], lambda, syndrome, 0, workspace);
+                                 };
+
+            scan_syndromes(blocks, count,
+                           [&](const std::size_t b, const galois::field_symbol* syndrome)
+                           {
+                              if (0 == syndrome)
+                              {
+                                 blocks[b].errors_detected  = 0;
+                                 blocks[b].errors_corrected = 0;
+                                 blocks[b].zero_numerators  = 0;
+                                 blocks[b].unrecoverable    = false;
+
+                                 instrumentation::record_clean();
+
+                                 ++decoded;
+
+                                 return;
+                              }
+
+                              group[group_size] = b;
+                              std::copy(syndrome, syndrome + fec_length, syndromes[group_size]);
+
+                              if (bm_lockstep_lanes == ++group_size)
+                              {
+                                 decoded += decode_group(group, syndromes, group_size, correct);
+                                 group_size = 0;
+                              }
+                           });
+
+            if (group_size > 0)
+            {
+               decoded += decode_group(group, syndromes, group_size, correct);
+            }
+
+            return decoded;
+         }
+
+         /*
+            As decode_batch(), over count codewords of code_length symbols
+            laid out back to back from codewords, data then parity, with no
+            per block metadata in between. Corrections are written in place
+            and the outcome of codeword b goes to status.error[b] and
+            status.corrected[b], so a clean codeword costs one status byte.
+         */
+         template <typename T>
+         std::size_t decode_batch(T* codewords, const std::size_t count, batch_status& status) const
+         {
+            status.reset(count);
+
+            std::size_t decoded = 0;
+
+            workspace_type& workspace = thread_workspace();
+
+            const auto record = [&](const std::size_t b, const codeword_view<T>& view, const bool ok)
+                                {
+                                   status.error    [b] = static_cast<std::uint8_t>(ok ? block_type::e_no_error : view.error);
+                                   status.corrected[b] = static_cast<std::uint16_t>(ok ? view.errors_corrected : 0);
+                                   return ok;
+                                };
+
+            if (!decoder_valid_)
+            {
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  codeword_view<T> view(codewords + (b * code_length));
+
+                  if (record(b, view, decode_codeword(view, erasure_locations_t(), workspace)))
+                     ++decoded;
+               }
+
+               return decoded;
+            }
+
+            std::size_t          group     [bm_lockstep_lanes];
+            galois::field_symbol syndromes [bm_lockstep_lanes][fec_length];
+            std::size_t          group_size = 0;
+
+            const auto correct = [&](const std::size_t b, const locator_polynomial& lambda, const syndrome_polynomial& syndrome)
+                                 {
+                                    codeword_view<T> view(codewords + (b * code_length));
+
+                                    return record(b, view, correct_errors(view, lambda, syndrome, 0, workspace));
+                                 };
+
+            scan_codeword_syndromes([codewords](const std::size_t b) { return static_cast<const T*>(codewords + (b * code_length)); }, count,
+                                    [&](const std::size_t b, const galois::field_symbol* syndrome)
+                                    {
+                                       if (0 == syndrome)
+                                       {
+                                          instrumentation::record_clean();
+
+                                          ++decoded;
+
+                                          return;
+                                       }
+
+                                       group[group_size] = b;
+                                       std::copy(syndrome, syndrome + fec_length, syndromes[group_size]);
+
+                                       if (bm_lockstep_lanes == ++group_size)
+                                       {
+                                          decoded += decode_group(group, syndromes, group_size, correct);
+                                          group_size = 0;
+                                       }
+                                    });
+
+            if (group_size > 0)
+            {
+               decoded += decode_group(group, syndromes, group_size, correct);
+            }
+
+            return decoded;
+         }
+
+         /*
+            Native decoding of a block of a code shortened from this one.
+            The virtual zero prefix adds nothing to the syndromes, and the
+            Chien search only visits the positions the short block holds.
+            Erasure positions are relative to the short block, given as an
+            erasure_locations_t or an erasure_mask<short_code_length>.
+         */
+         template <std::size_t short_code_length, std::size_t short_data_length, typename T, typename Erasures>
+         inline bool decode_shortened(block<short_code_length,fec_length,short_data_length,T>& rsblock,
+                                      const Erasures& erasure_list) const
+         {
+            static_assert((short_code_length <= code_length) && (short_code_length > fec_length),
+                          "decode_shortened() - block must be shorter than the natural code");
+
+            return decode_codeword(rsblock, erasure_list, thread_workspace(), short_code_length);
+         }
+
+         /*
+            Touch the field's and the decoder's tables from the calling
+            thread, optionally locking them in RAM, then decode warm_up_blocks
+            codewords, every other one with an error, through decode() and
+            decode_batch(). The first real codeword then takes no page fault
+            or cold miss, and the thread's workspace is already pooled.
+            false when a lock was refused.
+
+            Note: With SCHIFRA_DECODER_INSTRUMENTATION the warm up blocks
+                  are counted like any other.
+         */
+         bool warm_up(const bool lock = false) const
+         {
+            bool locked = field_.warm_up(lock);
+
+            if (tables_)
+               locked = tables_->warm_up(lock) && locked;
+
+            if (!decoder_valid_)
+               return locked;
+
+            std::vector<block_type> blocks(warm_up_blocks);
+
+            for (std::size_t b = 0; b < blocks.size(); ++b)
+            {
+               blocks[b].reset(0);
+
+               if ((fec_length >= 2) && (b & 1))
+                  blocks[b].data[b % code_length] = 1;
+            }
+
+            decode(blocks[1]);
+            decode_batch(&blocks[0], blocks.size());
+
+            return locked;
+         }
+
+      private:
+
+         static constexpr std::size_t warm_up_blocks = 2 * bm_lockstep_lanes;
+
+         decoder();
+         decoder(const decoder& dec);
+         decoder& operator=(const decoder& dec);
+
+      protected:
+
+         /*
+            The decoder only needs symbol access and the status members of
+            a block, this carries them for a codeword held in a span.
+         */
+         template <typename T>
+         struct codeword_view
+         {
+            typedef T symbol_type;
+            typedef typename block_type::error_t error_t;
+
+            static constexpr error_t e_no_error       = block_type::e_no_error;
+            static constexpr error_t e_decoder_error0 = block_type::e_decoder_error0;
+            static constexpr error_t e_decoder_error1 = block_type::e_decoder_error1;
+            static constexpr error_t e_decoder_error2 = block_type::e_decoder_error2;
+            static constexpr error_t e_decoder_error3 = block_type::e_decoder_error3;
+            static constexpr error_t e_decoder_error4 = block_type::e_decoder_error4;
+            static constexpr error_t e_decoder_error5 = block_type::e_decoder_error5;
+
+            explicit codeword_view(T* symbols)
+            : data(symbols),
+              errors_detected (0),
+              errors_corrected(0),
+              zero_numerators (0),
+              unrecoverable(false),
+              error(e_no_error)
+            {}
+
+            inline T& operator[](const std::size_t& index) const
+            {
+               return data[index];
+            }
+
+            T*                            data;
+            std::size_t                   errors_detected;
+            std::size_t                   errors_corrected;
+            std::size_t                   zero_numerators;
+            bool                          unrecoverable;
+            error_t                       error;
+         };
+
+         /* A codeword_view whose parity symbols are held apart, see decode_data() */
+         template <typename T>
+         struct split_codeword_view : public codeword_view<T>
+         {
+            split_codeword_view(T* data_symbols, T* parity_symbols)
+            : codeword_view<T>(data_symbols),
+              parity(parity_symbols)
+            {}
+
+            inline T& operator[](const std::size_t& index) const
+            {
+               return (index < data_length) ? this->data[index] : parity[index - data_length];
+            }
+
+            T* parity;
+         };
+
+         enum correction_mode
+         {
+            e_full_correction = 0,
+            e_erasures_only   = 1,
+            e_data_only       = 2
+         };
+
+         static inline workspace_type& thread_workspace()
+         {
+            static thread_local workspace_type workspace;
+            return workspace;
+         }
+
+         /*
+            Note: length is the number of symbols rsblock holds, a shorter
+                  codeword being one of the shortened code whose first
+                  code_length - length symbols are virtual zeros. For the
+                  other modes, see decode_erasures() and decode_data().
+         */
+         template <typename Codeword, typename Erasures>
+         bool decode_codeword(Codeword& rsblock,
+                              const Erasures& erasure_list,
+                              workspace_type& workspace,
+                              const std::size_t length = code_length,
+                              const correction_mode mode = e_full_correction) const
+         {
+            const std::size_t erasure_count = erasure_list.size();
+
+            if ((!decoder_valid_) || (erasure_count > fec_length))
             {
                rsblock.errors_detected  = 0;
                rsblock.errors_corrected = 0;
                rsblock.zero_numerators  = 0;
                rsblock.unrecoverable    = true;
-               rsblock.error            = block_type::e_decoder_error0;
+               rsblock.error            = Codeword::e_decoder_error0;
+
+               instrumentation::record_unrecoverable(rsblock.error);
 
                return false;
             }
 
-            galois::field_polynomial received(field_,code_length - 1);
-            load_message(received,rsblock);
+            received_polynomial received(field_);
+            syndrome_polynomial syndrome(field_);
 
-            galois::field_polynomial syndrome(field_);
+            bool clean = false;
 
-            if (compute_syndrome(received,syndrome) == 0)
+            {
+               instrumentation::stage_timer timer(instrumentation::e_syndrome);
+
+               load_message(received,rsblock,length);
+
+               clean = (compute_syndrome(received,syndrome) == 0);
+            }
+
+            if (clean)
             {
                rsblock.errors_detected  = 0;
                rsblock.errors_corrected = 0;
                rsblock.zero_numerators  = 0;
                rsblock.unrecoverable    = false;
 
+               instrumentation::record_clean();
+
                return true;
             }
 
-            galois::field_polynomial lambda(galois::field_element(field_,1));
+            locator_polynomial lambda(field_, galois::field_symbol(1));
 
-            erasure_locations_t erasure_locations;
+            erasure_locations_t& erasure_locations = workspace.erasure_locations;
 
-            if (!erasure_list.empty())
+            if (0 != erasure_count)
             {
-               prepare_erasure_list(erasure_locations, erasure_list);
+               prepare_erasure_list(erasure_locations, erasure_list, length);
 
                compute_gamma(lambda, erasure_locations);
             }
 
-            if (erasure_list.size() < fec_length)
+            if (e_erasures_only == mode)
+               return correct_erasures(rsblock, lambda, syndrome, erasure_count, workspace, length);
+
+            if (erasure_count < fec_length)
+            {
+               instrumentation::stage_timer timer(instrumentation::e_berlekamp_massey);
+
+               bool solved = false;
+
+               if constexpr (fec_length <= closed_form_max_fec)
+               {
+                  solved = (0 == erasure_count) && closed_form_locator(syndrome, lambda);
+               }
+
+               if (!solved)
+               {
+                  if constexpr (std::is_same<key_equation_solver, euclidean_solver>::value)
+                     euclidean_algorithm(lambda, syndrome, erasure_count);
+                  else
+                     modified_berlekamp_massey_algorithm(lambda, syndrome, erasure_count);
+               }
+            }
+
+            return correct_errors(rsblock, lambda, syndrome, erasure_count, workspace, length, e_data_only == mode);
+         }
+
+         /*
+            Calls visit(b, syndrome) for every block, syndrome being the
+            fec_length syndromes of block b, or null when they are all zero.
+
+            For fields of up to 2^8 elements the blocks are transposed into
+            a planar byte layout, batch_syndrome_lanes codewords per pass,
+            and every Horner step S = S * alpha^(gii + j) ^ r(i) is applied
+            to all of them through the galois::region kernels.
+         */
+         template <typename Visitor>
+         void scan_syndromes(const block_type* blocks, const std::size_t count, Visitor visit) const
+         {
+            scan_codeword_syndromes([blocks](const std::size_t b) -> const block_type& { return blocks[b]; }, count, visit);
+         }
+
+         /* As scan_syndromes(), codeword(b) giving the symbols of codeword b */
+         template <typename Codewords, typename Visitor>
+         void scan_codeword_syndromes(const Codewords& codeword, const std::size_t count, Visitor visit) const
+         {
+            if (!decoder_valid_ || (0 == syndrome_multiplier_))
+            {
+               received_polynomial received(field_);
+               syndrome_polynomial syndrome(field_);
+
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  if (!decoder_valid_)
+                  {
+                     syndrome.clear();
+                     syndrome.resize(fec_length);
+                     visit(b, syndrome.data());
+                     continue;
+                  }
+
+                  bool clean = false;
+
+                  {
+                     instrumentation::stage_timer timer(instrumentation::e_syndrome);
+
+                     load_message(received, codeword(b));
+
+                     clean = (0 == compute_syndrome(received, syndrome));
+                  }
+
+                  visit(b, clean ? static_cast<const galois::field_symbol*>(0) : syndrome.data());
+               }
+
+               return;
+            }
+
+            const std::size_t          max_lanes = std::min(batch_syndrome_lanes, count);
+            const galois::field_symbol mask      = field_.mask();
+
+            typename utils::object_pool<std::uint8_t>::array planar   = utils::object_pool<std::uint8_t>::acquire(code_length * max_lanes);
+            typename utils::object_pool<std::uint8_t>::array syndrome = utils::object_pool<std::uint8_t>::acquire(fec_length  * max_lanes);
+
+            for (std::size_t b = 0; b < count; b += max_lanes)
+            {
+               const std::size_t lanes = std::min(max_lanes, count - b);
+
+               {
+                  instrumentation::stage_timer timer(instrumentation::e_syndrome, lanes);
+
+                  for (std::size_t l = 0; l < lanes; ++l)
+                  {
+                     const auto& symbols = codeword(b + l);
+
+                     for (std::size_t i = 0; i < code_length; ++i)
+                     {
+                        planar[i * lanes + l] = static_cast<std::uint8_t>(symbols[i] & mask);
+                     }
+                  }
+
+                  for (std::size_t j = 0; j < fec_length; ++j)
+                  {
+                     std::copy(&planar[0], &planar[0] + lanes, &syndrome[j * lanes]);
+                  }
+
+                  for (std::size_t i = 1; i < code_length; ++i)
+                  {
+                     const std::uint8_t* r = &planar[i * lanes];
+
+                     for (std::size_t j = 0; j < fec_length; ++j)
+                     {
+                        std::uint8_t* s = &syndrome[j * lanes];
+
+                        /*
+                           Note: s ^= (c ^ 1) * s, run in place, is s = c * s.
+                        */
+                        galois::region::mul_add(syndrome_multiplier_[j], s, s, lanes);
+
+                        std::size_t l = 0;
+
+                        for (; (l + sizeof(std::uint64_t)) <= lanes; l += sizeof(std::uint64_t))
+                        {
+                           std::uint64_t sw;
+                           std::uint64_t rw;
+                           std::memcpy(&sw, s + l, sizeof(sw));
+                           std::memcpy(&rw, r + l, sizeof(rw));
+                           sw ^= rw;
+                           std::memcpy(s + l, &sw, sizeof(sw));
+                        }
+
+                        for (; l < lanes; ++l)
+                        {
+                           s[l] ^= r[l];
+                        }
+                     }
+                  }
+               }
+
+               galois::field_symbol lane_syndrome[fec_length];
+
+               for (std::size_t l = 0; l < lanes; ++l)
+               {
+                  std::uint8_t any = 0;
+
+                  for (std::size_t j = 0; j < fec_length; ++j)
+                  {
+                     lane_syndrome[j] = syndrome[j * lanes + l];
+                     any |= syndrome[j * lanes + l];
+                  }
+
+                  visit(b + l, (0 != any) ? static_cast<const galois::field_symbol*>(lane_syndrome) : 0);
+               }
+            }
+         }
+
+         /*
+            Lockstep BMA of a group of dirty codewords, then
+            correct(b, lambda, syndrome) for each, which runs the Chien
+            search and Forney steps on codeword b.
+         */
+         template <typename Correct>
+         std::size_t decode_group(const std::size_t* group,
+                                  const galois::field_symbol (*syndromes)[fec_length],
+                                  const std::size_t group_size,
+                                  const Correct& correct) const
+         {
+            galois::field_symbol locators[bm_lockstep_lanes][fec_length + 2];
+
+            syndrome_polynomial syndrome(field_);
+            locator_polynomial  lambda  (field_);
+
+            {
+               instrumentation::stage_timer timer(instrumentation::e_berlekamp_massey, group_size);
+
+               lockstep_berlekamp_massey<bm_lockstep_lanes>(syndromes, locators, group_size);
+            }
+
+            std::size_t decoded = 0;
+
+            for (std::size_t k = 0; k < group_size; ++k)
             {
-               modified_berlekamp_massey_algorithm(lambda, syndrome, erasure_list.size());
+               syndrome.clear();
+               syndrome.resize(fec_length);
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  syndrome[j] = syndromes[k][j];
+               }
+
+               lambda.clear();
+               lambda.resize(fec_length + 2);
+
+               for (std::size_t t = 0; t < (fec_length + 2); ++t)
+               {
+                  lambda[t] = locators[k][t];
+               }
+
+               lambda.simplify();
+
+               if (correct(group[k], lambda, syndrome))
+                  ++decoded;
             }
 
-            std::vector<int> error_locations;
+            return decoded;
+         }
+
+         /*
+            Chien search and Forney steps of decode_codeword(), run once the
+            error locator of a codeword with a non-zero syndrome is known.
+            With data_only the roots in the parity are held apart, in
+            workspace.parity_locations, see decode_data().
+         */
+         template <typename Codeword>
+         bool correct_errors(Codeword& rsblock,
+                             const locator_polynomial&  lambda,
+                             const syndrome_polynomial& syndrome,
+                             const std::size_t          erasure_count,
+                             workspace_type&            workspace,
+                             const std::size_t          length    = code_length,
+                             const bool                 data_only = false) const
+         {
+            std::vector<int>& error_locations  = workspace.error_locations;
+            std::vector<int>& parity_locations = workspace.parity_locations;
 
-            find_roots(lambda, error_locations);
+            std::size_t root_count = 0;
 
-            if (0 == error_locations.size())
+            {
+               instrumentation::stage_timer timer(instrumentation::e_chien_search);
+
+               if (data_only)
+               {
+                  find_roots(lambda, error_locations, code_length - length + 1, code_length - fec_length);
+
+                  parity_locations.clear();
+
+                  if (static_cast<int>(error_locations.size()) < lambda.deg())
+                  {
+                     find_roots(lambda, parity_locations, code_length - fec_length + 1);
+                  }
+
+                  root_count = error_locations.size() + parity_locations.size();
+               }
+               else
+               {
+                  find_roots(lambda, error_locations, code_length - length + 1);
+
+                  root_count = error_locations.size();
+               }
+            }
+
+            if (0 == root_count)
             {
                /*
                  Syndrome is non-zero yet no error locations have
@@ -130,11 +1035,13 @@ namespace schifra
                rsblock.errors_corrected = 0;
                rsblock.zero_numerators  = 0;
                rsblock.unrecoverable    = true;
-               rsblock.error            = block_type::e_decoder_error1;
+               rsblock.error            = Codeword::e_decoder_error1;
+
+               instrumentation::record_unrecoverable(rsblock.error);
 
                return false;
             }
-            else if (((2 * error_locations.size()) - erasure_list.size()) > fec_length)
+            else if (((2 * root_count) - erasure_count) > fec_length)
             {
                /*
                   Too many errors\erasures! 2E + S <= fec_length
@@ -150,65 +1057,165 @@ namespace schifra
 
                */
 
-               rsblock.errors_detected  = error_locations.size();
+               rsblock.errors_detected  = root_count;
                rsblock.errors_corrected = 0;
                rsblock.zero_numerators  = 0;
                rsblock.unrecoverable    = true;
-               rsblock.error            = block_type::e_decoder_error2;
+               rsblock.error            = Codeword::e_decoder_error2;
+
+               instrumentation::record_unrecoverable(rsblock.error);
 
                return false;
             }
             else
-               rsblock.errors_detected  = error_locations.size();
+               rsblock.errors_detected  = root_count;
 
-            return forney_algorithm(error_locations, lambda, syndrome, rsblock);
-         }
+            if (data_only && verify_corrections_)
+            {
+               error_locations.insert(error_locations.end(), parity_locations.begin(), parity_locations.end());
+            }
 
-      private:
+            bool corrected = false;
 
-         decoder();
-         decoder(const decoder& dec);
-         decoder& operator=(const decoder& dec);
+            /* Symbols at the error locations as read, see verify_corrections() */
+            galois::field_symbol read[fec_length] = { 0 };
 
-      protected:
+            if (verify_corrections_)
+            {
+               for (std::size_t i = 0; i < error_locations.size(); ++i)
+               {
+                  read[i] = rsblock[error_locations[i] - 1 - (code_length - length)];
+               }
+            }
 
-         void load_message(galois::field_polynomial& received, const block_type& rsblock) const
-         {
-            /*
-              Load message data into received polynomial in reverse order.
-            */
+            {
+               instrumentation::stage_timer timer(instrumentation::e_forney);
 
-            for (std::size_t i = 0; i < code_length; ++i)
+               corrected = forney_algorithm(error_locations, lambda, syndrome, rsblock, code_length - length);
+            }
+
+            if (corrected && verify_corrections_ && !corrections_cancel(error_locations, read, syndrome, rsblock, code_length - length))
             {
-               received[code_length - 1 - i] = rsblock[i];
+               for (std::size_t i = 0; i < error_locations.size(); ++i)
+               {
+                  rsblock[error_locations[i] - 1 - (code_length - length)] = static_cast<typename Codeword::symbol_type>(read[i]);
+               }
+
+               rsblock.errors_corrected = 0;
+               rsblock.unrecoverable    = true;
+               rsblock.error            = Codeword::e_decoder_error5;
+
+               corrected = false;
             }
+
+            if (corrected)
+               instrumentation::record_corrected(rsblock.errors_corrected);
+            else
+               instrumentation::record_unrecoverable(rsblock.error);
+
+            return corrected;
          }
 
-         void create_lookup_tables()
+         /*
+            Forney step of decode_erasures(): lambda is the erasure locator
+            and the erasures, held in workspace.erasure_locations, are its
+            roots, alpha^-e being alpha^(code_length - e). The block is
+            restored as read unless the corrections cancel the syndromes.
+         */
+         template <typename Codeword>
+         bool correct_erasures(Codeword& rsblock,
+                               const locator_polynomial&  lambda,
+                               const syndrome_polynomial& syndrome,
+                               const std::size_t          erasure_count,
+                               workspace_type&            workspace,
+                               const std::size_t          length = code_length) const
          {
-            root_exponent_table_.reserve(field_.size() + 1);
+            if (0 == erasure_count)
+            {
+               rsblock.errors_detected  = 0;
+               rsblock.errors_corrected = 0;
+               rsblock.zero_numerators  = 0;
+               rsblock.unrecoverable    = true;
+               rsblock.error            = Codeword::e_decoder_error1;
+
+               instrumentation::record_unrecoverable(rsblock.error);
+
+               return false;
+            }
+
+            std::vector<int>& error_locations = workspace.error_locations;
+
+            error_locations.resize(erasure_count);
+
+            galois::field_symbol read[fec_length];
 
-            for (int i = 0; i < static_cast<int>(field_.size() + 1); ++i)
+            for (std::size_t i = 0; i < erasure_count; ++i)
             {
-               root_exponent_table_.push_back(field_.exp(field_.alpha(code_length - i),(1 - gen_initial_index_)));
+               error_locations[i] = static_cast<int>(code_length - workspace.erasure_locations[i]);
+               read[i]            = rsblock[error_locations[i] - 1 - (code_length - length)];
             }
 
-            syndrome_exponent_table_.reserve(fec_length);
+            rsblock.errors_detected = erasure_count;
+
+            bool corrected = false;
+
+            {
+               instrumentation::stage_timer timer(instrumentation::e_forney);
+
+               corrected = forney_algorithm(error_locations, lambda, syndrome, rsblock, code_length - length);
+            }
+
+            if (corrected && !corrections_cancel(error_locations, read, syndrome, rsblock, code_length - length))
+            {
+               rsblock.unrecoverable = true;
+               rsblock.error         = Codeword::e_decoder_error5;
+
+               corrected = false;
+            }
+
+            if (!corrected)
+            {
+               for (std::size_t i = 0; i < erasure_count; ++i)
+               {
+                  rsblock[error_locations[i] - 1 - (code_length - length)] = static_cast<typename Codeword::symbol_type>(read[i]);
+               }
+
+               rsblock.errors_corrected = 0;
+
+               instrumentation::record_unrecoverable(rsblock.error);
+            }
+            else
+               instrumentation::record_corrected(rsblock.errors_corrected);
+
+            return corrected;
+         }
+
+         template <typename Codeword>
+         void load_message(received_polynomial& received, const Codeword& rsblock,
+                           const std::size_t length = code_length) const
+         {
+            received.clear();
+            received.resize(length);
 
-            for (int i = 0; i < static_cast<int>(fec_length); ++i)
+            for (std::size_t i = 0; i < length; ++i)
             {
-               syndrome_exponent_table_.push_back(field_.alpha(gen_initial_index_ + i));
+               received[length - 1 - i] = rsblock[i];
             }
+         }
 
-            gamma_table_.reserve(field_.size() + 1);
+         /* The shared tables of this field and code, see decoder_tables */
+         void create_lookup_tables()
+         {
+            tables_ = shared_decoder_tables(field_, gen_initial_index_, fec_length);
 
-            for (int i = 0; i < static_cast<int>(field_.size() + 1); ++i)
-            {
-               gamma_table_.push_back((1 + (X_ * galois::field_element(field_,field_.alpha(i)))));
-            }
+            root_exponent_table_     = tables_->root_exponents();
+            syndrome_exponent_table_ = tables_->syndrome_exponents();
+            syndrome_multiplier_     = tables_->syndrome_multipliers();
          }
 
-         void prepare_erasure_list(erasure_locations_t& erasure_locations, const erasure_locations_t& erasure_list) const
+         void prepare_erasure_list(erasure_locations_t& erasure_locations,
+                                   const erasure_locations_t& erasure_list,
+                                   const std::size_t length = code_length) const
          {
             /*
               Note: 1. Erasure positions must be unique.
@@ -220,51 +1227,125 @@ namespace schifra
 
             for (std::size_t i = 0; i < erasure_list.size(); ++i)
             {
-               erasure_locations[i] = (code_length - 1 - erasure_list[i]);
+               erasure_locations[i] = (length - 1 - erasure_list[i]);
             }
          }
 
-         int compute_syndrome(const galois::field_polynomial& received,
-                                    galois::field_polynomial& syndrome) const
+         template <std::size_t mask_length>
+         void prepare_erasure_list(erasure_locations_t& erasure_locations,
+                                   const erasure_mask<mask_length>& erasure_list,
+                                   const std::size_t length = code_length) const
+         {
+            erasure_locations.clear();
+
+            erasure_list.for_each([&](const std::size_t position)
+                                  {
+                                     erasure_locations.push_back(length - 1 - position);
+                                  });
+         }
+
+         int compute_syndrome(const received_polynomial& received,
+                                    syndrome_polynomial& syndrome) const
          {
             int error_flag = 0;
-            syndrome = galois::field_polynomial(field_,fec_length - 1);
+
+            syndrome.clear();
+            syndrome.resize(fec_length);
 
             for (std::size_t i = 0; i < fec_length; ++i)
             {
                syndrome[i]  = received(syndrome_exponent_table_[i]);
-               error_flag  |= syndrome[i].poly();
+               error_flag  |= syndrome[i];
             }
 
             return error_flag;
          }
 
-         void compute_gamma(galois::field_polynomial& gamma, const erasure_locations_t& erasure_locations) const
+         void compute_gamma(locator_polynomial& gamma, const erasure_locations_t& erasure_locations) const
          {
             for (std::size_t i = 0; i < erasure_locations.size(); ++i)
             {
-               gamma *= gamma_table_[erasure_locations[i]];
+               gamma.mul_linear(field_.alpha(static_cast<unsigned int>(erasure_locations[i])));
             }
          }
 
-         void find_roots(const galois::field_polynomial& poly, std::vector<int>& root_list) const
+         /*
+            Note: Roots below first_root map to the virtual zero prefix of a
+                  shortened codeword and are not searched for, nor are
+                  those beyond last_root.
+         */
+         void find_roots(const locator_polynomial& poly, std::vector<int>& root_list,
+                         const std::size_t first_root = 1,
+                         const std::size_t last_root  = code_length) const
          {
+            root_list.reserve(fec_length << 1);
+            root_list.resize(0);
+
+            if (1 == poly.deg())
+            {
+               /*
+                  A single root, poly[0] / poly[1], is read straight off
+                  the log table: the first i >= first_root with alpha^i
+                  equal to it, as the search below would have found.
+               */
+               const galois::field_symbol root = field_.div(poly[0], poly[1]);
+
+               if (0 != root)
+               {
+                  for (std::size_t i = static_cast<std::size_t>(field_.index(root)); i <= last_root; i += field_.size())
+                  {
+                     if ((i >= first_root) && (field_.alpha(static_cast<galois::field_symbol>(i)) == root))
+                     {
+                        root_list.push_back(static_cast<int>(i));
+                        break;
+                     }
+                  }
+               }
+
+               return;
+            }
+
             /*
-               Chien Search: Find the roots of the error locator polynomial
-               via an exhaustive search over all non-zero elements in the
-               given finite field.
+               Incremental Chien search: term j of poly(alpha^i) is
+               alpha^(log(poly[j]) + i.j), so moving to the next position
+               adds j to the exponent of each non-zero term, and the sum is
+               one antilog lookup per term. The search stops once deg(poly)
+               roots have been found.
             */
+            const std::size_t  polynomial_degree = poly.deg();
+            const unsigned int n                 = field_.size();
 
-            root_list.reserve(fec_length << 1);
-            root_list.resize(0);
+            unsigned int exponent[fec_length + 2];
+            unsigned int step    [fec_length + 2];
+            std::size_t  terms = 0;
 
-            const std::size_t polynomial_degree = poly.deg();
+            for (std::size_t j = 1; j <= polynomial_degree; ++j)
+            {
+               if (0 != poly[j])
+               {
+                  step    [terms] = static_cast<unsigned int>(j % n);
+                  exponent[terms] = static_cast<unsigned int>((field_.index(poly[j]) + j * first_root) % n);
+                  ++terms;
+               }
+            }
 
-            for (int i = 1; i <= static_cast<int>(code_length); ++i)
+            for (std::size_t i = first_root; i <= last_root; ++i)
             {
-               if (0 == poly(field_.alpha(i)).poly())
+               galois::field_symbol sum = poly[0];
+
+               for (std::size_t t = 0; t < terms; ++t)
+               {
+                  sum ^= field_.alpha(static_cast<galois::field_symbol>(exponent[t]));
+
+                  exponent[t] += step[t];
+
+                  if (exponent[t] >= n)
+                     exponent[t] -= n;
+               }
+
+               if (0 == sum)
                {
-                  root_list.push_back(i);
+                  root_list.push_back(static_cast<int>(i));
 
                   if (polynomial_degree == root_list.size())
                   {
@@ -274,56 +1355,118 @@ namespace schifra
             }
          }
 
-         void compute_discrepancy(galois::field_element&          discrepancy,
-                                  const galois::field_polynomial& lambda,
-                                  const galois::field_polynomial& syndrome,
-                                  const std::size_t&              l,
-                                  const std::size_t&              round) const
+         galois::field_symbol compute_discrepancy(const locator_polynomial&  lambda,
+                                                  const syndrome_polynomial& syndrome,
+                                                  const std::size_t&         l,
+                                                  const std::size_t&         round) const
          {
-            /*
-               Compute the lambda discrepancy at the current round of BMA
-            */
-
             const std::size_t upper_bound = std::min(static_cast<int>(l), lambda.deg());
 
-            discrepancy = 0;
+            galois::field_symbol discrepancy = 0;
 
             for (std::size_t i = 0; i <= upper_bound; ++i)
             {
-               discrepancy += lambda[i] * syndrome[round - i];
+               discrepancy ^= field_.mul(lambda[i], syndrome[round - i]);
             }
+
+            return discrepancy;
          }
 
-         void modified_berlekamp_massey_algorithm(galois::field_polynomial&       lambda,
-                                                  const galois::field_polynomial& syndrome,
-                                                  const std::size_t               erasure_count) const
+         /*
+            Peterson-Gorenstein-Zierler solution of the error locator for
+            t <= 2, ie: fec_length <= 4. The locator is the connection
+            polynomial of the shortest LFSR generating the syndromes, and
+            whenever that LFSR has length L <= fec_length / 2 it is unique,
+            so it is exactly the polynomial the BMA would have produced.
+
+            Two errors (fec_length >= 4), from Newton's identities:
+
+               lambda1 * S1 + lambda2 * S0 = S2
+               lambda1 * S2 + lambda2 * S1 = S3
+
+            which has a unique solution when det = S1^2 + S0.S2 is non-zero.
+            Otherwise one error, when S(k) = a.S(k - 1) for every k, giving
+            lambda = 1 + a.x.
+
+            Returns false when neither form applies (more errors than can be
+            corrected, or a degenerate syndrome), the BMA is then run.
+         */
+         bool closed_form_locator(const syndrome_polynomial& syndrome, locator_polynomial& lambda) const
          {
-            /*
-               Modified Berlekamp-Massey Algorithm
-               Identify the shortest length linear feed-back shift register (LFSR)
-               that will generate the sequence equivalent to the syndrome.
-            */
+            if constexpr (fec_length < 2)
+            {
+               return false;
+            }
+
+            const galois::field_symbol s0 = syndrome[0];
+            const galois::field_symbol s1 = syndrome[1];
+
+            if constexpr (fec_length >= 4)
+            {
+               const galois::field_symbol s2  = syndrome[2];
+               const galois::field_symbol s3  = syndrome[3];
+               const galois::field_symbol det = field_.mul(s1, s1) ^ field_.mul(s0, s2);
+
+               if (0 != det)
+               {
+                  lambda.clear();
+                  lambda.resize(3);
+                  lambda[0] = 1;
+                  lambda[1] = field_.div(field_.mul(s1, s2) ^ field_.mul(s0, s3), det);
+                  lambda[2] = field_.div(field_.mul(s1, s3) ^ field_.mul(s2, s2), det);
+                  lambda.simplify();
+
+                  return true;
+               }
+            }
+
+            if (0 == s0)
+               return false;
+
+            const galois::field_symbol a = field_.div(s1, s0);
+
+            for (std::size_t k = 2; k < fec_length; ++k)
+            {
+               if (syndrome[k] != field_.mul(a, syndrome[k - 1]))
+                  return false;
+            }
+
+            lambda.clear();
+            lambda.resize(2);
+            lambda[0] = 1;
+            lambda[1] = a;
+            lambda.simplify();
+
+            return true;
+         }
 
+         void modified_berlekamp_massey_algorithm(locator_polynomial&        lambda,
+                                                  const syndrome_polynomial& syndrome,
+                                                  const std::size_t          erasure_count) const
+         {
             int i = -1;
             std::size_t l = erasure_count;
 
-            galois::field_element discrepancy(field_,0);
-            galois::field_polynomial previous_lambda = lambda << 1;
+            locator_polynomial previous_lambda = lambda;
+            previous_lambda <<= 1;
 
             for (std::size_t round = erasure_count; round < fec_length; ++round)
             {
-               compute_discrepancy(discrepancy, lambda, syndrome, l, round);
+               const galois::field_symbol discrepancy = compute_discrepancy(lambda, syndrome, l, round);
 
                if (discrepancy != 0)
                {
-                  galois::field_polynomial tau = lambda - (discrepancy * previous_lambda);
+                  locator_polynomial tau = previous_lambda;
+                  tau *= discrepancy;
+                  tau -= lambda;
 
                   if (static_cast<int>(l) < (static_cast<int>(round) - i))
                   {
                      const std::size_t tmp = round - i;
                      i = static_cast<int>(round - l);
                      l = tmp;
-                     previous_lambda = lambda / discrepancy;
+                     previous_lambda  = lambda;
+                     previous_lambda /= discrepancy;
                   }
 
                   lambda = tau;
@@ -333,38 +1476,367 @@ namespace schifra
             }
          }
 
-         bool forney_algorithm(const std::vector<int>&         error_locations,
-                               const galois::field_polynomial& lambda,
-                               const galois::field_polynomial& syndrome,
-                               block_type&                     rsblock) const
+         /*
+            Key equation solved by the modified (inversionless) Euclidean
+            algorithm. lambda holds the erasure locator gamma on entry.
+            With T(x) = gamma(x).S(x) mod x^fec_length, remainders r and
+            their locators u run from (x^fec_length, 0) and (T, 1), the
+            higher degree remainder being reduced by the lower one each
+            step through a cross multiplication:
+
+               r  = lead(q).r + lead(r).x^d.q     d = deg r - deg q
+               u  = lead(q).u + lead(r).x^d.v
+
+            until deg q < (fec_length + erasure_count) / 2, the error
+            locator then being v, and lambda = gamma.v scaled to
+            lambda(0) = 1. Every step is the same two multiply-accumulates
+            whatever the data, and each lowers deg r + deg q.
+         */
+         void euclidean_algorithm(locator_polynomial&        lambda,
+                                  const syndrome_polynomial& syndrome,
+                                  const std::size_t          erasure_count) const
+         {
+            galois::field_symbol rem_a[fec_length + 1] = { 0 };
+            galois::field_symbol rem_b[fec_length + 1] = { 0 };
+            galois::field_symbol loc_a[fec_length + 1] = { 0 };
+            galois::field_symbol loc_b[fec_length + 1] = { 0 };
+
+            galois::field_symbol* r = rem_a;
+            galois::field_symbol* q = rem_b;
+            galois::field_symbol* u = loc_a;
+            galois::field_symbol* v = loc_b;
+
+            r[fec_length] = 1;
+
+            galois::poly_mul(field_, lambda.data(), lambda.size(), syndrome.data(), syndrome.size(), q, fec_length);
+
+            int deg_r = static_cast<int>(fec_length);
+            int deg_q = static_cast<int>(fec_length) - 1;
+            int deg_u = -1;
+            int deg_v = 0;
+
+            v[0] = 1;
+
+            while ((deg_q >= 0) && (0 == q[deg_q])) --deg_q;
+
+            const int limit = static_cast<int>(fec_length + erasure_count);
+
+            for (std::size_t step = 0; step < 2 * fec_length; ++step)
+            {
+               if (deg_r < deg_q)
+               {
+                  std::swap(r, q); std::swap(deg_r, deg_q);
+                  std::swap(u, v); std::swap(deg_u, deg_v);
+               }
+
+               if ((2 * deg_q) < limit)
+                  break;
+
+               const galois::field_symbol a = q[deg_q];
+               const galois::field_symbol b = r[deg_r];
+               const int                  d = deg_r - deg_q;
+
+               for (int i = 0; i <= deg_r; ++i)
+               {
+                  r[i] = field_.mul(a, r[i]) ^ (((i >= d) && (i - d <= deg_q)) ? field_.mul(b, q[i - d]) : 0);
+               }
+
+               const int deg = std::min(static_cast<int>(fec_length), std::max(deg_u, deg_v + d));
+
+               for (int i = 0; i <= deg; ++i)
+               {
+                  const galois::field_symbol ui = (i <= deg_u) ? field_.mul(a, u[i]) : 0;
+
+                  u[i] = ui ^ (((i >= d) && (i - d <= deg_v)) ? field_.mul(b, v[i - d]) : 0);
+               }
+
+               deg_u = deg;
+
+               while ((deg_r >= 0) && (0 == r[deg_r])) --deg_r;
+               while ((deg_u >= 0) && (0 == u[deg_u])) --deg_u;
+            }
+
+            /*
+               The key equation has no solution within the code's reach when
+               2.deg v + erasure_count > fec_length, or when the evaluator
+               q = v.T mod x^fec_length is not of lower degree than the
+               locator gamma.v: more errors than can be corrected. The
+               locator is then left without roots, so that the decoder fails
+               rather than correcting to another codeword.
+            */
+            if ((deg_v < 0) || ((2 * deg_v) + static_cast<int>(erasure_count) > static_cast<int>(fec_length)) ||
+                (deg_q >= deg_v + static_cast<int>(erasure_count)))
+            {
+               lambda.clear();
+               lambda.resize(1);
+               lambda[0] = 1;
+
+               return;
+            }
+
+            /* lambda = gamma.v, up to fec_length + 2 terms */
+            galois::field_symbol product[fec_length + 2];
+
+            const std::size_t terms = galois::poly_mul(field_, lambda.data(), lambda.size(),
+                                                       v, static_cast<std::size_t>(deg_v + 1),
+                                                       product, locator_polynomial::max_size());
+
+            lambda.resize(terms);
+
+            const galois::field_symbol scale = (0 != product[0]) ? field_.inverse(product[0]) : 1;
+
+            for (std::size_t i = 0; i < terms; ++i)
+            {
+               lambda[i] = field_.mul(scale, product[i]);
+            }
+
+            lambda.simplify();
+         }
+
+         /*
+            Inversionless Berlekamp-Massey run on up to lanes codewords in
+            lockstep, the state of every polynomial term held as one array
+            of lanes symbols. Each lane makes the same register length
+            decisions as modified_berlekamp_massey_algorithm(), but through
+            masks instead of branches:
+
+               lambda' = gamma.lambda + delta.previous    (delta != 0)
+               gamma'  = delta, previous' = lambda        (on a length change)
+
+            which leaves lambda a non-zero multiple of the BMA locator, it
+            is divided by lambda[0] at the end. Lanes past count are idle,
+            lambda[k] receives the fec_length + 2 locator terms of lane k.
+         */
+         template <std::size_t lanes>
+         void lockstep_berlekamp_massey(const galois::field_symbol (*syndrome)[fec_length],
+                                        galois::field_symbol       (*lambda)[fec_length + 2],
+                                        const std::size_t          count) const
+         {
+            const std::size_t terms = fec_length + 2;
+
+            galois::field_symbol s        [fec_length][lanes];
+            galois::field_symbol lam      [terms][lanes];
+            galois::field_symbol previous [terms][lanes];
+            galois::field_symbol gamma    [lanes];
+            galois::field_symbol delta    [lanes];
+            int                  shift    [lanes];
+            int                  length   [lanes];
+
+            for (std::size_t k = 0; k < lanes; ++k)
+            {
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  s[j][k] = (k < count) ? syndrome[k][j] : 0;
+               }
+
+               for (std::size_t t = 0; t < terms; ++t)
+               {
+                  lam     [t][k] = 0;
+                  previous[t][k] = 0;
+               }
+
+               lam     [0][k] = 1;
+               previous[1][k] = 1;
+               gamma      [k] = 1;
+               shift      [k] = -1;
+               length     [k] = 0;
+            }
+
+            /*
+               Note: deg(lambda) never exceeds its register length, so the
+                     largest length over all lanes bounds the terms that
+                     take part in the discrepancy and the update.
+            */
+            int max_length = 0;
+
+            for (std::size_t round = 0; round < fec_length; ++round)
+            {
+               const int         r      = static_cast<int>(round);
+               const std::size_t active = std::min(round, static_cast<std::size_t>(max_length)) + 1;
+
+               galois::field_symbol any = 0;
+
+               for (std::size_t k = 0; k < lanes; ++k)
+               {
+                  galois::field_symbol d = 0;
+
+                  for (std::size_t t = 0; t < active; ++t)
+                  {
+                     const galois::field_symbol mask = (static_cast<int>(t) <= length[k]) ? ~0 : 0;
+                     d ^= field_.mul(lam[t][k], s[round - t][k]) & mask;
+                  }
+
+                  delta[k] = d;
+                  any     |= d;
+               }
+
+               galois::field_symbol change[lanes];
+
+               for (std::size_t k = 0; k < lanes; ++k)
+               {
+                  const galois::field_symbol nonzero = (0 != delta[k]) ? ~0 : 0;
+
+                  change[k] = ((length[k] < (r - shift[k])) ? ~0 : 0) & nonzero;
+
+                  const int new_length = r - shift[k];
+
+                  shift [k] = (change[k]) ? (r - length[k]) : shift[k];
+                  length[k] = (change[k]) ? new_length      : length[k];
+
+                  max_length = std::max(max_length, length[k]);
+               }
+
+               /* lambda' = gamma.lambda + delta.previous, where delta != 0 */
+               const std::size_t update = static_cast<std::size_t>(max_length) + 1;
+
+               galois::field_symbol next[terms][lanes];
+
+               for (std::size_t t = 0; (0 != any) && (t < update); ++t)
+               {
+                  for (std::size_t k = 0; k < lanes; ++k)
+                  {
+                     next[t][k] = field_.mul(gamma[k], lam[t][k]) ^ field_.mul(delta[k], previous[t][k]);
+                  }
+               }
+
+               /* previous <<= 1, after taking lambda on a length change */
+               for (std::size_t t = round + 2; t > 0; --t)
+               {
+                  for (std::size_t k = 0; k < lanes; ++k)
+                  {
+                     previous[t][k] = (lam[t - 1][k] & change[k]) | (previous[t - 1][k] & ~change[k]);
+                  }
+               }
+
+               for (std::size_t k = 0; k < lanes; ++k)
+               {
+                  previous[0][k] = 0;
+               }
+
+               for (std::size_t t = 0; (0 != any) && (t < update); ++t)
+               {
+                  for (std::size_t k = 0; k < lanes; ++k)
+                  {
+                     const galois::field_symbol nonzero = (0 != delta[k]) ? ~0 : 0;
+
+                     lam[t][k] = (next[t][k] & nonzero) | (lam[t][k] & ~nonzero);
+                  }
+               }
+
+               for (std::size_t k = 0; k < lanes; ++k)
+               {
+                  gamma[k] = (delta[k] & change[k]) | (gamma[k] & ~change[k]);
+               }
+            }
+
+            for (std::size_t k = 0; k < count; ++k)
+            {
+               for (std::size_t t = 0; t < terms; ++t)
+               {
+                  lambda[k][t] = field_.div(lam[t][k], lam[0][k]);
+               }
+            }
+         }
+
+         template <typename Codeword>
+         bool forney_algorithm(const std::vector<int>&    error_locations,
+                               const locator_polynomial&  lambda,
+                               const syndrome_polynomial& syndrome,
+                               Codeword&                  rsblock,
+                               const std::size_t          padding = 0) const
          {
             /*
-               The Forney algorithm for computing the error magnitudes
+               omega = (lambda * syndrome) mod x^fec_length and the formal
+               derivative of lambda (its odd terms, as 2 = 0) are held as
+               the logs of their terms and evaluated in the log domain:
+               term j at x = alpha^l is alpha^(log(c[j]) + j.l), the j.l
+               exponent being stepped by l, modulo n, from term to term.
             */
-            const galois::field_polynomial omega = (lambda * syndrome) % fec_length;
-            const galois::field_polynomial lambda_derivative = lambda.derivative();
+            const unsigned int n = field_.size();
+
+            galois::field_symbol omega[fec_length];
+
+            unsigned int omega_log[fec_length];
+            unsigned int derivative_log[(fec_length + 3) / 2];
+
+            const std::size_t product_terms = galois::poly_mul(field_, lambda.data(), lambda.size(),
+                                                               syndrome.data(), syndrome.size(),
+                                                               omega, fec_length);
+
+            std::size_t omega_terms      = 0;
+            std::size_t derivative_terms = 0;
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               const galois::field_symbol c = (i < product_terms) ? omega[i] : 0;
+
+               omega_log[i] = (0 != c) ? static_cast<unsigned int>(field_.index(c)) : n;
+
+               if (0 != c)
+                  omega_terms = i + 1;
+            }
+
+            for (std::size_t j = 1; j < lambda.size(); j += 2)
+            {
+               derivative_log[j / 2] = (0 != lambda[j]) ? static_cast<unsigned int>(field_.index(lambda[j])) : n;
+
+               if (0 != lambda[j])
+                  derivative_terms = (j / 2) + 1;
+            }
 
             rsblock.errors_corrected = 0;
             rsblock.zero_numerators  = 0;
 
             for (std::size_t i = 0; i < error_locations.size(); ++i)
             {
-               const unsigned int         error_location = error_locations[i];
-               const galois::field_symbol alpha_inverse  = field_.alpha(error_location);
-               const galois::field_symbol numerator      = (omega(alpha_inverse) * root_exponent_table_[error_location]).poly();
-               const galois::field_symbol denominator    = lambda_derivative(alpha_inverse).poly();
+               const unsigned int error_location = error_locations[i];
+               const unsigned int l              = error_location % n;
+               const unsigned int l2             = (2 * l) % n;
+
+               galois::field_symbol omega_value = 0;
+               galois::field_symbol denominator = 0;
+
+               for (unsigned int t = 0, e = 0; t < omega_terms; ++t)
+               {
+                  if (n != omega_log[t])
+                  {
+                     const unsigned int x = omega_log[t] + e;
+                     omega_value ^= field_.alpha(static_cast<galois::field_symbol>((x >= n) ? (x - n) : x));
+                  }
+
+                  e += l;
+
+                  if (e >= n)
+                     e -= n;
+               }
+
+               for (unsigned int t = 0, e = 0; t < derivative_terms; ++t)
+               {
+                  if (n != derivative_log[t])
+                  {
+                     const unsigned int x = derivative_log[t] + e;
+                     denominator ^= field_.alpha(static_cast<galois::field_symbol>((x >= n) ? (x - n) : x));
+                  }
+
+                  e += l2;
+
+                  if (e >= n)
+                     e -= n;
+               }
+
+               const galois::field_symbol numerator = field_.mul(omega_value, root_exponent_table_[error_location]);
 
                if (0 != numerator)
                {
                   if (0 != denominator)
                   {
-                     rsblock[error_location - 1] ^= field_.div(numerator, denominator);
+                     rsblock[error_location - 1 - padding] ^= static_cast<typename Codeword::symbol_type>(field_.div(numerator, denominator));
                      rsblock.errors_corrected++;
                   }
                   else
                   {
                      rsblock.unrecoverable = true;
-                     rsblock.error         = block_type::e_decoder_error3;
+                     rsblock.error         = Codeword::e_decoder_error3;
                      return false;
                   }
                }
@@ -377,20 +1849,59 @@ namespace schifra
             else
             {
                rsblock.unrecoverable = true;
-               rsblock.error         = block_type::e_decoder_error4;
+               rsblock.error         = Codeword::e_decoder_error4;
                return false;
             }
          }
 
+         /*
+            True when the corrections forney_algorithm() made to rsblock,
+            the symbol at error_locations[k] having been read[k], cancel the
+            syndromes: an error e at degree d = code_length - location adds
+            e.alpha^((gii + j).d) to syndrome j.
+         */
+         template <typename Codeword>
+         bool corrections_cancel(const std::vector<int>&     error_locations,
+                                 const galois::field_symbol* read,
+                                 const syndrome_polynomial&  syndrome,
+                                 const Codeword&             rsblock,
+                                 const std::size_t           padding) const
+         {
+            const unsigned long long n = field_.size();
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               galois::field_symbol s = syndrome[j];
+
+               for (std::size_t k = 0; k < error_locations.size(); ++k)
+               {
+                  const galois::field_symbol e = static_cast<galois::field_symbol>(rsblock[error_locations[k] - 1 - padding]) ^ read[k];
+
+                  if (0 == e)
+                     continue;
+
+                  const unsigned long long d = code_length - error_locations[k];
+
+                  s ^= field_.mul(e, field_.alpha(static_cast<galois::field_symbol>((((gen_initial_index_ + j) % n) * d) % n)));
+               }
+
+               if (0 != s)
+                  return false;
+            }
+
+            return true;
+         }
+
       protected:
 
          bool                                  decoder_valid_;
          const galois::field&                  field_;
-         std::vector<galois::field_symbol>     root_exponent_table_;
-         std::vector<galois::field_symbol>     syndrome_exponent_table_;
-         std::vector<galois::field_polynomial> gamma_table_;
-         const galois::field_polynomial        X_;
+         decoder_table_cache::tables_ptr       tables_;
+         const galois::field_symbol*           root_exponent_table_;
+         const galois::field_symbol*           syndrome_exponent_table_;
+         const galois::region::multiplier*     syndrome_multiplier_;
          const unsigned int                    gen_initial_index_;
+         bool                                  verify_corrections_;
       };
 
       template <std::size_t code_length,
@@ -409,67 +1920,26 @@ namespace schifra
          : decoder_(field, gen_initial_index)
          {}
 
+         /*
+            Note: The block is decoded in place by the natural decoder, the
+                  padding_length virtual zeros are never materialised. As
+                  with decoder::decode(), an unrecoverable block may be left
+                  partially corrected.
+         */
          inline bool decode(block_type& rsblock, const erasure_locations_t& erasure_list) const
          {
-            typename natural_decoder_type::block_type block;
-
-            std::fill_n(&block[0], padding_length, typename block_type::symbol_type(0));
-
-            for (std::size_t i = 0; i < code_length; ++i)
-            {
-               block.data[padding_length + i] = rsblock.data[i];
-            }
-
-            erasure_locations_t shifted_position_erasure_list(erasure_list.size(),0);
-
-            for (std::size_t i = 0; i < erasure_list.size(); ++i)
-            {
-               shifted_position_erasure_list[i] = erasure_list[i] + padding_length;
-            }
-
-            if (decoder_.decode(block, shifted_position_erasure_list))
-            {
-               for (std::size_t i = 0; i < code_length; ++i)
-               {
-                  rsblock.data[i] = block.data[padding_length + i];
-               }
+            return decoder_.decode_shortened(rsblock, erasure_list);
+         }
 
-               rsblock.copy_state(block);
-               return true;
-            }
-            else
-            {
-               rsblock.copy_state(block);
-               return false;
-            }
+         inline bool decode(block_type& rsblock, const erasure_mask<code_length>& erasures) const
+         {
+            return decoder_.decode_shortened(rsblock, erasures);
          }
 
          inline bool decode(block_type& rsblock) const
          {
-            typename natural_decoder_type::block_type block;
-
-            std::fill_n(&block[0], padding_length, typename block_type::symbol_type(0));
-
-            for (std::size_t i = 0; i < code_length; ++i)
-            {
-               block.data[padding_length + i] = rsblock.data[i];
-            }
-
-            if (decoder_.decode(block))
-            {
-               for (std::size_t i = 0; i < code_length; ++i)
-               {
-                  rsblock.data[i] = block.data[padding_length + i];
-               }
-
-               rsblock.copy_state(block);
-               return true;
-            }
-            else
-            {
-               rsblock.copy_state(block);
-               return false;
-            }
+            const erasure_locations_t erasure_list;
+            return decoder_.decode_shortened(rsblock, erasure_list);
          }
 
       private:
@@ -478,6 +1948,20 @@ namespace schifra
          const natural_decoder_type decoder_;
       };
 
+      #if defined(SCHIFRA_EXTERN_TEMPLATES)
+
+      /* Compiled into the schifra_dna_storage library, see schifra_reed_solomon_instantiations.hpp */
+      #define SCHIFRA_EXTERN_DECODER(n, fec) extern template class decoder<n, fec>;
+      #define SCHIFRA_EXTERN_SHORTENED_DECODER(n, fec) extern template class shortened_decoder<n, fec>;
+
+      SCHIFRA_RS_COMMON_CODES(SCHIFRA_EXTERN_DECODER)
+      SCHIFRA_RS_COMMON_SHORTENED_CODES(SCHIFRA_EXTERN_SHORTENED_DECODER)
+
+      #undef SCHIFRA_EXTERN_DECODER
+      #undef SCHIFRA_EXTERN_SHORTENED_DECODER
+
+      #endif
+
    } // namespace reed_solomon
 
 } // namespace schifra
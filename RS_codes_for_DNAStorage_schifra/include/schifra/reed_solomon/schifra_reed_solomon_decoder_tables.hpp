@@ -0,0 +1,223 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_DECODER_TABLES_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_DECODER_TABLES_HPP
+
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+#include "schifra/utils/schifra_aligned_allocator.hpp"
+#include "schifra/utils/schifra_memory_accounting.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Lookup tables of decoder for a field, generator initial index and
+         fec_length, immutable once built. The root and syndrome exponents
+         are one flat, cache line aligned block drawn from the table memory
+         hook:
+
+            [0, field size + 1)                  : root exponents,
+                                                   alpha^(n - i)^(1 - gii)
+            [field size + 1, + fec_length)       : syndrome roots,
+                                                   alpha^(gii + i)
+
+         along with the region multipliers of the batch syndrome, by
+         alpha^(gii + i) ^ 1, for fields of up to 2^8 elements.
+      */
+      class decoder_tables
+      {
+      public:
+
+         decoder_tables(const galois::field& field,
+                        const unsigned int   gen_initial_index,
+                        const std::size_t    fec_length)
+         : root_count_(field.size() + 1),
+           charge_(utils::memory::e_decoder_tables)
+         {
+            exponents_.resize(root_count_ + fec_length);
+
+            for (std::size_t i = 0; i < root_count_; ++i)
+            {
+               exponents_[i] = field.exp(field.alpha(static_cast<galois::field_symbol>(field.size() - i)),(1 - gen_initial_index));
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               exponents_[root_count_ + i] = field.alpha(static_cast<galois::field_symbol>(gen_initial_index + i));
+            }
+
+            if (field.size() <= 0xFF)
+            {
+               syndrome_multiplier_.reserve(fec_length);
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  syndrome_multiplier_.push_back(galois::region::make_multiplier(field, exponents_[root_count_ + i] ^ 1));
+               }
+            }
+
+            charge_.resize(exponents_.capacity() * sizeof(galois::field_symbol) +
+                           syndrome_multiplier_.capacity() * sizeof(galois::region::multiplier));
+         }
+
+         inline const galois::field_symbol* root_exponents() const
+         {
+            return &exponents_[0];
+         }
+
+         inline const galois::field_symbol* syndrome_exponents() const
+         {
+            return &exponents_[root_count_];
+         }
+
+         /* Null for fields of more than 2^8 elements */
+         inline const galois::region::multiplier* syndrome_multipliers() const
+         {
+            return syndrome_multiplier_.empty() ? 0 : &syndrome_multiplier_[0];
+         }
+
+         /* See galois::field::warm_up() */
+         inline bool warm_up(const bool lock = false) const
+         {
+            const bool locked = utils::prefault(&exponents_[0], exponents_.size() * sizeof(galois::field_symbol), lock);
+
+            return utils::prefault(syndrome_multipliers(), syndrome_multiplier_.size() * sizeof(galois::region::multiplier), lock) && locked;
+         }
+
+      private:
+
+         decoder_tables(const decoder_tables&);
+         decoder_tables& operator=(const decoder_tables&);
+
+         typedef std::vector<galois::field_symbol, utils::table_allocator<galois::field_symbol> > table_type;
+
+         const std::size_t                       root_count_;
+         table_type                              exponents_;
+         std::vector<galois::region::multiplier> syndrome_multiplier_;
+         utils::memory::charge                   charge_;
+      };
+
+      /*
+         Process-wide cache of decoder tables keyed by (field instance,
+         field polynomial, initial root index, root count), so that every
+         decoder of one code over one field shares a single copy and
+         constructing another is a map lookup. Decoders over distinct
+         field instances, eg: the per node replicas of numa_replicas, get
+         tables of their own, built by the constructing thread. Entries
+         live as long as a decoder holds them.
+      */
+      class decoder_table_cache
+      {
+      public:
+
+         typedef std::shared_ptr<const decoder_tables> tables_ptr;
+
+         static decoder_table_cache& instance()
+         {
+            static decoder_table_cache cache;
+            return cache;
+         }
+
+         tables_ptr acquire(const galois::field& field, const unsigned int gen_initial_index, const std::size_t fec_length)
+         {
+            std::vector<unsigned int> primitive_poly(field.prim_poly_degree() + 1);
+
+            for (std::size_t i = 0; i < primitive_poly.size(); ++i)
+            {
+               primitive_poly[i] = field.prim_poly_term(static_cast<unsigned int>(i));
+            }
+
+            const key_type key(field_key(&field, primitive_poly), index_key(gen_initial_index, fec_length));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            table_map_t::iterator itr = tables_.find(key);
+
+            if (tables_.end() != itr)
+            {
+               if (tables_ptr tables = itr->second.lock())
+                  return tables;
+            }
+
+            /* Drop the entries of tables no decoder holds any more */
+            for (table_map_t::iterator i = tables_.begin(); i != tables_.end();)
+            {
+               if (i->second.expired())
+                  i = tables_.erase(i);
+               else
+                  ++i;
+            }
+
+            tables_ptr tables = std::make_shared<const decoder_tables>(field, gen_initial_index, fec_length);
+
+            tables_[key] = tables;
+
+            return tables;
+         }
+
+         std::size_t size() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return tables_.size();
+         }
+
+      private:
+
+         typedef std::pair<const galois::field*, std::vector<unsigned int> > field_key;
+         typedef std::pair<unsigned int, std::size_t>                       index_key;
+         typedef std::pair<field_key, index_key>                            key_type;
+         typedef std::map<key_type, std::weak_ptr<const decoder_tables> >   table_map_t;
+
+         decoder_table_cache() {}
+         decoder_table_cache(const decoder_table_cache&);
+         decoder_table_cache& operator=(const decoder_table_cache&);
+
+         table_map_t        tables_;
+         mutable std::mutex mutex_;
+      };
+
+      inline decoder_table_cache::tables_ptr shared_decoder_tables(const galois::field& field,
+                                                                   const unsigned int gen_initial_index,
+                                                                   const std::size_t  fec_length)
+      {
+         return decoder_table_cache::instance().acquire(field, gen_initial_index, fec_length);
+      }
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
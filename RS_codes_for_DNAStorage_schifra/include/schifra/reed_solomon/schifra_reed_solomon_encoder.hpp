@@ -24,13 +24,22 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_ENCODER_HPP
 
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "schifra/core/galois_field/field.hpp"
 #include "schifra/core/galois_field/element.hpp"
+#include "schifra/core/galois_field/fixed_polynomial.hpp"
 #include "schifra/core/galois_field/polynomial.hpp"
 #include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_instantiations.hpp"
+#include "schifra/utils/schifra_aligned_allocator.hpp"
 #include "schifra/utils/schifra_ecc_traits.hpp"
+#include "schifra/utils/schifra_span.hpp"
 
 
 namespace schifra
@@ -39,68 +48,433 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
       class encoder
       {
       public:
 
          typedef traits::reed_solomon_triat<code_length, fec_length,data_length> trait;
-         typedef block<code_length, fec_length> block_type;
+         typedef block<code_length, fec_length, code_length - fec_length, symbol_t> block_type;
+         typedef galois::fixed_polynomial<code_length>    message_polynomial;
+         typedef galois::fixed_polynomial<fec_length + 1> generator_polynomial;
+         typedef galois::fixed_polynomial<fec_length>     parity_polynomial;
+
+         /*
+            e_division : parity is the remainder of a polynomial division
+                         of the message by the generator.
+            e_lfsr     : parity is accumulated in a linear feedback shift
+                         register, using a precomputed row of products
+                         feedback * g[j] for every feedback symbol. Each
+                         data symbol costs one row lookup and fec_length
+                         xors. The table holds (field size + 1) * fec_length
+                         symbols, eg: 32KB for GF(2^8) with 32 fec symbols.
+
+            Both modes produce identical codewords.
+         */
+         enum mode_t
+         {
+            e_division = 0,
+            e_lfsr     = 1
+         };
+
+         /* Number of codewords whose LFSRs encode_batch() runs in lockstep */
+         static constexpr std::size_t batch_lanes = 8;
+
+         encoder(const galois::field& gfield,
+                 const galois::field_polynomial& generator,
+                 const mode_t mode = e_lfsr)
+         : encoder_valid_((code_length == gfield.size()) &&
+                          (static_cast<unsigned long long>(std::numeric_limits<symbol_t>::max()) >= gfield.size())),
+           field_(gfield),
+           generator_(generator),
+           fixed_generator_(gfield),
+           mode_(mode),
+           lfsr_rows_(0)
+         {
+            /*
+               Note: A generator that does not fit fec_length + 1 terms
+                     leaves fixed_generator_ empty, and encode() reports
+                     an incompatible generator.
+            */
+            fixed_generator_.assign(generator_);
+
+            if (encoder_valid_)
+            {
+               create_parity_row_table();
+
+               if (e_lfsr == mode_)
+               {
+                  create_lfsr_table();
+               }
+            }
+         }
 
-         encoder(const galois::field& gfield, const galois::field_polynomial& generator)
-         : encoder_valid_(code_length == gfield.size()),
+         /*
+            Encoder over a generator from the generator cache, sharing its
+            LFSR rows with every other encoder of the same code. A null or
+            mismatched generator gives an encoder reporting an
+            incompatible generator, as the constructor above would.
+         */
+         encoder(const galois::field& gfield,
+                 const generator_cache::generator_ptr& generator,
+                 const mode_t mode = e_lfsr)
+         : encoder_valid_((code_length == gfield.size()) &&
+                          (static_cast<unsigned long long>(std::numeric_limits<symbol_t>::max()) >= gfield.size())),
            field_(gfield),
-           generator_(generator)
-         {}
+           generator_(generator ? generator->polynomial() : galois::field_polynomial(gfield)),
+           fixed_generator_(gfield),
+           mode_(mode),
+           lfsr_rows_(0)
+         {
+            fixed_generator_.assign(generator_);
+
+            if (encoder_valid_)
+            {
+               create_parity_row_table();
+
+               if (e_lfsr == mode_)
+               {
+                  if (generator && (generator->fec_length() == fec_length) && !generator->lfsr_rows().empty())
+                  {
+                     lfsr_table_ = std::shared_ptr<const symbol_table>(generator, &generator->lfsr_rows());
+                     lfsr_rows_  = &(*lfsr_table_)[0];
+                  }
+                  else
+                     create_lfsr_table();
+               }
+            }
+         }
 
         ~encoder()
          {}
 
+         inline const galois::field& field() const
+         {
+            return field_;
+         }
+
          inline bool encode(block_type& rsblock) const
          {
-            if (!encoder_valid_)
+            const typename block_type::error_t error = encode_symbols(rsblock.data, rsblock.data + (code_length - fec_length));
+
+            if (block_type::e_no_error != error)
             {
-               rsblock.error = block_type::e_encoder_error0;
+               rsblock.error = error;
                return false;
             }
 
-            const galois::field_polynomial parities = msg_poly(rsblock) % generator_;
-            const galois::field_symbol     mask     = field_.mask();
+            return true;
+         }
 
-            if (parities.deg() == (fec_length - 1))
+         inline bool encode(const std::string& data, block_type& rsblock) const
+         {
+            std::string::const_iterator itr  = data.begin();
+            const galois::field_symbol  mask = field_.mask();
+
+            for (std::size_t i = 0; i < data_length; ++i, ++itr)
             {
-               for (std::size_t i = 0; i < fec_length; ++i)
+               rsblock.data[i] = static_cast<symbol_t>(static_cast<galois::field_symbol>(*itr) & mask);
+            }
+
+            return encode(rsblock);
+         }
+
+         /*
+            Encode count blocks. The status of each block is reported in
+            its error member exactly as encode() would, and the number of
+            successfully encoded blocks is returned.
+         */
+         inline std::size_t encode_batch(block_type* blocks, const std::size_t count) const
+         {
+            if (!encoder_valid_ || (e_lfsr != mode_) || (0 == lfsr_rows_))
+            {
+               std::size_t encoded = 0;
+
+               for (std::size_t b = 0; b < count; ++b)
                {
-                  rsblock.fec(i) = parities[fec_length - 1 - i].poly() & mask;
+                  if (encode(blocks[b]))
+                     ++encoded;
                }
+
+               return encoded;
             }
-            else
+
+            const symbol_t* data[batch_lanes];
+                  symbol_t* fec [batch_lanes];
+
+            for (std::size_t b = 0; b < count; b += batch_lanes)
             {
-               /*
-                  Note: Encoder should never branch here.
-                  Possible issues to look for:
-                  1. Generator polynomial degree is not equivelent to fec length
-                  2. Field and code length are not consistent.
+               const std::size_t lanes = std::min(batch_lanes, count - b);
 
-               */
-               rsblock.error = block_type::e_encoder_error1;
+               for (std::size_t l = 0; l < lanes; ++l)
+               {
+                  data[l] = blocks[b + l].data;
+                  fec [l] = blocks[b + l].data + (code_length - fec_length);
+               }
+
+               lfsr_encode_lanes(data, fec, lanes);
+            }
+
+            return count;
+         }
+
+         /*
+            Encode count codewords held in raw buffers. The data symbols of
+            codeword b are data[b * data_stride + i] and its fec symbols are
+            written to fec[b * fec_stride + i], in the same order as
+            block::fec(i). Returns the number of codewords encoded, which is
+            either count or zero (invalid encoder or generator).
+         */
+         inline std::size_t encode_batch(const symbol_t* data, const std::size_t data_stride,
+                                               symbol_t* fec,  const std::size_t fec_stride,
+                                         const std::size_t count) const
+         {
+            if (!encoder_valid_)
+               return 0;
+
+            if ((e_lfsr != mode_) || (0 == lfsr_rows_))
+            {
+               block_type rsblock;
+
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  std::copy(data + b * data_stride, data + b * data_stride + (code_length - fec_length), rsblock.data);
+
+                  if (!encode(rsblock))
+                     return 0;
+
+                  std::copy(rsblock.data + (code_length - fec_length), rsblock.data + code_length, fec + b * fec_stride);
+               }
+
+               return count;
+            }
+
+            const symbol_t* data_lanes[batch_lanes];
+                  symbol_t* fec_lanes [batch_lanes];
+
+            for (std::size_t b = 0; b < count; b += batch_lanes)
+            {
+               const std::size_t lanes = std::min(batch_lanes, count - b);
+
+               for (std::size_t l = 0; l < lanes; ++l)
+               {
+                  data_lanes[l] = data + (b + l) * data_stride;
+                  fec_lanes [l] = fec  + (b + l) * fec_stride;
+               }
+
+               lfsr_encode_lanes(data_lanes, fec_lanes, lanes);
+            }
+
+            return count;
+         }
+
+         /*
+            Encode directly between caller owned buffers: the data symbols
+            are read from data and the fec symbols written to parity, in
+            the same order as block::fec(i). Nothing is copied into a block,
+            so data may point straight into eg: an mmap'd file. A data span
+            shorter than data_length is encoded as a shortened codeword, ie:
+            preceded by virtual zero symbols. Returns false when the spans
+            are too long or parity is not fec_length long, or when
+            encode(block_type&) would have failed.
+         */
+         template <typename DataT, typename ParityT>
+         inline bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity) const
+         {
+            if (data.empty() || (data.size() > (code_length - fec_length)) || (parity.size() != fec_length))
+               return false;
+
+            return (block_type::e_no_error == encode_symbols(data.data(), parity.data(), data.size()));
+         }
+
+         /*
+            Punctured encode: as above, parity receiving only the
+            puncture.kept_count() symbols puncture keeps, in fec(i) order.
+         */
+         template <typename DataT, typename ParityT>
+         inline bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity, const puncture_mask& puncture) const
+         {
+            if (
+                 data.empty() || (data.size() > (code_length - fec_length)) ||
+                 (puncture.fec_length() != fec_length) || (parity.size() != puncture.kept_count())
+               )
+            {
                return false;
             }
 
+            galois::field_symbol full_parity[fec_length];
+
+            if (block_type::e_no_error != encode_symbols(data.data(), full_parity, data.size()))
+               return false;
+
+            puncture.compress(full_parity, parity.data());
+
             return true;
          }
 
-         inline bool encode(const std::string& data, block_type& rsblock) const
+         /*
+            Native encoding of a block of a code shortened from this one.
+            The virtual zero prefix leaves the LFSR state untouched, so only
+            the short_data_length symbols actually present are shifted in,
+            without building a natural length block.
+         */
+         template <std::size_t short_code_length, std::size_t short_data_length, typename T>
+         inline bool encode_shortened(block<short_code_length,fec_length,short_data_length,T>& rsblock) const
          {
-            std::string::const_iterator itr  = data.begin();
-            const galois::field_symbol  mask = field_.mask();
+            static_assert((short_code_length <= code_length) && (short_code_length > fec_length),
+                          "encode_shortened() - block must be shorter than the natural code");
 
-            for (std::size_t i = 0; i < data_length; ++i, ++itr)
+            const typename block_type::error_t error = encode_symbols(rsblock.data,
+                                                                      rsblock.data + short_data_length,
+                                                                      short_data_length);
+
+            if (block_type::e_no_error != error)
             {
-               rsblock.data[i] = static_cast<typename block_type::symbol_type>(*itr) & mask;
+               rsblock.error = static_cast<typename block<short_code_length,fec_length,short_data_length,T>::error_t>(error);
+               return false;
             }
 
-            return encode(rsblock);
+            return true;
+         }
+
+         /*
+            Incremental parity update. The code is linear, so replacing the
+            data symbol at position by new_symbol changes the parity by
+            (old_symbol ^ new_symbol) times the parity of a unit symbol at
+            that position, ie: x^(code_length - 1 - position) mod g(x). Those
+            rows are precomputed, so a small write costs fec_length multiplies
+            instead of a full encode(). parity is in block::fec(i) order.
+         */
+         template <typename ParityT, typename SymbolT>
+         inline bool update_parity(const utils::span<ParityT>& parity,
+                                   const std::size_t position,
+                                   const SymbolT old_symbol,
+                                   const SymbolT new_symbol) const
+         {
+            if (
+                 parity_row_table_.empty()              ||
+                 (parity.size() != fec_length)          ||
+                 (position >= (code_length - fec_length))
+               )
+            {
+               return false;
+            }
+
+            apply_parity_delta(parity.data(), position,
+                               static_cast<galois::field_symbol>(old_symbol) ^
+                               static_cast<galois::field_symbol>(new_symbol));
+
+            return true;
+         }
+
+         /*
+            Range variant: data symbols [position, position + count) change
+            from old_symbols to new_symbols.
+         */
+         template <typename ParityT, typename SymbolT>
+         inline bool update_parity(const utils::span<ParityT>& parity,
+                                   const std::size_t position,
+                                   const utils::span<SymbolT>& old_symbols,
+                                   const utils::span<SymbolT>& new_symbols) const
+         {
+            if (
+                 parity_row_table_.empty()                                   ||
+                 (parity.size() != fec_length)                               ||
+                 (old_symbols.size() != new_symbols.size())                  ||
+                 (position > (code_length - fec_length))                     ||
+                 (old_symbols.size() > ((code_length - fec_length) - position))
+               )
+            {
+               return false;
+            }
+
+            for (std::size_t i = 0; i < old_symbols.size(); ++i)
+            {
+               apply_parity_delta(parity.data(), position + i,
+                                  static_cast<galois::field_symbol>(old_symbols[i]) ^
+                                  static_cast<galois::field_symbol>(new_symbols[i]));
+            }
+
+            return true;
+         }
+
+         /*
+            Replace the data symbol at position of an encoded block by
+            new_symbol and bring its fec symbols up to date.
+         */
+         inline bool update_parity(block_type& rsblock,
+                                   const std::size_t position,
+                                   const symbol_t old_symbol,
+                                   const symbol_t new_symbol) const
+         {
+            utils::span<symbol_t> parity(rsblock.data + (code_length - fec_length), fec_length);
+
+            if (!update_parity(parity, position, old_symbol, new_symbol))
+            {
+               rsblock.error = encoder_valid_ ? block_type::e_encoder_error1 : block_type::e_encoder_error0;
+               return false;
+            }
+
+            rsblock.data[position] = new_symbol;
+
+            return true;
+         }
+
+         inline bool update_parity(block_type& rsblock,
+                                   const std::size_t position,
+                                   const utils::span<const symbol_t>& old_symbols,
+                                   const utils::span<const symbol_t>& new_symbols) const
+         {
+            utils::span<symbol_t> parity(rsblock.data + (code_length - fec_length), fec_length);
+
+            if (!update_parity(parity, position, old_symbols, new_symbols))
+            {
+               rsblock.error = encoder_valid_ ? block_type::e_encoder_error1 : block_type::e_encoder_error0;
+               return false;
+            }
+
+            std::copy(new_symbols.begin(), new_symbols.end(), rsblock.data + position);
+
+            return true;
+         }
+
+         inline mode_t mode() const
+         {
+            return mode_;
+         }
+
+         /*
+            Touch the field's and the encoder's tables from the calling
+            thread, optionally locking them in RAM, then encode zero blocks
+            through encode() and encode_batch(), so that the first real
+            codeword takes no page fault or cold miss. false when a lock
+            was refused.
+         */
+         inline bool warm_up(const bool lock = false) const
+         {
+            bool locked = field_.warm_up(lock);
+
+            if (lfsr_table_ && !lfsr_table_->empty())
+               locked = utils::prefault(&(*lfsr_table_)[0], lfsr_table_->size() * sizeof(galois::field_symbol), lock) && locked;
+
+            if (!parity_row_table_.empty())
+               locked = utils::prefault(&parity_row_table_[0], parity_row_table_.size() * sizeof(galois::field_symbol), lock) && locked;
+
+            if (!encoder_valid_)
+               return locked;
+
+            std::vector<block_type> blocks(batch_lanes);
+
+            for (std::size_t b = 0; b < blocks.size(); ++b)
+            {
+               blocks[b].reset(0);
+            }
+
+            encode(blocks[0]);
+            encode_batch(&blocks[0], blocks.size());
+
+            return locked;
          }
 
       private:
@@ -109,94 +483,277 @@ namespace schifra
          encoder(const encoder& enc);
          encoder& operator=(const encoder& enc);
 
-         inline galois::field_polynomial msg_poly(const block_type& rsblock) const
+         /*
+            Note: When data holds fewer than data_length symbols the message
+                  is simply truncated above them, the missing leading terms
+                  of a shortened code being zero.
+         */
+         template <typename DataT>
+         inline void load_message(const DataT* data, message_polynomial& message,
+                                  const std::size_t length = code_length - fec_length) const
+         {
+            message.clear();
+            message.resize(fec_length + length);
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               message[fec_length + length - 1 - i] = static_cast<galois::field_symbol>(data[i]);
+            }
+         }
+
+         void create_parity_row_table()
          {
-            galois::field_polynomial message(field_, code_length);
+            /*
+               Note: Row p holds x^(code_length - 1 - p) mod g(x) in fec(i)
+                     order. Starting from x^fec_length mod g(x), for the last
+                     data position, each row is the previous one times x.
+            */
+            if (fixed_generator_.deg() != static_cast<int>(fec_length))
+               return;
+
+            const galois::field_symbol leading = fixed_generator_[fec_length];
+
+            galois::field_symbol remainder[fec_length];
 
-            for (std::size_t i = fec_length; i < code_length; ++i)
+            for (std::size_t j = 0; j < fec_length; ++j)
             {
-               message[i] = rsblock.data[code_length - 1 - i];
+               remainder[j] = field_.div(fixed_generator_[j], leading);
             }
 
-            return message;
+            parity_row_table_.resize((code_length - fec_length) * fec_length);
+
+            for (std::size_t p = (code_length - fec_length); p > 0; --p)
+            {
+               galois::field_symbol* row = &parity_row_table_[(p - 1) * fec_length];
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  row[i] = remainder[fec_length - 1 - i];
+               }
+
+               const galois::field_symbol q = field_.div(remainder[fec_length - 1], leading);
+
+               for (std::size_t j = fec_length - 1; j > 0; --j)
+               {
+                  remainder[j] = remainder[j - 1] ^ field_.mul(q, fixed_generator_[j]);
+               }
+
+               remainder[0] = field_.mul(q, fixed_generator_[0]);
+            }
          }
 
-         const bool                     encoder_valid_;
-         const galois::field&           field_;
-         const galois::field_polynomial generator_;
-      };
+         template <typename ParityT>
+         inline void apply_parity_delta(ParityT* parity, const std::size_t position, galois::field_symbol delta) const
+         {
+            delta &= field_.mask();
 
-      template <std::size_t code_length,
-                std::size_t fec_length ,
-                std::size_t data_length    = code_length - fec_length,
-                std::size_t natural_length = 255, // Needs to be in-sync with field size
-                std::size_t padding_length = natural_length - data_length - fec_length>
-      class shortened_encoder
-      {
-      public:
+            if (0 == delta)
+               return;
 
-         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
-         typedef block<code_length,fec_length> block_type;
-         typedef block<natural_length,fec_length> short_block_t;
+            const galois::field_symbol* row = &parity_row_table_[position * fec_length];
 
-         shortened_encoder(const galois::field& gfield,
-                           const galois::field_polynomial& generator)
-         : encoder_(gfield, generator)
-         {}
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               parity[i] = static_cast<ParityT>(static_cast<galois::field_symbol>(parity[i]) ^ field_.mul(delta, row[i]));
+            }
+         }
 
-         inline bool encode(block_type& rsblock) const
+         void create_lfsr_table()
          {
-            short_block_t block;
+            /*
+               Note: The table is left empty when the generator degree is
+                     not fec_length, encode() then reports the same
+                     error as the division would.
+            */
+            if (fixed_generator_.deg() != static_cast<int>(fec_length))
+               return;
 
-            std::fill_n(&block[0], padding_length, typename block_type::symbol_type(0));
+            std::shared_ptr<symbol_table> table = std::make_shared<symbol_table>();
 
-            for (std::size_t i = 0; i < data_length; ++i)
+            make_lfsr_rows(field_, fixed_generator_, fec_length, *table);
+
+            lfsr_table_ = table;
+            lfsr_rows_  = &(*table)[0];
+         }
+
+         template <typename DataT, typename ParityT>
+         inline typename block_type::error_t encode_symbols(const DataT* data, ParityT* fec,
+                                                            const std::size_t length = code_length - fec_length) const
+         {
+            if (!encoder_valid_)
+               return block_type::e_encoder_error0;
+
+            if (e_lfsr == mode_)
             {
-               block.data[padding_length + i] = rsblock.data[i];
+               if ((0 == lfsr_rows_))
+                  return block_type::e_encoder_error1;
+
+               const DataT* data_lanes[1] = { data };
+                 ParityT*   fec_lanes [1] = { fec  };
+
+               lfsr_encode_lanes(data_lanes, fec_lanes, 1, length);
+
+               return block_type::e_no_error;
             }
 
-            if (encoder_.encode(block))
+            message_polynomial message(field_);
+            parity_polynomial  parities(field_);
+
+            load_message(data, message, length);
+
+            const galois::field_symbol mask = field_.mask();
+
+            if (
+                 message.mod_into(fixed_generator_, parities) &&
+                 (parities.deg() == (fec_length - 1))
+               )
             {
                for (std::size_t i = 0; i < fec_length; ++i)
                {
-                  rsblock.fec(i) = block.fec(i);
+                  fec[i] = static_cast<ParityT>(parities[fec_length - 1 - i] & mask);
                }
-
-               return true;
             }
             else
-               return false;
+            {
+               /*
+                  Note: Encoder should never branch here.
+                  Possible issues to look for:
+                  1. Generator polynomial degree is not equivelent to fec length
+                  2. Field and code length are not consistent.
+
+               */
+               return block_type::e_encoder_error1;
+            }
+
+            return block_type::e_no_error;
          }
 
-         inline bool encode(const std::string& data, block_type& rsblock) const
+         /*
+            Run the LFSR of up to batch_lanes codewords in lockstep. The
+            registers of different codewords are independent, so their
+            table lookups overlap instead of serialising on the feedback
+            symbol of a single register. Each register is double buffered
+            and preceded by a zero term, so that the shift and the row xor
+            form one dependency-free loop of exactly fec_length steps.
+         */
+         template <typename DataT, typename ParityT>
+         inline void lfsr_encode_lanes(const DataT* const data[],
+                                             ParityT* const fec [],
+                                       const std::size_t lanes,
+                                       const std::size_t length = code_length - fec_length) const
          {
-            short_block_t block;
+            const galois::field_symbol  mask  = field_.mask();
+            const galois::field_symbol* table = lfsr_rows_;
 
-            std::fill_n(&block[0], padding_length, typename block_type::symbol_type(0));
+            galois::field_symbol parity[2][batch_lanes][fec_length + 1];
 
-            for (std::size_t i = 0; i < data_length; ++i)
+            for (std::size_t l = 0; l < lanes; ++l)
             {
-               block.data[padding_length + i] = data[i];
+               std::fill_n(parity[0][l], fec_length + 1, galois::field_symbol(0));
+               parity[1][l][0] = 0;
             }
 
-            if (encoder_.encode(block))
+            std::size_t current = 0;
+
+            for (std::size_t i = 0; i < length; ++i)
             {
-               for (std::size_t i = 0; i < code_length; ++i)
+               for (std::size_t l = 0; l < lanes; ++l)
                {
-                  rsblock.data[i] = block.data[padding_length + i];
+                  const galois::field_symbol* reg = parity[current][l];
+                        galois::field_symbol* nxt = parity[current ^ 1][l];
+
+                  const galois::field_symbol* row = table + ((static_cast<galois::field_symbol>(data[l][i]) & mask) ^ reg[fec_length]) * fec_length;
+
+                  for (std::size_t j = 0; j < fec_length; ++j)
+                  {
+                     nxt[j + 1] = reg[j] ^ row[j];
+                  }
                }
 
-               return true;
+               current ^= 1;
             }
-            else
-               return false;
+
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  fec[l][i] = static_cast<ParityT>(parity[current][l][fec_length - i]);
+               }
+            }
+         }
+
+         /* Cache line aligned, from the table memory hook */
+         typedef std::vector<galois::field_symbol, utils::table_allocator<galois::field_symbol> > table_type;
+
+         const bool                          encoder_valid_;
+         const galois::field&                field_;
+         const galois::field_polynomial      generator_;
+         generator_polynomial                fixed_generator_;
+         const mode_t                        mode_;
+         std::shared_ptr<const symbol_table> lfsr_table_;  // own, or a cached generator's
+         const galois::field_symbol*         lfsr_rows_;
+         table_type                          parity_row_table_;
+      };
+
+      template <std::size_t code_length,
+                std::size_t fec_length ,
+                std::size_t data_length    = code_length - fec_length,
+                std::size_t natural_length = 255, // Needs to be in-sync with field size
+                std::size_t padding_length = natural_length - data_length - fec_length>
+      class shortened_encoder
+      {
+      public:
+
+         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
+         typedef block<code_length,fec_length> block_type;
+
+         typedef encoder<natural_length,fec_length> natural_encoder_type;
+
+         shortened_encoder(const galois::field& gfield,
+                           const galois::field_polynomial& generator,
+                           const typename natural_encoder_type::mode_t mode = natural_encoder_type::e_lfsr)
+         : encoder_(gfield, generator, mode)
+         {}
+
+         /*
+            Note: The block is encoded natively by the natural encoder, the
+                  padding_length virtual zeros are never materialised.
+         */
+         inline bool encode(block_type& rsblock) const
+         {
+            return encoder_.encode_shortened(rsblock);
+         }
+
+         inline bool encode(const std::string& data, block_type& rsblock) const
+         {
+            /* natural_length is the field size, ie: the symbol mask */
+            for (std::size_t i = 0; i < data_length; ++i)
+            {
+               rsblock.data[i] = static_cast<galois::field_symbol>(data[i]) & static_cast<galois::field_symbol>(natural_length);
+            }
+
+            return encoder_.encode_shortened(rsblock);
          }
 
       private:
 
-         const encoder<natural_length,fec_length> encoder_;
+         const natural_encoder_type encoder_;
       };
 
+      #if defined(SCHIFRA_EXTERN_TEMPLATES)
+
+      /* Compiled into the schifra_dna_storage library, see schifra_reed_solomon_instantiations.hpp */
+      #define SCHIFRA_EXTERN_ENCODER(n, fec) extern template class encoder<n, fec>;
+      #define SCHIFRA_EXTERN_SHORTENED_ENCODER(n, fec) extern template class shortened_encoder<n, fec>;
+
+      SCHIFRA_RS_COMMON_CODES(SCHIFRA_EXTERN_ENCODER)
+      SCHIFRA_RS_COMMON_SHORTENED_CODES(SCHIFRA_EXTERN_SHORTENED_ENCODER)
+
+      #undef SCHIFRA_EXTERN_ENCODER
+      #undef SCHIFRA_EXTERN_SHORTENED_ENCODER
+
+      #endif
+
    } // namespace reed_solomon
 
 } // namespace schifra
@@ -0,0 +1,338 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_EXECUTION_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_EXECUTION_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+
+
+/*
+   Execution policy overloads of the batch APIs, eg:
+
+      encode_batch(std::execution::par_unseq, encoder, first, last)
+
+   Only the policy types of <execution> are used, never its algorithms,
+   so neither OpenMP nor the parallel algorithms' runtime (TBB with
+   libstdc++) is needed. SCHIFRA_EXECUTION_POLICIES is defined when the
+   standard library has them.
+*/
+#if defined(__cpp_lib_execution) && !defined(SCHIFRA_NO_EXECUTION_POLICIES)
+#define SCHIFRA_EXECUTION_POLICIES
+#endif
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+         /*
+            Run function(begin,end) over [0,count) on up to one thread per
+            hardware thread, grain items at the least per thread, the
+            calling thread taking the first range. Returns the sum of what
+            the ranges returned, rethrowing the first exception thrown.
+         */
+         template <typename Function>
+         inline std::size_t parallel_ranges(const std::size_t count, const std::size_t grain, Function function)
+         {
+            const std::size_t hardware_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            const std::size_t threads = std::max<std::size_t>(1, std::min(hardware_threads, count / std::max<std::size_t>(1, grain)));
+
+            if (threads < 2)
+               return function(0, count);
+
+            std::vector<std::size_t> results(threads, 0);
+            std::exception_ptr       error;
+            std::mutex               error_mutex;
+
+            const auto run = [&](const std::size_t t)
+                             {
+                                try
+                                {
+                                   results[t] = function((count * (t    )) / threads,
+                                                         (count * (t + 1)) / threads);
+                                }
+                                catch (...)
+                                {
+                                   std::lock_guard<std::mutex> lock(error_mutex);
+
+                                   if (!error)
+                                      error = std::current_exception();
+                                }
+                             };
+
+            std::vector<std::thread> workers;
+
+            for (std::size_t t = 1; t < threads; ++t)
+            {
+               workers.push_back(std::thread(run, t));
+            }
+
+            run(0);
+
+            for (std::size_t t = 0; t < workers.size(); ++t)
+            {
+               workers[t].join();
+            }
+
+            if (error)
+               std::rethrow_exception(error);
+
+            std::size_t total = 0;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+               total += results[t];
+            }
+
+            return total;
+         }
+
+      } // namespace reed_solomon::details
+
+      #if defined(SCHIFRA_EXECUTION_POLICIES)
+
+      /*
+         How a call under policy runs:
+
+            seq       : on the calling thread, block by block
+            unseq     : on the calling thread, through the batch kernels
+            par       : on several threads, block by block
+            par_unseq : on several threads, each through the batch kernels
+
+         The batch kernels are the lockstep SIMD paths of encode_batch()
+         and decode_batch(). unseq exists from C++20 on.
+      */
+      template <typename Policy>
+      struct execution_traits
+      {
+         static constexpr bool parallel   = false;
+         static constexpr bool vectorized = false;
+      };
+
+      template <>
+      struct execution_traits<std::execution::parallel_policy>
+      {
+         static constexpr bool parallel   = true;
+         static constexpr bool vectorized = false;
+      };
+
+      template <>
+      struct execution_traits<std::execution::parallel_unsequenced_policy>
+      {
+         static constexpr bool parallel   = true;
+         static constexpr bool vectorized = true;
+      };
+
+      #if (__cpp_lib_execution >= 201902L)
+      template <>
+      struct execution_traits<std::execution::unsequenced_policy>
+      {
+         static constexpr bool parallel   = false;
+         static constexpr bool vectorized = true;
+      };
+      #endif
+
+      /* R when Policy is one of the std::execution policies */
+      template <typename Policy, typename R>
+      using enable_if_execution_policy =
+         typename std::enable_if<std::is_execution_policy<typename std::decay<Policy>::type>::value,R>::type;
+
+      template <typename Policy>
+      using execution_traits_of = execution_traits<typename std::decay<Policy>::type>;
+
+      /* Blocks per thread below which parallel policies stay on the caller */
+      constexpr std::size_t execution_grain = 256;
+
+      namespace details
+      {
+         /* Blocks [begin,end) of blocks, through the batch kernels when vectorized */
+         template <bool vectorized, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+         inline std::size_t encode_range(const encoder<code_length,fec_length,data_length>& encoder,
+                                         block<code_length,fec_length>* blocks,
+                                         const std::size_t begin, const std::size_t end)
+         {
+            if (vectorized)
+               return encoder.encode_batch(blocks + begin, end - begin);
+
+            std::size_t encoded = 0;
+
+            for (std::size_t b = begin; b < end; ++b)
+            {
+               if (encoder.encode(blocks[b]))
+                  ++encoded;
+            }
+
+            return encoded;
+         }
+
+         template <bool vectorized, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+         inline std::size_t decode_range(const decoder<code_length,fec_length,data_length>& decoder,
+                                         block<code_length,fec_length>* blocks,
+                                         const std::size_t begin, const std::size_t end)
+         {
+            if (vectorized)
+               return decoder.decode_batch(blocks + begin, end - begin);
+
+            std::size_t decoded = 0;
+
+            for (std::size_t b = begin; b < end; ++b)
+            {
+               if (decoder.decode(blocks[b]))
+                  ++decoded;
+            }
+
+            return decoded;
+         }
+
+      } // namespace reed_solomon::details
+
+      /*
+         Encode the blocks of [first,last), see encoder::encode_batch().
+         Returns the number of blocks encoded.
+      */
+      template <typename Policy, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+      inline enable_if_execution_policy<Policy,std::size_t>
+      encode_batch(Policy&&, const encoder<code_length,fec_length,data_length>& encoder,
+                   block<code_length,fec_length>* first, block<code_length,fec_length>* last)
+      {
+         typedef execution_traits_of<Policy> traits;
+
+         const std::size_t count = static_cast<std::size_t>(last - first);
+
+         const auto range = [&encoder,first](const std::size_t begin, const std::size_t end)
+                            {
+                               return details::encode_range<traits::vectorized>(encoder, first, begin, end);
+                            };
+
+         if (traits::parallel)
+            return details::parallel_ranges(count, execution_grain, range);
+         else
+            return range(0, count);
+      }
+
+      /*
+         Decode the blocks of [first,last), see decoder::decode_batch().
+         Returns the number of blocks decoded successfully.
+      */
+      template <typename Policy, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+      inline enable_if_execution_policy<Policy,std::size_t>
+      decode_batch(Policy&&, const decoder<code_length,fec_length,data_length>& decoder,
+                   block<code_length,fec_length>* first, block<code_length,fec_length>* last)
+      {
+         typedef execution_traits_of<Policy> traits;
+
+         const std::size_t count = static_cast<std::size_t>(last - first);
+
+         const auto range = [&decoder,first](const std::size_t begin, const std::size_t end)
+                            {
+                               return details::decode_range<traits::vectorized>(decoder, first, begin, end);
+                            };
+
+         if (traits::parallel)
+            return details::parallel_ranges(count, execution_grain, range);
+         else
+            return range(0, count);
+      }
+
+      /*
+         As above on the workers of executor, waiting for the batch. The
+         parallel policies split it as codec_executor::submit_range()
+         does, the others run it as one piece on a single worker.
+      */
+      template <typename Policy, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+      inline enable_if_execution_policy<Policy,std::size_t>
+      encode_batch(Policy&&, codec_executor<code_length,fec_length,data_length>& executor,
+                   block<code_length,fec_length>* first, block<code_length,fec_length>* last)
+      {
+         typedef execution_traits_of<Policy> traits;
+         typedef typename codec_executor<code_length,fec_length,data_length>::context context;
+
+         const std::size_t count = static_cast<std::size_t>(last - first);
+
+         if (traits::parallel)
+            return executor.submit_range(count,
+                                         [first](const context& ctx, const std::size_t begin, const std::size_t end)
+                                         {
+                                            return details::encode_range<traits::vectorized>(ctx.encoder, first, begin, end);
+                                         }).get();
+         else
+            return executor.submit_range(1,
+                                         [first,count](const context& ctx, const std::size_t, const std::size_t)
+                                         {
+                                            return details::encode_range<traits::vectorized>(ctx.encoder, first, 0, count);
+                                         }).get();
+      }
+
+      template <typename Policy, std::size_t code_length, std::size_t fec_length, std::size_t data_length>
+      inline enable_if_execution_policy<Policy,std::size_t>
+      decode_batch(Policy&&, codec_executor<code_length,fec_length,data_length>& executor,
+                   block<code_length,fec_length>* first, block<code_length,fec_length>* last)
+      {
+         typedef execution_traits_of<Policy> traits;
+         typedef typename codec_executor<code_length,fec_length,data_length>::context context;
+
+         const std::size_t count = static_cast<std::size_t>(last - first);
+
+         if (traits::parallel)
+            return executor.submit_range(count,
+                                         [first](const context& ctx, const std::size_t begin, const std::size_t end)
+                                         {
+                                            return details::decode_range<traits::vectorized>(ctx.decoder, first, begin, end);
+                                         }).get();
+         else
+            return executor.submit_range(1,
+                                         [first,count](const context& ctx, const std::size_t, const std::size_t)
+                                         {
+                                            return details::decode_range<traits::vectorized>(ctx.decoder, first, 0, count);
+                                         }).get();
+      }
+
+      #endif
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
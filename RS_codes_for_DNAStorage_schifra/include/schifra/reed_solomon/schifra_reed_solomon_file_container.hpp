@@ -0,0 +1,2131 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_CONTAINER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_CONTAINER_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "schifra_reed_solomon_decoder.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_file_decoder.hpp"
+#include "schifra_reed_solomon_file_encoder.hpp"
+#include "schifra_reed_solomon_parallel_file_codec.hpp"
+#include "schifra/utils/schifra_compression.hpp"
+#include "schifra/utils/schifra_crc.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Seekable container for file_encoder style output. The encoded
+         data is cut into chunks of chunk_blocks codewords, each laid out
+         exactly as file_encoder lays out a whole file, and is preceded by
+         a header and a chunk index. All fields are little endian:
+
+            header (64 bytes)
+               magic "SCHIFRAC", version, code_length, fec_length,
+               data_length, symbol bits, primitive polynomial (bit i is
+               the x^i coefficient), generator initial index, chunk_blocks
+               (all 32 bit), data size, chunk count (64 bit), the CRC-32
+               of the preceding bytes and the CRC-32 of the index.
+
+            index (16 bytes per chunk)
+               file offset (64 bit), encoded size and CRC-32 of the
+               encoded chunk (32 bit).
+
+         The index may be followed by spare, zeroed entries for a
+         container to grow into, the first chunk then starting past them.
+
+         In a compressed container (version 2) each chunk of
+         chunk_blocks * data_length input bytes is compressed on its own,
+         and its compression::compress() payload encoded in its place, so
+         every chunk starts on a codeword of its own. The payload's size
+         follows from the chunk's encoded size.
+
+         A chunk whose CRC checks out is copied without being decoded.
+      */
+      namespace container
+      {
+
+         static constexpr char          magic[8]    = {'S','C','H','I','F','R','A','C'};
+         static constexpr std::uint32_t version            = 1;
+         static constexpr std::uint32_t compressed_version = 2;
+         static constexpr std::size_t   header_size = 64;
+         static constexpr std::size_t   entry_size  = 16;
+
+         struct header
+         {
+            std::uint32_t code_length;
+            std::uint32_t fec_length;
+            std::uint32_t data_length;
+            std::uint32_t symbol_bits;
+            std::uint32_t primitive_polynomial;
+            std::uint32_t gen_initial_index;
+            std::uint32_t chunk_blocks;
+            std::uint64_t data_size;
+            std::uint64_t chunk_count;
+            bool          compressed;
+         };
+
+         struct chunk_entry
+         {
+            std::uint64_t offset;
+            std::uint32_t size;
+            std::uint32_t crc;
+         };
+
+         inline std::uint32_t primitive_polynomial(const galois::field& field)
+         {
+            std::uint32_t polynomial = 0;
+
+            for (unsigned int i = 0; i <= field.pwr(); ++i)
+            {
+               if (0 != field.prim_poly_term(i))
+                  polynomial |= (std::uint32_t(1) << i);
+            }
+
+            return polynomial;
+         }
+
+         /* Standard (zlib) CRC-32, folded with PCLMULQDQ/PMULL where available */
+         inline const schifra::crc32& crc_module()
+         {
+            static const schifra::crc32 module(schifra::crc32::zlib_key, 0xFFFFFFFF, schifra::crc32::e_hardware);
+
+            return module;
+         }
+
+         inline std::uint32_t crc(const unsigned char* data, const std::size_t size)
+         {
+            return static_cast<std::uint32_t>(crc_module().process(0xFFFFFFFF, data, size) ^ 0xFFFFFFFF);
+         }
+
+         inline void store(unsigned char* buffer, const std::uint64_t value, const std::size_t bytes)
+         {
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+               buffer[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+            }
+         }
+
+         inline std::uint64_t load(const unsigned char* buffer, const std::size_t bytes)
+         {
+            std::uint64_t value = 0;
+
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+               value |= static_cast<std::uint64_t>(buffer[i]) << (8 * i);
+            }
+
+            return value;
+         }
+
+         inline void store_entry(unsigned char* buffer, const chunk_entry& entry)
+         {
+            store(buffer     , entry.offset, 8);
+            store(buffer +  8, entry.size  , 4);
+            store(buffer + 12, entry.crc   , 4);
+         }
+
+         inline chunk_entry load_entry(const unsigned char* buffer)
+         {
+            chunk_entry entry;
+
+            entry.offset = load(buffer, 8);
+            entry.size   = static_cast<std::uint32_t>(load(buffer +  8, 4));
+            entry.crc    = static_cast<std::uint32_t>(load(buffer + 12, 4));
+
+            return entry;
+         }
+
+         inline bool operator==(const header& h0, const header& h1)
+         {
+            return (h0.code_length          == h1.code_length         ) &&
+                   (h0.fec_length           == h1.fec_length          ) &&
+                   (h0.data_length          == h1.data_length         ) &&
+                   (h0.symbol_bits          == h1.symbol_bits         ) &&
+                   (h0.primitive_polynomial == h1.primitive_polynomial) &&
+                   (h0.gen_initial_index    == h1.gen_initial_index   ) &&
+                   (h0.chunk_blocks         == h1.chunk_blocks        ) &&
+                   (h0.data_size            == h1.data_size           ) &&
+                   (h0.chunk_count          == h1.chunk_count         ) &&
+                   (h0.compressed           == h1.compressed          );
+         }
+
+         /* The input bytes of a chunk */
+         inline std::uint64_t chunk_data_size(const header& h, const std::size_t chunk_index)
+         {
+            const std::uint64_t chunk_data = static_cast<std::uint64_t>(h.chunk_blocks) * h.data_length;
+
+            return std::min(chunk_data, h.data_size - chunk_index * chunk_data);
+         }
+
+         /* Encoded size of data bytes, as file_encoder lays them out */
+         inline std::uint64_t encoded_size(const header& h, const std::uint64_t data)
+         {
+            const std::uint64_t remainder = data % h.data_length;
+
+            return (data / h.data_length) * h.code_length + ((remainder > 0) ? (remainder + h.fec_length) : 0);
+         }
+
+         /* The data bytes of an encoded size, 0 when no data encodes to it */
+         inline std::uint64_t data_size(const header& h, const std::uint64_t encoded)
+         {
+            const std::uint64_t remainder = encoded % h.code_length;
+
+            if ((remainder > 0) && (remainder <= h.fec_length))
+               return 0;
+
+            return (encoded / h.code_length) * h.data_length + ((remainder > 0) ? (remainder - h.fec_length) : 0);
+         }
+
+         /* Encoded size of an uncompressed chunk */
+         inline std::uint64_t chunk_size(const header& h, const std::size_t chunk_index)
+         {
+            return encoded_size(h, chunk_data_size(h, chunk_index));
+         }
+
+         /* Whether size is an encoded size chunk chunk_index may have */
+         inline bool valid_chunk_size(const header& h, const std::size_t chunk_index, const std::uint64_t size)
+         {
+            if (!h.compressed)
+               return (size == chunk_size(h, chunk_index));
+
+            const std::uint64_t payload = data_size(h, size);
+
+            return (payload > 0) && (payload <= compression::payload_bound(static_cast<std::size_t>(chunk_data_size(h, chunk_index))));
+         }
+
+         /*
+            The number of entries the index has room for, spare entries
+            included, as given by the offset of the first chunk.
+         */
+         inline std::size_t index_capacity(const std::vector<chunk_entry>& index)
+         {
+            if (
+                 !index.empty()                                               &&
+                 (index[0].offset >= (header_size + index.size() * entry_size)) &&
+                 (0 == ((index[0].offset - header_size) % entry_size))
+               )
+            {
+               return static_cast<std::size_t>((index[0].offset - header_size) / entry_size);
+            }
+
+            return index.size();
+         }
+
+         /*
+            The number of leading chunks the index records as written. The
+            encoder fills in an entry once its chunk has been flushed, and a
+            written entry follows on from the previous chunk with the size
+            that the header implies.
+         */
+         inline std::size_t written_chunks(const header& h, const std::vector<chunk_entry>& index)
+         {
+            std::uint64_t offset = header_size + index_capacity(index) * entry_size;
+
+            for (std::size_t i = 0; i < index.size(); ++i)
+            {
+               if ((index[i].offset != offset) || !valid_chunk_size(h, i, index[i].size))
+                  return i;
+
+               offset += index[i].size;
+            }
+
+            return index.size();
+         }
+
+         inline void write_index(const header& h,
+                                 const std::vector<chunk_entry>& index,
+                                 std::vector<unsigned char>& buffer)
+         {
+            buffer.assign(header_size + index.size() * entry_size, 0);
+
+            unsigned char* entries = &buffer[header_size];
+
+            for (std::size_t i = 0; i < index.size(); ++i)
+            {
+               store_entry(entries + i * entry_size, index[i]);
+            }
+
+            std::memcpy(&buffer[0], magic, sizeof(magic));
+
+            store(&buffer[ 8], h.compressed ? compressed_version : version, 4);
+            store(&buffer[12], h.code_length         , 4);
+            store(&buffer[16], h.fec_length          , 4);
+            store(&buffer[20], h.data_length         , 4);
+            store(&buffer[24], h.symbol_bits         , 4);
+            store(&buffer[28], h.primitive_polynomial, 4);
+            store(&buffer[32], h.gen_initial_index   , 4);
+            store(&buffer[36], h.chunk_blocks        , 4);
+            store(&buffer[40], h.data_size           , 8);
+            store(&buffer[48], h.chunk_count         , 8);
+            store(&buffer[56], crc(&buffer[0], 56), 4);
+            store(&buffer[60], crc(entries, index.size() * entry_size), 4);
+         }
+
+         /*
+            Checkpoint: overwrite the index entries [first,last) in place.
+            The index CRC is only rewritten with the complete index.
+         */
+         inline void write_entries(std::ostream& stream,
+                                   const std::vector<chunk_entry>& index,
+                                   const std::size_t first,
+                                   const std::size_t last)
+         {
+            if (first >= last)
+               return;
+
+            std::vector<unsigned char> buffer((last - first) * entry_size);
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+               store_entry(&buffer[(i - first) * entry_size], index[i]);
+            }
+
+            stream.seekp(static_cast<std::streamoff>(header_size + first * entry_size));
+            stream.write(reinterpret_cast<const char*>(&buffer[0]), static_cast<std::streamsize>(buffer.size()));
+         }
+
+         /*
+            Random access source of the bytes of a container, eg: a local
+            file or an object in object storage. Reading several ranges in
+            one call lets a remote source fetch them concurrently, and
+            prefetch() hints at ranges about to be read (their data left
+            null), which a source may start fetching. Sources are called
+            from one thread at a time unless they state otherwise.
+         */
+         class range_reader
+         {
+         public:
+
+            struct range
+            {
+               std::uint64_t  offset;
+               std::size_t    size;
+               unsigned char* data;
+            };
+
+            virtual ~range_reader()
+            {}
+
+            virtual bool read(const std::uint64_t offset, const std::size_t size, unsigned char* data) = 0;
+
+            virtual bool read(const range* ranges, const std::size_t count)
+            {
+               for (std::size_t i = 0; i < count; ++i)
+               {
+                  if (!read(ranges[i].offset, ranges[i].size, ranges[i].data))
+                     return false;
+               }
+
+               return true;
+            }
+
+            virtual void prefetch(const range*, const std::size_t)
+            {}
+         };
+
+         /* range_reader of a local file, safe to call from several threads */
+         class file_range_reader : public range_reader
+         {
+         public:
+
+            explicit file_range_reader(const std::string& file_name)
+            : stream_(file_name.c_str(), std::ios::binary)
+            {}
+
+            inline bool valid() const
+            {
+               return stream_.is_open();
+            }
+
+            using range_reader::read;
+
+            bool read(const std::uint64_t offset, const std::size_t size, unsigned char* data)
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               stream_.clear();
+               stream_.seekg(static_cast<std::streamoff>(offset));
+               stream_.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+
+               return !stream_.fail();
+            }
+
+         private:
+
+            std::ifstream stream_;
+            std::mutex    mutex_;
+         };
+
+         /*
+            Bounded cache of the ranges read through another range_reader,
+            eg: the chunks of a remote container, keeping up to capacity
+            bytes, least recently used evicted first. A range is cached
+            under its offset and served again only for the same size.
+
+            prefetch() hands ranges to a thread of the cache, which reads
+            them through the source while the caller decodes, a read of a
+            range being fetched waiting for it rather than reading it
+            twice. The source is then called from two threads at once, so
+            it must be safe to (file_range_reader and http_range_reader
+            are).
+         */
+         class caching_range_reader : public range_reader
+         {
+         public:
+
+            static constexpr std::size_t default_capacity = 64 * 1024 * 1024;
+
+            explicit caching_range_reader(range_reader& source, const std::size_t capacity = default_capacity)
+            : source_(source),
+              capacity_(capacity),
+              cached_(0),
+              stop_(false),
+              hits_(0),
+              misses_(0),
+              prefetched_(0),
+              fetch_nanoseconds_(0),
+              fetched_ranges_(0)
+            {
+               prefetcher_ = std::thread([this]() { run(); });
+            }
+
+           ~caching_range_reader()
+            {
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  stop_ = true;
+               }
+
+               wake_.notify_all();
+               prefetcher_.join();
+            }
+
+            using range_reader::read;
+
+            bool read(const std::uint64_t offset, const std::size_t size, unsigned char* data)
+            {
+               const range r = { offset, size, data };
+
+               return read(&r, 1);
+            }
+
+            bool read(const range* ranges, const std::size_t count)
+            {
+               std::vector<range> missing;
+
+               {
+                  std::unique_lock<std::mutex> lock(mutex_);
+
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     /* A range being prefetched is waited for */
+                     wake_.wait(lock, [&]() { return 0 == in_flight_.count(ranges[i].offset); });
+
+                     if (lookup(ranges[i]))
+                        ++hits_;
+                     else
+                     {
+                        missing.push_back(ranges[i]);
+                        ++misses_;
+                     }
+                  }
+               }
+
+               if (missing.empty())
+                  return true;
+
+               if (!fetch(&missing[0], missing.size()))
+                  return false;
+
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               for (std::size_t i = 0; i < missing.size(); ++i)
+               {
+                  insert(missing[i].offset, missing[i].data, missing[i].size);
+               }
+
+               return true;
+            }
+
+            void prefetch(const range* ranges, const std::size_t count)
+            {
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  for (std::size_t i = 0; i < count; ++i)
+                  {
+                     if (
+                          (ranges[i].size <= capacity_)       &&
+                          (0 == entries_.count(ranges[i].offset)) &&
+                          (0 == in_flight_.count(ranges[i].offset))
+                        )
+                     {
+                        in_flight_[ranges[i].offset] = ranges[i].size;
+                        pending_.push_back(ranges[i]);
+                     }
+                  }
+               }
+
+               wake_.notify_all();
+            }
+
+            inline std::size_t hits() const
+            {
+               return hits_.load(std::memory_order_relaxed);
+            }
+
+            inline std::size_t misses() const
+            {
+               return misses_.load(std::memory_order_relaxed);
+            }
+
+            inline std::size_t prefetched() const
+            {
+               return prefetched_.load(std::memory_order_relaxed);
+            }
+
+            /*
+               Wall time the source took per range read through it, ranges
+               read together sharing the time of their call, 0 before the
+               first read.
+            */
+            inline double seconds_per_range() const
+            {
+               const std::size_t ranges = fetched_ranges_.load(std::memory_order_relaxed);
+
+               return (0 == ranges) ? 0.0 : (static_cast<double>(fetch_nanoseconds_.load(std::memory_order_relaxed)) / 1e9) / ranges;
+            }
+
+         private:
+
+            caching_range_reader(const caching_range_reader&);
+            caching_range_reader& operator=(const caching_range_reader&);
+
+            struct entry
+            {
+               std::vector<unsigned char>           data;
+               std::list<std::uint64_t>::iterator   position;
+            };
+
+            bool fetch(range* ranges, const std::size_t count)
+            {
+               const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+               const bool result = source_.read(ranges, count);
+
+               fetch_nanoseconds_ += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+               fetched_ranges_    += count;
+
+               return result;
+            }
+
+            /* Copy out a cached range, marking it most recently used */
+            bool lookup(const range& r)
+            {
+               const std::unordered_map<std::uint64_t,entry>::iterator itr = entries_.find(r.offset);
+
+               if ((entries_.end() == itr) || (itr->second.data.size() != r.size))
+                  return false;
+
+               std::memcpy(r.data, itr->second.data.data(), r.size);
+
+               lru_.splice(lru_.begin(), lru_, itr->second.position);
+
+               return true;
+            }
+
+            void insert(const std::uint64_t offset, const unsigned char* data, const std::size_t size)
+            {
+               if (size > capacity_)
+                  return;
+
+               const std::unordered_map<std::uint64_t,entry>::iterator existing = entries_.find(offset);
+
+               if (entries_.end() != existing)
+               {
+                  cached_ -= existing->second.data.size();
+                  lru_.erase(existing->second.position);
+                  entries_.erase(existing);
+               }
+
+               while ((cached_ + size) > capacity_)
+               {
+                  const std::unordered_map<std::uint64_t,entry>::iterator victim = entries_.find(lru_.back());
+
+                  cached_ -= victim->second.data.size();
+                  entries_.erase(victim);
+                  lru_.pop_back();
+               }
+
+               lru_.push_front(offset);
+
+               entry& e = entries_[offset];
+
+               e.data.assign(data, data + size);
+               e.position = lru_.begin();
+
+               cached_ += size;
+            }
+
+            void run()
+            {
+               std::vector<range>                      batch;
+               std::vector<std::vector<unsigned char> > buffers;
+
+               std::unique_lock<std::mutex> lock(mutex_);
+
+               for ( ; ; )
+               {
+                  wake_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+
+                  if (stop_)
+                     return;
+
+                  batch.assign(pending_.begin(), pending_.end());
+                  pending_.clear();
+
+                  lock.unlock();
+
+                  buffers.resize(batch.size());
+
+                  for (std::size_t i = 0; i < batch.size(); ++i)
+                  {
+                     buffers[i].resize(std::max<std::size_t>(1, batch[i].size));
+                     batch[i].data = &buffers[i][0];
+                  }
+
+                  const bool fetched = fetch(&batch[0], batch.size());
+
+                  lock.lock();
+
+                  for (std::size_t i = 0; i < batch.size(); ++i)
+                  {
+                     /* Note: A failed prefetch is dropped, the read fetches it itself */
+                     if (fetched)
+                     {
+                        insert(batch[i].offset, batch[i].data, batch[i].size);
+                        ++prefetched_;
+                     }
+
+                     in_flight_.erase(batch[i].offset);
+                  }
+
+                  wake_.notify_all();
+               }
+            }
+
+            range_reader&                                 source_;
+            const std::size_t                             capacity_;
+            std::size_t                                   cached_;
+            std::unordered_map<std::uint64_t,entry>       entries_;
+            std::list<std::uint64_t>                      lru_;
+            std::unordered_map<std::uint64_t,std::size_t> in_flight_;
+            std::deque<range>                             pending_;
+            bool                                          stop_;
+            std::mutex                                    mutex_;
+            std::condition_variable                       wake_;
+            std::atomic<std::size_t>                      hits_;
+            std::atomic<std::size_t>                      misses_;
+            std::atomic<std::size_t>                      prefetched_;
+            std::atomic<std::uint64_t>                    fetch_nanoseconds_;
+            std::atomic<std::size_t>                      fetched_ranges_;
+            std::thread                                   prefetcher_;
+         };
+
+         inline bool parse_header(const unsigned char* buffer, header& h)
+         {
+            if (
+                 (0 != std::memcmp(buffer, magic, sizeof(magic)))                                  ||
+                 ((version != load(&buffer[8], 4)) && (compressed_version != load(&buffer[8], 4))) ||
+                 (crc(buffer, 56) != load(&buffer[56], 4))
+               )
+            {
+               return false;
+            }
+
+            h.code_length          = static_cast<std::uint32_t>(load(&buffer[12], 4));
+            h.fec_length           = static_cast<std::uint32_t>(load(&buffer[16], 4));
+            h.data_length          = static_cast<std::uint32_t>(load(&buffer[20], 4));
+            h.symbol_bits          = static_cast<std::uint32_t>(load(&buffer[24], 4));
+            h.primitive_polynomial = static_cast<std::uint32_t>(load(&buffer[28], 4));
+            h.gen_initial_index    = static_cast<std::uint32_t>(load(&buffer[32], 4));
+            h.chunk_blocks         = static_cast<std::uint32_t>(load(&buffer[36], 4));
+            h.data_size            = load(&buffer[40], 8);
+            h.chunk_count          = load(&buffer[48], 8);
+            h.compressed           = (compressed_version == load(&buffer[8], 4));
+
+            const std::uint64_t chunk_data = static_cast<std::uint64_t>(h.chunk_blocks) * h.data_length;
+
+            return (0 != chunk_data) && (h.chunk_count == (h.data_size + chunk_data - 1) / chunk_data);
+         }
+
+         /*
+            Index of the entries read after the header buffer, whose CRC
+            is only checked once every chunk has been written
+         */
+         inline bool parse_entries(const header& h,
+                                   const unsigned char* buffer,
+                                   const std::vector<unsigned char>& entries,
+                                   std::vector<chunk_entry>& index,
+                                   std::size_t& written)
+         {
+            index.resize(static_cast<std::size_t>(h.chunk_count));
+
+            for (std::size_t i = 0; i < index.size(); ++i)
+            {
+               index[i] = load_entry(&entries[i * entry_size]);
+            }
+
+            written = written_chunks(h, index);
+
+            if (written < index.size())
+               return true;
+
+            return (crc(entries.empty() ? buffer : &entries[0], entries.size()) == load(&buffer[60], 4));
+         }
+
+         /*
+            Reads and checks the header and the index of a container. The
+            index CRC is only checked once every chunk has been written,
+            written is set to the number of chunks that have been.
+         */
+         inline bool read_index(std::istream& stream,
+                                header& h,
+                                std::vector<chunk_entry>& index,
+                                std::size_t& written)
+         {
+            unsigned char buffer[header_size];
+
+            stream.seekg(0);
+            stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(header_size));
+
+            if (stream.fail() || !parse_header(buffer, h))
+               return false;
+
+            std::vector<unsigned char> entries(static_cast<std::size_t>(h.chunk_count) * entry_size);
+
+            if (!entries.empty())
+            {
+               stream.read(reinterpret_cast<char*>(&entries[0]), static_cast<std::streamsize>(entries.size()));
+
+               if (stream.fail())
+                  return false;
+            }
+
+            return parse_entries(h, buffer, entries, index, written);
+         }
+
+         /* read_index() through a range_reader, two reads in all */
+         inline bool read_index(range_reader& reader,
+                                header& h,
+                                std::vector<chunk_entry>& index,
+                                std::size_t& written)
+         {
+            unsigned char buffer[header_size];
+
+            if (!reader.read(0, header_size, buffer) || !parse_header(buffer, h))
+               return false;
+
+            std::vector<unsigned char> entries(static_cast<std::size_t>(h.chunk_count) * entry_size);
+
+            if (!entries.empty() && !reader.read(header_size, entries.size(), &entries[0]))
+               return false;
+
+            return parse_entries(h, buffer, entries, index, written);
+         }
+
+         /*
+            Check the CRCs of the first chunk_count chunks of a container
+            over threads threads (0 for one per hardware thread), each of
+            which reads its own contiguous run of chunks. Returns the
+            number of leading chunks that check out.
+         */
+         inline std::size_t verify_chunks(const std::string& file_name,
+                                          const std::vector<chunk_entry>& index,
+                                          const std::size_t chunk_count,
+                                          std::size_t threads = 0)
+         {
+            if (0 == threads)
+               threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+            threads = std::max<std::size_t>(1, std::min(threads, chunk_count));
+
+            std::vector<unsigned char> valid(chunk_count, 0);
+            std::vector<std::thread>   workers;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+               workers.push_back(std::thread([&, t]()
+                                 {
+                                    std::ifstream stream(file_name.c_str(), std::ios::binary);
+
+                                    std::vector<unsigned char> buffer;
+
+                                    for (std::size_t c = (t * chunk_count) / threads; c < ((t + 1) * chunk_count) / threads; ++c)
+                                    {
+                                       buffer.resize(std::max<std::size_t>(1, index[c].size));
+
+                                       stream.seekg(static_cast<std::streamoff>(index[c].offset));
+                                       stream.read(reinterpret_cast<char*>(&buffer[0]), static_cast<std::streamsize>(index[c].size));
+
+                                       valid[c] = (!stream.fail() && (crc(&buffer[0], index[c].size) == index[c].crc)) ? 1 : 0;
+                                    }
+                                 }));
+            }
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+               workers[t].join();
+            }
+
+            return static_cast<std::size_t>(std::find(valid.begin(), valid.end(), 0) - valid.begin());
+         }
+
+      } // namespace container
+
+      /*
+         Encode a file into a container, chunk_blocks codewords per chunk.
+         gen_initial_index is that of the generator polynomial the encoder
+         was built with, it is recorded for the decoder.
+
+         Every checkpoint_chunks chunks (0 for none) the output is flushed
+         and the index entries of the chunks written since the previous
+         checkpoint are filled in. With resume set, an existing output file
+         of the same code, chunking and input size is picked up where its
+         index leaves off: the chunks it records are CRC checked in
+         parallel, and encoding restarts at the first one that fails.
+
+         Note: A checkpoint flushes to the operating system, which covers a
+               killed or preempted process but not a power loss.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class container_file_encoder
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         static constexpr std::size_t default_chunk_blocks      = 64;
+         static constexpr std::size_t default_checkpoint_chunks = 256;
+
+         container_file_encoder(const encoder_type& encoder,
+                                const unsigned int gen_initial_index,
+                                const std::string& input_file_name,
+                                const std::string& output_file_name,
+                                const std::size_t chunk_blocks = default_chunk_blocks,
+                                const bool resume = false,
+                                const std::size_t checkpoint_chunks = default_checkpoint_chunks)
+         {
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::container_file_encoder() - Error: input file could not be opened." << std::endl;
+               return;
+            }
+
+            container::header h;
+
+            h.code_length          = static_cast<std::uint32_t>(code_length);
+            h.fec_length           = static_cast<std::uint32_t>(fec_length);
+            h.data_length          = static_cast<std::uint32_t>(data_length);
+            h.symbol_bits          = static_cast<std::uint32_t>(encoder.field().pwr());
+            h.primitive_polynomial = container::primitive_polynomial(encoder.field());
+            h.gen_initial_index    = static_cast<std::uint32_t>(gen_initial_index);
+            h.chunk_blocks         = static_cast<std::uint32_t>(std::max<std::size_t>(1, chunk_blocks));
+            h.data_size            = input_size;
+            h.compressed           = false;
+
+            const std::size_t chunk_data = h.chunk_blocks * data_length;
+
+            h.chunk_count          = (input_size + chunk_data - 1) / chunk_data;
+
+            std::vector<container::chunk_entry> index(static_cast<std::size_t>(h.chunk_count), container::chunk_entry());
+
+            const std::size_t first_chunk = resume ? resume_point(h, output_file_name, index) : 0;
+
+            std::fstream out_stream(output_file_name.c_str(),
+                                    (first_chunk > 0) ? (std::ios::in  | std::ios::out   | std::ios::binary) :
+                                                        (std::ios::out | std::ios::trunc | std::ios::binary));
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::container_file_encoder() - Error: output file could not be created." << std::endl;
+               return;
+            }
+
+            std::vector<unsigned char> header_buffer;
+
+            std::uint64_t offset = container::header_size + index.size() * container::entry_size;
+
+            if (first_chunk > 0)
+            {
+               /* Note: Drop whatever the index records past the resume point */
+               container::write_entries(out_stream, index, first_chunk, index.size());
+
+               offset = index[first_chunk - 1].offset + index[first_chunk - 1].size;
+            }
+            else
+            {
+               /* Note: The index is written again once the chunk CRCs are known */
+               container::write_index(h, index, header_buffer);
+               out_stream.write(reinterpret_cast<const char*>(&header_buffer[0]), static_cast<std::streamsize>(header_buffer.size()));
+            }
+
+            std::vector<unsigned char> input (chunk_data);
+            std::vector<unsigned char> output(h.chunk_blocks * code_length);
+
+            std::size_t remaining_bytes = input_size - first_chunk * chunk_data;
+            std::size_t checkpoint      = first_chunk;
+
+            in_stream .seekg(static_cast<std::streamoff>(first_chunk * chunk_data));
+            out_stream.seekp(static_cast<std::streamoff>(offset));
+
+            for (std::size_t c = first_chunk; c < index.size(); ++c)
+            {
+               const std::size_t read_amount = std::min(remaining_bytes, chunk_data);
+
+               in_stream.read(reinterpret_cast<char*>(&input[0]), static_cast<std::streamsize>(read_amount));
+
+               std::size_t    failures  = 0;
+               crc32::crc32_t crc_state = 0xFFFFFFFF;
+
+               const std::size_t write_amount = file_encoder_type::encode_buffer(encoder, &input[0], read_amount, &output[0], failures,
+                                                                                 container::crc_module(), crc_state);
+
+               for (std::size_t i = 0; i < failures; ++i)
+               {
+                  std::cout << "reed_solomon::container_file_encoder() - Error during encoding of block!" << std::endl;
+               }
+
+               index[c].offset = offset;
+               index[c].size   = static_cast<std::uint32_t>(write_amount);
+               index[c].crc    = static_cast<std::uint32_t>(crc_state ^ 0xFFFFFFFF);
+
+               out_stream.write(reinterpret_cast<const char*>(&output[0]), static_cast<std::streamsize>(write_amount));
+
+               offset          += write_amount;
+               remaining_bytes -= read_amount;
+
+               if ((checkpoint_chunks > 0) && ((c + 1 - checkpoint) >= checkpoint_chunks) && ((c + 1) < index.size()))
+               {
+                  /* Note: Chunks reach the file before the entries that record them */
+                  out_stream.flush();
+
+                  container::write_entries(out_stream, index, checkpoint, c + 1);
+
+                  out_stream.flush();
+                  out_stream.seekp(static_cast<std::streamoff>(offset));
+
+                  checkpoint = c + 1;
+               }
+            }
+
+            container::write_index(h, index, header_buffer);
+
+            out_stream.seekp(0);
+            out_stream.write(reinterpret_cast<const char*>(&header_buffer[0]), static_cast<std::streamsize>(header_buffer.size()));
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::container_file_encoder() - Error: output file could not be written." << std::endl;
+            }
+         }
+
+      private:
+
+         container_file_encoder(const container_file_encoder&);
+         container_file_encoder& operator=(const container_file_encoder&);
+
+         /*
+            The chunk to resume encoding at, index being filled in with the
+            chunks before it. 0 when there is nothing to resume.
+         */
+         static inline std::size_t resume_point(const container::header& h,
+                                                const std::string& output_file_name,
+                                                std::vector<container::chunk_entry>& index)
+         {
+            std::ifstream stream(output_file_name.c_str(), std::ios::binary);
+            if (!stream)
+               return 0;
+
+            container::header                   existing_header;
+            std::vector<container::chunk_entry> existing_index;
+            std::size_t                         written = 0;
+
+            if (!container::read_index(stream, existing_header, existing_index, written) || !(existing_header == h))
+            {
+               std::cout << "reed_solomon::container_file_encoder() - Error: output file cannot be resumed, encoding from the start." << std::endl;
+               return 0;
+            }
+
+            stream.close();
+
+            const std::size_t verified = container::verify_chunks(output_file_name, existing_index, written);
+
+            std::copy(existing_index.begin(), existing_index.begin() + verified, index.begin());
+
+            return verified;
+         }
+      };
+
+      /*
+         Bring a container up to date with its input file after the file
+         has grown by appending to it. Only the appended bytes are encoded,
+         along with the old partial tail block, which is encoded again as a
+         complete block. The codewords before it are kept as they are, so
+         the work done is proportional to the bytes appended. The tail
+         chunk's kept codewords are read back for its CRC, and the chunk is
+         not extended if that CRC fails.
+
+         Appending in place needs spare index entries for the new chunks.
+         When there are too few, the container is rewritten to a temporary
+         file with twice the entries it needs, and that file is renamed
+         over the original. The chunks are copied across without being
+         encoded again. Growth is geometric, so the copying amortises to a
+         constant per appended byte.
+
+         Note: In place, the new codewords are flushed before the header
+               and index are rewritten in a single write. An interrupted
+               append therefore leaves the old index. The exception is the
+               old partial tail block. Its data bytes are kept, but its
+               parity is overwritten, so its chunk then fails its CRC.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class container_file_appender
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         container_file_appender(const encoder_type& encoder,
+                                 const unsigned int gen_initial_index,
+                                 const std::string& input_file_name,
+                                 const std::string& container_file_name)
+         : appended_(0),
+           success_(false)
+         {
+            container::header                   h;
+            std::vector<container::chunk_entry> index;
+
+            {
+               std::ifstream stream(container_file_name.c_str(), std::ios::binary);
+
+               std::size_t written = 0;
+
+               if (!stream || !container::read_index(stream, h, index, written) || (written < index.size()))
+               {
+                  std::cout << "reed_solomon::container_file_appender() - Error: invalid or incomplete container." << std::endl;
+                  return;
+               }
+            }
+
+            if (h.compressed)
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: compressed containers cannot be appended to." << std::endl;
+               return;
+            }
+
+            if (
+                 (h.code_length          != code_length)                                      ||
+                 (h.fec_length           != fec_length)                                       ||
+                 (h.data_length          != data_length)                                      ||
+                 (h.symbol_bits          != encoder.field().pwr())                            ||
+                 (h.primitive_polynomial != container::primitive_polynomial(encoder.field())) ||
+                 (h.gen_initial_index    != gen_initial_index)
+               )
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: container code does not match the encoder." << std::endl;
+               return;
+            }
+
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+
+            if (input_size < h.data_size)
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: input file is shorter than the container's data." << std::endl;
+               return;
+            }
+            else if (input_size == h.data_size)
+            {
+               success_ = true;
+               return;
+            }
+
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: input file could not be opened." << std::endl;
+               return;
+            }
+
+            const std::size_t chunk_data = h.chunk_blocks * data_length;
+
+            /* The chunk encoding starts in, and its leading codewords that are kept */
+            const std::size_t first_chunk  = static_cast<std::size_t>(h.data_size / chunk_data);
+            const std::size_t kept_blocks  = static_cast<std::size_t>(h.data_size % chunk_data) / data_length;
+            const std::size_t kept_bytes   = kept_blocks * code_length;
+            const std::size_t old_capacity = container::index_capacity(index);
+
+            container::header updated = h;
+
+            updated.data_size   = input_size;
+            updated.chunk_count = (input_size + chunk_data - 1) / chunk_data;
+
+            const std::size_t capacity = (updated.chunk_count <= old_capacity) ? old_capacity : static_cast<std::size_t>(2 * updated.chunk_count);
+            const std::size_t shift    = (capacity - old_capacity) * container::entry_size;
+
+            std::uint64_t offset = container::header_size + old_capacity * container::entry_size;
+
+            if (first_chunk < index.size())
+               offset = index[first_chunk].offset;
+            else if (!index.empty())
+               offset = index.back().offset + index.back().size;
+
+            crc32::crc32_t tail_crc = 0xFFFFFFFF;
+
+            std::fstream stream(container_file_name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+            if (!stream)
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: container file could not be opened." << std::endl;
+               return;
+            }
+
+            if (kept_blocks > 0)
+            {
+               std::vector<unsigned char> tail(index[first_chunk].size);
+
+               stream.seekg(static_cast<std::streamoff>(offset));
+               stream.read(reinterpret_cast<char*>(&tail[0]), static_cast<std::streamsize>(tail.size()));
+
+               if (stream.fail() || (container::crc(&tail[0], tail.size()) != index[first_chunk].crc))
+               {
+                  std::cout << "reed_solomon::container_file_appender() - Error: tail chunk fails its CRC, container cannot be extended." << std::endl;
+                  return;
+               }
+
+               tail_crc = container::crc_module().process(tail_crc, &tail[0], kept_bytes);
+            }
+
+            const std::string temp_file_name = container_file_name + ".append";
+
+            std::fstream  temp_stream;
+            std::fstream& out_stream = (0 == shift) ? stream : temp_stream;
+
+            if (shift > 0)
+            {
+               temp_stream.open(temp_file_name.c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+
+               if (!temp_stream || !relocate(stream, temp_stream, container::header_size + capacity * container::entry_size,
+                                             container::header_size + old_capacity * container::entry_size, offset + kept_bytes))
+               {
+                  std::cout << "reed_solomon::container_file_appender() - Error: container could not be rewritten." << std::endl;
+                  temp_stream.close();
+                  std::remove(temp_file_name.c_str());
+                  return;
+               }
+
+               for (std::size_t c = 0; c < first_chunk; ++c)
+               {
+                  index[c].offset += shift;
+               }
+
+               offset += shift;
+            }
+
+            index.resize(static_cast<std::size_t>(updated.chunk_count), container::chunk_entry());
+
+            std::vector<unsigned char> input (chunk_data);
+            std::vector<unsigned char> output(h.chunk_blocks * code_length);
+
+            std::size_t position = first_chunk * chunk_data + kept_blocks * data_length;
+
+            in_stream .seekg(static_cast<std::streamoff>(position));
+            out_stream.seekp(static_cast<std::streamoff>(offset + kept_bytes));
+
+            for (std::size_t c = first_chunk; c < index.size(); ++c)
+            {
+               const std::size_t read_amount = std::min<std::size_t>((c + 1) * chunk_data, input_size) - position;
+
+               in_stream.read(reinterpret_cast<char*>(&input[0]), static_cast<std::streamsize>(read_amount));
+
+               std::size_t    failures  = 0;
+               crc32::crc32_t crc_state = (c == first_chunk) ? tail_crc : 0xFFFFFFFF;
+
+               const std::size_t write_amount = file_encoder_type::encode_buffer(encoder, &input[0], read_amount, &output[0], failures,
+                                                                                 container::crc_module(), crc_state);
+
+               for (std::size_t i = 0; i < failures; ++i)
+               {
+                  std::cout << "reed_solomon::container_file_appender() - Error during encoding of block!" << std::endl;
+               }
+
+               const std::size_t chunk_bytes = ((c == first_chunk) ? kept_bytes : 0) + write_amount;
+
+               index[c].offset = offset;
+               index[c].size   = static_cast<std::uint32_t>(chunk_bytes);
+               index[c].crc    = static_cast<std::uint32_t>(crc_state ^ 0xFFFFFFFF);
+
+               out_stream.write(reinterpret_cast<const char*>(&output[0]), static_cast<std::streamsize>(write_amount));
+
+               offset   += chunk_bytes;
+               position += read_amount;
+            }
+
+            if (in_stream.fail())
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: input file could not be read." << std::endl;
+               return;
+            }
+
+            /* Note: The codewords reach the file before the index that records them */
+            out_stream.flush();
+
+            std::vector<unsigned char> header_buffer;
+
+            container::write_index(updated, index, header_buffer);
+
+            out_stream.seekp(0);
+            out_stream.write(reinterpret_cast<const char*>(&header_buffer[0]), static_cast<std::streamsize>(header_buffer.size()));
+            out_stream.flush();
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::container_file_appender() - Error: container could not be written." << std::endl;
+               return;
+            }
+
+            if (shift > 0)
+            {
+               temp_stream.close();
+               stream     .close();
+
+               if (0 != std::rename(temp_file_name.c_str(), container_file_name.c_str()))
+               {
+                  std::cout << "reed_solomon::container_file_appender() - Error: rewritten container could not replace the original." << std::endl;
+                  std::remove(temp_file_name.c_str());
+                  return;
+               }
+            }
+
+            appended_ = input_size - static_cast<std::size_t>(h.data_size);
+            success_  = true;
+         }
+
+         /* The number of input bytes taken in, 0 when there were none or on failure */
+         inline std::size_t appended() const
+         {
+            return appended_;
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         container_file_appender(const container_file_appender&);
+         container_file_appender& operator=(const container_file_appender&);
+
+         /*
+            Copy the chunk bytes [begin,end) of a container to data_start
+            in a new one, which is zero filled before data_start for its
+            header and index.
+         */
+         static inline bool relocate(std::fstream& from,
+                                     std::fstream& to,
+                                     const std::uint64_t data_start,
+                                     const std::uint64_t begin,
+                                     const std::uint64_t end)
+         {
+            static constexpr std::size_t copy_size = 1 << 20;
+
+            std::vector<unsigned char> buffer(copy_size, 0);
+
+            for (std::uint64_t remaining = data_start; remaining > 0;)
+            {
+               const std::size_t amount = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, copy_size));
+
+               to.write(reinterpret_cast<const char*>(&buffer[0]), static_cast<std::streamsize>(amount));
+
+               remaining -= amount;
+            }
+
+            from.seekg(static_cast<std::streamoff>(begin));
+
+            for (std::uint64_t remaining = end - begin; remaining > 0;)
+            {
+               const std::size_t amount = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, copy_size));
+
+               from.read(reinterpret_cast<char*>(&buffer[0]), static_cast<std::streamsize>(amount));
+               to  .write(reinterpret_cast<const char*>(&buffer[0]), static_cast<std::streamsize>(amount));
+
+               remaining -= amount;
+            }
+
+            return !from.fail() && !to.fail();
+         }
+
+         std::size_t appended_;
+         bool        success_;
+      };
+
+      /*
+         Compress and encode a file into a compressed container. Each
+         chunk of chunk_blocks * data_length input bytes is compressed with
+         codec and its payload encoded by the same worker, on the
+         run_file_pipeline() pool of parallel_file_encoder with threads
+         workers (0 for one per hardware thread). The index entries are
+         filled in as the chunks are written, in file order, and the
+         header and index last. Chunks are compressed independently, so a
+         chunk the decoder cannot recover loses only its own bytes.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class compressed_container_file_encoder
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         static constexpr std::size_t default_chunk_blocks = 256;
+
+         compressed_container_file_encoder(const encoder_type& encoder,
+                                           const unsigned int gen_initial_index,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const compression::codec codec,
+                                           const std::size_t chunk_blocks = default_chunk_blocks,
+                                           const std::size_t threads = 0,
+                                           const int level = compression::default_level)
+         : payload_size_(0),
+           success_(false)
+         {
+            FileIO io;
+            run(encoder, gen_initial_index, io, input_file_name, output_file_name, codec, chunk_blocks, threads, level);
+         }
+
+         compressed_container_file_encoder(const encoder_type& encoder,
+                                           const unsigned int gen_initial_index,
+                                           FileIO& io,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const compression::codec codec,
+                                           const std::size_t chunk_blocks = default_chunk_blocks,
+                                           const std::size_t threads = 0,
+                                           const int level = compression::default_level)
+         : payload_size_(0),
+           success_(false)
+         {
+            run(encoder, gen_initial_index, io, input_file_name, output_file_name, codec, chunk_blocks, threads, level);
+         }
+
+         /* The compressed bytes encoded, over every chunk */
+         inline std::size_t payload_size() const
+         {
+            return payload_size_;
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         compressed_container_file_encoder(const compressed_container_file_encoder&);
+         compressed_container_file_encoder& operator=(const compressed_container_file_encoder&);
+
+         void run(const encoder_type& encoder,
+                  const unsigned int gen_initial_index,
+                  FileIO& io,
+                  const std::string& input_file_name,
+                  const std::string& output_file_name,
+                  const compression::codec codec,
+                  const std::size_t chunk_blocks,
+                  const std::size_t threads,
+                  const int level)
+         {
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+            if (input_size == 0)
+            {
+               std::cout << "reed_solomon::compressed_container_file_encoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (!compression::available(codec))
+            {
+               std::cout << "reed_solomon::compressed_container_file_encoder() - Error: compression codec is not built in." << std::endl;
+               return;
+            }
+
+            container::header h;
+
+            h.code_length          = static_cast<std::uint32_t>(code_length);
+            h.fec_length           = static_cast<std::uint32_t>(fec_length);
+            h.data_length          = static_cast<std::uint32_t>(data_length);
+            h.symbol_bits          = static_cast<std::uint32_t>(encoder.field().pwr());
+            h.primitive_polynomial = container::primitive_polynomial(encoder.field());
+            h.gen_initial_index    = static_cast<std::uint32_t>(gen_initial_index);
+            h.chunk_blocks         = static_cast<std::uint32_t>(std::max<std::size_t>(1, chunk_blocks));
+            h.data_size            = input_size;
+            h.compressed           = true;
+
+            const std::size_t chunk_data = h.chunk_blocks * data_length;
+
+            h.chunk_count          = (input_size + chunk_data - 1) / chunk_data;
+
+            std::vector<container::chunk_entry> index(static_cast<std::size_t>(h.chunk_count), container::chunk_entry());
+            std::vector<std::uint32_t>          crcs (index.size(), 0);
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << "reed_solomon::compressed_container_file_encoder() - Error: files could not be opened." << std::endl;
+               io.close();
+               return;
+            }
+
+            const std::size_t   payload_bound = compression::payload_bound(chunk_data);
+            const std::uint64_t data_start    = container::header_size + index.size() * container::entry_size;
+
+            std::uint64_t offset = data_start;
+
+            const bool io_success = details::run_file_pipeline(io,
+                                          input_size,
+                                          chunk_data,
+                                          static_cast<std::size_t>(container::encoded_size(h, payload_bound)),
+                                          details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                          [&](details::file_chunk& chunk)
+                                          {
+                                             static thread_local std::vector<unsigned char> payload;
+
+                                             payload.resize(payload_bound);
+
+                                             const std::size_t amount = compression::compress(codec, &chunk.input[0], chunk.amount, &payload[0], level);
+
+                                             crc32::crc32_t crc_state = 0xFFFFFFFF;
+
+                                             chunk.failures = 0;
+
+                                             chunk.output_amount = file_encoder_type::encode_buffer(encoder, &payload[0], amount, &chunk.output[0], chunk.failures,
+                                                                                                    container::crc_module(), crc_state);
+
+                                             crcs[chunk.index] = static_cast<std::uint32_t>(crc_state ^ 0xFFFFFFFF);
+                                          },
+                                          [&](const details::file_chunk& chunk)
+                                          {
+                                             for (std::size_t i = 0; i < chunk.failures; ++i)
+                                             {
+                                                std::cout << "reed_solomon::compressed_container_file_encoder() - Error during encoding of block!" << std::endl;
+                                             }
+
+                                             index[chunk.index].offset = offset;
+                                             index[chunk.index].size   = static_cast<std::uint32_t>(chunk.output_amount);
+                                             index[chunk.index].crc    = crcs[chunk.index];
+
+                                             offset        += chunk.output_amount;
+                                             payload_size_ += static_cast<std::size_t>(container::data_size(h, chunk.output_amount));
+                                          },
+                                          false,
+                                          0,
+                                          data_start);
+
+            io.close();
+
+            if (!io_success)
+            {
+               std::cout << "reed_solomon::compressed_container_file_encoder() - Error: file read or write failed." << std::endl;
+               return;
+            }
+
+            std::vector<unsigned char> header_buffer;
+
+            container::write_index(h, index, header_buffer);
+
+            std::fstream out_stream(output_file_name.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+
+            out_stream.write(reinterpret_cast<const char*>(&header_buffer[0]), static_cast<std::streamsize>(header_buffer.size()));
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::compressed_container_file_encoder() - Error: output file could not be written." << std::endl;
+               return;
+            }
+
+            success_ = true;
+         }
+
+         std::size_t payload_size_;
+         bool        success_;
+      };
+
+      /*
+         Random access reads of a container. decode_range() only reads the
+         chunks that cover the requested bytes, and of a chunk that fails
+         its CRC only decodes the codewords that cover them. The container
+         must have been written with the decoder's code, field and
+         generator initial index.
+
+         With crc_gate off every chunk read is decoded regardless of its
+         CRC. chunks_crc_passed() and chunks_decoded() count the chunks
+         that took each path.
+
+         A chunk of a compressed container is decoded as a whole when it
+         fails its CRC, then decompressed, the last one being kept for
+         the next read. Its bytes are zeroed when it cannot be recovered.
+
+         The container is read through a container::range_reader, a local
+         file by default. The chunks of a range are requested together,
+         up to read_batch_chunks at a time, so that a remote reader may
+         fetch them concurrently.
+
+         Scans, ie: a read of several chunks or one starting where the
+         last one ended, go through a read-ahead stage: while chunk N is
+         decoded, a thread of the decoder (a caching_range_reader over
+         the reader) loads chunks N+1 to N+k. k adapts between 1 and
+         set_read_ahead() chunks to the measured time a chunk takes to
+         load against the time it takes to decode, so that loading keeps
+         ahead of decoding without holding more chunks than it needs.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class container_file_decoder
+      {
+      public:
+
+         typedef file_decoder<code_length,fec_length,data_length,symbol_t> file_decoder_type;
+         typedef typename file_decoder_type::decoder_type decoder_type;
+
+         static constexpr std::size_t read_batch_chunks          = 16;
+         static constexpr std::size_t default_read_ahead_chunks  =  8;
+
+         container_file_decoder(const decoder_type& decoder, const std::string& file_name, const bool crc_gate = true)
+         : decoder_(decoder),
+           file_name_(file_name),
+           file_reader_(new container::file_range_reader(file_name)),
+           source_(file_reader_.get()),
+           reader_(source_),
+           valid_(false),
+           crc_gate_(crc_gate),
+           chunks_crc_passed_(0),
+           chunks_decoded_(0),
+           expanded_chunk_(no_chunk),
+           max_chunk_size_(0),
+           max_read_ahead_(0),
+           read_ahead_depth_(0),
+           hinted_(0),
+           next_offset_(no_chunk),
+           decode_seconds_(0.0)
+         {
+            if (!file_reader_->valid())
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: file could not be opened." << std::endl;
+               return;
+            }
+
+            open();
+         }
+
+         /*
+            Decoder of a container read through reader, eg: an object in
+            object storage, which must outlive the decoder.
+         */
+         container_file_decoder(const decoder_type& decoder, container::range_reader& reader, const bool crc_gate = true)
+         : decoder_(decoder),
+           source_(&reader),
+           reader_(source_),
+           valid_(false),
+           crc_gate_(crc_gate),
+           chunks_crc_passed_(0),
+           chunks_decoded_(0),
+           expanded_chunk_(no_chunk),
+           max_chunk_size_(0),
+           max_read_ahead_(0),
+           read_ahead_depth_(0),
+           hinted_(0),
+           next_offset_(no_chunk),
+           decode_seconds_(0.0)
+         {
+            open();
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline std::size_t data_size() const
+         {
+            return static_cast<std::size_t>(header_.data_size);
+         }
+
+         inline std::size_t chunks_crc_passed() const
+         {
+            return chunks_crc_passed_;
+         }
+
+         inline std::size_t chunks_decoded() const
+         {
+            return chunks_decoded_;
+         }
+
+         /*
+            Most chunks loaded ahead of a scan, 0 turning the read-ahead
+            stage off. Its buffer holds up to chunks + 2 chunks.
+         */
+         void set_read_ahead(const std::size_t chunks)
+         {
+            read_ahead_.reset();
+
+            reader_           = source_;
+            max_read_ahead_   = chunks;
+            read_ahead_depth_ = std::min<std::size_t>(1, chunks);
+            hinted_           = 0;
+
+            if (valid_ && (chunks > 0))
+            {
+               read_ahead_.reset(new container::caching_range_reader(*source_, (chunks + 2) * max_chunk_size_));
+               reader_ = read_ahead_.get();
+            }
+         }
+
+         /* Chunks currently loaded ahead of a scan */
+         inline std::size_t read_ahead_depth() const
+         {
+            return read_ahead_depth_;
+         }
+
+         /*
+            Decode the whole container into output_file_name, as one scan.
+            False when a chunk could not be read, or had bytes that could
+            not be recovered.
+         */
+         bool decode(const std::string& output_file_name)
+         {
+            if (!valid_)
+               return false;
+
+            std::ofstream out_stream(output_file_name.c_str(), std::ios::binary);
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: output file could not be created." << std::endl;
+               return false;
+            }
+
+            const std::size_t chunk_data = header_.chunk_blocks * data_length;
+
+            std::vector<unsigned char> buffer(chunk_data);
+
+            bool result = true;
+
+            for (std::size_t position = 0; position < data_size(); position += chunk_data)
+            {
+               const std::size_t amount = std::min(chunk_data, data_size() - position);
+
+               result &= decode_range(position, amount, &buffer[0]);
+
+               out_stream.write(reinterpret_cast<const char*>(&buffer[0]), static_cast<std::streamsize>(amount));
+            }
+
+            return result && static_cast<bool>(out_stream);
+         }
+
+         /*
+            Check every chunk against its CRC over threads threads (0 for
+            one per hardware thread), true when all of them check out. A
+            container behind another reader is read read_batch_chunks at
+            a time through it.
+         */
+         inline bool verify(const std::size_t threads = 0)
+         {
+            if (!valid_)
+               return false;
+
+            if (file_reader_)
+               return (container::verify_chunks(file_name_, index_, index_.size(), threads) == index_.size());
+
+            for (std::size_t first = 0; first < index_.size(); first += read_batch_chunks)
+            {
+               const std::size_t last = std::min(first + read_batch_chunks, index_.size()) - 1;
+
+               if (!fetch_chunks(first, last))
+                  return false;
+
+               for (std::size_t c = first; c <= last; ++c)
+               {
+                  if (container::crc(&chunks_[c - first][0], index_[c].size) != index_[c].crc)
+                     return false;
+               }
+            }
+
+            return true;
+         }
+
+         inline bool decode_range(const std::size_t offset, const std::size_t length, std::string& output)
+         {
+            output.resize(length);
+
+            return (0 == length) || decode_range(offset, length, reinterpret_cast<unsigned char*>(&output[0]));
+         }
+
+         /*
+            Decode the length data bytes at offset into output. The bytes
+            of unrecoverable codewords are passed through as read, and
+            false is returned.
+         */
+         bool decode_range(const std::size_t offset, const std::size_t length, unsigned char* output)
+         {
+            if (!valid_ || (offset > header_.data_size) || (length > (header_.data_size - offset)))
+               return false;
+
+            if (0 == length)
+               return true;
+
+            const std::size_t chunk_data = header_.chunk_blocks * data_length;
+            const std::size_t last_chunk = (offset + length - 1) / chunk_data;
+
+            /*
+               Note: Only a sequential scan reads ahead past the range, a
+                     random read of a few chunks only within it.
+            */
+            const bool        sequential = (offset == next_offset_);
+            const bool        scan       = read_ahead_ && (sequential || ((offset / chunk_data) != last_chunk));
+            const std::size_t limit      = sequential ? index_.size() : (last_chunk + 1);
+
+            next_offset_ = offset + length;
+
+            if (header_.compressed)
+               return decode_compressed_range(offset, length, output, scan, limit);
+
+            bool result = true;
+
+            for (std::size_t position = offset; position < (offset + length);)
+            {
+               const std::size_t first = position / chunk_data;
+               const std::size_t last  = scan ? first : std::min(last_chunk, first + read_batch_chunks - 1);
+
+               if (scan)
+                  read_ahead(first, limit);
+
+               if (!fetch_chunks(first, last))
+                  return false;
+
+               for (std::size_t chunk_index = first; chunk_index <= last; ++chunk_index)
+               {
+                  const std::size_t chunk_start = chunk_index * chunk_data;
+                  const std::size_t chunk_end   = std::min<std::size_t>(chunk_start + chunk_data, static_cast<std::size_t>(header_.data_size));
+                  const std::size_t end         = std::min(chunk_end, offset + length);
+
+                  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                  take_chunk(chunk_index, chunk_index - first);
+
+                  result &= copy_range(chunk_index, position - chunk_start, end - chunk_start, chunk_end - chunk_start, output + (position - offset));
+
+                  if (scan)
+                     adapt_read_ahead(start);
+
+                  position = end;
+               }
+            }
+
+            return result;
+         }
+
+      private:
+
+         static constexpr std::size_t no_chunk = static_cast<std::size_t>(-1);
+
+         container_file_decoder(const container_file_decoder&);
+         container_file_decoder& operator=(const container_file_decoder&);
+
+         bool decode_compressed_range(const std::size_t offset,
+                                      const std::size_t length,
+                                      unsigned char* output,
+                                      const bool scan,
+                                      const std::size_t limit)
+         {
+            const std::size_t chunk_data = header_.chunk_blocks * data_length;
+
+            bool result = true;
+
+            for (std::size_t position = offset; position < (offset + length);)
+            {
+               const std::size_t chunk_index = position / chunk_data;
+               const std::size_t chunk_start = chunk_index * chunk_data;
+               const std::size_t end         = std::min<std::size_t>(chunk_start + chunk_data, offset + length);
+
+               if (chunk_index != expanded_chunk_)
+               {
+                  if (scan)
+                     read_ahead(chunk_index, limit);
+
+                  if (!fetch_chunks(chunk_index, chunk_index))
+                     return false;
+
+                  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                  take_chunk(chunk_index, 0);
+
+                  expanded_chunk_ = expand_chunk(chunk_index) ? chunk_index : no_chunk;
+
+                  if (scan)
+                     adapt_read_ahead(start);
+               }
+
+               if (chunk_index == expanded_chunk_)
+                  std::memcpy(output + (position - offset), &expanded_[position - chunk_start], end - position);
+               else
+               {
+                  std::memset(output + (position - offset), 0, end - position);
+                  result = false;
+               }
+
+               position = end;
+            }
+
+            return result;
+         }
+
+         /*
+            Recover the payload of the compressed chunk just read, and
+            decompress it into expanded_.
+         */
+         bool expand_chunk(const std::size_t chunk_index)
+         {
+            const std::size_t payload_size = static_cast<std::size_t>(container::data_size(header_, chunk_.size()));
+
+            decoded_.resize(std::max<std::size_t>(1, payload_size));
+
+            if (chunk_crc_valid_)
+            {
+               for (std::size_t position = 0; position < payload_size; position += data_length)
+               {
+                  std::memcpy(&decoded_[position], &chunk_[(position / data_length) * code_length], std::min(data_length, payload_size - position));
+               }
+            }
+            else
+            {
+               failed_.clear();
+
+               file_decoder_type::decode_buffer(decoder_, &chunk_[0], chunk_.size(), &decoded_[0], 0, failed_);
+
+               for (std::size_t i = 0; i < failed_.size(); ++i)
+               {
+                  std::cout << "reed_solomon::container_file_decoder() - Error during decoding of block " << failed_[i] << " of chunk " << chunk_index << "!" << std::endl;
+               }
+
+               if (!failed_.empty())
+                  return false;
+            }
+
+            const std::size_t data_amount = static_cast<std::size_t>(container::chunk_data_size(header_, chunk_index));
+
+            expanded_.resize(std::max<std::size_t>(1, data_amount));
+
+            if (!compression::decompress(&decoded_[0], payload_size, &expanded_[0], data_amount))
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: chunk " << chunk_index << " could not be decompressed." << std::endl;
+               return false;
+            }
+
+            return true;
+         }
+
+         void open()
+         {
+            std::size_t written = 0;
+
+            if (!container::read_index(*source_, header_, index_, written))
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: invalid container header or index." << std::endl;
+               return;
+            }
+
+            if (written < index_.size())
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: container is incomplete, " << written << " of " << index_.size() << " chunks written." << std::endl;
+               return;
+            }
+
+            if (
+                 (header_.code_length          != code_length)                                          ||
+                 (header_.fec_length           != fec_length)                                           ||
+                 (header_.data_length          != data_length)                                          ||
+                 (header_.symbol_bits          != decoder_.field().pwr())                               ||
+                 (header_.primitive_polynomial != container::primitive_polynomial(decoder_.field()))    ||
+                 (header_.gen_initial_index    != decoder_.gen_initial_index())
+               )
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: container code does not match the decoder." << std::endl;
+               return;
+            }
+
+            for (std::size_t c = 0; c < index_.size(); ++c)
+            {
+               max_chunk_size_ = std::max<std::size_t>(max_chunk_size_, index_[c].size);
+            }
+
+            valid_ = true;
+
+            set_read_ahead(default_read_ahead_chunks);
+         }
+
+         /*
+            Hand the chunks up to read_ahead_depth_ past chunk_index and
+            before limit, that were not already, to the read-ahead stage
+         */
+         void read_ahead(const std::size_t chunk_index, const std::size_t limit)
+         {
+            if ((hinted_ <= chunk_index) || (hinted_ > (chunk_index + 1 + max_read_ahead_)))
+               hinted_ = chunk_index + 1;
+
+            const std::size_t last = std::min(chunk_index + 1 + read_ahead_depth_, limit);
+
+            ranges_.clear();
+
+            for ( ; hinted_ < last; ++hinted_)
+            {
+               const container::range_reader::range r = { index_[hinted_].offset, index_[hinted_].size, 0 };
+               ranges_.push_back(r);
+            }
+
+            if (!ranges_.empty())
+               read_ahead_->prefetch(&ranges_[0], ranges_.size());
+         }
+
+         /*
+            Fold the decode time of the chunk started at start into its
+            running average, and size the read-ahead so that the chunks
+            loading cover the time one takes to load: one more than the
+            load to decode time ratio.
+         */
+         void adapt_read_ahead(const std::chrono::steady_clock::time_point& start)
+         {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            decode_seconds_ = (0.0 == decode_seconds_) ? seconds : (decode_seconds_ + (seconds - decode_seconds_) / 8.0);
+
+            const double load_seconds = read_ahead_->seconds_per_range();
+
+            if ((decode_seconds_ <= 0.0) || (load_seconds >= (decode_seconds_ * max_read_ahead_)))
+               read_ahead_depth_ = max_read_ahead_;
+            else
+               read_ahead_depth_ = std::max<std::size_t>(1, std::min<std::size_t>(max_read_ahead_, static_cast<std::size_t>(load_seconds / decode_seconds_) + 1));
+         }
+
+         /* Read chunks [first,last] in one request to the reader */
+         bool fetch_chunks(const std::size_t first, const std::size_t last)
+         {
+            const std::size_t count = last - first + 1;
+
+            if (chunks_.size() < count)
+               chunks_.resize(count);
+
+            ranges_.clear();
+
+            for (std::size_t c = first; c <= last; ++c)
+            {
+               std::vector<unsigned char>& chunk = chunks_[c - first];
+
+               chunk.resize(std::max<std::size_t>(1, index_[c].size));
+
+               const container::range_reader::range r = { index_[c].offset, index_[c].size, &chunk[0] };
+               ranges_.push_back(r);
+            }
+
+            if (!reader_->read(&ranges_[0], ranges_.size()))
+            {
+               std::cout << "reed_solomon::container_file_decoder() - Error: chunks " << first << " to " << last << " could not be read." << std::endl;
+               return false;
+            }
+
+            return true;
+         }
+
+         /* Make chunk slot of the last fetch_chunks() the chunk just read */
+         inline void take_chunk(const std::size_t chunk_index, const std::size_t slot)
+         {
+            const container::chunk_entry& entry = index_[chunk_index];
+
+            chunk_.swap(chunks_[slot]);
+            chunk_.resize(entry.size);
+
+            chunk_crc_valid_ = crc_gate_ && (container::crc(&chunk_[0], chunk_.size()) == entry.crc);
+
+            if (chunk_crc_valid_)
+               ++chunks_crc_passed_;
+            else
+               ++chunks_decoded_;
+         }
+
+         /*
+            Copy the data bytes [begin,end) of the chunk just read, whose
+            data_amount bytes were encoded as file_encoder encodes them.
+            Only a chunk that failed its CRC (or any chunk, with the CRC
+            gate off) is decoded.
+         */
+         bool copy_range(const std::size_t chunk_index,
+                         const std::size_t begin,
+                         const std::size_t end,
+                         const std::size_t data_amount,
+                         unsigned char* output)
+         {
+            const std::size_t first_block = begin / data_length;
+            const std::size_t last_block  = (end - 1) / data_length;
+
+            if (chunk_crc_valid_)
+            {
+               for (std::size_t position = begin; position < end;)
+               {
+                  const std::size_t block     = position / data_length;
+                  const std::size_t block_end = std::min(end, (block + 1) * data_length);
+
+                  std::memcpy(output + (position - begin),
+                              &chunk_[block * code_length + (position - block * data_length)],
+                              block_end - position);
+
+                  position = block_end;
+               }
+
+               return true;
+            }
+
+            const std::size_t block_index = chunk_index * header_.chunk_blocks;
+
+            decoded_.resize((last_block - first_block + 1) * data_length);
+
+            failed_.clear();
+
+            file_decoder_type::decode_buffer(decoder_,
+                                             &chunk_[first_block * code_length],
+                                             std::min(chunk_.size(), (last_block + 1) * code_length) - first_block * code_length,
+                                             &decoded_[0],
+                                             block_index + first_block,
+                                             failed_);
+
+            const bool result = failed_.empty();
+
+            /*
+               Note: decode_buffer() packs out unrecoverable blocks, so the
+                     blocks are then decoded again one at a time, the failed
+                     ones being passed through as they were read.
+            */
+            if (!result)
+            {
+               for (std::size_t i = 0; i < failed_.size(); ++i)
+               {
+                  std::cout << "reed_solomon::container_file_decoder() - Error during decoding of block " << failed_[i] << "!" << std::endl;
+               }
+
+               for (std::size_t b = first_block; b <= last_block; ++b)
+               {
+                  unsigned char* block_output = &decoded_[(b - first_block) * data_length];
+
+                  failed_.clear();
+
+                  file_decoder_type::decode_buffer(decoder_,
+                                                   &chunk_[b * code_length],
+                                                   std::min(chunk_.size(), (b + 1) * code_length) - b * code_length,
+                                                   block_output,
+                                                   block_index + b,
+                                                   failed_);
+
+                  if (!failed_.empty())
+                  {
+                     std::memcpy(block_output, &chunk_[b * code_length], std::min(data_length, data_amount - b * data_length));
+                  }
+               }
+            }
+
+            std::memcpy(output, &decoded_[begin - first_block * data_length], end - begin);
+
+            return result;
+         }
+
+         const decoder_type&                               decoder_;
+         const std::string                                 file_name_;
+         std::unique_ptr<container::file_range_reader>     file_reader_;
+         container::range_reader*                          source_;
+         std::unique_ptr<container::caching_range_reader>  read_ahead_;
+         container::range_reader*                          reader_;
+         bool                                              valid_;
+         const bool                                        crc_gate_;
+         bool                                              chunk_crc_valid_;
+         std::size_t                                       chunks_crc_passed_;
+         std::size_t                                       chunks_decoded_;
+         std::size_t                                       expanded_chunk_;
+         std::size_t                                       max_chunk_size_;
+         std::size_t                                       max_read_ahead_;
+         std::size_t                                       read_ahead_depth_;
+         std::size_t                                       hinted_;
+         std::size_t                                       next_offset_;
+         double                                            decode_seconds_;
+         container::header                                 header_;
+         std::vector<container::chunk_entry>               index_;
+         std::vector<container::range_reader::range>       ranges_;
+         std::vector<std::vector<unsigned char> >          chunks_;
+         std::vector<unsigned char>                        chunk_;
+         std::vector<unsigned char>                        decoded_;
+         std::vector<unsigned char>                        expanded_;
+         std::vector<std::size_t>                          failed_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
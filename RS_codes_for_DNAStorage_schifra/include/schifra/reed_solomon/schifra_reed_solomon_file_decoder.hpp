@@ -24,12 +24,17 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_DECODER_HPP
 
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
+#include "schifra_reed_solomon_bitio.hpp"
 #include "schifra_reed_solomon_block.hpp"
 #include "schifra_reed_solomon_decoder.hpp"
 #include "schifra/utils/schifra_fileio.hpp"
+#include "schifra/utils/schifra_object_pool.hpp"
 
 
 namespace schifra
@@ -38,132 +43,307 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      /*
+         The input is read buffer_size bytes (rounded to whole blocks) at
+         a time and decoded batch_blocks blocks at a time with
+         decoder::decode_batch(), so that clean blocks only cost a batched
+         syndrome check. Each buffer's worth of output goes out in a
+         single write.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
       class file_decoder
       {
       public:
 
-         typedef decoder<code_length,fec_length> decoder_type;
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
          typedef typename decoder_type::block_type block_type;
 
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+         static constexpr std::size_t batch_blocks        = 64;
+
          file_decoder(const decoder_type& decoder,
                       const std::string& input_file_name,
-                      const std::string& output_file_name)
-         : current_block_index_(0)
+                      const std::string& output_file_name,
+                      const std::size_t buffer_size = default_buffer_size)
          {
-            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
+            decode_file(decoder, 0, input_file_name, output_file_name, buffer_size);
+         }
 
-            if (remaining_bytes == 0)
+         /*
+            Input written by file_encoder with the same puncture mask, ie:
+            puncture.stored_length(code_length) bytes per codeword.
+         */
+         file_decoder(const decoder_type& decoder,
+                      const puncture_mask& puncture,
+                      const std::string& input_file_name,
+                      const std::string& output_file_name,
+                      const std::size_t buffer_size = default_buffer_size)
+         {
+            if (puncture.fec_length() != fec_length)
             {
-               std::cout << "reed_solomon::file_decoder() - Error: input file has ZERO size." << std::endl;
+               std::cout << "reed_solomon::file_decoder() - Error: puncture mask does not match the code." << std::endl;
                return;
             }
 
-            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
-            if (!in_stream)
+            decode_file(decoder, &puncture, input_file_name, output_file_name, buffer_size);
+         }
+
+         /*
+            Decode amount bytes of input, laid out as consecutive codewords
+            the last of which may be short: its data bytes followed by its
+            fec, the data having been zero padded to data_length. The data
+            of the recoverable blocks is packed into output and its size
+            returned, the indices (counted from first_block_index) of the
+            unrecoverable ones are appended to failed. The blocks go
+            through decode_batch() batch_blocks at a time, and output may
+            be input itself as it never overtakes the next batch.
+
+            Note: Bytes are decoded as unsigned symbols, as file_encoder
+                  writes them, a plain char would sign extend.
+         */
+         static inline std::size_t decode_buffer(const decoder_type& decoder,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 const std::size_t first_block_index,
+                                                 std::vector<std::size_t>& failed)
+         {
+            const std::size_t complete_blocks = amount / code_length;
+            const std::size_t remaining_bytes = amount % code_length;
+            const std::size_t block_count     = complete_blocks + ((remaining_bytes > fec_length) ? 1 : 0);
+
+            typename utils::object_pool<block_type>::array blocks = utils::object_pool<block_type>::acquire(std::min(batch_blocks, block_count));
+
+            std::size_t write_amount = 0;
+
+            for (std::size_t b = 0; b < block_count; b += batch_blocks)
             {
-               std::cout << "reed_solomon::file_decoder() - Error: input file could not be opened." << std::endl;
-               return;
+               const std::size_t count = std::min(batch_blocks, block_count - b);
+
+               for (std::size_t l = 0; l < count; ++l)
+               {
+                  const unsigned char* codeword    = input + (b + l) * code_length;
+                  const std::size_t    data_amount = ((b + l) < complete_blocks) ? data_length : (remaining_bytes - fec_length);
+
+                  block_type& rsblock = blocks[l];
+
+                  bitio::unpack_symbols<8>(codeword, rsblock.data, data_amount);
+                  std::fill(rsblock.data + data_amount, rsblock.data + data_length, static_cast<typename block_type::symbol_type>(0));
+                  bitio::unpack_symbols<8>(codeword + data_amount, rsblock.data + data_length, fec_length);
+
+                  rsblock.unrecoverable = false;
+               }
+
+               decoder.decode_batch(&blocks[0], count);
+
+               for (std::size_t l = 0; l < count; ++l)
+               {
+                  if (blocks[l].unrecoverable)
+                  {
+                     failed.push_back(first_block_index + b + l);
+                     continue;
+                  }
+
+                  const std::size_t data_amount = ((b + l) < complete_blocks) ? data_length : (remaining_bytes - fec_length);
+
+                  bitio::pack_symbols<8>(blocks[l].data, data_amount, output + write_amount);
+
+                  write_amount += data_amount;
+               }
             }
 
-            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
-            if (!out_stream)
+            if ((remaining_bytes > 0) && (remaining_bytes <= fec_length))
             {
-               std::cout << "reed_solomon::file_decoder() - Error: output file could not be created." << std::endl;
-               return;
+               failed.push_back(first_block_index + complete_blocks);
             }
 
-            current_block_index_ = 0;
+            return write_amount;
+         }
 
-            while (remaining_bytes >= code_length)
+         /*
+            As above for codewords of puncture.stored_length(code_length)
+            bytes, the last one's kept parity following its data. Each block
+            is decoded with its punctured parity positions as erasures.
+         */
+         static inline std::size_t decode_buffer(const decoder_type& decoder,
+                                                 const puncture_mask& puncture,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 const std::size_t first_block_index,
+                                                 std::vector<std::size_t>& failed)
+         {
+            const std::size_t kept_length     = puncture.kept_count();
+            const std::size_t stored_length   = puncture.stored_length(code_length);
+            const std::size_t complete_blocks = amount / stored_length;
+            const std::size_t remaining_bytes = amount % stored_length;
+            const std::size_t block_count     = complete_blocks + ((remaining_bytes > kept_length) ? 1 : 0);
+
+            block_type rsblock;
+
+            std::size_t write_amount = 0;
+
+            for (std::size_t b = 0; b < block_count; ++b)
             {
-               process_complete_block(decoder,in_stream,out_stream);
-               remaining_bytes -= code_length;
-               current_block_index_++;
+               const unsigned char* codeword    = input + b * stored_length;
+               const std::size_t    data_amount = (b < complete_blocks) ? data_length : (remaining_bytes - kept_length);
+
+               bitio::unpack_symbols<8>(codeword, rsblock.data, data_amount);
+               std::fill(rsblock.data + data_amount, rsblock.data + data_length, static_cast<typename block_type::symbol_type>(0));
+               puncture.expand(codeword + data_amount, rsblock.data + data_length);
+
+               rsblock.unrecoverable = false;
+
+               if (!decoder.decode(rsblock, puncture))
+               {
+                  failed.push_back(first_block_index + b);
+                  continue;
+               }
+
+               bitio::pack_symbols<8>(rsblock.data, data_amount, output + write_amount);
+
+               write_amount += data_amount;
             }
 
-            if (remaining_bytes > 0)
+            if ((remaining_bytes > 0) && (remaining_bytes <= kept_length))
             {
-               process_partial_block(decoder,in_stream,out_stream,remaining_bytes);
+               failed.push_back(first_block_index + complete_blocks);
             }
 
-            in_stream.close();
-            out_stream.close();
+            return write_amount;
          }
 
       private:
 
-         inline void process_complete_block(const decoder_type& decoder,
-                                            std::ifstream& in_stream,
-                                            std::ofstream& out_stream)
+         void decode_file(const decoder_type& decoder,
+                          const puncture_mask* puncture,
+                          const std::string& input_file_name,
+                          const std::string& output_file_name,
+                          const std::size_t buffer_size)
          {
-            in_stream.read(&buffer_[0],static_cast<std::streamsize>(code_length));
-            copy<char,code_length,fec_length>(buffer_,code_length,block_);
+            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
 
-            if (!decoder.decode(block_))
+            if (remaining_bytes == 0)
             {
-               std::cout << "reed_solomon::file_decoder.process_complete_block() - Error during decoding of block " << current_block_index_ << "!" << std::endl;
+               std::cout << "reed_solomon::file_decoder() - Error: input file has ZERO size." << std::endl;
                return;
             }
 
-            for (std::size_t i = 0; i < data_length; ++i)
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+            if (!in_stream)
             {
-               buffer_[i] = static_cast<char>(block_[i]);
+               std::cout << "reed_solomon::file_decoder() - Error: input file could not be opened." << std::endl;
+               return;
             }
 
-            out_stream.write(&buffer_[0],static_cast<std::streamsize>(data_length));
-         }
-
-         inline void process_partial_block(const decoder_type& decoder,
-                                           std::ifstream& in_stream,
-                                           std::ofstream& out_stream,
-                                           const std::size_t& read_amount)
-         {
-            if (read_amount <= fec_length)
+            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
+            if (!out_stream)
             {
-               std::cout << "reed_solomon::file_decoder.process_partial_block() - Error during decoding of block " << current_block_index_ << "!" << std::endl;
+               std::cout << "reed_solomon::file_decoder() - Error: output file could not be created." << std::endl;
                return;
             }
 
-            in_stream.read(&buffer_[0],static_cast<std::streamsize>(read_amount));
+            /* Unpunctured codewords go through decode_batch() */
+            if (puncture && (0 == puncture->punctured_count()))
+               puncture = 0;
 
-            for (std::size_t i = 0; i < (read_amount - fec_length); ++i)
-            {
-               block_.data[i] = static_cast<typename block_type::symbol_type>(buffer_[i]);
-            }
+            const std::size_t stored_length = puncture ? puncture->stored_length(code_length) : code_length;
+
+            buffer_.resize(std::max<std::size_t>(1, buffer_size / stored_length) * stored_length);
 
-            if ((read_amount - fec_length) < data_length)
+            std::vector<std::size_t> failed;
+
+            for (std::size_t block_index = 0; remaining_bytes > 0; block_index += buffer_.size() / stored_length)
             {
-               for (std::size_t i = (read_amount - fec_length); i < data_length; ++i)
+               const std::size_t read_amount = std::min(remaining_bytes, buffer_.size());
+
+               in_stream.read(&buffer_[0],static_cast<std::streamsize>(read_amount));
+
+               unsigned char* buffer = reinterpret_cast<unsigned char*>(&buffer_[0]);
+
+               failed.clear();
+
+               const std::size_t write_amount = puncture ?
+                                                decode_buffer(decoder, *puncture, buffer, read_amount, buffer, block_index, failed) :
+                                                decode_buffer(decoder, buffer, read_amount, buffer, block_index, failed);
+
+               for (std::size_t i = 0; i < failed.size(); ++i)
                {
-                  block_.data[i] = 0;
+                  std::cout << "reed_solomon::file_decoder() - Error during decoding of block " << failed[i] << "!" << std::endl;
                }
+
+               out_stream.write(&buffer_[0],static_cast<std::streamsize>(write_amount));
+
+               remaining_bytes -= read_amount;
             }
 
-            for (std::size_t i = 0; i < fec_length; ++i)
+            in_stream.close();
+            out_stream.close();
+         }
+
+         std::vector<char> buffer_;
+      };
+
+      #ifdef SCHIFRA_FILEIO_MMAP
+
+      /*
+         file_decoder over memory mapped files. Codewords are staged from
+         the input mapping batch_blocks at a time for decode_batch(), and
+         the decoded data is written straight into the output mapping,
+         which is preallocated for every block and truncated on close to
+         what the recoverable blocks produced. The output and the error
+         reports are those of file_decoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class mapped_file_decoder
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type block_type;
+
+         mapped_file_decoder(const decoder_type& decoder,
+                             const std::string& input_file_name,
+                             const std::string& output_file_name)
+         {
+            fileio::mapped_file input;
+
+            if (!input.open(input_file_name))
             {
-               block_.fec(i) = static_cast<typename block_type::symbol_type>(buffer_[(read_amount - fec_length) + i]);
+               std::cout << "reed_solomon::mapped_file_decoder() - Error: input file could not be mapped." << std::endl;
+               return;
             }
 
-            if (!decoder.decode(block_))
+            const std::size_t complete_blocks = input.size() / code_length;
+            const std::size_t remaining_bytes = input.size() % code_length;
+            const std::size_t output_size     = complete_blocks * data_length + ((remaining_bytes > fec_length) ? (remaining_bytes - fec_length) : 0);
+
+            fileio::mapped_file output;
+
+            if (!output.create(output_file_name, output_size))
             {
-               std::cout << "reed_solomon::file_decoder.process_partial_block() - Error during decoding of block " << current_block_index_ << "!" << std::endl;
+               std::cout << "reed_solomon::mapped_file_decoder() - Error: output file could not be mapped." << std::endl;
                return;
             }
 
-            for (std::size_t i = 0; i < (read_amount - fec_length); ++i)
+            std::vector<std::size_t> failed;
+
+            const std::size_t write_amount = file_decoder<code_length,fec_length,data_length,symbol_t>::
+                                                decode_buffer(decoder, input.data(), input.size(), output.data(), 0, failed);
+
+            for (std::size_t i = 0; i < failed.size(); ++i)
             {
-               buffer_[i] = static_cast<char>(block_.data[i]);
+               std::cout << "reed_solomon::mapped_file_decoder() - Error during decoding of block " << failed[i] << "!" << std::endl;
             }
 
-            out_stream.write(&buffer_[0],static_cast<std::streamsize>(read_amount - fec_length));
+            output.close(write_amount);
          }
-
-         block_type block_;
-         std::size_t current_block_index_;
-         char buffer_[code_length];
       };
 
+      #endif
+
    } // namespace reed_solomon
 
 } // namespace schifra
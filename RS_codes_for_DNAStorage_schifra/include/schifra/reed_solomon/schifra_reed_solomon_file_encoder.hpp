@@ -24,13 +24,20 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_ENCODER_HPP
 
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
+#include "schifra_reed_solomon_bitio.hpp"
 #include "schifra_reed_solomon_block.hpp"
 #include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_parity_cache.hpp"
+#include "schifra/utils/schifra_crc.hpp"
 #include "schifra/utils/schifra_fileio.hpp"
+#include "schifra/utils/schifra_span.hpp"
 
 
 namespace schifra
@@ -39,17 +46,142 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      /*
+         The input is read buffer_size bytes (rounded to whole blocks) at
+         a time, every complete block is encoded straight out of the read
+         buffer into the output buffer, and each buffer's worth of output
+         goes out in a single write rather than two small writes per block.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
       class file_encoder
       {
       public:
 
-         typedef encoder<code_length,fec_length> encoder_type;
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
          typedef typename encoder_type::block_type block_type;
 
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
          file_encoder(const encoder_type& encoder,
                       const std::string& input_file_name,
-                      const std::string& output_file_name)
+                      const std::string& output_file_name,
+                      const std::size_t buffer_size = default_buffer_size)
+         {
+            encode_file(encoder, 0, input_file_name, output_file_name, buffer_size);
+         }
+
+         /*
+            Punctured output: each codeword is written without the parity
+            symbols puncture drops, ie: puncture.stored_length(code_length)
+            bytes, for file_decoder with the same mask to read back.
+         */
+         file_encoder(const encoder_type& encoder,
+                      const puncture_mask& puncture,
+                      const std::string& input_file_name,
+                      const std::string& output_file_name,
+                      const std::size_t buffer_size = default_buffer_size)
+         {
+            if (puncture.fec_length() != fec_length)
+            {
+               std::cout << "reed_solomon::file_encoder() - Error: puncture mask does not match the code." << std::endl;
+               return;
+            }
+
+            encode_file(encoder, &puncture, input_file_name, output_file_name, buffer_size);
+         }
+
+         /*
+            Complete blocks already in cache take their parity from it
+            rather than the encoder, see parity_cache. The output is the
+            same as without.
+         */
+         file_encoder(const encoder_type& encoder,
+                      parity_cache& cache,
+                      const std::string& input_file_name,
+                      const std::string& output_file_name,
+                      const std::size_t buffer_size = default_buffer_size)
+         {
+            if ((cache.data_length() != data_length) || (cache.fec_length() != fec_length))
+            {
+               std::cout << "reed_solomon::file_encoder() - Error: parity cache does not match the code." << std::endl;
+               return;
+            }
+
+            encode_file(encoder, 0, input_file_name, output_file_name, buffer_size, &cache);
+         }
+
+         /*
+            Encode amount bytes of input, laid out as consecutive data
+            blocks, the last of which may be short and is zero padded to
+            data_length. The encoded blocks are written to output, which
+            must have room for whole codewords, and the number of bytes
+            written is returned. Blocks that fail to encode are left out
+            and counted in failures.
+         */
+         static inline std::size_t encode_buffer(const encoder_type& encoder,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 std::size_t& failures)
+         {
+            return encode_codewords(encoder, input, amount, output, failures, 0, 0);
+         }
+
+         /*
+            As above, also running crc_state over the bytes written. Each
+            codeword is checksummed as soon as it is encoded, while it is
+            still in L1, rather than in a second pass over the output.
+         */
+         static inline std::size_t encode_buffer(const encoder_type& encoder,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 std::size_t& failures,
+                                                 const crc32& crc_module,
+                                                 crc32::crc32_t& crc_state)
+         {
+            return encode_codewords(encoder, input, amount, output, failures, &crc_module, &crc_state);
+         }
+
+         /*
+            As the first, writing each codeword without the parity symbols
+            puncture drops, puncture.stored_length(code_length) bytes per
+            complete block.
+         */
+         static inline std::size_t encode_buffer(const encoder_type& encoder,
+                                                 const puncture_mask& puncture,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 std::size_t& failures)
+         {
+            return encode_codewords(encoder, input, amount, output, failures, 0, 0, &puncture);
+         }
+
+         /*
+            As the first, complete blocks found in cache taking their parity
+            from it, and those encoded being added to it. The cache must be
+            of data_length and fec_length.
+         */
+         static inline std::size_t encode_buffer(const encoder_type& encoder,
+                                                 parity_cache& cache,
+                                                 const unsigned char* input,
+                                                 const std::size_t amount,
+                                                 unsigned char* output,
+                                                 std::size_t& failures)
+         {
+            return encode_codewords(encoder, input, amount, output, failures, 0, 0, 0, &cache);
+         }
+
+      private:
+
+         void encode_file(const encoder_type& encoder,
+                          const puncture_mask* puncture,
+                          const std::string& input_file_name,
+                          const std::string& output_file_name,
+                          const std::size_t buffer_size,
+                          parity_cache* cache = 0)
          {
             std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
             if (remaining_bytes == 0)
@@ -72,65 +204,202 @@ namespace schifra
                return;
             }
 
-            std::memset(data_buffer_,0,sizeof(data_buffer_));
-            std::memset(fec_buffer_ ,0,sizeof(fec_buffer_ ));
+            const std::size_t buffer_blocks = std::max<std::size_t>(1, buffer_size / code_length);
 
-            while (remaining_bytes >= data_length)
-            {
-               process_block(encoder,in_stream,out_stream,data_length);
-               remaining_bytes -= data_length;
-            }
+            in_buffer_ .resize(buffer_blocks * data_length);
+            out_buffer_.resize(buffer_blocks * code_length);
 
-            if (remaining_bytes > 0)
+            while (remaining_bytes > 0)
             {
-               process_block(encoder,in_stream,out_stream,remaining_bytes);
+               const std::size_t read_amount = std::min(remaining_bytes, in_buffer_.size());
+
+               in_stream.read(&in_buffer_[0],static_cast<std::streamsize>(read_amount));
+
+               std::size_t failures = 0;
+
+               const std::size_t write_amount = encode_codewords(encoder,
+                                                                 reinterpret_cast<const unsigned char*>(&in_buffer_[0]),
+                                                                 read_amount,
+                                                                 reinterpret_cast<unsigned char*>(&out_buffer_[0]),
+                                                                 failures, 0, 0, puncture, cache);
+
+               for (std::size_t i = 0; i < failures; ++i)
+               {
+                  std::cout << "reed_solomon::file_encoder() - Error during encoding of block!" << std::endl;
+               }
+
+               out_stream.write(&out_buffer_[0],static_cast<std::streamsize>(write_amount));
+
+               remaining_bytes -= read_amount;
             }
 
             in_stream.close();
             out_stream.close();
          }
 
-      private:
-
-         inline void process_block(const encoder_type& encoder,
-                                   std::ifstream& in_stream,
-                                   std::ofstream& out_stream,
-                                   const std::size_t& read_amount)
+         static inline std::size_t encode_codewords(const encoder_type& encoder,
+                                                    const unsigned char* input,
+                                                    const std::size_t amount,
+                                                    unsigned char* output,
+                                                    std::size_t& failures,
+                                                    const crc32* crc_module,
+                                                    crc32::crc32_t* crc_state,
+                                                    const puncture_mask* puncture = 0,
+                                                    parity_cache* cache = 0)
          {
-            in_stream.read(&data_buffer_[0],static_cast<std::streamsize>(read_amount));
-            for (std::size_t i = 0; i < read_amount; ++i)
+            const std::size_t complete_blocks = amount / data_length;
+            const std::size_t remaining_bytes = amount % data_length;
+
+            /* Unpunctured codewords get their fec straight in the output */
+            if (puncture && (0 == puncture->punctured_count()))
+               puncture = 0;
+
+            const std::size_t stored_fec_length = puncture ? puncture->kept_count() : fec_length;
+
+            unsigned char full_fec[fec_length];
+
+            std::size_t write_amount = 0;
+
+            for (std::size_t b = 0; b < complete_blocks; ++b, input += data_length)
             {
-               block_.data[i] = (data_buffer_[i] & 0xFF);
+               std::memcpy(output + write_amount, input, data_length);
+
+               unsigned char* fec = puncture ? full_fec : (output + write_amount + data_length);
+
+               if (!cache || !cache->lookup(input, fec))
+               {
+                  if (
+                       !encoder.encode(utils::span<const unsigned char>(input, data_length),
+                                       utils::span<unsigned char>(fec, fec_length))
+                     )
+                  {
+                     ++failures;
+                     continue;
+                  }
+
+                  if (cache)
+                  {
+                     cache->insert(input, fec);
+                  }
+               }
+
+               if (puncture)
+               {
+                  puncture->compress(full_fec, output + write_amount + data_length);
+               }
+
+               if (crc_module)
+               {
+                  *crc_state = crc_module->process(*crc_state, output + write_amount, data_length + stored_fec_length);
+               }
+
+               write_amount += data_length + stored_fec_length;
             }
 
-            if (read_amount < data_length)
+            /*
+               Note: The zero padding of the last block is not the virtual
+                     zero prefix of a shortened span encode(), so it goes
+                     through a block.
+            */
+            if (remaining_bytes > 0)
             {
-               for (std::size_t i = read_amount; i < data_length; ++i)
+               block_type rsblock;
+
+               bitio::unpack_symbols<8>(input, rsblock.data, remaining_bytes);
+               std::fill(rsblock.data + remaining_bytes, rsblock.data + data_length, static_cast<symbol_t>(0));
+
+               if (!encoder.encode(rsblock))
+               {
+                  ++failures;
+                  return write_amount;
+               }
+
+               std::memcpy(output + write_amount, input, remaining_bytes);
+
+               const std::size_t block_start = write_amount;
+
+               write_amount += remaining_bytes;
+
+               bitio::pack_symbols<8>(rsblock.data + data_length, fec_length, full_fec);
+
+               if (puncture)
+                  puncture->compress(full_fec, output + write_amount);
+               else
+                  std::memcpy(output + write_amount, full_fec, fec_length);
+
+               write_amount += stored_fec_length;
+
+               if (crc_module)
                {
-                  block_.data[i] = 0x00;
+                  *crc_state = crc_module->process(*crc_state, output + block_start, write_amount - block_start);
                }
             }
 
-            if (!encoder.encode(block_))
+            return write_amount;
+         }
+
+         std::vector<char> in_buffer_;
+         std::vector<char> out_buffer_;
+      };
+
+      #ifdef SCHIFRA_FILEIO_MMAP
+
+      /*
+         file_encoder over memory mapped files. The output is preallocated
+         at its final size and every complete block is encoded straight
+         from the input mapping, its data copied and its fec written into
+         the output mapping, so no bytes pass through the kernel's read and
+         write copies. The output is byte for byte that of file_encoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class mapped_file_encoder
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
+         typedef typename encoder_type::block_type block_type;
+
+         mapped_file_encoder(const encoder_type& encoder,
+                             const std::string& input_file_name,
+                             const std::string& output_file_name)
+         {
+            fileio::mapped_file input;
+
+            if (!input.open(input_file_name))
             {
-               std::cout << "reed_solomon::file_encoder.process_block() - Error during encoding of block!" << std::endl;
+               std::cout << "reed_solomon::mapped_file_encoder() - Error: input file could not be mapped." << std::endl;
                return;
             }
 
-            for (std::size_t i = 0; i < fec_length; ++i)
+            const std::size_t complete_blocks = input.size() / data_length;
+            const std::size_t remaining_bytes = input.size() % data_length;
+            const std::size_t output_size     = complete_blocks * code_length + ((remaining_bytes > 0) ? (remaining_bytes + fec_length) : 0);
+
+            fileio::mapped_file output;
+
+            if (!output.create(output_file_name, output_size))
             {
-               fec_buffer_[i] = static_cast<char>(block_.fec(i) & 0xFF);
+               std::cout << "reed_solomon::mapped_file_encoder() - Error: output file could not be mapped." << std::endl;
+               return;
             }
 
-            out_stream.write(&data_buffer_[0],static_cast<std::streamsize>(read_amount));
-            out_stream.write(&fec_buffer_[0],fec_length);
-         }
+            std::size_t failures = 0;
 
-         block_type block_;
-         char data_buffer_[data_length];
-         char fec_buffer_[fec_length];
+            const std::size_t write_amount = file_encoder<code_length,fec_length,data_length,symbol_t>::
+                                                encode_buffer(encoder, input.data(), input.size(), output.data(), failures);
+
+            for (std::size_t i = 0; i < failures; ++i)
+            {
+               std::cout << "reed_solomon::mapped_file_encoder() - Error during encoding of block!" << std::endl;
+            }
+
+            output.close(write_amount);
+         }
       };
 
+      #endif
+
    } // namespace reed_solomon
 
 } // namespace schifra
@@ -0,0 +1,308 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_INTERLEAVED_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_INTERLEAVED_CODEC_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_interleaving.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         file_encoder followed by dynamic_file_interleaver in one pass: a
+         stack of stack_size blocks is read, encoded and written out
+         interleaved from memory, so the encoded file never goes to disk.
+         The output is byte for byte that of the two separate passes.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class file_interleaved_encoder
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
+         typedef typename encoder_type::block_type block_type;
+
+         file_interleaved_encoder(const encoder_type& encoder,
+                                  const std::string& input_file_name,
+                                  const std::string& output_file_name,
+                                  const std::size_t stack_size)
+         {
+            if (0 == stack_size)
+            {
+               std::cout << "reed_solomon::file_interleaved_encoder() - Error: invalid stack size." << std::endl;
+               return;
+            }
+
+            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
+
+            if (0 == remaining_bytes)
+            {
+               std::cout << "reed_solomon::file_interleaved_encoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::file_interleaved_encoder() - Error: input file could not be opened." << std::endl;
+               return;
+            }
+
+            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::file_interleaved_encoder() - Error: output file could not be created." << std::endl;
+               return;
+            }
+
+            std::vector<block_type> blocks           (stack_size);
+            std::vector<char>       data_buffer      (data_length);
+            std::vector<char>       stack            (code_length * stack_size);
+            std::vector<char>       interleaved_stack(code_length * stack_size);
+
+            while (remaining_bytes > 0)
+            {
+               std::size_t count        = 0;
+               std::size_t last_amount  = data_length;
+
+               for (; (count < stack_size) && (remaining_bytes > 0); ++count)
+               {
+                  last_amount = std::min(remaining_bytes, data_length);
+
+                  in_stream.read(&data_buffer[0],static_cast<std::streamsize>(last_amount));
+
+                  block_type& rsblock = blocks[count];
+
+                  for (std::size_t i = 0; i < data_length; ++i)
+                  {
+                     rsblock.data[i] = (i < last_amount) ? static_cast<symbol_t>(data_buffer[i] & 0xFF) : 0x00;
+                  }
+
+                  rsblock.error = block_type::e_no_error;
+
+                  remaining_bytes -= last_amount;
+               }
+
+               encoder.encode_batch(&blocks[0], count);
+
+               /*
+                  Lay the encoded blocks out as file_encoder writes them,
+                  the last one of the file holding only its data bytes.
+               */
+               std::size_t amount = 0;
+
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  if (block_type::e_no_error != blocks[b].error)
+                  {
+                     std::cout << "reed_solomon::file_interleaved_encoder() - Error during encoding of block!" << std::endl;
+                     continue;
+                  }
+
+                  const std::size_t data_amount = ((b + 1) == count) ? last_amount : data_length;
+
+                  for (std::size_t i = 0; i < data_amount; ++i)
+                  {
+                     stack[amount++] = static_cast<char>(blocks[b].data[i] & 0xFF);
+                  }
+
+                  for (std::size_t i = 0; i < fec_length; ++i)
+                  {
+                     stack[amount++] = static_cast<char>(blocks[b].fec(i) & 0xFF);
+                  }
+               }
+
+               if (0 == amount)
+                  continue;
+
+               const std::size_t row_count = (amount + code_length - 1) / code_length;
+               const std::size_t partial   = amount - ((row_count - 1) * code_length);
+
+               interleave_stack(&stack[0], &interleaved_stack[0], code_length, row_count, partial);
+
+               out_stream.write(&interleaved_stack[0],static_cast<std::streamsize>(amount));
+            }
+
+            in_stream.close();
+            out_stream.close();
+         }
+      };
+
+      /*
+         dynamic_file_deinterleaver followed by file_decoder in one pass,
+         the inverse of file_interleaved_encoder. Each stack is
+         deinterleaved in memory and its blocks decoded as a batch, the
+         output being byte for byte that of the two separate passes.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class file_interleaved_decoder
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type block_type;
+
+         file_interleaved_decoder(const decoder_type& decoder,
+                                  const std::string& input_file_name,
+                                  const std::string& output_file_name,
+                                  const std::size_t stack_size)
+         {
+            if (0 == stack_size)
+            {
+               std::cout << "reed_solomon::file_interleaved_decoder() - Error: invalid stack size." << std::endl;
+               return;
+            }
+
+            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
+
+            if (0 == remaining_bytes)
+            {
+               std::cout << "reed_solomon::file_interleaved_decoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::file_interleaved_decoder() - Error: input file could not be opened." << std::endl;
+               return;
+            }
+
+            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::file_interleaved_decoder() - Error: output file could not be created." << std::endl;
+               return;
+            }
+
+            const std::size_t stack_length = code_length * stack_size;
+
+            std::vector<block_type> blocks           (stack_size);
+            std::vector<char>       interleaved_stack(stack_length);
+            std::vector<char>       stack            (stack_length);
+            std::vector<char>       output           (data_length * stack_size);
+
+            std::size_t block_index = 0;
+
+            while (remaining_bytes > 0)
+            {
+               const std::size_t amount    = std::min(remaining_bytes, stack_length);
+               const std::size_t row_count = (amount + code_length - 1) / code_length;
+               const std::size_t partial   = amount - ((row_count - 1) * code_length);
+
+               in_stream.read(&interleaved_stack[0],static_cast<std::streamsize>(amount));
+
+               deinterleave_stack(&interleaved_stack[0], &stack[0], code_length, row_count, partial);
+
+               remaining_bytes -= amount;
+
+               /*
+                  A short last block is its data bytes followed by its fec,
+                  the data being zero padded back to data_length.
+               */
+               std::size_t count = row_count;
+
+               if ((code_length != partial) && (partial <= fec_length))
+                  --count;
+
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  const char*       row         = &stack[b * code_length];
+                  const std::size_t length      = ((b + 1) == row_count) ? partial : code_length;
+                  const std::size_t data_amount = length - fec_length;
+
+                  block_type& rsblock = blocks[b];
+
+                  for (std::size_t i = 0; i < data_length; ++i)
+                  {
+                     rsblock.data[i] = (i < data_amount) ? static_cast<symbol_t>(row[i] & 0xFF) : 0;
+                  }
+
+                  for (std::size_t i = 0; i < fec_length; ++i)
+                  {
+                     rsblock.fec(i) = static_cast<symbol_t>(row[data_amount + i] & 0xFF);
+                  }
+
+                  rsblock.unrecoverable = false;
+               }
+
+               decoder.decode_batch(&blocks[0], count);
+
+               std::size_t output_amount = 0;
+
+               for (std::size_t b = 0; b < count; ++b, ++block_index)
+               {
+                  if (blocks[b].unrecoverable)
+                  {
+                     std::cout << "reed_solomon::file_interleaved_decoder() - Error during decoding of block " << block_index << "!" << std::endl;
+                     continue;
+                  }
+
+                  const std::size_t data_amount = (((b + 1) == row_count) ? partial : code_length) - fec_length;
+
+                  for (std::size_t i = 0; i < data_amount; ++i)
+                  {
+                     output[output_amount++] = static_cast<char>(blocks[b].data[i]);
+                  }
+               }
+
+               if (count < row_count)
+               {
+                  std::cout << "reed_solomon::file_interleaved_decoder() - Error during decoding of block " << block_index << "!" << std::endl;
+               }
+
+               out_stream.write(&output[0],static_cast<std::streamsize>(output_amount));
+            }
+
+            in_stream.close();
+            out_stream.close();
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -24,8 +24,12 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_INTERLEAVER_HPP
 
 
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "schifra/reed_solomon/schifra_reed_solomon_interleaving.hpp"
 #include "schifra/utils/schifra_fileio.hpp"
@@ -37,14 +41,28 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t block_length, std::size_t stack_size>
-      class file_interleaver
+      /*
+         Interleave a file stack_size rows of block_length bytes at a time,
+         both given at runtime so the depth can follow the channel's burst
+         statistics without an instantiation per depth. A final incomplete
+         stack is interleaved over the rows it holds, its last row possibly
+         partial, which is the layout file_updater expects.
+      */
+      class dynamic_file_interleaver
       {
       public:
 
-         file_interleaver(const std::string& input_file_name,
-                          const std::string& output_file_name)
+         dynamic_file_interleaver(const std::string& input_file_name,
+                                  const std::string& output_file_name,
+                                  const std::size_t block_length,
+                                  const std::size_t stack_size)
          {
+            if ((0 == block_length) || (0 == stack_size))
+            {
+               std::cout << "reed_solomon::file_interleaver() - Error: invalid stack dimensions." << std::endl;
+               return;
+            }
+
             std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
 
             if (0 == remaining_bytes)
@@ -69,87 +87,49 @@ namespace schifra
                return;
             }
 
-            while (remaining_bytes >= (block_length * stack_size))
-            {
-               process_block(in_stream,out_stream);
-               remaining_bytes -= (block_length * stack_size);
-            }
-
-            if (remaining_bytes > 0)
-            {
-               process_incomplete_block(in_stream,out_stream,remaining_bytes);
-            }
-
-            in_stream.close();
-            out_stream.close();
-         }
-
-      private:
-
-         inline void process_block(std::ifstream& in_stream,
-                                   std::ofstream& out_stream)
-         {
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
+            const std::size_t stack_length = block_length * stack_size;
 
-            interleave<char,block_length,stack_size>(block_stack_);
+            std::vector<char> stack            (stack_length);
+            std::vector<char> interleaved_stack(stack_length);
 
-            for (std::size_t i = 0; i < stack_size; ++i)
+            while (remaining_bytes > 0)
             {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-         }
+               const std::size_t amount    = std::min(remaining_bytes, stack_length);
+               const std::size_t row_count = (amount + block_length - 1) / block_length;
+               const std::size_t partial   = amount - ((row_count - 1) * block_length);
 
-         inline void process_incomplete_block(std::ifstream& in_stream,
-                                              std::ofstream& out_stream,
-                                              const std::size_t amount)
-         {
-            std::size_t complete_row_count = amount / block_length;
-            std::size_t remainder = amount % block_length;
+               in_stream.read(&stack[0],static_cast<std::streamsize>(amount));
 
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
+               interleave_stack(&stack[0], &interleaved_stack[0], block_length, row_count, partial);
 
-            if (remainder != 0)
-            {
-               in_stream.read(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
-
-            if (remainder == 0)
-               interleave<char,block_length,stack_size>(block_stack_,complete_row_count);
-            else
-               interleave<char,block_length>(block_stack_,complete_row_count + 1,remainder);
+               out_stream.write(&interleaved_stack[0],static_cast<std::streamsize>(amount));
 
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
+               remaining_bytes -= amount;
             }
 
-            if (remainder != 0)
-            {
-               out_stream.write(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
+            in_stream.close();
+            out_stream.close();
          }
-
-         data_block<char,block_length> block_stack_[stack_size];
-
       };
 
-      template <std::size_t block_length, std::size_t stack_size>
-      class file_deinterleaver
+      class dynamic_file_deinterleaver
       {
       public:
 
-         file_deinterleaver(const std::string& input_file_name,
-                            const std::string& output_file_name)
+         dynamic_file_deinterleaver(const std::string& input_file_name,
+                                    const std::string& output_file_name,
+                                    const std::size_t block_length,
+                                    const std::size_t stack_size)
          {
-            std::size_t input_file_size = schifra::fileio::file_size(input_file_name);
+            if ((0 == block_length) || (0 == stack_size))
+            {
+               std::cout << "reed_solomon::file_deinterleaver() - Error: invalid stack dimensions." << std::endl;
+               return;
+            }
 
-            if (input_file_size == 0)
+            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
+
+            if (0 == remaining_bytes)
             {
                std::cout << "reed_solomon::file_deinterleaver() - Error: input file has ZERO size." << std::endl;
                return;
@@ -171,73 +151,52 @@ namespace schifra
                return;
             }
 
-            for (std::size_t i = 0; i < (input_file_size / (block_length * stack_size)); ++i)
-            {
-               process_block(in_stream,out_stream);
-            }
+            const std::size_t stack_length = block_length * stack_size;
 
-            if ((input_file_size % (block_length * stack_size)) != 0)
-            {
-               process_incomplete_block(in_stream,out_stream,(input_file_size % (block_length * stack_size)));
-            }
-
-            in_stream.close();
-            out_stream.close();
-         }
+            std::vector<char> interleaved_stack(stack_length);
+            std::vector<char> stack            (stack_length);
 
-      private:
-
-         inline void process_block(std::ifstream& in_stream,
-                                   std::ofstream& out_stream)
-         {
-            for (std::size_t i = 0; i < stack_size; ++i)
+            while (remaining_bytes > 0)
             {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
+               const std::size_t amount    = std::min(remaining_bytes, stack_length);
+               const std::size_t row_count = (amount + block_length - 1) / block_length;
+               const std::size_t partial   = amount - ((row_count - 1) * block_length);
 
-            deinterleave<char,block_length,stack_size>(block_stack_);
-
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-         }
+               in_stream.read(&interleaved_stack[0],static_cast<std::streamsize>(amount));
 
-         inline void process_incomplete_block(std::ifstream& in_stream,
-                                              std::ofstream& out_stream,
-                                              const std::size_t amount)
-         {
-            std::size_t complete_row_count = amount / block_length;
-            std::size_t remainder = amount % block_length;
+               deinterleave_stack(&interleaved_stack[0], &stack[0], block_length, row_count, partial);
 
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
+               out_stream.write(&stack[0],static_cast<std::streamsize>(amount));
 
-            if (remainder != 0)
-            {
-               in_stream.read(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
+               remaining_bytes -= amount;
             }
 
-            if (remainder == 0)
-               deinterleave<char,block_length>(block_stack_,complete_row_count);
-            else
-               deinterleave<char,block_length>(block_stack_,complete_row_count + 1,remainder);
+            in_stream.close();
+            out_stream.close();
+         }
+      };
 
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
+      /* Fixed dimension forms, kept for existing callers */
+      template <std::size_t block_length, std::size_t stack_size>
+      class file_interleaver : public dynamic_file_interleaver
+      {
+      public:
 
-            if (remainder != 0)
-            {
-               out_stream.write(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
-         }
+         file_interleaver(const std::string& input_file_name,
+                          const std::string& output_file_name)
+         : dynamic_file_interleaver(input_file_name, output_file_name, block_length, stack_size)
+         {}
+      };
 
-         data_block<char,block_length> block_stack_[stack_size];
+      template <std::size_t block_length, std::size_t stack_size>
+      class file_deinterleaver : public dynamic_file_deinterleaver
+      {
+      public:
 
+         file_deinterleaver(const std::string& input_file_name,
+                            const std::string& output_file_name)
+         : dynamic_file_deinterleaver(input_file_name, output_file_name, block_length, stack_size)
+         {}
       };
 
    } // namespace reed_solomon
@@ -0,0 +1,350 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_PARITY_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_PARITY_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_decoder.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+#include "schifra/utils/schifra_object_pool.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace parity
+      {
+
+         /* Size of the parity sidecar of a data_size byte file */
+         inline std::size_t sidecar_size(const std::size_t data_size,
+                                         const std::size_t data_length,
+                                         const std::size_t fec_length)
+         {
+            return ((data_size + data_length - 1) / data_length) * fec_length;
+         }
+
+      } // namespace parity
+
+      /*
+         Parity only encoding: the file is left untouched and the fec of
+         each of its blocks is written, contiguously and in block order,
+         to a sidecar file. The fec bytes are those file_encoder would
+         interleave with the data (the last block being zero padded), so
+         encoding reads the file once and writes fec_length / data_length
+         of its size, and a healthy file is read directly with no decode.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class parity_file_encoder
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
+         typedef typename encoder_type::block_type block_type;
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
+         parity_file_encoder(const encoder_type& encoder,
+                             const std::string& data_file_name,
+                             const std::string& parity_file_name,
+                             const std::size_t buffer_size = default_buffer_size)
+         {
+            std::size_t remaining_bytes = schifra::fileio::file_size(data_file_name);
+            if (remaining_bytes == 0)
+            {
+               std::cout << "reed_solomon::parity_file_encoder() - Error: data file has ZERO size." << std::endl;
+               return;
+            }
+
+            std::ifstream in_stream(data_file_name.c_str(),std::ios::binary);
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::parity_file_encoder() - Error: data file could not be opened." << std::endl;
+               return;
+            }
+
+            std::ofstream out_stream(parity_file_name.c_str(),std::ios::binary);
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::parity_file_encoder() - Error: parity file could not be created." << std::endl;
+               return;
+            }
+
+            const std::size_t buffer_blocks = std::max<std::size_t>(1, buffer_size / data_length);
+
+            std::vector<unsigned char> data  (buffer_blocks * data_length);
+            std::vector<unsigned char> parity(buffer_blocks * fec_length );
+
+            while (remaining_bytes > 0)
+            {
+               const std::size_t read_amount = std::min(remaining_bytes, data.size());
+
+               in_stream.read(reinterpret_cast<char*>(&data[0]),static_cast<std::streamsize>(read_amount));
+
+               const std::size_t failures = encode_buffer(encoder, &data[0], read_amount, &parity[0]);
+
+               for (std::size_t i = 0; i < failures; ++i)
+               {
+                  std::cout << "reed_solomon::parity_file_encoder() - Error during encoding of block!" << std::endl;
+               }
+
+               out_stream.write(reinterpret_cast<const char*>(&parity[0]),
+                                static_cast<std::streamsize>(parity::sidecar_size(read_amount, data_length, fec_length)));
+
+               remaining_bytes -= read_amount;
+            }
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::parity_file_encoder() - Error: parity file could not be written." << std::endl;
+            }
+         }
+
+         /*
+            Write the fec of the blocks of amount bytes of data, the last of
+            which may be short and is zero padded, to parity. A block that
+            fails to encode leaves zero fec in its place, so the sidecar
+            stays aligned with the file, and the failures are counted.
+         */
+         static inline std::size_t encode_buffer(const encoder_type& encoder,
+                                                 const unsigned char* data,
+                                                 const std::size_t amount,
+                                                 unsigned char* parity)
+         {
+            const std::size_t complete_blocks = amount / data_length;
+            const std::size_t remaining_bytes = amount % data_length;
+
+            std::size_t failures = 0;
+
+            for (std::size_t b = 0; b < complete_blocks; ++b, data += data_length, parity += fec_length)
+            {
+               if (
+                    !encoder.encode(utils::span<const unsigned char>(data, data_length),
+                                    utils::span<unsigned char>(parity, fec_length))
+                  )
+               {
+                  std::memset(parity, 0, fec_length);
+                  ++failures;
+               }
+            }
+
+            /* Note: As in file_encoder, the padding of the last block is not a shortened prefix */
+            if (remaining_bytes > 0)
+            {
+               block_type rsblock;
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  rsblock.data[i] = (i < remaining_bytes) ? static_cast<symbol_t>(data[i]) : 0x00;
+               }
+
+               if (!encoder.encode(rsblock))
+               {
+                  std::memset(parity, 0, fec_length);
+                  return failures + 1;
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  parity[i] = static_cast<unsigned char>(rsblock.fec(i) & 0xFF);
+               }
+            }
+
+            return failures;
+         }
+      };
+
+      /*
+         Repairs a file from its parity_file_encoder sidecar, writing the
+         corrected data to the output file. Blocks are checked through
+         decoder::decode_batch() batch_blocks at a time, so healthy blocks
+         only cost a syndrome check. The output is always the size of the
+         file: an unrecoverable block is reported and passed through as
+         read.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class parity_file_decoder
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type block_type;
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+         static constexpr std::size_t batch_blocks        = 64;
+
+         parity_file_decoder(const decoder_type& decoder,
+                             const std::string& data_file_name,
+                             const std::string& parity_file_name,
+                             const std::string& output_file_name,
+                             const std::size_t buffer_size = default_buffer_size)
+         {
+            std::size_t remaining_bytes = schifra::fileio::file_size(data_file_name);
+            if (remaining_bytes == 0)
+            {
+               std::cout << "reed_solomon::parity_file_decoder() - Error: data file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (schifra::fileio::file_size(parity_file_name) != parity::sidecar_size(remaining_bytes, data_length, fec_length))
+            {
+               std::cout << "reed_solomon::parity_file_decoder() - Error: parity file size does not match the data file." << std::endl;
+               return;
+            }
+
+            std::ifstream data_stream(data_file_name.c_str(),std::ios::binary);
+            std::ifstream parity_stream(parity_file_name.c_str(),std::ios::binary);
+            if (!data_stream || !parity_stream)
+            {
+               std::cout << "reed_solomon::parity_file_decoder() - Error: input files could not be opened." << std::endl;
+               return;
+            }
+
+            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::parity_file_decoder() - Error: output file could not be created." << std::endl;
+               return;
+            }
+
+            const std::size_t buffer_blocks = std::max<std::size_t>(1, buffer_size / data_length);
+
+            std::vector<unsigned char> data  (buffer_blocks * data_length);
+            std::vector<unsigned char> parity(buffer_blocks * fec_length );
+            std::vector<std::size_t>   failed;
+
+            for (std::size_t block_index = 0; remaining_bytes > 0; block_index += buffer_blocks)
+            {
+               const std::size_t read_amount = std::min(remaining_bytes, data.size());
+
+               data_stream  .read(reinterpret_cast<char*>(&data  [0]),static_cast<std::streamsize>(read_amount));
+               parity_stream.read(reinterpret_cast<char*>(&parity[0]),
+                                  static_cast<std::streamsize>(parity::sidecar_size(read_amount, data_length, fec_length)));
+
+               failed.clear();
+
+               decode_buffer(decoder, &data[0], read_amount, &parity[0], block_index, failed);
+
+               for (std::size_t i = 0; i < failed.size(); ++i)
+               {
+                  std::cout << "reed_solomon::parity_file_decoder() - Error during decoding of block " << failed[i] << "!" << std::endl;
+               }
+
+               out_stream.write(reinterpret_cast<const char*>(&data[0]),static_cast<std::streamsize>(read_amount));
+
+               remaining_bytes -= read_amount;
+            }
+
+            if (!data_stream || !parity_stream || !out_stream)
+            {
+               std::cout << "reed_solomon::parity_file_decoder() - Error: file read or write failed." << std::endl;
+            }
+         }
+
+         /*
+            Correct amount bytes of data in place against the fec of its
+            blocks in parity. The indices (counted from first_block_index)
+            of the unrecoverable blocks are appended to failed, and their
+            data is left as it was.
+         */
+         static inline void decode_buffer(const decoder_type& decoder,
+                                          unsigned char* data,
+                                          const std::size_t amount,
+                                          const unsigned char* parity,
+                                          const std::size_t first_block_index,
+                                          std::vector<std::size_t>& failed)
+         {
+            const std::size_t block_count = (amount + data_length - 1) / data_length;
+
+            typename utils::object_pool<block_type>::array blocks = utils::object_pool<block_type>::acquire(std::min(batch_blocks, block_count));
+
+            for (std::size_t b = 0; b < block_count; b += batch_blocks)
+            {
+               const std::size_t count = std::min(batch_blocks, block_count - b);
+
+               for (std::size_t l = 0; l < count; ++l)
+               {
+                  const unsigned char* block_data  = data   + (b + l) * data_length;
+                  const unsigned char* block_fec   = parity + (b + l) * fec_length;
+                  const std::size_t    data_amount = std::min(data_length, amount - (b + l) * data_length);
+
+                  block_type& rsblock = blocks[l];
+
+                  for (std::size_t i = 0; i < data_length; ++i)
+                  {
+                     rsblock.data[i] = (i < data_amount) ? static_cast<typename block_type::symbol_type>(block_data[i]) : 0;
+                  }
+
+                  for (std::size_t i = 0; i < fec_length; ++i)
+                  {
+                     rsblock.fec(i) = static_cast<typename block_type::symbol_type>(block_fec[i]);
+                  }
+
+                  rsblock.unrecoverable = false;
+               }
+
+               decoder.decode_batch(&blocks[0], count);
+
+               for (std::size_t l = 0; l < count; ++l)
+               {
+                  if (blocks[l].unrecoverable)
+                  {
+                     failed.push_back(first_block_index + b + l);
+                     continue;
+                  }
+
+                  if (0 == blocks[l].errors_corrected)
+                     continue;
+
+                  unsigned char*    block_data  = data + (b + l) * data_length;
+                  const std::size_t data_amount = std::min(data_length, amount - (b + l) * data_length);
+
+                  for (std::size_t i = 0; i < data_amount; ++i)
+                  {
+                     block_data[i] = static_cast<unsigned char>(blocks[l].data[i]);
+                  }
+               }
+            }
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
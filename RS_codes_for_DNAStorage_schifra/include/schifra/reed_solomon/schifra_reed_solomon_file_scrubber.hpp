@@ -0,0 +1,361 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_SCRUBBER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_SCRUBBER_HPP
+
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_bitio.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_parallel_file_codec.hpp"
+#include "schifra/utils/schifra_io_backend.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Outcome of scrubbing: codewords checked, those with non-zero
+         syndromes, those of them corrected, and the indices of the rest,
+         which could not be. io_success is false when the file could not
+         be opened or a read or write failed.
+      */
+      struct scrub_report
+      {
+         scrub_report()
+         : blocks  (0),
+           dirty   (0),
+           repaired(0),
+           io_success(true)
+         {}
+
+         std::uint64_t            blocks;
+         std::uint64_t            dirty;
+         std::uint64_t            repaired;
+         std::vector<std::size_t> failed;
+         bool                     io_success;
+      };
+
+      /*
+         Integrity scrubbing of files written by file_encoder or
+         parallel_file_encoder: codewords of code_length bytes back to
+         back, the last one possibly short. Whole codeword chunks are read
+         through a FileIO backend, at most bytes_per_second (0 for no cap)
+         so that foreground I/O keeps the device, and threads workers (0
+         for one per hardware thread) check them with verify_batch()
+         straight from the read buffer. Only dirty codewords are decoded.
+         With repair, a chunk in which codewords were corrected is written
+         back where it was read from, the others are only read.
+
+         start() runs scrub() over a set of files in a background thread,
+         pass after pass, until stop().
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class file_scrubber
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type block_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+         file_scrubber(const decoder_type& decoder,
+                       const std::size_t threads = 0,
+                       const std::uint64_t bytes_per_second = 0,
+                       const std::size_t buffer_size = default_buffer_size)
+         : decoder_(decoder),
+           threads_(details::pipeline_threads(threads)),
+           bytes_per_second_(bytes_per_second),
+           buffer_size_(buffer_size),
+           running_(false),
+           passes_(0),
+           failed_(0)
+         {}
+
+        ~file_scrubber()
+         {
+            stop();
+         }
+
+         /* Scrub one file, through a default constructed FileIO */
+         inline scrub_report scrub(const std::string& file_name, const bool repair = true) const
+         {
+            FileIO io;
+            return scrub(io, file_name, repair);
+         }
+
+         inline scrub_report scrub(FileIO& io, const std::string& file_name, const bool repair = true) const
+         {
+            scrub_report report;
+
+            const std::size_t file_size = schifra::fileio::file_size(file_name);
+
+            if (0 == file_size)
+               return report;
+
+            if (!io.open_in_place(file_name))
+            {
+               std::cout << "reed_solomon::file_scrubber() - Error: file could not be opened." << std::endl;
+               io.close();
+               report.io_success = false;
+               return report;
+            }
+
+            const std::size_t chunk_blocks = details::pipeline_chunk_blocks(buffer_size_, io.alignment(), code_length, data_length);
+
+            report.io_success = details::run_file_pipeline(io,
+                                       file_size,
+                                       chunk_blocks * code_length,
+                                       0,
+                                       threads_,
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          scrub_chunk(chunk, chunk.index * chunk_blocks, repair);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          report.blocks   += (chunk.amount + code_length - 1) / code_length;
+                                          report.dirty    += chunk.failures;
+                                          report.repaired += chunk.repaired;
+                                          report.failed.insert(report.failed.end(), chunk.failed.begin(), chunk.failed.end());
+                                       },
+                                       true,
+                                       bytes_per_second_);
+
+            if (!report.io_success)
+            {
+               std::cout << "reed_solomon::file_scrubber() - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            return report;
+         }
+
+         /*
+            Scrub file_names over and over in a background thread, waiting
+            interval after each pass, until stop(). Failed codewords are
+            reported per file in totals() only as counts.
+         */
+         inline void start(const std::vector<std::string>& file_names,
+                           const bool repair = true,
+                           const std::chrono::milliseconds interval = std::chrono::milliseconds(0))
+         {
+            stop();
+
+            running_ = true;
+
+            thread_ = std::thread([this, file_names, repair, interval]()
+                                  {
+                                     std::unique_lock<std::mutex> lock(mutex_);
+
+                                     while (running_)
+                                     {
+                                        for (std::size_t i = 0; running_ && (i < file_names.size()); ++i)
+                                        {
+                                           lock.unlock();
+
+                                           const scrub_report report = scrub(file_names[i], repair);
+
+                                           lock.lock();
+
+                                           totals_.blocks     += report.blocks;
+                                           totals_.dirty      += report.dirty;
+                                           totals_.repaired   += report.repaired;
+                                           totals_.io_success  = totals_.io_success && report.io_success;
+                                           failed_            += report.failed.size();
+                                        }
+
+                                        ++passes_;
+
+                                        stopped_.wait_for(lock, interval, [this]() { return !running_; });
+                                     }
+                                  });
+         }
+
+         /* Returns once the file being scrubbed, if any, is done */
+         inline void stop()
+         {
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               running_ = false;
+            }
+
+            stopped_.notify_all();
+
+            if (thread_.joinable())
+               thread_.join();
+         }
+
+         /*
+            Counts of the background passes so far, failed being empty and
+            failed_blocks() giving their number.
+         */
+         inline scrub_report totals() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return totals_;
+         }
+
+         inline std::uint64_t failed_blocks() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return failed_;
+         }
+
+         /* Complete passes over the files given to start() */
+         inline std::size_t passes() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return passes_;
+         }
+
+      private:
+
+         file_scrubber(const file_scrubber&);
+         file_scrubber& operator=(const file_scrubber&);
+
+         /*
+            Check the codewords of chunk, the first of which is codeword
+            first_block of the file, correcting the dirty ones in the
+            chunk's buffer. failures counts the dirty codewords, repaired
+            those corrected; with repair the chunk is to be written back
+            when any was.
+         */
+         inline void scrub_chunk(details::file_chunk& chunk, const std::size_t first_block, const bool repair) const
+         {
+            static thread_local std::vector<std::uint64_t> dirty;
+
+            unsigned char* codewords = &chunk.input[0];
+
+            const std::size_t complete_blocks = chunk.amount / code_length;
+            const std::size_t remaining_bytes = chunk.amount % code_length;
+
+            chunk.failed.clear();
+            chunk.failures      = 0;
+            chunk.repaired      = 0;
+            chunk.output_amount = 0;
+
+            if (decoder_.verify_batch(static_cast<const unsigned char*>(codewords), complete_blocks, dirty) > 0)
+            {
+               block_type rsblock;
+
+               for (std::size_t b = 0; b < complete_blocks; ++b)
+               {
+                  if (0 == (dirty[b / 64] & (static_cast<std::uint64_t>(1) << (b % 64))))
+                     continue;
+
+                  unsigned char* codeword = codewords + b * code_length;
+
+                  bitio::unpack_symbols<8>(codeword, rsblock.data, code_length);
+
+                  repair_block(chunk, rsblock, first_block + b, codeword, data_length);
+               }
+            }
+
+            if (remaining_bytes > fec_length)
+            {
+               const std::size_t data_amount = remaining_bytes - fec_length;
+
+               unsigned char* codeword = codewords + complete_blocks * code_length;
+
+               block_type rsblock;
+
+               bitio::unpack_symbols<8>(codeword, rsblock.data, data_amount);
+               std::fill(rsblock.data + data_amount, rsblock.data + data_length, static_cast<typename block_type::symbol_type>(0));
+               bitio::unpack_symbols<8>(codeword + data_amount, rsblock.data + data_length, fec_length);
+
+               if (!decoder_.verify(rsblock))
+               {
+                  repair_block(chunk, rsblock, first_block + complete_blocks, codeword, data_amount);
+               }
+            }
+            else if (remaining_bytes > 0)
+            {
+               ++chunk.failures;
+               chunk.failed.push_back(first_block + complete_blocks);
+            }
+
+            if (repair && (chunk.repaired > 0))
+            {
+               chunk.output_amount = chunk.amount;
+            }
+         }
+
+         /*
+            Decode dirty block rsblock, stored at codeword as data_amount
+            data symbols then its fec, writing it back there when corrected
+         */
+         inline void repair_block(details::file_chunk& chunk, block_type& rsblock, const std::size_t block_index,
+                                  unsigned char* codeword, const std::size_t data_amount) const
+         {
+            ++chunk.failures;
+
+            if (!decoder_.decode(rsblock))
+            {
+               chunk.failed.push_back(block_index);
+               return;
+            }
+
+            bitio::pack_symbols<8>(rsblock.data, data_amount, codeword);
+            bitio::pack_symbols<8>(rsblock.data + data_length, fec_length, codeword + data_amount);
+
+            ++chunk.repaired;
+         }
+
+         const decoder_type&       decoder_;
+         const std::size_t         threads_;
+         const std::uint64_t       bytes_per_second_;
+         const std::size_t         buffer_size_;
+         mutable std::mutex        mutex_;
+         std::condition_variable   stopped_;
+         std::thread               thread_;
+         bool                      running_;
+         std::size_t               passes_;
+         std::uint64_t             failed_;
+         scrub_report              totals_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,670 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_STRIPED_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_STRIPED_CODEC_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_file_container.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_interleaving.hpp"
+#include "schifra/utils/schifra_ring_queue.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Striped output over several files or devices. The input is
+         encoded stack_size codewords at a time and each stack is
+         interleaved, as erasure_channel_stack_encode() interleaves one, so
+         that symbol c of every codeword of the stack forms column c, a
+         contiguous run of stack_size bytes. Stripe d of n holds columns
+         [d * code_length / n, (d + 1) * code_length / n) of every stack,
+         so a lost stripe erases the same symbols of every codeword and is
+         recovered as such while its column count stays within fec_length.
+         The last stack is zero padded. Each stripe starts with a header,
+         all fields little endian:
+
+            header (64 bytes)
+               magic "SCHIFRAS", version, code_length, fec_length,
+               stack_size, stripe count, stripe index (all 32 bit), data
+               size (64 bit, at offset 40) and the CRC-32 of the preceding
+               56 bytes (at offset 56).
+      */
+      namespace stripe
+      {
+
+         static constexpr char          magic[8]    = {'S','C','H','I','F','R','A','S'};
+         static constexpr std::uint32_t version     = 1;
+         static constexpr std::size_t   header_size = 64;
+
+         struct header
+         {
+            std::uint32_t code_length;
+            std::uint32_t fec_length;
+            std::uint32_t stack_size;
+            std::uint32_t stripe_count;
+            std::uint32_t stripe_index;
+            std::uint64_t data_size;
+         };
+
+         inline std::size_t first_column(const std::size_t stripe_index,
+                                         const std::size_t stripe_count,
+                                         const std::size_t code_length)
+         {
+            return (stripe_index * code_length) / stripe_count;
+         }
+
+         inline void write_header(const header& h, unsigned char* buffer)
+         {
+            std::memset(buffer, 0, header_size);
+            std::memcpy(buffer, magic, sizeof(magic));
+
+            container::store(&buffer[ 8], version       , 4);
+            container::store(&buffer[12], h.code_length , 4);
+            container::store(&buffer[16], h.fec_length  , 4);
+            container::store(&buffer[20], h.stack_size  , 4);
+            container::store(&buffer[24], h.stripe_count, 4);
+            container::store(&buffer[28], h.stripe_index, 4);
+            container::store(&buffer[40], h.data_size   , 8);
+            container::store(&buffer[56], container::crc(buffer, 56), 4);
+         }
+
+         inline bool read_header(std::istream& stream, header& h)
+         {
+            unsigned char buffer[header_size];
+
+            stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(header_size));
+
+            if (
+                 stream.fail()                                              ||
+                 (0 != std::memcmp(buffer, magic, sizeof(magic)))          ||
+                 (version != container::load(&buffer[8], 4))               ||
+                 (container::crc(buffer, 56) != container::load(&buffer[56], 4))
+               )
+            {
+               return false;
+            }
+
+            h.code_length  = static_cast<std::uint32_t>(container::load(&buffer[12], 4));
+            h.fec_length   = static_cast<std::uint32_t>(container::load(&buffer[16], 4));
+            h.stack_size   = static_cast<std::uint32_t>(container::load(&buffer[20], 4));
+            h.stripe_count = static_cast<std::uint32_t>(container::load(&buffer[24], 4));
+            h.stripe_index = static_cast<std::uint32_t>(container::load(&buffer[28], 4));
+            h.data_size    = container::load(&buffer[40], 8);
+
+            return true;
+         }
+
+         /* Stacks of a run, each with one buffer per stripe */
+         struct chunk
+         {
+            std::size_t                             index;
+            std::size_t                             stacks;
+            std::atomic<std::size_t>                remaining;
+            std::vector<std::vector<unsigned char> > stripes;
+            std::vector<unsigned char>              lost;
+         };
+
+      } // namespace stripe
+
+      /*
+         Encode a file into stripe_file_names.size() stripes, each written
+         by a dedicated writer thread, so the aggregate bandwidth scales
+         with the number of devices. The calling thread reads and encodes
+         buffer_size (rounded to whole stacks) at a time, and chunks are
+         recycled through a small pool so memory stays bounded.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class striped_file_encoder
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
+
+         static constexpr std::size_t default_stack_size  = 64;
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+         static constexpr std::size_t pool_size           = 4;
+
+         striped_file_encoder(const encoder_type& encoder,
+                              const std::string& input_file_name,
+                              const std::vector<std::string>& stripe_file_names,
+                              const std::size_t stack_size  = default_stack_size,
+                              const std::size_t buffer_size = default_buffer_size)
+         {
+            const std::size_t stripe_count = stripe_file_names.size();
+
+            if ((0 == stripe_count) || (stripe_count > code_length) || (0 == stack_size))
+            {
+               std::cout << "reed_solomon::striped_file_encoder() - Error: invalid stripe count or stack size." << std::endl;
+               return;
+            }
+
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+            if (input_size == 0)
+            {
+               std::cout << "reed_solomon::striped_file_encoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            std::ifstream in_stream(input_file_name.c_str(),std::ios::binary);
+            if (!in_stream)
+            {
+               std::cout << "reed_solomon::striped_file_encoder() - Error: input file could not be opened." << std::endl;
+               return;
+            }
+
+            std::vector<std::ofstream> out_streams(stripe_count);
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               out_streams[d].open(stripe_file_names[d].c_str(),std::ios::binary);
+
+               if (!out_streams[d])
+               {
+                  std::cout << "reed_solomon::striped_file_encoder() - Error: stripe file " << stripe_file_names[d] << " could not be created." << std::endl;
+                  return;
+               }
+
+               stripe::header h = stripe::header();
+
+               h.code_length  = static_cast<std::uint32_t>(code_length);
+               h.fec_length   = static_cast<std::uint32_t>(fec_length);
+               h.stack_size   = static_cast<std::uint32_t>(stack_size);
+               h.stripe_count = static_cast<std::uint32_t>(stripe_count);
+               h.stripe_index = static_cast<std::uint32_t>(d);
+               h.data_size    = input_size;
+
+               unsigned char header_buffer[stripe::header_size];
+
+               stripe::write_header(h, header_buffer);
+
+               out_streams[d].write(reinterpret_cast<const char*>(header_buffer), static_cast<std::streamsize>(stripe::header_size));
+            }
+
+            const std::size_t stack_data   = stack_size * data_length;
+            const std::size_t stack_length = stack_size * code_length;
+            const std::size_t chunk_stacks = std::max<std::size_t>(1, buffer_size / stack_length);
+            const std::size_t stack_count  = (input_size + stack_data - 1) / stack_data;
+
+            std::vector<stripe::chunk> chunks(pool_size);
+
+            utils::mpmc_ring<stripe::chunk*> free_chunks(chunks.size());
+
+            std::deque<utils::spsc_ring<stripe::chunk*> > write_queues;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               write_queues.emplace_back(chunks.size());
+            }
+
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+            {
+               chunks[i].stripes.resize(stripe_count);
+
+               for (std::size_t d = 0; d < stripe_count; ++d)
+               {
+                  const std::size_t columns = stripe::first_column(d + 1, stripe_count, code_length) -
+                                              stripe::first_column(d    , stripe_count, code_length);
+
+                  chunks[i].stripes[d].resize(chunk_stacks * columns * stack_size);
+               }
+
+               free_chunks.push(&chunks[i]);
+            }
+
+            std::vector<unsigned char> write_failed(stripe_count, 0);
+            std::vector<std::thread>   writers;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               writers.push_back(std::thread([&, d]()
+                                 {
+                                    stripe::chunk* chunk = 0;
+
+                                    const std::size_t columns = stripe::first_column(d + 1, stripe_count, code_length) -
+                                                                stripe::first_column(d    , stripe_count, code_length);
+
+                                    while (write_queues[d].pop(chunk))
+                                    {
+                                       out_streams[d].write(reinterpret_cast<const char*>(&chunk->stripes[d][0]),
+                                                            static_cast<std::streamsize>(chunk->stacks * columns * stack_size));
+
+                                       if (out_streams[d].fail())
+                                          write_failed[d] = 1;
+
+                                       if (1 == chunk->remaining.fetch_sub(1))
+                                          free_chunks.push(chunk);
+                                    }
+                                 }));
+            }
+
+            std::vector<unsigned char> data       (stack_data);
+            std::vector<unsigned char> stack      (stack_length);
+            std::vector<unsigned char> interleaved(stack_length);
+
+            std::size_t remaining_bytes = input_size;
+
+            for (std::size_t s = 0; s < stack_count;)
+            {
+               stripe::chunk* chunk = 0;
+
+               free_chunks.pop(chunk);
+
+               chunk->stacks = std::min(chunk_stacks, stack_count - s);
+
+               for (std::size_t k = 0; k < chunk->stacks; ++k, ++s)
+               {
+                  const std::size_t read_amount = std::min(remaining_bytes, stack_data);
+
+                  in_stream.read(reinterpret_cast<char*>(&data[0]), static_cast<std::streamsize>(read_amount));
+
+                  std::fill(data.begin() + read_amount, data.end(), static_cast<unsigned char>(0));
+
+                  remaining_bytes -= read_amount;
+
+                  for (std::size_t b = 0; b < stack_size; ++b)
+                  {
+                     unsigned char* row = &stack[b * code_length];
+
+                     std::memcpy(row, &data[b * data_length], data_length);
+
+                     if (
+                          !encoder.encode(utils::span<const unsigned char>(row, data_length),
+                                          utils::span<unsigned char>(row + data_length, fec_length))
+                        )
+                     {
+                        std::cout << "reed_solomon::striped_file_encoder() - Error during encoding of block!" << std::endl;
+                        std::memset(row + data_length, 0, fec_length);
+                     }
+                  }
+
+                  interleave_stack(&stack[0], &interleaved[0], code_length, stack_size, code_length);
+
+                  for (std::size_t d = 0; d < stripe_count; ++d)
+                  {
+                     const std::size_t first = stripe::first_column(d    , stripe_count, code_length);
+                     const std::size_t last  = stripe::first_column(d + 1, stripe_count, code_length);
+
+                     std::memcpy(&chunk->stripes[d][k * (last - first) * stack_size],
+                                 &interleaved[first * stack_size],
+                                 (last - first) * stack_size);
+                  }
+               }
+
+               chunk->remaining = stripe_count;
+
+               for (std::size_t d = 0; d < stripe_count; ++d)
+               {
+                  write_queues[d].push(chunk);
+               }
+            }
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               write_queues[d].close();
+               writers[d].join();
+
+               if (write_failed[d])
+               {
+                  std::cout << "reed_solomon::striped_file_encoder() - Error: stripe file " << stripe_file_names[d] << " could not be written." << std::endl;
+               }
+            }
+         }
+      };
+
+      /*
+         Decode the stripes of a striped_file_encoder file, each read by
+         a dedicated reader thread. A stripe that is missing, has a bad
+         header or comes up short is treated as lost, its columns being
+         erasures in every codeword it covers, and the file is recovered
+         as long as the erased columns, plus twice any symbol errors, fit
+         in fec_length. As with file_decoder, unrecoverable blocks are
+         reported and left out of the output.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class striped_file_decoder
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,code_length - fec_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type block_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+         static constexpr std::size_t pool_size           = 4;
+
+         striped_file_decoder(const decoder_type& decoder,
+                              const std::vector<std::string>& stripe_file_names,
+                              const std::string& output_file_name,
+                              const std::size_t buffer_size = default_buffer_size)
+         {
+            const std::size_t stripe_count = stripe_file_names.size();
+
+            if ((0 == stripe_count) || (stripe_count > code_length))
+            {
+               std::cout << "reed_solomon::striped_file_decoder() - Error: invalid stripe count." << std::endl;
+               return;
+            }
+
+            std::vector<std::ifstream> in_streams(stripe_count);
+            std::vector<unsigned char> lost      (stripe_count, 1);
+
+            stripe::header h = stripe::header();
+            bool           have_header = false;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               in_streams[d].open(stripe_file_names[d].c_str(),std::ios::binary);
+
+               stripe::header stripe_header;
+
+               if (!in_streams[d] || !stripe::read_header(in_streams[d], stripe_header))
+               {
+                  std::cout << "reed_solomon::striped_file_decoder() - Error: stripe file " << stripe_file_names[d] << " is missing or invalid." << std::endl;
+                  continue;
+               }
+
+               if (
+                    (stripe_header.code_length  != code_length )  ||
+                    (stripe_header.fec_length   != fec_length  )  ||
+                    (stripe_header.stripe_count != stripe_count)  ||
+                    (stripe_header.stripe_index != d           )  ||
+                    (0 == stripe_header.stack_size)               ||
+                    (have_header && ((stripe_header.stack_size != h.stack_size) || (stripe_header.data_size != h.data_size)))
+                  )
+               {
+                  std::cout << "reed_solomon::striped_file_decoder() - Error: stripe file " << stripe_file_names[d] << " does not belong to this set." << std::endl;
+                  continue;
+               }
+
+               h           = stripe_header;
+               have_header = true;
+               lost[d]     = 0;
+            }
+
+            erasure_locations_t erasures;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               if (!lost[d])
+                  continue;
+
+               for (std::size_t c = stripe::first_column(d, stripe_count, code_length); c < stripe::first_column(d + 1, stripe_count, code_length); ++c)
+               {
+                  erasures.push_back(c);
+               }
+            }
+
+            if (!have_header || (erasures.size() > fec_length))
+            {
+               std::cout << "reed_solomon::striped_file_decoder() - Error: too many stripes lost to recover the file." << std::endl;
+               return;
+            }
+
+            std::ofstream out_stream(output_file_name.c_str(),std::ios::binary);
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::striped_file_decoder() - Error: output file could not be created." << std::endl;
+               return;
+            }
+
+            const std::size_t stack_size   = h.stack_size;
+            const std::size_t stack_data   = stack_size * data_length;
+            const std::size_t stack_length = stack_size * code_length;
+            const std::size_t chunk_stacks = std::max<std::size_t>(1, buffer_size / stack_length);
+            const std::size_t stack_count  = static_cast<std::size_t>((h.data_size + stack_data - 1) / stack_data);
+            const std::size_t chunk_count  = (stack_count + chunk_stacks - 1) / chunk_stacks;
+
+            std::vector<stripe::chunk> chunks(pool_size);
+
+            utils::mpmc_ring<stripe::chunk*> free_chunks(chunks.size());
+            utils::mpmc_ring<stripe::chunk*> read_chunks(chunks.size());
+
+            std::deque<utils::spsc_ring<stripe::chunk*> > read_queues;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               read_queues.emplace_back(chunks.size());
+            }
+
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+            {
+               chunks[i].stripes.resize(stripe_count);
+               chunks[i].lost   .resize(stripe_count);
+
+               for (std::size_t d = 0; d < stripe_count; ++d)
+               {
+                  const std::size_t columns = stripe::first_column(d + 1, stripe_count, code_length) -
+                                              stripe::first_column(d    , stripe_count, code_length);
+
+                  chunks[i].stripes[d].resize(chunk_stacks * columns * stack_size);
+               }
+
+               free_chunks.push(&chunks[i]);
+            }
+
+            std::vector<std::thread> readers;
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               readers.push_back(std::thread([&, d]()
+                                 {
+                                    stripe::chunk* chunk = 0;
+
+                                    const std::size_t columns = stripe::first_column(d + 1, stripe_count, code_length) -
+                                                                stripe::first_column(d    , stripe_count, code_length);
+
+                                    while (read_queues[d].pop(chunk))
+                                    {
+                                       chunk->lost[d] = lost[d];
+
+                                       if (!lost[d])
+                                       {
+                                          in_streams[d].read(reinterpret_cast<char*>(&chunk->stripes[d][0]),
+                                                             static_cast<std::streamsize>(chunk->stacks * columns * stack_size));
+
+                                          if (in_streams[d].fail())
+                                          {
+                                             std::cout << "reed_solomon::striped_file_decoder() - Error: stripe file " << stripe_file_names[d] << " came up short." << std::endl;
+                                             lost[d]        = 1;
+                                             chunk->lost[d] = 1;
+                                          }
+                                       }
+
+                                       if (1 == chunk->remaining.fetch_sub(1))
+                                          read_chunks.push(chunk);
+                                    }
+                                 }));
+            }
+
+            /*
+               Note: Chunks are handed to the readers by a dispatcher
+                     thread, so the calling thread decodes one chunk while
+                     the next ones are being read.
+            */
+            std::thread dispatcher([&]()
+                                   {
+                                      for (std::size_t c = 0; c < chunk_count; ++c)
+                                      {
+                                         stripe::chunk* chunk = 0;
+
+                                         if (!free_chunks.pop(chunk))
+                                            break;
+
+                                         chunk->index     = c;
+                                         chunk->stacks    = std::min(chunk_stacks, stack_count - c * chunk_stacks);
+                                         chunk->remaining = stripe_count;
+
+                                         for (std::size_t d = 0; d < stripe_count; ++d)
+                                         {
+                                            read_queues[d].push(chunk);
+                                         }
+                                      }
+                                   });
+
+            std::map<std::size_t,stripe::chunk*> pending;
+
+            std::vector<unsigned char> interleaved(stack_length);
+            std::vector<unsigned char> stack      (stack_length);
+            std::vector<block_type>    blocks     (stack_size);
+            std::vector<unsigned char> output     (stack_data);
+
+            std::uint64_t remaining_bytes = h.data_size;
+            std::size_t   block_index     = 0;
+
+            for (std::size_t next = 0; next < chunk_count;)
+            {
+               stripe::chunk* chunk = 0;
+
+               read_chunks.pop(chunk);
+
+               pending[chunk->index] = chunk;
+
+               while (!pending.empty() && (pending.begin()->first == next))
+               {
+                  chunk = pending.begin()->second;
+
+                  pending.erase(pending.begin());
+                  ++next;
+
+                  erasure_locations_t chunk_erasures;
+
+                  for (std::size_t d = 0; d < stripe_count; ++d)
+                  {
+                     if (!chunk->lost[d])
+                        continue;
+
+                     for (std::size_t c = stripe::first_column(d, stripe_count, code_length); c < stripe::first_column(d + 1, stripe_count, code_length); ++c)
+                     {
+                        chunk_erasures.push_back(c);
+                     }
+                  }
+
+                  for (std::size_t k = 0; k < chunk->stacks; ++k)
+                  {
+                     for (std::size_t d = 0; d < stripe_count; ++d)
+                     {
+                        const std::size_t first = stripe::first_column(d    , stripe_count, code_length);
+                        const std::size_t last  = stripe::first_column(d + 1, stripe_count, code_length);
+
+                        if (chunk->lost[d])
+                           std::memset(&interleaved[first * stack_size], 0, (last - first) * stack_size);
+                        else
+                           std::memcpy(&interleaved[first * stack_size],
+                                       &chunk->stripes[d][k * (last - first) * stack_size],
+                                       (last - first) * stack_size);
+                     }
+
+                     deinterleave_stack(&interleaved[0], &stack[0], code_length, stack_size, code_length);
+
+                     for (std::size_t b = 0; b < stack_size; ++b)
+                     {
+                        for (std::size_t i = 0; i < code_length; ++i)
+                        {
+                           blocks[b][i] = static_cast<symbol_t>(stack[b * code_length + i]);
+                        }
+
+                        blocks[b].unrecoverable = false;
+                     }
+
+                     if (chunk_erasures.empty())
+                        decoder.decode_batch(&blocks[0], stack_size);
+                     else
+                     {
+                        for (std::size_t b = 0; b < stack_size; ++b)
+                        {
+                           decoder.decode(blocks[b], chunk_erasures);
+                        }
+                     }
+
+                     const std::size_t stack_amount = static_cast<std::size_t>(std::min<std::uint64_t>(remaining_bytes, stack_data));
+
+                     std::size_t output_amount = 0;
+
+                     for (std::size_t b = 0; (b * data_length) < stack_amount; ++b, ++block_index)
+                     {
+                        if (blocks[b].unrecoverable)
+                        {
+                           std::cout << "reed_solomon::striped_file_decoder() - Error during decoding of block " << block_index << "!" << std::endl;
+                           continue;
+                        }
+
+                        const std::size_t data_amount = std::min(data_length, stack_amount - b * data_length);
+
+                        for (std::size_t i = 0; i < data_amount; ++i)
+                        {
+                           output[output_amount++] = static_cast<unsigned char>(blocks[b].data[i]);
+                        }
+                     }
+
+                     out_stream.write(reinterpret_cast<const char*>(&output[0]), static_cast<std::streamsize>(output_amount));
+
+                     remaining_bytes -= stack_amount;
+                  }
+
+                  free_chunks.push(chunk);
+               }
+            }
+
+            dispatcher.join();
+
+            for (std::size_t d = 0; d < stripe_count; ++d)
+            {
+               read_queues[d].close();
+               readers[d].join();
+            }
+
+            if (!out_stream)
+            {
+               std::cout << "reed_solomon::striped_file_decoder() - Error: output file could not be written." << std::endl;
+            }
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,197 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FILE_UPDATER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_UPDATER_HPP
+
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_interleaving.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         In place modification of a file produced by file_encoder, or by
+         file_encoder followed by file_interleaver<code_length,stack_size>
+         when stack_size > 1. Offsets passed to update() are offsets into
+         the original (unencoded) data. Only the modified data bytes and the
+         fec bytes of the affected codewords are read and rewritten, the
+         parity being patched through encoder::update_parity().
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t stack_size = 1,
+                typename symbol_t = galois::field_symbol>
+      class file_updater
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,code_length - fec_length,symbol_t> encoder_type;
+
+         file_updater(const encoder_type& encoder, const std::string& file_name)
+         : encoder_(encoder),
+           file_size_(schifra::fileio::file_size(file_name)),
+           stream_(file_name.c_str(), std::ios::in | std::ios::out | std::ios::binary)
+         {
+            if (!stream_)
+            {
+               std::cout << "reed_solomon::file_updater() - Error: file could not be opened." << std::endl;
+            }
+         }
+
+         inline bool update(const std::size_t data_offset, const std::string& data)
+         {
+            return update(data_offset, data.data(), data.size());
+         }
+
+         bool update(const std::size_t data_offset, const char* data, const std::size_t length)
+         {
+            if (!stream_)
+               return false;
+
+            std::size_t processed = 0;
+
+            while (processed < length)
+            {
+               const std::size_t offset       = data_offset + processed;
+               const std::size_t record_start = (offset / data_length) * code_length;
+               const std::size_t position     = (offset % data_length);
+
+               if (record_start >= file_size_)
+                  return false;
+
+               const std::size_t record_size = std::min(code_length, file_size_ - record_start);
+
+               if ((record_size <= fec_length) || (position >= (record_size - fec_length)))
+                  return false;
+
+               const std::size_t record_data = record_size - fec_length;
+               const std::size_t count       = std::min(length - processed, record_data - position);
+
+               for (std::size_t i = 0; i < count; ++i)
+               {
+                  old_buffer_[i] = read_symbol(record_start + position + i);
+                  new_buffer_[i] = static_cast<unsigned char>(data[processed + i]);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  fec_buffer_[i] = read_symbol(record_start + record_data + i);
+               }
+
+               if (!stream_)
+                  return false;
+
+               if (
+                    !encoder_.update_parity(utils::span<unsigned char>(fec_buffer_, fec_length),
+                                            position,
+                                            utils::span<const unsigned char>(old_buffer_, count),
+                                            utils::span<const unsigned char>(new_buffer_, count))
+                  )
+               {
+                  std::cout << "reed_solomon::file_updater.update() - Error during parity update!" << std::endl;
+                  return false;
+               }
+
+               for (std::size_t i = 0; i < count; ++i)
+               {
+                  write_symbol(record_start + position + i, new_buffer_[i]);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  write_symbol(record_start + record_data + i, fec_buffer_[i]);
+               }
+
+               if (!stream_)
+                  return false;
+
+               processed += count;
+            }
+
+            stream_.flush();
+
+            return static_cast<bool>(stream_);
+         }
+
+      private:
+
+         file_updater(const file_updater&);
+         file_updater& operator=(const file_updater&);
+
+         static const std::size_t data_length = code_length - fec_length;
+
+         /* Offset in the file of the symbol at offset encoded_offset of the file_encoder output */
+         inline std::size_t file_offset(const std::size_t encoded_offset) const
+         {
+            if (1 == stack_size)
+               return encoded_offset;
+
+            const std::size_t stack_length = code_length * stack_size;
+            const std::size_t stack_start  = (encoded_offset / stack_length) * stack_length;
+            const std::size_t within       = (encoded_offset % stack_length);
+            const std::size_t available    = std::min(stack_length, file_size_ - stack_start);
+            const std::size_t row_count    = (available + code_length - 1) / code_length;
+            const std::size_t partial      = available - ((row_count - 1) * code_length);
+
+            return stack_start + interleaved_offset(within / code_length, within % code_length, row_count, partial);
+         }
+
+         inline unsigned char read_symbol(const std::size_t encoded_offset)
+         {
+            char c = 0;
+            stream_.seekg(static_cast<std::streamoff>(file_offset(encoded_offset)));
+            stream_.read(&c, 1);
+            return static_cast<unsigned char>(c);
+         }
+
+         inline void write_symbol(const std::size_t encoded_offset, const unsigned char symbol)
+         {
+            const char c = static_cast<char>(symbol);
+            stream_.seekp(static_cast<std::streamoff>(file_offset(encoded_offset)));
+            stream_.write(&c, 1);
+         }
+
+         const encoder_type& encoder_;
+         const std::size_t   file_size_;
+         std::fstream        stream_;
+         unsigned char       old_buffer_[data_length];
+         unsigned char       new_buffer_[data_length];
+         unsigned char       fec_buffer_[fec_length];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,488 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FIXED_ENCODER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FIXED_ENCODER_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/static_field.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_bitsliced.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/utils/schifra_ecc_traits.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+         /*
+            The LFSR register of a fixed_encoder: fec_length symbols in
+            slots of 4 (GF(2^2) to GF(2^4)) or 8 bits, slot k of the
+            register at bits [k * slot_bits, (k + 1) * slot_bits) of an
+            array of 64 bit words.
+         */
+         template <typename Field, std::size_t fec_length>
+         struct fixed_register_layout
+         {
+            typedef std::uint64_t word_type;
+
+            static constexpr std::size_t slot_bits = (Field::power <= 4) ? 4 : 8;
+            static constexpr std::size_t per_word  = 64 / slot_bits;
+            static constexpr std::size_t words     = (fec_length + per_word - 1) / per_word;
+            static constexpr std::size_t top_word  = (fec_length - 1) / per_word;
+            static constexpr std::size_t top_shift = ((fec_length - 1) % per_word) * slot_bits;
+         };
+
+         /*
+            Row v holds v times every generator coefficient, as a whole
+            register: shifting one symbol in is then one row lookup and
+            a shift and xor per word.
+         */
+         template <typename Field, std::size_t fec_length, std::size_t gen_initial_index>
+         struct fixed_encoder_rows
+         {
+            typedef fixed_register_layout<Field, fec_length> layout;
+            typedef typename layout::word_type word_type;
+
+            word_type row[Field::order][layout::words];
+
+            static constexpr fixed_encoder_rows make()
+            {
+               typedef bitsliced_generator<Field, fec_length> generator_t;
+
+               const generator_t generator = generator_t::make(gen_initial_index);
+
+               fixed_encoder_rows r = {};
+
+               for (unsigned int v = 0; v < Field::order; ++v)
+               {
+                  for (std::size_t k = 0; k < fec_length; ++k)
+                  {
+                     const word_type product = static_cast<word_type>(Field::mul(static_cast<galois::field_symbol>(v), generator.g[k]));
+
+                     r.row[v][k / layout::per_word] |= product << ((k % layout::per_word) * layout::slot_bits);
+                  }
+               }
+
+               return r;
+            }
+         };
+
+      } // namespace details
+
+      /*
+         Encoder of a code fixed at compile time: field, code and fec
+         lengths and generator roots alpha^gen_initial_index onwards.
+
+         The generator coefficients and every product feedback * g[k]
+         are computed by the compiler, and the register is held packed
+         in 64 bit words, so one data symbol costs a row lookup plus a
+         shift and xor per word, the shift being unrolled by template
+         recursion over the words. For RS(15,11) the whole register is
+         16 bits of one word, for RS(255,239) two words.
+
+         Codewords are bit-exact with reed_solomon::encoder over the
+         equivalent galois::field and make_sequential_root_generator_polynomial
+         generator, and the interface is that of encoder, including
+         shortened codewords through encode(span, span).
+      */
+      template <typename Field,
+                std::size_t code_length,
+                std::size_t fec_length,
+                std::size_t gen_initial_index,
+                typename symbol_t = galois::field_symbol>
+      class fixed_encoder
+      {
+      public:
+
+         static_assert(code_length == Field::field_size, "fixed_encoder - code length must be the field size");
+         static_assert((fec_length > 0) && (fec_length < code_length), "fixed_encoder - invalid fec length");
+
+         typedef traits::reed_solomon_triat<code_length, fec_length, code_length - fec_length> trait;
+         typedef block<code_length, fec_length, code_length - fec_length, symbol_t> block_type;
+
+         /* Number of codewords whose registers encode_batch() runs in lockstep */
+         static constexpr std::size_t batch_lanes = 4;
+
+         fixed_encoder()
+         : encoder_valid_(true)
+         {}
+
+         /*
+            Drop in for encoder(gfield, generator): the encoder is only
+            valid, ie: encode() only succeeds, when gfield is Field and
+            generator the one baked in.
+         */
+         fixed_encoder(const galois::field& gfield, const galois::field_polynomial& generator)
+         : encoder_valid_(Field::equivalent(gfield) && same_generator(generator))
+         {}
+
+         fixed_encoder(const galois::field& gfield, const generator_cache::generator_ptr& generator)
+         : encoder_valid_(generator && Field::equivalent(gfield) && same_generator(generator->polynomial()))
+         {}
+
+         inline bool valid() const
+         {
+            return encoder_valid_;
+         }
+
+         /*
+            As encoder::warm_up(), for drop in use. The tables are compiled
+            in, so there is nothing of the encoder's own to lock: running
+            zero blocks through encode() and encode_batch() faults in and
+            caches what they read.
+         */
+         inline bool warm_up(const bool = false) const
+         {
+            std::vector<block_type> blocks(batch_lanes);
+
+            for (std::size_t b = 0; b < blocks.size(); ++b)
+            {
+               blocks[b].reset(0);
+            }
+
+            encode(blocks[0]);
+            encode_batch(&blocks[0], blocks.size());
+
+            return true;
+         }
+
+         inline bool encode(block_type& rsblock) const
+         {
+            if (!encoder_valid_)
+            {
+               rsblock.error = block_type::e_encoder_error1;
+               return false;
+            }
+
+            encode_symbols(rsblock.data, rsblock.data + data_length);
+
+            return true;
+         }
+
+         inline bool encode(const std::string& data, block_type& rsblock) const
+         {
+            for (std::size_t i = 0; i < data_length; ++i)
+            {
+               rsblock.data[i] = static_cast<symbol_t>(static_cast<galois::field_symbol>(static_cast<unsigned char>(data[i])) & Field::mask());
+            }
+
+            return encode(rsblock);
+         }
+
+         /* As encoder::encode(span, span), shorter data being a shortened codeword */
+         template <typename DataT, typename ParityT>
+         inline bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity) const
+         {
+            if (!encoder_valid_ || data.empty() || (data.size() > data_length) || (parity.size() != fec_length))
+               return false;
+
+            encode_symbols(data.data(), parity.data(), data.size());
+
+            return true;
+         }
+
+         /* As encoder::encode(span, span, puncture_mask) */
+         template <typename DataT, typename ParityT>
+         inline bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity, const puncture_mask& puncture) const
+         {
+            if (
+                 !encoder_valid_ || data.empty() || (data.size() > data_length) ||
+                 (puncture.fec_length() != fec_length) || (parity.size() != puncture.kept_count())
+               )
+            {
+               return false;
+            }
+
+            galois::field_symbol full_parity[fec_length];
+
+            encode_symbols(data.data(), full_parity, data.size());
+
+            puncture.compress(full_parity, parity.data());
+
+            return true;
+         }
+
+         template <std::size_t short_code_length, std::size_t short_data_length, typename T>
+         inline bool encode_shortened(block<short_code_length,fec_length,short_data_length,T>& rsblock) const
+         {
+            static_assert((short_code_length <= code_length) && (short_code_length > fec_length),
+                          "encode_shortened() - block must be shorter than the natural code");
+
+            if (!encoder_valid_)
+            {
+               rsblock.error = block<short_code_length,fec_length,short_data_length,T>::e_encoder_error1;
+               return false;
+            }
+
+            encode_symbols(rsblock.data, rsblock.data + short_data_length, short_data_length);
+
+            return true;
+         }
+
+         inline std::size_t encode_batch(block_type* blocks, const std::size_t count) const
+         {
+            if (!encoder_valid_)
+            {
+               for (std::size_t b = 0; b < count; ++b)
+               {
+                  blocks[b].error = block_type::e_encoder_error1;
+               }
+
+               return 0;
+            }
+
+            const symbol_t* data[batch_lanes];
+                  symbol_t* fec [batch_lanes];
+
+            std::size_t b = 0;
+
+            for ( ; (b + batch_lanes) <= count; b += batch_lanes)
+            {
+               for (std::size_t l = 0; l < batch_lanes; ++l)
+               {
+                  data[l] = blocks[b + l].data;
+                  fec [l] = blocks[b + l].data + data_length;
+               }
+
+               encode_lanes<batch_lanes>(data, fec, data_length);
+            }
+
+            for ( ; b < count; ++b)
+            {
+               encode_symbols(blocks[b].data, blocks[b].data + data_length);
+            }
+
+            return count;
+         }
+
+         /* As encoder::encode_batch() over raw buffers */
+         inline std::size_t encode_batch(const symbol_t* data, const std::size_t data_stride,
+                                               symbol_t* fec,  const std::size_t fec_stride,
+                                         const std::size_t count) const
+         {
+            if (!encoder_valid_)
+               return 0;
+
+            const symbol_t* data_lanes[batch_lanes];
+                  symbol_t* fec_lanes [batch_lanes];
+
+            std::size_t b = 0;
+
+            for ( ; (b + batch_lanes) <= count; b += batch_lanes)
+            {
+               for (std::size_t l = 0; l < batch_lanes; ++l)
+               {
+                  data_lanes[l] = data + (b + l) * data_stride;
+                  fec_lanes [l] = fec  + (b + l) * fec_stride;
+               }
+
+               encode_lanes<batch_lanes>(data_lanes, fec_lanes, data_length);
+            }
+
+            for ( ; b < count; ++b)
+            {
+               encode_symbols(data + b * data_stride, fec + b * fec_stride);
+            }
+
+            return count;
+         }
+
+         static constexpr galois::field_symbol generator(const std::size_t i)
+         {
+            return generator_.g[i];
+         }
+
+      private:
+
+         static constexpr std::size_t data_length = code_length - fec_length;
+
+         typedef details::fixed_register_layout<Field, fec_length>                 layout;
+         typedef typename layout::word_type                                       word_type;
+         typedef details::bitsliced_generator<Field, fec_length>                  generator_t;
+         typedef details::fixed_encoder_rows<Field, fec_length, gen_initial_index> rows_t;
+
+         static constexpr word_type   slot_mask = (word_type(1) << layout::slot_bits) - 1;
+         static constexpr generator_t generator_ = generator_t::make(gen_initial_index);
+         static constexpr rows_t      rows_      = rows_t::make();
+
+         static bool same_generator(const galois::field_polynomial& generator)
+         {
+            if (generator.deg() != static_cast<int>(fec_length))
+               return false;
+
+            for (std::size_t k = 0; k <= fec_length; ++k)
+            {
+               if (generator[k].poly() != generator_.g[k])
+                  return false;
+            }
+
+            return true;
+         }
+
+         /* reg = (reg << slot_bits) ^ row, for words W..0 */
+         template <std::size_t W>
+         static inline void shift(word_type* reg, const word_type* row)
+         {
+            if constexpr (W > 0)
+            {
+               reg[W] = ((reg[W] << layout::slot_bits) | (reg[W - 1] >> (64 - layout::slot_bits))) ^ row[W];
+               shift<W - 1>(reg, row);
+            }
+            else
+               reg[0] = (reg[0] << layout::slot_bits) ^ row[0];
+         }
+
+         /*
+            Note: Slots above fec_length - 1 of the top word collect the
+                  symbols shifted out. They are never read back, and only
+                  move further up, so they are not cleared.
+         */
+         template <typename DataT>
+         static inline void step(word_type* reg, const DataT symbol)
+         {
+            const word_type feedback = (static_cast<word_type>(static_cast<galois::field_symbol>(symbol) & Field::mask())) ^
+                                       ((reg[layout::top_word] >> layout::top_shift) & slot_mask);
+
+            shift<layout::words - 1>(reg, rows_.row[feedback]);
+         }
+
+         template <typename ParityT>
+         static inline void store(const word_type* reg, ParityT* fec)
+         {
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               const std::size_t k = fec_length - 1 - i;
+
+               fec[i] = static_cast<ParityT>((reg[k / layout::per_word] >> ((k % layout::per_word) * layout::slot_bits)) & slot_mask);
+            }
+         }
+
+         template <typename DataT, typename ParityT>
+         static inline void encode_symbols(const DataT* data, ParityT* fec, const std::size_t length = data_length)
+         {
+            word_type reg[layout::words] = {};
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               step(reg, data[i]);
+            }
+
+            store(reg, fec);
+         }
+
+         /* Independent registers, so that their row lookups overlap */
+         template <std::size_t lanes, typename DataT, typename ParityT>
+         static inline void encode_lanes(const DataT* const data[], ParityT* const fec[], const std::size_t length)
+         {
+            word_type reg[lanes][layout::words] = {};
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               for (std::size_t l = 0; l < lanes; ++l)
+               {
+                  step(reg[l], data[l][i]);
+               }
+            }
+
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+               store(reg[l], fec[l]);
+            }
+         }
+
+         const bool encoder_valid_;
+      };
+
+      /*
+         Codes with a compile time encoder: the field and generator they
+         are used with throughout the library, ie: primitive_polynomial01
+         and roots from alpha^1 for GF(2^4) (dna_storage), and
+         primitive_polynomial06 and roots from alpha^120 for GF(2^8).
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      struct fixed_code
+      {
+         static constexpr bool defined = false;
+      };
+
+      template <std::size_t fec_length>
+      struct fixed_gf16_code
+      {
+         static constexpr bool defined = true;
+
+         typedef fixed_encoder<galois::gf16_static_field, 15, fec_length, 1> encoder_type;
+      };
+
+      template <std::size_t fec_length>
+      struct fixed_gf256_code
+      {
+         static constexpr bool defined = true;
+
+         typedef fixed_encoder<galois::gf256_static_field, 255, fec_length, 120> encoder_type;
+      };
+
+      template <> struct fixed_code< 15,  2> : public fixed_gf16_code < 2> {};
+      template <> struct fixed_code< 15,  4> : public fixed_gf16_code < 4> {};
+      template <> struct fixed_code<255,  8> : public fixed_gf256_code< 8> {};
+      template <> struct fixed_code<255, 16> : public fixed_gf256_code<16> {};
+      template <> struct fixed_code<255, 32> : public fixed_gf256_code<32> {};
+
+      /*
+         select_encoder<code_length, fec_length>::type is the fixed_encoder
+         of a fixed_code, and encoder<code_length, fec_length> otherwise.
+         Both are built from (field, generator), a fixed_encoder refusing
+         to encode when they are not the ones it was compiled for.
+      */
+      template <std::size_t code_length, std::size_t fec_length, bool = fixed_code<code_length, fec_length>::defined>
+      struct select_encoder
+      {
+         typedef encoder<code_length, fec_length> type;
+      };
+
+      template <std::size_t code_length, std::size_t fec_length>
+      struct select_encoder<code_length, fec_length, true>
+      {
+         typedef typename fixed_code<code_length, fec_length>::encoder_type type;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,253 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_GENERATOR_CACHE_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_GENERATOR_CACHE_HPP
+
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/utils/schifra_aligned_allocator.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      typedef std::vector<galois::field_symbol, utils::table_allocator<galois::field_symbol> > symbol_table;
+
+      /*
+         LFSR feedback rows of generator g of degree fec_length: row v
+         holds (v / g[fec_length]) * g[j] for j in [0,fec_length), so an
+         encoder step is one row lookup and fec_length xors.
+      */
+      template <typename Generator>
+      inline void make_lfsr_rows(const galois::field& field,
+                                 const Generator& generator,
+                                 const std::size_t fec_length,
+                                 symbol_table& rows)
+      {
+         const galois::field_symbol leading = generator[fec_length];
+
+         rows.resize((field.size() + 1) * fec_length);
+
+         for (std::size_t v = 0; v <= field.size(); ++v)
+         {
+            const galois::field_symbol feedback = field.div(static_cast<galois::field_symbol>(v), leading);
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               rows[v * fec_length + j] = field.mul(feedback, generator[j]);
+            }
+         }
+      }
+
+      /*
+         A sequential root generator polynomial, immutable once built,
+         with its coefficients and LFSR rows. The polynomial is over the
+         field registry's instance of the field, which lives as long as
+         the process, so it stays usable whatever field it was asked for
+         with.
+      */
+      class cached_generator
+      {
+      public:
+
+         cached_generator(const galois::field_registry::field_ptr& field,
+                          const unsigned int initial_index,
+                          const std::size_t  fec_length)
+         : field_(field),
+           polynomial_(*field),
+           initial_index_(initial_index),
+           fec_length_(fec_length),
+           valid_(false)
+         {
+            if (!make_sequential_root_generator_polynomial(*field_, initial_index, fec_length, polynomial_))
+               return;
+
+            if (polynomial_.deg() != static_cast<int>(fec_length))
+               return;
+
+            coefficients_.resize(fec_length + 1);
+
+            for (std::size_t i = 0; i <= fec_length; ++i)
+            {
+               coefficients_[i] = polynomial_[i].poly();
+            }
+
+            /* Note: Compact fields would need a row per symbol of a huge field */
+            if (!field_->compact())
+            {
+               make_lfsr_rows(*field_, coefficients_, fec_length, lfsr_rows_);
+            }
+
+            valid_ = true;
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline const galois::field& field() const
+         {
+            return *field_;
+         }
+
+         inline const galois::field_polynomial& polynomial() const
+         {
+            return polynomial_;
+         }
+
+         /* g[0] ... g[fec_length] */
+         inline const std::vector<galois::field_symbol>& coefficients() const
+         {
+            return coefficients_;
+         }
+
+         /* Empty for compact fields */
+         inline const symbol_table& lfsr_rows() const
+         {
+            return lfsr_rows_;
+         }
+
+         inline unsigned int initial_index() const
+         {
+            return initial_index_;
+         }
+
+         inline std::size_t fec_length() const
+         {
+            return fec_length_;
+         }
+
+      private:
+
+         cached_generator(const cached_generator&);
+         cached_generator& operator=(const cached_generator&);
+
+         const galois::field_registry::field_ptr field_;
+         galois::field_polynomial                polynomial_;
+         std::vector<galois::field_symbol>       coefficients_;
+         symbol_table                            lfsr_rows_;
+         const unsigned int                      initial_index_;
+         const std::size_t                       fec_length_;
+         bool                                    valid_;
+      };
+
+      /*
+         Process-wide cache of generator polynomials keyed by (field,
+         initial root index, root count). The first request builds the
+         polynomial and its LFSR rows, every later request on any thread
+         gets the same instance, so all codecs of one code share them.
+         Entries are kept for the lifetime of the process.
+      */
+      class generator_cache
+      {
+      public:
+
+         typedef std::shared_ptr<const cached_generator> generator_ptr;
+
+         static generator_cache& instance()
+         {
+            static generator_cache cache;
+            return cache;
+         }
+
+         /* Null when no such generator exists, eg: too many roots for the field */
+         generator_ptr acquire(const galois::field& field, const unsigned int initial_index, const std::size_t fec_length)
+         {
+            std::vector<unsigned int> primitive_poly(field.prim_poly_degree() + 1);
+
+            for (std::size_t i = 0; i < primitive_poly.size(); ++i)
+            {
+               primitive_poly[i] = field.prim_poly_term(static_cast<unsigned int>(i));
+            }
+
+            const key_type key(field_key(field.pwr(), primitive_poly), index_key(initial_index, fec_length));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            generator_map_t::const_iterator itr = generators_.find(key);
+
+            if (generators_.end() != itr)
+            {
+               return itr->second;
+            }
+
+            const galois::field_registry::field_ptr shared_field =
+               galois::shared_field(static_cast<int>(field.pwr()), field.prim_poly_degree(), &primitive_poly[0]);
+
+            generator_ptr generator = std::make_shared<const cached_generator>(shared_field, initial_index, fec_length);
+
+            if (!generator->valid())
+               generator.reset();
+
+            generators_.insert(std::make_pair(key, generator));
+
+            return generator;
+         }
+
+         std::size_t size() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return generators_.size();
+         }
+
+      private:
+
+         typedef std::pair<unsigned int, std::vector<unsigned int> > field_key;
+         typedef std::pair<unsigned int, std::size_t>               index_key;
+         typedef std::pair<field_key, index_key>                    key_type;
+         typedef std::map<key_type, generator_ptr>                  generator_map_t;
+
+         generator_cache() {}
+         generator_cache(const generator_cache&);
+         generator_cache& operator=(const generator_cache&);
+
+         generator_map_t    generators_;
+         mutable std::mutex mutex_;
+      };
+
+      inline generator_cache::generator_ptr shared_generator(const galois::field& field,
+                                                             const unsigned int initial_index,
+                                                             const std::size_t  fec_length)
+      {
+         return generator_cache::instance().acquire(field, initial_index, fec_length);
+      }
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
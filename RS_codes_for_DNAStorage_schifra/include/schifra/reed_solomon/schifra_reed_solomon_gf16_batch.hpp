@@ -0,0 +1,827 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_GF16_BATCH_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_GF16_BATCH_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/region.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Multi-codeword kernels for Reed-Solomon codes over GF(2^4).
+
+         A GF(16) multiplication by a constant is a 16 entry table, which
+         is exactly one shuffle register, so a multiply of 16/32/64 symbols
+         at once is a single pshufb. The kernels work on a planar layout,
+         where symbol j of lane (codeword) l lives at buffer[j * lanes + l].
+         Each vector therefore holds the same symbol position of 16/32/64
+         independent codewords, and the encoder LFSR, the syndrome Horner
+         evaluation and the Chien search run for all of them in lockstep.
+         Symbols occupy the low nibble of each byte.
+
+         Results are bit-exact with reed_solomon::encoder and the syndrome
+         and root search of reed_solomon::decoder for the same field,
+         generator polynomial and generator initial index.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class gf16_batch_codec
+      {
+      public:
+
+         static const std::size_t data_length = code_length - fec_length;
+
+         enum kernel_t
+         {
+            e_scalar = 0,
+            e_ssse3  = 1,
+            e_avx2   = 2,
+            e_avx512 = 3,
+            e_neon   = 4
+         };
+
+         gf16_batch_codec(const galois::field& gfield,
+                          const galois::field_polynomial& generator,
+                          const unsigned int gen_initial_index)
+         : valid_((gfield.pwr() == 4) && (code_length == gfield.size()) && (generator.deg() == static_cast<int>(fec_length))),
+           kernel_(select_kernel())
+         {
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               for (std::size_t j = 0; j < 16; ++j)
+               {
+                  mul_[i][j] = valid_ ? static_cast<std::uint8_t>(gfield.mul(static_cast<galois::field_symbol>(i), static_cast<galois::field_symbol>(j))) : 0;
+               }
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               copy_row(gen_row_[i], valid_ ? generator[i].poly() : 0);
+               copy_row(syn_row_[i], valid_ ? gfield.alpha(gen_initial_index + i) : 0);
+            }
+
+            for (std::size_t i = 0; i <= fec_length; ++i)
+            {
+               copy_row(chien_row_[i], valid_ ? gfield.alpha(i) : 0);
+            }
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline kernel_t kernel() const
+         {
+            return kernel_;
+         }
+
+         /*
+            data  : [data_length][lanes] planar data symbols
+            parity: [fec_length ][lanes] planar parity symbols, written
+         */
+         inline bool encode(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes) const
+         {
+            if (!valid_)
+               return false;
+
+            std::size_t l = 0;
+
+            #ifdef SCHIFRA_REGION_X86
+            switch (kernel_)
+            {
+               case e_avx512 : l = encode_avx512(data, parity, lanes, l); [[fallthrough]];
+               case e_avx2   : l = encode_avx2  (data, parity, lanes, l); [[fallthrough]];
+               case e_ssse3  : l = encode_ssse3 (data, parity, lanes, l); break;
+               default       : break;
+            }
+            #elif defined(SCHIFRA_REGION_NEON)
+            if (e_neon == kernel_)
+            {
+               l = encode_neon(data, parity, lanes, l);
+            }
+            #endif
+
+            encode_scalar(data, parity, lanes, l);
+
+            return true;
+         }
+
+         /*
+            codeword: [code_length][lanes] planar codeword symbols (data then fec)
+            syndrome: [fec_length ][lanes] planar syndromes, written
+            Returns the number of lanes with a non-zero syndrome.
+         */
+         inline std::size_t syndrome(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes) const
+         {
+            if (!valid_)
+               return lanes;
+
+            std::size_t l = 0;
+
+            #ifdef SCHIFRA_REGION_X86
+            switch (kernel_)
+            {
+               case e_avx512 : l = syndrome_avx512(codeword, syndrome, lanes, l); [[fallthrough]];
+               case e_avx2   : l = syndrome_avx2  (codeword, syndrome, lanes, l); [[fallthrough]];
+               case e_ssse3  : l = syndrome_ssse3 (codeword, syndrome, lanes, l); break;
+               default       : break;
+            }
+            #elif defined(SCHIFRA_REGION_NEON)
+            if (e_neon == kernel_)
+            {
+               l = syndrome_neon(codeword, syndrome, lanes, l);
+            }
+            #endif
+
+            syndrome_scalar(codeword, syndrome, lanes, l);
+
+            std::size_t dirty = 0;
+
+            for (std::size_t i = 0; i < lanes; ++i)
+            {
+               std::uint8_t s = 0;
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  s |= syndrome[j * lanes + i];
+               }
+
+               dirty += (0 != s) ? 1 : 0;
+            }
+
+            return dirty;
+         }
+
+         /*
+            lambda: [fec_length + 1][lanes] planar error locator coefficients,
+                    lambda[j * lanes + l] being the coefficient of x^j.
+            roots : [code_length][lanes], roots[p * lanes + l] is set to 1 when
+                    block position p of lane l is an error location, ie: when
+                    lambda(alpha^(p + 1)) == 0, otherwise 0.
+         */
+         inline bool chien(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes) const
+         {
+            if (!valid_)
+               return false;
+
+            std::size_t l = 0;
+
+            #ifdef SCHIFRA_REGION_X86
+            switch (kernel_)
+            {
+               case e_avx512 : l = chien_avx512(lambda, roots, lanes, l); [[fallthrough]];
+               case e_avx2   : l = chien_avx2  (lambda, roots, lanes, l); [[fallthrough]];
+               case e_ssse3  : l = chien_ssse3 (lambda, roots, lanes, l); break;
+               default       : break;
+            }
+            #elif defined(SCHIFRA_REGION_NEON)
+            if (e_neon == kernel_)
+            {
+               l = chien_neon(lambda, roots, lanes, l);
+            }
+            #endif
+
+            chien_scalar(lambda, roots, lanes, l);
+
+            return true;
+         }
+
+      private:
+
+         gf16_batch_codec(const gf16_batch_codec&);
+         gf16_batch_codec& operator=(const gf16_batch_codec&);
+
+         inline void copy_row(std::uint8_t row[16], const galois::field_symbol c) const
+         {
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               row[i] = mul_[c & 0x0F][i];
+            }
+         }
+
+         /*
+            The kernel follows the backend bound in galois::region::dispatcher
+            at construction time, so forcing a backend there also selects the
+            matching lane width here.
+         */
+         static kernel_t select_kernel()
+         {
+            switch (galois::region::active_backend())
+            {
+               #ifdef SCHIFRA_REGION_X86
+               case galois::region::e_gfni_avx512 :
+               case galois::region::e_avx512      : return e_avx512;
+               case galois::region::e_gfni_avx2   :
+               case galois::region::e_avx2        : return e_avx2;
+               case galois::region::e_ssse3       : return e_ssse3;
+               #endif
+
+               #ifdef SCHIFRA_REGION_NEON
+               case galois::region::e_sve         :
+               case galois::region::e_neon        : return e_neon;
+               #endif
+
+               default                            : return e_scalar;
+            }
+         }
+
+         inline void encode_scalar(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes, std::size_t l) const
+         {
+            for (; l < lanes; ++l)
+            {
+               std::uint8_t r[fec_length] = { 0 };
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  const std::uint8_t fb = (data[i * lanes + l] ^ r[fec_length - 1]) & 0x0F;
+
+                  for (std::size_t j = fec_length - 1; j > 0; --j)
+                  {
+                     r[j] = r[j - 1] ^ gen_row_[j][fb];
+                  }
+
+                  r[0] = gen_row_[0][fb];
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  parity[i * lanes + l] = r[fec_length - 1 - i];
+               }
+            }
+         }
+
+         inline void syndrome_scalar(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes, std::size_t l) const
+         {
+            for (; l < lanes; ++l)
+            {
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  std::uint8_t s = 0;
+
+                  for (std::size_t i = 0; i < code_length; ++i)
+                  {
+                     s = syn_row_[k][s] ^ (codeword[i * lanes + l] & 0x0F);
+                  }
+
+                  syndrome[k * lanes + l] = s;
+               }
+            }
+         }
+
+         inline void chien_scalar(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes, std::size_t l) const
+         {
+            for (; l < lanes; ++l)
+            {
+               std::uint8_t t[fec_length + 1];
+
+               for (std::size_t j = 0; j <= fec_length; ++j)
+               {
+                  t[j] = lambda[j * lanes + l] & 0x0F;
+               }
+
+               for (std::size_t p = 0; p < code_length; ++p)
+               {
+                  std::uint8_t sum = t[0];
+
+                  for (std::size_t j = 1; j <= fec_length; ++j)
+                  {
+                     t[j] = chien_row_[j][t[j]];
+                     sum ^= t[j];
+                  }
+
+                  roots[p * lanes + l] = (0 == sum) ? 1 : 0;
+               }
+            }
+         }
+
+         #ifdef SCHIFRA_REGION_X86
+
+         __attribute__((target("ssse3")))
+         std::size_t encode_ssse3(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes, std::size_t l) const
+         {
+            const __m128i mask = _mm_set1_epi8(0x0F);
+
+            __m128i g[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               g[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gen_row_[j]));
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               __m128i r[fec_length];
+
+               for (std::size_t j = 0; j < fec_length; ++j) r[j] = _mm_setzero_si128();
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  const __m128i d  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * lanes + l));
+                  const __m128i fb = _mm_and_si128(_mm_xor_si128(d, r[fec_length - 1]), mask);
+
+                  for (std::size_t j = fec_length - 1; j > 0; --j)
+                  {
+                     r[j] = _mm_xor_si128(r[j - 1], _mm_shuffle_epi8(g[j], fb));
+                  }
+
+                  r[0] = _mm_shuffle_epi8(g[0], fb);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(parity + i * lanes + l), r[fec_length - 1 - i]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("ssse3")))
+         std::size_t syndrome_ssse3(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes, std::size_t l) const
+         {
+            const __m128i mask = _mm_set1_epi8(0x0F);
+
+            __m128i a[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(syn_row_[k]));
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               __m128i s[fec_length];
+
+               for (std::size_t k = 0; k < fec_length; ++k) s[k] = _mm_setzero_si128();
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  const __m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codeword + i * lanes + l)), mask);
+
+                  for (std::size_t k = 0; k < fec_length; ++k)
+                  {
+                     s[k] = _mm_xor_si128(_mm_shuffle_epi8(a[k], s[k]), c);
+                  }
+               }
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(syndrome + k * lanes + l), s[k]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("ssse3")))
+         std::size_t chien_ssse3(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes, std::size_t l) const
+         {
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            const __m128i one  = _mm_set1_epi8(0x01);
+            const __m128i zero = _mm_setzero_si128();
+
+            __m128i a[fec_length + 1];
+
+            for (std::size_t j = 0; j <= fec_length; ++j)
+            {
+               a[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chien_row_[j]));
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               __m128i t[fec_length + 1];
+
+               for (std::size_t j = 0; j <= fec_length; ++j)
+               {
+                  t[j] = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lambda + j * lanes + l)), mask);
+               }
+
+               for (std::size_t p = 0; p < code_length; ++p)
+               {
+                  __m128i sum = t[0];
+
+                  for (std::size_t j = 1; j <= fec_length; ++j)
+                  {
+                     t[j] = _mm_shuffle_epi8(a[j], t[j]);
+                     sum  = _mm_xor_si128(sum, t[j]);
+                  }
+
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(roots + p * lanes + l), _mm_and_si128(_mm_cmpeq_epi8(sum, zero), one));
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx2")))
+         std::size_t encode_avx2(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes, std::size_t l) const
+         {
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+
+            __m256i g[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               g[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(gen_row_[j])));
+            }
+
+            for (; (l + 32) <= lanes; l += 32)
+            {
+               __m256i r[fec_length];
+
+               for (std::size_t j = 0; j < fec_length; ++j) r[j] = _mm256_setzero_si256();
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  const __m256i d  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * lanes + l));
+                  const __m256i fb = _mm256_and_si256(_mm256_xor_si256(d, r[fec_length - 1]), mask);
+
+                  for (std::size_t j = fec_length - 1; j > 0; --j)
+                  {
+                     r[j] = _mm256_xor_si256(r[j - 1], _mm256_shuffle_epi8(g[j], fb));
+                  }
+
+                  r[0] = _mm256_shuffle_epi8(g[0], fb);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(parity + i * lanes + l), r[fec_length - 1 - i]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx2")))
+         std::size_t syndrome_avx2(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes, std::size_t l) const
+         {
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+
+            __m256i a[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               a[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(syn_row_[k])));
+            }
+
+            for (; (l + 32) <= lanes; l += 32)
+            {
+               __m256i s[fec_length];
+
+               for (std::size_t k = 0; k < fec_length; ++k) s[k] = _mm256_setzero_si256();
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  const __m256i c = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(codeword + i * lanes + l)), mask);
+
+                  for (std::size_t k = 0; k < fec_length; ++k)
+                  {
+                     s[k] = _mm256_xor_si256(_mm256_shuffle_epi8(a[k], s[k]), c);
+                  }
+               }
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(syndrome + k * lanes + l), s[k]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx2")))
+         std::size_t chien_avx2(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes, std::size_t l) const
+         {
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            const __m256i one  = _mm256_set1_epi8(0x01);
+            const __m256i zero = _mm256_setzero_si256();
+
+            __m256i a[fec_length + 1];
+
+            for (std::size_t j = 0; j <= fec_length; ++j)
+            {
+               a[j] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chien_row_[j])));
+            }
+
+            for (; (l + 32) <= lanes; l += 32)
+            {
+               __m256i t[fec_length + 1];
+
+               for (std::size_t j = 0; j <= fec_length; ++j)
+               {
+                  t[j] = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lambda + j * lanes + l)), mask);
+               }
+
+               for (std::size_t p = 0; p < code_length; ++p)
+               {
+                  __m256i sum = t[0];
+
+                  for (std::size_t j = 1; j <= fec_length; ++j)
+                  {
+                     t[j] = _mm256_shuffle_epi8(a[j], t[j]);
+                     sum  = _mm256_xor_si256(sum, t[j]);
+                  }
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(roots + p * lanes + l), _mm256_and_si256(_mm256_cmpeq_epi8(sum, zero), one));
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx512f,avx512bw")))
+         std::size_t encode_avx512(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes, std::size_t l) const
+         {
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+
+            __m512i g[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               g[j] = load_row_x4(gen_row_[j]);
+            }
+
+            for (; (l + 64) <= lanes; l += 64)
+            {
+               __m512i r[fec_length];
+
+               for (std::size_t j = 0; j < fec_length; ++j) r[j] = _mm512_setzero_si512();
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  const __m512i d  = _mm512_loadu_si512(data + i * lanes + l);
+                  const __m512i fb = _mm512_and_si512(_mm512_xor_si512(d, r[fec_length - 1]), mask);
+
+                  for (std::size_t j = fec_length - 1; j > 0; --j)
+                  {
+                     r[j] = _mm512_xor_si512(r[j - 1], _mm512_shuffle_epi8(g[j], fb));
+                  }
+
+                  r[0] = _mm512_shuffle_epi8(g[0], fb);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  _mm512_storeu_si512(parity + i * lanes + l, r[fec_length - 1 - i]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx512f,avx512bw")))
+         std::size_t syndrome_avx512(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes, std::size_t l) const
+         {
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+
+            __m512i a[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               a[k] = load_row_x4(syn_row_[k]);
+            }
+
+            for (; (l + 64) <= lanes; l += 64)
+            {
+               __m512i s[fec_length];
+
+               for (std::size_t k = 0; k < fec_length; ++k) s[k] = _mm512_setzero_si512();
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  const __m512i c = _mm512_and_si512(_mm512_loadu_si512(codeword + i * lanes + l), mask);
+
+                  for (std::size_t k = 0; k < fec_length; ++k)
+                  {
+                     s[k] = _mm512_xor_si512(_mm512_shuffle_epi8(a[k], s[k]), c);
+                  }
+               }
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  _mm512_storeu_si512(syndrome + k * lanes + l, s[k]);
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx512f,avx512bw")))
+         std::size_t chien_avx512(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes, std::size_t l) const
+         {
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+            const __m512i one  = _mm512_set1_epi8(0x01);
+
+            __m512i a[fec_length + 1];
+
+            for (std::size_t j = 0; j <= fec_length; ++j)
+            {
+               a[j] = load_row_x4(chien_row_[j]);
+            }
+
+            for (; (l + 64) <= lanes; l += 64)
+            {
+               __m512i t[fec_length + 1];
+
+               for (std::size_t j = 0; j <= fec_length; ++j)
+               {
+                  t[j] = _mm512_and_si512(_mm512_loadu_si512(lambda + j * lanes + l), mask);
+               }
+
+               for (std::size_t p = 0; p < code_length; ++p)
+               {
+                  __m512i sum = t[0];
+
+                  for (std::size_t j = 1; j <= fec_length; ++j)
+                  {
+                     t[j] = _mm512_shuffle_epi8(a[j], t[j]);
+                     sum  = _mm512_xor_si512(sum, t[j]);
+                  }
+
+                  const __mmask64 z = _mm512_testn_epi8_mask(sum, sum);
+
+                  _mm512_storeu_si512(roots + p * lanes + l, _mm512_maskz_mov_epi8(z, one));
+               }
+            }
+
+            return l;
+         }
+
+         __attribute__((target("avx512f,avx512bw")))
+         static __m512i load_row_x4(const std::uint8_t row[16])
+         {
+            std::uint8_t row64[64];
+
+            for (std::size_t i = 0; i < 64; ++i)
+            {
+               row64[i] = row[i & 0x0F];
+            }
+
+            return _mm512_loadu_si512(row64);
+         }
+
+         #endif // SCHIFRA_REGION_X86
+
+         #ifdef SCHIFRA_REGION_NEON
+
+         std::size_t encode_neon(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes, std::size_t l) const
+         {
+            const uint8x16_t mask = vdupq_n_u8(0x0F);
+
+            uint8x16_t g[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               g[j] = vld1q_u8(gen_row_[j]);
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               uint8x16_t r[fec_length];
+
+               for (std::size_t j = 0; j < fec_length; ++j) r[j] = vdupq_n_u8(0);
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  const uint8x16_t d  = vld1q_u8(data + i * lanes + l);
+                  const uint8x16_t fb = vandq_u8(veorq_u8(d, r[fec_length - 1]), mask);
+
+                  for (std::size_t j = fec_length - 1; j > 0; --j)
+                  {
+                     r[j] = veorq_u8(r[j - 1], vqtbl1q_u8(g[j], fb));
+                  }
+
+                  r[0] = vqtbl1q_u8(g[0], fb);
+               }
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  vst1q_u8(parity + i * lanes + l, r[fec_length - 1 - i]);
+               }
+            }
+
+            return l;
+         }
+
+         std::size_t syndrome_neon(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes, std::size_t l) const
+         {
+            const uint8x16_t mask = vdupq_n_u8(0x0F);
+
+            uint8x16_t a[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               a[k] = vld1q_u8(syn_row_[k]);
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               uint8x16_t s[fec_length];
+
+               for (std::size_t k = 0; k < fec_length; ++k) s[k] = vdupq_n_u8(0);
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  const uint8x16_t c = vandq_u8(vld1q_u8(codeword + i * lanes + l), mask);
+
+                  for (std::size_t k = 0; k < fec_length; ++k)
+                  {
+                     s[k] = veorq_u8(vqtbl1q_u8(a[k], s[k]), c);
+                  }
+               }
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  vst1q_u8(syndrome + k * lanes + l, s[k]);
+               }
+            }
+
+            return l;
+         }
+
+         std::size_t chien_neon(const std::uint8_t* lambda, std::uint8_t* roots, const std::size_t lanes, std::size_t l) const
+         {
+            const uint8x16_t mask = vdupq_n_u8(0x0F);
+            const uint8x16_t one  = vdupq_n_u8(0x01);
+
+            uint8x16_t a[fec_length + 1];
+
+            for (std::size_t j = 0; j <= fec_length; ++j)
+            {
+               a[j] = vld1q_u8(chien_row_[j]);
+            }
+
+            for (; (l + 16) <= lanes; l += 16)
+            {
+               uint8x16_t t[fec_length + 1];
+
+               for (std::size_t j = 0; j <= fec_length; ++j)
+               {
+                  t[j] = vandq_u8(vld1q_u8(lambda + j * lanes + l), mask);
+               }
+
+               for (std::size_t p = 0; p < code_length; ++p)
+               {
+                  uint8x16_t sum = t[0];
+
+                  for (std::size_t j = 1; j <= fec_length; ++j)
+                  {
+                     t[j] = vqtbl1q_u8(a[j], t[j]);
+                     sum  = veorq_u8(sum, t[j]);
+                  }
+
+                  vst1q_u8(roots + p * lanes + l, vandq_u8(vceqzq_u8(sum), one));
+               }
+            }
+
+            return l;
+         }
+
+         #endif // SCHIFRA_REGION_NEON
+
+         const bool     valid_;
+         const kernel_t kernel_;
+         std::uint8_t   mul_      [16][16];
+         std::uint8_t   gen_row_  [fec_length][16];
+         std::uint8_t   syn_row_  [fec_length][16];
+         std::uint8_t   chien_row_[fec_length + 1][16];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
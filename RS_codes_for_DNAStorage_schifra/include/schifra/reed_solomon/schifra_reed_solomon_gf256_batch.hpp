@@ -0,0 +1,614 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_GF256_BATCH_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_GF256_BATCH_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Multi-codeword kernels for Reed-Solomon codes over GF(2^m), m <= 8,
+         one symbol per byte, natural or shortened (code_length up to the
+         field size). The layout is planar, as in gf16_batch_codec: symbol
+         j of lane l lives at buffer[j * lanes + l].
+
+         Both the encoder LFSR and the syndrome Horner evaluation are run
+         as whole rows of galois::region::mul_add, so every step works on
+         window_lanes codewords at once through the SSSE3/AVX2/AVX512/GFNI
+         or NEON/SVE backend bound in galois::region::dispatcher. Rows are
+         multiplied in place as s ^= (c ^ 1) * s, and the LFSR shift is a
+         rotation of row pointers, so no row is ever copied.
+
+         Results are bit-exact with reed_solomon::encoder and the syndromes
+         of reed_solomon::decoder for the same field, generator polynomial
+         and generator initial index.
+
+         decode() corrects errors and erasures of lanes sharing one erasure
+         set, eg: the columns of an outer code across strands, where a lost
+         strand is the same row of every column. The work tied to the
+         erasures (their locator, the modified syndromes, the Forney
+         coefficients) is done once per call and applied to whole rows, so
+         only the lanes with errors beyond the erasures run the per lane
+         Berlekamp-Massey, Chien and Forney steps.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class gf256_batch_codec
+      {
+      public:
+
+         static const std::size_t data_length = code_length - fec_length;
+
+         /* Lanes per pass, sized so fec_length register rows stay in L1 */
+         static constexpr std::size_t window_lanes = 1024;
+
+         /* Errata count of a lane decode() could not correct */
+         static const std::uint8_t uncorrectable = 0xFF;
+
+         gf256_batch_codec(const galois::field& gfield,
+                           const galois::field_polynomial& generator,
+                           const unsigned int gen_initial_index)
+         : field_(gfield),
+           gen_initial_index_(gen_initial_index),
+           valid_((gfield.pwr() <= 8) && (code_length <= gfield.size()) && (code_length > fec_length) &&
+                  (generator.deg() == static_cast<int>(fec_length)))
+         {
+            if (!valid_)
+               return;
+
+            const galois::field_symbol leading = generator[fec_length].poly();
+
+            lfsr_multiplier_.reserve(fec_length);
+            syndrome_multiplier_.reserve(fec_length);
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               const galois::field_symbol feedback = gfield.div(generator[i].poly(), leading);
+
+               lfsr_multiplier_.push_back(galois::region::make_multiplier(gfield, feedback));
+               syndrome_multiplier_.push_back(galois::region::make_multiplier(gfield, gfield.alpha(gen_initial_index + i) ^ 1));
+            }
+
+            /* x^0 feeds the register in place, so it is the one row multiplied as (c ^ 1) */
+            lfsr_multiplier_[0] = galois::region::make_multiplier(gfield, gfield.div(generator[0].poly(), leading) ^ 1);
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         /*
+            data  : [data_length][lanes] planar data symbols
+            parity: [fec_length ][lanes] planar parity symbols, written
+         */
+         inline bool encode(const std::uint8_t* data, std::uint8_t* parity, const std::size_t lanes) const
+         {
+            if (!valid_)
+               return false;
+
+            std::vector<std::uint8_t> register_rows(fec_length * window_lanes);
+            std::uint8_t* registers[fec_length];
+
+            for (std::size_t k = 0; k < fec_length; ++k)
+            {
+               registers[k] = &register_rows[k * window_lanes];
+            }
+
+            for (std::size_t l = 0; l < lanes; l += window_lanes)
+            {
+               const std::size_t width = std::min(window_lanes, lanes - l);
+
+               /*
+                  reg(k), the coefficient of x^(k - 1), is registers[(k - 1 + shift) % fec_length].
+                  A step computes fb = d ^ reg(fec_length) and reg'(k + 1) = reg(k) ^ g'(k) * fb,
+                  reg'(1) = g'(0) * fb, which leaves fb in the row that becomes reg'(1).
+               */
+               std::size_t shift = 0;
+
+               for (std::size_t k = 0; k < fec_length; ++k)
+               {
+                  std::memset(registers[k], 0, width);
+               }
+
+               for (std::size_t i = 0; i < data_length; ++i)
+               {
+                  std::uint8_t* feedback = registers[(fec_length - 1 + shift) % fec_length];
+
+                  xor_row(data + (i * lanes) + l, feedback, width);
+
+                  for (std::size_t k = 1; k < fec_length; ++k)
+                  {
+                     galois::region::mul_add(lfsr_multiplier_[k], feedback, registers[(k - 1 + shift) % fec_length], width);
+                  }
+
+                  galois::region::mul_add(lfsr_multiplier_[0], feedback, feedback, width);
+
+                  shift = (shift + fec_length - 1) % fec_length;
+               }
+
+               /* fec(i) is reg(fec_length - i) */
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  std::memcpy(parity + (i * lanes) + l, registers[(fec_length - 1 - i + shift) % fec_length], width);
+               }
+            }
+
+            return true;
+         }
+
+         /*
+            codeword: [code_length][lanes] planar codeword symbols (data then fec)
+            syndrome: [fec_length ][lanes] planar syndromes, written
+            Returns the number of lanes with a non-zero syndrome.
+         */
+         inline std::size_t syndrome(const std::uint8_t* codeword, std::uint8_t* syndrome, const std::size_t lanes) const
+         {
+            if (!valid_)
+               return lanes;
+
+            for (std::size_t l = 0; l < lanes; l += window_lanes)
+            {
+               syndrome_rows(codeword + l, lanes, syndrome + l, lanes, std::min(window_lanes, lanes - l));
+            }
+
+            std::size_t dirty = 0;
+
+            for (std::size_t i = 0; i < lanes; ++i)
+            {
+               std::uint8_t s = 0;
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  s |= syndrome[j * lanes + i];
+               }
+
+               dirty += (0 != s) ? 1 : 0;
+            }
+
+            return dirty;
+         }
+
+         /*
+            codeword : [code_length][lanes] planar codewords, corrected in place
+            erasures : rows (0 to code_length - 1) erased in every lane
+            errata   : [lanes] symbols corrected per lane, or uncorrectable,
+                       written when not null
+            Returns the number of lanes decoded. Lanes that could not be
+            corrected are left as they were.
+
+            With Gamma(x) the erasure locator and S(x) the syndromes, the
+            modified syndromes T(x) = Gamma(x)S(x) mod x^fec_length are
+            computed as rows. A lane whose T(e) to T(fec_length - 1) are
+            zero, e being the number of erasures, has no error outside the
+            erasures: T(x) is then its errata evaluator and the Forney
+            values are fixed combinations of T(0) to T(e - 1), applied to
+            every such lane at once. The other lanes go through the errors
+            and erasures Berlekamp-Massey one by one.
+         */
+         inline std::size_t decode(std::uint8_t* codeword,
+                                   const std::size_t lanes,
+                                   const erasure_locations_t& erasures,
+                                   std::uint8_t* errata = 0) const
+         {
+            const std::size_t e = erasures.size();
+
+            bool usable = valid_ && (e <= fec_length);
+
+            for (std::size_t k = 0; usable && (k < e); ++k)
+            {
+               usable = (erasures[k] < code_length);
+            }
+
+            if (!usable)
+            {
+               if (errata)
+                  std::memset(errata, uncorrectable, lanes);
+
+               return 0;
+            }
+
+            /* Erasure k is the root X(k)^-1 of Gamma(x) = prod(1 + X(k)x), X(k) = alpha^(code_length - 1 - row) */
+            galois::field_symbol gamma[fec_length + 1];
+
+            std::fill(gamma, gamma + fec_length + 1, galois::field_symbol(0));
+
+            gamma[0] = 1;
+
+            for (std::size_t k = 0; k < e; ++k)
+            {
+               const galois::field_symbol x = power(code_length - 1 - erasures[k], 1);
+
+               for (std::size_t i = k + 1; i > 0; --i)
+               {
+                  gamma[i] ^= field_.mul(x, gamma[i - 1]);
+               }
+            }
+
+            /* gamma_multiplier[i - 1] multiplies by Gamma(i), Gamma(0) = 1 needs none */
+            std::vector<galois::region::multiplier> gamma_multiplier(e);
+
+            for (std::size_t i = 1; i <= e; ++i)
+            {
+               gamma_multiplier[i - 1] = galois::region::make_multiplier(field_, gamma[i]);
+            }
+
+            /* value(k) = X(k)^(1 - gii) T(X(k)^-1) / Gamma'(X(k)^-1), ie: sum over j < e of forney(k, j) T(j) */
+            std::vector<galois::region::multiplier> forney_multiplier(e * e);
+
+            for (std::size_t k = 0; k < e; ++k)
+            {
+               const std::size_t    p     = code_length - 1 - erasures[k];
+               const galois::field_symbol slope = derivative(gamma, e, power(p, -1));
+
+               for (std::size_t j = 0; j < e; ++j)
+               {
+                  const galois::field_symbol c = field_.div(power(p, 1 - static_cast<long>(gen_initial_index_) - static_cast<long>(j)), slope);
+
+                  forney_multiplier[k * e + j] = galois::region::make_multiplier(field_, c);
+               }
+            }
+
+            std::vector<std::uint8_t> syndrome_row(fec_length * window_lanes);
+            std::vector<std::uint8_t> modified_row(fec_length * window_lanes);
+            std::vector<std::uint8_t> value_row   (std::max<std::size_t>(1, e) * window_lanes);
+
+            std::size_t decoded = 0;
+
+            for (std::size_t l = 0; l < lanes; l += window_lanes)
+            {
+               const std::size_t width = std::min(window_lanes, lanes - l);
+
+               syndrome_rows(codeword + l, lanes, &syndrome_row[0], width, width);
+
+               /* T(j) = sum over i <= min(j, e) of Gamma(i) S(j - i) */
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  std::uint8_t* t = &modified_row[j * width];
+
+                  std::memcpy(t, &syndrome_row[j * width], width);
+
+                  for (std::size_t i = 1; (i <= e) && (i <= j); ++i)
+                  {
+                     galois::region::mul_add(gamma_multiplier[i - 1], &syndrome_row[(j - i) * width], t, width);
+                  }
+               }
+
+               std::fill(value_row.begin(), value_row.begin() + (e * width), std::uint8_t(0));
+
+               for (std::size_t k = 0; k < e; ++k)
+               {
+                  for (std::size_t j = 0; j < e; ++j)
+                  {
+                     galois::region::mul_add(forney_multiplier[k * e + j], &modified_row[j * width], &value_row[k * width], width);
+                  }
+               }
+
+               for (std::size_t w = 0; w < width; ++w)
+               {
+                  std::uint8_t extra = 0;
+
+                  for (std::size_t j = e; j < fec_length; ++j)
+                  {
+                     extra |= modified_row[j * width + w];
+                  }
+
+                  std::size_t count = 0;
+
+                  if (0 == extra)
+                  {
+                     for (std::size_t k = 0; k < e; ++k)
+                     {
+                        count += (0 != value_row[k * width + w]) ? 1 : 0;
+                     }
+                  }
+                  else
+                  {
+                     /* The batch Forney values are those of an erasures only lane, the lane is corrected on its own */
+                     for (std::size_t k = 0; k < e; ++k)
+                     {
+                        value_row[k * width + w] = 0;
+                     }
+
+                     count = correct_lane(codeword + l + w, lanes, &syndrome_row[w], width, gamma, e);
+                  }
+
+                  if (uncorrectable != count)
+                     ++decoded;
+
+                  if (errata)
+                     errata[l + w] = static_cast<std::uint8_t>(count);
+               }
+
+               for (std::size_t k = 0; k < e; ++k)
+               {
+                  xor_row(&value_row[k * width], codeword + (erasures[k] * lanes) + l, width);
+               }
+            }
+
+            return decoded;
+         }
+
+      private:
+
+         gf256_batch_codec(const gf256_batch_codec&);
+         gf256_batch_codec& operator=(const gf256_batch_codec&);
+
+         /* alpha^(exponent * n), n possibly negative */
+         inline galois::field_symbol power(const std::size_t exponent, const long n) const
+         {
+            const long size = static_cast<long>(field_.size());
+
+            long r = (static_cast<long>(exponent) * n) % size;
+
+            if (r < 0)
+               r += size;
+
+            return field_.alpha(static_cast<galois::field_symbol>(r));
+         }
+
+         inline galois::field_symbol evaluate(const galois::field_symbol* poly, const std::size_t degree, const galois::field_symbol x) const
+         {
+            galois::field_symbol r = 0;
+
+            for (std::size_t i = degree + 1; i > 0; --i)
+            {
+               r = field_.mul(r, x) ^ poly[i - 1];
+            }
+
+            return r;
+         }
+
+         /* poly'(x), in characteristic 2 the odd terms of poly shifted down */
+         inline galois::field_symbol derivative(const galois::field_symbol* poly, const std::size_t degree, const galois::field_symbol x) const
+         {
+            const galois::field_symbol x2 = field_.mul(x, x);
+
+            galois::field_symbol r = 0;
+
+            for (std::size_t i = (degree | 1) + 2; i > 1; i -= 2)
+            {
+               r = field_.mul(r, x2) ^ ((i - 2 <= degree) ? poly[i - 2] : 0);
+            }
+
+            return r;
+         }
+
+         /*
+            syndrome(j) = r(alpha^(gii + j)) of width lanes: codeword rows
+            with a stride of codeword_stride, syndrome rows with a stride
+            of syndrome_stride.
+         */
+         inline void syndrome_rows(const std::uint8_t* codeword, const std::size_t codeword_stride,
+                                   std::uint8_t* syndrome, const std::size_t syndrome_stride,
+                                   const std::size_t width) const
+         {
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               std::memcpy(syndrome + (j * syndrome_stride), codeword, width);
+            }
+
+            /* S(j) = S(j) * alpha^(gii + j) ^ r(i) */
+            for (std::size_t i = 1; i < code_length; ++i)
+            {
+               const std::uint8_t* r = codeword + (i * codeword_stride);
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  std::uint8_t* s = syndrome + (j * syndrome_stride);
+
+                  galois::region::mul_add(syndrome_multiplier_[j], s, s, width);
+                  xor_row(r, s, width);
+               }
+            }
+         }
+
+         /*
+            Errors and erasures decoding of one lane: symbol i of the lane
+            at column[i * stride], its syndromes at syndrome[j * syndrome_stride].
+            Berlekamp-Massey starts from the erasure locator gamma, of e
+            roots, and extends it over the modified syndromes. Returns the
+            symbols corrected, or uncorrectable with the lane left as is.
+         */
+         inline std::size_t correct_lane(std::uint8_t* column, const std::size_t stride,
+                                         const std::uint8_t* syndrome, const std::size_t syndrome_stride,
+                                         const galois::field_symbol* gamma, const std::size_t e) const
+         {
+            galois::field_symbol s[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               s[j] = syndrome[j * syndrome_stride];
+            }
+
+            galois::field_symbol lambda[fec_length + 1];
+            galois::field_symbol prior [fec_length + 1];
+            galois::field_symbol next  [fec_length + 1];
+
+            std::copy(gamma, gamma + fec_length + 1, lambda);
+            std::copy(gamma, gamma + fec_length + 1, prior );
+
+            std::size_t L = e;
+
+            for (std::size_t r = e + 1; r <= fec_length; ++r)
+            {
+               galois::field_symbol discrepancy = 0;
+
+               for (std::size_t i = 0; (i <= L) && (i < r); ++i)
+               {
+                  discrepancy ^= field_.mul(lambda[i], s[r - 1 - i]);
+               }
+
+               if (0 == discrepancy)
+               {
+                  shift(prior);
+                  continue;
+               }
+
+               next[0] = lambda[0];
+
+               for (std::size_t i = 1; i <= fec_length; ++i)
+               {
+                  next[i] = lambda[i] ^ field_.mul(discrepancy, prior[i - 1]);
+               }
+
+               if ((2 * L) <= (r + e - 1))
+               {
+                  L = r + e - L;
+
+                  const galois::field_symbol inverse = field_.inverse(discrepancy);
+
+                  for (std::size_t i = 0; i <= fec_length; ++i)
+                  {
+                     prior[i] = field_.mul(inverse, lambda[i]);
+                  }
+               }
+               else
+                  shift(prior);
+
+               std::copy(next, next + fec_length + 1, lambda);
+            }
+
+            /* 2v + e <= fec_length for v errors, and lambda of degree L */
+            if (((2 * L) > (fec_length + e)) || (0 == lambda[L]))
+               return uncorrectable;
+
+            for (std::size_t i = L + 1; i <= fec_length; ++i)
+            {
+               if (0 != lambda[i])
+                  return uncorrectable;
+            }
+
+            std::size_t row  [fec_length];
+            std::size_t roots = 0;
+
+            for (std::size_t i = 0; (i < code_length) && (roots <= L); ++i)
+            {
+               if (0 == evaluate(lambda, L, power(code_length - 1 - i, -1)))
+               {
+                  if (roots < L)
+                     row[roots] = i;
+
+                  ++roots;
+               }
+            }
+
+            if (roots != L)
+               return uncorrectable;
+
+            /* omega(x) = s(x)lambda(x) mod x^fec_length */
+            galois::field_symbol omega[fec_length];
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               omega[j] = 0;
+
+               for (std::size_t i = 0; (i <= j) && (i <= L); ++i)
+               {
+                  omega[j] ^= field_.mul(lambda[i], s[j - i]);
+               }
+            }
+
+            galois::field_symbol value[fec_length];
+
+            for (std::size_t k = 0; k < L; ++k)
+            {
+               const std::size_t          p     = code_length - 1 - row[k];
+               const galois::field_symbol x     = power(p, -1);
+               const galois::field_symbol slope = derivative(lambda, L, x);
+
+               if (0 == slope)
+                  return uncorrectable;
+
+               value[k] = field_.div(field_.mul(power(p, 1 - static_cast<long>(gen_initial_index_)), evaluate(omega, fec_length - 1, x)), slope);
+            }
+
+            std::size_t count = 0;
+
+            for (std::size_t k = 0; k < L; ++k)
+            {
+               column[row[k] * stride] ^= static_cast<std::uint8_t>(value[k]);
+               count += (0 != value[k]) ? 1 : 0;
+            }
+
+            return count;
+         }
+
+         static inline void shift(galois::field_symbol* poly)
+         {
+            for (std::size_t i = fec_length; i > 0; --i)
+            {
+               poly[i] = poly[i - 1];
+            }
+
+            poly[0] = 0;
+         }
+
+         static inline void xor_row(const std::uint8_t* src, std::uint8_t* dst, const std::size_t length)
+         {
+            std::size_t i = 0;
+
+            for ( ; (i + sizeof(std::uint64_t)) <= length; i += sizeof(std::uint64_t))
+            {
+               std::uint64_t s;
+               std::uint64_t d;
+               std::memcpy(&s, src + i, sizeof(s));
+               std::memcpy(&d, dst + i, sizeof(d));
+               d ^= s;
+               std::memcpy(dst + i, &d, sizeof(d));
+            }
+
+            for ( ; i < length; ++i)
+            {
+               dst[i] ^= src[i];
+            }
+         }
+
+         const galois::field&                    field_;
+         const unsigned int                      gen_initial_index_;
+         const bool                              valid_;
+         std::vector<galois::region::multiplier> lfsr_multiplier_;
+         std::vector<galois::region::multiplier> syndrome_multiplier_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
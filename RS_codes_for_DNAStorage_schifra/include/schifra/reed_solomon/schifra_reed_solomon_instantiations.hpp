@@ -0,0 +1,65 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_INSTANTIATIONS_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_INSTANTIATIONS_HPP
+
+
+/*
+   Codes compiled once into the schifra_dna_storage library (see
+   src/schifra_instantiations.cpp) rather than in every consumer.
+
+   When SCHIFRA_EXTERN_TEMPLATES is defined, as it is for every target
+   linking the schifra CMake target, the encoder, decoder and dna_storage
+   headers declare these instantiations extern, so a consumer links against
+   the library's optimised copy instead of instantiating its own. Header
+   only builds leave it undefined and instantiate as before.
+
+   SCHIFRA_RS_COMMON_CODES(X) expands X(code_length, fec_length) for each
+   natural code:
+      RS(15,13), RS(15,11)                     : GF(2^4), two DNA bases per symbol
+      RS(63,55), RS(63,51)                     : GF(2^6)
+      RS(255,253) .. RS(255,223)               : GF(2^8), the usual rates
+
+   SCHIFRA_RS_COMMON_SHORTENED_CODES(X) expands X(code_length, fec_length)
+   for each shortened code of a natural RS(255,k) code:
+      RS(204,188)                              : DVB
+      RS(207,187)                              : ATSC
+*/
+
+#define SCHIFRA_RS_COMMON_CODES(X) \
+   X( 15,  2)                      \
+   X( 15,  4)                      \
+   X( 63,  8)                      \
+   X( 63, 12)                      \
+   X(255,  2)                      \
+   X(255,  4)                      \
+   X(255,  8)                      \
+   X(255, 16)                      \
+   X(255, 32)
+
+#define SCHIFRA_RS_COMMON_SHORTENED_CODES(X) \
+   X(204, 16)                                \
+   X(207, 20)
+
+
+#endif
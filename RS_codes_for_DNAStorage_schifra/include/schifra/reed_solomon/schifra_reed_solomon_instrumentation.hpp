@@ -0,0 +1,542 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_INSTRUMENTATION_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_INSTRUMENTATION_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "schifra/utils/schifra_metrics.hpp"
+
+#ifdef SCHIFRA_DECODER_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <x86intrin.h>
+#define SCHIFRA_INSTRUMENTATION_TSC
+#endif
+#endif
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Per stage timings and per outcome counts of reed_solomon::decoder,
+         compiled in only when SCHIFRA_DECODER_INSTRUMENTATION is defined
+         (the CMake option of the same name defines it for every target
+         linking schifra). Without it the hooks are empty inline functions
+         and the decoder is unchanged.
+
+         Every thread counts into its own accumulator, written with plain
+         relaxed stores, so the hooks take no lock and share no cache line.
+         totals() sums the accumulators of the live threads with those
+         left by threads that have exited.
+
+         Stage times are in ticks of the time stamp counter on x86 and in
+         nanoseconds elsewhere, see tick_unit().
+      */
+      namespace instrumentation
+      {
+
+         enum stage_t
+         {
+            e_syndrome         = 0,
+            e_berlekamp_massey = 1,
+            e_chien_search     = 2,
+            e_forney           = 3,
+            e_stage_count      = 4
+         };
+
+         /* Corrections of max_tracked_corrections or more share the last bucket */
+         static constexpr std::size_t max_tracked_corrections = 64;
+
+         /* Indexed by block::error_t */
+         static constexpr std::size_t error_kind_count = 9;
+
+         #ifdef SCHIFRA_DECODER_INSTRUMENTATION
+         static constexpr bool enabled = true;
+         #else
+         static constexpr bool enabled = false;
+         #endif
+
+         struct snapshot
+         {
+            snapshot()
+            {
+               clear();
+            }
+
+            inline void clear()
+            {
+               for (std::size_t i = 0; i < e_stage_count; ++i)
+               {
+                  stage_ticks[i] = 0;
+                  stage_calls[i] = 0;
+               }
+
+               for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+               {
+                  corrected[i] = 0;
+               }
+
+               for (std::size_t i = 0; i < error_kind_count; ++i)
+               {
+                  unrecoverable[i] = 0;
+               }
+
+               clean = 0;
+            }
+
+            inline void merge(const snapshot& s)
+            {
+               for (std::size_t i = 0; i < e_stage_count; ++i)
+               {
+                  stage_ticks[i] += s.stage_ticks[i];
+                  stage_calls[i] += s.stage_calls[i];
+               }
+
+               for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+               {
+                  corrected[i] += s.corrected[i];
+               }
+
+               for (std::size_t i = 0; i < error_kind_count; ++i)
+               {
+                  unrecoverable[i] += s.unrecoverable[i];
+               }
+
+               clean += s.clean;
+            }
+
+            inline std::uint64_t blocks() const
+            {
+               std::uint64_t total = clean;
+
+               for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+               {
+                  total += corrected[i];
+               }
+
+               for (std::size_t i = 0; i < error_kind_count; ++i)
+               {
+                  total += unrecoverable[i];
+               }
+
+               return total;
+            }
+
+            inline double ticks_per_call(const stage_t stage) const
+            {
+               return (0 == stage_calls[stage]) ? 0.0 : static_cast<double>(stage_ticks[stage]) / stage_calls[stage];
+            }
+
+            void print(std::FILE* out) const;
+
+            std::uint64_t stage_ticks  [e_stage_count];
+            std::uint64_t stage_calls  [e_stage_count];   /* codewords through the stage */
+            std::uint64_t corrected    [max_tracked_corrections + 1];
+            std::uint64_t unrecoverable[error_kind_count];
+            std::uint64_t clean;
+         };
+
+         inline const char* stage_name(const stage_t stage)
+         {
+            switch (stage)
+            {
+               case e_syndrome         : return "syndrome";
+               case e_berlekamp_massey : return "berlekamp_massey";
+               case e_chien_search     : return "chien_search";
+               case e_forney           : return "forney";
+               default                 : return "unknown";
+            }
+         }
+
+         inline const char* tick_unit()
+         {
+            #ifdef SCHIFRA_INSTRUMENTATION_TSC
+            return "cycles";
+            #else
+            return "ns";
+            #endif
+         }
+
+         inline void snapshot::print(std::FILE* out) const
+         {
+            std::fprintf(out, "decoder: %llu blocks, %llu clean",
+                         static_cast<unsigned long long>(blocks()),
+                         static_cast<unsigned long long>(clean));
+
+            for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+            {
+               if (0 != corrected[i])
+                  std::fprintf(out, ", corrected-%zu%s=%llu", i, (max_tracked_corrections == i) ? "+" : "",
+                               static_cast<unsigned long long>(corrected[i]));
+            }
+
+            for (std::size_t i = 0; i < error_kind_count; ++i)
+            {
+               if (0 != unrecoverable[i])
+                  std::fprintf(out, ", unrecoverable(error %zu)=%llu", i, static_cast<unsigned long long>(unrecoverable[i]));
+            }
+
+            std::fprintf(out, "\n");
+
+            for (std::size_t i = 0; i < e_stage_count; ++i)
+            {
+               std::fprintf(out, "  %-17s %12llu codewords %10.1f %s/codeword\n",
+                            stage_name(static_cast<stage_t>(i)),
+                            static_cast<unsigned long long>(stage_calls[i]),
+                            ticks_per_call(static_cast<stage_t>(i)),
+                            tick_unit());
+            }
+         }
+
+         #ifdef SCHIFRA_DECODER_INSTRUMENTATION
+
+         inline std::uint64_t ticks()
+         {
+            #ifdef SCHIFRA_INSTRUMENTATION_TSC
+            return static_cast<std::uint64_t>(__rdtsc());
+            #else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count());
+            #endif
+         }
+
+         class registry;
+
+         /*
+            Counters of one thread. Only the owning thread writes, so an
+            increment is a relaxed load and store rather than a locked
+            read-modify-write; snapshot() may read them at any time.
+         */
+         class accumulator
+         {
+         public:
+
+            inline accumulator();
+           ~accumulator();
+
+            inline void add(std::atomic<std::uint64_t>& counter, const std::uint64_t amount)
+            {
+               counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            inline void collect(snapshot& s) const
+            {
+               for (std::size_t i = 0; i < e_stage_count; ++i)
+               {
+                  s.stage_ticks[i] += stage_ticks[i].load(std::memory_order_relaxed);
+                  s.stage_calls[i] += stage_calls[i].load(std::memory_order_relaxed);
+               }
+
+               for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+               {
+                  s.corrected[i] += corrected[i].load(std::memory_order_relaxed);
+               }
+
+               for (std::size_t i = 0; i < error_kind_count; ++i)
+               {
+                  s.unrecoverable[i] += unrecoverable[i].load(std::memory_order_relaxed);
+               }
+
+               s.clean += clean.load(std::memory_order_relaxed);
+            }
+
+            inline void clear()
+            {
+               for (std::size_t i = 0; i < e_stage_count; ++i)
+               {
+                  stage_ticks[i].store(0, std::memory_order_relaxed);
+                  stage_calls[i].store(0, std::memory_order_relaxed);
+               }
+
+               for (std::size_t i = 0; i <= max_tracked_corrections; ++i)
+               {
+                  corrected[i].store(0, std::memory_order_relaxed);
+               }
+
+               for (std::size_t i = 0; i < error_kind_count; ++i)
+               {
+                  unrecoverable[i].store(0, std::memory_order_relaxed);
+               }
+
+               clean.store(0, std::memory_order_relaxed);
+            }
+
+            std::atomic<std::uint64_t> stage_ticks  [e_stage_count];
+            std::atomic<std::uint64_t> stage_calls  [e_stage_count];
+            std::atomic<std::uint64_t> corrected    [max_tracked_corrections + 1];
+            std::atomic<std::uint64_t> unrecoverable[error_kind_count];
+            std::atomic<std::uint64_t> clean;
+
+         private:
+
+            accumulator(const accumulator&);
+            accumulator& operator=(const accumulator&);
+         };
+
+         class registry
+         {
+         public:
+
+            static inline registry& instance()
+            {
+               static registry r;
+               return r;
+            }
+
+            inline void attach(accumulator* a)
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               live_.push_back(a);
+            }
+
+            /* A thread exiting folds its counts into retired_ */
+            inline void detach(accumulator* a)
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               a->collect(retired_);
+
+               for (std::size_t i = 0; i < live_.size(); ++i)
+               {
+                  if (live_[i] == a)
+                  {
+                     live_[i] = live_.back();
+                     live_.pop_back();
+                     break;
+                  }
+               }
+            }
+
+            inline snapshot collect()
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               snapshot s = retired_;
+
+               for (std::size_t i = 0; i < live_.size(); ++i)
+               {
+                  live_[i]->collect(s);
+               }
+
+               return s;
+            }
+
+            inline void reset()
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               retired_.clear();
+
+               for (std::size_t i = 0; i < live_.size(); ++i)
+               {
+                  live_[i]->clear();
+               }
+            }
+
+         private:
+
+            registry() {}
+            registry(const registry&);
+            registry& operator=(const registry&);
+
+            std::mutex                mutex_;
+            std::vector<accumulator*> live_;
+            snapshot                  retired_;
+         };
+
+         inline accumulator::accumulator()
+         {
+            clear();
+            registry::instance().attach(this);
+         }
+
+         inline accumulator::~accumulator()
+         {
+            registry::instance().detach(this);
+         }
+
+         inline accumulator& local()
+         {
+            static thread_local accumulator a;
+            return a;
+         }
+
+         /* Times the enclosing scope as count codewords through stage */
+         class stage_timer
+         {
+         public:
+
+            explicit stage_timer(const stage_t stage, const std::size_t count = 1)
+            : stage_(stage),
+              count_(count),
+              start_(ticks())
+            {}
+
+           ~stage_timer()
+            {
+               accumulator& a = local();
+
+               a.add(a.stage_ticks[stage_], ticks() - start_);
+               a.add(a.stage_calls[stage_], count_);
+            }
+
+         private:
+
+            stage_timer(const stage_timer&);
+            stage_timer& operator=(const stage_timer&);
+
+            const stage_t       stage_;
+            const std::size_t   count_;
+            const std::uint64_t start_;
+         };
+
+         inline void record_clean(const std::size_t count = 1)
+         {
+            accumulator& a = local();
+            a.add(a.clean, count);
+         }
+
+         inline void record_corrected(const std::size_t corrections)
+         {
+            accumulator& a = local();
+            a.add(a.corrected[(corrections < max_tracked_corrections) ? corrections : max_tracked_corrections], 1);
+         }
+
+         inline void record_unrecoverable(const int error)
+         {
+            accumulator& a = local();
+            a.add(a.unrecoverable[((error >= 0) && (static_cast<std::size_t>(error) < error_kind_count)) ? error : 0], 1);
+         }
+
+         /*
+            Totals over every thread since start up or the last reset().
+            Note: Counts of a thread still decoding may be a few codewords
+                  behind, reset() during decoding may lose a few.
+         */
+         inline snapshot totals()
+         {
+            return registry::instance().collect();
+         }
+
+         inline void reset()
+         {
+            registry::instance().reset();
+         }
+
+         #else
+
+         class stage_timer
+         {
+         public:
+
+            explicit stage_timer(const stage_t, const std::size_t = 1) {}
+         };
+
+         inline void record_clean        (const std::size_t = 1) {}
+         inline void record_corrected    (const std::size_t    ) {}
+         inline void record_unrecoverable(const int            ) {}
+
+         inline snapshot totals() { return snapshot(); }
+         inline void     reset () {}
+
+         #endif
+
+         /*
+            Publish totals() through a metrics registry, read on every
+            scrape: blocks by outcome, symbols corrected, and the ticks
+            and codewords of each stage. Nothing is registered when the
+            instrumentation is compiled out.
+         */
+         inline void export_metrics(utils::metrics::registry& registry)
+         {
+            if (!enabled)
+               return;
+
+            registry.add_collector([](std::vector<utils::metrics::sample>& samples)
+            {
+               typedef utils::metrics::registry r;
+
+               const snapshot s = totals();
+
+               std::uint64_t corrected_blocks  = 0;
+               std::uint64_t corrected_symbols = 0;
+               std::uint64_t failed_blocks     = 0;
+
+               for (std::size_t k = 0; k <= max_tracked_corrections; ++k)
+               {
+                  corrected_blocks  += s.corrected[k];
+                  corrected_symbols += k * s.corrected[k];
+               }
+
+               for (std::size_t e = 0; e < error_kind_count; ++e)
+               {
+                  failed_blocks += s.unrecoverable[e];
+               }
+
+               const char* blocks_help = "Codewords decoded, by outcome";
+
+               samples.push_back(r::make_sample("schifra_decoder_blocks_total", blocks_help, utils::metrics::e_counter,
+                                                "schifra_decoder_blocks_total", "outcome=\"clean\"", static_cast<double>(s.clean)));
+               samples.push_back(r::make_sample("schifra_decoder_blocks_total", blocks_help, utils::metrics::e_counter,
+                                                "schifra_decoder_blocks_total", "outcome=\"corrected\"", static_cast<double>(corrected_blocks)));
+               samples.push_back(r::make_sample("schifra_decoder_blocks_total", blocks_help, utils::metrics::e_counter,
+                                                "schifra_decoder_blocks_total", "outcome=\"unrecoverable\"", static_cast<double>(failed_blocks)));
+
+               samples.push_back(r::make_sample("schifra_decoder_corrected_symbols_total", "Symbols corrected",
+                                                utils::metrics::e_counter, "schifra_decoder_corrected_symbols_total", "",
+                                                static_cast<double>(corrected_symbols)));
+
+               const std::string ticks_help = std::string("Time spent per decoder stage, in ") + tick_unit();
+
+               for (std::size_t i = 0; i < e_stage_count; ++i)
+               {
+                  const std::string label = std::string("stage=\"") + stage_name(static_cast<stage_t>(i)) + "\"";
+
+                  samples.push_back(r::make_sample("schifra_decoder_stage_ticks_total", ticks_help, utils::metrics::e_counter,
+                                                   "schifra_decoder_stage_ticks_total", label, static_cast<double>(s.stage_ticks[i])));
+                  samples.push_back(r::make_sample("schifra_decoder_stage_codewords_total", "Codewords through each decoder stage",
+                                                   utils::metrics::e_counter, "schifra_decoder_stage_codewords_total", label,
+                                                   static_cast<double>(s.stage_calls[i])));
+               }
+            });
+         }
+
+      } // namespace instrumentation
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -24,11 +24,15 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_INTERLEAVING_HPP
 
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block_stack.hpp"
+#include "schifra/utils/schifra_transpose.hpp"
 
 
 namespace schifra
@@ -37,47 +41,72 @@ namespace schifra
    namespace reed_solomon
    {
 
-      template <std::size_t code_length, std::size_t fec_length>
-      inline void interleave(block<code_length,fec_length> (&block_stack)[code_length])
+      namespace details
       {
-         for (std::size_t i = 0; i < code_length; ++i)
+         /*
+            The full stack interleavers are transposes: symbol index of row
+            goes to index * row_count + row of the interleaved stack read as
+            one contiguous run, and deinterleaving is its inverse. Both go
+            through the tiled utils::transpose and a row_count x block_length
+            auxiliary matrix.
+         */
+         template <typename T, std::size_t block_length>
+         inline void interleave_rows(data_block<T,block_length>* block_stack, const std::size_t row_count, T* auxiliary_stack)
          {
-            for (std::size_t j = i + 1; j < code_length; ++j)
+            utils::transpose<T>(row_count, block_length,
+                                [&](const std::size_t row)   { return static_cast<const T*>(block_stack[row].begin()); },
+                                [&](const std::size_t index) { return auxiliary_stack + (index * row_count);          });
+
+            for (std::size_t row = 0; row < row_count; ++row)
             {
-               typename block<code_length,fec_length>::symbol_type tmp = block_stack[i][j];
-               block_stack[i][j] = block_stack[j][i];
-               block_stack[j][i] = tmp;
-           }
+               std::copy(auxiliary_stack + (row * block_length), auxiliary_stack + ((row + 1) * block_length), block_stack[row].begin());
+            }
          }
-      }
-
-      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count>
-      inline void interleave(block<code_length,fec_length> (&block_stack)[row_count])
-      {
-         block<code_length,fec_length> auxiliary_stack[row_count];
 
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
-
-         for (std::size_t index = 0; index < code_length; ++index)
+         template <typename T, std::size_t block_length>
+         inline void deinterleave_rows(data_block<T,block_length>* block_stack, const std::size_t row_count, T* auxiliary_stack)
          {
             for (std::size_t row = 0; row < row_count; ++row)
             {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_index == code_length)
-               {
-                  aux_index = 0;
-                  aux_row++;
-               }
+               std::copy(block_stack[row].begin(), block_stack[row].end(), auxiliary_stack + (row * block_length));
             }
+
+            utils::transpose<T>(block_length, row_count,
+                                [&](const std::size_t index) { return static_cast<const T*>(auxiliary_stack + (index * row_count)); },
+                                [&](const std::size_t row)   { return block_stack[row].begin();                                    });
          }
 
-         copy<code_length,fec_length,row_count>(auxiliary_stack,block_stack);
+      } // namespace details
+
+      template <std::size_t code_length, std::size_t fec_length, typename symbol_t>
+      inline void interleave(block<code_length,fec_length,code_length - fec_length,symbol_t> (&block_stack)[code_length])
+      {
+         utils::transpose_in_place<symbol_t>(code_length,
+                                             [&](const std::size_t i) { return block_stack[i].data; });
       }
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count>
-      inline void interleave(block<code_length,fec_length,row_count> (&block_stack)[row_count],
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void interleave(block<code_length,fec_length,code_length - fec_length,symbol_t> (&block_stack)[row_count])
+      {
+         /*
+            Symbol index of row lands at index * row_count + row of the
+            interleaved stack read as one run of symbols, ie: the stack is
+            transposed into a code_length x row_count matrix.
+         */
+         symbol_t auxiliary_stack[code_length * row_count];
+
+         utils::transpose<symbol_t>(row_count, code_length,
+                                    [&](const std::size_t row)   { return static_cast<const symbol_t*>(block_stack[row].data); },
+                                    [&](const std::size_t index) { return auxiliary_stack + (index * row_count);             });
+
+         for (std::size_t row = 0; row < row_count; ++row)
+         {
+            std::copy(auxiliary_stack + (row * code_length), auxiliary_stack + ((row + 1) * code_length), block_stack[row].data);
+         }
+      }
+
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void interleave(block<code_length,fec_length,row_count,symbol_t> (&block_stack)[row_count],
                              const std::size_t partial_code_length)
       {
          if (partial_code_length == code_length)
@@ -86,7 +115,7 @@ namespace schifra
          }
          else
          {
-            block<code_length,fec_length,row_count> auxiliary_stack[row_count];
+            block<code_length,fec_length,row_count,symbol_t> auxiliary_stack[row_count];
 
             std::size_t aux_row   = 0;
             std::size_t aux_index = 0;
@@ -141,40 +170,16 @@ namespace schifra
       template <typename T, std::size_t block_length>
       inline void interleave(data_block<T,block_length> (&block_stack)[block_length])
       {
-         for (std::size_t i = 0; i < block_length; ++i)
-         {
-            for (std::size_t j = i + 1; j < block_length; ++j)
-            {
-               T tmp = block_stack[i][j];
-               block_stack[i][j] = block_stack[j][i];
-               block_stack[j][i] = tmp;
-           }
-         }
+         utils::transpose_in_place<T>(block_length,
+                                      [&](const std::size_t i) { return block_stack[i].begin(); });
       }
 
       template <typename T, std::size_t block_length, std::size_t row_count>
       inline void interleave(data_block<T,block_length> (&block_stack)[row_count])
       {
-         data_block<T,block_length> auxiliary_stack[row_count];
-
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
-
-         for (std::size_t index = 0; index < block_length; ++index)
-         {
-            for (std::size_t row = 0; row < row_count; ++row)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_index == block_length)
-               {
-                  aux_index = 0;
-                  aux_row++;
-               }
-            }
-         }
+         T auxiliary_stack[block_length * row_count];
 
-         copy<T,block_length,row_count>(auxiliary_stack,block_stack);
+         details::interleave_rows<T,block_length>(block_stack, row_count, auxiliary_stack);
       }
 
       template <typename T, std::size_t block_length, std::size_t row_count>
@@ -238,34 +243,9 @@ namespace schifra
       inline void interleave(data_block<T,block_length> block_stack[],
                              const std::size_t row_count)
       {
-         data_block<T,block_length>* auxiliary_stack = new data_block<T,block_length>[row_count];
-
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
-
-         for (std::size_t index = 0; index < block_length; ++index)
-         {
-            for (std::size_t row = 0; row < row_count; ++row)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_index == block_length)
-               {
-                  aux_index = 0;
-                  aux_row++;
-               }
-            }
-         }
-
-         for (std::size_t row = 0; row < row_count; ++row)
-         {
-            for (std::size_t index = 0; index < block_length; ++index)
-            {
-               block_stack[row][index] = auxiliary_stack[row][index];
-            }
-         }
+         std::vector<T> auxiliary_stack(block_length * row_count);
 
-         delete[] auxiliary_stack;
+         details::interleave_rows<T,block_length>(block_stack, row_count, auxiliary_stack.data());
       }
 
       template <typename T, std::size_t block_length>
@@ -322,33 +302,23 @@ namespace schifra
          delete[] auxiliary_stack;
       }
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count>
-      inline void deinterleave(block<code_length,fec_length> (&block_stack)[row_count])
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void deinterleave(block<code_length,fec_length,code_length - fec_length,symbol_t> (&block_stack)[row_count])
       {
-         block<code_length,fec_length> auxiliary_stack[row_count];
-
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
+         symbol_t auxiliary_stack[code_length * row_count];
 
          for (std::size_t row = 0; row < row_count; ++row)
          {
-            for (std::size_t index = 0; index < code_length; ++index)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_row == row_count)
-               {
-                  aux_row = 0;
-                  aux_index++;
-               }
-            }
+            std::copy(block_stack[row].data, block_stack[row].data + code_length, auxiliary_stack + (row * code_length));
          }
 
-         copy<code_length,fec_length,row_count>(auxiliary_stack,block_stack);
+         utils::transpose<symbol_t>(code_length, row_count,
+                                    [&](const std::size_t index) { return static_cast<const symbol_t*>(auxiliary_stack + (index * row_count)); },
+                                    [&](const std::size_t row)   { return block_stack[row].data;                                               });
       }
 
-      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count>
-      inline void deinterleave(block<code_length,fec_length> (&block_stack)[row_count],
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void deinterleave(block<code_length,fec_length,code_length - fec_length,symbol_t> (&block_stack)[row_count],
                                const std::size_t partial_code_length)
       {
          if (partial_code_length == code_length)
@@ -357,7 +327,7 @@ namespace schifra
          }
          else
          {
-            block<code_length,fec_length> auxiliary_stack[row_count];
+            block<code_length,fec_length,code_length - fec_length,symbol_t> auxiliary_stack[row_count];
 
             std::size_t aux_row1   = 0;
             std::size_t aux_index1 = 0;
@@ -417,76 +387,25 @@ namespace schifra
       template <typename T, std::size_t block_length>
       inline void deinterleave(data_block<T,block_length> (&block_stack)[block_length])
       {
-         data_block<T,block_length> auxiliary_stack[block_length];
-
-         for (std::size_t row = 0; row < block_length; ++row)
-         {
-            for (std::size_t index = 0; index < block_length; ++index)
-            {
-               auxiliary_stack[index][row] = block_stack[row][index];
-            }
-         }
-
-         copy<T,block_length,block_length>(auxiliary_stack,block_stack);
+         utils::transpose_in_place<T>(block_length,
+                                      [&](const std::size_t i) { return block_stack[i].begin(); });
       }
 
       template <typename T, std::size_t block_length, std::size_t row_count>
       inline void deinterleave(data_block<T,block_length> (&block_stack)[row_count])
       {
-         data_block<T,block_length> auxiliary_stack[row_count];
-
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
-
-         for (std::size_t row = 0; row < row_count; ++row)
-         {
-            for (std::size_t index = 0; index < block_length; ++index)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_row == row_count)
-               {
-                  aux_row = 0;
-                  aux_index++;
-               }
-            }
-         }
+         T auxiliary_stack[block_length * row_count];
 
-         copy<T,block_length,row_count>(auxiliary_stack,block_stack);
+         details::deinterleave_rows<T,block_length>(block_stack, row_count, auxiliary_stack);
       }
 
       template <typename T, std::size_t block_length>
       inline void deinterleave(data_block<T,block_length> block_stack[],
                                const std::size_t row_count)
       {
-         data_block<T,block_length>* auxiliary_stack = new data_block<T,block_length>[row_count];
-
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = 0;
+         std::vector<T> auxiliary_stack(block_length * row_count);
 
-         for (std::size_t row = 0; row < row_count; ++row)
-         {
-            for (std::size_t index = 0; index < block_length; ++index)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_row == row_count)
-               {
-                  aux_row = 0;
-                  aux_index++;
-               }
-            }
-         }
-
-         for (std::size_t row = 0; row < row_count; ++row)
-         {
-            for (std::size_t index = 0; index < block_length; ++index)
-            {
-               block_stack[row][index] = auxiliary_stack[row][index];
-            }
-         }
-
-         delete[] auxiliary_stack;
+         details::deinterleave_rows<T,block_length>(block_stack, row_count, auxiliary_stack.data());
       }
 
       template <typename T, std::size_t block_length>
@@ -557,79 +476,121 @@ namespace schifra
       template <typename T, std::size_t block_length, std::size_t skip_columns>
       inline void interleave_columnskip(data_block<T,block_length>* block_stack)
       {
-         for (std::size_t i = 0; i < block_length; ++i)
-         {
-            for (std::size_t j = i + 1; j < block_length; ++j)
-            {
-               std::size_t x1 = i + skip_columns;
-               std::size_t x2 = j + skip_columns;
-
-               T tmp = block_stack[i][x2];
-               block_stack[i][x2] = block_stack[j][x1];
-               block_stack[j][x1] = tmp;
-            }
-         }
+         utils::transpose_in_place<T>(block_length,
+                                      [&](const std::size_t i) { return block_stack[i].begin(); },
+                                      skip_columns);
       }
 
       template <typename T, std::size_t block_length, std::size_t skip_columns>
       inline void interleave_columnskip(data_block<T,block_length>* block_stack, const std::size_t& row_count)
       {
-         data_block<T,block_length>* auxiliary_stack = new data_block<T,block_length>[row_count];
+         const std::size_t width = block_length - skip_columns;
 
-         std::size_t aux_row   = 0;
-         std::size_t aux_index = skip_columns;
+         std::vector<T> auxiliary_stack(width * row_count);
 
-         for (std::size_t index = skip_columns; index < block_length; ++index)
-         {
-            for (std::size_t row = 0; row < row_count; ++row)
-            {
-               auxiliary_stack[aux_row][aux_index] = block_stack[row][index];
-
-               if (++aux_index == block_length)
-               {
-                  aux_index = skip_columns;
-                  aux_row++;
-               }
-            }
-         }
+         utils::transpose<T>(row_count, width,
+                             [&](const std::size_t row)   { return static_cast<const T*>(block_stack[row].begin() + skip_columns); },
+                             [&](const std::size_t index) { return auxiliary_stack.data() + (index * row_count);                });
 
          for (std::size_t row = 0; row < row_count; ++row)
          {
-            for (std::size_t index = skip_columns; index < block_length; ++index)
-            {
-               block_stack[row][index] = auxiliary_stack[row][index];
-            }
+            std::copy(auxiliary_stack.data() + (row * width),
+                      auxiliary_stack.data() + ((row + 1) * width),
+                      block_stack[row].begin() + skip_columns);
          }
-
-         delete[] auxiliary_stack;
       }
 
       template <typename T, std::size_t data_length>
       inline void interleave(T* block_stack[data_length])
       {
-         for (std::size_t i = 0; i < data_length; ++i)
-         {
-            for (std::size_t j = i + 1; j < data_length; ++j)
-            {
-               T tmp = block_stack[i][j];
-               block_stack[i][j] = block_stack[j][i];
-               block_stack[j][i] = tmp;
-            }
-         }
+         utils::transpose_in_place<T>(data_length,
+                                      [&](const std::size_t i) { return block_stack[i]; });
       }
 
       template <typename T, std::size_t data_length, std::size_t skip_columns>
       inline void interleave_columnskip(T* block_stack[data_length])
       {
-         for (std::size_t i = skip_columns; i < data_length; ++i)
-         {
-            for (std::size_t j = i + 1; j < data_length; ++j)
-            {
-               T tmp = block_stack[i][j];
-               block_stack[i][j] = block_stack[j][i];
-               block_stack[j][i] = tmp;
-            }
-         }
+         utils::transpose_in_place<T>(data_length - skip_columns,
+                                      [&](const std::size_t i) { return block_stack[skip_columns + i]; },
+                                      skip_columns);
+      }
+
+      /*
+         Where symbol index of row ends up once a stack of row_count rows
+         has been through interleave(), whose last row may only hold
+         partial_block_length symbols. The result is the offset into the
+         interleaved stack read as one contiguous run of symbols.
+      */
+      inline std::size_t interleaved_offset(const std::size_t row,
+                                            const std::size_t index,
+                                            const std::size_t row_count,
+                                            const std::size_t partial_block_length)
+      {
+         if (index < partial_block_length)
+            return (index * row_count) + row;
+         else
+            return (partial_block_length * row_count) + ((index - partial_block_length) * (row_count - 1)) + row;
+      }
+
+      /*
+         Runtime sized interleaving of a stack held row-major in a flat
+         buffer: row_count rows of block_length symbols, the last of which
+         only holds partial_block_length symbols (block_length for a full
+         stack). The results are laid out as interleave()/deinterleave()
+         leave an array of rows, the partial row included, but the stack
+         dimensions are plain arguments so the depth can be picked per
+         file. The source and destination must not overlap.
+      */
+      template <typename T>
+      inline void interleave_stack(const T* stack, T* interleaved_stack,
+                                   const std::size_t block_length,
+                                   const std::size_t row_count,
+                                   const std::size_t partial_block_length)
+      {
+         if ((0 == row_count) || (partial_block_length > block_length))
+            return;
+
+         T* const tail = interleaved_stack + (partial_block_length * row_count);
+
+         utils::transpose<T>(row_count, partial_block_length,
+                             [&](const std::size_t row)   { return stack + (row * block_length);             },
+                             [&](const std::size_t index) { return interleaved_stack + (index * row_count);  });
+
+         utils::transpose<T>(row_count - 1, block_length - partial_block_length,
+                             [&](const std::size_t row)   { return stack + (row * block_length) + partial_block_length; },
+                             [&](const std::size_t index) { return tail + (index * (row_count - 1));                   });
+      }
+
+      template <typename T>
+      inline void deinterleave_stack(const T* interleaved_stack, T* stack,
+                                     const std::size_t block_length,
+                                     const std::size_t row_count,
+                                     const std::size_t partial_block_length)
+      {
+         if ((0 == row_count) || (partial_block_length > block_length))
+            return;
+
+         const T* const tail = interleaved_stack + (partial_block_length * row_count);
+
+         utils::transpose<T>(partial_block_length, row_count,
+                             [&](const std::size_t index) { return interleaved_stack + (index * row_count); },
+                             [&](const std::size_t row)   { return stack + (row * block_length);            });
+
+         utils::transpose<T>(block_length - partial_block_length, row_count - 1,
+                             [&](const std::size_t index) { return tail + (index * (row_count - 1));                   },
+                             [&](const std::size_t row)   { return stack + (row * block_length) + partial_block_length; });
+      }
+
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void interleave(block_stack<code_length,fec_length,row_count,symbol_t>& stack)
+      {
+         stack.interleave();
+      }
+
+      template <std::size_t code_length, std::size_t fec_length, std::size_t row_count, typename symbol_t>
+      inline void deinterleave(block_stack<code_length,fec_length,row_count,symbol_t>& stack)
+      {
+         stack.deinterleave();
       }
 
    } // namespace reed_solomon
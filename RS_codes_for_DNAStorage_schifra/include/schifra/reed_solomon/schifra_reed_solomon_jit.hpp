@@ -0,0 +1,311 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_JIT_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_JIT_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__)) && !defined(SCHIFRA_NO_JIT)
+   #define SCHIFRA_JIT_X86_64
+   #include <sys/mman.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         LFSR kernel generated at run time for one code over a field of at
+         most 8 bits: parity = data(x).x^fec_length mod g(x), written as
+         encoder::encode() writes block::fec(i), for data of any length.
+
+         The register lives in up to four xmm registers, fec_length bytes
+         at the top of them, so a step is one byte shift of the register
+         and one xor of the feedback row. The rows, g(x) times every
+         feedback symbol laid out as the register, follow the code in the
+         same mapping, and the fec length, row stride and symbol mask are
+         immediates of the code. Only SSE2 is used, which every x86-64 has.
+
+         valid() is false where no kernel can be generated: other targets
+         (or SCHIFRA_NO_JIT), fields over 8 bits, more than 64 parity
+         symbols, or a system refusing executable memory.
+      */
+      class jit_lfsr
+      {
+      public:
+
+         typedef void (*kernel_t)(const std::uint8_t* data, std::size_t length, std::uint8_t* parity);
+
+         static const std::size_t max_fec_length = 64;
+
+         /* generator: the fec_length + 1 coefficients of g(x), g_0 first */
+         jit_lfsr(const galois::field& field, const std::vector<galois::field_symbol>& generator)
+         : kernel_(0),
+           region_(0),
+           region_size_(0),
+           fec_length_(generator.empty() ? 0 : generator.size() - 1)
+         {
+            #ifdef SCHIFRA_JIT_X86_64
+            if ((field.size() > 0xFF) || (0 == fec_length_) || (fec_length_ > max_fec_length) || (0 == generator[fec_length_]))
+               return;
+
+            std::vector<std::uint8_t> code;
+            std::vector<std::uint8_t> rows;
+
+            emit_x86_64(field, generator, code, rows);
+
+            const std::size_t table_offset = (code.size() + 63) & ~std::size_t(63);
+
+            region_size_ = table_offset + rows.size();
+
+            void* region = ::mmap(0, region_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (MAP_FAILED == region)
+               return;
+
+            std::memcpy(region, code.data(), code.size());
+            std::memcpy(static_cast<std::uint8_t*>(region) + table_offset, rows.data(), rows.size());
+
+            if (0 != ::mprotect(region, region_size_, PROT_READ | PROT_EXEC))
+            {
+               ::munmap(region, region_size_);
+               return;
+            }
+
+            region_ = region;
+            kernel_ = reinterpret_cast<kernel_t>(region);
+            #else
+            (void)field;
+            #endif
+         }
+
+        ~jit_lfsr()
+         {
+            #ifdef SCHIFRA_JIT_X86_64
+            if (region_)
+               ::munmap(region_, region_size_);
+            #endif
+         }
+
+         inline bool valid() const
+         {
+            return (0 != kernel_);
+         }
+
+         inline std::size_t fec_length() const
+         {
+            return fec_length_;
+         }
+
+         /* Bytes of code and feedback rows generated */
+         inline std::size_t size() const
+         {
+            return region_size_;
+         }
+
+         inline void operator()(const std::uint8_t* data, const std::size_t length, std::uint8_t* parity) const
+         {
+            kernel_(data, length, parity);
+         }
+
+      private:
+
+         jit_lfsr(const jit_lfsr&);
+         jit_lfsr& operator=(const jit_lfsr&);
+
+         #ifdef SCHIFRA_JIT_X86_64
+         /*
+            void kernel(const uint8_t* data, size_t length, uint8_t* parity)
+            System V: rdi = data, rsi = length, rdx = parity.
+
+            Register byte i + pad of xmm0..xmm(n-1) (pad = 16n - fec_length)
+            holds reg[i + 1] of encoder::lfsr_encode(), so the symbol fed
+            back is the top byte of xmm(n-1). The rows are 16n bytes, 64
+            byte aligned right behind the code, rows[v] holding f.g_i at
+            byte i + pad for the feedback f = v / g_fec_length.
+         */
+         void emit_x86_64(const galois::field&                     field,
+                          const std::vector<galois::field_symbol>& generator,
+                          std::vector<std::uint8_t>&               code,
+                          std::vector<std::uint8_t>&               rows) const
+         {
+            const std::size_t   n      = (fec_length_ + 15) / 16;
+            const std::size_t   stride = 16 * n;
+            const std::size_t   pad    = stride - fec_length_;
+            const unsigned int  mask   = static_cast<unsigned int>(field.mask());
+            const std::uint8_t  top    = static_cast<std::uint8_t>(n - 1);
+
+            rows.assign((mask + 1) * stride, 0);
+
+            for (unsigned int v = 0; v <= mask; ++v)
+            {
+               const galois::field_symbol feedback = field.div(static_cast<galois::field_symbol>(v), generator[fec_length_]);
+
+               for (std::size_t i = 0; i < fec_length_; ++i)
+               {
+                  rows[v * stride + pad + i] = static_cast<std::uint8_t>(field.mul(feedback, generator[i]));
+               }
+            }
+
+            code.clear();
+
+            /* pxor xmmk, xmmk */
+            for (std::size_t k = 0; k < n; ++k)
+            {
+               emit(code, 0x66, 0x0F, 0xEF, static_cast<std::uint8_t>(0xC0 | (k << 3) | k));
+            }
+
+            /* lea r8, [rip + rows], patched below */
+            emit(code, 0x4C, 0x8D, 0x05);
+            const std::size_t rows_fixup = code.size();
+            emit32(code, 0);
+
+            /* test rsi, rsi ; jz done */
+            emit(code, 0x48, 0x85, 0xF6);
+            emit(code, 0x0F, 0x84);
+            const std::size_t done_fixup = code.size();
+            emit32(code, 0);
+
+            const std::size_t loop = code.size();
+
+            /* movzx eax, byte [rdi] */
+            emit(code, 0x0F, 0xB6, 0x07);
+
+            /* pextrw ecx, xmm(n-1), 7 ; shr ecx, 8 ; xor eax, ecx */
+            emit(code, 0x66, 0x0F, 0xC5, static_cast<std::uint8_t>(0xC8 | top), 0x07);
+            emit(code, 0xC1, 0xE9, 0x08);
+            emit(code, 0x31, 0xC8);
+
+            /* and eax, mask */
+            if (mask != 0xFF)
+            {
+               emit(code, 0x25);
+               emit32(code, mask);
+            }
+
+            /* eax = v * stride: shl for 16, 32 and 64, imul otherwise */
+            if (3 == n)
+            {
+               emit(code, 0x69, 0xC0);
+               emit32(code, static_cast<std::uint32_t>(stride));
+            }
+            else
+            {
+               emit(code, 0xC1, 0xE0, static_cast<std::uint8_t>((1 == n) ? 4 : ((2 == n) ? 5 : 6)));
+            }
+
+            /* Shift the register up a byte, carrying across xmm registers */
+            for (std::size_t k = n - 1; k > 0; --k)
+            {
+               emit(code, 0x66, 0x0F, 0x6F, static_cast<std::uint8_t>(0xE0 | (k - 1)));      /* movdqa xmm4, xmm(k-1) */
+               emit(code, 0x66, 0x0F, 0x73, 0xDC, 0x0F);                                     /* psrldq xmm4, 15       */
+               emit(code, 0x66, 0x0F, 0x73, static_cast<std::uint8_t>(0xF8 | k), 0x01);      /* pslldq xmmk, 1        */
+               emit(code, 0x66, 0x0F, 0xEB, static_cast<std::uint8_t>(0xC4 | (k << 3)));     /* por    xmmk, xmm4     */
+            }
+
+            emit(code, 0x66, 0x0F, 0x73, 0xF8, 0x01);                                        /* pslldq xmm0, 1        */
+
+            /* pxor xmmk, [r8 + rax + 16k] */
+            for (std::size_t k = 0; k < n; ++k)
+            {
+               emit(code, 0x66, 0x41, 0x0F, 0xEF);
+               emit(code, static_cast<std::uint8_t>(0x44 | (k << 3)), 0x00, static_cast<std::uint8_t>(16 * k));
+            }
+
+            /* inc rdi ; dec rsi ; jnz loop */
+            emit(code, 0x48, 0xFF, 0xC7);
+            emit(code, 0x48, 0xFF, 0xCE);
+            emit(code, 0x0F, 0x85);
+            emit32(code, static_cast<std::uint32_t>(static_cast<std::int32_t>(loop - (code.size() + 4))));
+
+            patch32(code, done_fixup, static_cast<std::uint32_t>(code.size() - (done_fixup + 4)));
+
+            /* Spill the register below rsp (red zone), then write the parity top byte first */
+            for (std::size_t k = 0; k < n; ++k)
+            {
+               emit(code, 0xF3, 0x0F, 0x7F, static_cast<std::uint8_t>(0x44 | (k << 3)), 0x24);
+               emit(code, static_cast<std::uint8_t>(static_cast<std::int8_t>(16 * k) - static_cast<std::int8_t>(stride)));
+            }
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               emit(code, 0x0F, 0xB6, 0x44, 0x24, static_cast<std::uint8_t>(static_cast<std::int8_t>(-1 - static_cast<int>(i))));
+               emit(code, 0x88, 0x42, static_cast<std::uint8_t>(i));
+            }
+
+            emit(code, 0xC3);
+
+            const std::size_t table_offset = (code.size() + 63) & ~std::size_t(63);
+
+            patch32(code, rows_fixup, static_cast<std::uint32_t>(table_offset - (rows_fixup + 4)));
+         }
+
+         static inline void emit(std::vector<std::uint8_t>& code, const std::uint8_t b)
+         {
+            code.push_back(b);
+         }
+
+         template <typename... Bytes>
+         static inline void emit(std::vector<std::uint8_t>& code, const std::uint8_t b, const Bytes... bytes)
+         {
+            code.push_back(b);
+            emit(code, static_cast<std::uint8_t>(bytes)...);
+         }
+
+         static inline void emit32(std::vector<std::uint8_t>& code, const std::uint32_t value)
+         {
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+               code.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+         }
+
+         static inline void patch32(std::vector<std::uint8_t>& code, const std::size_t offset, const std::uint32_t value)
+         {
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+               code[offset + i] = static_cast<std::uint8_t>(value >> (8 * i));
+            }
+         }
+         #endif
+
+         kernel_t    kernel_;
+         void*       region_;
+         std::size_t region_size_;
+         std::size_t fec_length_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,445 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_MATRIX_ENCODER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_MATRIX_ENCODER_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/region_dispatch.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Systematic generator matrix encoder for the code of rs_codec (an
+         (n,k) code over field with fec_length = n - k generator roots from
+         alpha^fcr), for long codes where the shift register of rs_codec,
+         serial within a codeword, is the bottleneck.
+
+         Parity is linear in the data, column i of the fec_length x k
+         parity matrix being the parity of data symbol i alone, that is
+         x^(fec_length + k - 1 - i) mod g(x). Encoding a codeword is then
+
+            parity ^= data[i] * column(i)    for every nonzero data[i]
+
+         with no dependency between parity rows. The matrix is stored in
+         blocks of row_block rows, column after column within a block, so
+         that a range of blocks is one contiguous run of memory. The data
+         is taken in tiles of column_tile symbols, each tile run against
+         every block of the range while it is in L1.
+
+            fields of up to 8 bits : column(i) is kept as symbols and each
+                                     column of a block is one region
+                                     multiply-accumulate by data[i], through
+                                     the SIMD backend bound by the region
+                                     dispatcher.
+            fields of 9 to 16 bits : column(i) is kept as logarithms, each
+                                     column of a block being a loop of
+                                     antilog lookups of log data[i] + log
+                                     coefficient. The few zero coefficients
+                                     are stored as log 1 and their
+                                     contribution taken back afterwards.
+
+         Ranges of row blocks are independent: encode() may split them
+         across threads, or a caller may hand them out to its own workers
+         through encode_rows().
+
+         Note: The matrix holds fec_length x k symbols (bytes, or 16 bit
+               logarithms), eg: 80MB for RS(22000,20000) over GF(2^16),
+               and takes O(fec_length.k) multiplies to build. Codes over
+               more than 16 bits are invalid.
+      */
+      class matrix_encoder
+      {
+      public:
+
+         static const std::size_t row_block   = 256;
+         static const std::size_t column_tile = 256;
+
+         matrix_encoder(const galois::field& field,
+                        const std::size_t n,
+                        const std::size_t k,
+                        const unsigned int fcr = 0)
+         : field_(field),
+           code_length_(n),
+           data_length_(k),
+           fec_length_(n - k),
+           fcr_(fcr),
+           wide_(field.pwr() > 8),
+           valid_(false)
+         {
+            if ((k == 0) || (k >= n) || (n > field.size()) || (field.pwr() > 16))
+               return;
+
+            generator_cache::generator_ptr generator = shared_generator(field_, fcr_, fec_length_);
+
+            if (!generator)
+               return;
+
+            create_matrix(generator->coefficients());
+
+            valid_ = true;
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline std::size_t code_length() const { return code_length_; }
+         inline std::size_t data_length() const { return data_length_; }
+         inline std::size_t fec_length () const { return fec_length_;  }
+
+         /* Number of row blocks, the unit encode_rows() splits work in */
+         inline std::size_t row_blocks() const
+         {
+            return (fec_length_ + row_block - 1) / row_block;
+         }
+
+         /*
+            Write the fec_length parity symbols of data to parity, the same
+            as rs_codec::encode(), the row blocks being split across threads
+            (0 for one per hardware thread). data may be shorter than
+            data_length(), it is then a further shortened codeword.
+         */
+         template <typename DataT, typename ParityT>
+         bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity, std::size_t threads = 1) const
+         {
+            if (!valid_ || data.empty() || (data.size() > data_length_) || (parity.size() != fec_length_))
+               return false;
+
+            if (0 == threads)
+               threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+            threads = std::min(threads, row_blocks());
+
+            if (1 == threads)
+               return encode_rows(data, parity, 0, row_blocks());
+
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+
+            for (std::size_t t = 1; t < threads; ++t)
+            {
+               workers.push_back(std::thread([&, t]()
+                                 {
+                                    encode_rows(data, parity, (t * row_blocks()) / threads, ((t + 1) * row_blocks()) / threads);
+                                 }));
+            }
+
+            encode_rows(data, parity, 0, row_blocks() / threads);
+
+            for (std::size_t t = 0; t < workers.size(); ++t)
+            {
+               workers[t].join();
+            }
+
+            return true;
+         }
+
+         /*
+            Write parity symbols [first_block.row_block, last_block.row_block)
+            of data, clipped to fec_length, leaving the others untouched.
+            Disjoint ranges may run concurrently on the same parity.
+         */
+         template <typename DataT, typename ParityT>
+         bool encode_rows(const utils::span<DataT>& data,
+                          const utils::span<ParityT>& parity,
+                          const std::size_t first_block,
+                          const std::size_t last_block) const
+         {
+            if (!valid_ || data.empty() || (data.size() > data_length_) || (parity.size() != fec_length_) ||
+                (first_block > last_block) || (last_block > row_blocks()))
+               return false;
+
+            const std::size_t first_row = first_block * row_block;
+            const std::size_t last_row  = std::min(fec_length_, last_block * row_block);
+
+            if (first_row >= last_row)
+               return true;
+
+            workspace& ws = thread_workspace();
+
+            /* A shortened codeword starts at column data_length - size */
+            const std::size_t offset = data_length_ - data.size();
+
+            if (wide_)
+            {
+               ws.wide.assign(last_row - first_row, 0);
+
+               accumulate_wide(data.data(), data.size(), offset, first_block, last_block, ws);
+
+               for (std::size_t r = first_row; r < last_row; ++r)
+               {
+                  parity[r] = static_cast<ParityT>(ws.wide[r - first_row]);
+               }
+            }
+            else
+            {
+               ws.narrow.assign(last_row - first_row, 0);
+
+               accumulate_narrow(data.data(), data.size(), offset, first_block, last_block, ws);
+
+               for (std::size_t r = first_row; r < last_row; ++r)
+               {
+                  parity[r] = static_cast<ParityT>(ws.narrow[r - first_row]);
+               }
+            }
+
+            return true;
+         }
+
+      private:
+
+         matrix_encoder(const matrix_encoder&);
+         matrix_encoder& operator=(const matrix_encoder&);
+
+         struct workspace
+         {
+            std::vector<std::uint8_t>  narrow;
+            std::vector<std::uint16_t> wide;
+            std::vector<std::uint32_t> tile;
+         };
+
+         static inline workspace& thread_workspace()
+         {
+            static thread_local workspace ws;
+            return ws;
+         }
+
+         /* Coefficient (row r, column i) of a zero entry of the matrix */
+         struct zero_entry
+         {
+            std::size_t row;
+            std::size_t column;
+         };
+
+         inline std::size_t block_rows(const std::size_t b) const
+         {
+            return std::min(row_block, fec_length_ - b * row_block);
+         }
+
+         /* Start of column i of block b */
+         inline std::size_t column_offset(const std::size_t b, const std::size_t i) const
+         {
+            return b * row_block * data_length_ + i * block_rows(b);
+         }
+
+         void create_matrix(const std::vector<galois::field_symbol>& generator)
+         {
+            const galois::field_symbol mask = field_.mask();
+
+            if (wide_)
+            {
+               /* Antilogs over two periods, log a + log b needs no reduction */
+               const std::size_t period = field_.size();
+
+               antilog_.resize(2 * period);
+
+               for (std::size_t e = 0; e < antilog_.size(); ++e)
+               {
+                  antilog_[e] = static_cast<std::uint16_t>(field_.alpha(static_cast<galois::field_symbol>(e % period)));
+               }
+
+               log_matrix_.resize(fec_length_ * data_length_);
+            }
+            else
+            {
+               matrix_.resize(fec_length_ * data_length_);
+
+               multiplier_.resize(static_cast<std::size_t>(mask) + 1);
+
+               for (galois::field_symbol v = 0; v <= mask; ++v)
+               {
+                  multiplier_[v] = galois::region::make_multiplier(field_, v);
+               }
+            }
+
+            /*
+               reg holds x^(fec_length + j) mod g(x), reg[e] being the
+               coefficient of x^e, and is column data_length - 1 - j of the
+               matrix. Parity symbol r is the coefficient of
+               x^(fec_length - 1 - r), as in rs_codec::lfsr_encode().
+            */
+            std::vector<galois::field_symbol> feedback(fec_length_);
+
+            for (std::size_t e = 0; e < fec_length_; ++e)
+            {
+               feedback[e] = field_.div(generator[e], generator[fec_length_]);
+            }
+
+            std::vector<galois::field_symbol> reg(feedback);
+
+            for (std::size_t j = 0; j < data_length_; ++j)
+            {
+               if (j > 0)
+               {
+                  const galois::field_symbol top = reg[fec_length_ - 1];
+
+                  for (std::size_t e = fec_length_ - 1; e > 0; --e)
+                  {
+                     reg[e] = reg[e - 1] ^ field_.mul(top, feedback[e]);
+                  }
+
+                  reg[0] = field_.mul(top, feedback[0]);
+               }
+
+               const std::size_t column = data_length_ - 1 - j;
+
+               for (std::size_t r = 0; r < fec_length_; ++r)
+               {
+                  const galois::field_symbol c   = reg[fec_length_ - 1 - r];
+                  const std::size_t          pos = column_offset(r / row_block, column) + (r % row_block);
+
+                  if (!wide_)
+                     matrix_[pos] = static_cast<std::uint8_t>(c);
+                  else if (0 != c)
+                     log_matrix_[pos] = static_cast<std::uint16_t>(field_.index(c));
+                  else
+                  {
+                     log_matrix_[pos] = 0;
+
+                     zero_entry z = { r, column };
+                     zero_.push_back(z);
+                  }
+               }
+            }
+
+         }
+
+         template <typename DataT>
+         void accumulate_narrow(const DataT* data, const std::size_t length, const std::size_t offset,
+                                const std::size_t first_block, const std::size_t last_block,
+                                workspace& ws) const
+         {
+            const galois::field_symbol mask = field_.mask();
+
+            for (std::size_t t = 0; t < length; t += column_tile)
+            {
+               const std::size_t tile_end = std::min(length, t + column_tile);
+
+               for (std::size_t b = first_block; b < last_block; ++b)
+               {
+                  const std::size_t rows = block_rows(b);
+                  std::uint8_t*     acc  = &ws.narrow[(b - first_block) * row_block];
+
+                  for (std::size_t i = t; i < tile_end; ++i)
+                  {
+                     const galois::field_symbol d = static_cast<galois::field_symbol>(data[i]) & mask;
+
+                     if (0 != d)
+                     {
+                        galois::region::mul_add(multiplier_[d], &matrix_[column_offset(b, offset + i)], acc, rows);
+                     }
+                  }
+               }
+            }
+         }
+
+         template <typename DataT>
+         void accumulate_wide(const DataT* data, const std::size_t length, const std::size_t offset,
+                              const std::size_t first_block, const std::size_t last_block,
+                              workspace& ws) const
+         {
+            const galois::field_symbol mask = field_.mask();
+            const std::uint16_t*       antilog = &antilog_[0];
+
+            ws.tile.resize(column_tile);
+
+            for (std::size_t t = 0; t < length; t += column_tile)
+            {
+               const std::size_t tile_end = std::min(length, t + column_tile);
+
+               /* Positions of the tile's nonzero data symbols */
+               std::size_t count = 0;
+
+               for (std::size_t i = t; i < tile_end; ++i)
+               {
+                  if (0 != (static_cast<galois::field_symbol>(data[i]) & mask))
+                     ws.tile[count++] = static_cast<std::uint32_t>(i);
+               }
+
+               for (std::size_t b = first_block; b < last_block; ++b)
+               {
+                  const std::size_t rows = block_rows(b);
+                  std::uint16_t*    acc  = &ws.wide[(b - first_block) * row_block];
+
+                  for (std::size_t c = 0; c < count; ++c)
+                  {
+                     const std::size_t    i      = ws.tile[c];
+                     const std::uint16_t* column = &log_matrix_[column_offset(b, offset + i)];
+                     const std::uint16_t* base   = antilog + field_.index(static_cast<galois::field_symbol>(data[i]) & mask);
+
+                     for (std::size_t r = 0; r < rows; ++r)
+                     {
+                        acc[r] ^= base[column[r]];
+                     }
+                  }
+               }
+            }
+
+            /* Take back data[i] * 1 for the zero coefficients in range */
+            const std::size_t first_row = first_block * row_block;
+            const std::size_t last_row  = first_row + ws.wide.size();
+
+            for (std::size_t z = 0; z < zero_.size(); ++z)
+            {
+               if ((zero_[z].row < first_row) || (zero_[z].row >= last_row) || (zero_[z].column < offset))
+                  continue;
+
+               ws.wide[zero_[z].row - first_row] ^=
+                  static_cast<std::uint16_t>(static_cast<galois::field_symbol>(data[zero_[z].column - offset]) & mask);
+            }
+         }
+
+         const galois::field&                    field_;
+         const std::size_t                       code_length_;
+         const std::size_t                       data_length_;
+         const std::size_t                       fec_length_;
+         const unsigned int                      fcr_;
+         const bool                              wide_;
+         bool                                    valid_;
+         std::vector<std::uint8_t>               matrix_;
+         std::vector<galois::region::multiplier> multiplier_;
+         std::vector<std::uint16_t>              log_matrix_;
+         std::vector<std::uint16_t>              antilog_;
+         std::vector<zero_entry>                 zero_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,210 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_NUMA_REPLICAS_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_NUMA_REPLICAS_HPP
+
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "schifra/core/galois_field/element.hpp"
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/utils/schifra_cpu_topology.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         One copy of the field tables, generator, encoder and decoder per
+         NUMA node, so that threads on every socket look symbols up in
+         memory attached to it rather than in whatever node happened to
+         construct the original field. A node's replica is built on first
+         request by a thread running on that node (the caller itself when
+         it already is, otherwise a helper pinned there), so first-touch
+         page placement puts the tables local to it.
+
+         Encoder and decoder are const and keep their scratch space per
+         thread, so every thread of a node may share its replica.
+
+         Note: Without affinity support (non-Linux) or sysfs topology,
+               there is a single node and thus a single replica.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class numa_replicas
+      {
+      public:
+
+         typedef encoder<code_length,fec_length,data_length> encoder_type;
+         typedef decoder<code_length,fec_length,data_length> decoder_type;
+
+         struct replica
+         {
+            replica(const int                       numa_node,
+                    const galois::field&            source_field,
+                    const galois::field_polynomial& source_generator,
+                    const unsigned int              gen_initial_index)
+            : node(numa_node),
+              primitive_poly(primitive_polynomial(source_field)),
+              field(source_field.pwr(), source_field.prim_poly_degree(), &primitive_poly[0]),
+              generator(rebase(field, source_generator)),
+              encoder(field, generator),
+              decoder(field, gen_initial_index)
+            {}
+
+            const int                       node;
+            const std::vector<unsigned int> primitive_poly;
+            const galois::field             field;
+            const galois::field_polynomial  generator;
+            const encoder_type              encoder;
+            const decoder_type              decoder;
+
+         private:
+
+            replica(const replica&);
+            replica& operator=(const replica&);
+         };
+
+         numa_replicas(const galois::field&            field,
+                       const galois::field_polynomial& generator,
+                       const unsigned int              gen_initial_index,
+                       const utils::cpu_topology&      topology = utils::cpu_topology())
+         : field_(field),
+           generator_(generator),
+           gen_initial_index_(gen_initial_index),
+           topology_(topology),
+           replicas_(topology.node_count()),
+           built_(new std::once_flag[topology.node_count()])
+         {}
+
+         inline std::size_t node_count() const
+         {
+            return replicas_.size();
+         }
+
+         inline const utils::cpu_topology& topology() const
+         {
+            return topology_;
+         }
+
+         /* Replica of node, built on that node the first time it is asked for */
+         const replica& on_node(int node)
+         {
+            if ((node < 0) || (static_cast<std::size_t>(node) >= replicas_.size()))
+               node = 0;
+
+            std::call_once(built_[node], [this, node]() { build(node); });
+
+            return *replicas_[node];
+         }
+
+         /* Replica of the node the calling thread is running on */
+         inline const replica& local()
+         {
+            return on_node(topology_.node_of(utils::cpu_topology::current_cpu()));
+         }
+
+      private:
+
+         numa_replicas(const numa_replicas&);
+         numa_replicas& operator=(const numa_replicas&);
+
+         static inline std::vector<unsigned int> primitive_polynomial(const galois::field& gfield)
+         {
+            std::vector<unsigned int> terms(gfield.prim_poly_degree() + 1);
+
+            for (std::size_t i = 0; i < terms.size(); ++i)
+            {
+               terms[i] = gfield.prim_poly_term(static_cast<unsigned int>(i));
+            }
+
+            return terms;
+         }
+
+         /* Same coefficients, but over the replica's field */
+         static inline galois::field_polynomial rebase(const galois::field& gfield, const galois::field_polynomial& polynomial)
+         {
+            galois::field_polynomial result(gfield, static_cast<unsigned int>(polynomial.deg()));
+
+            for (int i = 0; i <= polynomial.deg(); ++i)
+            {
+               result[i] = galois::field_element(gfield, polynomial[i].poly());
+            }
+
+            return result;
+         }
+
+         void build(const int node)
+         {
+            const int cpu = topology_.first_cpu_of_node(node);
+
+            if ((cpu < 0) || (topology_.node_of(utils::cpu_topology::current_cpu()) == node))
+            {
+               replicas_[node].reset(new replica(node, field_, generator_, gen_initial_index_));
+               return;
+            }
+
+            std::exception_ptr error;
+
+            std::thread helper([&]()
+                               {
+                                  try
+                                  {
+                                     utils::cpu_topology::pin_current_thread(cpu);
+                                     replicas_[node].reset(new replica(node, field_, generator_, gen_initial_index_));
+                                  }
+                                  catch (...)
+                                  {
+                                     error = std::current_exception();
+                                  }
+                               });
+
+            helper.join();
+
+            if (error)
+               std::rethrow_exception(error);
+         }
+
+         const galois::field&                  field_;
+         const galois::field_polynomial        generator_;
+         const unsigned int                    gen_initial_index_;
+         const utils::cpu_topology             topology_;
+         std::vector<std::unique_ptr<replica> > replicas_;
+         std::unique_ptr<std::once_flag[]>     built_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
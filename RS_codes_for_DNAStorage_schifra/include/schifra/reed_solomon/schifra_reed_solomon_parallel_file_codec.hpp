@@ -0,0 +1,1044 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_PARALLEL_FILE_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_PARALLEL_FILE_CODEC_HPP
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_file_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_file_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_interleaving.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_tuning.hpp"
+#include "schifra/utils/schifra_memory_accounting.hpp"
+#include "schifra/utils/schifra_trace.hpp"
+#include "schifra/utils/schifra_aligned_allocator.hpp"
+#include "schifra/utils/schifra_ring_queue.hpp"
+#include "schifra/utils/schifra_io_backend.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+
+         /* Chunk buffers are aligned for the O_DIRECT modes of the backends */
+         typedef std::vector<unsigned char, utils::aligned_allocator<unsigned char, fileio::direct_io_alignment> > chunk_buffer;
+
+         struct file_chunk
+         {
+            std::size_t              index;
+            std::size_t              amount;
+            std::size_t              input_index;
+            std::size_t              output_index;
+            std::size_t              output_amount;
+            std::size_t              failures;
+            std::size_t              repaired;
+            chunk_buffer             input;
+            chunk_buffer             output;
+            std::vector<std::size_t> failed;
+         };
+
+         inline std::size_t pipeline_threads(const std::size_t threads)
+         {
+            if (threads > 0)
+               return threads;
+
+            const std::size_t hardware_threads = std::thread::hardware_concurrency();
+
+            return (hardware_threads > 0) ? hardware_threads : 1;
+         }
+
+         /*
+            The codewords per buffer_size chunk, rounded up so that both
+            its encoded and decoded sizes, and so every file offset but
+            the tail's, are multiples of the backend's alignment.
+         */
+         inline std::size_t pipeline_chunk_blocks(const std::size_t buffer_size,
+                                                  const std::size_t alignment,
+                                                  const std::size_t code_length,
+                                                  const std::size_t data_length)
+         {
+            const std::size_t chunk_blocks = std::max<std::size_t>(1, buffer_size / code_length);
+
+            const std::size_t multiple = std::lcm(alignment / std::gcd(code_length, alignment),
+                                                  alignment / std::gcd(data_length, alignment));
+
+            return ((chunk_blocks + multiple - 1) / multiple) * multiple;
+         }
+
+         /*
+            Run total_size bytes of the input of io through a three stage
+            pipeline: the calling thread reads chunk_size byte chunks,
+            threads workers run process(chunk) on them in any order, and a
+            writer thread hands them to report(chunk) and writes their
+            output in file order, holding early ones in a reorder buffer.
+            Each stage keeps up to io.depth() requests in flight. Chunks
+            are recycled through a pool of 2 * threads + io.depth(), so
+            reading stalls rather than running ahead of a slow worker or
+            writer and memory stays bounded. A chunk's output is its
+            output buffer, or its input buffer when output_size is zero.
+            Output is written one chunk after another from output_offset
+            on, or with in_place back where its input was read from, and a
+            chunk with no output is not written. A non-zero
+            bytes_per_second caps the rate at which reads are issued.
+            Returns false when any read or write failed.
+         */
+         template <typename FileIO, typename Process, typename Report>
+         inline bool run_file_pipeline(FileIO& io,
+                                       const std::size_t total_size,
+                                       const std::size_t chunk_size,
+                                       const std::size_t output_size,
+                                       const std::size_t threads,
+                                       const Process& process,
+                                       const Report& report,
+                                       const bool in_place = false,
+                                       const std::uint64_t bytes_per_second = 0,
+                                       const std::uint64_t output_offset = 0)
+         {
+            const std::size_t chunk_count = (total_size + chunk_size - 1) / chunk_size;
+            const std::size_t depth       = io.depth();
+
+            std::vector<file_chunk> chunks(std::min(2 * threads + depth, chunk_count));
+
+            utils::mpmc_ring<file_chunk*> free_chunks(chunks.size());
+            utils::mpmc_ring<file_chunk*> work       (chunks.size());
+            utils::mpmc_ring<file_chunk*> done       (chunks.size());
+
+            std::vector<unsigned char*> buffers;
+            std::vector<std::size_t>    sizes;
+
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+            {
+               chunks[i].input .resize(chunk_size );
+               chunks[i].output.resize(output_size);
+
+               chunks[i].input_index = buffers.size();
+               buffers.push_back(&chunks[i].input[0]);
+               sizes  .push_back(chunk_size);
+
+               chunks[i].output_index = chunks[i].input_index;
+
+               if (output_size > 0)
+               {
+                  chunks[i].output_index = buffers.size();
+                  buffers.push_back(&chunks[i].output[0]);
+                  sizes  .push_back(output_size);
+               }
+
+               free_chunks.push(&chunks[i]);
+            }
+
+            const utils::memory::charge chunk_memory(utils::memory::e_pipeline_queues,
+                                                     std::accumulate(sizes.begin(), sizes.end(), std::size_t(0)));
+
+            io.register_buffers(buffers, sizes);
+
+            bool read_success  = true;
+            bool write_success = true;
+
+            std::vector<std::thread> workers;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+               workers.push_back(std::thread([&]()
+                                 {
+                                    utils::trace::set_thread_name("pipeline worker");
+
+                                    file_chunk* chunk = 0;
+
+                                    for ( ; ; )
+                                    {
+                                       {
+                                          utils::trace::scope wait(utils::trace::e_queue_wait, "wait for work");
+
+                                          if (!work.pop(chunk))
+                                             break;
+                                       }
+
+                                       {
+                                          utils::trace::scope codec(utils::trace::e_codec, "process chunk", static_cast<std::int64_t>(chunk->amount));
+                                          process(*chunk);
+                                       }
+
+                                       done.push(chunk);
+                                    }
+                                 }));
+            }
+
+            std::thread writer([&]()
+                               {
+                                  utils::trace::set_thread_name("pipeline writer");
+
+                                  std::map<std::size_t,file_chunk*> pending;
+                                  std::size_t next      = 0;
+                                  std::size_t written   = 0;
+                                  std::size_t in_flight = 0;
+                                  std::uint64_t offset  = output_offset;
+
+                                  while (written < chunk_count)
+                                  {
+                                     while ((in_flight < depth) && !pending.empty() && (pending.begin()->first == next))
+                                     {
+                                        file_chunk* chunk = pending.begin()->second;
+
+                                        pending.erase(pending.begin());
+                                        ++next;
+
+                                        report(*chunk);
+
+                                        if (0 == chunk->output_amount)
+                                        {
+                                           free_chunks.push(chunk);
+                                           ++written;
+                                           continue;
+                                        }
+
+                                        const unsigned char* data = (output_size > 0) ? &chunk->output[0] : &chunk->input[0];
+
+                                        const std::uint64_t write_offset = in_place ? static_cast<std::uint64_t>(chunk->index) * chunk_size : offset;
+
+                                        utils::trace::scope submit(utils::trace::e_writer, "submit write", static_cast<std::int64_t>(chunk->output_amount));
+
+                                        if (!io.submit_write(data, chunk->output_amount, write_offset, chunk->output_index, chunk))
+                                        {
+                                           write_success = false;
+                                           free_chunks.push(chunk);
+                                           ++written;
+                                        }
+                                        else
+                                           ++in_flight;
+
+                                        offset += chunk->output_amount;
+                                     }
+
+                                     if (written == chunk_count)
+                                        break;
+
+                                     file_chunk* chunk = 0;
+
+                                     if ((in_flight > 0) && ((in_flight == depth) || !done.try_pop(chunk)))
+                                     {
+                                        void* tag = 0;
+
+                                        {
+                                           utils::trace::scope wait(utils::trace::e_writer, "wait write");
+
+                                           if (!io.wait_write(tag))
+                                              write_success = false;
+                                        }
+
+                                        if (0 == tag)
+                                           break;
+
+                                        free_chunks.push(static_cast<file_chunk*>(tag));
+                                        --in_flight;
+                                        ++written;
+                                        continue;
+                                     }
+
+                                     if (0 == chunk)
+                                     {
+                                        utils::trace::scope wait(utils::trace::e_queue_wait, "wait for processed chunk");
+
+                                        if (!done.pop(chunk))
+                                           break;
+                                     }
+
+                                     pending[chunk->index] = chunk;
+                                  }
+                               });
+
+            std::size_t submitted = 0;
+            std::size_t in_flight = 0;
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            /*
+               Note: The reader only blocks for a free chunk when it has no
+                     reads in flight, the writer may be waiting on one of
+                     them before it can release any chunk.
+            */
+            for (std::size_t completed = 0; completed < chunk_count; )
+            {
+               file_chunk* chunk = 0;
+
+               if ((submitted < chunk_count) && (in_flight < depth))
+               {
+                  if (0 == in_flight)
+                  {
+                     utils::trace::scope wait(utils::trace::e_queue_wait, "wait for free chunk");
+                     free_chunks.pop(chunk);
+                  }
+                  else
+                     free_chunks.try_pop(chunk);
+               }
+
+               if (0 != chunk)
+               {
+                  chunk->index  = submitted;
+                  chunk->amount = std::min(chunk_size, total_size - submitted * chunk_size);
+
+                  if (bytes_per_second > 0)
+                  {
+                     const double due = static_cast<double>(submitted * chunk_size) / static_cast<double>(bytes_per_second);
+
+                     std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(due)));
+                  }
+
+                  ++submitted;
+
+                  utils::trace::scope submit(utils::trace::e_reader, "submit read", static_cast<std::int64_t>(chunk->amount));
+
+                  if (io.submit_read(&chunk->input[0], chunk->amount, (chunk->index * chunk_size), chunk->input_index, chunk))
+                     ++in_flight;
+                  else
+                  {
+                     read_success = false;
+                     work.push(chunk);
+                     ++completed;
+                  }
+
+                  continue;
+               }
+
+               void* tag = 0;
+
+               {
+                  utils::trace::scope wait(utils::trace::e_reader, "wait read");
+
+                  if (!io.wait_read(tag))
+                     read_success = false;
+               }
+
+               if (0 == tag)
+                  break;
+
+               work.push(static_cast<file_chunk*>(tag));
+               --in_flight;
+               ++completed;
+            }
+
+            work.close();
+
+            for (std::size_t t = 0; t < workers.size(); ++t)
+            {
+               workers[t].join();
+            }
+
+            done.close();
+            writer.join();
+
+            return read_success && write_success;
+         }
+
+         /*
+            (De)interleave the amount bytes at input, whole stacks of
+            stack_size rows of block_length bytes but for a last short one,
+            to output, as dynamic_file_(de)interleaver does stack by stack.
+         */
+         inline void transpose_stacks(const unsigned char* input,
+                                      unsigned char* output,
+                                      const std::size_t amount,
+                                      const std::size_t block_length,
+                                      const std::size_t stack_size,
+                                      const bool deinterleave)
+         {
+            const std::size_t stack_length = block_length * stack_size;
+
+            for (std::size_t offset = 0; offset < amount; offset += stack_length)
+            {
+               const std::size_t stack_amount = std::min(stack_length, amount - offset);
+               const std::size_t row_count    = (stack_amount + block_length - 1) / block_length;
+               const std::size_t partial      = stack_amount - ((row_count - 1) * block_length);
+
+               if (deinterleave)
+                  deinterleave_stack(input + offset, output + offset, block_length, row_count, partial);
+               else
+                  interleave_stack(input + offset, output + offset, block_length, row_count, partial);
+            }
+         }
+
+         /*
+            dynamic_file_(de)interleaver over the pipeline: chunks of whole
+            stacks, about buffer_size bytes each, are read and written
+            sequentially while the workers transpose their stacks.
+         */
+         template <typename FileIO>
+         inline bool run_stack_pipeline(FileIO& io,
+                                        const std::string& input_file_name,
+                                        const std::string& output_file_name,
+                                        const std::size_t block_length,
+                                        const std::size_t stack_size,
+                                        const std::size_t threads,
+                                        const std::size_t buffer_size,
+                                        const bool deinterleave)
+         {
+            const char* const name = deinterleave ? "reed_solomon::parallel_file_deinterleaver()" : "reed_solomon::parallel_file_interleaver()";
+
+            if ((0 == block_length) || (0 == stack_size))
+            {
+               std::cout << name << " - Error: invalid stack dimensions." << std::endl;
+               return false;
+            }
+
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+
+            if (0 == input_size)
+            {
+               std::cout << name << " - Error: input file has ZERO size." << std::endl;
+               return false;
+            }
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << name << " - Error: files could not be opened." << std::endl;
+               io.close();
+               return false;
+            }
+
+            const std::size_t stack_length = block_length * stack_size;
+            const std::size_t chunk_size   = stack_length * pipeline_chunk_blocks(buffer_size, io.alignment(), stack_length, stack_length);
+
+            const bool success = run_file_pipeline(io,
+                                       input_size,
+                                       chunk_size,
+                                       chunk_size,
+                                       pipeline_threads(threads),
+                                       [&](file_chunk& chunk)
+                                       {
+                                          transpose_stacks(&chunk.input[0], &chunk.output[0], chunk.amount, block_length, stack_size, deinterleave);
+
+                                          chunk.output_amount = chunk.amount;
+                                       },
+                                       [](const file_chunk&) {});
+
+            if (!success)
+            {
+               std::cout << name << " - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            return success;
+         }
+
+      } // namespace details
+
+      /*
+         file_encoder spread over threads worker threads (0 for the count
+         of the code's tuned profile, see tuning, or one per hardware
+         thread). Each worker encodes whole buffer_size chunks (0 for the
+         tuned size, or default_buffer_size) with
+         file_encoder::encode_buffer(), and the output is byte for byte
+         that of file_encoder. FileIO is the I/O backend, eg:
+         fileio::uring_file_io to keep several reads and writes in flight
+         on Linux, a configured instance can be passed in.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class parallel_file_encoder
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+         parallel_file_encoder(const encoder_type& encoder,
+                               const std::string& input_file_name,
+                               const std::string& output_file_name,
+                               const std::size_t threads = 0,
+                               const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            FileIO io;
+            run(encoder, io, input_file_name, output_file_name, threads, buffer_size);
+         }
+
+         parallel_file_encoder(const encoder_type& encoder,
+                               FileIO& io,
+                               const std::string& input_file_name,
+                               const std::string& output_file_name,
+                               const std::size_t threads = 0,
+                               const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            run(encoder, io, input_file_name, output_file_name, threads, buffer_size);
+         }
+
+         /* The file was read, encoded and written without error */
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         inline void run(const encoder_type& encoder,
+                         FileIO& io,
+                         const std::string& input_file_name,
+                         const std::string& output_file_name,
+                         const std::size_t threads,
+                         const std::size_t buffer_size)
+         {
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+            if (input_size == 0)
+            {
+               std::cout << "reed_solomon::parallel_file_encoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << "reed_solomon::parallel_file_encoder() - Error: files could not be opened." << std::endl;
+               io.close();
+               return;
+            }
+
+            const std::size_t chunk_blocks = details::pipeline_chunk_blocks(tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size), io.alignment(), code_length, data_length);
+
+            /* Note: Only touched by the writer, which calls report() */
+            std::size_t failures = 0;
+
+            const bool success = details::run_file_pipeline(io,
+                                       input_size,
+                                       chunk_blocks * data_length,
+                                       chunk_blocks * code_length,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          chunk.failures = 0;
+
+                                          chunk.output_amount = file_encoder_type::encode_buffer(encoder,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.amount,
+                                                                                                 &chunk.output[0],
+                                                                                                 chunk.failures);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          failures += chunk.failures;
+
+                                          for (std::size_t i = 0; i < chunk.failures; ++i)
+                                          {
+                                             std::cout << "reed_solomon::parallel_file_encoder() - Error during encoding of block!" << std::endl;
+                                          }
+                                       });
+
+            if (!success)
+            {
+               std::cout << "reed_solomon::parallel_file_encoder() - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            success_ = success && (0 == failures);
+         }
+
+         bool success_;
+      };
+
+      /*
+         file_decoder spread over threads worker threads, 0 threads or
+         buffer_size being taken as for parallel_file_encoder. Decoding
+         cost varies with the error count of each chunk, so chunks may
+         finish out of order, but the output and the error reports come
+         out in file order, as file_decoder produces them. FileIO is the I/O backend, as for parallel_file_encoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class parallel_file_decoder
+      {
+      public:
+
+         typedef file_decoder<code_length,fec_length,data_length,symbol_t> file_decoder_type;
+         typedef typename file_decoder_type::decoder_type decoder_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+         parallel_file_decoder(const decoder_type& decoder,
+                               const std::string& input_file_name,
+                               const std::string& output_file_name,
+                               const std::size_t threads = 0,
+                               const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            FileIO io;
+            run(decoder, io, input_file_name, output_file_name, threads, buffer_size);
+         }
+
+         parallel_file_decoder(const decoder_type& decoder,
+                               FileIO& io,
+                               const std::string& input_file_name,
+                               const std::string& output_file_name,
+                               const std::size_t threads = 0,
+                               const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            run(decoder, io, input_file_name, output_file_name, threads, buffer_size);
+         }
+
+         /* The file was read, decoded and written without error */
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         inline void run(const decoder_type& decoder,
+                         FileIO& io,
+                         const std::string& input_file_name,
+                         const std::string& output_file_name,
+                         const std::size_t threads,
+                         const std::size_t buffer_size)
+         {
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+            if (input_size == 0)
+            {
+               std::cout << "reed_solomon::parallel_file_decoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << "reed_solomon::parallel_file_decoder() - Error: files could not be opened." << std::endl;
+               io.close();
+               return;
+            }
+
+            const std::size_t chunk_blocks = details::pipeline_chunk_blocks(tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size), io.alignment(), code_length, data_length);
+
+            /* Note: Only touched by the writer, which calls report() */
+            std::size_t failures = 0;
+
+            /* Note: Chunks are decoded in place, their output buffer is unused */
+            const bool success = details::run_file_pipeline(io,
+                                       input_size,
+                                       chunk_blocks * code_length,
+                                       0,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          chunk.failed.clear();
+
+                                          chunk.output_amount = file_decoder_type::decode_buffer(decoder,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.amount,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.index * chunk_blocks,
+                                                                                                 chunk.failed);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          failures += chunk.failed.size();
+
+                                          for (std::size_t i = 0; i < chunk.failed.size(); ++i)
+                                          {
+                                             std::cout << "reed_solomon::parallel_file_decoder() - Error during decoding of block " << chunk.failed[i] << "!" << std::endl;
+                                          }
+                                       });
+
+            if (!success)
+            {
+               std::cout << "reed_solomon::parallel_file_decoder() - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            success_ = success && (0 == failures);
+         }
+
+         bool success_;
+      };
+
+      /*
+         dynamic_file_interleaver and dynamic_file_deinterleaver over the
+         pipeline of parallel_file_encoder: whole stacks, about
+         buffer_size bytes of them per chunk (0 for default_buffer_size),
+         are read and written in large sequential requests and transposed
+         by threads workers (0 for one per hardware thread) with the tiled
+         interleave_stack() kernel. The output is byte for byte that of
+         the serial forms.
+      */
+      template <typename FileIO = fileio::stream_file_io>
+      class parallel_file_interleaver
+      {
+      public:
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
+         parallel_file_interleaver(const std::string& input_file_name,
+                                   const std::string& output_file_name,
+                                   const std::size_t block_length,
+                                   const std::size_t stack_size,
+                                   const std::size_t threads = 0,
+                                   const std::size_t buffer_size = 0)
+         {
+            FileIO io;
+            success_ = details::run_stack_pipeline(io, input_file_name, output_file_name, block_length, stack_size,
+                                                   threads, (buffer_size > 0) ? buffer_size : default_buffer_size, false);
+         }
+
+         parallel_file_interleaver(FileIO& io,
+                                   const std::string& input_file_name,
+                                   const std::string& output_file_name,
+                                   const std::size_t block_length,
+                                   const std::size_t stack_size,
+                                   const std::size_t threads = 0,
+                                   const std::size_t buffer_size = 0)
+         {
+            success_ = details::run_stack_pipeline(io, input_file_name, output_file_name, block_length, stack_size,
+                                                   threads, (buffer_size > 0) ? buffer_size : default_buffer_size, false);
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         bool success_;
+      };
+
+      template <typename FileIO = fileio::stream_file_io>
+      class parallel_file_deinterleaver
+      {
+      public:
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
+         parallel_file_deinterleaver(const std::string& input_file_name,
+                                     const std::string& output_file_name,
+                                     const std::size_t block_length,
+                                     const std::size_t stack_size,
+                                     const std::size_t threads = 0,
+                                     const std::size_t buffer_size = 0)
+         {
+            FileIO io;
+            success_ = details::run_stack_pipeline(io, input_file_name, output_file_name, block_length, stack_size,
+                                                   threads, (buffer_size > 0) ? buffer_size : default_buffer_size, true);
+         }
+
+         parallel_file_deinterleaver(FileIO& io,
+                                     const std::string& input_file_name,
+                                     const std::string& output_file_name,
+                                     const std::size_t block_length,
+                                     const std::size_t stack_size,
+                                     const std::size_t threads = 0,
+                                     const std::size_t buffer_size = 0)
+         {
+            success_ = details::run_stack_pipeline(io, input_file_name, output_file_name, block_length, stack_size,
+                                                   threads, (buffer_size > 0) ? buffer_size : default_buffer_size, true);
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         bool success_;
+      };
+
+      /*
+         file_interleaved_encoder over the pipeline: each worker encodes
+         the stacks of a chunk with file_encoder::encode_buffer() into a
+         scratch buffer of its own and interleaves them into the chunk's
+         output. Chunks hold whole stacks of stack_size codewords, and
+         threads and buffer_size are taken as for parallel_file_encoder.
+         The output is byte for byte that of file_interleaved_encoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class parallel_file_interleaved_encoder
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
+         parallel_file_interleaved_encoder(const encoder_type& encoder,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const std::size_t stack_size,
+                                           const std::size_t threads = 0,
+                                           const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            FileIO io;
+            run(encoder, io, input_file_name, output_file_name, stack_size, threads, buffer_size);
+         }
+
+         parallel_file_interleaved_encoder(const encoder_type& encoder,
+                                           FileIO& io,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const std::size_t stack_size,
+                                           const std::size_t threads = 0,
+                                           const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            run(encoder, io, input_file_name, output_file_name, stack_size, threads, buffer_size);
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         inline void run(const encoder_type& encoder,
+                         FileIO& io,
+                         const std::string& input_file_name,
+                         const std::string& output_file_name,
+                         const std::size_t stack_size,
+                         const std::size_t threads,
+                         const std::size_t buffer_size)
+         {
+            if (0 == stack_size)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_encoder() - Error: invalid stack size." << std::endl;
+               return;
+            }
+
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+
+            if (0 == input_size)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_encoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_encoder() - Error: files could not be opened." << std::endl;
+               io.close();
+               return;
+            }
+
+            const std::size_t chunk_stacks = details::pipeline_chunk_blocks(tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size),
+                                                                            io.alignment(), stack_size * code_length, stack_size * data_length);
+
+            const std::size_t output_size = chunk_stacks * stack_size * code_length;
+
+            /* Note: Only touched by the writer, which calls report() */
+            std::size_t failures = 0;
+
+            const bool success = details::run_file_pipeline(io,
+                                       input_size,
+                                       chunk_stacks * stack_size * data_length,
+                                       output_size,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          static thread_local details::chunk_buffer encoded;
+
+                                          encoded.resize(output_size);
+
+                                          chunk.failures = 0;
+
+                                          chunk.output_amount = file_encoder_type::encode_buffer(encoder,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.amount,
+                                                                                                 &encoded[0],
+                                                                                                 chunk.failures);
+
+                                          details::transpose_stacks(&encoded[0], &chunk.output[0], chunk.output_amount, code_length, stack_size, false);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          failures += chunk.failures;
+
+                                          for (std::size_t i = 0; i < chunk.failures; ++i)
+                                          {
+                                             std::cout << "reed_solomon::parallel_file_interleaved_encoder() - Error during encoding of block!" << std::endl;
+                                          }
+                                       });
+
+            if (!success)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_encoder() - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            success_ = success && (0 == failures);
+         }
+
+         bool success_;
+      };
+
+      /*
+         file_interleaved_decoder over the pipeline, the inverse of
+         parallel_file_interleaved_encoder: each worker deinterleaves the
+         stacks of a chunk into its output buffer and decodes them there
+         in place with file_decoder::decode_buffer(). The output and the
+         error reports come out in file order, as for file_decoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol, typename FileIO = fileio::stream_file_io>
+      class parallel_file_interleaved_decoder
+      {
+      public:
+
+         typedef file_decoder<code_length,fec_length,data_length,symbol_t> file_decoder_type;
+         typedef typename file_decoder_type::decoder_type decoder_type;
+
+         static constexpr std::size_t default_buffer_size = 4 * 1024 * 1024;
+
+         parallel_file_interleaved_decoder(const decoder_type& decoder,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const std::size_t stack_size,
+                                           const std::size_t threads = 0,
+                                           const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            FileIO io;
+            run(decoder, io, input_file_name, output_file_name, stack_size, threads, buffer_size);
+         }
+
+         parallel_file_interleaved_decoder(const decoder_type& decoder,
+                                           FileIO& io,
+                                           const std::string& input_file_name,
+                                           const std::string& output_file_name,
+                                           const std::size_t stack_size,
+                                           const std::size_t threads = 0,
+                                           const std::size_t buffer_size = 0)
+         : success_(false)
+         {
+            run(decoder, io, input_file_name, output_file_name, stack_size, threads, buffer_size);
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+      private:
+
+         inline void run(const decoder_type& decoder,
+                         FileIO& io,
+                         const std::string& input_file_name,
+                         const std::string& output_file_name,
+                         const std::size_t stack_size,
+                         const std::size_t threads,
+                         const std::size_t buffer_size)
+         {
+            if (0 == stack_size)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_decoder() - Error: invalid stack size." << std::endl;
+               return;
+            }
+
+            const std::size_t input_size = schifra::fileio::file_size(input_file_name);
+
+            if (0 == input_size)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_decoder() - Error: input file has ZERO size." << std::endl;
+               return;
+            }
+
+            if (!io.open(input_file_name, output_file_name))
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_decoder() - Error: files could not be opened." << std::endl;
+               io.close();
+               return;
+            }
+
+            const std::size_t chunk_stacks = details::pipeline_chunk_blocks(tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size),
+                                                                            io.alignment(), stack_size * code_length, stack_size * data_length);
+
+            const std::size_t chunk_size = chunk_stacks * stack_size * code_length;
+
+            /* Note: Only touched by the writer, which calls report() */
+            std::size_t failures = 0;
+
+            const bool success = details::run_file_pipeline(io,
+                                       input_size,
+                                       chunk_size,
+                                       chunk_size,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          details::transpose_stacks(&chunk.input[0], &chunk.output[0], chunk.amount, code_length, stack_size, true);
+
+                                          chunk.failed.clear();
+
+                                          chunk.output_amount = file_decoder_type::decode_buffer(decoder,
+                                                                                                 &chunk.output[0],
+                                                                                                 chunk.amount,
+                                                                                                 &chunk.output[0],
+                                                                                                 chunk.index * chunk_stacks * stack_size,
+                                                                                                 chunk.failed);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          failures += chunk.failed.size();
+
+                                          for (std::size_t i = 0; i < chunk.failed.size(); ++i)
+                                          {
+                                             std::cout << "reed_solomon::parallel_file_interleaved_decoder() - Error during decoding of block " << chunk.failed[i] << "!" << std::endl;
+                                          }
+                                       });
+
+            if (!success)
+            {
+               std::cout << "reed_solomon::parallel_file_interleaved_decoder() - Error: file read or write failed." << std::endl;
+            }
+
+            io.close();
+
+            success_ = success && (0 == failures);
+         }
+
+         bool success_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
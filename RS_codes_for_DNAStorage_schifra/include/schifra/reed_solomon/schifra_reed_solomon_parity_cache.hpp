@@ -0,0 +1,429 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_PARITY_CACHE_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_PARITY_CACHE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Bounded LRU cache of the parity of data blocks, for inputs that
+         repeat whole blocks (reference genomes, padding, repeated
+         headers): a hit copies the parity of an earlier identical block
+         instead of encoding it again.
+
+         Blocks are data_length bytes, one symbol per byte, and their
+         parity fec_length bytes. An entry is keyed by a 64 bit hash of the
+         block but keeps the block itself, so a hash collision is a miss,
+         never wrong parity.
+
+         Every thread using the cache gets its own shard of up to
+         capacity entries, created on its first lookup, so lookups and
+         inserts take no lock and share no cache line; the price is that
+         a block encoded by one thread is not a hit for another. The
+         statistics sum every shard. Memory is bounded by capacity entries
+         per thread that has used the cache, held until it is destroyed.
+      */
+      class parity_cache
+      {
+      public:
+
+         struct statistics
+         {
+            statistics()
+            : hits(0),
+              misses(0),
+              insertions(0),
+              evictions(0),
+              entries(0),
+              shards(0)
+            {}
+
+            inline double hit_rate() const
+            {
+               return (0 == (hits + misses)) ? 0.0 : static_cast<double>(hits) / (hits + misses);
+            }
+
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t insertions;
+            std::uint64_t evictions;
+            std::size_t   entries;
+            std::size_t   shards;
+         };
+
+         parity_cache(const std::size_t data_length,
+                      const std::size_t fec_length,
+                      const std::size_t capacity)
+         : data_length_(data_length),
+           fec_length_(fec_length),
+           capacity_(std::max<std::size_t>(capacity, 1)),
+           id_(next_id())
+         {}
+
+         inline std::size_t data_length() const { return data_length_; }
+         inline std::size_t fec_length () const { return fec_length_;  }
+         inline std::size_t capacity   () const { return capacity_;    }
+
+         /* Copies the cached parity of data into parity, true on a hit */
+         inline bool lookup(const unsigned char* data, unsigned char* parity)
+         {
+            return local().lookup(hash(data, data_length_), data, parity);
+         }
+
+         /* Caches the parity of data, evicting the least recently used entry when full */
+         inline void insert(const unsigned char* data, const unsigned char* parity)
+         {
+            local().insert(hash(data, data_length_), data, parity);
+         }
+
+         /*
+            Totals over every shard.
+            Note: Counts of a thread still encoding may be a few blocks behind.
+         */
+         inline statistics stats() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            statistics s;
+
+            for (std::size_t i = 0; i < shards_.size(); ++i)
+            {
+               shards_[i]->collect(s);
+            }
+
+            s.shards = shards_.size();
+
+            return s;
+         }
+
+         /* Note: No thread may use the cache meanwhile */
+         inline void clear()
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (std::size_t i = 0; i < shards_.size(); ++i)
+            {
+               shards_[i]->clear();
+            }
+         }
+
+         /* 64 bit hash of length bytes, a multiply-xorshift per 8 byte word */
+         static inline std::uint64_t hash(const unsigned char* data, std::size_t length)
+         {
+            std::uint64_t h = 0x9E3779B97F4A7C15ULL ^ length;
+
+            for (; length >= 8; data += 8, length -= 8)
+            {
+               std::uint64_t w;
+               std::memcpy(&w, data, 8);
+               h = mix(h ^ w);
+            }
+
+            if (length > 0)
+            {
+               std::uint64_t w = 0;
+               std::memcpy(&w, data, length);
+               h = mix(h ^ w);
+            }
+
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 33;
+
+            return h;
+         }
+
+      private:
+
+         parity_cache(const parity_cache&);
+         parity_cache& operator=(const parity_cache&);
+
+         static inline std::uint64_t mix(std::uint64_t x)
+         {
+            x *= 0xBF58476D1CE4E5B9ULL;
+            return x ^ (x >> 29);
+         }
+
+         static inline std::uint64_t next_id()
+         {
+            static std::atomic<std::uint64_t> id(0);
+            return id.fetch_add(1, std::memory_order_relaxed) + 1;
+         }
+
+         /*
+            The entries of one thread: a doubly linked LRU list over a
+            fixed array of entries, indexed by an open addressing table of
+            twice the capacity. Only the owning thread writes the counters,
+            as relaxed load and store pairs, so stats() may read them.
+         */
+         class shard
+         {
+         public:
+
+            shard(const std::size_t data_length, const std::size_t fec_length, const std::size_t capacity)
+            : data_length_(data_length),
+              entry_length_(data_length + fec_length),
+              capacity_(capacity),
+              hash_(capacity, 0),
+              symbols_(capacity * (data_length + fec_length)),
+              prev_(capacity, none),
+              next_(capacity, none)
+            {
+               std::size_t slots = 1;
+
+               while (slots < (2 * capacity))
+               {
+                  slots <<= 1;
+               }
+
+               index_.assign(slots, 0);
+               mask_ = slots - 1;
+
+               clear();
+            }
+
+            inline bool lookup(const std::uint64_t h, const unsigned char* data, unsigned char* parity)
+            {
+               const std::size_t slot = find(h, data);
+
+               if (npos == slot)
+               {
+                  add(misses_, 1);
+                  return false;
+               }
+
+               const std::uint32_t e = index_[slot] - 1;
+
+               std::memcpy(parity, &symbols_[e * entry_length_ + data_length_], entry_length_ - data_length_);
+
+               touch(e);
+               add(hits_, 1);
+
+               return true;
+            }
+
+            inline void insert(const std::uint64_t h, const unsigned char* data, const unsigned char* parity)
+            {
+               if (npos != find(h, data))
+                  return;
+
+               std::uint32_t e;
+
+               if (size_ < capacity_)
+               {
+                  e = static_cast<std::uint32_t>(size_++);
+               }
+               else
+               {
+                  e = tail_;
+                  erase_index(e);
+                  unlink(e);
+                  add(evictions_, 1);
+               }
+
+               hash_[e] = h;
+               std::memcpy(&symbols_[e * entry_length_], data, data_length_);
+               std::memcpy(&symbols_[e * entry_length_ + data_length_], parity, entry_length_ - data_length_);
+
+               std::size_t slot = h & mask_;
+
+               while (0 != index_[slot])
+               {
+                  slot = (slot + 1) & mask_;
+               }
+
+               index_[slot] = e + 1;
+
+               push_front(e);
+               add(insertions_, 1);
+            }
+
+            inline void collect(statistics& s) const
+            {
+               s.hits       += hits_      .load(std::memory_order_relaxed);
+               s.misses     += misses_    .load(std::memory_order_relaxed);
+               s.insertions += insertions_.load(std::memory_order_relaxed);
+               s.evictions  += evictions_ .load(std::memory_order_relaxed);
+               s.entries    += size_;
+            }
+
+            inline void clear()
+            {
+               std::fill(index_.begin(), index_.end(), 0);
+
+               head_ = none;
+               tail_ = none;
+               size_ = 0;
+
+               hits_      .store(0, std::memory_order_relaxed);
+               misses_    .store(0, std::memory_order_relaxed);
+               insertions_.store(0, std::memory_order_relaxed);
+               evictions_ .store(0, std::memory_order_relaxed);
+            }
+
+         private:
+
+            static constexpr std::uint32_t none = 0xFFFFFFFF;
+            static constexpr std::size_t   npos = static_cast<std::size_t>(-1);
+
+            static inline void add(std::atomic<std::uint64_t>& counter, const std::uint64_t amount)
+            {
+               counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            /* Slot of the index holding data, npos when not cached */
+            inline std::size_t find(const std::uint64_t h, const unsigned char* data) const
+            {
+               for (std::size_t slot = h & mask_; 0 != index_[slot]; slot = (slot + 1) & mask_)
+               {
+                  const std::uint32_t e = index_[slot] - 1;
+
+                  if ((hash_[e] == h) && (0 == std::memcmp(&symbols_[e * entry_length_], data, data_length_)))
+                     return slot;
+               }
+
+               return npos;
+            }
+
+            /* Backward shift deletion, which keeps every probe sequence unbroken */
+            inline void erase_index(const std::uint32_t e)
+            {
+               std::size_t hole = hash_[e] & mask_;
+
+               while (index_[hole] != (e + 1))
+               {
+                  hole = (hole + 1) & mask_;
+               }
+
+               for (std::size_t slot = (hole + 1) & mask_; 0 != index_[slot]; slot = (slot + 1) & mask_)
+               {
+                  const std::size_t home = hash_[index_[slot] - 1] & mask_;
+
+                  if (((slot - home) & mask_) >= ((slot - hole) & mask_))
+                  {
+                     index_[hole] = index_[slot];
+                     hole = slot;
+                  }
+               }
+
+               index_[hole] = 0;
+            }
+
+            inline void unlink(const std::uint32_t e)
+            {
+               if (none != prev_[e]) next_[prev_[e]] = next_[e]; else head_ = next_[e];
+               if (none != next_[e]) prev_[next_[e]] = prev_[e]; else tail_ = prev_[e];
+            }
+
+            inline void push_front(const std::uint32_t e)
+            {
+               prev_[e] = none;
+               next_[e] = head_;
+
+               if (none != head_)
+                  prev_[head_] = e;
+               else
+                  tail_ = e;
+
+               head_ = e;
+            }
+
+            inline void touch(const std::uint32_t e)
+            {
+               if (head_ != e)
+               {
+                  unlink(e);
+                  push_front(e);
+               }
+            }
+
+            const std::size_t          data_length_;
+            const std::size_t          entry_length_;
+            const std::size_t          capacity_;
+            std::vector<std::uint64_t> hash_;
+            std::vector<unsigned char> symbols_;   /* entry_length_ per entry, data then parity */
+            std::vector<std::uint32_t> prev_;
+            std::vector<std::uint32_t> next_;
+            std::vector<std::uint32_t> index_;     /* entry + 1, 0 for an empty slot            */
+            std::size_t                mask_;
+            std::uint32_t              head_;      /* most recently used                        */
+            std::uint32_t              tail_;      /* least recently used                       */
+            std::size_t                size_;
+
+            std::atomic<std::uint64_t> hits_;
+            std::atomic<std::uint64_t> misses_;
+            std::atomic<std::uint64_t> insertions_;
+            std::atomic<std::uint64_t> evictions_;
+         };
+
+         /*
+            The calling thread's shard. Threads find theirs by the cache's
+            id rather than its address, which a later cache may reuse.
+         */
+         inline shard& local()
+         {
+            static thread_local std::vector<std::pair<std::uint64_t, shard*> > shards;
+
+            for (std::size_t i = 0; i < shards.size(); ++i)
+            {
+               if (shards[i].first == id_)
+                  return *shards[i].second;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            shards_.push_back(std::unique_ptr<shard>(new shard(data_length_, fec_length_, capacity_)));
+            shards.push_back(std::make_pair(id_, shards_.back().get()));
+
+            return *shards_.back();
+         }
+
+         const std::size_t                   data_length_;
+         const std::size_t                   fec_length_;
+         const std::size_t                   capacity_;
+         const std::uint64_t                 id_;
+         mutable std::mutex                  mutex_;
+         std::vector<std::unique_ptr<shard> > shards_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,553 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_RATE_CONTROLLER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_RATE_CONTROLLER_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_instrumentation.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_rs_codec.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Picks the code rate and interleave depth of the batches to come
+         from the errors the decoder saw in the batches before: the least
+         parity whose predicted block failure rate stays under a target,
+         rather than the parity of the worst channel everywhere.
+
+         Every observe() adds one batch of decoder telemetry, the errors
+         per block histogram, the uncorrectable blocks and, when known, the
+         per position heatmap (dna_storage::process_stats, or a snapshot of
+         the decoder instrumentation). From these the controller estimates
+         the symbol error rate of every codeword position and predicts, for
+         r kept parity symbols, the rate of blocks with more than r / 2
+         errors as the larger of:
+
+           - the tail of independent errors at the observed rate of every
+             stored position (a Poisson binomial distribution), and
+           - the observed histogram itself, which holds the bursts the
+             independent model underestimates. At interleave depth d a
+             block of k errors counts as ceil(k / d) errors; uncorrectable
+             blocks, whose error count is unknown, get no such credit.
+
+         A rate is applied through one of two engines:
+
+           e_puncture       - one mother code of fec_length parity symbols,
+                              of which the fec_length - r the heatmap shows
+                              noisiest are punctured, see puncture_mask
+           e_reparameterise - an rs_codec of (code_length, code_length - r),
+                              the freed symbols carrying data
+
+         update() moves the current decision with hysteresis: to more
+         parity as soon as the current rate is predicted over target, to
+         less only once the lower rate is predicted under
+         target * hysteresis, and not at all before min_blocks blocks have
+         been observed. A memory below one ages past batches at every
+         observe(), so that the estimate follows a drifting channel.
+
+         Note: The histogram and heatmap must count errors only. Punctured
+               positions, filled in by the decoder as erasures, are skipped
+               in the heatmap but would inflate the histogram.
+      */
+      class rate_controller
+      {
+      public:
+
+         enum engine_t
+         {
+            e_puncture       = 0,
+            e_reparameterise = 1
+         };
+
+         struct policy
+         {
+            policy(const std::size_t n = 0, const std::size_t fec = 0)
+            : code_length(n),
+              fec_length(fec),
+              target_failure_rate(1.0e-6),
+              min_kept_parity(0),
+              max_interleave_depth(1),
+              hysteresis(0.5),
+              memory(1.0),
+              min_blocks(1000),
+              engine(e_puncture)
+            {}
+
+            std::size_t code_length;
+            std::size_t fec_length;            /* parity of the mother code, the most a rate keeps */
+            double      target_failure_rate;   /* per block                                        */
+            std::size_t min_kept_parity;
+            std::size_t max_interleave_depth;  /* 1 never interleaves                              */
+            double      hysteresis;            /* in (0,1]                                         */
+            double      memory;                /* weight of the past at every observe(), in [0,1]  */
+            std::size_t min_blocks;
+            engine_t    engine;
+         };
+
+         struct decision
+         {
+            std::size_t   kept_parity;
+            std::size_t   interleave_depth;
+            double        predicted_failure_rate;
+            puncture_mask puncture;   /* over fec_length, nothing punctured with e_reparameterise */
+         };
+
+         explicit rate_controller(const policy& p)
+         : policy_(p),
+           blocks_(0.0),
+           histogram_(p.fec_length + 1, 0.0),
+           uncorrectable_(p.fec_length / 2 + 1, 0.0),
+           errors_(p.code_length, 0.0),
+           exposure_(p.code_length, 0.0)
+         {
+            policy_.min_kept_parity      = std::min(policy_.min_kept_parity, policy_.fec_length);
+            policy_.max_interleave_depth = std::max<std::size_t>(policy_.max_interleave_depth, 1);
+
+            current_.kept_parity            = policy_.fec_length;
+            current_.interleave_depth       = 1;
+            current_.predicted_failure_rate = 0.0;
+            current_.puncture               = puncture_mask(policy_.fec_length);
+         }
+
+         inline const policy& settings() const
+         {
+            return policy_;
+         }
+
+         inline const decision& current() const
+         {
+            return current_;
+         }
+
+         /* Blocks observed, aged by memory */
+         inline double blocks() const
+         {
+            return blocks_;
+         }
+
+         /* Data symbols per codeword at the current rate */
+         inline std::size_t data_length() const
+         {
+            return policy_.code_length - ((e_puncture == policy_.engine) ? policy_.fec_length : current_.kept_parity);
+         }
+
+         /* Symbols stored per codeword at the current rate */
+         inline std::size_t stored_length() const
+         {
+            return stored_length(current_);
+         }
+
+         /*
+            The codec of the current rate: the mother code with e_puncture,
+            to be used with current().puncture, otherwise the code of
+            current().kept_parity parity symbols. Null when the current
+            rate keeps no parity.
+         */
+         inline std::unique_ptr<rs_codec> create_codec(const galois::field& field, const unsigned int fcr = 0) const
+         {
+            const std::size_t k = data_length();
+
+            if (k >= policy_.code_length)
+               return std::unique_ptr<rs_codec>();
+
+            return std::unique_ptr<rs_codec>(new rs_codec(field, policy_.code_length, k, fcr));
+         }
+
+         /*
+            One batch decoded at the current rate: errors_per_block[k]
+            blocks corrected k errors (k of histogram_size - 1 or more share
+            the last bucket), uncorrectable blocks failed, and when not null
+            error_positions[i] errors were corrected at codeword position i,
+            for the code_length positions.
+         */
+         template <typename T>
+         inline void observe(const T* errors_per_block,
+                             const std::size_t histogram_size,
+                             const std::uint64_t uncorrectable,
+                             const T* error_positions = 0)
+         {
+            age();
+
+            const std::size_t capacity = current_.kept_parity / 2;
+            const std::size_t stored   = stored_length(current_);
+
+            double corrected_blocks = 0.0;
+            double corrected_errors = 0.0;
+
+            for (std::size_t k = 0; k < histogram_size; ++k)
+            {
+               const double count = static_cast<double>(errors_per_block[k]);
+
+               histogram_[std::min(k, policy_.fec_length)] += count;
+               corrected_blocks += count;
+               corrected_errors += count * k;
+            }
+
+            uncorrectable_[capacity] += static_cast<double>(uncorrectable);
+
+            const double batch = corrected_blocks + static_cast<double>(uncorrectable);
+
+            blocks_ += batch;
+
+            /*
+               Uncorrectable blocks had at least capacity + 1 errors, and
+               without a heatmap the corrected ones are spread evenly too.
+            */
+            const double spread = ((static_cast<double>(uncorrectable) * (capacity + 1)) +
+                                   (error_positions ? 0.0 : corrected_errors)) / std::max<std::size_t>(stored, 1);
+
+            for (std::size_t i = 0; i < policy_.code_length; ++i)
+            {
+               if (!is_stored(current_, i))
+                  continue;
+
+               exposure_[i] += batch;
+               errors_  [i] += spread + (error_positions ? static_cast<double>(error_positions[i]) : 0.0);
+            }
+         }
+
+         /*
+            A snapshot of the decoder instrumentation holding one batch, eg:
+            instrumentation::totals() after an instrumentation::reset().
+            It has no heatmap.
+         */
+         inline void observe(const instrumentation::snapshot& s)
+         {
+            std::uint64_t histogram[instrumentation::max_tracked_corrections + 1];
+            std::uint64_t uncorrectable = 0;
+
+            std::copy(s.corrected, s.corrected + instrumentation::max_tracked_corrections + 1, histogram);
+
+            histogram[0] += s.clean;
+
+            for (std::size_t i = 0; i < instrumentation::error_kind_count; ++i)
+            {
+               uncorrectable += s.unrecoverable[i];
+            }
+
+            observe<std::uint64_t>(histogram, instrumentation::max_tracked_corrections + 1, uncorrectable);
+         }
+
+         /* dna_storage::process_stats, or anything with the same histogram and heatmap */
+         template <typename Stats>
+         inline void observe_stats(const Stats& stats)
+         {
+            observe(stats.errors_per_block.data(),
+                    stats.errors_per_block.size(),
+                    stats.uncorrectable_blocks,
+                    (stats.error_positions.size() == policy_.code_length) ? stats.error_positions.data() : 0);
+         }
+
+         /* The least redundancy predicted under the target failure rate */
+         inline decision recommend() const
+         {
+            return select(policy_.target_failure_rate);
+         }
+
+         /* Predicted failure rate of kept_parity parity symbols at interleave depth */
+         inline double predict(const std::size_t kept_parity, const std::size_t interleave_depth = 1) const
+         {
+            std::vector<double> rate;
+            position_rates(rate);
+
+            return failure_rate(candidate(std::min(kept_parity, policy_.fec_length), rate),
+                                std::max<std::size_t>(interleave_depth, 1), rate);
+         }
+
+         /* Moves to the recommended rate, with hysteresis. True when the decision changed. */
+         inline bool update()
+         {
+            if (blocks_ < static_cast<double>(policy_.min_blocks))
+               return false;
+
+            const decision raise = select(policy_.target_failure_rate);
+
+            if (
+                 (raise.kept_parity > current_.kept_parity) ||
+                 (
+                   (raise.kept_parity      == current_.kept_parity     ) &&
+                   (raise.interleave_depth >  current_.interleave_depth)
+                 )
+               )
+            {
+               current_ = raise;
+               return true;
+            }
+
+            const decision lower = select(policy_.target_failure_rate * policy_.hysteresis);
+
+            if (
+                 (lower.kept_parity < current_.kept_parity) ||
+                 (
+                   (lower.kept_parity      == current_.kept_parity     ) &&
+                   (lower.interleave_depth <  current_.interleave_depth)
+                 )
+               )
+            {
+               current_ = lower;
+               return true;
+            }
+
+            std::vector<double> rate;
+            position_rates(rate);
+
+            current_.predicted_failure_rate = failure_rate(current_, current_.interleave_depth, rate);
+
+            return false;
+         }
+
+         /* Forgets every observation, the current decision is kept */
+         inline void reset()
+         {
+            blocks_ = 0.0;
+            std::fill(histogram_    .begin(), histogram_    .end(), 0.0);
+            std::fill(uncorrectable_.begin(), uncorrectable_.end(), 0.0);
+            std::fill(errors_       .begin(), errors_       .end(), 0.0);
+            std::fill(exposure_     .begin(), exposure_     .end(), 0.0);
+         }
+
+      private:
+
+         inline std::size_t parity_start() const
+         {
+            return policy_.code_length - policy_.fec_length;
+         }
+
+         inline bool is_stored(const decision& d, const std::size_t position) const
+         {
+            if ((e_reparameterise == policy_.engine) || (position < parity_start()))
+               return true;
+
+            return !d.puncture.punctured(position - parity_start());
+         }
+
+         inline std::size_t stored_length(const decision& d) const
+         {
+            return (e_puncture == policy_.engine) ? d.puncture.stored_length(policy_.code_length) : policy_.code_length;
+         }
+
+         inline void age()
+         {
+            if (policy_.memory >= 1.0)
+               return;
+
+            const double w = std::max(policy_.memory, 0.0);
+
+            blocks_ *= w;
+
+            for (std::size_t i = 0; i < histogram_    .size(); ++i) histogram_    [i] *= w;
+            for (std::size_t i = 0; i < uncorrectable_.size(); ++i) uncorrectable_[i] *= w;
+            for (std::size_t i = 0; i < errors_       .size(); ++i) errors_       [i] *= w;
+            for (std::size_t i = 0; i < exposure_     .size(); ++i) exposure_     [i] *= w;
+         }
+
+         /*
+            Error rate of every position. Each position starts with one
+            error spread over the codeword, so that a clean channel is not
+            taken as error free, and a position never stored as no better
+            than average.
+         */
+         inline void position_rates(std::vector<double>& rate) const
+         {
+            const double prior = 1.0 / std::max<std::size_t>(policy_.code_length, 1);
+
+            rate.resize(policy_.code_length);
+
+            for (std::size_t i = 0; i < policy_.code_length; ++i)
+            {
+               rate[i] = std::min(1.0, (errors_[i] + prior) / (exposure_[i] + 1.0));
+            }
+         }
+
+         /* kept_parity parity symbols, the noisiest others punctured */
+         inline decision candidate(const std::size_t kept_parity, const std::vector<double>& rate) const
+         {
+            decision d;
+
+            d.kept_parity            = kept_parity;
+            d.interleave_depth       = 1;
+            d.predicted_failure_rate = 0.0;
+            d.puncture               = puncture_mask(policy_.fec_length);
+
+            if (e_reparameterise == policy_.engine)
+               return d;
+
+            std::vector<std::size_t> order(policy_.fec_length);
+
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+               order[i] = i;
+            }
+
+            const std::size_t start = parity_start();
+
+            std::stable_sort(order.begin(), order.end(),
+                             [&](const std::size_t a, const std::size_t b)
+                             {
+                                return (rate[start + a] != rate[start + b]) ? (rate[start + a] > rate[start + b]) : (a > b);
+                             });
+
+            for (std::size_t i = 0; i < policy_.fec_length - kept_parity; ++i)
+            {
+               d.puncture.puncture(order[i]);
+            }
+
+            return d;
+         }
+
+         /*
+            tail[t]: probability of more than t errors in the stored
+            positions of d, errors independent at the given rates. The
+            distribution is only kept up to fec_length / 2 + 1 errors and
+            the tails are summed from the top, so that rates far below
+            machine epsilon keep their precision.
+         */
+         inline void model_tail(const decision& d, const std::vector<double>& rate, std::vector<double>& tail) const
+         {
+            const std::size_t top = policy_.fec_length / 2 + 1;
+
+            std::vector<double> p(top + 1, 0.0);
+
+            p[0] = 1.0;
+
+            for (std::size_t i = 0; i < policy_.code_length; ++i)
+            {
+               if (!is_stored(d, i))
+                  continue;
+
+               const double e = rate[i];
+
+               p[top] += p[top - 1] * e;
+
+               for (std::size_t j = top - 1; j > 0; --j)
+               {
+                  p[j] = (p[j] * (1.0 - e)) + (p[j - 1] * e);
+               }
+
+               p[0] *= (1.0 - e);
+            }
+
+            tail.assign(top, 0.0);
+
+            double sum = p[top];
+
+            for (std::size_t t = top; t-- > 0;)
+            {
+               tail[t] = sum;
+               sum += p[t];
+            }
+         }
+
+         inline double failure_rate(const decision& d, const std::size_t depth, const std::vector<double>& rate) const
+         {
+            std::vector<double> tail;
+            model_tail(d, rate, tail);
+
+            const std::size_t capacity = d.kept_parity / 2;
+
+            if (blocks_ <= 0.0)
+               return tail[capacity];
+
+            double failed = 0.0;
+
+            for (std::size_t k = 0; k < histogram_.size(); ++k)
+            {
+               if (((k + depth - 1) / depth) > capacity)
+                  failed += histogram_[k];
+            }
+
+            /*
+               Blocks that failed at capacity s had more than s errors:
+               they fail again at any capacity up to s, and beyond it in
+               the proportion the model gives.
+            */
+            for (std::size_t s = 0; s < uncorrectable_.size(); ++s)
+            {
+               if (uncorrectable_[s] <= 0.0)
+                  continue;
+               else if (capacity <= s)
+                  failed += uncorrectable_[s];
+               else if (tail[s] > 0.0)
+                  failed += uncorrectable_[s] * (tail[capacity] / tail[s]);
+            }
+
+            return std::max(tail[capacity], failed / blocks_);
+         }
+
+         inline decision select(const double threshold) const
+         {
+            std::vector<double> rate;
+            position_rates(rate);
+
+            decision best;
+
+            for (std::size_t kept = policy_.min_kept_parity; kept <= policy_.fec_length; ++kept)
+            {
+               decision d = candidate(kept, rate);
+
+               best = d;
+               best.predicted_failure_rate = 2.0;
+
+               for (std::size_t depth = 1; depth <= policy_.max_interleave_depth; ++depth)
+               {
+                  d.interleave_depth       = depth;
+                  d.predicted_failure_rate = failure_rate(d, depth, rate);
+
+                  if (d.predicted_failure_rate <= threshold)
+                     return d;
+                  else if (d.predicted_failure_rate < best.predicted_failure_rate)
+                     best = d;
+               }
+            }
+
+            /* Nothing meets the target: all the parity, at the shallowest of the best depths */
+            return best;
+         }
+
+         policy              policy_;
+         decision            current_;
+         double              blocks_;
+         std::vector<double> histogram_;       /* [k]: correctable blocks with k errors          */
+         std::vector<double> uncorrectable_;   /* [s]: blocks uncorrectable at capacity s        */
+         std::vector<double> errors_;          /* [i]: errors seen at codeword position i        */
+         std::vector<double> exposure_;        /* [i]: blocks in which position i was stored     */
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
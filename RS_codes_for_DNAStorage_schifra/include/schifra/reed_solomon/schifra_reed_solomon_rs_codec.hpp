@@ -0,0 +1,614 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_RS_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_RS_CODEC_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/polynomial_kernels.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_generator_cache.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_jit.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Reed-Solomon codec whose parameters are only known at run time:
+         an (n,k) code over field, n at most the field size, with the
+         fec_length = n - k roots of the generator starting at alpha^fcr,
+         the same code as encoder<field size, n - k> and decoder with
+         gen_initial_index fcr, shortened to n. Codewords are laid out as
+         in block::data, data first then parity in block::fec(i) order.
+
+         Byte codewords of the common codes (see specializations below)
+         go through the precompiled encoder and decoder, every other code
+         and symbol type through flat array kernels: a table driven LFSR
+         encoder and a syndrome, Berlekamp-Massey, Chien search and Forney
+         decoder working on log/antilog lookups. Where it can, the other
+         byte codes of fields of up to 8 bits get an LFSR kernel generated
+         for them at construction (see jit_lfsr), encoding and computing
+         the syndromes of their codewords.
+      */
+      class rs_codec
+      {
+      public:
+
+         rs_codec(const galois::field& field,
+                  const std::size_t n,
+                  const std::size_t k,
+                  const unsigned int fcr = 0)
+         : field_(field),
+           code_length_(n),
+           data_length_(k),
+           fec_length_(n - k),
+           fcr_(fcr),
+           valid_(false),
+           lfsr_rows_(0),
+           special_encoder_(0),
+           special_decoder_(0),
+           special_encode_(0),
+           special_decode_(0),
+           special_destroy_(0)
+         {
+            if ((k == 0) || (k >= n) || (n > field.size()))
+               return;
+
+            cached_generator_ = shared_generator(field_, fcr_, fec_length_);
+
+            if (!cached_generator_)
+               return;
+
+            generator_ = cached_generator_->coefficients();
+
+            /*
+               Note: Feedback rows as in encoder::create_lfsr_table(),
+                     shared through the generator cache, for fields of up
+                     to 8 bits. Larger fields multiply through the log
+                     tables.
+            */
+            if ((field_.size() <= 0xFF) && !cached_generator_->lfsr_rows().empty())
+            {
+               lfsr_rows_ = &cached_generator_->lfsr_rows()[0];
+            }
+
+            root_.resize(fec_length_);
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               root_[i] = field_.alpha(static_cast<galois::field_symbol>((fcr_ + i) % field_.size()));
+            }
+
+            create_specialization();
+
+            if (!specialized())
+            {
+               create_jit();
+            }
+
+            valid_ = true;
+         }
+
+        ~rs_codec()
+         {
+            if (special_destroy_)
+            {
+               special_destroy_(special_encoder_, special_decoder_);
+            }
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline const galois::field& field() const { return field_;       }
+         inline std::size_t code_length()    const { return code_length_; }
+         inline std::size_t data_length()    const { return data_length_; }
+         inline std::size_t fec_length()     const { return fec_length_;  }
+         inline unsigned int fcr()           const { return fcr_;         }
+
+         /* True when byte codewords go through a precompiled codec */
+         inline bool specialized() const
+         {
+            return (0 != special_encode_);
+         }
+
+         /* True when byte codewords go through a generated LFSR kernel */
+         inline bool jit() const
+         {
+            return static_cast<bool>(jit_);
+         }
+
+         /*
+            Write the fec_length parity symbols of data to parity. data may
+            be shorter than data_length(), it is then a further shortened
+            codeword.
+         */
+         template <typename DataT, typename ParityT>
+         bool encode(const utils::span<DataT>& data, const utils::span<ParityT>& parity) const
+         {
+            if (!valid_ || data.empty() || (data.size() > data_length_) || (parity.size() != fec_length_))
+               return false;
+
+            if constexpr (std::is_same<typename std::remove_const<DataT>::type, std::uint8_t>::value &&
+                          std::is_same<ParityT, std::uint8_t>::value)
+            {
+               if (special_encode_)
+                  return special_encode_(special_encoder_, data.data(), data.size(), parity.data());
+
+               if (jit_)
+               {
+                  (*jit_)(data.data(), data.size(), parity.data());
+                  return true;
+               }
+            }
+
+            lfsr_encode(data.data(), data.size(), parity.data());
+
+            return true;
+         }
+
+         /*
+            Correct a codeword of at most code_length() symbols in place,
+            the erasure positions being relative to it. Returns false when
+            it is unrecoverable, in which case it is left untouched.
+         */
+         template <typename T>
+         bool decode(const utils::span<T>& codeword, const erasure_locations_t& erasures = erasure_locations_t()) const
+         {
+            if (!valid_ || (codeword.size() > code_length_) || (codeword.size() <= fec_length_) || (erasures.size() > fec_length_))
+               return false;
+
+            if constexpr (std::is_same<T, std::uint8_t>::value)
+            {
+               if (special_decode_)
+                  return special_decode_(special_decoder_, codeword.data(), codeword.size(), erasures);
+            }
+
+            return decode_symbols(codeword.data(), codeword.size(), erasures);
+         }
+
+      private:
+
+         rs_codec(const rs_codec&);
+         rs_codec& operator=(const rs_codec&);
+
+         typedef bool (*special_encode_t )(const void*, const std::uint8_t*, const std::size_t, std::uint8_t*);
+         typedef bool (*special_decode_t )(const void*, std::uint8_t*, const std::size_t, const erasure_locations_t&);
+         typedef void (*special_destroy_t)(const void*, const void*);
+
+         /*
+            Precompiled codec of the natural code of length field_size with
+            fec_length parity symbols, of which the run time code is a
+            shortened version.
+         */
+         template <std::size_t field_size, std::size_t fec_length>
+         struct specialization
+         {
+            typedef reed_solomon::encoder<field_size,fec_length> encoder_type;
+            typedef reed_solomon::decoder<field_size,fec_length> decoder_type;
+
+            static bool encode(const void* encoder, const std::uint8_t* data, const std::size_t length, std::uint8_t* parity)
+            {
+               return static_cast<const encoder_type*>(encoder)->encode(utils::span<const std::uint8_t>(data, length),
+                                                                       utils::span<std::uint8_t>(parity, fec_length));
+            }
+
+            static bool decode(const void* decoder, std::uint8_t* codeword, const std::size_t length, const erasure_locations_t& erasures)
+            {
+               return static_cast<const decoder_type*>(decoder)->decode(utils::span<std::uint8_t>(codeword, length), erasures);
+            }
+
+            static void destroy(const void* encoder, const void* decoder)
+            {
+               delete static_cast<const encoder_type*>(encoder);
+               delete static_cast<const decoder_type*>(decoder);
+            }
+         };
+
+         template <std::size_t field_size, std::size_t fec_length>
+         inline bool try_specialization()
+         {
+            if ((field_.size() != field_size) || (fec_length_ != fec_length))
+               return false;
+
+            typedef specialization<field_size,fec_length> special_type;
+
+            special_encoder_ = new typename special_type::encoder_type(field_, cached_generator_);
+            special_decoder_ = new typename special_type::decoder_type(field_, fcr_);
+            special_encode_  = &special_type::encode;
+            special_decode_  = &special_type::decode;
+            special_destroy_ = &special_type::destroy;
+
+            return true;
+         }
+
+         /*
+            Note: The byte sized codes in common use: RS(15,k) for DNA bases
+                  and the usual RS(255,k) rates. Any other code is handled
+                  by the flat kernels, no template is instantiated for it.
+         */
+         void create_specialization()
+         {
+            try_specialization< 15,  2>() ||
+            try_specialization< 15,  4>() ||
+            try_specialization<255,  2>() ||
+            try_specialization<255,  4>() ||
+            try_specialization<255,  8>() ||
+            try_specialization<255, 16>() ||
+            try_specialization<255, 32>();
+         }
+
+         /*
+            Note: jit_scale_[i] = root_i^-fec_length, the remainder of
+                  c(x).x^fec_length at root_i being the syndrome scaled
+                  by root_i^fec_length.
+         */
+         void create_jit()
+         {
+            jit_.reset(new jit_lfsr(field_, generator_));
+
+            if (!jit_->valid())
+            {
+               jit_.reset();
+               return;
+            }
+
+            jit_scale_.resize(fec_length_);
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               jit_scale_[i] = inverse_locator((fcr_ + i) * fec_length_);
+            }
+         }
+
+         template <typename DataT, typename ParityT>
+         void lfsr_encode(const DataT* data, const std::size_t length, ParityT* parity) const
+         {
+            const galois::field_symbol mask = field_.mask();
+
+            std::vector<galois::field_symbol>& reg = thread_workspace().lfsr;
+
+            reg.assign(fec_length_ + 1, 0);
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               const galois::field_symbol v = (static_cast<galois::field_symbol>(data[i]) & mask) ^ reg[fec_length_];
+
+               if (0 != lfsr_rows_)
+               {
+                  const galois::field_symbol* row = lfsr_rows_ + (v * fec_length_);
+
+                  for (std::size_t j = fec_length_; j > 0; --j)
+                  {
+                     reg[j] = reg[j - 1] ^ row[j - 1];
+                  }
+               }
+               else
+               {
+                  const galois::field_symbol feedback = field_.div(v, generator_[fec_length_]);
+
+                  for (std::size_t j = fec_length_; j > 0; --j)
+                  {
+                     reg[j] = reg[j - 1] ^ field_.mul(feedback, generator_[j - 1]);
+                  }
+               }
+
+               reg[0] = 0;
+            }
+
+            for (std::size_t i = 0; i < fec_length_; ++i)
+            {
+               parity[i] = static_cast<ParityT>(reg[fec_length_ - i]);
+            }
+         }
+
+         /* alpha^(-degree) */
+         inline galois::field_symbol inverse_locator(const std::size_t degree) const
+         {
+            return field_.alpha(static_cast<galois::field_symbol>((field_.size() - (degree % field_.size())) % field_.size()));
+         }
+
+         /*
+            Position p of a codeword of length symbols stands for x^(length
+            - 1 - p), the syndromes are the codeword at alpha^(fcr + i).
+         */
+         template <typename T>
+         bool decode_symbols(T* codeword, const std::size_t length, const erasure_locations_t& erasures) const
+         {
+            workspace& ws = thread_workspace();
+
+            const galois::field_symbol mask = field_.mask();
+
+            std::vector<galois::field_symbol>& syndrome = ws.syndrome;
+
+            syndrome.assign(fec_length_, 0);
+
+            bool clean = true;
+
+            bool remainder_syndromes = false;
+
+            if constexpr (std::is_same<T, std::uint8_t>::value)
+            {
+               if (jit_)
+               {
+                  /*
+                     r(x) = c(x).x^fec_length mod g(x), zero for a codeword,
+                     else the syndromes are r(root_i).root_i^-fec_length:
+                     a pass over the codeword rather than one per root.
+                  */
+                  std::uint8_t remainder[jit_lfsr::max_fec_length];
+
+                  (*jit_)(codeword, length, remainder);
+
+                  for (std::size_t j = 0; j < fec_length_; ++j)
+                  {
+                     clean &= (0 == remainder[j]);
+                  }
+
+                  if (clean)
+                     return true;
+
+                  for (std::size_t i = 0; i < fec_length_; ++i)
+                  {
+                     galois::field_symbol s = 0;
+
+                     for (std::size_t j = 0; j < fec_length_; ++j)
+                     {
+                        s = field_.mul(s, root_[i]) ^ remainder[j];
+                     }
+
+                     syndrome[i] = field_.mul(s, jit_scale_[i]);
+                  }
+
+                  remainder_syndromes = true;
+               }
+            }
+
+            if (!remainder_syndromes)
+            {
+               /*
+                  Horner's rule at every root at once, one batch multiply
+                  per symbol: the fec_length products are independent,
+                  where a root at a time is a chain of dependent lookups.
+               */
+               for (std::size_t p = 0; p < length; ++p)
+               {
+                  field_.mul_batch(syndrome.data(), root_.data(), syndrome.data(), fec_length_);
+
+                  const galois::field_symbol symbol = static_cast<galois::field_symbol>(codeword[p]) & mask;
+
+                  for (std::size_t i = 0; i < fec_length_; ++i)
+                  {
+                     syndrome[i] ^= symbol;
+                  }
+               }
+
+               for (std::size_t i = 0; i < fec_length_; ++i)
+               {
+                  clean &= (0 == syndrome[i]);
+               }
+            }
+
+            if (clean)
+               return true;
+
+            /* Erasure locator, the Berlekamp-Massey starting point */
+            std::vector<galois::field_symbol>& lambda = ws.lambda;
+            std::vector<galois::field_symbol>& prior  = ws.prior;
+            std::vector<galois::field_symbol>& temp   = ws.temp;
+
+            lambda.assign(fec_length_ + 1, 0);
+            lambda[0] = 1;
+
+            for (std::size_t e = 0; e < erasures.size(); ++e)
+            {
+               if (erasures[e] >= length)
+                  return false;
+
+               const galois::field_symbol x = field_.alpha(static_cast<galois::field_symbol>((length - 1 - erasures[e]) % field_.size()));
+
+               for (std::size_t j = e + 1; j > 0; --j)
+               {
+                  lambda[j] ^= field_.mul(lambda[j - 1], x);
+               }
+            }
+
+            prior = lambda;
+
+            std::size_t order = erasures.size();
+
+            for (std::size_t r = erasures.size(); r < fec_length_; ++r)
+            {
+               galois::field_symbol discrepancy = 0;
+
+               for (std::size_t j = 0; j <= std::min(order, r); ++j)
+               {
+                  discrepancy ^= field_.mul(lambda[j], syndrome[r - j]);
+               }
+
+               /* prior <- x.prior */
+               for (std::size_t j = fec_length_; j > 0; --j)
+               {
+                  prior[j] = prior[j - 1];
+               }
+
+               prior[0] = 0;
+
+               if (0 == discrepancy)
+                  continue;
+
+               temp = lambda;
+
+               galois::poly_scale_add(field_, prior.data(), fec_length_ + 1, discrepancy, temp.data());
+
+               if ((2 * order) <= (r + erasures.size()))
+               {
+                  order = r + 1 + erasures.size() - order;
+
+                  galois::poly_scale(field_, lambda.data(), fec_length_ + 1, field_.inverse(discrepancy), prior.data());
+               }
+
+               lambda.swap(temp);
+            }
+
+            std::size_t degree = fec_length_;
+
+            while ((degree > 0) && (0 == lambda[degree]))
+            {
+               --degree;
+            }
+
+            if ((degree != order) || ((2 * degree) > (fec_length_ + erasures.size())))
+               return false;
+
+            /*
+               Chien search over the positions the codeword holds, their
+               inverse locators alpha^-(length - 1 - p) rising by alpha:
+               lambda at each of them, then the scratch of the search.
+            */
+            std::vector<std::size_t>& location = ws.location;
+
+            std::vector<galois::field_symbol>& chien = ws.chien;
+
+            chien.resize(length + 2 * (degree + 1));
+
+            galois::poly_eval_geometric(field_, lambda.data(), degree + 1,
+                                        inverse_locator(length - 1), field_.alpha(1), length,
+                                        chien.data() + length, chien.data() + length + degree + 1, chien.data());
+
+            location.clear();
+
+            for (std::size_t p = 0; p < length; ++p)
+            {
+               if (0 == chien[p])
+                  location.push_back(p);
+            }
+
+            if (location.size() != degree)
+               return false;
+
+            /* Error evaluator omega = syndrome.lambda mod x^fec_length */
+            std::vector<galois::field_symbol>& omega = ws.omega;
+
+            omega.resize(fec_length_);
+
+            galois::poly_mul(field_, syndrome.data(), fec_length_, lambda.data(), degree + 1, omega.data(), fec_length_);
+
+            /* lambda', into the Berlekamp-Massey scratch */
+            std::vector<galois::field_symbol>& derivative = ws.temp;
+
+            derivative.resize(degree);
+
+            galois::poly_derivative(lambda.data(), degree + 1, derivative.data());
+
+            std::vector<galois::field_symbol>& magnitude = ws.magnitude;
+
+            magnitude.resize(degree);
+
+            /* Forney: e = X^(1 - fcr).omega(X^-1) / lambda'(X^-1) */
+            for (std::size_t l = 0; l < degree; ++l)
+            {
+               const std::size_t          d = length - 1 - location[l];
+               const galois::field_symbol x = inverse_locator(d);
+
+               const galois::field_symbol numerator   = galois::poly_eval(field_, omega.data(), fec_length_, x);
+               const galois::field_symbol denominator = galois::poly_eval(field_, derivative.data(), degree, x);
+
+               if (0 == denominator)
+                  return false;
+
+               const long long exponent = (static_cast<long long>(d) * (1 - static_cast<long long>(fcr_))) % static_cast<long long>(field_.size());
+
+               const galois::field_symbol scale = field_.alpha(static_cast<galois::field_symbol>((exponent + field_.size()) % field_.size()));
+
+               magnitude[l] = field_.div(field_.mul(numerator, scale), denominator);
+            }
+
+            for (std::size_t l = 0; l < degree; ++l)
+            {
+               codeword[location[l]] = static_cast<T>((static_cast<galois::field_symbol>(codeword[location[l]]) & mask) ^ magnitude[l]);
+            }
+
+            return true;
+         }
+
+         struct workspace
+         {
+            std::vector<galois::field_symbol> lfsr;
+            std::vector<galois::field_symbol> syndrome;
+            std::vector<galois::field_symbol> lambda;
+            std::vector<galois::field_symbol> prior;
+            std::vector<galois::field_symbol> temp;
+            std::vector<galois::field_symbol> omega;
+            std::vector<galois::field_symbol> magnitude;
+            std::vector<galois::field_symbol> chien;
+            std::vector<std::size_t>          location;
+         };
+
+         static inline workspace& thread_workspace()
+         {
+            static thread_local workspace ws;
+            return ws;
+         }
+
+         const galois::field&              field_;
+         const std::size_t                 code_length_;
+         const std::size_t                 data_length_;
+         const std::size_t                 fec_length_;
+         const unsigned int                fcr_;
+         bool                              valid_;
+         generator_cache::generator_ptr    cached_generator_;
+         std::vector<galois::field_symbol> generator_;
+         const galois::field_symbol*       lfsr_rows_;
+         std::vector<galois::field_symbol> root_;
+         const void*                       special_encoder_;
+         const void*                       special_decoder_;
+         special_encode_t                  special_encode_;
+         special_decode_t                  special_decode_;
+         special_destroy_t                 special_destroy_;
+         std::unique_ptr<jit_lfsr>         jit_;
+         std::vector<galois::field_symbol> jit_scale_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
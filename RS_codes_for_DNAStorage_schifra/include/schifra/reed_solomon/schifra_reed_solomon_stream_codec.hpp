@@ -0,0 +1,476 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_STREAM_CODEC_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_STREAM_CODEC_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_parallel_file_codec.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Streams of unknown length, eg: std::cin and std::cout. The data
+         is encoded exactly as file_encoder encodes a file, and is followed
+         by a trailer, all of whose fields are little endian:
+
+            trailer (16 bytes)
+               magic "SCHT", the data length of the final partial block
+               (32 bit, 0 when the last block is complete) and the data
+               size (64 bit).
+
+         The decoder holds back the last 16 bytes it has read, which at
+         the end of the stream are the trailer, and so can tell a stream
+         that was cut short from one that ended.
+
+         Note: Diagnostics go to std::cerr, as std::cout may be carrying
+               the output stream.
+      */
+      namespace stream
+      {
+
+         static constexpr char        magic[4]     = {'S','C','H','T'};
+         static constexpr std::size_t trailer_size = 16;
+
+         inline void write_trailer(unsigned char* buffer, const std::uint32_t tail_length, const std::uint64_t data_size)
+         {
+            std::memcpy(buffer, magic, sizeof(magic));
+
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+               buffer[4 + i] = static_cast<unsigned char>((tail_length >> (8 * i)) & 0xFF);
+            }
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               buffer[8 + i] = static_cast<unsigned char>((data_size >> (8 * i)) & 0xFF);
+            }
+         }
+
+         inline bool read_trailer(const unsigned char* buffer, std::uint32_t& tail_length, std::uint64_t& data_size)
+         {
+            if (0 != std::memcmp(buffer, magic, sizeof(magic)))
+               return false;
+
+            tail_length = 0;
+            data_size   = 0;
+
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+               tail_length |= static_cast<std::uint32_t>(buffer[4 + i]) << (8 * i);
+            }
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               data_size |= static_cast<std::uint64_t>(buffer[8 + i]) << (8 * i);
+            }
+
+            return true;
+         }
+
+      } // namespace stream
+
+      namespace details
+      {
+
+         /*
+            run_file_pipeline() for streams: the calling thread fills
+            chunks with read(chunk), which sets chunk.amount and returns
+            false once the stream is exhausted, threads workers run
+            process(chunk), and a writer thread hands them to report(chunk)
+            and writes their output to out in stream order. Chunks are
+            recycled through a pool of 2 * threads + 1, as memory must stay
+            bounded however long the stream is. A chunk's output is its
+            output buffer, or its input buffer when output_size is zero.
+            Returns false when writing failed.
+         */
+         template <typename Read, typename Process, typename Report>
+         inline bool run_stream_pipeline(std::ostream& out,
+                                         const std::size_t input_size,
+                                         const std::size_t output_size,
+                                         const std::size_t threads,
+                                         const Read& read,
+                                         const Process& process,
+                                         const Report& report)
+         {
+            std::vector<file_chunk> chunks(2 * threads + 1);
+
+            utils::mpmc_ring<file_chunk*> free_chunks(chunks.size());
+            utils::mpmc_ring<file_chunk*> work       (chunks.size());
+            utils::mpmc_ring<file_chunk*> done       (chunks.size());
+
+            for (std::size_t i = 0; i < chunks.size(); ++i)
+            {
+               chunks[i].input .resize(input_size );
+               chunks[i].output.resize(output_size);
+
+               free_chunks.push(&chunks[i]);
+            }
+
+            bool write_success = true;
+
+            std::vector<std::thread> workers;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+               workers.push_back(std::thread([&]()
+                                 {
+                                    file_chunk* chunk = 0;
+
+                                    while (work.pop(chunk))
+                                    {
+                                       process(*chunk);
+                                       done.push(chunk);
+                                    }
+                                 }));
+            }
+
+            std::thread writer([&]()
+                               {
+                                  std::map<std::size_t,file_chunk*> pending;
+                                  std::size_t next = 0;
+
+                                  file_chunk* chunk = 0;
+
+                                  while (done.pop(chunk))
+                                  {
+                                     pending[chunk->index] = chunk;
+
+                                     while (!pending.empty() && (pending.begin()->first == next))
+                                     {
+                                        chunk = pending.begin()->second;
+
+                                        pending.erase(pending.begin());
+                                        ++next;
+
+                                        report(*chunk);
+
+                                        if (chunk->output_amount > 0)
+                                        {
+                                           const unsigned char* data = (output_size > 0) ? &chunk->output[0] : &chunk->input[0];
+
+                                           out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(chunk->output_amount));
+
+                                           if (out.fail())
+                                              write_success = false;
+                                        }
+
+                                        free_chunks.push(chunk);
+                                     }
+                                  }
+                               });
+
+            bool more = true;
+
+            for (std::size_t index = 0; more; )
+            {
+               file_chunk* chunk = 0;
+
+               if (!free_chunks.pop(chunk))
+                  break;
+
+               more = read(*chunk);
+
+               if (0 == chunk->amount)
+               {
+                  free_chunks.push(chunk);
+                  continue;
+               }
+
+               chunk->index = index++;
+
+               work.push(chunk);
+            }
+
+            work.close();
+
+            for (std::size_t t = 0; t < workers.size(); ++t)
+            {
+               workers[t].join();
+            }
+
+            done.close();
+            writer.join();
+
+            out.flush();
+
+            return write_success && !out.fail();
+         }
+
+      } // namespace details
+
+      /*
+         parallel_file_encoder for a stream of unknown length: in is read
+         until it ends, buffer_size (rounded to whole blocks) at a time,
+         and each chunk is encoded by one of threads worker threads with
+         file_encoder::encode_buffer(). 0 threads or buffer_size are taken
+         as for parallel_file_encoder. The
+         output is that of file_encoder followed by the stream trailer.
+         Both streams should be in binary mode.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class stream_encoder
+      {
+      public:
+
+         typedef file_encoder<code_length,fec_length,data_length,symbol_t> file_encoder_type;
+         typedef typename file_encoder_type::encoder_type encoder_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+         stream_encoder(const encoder_type& encoder,
+                        std::istream& in,
+                        std::ostream& out,
+                        const std::size_t threads = 0,
+                        const std::size_t buffer_size = 0)
+         : data_size_(0),
+           success_(false)
+         {
+            const std::size_t chunk_size = std::max<std::size_t>(1, tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size) / code_length) * data_length;
+
+            bool success = details::run_stream_pipeline(out,
+                                       chunk_size,
+                                       (chunk_size / data_length) * code_length,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk) -> bool
+                                       {
+                                          in.read(reinterpret_cast<char*>(&chunk.input[0]), static_cast<std::streamsize>(chunk_size));
+
+                                          chunk.amount = static_cast<std::size_t>(in.gcount());
+
+                                          data_size_ += chunk.amount;
+
+                                          return (chunk.amount == chunk_size);
+                                       },
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          chunk.failures = 0;
+
+                                          chunk.output_amount = file_encoder_type::encode_buffer(encoder,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.amount,
+                                                                                                 &chunk.output[0],
+                                                                                                 chunk.failures);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          for (std::size_t i = 0; i < chunk.failures; ++i)
+                                          {
+                                             std::cerr << "reed_solomon::stream_encoder() - Error during encoding of block!" << std::endl;
+                                          }
+                                       });
+
+            if (in.bad())
+            {
+               std::cerr << "reed_solomon::stream_encoder() - Error: input stream could not be read." << std::endl;
+               success = false;
+            }
+
+            unsigned char trailer[stream::trailer_size];
+
+            stream::write_trailer(trailer, static_cast<std::uint32_t>(data_size_ % data_length), data_size_);
+
+            out.write(reinterpret_cast<const char*>(trailer), static_cast<std::streamsize>(stream::trailer_size));
+            out.flush();
+
+            if (!success || out.fail())
+            {
+               std::cerr << "reed_solomon::stream_encoder() - Error: stream read or write failed." << std::endl;
+               return;
+            }
+
+            success_ = true;
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+         inline std::uint64_t data_size() const
+         {
+            return data_size_;
+         }
+
+      private:
+
+         stream_encoder(const stream_encoder&);
+         stream_encoder& operator=(const stream_encoder&);
+
+         std::uint64_t data_size_;
+         bool          success_;
+      };
+
+      /*
+         parallel_file_decoder for a stream_encoder stream of unknown
+         length. The output and the error reports come out in stream
+         order. The stream is only known to be whole once its trailer has
+         been read and matches the amount decoded, success() is false
+         otherwise, eg: for a stream that was cut short.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class stream_decoder
+      {
+      public:
+
+         typedef file_decoder<code_length,fec_length,data_length,symbol_t> file_decoder_type;
+         typedef typename file_decoder_type::decoder_type decoder_type;
+
+         static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+         stream_decoder(const decoder_type& decoder,
+                        std::istream& in,
+                        std::ostream& out,
+                        const std::size_t threads = 0,
+                        const std::size_t buffer_size = 0)
+         : data_size_(0),
+           success_(false)
+         {
+            const std::size_t chunk_blocks = std::max<std::size_t>(1, tuning::buffer_size<code_length,fec_length>(buffer_size, default_buffer_size) / code_length);
+            const std::size_t chunk_size   = chunk_blocks * code_length;
+
+            unsigned char held[stream::trailer_size];
+
+            in.read(reinterpret_cast<char*>(held), static_cast<std::streamsize>(stream::trailer_size));
+
+            if (static_cast<std::size_t>(in.gcount()) != stream::trailer_size)
+            {
+               std::cerr << "reed_solomon::stream_decoder() - Error: input stream is too short to hold a trailer." << std::endl;
+               return;
+            }
+
+            std::uint64_t encoded_size = 0;
+
+            /*
+               Note: Each chunk is the held back bytes followed by what is
+                     read, and its last trailer_size bytes are held back in
+                     turn, so its codewords are the first amount bytes and
+                     are decoded in place.
+            */
+            bool success = details::run_stream_pipeline(out,
+                                       chunk_size + stream::trailer_size,
+                                       0,
+                                       details::pipeline_threads(tuning::threads<code_length,fec_length>(threads)),
+                                       [&](details::file_chunk& chunk) -> bool
+                                       {
+                                          unsigned char* buffer = &chunk.input[0];
+
+                                          std::memcpy(buffer, held, stream::trailer_size);
+
+                                          in.read(reinterpret_cast<char*>(buffer + stream::trailer_size), static_cast<std::streamsize>(chunk_size));
+
+                                          chunk.amount = static_cast<std::size_t>(in.gcount());
+
+                                          std::memcpy(held, buffer + chunk.amount, stream::trailer_size);
+
+                                          encoded_size += chunk.amount;
+
+                                          return (chunk.amount == chunk_size);
+                                       },
+                                       [&](details::file_chunk& chunk)
+                                       {
+                                          chunk.failed.clear();
+
+                                          chunk.output_amount = file_decoder_type::decode_buffer(decoder,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.amount,
+                                                                                                 &chunk.input[0],
+                                                                                                 chunk.index * chunk_blocks,
+                                                                                                 chunk.failed);
+                                       },
+                                       [&](const details::file_chunk& chunk)
+                                       {
+                                          for (std::size_t i = 0; i < chunk.failed.size(); ++i)
+                                          {
+                                             std::cerr << "reed_solomon::stream_decoder() - Error during decoding of block " << chunk.failed[i] << "!" << std::endl;
+                                          }
+                                       });
+
+            if (in.bad() || !success)
+            {
+               std::cerr << "reed_solomon::stream_decoder() - Error: stream read or write failed." << std::endl;
+               return;
+            }
+
+            std::uint32_t tail_length = 0;
+
+            if (!stream::read_trailer(held, tail_length, data_size_))
+            {
+               std::cerr << "reed_solomon::stream_decoder() - Error: input stream has no trailer, it may have been cut short." << std::endl;
+               return;
+            }
+
+            const std::uint64_t complete_blocks = data_size_ / data_length;
+
+            if (
+                 (tail_length != (data_size_ % data_length)) ||
+                 (encoded_size != (complete_blocks * code_length + ((tail_length > 0) ? (tail_length + fec_length) : 0)))
+               )
+            {
+               std::cerr << "reed_solomon::stream_decoder() - Error: input stream does not match its trailer." << std::endl;
+               return;
+            }
+
+            success_ = true;
+         }
+
+         inline bool success() const
+         {
+            return success_;
+         }
+
+         /* The data size recorded in the trailer */
+         inline std::uint64_t data_size() const
+         {
+            return data_size_;
+         }
+
+      private:
+
+         stream_decoder(const stream_decoder&);
+         stream_decoder& operator=(const stream_decoder&);
+
+         std::uint64_t data_size_;
+         bool          success_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
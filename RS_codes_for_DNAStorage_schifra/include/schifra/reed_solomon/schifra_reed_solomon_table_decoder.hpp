@@ -0,0 +1,291 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_TABLE_DECODER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_TABLE_DECODER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/utils/schifra_span.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Decoder for the GF(2^4) codes, eg: RS(15,11), whose fec_length
+         syndromes pack into a 4 * fec_length bit index. Every one of the
+         16^fec_length syndrome vectors is mapped to the corrections and
+         block status that decoder::decode() produces for it, so decoding
+         becomes a syndrome, one table lookup and two xors.
+
+         The table is built on the first decode (65536 entries of 8 bytes
+         for fec_length = 4) by running the algebraic decoder once per
+         syndrome, which keeps the results bit-exact with it, failures and
+         partial corrections included. Codes outside the table's reach
+         (fec_length > 4) and erasure decoding go to the algebraic decoder.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length,
+                typename symbol_t = galois::field_symbol>
+      class syndrome_table_decoder
+      {
+      public:
+
+         typedef decoder<code_length,fec_length,data_length,symbol_t> decoder_type;
+         typedef typename decoder_type::block_type                   block_type;
+
+         /* Largest number of symbols a table entry corrects, fec_length / 2 for fec_length = 4 */
+         static constexpr std::size_t max_corrections = 2;
+
+         static constexpr std::size_t symbol_bits = 4;
+
+         static constexpr std::size_t table_size = (fec_length <= 4) ? (std::size_t(1) << (symbol_bits * fec_length)) : 0;
+
+         syndrome_table_decoder(const galois::field& field, const unsigned int& gen_initial_index = 0)
+         : decoder_(field, gen_initial_index),
+           table_valid_((0 != table_size) &&
+                        (code_length == 15) &&
+                        (field.size() == code_length))
+         {
+            if (table_valid_)
+            {
+               create_syndrome_contribution_table(field, gen_initial_index);
+            }
+         }
+
+         /* True when decoding goes through the syndrome table */
+         inline bool valid() const
+         {
+            return table_valid_;
+         }
+
+         inline const decoder_type& algebraic_decoder() const
+         {
+            return decoder_;
+         }
+
+         bool decode(block_type& rsblock) const
+         {
+            if (!table_valid_)
+               return decoder_.decode(rsblock);
+
+            const std::size_t syndrome = compute_syndrome(rsblock.data);
+            const correction& entry    = lookup(syndrome);
+
+            apply(entry, rsblock.data);
+
+            rsblock.errors_detected  = entry.errors_detected;
+            rsblock.errors_corrected = entry.errors_corrected;
+            rsblock.zero_numerators  = entry.zero_numerators;
+
+            /*
+               Note: As with decoder::decode(), a corrected block keeps its
+                     previous unrecoverable and error members.
+            */
+            if (0 == syndrome)
+               rsblock.unrecoverable = false;
+            else if (block_type::e_no_error != entry.error)
+            {
+               rsblock.unrecoverable = true;
+               rsblock.error         = static_cast<typename block_type::error_t>(entry.error);
+            }
+
+            return (block_type::e_no_error == entry.error);
+         }
+
+         bool decode(block_type& rsblock, const erasure_locations_t& erasure_list) const
+         {
+            if (!erasure_list.empty())
+               return decoder_.decode(rsblock, erasure_list);
+
+            return decode(rsblock);
+         }
+
+         /*
+            Decode a caller owned codeword of code_length symbols in place,
+            other lengths are left to the algebraic decoder.
+         */
+         template <typename T>
+         inline bool decode(const utils::span<T>& codeword) const
+         {
+            if (!table_valid_ || (codeword.size() != code_length))
+               return decoder_.decode(codeword);
+
+            const correction& entry = lookup(compute_syndrome(codeword.data()));
+
+            apply(entry, codeword.data());
+
+            return (block_type::e_no_error == entry.error);
+         }
+
+      private:
+
+         syndrome_table_decoder();
+         syndrome_table_decoder(const syndrome_table_decoder& dec);
+         syndrome_table_decoder& operator=(const syndrome_table_decoder& dec);
+
+         /*
+            Unused corrections have a zero magnitude, so apply() is always
+            max_corrections unconditional xors.
+         */
+         struct correction
+         {
+            std::uint8_t position [max_corrections];
+            std::uint8_t magnitude[max_corrections];
+            std::uint8_t errors_detected;
+            std::uint8_t errors_corrected;
+            std::uint8_t zero_numerators;
+            std::uint8_t error;
+         };
+
+         void create_syndrome_contribution_table(const galois::field& field, const unsigned int& gen_initial_index)
+         {
+            /*
+               Symbol i of a block is the coefficient of x^(code_length - 1 - i)
+               of the received polynomial, so a value v there adds
+               v.alpha^((gii + j).(code_length - 1 - i)) to syndrome j.
+            */
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               for (std::size_t v = 0; v <= field.mask(); ++v)
+               {
+                  std::uint16_t packed = 0;
+
+                  for (std::size_t j = 0; j < fec_length; ++j)
+                  {
+                     const galois::field_symbol root = field.alpha(gen_initial_index + static_cast<unsigned int>(j));
+                     const galois::field_symbol s    = field.mul(static_cast<galois::field_symbol>(v),
+                                                                 field.exp(root, static_cast<int>(code_length - 1 - i)));
+
+                     packed |= static_cast<std::uint16_t>(s << (symbol_bits * j));
+                  }
+
+                  contribution_[i][v] = packed;
+               }
+            }
+         }
+
+         /*
+            A block holding only fec_length arbitrary trailing symbols runs
+            through every syndrome exactly once, as any fec_length columns
+            of the parity check matrix are independent.
+         */
+         void create_syndrome_table() const
+         {
+            table_.resize(table_size);
+
+            for (std::size_t v = 0; v < table_size; ++v)
+            {
+               block_type received;
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  received[i] = 0;
+               }
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  received[code_length - fec_length + j] = static_cast<symbol_t>((v >> (symbol_bits * j)) & 0x0F);
+               }
+
+               block_type decoded = received;
+
+               decoder_.decode(decoded);
+
+               correction& entry = table_[compute_syndrome(received.data)];
+
+               std::size_t k = 0;
+
+               for (std::size_t i = 0; i < max_corrections; ++i)
+               {
+                  entry.position [i] = 0;
+                  entry.magnitude[i] = 0;
+               }
+
+               for (std::size_t i = 0; (i < code_length) && (k < max_corrections); ++i)
+               {
+                  if (decoded[i] != received[i])
+                  {
+                     entry.position [k] = static_cast<std::uint8_t>(i);
+                     entry.magnitude[k] = static_cast<std::uint8_t>(decoded[i] ^ received[i]);
+                     ++k;
+                  }
+               }
+
+               entry.errors_detected  = static_cast<std::uint8_t>(decoded.errors_detected );
+               entry.errors_corrected = static_cast<std::uint8_t>(decoded.errors_corrected);
+               entry.zero_numerators  = static_cast<std::uint8_t>(decoded.zero_numerators );
+               entry.error            = static_cast<std::uint8_t>(decoded.unrecoverable ? decoded.error : block_type::e_no_error);
+            }
+         }
+
+         template <typename T>
+         inline std::size_t compute_syndrome(const T* symbols) const
+         {
+            std::uint16_t syndrome = 0;
+
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               syndrome ^= contribution_[i][symbols[i] & 0x0F];
+            }
+
+            return syndrome;
+         }
+
+         inline const correction& lookup(const std::size_t& syndrome) const
+         {
+            std::call_once(table_once_, [this]() { create_syndrome_table(); });
+
+            return table_[syndrome];
+         }
+
+         template <typename T>
+         static inline void apply(const correction& entry, T* symbols)
+         {
+            for (std::size_t i = 0; i < max_corrections; ++i)
+            {
+               symbols[entry.position[i]] ^= static_cast<T>(entry.magnitude[i]);
+            }
+         }
+
+         const decoder_type              decoder_;
+         const bool                      table_valid_;
+         std::uint16_t                   contribution_[code_length][16];
+         mutable std::vector<correction> table_;
+         mutable std::once_flag          table_once_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
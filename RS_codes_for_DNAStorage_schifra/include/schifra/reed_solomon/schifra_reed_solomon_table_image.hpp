@@ -0,0 +1,349 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_TABLE_IMAGE_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_TABLE_IMAGE_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "schifra/core/galois_field/element.hpp"
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/utils/schifra_fileio.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Precomputed field tables and generator polynomials saved as one
+         binary image, so that short lived processes can map them instead
+         of generating them. The field's mul/div/exp/inverse tables, the
+         bulk of the cost (O(field size^2)), sit page aligned in the
+         image and are used in place from a read-only shared mapping, so
+         every process using the same image shares one copy through the
+         page cache.
+
+         Layout: header, generator records (initial index, degree, then
+         degree + 1 symbols), then the field lut at the next page
+         boundary. Images are native: the header records version, byte
+         order, symbol size and the LINEAR_EXP_LUT setting, and an image
+         not matching the reading build is rejected rather than used.
+
+         Note: Encoder/decoder tables are O(field size * fec length) and
+               are still built per codec, over the image's field.
+      */
+      class table_image
+      {
+      public:
+
+         /* (initial root index, fec length) of a sequential root generator */
+         typedef std::pair<unsigned int, std::size_t> generator_key;
+
+         static const std::uint32_t version = 1;
+
+         static bool write(const std::string& file_name,
+                           const galois::field& field,
+                           const std::vector<generator_key>& generators)
+         {
+            header h;
+
+            if (!make_header(field, h))
+            {
+               std::cout << "reed_solomon::table_image::write() - Error: field cannot be imaged." << std::endl;
+               return false;
+            }
+
+            std::string records;
+
+            for (std::size_t i = 0; i < generators.size(); ++i)
+            {
+               galois::field_polynomial generator(field);
+
+               if (!make_sequential_root_generator_polynomial(field, generators[i].first, generators[i].second, generator))
+               {
+                  std::cout << "reed_solomon::table_image::write() - Error: invalid generator "
+                            << generators[i].first << "/" << generators[i].second << std::endl;
+                  return false;
+               }
+
+               const std::uint32_t record[2] = { generators[i].first, static_cast<std::uint32_t>(generator.deg()) };
+
+               records.append(reinterpret_cast<const char*>(record), sizeof(record));
+
+               for (int j = 0; j <= generator.deg(); ++j)
+               {
+                  const galois::field_symbol symbol = generator[j].poly();
+                  records.append(reinterpret_cast<const char*>(&symbol), sizeof(symbol));
+               }
+            }
+
+            h.generator_count = static_cast<std::uint32_t>(generators.size());
+            h.lut_size        = field.lut_size();
+            h.lut_offset      = round_to_page(sizeof(header) + records.size());
+
+            std::ofstream stream(file_name.c_str(), std::ios::binary | std::ios::trunc);
+
+            if (!stream)
+            {
+               std::cout << "reed_solomon::table_image::write() - Error: " << file_name << " could not be created." << std::endl;
+               return false;
+            }
+
+            stream.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            stream.write(records.data(), static_cast<std::streamsize>(records.size()));
+
+            if (0 != h.lut_size)
+            {
+               const std::string padding(static_cast<std::size_t>(h.lut_offset) - sizeof(header) - records.size(), '\0');
+
+               stream.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+               stream.write(field.lut(), static_cast<std::streamsize>(h.lut_size));
+            }
+
+            return !stream.fail();
+         }
+
+         explicit table_image(const std::string& file_name)
+         : data_(0),
+           size_(0)
+         {
+            #ifdef SCHIFRA_FILEIO_MMAP
+            if (!file_.open(file_name))
+               return;
+
+            file_.advise(MADV_WILLNEED);
+
+            data_ = reinterpret_cast<const char*>(file_.data());
+            size_ = file_.size();
+            #else
+            fileio::load_file(file_name, buffer_);
+
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            #endif
+
+            if (!load())
+            {
+               field_.reset();
+               generators_.clear();
+            }
+         }
+
+         inline bool valid() const
+         {
+            return static_cast<bool>(field_);
+         }
+
+         /* Only to be called on a valid image, and lives as long as it */
+         inline const galois::field& field() const
+         {
+            return *field_;
+         }
+
+         inline std::size_t generator_count() const
+         {
+            return generators_.size();
+         }
+
+         /* The generator with the given initial root index and fec length, false if not imaged */
+         bool generator(const unsigned int initial_index,
+                        const std::size_t fec_length,
+                        galois::field_polynomial& generator_polynomial) const
+         {
+            for (std::size_t i = 0; i < generators_.size(); ++i)
+            {
+               const generator_record& record = generators_[i];
+
+               if ((record.initial_index != initial_index) || (record.degree != fec_length))
+                  continue;
+
+               generator_polynomial = galois::field_polynomial(*field_, static_cast<unsigned int>(record.degree));
+
+               for (std::size_t j = 0; j <= record.degree; ++j)
+               {
+                  galois::field_symbol symbol;
+                  std::memcpy(&symbol, record.symbols + (j * sizeof(symbol)), sizeof(symbol));
+
+                  generator_polynomial[j] = galois::field_element(*field_, symbol);
+               }
+
+               return true;
+            }
+
+            return false;
+         }
+
+      private:
+
+         table_image(const table_image&);
+         table_image& operator=(const table_image&);
+
+         static const std::size_t page_size = 4096;
+         static const std::size_t max_prim_poly_terms = 33;
+
+         struct header
+         {
+            char          magic[8];
+            std::uint32_t version;
+            std::uint32_t byte_order;
+            std::uint32_t symbol_size;
+            std::uint32_t linear_exp_lut;
+            std::uint32_t power;
+            std::uint32_t prim_poly_degree;
+            std::uint32_t prim_poly[max_prim_poly_terms];
+            std::uint32_t generator_count;
+            std::uint64_t lut_offset;
+            std::uint64_t lut_size;
+         };
+
+         struct generator_record
+         {
+            unsigned int initial_index;
+            std::size_t  degree;
+            const char*  symbols;
+         };
+
+         static inline std::uint64_t round_to_page(const std::size_t size)
+         {
+            return static_cast<std::uint64_t>(((size + page_size - 1) / page_size) * page_size);
+         }
+
+         static bool make_header(const galois::field& field, header& h)
+         {
+            std::memset(&h, 0, sizeof(h));
+
+            if ((field.prim_poly_degree() + 1) > max_prim_poly_terms)
+               return false;
+
+            std::memcpy(h.magic, "SCHIFRAT", sizeof(h.magic));
+
+            h.version          = version;
+            h.byte_order       = 0x01020304;
+            h.symbol_size      = sizeof(galois::field_symbol);
+            #ifdef LINEAR_EXP_LUT
+            h.linear_exp_lut   = 1;
+            #else
+            h.linear_exp_lut   = 0;
+            #endif
+            h.power            = field.pwr();
+            h.prim_poly_degree = static_cast<std::uint32_t>(field.prim_poly_degree());
+
+            for (std::size_t i = 0; i <= field.prim_poly_degree(); ++i)
+            {
+               h.prim_poly[i] = field.prim_poly_term(static_cast<unsigned int>(i));
+            }
+
+            return true;
+         }
+
+         bool load()
+         {
+            if ((0 == data_) || (size_ < sizeof(header)))
+               return false;
+
+            header h;
+            std::memcpy(&h, data_, sizeof(h));
+
+            header expected;
+            std::memset(&expected, 0, sizeof(expected));
+            std::memcpy(expected.magic, "SCHIFRAT", sizeof(expected.magic));
+
+            if (
+                 (0 != std::memcmp(h.magic, expected.magic, sizeof(h.magic))) ||
+                 (version                      != h.version    ) ||
+                 (0x01020304                   != h.byte_order ) ||
+                 (sizeof(galois::field_symbol) != h.symbol_size) ||
+                 #ifdef LINEAR_EXP_LUT
+                 (1 != h.linear_exp_lut) ||
+                 #else
+                 (0 != h.linear_exp_lut) ||
+                 #endif
+                 ((h.prim_poly_degree + 1) > max_prim_poly_terms) ||
+                 (h.lut_offset > size_) ||
+                 (h.lut_size   > (size_ - h.lut_offset))
+               )
+            {
+               return false;
+            }
+
+            std::size_t offset = sizeof(header);
+
+            for (std::size_t i = 0; i < h.generator_count; ++i)
+            {
+               std::uint32_t record[2];
+
+               if ((size_ - offset) < sizeof(record))
+                  return false;
+
+               std::memcpy(record, data_ + offset, sizeof(record));
+               offset += sizeof(record);
+
+               const std::size_t symbols_size = (static_cast<std::size_t>(record[1]) + 1) * sizeof(galois::field_symbol);
+
+               if ((size_ - offset) < symbols_size)
+                  return false;
+
+               const generator_record generator = { record[0], record[1], data_ + offset };
+               generators_.push_back(generator);
+
+               offset += symbols_size;
+            }
+
+            const char* lut = (0 != h.lut_size) ? (data_ + h.lut_offset) : 0;
+
+            field_.reset(new galois::field(static_cast<int>(h.power), h.prim_poly_degree, h.prim_poly, lut));
+
+            /* The image's lut must be exactly what this build's field expects */
+            return (field_->lut_size() == h.lut_size);
+         }
+
+         #ifdef SCHIFRA_FILEIO_MMAP
+         fileio::mapped_file file_;
+         #else
+         std::string         buffer_;
+         #endif
+
+         const char*                           data_;
+         std::size_t                           size_;
+         std::unique_ptr<galois::field>        field_;
+         std::vector<generator_record>         generators_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
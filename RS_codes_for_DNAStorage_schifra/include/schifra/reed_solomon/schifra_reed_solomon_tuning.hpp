@@ -0,0 +1,305 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_TUNING_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_TUNING_HPP
+
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Tuned settings of the codec executor and the parallel file and
+         stream pipelines, per code, as found by autotuner for the host.
+         Profiles are kept in a text file, one line per code:
+
+            code_length fec_length threads grain buffer_size
+
+         The file is named by the SCHIFRA_TUNING_FILE environment variable,
+         or is ~/.schifra_tuning. It is read the first time a profile is
+         looked up. An executor or pipeline given 0 threads, grain or
+         buffer size takes it from the profile of its code, or falls back
+         to its default when there is none.
+      */
+      namespace tuning
+      {
+
+         struct profile
+         {
+            std::size_t threads;
+            std::size_t grain;
+            std::size_t buffer_size;
+         };
+
+         inline std::string profile_path()
+         {
+            const char* file = std::getenv("SCHIFRA_TUNING_FILE");
+
+            if ((0 != file) && (0 != file[0]))
+               return file;
+
+            const char* home = std::getenv("HOME");
+
+            if ((0 != home) && (0 != home[0]))
+               return std::string(home) + "/.schifra_tuning";
+
+            return std::string();
+         }
+
+         namespace details
+         {
+
+            struct entry
+            {
+               std::size_t code_length;
+               std::size_t fec_length;
+               profile     settings;
+            };
+
+            inline bool read_profiles(const std::string& path, std::vector<entry>& entries)
+            {
+               std::ifstream stream(path.c_str());
+               if (!stream)
+                  return false;
+
+               std::string line;
+
+               while (std::getline(stream, line))
+               {
+                  std::istringstream fields(line);
+
+                  entry e;
+
+                  if (
+                       (fields >> e.code_length >> e.fec_length >> e.settings.threads >> e.settings.grain >> e.settings.buffer_size) &&
+                       (e.code_length > e.fec_length)
+                     )
+                  {
+                     entries.push_back(e);
+                  }
+               }
+
+               return true;
+            }
+
+            /* The profiles looked up by the executor and pipelines, read once */
+            class registry
+            {
+            public:
+
+               static registry& instance()
+               {
+                  static registry r;
+                  return r;
+               }
+
+               inline bool find(const std::size_t code_length, const std::size_t fec_length, profile& settings)
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  if (!loaded_)
+                  {
+                     read_profiles(profile_path(), entries_);
+                     loaded_ = true;
+                  }
+
+                  for (std::size_t i = 0; i < entries_.size(); ++i)
+                  {
+                     if ((entries_[i].code_length == code_length) && (entries_[i].fec_length == fec_length))
+                     {
+                        settings = entries_[i].settings;
+                        return true;
+                     }
+                  }
+
+                  return false;
+               }
+
+               inline void install(const std::size_t code_length, const std::size_t fec_length, const profile& settings)
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  loaded_ = true;
+
+                  for (std::size_t i = 0; i < entries_.size(); ++i)
+                  {
+                     if ((entries_[i].code_length == code_length) && (entries_[i].fec_length == fec_length))
+                     {
+                        entries_[i].settings = settings;
+                        return;
+                     }
+                  }
+
+                  const entry e = { code_length, fec_length, settings };
+
+                  entries_.push_back(e);
+               }
+
+            private:
+
+               registry()
+               : loaded_(false)
+               {}
+
+               std::mutex         mutex_;
+               bool               loaded_;
+               std::vector<entry> entries_;
+            };
+
+         } // namespace details
+
+         /* The profile of a code in path, false when there is none */
+         inline bool load(const std::string& path, const std::size_t code_length, const std::size_t fec_length, profile& settings)
+         {
+            std::vector<details::entry> entries;
+
+            details::read_profiles(path, entries);
+
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+               if ((entries[i].code_length == code_length) && (entries[i].fec_length == fec_length))
+               {
+                  settings = entries[i].settings;
+                  return true;
+               }
+            }
+
+            return false;
+         }
+
+         /*
+            Store the profile of a code in path, keeping those of other
+            codes, and use it from now on in this process. The file is
+            written aside and renamed over the old one, so that a reader
+            never sees it half written.
+         */
+         inline bool save(const std::string& path, const std::size_t code_length, const std::size_t fec_length, const profile& settings)
+         {
+            details::registry::instance().install(code_length, fec_length, settings);
+
+            if (path.empty())
+               return false;
+
+            std::vector<details::entry> entries;
+
+            details::read_profiles(path, entries);
+
+            const std::string temp_path = path + ".tmp";
+
+            {
+               std::ofstream stream(temp_path.c_str(), std::ios::trunc);
+
+               for (std::size_t i = 0; i < entries.size(); ++i)
+               {
+                  if ((entries[i].code_length != code_length) || (entries[i].fec_length != fec_length))
+                  {
+                     stream << entries[i].code_length      << ' ' << entries[i].fec_length     << ' '
+                            << entries[i].settings.threads << ' ' << entries[i].settings.grain << ' '
+                            << entries[i].settings.buffer_size << '\n';
+                  }
+               }
+
+               stream << code_length      << ' ' << fec_length     << ' '
+                      << settings.threads << ' ' << settings.grain << ' '
+                      << settings.buffer_size << '\n';
+
+               if (!stream.flush())
+               {
+                  std::remove(temp_path.c_str());
+                  return false;
+               }
+            }
+
+            if (0 != std::rename(temp_path.c_str(), path.c_str()))
+            {
+               std::remove(temp_path.c_str());
+               return false;
+            }
+
+            return true;
+         }
+
+         /* The tuned profile of a code, false when it has none */
+         template <std::size_t code_length, std::size_t fec_length>
+         inline bool tuned(profile& settings)
+         {
+            return details::registry::instance().find(code_length, fec_length, settings);
+         }
+
+         /* requested when given, else the tuned thread count, else 0 */
+         template <std::size_t code_length, std::size_t fec_length>
+         inline std::size_t threads(const std::size_t requested)
+         {
+            profile settings;
+
+            if ((0 == requested) && tuned<code_length,fec_length>(settings))
+               return settings.threads;
+
+            return requested;
+         }
+
+         /* requested when given, else the tuned grain, else fallback */
+         template <std::size_t code_length, std::size_t fec_length>
+         inline std::size_t grain(const std::size_t requested, const std::size_t fallback)
+         {
+            profile settings;
+
+            if (requested > 0)
+               return requested;
+
+            return (tuned<code_length,fec_length>(settings) && (settings.grain > 0)) ? settings.grain : fallback;
+         }
+
+         /* requested when given, else the tuned buffer size, else fallback */
+         template <std::size_t code_length, std::size_t fec_length>
+         inline std::size_t buffer_size(const std::size_t requested, const std::size_t fallback)
+         {
+            profile settings;
+
+            if (requested > 0)
+               return requested;
+
+            return (tuned<code_length,fec_length>(settings) && (settings.buffer_size > 0)) ? settings.buffer_size : fallback;
+         }
+
+      } // namespace tuning
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
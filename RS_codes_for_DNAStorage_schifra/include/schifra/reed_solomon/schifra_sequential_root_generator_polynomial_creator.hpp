@@ -25,19 +25,94 @@
 
 
 #include <cstddef>
+#include <vector>
 
 #include "schifra/core/galois_field/field.hpp"
 #include "schifra/core/galois_field/element.hpp"
 #include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/core/galois_field/polynomial_kernels.hpp"
 
 
 namespace schifra
 {
 
+   namespace details
+   {
+
+      /* Roots per leaf of the product tree, multiplied in one at a time */
+      const std::size_t generator_leaf_roots = 64;
+
+      /* Workspace symbols of generator_product() for count roots */
+      inline std::size_t generator_workspace(const std::size_t count)
+      {
+         if (count <= generator_leaf_roots)
+            return 0;
+
+         const std::size_t terms = count - (count / 2) + 1;
+
+         return 2 * terms + (2 * terms - 1) + galois::karatsuba_scratch(terms) + generator_workspace(count - (count / 2));
+      }
+
+      /*
+         product = (x + alpha^first) ... (x + alpha^(first + count - 1)),
+         count + 1 terms lowest power first. Each half of the roots is
+         multiplied out in the workspace and the halves are combined with
+         Karatsuba, leaves being built in place one root at a time.
+      */
+      inline void generator_product(const galois::field& field,
+                                    const std::size_t first,
+                                    const std::size_t count,
+                                    galois::field_symbol* product,
+                                    galois::field_symbol* workspace)
+      {
+         if (count <= generator_leaf_roots)
+         {
+            product[0] = 1;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               galois::poly_mul_linear(field, product, i + 1, field.alpha(static_cast<galois::field_symbol>(first + i)));
+            }
+
+            return;
+         }
+
+         const std::size_t lower = count / 2;
+         const std::size_t terms = count - lower + 1;
+
+         galois::field_symbol* left  = workspace;
+         galois::field_symbol* right = left  + terms;
+         galois::field_symbol* full  = right + terms;
+         galois::field_symbol* rest  = full  + (2 * terms - 1);
+
+         generator_product(field, first, lower, left, rest);
+
+         for (std::size_t i = lower + 1; i < terms; ++i)
+         {
+            left[i] = 0;
+         }
+
+         generator_product(field, first + lower, count - lower, right, rest);
+
+         galois::poly_mul_karatsuba(field, left, right, terms, full, rest);
+
+         for (std::size_t i = 0; i <= count; ++i)
+         {
+            product[i] = full[i];
+         }
+      }
+
+   } // namespace details
+
+   /*
+      Coefficients g[0] .. g[num_elements] of the generator whose roots
+      are alpha^initial_index .. alpha^(initial_index + num_elements - 1),
+      built over raw symbols in one workspace allocation.
+   */
    inline bool make_sequential_root_generator_polynomial(const galois::field& field,
                                                          const std::size_t initial_index,
                                                          const std::size_t num_elements,
-                                                         galois::field_polynomial& generator_polynomial)
+                                                         std::vector<galois::field_symbol>& generator_coefficients)
    {
       if (
            (initial_index >= field.size()) ||
@@ -47,13 +122,30 @@ namespace schifra
          return false;
       }
 
-      galois::field_element alpha(field, 2);
-      galois::field_polynomial X = galois::generate_X(field);
-      generator_polynomial = galois::field_element(field, 1);
+      std::vector<galois::field_symbol> workspace(details::generator_workspace(num_elements));
+
+      generator_coefficients.resize(num_elements + 1);
+
+      details::generator_product(field, initial_index, num_elements, generator_coefficients.data(), workspace.data());
+
+      return true;
+   }
+
+   inline bool make_sequential_root_generator_polynomial(const galois::field& field,
+                                                         const std::size_t initial_index,
+                                                         const std::size_t num_elements,
+                                                         galois::field_polynomial& generator_polynomial)
+   {
+      std::vector<galois::field_symbol> coefficients;
+
+      if (!make_sequential_root_generator_polynomial(field, initial_index, num_elements, coefficients))
+         return false;
+
+      generator_polynomial = galois::field_polynomial(field, static_cast<unsigned int>(num_elements));
 
-      for (std::size_t i = initial_index; i < (initial_index + num_elements); ++i)
+      for (std::size_t i = 0; i <= num_elements; ++i)
       {
-         generator_polynomial *= (X + (alpha ^ static_cast<galois::field_symbol>(i)));
+         generator_polynomial[i] = coefficients[i];
       }
 
       return true;
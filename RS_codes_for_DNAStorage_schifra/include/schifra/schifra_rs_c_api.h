@@ -0,0 +1,142 @@
+/*
+   schifra_rs_c_api.h - C interface to the run time Reed-Solomon codec
+
+   A stable C ABI over reed_solomon::rs_codec, exported by the
+   schifra_dna_storage shared library, so that other languages (Go, Rust,
+   ...) can use the codec through their FFI, and C++ consumers without
+   compiling the codec headers.
+
+   A codec is an opaque handle for an (n, k) code over GF(2^m), 3 <= m <= 8,
+   with one symbol per byte. Codewords are laid out data first, then parity.
+   Batch entry points take caller owned buffers holding many blocks at a
+   fixed stride, so that one call, rather than one per block, crosses the
+   FFI boundary, and report the outcome of every block in a status array.
+
+   A codec is immutable once created: any number of threads may call the
+   batch functions on the same handle concurrently.
+
+   Copyright (C) 2025 Schifra Project
+*/
+
+#ifndef INCLUDE_SCHIFRA_RS_C_API_H
+#define INCLUDE_SCHIFRA_RS_C_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+   #if defined(SCHIFRA_C_API_BUILD)
+      #define SCHIFRA_C_API __declspec(dllexport)
+   #else
+      #define SCHIFRA_C_API __declspec(dllimport)
+   #endif
+#elif defined(__GNUC__)
+   #define SCHIFRA_C_API __attribute__((visibility("default")))
+#else
+   #define SCHIFRA_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change of the functions or structs below */
+#define RS_ABI_VERSION 1
+
+typedef struct rs_codec rs_codec_t;
+
+/* Result of every function returning rs_result_t */
+typedef enum
+{
+   RS_OK               = 0,
+   RS_INVALID_ARGUMENT = 1,  /* null pointer, bad code parameters, stride too small */
+   RS_OUT_OF_MEMORY    = 2,
+   RS_INTERNAL_ERROR   = 3
+} rs_result_t;
+
+/* Outcome of one block, one uint8_t per block of the status arrays */
+typedef enum
+{
+   RS_BLOCK_OK            = 0,  /* encoded, or decoded with zero syndromes */
+   RS_BLOCK_CORRECTED     = 1,  /* decoded after correcting errors         */
+   RS_BLOCK_UNCORRECTABLE = 2,  /* too many errors, codeword left as read  */
+   RS_BLOCK_INVALID       = 3   /* a symbol does not fit in symbol_bits    */
+} rs_block_status_t;
+
+/* Cumulative block counts of a codec since creation or rs_stats_reset() */
+typedef struct
+{
+   uint64_t blocks_encoded;
+   uint64_t blocks_decoded;
+   uint64_t blocks_clean;
+   uint64_t blocks_corrected;
+   uint64_t blocks_uncorrectable;
+   uint64_t blocks_invalid;
+} rs_stats_t;
+
+/* RS_ABI_VERSION the library was built with */
+SCHIFRA_C_API uint32_t rs_abi_version(void);
+
+/* Static, human readable description of a result */
+SCHIFRA_C_API const char* rs_result_string(rs_result_t result);
+
+/*
+   Create the (n, k) code over GF(2^symbol_bits), n at most 2^symbol_bits - 1,
+   whose generator has the n - k consecutive roots alpha^fcr ..
+   alpha^(fcr + n - k - 1). primitive_poly is the field polynomial as a bit
+   mask, bit i the coefficient of x^i (eg: 0x187 for x^8 + x^7 + x^2 + x + 1),
+   or 0 for the library's default polynomial of that field size.
+*/
+SCHIFRA_C_API rs_result_t rs_codec_create(unsigned int symbol_bits,
+                                          unsigned int primitive_poly,
+                                          size_t n,
+                                          size_t k,
+                                          unsigned int fcr,
+                                          rs_codec_t** codec);
+
+/* Accepts null */
+SCHIFRA_C_API void rs_codec_destroy(rs_codec_t* codec);
+
+SCHIFRA_C_API size_t rs_code_length(const rs_codec_t* codec);
+SCHIFRA_C_API size_t rs_data_length(const rs_codec_t* codec);
+SCHIFRA_C_API size_t rs_fec_length (const rs_codec_t* codec);
+
+/*
+   Compute the parity of blocks blocks. Block i reads data_length() symbols
+   at data + i * data_stride and writes fec_length() symbols at
+   parity + i * parity_stride; for whole codewords in one buffer pass
+   parity = data + data_length() and the same stride for both. status, when
+   not null, receives one rs_block_status_t per block: RS_BLOCK_OK, or
+   RS_BLOCK_INVALID when a data symbol does not fit in symbol_bits, the
+   block's parity then being left untouched.
+*/
+SCHIFRA_C_API rs_result_t rs_encode_batch(const rs_codec_t* codec,
+                                          const uint8_t* data,
+                                          size_t data_stride,
+                                          uint8_t* parity,
+                                          size_t parity_stride,
+                                          size_t blocks,
+                                          uint8_t* status);
+
+/*
+   Correct blocks codewords in place, codeword i being code_length()
+   symbols at codewords + i * stride. status, when not null, receives one
+   rs_block_status_t per block. Uncorrectable and invalid blocks are left
+   as they were and do not fail the call; decoded, when not null, receives
+   the number of blocks that decoded (clean or corrected).
+*/
+SCHIFRA_C_API rs_result_t rs_decode_batch(const rs_codec_t* codec,
+                                          uint8_t* codewords,
+                                          size_t stride,
+                                          size_t blocks,
+                                          uint8_t* status,
+                                          size_t* decoded);
+
+SCHIFRA_C_API rs_result_t rs_stats(const rs_codec_t* codec, rs_stats_t* stats);
+SCHIFRA_C_API rs_result_t rs_stats_reset(rs_codec_t* codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,309 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_ALIGNED_ALLOCATOR_HPP
+#define INCLUDE_SCHIFRA_ALIGNED_ALLOCATOR_HPP
+
+
+#include <cstddef>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         A std::allocator replacement whose storage starts on an alignment
+         byte boundary, eg: 4096 for buffers handed to O_DIRECT I/O.
+      */
+      template <typename T, std::size_t alignment>
+      class aligned_allocator
+      {
+      public:
+
+         typedef T value_type;
+
+         template <typename U>
+         struct rebind
+         {
+            typedef aligned_allocator<U,alignment> other;
+         };
+
+         aligned_allocator()
+         {}
+
+         template <typename U>
+         aligned_allocator(const aligned_allocator<U,alignment>&)
+         {}
+
+         inline T* allocate(const std::size_t n)
+         {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+         }
+
+         inline void deallocate(T* p, const std::size_t)
+         {
+            ::operator delete(p, std::align_val_t(alignment));
+         }
+
+         template <typename U>
+         inline bool operator==(const aligned_allocator<U,alignment>&) const
+         {
+            return true;
+         }
+
+         template <typename U>
+         inline bool operator!=(const aligned_allocator<U,alignment>&) const
+         {
+            return false;
+         }
+      };
+
+      static const std::size_t cache_line_size = 64;
+      static const std::size_t huge_page_size  = 2 * 1024 * 1024;
+
+      /*
+         Hook through which field lookup tables and codec tables get their
+         memory. Both functions are given the same size for a block, so a
+         hook may round it up (eg: to whole huge pages) consistently.
+         Memory must be aligned to at least cache_line_size.
+      */
+      struct table_memory
+      {
+         void* (*allocate  )(std::size_t size);
+         void  (*deallocate)(void* p, std::size_t size);
+
+         inline bool operator==(const table_memory& m) const
+         {
+            return (allocate == m.allocate) && (deallocate == m.deallocate);
+         }
+
+         inline bool operator!=(const table_memory& m) const
+         {
+            return !(*this == m);
+         }
+      };
+
+      namespace details
+      {
+         inline void* cache_aligned_allocate(const std::size_t size)
+         {
+            return ::operator new(size, std::align_val_t(cache_line_size));
+         }
+
+         inline void cache_aligned_deallocate(void* p, const std::size_t)
+         {
+            ::operator delete(p, std::align_val_t(cache_line_size));
+         }
+
+         /*
+            Blocks of at least half a huge page are mapped in whole 2MB
+            pages, from the hugetlbfs pool when one is reserved, otherwise
+            as normal pages the kernel is asked to back with transparent
+            huge pages. Smaller blocks are not worth a page of their own.
+         */
+         inline bool use_huge_pages(const std::size_t size)
+         {
+            #if defined(__linux__)
+            return (size >= (huge_page_size / 2));
+            #else
+            (void)size;
+            return false;
+            #endif
+         }
+
+         inline void* huge_page_allocate(const std::size_t size)
+         {
+            if (!use_huge_pages(size))
+               return cache_aligned_allocate(size);
+
+            #if defined(__linux__)
+            const std::size_t length = ((size + huge_page_size - 1) / huge_page_size) * huge_page_size;
+
+            #ifdef MAP_HUGETLB
+            void* p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            if (MAP_FAILED != p)
+               return p;
+            #endif
+
+            void* q = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (MAP_FAILED == q)
+               throw std::bad_alloc();
+
+            #ifdef MADV_HUGEPAGE
+            madvise(q, length, MADV_HUGEPAGE);
+            #endif
+
+            return q;
+            #else
+            return cache_aligned_allocate(size);
+            #endif
+         }
+
+         inline void huge_page_deallocate(void* p, const std::size_t size)
+         {
+            if (!use_huge_pages(size))
+            {
+               cache_aligned_deallocate(p, size);
+               return;
+            }
+
+            #if defined(__linux__)
+            munmap(p, ((size + huge_page_size - 1) / huge_page_size) * huge_page_size);
+            #endif
+         }
+
+      } // namespace details
+
+      inline table_memory cache_aligned_table_memory()
+      {
+         const table_memory memory = { details::cache_aligned_allocate, details::cache_aligned_deallocate };
+         return memory;
+      }
+
+      inline table_memory huge_page_table_memory()
+      {
+         const table_memory memory = { details::huge_page_allocate, details::huge_page_deallocate };
+         return memory;
+      }
+
+      /*
+         The hook used by tables built from now on, cache line aligned
+         heap memory unless SCHIFRA_HUGE_PAGE_TABLES is defined. Tables
+         remember the hook they were allocated with, but changing it while
+         other threads construct fields or codecs is not supported.
+      */
+      inline table_memory& table_memory_hook()
+      {
+         #ifdef SCHIFRA_HUGE_PAGE_TABLES
+         static table_memory memory = huge_page_table_memory();
+         #else
+         static table_memory memory = cache_aligned_table_memory();
+         #endif
+
+         return memory;
+      }
+
+      /* std allocator drawing from the table memory hook current at its construction */
+      template <typename T>
+      class table_allocator
+      {
+      public:
+
+         typedef T value_type;
+
+         template <typename U>
+         struct rebind
+         {
+            typedef table_allocator<U> other;
+         };
+
+         table_allocator()
+         : memory_(table_memory_hook())
+         {}
+
+         template <typename U>
+         table_allocator(const table_allocator<U>& allocator)
+         : memory_(allocator.memory())
+         {}
+
+         inline T* allocate(const std::size_t n)
+         {
+            return static_cast<T*>(memory_.allocate(n * sizeof(T)));
+         }
+
+         inline void deallocate(T* p, const std::size_t n)
+         {
+            memory_.deallocate(p, n * sizeof(T));
+         }
+
+         inline const table_memory& memory() const
+         {
+            return memory_;
+         }
+
+         template <typename U>
+         inline bool operator==(const table_allocator<U>& allocator) const
+         {
+            return memory_ == allocator.memory();
+         }
+
+         template <typename U>
+         inline bool operator!=(const table_allocator<U>& allocator) const
+         {
+            return memory_ != allocator.memory();
+         }
+
+      private:
+
+         table_memory memory_;
+      };
+
+      /*
+         Read a byte of every cache line of the size bytes at p, so that
+         the pages are faulted in and the lines are in the calling core's
+         caches (and, first touch being the default NUMA policy, pages
+         not yet faulted land on its node). With lock the pages are also
+         locked in RAM; false when that is refused, eg: over
+         RLIMIT_MEMLOCK, or not supported.
+      */
+      inline bool prefault(const void* p, const std::size_t size, const bool lock = false)
+      {
+         if ((0 == p) || (0 == size))
+            return true;
+
+         const volatile unsigned char* bytes = static_cast<const volatile unsigned char*>(p);
+
+         unsigned char sink = 0;
+
+         for (std::size_t i = 0; i < size; i += cache_line_size)
+         {
+            sink ^= bytes[i];
+         }
+
+         sink ^= bytes[size - 1];
+         (void)sink;
+
+         if (!lock)
+            return true;
+
+         #if defined(__linux__)
+         return (0 == mlock(p, size));
+         #else
+         return false;
+         #endif
+      }
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
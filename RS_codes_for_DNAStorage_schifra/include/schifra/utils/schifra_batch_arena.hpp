@@ -0,0 +1,152 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_BATCH_ARENA_HPP
+#define INCLUDE_SCHIFRA_BATCH_ARENA_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "schifra_memory_accounting.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Monotonic memory for the objects of one batch (strands, ECC sets,
+         decoded sequences and their scratch), to be given to std::pmr
+         containers. Allocation is a pointer bump and deallocation does
+         nothing; reset() frees the whole batch at once. The arena keeps one
+         buffer, grown at reset() to what the largest batch so far used, so
+         that once batches have reached their size they are served without
+         going to upstream at all.
+
+         Note: An arena is not thread safe, each thread keeps its own.
+      */
+      class batch_arena : public std::pmr::memory_resource
+      {
+      public:
+
+         explicit batch_arena(const std::size_t initial_size = 64 * 1024,
+                              std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+         : upstream_(upstream),
+           buffer_(std::max<std::size_t>(initial_size, 1)),
+           used_(0),
+           peak_(0),
+           charge_(memory::e_batch_arenas, buffer_.size())
+         {
+            start();
+         }
+
+         batch_arena(const batch_arena&) = delete;
+         batch_arena& operator=(const batch_arena&) = delete;
+
+         /*
+            Free everything allocated since the last reset(). Containers
+            still holding arena memory must be gone, or cleared and no
+            longer used.
+         */
+         inline void reset()
+         {
+            resource_.reset();
+
+            if (used_ > buffer_.size())
+            {
+               std::vector<unsigned char>().swap(buffer_);
+               buffer_.resize(used_ + used_ / 4);
+            }
+
+            charge_.resize(buffer_.size());
+
+            used_ = 0;
+            start();
+         }
+
+         /* Bytes handed out since the last reset() */
+         inline std::size_t used() const
+         {
+            return used_;
+         }
+
+         /* Most bytes any batch has used */
+         inline std::size_t peak() const
+         {
+            return peak_;
+         }
+
+         /* Size of the buffer served without upstream */
+         inline std::size_t capacity() const
+         {
+            return buffer_.size();
+         }
+
+      private:
+
+         inline void start()
+         {
+            resource_.emplace(buffer_.data(), buffer_.size(), upstream_);
+         }
+
+         void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+         {
+            void* p = resource_->allocate(bytes, alignment);
+            used_ += bytes;
+            peak_  = std::max(peak_, used_);
+
+            /* Past the buffer a batch is served by upstream */
+            if (used_ > charge_.bytes())
+               charge_.resize(used_);
+
+            return p;
+         }
+
+         void do_deallocate(void*, std::size_t, std::size_t) override
+         {}
+
+         bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+         {
+            return this == &other;
+         }
+
+         std::pmr::memory_resource* upstream_;
+         std::vector<unsigned char> buffer_;
+         std::optional<std::pmr::monotonic_buffer_resource> resource_;
+         std::size_t used_;
+         std::size_t peak_;
+         memory::charge charge_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+
+#endif
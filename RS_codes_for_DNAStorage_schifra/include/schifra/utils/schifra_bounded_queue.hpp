@@ -0,0 +1,147 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_BOUNDED_QUEUE_HPP
+#define INCLUDE_SCHIFRA_BOUNDED_QUEUE_HPP
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         A fixed capacity multi-producer multi-consumer queue. push()
+         blocks while the queue is full, which is what bounds the memory
+         of a pipeline, and pop() blocks while it is empty. Once closed,
+         push() fails and pop() drains what is left before failing.
+      */
+      template <typename T>
+      class bounded_queue
+      {
+      public:
+
+         explicit bounded_queue(const std::size_t capacity)
+         : capacity_((capacity > 0) ? capacity : 1),
+           closed_(false)
+         {}
+
+         inline bool push(const T& value)
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            not_full_.wait(lock, [this]() { return closed_ || (items_.size() < capacity_); });
+
+            if (closed_)
+               return false;
+
+            items_.push_back(value);
+
+            lock.unlock();
+            not_empty_.notify_one();
+
+            return true;
+         }
+
+         inline bool pop(T& value)
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+
+            if (items_.empty())
+               return false;
+
+            value = items_.front();
+            items_.pop_front();
+
+            lock.unlock();
+            not_full_.notify_one();
+
+            return true;
+         }
+
+         /* Non-blocking pop(), false when the queue is empty */
+         inline bool try_pop(T& value)
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (items_.empty())
+               return false;
+
+            value = items_.front();
+            items_.pop_front();
+
+            lock.unlock();
+            not_full_.notify_one();
+
+            return true;
+         }
+
+         inline void close()
+         {
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               closed_ = true;
+            }
+
+            not_empty_.notify_all();
+            not_full_ .notify_all();
+         }
+
+         inline std::size_t capacity() const
+         {
+            return capacity_;
+         }
+
+         /* Items currently queued, eg: exported as a pipeline depth gauge */
+         inline std::size_t size() const
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return items_.size();
+         }
+
+      private:
+
+         bounded_queue(const bounded_queue&);
+         bounded_queue& operator=(const bounded_queue&);
+
+         const std::size_t       capacity_;
+         bool                    closed_;
+         std::deque<T>           items_;
+         mutable std::mutex      mutex_;
+         std::condition_variable not_empty_;
+         std::condition_variable not_full_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,717 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_CHANNEL_SIMULATOR_HPP
+#define INCLUDE_SCHIFRA_CHANNEL_SIMULATOR_HPP
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_CHANNEL_X86
+   #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+   #define SCHIFRA_CHANNEL_NEON
+   #include <arm_neon.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace channel
+      {
+
+         /*
+            SplitMix64, used only to expand a 64 bit seed into generator
+            state, as recommended for the xoshiro family.
+         */
+         inline std::uint64_t splitmix64(std::uint64_t& state)
+         {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+         }
+
+         #if defined(__SIZEOF_INT128__)
+         __extension__ typedef unsigned __int128 uint128_t;
+         #endif
+
+         inline std::uint64_t rotl(const std::uint64_t x, const int k)
+         {
+            return (x << k) | (x >> (64 - k));
+         }
+
+         /*
+            xoshiro256++ (Blackman and Vigna), a UniformRandomBitGenerator
+            so it also drives the <random> distributions. jump() advances
+            2^128 steps: stream i of a seed is the seeded generator jumped
+            i times, so streams never overlap and a simulation gives the
+            same results however its work is spread over threads, as long
+            as each unit of work keeps its stream number.
+         */
+         class xoshiro256pp
+         {
+         public:
+
+            typedef std::uint64_t result_type;
+
+            explicit xoshiro256pp(const std::uint64_t seed = 0, const std::uint64_t stream = 0)
+            {
+               this->seed(seed, stream);
+            }
+
+            void seed(std::uint64_t seed, const std::uint64_t stream = 0)
+            {
+               for (int i = 0; i < 4; ++i)
+               {
+                  s_[i] = splitmix64(seed);
+               }
+
+               for (std::uint64_t i = 0; i < stream; ++i)
+               {
+                  jump();
+               }
+            }
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            inline result_type operator()()
+            {
+               const std::uint64_t result = rotl(s_[0] + s_[3], 23) + s_[0];
+               const std::uint64_t t      = s_[1] << 17;
+
+               s_[2] ^= s_[0];
+               s_[3] ^= s_[1];
+               s_[1] ^= s_[2];
+               s_[0] ^= s_[3];
+               s_[2] ^= t;
+               s_[3]  = rotl(s_[3], 45);
+
+               return result;
+            }
+
+            void jump()
+            {
+               static const std::uint64_t polynomial[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                                           0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+
+               std::uint64_t s[4] = { 0, 0, 0, 0 };
+
+               for (int i = 0; i < 4; ++i)
+               {
+                  for (int b = 0; b < 64; ++b)
+                  {
+                     if (polynomial[i] & (std::uint64_t(1) << b))
+                     {
+                        for (int j = 0; j < 4; ++j) s[j] ^= s_[j];
+                     }
+
+                     (*this)();
+                  }
+               }
+
+               for (int j = 0; j < 4; ++j) s_[j] = s[j];
+            }
+
+            const std::uint64_t* state() const { return s_; }
+
+         private:
+
+            std::uint64_t s_[4];
+         };
+
+         /*
+            PCG32 (O'Neill), XSH RR output: 32 bits per step from 64 bits
+            of state, for when a smaller generator is wanted. stream
+            selects one of 2^63 independent sequences of a seed.
+         */
+         class pcg32
+         {
+         public:
+
+            typedef std::uint32_t result_type;
+
+            explicit pcg32(const std::uint64_t seed = 0, const std::uint64_t stream = 0)
+            {
+               this->seed(seed, stream);
+            }
+
+            void seed(const std::uint64_t seed, const std::uint64_t stream = 0)
+            {
+               state_     = 0;
+               increment_ = (stream << 1) | 1;
+               (*this)();
+               state_ += seed;
+               (*this)();
+            }
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            inline result_type operator()()
+            {
+               const std::uint64_t old = state_;
+
+               state_ = old * 6364136223846793005ULL + increment_;
+
+               const std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+               const std::uint32_t rotation   = static_cast<std::uint32_t>(old >> 59);
+
+               return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+            }
+
+         private:
+
+            std::uint64_t state_;
+            std::uint64_t increment_;
+         };
+
+         /*
+            Four xoshiro256++ generators stepped together, lane l being
+            stream (4 * stream + l) of the seed. State is held word major,
+            s_[w][l], so one step is a handful of 256 bit (AVX2) or two
+            128 bit (NEON) operations. fill() writes the lanes' outputs
+            interleaved: out[4 * i + l] is lane l's i-th word.
+         */
+         class xoshiro256pp_x4
+         {
+         public:
+
+            static constexpr std::size_t lanes = 4;
+
+            explicit xoshiro256pp_x4(const std::uint64_t seed = 0, const std::uint64_t stream = 0)
+            {
+               this->seed(seed, stream);
+            }
+
+            void seed(const std::uint64_t seed, const std::uint64_t stream = 0)
+            {
+               xoshiro256pp lane(seed, lanes * stream);
+
+               for (std::size_t l = 0; l < lanes; ++l)
+               {
+                  for (std::size_t w = 0; w < 4; ++w)
+                  {
+                     s_[w][l] = lane.state()[w];
+                  }
+
+                  lane.jump();
+               }
+            }
+
+            /* count words, a multiple of lanes */
+            void fill(std::uint64_t* out, const std::size_t count)
+            {
+               std::size_t i = 0;
+
+               #if defined(SCHIFRA_CHANNEL_X86)
+               if (host_cpu_features().avx2)
+                  i = fill_avx2(out, count);
+               #elif defined(SCHIFRA_CHANNEL_NEON)
+               i = fill_neon(out, count);
+               #endif
+
+               for ( ; (i + lanes) <= count; i += lanes)
+               {
+                  for (std::size_t l = 0; l < lanes; ++l)
+                  {
+                     out[i + l] = rotl(s_[0][l] + s_[3][l], 23) + s_[0][l];
+
+                     const std::uint64_t t = s_[1][l] << 17;
+
+                     s_[2][l] ^= s_[0][l];
+                     s_[3][l] ^= s_[1][l];
+                     s_[1][l] ^= s_[2][l];
+                     s_[0][l] ^= s_[3][l];
+                     s_[2][l] ^= t;
+                     s_[3][l]  = rotl(s_[3][l], 45);
+                  }
+               }
+            }
+
+         private:
+
+            #if defined(SCHIFRA_CHANNEL_X86)
+
+            __attribute__((target("avx2")))
+            std::size_t fill_avx2(std::uint64_t* out, const std::size_t count)
+            {
+               __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_[0]));
+               __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_[1]));
+               __m256i s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_[2]));
+               __m256i s3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_[3]));
+
+               std::size_t i = 0;
+
+               for ( ; (i + lanes) <= count; i += lanes)
+               {
+                  const __m256i sum    = _mm256_add_epi64(s0, s3);
+                  const __m256i result = _mm256_add_epi64(_mm256_or_si256(_mm256_slli_epi64(sum, 23),
+                                                                          _mm256_srli_epi64(sum, 41)), s0);
+                  const __m256i t      = _mm256_slli_epi64(s1, 17);
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+
+                  s2 = _mm256_xor_si256(s2, s0);
+                  s3 = _mm256_xor_si256(s3, s1);
+                  s1 = _mm256_xor_si256(s1, s2);
+                  s0 = _mm256_xor_si256(s0, s3);
+                  s2 = _mm256_xor_si256(s2, t);
+                  s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+               }
+
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(s_[0]), s0);
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(s_[1]), s1);
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(s_[2]), s2);
+               _mm256_storeu_si256(reinterpret_cast<__m256i*>(s_[3]), s3);
+
+               return i;
+            }
+
+            #endif
+
+            #if defined(SCHIFRA_CHANNEL_NEON)
+
+            static inline uint64x2_t step_neon(uint64x2_t& s0, uint64x2_t& s1, uint64x2_t& s2, uint64x2_t& s3)
+            {
+               const uint64x2_t sum    = vaddq_u64(s0, s3);
+               const uint64x2_t result = vaddq_u64(vorrq_u64(vshlq_n_u64(sum, 23), vshrq_n_u64(sum, 41)), s0);
+               const uint64x2_t t      = vshlq_n_u64(s1, 17);
+
+               s2 = veorq_u64(s2, s0);
+               s3 = veorq_u64(s3, s1);
+               s1 = veorq_u64(s1, s2);
+               s0 = veorq_u64(s0, s3);
+               s2 = veorq_u64(s2, t);
+               s3 = vorrq_u64(vshlq_n_u64(s3, 45), vshrq_n_u64(s3, 19));
+
+               return result;
+            }
+
+            std::size_t fill_neon(std::uint64_t* out, const std::size_t count)
+            {
+               uint64x2_t a0 = vld1q_u64(s_[0]), b0 = vld1q_u64(s_[0] + 2);
+               uint64x2_t a1 = vld1q_u64(s_[1]), b1 = vld1q_u64(s_[1] + 2);
+               uint64x2_t a2 = vld1q_u64(s_[2]), b2 = vld1q_u64(s_[2] + 2);
+               uint64x2_t a3 = vld1q_u64(s_[3]), b3 = vld1q_u64(s_[3] + 2);
+
+               std::size_t i = 0;
+
+               for ( ; (i + lanes) <= count; i += lanes)
+               {
+                  vst1q_u64(out + i    , step_neon(a0, a1, a2, a3));
+                  vst1q_u64(out + i + 2, step_neon(b0, b1, b2, b3));
+               }
+
+               vst1q_u64(s_[0], a0); vst1q_u64(s_[0] + 2, b0);
+               vst1q_u64(s_[1], a1); vst1q_u64(s_[1] + 2, b1);
+               vst1q_u64(s_[2], a2); vst1q_u64(s_[2] + 2, b2);
+               vst1q_u64(s_[3], a3); vst1q_u64(s_[3] + 2, b3);
+
+               return i;
+            }
+
+            #endif
+
+            std::uint64_t s_[4][lanes];
+         };
+
+         /*
+            Channel error model, each process independent, rates per symbol:
+               substitution_rate : symbol replaced by a different one
+               erasure_rate      : symbol erased, ie: known to be lost
+               burst_rate        : a burst starts at the symbol, and
+                                   substitutes burst_length symbols (a
+                                   length drawn uniformly from
+                                   [1, burst_length] when random_burst_length)
+         */
+         struct channel_model
+         {
+            double      substitution_rate   = 0.0;
+            double      erasure_rate        = 0.0;
+            double      burst_rate          = 0.0;
+            std::size_t burst_length        = 8;
+            bool        random_burst_length = false;
+         };
+
+         /* What one corrupt_*() call did */
+         struct channel_stats
+         {
+            std::size_t substitutions = 0;
+            std::size_t erasures      = 0;
+            std::size_t bursts        = 0;
+
+            channel_stats& operator+=(const channel_stats& s)
+            {
+               substitutions += s.substitutions;
+               erasures      += s.erasures;
+               bursts        += s.bursts;
+               return *this;
+            }
+         };
+
+         /*
+            Error injection for Monte Carlo simulation of a code over a
+            channel, one per thread, seeded with (seed, stream) for
+            reproducible runs.
+
+            Rate models draw the gap to the next event from the geometric
+            distribution rather than flipping a coin per symbol, so their
+            cost is in the number of errors, not of symbols. The random
+            words behind positions and magnitudes are generated a buffer at
+            a time by the 4 lane xoshiro256++.
+
+            Bases are corrupted in place in ACGT text, erasures written as
+            'N'; symbols are symbol_bits wide values (eg: GF(2^m) symbols
+            one per byte), erasure positions reported separately.
+         */
+         class channel_simulator
+         {
+         public:
+
+            explicit channel_simulator(const channel_model& model = channel_model(),
+                                       const std::uint64_t seed = 0,
+                                       const std::uint64_t stream = 0)
+            : model_(model),
+              generator_(seed, stream),
+              next_(buffer_size)
+            {
+               set_model(model);
+            }
+
+            void set_model(const channel_model& model)
+            {
+               model_ = model;
+               substitution_scale_ = gap_scale(model_.substitution_rate);
+               erasure_scale_      = gap_scale(model_.erasure_rate     );
+               burst_scale_        = gap_scale(model_.burst_rate       );
+            }
+
+            const channel_model& model() const { return model_; }
+
+            void seed(const std::uint64_t seed, const std::uint64_t stream = 0)
+            {
+               generator_.seed(seed, stream);
+               next_ = buffer_size;
+            }
+
+            /* Next 64 random bits */
+            inline std::uint64_t next()
+            {
+               if (next_ == buffer_size)
+               {
+                  generator_.fill(buffer_, buffer_size);
+                  next_ = 0;
+               }
+
+               return buffer_[next_++];
+            }
+
+            /* Uniform in [0, range), multiply-shift (Lemire) rejection, range > 0 */
+            inline std::uint64_t bounded(const std::uint64_t range)
+            {
+               #if defined(__SIZEOF_INT128__)
+               uint128_t m = static_cast<uint128_t>(next()) * range;
+
+               if (static_cast<std::uint64_t>(m) < range)
+               {
+                  const std::uint64_t threshold = (0 - range) % range;
+
+                  while (static_cast<std::uint64_t>(m) < threshold)
+                  {
+                     m = static_cast<uint128_t>(next()) * range;
+                  }
+               }
+
+               return static_cast<std::uint64_t>(m >> 64);
+               #else
+               const std::uint64_t limit = max_value - (max_value % range);
+               std::uint64_t r;
+
+               do { r = next(); } while (r >= limit);
+
+               return r % range;
+               #endif
+            }
+
+            /* Uniform in (0, 1] */
+            inline double unit()
+            {
+               return static_cast<double>((next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+            }
+
+            /* Apply the model to length bases of ACGT text */
+            channel_stats corrupt_bases(char* bases, const std::size_t length,
+                                        std::vector<std::size_t>* erasures = 0)
+            {
+               channel_stats stats;
+
+               for_each_event(substitution_scale_, length, [&](const std::size_t i)
+               {
+                  substitute_base(bases[i]);
+                  ++stats.substitutions;
+               });
+
+               for_each_event(burst_scale_, length, [&](const std::size_t i)
+               {
+                  const std::size_t end = std::min(length, i + draw_burst_length());
+
+                  for (std::size_t j = i; j < end; ++j)
+                  {
+                     substitute_base(bases[j]);
+                  }
+
+                  stats.substitutions += end - i;
+                  ++stats.bursts;
+               });
+
+               for_each_event(erasure_scale_, length, [&](const std::size_t i)
+               {
+                  bases[i] = 'N';
+                  if (erasures) erasures->push_back(i);
+                  ++stats.erasures;
+               });
+
+               return stats;
+            }
+
+            /*
+               Apply the model to length symbols of symbol_bits (1 to 8)
+               bits each. An erased symbol is zeroed.
+            */
+            channel_stats corrupt_symbols(std::uint8_t* symbols, const std::size_t length,
+                                          const unsigned int symbol_bits,
+                                          std::vector<std::size_t>* erasures = 0)
+            {
+               channel_stats stats;
+
+               const std::uint64_t nonzero = (std::uint64_t(1) << symbol_bits) - 1;
+
+               for_each_event(substitution_scale_, length, [&](const std::size_t i)
+               {
+                  symbols[i] ^= static_cast<std::uint8_t>(1 + bounded(nonzero));
+                  ++stats.substitutions;
+               });
+
+               for_each_event(burst_scale_, length, [&](const std::size_t i)
+               {
+                  const std::size_t end = std::min(length, i + draw_burst_length());
+
+                  for (std::size_t j = i; j < end; ++j)
+                  {
+                     symbols[j] ^= static_cast<std::uint8_t>(1 + bounded(nonzero));
+                  }
+
+                  stats.substitutions += end - i;
+                  ++stats.bursts;
+               });
+
+               for_each_event(erasure_scale_, length, [&](const std::size_t i)
+               {
+                  symbols[i] = 0;
+                  if (erasures) erasures->push_back(i);
+                  ++stats.erasures;
+               });
+
+               return stats;
+            }
+
+            /*
+               Substitute exactly errors distinct bases in each of blocks
+               blocks of block_length bases, block b starting at
+               bases + b * stride. Returns the substitutions made.
+            */
+            std::size_t corrupt_bases_fixed(char* bases, const std::size_t block_length, const std::size_t stride,
+                                            const std::size_t blocks, const std::size_t errors)
+            {
+               const std::size_t count = std::min(errors, block_length);
+
+               for (std::size_t b = 0; b < blocks; ++b)
+               {
+                  char* block = bases + b * stride;
+
+                  draw_positions(block_length, count, [&](const std::size_t i) { substitute_base(block[i]); });
+               }
+
+               return count * blocks;
+            }
+
+            /* corrupt_bases_fixed() over symbols of symbol_bits bits */
+            std::size_t corrupt_symbols_fixed(std::uint8_t* symbols, const std::size_t block_length, const std::size_t stride,
+                                              const std::size_t blocks, const std::size_t errors,
+                                              const unsigned int symbol_bits)
+            {
+               const std::size_t   count   = std::min(errors, block_length);
+               const std::uint64_t nonzero = (std::uint64_t(1) << symbol_bits) - 1;
+
+               for (std::size_t b = 0; b < blocks; ++b)
+               {
+                  std::uint8_t* block = symbols + b * stride;
+
+                  draw_positions(block_length, count, [&](const std::size_t i)
+                  {
+                     block[i] ^= static_cast<std::uint8_t>(1 + bounded(nonzero));
+                  });
+               }
+
+               return count * blocks;
+            }
+
+         private:
+
+            static constexpr std::size_t   buffer_size = 256;
+            static constexpr std::uint64_t max_value   = std::numeric_limits<std::uint64_t>::max();
+
+            /*
+               1 / ln(1 - p): the gap to the next event of a per symbol
+               rate p is floor(ln(u) * scale), u uniform in (0, 1]. 0 for
+               p <= 0, no events, and -0.0 for p >= 1, every symbol.
+            */
+            static double gap_scale(const double rate)
+            {
+               if (!(rate > 0.0)) return 0.0;
+               if (rate >= 1.0)   return -0.0;
+               return 1.0 / std::log1p(-rate);
+            }
+
+            template <typename Event>
+            inline void for_each_event(const double scale, const std::size_t length, Event event)
+            {
+               if (0.0 == scale)
+               {
+                  if (!std::signbit(scale))
+                     return;
+
+                  for (std::size_t i = 0; i < length; ++i) event(i);
+
+                  return;
+               }
+
+               std::size_t i = 0;
+
+               for ( ; ; )
+               {
+                  const double gap = std::floor(std::log(unit()) * scale);
+
+                  if (gap >= static_cast<double>(length - i))
+                     return;
+
+                  i += static_cast<std::size_t>(gap);
+
+                  event(i++);
+
+                  if (i >= length)
+                     return;
+               }
+            }
+
+            inline std::size_t draw_burst_length()
+            {
+               if (!model_.random_burst_length || (model_.burst_length <= 1))
+                  return std::max<std::size_t>(model_.burst_length, 1);
+
+               return 1 + static_cast<std::size_t>(bounded(model_.burst_length));
+            }
+
+            /* A different base, '\0' kept for anything not ACGTacgt */
+            inline void substitute_base(char& base)
+            {
+               static const char symbol_base[] = { 'A', 'C', 'G', 'T' };
+
+               int s;
+
+               switch (base)
+               {
+                  case 'A' : case 'a' : s = 0; break;
+                  case 'C' : case 'c' : s = 1; break;
+                  case 'G' : case 'g' : s = 2; break;
+                  case 'T' : case 't' : s = 3; break;
+                  default  : base = symbol_base[bounded(4)]; return;
+               }
+
+               base = symbol_base[(s + 1 + static_cast<int>(bounded(3))) & 3];
+            }
+
+            /*
+               count distinct positions of [0, length): Floyd's sampling,
+               count draws whatever the overlap, positions held in a small
+               sorted list.
+            */
+            template <typename Visit>
+            inline void draw_positions(const std::size_t length, const std::size_t count, Visit visit)
+            {
+               chosen_.clear();
+
+               for (std::size_t j = length - count; j < length; ++j)
+               {
+                  std::size_t t = static_cast<std::size_t>(bounded(j + 1));
+
+                  std::vector<std::size_t>::iterator itr = std::lower_bound(chosen_.begin(), chosen_.end(), t);
+
+                  if ((itr != chosen_.end()) && (*itr == t))
+                  {
+                     t   = j;
+                     itr = chosen_.end();
+                  }
+
+                  chosen_.insert(itr, t);
+               }
+
+               for (std::size_t k = 0; k < chosen_.size(); ++k)
+               {
+                  visit(chosen_[k]);
+               }
+            }
+
+            channel_model            model_;
+            double                   substitution_scale_;
+            double                   erasure_scale_;
+            double                   burst_scale_;
+            xoshiro256pp_x4          generator_;
+            std::uint64_t            buffer_[buffer_size];
+            std::size_t              next_;
+            std::vector<std::size_t> chosen_;
+         };
+
+      } // namespace channel
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
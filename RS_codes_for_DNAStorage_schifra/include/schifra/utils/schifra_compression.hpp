@@ -0,0 +1,199 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_SCHIFRA_COMPRESSION_HPP
+#define INCLUDE_SCHIFRA_COMPRESSION_HPP
+
+
+#include <cstddef>
+#include <cstring>
+
+#include "schifra/utils/schifra_trace.hpp"
+
+#ifdef SCHIFRA_WITH_ZSTD
+   #include <zstd.h>
+#endif
+
+#ifdef SCHIFRA_WITH_LZ4
+   #include <lz4.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace compression
+   {
+
+      /*
+         Per chunk compression ahead of encoding. A compressed chunk, or
+         payload, is one codec byte followed by the codec's output. A
+         chunk that a codec does not shrink is stored as it is, so a
+         payload is never more than one byte larger than its chunk.
+
+         zstd and LZ4 are built in when SCHIFRA_WITH_ZSTD and
+         SCHIFRA_WITH_LZ4 are defined and the libraries are linked, as the
+         CMake options of the same names do when the libraries are found.
+      */
+      enum codec
+      {
+         stored = 0,
+         zstd   = 1,
+         lz4    = 2
+      };
+
+      static const int default_level = 3;
+
+      inline bool available(const codec c)
+      {
+         switch (c)
+         {
+            case stored : return true;
+            #ifdef SCHIFRA_WITH_ZSTD
+            case zstd   : return true;
+            #endif
+            #ifdef SCHIFRA_WITH_LZ4
+            case lz4    : return true;
+            #endif
+            default     : return false;
+         }
+      }
+
+      /* The largest payload of a size byte chunk */
+      inline std::size_t payload_bound(const std::size_t size)
+      {
+         return size + 1;
+      }
+
+      /*
+         Compress the size bytes of input with c at level (zstd only),
+         writing the payload to output, of at least payload_bound(size)
+         bytes. Returns the payload's size.
+      */
+      inline std::size_t compress(const codec c,
+                                  const unsigned char* input,
+                                  const std::size_t size,
+                                  unsigned char* output,
+                                  const int level = default_level)
+      {
+         utils::trace::scope trace(utils::trace::e_compression, "compress", static_cast<std::int64_t>(size));
+
+         std::size_t compressed = 0;
+
+         switch (c)
+         {
+            #ifdef SCHIFRA_WITH_ZSTD
+            case zstd : {
+                           const std::size_t result = ZSTD_compress(output + 1, size, input, size, level);
+
+                           if (!ZSTD_isError(result))
+                              compressed = result;
+                        }
+                        break;
+            #endif
+
+            #ifdef SCHIFRA_WITH_LZ4
+            case lz4  : {
+                           const int result = LZ4_compress_default(reinterpret_cast<const char*>(input),
+                                                                   reinterpret_cast<char*>(output + 1),
+                                                                   static_cast<int>(size),
+                                                                   static_cast<int>(size));
+
+                           if (result > 0)
+                              compressed = static_cast<std::size_t>(result);
+                        }
+                        break;
+            #endif
+
+            default   : break;
+         }
+
+         (void)level;
+
+         if ((compressed > 0) && (compressed < size))
+         {
+            output[0] = static_cast<unsigned char>(c);
+            return compressed + 1;
+         }
+
+         output[0] = static_cast<unsigned char>(stored);
+
+         if (size > 0)
+            std::memcpy(output + 1, input, size);
+
+         return size + 1;
+      }
+
+      /*
+         Expand the payload_size bytes of payload into exactly size bytes
+         of output. False when its codec is not built in or the payload
+         does not expand to size bytes, eg: it was corrupted.
+      */
+      inline bool decompress(const unsigned char* payload,
+                             const std::size_t payload_size,
+                             unsigned char* output,
+                             const std::size_t size)
+      {
+         utils::trace::scope trace(utils::trace::e_compression, "decompress", static_cast<std::int64_t>(size));
+
+         if (0 == payload_size)
+            return false;
+
+         const unsigned char* data   = payload + 1;
+         const std::size_t    amount = payload_size - 1;
+
+         switch (payload[0])
+         {
+            case stored : if (amount != size)
+                             return false;
+
+                          if (size > 0)
+                             std::memcpy(output, data, size);
+
+                          return true;
+
+            #ifdef SCHIFRA_WITH_ZSTD
+            case zstd   : {
+                             const std::size_t result = ZSTD_decompress(output, size, data, amount);
+
+                             return !ZSTD_isError(result) && (result == size);
+                          }
+            #endif
+
+            #ifdef SCHIFRA_WITH_LZ4
+            case lz4    : return (LZ4_decompress_safe(reinterpret_cast<const char*>(data),
+                                                      reinterpret_cast<char*>(output),
+                                                      static_cast<int>(amount),
+                                                      static_cast<int>(size)) == static_cast<int>(size));
+            #endif
+
+            default     : return false;
+         }
+      }
+
+   } // namespace compression
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,105 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_CPU_FEATURES_HPP
+#define INCLUDE_SCHIFRA_CPU_FEATURES_HPP
+
+
+#if defined(__aarch64__) && defined(__linux__)
+   #include <sys/auxv.h>
+   #include <asm/hwcap.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      struct cpu_features
+      {
+         bool ssse3;
+         bool sse42;
+         bool pclmul;
+         bool avx2;
+         bool avx512bw;
+         bool gfni;
+         bool vpclmul;
+         bool neon;
+         bool pmull;
+         bool crc32;
+         bool sve;
+         bool sve2;
+      };
+
+      namespace details
+      {
+         inline cpu_features probe_cpu_features()
+         {
+            cpu_features f = { false, false, false, false, false, false,
+                               false, false, false, false, false, false };
+
+            #if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            f.ssse3    = __builtin_cpu_supports("ssse3");
+            f.sse42    = __builtin_cpu_supports("sse4.2");
+            f.pclmul   = __builtin_cpu_supports("pclmul");
+            f.avx2     = __builtin_cpu_supports("avx2");
+            f.avx512bw = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+            f.gfni     = __builtin_cpu_supports("gfni");
+            f.vpclmul  = __builtin_cpu_supports("vpclmulqdq");
+            #elif defined(__aarch64__)
+            f.neon = true;
+               #if defined(__linux__)
+               const unsigned long hwcap  = getauxval(AT_HWCAP);
+               const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+               f.pmull = (0 != (hwcap  & HWCAP_PMULL));
+               f.crc32 = (0 != (hwcap  & HWCAP_CRC32));
+               f.sve   = (0 != (hwcap  & HWCAP_SVE  ));
+               #if defined(HWCAP2_SVE2)
+               f.sve2  = (0 != (hwcap2 & HWCAP2_SVE2));
+               #else
+               (void)hwcap2;
+               #endif
+               #endif
+            #endif
+
+            return f;
+         }
+
+      } // namespace details
+
+      /*
+         Features of the running cpu, probed once on first use.
+      */
+      inline const cpu_features& host_cpu_features()
+      {
+         static const cpu_features features = details::probe_cpu_features();
+         return features;
+      }
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,342 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_CPU_TOPOLOGY_HPP
+#define INCLUDE_SCHIFRA_CPU_TOPOLOGY_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#define SCHIFRA_CPU_AFFINITY
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Logical cpus the process may run on, with the socket (package),
+         physical core and NUMA node of each, as reported by sysfs. Where
+         sysfs or affinity control is missing (non-Linux, containers with
+         /sys hidden) every cpu is put on socket, core and node 0 and
+         pinning is a no-op, so callers need not special case it.
+      */
+      struct logical_cpu
+      {
+         int id;
+         int socket;
+         int core;
+         int node;
+         int smt_index;   /* 0 for the first hardware thread of its core */
+      };
+
+      class cpu_topology
+      {
+      public:
+
+         enum placement_t
+         {
+            e_none    = 0,   /* leave placement to the scheduler                       */
+            e_compact = 1,   /* fill a socket, its cores then their SMT siblings, first */
+            e_scatter = 2    /* spread round-robin over sockets, then cores, then SMT   */
+         };
+
+         cpu_topology()
+         {
+            std::vector<int> allowed;
+
+            #ifdef SCHIFRA_CPU_AFFINITY
+            cpu_set_t set;
+            CPU_ZERO(&set);
+
+            if (0 == sched_getaffinity(0, sizeof(set), &set))
+            {
+               for (int c = 0; c < CPU_SETSIZE; ++c)
+               {
+                  if (CPU_ISSET(c, &set)) allowed.push_back(c);
+               }
+            }
+            #endif
+
+            if (allowed.empty())
+            {
+               const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+               for (int c = 0; c < count; ++c)
+               {
+                  allowed.push_back(c);
+               }
+            }
+
+            const std::vector<int> node_of = read_node_map();
+
+            for (std::size_t i = 0; i < allowed.size(); ++i)
+            {
+               const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(allowed[i]) + "/topology/";
+
+               logical_cpu cpu;
+
+               cpu.id        = allowed[i];
+               cpu.socket    = std::max(0, read_int(base + "physical_package_id", 0));
+               cpu.core      = std::max(0, read_int(base + "core_id"            , allowed[i]));
+               cpu.node      = (static_cast<std::size_t>(allowed[i]) < node_of.size()) ? node_of[allowed[i]] : 0;
+               cpu.smt_index = 0;
+
+               cpus_.push_back(cpu);
+            }
+
+            /* SMT index: rank of the cpu among those sharing its socket and core */
+            for (std::size_t i = 0; i < cpus_.size(); ++i)
+            {
+               for (std::size_t j = 0; j < cpus_.size(); ++j)
+               {
+                  if ((cpus_[j].socket == cpus_[i].socket) && (cpus_[j].core == cpus_[i].core) && (cpus_[j].id < cpus_[i].id))
+                     ++cpus_[i].smt_index;
+               }
+            }
+         }
+
+         inline const std::vector<logical_cpu>& cpus() const
+         {
+            return cpus_;
+         }
+
+         inline std::size_t socket_count() const
+         {
+            int top = 0;
+
+            for (std::size_t i = 0; i < cpus_.size(); ++i)
+            {
+               top = std::max(top, cpus_[i].socket);
+            }
+
+            return static_cast<std::size_t>(top) + 1;
+         }
+
+         /*
+            The cpus in the order threads 0, 1, 2, ... should be pinned to
+            for the given placement, e_none keeping the sysfs order.
+         */
+         std::vector<logical_cpu> order(const placement_t placement) const
+         {
+            std::vector<logical_cpu> result = cpus_;
+
+            if (e_compact == placement)
+            {
+               std::stable_sort(result.begin(), result.end(),
+                                [](const logical_cpu& a, const logical_cpu& b)
+                                {
+                                   if (a.socket    != b.socket   ) return a.socket    < b.socket;
+                                   if (a.smt_index != b.smt_index) return a.smt_index < b.smt_index;
+                                   return a.core < b.core;
+                                });
+            }
+            else if (e_scatter == placement)
+            {
+               /* Rank of each cpu within its socket, sockets then interleaved by rank */
+               std::vector<logical_cpu> compact = order(e_compact);
+               std::vector<std::size_t> rank(compact.size(), 0);
+
+               for (std::size_t i = 0; i < compact.size(); ++i)
+               {
+                  for (std::size_t j = 0; j < i; ++j)
+                  {
+                     if (compact[j].socket == compact[i].socket) ++rank[i];
+                  }
+               }
+
+               std::vector<std::size_t> index(compact.size());
+
+               for (std::size_t i = 0; i < index.size(); ++i)
+               {
+                  index[i] = i;
+               }
+
+               std::stable_sort(index.begin(), index.end(),
+                                [&](const std::size_t a, const std::size_t b)
+                                {
+                                   if (rank[a] != rank[b]) return rank[a] < rank[b];
+                                   return compact[a].socket < compact[b].socket;
+                                });
+
+               for (std::size_t i = 0; i < index.size(); ++i)
+               {
+                  result[i] = compact[index[i]];
+               }
+            }
+
+            return result;
+         }
+
+         /* First cpu of NUMA node, or -1 when the node has none the process may use */
+         inline int first_cpu_of_node(const int node) const
+         {
+            for (std::size_t i = 0; i < cpus_.size(); ++i)
+            {
+               if (cpus_[i].node == node) return cpus_[i].id;
+            }
+
+            return -1;
+         }
+
+         /* NUMA node of cpu, 0 when it is not one the process may use */
+         inline int node_of(const int cpu) const
+         {
+            for (std::size_t i = 0; i < cpus_.size(); ++i)
+            {
+               if (cpus_[i].id == cpu) return cpus_[i].node;
+            }
+
+            return 0;
+         }
+
+         inline std::size_t node_count() const
+         {
+            int top = 0;
+
+            for (std::size_t i = 0; i < cpus_.size(); ++i)
+            {
+               top = std::max(top, cpus_[i].node);
+            }
+
+            return static_cast<std::size_t>(top) + 1;
+         }
+
+         /* cpu the calling thread is running on, or -1 when unknown */
+         static inline int current_cpu()
+         {
+            #ifdef SCHIFRA_CPU_AFFINITY
+            return sched_getcpu();
+            #else
+            return -1;
+            #endif
+         }
+
+         /* Pin the calling thread to cpu, returns false when that is not possible */
+         static inline bool pin_current_thread(const int cpu)
+         {
+            #ifdef SCHIFRA_CPU_AFFINITY
+            if ((cpu < 0) || (cpu >= CPU_SETSIZE))
+               return false;
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+
+            return (0 == sched_setaffinity(0, sizeof(set), &set));
+            #else
+            (void)cpu;
+            return false;
+            #endif
+         }
+
+         static inline const char* placement_name(const placement_t placement)
+         {
+            switch (placement)
+            {
+               case e_compact : return "compact";
+               case e_scatter : return "scatter";
+               default        : return "none";
+            }
+         }
+
+      private:
+
+         static inline int read_int(const std::string& file_name, const int default_value)
+         {
+            std::ifstream in(file_name.c_str());
+            int value = default_value;
+
+            if (!(in >> value))
+               return default_value;
+
+            return value;
+         }
+
+         /*
+            cpu -> node from the cpulist of each /sys/devices/system/node/nodeN,
+            eg: "0-3,8-11".
+         */
+         static std::vector<int> read_node_map()
+         {
+            std::vector<int> node_of;
+
+            for (int node = 0; node < 1024; ++node)
+            {
+               std::ifstream in(("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist").c_str());
+
+               if (!in)
+               {
+                  if (node > 0) break; else continue;
+               }
+
+               std::string list;
+               std::getline(in, list);
+
+               std::size_t pos = 0;
+
+               while (pos < list.size())
+               {
+                  const std::size_t comma = std::min(list.find(',', pos), list.size());
+                  const std::string range = list.substr(pos, comma - pos);
+                  const std::size_t dash  = range.find('-');
+
+                  if (!range.empty())
+                  {
+                     const int first = std::atoi(range.c_str());
+                     const int last  = (std::string::npos == dash) ? first : std::atoi(range.c_str() + dash + 1);
+
+                     for (int c = first; c <= last; ++c)
+                     {
+                        if (static_cast<std::size_t>(c) >= node_of.size())
+                           node_of.resize(c + 1, 0);
+
+                        node_of[c] = node;
+                     }
+                  }
+
+                  pos = comma + 1;
+               }
+            }
+
+            return node_of;
+         }
+
+         std::vector<logical_cpu> cpus_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
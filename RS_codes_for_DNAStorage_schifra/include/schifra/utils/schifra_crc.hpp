@@ -24,25 +24,81 @@
 #define INCLUDE_SCHIFRA_CRC_HPP
 
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_CRC_X86
+   #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+   #define SCHIFRA_CRC_ARM_CRC32
+   #include <arm_acle.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_AES)
+   #define SCHIFRA_CRC_PMULL
+   #include <arm_neon.h>
+#endif
 
 
 namespace schifra
 {
 
+   /*
+      Reflected table driven CRC, key being the reversed polynomial (eg:
+      0xEDB88320 for the zlib CRC-32), the key and the state both fitting
+      in 32 bits. update() consumes one byte per table lookup by default,
+      or 8 or 16 bytes per round of lookups with slicing-by-8/16, whose 8
+      or 16 tables of 256 entries are built up front.
+
+      e_hardware uses the cpu's CRC instructions where they implement the
+      key (SSE4.2 for CRC-32C, ARMv8 for CRC-32C and the zlib CRC-32), and
+      otherwise folds 64 bytes at a time with carry-less multiplies
+      (PCLMULQDQ or PMULL), which works for any key. Whatever is left, or
+      everything on a cpu with neither, goes through slicing-by-16. All
+      modes produce the same state.
+   */
    class crc32
    {
    public:
 
       typedef std::size_t crc32_t;
 
-      crc32(const crc32_t& _key, const crc32_t& _state = 0x00)
+      enum slicing_mode
+      {
+         e_slice_by_1  =  1,
+         e_slice_by_8  =  8,
+         e_slice_by_16 = 16,
+         e_hardware    = 17
+      };
+
+      static constexpr crc32_t crc32c_key = 0x82F63B78;
+      static constexpr crc32_t zlib_key   = 0xEDB88320;
+
+      crc32(const crc32_t& _key, const crc32_t& _state = 0x00, const slicing_mode _slicing = e_slice_by_1)
       : key(_key),
         state(_state),
-        initial_state(_state)
+        initial_state(_state),
+        slicing(_slicing),
+        instruction(e_no_instruction),
+        folding(false)
       {
          initialize_crc32_table();
+
+         if (e_hardware == slicing)
+         {
+            initialize_hardware();
+         }
       }
 
       void reset()
@@ -52,31 +108,22 @@ namespace schifra
 
       void update_1byte(const unsigned char data)
       {
-         state = (state >> 8) ^ table[data];
+         state = (state >> 8) ^ table[(state ^ data) & 0xFF];
       }
 
       void update(const unsigned char data[], const std::size_t& count)
       {
-         for (std::size_t i = 0; i < count; ++i)
-         {
-            update_1byte(data[i]);
-         }
+         state = process(state, data, count);
       }
 
       void update(char data[], const std::size_t& count)
       {
-         for (std::size_t i = 0; i < count; ++i)
-         {
-            update_1byte(static_cast<unsigned char>(data[i]));
-         }
+         state = process(state, reinterpret_cast<const unsigned char*>(data), count);
       }
 
       void update(const std::string& data)
       {
-         for (std::size_t i = 0; i < data.size(); ++i)
-         {
-            update_1byte(static_cast<unsigned char>(data[i]));
-         }
+         state = process(state, reinterpret_cast<const unsigned char*>(data.data()), data.size());
       }
 
       void update(const std::size_t& data)
@@ -92,13 +139,232 @@ namespace schifra
          return state;
       }
 
+      /*
+         The state after count bytes of data starting from crc_state,
+         leaving the instance's own state untouched, so that a single
+         const instance (ie: its tables) can be shared between threads.
+      */
+      crc32_t process(crc32_t crc_state, const unsigned char* data, std::size_t count) const
+      {
+         if (e_hardware == slicing)
+         {
+            #if defined(SCHIFRA_CRC_X86)
+            if (e_sse42_crc32c == instruction)
+               return process_sse42(crc_state, data, count);
+            else if (folding && (count >= 64))
+               crc_state = process_pclmul(crc_state, data, count);
+            #endif
+
+            #if defined(SCHIFRA_CRC_ARM_CRC32)
+            if (e_no_instruction != instruction)
+               return process_arm_crc32(crc_state, data, count);
+            #endif
+
+            #if defined(SCHIFRA_CRC_PMULL)
+            if (folding && (count >= 64))
+               crc_state = process_pmull(crc_state, data, count);
+            #endif
+         }
+
+         if ((e_slice_by_16 == slicing) || (e_hardware == slicing))
+         {
+            for (; count >= 16; count -= 16, data += 16)
+            {
+               crc_state = slice_round(crc_state, data, 16);
+            }
+         }
+         else if (e_slice_by_8 == slicing)
+         {
+            for (; count >= 8; count -= 8, data += 8)
+            {
+               crc_state = slice_round(crc_state, data, 8);
+            }
+         }
+
+         for (std::size_t i = 0; i < count; ++i)
+         {
+            crc_state = (crc_state >> 8) ^ table[(crc_state ^ data[i]) & 0xFF];
+         }
+
+         return crc_state;
+      }
+
+      /*
+         The state after count zero bytes starting from crc_state. Feeding
+         a zero byte is linear over GF(2), ie: a 32x32 bit matrix, which
+         is raised to the count'th power by repeated squaring, so the cost
+         is logarithmic in count.
+      */
+      crc32_t shift(const crc32_t crc_state, std::size_t count) const
+      {
+         std::uint32_t power[32];
+         std::uint32_t square[32];
+
+         /* Note: Column i of the one zero byte operator is its image of bit i */
+         for (std::size_t i = 0; i < 32; ++i)
+         {
+            const std::uint32_t v = static_cast<std::uint32_t>(1) << i;
+            power[i] = (v >> 8) ^ static_cast<std::uint32_t>(table[v & 0xFF]);
+         }
+
+         std::uint32_t result = static_cast<std::uint32_t>(crc_state);
+
+         while (count > 0)
+         {
+            if (count & 1)
+               result = gf2_matrix_times(power, result);
+
+            count >>= 1;
+
+            if (count > 0)
+            {
+               gf2_matrix_square(square, power);
+               std::memcpy(power, square, sizeof(power));
+            }
+         }
+
+         return static_cast<crc32_t>(result);
+      }
+
+      /*
+         The state over A followed by B, from state_a over A and state_b
+         over len_b bytes of B, both having started from the initial state
+         of this instance. This lets chunks be checksummed independently
+         and merged afterwards.
+      */
+      inline crc32_t combine(const crc32_t state_a, const crc32_t state_b, const std::size_t len_b) const
+      {
+         return shift(state_a ^ initial_state, len_b) ^ state_b;
+      }
+
+      /*
+         process() with the data split across thread_count threads (0 for
+         one per core), the per thread states merged with shift(). Buffers
+         under thread_count * min_thread_bytes use fewer threads.
+      */
+      crc32_t process(const crc32_t crc_state,
+                      const unsigned char* data,
+                      const std::size_t count,
+                      std::size_t thread_count,
+                      const std::size_t min_thread_bytes = 1024 * 1024) const
+      {
+         if (0 == thread_count)
+            thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+         thread_count = std::min(thread_count, std::max<std::size_t>(1, count / std::max<std::size_t>(1, min_thread_bytes)));
+
+         if (thread_count <= 1)
+            return process(crc_state, data, count);
+
+         const std::size_t piece = count / thread_count;
+
+         std::vector<crc32_t>     states(thread_count, 0);
+         std::vector<std::thread> threads;
+
+         for (std::size_t t = 1; t < thread_count; ++t)
+         {
+            const std::size_t piece_size = (t + 1 == thread_count) ? (count - t * piece) : piece;
+
+            threads.push_back(std::thread([this, &states, data, piece, piece_size, t]()
+                                          {
+                                             states[t] = process(0, data + t * piece, piece_size);
+                                          }));
+         }
+
+         /* Note: process(s, A || B) == shift(process(s, A), |B|) ^ process(0, B) */
+         crc32_t result = process(crc_state, data, piece);
+
+         for (std::size_t t = 1; t < thread_count; ++t)
+         {
+            threads[t - 1].join();
+
+            const std::size_t piece_size = (t + 1 == thread_count) ? (count - t * piece) : piece;
+
+            result = shift(result, piece_size) ^ states[t];
+         }
+
+         return result;
+      }
+
+      /* True when process() has a hardware path, e_hardware only */
+      inline bool hardware() const
+      {
+         return (e_no_instruction != instruction) || folding;
+      }
+
    private:
 
       crc32& operator=(const crc32&);
 
+      static inline std::uint32_t gf2_matrix_times(const std::uint32_t matrix[32], std::uint32_t vector)
+      {
+         std::uint32_t result = 0;
+
+         for (std::size_t i = 0; vector; ++i, vector >>= 1)
+         {
+            if (vector & 1)
+               result ^= matrix[i];
+         }
+
+         return result;
+      }
+
+      static inline void gf2_matrix_square(std::uint32_t square[32], const std::uint32_t matrix[32])
+      {
+         for (std::size_t i = 0; i < 32; ++i)
+         {
+            square[i] = gf2_matrix_times(matrix, matrix[i]);
+         }
+      }
+
+      enum instruction_t
+      {
+         e_no_instruction = 0,
+         e_sse42_crc32c   = 1,
+         e_arm_crc32c     = 2,
+         e_arm_crc32      = 3
+      };
+
+      static inline std::uint32_t load32(const unsigned char* data)
+      {
+         return  static_cast<std::uint32_t>(data[0])        |
+                (static_cast<std::uint32_t>(data[1]) <<  8) |
+                (static_cast<std::uint32_t>(data[2]) << 16) |
+                (static_cast<std::uint32_t>(data[3]) << 24) ;
+      }
+
+      /*
+         One round of slicing-by-n (n = 8 or 16): the state is folded into
+         the first four bytes, and byte i of the round is looked up in
+         slice n - 1 - i, which advances it over the bytes that follow.
+      */
+      inline crc32_t slice_round(const crc32_t crc_state, const unsigned char* data, const std::size_t n) const
+      {
+         const std::uint32_t* slice = &slice_table[0];
+
+         const std::uint32_t first = load32(data) ^ static_cast<std::uint32_t>(crc_state);
+
+         std::uint32_t result = slice[(n - 1) * 256 + ( first        & 0xFF)] ^
+                                slice[(n - 2) * 256 + ((first >>  8) & 0xFF)] ^
+                                slice[(n - 3) * 256 + ((first >> 16) & 0xFF)] ^
+                                slice[(n - 4) * 256 + ((first >> 24) & 0xFF)] ;
+
+         for (std::size_t i = 4; i < n; i += 4)
+         {
+            const std::uint32_t word = load32(data + i);
+
+            result ^= slice[(n - 1 - i) * 256 + ( word        & 0xFF)] ^
+                      slice[(n - 2 - i) * 256 + ((word >>  8) & 0xFF)] ^
+                      slice[(n - 3 - i) * 256 + ((word >> 16) & 0xFF)] ^
+                      slice[(n - 4 - i) * 256 + ((word >> 24) & 0xFF)] ;
+         }
+
+         return result;
+      }
+
       void initialize_crc32_table()
       {
-         for (std::size_t i = 0; i < 0xFF; ++i)
+         for (std::size_t i = 0; i < 256; ++i)
          {
             crc32_t reg = i;
 
@@ -109,14 +375,277 @@ namespace schifra
 
             table[i] = reg;
          }
+
+         if (e_slice_by_1 == slicing)
+            return;
+
+         const std::size_t slices = (e_hardware == slicing) ? 16 : static_cast<std::size_t>(slicing);
+
+         /* Note: Slice k advances a byte over k further zero bytes */
+         slice_table.resize(slices * 256);
+
+         for (std::size_t i = 0; i < 256; ++i)
+         {
+            slice_table[i] = static_cast<std::uint32_t>(table[i]);
+         }
+
+         for (std::size_t k = 1; k < slices; ++k)
+         {
+            for (std::size_t i = 0; i < 256; ++i)
+            {
+               const std::uint32_t previous = slice_table[(k - 1) * 256 + i];
+
+               slice_table[k * 256 + i] = (previous >> 8) ^ static_cast<std::uint32_t>(table[previous & 0xFF]);
+            }
+         }
+      }
+
+
+      /* x^n mod P, P being the (unreflected) polynomial of the key */
+      inline std::uint32_t xpow_mod(std::size_t n) const
+      {
+         std::uint32_t polynomial = 0;
+
+         for (std::size_t i = 0; i < 32; ++i)
+         {
+            if (key & (static_cast<crc32_t>(1) << i))
+               polynomial |= static_cast<std::uint32_t>(1) << (31 - i);
+         }
+
+         std::uint32_t remainder = 1;
+
+         for (; n > 0; --n)
+         {
+            remainder = (remainder & 0x80000000) ? ((remainder << 1) ^ polynomial) : (remainder << 1);
+         }
+
+         return remainder;
       }
 
+      /* A remainder as the 64-bit reflected operand of a carry-less multiply */
+      static inline std::uint64_t reflect64(const std::uint32_t remainder)
+      {
+         std::uint64_t result = 0;
+
+         for (std::size_t i = 0; i < 32; ++i)
+         {
+            if (remainder & (static_cast<std::uint32_t>(1) << i))
+               result |= static_cast<std::uint64_t>(1) << (63 - i);
+         }
+
+         return result;
+      }
+
+      /*
+         A reflected 128-bit register holds the polynomial H.x^64 + L in
+         its low and high 64 bits. Moving it d bits further along the
+         message multiplies it by x^d, and as a reflected carry-less
+         product of 64-bit operands comes out multiplied by x, that is
+         H.(x^(d + 63) mod P) + L.(x^(d - 1) mod P), a 96-bit result that
+         is xored into the register d bits on.
+      */
+      void initialize_hardware()
+      {
+         const utils::cpu_features& cpu = utils::host_cpu_features();
+
+         #if defined(SCHIFRA_CRC_X86)
+         if (cpu.sse42 && (crc32c_key == key))
+            instruction = e_sse42_crc32c;
+
+         folding = cpu.pclmul;
+         #endif
+
+         #if defined(SCHIFRA_CRC_ARM_CRC32)
+         if (cpu.crc32 && (crc32c_key == key))
+            instruction = e_arm_crc32c;
+         else if (cpu.crc32 && (zlib_key == key))
+            instruction = e_arm_crc32;
+         #endif
+
+         #if defined(SCHIFRA_CRC_PMULL)
+         folding = cpu.pmull;
+         #endif
+
+         (void)cpu;
+
+         fold_128[0] = reflect64(xpow_mod(128 + 63));
+         fold_128[1] = reflect64(xpow_mod(128 -  1));
+         fold_512[0] = reflect64(xpow_mod(512 + 63));
+         fold_512[1] = reflect64(xpow_mod(512 -  1));
+      }
+
+      /*
+         Fold count bytes (at least 64) into four registers 64 bytes at a
+         time, then into one, then 16 bytes at a time. The state is xored
+         into the first four bytes, and the final register is run through
+         the tables from a zero state. data and count are advanced over
+         what was consumed, the caller finishes the rest.
+      */
+      #if defined(SCHIFRA_CRC_X86)
+      __attribute__((target("pclmul,sse4.1")))
+      inline crc32_t process_pclmul(const crc32_t crc_state, const unsigned char*& data, std::size_t& count) const
+      {
+         const __m128i k512 = _mm_set_epi64x(static_cast<long long>(fold_512[1]), static_cast<long long>(fold_512[0]));
+         const __m128i k128 = _mm_set_epi64x(static_cast<long long>(fold_128[1]), static_cast<long long>(fold_128[0]));
+
+         __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data     ));
+         __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+         __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+         __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+
+         x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128(static_cast<int>(crc_state)));
+
+         data  += 64;
+         count -= 64;
+
+         for (; count >= 64; count -= 64, data += 64)
+         {
+            x0 = fold_pclmul(x0, k512, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data     )));
+            x1 = fold_pclmul(x1, k512, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+            x2 = fold_pclmul(x2, k512, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+            x3 = fold_pclmul(x3, k512, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+         }
+
+         x0 = fold_pclmul(x0, k128, x1);
+         x0 = fold_pclmul(x0, k128, x2);
+         x0 = fold_pclmul(x0, k128, x3);
+
+         for (; count >= 16; count -= 16, data += 16)
+         {
+            x0 = fold_pclmul(x0, k128, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+         }
+
+         unsigned char folded[16];
+
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), x0);
+
+         return slice_round(0, folded, 16);
+      }
+
+      __attribute__((target("pclmul,sse4.1")))
+      static inline __m128i fold_pclmul(const __m128i x, const __m128i k, const __m128i next)
+      {
+         return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                            _mm_clmulepi64_si128(x, k, 0x11)),
+                              next);
+      }
+
+      __attribute__((target("sse4.2")))
+      inline crc32_t process_sse42(const crc32_t crc_state, const unsigned char* data, std::size_t count) const
+      {
+         #if defined(__x86_64__)
+         std::uint64_t result = static_cast<std::uint32_t>(crc_state);
+
+         for (; count >= 8; count -= 8, data += 8)
+         {
+            std::uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            result = _mm_crc32_u64(result, word);
+         }
+         #else
+         std::uint32_t result = static_cast<std::uint32_t>(crc_state);
+
+         for (; count >= 4; count -= 4, data += 4)
+         {
+            std::uint32_t word;
+            std::memcpy(&word, data, sizeof(word));
+            result = _mm_crc32_u32(result, word);
+         }
+         #endif
+
+         for (; count > 0; --count, ++data)
+         {
+            result = _mm_crc32_u8(static_cast<std::uint32_t>(result), *data);
+         }
+
+         return static_cast<crc32_t>(static_cast<std::uint32_t>(result));
+      }
+      #endif
+
+      #if defined(SCHIFRA_CRC_ARM_CRC32)
+      inline crc32_t process_arm_crc32(const crc32_t crc_state, const unsigned char* data, std::size_t count) const
+      {
+         std::uint32_t result = static_cast<std::uint32_t>(crc_state);
+
+         const bool castagnoli = (e_arm_crc32c == instruction);
+
+         for (; count >= 8; count -= 8, data += 8)
+         {
+            std::uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            result = castagnoli ? __crc32cd(result, word) : __crc32d(result, word);
+         }
+
+         for (; count > 0; --count, ++data)
+         {
+            result = castagnoli ? __crc32cb(result, *data) : __crc32b(result, *data);
+         }
+
+         return static_cast<crc32_t>(result);
+      }
+      #endif
+
+      #if defined(SCHIFRA_CRC_PMULL)
+      inline crc32_t process_pmull(const crc32_t crc_state, const unsigned char*& data, std::size_t& count) const
+      {
+         uint64x2_t x0 = vld1q_u64(reinterpret_cast<const std::uint64_t*>(data     ));
+         uint64x2_t x1 = vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 16));
+         uint64x2_t x2 = vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 32));
+         uint64x2_t x3 = vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 48));
+
+         x0 = veorq_u64(x0, vsetq_lane_u64(static_cast<std::uint32_t>(crc_state), vdupq_n_u64(0), 0));
+
+         data  += 64;
+         count -= 64;
+
+         for (; count >= 64; count -= 64, data += 64)
+         {
+            x0 = fold_pmull(x0, fold_512, vld1q_u64(reinterpret_cast<const std::uint64_t*>(data     )));
+            x1 = fold_pmull(x1, fold_512, vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 16)));
+            x2 = fold_pmull(x2, fold_512, vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 32)));
+            x3 = fold_pmull(x3, fold_512, vld1q_u64(reinterpret_cast<const std::uint64_t*>(data + 48)));
+         }
+
+         x0 = fold_pmull(x0, fold_128, x1);
+         x0 = fold_pmull(x0, fold_128, x2);
+         x0 = fold_pmull(x0, fold_128, x3);
+
+         for (; count >= 16; count -= 16, data += 16)
+         {
+            x0 = fold_pmull(x0, fold_128, vld1q_u64(reinterpret_cast<const std::uint64_t*>(data)));
+         }
+
+         unsigned char folded[16];
+
+         vst1q_u64(reinterpret_cast<std::uint64_t*>(folded), x0);
+
+         return slice_round(0, folded, 16);
+      }
+
+      static inline uint64x2_t fold_pmull(const uint64x2_t x, const std::uint64_t k[2], const uint64x2_t next)
+      {
+         const poly128_t low  = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(x, 0)), static_cast<poly64_t>(k[0]));
+         const poly128_t high = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(x, 1)), static_cast<poly64_t>(k[1]));
+
+         return veorq_u64(veorq_u64(vreinterpretq_u64_p128(low), vreinterpretq_u64_p128(high)), next);
+      }
+      #endif
+
    protected:
 
       crc32_t key;
       crc32_t state;
       const crc32_t initial_state;
       crc32_t table[256];
+
+   private:
+
+      const slicing_mode         slicing;
+      std::vector<std::uint32_t> slice_table;
+      instruction_t              instruction;
+      bool                       folding;
+      std::uint64_t              fold_128[2];
+      std::uint64_t              fold_512[2];
    };
 
    class schifra_crc : public crc32
@@ -166,6 +695,18 @@ namespace schifra
 
    };
 
+   /*
+      zlib style combine of finalized CRC-32 values (initial state and
+      final xor both 0xFFFFFFFF): the CRC-32 of A followed by B, from that
+      of A, that of B and the length of B.
+   */
+   inline crc32::crc32_t crc32_combine(const crc32::crc32_t crc_a, const crc32::crc32_t crc_b, const std::size_t len_b)
+   {
+      static const crc32 crc_module(crc32::zlib_key, 0xFFFFFFFF);
+
+      return crc_module.shift(crc_a, len_b) ^ crc_b;
+   }
+
 } // namespace schifra
 
 
@@ -0,0 +1,418 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_DNA_ALPHABET_HPP
+#define INCLUDE_SCHIFRA_DNA_ALPHABET_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+   #define SCHIFRA_DNA_X86
+   #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+   #define SCHIFRA_DNA_NEON
+   #include <arm_neon.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace dna
+      {
+
+         /*
+            Nucleotide <-> 2 bit symbol translation, A=0 C=1 G=2 T=3, case
+            insensitive on input and upper case on output. Single bases go
+            through constexpr 256 entry tables, whole reads through the
+            bulk functions below, which take 32 (AVX2) or 16 (NEON) bases
+            per step: the case folded base indexes a 16 entry shuffle by its
+            low nibble, A/C/G/T having distinct ones (1/3/7/4), and is
+            valid only if the expected letter comes back.
+         */
+         static const std::uint8_t invalid_base = 0xFF;
+
+         struct base_table
+         {
+            std::uint8_t symbol[256];
+         };
+
+         inline constexpr base_table make_base_table()
+         {
+            base_table table = {};
+
+            for (std::size_t i = 0; i < 256; ++i)
+            {
+               table.symbol[i] = invalid_base;
+            }
+
+            table.symbol['A'] = 0; table.symbol['a'] = 0;
+            table.symbol['C'] = 1; table.symbol['c'] = 1;
+            table.symbol['G'] = 2; table.symbol['g'] = 2;
+            table.symbol['T'] = 3; table.symbol['t'] = 3;
+
+            return table;
+         }
+
+         static constexpr base_table base_to_symbol_table = make_base_table();
+         static constexpr char       symbol_to_base_table[4] = { 'A', 'C', 'G', 'T' };
+
+         /* invalid_base for anything but ACGTacgt */
+         inline std::uint8_t base_to_symbol(const char base)
+         {
+            return base_to_symbol_table.symbol[static_cast<unsigned char>(base)];
+         }
+
+         /* symbol must be in [0,4) */
+         inline char symbol_to_base(const std::uint8_t symbol)
+         {
+            return symbol_to_base_table[symbol & 3];
+         }
+
+         namespace details
+         {
+            /*
+               Per low nibble of a case folded base: the letter it must be
+               to be valid (0xFF never matches) and its symbol.
+            */
+            static const std::uint8_t expected_letter[16] =
+               {
+                  0xFF, 'A' , 0xFF, 'C' , 'T' , 0xFF, 0xFF, 'G' ,
+                  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+               };
+
+            static const std::uint8_t nibble_symbol[16] =
+               {
+                  0, 0, 0, 1, 3, 0, 0, 2,
+                  0, 0, 0, 0, 0, 0, 0, 0
+               };
+
+            /*
+               Per low nibble, what a base is xor'ed with to complement it:
+               A^T = 0x15 and C^G = 0x04, in either case. Other bytes with
+               these nibbles are swapped among themselves (eg: Q and D),
+               never into a base, and bytes with bit 7 set are left as is.
+            */
+            static const std::uint8_t complement_xor[16] =
+               {
+                  0x00, 0x15, 0x00, 0x04, 0x15, 0x00, 0x00, 0x04,
+                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+               };
+
+            /* Scalar tail from i, returns the offset of the first invalid base or count */
+            inline std::size_t to_symbols_scalar(const char* bases, const std::size_t count, std::uint8_t* symbols, std::size_t i)
+            {
+               for ( ; i < count; ++i)
+               {
+                  const std::uint8_t s = base_to_symbol(bases[i]);
+
+                  if (invalid_base == s)
+                     return i;
+
+                  if (symbols)
+                     symbols[i] = s;
+               }
+
+               return count;
+            }
+
+            inline char complement_scalar(const char base)
+            {
+               const std::uint8_t b = static_cast<std::uint8_t>(base);
+               return static_cast<char>((b & 0x80) ? b : (b ^ complement_xor[b & 0x0F]));
+            }
+
+            /* Reverse complement of the last count - i bases of the output */
+            inline void reverse_complement_scalar(const char* bases, const std::size_t count, char* out, std::size_t i)
+            {
+               for ( ; i < count; ++i)
+               {
+                  out[i] = complement_scalar(bases[count - 1 - i]);
+               }
+            }
+
+            inline bool to_bases_scalar(const std::uint8_t* symbols, const std::size_t count, char* bases, std::size_t i)
+            {
+               for ( ; i < count; ++i)
+               {
+                  if (symbols[i] > 3)
+                     return false;
+
+                  bases[i] = symbol_to_base_table[symbols[i]];
+               }
+
+               return true;
+            }
+
+            #ifdef SCHIFRA_DNA_X86
+
+            /*
+               Bases [0,i) converted, i a multiple of 32, stopping at the
+               first step that holds an invalid base
+            */
+            __attribute__((target("avx2")))
+            inline std::size_t to_symbols_avx2(const char* bases, const std::size_t count, std::uint8_t* symbols)
+            {
+               const __m256i fold     = _mm256_set1_epi8(static_cast<char>(0xDF));
+               const __m256i low      = _mm256_set1_epi8(0x0F);
+               const __m256i expected = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(expected_letter)));
+               const __m256i symbol   = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_symbol  )));
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const __m256i b      = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + i)), fold);
+                  const __m256i nibble = _mm256_and_si256(b, low);
+
+                  /* Note: bytes of b with bit 7 set shuffle to 0, never a letter */
+                  const __m256i match  = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(expected, nibble), b);
+
+                  if (-1 != _mm256_movemask_epi8(match))
+                     return i;
+
+                  if (symbols)
+                     _mm256_storeu_si256(reinterpret_cast<__m256i*>(symbols + i), _mm256_shuffle_epi8(symbol, nibble));
+               }
+
+               return i;
+            }
+
+            __attribute__((target("avx2")))
+            inline std::size_t to_bases_avx2(const std::uint8_t* symbols, const std::size_t count, char* bases)
+            {
+               const __m256i letters = _mm256_setr_epi8('A', 'C', 'G', 'T', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                        'A', 'C', 'G', 'T', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+               const __m256i high    = _mm256_set1_epi8(static_cast<char>(0xFC));
+               const __m256i zero    = _mm256_setzero_si256();
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(symbols + i));
+
+                  if (-1 != _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(s, high), zero)))
+                     return count + 1;
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(bases + i), _mm256_shuffle_epi8(letters, s));
+               }
+
+               return i;
+            }
+
+            /* Output bases [0,i) written, i a multiple of 32 */
+            __attribute__((target("avx2")))
+            inline std::size_t reverse_complement_avx2(const char* bases, const std::size_t count, char* out)
+            {
+               const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+               const __m256i low      = _mm256_set1_epi8(0x0F);
+               const __m256i high_bit = _mm256_set1_epi8(static_cast<char>(0x80));
+               const __m256i xors     = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(complement_xor)));
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + count - i - 32));
+
+                  b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, reverse), 0x4E);
+
+                  /* Bit 7 in the index makes the shuffle return 0, ie: no xor */
+                  const __m256i index = _mm256_or_si256(_mm256_and_si256(b, low), _mm256_and_si256(b, high_bit));
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(b, _mm256_shuffle_epi8(xors, index)));
+               }
+
+               return i;
+            }
+
+            #endif
+
+            #ifdef SCHIFRA_DNA_NEON
+
+            inline std::size_t reverse_complement_neon(const char* bases, const std::size_t count, char* out)
+            {
+               const uint8x16_t low  = vdupq_n_u8(0x8F);
+               const uint8x16_t xors = vld1q_u8(complement_xor);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  uint8x16_t b = vld1q_u8(reinterpret_cast<const std::uint8_t*>(bases + count - i - 16));
+
+                  b = vrev64q_u8(b);
+                  b = vextq_u8(b, b, 8);
+
+                  /* Indexes of 0x80 and up are out of the table, giving 0 */
+                  vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i), veorq_u8(b, vqtbl1q_u8(xors, vandq_u8(b, low))));
+               }
+
+               return i;
+            }
+
+            inline std::size_t to_symbols_neon(const char* bases, const std::size_t count, std::uint8_t* symbols)
+            {
+               const uint8x16_t fold     = vdupq_n_u8(0xDF);
+               const uint8x16_t low      = vdupq_n_u8(0x0F);
+               const uint8x16_t expected = vld1q_u8(expected_letter);
+               const uint8x16_t symbol   = vld1q_u8(nibble_symbol  );
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  const uint8x16_t b      = vandq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(bases + i)), fold);
+                  const uint8x16_t nibble = vandq_u8(b, low);
+
+                  if (0xFF != vminvq_u8(vceqq_u8(vqtbl1q_u8(expected, nibble), b)))
+                     return i;
+
+                  if (symbols)
+                     vst1q_u8(symbols + i, vqtbl1q_u8(symbol, nibble));
+               }
+
+               return i;
+            }
+
+            inline std::size_t to_bases_neon(const std::uint8_t* symbols, const std::size_t count, char* bases)
+            {
+               const std::uint8_t letter_bytes[16] = { 'A', 'C', 'G', 'T' };
+               const uint8x16_t   letters          = vld1q_u8(letter_bytes);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  const uint8x16_t s = vld1q_u8(symbols + i);
+
+                  if (3 < vmaxvq_u8(s))
+                     return count + 1;
+
+                  vst1q_u8(reinterpret_cast<std::uint8_t*>(bases + i), vqtbl1q_u8(letters, s));
+               }
+
+               return i;
+            }
+
+            #endif
+
+         } // namespace details
+
+         /*
+            Translate count bases into symbols, validating and case folding
+            them in the same pass, and return the offset of the first base
+            that is not one of ACGTacgt, or count when there is none.
+            Symbols before that offset are written, those after it may or
+            may not be. symbols may be null to validate only.
+
+            The SIMD kernels stop at the first step holding an invalid
+            base, the scalar tail then converts up to the base itself.
+         */
+         inline std::size_t first_invalid_base(const char* bases, const std::size_t count, std::uint8_t* symbols)
+         {
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               i = details::to_symbols_avx2(bases, count, symbols);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::to_symbols_neon(bases, count, symbols);
+            #endif
+
+            return details::to_symbols_scalar(bases, count, symbols, i);
+         }
+
+         /*
+            As first_invalid_base(), returning false, with symbols partly
+            written, when a base is not one of ACGTacgt
+         */
+         inline bool bases_to_symbols(const char* bases, const std::size_t count, std::uint8_t* symbols)
+         {
+            return (count == first_invalid_base(bases, count, symbols));
+         }
+
+         inline bool valid_bases(const char* bases, const std::size_t count)
+         {
+            return bases_to_symbols(bases, count, 0);
+         }
+
+         /* Complement of an ACGTacgt base, case kept, anything else stays a non base */
+         inline char complement_base(const char base)
+         {
+            return details::complement_scalar(base);
+         }
+
+         /*
+            Reverse complement of count bases into out, which must not
+            overlap them, 32 (AVX2) or 16 (NEON) bases per step.
+         */
+         inline void reverse_complement(const char* bases, const std::size_t count, char* out)
+         {
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               i = details::reverse_complement_avx2(bases, count, out);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::reverse_complement_neon(bases, count, out);
+            #endif
+
+            details::reverse_complement_scalar(bases, count, out, i);
+         }
+
+         /* Translate count symbols into upper case bases, false if one is not in [0,4) */
+         inline bool symbols_to_bases(const std::uint8_t* symbols, const std::size_t count, char* bases)
+         {
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               i = details::to_bases_avx2(symbols, count, bases);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::to_bases_neon(symbols, count, bases);
+            #endif
+
+            if (i > count)
+               return false;
+
+            return details::to_bases_scalar(symbols, count, bases, i);
+         }
+
+      } // namespace dna
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
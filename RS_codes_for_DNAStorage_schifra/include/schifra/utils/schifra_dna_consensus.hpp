@@ -0,0 +1,214 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_DNA_CONSENSUS_HPP
+#define INCLUDE_SCHIFRA_DNA_CONSENSUS_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace dna
+      {
+
+         /*
+            Per position consensus of several reads of one strand. Votes
+            are 16 bit saturating counters, votes[s * length + i] holding
+            the weight of base symbol s at position i. add_votes() adds
+            one read, each base weighing its quality (eg: its Phred score)
+            or 1 without qualities; bases other than ACGTacgt, eg: 'N',
+            abstain. call_consensus() then takes the heaviest base of each
+            position and its margin over the runner up, a margin of 0
+            being a tie, ie: a position the reads do not settle.
+         */
+         namespace details
+         {
+            inline void add_votes_scalar(const char* read, const std::uint8_t* quality, const std::size_t length,
+                                         std::uint16_t* votes, std::size_t i)
+            {
+               for ( ; i < length; ++i)
+               {
+                  const std::uint8_t s = base_to_symbol(read[i]);
+
+                  if (invalid_base == s)
+                     continue;
+
+                  std::uint16_t& v = votes[s * length + i];
+
+                  const unsigned int sum = static_cast<unsigned int>(v) + (quality ? quality[i] : 1U);
+
+                  v = static_cast<std::uint16_t>((sum > 0xFFFF) ? 0xFFFF : sum);
+               }
+            }
+
+            #ifdef SCHIFRA_DNA_X86
+
+            /*
+               16 positions per step: the case folded base gives its symbol
+               through the nibble shuffle of to_symbols_avx2() (0xFF when
+               invalid), and each of the 4 symbol compares selects the
+               weights added, widened to 16 bits, to that symbol's counters.
+            */
+            __attribute__((target("avx2")))
+            inline std::size_t add_votes_avx2(const char* read, const std::uint8_t* quality, const std::size_t length,
+                                              std::uint16_t* votes)
+            {
+               const __m128i fold     = _mm_set1_epi8(static_cast<char>(0xDF));
+               const __m128i low      = _mm_set1_epi8(0x0F);
+               const __m128i invalid  = _mm_set1_epi8(static_cast<char>(0xFF));
+               const __m128i expected = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expected_letter));
+               const __m128i symbol   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_symbol  ));
+               const __m128i one      = _mm_set1_epi8(1);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= length; i += 16)
+               {
+                  const __m128i b      = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(read + i)), fold);
+                  const __m128i nibble = _mm_and_si128(b, low);
+                  const __m128i valid  = _mm_cmpeq_epi8(_mm_shuffle_epi8(expected, nibble), b);
+                  const __m128i s      = _mm_blendv_epi8(invalid, _mm_shuffle_epi8(symbol, nibble), valid);
+                  const __m128i weight = quality ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(quality + i)) : one;
+
+                  for (int k = 0; k < 4; ++k)
+                  {
+                     const __m128i selected = _mm_and_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8(static_cast<char>(k))), weight);
+
+                     __m256i* v = reinterpret_cast<__m256i*>(votes + (k * length) + i);
+
+                     _mm256_storeu_si256(v, _mm256_adds_epu16(_mm256_loadu_si256(v), _mm256_cvtepu8_epi16(selected)));
+                  }
+               }
+
+               return i;
+            }
+
+            #endif
+
+            #ifdef SCHIFRA_DNA_NEON
+
+            inline std::size_t add_votes_neon(const char* read, const std::uint8_t* quality, const std::size_t length,
+                                              std::uint16_t* votes)
+            {
+               const uint8x16_t fold     = vdupq_n_u8(0xDF);
+               const uint8x16_t low      = vdupq_n_u8(0x0F);
+               const uint8x16_t expected = vld1q_u8(expected_letter);
+               const uint8x16_t symbol   = vld1q_u8(nibble_symbol  );
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= length; i += 16)
+               {
+                  const uint8x16_t b      = vandq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(read + i)), fold);
+                  const uint8x16_t nibble = vandq_u8(b, low);
+                  const uint8x16_t valid  = vceqq_u8(vqtbl1q_u8(expected, nibble), b);
+                  const uint8x16_t s      = vorrq_u8(vqtbl1q_u8(symbol, nibble), vmvnq_u8(valid));
+                  const uint8x16_t weight = quality ? vld1q_u8(quality + i) : vdupq_n_u8(1);
+
+                  for (int k = 0; k < 4; ++k)
+                  {
+                     const uint8x16_t selected = vandq_u8(vceqq_u8(s, vdupq_n_u8(static_cast<std::uint8_t>(k))), weight);
+
+                     std::uint16_t* v = votes + (k * length) + i;
+
+                     vst1q_u16(v    , vqaddq_u16(vld1q_u16(v    ), vmovl_u8(vget_low_u8 (selected))));
+                     vst1q_u16(v + 8, vqaddq_u16(vld1q_u16(v + 8), vmovl_u8(vget_high_u8(selected))));
+                  }
+               }
+
+               return i;
+            }
+
+            #endif
+
+         } // namespace details
+
+         /*
+            Add the votes of a read of length bases, quality may be null.
+            votes holds 4 * length counters, zeroed before the first read.
+         */
+         inline void add_votes(const char* read, const std::uint8_t* quality, const std::size_t length, std::uint16_t* votes)
+         {
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               i = details::add_votes_avx2(read, quality, length, votes);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::add_votes_neon(read, quality, length, votes);
+            #endif
+
+            details::add_votes_scalar(read, quality, length, votes, i);
+         }
+
+         /*
+            The consensus base of every position, 'A' on a tie of no votes,
+            and when margin is not null the winning weight less the runner
+            up's.
+         */
+         inline void call_consensus(const std::uint16_t* votes, const std::size_t length, char* bases, std::uint16_t* margin)
+         {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+               std::uint8_t  best     = 0;
+               std::uint16_t best_v   = votes[i];
+               std::uint16_t second_v = 0;
+
+               for (std::uint8_t s = 1; s < 4; ++s)
+               {
+                  const std::uint16_t v = votes[s * length + i];
+
+                  if (v > best_v)
+                  {
+                     second_v = best_v;
+                     best_v   = v;
+                     best     = s;
+                  }
+                  else if (v > second_v)
+                     second_v = v;
+               }
+
+               bases[i] = symbol_to_base(best);
+
+               if (margin)
+                  margin[i] = static_cast<std::uint16_t>(best_v - second_v);
+            }
+         }
+
+      } // namespace dna
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
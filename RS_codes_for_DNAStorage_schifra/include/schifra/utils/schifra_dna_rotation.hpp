@@ -0,0 +1,222 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_DNA_ROTATION_HPP
+#define INCLUDE_SCHIFRA_DNA_ROTATION_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace dna
+      {
+
+         /*
+            Rotation mapping of strands, a constrained coding stage between
+            the codec and the bases written out. Base i of a strand is
+            advanced by key[i] (mod 4) on the way out and moved back on the
+            way in, so the mapping keeps the strand length and turns a base
+            substitution into a base substitution, leaving the codec and
+            its indel search unchanged.
+
+            make_rotation_key() draws each group of 4 positions as a
+            permutation of ACGT, no base equal to the one before it. Any
+            run of constant data (eg: zero padding, all 'A') then comes out
+            without homopolymers and at 50% GC per 4 bases; other data comes
+            out as scrambled, long runs and GC skew in the input no longer
+            lining up with the output.
+
+            Symbols are bytes of 2 bit fields, each advanced by the field of
+            the key byte in the same place with no carry into the next, so
+            any packing works as long as the key is packed the same way: one
+            base per byte, 4 per byte as packed_dna, or the 2 per symbol of
+            the GF(2^4) strands. 32 (AVX2), 16 (NEON) or 8 (SWAR) bytes per
+            step: a + k per field is a ^ k with the carry of its low bits,
+            (a & k & 01b) << 1, xor'ed into its high bit.
+         */
+         namespace details
+         {
+            static const std::uint64_t low_fields = 0x5555555555555555ULL;
+
+            inline std::uint64_t rotate_word(const std::uint64_t a, const std::uint64_t k)
+            {
+               return (a ^ k) ^ ((a & k & low_fields) << 1);
+            }
+
+            inline void rotate_scalar(const std::uint8_t* symbols, const std::uint8_t* key, const std::size_t count, std::uint8_t* out, std::size_t i)
+            {
+               for ( ; (i + 8) <= count; i += 8)
+               {
+                  std::uint64_t a;
+                  std::uint64_t k;
+
+                  std::memcpy(&a, symbols + i, sizeof(a));
+                  std::memcpy(&k, key     + i, sizeof(k));
+
+                  a = rotate_word(a, k);
+
+                  std::memcpy(out + i, &a, sizeof(a));
+               }
+
+               for ( ; i < count; ++i)
+               {
+                  out[i] = static_cast<std::uint8_t>(rotate_word(symbols[i], key[i]));
+               }
+            }
+
+            #ifdef SCHIFRA_DNA_X86
+
+            __attribute__((target("avx2")))
+            inline std::size_t rotate_avx2(const std::uint8_t* symbols, const std::uint8_t* key, const std::size_t count, std::uint8_t* out)
+            {
+               const __m256i low = _mm256_set1_epi8(0x55);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 32) <= count; i += 32)
+               {
+                  const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(symbols + i));
+                  const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key     + i));
+
+                  /* Note: the 16 bit shift keeps the carries in their bytes, 0x55 leaving bit 7 clear */
+                  const __m256i carry = _mm256_slli_epi16(_mm256_and_si256(_mm256_and_si256(a, k), low), 1);
+
+                  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(_mm256_xor_si256(a, k), carry));
+               }
+
+               return i;
+            }
+
+            #endif
+
+            #ifdef SCHIFRA_DNA_NEON
+
+            inline std::size_t rotate_neon(const std::uint8_t* symbols, const std::uint8_t* key, const std::size_t count, std::uint8_t* out)
+            {
+               const uint8x16_t low = vdupq_n_u8(0x55);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  const uint8x16_t a = vld1q_u8(symbols + i);
+                  const uint8x16_t k = vld1q_u8(key     + i);
+
+                  vst1q_u8(out + i, veorq_u8(veorq_u8(a, k), vshlq_n_u8(vandq_u8(vandq_u8(a, k), low), 1)));
+               }
+
+               return i;
+            }
+
+            #endif
+
+         } // namespace details
+
+         /* The 2 bit fields of symbol advanced by those of key, mod 4 */
+         inline std::uint8_t rotate_symbol(const std::uint8_t symbol, const std::uint8_t key)
+         {
+            return static_cast<std::uint8_t>(details::rotate_word(symbol, key));
+         }
+
+         /* The key moving each field back by what key moves it forward */
+         inline std::uint8_t inverse_rotation(const std::uint8_t key)
+         {
+            return rotate_symbol(static_cast<std::uint8_t>(~key), 0x55);
+         }
+
+         /*
+            out[i] = symbols[i] rotated by key[i], count bytes. out may be
+            symbols itself.
+         */
+         inline void rotate_symbols(const std::uint8_t* symbols, const std::uint8_t* key, const std::size_t count, std::uint8_t* out)
+         {
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               i = details::rotate_avx2(symbols, key, count, out);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::rotate_neon(symbols, key, count, out);
+            #endif
+
+            details::rotate_scalar(symbols, key, count, out, i);
+         }
+
+         /*
+            Key of count bases, one per byte in [0,4), drawn from seed as
+            above: groups of 4 positions are permutations of the 4 bases,
+            the first of a group differing from the last of the one before.
+         */
+         inline void make_rotation_key(const std::size_t count, std::uint32_t seed, std::uint8_t* key)
+         {
+            /* Note: xorshift32 is stuck at 0 */
+            std::uint32_t state = (0 == seed) ? 0x9E3779B9U : seed;
+
+            std::uint8_t previous = 0xFF;
+
+            for (std::size_t i = 0; i < count; i += 4)
+            {
+               std::uint8_t group[4] = { 0, 1, 2, 3 };
+
+               for (std::size_t j = 3; j > 0; --j)
+               {
+                  state ^= state << 13;
+                  state ^= state >> 17;
+                  state ^= state <<  5;
+
+                  const std::size_t r = state % (j + 1);
+                  const std::uint8_t t = group[j]; group[j] = group[r]; group[r] = t;
+               }
+
+               if (group[0] == previous)
+               {
+                  const std::uint8_t t = group[0]; group[0] = group[1 + (state >> 8) % 3]; group[1 + (state >> 8) % 3] = t;
+               }
+
+               for (std::size_t j = 0; (j < 4) && ((i + j) < count); ++j)
+               {
+                  key[i + j] = group[j];
+               }
+
+               previous = group[3];
+            }
+         }
+
+      } // namespace dna
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,482 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_ENERGY_METER_HPP
+#define INCLUDE_SCHIFRA_ENERGY_METER_HPP
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SCHIFRA_ENERGY_RAPL
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Energy drawn by the cpu packages and their DRAM, from the RAPL
+         counters of Intel and AMD processors. The powercap sysfs files
+         (/sys/class/powercap/intel-rapl:N, which AMD processors expose
+         too) are read when they are readable, otherwise the perf "power"
+         PMU, which needs perf_event_paranoid <= 0 or CAP_PERFMON. Joules
+         accumulate over every start()/stop() pair, see section.
+
+         RAPL counts the whole package, not a thread: a meter is started
+         and stopped once around a multithreaded run, by one thread, and
+         whatever else the machine runs meanwhile is counted too. The
+         counters update about every millisecond, so sections shorter
+         than tens of milliseconds read mostly noise. Where neither source
+         is available (other platforms, VMs, no permission) the calls do
+         nothing and available() is false.
+      */
+      class energy_meter
+      {
+      public:
+
+         enum domain_t
+         {
+            e_package      = 0,
+            e_dram         = 1,
+            e_domain_count = 2
+         };
+
+         struct reading
+         {
+            reading()
+            {
+               clear();
+            }
+
+            inline void clear()
+            {
+               for (std::size_t i = 0; i < e_domain_count; ++i)
+               {
+                  joules[i] = 0.0;
+                  valid [i] = false;
+               }
+
+               seconds = 0.0;
+            }
+
+            inline void merge(const reading& r)
+            {
+               for (std::size_t i = 0; i < e_domain_count; ++i)
+               {
+                  joules[i] += r.joules[i];
+                  valid [i] |= r.valid[i];
+               }
+
+               seconds += r.seconds;
+            }
+
+            inline bool any() const
+            {
+               return valid[e_package] || valid[e_dram];
+            }
+
+            /* Package plus DRAM, those that were measured */
+            inline double total() const
+            {
+               return (valid[e_package] ? joules[e_package] : 0.0) + (valid[e_dram] ? joules[e_dram] : 0.0);
+            }
+
+            /* Joules per amount of work, eg: per MB */
+            inline double per(const double amount) const
+            {
+               return (any() && (amount > 0.0)) ? total() / amount : 0.0;
+            }
+
+            inline double watts() const
+            {
+               return (seconds > 0.0) ? total() / seconds : 0.0;
+            }
+
+            /* One line summary, per unit of work (eg: per MB) */
+            inline void print(std::FILE* out, const double units, const char* unit_name = "MB") const
+            {
+               if (!any())
+               {
+                  std::fprintf(out, "energy: RAPL unavailable\n");
+                  return;
+               }
+
+               std::fprintf(out, "energy: J/%s=%.6f", unit_name, per(units));
+
+               if (valid[e_package]) std::fprintf(out, " package=%.3fJ", joules[e_package]);
+               if (valid[e_dram   ]) std::fprintf(out, " dram=%.3fJ"   , joules[e_dram   ]);
+
+               std::fprintf(out, " power=%.2fW\n", watts());
+            }
+
+            double joules[e_domain_count];
+            bool   valid [e_domain_count];
+            double seconds;
+         };
+
+         /* Wraps a section of code: the meter runs for the lifetime of the section */
+         class section
+         {
+         public:
+
+            explicit section(energy_meter& meter)
+            : meter_(meter)
+            {
+               meter_.start();
+            }
+
+           ~section()
+            {
+               meter_.stop();
+            }
+
+         private:
+
+            section(const section&);
+            section& operator=(const section&);
+
+            energy_meter& meter_;
+         };
+
+         energy_meter()
+         {
+            #ifdef SCHIFRA_ENERGY_RAPL
+            open_powercap();
+
+            if (counters_.empty())
+               open_perf();
+            #endif
+         }
+
+        ~energy_meter()
+         {
+            #ifdef SCHIFRA_ENERGY_RAPL
+            for (std::size_t i = 0; i < counters_.size(); ++i)
+            {
+               if (counters_[i].fd >= 0) close(counters_[i].fd);
+            }
+            #endif
+         }
+
+         /* True when at least one domain can be measured */
+         inline bool available() const
+         {
+            return !counters_.empty();
+         }
+
+         /* "powercap", "perf" or "none" */
+         inline const char* source() const
+         {
+            return counters_.empty() ? "none" : (counters_[0].perf ? "perf" : "powercap");
+         }
+
+         /*
+            Benchmarks measure energy when asked to on their command line,
+            or when the SCHIFRA_ENERGY environment variable is set to a
+            non-zero value.
+         */
+         static inline bool requested()
+         {
+            const char* env = std::getenv("SCHIFRA_ENERGY");
+            return (0 != env) && (0 != std::strcmp(env, "")) && (0 != std::strcmp(env, "0"));
+         }
+
+         inline void start()
+         {
+            for (std::size_t i = 0; i < counters_.size(); ++i)
+            {
+               counters_[i].start = read_counter(counters_[i]);
+            }
+
+            start_ = std::chrono::steady_clock::now();
+         }
+
+         inline void stop()
+         {
+            totals_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+
+            for (std::size_t i = 0; i < counters_.size(); ++i)
+            {
+               counter& c = counters_[i];
+
+               const std::uint64_t now = read_counter(c);
+
+               /* Note: The sysfs counters wrap at max_energy_range_uj */
+               const std::uint64_t delta = (now >= c.start) ? (now - c.start) : (now + c.range - c.start);
+
+               totals_.joules[c.domain] += delta * c.scale;
+               totals_.valid [c.domain]  = true;
+            }
+         }
+
+         inline void reset()
+         {
+            totals_.clear();
+         }
+
+         inline const reading& totals() const
+         {
+            return totals_;
+         }
+
+      private:
+
+         energy_meter(const energy_meter&);
+         energy_meter& operator=(const energy_meter&);
+
+         /*
+            One RAPL domain of one package: an energy_uj file (fd, range
+            its wrap point), or a perf event (fd, perf). scale turns a
+            count into joules.
+         */
+         struct counter
+         {
+            domain_t      domain;
+            int           fd;
+            bool          perf;
+            double        scale;
+            std::uint64_t range;
+            std::uint64_t start;
+         };
+
+         #ifdef SCHIFRA_ENERGY_RAPL
+         static inline bool read_file(const std::string& path, std::string& text)
+         {
+            text.clear();
+
+            std::FILE* file = std::fopen(path.c_str(), "r");
+
+            if (0 == file)
+               return false;
+
+            char buffer[256];
+
+            const std::size_t length = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+
+            std::fclose(file);
+
+            text.assign(buffer, length);
+
+            while (!text.empty() && (('\n' == text[text.size() - 1]) || (' ' == text[text.size() - 1])))
+               text.erase(text.size() - 1);
+
+            return !text.empty();
+         }
+
+         /*
+            Package domains are intel-rapl:N, named package-N, and their
+            DRAM the subdomain of that name. core and uncore are part of
+            the package and psys covers more than the cpu, so both are
+            left out to not count energy twice.
+         */
+         inline void open_powercap()
+         {
+            const std::string base = "/sys/class/powercap/intel-rapl:";
+
+            for (int package = 0; package < 64; ++package)
+            {
+               const std::string zone = base + std::to_string(package);
+
+               std::string name;
+
+               if (!read_file(zone + "/name", name))
+                  break;
+
+               if (0 == name.compare(0, 7, "package"))
+                  add_powercap(zone, e_package);
+
+               for (int sub = 0; sub < 8; ++sub)
+               {
+                  const std::string subzone = zone + "/intel-rapl:" + std::to_string(package) + ":" + std::to_string(sub);
+
+                  if (!read_file(subzone + "/name", name))
+                     break;
+
+                  if ("dram" == name)
+                     add_powercap(subzone, e_dram);
+               }
+            }
+         }
+
+         inline void add_powercap(const std::string& zone, const domain_t domain)
+         {
+            std::string text;
+
+            const int fd = ::open((zone + "/energy_uj").c_str(), O_RDONLY);
+
+            if (fd < 0)
+               return;
+
+            counter c;
+
+            c.domain = domain;
+            c.fd     = fd;
+            c.perf   = false;
+            c.scale  = 1.0e-6;
+            c.range  = read_file(zone + "/max_energy_range_uj", text) ? std::strtoull(text.c_str(), 0, 10) : 0;
+            c.start  = 0;
+
+            /* Note: Since 5.10 energy_uj is readable by root only */
+            char buffer[32];
+
+            if (::pread(fd, buffer, sizeof(buffer), 0) <= 0)
+            {
+               ::close(fd);
+               return;
+            }
+
+            counters_.push_back(c);
+         }
+
+         /*
+            The perf power PMU counts per package, opened on the first cpu
+            of each: /sys/devices/system/cpu/cpuN/topology/physical_package_id.
+         */
+         inline void open_perf()
+         {
+            std::string text;
+
+            if (!read_file("/sys/bus/event_source/devices/power/type", text))
+               return;
+
+            const std::uint32_t type = static_cast<std::uint32_t>(std::strtoul(text.c_str(), 0, 10));
+
+            std::vector<int> package_cpu;
+
+            for (int cpu = 0; cpu < 4096; ++cpu)
+            {
+               if (!read_file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/physical_package_id", text))
+               {
+                  if (0 == cpu) package_cpu.push_back(0);
+                  break;
+               }
+
+               const std::size_t package = std::strtoul(text.c_str(), 0, 10);
+
+               if (package >= package_cpu.size())
+                  package_cpu.resize(package + 1, -1);
+
+               if (package_cpu[package] < 0)
+                  package_cpu[package] = cpu;
+            }
+
+            const struct { const char* event; domain_t domain; } events[] =
+                     {
+                        { "energy-pkg" , e_package },
+                        { "energy-ram" , e_dram    }
+                     };
+
+            for (std::size_t e = 0; e < sizeof(events) / sizeof(events[0]); ++e)
+            {
+               const std::string path = std::string("/sys/bus/event_source/devices/power/events/") + events[e].event;
+
+               std::string config_text;
+               std::string scale_text;
+
+               if (!read_file(path, config_text) || !read_file(path + ".scale", scale_text))
+                  continue;
+
+               /* eg: event=0x02 */
+               const std::size_t eq = config_text.find('=');
+
+               const std::uint64_t config = std::strtoull(config_text.c_str() + ((std::string::npos == eq) ? 0 : eq + 1), 0, 0);
+
+               for (std::size_t p = 0; p < package_cpu.size(); ++p)
+               {
+                  if (package_cpu[p] < 0)
+                     continue;
+
+                  perf_event_attr attr;
+
+                  std::memset(&attr, 0, sizeof(attr));
+
+                  attr.type   = type;
+                  attr.size   = sizeof(attr);
+                  attr.config = config;
+
+                  const int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, -1, package_cpu[p], -1, 0));
+
+                  if (fd < 0)
+                     continue;
+
+                  counter c;
+
+                  c.domain = events[e].domain;
+                  c.fd     = fd;
+                  c.perf   = true;
+                  c.scale  = std::strtod(scale_text.c_str(), 0);
+                  c.range  = 0;
+                  c.start  = 0;
+
+                  counters_.push_back(c);
+               }
+            }
+         }
+         #endif
+
+         static inline std::uint64_t read_counter(const counter& c)
+         {
+            #ifdef SCHIFRA_ENERGY_RAPL
+            if (c.perf)
+            {
+               std::uint64_t value = 0;
+
+               return (sizeof(value) == ::read(c.fd, &value, sizeof(value))) ? value : 0;
+            }
+
+            char buffer[32] = { 0 };
+
+            if (::pread(c.fd, buffer, sizeof(buffer) - 1, 0) > 0)
+               return std::strtoull(buffer, 0, 10);
+            #else
+            (void)c;
+            #endif
+
+            return 0;
+         }
+
+         std::vector<counter>                  counters_;
+         reading                               totals_;
+         std::chrono::steady_clock::time_point start_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
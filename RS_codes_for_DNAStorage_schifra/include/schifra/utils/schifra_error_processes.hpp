@@ -24,14 +24,22 @@
 #define INCLUDE_SCHIFRA_ERROR_PROCESSES_HPP
 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <deque>
+#include <thread>
 #include <vector>
 
 #include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/utils/schifra_channel_simulator.hpp"
+#include "schifra/utils/schifra_cpu_features.hpp"
 #include "schifra/utils/schifra_fileio.hpp"
 
 
@@ -487,6 +495,435 @@ namespace schifra
       ofile.close();
    }
 
+   #ifdef SCHIFRA_FILEIO_MMAP
+
+   /*
+      The bursts of corrupt_file_with_bursts(). Bursts start at a rate of
+      burst_rate per byte (ie: geometric gaps between them) and their
+      lengths, clipped to [min_length, max_length], follow distribution:
+
+         e_fixed     - mean_length
+         e_uniform   - uniform over [min_length, max_length]
+         e_geometric - geometric of mean mean_length
+         e_pareto    - power law of exponent pareto_alpha from min_length,
+                       ie: mostly short bursts and the odd very long one
+
+      Every byte of a burst is XORed with a non-zero mask, all ones (the
+      bytes inverted, as corrupt_file_with_burst_errors() does) or, with
+      e_random_mask, an 8 byte pattern drawn for the burst.
+   */
+   struct file_burst_model
+   {
+      enum distribution_t
+      {
+         e_fixed,
+         e_uniform,
+         e_geometric,
+         e_pareto
+      };
+
+      enum mask_t
+      {
+         e_invert_mask,
+         e_random_mask
+      };
+
+      file_burst_model()
+      : burst_rate(1.0e-6),
+        distribution(e_fixed),
+        min_length(1),
+        mean_length(16),
+        max_length(4096),
+        pareto_alpha(1.5),
+        mask(e_invert_mask)
+      {}
+
+      double         burst_rate;
+      distribution_t distribution;
+      std::uint64_t  min_length;
+      std::uint64_t  mean_length;
+      std::uint64_t  max_length;
+      double         pareto_alpha;
+      mask_t         mask;
+   };
+
+   /*
+      An injected burst: byte offset + i of the file was XORed with byte
+      (i % 8) of mask, little endian, for i in [0, length).
+   */
+   struct file_burst
+   {
+      std::uint64_t offset;
+      std::uint64_t length;
+      std::uint64_t mask;
+   };
+
+   namespace details
+   {
+      /* Bursts are placed independently in segments of this size, each seeded from its index */
+      static const std::uint64_t file_burst_segment = 64ULL << 20;
+
+      /* Run task(i) for i in [0, count) over threads threads */
+      template <typename Task>
+      inline void parallel_for(const std::size_t threads, const std::size_t count, const Task& task)
+      {
+         std::atomic<std::size_t> next(0);
+
+         const auto work = [&]()
+                           {
+                              for (std::size_t i = next++; i < count; i = next++)
+                              {
+                                 task(i);
+                              }
+                           };
+
+         std::vector<std::thread> workers;
+
+         for (std::size_t t = 1; t < std::min(threads, count); ++t)
+         {
+            workers.push_back(std::thread(work));
+         }
+
+         work();
+
+         for (std::size_t t = 0; t < workers.size(); ++t)
+         {
+            workers[t].join();
+         }
+      }
+
+      inline double unit_interval(utils::channel::xoshiro256pp& rng)
+      {
+         /* [0,1) with 53 random bits */
+         return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+      }
+
+      inline std::uint64_t file_burst_length(const file_burst_model& model, utils::channel::xoshiro256pp& rng)
+      {
+         const double min_length = static_cast<double>(std::max<std::uint64_t>(1, model.min_length));
+         const double max_length = static_cast<double>(std::max<std::uint64_t>(1, model.max_length));
+         const double u          = unit_interval(rng);
+
+         double length = static_cast<double>(model.mean_length);
+
+         switch (model.distribution)
+         {
+            case file_burst_model::e_fixed     : break;
+
+            case file_burst_model::e_uniform   : length = min_length + std::floor(u * (max_length - min_length + 1.0));
+                                                 break;
+
+            case file_burst_model::e_geometric : if (model.mean_length > 1)
+                                                    length = 1.0 + std::floor(std::log1p(-u) / std::log1p(-1.0 / model.mean_length));
+                                                 else
+                                                    length = 1.0;
+                                                 break;
+
+            case file_burst_model::e_pareto    : length = std::floor(min_length * std::pow(1.0 - u, -1.0 / std::max(model.pareto_alpha, 1.0e-3)));
+                                                 break;
+         }
+
+         return static_cast<std::uint64_t>(std::min(std::max(length, min_length), max_length));
+      }
+
+      inline std::uint64_t file_burst_mask(const file_burst_model& model, utils::channel::xoshiro256pp& rng)
+      {
+         if (file_burst_model::e_invert_mask == model.mask)
+            return ~std::uint64_t(0);
+
+         std::uint64_t mask = rng();
+
+         /* A zero byte would leave its data byte intact */
+         for (unsigned int b = 0; b < 64; b += 8)
+         {
+            if (0 == ((mask >> b) & 0xFF))
+               mask |= std::uint64_t(0xFF) << b;
+         }
+
+         return mask;
+      }
+
+      /* Bursts starting in [begin, end), in order and not overlapping */
+      inline void generate_file_bursts(const file_burst_model& model,
+                                       const std::uint64_t seed,
+                                       const std::uint64_t begin,
+                                       const std::uint64_t end,
+                                       std::vector<file_burst>& bursts)
+      {
+         bursts.clear();
+
+         if (model.burst_rate <= 0.0)
+            return;
+
+         std::uint64_t state = seed ^ (begin / file_burst_segment) * 0xD1B54A32D192ED03ULL;
+         utils::channel::xoshiro256pp rng(utils::channel::splitmix64(state));
+
+         const double log_q = (model.burst_rate < 1.0) ? std::log1p(-model.burst_rate) : 0.0;
+
+         for (std::uint64_t position = begin; ; )
+         {
+            if (log_q < 0.0)
+            {
+               const double gap = std::floor(std::log(1.0 - unit_interval(rng)) / log_q);
+
+               if (gap >= static_cast<double>(end - position))
+                  break;
+
+               position += static_cast<std::uint64_t>(gap);
+            }
+
+            if (position >= end)
+               break;
+
+            file_burst burst;
+
+            burst.offset = position;
+            burst.length = file_burst_length(model, rng);
+            burst.mask   = file_burst_mask  (model, rng);
+
+            bursts.push_back(burst);
+
+            position += burst.length;
+         }
+      }
+
+      /* XOR count bytes with mask, byte i with byte (i % 8) of it */
+      inline void xor_mask(unsigned char* data, const std::size_t count, const std::uint64_t mask)
+      {
+         std::size_t i = 0;
+
+         for ( ; (i + 8) <= count; i += 8)
+         {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            word ^= mask;
+            std::memcpy(data + i, &word, 8);
+         }
+
+         for ( ; i < count; ++i)
+         {
+            data[i] ^= static_cast<unsigned char>(mask >> (8 * (i & 7)));
+         }
+      }
+
+      #if defined(SCHIFRA_CHANNEL_X86)
+
+      __attribute__((target("avx2")))
+      inline void xor_mask_avx2(unsigned char* data, const std::size_t count, const std::uint64_t mask)
+      {
+         const __m256i pattern = _mm256_set1_epi64x(static_cast<long long>(mask));
+
+         std::size_t i = 0;
+
+         for ( ; (i + 128) <= count; i += 128)
+         {
+            __m256i* p = reinterpret_cast<__m256i*>(data + i);
+
+            _mm256_storeu_si256(p + 0, _mm256_xor_si256(_mm256_loadu_si256(p + 0), pattern));
+            _mm256_storeu_si256(p + 1, _mm256_xor_si256(_mm256_loadu_si256(p + 1), pattern));
+            _mm256_storeu_si256(p + 2, _mm256_xor_si256(_mm256_loadu_si256(p + 2), pattern));
+            _mm256_storeu_si256(p + 3, _mm256_xor_si256(_mm256_loadu_si256(p + 3), pattern));
+         }
+
+         for ( ; (i + 32) <= count; i += 32)
+         {
+            __m256i* p = reinterpret_cast<__m256i*>(data + i);
+            _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), pattern));
+         }
+
+         /* i is a multiple of 8, the mask keeps its phase */
+         xor_mask(data + i, count - i, mask);
+      }
+
+      #elif defined(SCHIFRA_CHANNEL_NEON)
+
+      inline void xor_mask_neon(unsigned char* data, const std::size_t count, const std::uint64_t mask)
+      {
+         const uint8x16_t pattern = vreinterpretq_u8_u64(vdupq_n_u64(mask));
+
+         std::size_t i = 0;
+
+         for ( ; (i + 16) <= count; i += 16)
+         {
+            vst1q_u8(data + i, veorq_u8(vld1q_u8(data + i), pattern));
+         }
+
+         xor_mask(data + i, count - i, mask);
+      }
+
+      #endif
+
+      /* Apply the part of burst in [begin, end) of the file mapped at data */
+      inline void apply_file_burst(unsigned char* data, const file_burst& burst, const std::uint64_t begin, const std::uint64_t end)
+      {
+         const std::uint64_t first = std::max(begin, burst.offset);
+         const std::uint64_t last  = std::min(end  , burst.offset + burst.length);
+
+         if (first >= last)
+            return;
+
+         /* Rotate the mask so that its byte (first - offset) % 8 lands on data[first] */
+         const unsigned int  shift = static_cast<unsigned int>(8 * ((first - burst.offset) & 7));
+         const std::uint64_t mask  = shift ? ((burst.mask >> shift) | (burst.mask << (64 - shift))) : burst.mask;
+         const std::size_t   count = static_cast<std::size_t>(last - first);
+
+         #if defined(SCHIFRA_CHANNEL_X86)
+         if (utils::host_cpu_features().avx2)
+         {
+            xor_mask_avx2(data + first, count, mask);
+            return;
+         }
+         #elif defined(SCHIFRA_CHANNEL_NEON)
+         xor_mask_neon(data + first, count, mask);
+         return;
+         #endif
+
+         xor_mask(data + first, count, mask);
+      }
+
+   } // namespace details
+
+   /*
+      Inject bursts drawn from model into file_name, in place, and return
+      them in bursts, in file order, for checking against what a decoder
+      later reports (see file_burst_blocks()). The file is mapped rather
+      than streamed and the work shared between threads threads (0 for
+      one per core): bursts are drawn per 64MB segment, each seeded from
+      seed and its index, then applied over disjoint ranges of the file.
+      The bursts injected thus depend on the file size, model and seed
+      only. Injecting the same bursts again restores the file.
+   */
+   inline bool corrupt_file_with_bursts(const std::string& file_name,
+                                        const file_burst_model& model,
+                                        const std::uint64_t seed,
+                                        std::vector<file_burst>& bursts,
+                                        std::size_t threads = 0)
+   {
+      bursts.clear();
+
+      fileio::mapped_file file;
+
+      if (!file.open(file_name, true))
+      {
+         std::cout << "corrupt_file_with_bursts() - Error: " << file_name << " could not be mapped for writing!" << std::endl;
+         return false;
+      }
+
+      /* Only the burst pages are touched, read ahead would be wasted */
+      file.advise(MADV_RANDOM);
+
+      if (0 == threads)
+         threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+      const std::uint64_t size     = file.size();
+      const std::size_t   segments = static_cast<std::size_t>((size + details::file_burst_segment - 1) / details::file_burst_segment);
+
+      std::vector<std::vector<file_burst> > segment_bursts(segments);
+
+      details::parallel_for(threads, segments,
+                            [&](const std::size_t s)
+                            {
+                               details::generate_file_bursts(model, seed,
+                                                             s * details::file_burst_segment,
+                                                             std::min(size, (s + 1) * details::file_burst_segment),
+                                                             segment_bursts[s]);
+                            });
+
+      /* A burst running into the next segment wins over those it overlaps there */
+      for (std::size_t s = 0; s < segments; ++s)
+      {
+         for (std::size_t b = 0; b < segment_bursts[s].size(); ++b)
+         {
+            file_burst burst = segment_bursts[s][b];
+
+            if (!bursts.empty() && (burst.offset < (bursts.back().offset + bursts.back().length)))
+               continue;
+
+            burst.length = std::min(burst.length, size - burst.offset);
+
+            bursts.push_back(burst);
+         }
+      }
+
+      /* Disjoint ranges of the file, a burst straddling two is applied in parts */
+      const std::uint64_t range  = std::max<std::uint64_t>(1ULL << 20, (size + threads * 4 - 1) / (threads * 4));
+      const std::size_t   ranges = static_cast<std::size_t>((size + range - 1) / range);
+
+      details::parallel_for(threads, ranges,
+                            [&](const std::size_t r)
+                            {
+                               const std::uint64_t begin = r * range;
+                               const std::uint64_t end   = std::min(size, begin + range);
+
+                               /* Bursts are ordered and disjoint, so are their ends */
+                               std::vector<file_burst>::const_iterator itr =
+                                  std::upper_bound(bursts.begin(), bursts.end(), begin,
+                                                   [](const std::uint64_t position, const file_burst& burst)
+                                                   {
+                                                      return position < (burst.offset + burst.length);
+                                                   });
+
+                               for ( ; (itr != bursts.end()) && (itr->offset < end); ++itr)
+                               {
+                                  details::apply_file_burst(file.data(), *itr, begin, end);
+                               }
+                            });
+
+      file.close();
+
+      return true;
+   }
+
+   /* Indices of the block_size byte blocks of a file that bursts touch, in order */
+   inline void file_burst_blocks(const std::vector<file_burst>& bursts,
+                                 const std::uint64_t block_size,
+                                 std::vector<std::uint64_t>& blocks)
+   {
+      blocks.clear();
+
+      if (0 == block_size)
+         return;
+
+      for (std::size_t b = 0; b < bursts.size(); ++b)
+      {
+         if (0 == bursts[b].length)
+            continue;
+
+         std::uint64_t       first = bursts[b].offset / block_size;
+         const std::uint64_t last  = (bursts[b].offset + bursts[b].length - 1) / block_size;
+
+         if (!blocks.empty() && (first <= blocks.back()))
+            first = blocks.back() + 1;
+
+         for (std::uint64_t i = first; i <= last; ++i)
+         {
+            blocks.push_back(i);
+         }
+      }
+   }
+
+   /* One "offset,length,mask" line per burst, mask in hex, after a header line */
+   inline bool save_file_bursts(const std::string& file_name, const std::vector<file_burst>& bursts)
+   {
+      std::ofstream file(file_name.c_str());
+
+      if (!file)
+         return false;
+
+      file << "offset,length,mask\n";
+
+      for (std::size_t b = 0; b < bursts.size(); ++b)
+      {
+         file << std::dec << bursts[b].offset << ','
+                          << bursts[b].length << ','
+              << std::hex << bursts[b].mask   << '\n';
+      }
+
+      return static_cast<bool>(file);
+   }
+
+   #endif
+
    static const std::size_t global_random_error_index[] =
                          {
                             13,  170,  148,   66,  228,  208,  182,   92,
@@ -32,6 +32,14 @@
 
 #include "schifra/utils/schifra_crc.hpp"
 
+#if defined(__unix__) || defined(__APPLE__)
+   #define SCHIFRA_FILEIO_MMAP
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
 
 namespace schifra
 {
@@ -220,6 +228,164 @@ namespace schifra
          return crc_module.crc();
       }
 
+      #ifdef SCHIFRA_FILEIO_MMAP
+
+      /*
+         A file mapped into memory: an existing file, read-only or writable
+         in place, or one created at a given size and mapped for writing.
+         A created mapping can be shrunk on close(), eg: when the final
+         output turns out shorter than the size it was preallocated with.
+         The mapping is advised for sequential access, the way the file
+         codecs walk it.
+      */
+      class mapped_file
+      {
+      public:
+
+         mapped_file()
+         : fd_(-1),
+           data_(0),
+           size_(0),
+           writable_(false)
+         {}
+
+        ~mapped_file()
+         {
+            close();
+         }
+
+         /* Map an existing file, writable for changing it in place (it is never resized) */
+         inline bool open(const std::string& file_name, const bool writable = false)
+         {
+            close();
+
+            fd_ = ::open(file_name.c_str(), writable ? O_RDWR : O_RDONLY);
+
+            if (fd_ < 0)
+               return false;
+
+            struct stat status;
+
+            if ((0 != ::fstat(fd_, &status)) || (status.st_size <= 0))
+            {
+               close();
+               return false;
+            }
+
+            size_ = static_cast<std::size_t>(status.st_size);
+
+            return map(writable ? (PROT_READ | PROT_WRITE) : PROT_READ);
+         }
+
+         inline bool create(const std::string& file_name, const std::size_t size)
+         {
+            close();
+
+            fd_ = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+            if (fd_ < 0)
+               return false;
+
+            /* Note: An empty file is created but has nothing to map */
+            if (0 == size)
+            {
+               close();
+               return true;
+            }
+
+            if (0 != ::ftruncate(fd_, static_cast<off_t>(size)))
+            {
+               close();
+               return false;
+            }
+
+            size_     = size;
+            writable_ = true;
+
+            return map(PROT_READ | PROT_WRITE);
+         }
+
+         /* Unmap and close, a writable file is truncated to size when given */
+         inline void close(const std::size_t size = static_cast<std::size_t>(-1))
+         {
+            if (0 != data_)
+            {
+               ::munmap(data_, size_);
+               data_ = 0;
+            }
+
+            if (fd_ >= 0)
+            {
+               if (writable_ && (size < size_))
+               {
+                  if (0 != ::ftruncate(fd_, static_cast<off_t>(size)))
+                  {
+                     std::cout << "fileio::mapped_file::close() - Error: file could not be truncated." << std::endl;
+                  }
+               }
+
+               ::close(fd_);
+               fd_ = -1;
+            }
+
+            size_     = 0;
+            writable_ = false;
+         }
+
+         inline bool valid() const
+         {
+            return (0 != data_);
+         }
+
+         inline unsigned char* data() const
+         {
+            return static_cast<unsigned char*>(data_);
+         }
+
+         inline std::size_t size() const
+         {
+            return size_;
+         }
+
+         /* Replace the default sequential access advice, eg: MADV_WILLNEED */
+         inline void advise(const int advice)
+         {
+            if (0 != data_)
+            {
+               ::madvise(data_, size_, advice);
+            }
+         }
+
+      private:
+
+         mapped_file(const mapped_file&);
+         mapped_file& operator=(const mapped_file&);
+
+         inline bool map(const int protection)
+         {
+            void* data = ::mmap(0, size_, protection, MAP_SHARED, fd_, 0);
+
+            if (MAP_FAILED == data)
+            {
+               close();
+               return false;
+            }
+
+            data_ = data;
+
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+
+            return true;
+         }
+
+         int         fd_;
+         void*       data_;
+         std::size_t size_;
+         bool        writable_;
+      };
+
+      #endif
+
    } // namespace fileio
 
 } // namespace schifra
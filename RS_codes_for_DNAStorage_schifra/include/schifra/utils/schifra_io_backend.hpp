@@ -0,0 +1,817 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_IO_BACKEND_HPP
+#define INCLUDE_SCHIFRA_IO_BACKEND_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+   #define SCHIFRA_FILEIO_POSIX
+   #include <cerrno>
+   #include <fcntl.h>
+   #include <sys/types.h>
+   #include <unistd.h>
+#endif
+
+#if defined(SCHIFRA_FILEIO_POSIX) && defined(__linux__) && defined(__has_include)
+   #if __has_include(<linux/io_uring.h>)
+      #define SCHIFRA_FILEIO_URING
+      #include <linux/io_uring.h>
+      #include <sys/mman.h>
+      #include <sys/syscall.h>
+      #include <sys/uio.h>
+   #endif
+#endif
+
+
+namespace schifra
+{
+
+   namespace fileio
+   {
+
+      /*
+         I/O backends of the pipelined file coders. A backend owns the
+         input and the output file, and queues reads (from the reader
+         thread only) and writes (from the writer thread only) of caller
+         owned buffers at given offsets, up to depth() of each in flight.
+         wait_read()/wait_write() block for one completion and return the
+         tag it was submitted with, and false when it failed. The buffers
+         that requests will use may be registered up front, a request
+         then names its buffer by its registration index. alignment() is
+         the boundary that buffers, sizes and offsets need to meet for the
+         backend's fastest path, eg: direct_io_alignment for O_DIRECT.
+         open_in_place() opens a single file for both, neither created
+         nor truncated, so that writes update it where it was read, eg:
+         to repair it.
+      */
+
+      static constexpr std::size_t direct_io_alignment = 4096;
+
+      namespace details
+      {
+
+         /* Completions of the synchronous backends, reaped in submission order */
+         class completion_list
+         {
+         public:
+
+            inline void push(void* tag, const bool success)
+            {
+               completions_.push_back(completion(tag, success));
+            }
+
+            inline bool pop(void*& tag)
+            {
+               if (completions_.empty())
+                  return false;
+
+               tag = completions_.front().tag;
+
+               const bool success = completions_.front().success;
+
+               completions_.pop_front();
+
+               return success;
+            }
+
+         private:
+
+            struct completion
+            {
+               completion(void* t, const bool s)
+               : tag(t),
+                 success(s)
+               {}
+
+               void* tag;
+               bool  success;
+            };
+
+            std::deque<completion> completions_;
+         };
+
+      } // namespace details
+
+      /* Synchronous, portable backend over iostreams, the default */
+      class stream_file_io
+      {
+      public:
+
+         stream_file_io()
+         {}
+
+         inline bool open(const std::string& input_file_name, const std::string& output_file_name)
+         {
+            in_stream_ .open(input_file_name .c_str(),std::ios::binary);
+            out_stream_.open(output_file_name.c_str(),std::ios::binary);
+
+            return (in_stream_ && out_stream_);
+         }
+
+         inline bool open_in_place(const std::string& file_name)
+         {
+            in_stream_ .open(file_name.c_str(),std::ios::binary);
+            out_stream_.open(file_name.c_str(),std::ios::binary | std::ios::in | std::ios::out);
+
+            return (in_stream_ && out_stream_);
+         }
+
+         inline std::size_t depth() const
+         {
+            return 1;
+         }
+
+         inline std::size_t alignment() const
+         {
+            return 1;
+         }
+
+         inline void register_buffers(const std::vector<unsigned char*>&, const std::vector<std::size_t>&)
+         {}
+
+         inline bool submit_read(unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t, void* tag)
+         {
+            in_stream_.seekg(static_cast<std::streamoff>(offset));
+            in_stream_.read(reinterpret_cast<char*>(buffer),static_cast<std::streamsize>(size));
+
+            read_completions_.push(tag, !in_stream_.fail());
+
+            return true;
+         }
+
+         inline bool submit_write(const unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t, void* tag)
+         {
+            out_stream_.seekp(static_cast<std::streamoff>(offset));
+            out_stream_.write(reinterpret_cast<const char*>(buffer),static_cast<std::streamsize>(size));
+
+            write_completions_.push(tag, !out_stream_.fail());
+
+            return true;
+         }
+
+         inline bool wait_read(void*& tag)
+         {
+            return read_completions_.pop(tag);
+         }
+
+         inline bool wait_write(void*& tag)
+         {
+            return write_completions_.pop(tag);
+         }
+
+         inline void close()
+         {
+            in_stream_ .close();
+            out_stream_.close();
+         }
+
+      private:
+
+         stream_file_io(const stream_file_io&);
+         stream_file_io& operator=(const stream_file_io&);
+
+         std::ifstream            in_stream_;
+         std::ofstream            out_stream_;
+         details::completion_list read_completions_;
+         details::completion_list write_completions_;
+      };
+
+      #ifdef SCHIFRA_FILEIO_POSIX
+
+      namespace details
+      {
+
+         inline bool direct_io_aligned(const void* buffer, const std::size_t size, const std::uint64_t offset)
+         {
+            return (0 == (reinterpret_cast<std::uintptr_t>(buffer) % direct_io_alignment)) &&
+                   (0 == (size   % direct_io_alignment)) &&
+                   (0 == (offset % direct_io_alignment));
+         }
+
+         /*
+            Open file_name with flags, and when direct a second O_DIRECT
+            descriptor of the same file. Where O_DIRECT is refused (eg: by
+            tmpfs) direct_fd is fd, and all I/O is buffered.
+         */
+         inline bool open_file(const std::string& file_name, const int flags, const bool direct, int& fd, int& direct_fd)
+         {
+            fd        = ::open(file_name.c_str(), flags, 0644);
+            direct_fd = fd;
+
+            if (fd < 0)
+               return false;
+
+            #ifdef O_DIRECT
+            if (direct)
+            {
+               const int dfd = ::open(file_name.c_str(), (flags & ~(O_CREAT | O_TRUNC)) | O_DIRECT);
+
+               if (dfd >= 0)
+                  direct_fd = dfd;
+            }
+            #else
+            (void)direct;
+            #endif
+
+            return true;
+         }
+
+         inline void close_file(int& fd, int& direct_fd)
+         {
+            if (direct_fd != fd)
+               ::close(direct_fd);
+
+            if (fd >= 0)
+               ::close(fd);
+
+            fd        = -1;
+            direct_fd = -1;
+         }
+
+      } // namespace details
+
+      /*
+         Synchronous pread/pwrite backend. With direct, requests that meet
+         direct_io_alignment bypass the page cache through O_DIRECT, the
+         rest (eg: the unaligned tail of a file) are buffered, so the
+         files are byte for byte those of a buffered run.
+      */
+      class posix_file_io
+      {
+      public:
+
+         explicit posix_file_io(const bool direct = false)
+         : direct_(direct),
+           input_fd_ (-1),
+           input_direct_fd_ (-1),
+           output_fd_(-1),
+           output_direct_fd_(-1)
+         {}
+
+        ~posix_file_io()
+         {
+            close();
+         }
+
+         inline bool open(const std::string& input_file_name, const std::string& output_file_name)
+         {
+            return details::open_file(input_file_name , O_RDONLY                      , direct_, input_fd_ , input_direct_fd_ ) &&
+                   details::open_file(output_file_name, O_WRONLY | O_CREAT | O_TRUNC , direct_, output_fd_, output_direct_fd_);
+         }
+
+         inline bool open_in_place(const std::string& file_name)
+         {
+            return details::open_file(file_name, O_RDONLY, direct_, input_fd_ , input_direct_fd_ ) &&
+                   details::open_file(file_name, O_WRONLY, direct_, output_fd_, output_direct_fd_);
+         }
+
+         inline std::size_t depth() const
+         {
+            return 1;
+         }
+
+         inline std::size_t alignment() const
+         {
+            return direct_ ? direct_io_alignment : 1;
+         }
+
+         inline void register_buffers(const std::vector<unsigned char*>&, const std::vector<std::size_t>&)
+         {}
+
+         inline bool submit_read(unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t, void* tag)
+         {
+            const int fd = details::direct_io_aligned(buffer, size, offset) ? input_direct_fd_ : input_fd_;
+
+            std::size_t done = 0;
+
+            while (done < size)
+            {
+               const ssize_t result = ::pread(fd, buffer + done, size - done, static_cast<off_t>(offset + done));
+
+               if ((result < 0) && (EINTR == errno))
+                  continue;
+
+               if (result <= 0)
+                  break;
+
+               done += static_cast<std::size_t>(result);
+            }
+
+            read_completions_.push(tag, done == size);
+
+            return true;
+         }
+
+         inline bool submit_write(const unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t, void* tag)
+         {
+            const int fd = details::direct_io_aligned(buffer, size, offset) ? output_direct_fd_ : output_fd_;
+
+            std::size_t done = 0;
+
+            while (done < size)
+            {
+               const ssize_t result = ::pwrite(fd, buffer + done, size - done, static_cast<off_t>(offset + done));
+
+               if ((result < 0) && (EINTR == errno))
+                  continue;
+
+               if (result <= 0)
+                  break;
+
+               done += static_cast<std::size_t>(result);
+            }
+
+            write_completions_.push(tag, done == size);
+
+            return true;
+         }
+
+         inline bool wait_read(void*& tag)
+         {
+            return read_completions_.pop(tag);
+         }
+
+         inline bool wait_write(void*& tag)
+         {
+            return write_completions_.pop(tag);
+         }
+
+         inline void close()
+         {
+            details::close_file(input_fd_ , input_direct_fd_ );
+            details::close_file(output_fd_, output_direct_fd_);
+         }
+
+      private:
+
+         posix_file_io(const posix_file_io&);
+         posix_file_io& operator=(const posix_file_io&);
+
+         const bool               direct_;
+         int                      input_fd_;
+         int                      input_direct_fd_;
+         int                      output_fd_;
+         int                      output_direct_fd_;
+         details::completion_list read_completions_;
+         details::completion_list write_completions_;
+      };
+
+      #endif
+
+      #ifdef SCHIFRA_FILEIO_URING
+
+      /*
+         Linux io_uring backend. Reads and writes go through two rings,
+         one per thread, so neither side locks, and up to queue_depth of
+         each stay in flight while the workers code. Both files are
+         registered with each ring, as are the buffers when the kernel
+         accepts them (RLIMIT_MEMLOCK permitting), otherwise plain
+         READ/WRITE requests are used. Short transfers are resubmitted
+         for the remainder before they complete. With direct, requests
+         that meet direct_io_alignment go through O_DIRECT descriptors, as
+         with posix_file_io.
+      */
+      class uring_file_io
+      {
+      public:
+
+         static constexpr std::size_t default_queue_depth = 8;
+
+         explicit uring_file_io(const std::size_t queue_depth = default_queue_depth, const bool direct = false)
+         : depth_((queue_depth > 0) ? queue_depth : 1),
+           direct_(direct),
+           input_fd_ (-1),
+           input_direct_fd_ (-1),
+           output_fd_(-1),
+           output_direct_fd_(-1)
+         {}
+
+        ~uring_file_io()
+         {
+            close();
+         }
+
+         inline bool open(const std::string& input_file_name, const std::string& output_file_name)
+         {
+            if (
+                 !details::open_file(input_file_name , O_RDONLY                     , direct_, input_fd_ , input_direct_fd_ ) ||
+                 !details::open_file(output_file_name, O_WRONLY | O_CREAT | O_TRUNC, direct_, output_fd_, output_direct_fd_)
+               )
+            {
+               return false;
+            }
+
+            return read_ring_ .setup(depth_, input_fd_ , input_direct_fd_ ) &&
+                   write_ring_.setup(depth_, output_fd_, output_direct_fd_);
+         }
+
+         inline bool open_in_place(const std::string& file_name)
+         {
+            if (
+                 !details::open_file(file_name, O_RDONLY, direct_, input_fd_ , input_direct_fd_ ) ||
+                 !details::open_file(file_name, O_WRONLY, direct_, output_fd_, output_direct_fd_)
+               )
+            {
+               return false;
+            }
+
+            return read_ring_ .setup(depth_, input_fd_ , input_direct_fd_ ) &&
+                   write_ring_.setup(depth_, output_fd_, output_direct_fd_);
+         }
+
+         inline std::size_t depth() const
+         {
+            return depth_;
+         }
+
+         inline std::size_t alignment() const
+         {
+            return direct_ ? direct_io_alignment : 1;
+         }
+
+         inline void register_buffers(const std::vector<unsigned char*>& buffers, const std::vector<std::size_t>& sizes)
+         {
+            std::vector<iovec> iov(buffers.size());
+
+            for (std::size_t i = 0; i < buffers.size(); ++i)
+            {
+               iov[i].iov_base = buffers[i];
+               iov[i].iov_len  = sizes[i];
+            }
+
+            read_ring_ .register_buffers(iov);
+            write_ring_.register_buffers(iov);
+         }
+
+         inline bool submit_read(unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t buffer_index, void* tag)
+         {
+            return read_ring_.submit(IORING_OP_READ, IORING_OP_READ_FIXED, buffer, size, offset, buffer_index, tag);
+         }
+
+         inline bool submit_write(const unsigned char* buffer, const std::size_t size, const std::uint64_t offset, const std::size_t buffer_index, void* tag)
+         {
+            return write_ring_.submit(IORING_OP_WRITE, IORING_OP_WRITE_FIXED, const_cast<unsigned char*>(buffer), size, offset, buffer_index, tag);
+         }
+
+         inline bool wait_read(void*& tag)
+         {
+            return read_ring_.wait(tag);
+         }
+
+         inline bool wait_write(void*& tag)
+         {
+            return write_ring_.wait(tag);
+         }
+
+         inline void close()
+         {
+            read_ring_ .close();
+            write_ring_.close();
+
+            details::close_file(input_fd_ , input_direct_fd_ );
+            details::close_file(output_fd_, output_direct_fd_);
+         }
+
+      private:
+
+         uring_file_io(const uring_file_io&);
+         uring_file_io& operator=(const uring_file_io&);
+
+         class ring
+         {
+         public:
+
+            ring()
+            : ring_fd_(-1),
+              fds_(),
+              sq_ring_(0),
+              cq_ring_(0),
+              sqes_(0),
+              sq_ring_size_(0),
+              cq_ring_size_(0),
+              sqes_size_(0),
+              sq_tail_(0),
+              sq_mask_(0),
+              sq_array_(0),
+              cq_head_(0),
+              cq_tail_(0),
+              cq_mask_(0),
+              cqes_(0),
+              files_registered_(false),
+              buffers_registered_(false)
+            {}
+
+            inline bool setup(const std::size_t depth, const int fd, const int direct_fd)
+            {
+               io_uring_params params;
+               std::memset(&params, 0, sizeof(params));
+
+               ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned int>(depth), &params));
+
+               if (ring_fd_ < 0)
+                  return false;
+
+               sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+               cq_ring_size_ = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+               sqes_size_    = params.sq_entries * sizeof(io_uring_sqe);
+
+               if (params.features & IORING_FEAT_SINGLE_MMAP)
+               {
+                  sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+               }
+
+               sq_ring_ = ::mmap(0, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+
+               if (MAP_FAILED == sq_ring_)
+               {
+                  sq_ring_ = 0;
+                  return false;
+               }
+
+               if (params.features & IORING_FEAT_SINGLE_MMAP)
+                  cq_ring_ = sq_ring_;
+               else
+               {
+                  cq_ring_ = ::mmap(0, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+
+                  if (MAP_FAILED == cq_ring_)
+                  {
+                     cq_ring_ = 0;
+                     return false;
+                  }
+               }
+
+               sqes_ = static_cast<io_uring_sqe*>(::mmap(0, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+
+               if (MAP_FAILED == static_cast<void*>(sqes_))
+               {
+                  sqes_ = 0;
+                  return false;
+               }
+
+               unsigned char* sq = static_cast<unsigned char*>(sq_ring_);
+               unsigned char* cq = static_cast<unsigned char*>(cq_ring_);
+
+               sq_tail_  = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail        );
+               sq_mask_  = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask  );
+               sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array       );
+               cq_head_  = reinterpret_cast<unsigned int*>(cq + params.cq_off.head        );
+               cq_tail_  = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail        );
+               cq_mask_  = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask  );
+               cqes_     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes        );
+
+               requests_.resize(params.sq_entries);
+
+               for (std::size_t i = 0; i < requests_.size(); ++i)
+               {
+                  free_requests_.push_back(i);
+               }
+
+               /*
+                  Note: The buffered and direct descriptors are registered
+                        as fixed files 0 and 1, requests refer to them by
+                        index.
+               */
+               fds_[0] = fd;
+               fds_[1] = direct_fd;
+
+               files_registered_ = (0 == ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES, fds_, 2));
+
+               return true;
+            }
+
+            inline void register_buffers(const std::vector<iovec>& iov)
+            {
+               if ((ring_fd_ < 0) || iov.empty())
+                  return;
+
+               buffers_registered_ = (0 == ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                                                     &iov[0], static_cast<unsigned int>(iov.size())));
+            }
+
+            inline bool submit(const unsigned int opcode, const unsigned int fixed_opcode,
+                               unsigned char* buffer, const std::size_t size, const std::uint64_t offset,
+                               const std::size_t buffer_index, void* tag)
+            {
+               if ((ring_fd_ < 0) || free_requests_.empty())
+                  return false;
+
+               const std::size_t r = free_requests_.back();
+               free_requests_.pop_back();
+
+               request& req = requests_[r];
+
+               req.opcode       = buffers_registered_ ? fixed_opcode : opcode;
+               req.buffer       = buffer;
+               req.size         = size;
+               req.offset       = offset;
+               req.buffer_index = buffer_index;
+               req.tag          = tag;
+
+               return push(r);
+            }
+
+            inline bool wait(void*& tag)
+            {
+               for ( ; ; )
+               {
+                  const unsigned int head = *cq_head_;
+
+                  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+                  {
+                     const long result = ::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, 0, 0);
+
+                     if ((result < 0) && (EINTR != errno))
+                        return false;
+
+                     continue;
+                  }
+
+                  const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+
+                  const std::size_t r   = static_cast<std::size_t>(cqe.user_data);
+                  const int         res = cqe.res;
+
+                  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+                  request& req = requests_[r];
+
+                  if ((-EAGAIN == res) || (-EINTR == res))
+                  {
+                     if (!push(r))
+                        return complete(r, tag, false);
+
+                     continue;
+                  }
+
+                  if (res <= 0)
+                     return complete(r, tag, false);
+
+                  if (static_cast<std::size_t>(res) < req.size)
+                  {
+                     req.buffer += res;
+                     req.size   -= static_cast<std::size_t>(res);
+                     req.offset += static_cast<std::uint64_t>(res);
+
+                     if (!push(r))
+                        return complete(r, tag, false);
+
+                     continue;
+                  }
+
+                  return complete(r, tag, true);
+               }
+            }
+
+            inline void close()
+            {
+               if (0 != sqes_)
+               {
+                  ::munmap(sqes_, sqes_size_);
+                  sqes_ = 0;
+               }
+
+               if ((0 != cq_ring_) && (cq_ring_ != sq_ring_))
+                  ::munmap(cq_ring_, cq_ring_size_);
+
+               if (0 != sq_ring_)
+                  ::munmap(sq_ring_, sq_ring_size_);
+
+               sq_ring_ = 0;
+               cq_ring_ = 0;
+
+               if (ring_fd_ >= 0)
+               {
+                  ::close(ring_fd_);
+                  ring_fd_ = -1;
+               }
+
+               requests_.clear();
+               free_requests_.clear();
+
+               files_registered_   = false;
+               buffers_registered_ = false;
+            }
+
+         private:
+
+            struct request
+            {
+               unsigned int   opcode;
+               unsigned char* buffer;
+               std::size_t    size;
+               std::uint64_t  offset;
+               std::size_t    buffer_index;
+               void*          tag;
+            };
+
+            inline bool push(const std::size_t r)
+            {
+               const request& req  = requests_[r];
+               const unsigned int tail = *sq_tail_;
+               const unsigned int slot = tail & sq_mask_;
+
+               io_uring_sqe& sqe = sqes_[slot];
+               std::memset(&sqe, 0, sizeof(sqe));
+
+               const std::size_t file = ((fds_[1] != fds_[0]) && details::direct_io_aligned(req.buffer, req.size, req.offset)) ? 1 : 0;
+
+               sqe.opcode    = static_cast<std::uint8_t>(req.opcode);
+               sqe.fd        = files_registered_ ? static_cast<int>(file) : fds_[file];
+               sqe.flags     = files_registered_ ? static_cast<std::uint8_t>(IOSQE_FIXED_FILE) : 0;
+               sqe.addr      = reinterpret_cast<std::uint64_t>(req.buffer);
+               sqe.len       = static_cast<std::uint32_t>(req.size);
+               sqe.off       = req.offset;
+               sqe.buf_index = static_cast<std::uint16_t>(req.buffer_index);
+               sqe.user_data = static_cast<std::uint64_t>(r);
+
+               sq_array_[slot] = slot;
+
+               __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+               for ( ; ; )
+               {
+                  const long result = ::syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, 0, 0);
+
+                  if (result >= 0)
+                     return true;
+
+                  if (EINTR != errno)
+                     return false;
+               }
+            }
+
+            inline bool complete(const std::size_t r, void*& tag, const bool success)
+            {
+               tag = requests_[r].tag;
+               free_requests_.push_back(r);
+               return success;
+            }
+
+            int                      ring_fd_;
+            int                      fds_[2];
+            void*                    sq_ring_;
+            void*                    cq_ring_;
+            io_uring_sqe*            sqes_;
+            std::size_t              sq_ring_size_;
+            std::size_t              cq_ring_size_;
+            std::size_t              sqes_size_;
+            unsigned int*            sq_tail_;
+            unsigned int             sq_mask_;
+            unsigned int*            sq_array_;
+            unsigned int*            cq_head_;
+            unsigned int*            cq_tail_;
+            unsigned int             cq_mask_;
+            io_uring_cqe*            cqes_;
+            bool                     files_registered_;
+            bool                     buffers_registered_;
+            std::vector<request>     requests_;
+            std::vector<std::size_t> free_requests_;
+         };
+
+         const std::size_t depth_;
+         const bool        direct_;
+         int               input_fd_;
+         int               input_direct_fd_;
+         int               output_fd_;
+         int               output_direct_fd_;
+         ring              read_ring_;
+         ring              write_ring_;
+      };
+
+      #endif
+
+   } // namespace fileio
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,183 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_LATENCY_HISTOGRAM_HPP
+#define INCLUDE_SCHIFRA_LATENCY_HISTOGRAM_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Log-linear (HDR style) histogram of non-negative integer samples,
+         eg: latencies in nanoseconds. Values below 128 have a bucket each,
+         above that every power of two range is split into 64 buckets, so
+         any recorded value is reported to within 1/64 (1.6%) of itself
+         over the whole 64 bit range. record() is a bucket increment with
+         no allocation, so one histogram per thread can sit in a timed
+         loop, the per thread histograms being merged afterwards.
+      */
+      class latency_histogram
+      {
+      public:
+
+         static constexpr std::size_t linear_buckets = 128;
+         static constexpr std::size_t sub_buckets    =  64;
+         static constexpr std::size_t bucket_count   = linear_buckets + (63 - 6) * sub_buckets;
+
+         latency_histogram()
+         {
+            reset();
+         }
+
+         inline void reset()
+         {
+            std::fill(counts_, counts_ + bucket_count, 0);
+
+            count_ = 0;
+            sum_   = 0;
+            min_   = std::numeric_limits<std::uint64_t>::max();
+            max_   = 0;
+         }
+
+         inline void record(const std::uint64_t value)
+         {
+            ++counts_[bucket_index(value)];
+            ++count_;
+
+            sum_ += value;
+            min_  = std::min(min_, value);
+            max_  = std::max(max_, value);
+         }
+
+         inline void merge(const latency_histogram& histogram)
+         {
+            for (std::size_t i = 0; i < bucket_count; ++i)
+            {
+               counts_[i] += histogram.counts_[i];
+            }
+
+            count_ += histogram.count_;
+            sum_   += histogram.sum_;
+            min_    = std::min(min_, histogram.min_);
+            max_    = std::max(max_, histogram.max_);
+         }
+
+         inline std::uint64_t count() const { return count_;                    }
+         inline std::uint64_t min  () const { return (0 == count_) ? 0 : min_;  }
+         inline std::uint64_t max  () const { return max_;                      }
+
+         inline double mean() const
+         {
+            return (0 == count_) ? 0.0 : static_cast<double>(sum_) / count_;
+         }
+
+         /*
+            Smallest recorded value v such that at least percentile % of
+            the samples are <= v, given as the upper end of v's bucket
+            (clamped to the largest sample). Zero when nothing is recorded.
+         */
+         std::uint64_t percentile(const double percentile) const
+         {
+            if (0 == count_)
+               return 0;
+
+            const double        clamped = std::min(100.0, std::max(0.0, percentile));
+            const std::uint64_t rank    = std::max<std::uint64_t>(1, static_cast<std::uint64_t>((clamped / 100.0) * count_ + 0.5));
+
+            std::uint64_t running = 0;
+
+            for (std::size_t i = 0; i < bucket_count; ++i)
+            {
+               running += counts_[i];
+
+               if (running >= rank)
+                  return std::min(max_, std::max(min_, bucket_upper(i)));
+            }
+
+            return max_;
+         }
+
+      private:
+
+         static inline std::size_t msb(std::uint64_t value)
+         {
+            #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(63 - __builtin_clzll(value));
+            #else
+            std::size_t r = 0;
+
+            while (value >>= 1)
+            {
+               ++r;
+            }
+
+            return r;
+            #endif
+         }
+
+         /*
+            Note: For value >= 128 with highest bit m, shift = m - 6 brings
+                  it into [64,128), the top 7 bits select the bucket.
+         */
+         static inline std::size_t bucket_index(const std::uint64_t value)
+         {
+            if (value < linear_buckets)
+               return static_cast<std::size_t>(value);
+
+            const std::size_t shift = msb(value) - 6;
+
+            return linear_buckets + (shift - 1) * sub_buckets + static_cast<std::size_t>((value >> shift) - sub_buckets);
+         }
+
+         static inline std::uint64_t bucket_upper(const std::size_t index)
+         {
+            if (index < linear_buckets)
+               return index;
+
+            const std::size_t   shift    = ((index - linear_buckets) / sub_buckets) + 1;
+            const std::uint64_t mantissa = ((index - linear_buckets) % sub_buckets) + sub_buckets;
+
+            return ((mantissa + 1) << shift) - 1;
+         }
+
+         std::uint64_t counts_[bucket_count];
+         std::uint64_t count_;
+         std::uint64_t sum_;
+         std::uint64_t min_;
+         std::uint64_t max_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
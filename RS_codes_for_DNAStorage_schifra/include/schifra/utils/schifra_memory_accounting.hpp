@@ -0,0 +1,319 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_MEMORY_ACCOUNTING_HPP
+#define INCLUDE_SCHIFRA_MEMORY_ACCOUNTING_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "schifra/utils/schifra_metrics.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Bytes held by each component of the library, now and at their
+         peak, so that the number of concurrent codecs, pipelines and
+         threads can be sized against a memory limit rather than guessed:
+
+            field_tables     : antilog, log, inverse and mul/div/exp tables
+                               of every galois::field (a table image the
+                               field does not own is not counted)
+            decoder_tables   : root and syndrome exponents and multipliers
+                               shared by the decoders of a code
+            codec_instances  : general_codec objects and the encoders and
+                               decoders they have built
+            object_pools     : arrays of every object_pool, handed out or
+                               cached
+            batch_arenas     : buffers of the batch_arenas
+            pipeline_queues  : chunk buffers of the file pipelines and the
+                               slots of their rings
+
+         The accounting is done when memory is allocated or freed, which
+         for all of these is at construction, growth or destruction, never
+         per codeword; it is two atomic adds and a peak update.
+      */
+      namespace memory
+      {
+
+         enum component_t
+         {
+            e_field_tables    = 0,
+            e_decoder_tables  = 1,
+            e_codec_instances = 2,
+            e_object_pools    = 3,
+            e_batch_arenas    = 4,
+            e_pipeline_queues = 5,
+            e_component_count = 6
+         };
+
+         inline const char* component_name(const component_t component)
+         {
+            switch (component)
+            {
+               case e_field_tables    : return "field_tables";
+               case e_decoder_tables  : return "decoder_tables";
+               case e_codec_instances : return "codec_instances";
+               case e_object_pools    : return "object_pools";
+               case e_batch_arenas    : return "batch_arenas";
+               case e_pipeline_queues : return "pipeline_queues";
+               default                : return "unknown";
+            }
+         }
+
+         struct usage
+         {
+            usage()
+            : current(0),
+              peak(0)
+            {}
+
+            std::size_t current;
+            std::size_t peak;
+         };
+
+         struct snapshot
+         {
+            /* Keeps the larger of each, eg: over the samples of a run */
+            inline void merge(const snapshot& s)
+            {
+               for (std::size_t i = 0; i < e_component_count; ++i)
+               {
+                  components[i].current = std::max(components[i].current, s.components[i].current);
+                  components[i].peak    = std::max(components[i].peak   , s.components[i].peak   );
+               }
+
+               total.current = std::max(total.current, s.total.current);
+               total.peak    = std::max(total.peak   , s.total.peak   );
+            }
+
+            void print(std::FILE* out) const;
+
+            usage components[e_component_count];
+
+            /* Over every component, its peak being that of the sum */
+            usage total;
+         };
+
+         inline void snapshot::print(std::FILE* out) const
+         {
+            std::fprintf(out, "memory: %zu bytes, peak %zu bytes\n", total.current, total.peak);
+
+            for (std::size_t i = 0; i < e_component_count; ++i)
+            {
+               std::fprintf(out, "  %-16s %14zu bytes, peak %14zu bytes\n",
+                            component_name(static_cast<component_t>(i)),
+                            components[i].current,
+                            components[i].peak);
+            }
+         }
+
+         namespace details
+         {
+            struct counter
+            {
+               std::atomic<std::size_t> current;
+               std::atomic<std::size_t> peak;
+            };
+
+            /* One per component, then the total */
+            inline counter counters[e_component_count + 1];
+
+            inline void add(counter& c, const std::size_t bytes)
+            {
+               const std::size_t current = c.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+               std::size_t peak = c.peak.load(std::memory_order_relaxed);
+
+               while ((current > peak) && !c.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+               {}
+            }
+
+            inline usage read(const counter& c)
+            {
+               usage u;
+               u.current = c.current.load(std::memory_order_relaxed);
+               u.peak    = c.peak   .load(std::memory_order_relaxed);
+               return u;
+            }
+         }
+
+         inline void allocated(const component_t component, const std::size_t bytes)
+         {
+            if (0 == bytes)
+               return;
+
+            details::add(details::counters[component], bytes);
+            details::add(details::counters[e_component_count], bytes);
+         }
+
+         inline void released(const component_t component, const std::size_t bytes)
+         {
+            if (0 == bytes)
+               return;
+
+            details::counters[component        ].current.fetch_sub(bytes, std::memory_order_relaxed);
+            details::counters[e_component_count].current.fetch_sub(bytes, std::memory_order_relaxed);
+         }
+
+         inline usage current(const component_t component)
+         {
+            return details::read(details::counters[component]);
+         }
+
+         inline snapshot totals()
+         {
+            snapshot s;
+
+            for (std::size_t i = 0; i < e_component_count; ++i)
+            {
+               s.components[i] = details::read(details::counters[i]);
+            }
+
+            s.total = details::read(details::counters[e_component_count]);
+
+            return s;
+         }
+
+         /* Start the peaks over from what is held now */
+         inline void reset_peaks()
+         {
+            for (std::size_t i = 0; i <= e_component_count; ++i)
+            {
+               details::counters[i].peak.store(details::counters[i].current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+         }
+
+         /*
+            Bytes a component holds on behalf of an object, accounted for
+            as long as the charge lives, eg: as a member of the object.
+         */
+         class charge
+         {
+         public:
+
+            explicit charge(const component_t component, const std::size_t bytes = 0)
+            : component_(component),
+              bytes_(bytes)
+            {
+               allocated(component_, bytes_);
+            }
+
+            charge(charge&& c) noexcept
+            : component_(c.component_),
+              bytes_(c.bytes_)
+            {
+               c.bytes_ = 0;
+            }
+
+            charge& operator=(charge&& c) noexcept
+            {
+               if (this != &c)
+               {
+                  released(component_, bytes_);
+                  component_ = c.component_;
+                  bytes_     = c.bytes_;
+                  c.bytes_   = 0;
+               }
+
+               return *this;
+            }
+
+            charge(const charge&) = delete;
+            charge& operator=(const charge&) = delete;
+
+           ~charge()
+            {
+               released(component_, bytes_);
+            }
+
+            /* The object now holds bytes */
+            inline void resize(const std::size_t bytes)
+            {
+               if (bytes > bytes_)
+                  allocated(component_, bytes - bytes_);
+               else
+                  released(component_, bytes_ - bytes);
+
+               bytes_ = bytes;
+            }
+
+            inline std::size_t bytes() const
+            {
+               return bytes_;
+            }
+
+         private:
+
+            component_t component_;
+            std::size_t bytes_;
+         };
+
+         /*
+            Publish totals() through a metrics registry, read on every
+            scrape: the current and peak bytes of each component and of
+            them all.
+         */
+         inline void export_metrics(utils::metrics::registry& registry)
+         {
+            registry.add_collector([](std::vector<utils::metrics::sample>& samples)
+            {
+               typedef utils::metrics::registry r;
+
+               const snapshot s = totals();
+
+               const char* current_help = "Bytes held by each component of the library";
+               const char* peak_help    = "Most bytes held by each component of the library";
+
+               for (std::size_t i = 0; i <= e_component_count; ++i)
+               {
+                  const usage& u = (i < e_component_count) ? s.components[i] : s.total;
+
+                  const std::string label = std::string("component=\"") +
+                                            ((i < e_component_count) ? component_name(static_cast<component_t>(i)) : "total") + "\"";
+
+                  samples.push_back(r::make_sample("schifra_memory_bytes", current_help, utils::metrics::e_gauge,
+                                                   "schifra_memory_bytes", label, static_cast<double>(u.current)));
+                  samples.push_back(r::make_sample("schifra_memory_peak_bytes", peak_help, utils::metrics::e_gauge,
+                                                   "schifra_memory_peak_bytes", label, static_cast<double>(u.peak)));
+               }
+            });
+         }
+
+      } // namespace memory
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
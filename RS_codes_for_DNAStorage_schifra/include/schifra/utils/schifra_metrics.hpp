@@ -0,0 +1,481 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_METRICS_HPP
+#define INCLUDE_SCHIFRA_METRICS_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Metrics of a long running codec service: counters, gauges and
+         histograms, read either as samples (collect()) or rendered in the
+         Prometheus text exposition format (prometheus_text()), eg: served
+         on /metrics by whatever HTTP layer the service already has.
+
+         Counters and histograms are split into cache line sized shards, a
+         thread always updating the same shard with a relaxed atomic add,
+         so updates from the codec threads neither lock nor contend. The
+         shards are only summed when the metrics are scraped.
+
+         Values owned elsewhere, eg: the depth of a bounded_queue or the
+         decoder instrumentation totals, are pulled at scrape time through
+         callbacks and collectors.
+      */
+      namespace metrics
+      {
+
+         static constexpr std::size_t shard_count = 16;
+
+         /* Shard of the calling thread, threads being dealt round-robin */
+         inline std::size_t shard_index()
+         {
+            static std::atomic<std::size_t> next_shard(0);
+            static thread_local const std::size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+            return index;
+         }
+
+         class counter
+         {
+         public:
+
+            counter() {}
+
+            inline void add(const std::uint64_t amount = 1)
+            {
+               shards_[shard_index()].value.fetch_add(amount, std::memory_order_relaxed);
+            }
+
+            inline std::uint64_t value() const
+            {
+               std::uint64_t total = 0;
+
+               for (std::size_t i = 0; i < shard_count; ++i)
+               {
+                  total += shards_[i].value.load(std::memory_order_relaxed);
+               }
+
+               return total;
+            }
+
+         private:
+
+            counter(const counter&);
+            counter& operator=(const counter&);
+
+            struct alignas(64) shard
+            {
+               shard() : value(0) {}
+
+               std::atomic<std::uint64_t> value;
+            };
+
+            shard shards_[shard_count];
+         };
+
+         /* A value that goes up and down, eg: blocks in flight */
+         class gauge
+         {
+         public:
+
+            gauge() : value_(0) {}
+
+            inline void set(const std::int64_t value) { value_.store(value, std::memory_order_relaxed);      }
+            inline void add(const std::int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed);  }
+            inline void sub(const std::int64_t delta) { value_.fetch_sub(delta, std::memory_order_relaxed);  }
+
+            inline std::int64_t value() const
+            {
+               return value_.load(std::memory_order_relaxed);
+            }
+
+         private:
+
+            gauge(const gauge&);
+            gauge& operator=(const gauge&);
+
+            std::atomic<std::int64_t> value_;
+         };
+
+         /*
+            Cumulative histogram of integer observations, eg: decode latency
+            in nanoseconds, over fixed ascending upper bounds plus +Inf.
+         */
+         class histogram
+         {
+         public:
+
+            explicit histogram(const std::vector<std::uint64_t>& upper_bounds)
+            : bounds_(upper_bounds),
+              shards_(new shard[shard_count])
+            {
+               for (std::size_t i = 0; i < shard_count; ++i)
+               {
+                  shards_[i].buckets.reset(new std::atomic<std::uint64_t>[bounds_.size() + 1]);
+
+                  for (std::size_t b = 0; b <= bounds_.size(); ++b)
+                  {
+                     shards_[i].buckets[b].store(0, std::memory_order_relaxed);
+                  }
+               }
+            }
+
+            /* count bounds start, start * factor, start * factor^2, ... */
+            static inline std::vector<std::uint64_t> exponential_bounds(const std::uint64_t start,
+                                                                       const double        factor,
+                                                                       const std::size_t   count)
+            {
+               std::vector<std::uint64_t> bounds;
+               double bound = static_cast<double>(start);
+
+               for (std::size_t i = 0; i < count; ++i, bound *= factor)
+               {
+                  const std::uint64_t b = static_cast<std::uint64_t>(bound);
+
+                  if (bounds.empty() || (b > bounds.back()))
+                     bounds.push_back(b);
+               }
+
+               return bounds;
+            }
+
+            inline void observe(const std::uint64_t value)
+            {
+               std::size_t b = 0;
+
+               while ((b < bounds_.size()) && (value > bounds_[b]))
+               {
+                  ++b;
+               }
+
+               shard& s = shards_[shard_index()];
+
+               s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+               s.sum.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            inline const std::vector<std::uint64_t>& upper_bounds() const
+            {
+               return bounds_;
+            }
+
+            /* Per bucket (not cumulative) counts, the last one being +Inf */
+            inline std::vector<std::uint64_t> counts() const
+            {
+               std::vector<std::uint64_t> result(bounds_.size() + 1, 0);
+
+               for (std::size_t i = 0; i < shard_count; ++i)
+               {
+                  for (std::size_t b = 0; b <= bounds_.size(); ++b)
+                  {
+                     result[b] += shards_[i].buckets[b].load(std::memory_order_relaxed);
+                  }
+               }
+
+               return result;
+            }
+
+            inline std::uint64_t sum() const
+            {
+               std::uint64_t total = 0;
+
+               for (std::size_t i = 0; i < shard_count; ++i)
+               {
+                  total += shards_[i].sum.load(std::memory_order_relaxed);
+               }
+
+               return total;
+            }
+
+         private:
+
+            histogram(const histogram&);
+            histogram& operator=(const histogram&);
+
+            struct alignas(64) shard
+            {
+               shard() : sum(0) {}
+
+               std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;
+               std::atomic<std::uint64_t>                    sum;
+            };
+
+            const std::vector<std::uint64_t> bounds_;
+            std::unique_ptr<shard[]>         shards_;
+         };
+
+         enum metric_t
+         {
+            e_counter   = 0,
+            e_gauge     = 1,
+            e_histogram = 2
+         };
+
+         /*
+            One exported value. family is the metric name HELP and TYPE
+            refer to, name the sample's own (family_bucket, family_sum,
+            family_count for histograms), labels the inside of the braces,
+            eg: stage="forney", or empty.
+         */
+         struct sample
+         {
+            std::string family;
+            std::string help;
+            metric_t    type;
+            std::string name;
+            std::string labels;
+            double      value;
+         };
+
+         class registry
+         {
+         public:
+
+            typedef std::function<void(std::vector<sample>&)> collector_t;
+
+            registry() {}
+
+            /*
+               The returned references stay valid for the lifetime of the
+               registry. Registration takes a lock, keep it out of the hot
+               path.
+            */
+            counter& add_counter(const std::string& name, const std::string& help, const std::string& labels = "")
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               counters_.push_back(entry<counter>(name, help, labels, new counter()));
+
+               return *counters_.back().metric;
+            }
+
+            gauge& add_gauge(const std::string& name, const std::string& help, const std::string& labels = "")
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               gauges_.push_back(entry<gauge>(name, help, labels, new gauge()));
+
+               return *gauges_.back().metric;
+            }
+
+            histogram& add_histogram(const std::string& name, const std::string& help,
+                                     const std::vector<std::uint64_t>& upper_bounds,
+                                     const std::string& labels = "")
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               histograms_.push_back(entry<histogram>(name, help, labels, new histogram(upper_bounds)));
+
+               return *histograms_.back().metric;
+            }
+
+            /* A gauge read from value() on every scrape, eg: a queue's size() */
+            void add_gauge_callback(const std::string& name, const std::string& help,
+                                    const std::function<double()>& value,
+                                    const std::string& labels = "")
+            {
+               add_collector([=](std::vector<sample>& samples)
+                             {
+                                samples.push_back(make_sample(name, help, e_gauge, name, labels, value()));
+                             });
+            }
+
+            /* Appends any number of samples on every scrape */
+            void add_collector(const collector_t& collector)
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               collectors_.push_back(collector);
+            }
+
+            /* Pull API: every sample, in registration order */
+            std::vector<sample> collect() const
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+
+               std::vector<sample> samples;
+
+               for (std::size_t i = 0; i < counters_.size(); ++i)
+               {
+                  const entry<counter>& c = counters_[i];
+                  samples.push_back(make_sample(c.name, c.help, e_counter, c.name, c.labels, static_cast<double>(c.metric->value())));
+               }
+
+               for (std::size_t i = 0; i < gauges_.size(); ++i)
+               {
+                  const entry<gauge>& g = gauges_[i];
+                  samples.push_back(make_sample(g.name, g.help, e_gauge, g.name, g.labels, static_cast<double>(g.metric->value())));
+               }
+
+               for (std::size_t i = 0; i < histograms_.size(); ++i)
+               {
+                  const entry<histogram>& h = histograms_[i];
+
+                  const std::vector<std::uint64_t>  counts = h.metric->counts();
+                  const std::vector<std::uint64_t>& bounds = h.metric->upper_bounds();
+
+                  const std::string separator = h.labels.empty() ? "" : ",";
+
+                  std::uint64_t cumulative = 0;
+
+                  for (std::size_t b = 0; b < counts.size(); ++b)
+                  {
+                     cumulative += counts[b];
+
+                     const std::string le = (b < bounds.size()) ? std::to_string(bounds[b]) : std::string("+Inf");
+
+                     samples.push_back(make_sample(h.name, h.help, e_histogram, h.name + "_bucket",
+                                                   h.labels + separator + "le=\"" + le + "\"",
+                                                   static_cast<double>(cumulative)));
+                  }
+
+                  samples.push_back(make_sample(h.name, h.help, e_histogram, h.name + "_sum"  , h.labels, static_cast<double>(h.metric->sum())));
+                  samples.push_back(make_sample(h.name, h.help, e_histogram, h.name + "_count", h.labels, static_cast<double>(cumulative)));
+               }
+
+               for (std::size_t i = 0; i < collectors_.size(); ++i)
+               {
+                  collectors_[i](samples);
+               }
+
+               return samples;
+            }
+
+            /*
+               Prometheus text exposition format (version 0.0.4), samples of
+               one family kept together under a single HELP and TYPE.
+            */
+            std::string prometheus_text() const
+            {
+               const std::vector<sample> samples = collect();
+
+               std::vector<bool> written(samples.size(), false);
+               std::string       text;
+
+               for (std::size_t i = 0; i < samples.size(); ++i)
+               {
+                  if (written[i])
+                     continue;
+
+                  const sample& head = samples[i];
+
+                  text += "# HELP " + head.family + " " + head.help + "\n";
+                  text += "# TYPE " + head.family + " " + type_name(head.type) + "\n";
+
+                  for (std::size_t j = i; j < samples.size(); ++j)
+                  {
+                     if (written[j] || (samples[j].family != head.family))
+                        continue;
+
+                     const sample& s = samples[j];
+
+                     char value[64];
+                     std::snprintf(value, sizeof(value), "%.17g", s.value);
+
+                     text += s.name;
+
+                     if (!s.labels.empty())
+                        text += "{" + s.labels + "}";
+
+                     text += " ";
+                     text += value;
+                     text += "\n";
+
+                     written[j] = true;
+                  }
+               }
+
+               return text;
+            }
+
+            static inline sample make_sample(const std::string& family, const std::string& help, const metric_t type,
+                                             const std::string& name, const std::string& labels, const double value)
+            {
+               sample s;
+
+               s.family = family;
+               s.help   = help;
+               s.type   = type;
+               s.name   = name;
+               s.labels = labels;
+               s.value  = value;
+
+               return s;
+            }
+
+            static inline const char* type_name(const metric_t type)
+            {
+               switch (type)
+               {
+                  case e_counter   : return "counter";
+                  case e_gauge     : return "gauge";
+                  case e_histogram : return "histogram";
+                  default          : return "untyped";
+               }
+            }
+
+         private:
+
+            registry(const registry&);
+            registry& operator=(const registry&);
+
+            template <typename Metric>
+            struct entry
+            {
+               entry(const std::string& n, const std::string& h, const std::string& l, Metric* m)
+               : name(n), help(h), labels(l), metric(m)
+               {}
+
+               std::string             name;
+               std::string             help;
+               std::string             labels;
+               std::shared_ptr<Metric> metric;
+            };
+
+            mutable std::mutex                mutex_;
+            std::vector<entry<counter>   >    counters_;
+            std::vector<entry<gauge>     >    gauges_;
+            std::vector<entry<histogram> >    histograms_;
+            std::vector<collector_t>          collectors_;
+         };
+
+      } // namespace metrics
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,312 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_OBJECT_POOL_HPP
+#define INCLUDE_SCHIFRA_OBJECT_POOL_HPP
+
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "schifra_aligned_allocator.hpp"
+#include "schifra_memory_accounting.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Pool of arrays of T, eg: block arrays of the batch decoders and
+         file codecs, or decoder workspaces, so that code running them over
+         and over allocates only while warming up.
+
+         An array released goes to its thread's free list, of at most
+         thread_cache_size arrays, which acquire() takes from without
+         locking. Arrays beyond that, and those of a thread that exits, go
+         to a global overflow list of at most global_cache_size arrays,
+         shared under a mutex; the rest are freed. Arrays are cache line
+         aligned and their elements constructed once, when first allocated:
+         an array handed out again holds whatever its last user left in it.
+      */
+      template <typename T>
+      class object_pool
+      {
+      private:
+
+         struct storage
+         {
+            T*          data;
+            std::size_t capacity;
+         };
+
+      public:
+
+         static const std::size_t thread_cache_size = 8;
+         static const std::size_t global_cache_size = 64;
+
+         /* count elements of T, back to the pool when destroyed */
+         class array
+         {
+         public:
+
+            array()
+            {
+               storage_.data     = 0;
+               storage_.capacity = 0;
+               size_             = 0;
+            }
+
+            array(array&& a) noexcept
+            : storage_(a.storage_),
+              size_   (a.size_)
+            {
+               a.storage_.data = 0;
+               a.size_         = 0;
+            }
+
+            array& operator=(array&& a) noexcept
+            {
+               if (this != &a)
+               {
+                  release();
+                  storage_        = a.storage_;
+                  size_           = a.size_;
+                  a.storage_.data = 0;
+                  a.size_         = 0;
+               }
+
+               return *this;
+            }
+
+            array(const array&) = delete;
+            array& operator=(const array&) = delete;
+
+           ~array()
+            {
+               release();
+            }
+
+            inline T*          data()       { return storage_.data; }
+            inline const T*    data() const { return storage_.data; }
+            inline std::size_t size() const { return size_;         }
+
+            inline T&       operator[](const std::size_t i)       { return storage_.data[i]; }
+            inline const T& operator[](const std::size_t i) const { return storage_.data[i]; }
+
+            inline T* begin() { return storage_.data;         }
+            inline T* end  () { return storage_.data + size_; }
+
+         private:
+
+            friend class object_pool;
+
+            array(const storage& s, const std::size_t count)
+            : storage_(s),
+              size_   (count)
+            {}
+
+            inline void release()
+            {
+               if (storage_.data)
+               {
+                  object_pool::release(storage_);
+                  storage_.data = 0;
+               }
+            }
+
+            storage     storage_;
+            std::size_t size_;
+         };
+
+         /* An array of at least count elements, empty for 0 */
+         static inline array acquire(const std::size_t count)
+         {
+            if (0 == count)
+               return array();
+
+            storage s;
+
+            if (take(local().free, count, s))
+               return array(s, count);
+
+            {
+               global_list& g = global();
+               std::lock_guard<std::mutex> lock(g.mutex);
+
+               if (take(g.free, count, s))
+                  return array(s, count);
+            }
+
+            return array(allocate(count), count);
+         }
+
+      private:
+
+         struct thread_cache
+         {
+            thread_cache()
+            {
+               free.reserve(thread_cache_size);
+            }
+
+           ~thread_cache()
+            {
+               for (std::size_t i = 0; i < free.size(); ++i)
+               {
+                  overflow(free[i]);
+               }
+            }
+
+            std::vector<storage> free;
+         };
+
+         struct global_list
+         {
+            global_list()
+            {
+               free.reserve(global_cache_size);
+            }
+
+           ~global_list()
+            {
+               for (std::size_t i = 0; i < free.size(); ++i)
+               {
+                  destroy(free[i]);
+               }
+            }
+
+            std::mutex           mutex;
+            std::vector<storage> free;
+         };
+
+         static inline thread_cache& local()
+         {
+            static thread_local thread_cache cache;
+            return cache;
+         }
+
+         static inline global_list& global()
+         {
+            static global_list list;
+            return list;
+         }
+
+         /* Takes the last array of free holding at least count elements */
+         static inline bool take(std::vector<storage>& free, const std::size_t count, storage& s)
+         {
+            for (std::size_t i = free.size(); i-- > 0;)
+            {
+               if (free[i].capacity >= count)
+               {
+                  s       = free[i];
+                  free[i] = free.back();
+                  free.pop_back();
+                  return true;
+               }
+            }
+
+            return false;
+         }
+
+         static inline void release(const storage& s)
+         {
+            std::vector<storage>& free = local().free;
+
+            if (free.size() < thread_cache_size)
+               free.push_back(s);
+            else
+               overflow(s);
+         }
+
+         static inline void overflow(const storage& s)
+         {
+            global_list& g = global();
+
+            {
+               std::lock_guard<std::mutex> lock(g.mutex);
+
+               if (g.free.size() < global_cache_size)
+               {
+                  g.free.push_back(s);
+                  return;
+               }
+            }
+
+            destroy(s);
+         }
+
+         static inline storage allocate(const std::size_t count)
+         {
+            storage s;
+            s.data     = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(cache_line_size)));
+            s.capacity = count;
+
+            std::size_t i = 0;
+
+            try
+            {
+               for (; i < count; ++i)
+               {
+                  new (s.data + i) T();
+               }
+            }
+            catch (...)
+            {
+               while (i-- > 0)
+               {
+                  s.data[i].~T();
+               }
+
+               ::operator delete(s.data, std::align_val_t(cache_line_size));
+               throw;
+            }
+
+            memory::allocated(memory::e_object_pools, count * sizeof(T));
+
+            return s;
+         }
+
+         static inline void destroy(const storage& s)
+         {
+            for (std::size_t i = 0; i < s.capacity; ++i)
+            {
+               s.data[i].~T();
+            }
+
+            ::operator delete(s.data, std::align_val_t(cache_line_size));
+
+            memory::released(memory::e_object_pools, s.capacity * sizeof(T));
+         }
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+
+#endif
@@ -0,0 +1,625 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_PACKED_DNA_HPP
+#define INCLUDE_SCHIFRA_PACKED_DNA_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "schifra/utils/schifra_cpu_features.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace dna
+      {
+
+         namespace details
+         {
+            /* The four symbols of a packed byte in reverse order */
+            struct reverse_table
+            {
+               std::uint8_t byte[256];
+            };
+
+            inline constexpr reverse_table make_reverse_table()
+            {
+               reverse_table table = {};
+
+               for (std::size_t b = 0; b < 256; ++b)
+               {
+                  table.byte[b] = static_cast<std::uint8_t>(((b & 0x03) << 6) | ((b & 0x0C) << 2) |
+                                                            ((b & 0x30) >> 2) | ((b & 0xC0) >> 6));
+               }
+
+               return table;
+            }
+
+            static constexpr reverse_table reverse_symbols = make_reverse_table();
+
+            /* Pack symbols [i,count), 4 per byte, returns false on a base not ACGTacgt */
+            inline bool pack_scalar(const char* bases, const std::size_t count, std::uint8_t* packed, std::size_t i)
+            {
+               for ( ; i < count; ++i)
+               {
+                  const std::uint8_t s = base_to_symbol(bases[i]);
+
+                  if (invalid_base == s)
+                     return false;
+
+                  const std::size_t shift = (i & 3) << 1;
+
+                  packed[i >> 2] = static_cast<std::uint8_t>((packed[i >> 2] & ~(3 << shift)) | (s << shift));
+               }
+
+               return true;
+            }
+
+            inline void unpack_scalar(const std::uint8_t* packed, const std::size_t offset, const std::size_t count, char* bases, std::size_t i)
+            {
+               for ( ; i < count; ++i)
+               {
+                  const std::size_t p = offset + i;
+
+                  bases[i] = symbol_to_base_table[(packed[p >> 2] >> ((p & 3) << 1)) & 3];
+               }
+            }
+
+            #ifdef SCHIFRA_DNA_X86
+
+            /*
+               16 bases per step: validated and translated as in
+               to_symbols_avx2(), then s0 + 4s1 per pair (maddubs) and
+               (s0 + 4s1) + 16(s2 + 4s3) per quad (madd), whose low bytes
+               are the packed bytes. Returns bases done, count + 1 if one
+               was invalid.
+            */
+            __attribute__((target("ssse3")))
+            inline std::size_t pack_ssse3(const char* bases, const std::size_t count, std::uint8_t* packed)
+            {
+               const __m128i fold     = _mm_set1_epi8(static_cast<char>(0xDF));
+               const __m128i low      = _mm_set1_epi8(0x0F);
+               const __m128i expected = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expected_letter));
+               const __m128i symbol   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_symbol  ));
+               const __m128i pairs    = _mm_set1_epi16(0x0401);
+               const __m128i quads    = _mm_set1_epi32(0x00100001);
+               const __m128i gather   = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 16) <= count; i += 16)
+               {
+                  const __m128i b      = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + i)), fold);
+                  const __m128i nibble = _mm_and_si128(b, low);
+
+                  if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_shuffle_epi8(expected, nibble), b)))
+                     return count + 1;
+
+                  const __m128i s = _mm_shuffle_epi8(symbol, nibble);
+                  const __m128i q = _mm_shuffle_epi8(_mm_madd_epi16(_mm_maddubs_epi16(s, pairs), quads), gather);
+
+                  const int word = _mm_cvtsi128_si32(q);
+
+                  packed[(i >> 2) + 0] = static_cast<std::uint8_t>(word      );
+                  packed[(i >> 2) + 1] = static_cast<std::uint8_t>(word >>  8);
+                  packed[(i >> 2) + 2] = static_cast<std::uint8_t>(word >> 16);
+                  packed[(i >> 2) + 3] = static_cast<std::uint8_t>(word >> 24);
+               }
+
+               return i;
+            }
+
+            /*
+               16 packed bytes (64 bases) per step: each nibble holds two
+               bases, shuffled out as letters by two 16 entry tables, and
+               the four resulting vectors interleaved back into order.
+            */
+            __attribute__((target("ssse3")))
+            inline std::size_t unpack_ssse3(const std::uint8_t* packed, const std::size_t count, char* bases)
+            {
+               const __m128i first  = _mm_setr_epi8('A','C','G','T','A','C','G','T','A','C','G','T','A','C','G','T');
+               const __m128i second = _mm_setr_epi8('A','A','A','A','C','C','C','C','G','G','G','G','T','T','T','T');
+               const __m128i low    = _mm_set1_epi8(0x0F);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
+               {
+                  const __m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + (i >> 2)));
+                  const __m128i lo = _mm_and_si128(x, low);
+                  const __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), low);
+
+                  const __m128i c0 = _mm_shuffle_epi8(first , lo);
+                  const __m128i c1 = _mm_shuffle_epi8(second, lo);
+                  const __m128i c2 = _mm_shuffle_epi8(first , hi);
+                  const __m128i c3 = _mm_shuffle_epi8(second, hi);
+
+                  const __m128i a0 = _mm_unpacklo_epi8(c0, c1);
+                  const __m128i a1 = _mm_unpackhi_epi8(c0, c1);
+                  const __m128i b0 = _mm_unpacklo_epi8(c2, c3);
+                  const __m128i b1 = _mm_unpackhi_epi8(c2, c3);
+
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i +  0), _mm_unpacklo_epi16(a0, b0));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i + 16), _mm_unpackhi_epi16(a0, b0));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i + 32), _mm_unpacklo_epi16(a1, b1));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i + 48), _mm_unpackhi_epi16(a1, b1));
+               }
+
+               return i;
+            }
+
+            /*
+               Reverse complement of whole bytes, 16 per step: byte order
+               reversed by a shuffle, the symbols within a byte by two
+               nibble lookups (each nibble's pair of symbols swapped and the
+               nibbles exchanged), then complemented (xor 0xFF). Returns
+               the bytes done.
+            */
+            __attribute__((target("ssse3")))
+            inline std::size_t reverse_complement_ssse3(const std::uint8_t* packed, const std::size_t n, std::uint8_t* out)
+            {
+               const __m128i reverse   = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+               const __m128i low       = _mm_set1_epi8(0x0F);
+               const __m128i swap_low  = _mm_setr_epi8(0x00, 0x04, 0x08, 0x0C, 0x01, 0x05, 0x09, 0x0D,
+                                                       0x02, 0x06, 0x0A, 0x0E, 0x03, 0x07, 0x0B, 0x0F);
+               const __m128i swap_high = _mm_slli_epi16(swap_low, 4);
+               const __m128i ones      = _mm_set1_epi8(static_cast<char>(0xFF));
+
+               std::size_t j = 0;
+
+               for ( ; (j + 16) <= n; j += 16)
+               {
+                  const __m128i b  = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(packed + n - j - 16)), reverse);
+                  const __m128i lo = _mm_and_si128(b, low);
+                  const __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), low);
+                  const __m128i r  = _mm_or_si128(_mm_shuffle_epi8(swap_high, lo), _mm_shuffle_epi8(swap_low, hi));
+
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), _mm_xor_si128(r, ones));
+               }
+
+               return j;
+            }
+
+            #endif
+
+            #ifdef SCHIFRA_DNA_NEON
+
+            /* 64 bases per step, de-interleaved by vld4q into the four positions of each byte */
+            inline std::size_t pack_neon(const char* bases, const std::size_t count, std::uint8_t* packed)
+            {
+               const uint8x16_t fold     = vdupq_n_u8(0xDF);
+               const uint8x16_t low      = vdupq_n_u8(0x0F);
+               const uint8x16_t expected = vld1q_u8(expected_letter);
+               const uint8x16_t symbol   = vld1q_u8(nibble_symbol  );
+
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
+               {
+                  const uint8x16x4_t b = vld4q_u8(reinterpret_cast<const std::uint8_t*>(bases + i));
+
+                  uint8x16_t out   = vdupq_n_u8(0);
+                  uint8x16_t valid = vdupq_n_u8(0xFF);
+
+                  for (int k = 0; k < 4; ++k)
+                  {
+                     const uint8x16_t f      = vandq_u8(b.val[k], fold);
+                     const uint8x16_t nibble = vandq_u8(f, low);
+
+                     valid = vandq_u8(valid, vceqq_u8(vqtbl1q_u8(expected, nibble), f));
+                     out   = vorrq_u8(out, vshlq_u8(vqtbl1q_u8(symbol, nibble), vdupq_n_s8(static_cast<std::int8_t>(2 * k))));
+                  }
+
+                  if (0xFF != vminvq_u8(valid))
+                     return count + 1;
+
+                  vst1q_u8(packed + (i >> 2), out);
+               }
+
+               return i;
+            }
+
+            inline std::size_t unpack_neon(const std::uint8_t* packed, const std::size_t count, char* bases)
+            {
+               const std::uint8_t letter_bytes[16] = { 'A', 'C', 'G', 'T' };
+               const uint8x16_t   letters          = vld1q_u8(letter_bytes);
+               const uint8x16_t   mask             = vdupq_n_u8(3);
+
+               std::size_t i = 0;
+
+               for ( ; (i + 64) <= count; i += 64)
+               {
+                  const uint8x16_t x = vld1q_u8(packed + (i >> 2));
+
+                  uint8x16x4_t out;
+
+                  out.val[0] = vqtbl1q_u8(letters, vandq_u8(x, mask));
+                  out.val[1] = vqtbl1q_u8(letters, vandq_u8(vshrq_n_u8(x, 2), mask));
+                  out.val[2] = vqtbl1q_u8(letters, vandq_u8(vshrq_n_u8(x, 4), mask));
+                  out.val[3] = vqtbl1q_u8(letters, vshrq_n_u8(x, 6));
+
+                  vst4q_u8(reinterpret_cast<std::uint8_t*>(bases + i), out);
+               }
+
+               return i;
+            }
+
+            inline std::size_t reverse_complement_neon(const std::uint8_t* packed, const std::size_t n, std::uint8_t* out)
+            {
+               const std::uint8_t swap_bytes[16] = { 0x00, 0x04, 0x08, 0x0C, 0x01, 0x05, 0x09, 0x0D,
+                                                     0x02, 0x06, 0x0A, 0x0E, 0x03, 0x07, 0x0B, 0x0F };
+               const uint8x16_t   swap_low       = vld1q_u8(swap_bytes);
+               const uint8x16_t   swap_high      = vshlq_n_u8(swap_low, 4);
+               const uint8x16_t   low            = vdupq_n_u8(0x0F);
+
+               std::size_t j = 0;
+
+               for ( ; (j + 16) <= n; j += 16)
+               {
+                  uint8x16_t b = vrev64q_u8(vld1q_u8(packed + n - j - 16));
+                  b = vextq_u8(b, b, 8);
+
+                  const uint8x16_t r = vorrq_u8(vqtbl1q_u8(swap_high, vandq_u8(b, low)), vqtbl1q_u8(swap_low, vshrq_n_u8(b, 4)));
+
+                  vst1q_u8(out + j, vmvnq_u8(r));
+               }
+
+               return j;
+            }
+
+            #endif
+
+         } // namespace details
+
+         /*
+            Pack count bases into (count + 3) / 4 bytes, base i in bits
+            2(i % 4) of byte i / 4. Returns false, with packed partly
+            written, on a base not ACGTacgt.
+         */
+         inline bool pack_bases(const char* bases, const std::size_t count, std::uint8_t* packed)
+         {
+            if (0 != (count & 3))
+               packed[count >> 2] = 0;
+
+            std::size_t i = 0;
+
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().ssse3)
+               i = details::pack_ssse3(bases, count, packed);
+            #elif defined(SCHIFRA_DNA_NEON)
+            i = details::pack_neon(bases, count, packed);
+            #endif
+
+            return (i <= count) && details::pack_scalar(bases, count, packed, i);
+         }
+
+         /*
+            Read only window of bases [offset, offset + size) of a packed
+            sequence, valid as long as the sequence is not modified.
+         */
+         class packed_dna_view
+         {
+         public:
+
+            packed_dna_view(const std::uint8_t* packed, const std::size_t offset, const std::size_t size)
+            : packed_(packed),
+              offset_(offset),
+              size_(size)
+            {}
+
+            inline std::size_t size() const
+            {
+               return size_;
+            }
+
+            inline std::uint8_t symbol(const std::size_t i) const
+            {
+               const std::size_t p = offset_ + i;
+               return static_cast<std::uint8_t>((packed_[p >> 2] >> ((p & 3) << 1)) & 3);
+            }
+
+            inline char base(const std::size_t i) const
+            {
+               return symbol_to_base_table[symbol(i)];
+            }
+
+            inline packed_dna_view substr(const std::size_t pos, const std::size_t count) const
+            {
+               return packed_dna_view(packed_, offset_ + pos, count);
+            }
+
+            inline void unpack(char* bases) const
+            {
+               std::size_t i = 0;
+
+               /* Only byte aligned windows take the vector path */
+               if (0 == (offset_ & 3))
+               {
+                  #if defined(SCHIFRA_DNA_X86)
+                  if (host_cpu_features().ssse3)
+                     i = details::unpack_ssse3(packed_ + (offset_ >> 2), size_, bases);
+                  #elif defined(SCHIFRA_DNA_NEON)
+                  i = details::unpack_neon(packed_ + (offset_ >> 2), size_, bases);
+                  #endif
+               }
+
+               details::unpack_scalar(packed_, offset_, size_, bases, i);
+            }
+
+            inline std::string to_string() const
+            {
+               std::string bases(size_, 'A');
+
+               if (size_)
+                  unpack(&bases[0]);
+
+               return bases;
+            }
+
+         private:
+
+            const std::uint8_t* packed_;
+            std::size_t         offset_;
+            std::size_t         size_;
+         };
+
+         /*
+            Nucleotide sequence at 2 bits per base, 4 bases per byte with
+            base i in bits 2(i mod 4) of byte i/4, ie: a quarter of the
+            memory of a std::string. Symbols follow the A=0 C=1 G=2 T=3
+            mapping, so complementing a base is s ^ 3, and bases 2k and
+            2k+1 together form the nibble symbol_pair(k), a GF(2^4) symbol.
+            Bits past size() in the last byte are kept zero.
+         */
+         class packed_dna
+         {
+         public:
+
+            packed_dna()
+            : size_(0)
+            {}
+
+            /* count bases, all A */
+            explicit packed_dna(const std::size_t count)
+            : bytes_((count + 3) >> 2, 0),
+              size_(count)
+            {}
+
+            /* Replace the contents with bases, false (and left empty) if one is not ACGTacgt */
+            bool assign(const char* bases, const std::size_t count)
+            {
+               bytes_.assign((count + 3) >> 2, 0);
+               size_ = count;
+
+               if (!pack_bases(bases, count, bytes_.data()))
+               {
+                  clear();
+                  return false;
+               }
+
+               return true;
+            }
+
+            inline bool assign(const std::string& bases)
+            {
+               return assign(bases.data(), bases.size());
+            }
+
+            inline void clear()
+            {
+               bytes_.clear();
+               size_ = 0;
+            }
+
+            inline std::size_t size() const
+            {
+               return size_;
+            }
+
+            inline bool empty() const
+            {
+               return (0 == size_);
+            }
+
+            /* The packed bytes, (size() + 3) / 4 of them */
+            inline const std::uint8_t* data() const
+            {
+               return bytes_.data();
+            }
+
+            inline std::size_t byte_size() const
+            {
+               return bytes_.size();
+            }
+
+            inline std::uint8_t symbol(const std::size_t i) const
+            {
+               return static_cast<std::uint8_t>((bytes_[i >> 2] >> ((i & 3) << 1)) & 3);
+            }
+
+            inline void set_symbol(const std::size_t i, const std::uint8_t s)
+            {
+               const std::size_t shift = (i & 3) << 1;
+               bytes_[i >> 2] = static_cast<std::uint8_t>((bytes_[i >> 2] & ~(3 << shift)) | ((s & 3) << shift));
+            }
+
+            inline char base(const std::size_t i) const
+            {
+               return symbol_to_base_table[symbol(i)];
+            }
+
+            /* Bases 2k (low bits) and 2k + 1 as one 4 bit symbol */
+            inline std::uint8_t symbol_pair(const std::size_t k) const
+            {
+               return static_cast<std::uint8_t>((bytes_[k >> 1] >> ((k & 1) << 2)) & 0x0F);
+            }
+
+            inline void push_back(const std::uint8_t s)
+            {
+               if (0 == (size_ & 3))
+                  bytes_.push_back(0);
+
+               ++size_;
+               set_symbol(size_ - 1, s);
+            }
+
+            /*
+               Appends bases, false (leaving the sequence as it was) if one
+               is not ACGTacgt. Bases up to a byte boundary are pushed one
+               at a time and the rest packed by pack_bases().
+            */
+            bool append(const char* bases, const std::size_t count)
+            {
+               const std::size_t old_size  = size_;
+               const std::size_t old_bytes = bytes_.size();
+
+               bytes_.reserve((size_ + count + 3) >> 2);
+
+               std::size_t i = 0;
+
+               for ( ; (i < count) && (0 != (size_ & 3)); ++i)
+               {
+                  const std::uint8_t s = base_to_symbol(bases[i]);
+
+                  if (invalid_base == s)
+                     return rollback(old_size, old_bytes);
+
+                  push_back(s);
+               }
+
+               if (i < count)
+               {
+                  bytes_.resize((size_ + (count - i) + 3) >> 2);
+
+                  if (!pack_bases(bases + i, count - i, bytes_.data() + (size_ >> 2)))
+                     return rollback(old_size, old_bytes);
+
+                  size_ += count - i;
+               }
+
+               return true;
+            }
+
+            inline packed_dna_view view() const
+            {
+               return packed_dna_view(bytes_.data(), 0, size_);
+            }
+
+            inline packed_dna_view substr(const std::size_t pos, const std::size_t count) const
+            {
+               return packed_dna_view(bytes_.data(), pos, count);
+            }
+
+            inline std::string to_string() const
+            {
+               return view().to_string();
+            }
+
+            /*
+               Reverse complement: bytes taken in reverse order with their
+               four symbols reversed and complemented (xor 0xFF), 16 at a
+               time on SSSE3/NEON, then, when
+               size() is not a multiple of 4, shifted down over the padding
+               that moved to the front.
+            */
+            packed_dna reverse_complement() const
+            {
+               packed_dna result(size_);
+
+               const std::size_t n = bytes_.size();
+
+               std::size_t j = 0;
+
+               #if defined(SCHIFRA_DNA_X86)
+               if (host_cpu_features().ssse3)
+                  j = details::reverse_complement_ssse3(bytes_.data(), n, result.bytes_.data());
+               #elif defined(SCHIFRA_DNA_NEON)
+               j = details::reverse_complement_neon(bytes_.data(), n, result.bytes_.data());
+               #endif
+
+               for ( ; j < n; ++j)
+               {
+                  result.bytes_[j] = static_cast<std::uint8_t>(details::reverse_symbols.byte[bytes_[n - 1 - j]] ^ 0xFF);
+               }
+
+               const std::size_t padding = (4 - (size_ & 3)) & 3;
+
+               if (padding)
+               {
+                  const unsigned int shift = static_cast<unsigned int>(padding << 1);
+
+                  for (std::size_t j = 0; j < n; ++j)
+                  {
+                     const unsigned int next = ((j + 1) < n) ? result.bytes_[j + 1] : 0;
+                     result.bytes_[j] = static_cast<std::uint8_t>((result.bytes_[j] >> shift) | (next << (8 - shift)));
+                  }
+
+                  result.bytes_[n - 1] &= static_cast<std::uint8_t>(0xFF >> shift);
+               }
+
+               return result;
+            }
+
+            inline bool operator==(const packed_dna& other) const
+            {
+               return (size_ == other.size_) && (bytes_ == other.bytes_);
+            }
+
+            inline bool operator!=(const packed_dna& other) const
+            {
+               return !(*this == other);
+            }
+
+         private:
+
+            /* Undo a failed append(), clearing the bits past old_size */
+            inline bool rollback(const std::size_t old_size, const std::size_t old_bytes)
+            {
+               bytes_.resize(old_bytes);
+               size_ = old_size;
+
+               if (0 != (size_ & 3))
+                  bytes_.back() &= static_cast<std::uint8_t>((1 << ((size_ & 3) << 1)) - 1);
+
+               return false;
+            }
+
+            std::vector<std::uint8_t> bytes_;
+            std::size_t               size_;
+         };
+
+      } // namespace dna
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
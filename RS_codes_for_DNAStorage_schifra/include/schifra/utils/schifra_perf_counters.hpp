@@ -0,0 +1,318 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_PERF_COUNTERS_HPP
+#define INCLUDE_SCHIFRA_PERF_COUNTERS_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SCHIFRA_PERF_EVENTS
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Hardware performance counters of the calling thread, read through
+         perf_event_open on Linux: cycles, instructions, L1 data cache read
+         misses, last level cache misses and branch mispredictions, user
+         space only. Counts accumulate over every start()/stop() pair, so
+         arbitrary sections of the codec can be wrapped, see section.
+
+         Each event is opened on its own, an event the kernel or cpu does
+         not offer (eg: in a VM, or with perf_event_paranoid > 2) is simply
+         left out, and multiplexed counts are scaled by the time they were
+         actually running. On other platforms nothing is available and the
+         calls do nothing.
+
+         Note: The counters follow the thread that constructed them, a
+               multithreaded run needs an instance per thread, the
+               readings being summed with reading::merge().
+      */
+      class perf_counters
+      {
+      public:
+
+         enum event_t
+         {
+            e_cycles        = 0,
+            e_instructions  = 1,
+            e_l1d_misses    = 2,
+            e_llc_misses    = 3,
+            e_branch_misses = 4,
+            e_event_count   = 5
+         };
+
+         struct reading
+         {
+            reading()
+            {
+               clear();
+            }
+
+            inline void clear()
+            {
+               for (std::size_t i = 0; i < e_event_count; ++i)
+               {
+                  value[i] = 0;
+                  valid[i] = false;
+               }
+            }
+
+            inline void merge(const reading& r)
+            {
+               for (std::size_t i = 0; i < e_event_count; ++i)
+               {
+                  value[i] += r.value[i];
+                  valid[i] |= r.valid[i];
+               }
+            }
+
+            inline bool any() const
+            {
+               for (std::size_t i = 0; i < e_event_count; ++i)
+               {
+                  if (valid[i]) return true;
+               }
+
+               return false;
+            }
+
+            inline double per(const event_t event, const double amount) const
+            {
+               return (valid[event] && (amount > 0.0)) ? value[event] / amount : 0.0;
+            }
+
+            inline double ipc() const
+            {
+               return (valid[e_cycles] && valid[e_instructions] && (0 != value[e_cycles])) ?
+                      static_cast<double>(value[e_instructions]) / value[e_cycles] : 0.0;
+            }
+
+            /*
+               One line summary, per unit of work (eg: per byte), events
+               that could not be counted being shown as "n/a".
+            */
+            inline void print(std::FILE* out, const double units, const char* unit_name = "byte") const
+            {
+               const char* const names[e_event_count] = { "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses" };
+
+               if (!any())
+               {
+                  std::fprintf(out, "perf: counters unavailable\n");
+                  return;
+               }
+
+               std::fprintf(out, "perf:");
+
+               for (std::size_t i = 0; i < e_event_count; ++i)
+               {
+                  if (valid[i])
+                     std::fprintf(out, " %s/%s=%.4f", names[i], unit_name, per(static_cast<event_t>(i), units));
+                  else
+                     std::fprintf(out, " %s=n/a", names[i]);
+               }
+
+               if (valid[e_cycles] && valid[e_instructions])
+                  std::fprintf(out, " IPC=%.3f", ipc());
+
+               std::fprintf(out, "\n");
+            }
+
+            std::uint64_t value[e_event_count];
+            bool          valid[e_event_count];
+         };
+
+         /* Wraps a section of code: the counters run for the lifetime of the section */
+         class section
+         {
+         public:
+
+            explicit section(perf_counters& counters)
+            : counters_(counters)
+            {
+               counters_.start();
+            }
+
+           ~section()
+            {
+               counters_.stop();
+            }
+
+         private:
+
+            section(const section&);
+            section& operator=(const section&);
+
+            perf_counters& counters_;
+         };
+
+         perf_counters()
+         {
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               fd_[i] = -1;
+            }
+
+            #ifdef SCHIFRA_PERF_EVENTS
+            const std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D                |
+                                                (PERF_COUNT_HW_CACHE_OP_READ     <<  8) |
+                                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+            fd_[e_cycles       ] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES      );
+            fd_[e_instructions ] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS    );
+            fd_[e_l1d_misses   ] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss                 );
+            fd_[e_llc_misses   ] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES    );
+            fd_[e_branch_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES   );
+            #endif
+         }
+
+        ~perf_counters()
+         {
+            #ifdef SCHIFRA_PERF_EVENTS
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               if (fd_[i] >= 0) close(fd_[i]);
+            }
+            #endif
+         }
+
+         /* True when at least one of the events can be counted */
+         inline bool available() const
+         {
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               if (fd_[i] >= 0) return true;
+            }
+
+            return false;
+         }
+
+         /*
+            Benchmarks collect counters when asked to on their command line,
+            or when the SCHIFRA_PERF_COUNTERS environment variable is set to
+            a non-zero value.
+         */
+         static inline bool requested()
+         {
+            const char* env = std::getenv("SCHIFRA_PERF_COUNTERS");
+            return (0 != env) && (0 != std::strcmp(env, "")) && (0 != std::strcmp(env, "0"));
+         }
+
+         inline void start()
+         {
+            #ifdef SCHIFRA_PERF_EVENTS
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               if (fd_[i] < 0) continue;
+
+               ioctl(fd_[i], PERF_EVENT_IOC_RESET , 0);
+               ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+            #endif
+         }
+
+         inline void stop()
+         {
+            #ifdef SCHIFRA_PERF_EVENTS
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               if (fd_[i] >= 0) ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+
+            for (std::size_t i = 0; i < e_event_count; ++i)
+            {
+               if (fd_[i] < 0) continue;
+
+               /* value, time enabled, time running */
+               std::uint64_t data[3] = { 0, 0, 0 };
+
+               if (sizeof(data) != read(fd_[i], data, sizeof(data)))
+                  continue;
+
+               if (0 != data[2])
+               {
+                  totals_.value[i] += (data[2] < data[1]) ?
+                                      static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : data[0];
+                  totals_.valid[i]  = true;
+               }
+            }
+            #endif
+         }
+
+         inline void reset()
+         {
+            totals_.clear();
+         }
+
+         inline const reading& totals() const
+         {
+            return totals_;
+         }
+
+      private:
+
+         perf_counters(const perf_counters&);
+         perf_counters& operator=(const perf_counters&);
+
+         #ifdef SCHIFRA_PERF_EVENTS
+         static inline int open_event(const std::uint32_t type, const std::uint64_t config)
+         {
+            perf_event_attr attr;
+
+            std::memset(&attr, 0, sizeof(attr));
+
+            attr.type           = type;
+            attr.size           = sizeof(attr);
+            attr.config         = config;
+            attr.disabled       = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+         }
+         #endif
+
+         int     fd_[e_event_count];
+         reading totals_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,557 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_RING_QUEUE_HPP
+#define INCLUDE_SCHIFRA_RING_QUEUE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include "schifra_memory_accounting.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      inline void cpu_relax()
+      {
+         #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+         _mm_pause();
+         #elif defined(__aarch64__) || defined(__arm__)
+         __asm__ __volatile__("yield");
+         #endif
+      }
+
+      /*
+         Wait policies of the ring queues: how a push() into a full ring
+         or a pop() from an empty one waits for the other side.
+
+         spin_wait     : spins, yielding the cpu now and then. The lowest
+                         handoff latency, for stages that each own a core.
+         blocking_wait : spins briefly, then sleeps on a condition
+                         variable. notify() only takes the lock when a
+                         thread is actually asleep, so a stage that keeps
+                         up never makes a system call.
+      */
+      class spin_wait
+      {
+      public:
+
+         spin_wait() {}
+
+         template <typename Ready>
+         inline void wait(const Ready& ready)
+         {
+            for (std::size_t spins = 0; !ready(); ++spins)
+            {
+               if (0 == (spins % 64))
+                  std::this_thread::yield();
+               else
+                  cpu_relax();
+            }
+         }
+
+         inline void notify    () {}
+         inline void notify_all() {}
+
+      private:
+
+         spin_wait(const spin_wait&);
+         spin_wait& operator=(const spin_wait&);
+      };
+
+      class blocking_wait
+      {
+      public:
+
+         static constexpr std::size_t spin_limit = 256;
+
+         blocking_wait()
+         : waiters_(0)
+         {}
+
+         template <typename Ready>
+         inline void wait(const Ready& ready)
+         {
+            for (std::size_t spins = 0; spins < spin_limit; ++spins)
+            {
+               if (ready())
+                  return;
+
+               cpu_relax();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            condition_.wait(lock, ready);
+
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+         }
+
+         /*
+            Note: The fence orders the caller's publishing store before
+                  the read of waiters_, pairing with the fence in wait(),
+                  so a sleeper is either seen here or sees the update.
+         */
+         inline void notify()
+         {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (0 != waiters_.load(std::memory_order_relaxed))
+            {
+               std::lock_guard<std::mutex> lock(mutex_);
+               condition_.notify_all();
+            }
+         }
+
+         inline void notify_all()
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_all();
+         }
+
+      private:
+
+         blocking_wait(const blocking_wait&);
+         blocking_wait& operator=(const blocking_wait&);
+
+         std::atomic<std::size_t> waiters_;
+         std::mutex               mutex_;
+         std::condition_variable  condition_;
+      };
+
+      namespace details
+      {
+         inline std::size_t ring_capacity(const std::size_t capacity)
+         {
+            std::size_t c = 2;
+
+            while (c < capacity)
+            {
+               c <<= 1;
+            }
+
+            return c;
+         }
+      }
+
+      /*
+         Bounded single-producer single-consumer ring. The producer owns
+         tail_, the consumer head_, each on its own cache line along with
+         a cached copy of the other index, so a push or pop only touches
+         the shared line when the ring looks full or empty.
+
+         The interface is that of bounded_queue: push() waits while full,
+         pop() while empty, and once closed push() fails and pop() drains
+         what is left. push_batch()/pop_batch() move several items with a
+         single index update. The capacity is rounded up to a power of 2.
+      */
+      template <typename T, typename WaitPolicy = blocking_wait>
+      class spsc_ring
+      {
+      public:
+
+         explicit spsc_ring(const std::size_t capacity)
+         : capacity_(details::ring_capacity(capacity)),
+           mask_(capacity_ - 1),
+           items_(new T[capacity_]),
+           closed_(false),
+           charge_(memory::e_pipeline_queues, capacity_ * sizeof(T))
+         {}
+
+         inline bool try_push(const T& value)
+         {
+            return 1 == try_push_batch(&value, 1);
+         }
+
+         inline bool try_pop(T& value)
+         {
+            return 1 == try_pop_batch(&value, 1);
+         }
+
+         /* Pushes up to count items, returns how many fitted */
+         inline std::size_t try_push_batch(const T* values, const std::size_t count)
+         {
+            const std::size_t tail = producer_.index.load(std::memory_order_relaxed);
+
+            if ((tail - producer_.cached) + count > capacity_)
+               producer_.cached = consumer_.index.load(std::memory_order_acquire);
+
+            const std::size_t amount = std::min(count, capacity_ - (tail - producer_.cached));
+
+            for (std::size_t i = 0; i < amount; ++i)
+            {
+               items_[(tail + i) & mask_] = values[i];
+            }
+
+            if (amount > 0)
+            {
+               producer_.index.store(tail + amount, std::memory_order_release);
+               not_empty_.notify();
+            }
+
+            return amount;
+         }
+
+         /* Pops up to count items, returns how many there were */
+         inline std::size_t try_pop_batch(T* values, const std::size_t count)
+         {
+            const std::size_t head = consumer_.index.load(std::memory_order_relaxed);
+
+            if ((consumer_.cached - head) < count)
+               consumer_.cached = producer_.index.load(std::memory_order_acquire);
+
+            const std::size_t amount = std::min(count, consumer_.cached - head);
+
+            for (std::size_t i = 0; i < amount; ++i)
+            {
+               values[i] = items_[(head + i) & mask_];
+            }
+
+            if (amount > 0)
+            {
+               consumer_.index.store(head + amount, std::memory_order_release);
+               not_full_.notify();
+            }
+
+            return amount;
+         }
+
+         inline bool push(const T& value)
+         {
+            return 1 == push_batch(&value, 1);
+         }
+
+         inline bool pop(T& value)
+         {
+            return 1 == pop_batch(&value, 1);
+         }
+
+         /* Pushes all count items, waiting for room, unless closed meanwhile */
+         inline std::size_t push_batch(const T* values, const std::size_t count)
+         {
+            std::size_t pushed = 0;
+
+            while (pushed < count)
+            {
+               if (closed_.load(std::memory_order_acquire))
+                  break;
+
+               pushed += try_push_batch(values + pushed, count - pushed);
+
+               if (pushed < count)
+                  not_full_.wait([this]() { return closed_.load(std::memory_order_acquire) || (size() < capacity_); });
+            }
+
+            return pushed;
+         }
+
+         /* Pops between 1 and count items, waiting for the first; 0 once closed and drained */
+         inline std::size_t pop_batch(T* values, const std::size_t count)
+         {
+            for ( ; ; )
+            {
+               const std::size_t popped = try_pop_batch(values, count);
+
+               if (popped > 0)
+                  return popped;
+
+               if (closed_.load(std::memory_order_acquire) && (0 == size()))
+                  return 0;
+
+               not_empty_.wait([this]() { return closed_.load(std::memory_order_acquire) || (size() > 0); });
+            }
+         }
+
+         inline void close()
+         {
+            closed_.store(true, std::memory_order_release);
+
+            not_empty_.notify_all();
+            not_full_ .notify_all();
+         }
+
+         inline std::size_t size() const
+         {
+            return producer_.index.load(std::memory_order_acquire) - consumer_.index.load(std::memory_order_acquire);
+         }
+
+         inline std::size_t capacity() const
+         {
+            return capacity_;
+         }
+
+      private:
+
+         spsc_ring(const spsc_ring&);
+         spsc_ring& operator=(const spsc_ring&);
+
+         struct alignas(64) side
+         {
+            side() : index(0), cached(0) {}
+
+            std::atomic<std::size_t> index;
+            std::size_t              cached;   /* last seen index of the other side */
+         };
+
+         const std::size_t    capacity_;
+         const std::size_t    mask_;
+         std::unique_ptr<T[]> items_;
+
+         side                 producer_;
+         side                 consumer_;
+         std::atomic<bool>    closed_;
+
+         WaitPolicy           not_empty_;
+         WaitPolicy           not_full_;
+
+         const memory::charge charge_;
+      };
+
+      /*
+         Bounded multi-producer multi-consumer ring (D. Vyukov's design).
+         Every cell carries a sequence number telling whether it is ready
+         to be written or read at the current lap, so producers and
+         consumers only contend on their own index, with a CAS, and never
+         lock. The interface is that of spsc_ring.
+      */
+      template <typename T, typename WaitPolicy = blocking_wait>
+      class mpmc_ring
+      {
+      public:
+
+         explicit mpmc_ring(const std::size_t capacity)
+         : capacity_(details::ring_capacity(capacity)),
+           mask_(capacity_ - 1),
+           cells_(new cell[capacity_]),
+           closed_(false),
+           charge_(memory::e_pipeline_queues, capacity_ * sizeof(cell))
+         {
+            for (std::size_t i = 0; i < capacity_; ++i)
+            {
+               cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+         }
+
+         inline bool try_push(const T& value)
+         {
+            std::size_t tail = tail_.index.load(std::memory_order_relaxed);
+
+            for ( ; ; )
+            {
+               cell& c = cells_[tail & mask_];
+
+               const std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+               const std::ptrdiff_t lag   = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(tail);
+
+               if (0 == lag)
+               {
+                  if (tail_.index.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                  {
+                     c.value = value;
+                     c.sequence.store(tail + 1, std::memory_order_release);
+                     not_empty_.notify();
+                     return true;
+                  }
+               }
+               else if (lag < 0)
+                  return false;   /* full */
+               else
+                  tail = tail_.index.load(std::memory_order_relaxed);
+            }
+         }
+
+         inline bool try_pop(T& value)
+         {
+            std::size_t head = head_.index.load(std::memory_order_relaxed);
+
+            for ( ; ; )
+            {
+               cell& c = cells_[head & mask_];
+
+               const std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+               const std::ptrdiff_t lag   = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(head + 1);
+
+               if (0 == lag)
+               {
+                  if (head_.index.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+                  {
+                     value = c.value;
+                     c.sequence.store(head + capacity_, std::memory_order_release);
+                     not_full_.notify();
+                     return true;
+                  }
+               }
+               else if (lag < 0)
+                  return false;   /* empty */
+               else
+                  head = head_.index.load(std::memory_order_relaxed);
+            }
+         }
+
+         inline std::size_t try_push_batch(const T* values, const std::size_t count)
+         {
+            std::size_t pushed = 0;
+
+            while ((pushed < count) && try_push(values[pushed]))
+            {
+               ++pushed;
+            }
+
+            return pushed;
+         }
+
+         inline std::size_t try_pop_batch(T* values, const std::size_t count)
+         {
+            std::size_t popped = 0;
+
+            while ((popped < count) && try_pop(values[popped]))
+            {
+               ++popped;
+            }
+
+            return popped;
+         }
+
+         inline bool push(const T& value)
+         {
+            for ( ; ; )
+            {
+               if (closed_.load(std::memory_order_acquire))
+                  return false;
+
+               if (try_push(value))
+                  return true;
+
+               not_full_.wait([this]() { return closed_.load(std::memory_order_acquire) || (size() < capacity_); });
+            }
+         }
+
+         inline bool pop(T& value)
+         {
+            for ( ; ; )
+            {
+               if (try_pop(value))
+                  return true;
+
+               if (closed_.load(std::memory_order_acquire) && (0 == size()))
+                  return false;
+
+               not_empty_.wait([this]() { return closed_.load(std::memory_order_acquire) || (size() > 0); });
+            }
+         }
+
+         inline std::size_t push_batch(const T* values, const std::size_t count)
+         {
+            std::size_t pushed = 0;
+
+            while ((pushed < count) && push(values[pushed]))
+            {
+               ++pushed;
+            }
+
+            return pushed;
+         }
+
+         inline std::size_t pop_batch(T* values, const std::size_t count)
+         {
+            if ((0 == count) || !pop(values[0]))
+               return 0;
+
+            return 1 + try_pop_batch(values + 1, count - 1);
+         }
+
+         inline void close()
+         {
+            closed_.store(true, std::memory_order_release);
+
+            not_empty_.notify_all();
+            not_full_ .notify_all();
+         }
+
+         /* Claimed slots, may briefly count an item still being written or read */
+         inline std::size_t size() const
+         {
+            const std::size_t head = head_.index.load(std::memory_order_acquire);
+            const std::size_t tail = tail_.index.load(std::memory_order_acquire);
+
+            return (tail > head) ? (tail - head) : 0;
+         }
+
+         inline std::size_t capacity() const
+         {
+            return capacity_;
+         }
+
+      private:
+
+         mpmc_ring(const mpmc_ring&);
+         mpmc_ring& operator=(const mpmc_ring&);
+
+         struct alignas(64) cell
+         {
+            std::atomic<std::size_t> sequence;
+            T                        value;
+         };
+
+         struct alignas(64) padded_index
+         {
+            padded_index() : index(0) {}
+
+            std::atomic<std::size_t> index;
+         };
+
+         const std::size_t       capacity_;
+         const std::size_t       mask_;
+         std::unique_ptr<cell[]> cells_;
+
+         padded_index            tail_;
+         padded_index            head_;
+         std::atomic<bool>       closed_;
+
+         WaitPolicy              not_empty_;
+         WaitPolicy              not_full_;
+
+         const memory::charge    charge_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
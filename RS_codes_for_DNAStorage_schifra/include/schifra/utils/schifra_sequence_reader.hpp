@@ -0,0 +1,531 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_SEQUENCE_READER_HPP
+#define INCLUDE_SCHIFRA_SEQUENCE_READER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+#include "schifra/utils/schifra_packed_dna.hpp"
+#include "schifra/utils/schifra_trace.hpp"
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace dna
+      {
+
+         /*
+            FASTQ quality characters are the Phred score plus phred_offset
+            (Sanger / Illumina 1.8+).
+         */
+         static const std::uint8_t phred_offset = 33;
+
+         /* Phred score of a quality character, 0 below the offset */
+         inline std::uint8_t phred_score(const char quality)
+         {
+            const std::uint8_t q = static_cast<std::uint8_t>(quality);
+            return (q > phred_offset) ? static_cast<std::uint8_t>(q - phred_offset) : 0;
+         }
+
+         namespace details
+         {
+            /* First c in [p,end), or end */
+            inline const char* find_byte_scalar(const char* p, const char* end, const char c)
+            {
+               const void* found = std::memchr(p, c, static_cast<std::size_t>(end - p));
+               return found ? static_cast<const char*>(found) : end;
+            }
+
+            #ifdef SCHIFRA_DNA_X86
+
+            __attribute__((target("avx2")))
+            inline const char* find_byte_avx2(const char* p, const char* end, const char c)
+            {
+               const __m256i target = _mm256_set1_epi8(c);
+
+               for ( ; (end - p) >= 32; p += 32)
+               {
+                  const unsigned int hits = static_cast<unsigned int>(_mm256_movemask_epi8(
+                     _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), target)));
+
+                  if (hits)
+                     return p + __builtin_ctz(hits);
+               }
+
+               return find_byte_scalar(p, end, c);
+            }
+
+            #endif
+
+            #ifdef SCHIFRA_DNA_NEON
+
+            inline const char* find_byte_neon(const char* p, const char* end, const char c)
+            {
+               const uint8x16_t target = vdupq_n_u8(static_cast<std::uint8_t>(c));
+
+               for ( ; (end - p) >= 16; p += 16)
+               {
+                  const uint8x16_t hits = vceqq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(p)), target);
+
+                  /* 4 bits per byte of hits */
+                  const std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+
+                  if (mask)
+                     return p + (__builtin_ctzll(mask) >> 2);
+               }
+
+               return find_byte_scalar(p, end, c);
+            }
+
+            #endif
+
+         } // namespace details
+
+         /* First c in [p,end), or end, 32 (AVX2) or 16 (NEON) bytes per step */
+         inline const char* find_byte(const char* p, const char* end, const char c)
+         {
+            #if defined(SCHIFRA_DNA_X86)
+            if (host_cpu_features().avx2)
+               return details::find_byte_avx2(p, end, c);
+            #elif defined(SCHIFRA_DNA_NEON)
+            return details::find_byte_neon(p, end, c);
+            #endif
+
+            return details::find_byte_scalar(p, end, c);
+         }
+
+         /*
+            One read, the views being valid until the next call into the
+            reader. quality is empty for FASTA.
+         */
+         struct sequence_record
+         {
+            std::string_view name;
+            std::string_view sequence;
+            std::string_view quality;
+         };
+
+         /*
+            Streaming FASTA/FASTQ reader, the format being told by the first
+            record ('>' or '@'). Input is either a std::istream, read in
+            chunks of chunk_size bytes into a buffer that only grows when a
+            single record does not fit in half of it, or a region already in
+            memory, eg: an mmap'd file, which is parsed in place. Line ends
+            are found a vector at a time by find_byte(), and records come
+            back as views into the chunk, so nothing is allocated per record.
+            FASTQ records are 4 lines ('@' name, bases, '+', qualities), as
+            every current sequencer writes them. FASTA sequences may span
+            lines, those of more than one line being joined into a scratch
+            buffer reused across records. Blank lines and "\r\n" line ends
+            are accepted.
+         */
+         class sequence_reader
+         {
+         public:
+
+            enum format_t
+            {
+               e_unknown = 0,
+               e_fasta   = 1,
+               e_fastq   = 2
+            };
+
+            static const std::size_t default_chunk_size = 1 << 20;
+
+            explicit sequence_reader(std::istream& input, const std::size_t chunk_size = default_chunk_size)
+            : input_(&input),
+              buffer_((chunk_size < 64) ? 64 : chunk_size),
+              pos_(buffer_.data()),
+              end_(buffer_.data()),
+              eof_(false),
+              format_(e_unknown),
+              records_(0),
+              rejected_(0),
+              malformed_(false)
+            {}
+
+            sequence_reader(const char* data, const std::size_t size)
+            : input_(0),
+              pos_(data),
+              end_(data + size),
+              eof_(true),
+              format_(e_unknown),
+              records_(0),
+              rejected_(0),
+              malformed_(false)
+            {}
+
+            /*
+               Read the next record, false at the end of the input or on a
+               malformed record, which malformed() then tells apart.
+            */
+            inline bool next(sequence_record& record)
+            {
+               if (malformed_)
+                  return false;
+
+               for ( ; ; )
+               {
+                  const parse_result result = parse(record);
+
+                  if (e_complete == result)
+                  {
+                     ++records_;
+                     return true;
+                  }
+                  else if (e_end == result)
+                     return false;
+                  else if (e_malformed == result)
+                  {
+                     malformed_ = true;
+                     return false;
+                  }
+                  else if (!refill())
+                  {
+                     /* Truncated last record */
+                     malformed_ = true;
+                     return false;
+                  }
+               }
+            }
+
+            /*
+               Append up to max_records reads to bases (and their qualities
+               to qualities when not null), back to back, each fitted to
+               record_length: cut, or padded with 'N' and '!' (Phred 0). A
+               batch of strands is then in the layout the batch decoders
+               take, and a read with an indel is reported by them as that
+               one strand rather than shifting the ones after it. Returns
+               the records read, 0 at the end of the input.
+            */
+            inline std::size_t read_batch(const std::size_t max_records, const std::size_t record_length,
+                                          std::string& bases, std::string* qualities = 0)
+            {
+               trace::scope parse(trace::e_parser, "read batch");
+
+               sequence_record record;
+               std::size_t count = 0;
+
+               for ( ; (count < max_records) && next(record); ++count)
+               {
+                  append_fitted(bases, record.sequence, record_length, 'N');
+
+                  if (qualities)
+                     append_fitted(*qualities, record.quality, record_length, '!');
+               }
+
+               return count;
+            }
+
+            /*
+               Append up to max_records reads to a packed sequence. Reads
+               with a base other than ACGTacgt cannot be packed and are
+               skipped, counted by rejected(). Returns the records read,
+               packed or not, 0 at the end of the input.
+            */
+            inline std::size_t read_batch(const std::size_t max_records, packed_dna& bases)
+            {
+               trace::scope parse(trace::e_parser, "read batch");
+
+               sequence_record record;
+               std::size_t count = 0;
+
+               for ( ; (count < max_records) && next(record); ++count)
+               {
+                  if (!bases.append(record.sequence.data(), record.sequence.size()))
+                     ++rejected_;
+               }
+
+               return count;
+            }
+
+            inline format_t format() const
+            {
+               return format_;
+            }
+
+            /* Records read so far */
+            inline std::size_t records() const
+            {
+               return records_;
+            }
+
+            inline std::size_t rejected() const
+            {
+               return rejected_;
+            }
+
+            inline bool malformed() const
+            {
+               return malformed_;
+            }
+
+         private:
+
+            sequence_reader(const sequence_reader&);
+            sequence_reader& operator=(const sequence_reader&);
+
+            enum parse_result
+            {
+               e_complete,
+               e_more,
+               e_end,
+               e_malformed
+            };
+
+            static inline void append_fitted(std::string& out, const std::string_view& s, const std::size_t length, const char pad)
+            {
+               const std::size_t n = (s.size() < length) ? s.size() : length;
+
+               out.append(s.data(), n);
+               out.append(length - n, pad);
+            }
+
+            /*
+               Line starting at p: [p,line_end) without its line ending and
+               next the start of the following line. false when the line
+               end is not in the buffer yet.
+            */
+            inline bool line(const char* p, const char*& line_end, const char*& next) const
+            {
+               const char* nl = find_byte(p, end_, '\n');
+
+               if ((nl == end_) && !eof_)
+                  return false;
+
+               next = (nl == end_) ? end_ : nl + 1;
+
+               if ((nl > p) && ('\r' == nl[-1]))
+                  --nl;
+
+               line_end = nl;
+
+               return true;
+            }
+
+            inline const char* skip_blank(const char* p) const
+            {
+               while ((p < end_) && (('\n' == *p) || ('\r' == *p)))
+               {
+                  ++p;
+               }
+
+               return p;
+            }
+
+            /* One record from pos_, which only moves past it once complete */
+            inline parse_result parse(sequence_record& record)
+            {
+               const char* p = skip_blank(pos_);
+
+               if (p == end_)
+               {
+                  pos_ = p;
+                  return eof_ ? e_end : e_more;
+               }
+
+               if (e_unknown == format_)
+               {
+                  if      ('>' == *p) format_ = e_fasta;
+                  else if ('@' == *p) format_ = e_fastq;
+                  else                return e_malformed;
+               }
+
+               const char* line_end = 0;
+               const char* next     = 0;
+
+               if (*p != ((e_fasta == format_) ? '>' : '@'))
+                  return e_malformed;
+
+               if (!line(p, line_end, next))
+                  return e_more;
+
+               record.name = std::string_view(p + 1, static_cast<std::size_t>(line_end - p - 1));
+               p = next;
+
+               return (e_fasta == format_) ? parse_fasta(p, record) : parse_fastq(p, record);
+            }
+
+            inline parse_result parse_fastq(const char* p, sequence_record& record)
+            {
+               const char* line_end = 0;
+               const char* next     = 0;
+
+               if (p == end_)
+                  return eof_ ? e_malformed : e_more;
+
+               if (!line(p, line_end, next))
+                  return e_more;
+
+               record.sequence = std::string_view(p, static_cast<std::size_t>(line_end - p));
+               p = next;
+
+               if (p == end_)
+                  return eof_ ? e_malformed : e_more;
+
+               if ('+' != *p)
+                  return e_malformed;
+
+               if (!line(p, line_end, next))
+                  return e_more;
+
+               p = next;
+
+               if (p == end_)
+                  return eof_ ? e_malformed : e_more;
+
+               if (!line(p, line_end, next))
+                  return e_more;
+
+               record.quality = std::string_view(p, static_cast<std::size_t>(line_end - p));
+
+               if (record.quality.size() != record.sequence.size())
+                  return e_malformed;
+
+               pos_ = next;
+
+               return e_complete;
+            }
+
+            inline parse_result parse_fasta(const char* p, sequence_record& record)
+            {
+               const char* first_begin = 0;
+               const char* first_end   = 0;
+               std::size_t lines       = 0;
+
+               for ( ; ; )
+               {
+                  p = skip_blank(p);
+
+                  if (p == end_)
+                  {
+                     if (!eof_)
+                        return e_more;
+
+                     break;
+                  }
+
+                  if ('>' == *p)
+                     break;
+
+                  const char* line_end = 0;
+                  const char* next     = 0;
+
+                  if (!line(p, line_end, next))
+                     return e_more;
+
+                  if (0 == lines)
+                  {
+                     first_begin = p;
+                     first_end   = line_end;
+                  }
+                  else
+                  {
+                     if (1 == lines)
+                        joined_.assign(first_begin, first_end);
+
+                     joined_.append(p, line_end);
+                  }
+
+                  ++lines;
+                  p = next;
+               }
+
+               if (lines > 1)
+                  record.sequence = std::string_view(joined_);
+               else
+                  record.sequence = std::string_view(first_begin, static_cast<std::size_t>(first_end - first_begin));
+
+               record.quality = std::string_view();
+               pos_ = p;
+
+               return e_complete;
+            }
+
+            /*
+               Move the unparsed tail to the front of the buffer and read
+               after it, doubling the buffer first when the tail is more
+               than half of it. false when nothing more can be read.
+            */
+            inline bool refill()
+            {
+               if ((0 == input_) || eof_)
+                  return false;
+
+               const std::size_t keep = static_cast<std::size_t>(end_ - pos_);
+
+               if ((2 * keep) > buffer_.size())
+               {
+                  std::vector<char> larger(2 * buffer_.size());
+                  std::memcpy(larger.data(), pos_, keep);
+                  buffer_.swap(larger);
+               }
+               else if (keep)
+                  std::memmove(buffer_.data(), pos_, keep);
+
+               {
+                  trace::scope read(trace::e_reader, "refill");
+                  input_->read(buffer_.data() + keep, static_cast<std::streamsize>(buffer_.size() - keep));
+               }
+
+               const std::size_t got = static_cast<std::size_t>(input_->gcount());
+
+               pos_ = buffer_.data();
+               end_ = buffer_.data() + keep + got;
+               eof_ = !(*input_);
+
+               return (got > 0) || eof_;
+            }
+
+            std::istream*     input_;
+            std::vector<char> buffer_;
+            const char*       pos_;
+            const char*       end_;
+            bool              eof_;
+            format_t          format_;
+            std::size_t       records_;
+            std::size_t       rejected_;
+            bool              malformed_;
+            std::string       joined_;
+         };
+
+      } // namespace dna
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
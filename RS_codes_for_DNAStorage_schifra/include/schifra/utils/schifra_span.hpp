@@ -0,0 +1,134 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_SPAN_HPP
+#define INCLUDE_SCHIFRA_SPAN_HPP
+
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         A non-owning view of a contiguous run of symbols, a subset of
+         C++20 std::span for C++17 builds. It lets the codecs read and
+         write caller owned memory (eg: an mmap'd file) without first
+         copying it into a block.
+      */
+      template <typename T>
+      class span
+      {
+      public:
+
+         typedef T           element_type;
+         typedef std::size_t size_type;
+
+         span()
+         : data_(0),
+           size_(0)
+         {}
+
+         span(T* data, const std::size_t size)
+         : data_(data),
+           size_(size)
+         {}
+
+         template <std::size_t N>
+         span(T (&array)[N])
+         : data_(array),
+           size_(N)
+         {}
+
+         template <typename U,
+                   typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+         span(const span<U>& s)
+         : data_(s.data()),
+           size_(s.size())
+         {}
+
+         template <typename U,
+                   typename = typename std::enable_if<std::is_convertible<U(*)[], T(*)[]>::value>::type>
+         span(std::vector<U>& v)
+         : data_(v.data()),
+           size_(v.size())
+         {}
+
+         template <typename U,
+                   typename = typename std::enable_if<std::is_convertible<const U(*)[], T(*)[]>::value>::type>
+         span(const std::vector<U>& v)
+         : data_(v.data()),
+           size_(v.size())
+         {}
+
+         inline T* data() const
+         {
+            return data_;
+         }
+
+         inline std::size_t size() const
+         {
+            return size_;
+         }
+
+         inline bool empty() const
+         {
+            return (0 == size_);
+         }
+
+         inline T& operator[](const std::size_t& index) const
+         {
+            return data_[index];
+         }
+
+         inline T* begin() const
+         {
+            return data_;
+         }
+
+         inline T* end() const
+         {
+            return data_ + size_;
+         }
+
+         inline span subspan(const std::size_t& offset, const std::size_t& count) const
+         {
+            return span(data_ + offset, count);
+         }
+
+      private:
+
+         T*          data_;
+         std::size_t size_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,444 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_TCP_MESH_HPP
+#define INCLUDE_SCHIFRA_TCP_MESH_HPP
+
+
+#if defined(__unix__) || defined(__APPLE__)
+
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Full TCP mesh between the nodes of a job, rank being this node's
+         index into endpoints ("host:port", one per node, the same list on
+         every node). Each node listens on the port of its own endpoint,
+         connects to the nodes of lower rank and accepts those of higher
+         rank, retrying for up to connect_timeout while they come up.
+
+         exchange() is the one collective: every node hands in one message
+         per node, its own included, and gets back the one every node
+         addressed to it. Messages are sent on a thread per peer while the
+         calling thread receives, so nodes never block on each other's
+         full socket buffers. Anything providing rank(), nodes() and
+         exchange() (eg: over MPI_Alltoallv) may stand in for it.
+      */
+      class tcp_mesh
+      {
+      public:
+
+         tcp_mesh(const std::size_t               rank,
+                  const std::vector<std::string>& endpoints,
+                  const std::chrono::seconds      connect_timeout = std::chrono::seconds(30))
+         : rank_(rank),
+           sockets_(endpoints.size(), -1),
+           valid_(false)
+         {
+            if (rank_ >= endpoints.size())
+            {
+               std::cout << "utils::tcp_mesh() - Error: rank is not one of the endpoints." << std::endl;
+               return;
+            }
+
+            const int listener = listen_on(endpoints[rank_]);
+
+            if (listener < 0)
+            {
+               std::cout << "utils::tcp_mesh() - Error: could not listen on " << endpoints[rank_] << "." << std::endl;
+               return;
+            }
+
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + connect_timeout;
+
+            bool connected = true;
+
+            for (std::size_t peer = 0; connected && (peer < rank_); ++peer)
+            {
+               sockets_[peer] = connect_to(endpoints[peer], deadline);
+
+               const std::uint32_t me = static_cast<std::uint32_t>(rank_);
+
+               connected = (sockets_[peer] >= 0) && send_all(sockets_[peer], &me, sizeof(me));
+            }
+
+            for (std::size_t accepted = rank_ + 1; connected && (accepted < endpoints.size()); ++accepted)
+            {
+               const int fd = ::accept(listener, 0, 0);
+
+               std::uint32_t peer = 0;
+
+               if ((fd < 0) || !receive_all(fd, &peer, sizeof(peer)) || (peer <= rank_) || (peer >= endpoints.size()) || (sockets_[peer] >= 0))
+               {
+                  if (fd >= 0)
+                     ::close(fd);
+
+                  connected = false;
+                  break;
+               }
+
+               no_delay(fd);
+
+               sockets_[peer] = fd;
+            }
+
+            ::close(listener);
+
+            if (!connected)
+            {
+               std::cout << "utils::tcp_mesh() - Error: could not connect every node." << std::endl;
+               return;
+            }
+
+            valid_ = true;
+         }
+
+        ~tcp_mesh()
+         {
+            for (std::size_t i = 0; i < sockets_.size(); ++i)
+            {
+               if (sockets_[i] >= 0)
+                  ::close(sockets_[i]);
+            }
+         }
+
+         inline bool valid() const
+         {
+            return valid_;
+         }
+
+         inline std::size_t rank() const
+         {
+            return rank_;
+         }
+
+         inline std::size_t nodes() const
+         {
+            return sockets_.size();
+         }
+
+         /* All-to-all: outgoing[n] goes to node n, incoming[n] is what node n sent here */
+         bool exchange(const std::vector<std::string>& outgoing, std::vector<std::string>& incoming)
+         {
+            incoming.assign(nodes(), std::string());
+
+            if (!valid_ || (outgoing.size() != nodes()))
+               return false;
+
+            incoming[rank_] = outgoing[rank_];
+
+            std::vector<char>        sent(nodes(), 1);
+            std::vector<std::thread> senders;
+
+            for (std::size_t peer = 0; peer < nodes(); ++peer)
+            {
+               if (peer == rank_)
+                  continue;
+
+               senders.push_back(std::thread([this, peer, &outgoing, &sent]()
+                                             {
+                                                sent[peer] = send_message(sockets_[peer], outgoing[peer]) ? 1 : 0;
+                                             }));
+            }
+
+            bool result = true;
+
+            for (std::size_t peer = 0; peer < nodes(); ++peer)
+            {
+               if ((peer != rank_) && result)
+                  result = receive_message(sockets_[peer], incoming[peer]);
+            }
+
+            /* Note: A receive failure leaves senders blocked on a live peer, shut the sockets to free them */
+            if (!result)
+            {
+               for (std::size_t peer = 0; peer < nodes(); ++peer)
+               {
+                  if (peer != rank_)
+                     ::shutdown(sockets_[peer], SHUT_RDWR);
+               }
+            }
+
+            for (std::size_t i = 0; i < senders.size(); ++i)
+            {
+               senders[i].join();
+            }
+
+            for (std::size_t peer = 0; peer < nodes(); ++peer)
+            {
+               result = result && (0 != sent[peer]);
+            }
+
+            if (!result)
+            {
+               std::cout << "utils::tcp_mesh::exchange() - Error: lost a node." << std::endl;
+               valid_ = false;
+            }
+
+            return result;
+         }
+
+      private:
+
+         tcp_mesh(const tcp_mesh&);
+         tcp_mesh& operator=(const tcp_mesh&);
+
+         static inline bool split(const std::string& endpoint, std::string& host, std::string& port)
+         {
+            const std::size_t colon = endpoint.rfind(':');
+
+            if ((std::string::npos == colon) || (colon + 1 == endpoint.size()))
+               return false;
+
+            host = endpoint.substr(0, colon);
+            port = endpoint.substr(colon + 1);
+
+            /* Note: "[::1]:9000" style IPv6 hosts */
+            if ((host.size() >= 2) && ('[' == host[0]) && (']' == host[host.size() - 1]))
+               host = host.substr(1, host.size() - 2);
+
+            return true;
+         }
+
+         static inline int listen_on(const std::string& endpoint)
+         {
+            std::string host;
+            std::string port;
+
+            if (!split(endpoint, host, port))
+               return -1;
+
+            ::addrinfo hints;
+
+            std::memset(&hints, 0, sizeof(hints));
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags    = AI_PASSIVE;
+
+            ::addrinfo* addresses = 0;
+
+            /* Note: Listen on every interface, host only names this node to the others */
+            if (0 != ::getaddrinfo(0, port.c_str(), &hints, &addresses))
+               return -1;
+
+            int listener = -1;
+
+            for (::addrinfo* a = addresses; (0 != a) && (listener < 0); a = a->ai_next)
+            {
+               const int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+               if (fd < 0)
+                  continue;
+
+               const int on = 1;
+
+               ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+               if ((0 == ::bind(fd, a->ai_addr, a->ai_addrlen)) && (0 == ::listen(fd, SOMAXCONN)))
+                  listener = fd;
+               else
+                  ::close(fd);
+            }
+
+            ::freeaddrinfo(addresses);
+
+            return listener;
+         }
+
+         static inline int connect_to(const std::string& endpoint, const std::chrono::steady_clock::time_point& deadline)
+         {
+            std::string host;
+            std::string port;
+
+            if (!split(endpoint, host, port))
+               return -1;
+
+            ::addrinfo hints;
+
+            std::memset(&hints, 0, sizeof(hints));
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            for ( ; ; )
+            {
+               ::addrinfo* addresses = 0;
+
+               int fd = -1;
+
+               if (0 == ::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses))
+               {
+                  for (::addrinfo* a = addresses; (0 != a) && (fd < 0); a = a->ai_next)
+                  {
+                     fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+
+                     if ((fd >= 0) && (0 != ::connect(fd, a->ai_addr, a->ai_addrlen)))
+                     {
+                        ::close(fd);
+                        fd = -1;
+                     }
+                  }
+
+                  ::freeaddrinfo(addresses);
+               }
+
+               if (fd >= 0)
+               {
+                  no_delay(fd);
+                  return fd;
+               }
+
+               if (std::chrono::steady_clock::now() > deadline)
+                  return -1;
+
+               /* Note: The peer may not be listening yet */
+               std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+         }
+
+         static inline void no_delay(const int fd)
+         {
+            const int on = 1;
+
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+         }
+
+         static inline bool send_all(const int fd, const void* data, std::size_t size)
+         {
+            const char* p = static_cast<const char*>(data);
+
+            while (size > 0)
+            {
+               #if defined(MSG_NOSIGNAL)
+               const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+               #else
+               const ssize_t n = ::send(fd, p, size, 0);
+               #endif
+
+               if (n < 0)
+               {
+                  if (EINTR == errno)
+                     continue;
+
+                  return false;
+               }
+
+               p    += n;
+               size -= static_cast<std::size_t>(n);
+            }
+
+            return true;
+         }
+
+         static inline bool receive_all(const int fd, void* data, std::size_t size)
+         {
+            char* p = static_cast<char*>(data);
+
+            while (size > 0)
+            {
+               const ssize_t n = ::recv(fd, p, size, 0);
+
+               if (n < 0)
+               {
+                  if (EINTR == errno)
+                     continue;
+
+                  return false;
+               }
+               else if (0 == n)
+                  return false;
+
+               p    += n;
+               size -= static_cast<std::size_t>(n);
+            }
+
+            return true;
+         }
+
+         /* A message is its size, 8 bytes little endian, then its bytes */
+         static inline bool send_message(const int fd, const std::string& message)
+         {
+            unsigned char size[8];
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               size[i] = static_cast<unsigned char>((static_cast<std::uint64_t>(message.size()) >> (8 * i)) & 0xFF);
+            }
+
+            return send_all(fd, size, sizeof(size)) && send_all(fd, message.data(), message.size());
+         }
+
+         static inline bool receive_message(const int fd, std::string& message)
+         {
+            unsigned char size[8];
+
+            if (!receive_all(fd, size, sizeof(size)))
+               return false;
+
+            std::uint64_t length = 0;
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+               length |= static_cast<std::uint64_t>(size[i]) << (8 * i);
+            }
+
+            message.resize(static_cast<std::size_t>(length));
+
+            return message.empty() || receive_all(fd, &message[0], message.size());
+         }
+
+         const std::size_t rank_;
+         std::vector<int>  sockets_;
+         bool              valid_;
+      };
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
+
+#endif
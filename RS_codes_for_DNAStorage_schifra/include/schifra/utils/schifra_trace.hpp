@@ -0,0 +1,826 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_TRACE_HPP
+#define INCLUDE_SCHIFRA_TRACE_HPP
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef SCHIFRA_TRACE
+#include <atomic>
+#include <memory>
+#include <mutex>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      /*
+         Timeline of the stages of the file pipelines and the codec
+         executor, ie: what each thread was doing when, written out as
+         Chrome trace JSON (chrome://tracing, ui.perfetto.dev) or as a
+         Perfetto protobuf trace.
+
+         Recording is compiled in only when SCHIFRA_TRACE is defined (the
+         CMake option of the same name defines it for every target linking
+         schifra), and then only between start() and stop(). Compiled out
+         the hooks are empty inline functions, compiled in but stopped
+         each hook is one relaxed load of a flag.
+
+         Every thread records into its own ring of events_per_thread
+         events, written with no lock, the oldest being overwritten once
+         it is full. A ring outlives its thread until the next start(), so
+         the threads of a pipeline that has returned are still dumped.
+
+         Event names are not copied, they must be string literals or
+         otherwise outlive the dump.
+      */
+      namespace trace
+      {
+
+         enum category_t
+         {
+            e_reader         = 0,
+            e_parser         = 1,
+            e_codec          = 2,
+            e_compression    = 3,
+            e_writer         = 4,
+            e_queue_wait     = 5,
+            e_transfer       = 6,   /* host <-> device copies of an offload backend */
+            e_category_count = 7
+         };
+
+         inline const char* category_name(const category_t category)
+         {
+            switch (category)
+            {
+               case e_reader      : return "reader";
+               case e_parser      : return "parser";
+               case e_codec       : return "codec";
+               case e_compression : return "compression";
+               case e_writer      : return "writer";
+               case e_queue_wait  : return "queue_wait";
+               case e_transfer    : return "transfer";
+               default            : return "unknown";
+            }
+         }
+
+         #ifdef SCHIFRA_TRACE
+         static constexpr bool enabled = true;
+         #else
+         static constexpr bool enabled = false;
+         #endif
+
+         static constexpr std::size_t default_events_per_thread = 64 * 1024;
+
+         struct event
+         {
+            enum kind_t
+            {
+               e_slice   = 0,
+               e_counter = 1
+            };
+
+            const char*   name;
+            std::uint64_t begin;      /* ns since start() */
+            std::uint64_t duration;   /* ns, of a slice */
+            std::int64_t  value;      /* of a counter, or the argument of a slice, eg: bytes */
+            std::uint8_t  category;
+            std::uint8_t  kind;
+         };
+
+         /* The events of one thread in the order they ended */
+         struct thread_events
+         {
+            std::uint32_t      tid;
+            std::string        name;
+            std::vector<event> events;
+            std::uint64_t      dropped;   /* overwritten once the ring was full */
+         };
+
+         #ifdef SCHIFRA_TRACE
+
+         namespace details
+         {
+            inline std::uint64_t now()
+            {
+               return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch()).count());
+            }
+
+            inline std::uint64_t nanoseconds(const std::chrono::steady_clock::time_point t)
+            {
+               return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+            }
+
+            inline std::atomic<bool> active(false);
+
+            /*
+               Events of one thread in one session. Only the owning thread
+               pushes, written_ being published after the event so that
+               collect() never copies a half written one.
+               Note: Collecting a ring that is still being written may see
+                     events overwritten under it, dump after stop().
+            */
+            class ring
+            {
+            public:
+
+               ring(const std::size_t capacity, const std::uint64_t session_id, const std::uint32_t thread_id, const std::string& thread_name)
+               : session(session_id),
+                 tid(thread_id),
+                 name(thread_name),
+                 events_(std::max<std::size_t>(capacity, 1)),
+                 written_(0)
+               {}
+
+               inline void push(const event& e)
+               {
+                  const std::uint64_t written = written_.load(std::memory_order_relaxed);
+
+                  events_[written % events_.size()] = e;
+
+                  written_.store(written + 1, std::memory_order_release);
+               }
+
+               inline void collect(const std::uint64_t origin, thread_events& out) const
+               {
+                  const std::uint64_t written = written_.load(std::memory_order_acquire);
+                  const std::uint64_t kept    = std::min<std::uint64_t>(written, events_.size());
+
+                  out.tid     = tid;
+                  out.name    = name;
+                  out.dropped = written - kept;
+
+                  out.events.clear();
+                  out.events.reserve(static_cast<std::size_t>(kept));
+
+                  for (std::uint64_t i = written - kept; i < written; ++i)
+                  {
+                     event e = events_[i % events_.size()];
+
+                     e.begin = (e.begin > origin) ? (e.begin - origin) : 0;
+
+                     out.events.push_back(e);
+                  }
+               }
+
+               const std::uint64_t session;
+               const std::uint32_t tid;
+               std::string         name;   /* guarded by the registry */
+
+            private:
+
+               ring(const ring&);
+               ring& operator=(const ring&);
+
+               std::vector<event>         events_;
+               std::atomic<std::uint64_t> written_;
+            };
+
+            class registry
+            {
+            public:
+
+               static inline registry& instance()
+               {
+                  static registry r;
+                  return r;
+               }
+
+               inline void start(const std::size_t events_per_thread)
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  rings_.clear();
+
+                  capacity_ = events_per_thread;
+                  origin_   = now();
+
+                  session_.fetch_add(1, std::memory_order_release);
+                  active.store(true, std::memory_order_release);
+               }
+
+               inline std::uint64_t session() const
+               {
+                  return session_.load(std::memory_order_acquire);
+               }
+
+               inline std::shared_ptr<ring> attach(const std::uint32_t tid, const std::string& name)
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  std::shared_ptr<ring> r = std::make_shared<ring>(capacity_, session_.load(std::memory_order_relaxed), tid, name);
+
+                  rings_.push_back(r);
+
+                  return r;
+               }
+
+               inline void rename(ring& r, const std::string& name)
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  r.name = name;
+               }
+
+               inline std::vector<thread_events> collect()
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+
+                  std::vector<thread_events> result(rings_.size());
+
+                  for (std::size_t i = 0; i < rings_.size(); ++i)
+                  {
+                     rings_[i]->collect(origin_, result[i]);
+                  }
+
+                  return result;
+               }
+
+            private:
+
+               registry()
+               : capacity_(default_events_per_thread),
+                 origin_(0),
+                 session_(0)
+               {}
+
+               registry(const registry&);
+               registry& operator=(const registry&);
+
+               std::mutex                         mutex_;
+               std::vector<std::shared_ptr<ring>> rings_;
+               std::size_t                        capacity_;
+               std::uint64_t                      origin_;
+               std::atomic<std::uint64_t>         session_;
+            };
+
+            struct thread_state
+            {
+               thread_state()
+               : tid(next_tid().fetch_add(1, std::memory_order_relaxed))
+               {}
+
+               static inline std::atomic<std::uint32_t>& next_tid()
+               {
+                  static std::atomic<std::uint32_t> tid(1);
+                  return tid;
+               }
+
+               std::shared_ptr<ring> current;
+               std::uint32_t         tid;
+               std::string           name;
+            };
+
+            inline thread_state& local()
+            {
+               static thread_local thread_state s;
+               return s;
+            }
+
+            /* The thread's ring of the current session, made on its first event */
+            inline ring& local_ring()
+            {
+               thread_state& s = local();
+
+               registry& r = registry::instance();
+
+               if (!s.current || (s.current->session != r.session()))
+                  s.current = r.attach(s.tid, s.name);
+
+               return *s.current;
+            }
+
+            inline void record(const event& e)
+            {
+               if (active.load(std::memory_order_relaxed))
+                  local_ring().push(e);
+            }
+
+         } // namespace details
+
+         /*
+            Start a new session, dropping the events of the last one, each
+            thread recording its last events_per_thread events.
+         */
+         inline void start(const std::size_t events_per_thread = default_events_per_thread)
+         {
+            details::registry::instance().start(events_per_thread);
+         }
+
+         inline void stop()
+         {
+            details::active.store(false, std::memory_order_release);
+         }
+
+         inline bool active()
+         {
+            return details::active.load(std::memory_order_relaxed);
+         }
+
+         /* Name the calling thread's track, eg: "pipeline reader" */
+         inline void set_thread_name(const std::string& name)
+         {
+            details::thread_state& s = details::local();
+
+            if (s.name == name)
+               return;
+
+            s.name = name;
+
+            if (s.current)
+               details::registry::instance().rename(*s.current, name);
+         }
+
+         /* A slice measured by the caller, eg: a queue wait that began on another thread */
+         inline void complete(const category_t category,
+                              const char* name,
+                              const std::chrono::steady_clock::time_point begin,
+                              const std::chrono::steady_clock::time_point end,
+                              const std::int64_t value = 0)
+         {
+            if (!active())
+               return;
+
+            const std::uint64_t b = details::nanoseconds(begin);
+            const std::uint64_t e = details::nanoseconds(end);
+
+            const event ev = { name, b, (e > b) ? (e - b) : 0, value, static_cast<std::uint8_t>(category), event::e_slice };
+
+            details::record(ev);
+         }
+
+         /* A sample of a value over time, eg: a queue's depth */
+         inline void counter(const char* name, const std::int64_t value)
+         {
+            if (!active())
+               return;
+
+            const event ev = { name, details::now(), 0, value, static_cast<std::uint8_t>(e_queue_wait), event::e_counter };
+
+            details::record(ev);
+         }
+
+         /*
+            Records the enclosing scope as a slice of category, started
+            only when tracing was active at its construction.
+         */
+         class scope
+         {
+         public:
+
+            scope(const category_t category, const char* name, const std::int64_t value = 0)
+            : name_(name),
+              value_(value),
+              begin_(active() ? details::now() : 0),
+              category_(category)
+            {}
+
+           ~scope()
+            {
+               if (0 == begin_)
+                  return;
+
+               const event ev = { name_, begin_, details::now() - begin_, value_, static_cast<std::uint8_t>(category_), event::e_slice };
+
+               details::record(ev);
+            }
+
+            /* The slice's argument, eg: the bytes a read returned */
+            inline void value(const std::int64_t v)
+            {
+               value_ = v;
+            }
+
+         private:
+
+            scope(const scope&);
+            scope& operator=(const scope&);
+
+            const char*         name_;
+            std::int64_t        value_;
+            const std::uint64_t begin_;
+            const category_t    category_;
+         };
+
+         /* The events of every thread of the current, or last, session */
+         inline std::vector<thread_events> events()
+         {
+            return details::registry::instance().collect();
+         }
+
+         #else
+
+         inline void start(const std::size_t = default_events_per_thread) {}
+         inline void stop () {}
+         inline bool active() { return false; }
+
+         inline void set_thread_name(const std::string&) {}
+
+         inline void complete(const category_t, const char*,
+                              const std::chrono::steady_clock::time_point,
+                              const std::chrono::steady_clock::time_point,
+                              const std::int64_t = 0) {}
+
+         inline void counter(const char*, const std::int64_t) {}
+
+         class scope
+         {
+         public:
+
+            scope(const category_t, const char*, const std::int64_t = 0) {}
+
+            inline void value(const std::int64_t) {}
+         };
+
+         inline std::vector<thread_events> events() { return std::vector<thread_events>(); }
+
+         #endif
+
+         namespace details
+         {
+            inline void write_json_string(std::ostream& out, const char* s)
+            {
+               out << '"';
+
+               for ( ; *s; ++s)
+               {
+                  const unsigned char c = static_cast<unsigned char>(*s);
+
+                  if (('"' == c) || ('\\' == c))
+                     out << '\\' << static_cast<char>(c);
+                  else if (c < 0x20)
+                  {
+                     char escaped[8];
+                     std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                     out << escaped;
+                  }
+                  else
+                     out << static_cast<char>(c);
+               }
+
+               out << '"';
+            }
+
+            /* Microseconds, as Chrome trace timestamps are, to the nanosecond */
+            inline void write_microseconds(std::ostream& out, const std::uint64_t ns)
+            {
+               char buffer[32];
+               std::snprintf(buffer, sizeof(buffer), "%llu.%03llu",
+                             static_cast<unsigned long long>(ns / 1000),
+                             static_cast<unsigned long long>(ns % 1000));
+               out << buffer;
+            }
+
+            /* Protobuf wire format, enough of it to write Perfetto's trace.proto */
+            namespace proto
+            {
+               inline void varint(std::string& out, std::uint64_t v)
+               {
+                  while (v >= 0x80)
+                  {
+                     out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+                     v >>= 7;
+                  }
+
+                  out.push_back(static_cast<char>(v));
+               }
+
+               inline void uint_field(std::string& out, const std::uint32_t field, const std::uint64_t v)
+               {
+                  varint(out, static_cast<std::uint64_t>(field) << 3);
+                  varint(out, v);
+               }
+
+               inline void bytes_field(std::string& out, const std::uint32_t field, const std::string& v)
+               {
+                  varint(out, (static_cast<std::uint64_t>(field) << 3) | 2);
+                  varint(out, v.size());
+                  out += v;
+               }
+            }
+
+            /* Perfetto's TracePacket field numbers */
+            enum packet_field_t
+            {
+               e_packet_timestamp        =  8,
+               e_packet_sequence_id      = 10,
+               e_packet_track_event      = 11,
+               e_packet_sequence_flags   = 13,
+               e_packet_track_descriptor = 60
+            };
+
+            enum track_event_type_t
+            {
+               e_slice_begin = 1,
+               e_slice_end   = 2,
+               e_counter     = 4
+            };
+
+            static constexpr std::uint32_t pid                    = 1;
+            static constexpr std::uint64_t process_track          = 1;
+            static constexpr std::uint64_t first_counter_track    = std::uint64_t(1) << 48;
+            static constexpr std::uint32_t descriptor_sequence_id = 0x7FFFFFFF;
+
+            inline std::uint64_t thread_track(const std::uint32_t tid)
+            {
+               return 1 + tid;
+            }
+
+            inline void write_packet(std::ostream& out, const std::string& packet)
+            {
+               std::string framed;
+               proto::bytes_field(framed, 1, packet);
+               out.write(framed.data(), static_cast<std::streamsize>(framed.size()));
+            }
+
+            /* TrackEvent of type on track, name and categories only set for slice begins */
+            inline void write_track_event(std::ostream& out,
+                                          const std::uint32_t sequence_id,
+                                          const std::uint64_t timestamp,
+                                          const track_event_type_t type,
+                                          const std::uint64_t track,
+                                          const event* slice,
+                                          const std::int64_t counter_value = 0)
+            {
+               std::string track_event;
+
+               proto::uint_field(track_event, 9, type);
+               proto::uint_field(track_event, 11, track);
+
+               if (slice)
+               {
+                  proto::bytes_field(track_event, 22, category_name(static_cast<category_t>(slice->category)));
+                  proto::bytes_field(track_event, 23, slice->name);
+
+                  if (0 != slice->value)
+                  {
+                     std::string annotation;
+                     proto::uint_field (annotation,  4, static_cast<std::uint64_t>(slice->value));
+                     proto::bytes_field(annotation, 10, "value");
+                     proto::bytes_field(track_event, 4, annotation);
+                  }
+               }
+
+               if (e_counter == type)
+                  proto::uint_field(track_event, 30, static_cast<std::uint64_t>(counter_value));
+
+               std::string packet;
+
+               proto::uint_field (packet, e_packet_timestamp  , timestamp);
+               proto::uint_field (packet, e_packet_sequence_id, sequence_id);
+               proto::bytes_field(packet, e_packet_track_event, track_event);
+
+               write_packet(out, packet);
+            }
+
+         } // namespace details
+
+         /*
+            Chrome trace JSON, one complete ("X") event per slice and one
+            counter ("C") event per sample, each thread named by a
+            thread_name metadata event.
+         */
+         inline bool write_chrome_json(std::ostream& out, const std::vector<thread_events>& threads = events())
+         {
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+            out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << details::pid << ",\"args\":{\"name\":\"schifra\"}}";
+
+            for (std::size_t t = 0; t < threads.size(); ++t)
+            {
+               const thread_events& thread = threads[t];
+
+               const std::string name = thread.name.empty() ? ("thread " + std::to_string(thread.tid)) : thread.name;
+
+               out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << details::pid << ",\"tid\":" << thread.tid << ",\"args\":{\"name\":";
+               details::write_json_string(out, name.c_str());
+               out << ",\"dropped\":" << thread.dropped << "}}";
+
+               for (std::size_t i = 0; i < thread.events.size(); ++i)
+               {
+                  const event& e = thread.events[i];
+
+                  out << ",\n{\"name\":";
+                  details::write_json_string(out, e.name);
+
+                  if (event::e_slice == e.kind)
+                  {
+                     out << ",\"cat\":\"" << category_name(static_cast<category_t>(e.category)) << "\",\"ph\":\"X\",\"ts\":";
+                     details::write_microseconds(out, e.begin);
+                     out << ",\"dur\":";
+                     details::write_microseconds(out, e.duration);
+                  }
+                  else
+                  {
+                     out << ",\"ph\":\"C\",\"ts\":";
+                     details::write_microseconds(out, e.begin);
+                  }
+
+                  out << ",\"pid\":" << details::pid << ",\"tid\":" << thread.tid;
+
+                  if ((event::e_counter == e.kind) || (0 != e.value))
+                     out << ",\"args\":{\"value\":" << e.value << "}";
+
+                  out << "}";
+               }
+            }
+
+            out << "\n]}\n";
+
+            return static_cast<bool>(out);
+         }
+
+         /*
+            Perfetto protobuf trace: a track per thread, the slices of a
+            thread as begin/end track events on its own packet sequence,
+            and a counter track per counter name.
+         */
+         inline bool write_perfetto(std::ostream& out, const std::vector<thread_events>& threads = events())
+         {
+            using namespace details;
+
+            std::vector<const char*> counters;
+
+            for (std::size_t t = 0; t < threads.size(); ++t)
+            {
+               for (std::size_t i = 0; i < threads[t].events.size(); ++i)
+               {
+                  const event& e = threads[t].events[i];
+
+                  if ((event::e_counter == e.kind) && (counters.end() == std::find(counters.begin(), counters.end(), e.name)))
+                     counters.push_back(e.name);
+               }
+            }
+
+            {
+               std::string process;
+               proto::uint_field (process, 1, pid);
+               proto::bytes_field(process, 6, "schifra");
+
+               std::string descriptor;
+               proto::uint_field (descriptor, 1, process_track);
+               proto::bytes_field(descriptor, 3, process);
+
+               std::string packet;
+               proto::uint_field (packet, e_packet_sequence_id     , descriptor_sequence_id);
+               proto::uint_field (packet, e_packet_sequence_flags  , 1);
+               proto::bytes_field(packet, e_packet_track_descriptor, descriptor);
+
+               write_packet(out, packet);
+            }
+
+            for (std::size_t c = 0; c < counters.size(); ++c)
+            {
+               std::string descriptor;
+               proto::uint_field (descriptor, 1, first_counter_track + c);
+               proto::bytes_field(descriptor, 2, counters[c]);
+               proto::uint_field (descriptor, 5, process_track);
+               proto::bytes_field(descriptor, 8, std::string());
+
+               std::string packet;
+               proto::uint_field (packet, e_packet_sequence_id     , descriptor_sequence_id);
+               proto::bytes_field(packet, e_packet_track_descriptor, descriptor);
+
+               write_packet(out, packet);
+            }
+
+            for (std::size_t t = 0; t < threads.size(); ++t)
+            {
+               const thread_events& thread = threads[t];
+
+               const std::uint32_t sequence_id = thread.tid;
+               const std::uint64_t track       = thread_track(thread.tid);
+
+               {
+                  std::string descriptor_thread;
+                  proto::uint_field(descriptor_thread, 1, pid);
+                  proto::uint_field(descriptor_thread, 2, thread.tid);
+
+                  if (!thread.name.empty())
+                     proto::bytes_field(descriptor_thread, 5, thread.name);
+
+                  std::string descriptor;
+                  proto::uint_field (descriptor, 1, track);
+                  proto::uint_field (descriptor, 5, process_track);
+                  proto::bytes_field(descriptor, 4, descriptor_thread);
+
+                  std::string packet;
+                  proto::uint_field (packet, e_packet_sequence_id     , sequence_id);
+                  proto::uint_field (packet, e_packet_sequence_flags  , 1);
+                  proto::bytes_field(packet, e_packet_track_descriptor, descriptor);
+
+                  write_packet(out, packet);
+               }
+
+               /*
+                  Slices are recorded as they end, a parent after its
+                  children, so begins and ends are put back in time order:
+                  at equal times ends go first, the inner slice's end
+                  before the outer's, and the outer slice's begin first.
+               */
+               struct edge
+               {
+                  std::uint64_t time;
+                  std::uint64_t duration;
+                  std::size_t   index;
+                  bool          begin;
+
+                  bool operator<(const edge& e) const
+                  {
+                     if (time  != e.time ) return time < e.time;
+                     if (begin != e.begin) return !begin;
+                     return begin ? (duration > e.duration) : (duration < e.duration);
+                  }
+               };
+
+               std::vector<edge> edges;
+               edges.reserve(2 * thread.events.size());
+
+               for (std::size_t i = 0; i < thread.events.size(); ++i)
+               {
+                  const event& e = thread.events[i];
+
+                  const edge first = { e.begin, e.duration, i, true };
+                  edges.push_back(first);
+
+                  if (event::e_slice == e.kind)
+                  {
+                     const edge last = { e.begin + e.duration, e.duration, i, false };
+                     edges.push_back(last);
+                  }
+               }
+
+               std::stable_sort(edges.begin(), edges.end());
+
+               for (std::size_t i = 0; i < edges.size(); ++i)
+               {
+                  const event& e = thread.events[edges[i].index];
+
+                  if (event::e_counter == e.kind)
+                  {
+                     const std::size_t c = static_cast<std::size_t>(std::find(counters.begin(), counters.end(), e.name) - counters.begin());
+
+                     write_track_event(out, sequence_id, e.begin, e_counter, first_counter_track + c, 0, e.value);
+                  }
+                  else if (edges[i].begin)
+                     write_track_event(out, sequence_id, e.begin, e_slice_begin, track, &e);
+                  else
+                     write_track_event(out, sequence_id, e.begin + e.duration, e_slice_end, track, 0);
+               }
+            }
+
+            return static_cast<bool>(out);
+         }
+
+         inline bool save_chrome_json(const std::string& file_name)
+         {
+            std::ofstream out(file_name.c_str(), std::ios::binary);
+            return out && write_chrome_json(out);
+         }
+
+         inline bool save_perfetto(const std::string& file_name)
+         {
+            std::ofstream out(file_name.c_str(), std::ios::binary);
+            return out && write_perfetto(out);
+         }
+
+      } // namespace trace
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,317 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_SCHIFRA_TRANSPOSE_HPP
+#define INCLUDE_SCHIFRA_TRANSPOSE_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__SSE2__)
+   #include <emmintrin.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace utils
+   {
+
+      namespace details
+      {
+
+         /*
+            Transpose of one size x size tile of width byte elements:
+            dst[j][dc + i] = src[i][sc + j]. Rows are given as pointers, so
+            they need not be equally spaced (eg: the data of a stack of
+            blocks). The generic tile is scalar, with SSE2 the 1, 2 and 4
+            byte symbols are transposed in registers by unpack networks.
+         */
+         template <std::size_t width>
+         struct transpose_tile
+         {
+            static const std::size_t size = 8;
+
+            template <typename T>
+            static inline void apply(const T* const* src, const std::size_t sc, T* const* dst, const std::size_t dc)
+            {
+               for (std::size_t i = 0; i < size; ++i)
+               {
+                  for (std::size_t j = 0; j < size; ++j)
+                  {
+                     dst[j][dc + i] = src[i][sc + j];
+                  }
+               }
+            }
+         };
+
+         #if defined(__SSE2__)
+         template <>
+         struct transpose_tile<1>
+         {
+            static const std::size_t size = 8;
+
+            template <typename T>
+            static inline void apply(const T* const* src, const std::size_t sc, T* const* dst, const std::size_t dc)
+            {
+               __m128i r[8];
+
+               for (std::size_t i = 0; i < 8; ++i)
+               {
+                  r[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src[i] + sc));
+               }
+
+               const __m128i t0 = _mm_unpacklo_epi8(r[0], r[1]);
+               const __m128i t1 = _mm_unpacklo_epi8(r[2], r[3]);
+               const __m128i t2 = _mm_unpacklo_epi8(r[4], r[5]);
+               const __m128i t3 = _mm_unpacklo_epi8(r[6], r[7]);
+
+               const __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+               const __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+               const __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+               const __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+
+               /* Each of v holds two complete columns */
+               const __m128i v[4] = {
+                                       _mm_unpacklo_epi32(u0, u2),
+                                       _mm_unpackhi_epi32(u0, u2),
+                                       _mm_unpacklo_epi32(u1, u3),
+                                       _mm_unpackhi_epi32(u1, u3)
+                                    };
+
+               for (std::size_t j = 0; j < 4; ++j)
+               {
+                  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst[2 * j    ] + dc), v[j]);
+                  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst[2 * j + 1] + dc), _mm_unpackhi_epi64(v[j], v[j]));
+               }
+            }
+         };
+
+         template <>
+         struct transpose_tile<2>
+         {
+            static const std::size_t size = 8;
+
+            template <typename T>
+            static inline void apply(const T* const* src, const std::size_t sc, T* const* dst, const std::size_t dc)
+            {
+               __m128i r[8];
+
+               for (std::size_t i = 0; i < 8; ++i)
+               {
+                  r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[i] + sc));
+               }
+
+               __m128i t[8];
+
+               for (std::size_t i = 0; i < 4; ++i)
+               {
+                  t[2 * i    ] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+                  t[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+               }
+
+               /* u[0..3]: columns (0,1) (2,3) (4,5) (6,7) of rows 0-3, u[4..7] the same of rows 4-7 */
+               __m128i u[8];
+
+               for (std::size_t h = 0; h < 2; ++h)
+               {
+                  u[4 * h    ] = _mm_unpacklo_epi32(t[4 * h    ], t[4 * h + 2]);
+                  u[4 * h + 1] = _mm_unpackhi_epi32(t[4 * h    ], t[4 * h + 2]);
+                  u[4 * h + 2] = _mm_unpacklo_epi32(t[4 * h + 1], t[4 * h + 3]);
+                  u[4 * h + 3] = _mm_unpackhi_epi32(t[4 * h + 1], t[4 * h + 3]);
+               }
+
+               for (std::size_t j = 0; j < 4; ++j)
+               {
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[2 * j    ] + dc), _mm_unpacklo_epi64(u[j], u[j + 4]));
+                  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[2 * j + 1] + dc), _mm_unpackhi_epi64(u[j], u[j + 4]));
+               }
+            }
+         };
+
+         template <>
+         struct transpose_tile<4>
+         {
+            static const std::size_t size = 4;
+
+            template <typename T>
+            static inline void apply(const T* const* src, const std::size_t sc, T* const* dst, const std::size_t dc)
+            {
+               const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[0] + sc));
+               const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[1] + sc));
+               const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[2] + sc));
+               const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[3] + sc));
+
+               const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+               const __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+               const __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+               const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[0] + dc), _mm_unpacklo_epi64(t0, t2));
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[1] + dc), _mm_unpackhi_epi64(t0, t2));
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[2] + dc), _mm_unpacklo_epi64(t1, t3));
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[3] + dc), _mm_unpackhi_epi64(t1, t3));
+            }
+         };
+         #endif
+
+      } // namespace details
+
+      /*
+         dst_row(c)[r] = src_row(r)[c] for every r < height and c < width,
+         where src_row(r) and dst_row(c) return pointers to the rows of the
+         source and destination, which must not overlap.
+
+         The matrix is walked a band of tile rows at a time, so the source
+         is read sequentially and each destination row is written a tile
+         (eg: 8 bytes) at a time while its cache line is still resident.
+      */
+      template <typename T, typename SourceRow, typename DestinationRow>
+      inline void transpose(const std::size_t height, const std::size_t width,
+                            SourceRow src_row, DestinationRow dst_row)
+      {
+         typedef details::transpose_tile<sizeof(T)> tile;
+
+         const std::size_t n           = tile::size;
+         const std::size_t full_height = height - (height % n);
+         const std::size_t full_width  = width  - (width  % n);
+
+         const T* src[n];
+         T*       dst[n];
+
+         for (std::size_t r0 = 0; r0 < full_height; r0 += n)
+         {
+            for (std::size_t k = 0; k < n; ++k)
+            {
+               src[k] = src_row(r0 + k);
+            }
+
+            for (std::size_t c0 = 0; c0 < full_width; c0 += n)
+            {
+               for (std::size_t k = 0; k < n; ++k)
+               {
+                  dst[k] = dst_row(c0 + k);
+               }
+
+               tile::apply(src, c0, dst, r0);
+            }
+
+            for (std::size_t c = full_width; c < width; ++c)
+            {
+               T* d = dst_row(c);
+
+               for (std::size_t k = 0; k < n; ++k)
+               {
+                  d[r0 + k] = src[k][c];
+               }
+            }
+         }
+
+         for (std::size_t r = full_height; r < height; ++r)
+         {
+            const T* s = src_row(r);
+
+            for (std::size_t c = 0; c < width; ++c)
+            {
+               dst_row(c)[r] = s[c];
+            }
+         }
+      }
+
+      /*
+         Swap row(i)[offset + j] with row(j)[offset + i] for every i < j < n,
+         ie: transpose the n x n matrix at column offset of the rows in
+         place. Off-diagonal tiles are transposed pairwise through one tile
+         of scratch.
+      */
+      template <typename T, typename Row>
+      inline void transpose_in_place(const std::size_t n, Row row, const std::size_t offset = 0)
+      {
+         typedef details::transpose_tile<sizeof(T)> tile;
+
+         const std::size_t t    = tile::size;
+         const std::size_t full = n - (n % t);
+
+         T  scratch    [t][t];
+         T* scratch_row[t];
+         T* upper      [t];
+         T* lower      [t];
+
+         for (std::size_t k = 0; k < t; ++k)
+         {
+            scratch_row[k] = scratch[k];
+         }
+
+         for (std::size_t i0 = 0; i0 < full; i0 += t)
+         {
+            for (std::size_t k = 0; k < t; ++k)
+            {
+               upper[k] = row(i0 + k) + offset;
+            }
+
+            for (std::size_t j0 = i0; j0 < full; j0 += t)
+            {
+               for (std::size_t k = 0; k < t; ++k)
+               {
+                  lower[k] = row(j0 + k) + offset;
+               }
+
+               /*
+                  Tile (i0, j0) goes to scratch, tile (j0, i0) then takes
+                  its place and scratch fills (j0, i0). The diagonal tile
+                  is its own partner.
+               */
+               tile::apply(upper, j0, scratch_row, 0);
+
+               if (j0 != i0)
+               {
+                  tile::apply(lower, i0, upper, j0);
+               }
+
+               for (std::size_t k = 0; k < t; ++k)
+               {
+                  std::copy(scratch[k], scratch[k] + t, lower[k] + i0);
+               }
+            }
+         }
+
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            T* ri = row(i) + offset;
+
+            for (std::size_t j = std::max(i + 1, full); j < n; ++j)
+            {
+               T* rj = row(j) + offset;
+
+               std::swap(ri[j], rj[i]);
+            }
+         }
+      }
+
+   } // namespace utils
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,421 @@
+/*
+   schifra_dna_module.cpp - Python bindings of the DNA storage codec
+
+   The schifra_dna extension module exposes the whole sequence APIs of
+   dna_storage<15, 4, 11>: encode_sequence()/decode_sequence(),
+   encode_strands()/decode_strands(), decode_strands_oriented() and
+   decode_strands_unique().
+
+   Inputs are taken through the buffer protocol, so bytes, bytearray,
+   memoryview, mmap and NumPy uint8/S1 arrays are read in place, as is the
+   UTF-8 buffer of an ASCII str. The GIL is released for the duration of
+   the codec call, so that Python threads encode and decode concurrently,
+   and every thread reuses its own sequence_buffer so that, once grown, a
+   call allocates nothing but its result objects.
+
+   Copyright (C) 2025 Schifra Project
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "schifra/dna_storage.hpp"
+
+namespace {
+
+typedef schifra::dna_storage<15, 4, 11> codec_type;
+
+// Built on first use, then shared by every call and thread: all of the
+// sequence APIs are const
+const codec_type& codec() {
+    static const codec_type instance;
+    return instance;
+}
+
+// Per thread output of the codec, reused across calls
+codec_type::sequence_buffer& thread_buffer() {
+    static thread_local codec_type::sequence_buffer buffer;
+    return buffer;
+}
+
+// Read only, contiguous view of a Python argument, held for the duration of
+// a call: any C contiguous buffer, or the UTF-8 data of a str
+class input_bytes {
+public:
+    input_bytes() = default;
+    input_bytes(const input_bytes&) = delete;
+    input_bytes& operator=(const input_bytes&) = delete;
+
+    ~input_bytes() {
+        if (has_view_) PyBuffer_Release(&view_);
+    }
+
+    // On failure a Python exception is set and false returned
+    bool acquire(PyObject* object, const char* name) {
+        if (PyUnicode_Check(object)) {
+            Py_ssize_t size = 0;
+            const char* data = PyUnicode_AsUTF8AndSize(object, &size);
+            if (!data) return false;
+            data_ = data;
+            size_ = static_cast<std::size_t>(size);
+            return true;
+        }
+
+        if (PyObject_GetBuffer(object, &view_, PyBUF_C_CONTIGUOUS) != 0) {
+            PyErr_Format(PyExc_TypeError, "%s must be a str or a contiguous bytes-like object, not %.100s",
+                         name, Py_TYPE(object)->tp_name);
+            return false;
+        }
+        has_view_ = true;
+        data_ = static_cast<const char*>(view_.buf);
+        size_ = static_cast<std::size_t>(view_.len);
+        return true;
+    }
+
+    std::string_view chars() const { return std::string_view(data_, size_); }
+
+    schifra::utils::span<const std::uint8_t> bytes() const {
+        return schifra::utils::span<const std::uint8_t>(reinterpret_cast<const std::uint8_t*>(data_), size_);
+    }
+
+private:
+    Py_buffer view_{};
+    bool has_view_ = false;
+    const char* data_ = "";
+    std::size_t size_ = 0;
+};
+
+bool parse_engine(const char* name, codec_type::batch_engine& engine) {
+    const std::string_view value = name ? name : "simd";
+    if (value == "simd") {
+        engine = codec_type::batch_engine::simd;
+    }
+    else if (value == "bitsliced") {
+        engine = codec_type::batch_engine::bitsliced;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError, "engine must be 'simd' or 'bitsliced', not '%s'", name);
+        return false;
+    }
+    return true;
+}
+
+// Run call() with the GIL released, turning a C++ exception into a Python
+// one once it is held again. Returns false when call() threw.
+template <typename Call>
+bool run_without_gil(Call call) {
+    std::string message;
+    PyObject* type = nullptr;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        call();
+    }
+    catch (const std::invalid_argument& e) {
+        type = PyExc_ValueError;
+        message = e.what();
+    }
+    catch (const std::bad_alloc&) {
+        type = PyExc_MemoryError;
+    }
+    catch (const std::exception& e) {
+        type = PyExc_RuntimeError;
+        message = e.what();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (type) {
+        PyErr_SetString(type, message.c_str());
+        return false;
+    }
+    return true;
+}
+
+PyObject* to_bytes(const void* data, std::size_t size) {
+    return PyBytes_FromStringAndSize(static_cast<const char*>(data), static_cast<Py_ssize_t>(size));
+}
+
+// Tuple of the given new references, which it takes over, or null with all
+// of them released when any is null
+template <typename... Objects>
+PyObject* make_tuple(Objects... objects) {
+    PyObject* items[] = { objects... };
+    for (PyObject* item : items) {
+        if (!item) {
+            for (PyObject* other : items) Py_XDECREF(other);
+            return nullptr;
+        }
+    }
+    PyObject* tuple = PyTuple_New(sizeof...(Objects));
+    if (!tuple) {
+        for (PyObject* item : items) Py_DECREF(item);
+        return nullptr;
+    }
+    for (std::size_t i = 0; i < sizeof...(Objects); ++i) {
+        PyTuple_SET_ITEM(tuple, static_cast<Py_ssize_t>(i), items[i]);
+    }
+    return tuple;
+}
+
+PyObject* status_bytes(const codec_type::sequence_buffer& out) {
+    return to_bytes(out.status.data(), out.status.size());
+}
+
+PyObject* encode_sequence(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "sequence", "engine", nullptr };
+    PyObject* sequence_object = nullptr;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s:encode_sequence", const_cast<char**>(keywords),
+                                     &sequence_object, &engine_name)) {
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes sequence;
+    if (!parse_engine(engine_name, engine) || !sequence.acquire(sequence_object, "sequence")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    if (!run_without_gil([&] { codec().encode_sequence(sequence.chars(), out, engine); })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()),
+                      to_bytes(out.ecc.data(), out.ecc.size()),
+                      status_bytes(out));
+}
+
+PyObject* decode_sequence(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "strands", "ecc", "length", "engine", nullptr };
+    PyObject* strands_object = nullptr;
+    PyObject* ecc_object = nullptr;
+    Py_ssize_t length = 0;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOn|s:decode_sequence", const_cast<char**>(keywords),
+                                     &strands_object, &ecc_object, &length, &engine_name)) {
+        return nullptr;
+    }
+    if (length < 0) {
+        PyErr_SetString(PyExc_ValueError, "length must not be negative");
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes strands;
+    input_bytes ecc;
+    if (!parse_engine(engine_name, engine) ||
+        !strands.acquire(strands_object, "strands") ||
+        !ecc.acquire(ecc_object, "ecc")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    std::size_t decoded = 0;
+    if (!run_without_gil([&] {
+            decoded = codec().decode_sequence(strands.chars(), ecc.bytes(), static_cast<std::size_t>(length), out, engine);
+        })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()),
+                      status_bytes(out),
+                      PyLong_FromSize_t(decoded));
+}
+
+PyObject* encode_strands(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "sequence", "engine", nullptr };
+    PyObject* sequence_object = nullptr;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s:encode_strands", const_cast<char**>(keywords),
+                                     &sequence_object, &engine_name)) {
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes sequence;
+    if (!parse_engine(engine_name, engine) || !sequence.acquire(sequence_object, "sequence")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    if (!run_without_gil([&] { codec().encode_strands(sequence.chars(), out, engine); })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()), status_bytes(out));
+}
+
+PyObject* decode_strands(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "strands", "length", "engine", nullptr };
+    PyObject* strands_object = nullptr;
+    Py_ssize_t length = 0;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|s:decode_strands", const_cast<char**>(keywords),
+                                     &strands_object, &length, &engine_name)) {
+        return nullptr;
+    }
+    if (length < 0) {
+        PyErr_SetString(PyExc_ValueError, "length must not be negative");
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes strands;
+    if (!parse_engine(engine_name, engine) || !strands.acquire(strands_object, "strands")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    std::size_t decoded = 0;
+    if (!run_without_gil([&] {
+            decoded = codec().decode_strands(strands.chars(), static_cast<std::size_t>(length), out, engine);
+        })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()),
+                      status_bytes(out),
+                      PyLong_FromSize_t(decoded));
+}
+
+PyObject* decode_strands_oriented(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "reads", "engine", nullptr };
+    PyObject* reads_object = nullptr;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s:decode_strands_oriented", const_cast<char**>(keywords),
+                                     &reads_object, &engine_name)) {
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes reads;
+    if (!parse_engine(engine_name, engine) || !reads.acquire(reads_object, "reads")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    std::size_t decoded = 0;
+    if (!run_without_gil([&] { decoded = codec().decode_strands_oriented(reads.chars(), out, engine); })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()),
+                      status_bytes(out),
+                      to_bytes(out.orientation.data(), out.orientation.size()),
+                      PyLong_FromSize_t(decoded));
+}
+
+PyObject* decode_strands_unique(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "reads", "engine", nullptr };
+    PyObject* reads_object = nullptr;
+    const char* engine_name = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s:decode_strands_unique", const_cast<char**>(keywords),
+                                     &reads_object, &engine_name)) {
+        return nullptr;
+    }
+
+    codec_type::batch_engine engine;
+    input_bytes reads;
+    if (!parse_engine(engine_name, engine) || !reads.acquire(reads_object, "reads")) {
+        return nullptr;
+    }
+
+    codec_type::sequence_buffer& out = thread_buffer();
+    std::size_t decoded = 0;
+    if (!run_without_gil([&] { decoded = codec().decode_strands_unique(reads.chars(), out, engine); })) {
+        return nullptr;
+    }
+
+    return make_tuple(to_bytes(out.dna.data(), out.dna.size()),
+                      status_bytes(out),
+                      to_bytes(out.orientation.data(), out.orientation.size()),
+                      to_bytes(out.copies.data(), out.copies.size() * sizeof(std::uint32_t)),
+                      PyLong_FromSize_t(decoded));
+}
+
+PyMethodDef module_methods[] = {
+    { "encode_sequence", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(encode_sequence)),
+      METH_VARARGS | METH_KEYWORDS,
+      "encode_sequence(sequence, engine='simd') -> (strands, ecc, status)\n\n"
+      "Encode a DNA sequence of any length in blocks of DATA_LENGTH bases, the\n"
+      "last padded with 'A's. strands holds CODE_LENGTH bases and ecc\n"
+      "FEC_LENGTH symbols per block, status one STATUS_* byte per block." },
+    { "decode_sequence", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(decode_sequence)),
+      METH_VARARGS | METH_KEYWORDS,
+      "decode_sequence(strands, ecc, length, engine='simd') -> (sequence, status, decoded)\n\n"
+      "Decode the output of encode_sequence(), trimming the sequence to length.\n"
+      "decoded is the number of blocks that decoded." },
+    { "encode_strands", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(encode_strands)),
+      METH_VARARGS | METH_KEYWORDS,
+      "encode_strands(sequence, engine='simd') -> (strands, status)\n\n"
+      "Encode a DNA sequence into in-band strands of STRAND_LENGTH bases, each\n"
+      "carrying STRAND_DATA_LENGTH bases of the sequence." },
+    { "decode_strands", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(decode_strands)),
+      METH_VARARGS | METH_KEYWORDS,
+      "decode_strands(strands, length, engine='simd') -> (sequence, status, decoded)\n\n"
+      "Decode the output of encode_strands(), trimming the sequence to length." },
+    { "decode_strands_oriented", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(decode_strands_oriented)),
+      METH_VARARGS | METH_KEYWORDS,
+      "decode_strands_oriented(reads, engine='simd') -> (sequence, status, orientation, decoded)\n\n"
+      "Decode reads of STRAND_LENGTH bases, each in either orientation.\n"
+      "orientation holds one ORIENTATION_* byte per read." },
+    { "decode_strands_unique", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(decode_strands_unique)),
+      METH_VARARGS | METH_KEYWORDS,
+      "decode_strands_unique(reads, engine='simd') -> (sequence, status, orientation, copies, decoded)\n\n"
+      "decode_strands_oriented() decoding each distinct read once, duplicates\n"
+      "reusing its result. copies holds one native uint32 per read, the number\n"
+      "of reads with the same bases, eg: numpy.frombuffer(copies, numpy.uint32)." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyModuleDef module_definition = {
+    PyModuleDef_HEAD_INIT,
+    "schifra_dna",
+    "Reed-Solomon RS(15, 11) codec for DNA storage, see schifra/dna_storage.hpp",
+    -1,
+    module_methods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+bool add_constant(PyObject* module, const char* name, std::size_t value) {
+    return PyModule_AddIntConstant(module, name, static_cast<long>(value)) == 0;
+}
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_schifra_dna(void) {
+    PyObject* module = PyModule_Create(&module_definition);
+    if (!module) return nullptr;
+
+    typedef codec_type::block_status status;
+    typedef codec_type::strand_orientation orientation;
+
+    if (!add_constant(module, "CODE_LENGTH", 15) ||
+        !add_constant(module, "FEC_LENGTH", 4) ||
+        !add_constant(module, "DATA_LENGTH", 11) ||
+        !add_constant(module, "STRAND_LENGTH", codec_type::strand_length()) ||
+        !add_constant(module, "STRAND_DATA_LENGTH", codec_type::strand_data_length()) ||
+        !add_constant(module, "STATUS_OK", static_cast<std::size_t>(status::ok)) ||
+        !add_constant(module, "STATUS_CORRECTED", static_cast<std::size_t>(status::corrected)) ||
+        !add_constant(module, "STATUS_UNCORRECTABLE", static_cast<std::size_t>(status::uncorrectable)) ||
+        !add_constant(module, "STATUS_INVALID", static_cast<std::size_t>(status::invalid)) ||
+        !add_constant(module, "ORIENTATION_FORWARD", static_cast<std::size_t>(orientation::forward)) ||
+        !add_constant(module, "ORIENTATION_REVERSE", static_cast<std::size_t>(orientation::reverse)) ||
+        !add_constant(module, "ORIENTATION_UNKNOWN", static_cast<std::size_t>(orientation::unknown))) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+
+    return module;
+}
@@ -24,7 +24,12 @@
 #define INCLUDE_SCHIFRA_ERASURE_CHANNEL_HPP
 
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
 #include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_codec_executor.hpp"
 #include "schifra_reed_solomon_encoder.hpp"
 #include "schifra_reed_solomon_decoder.hpp"
 #include "schifra_reed_solomon_interleaving.hpp"
@@ -76,6 +81,101 @@ namespace schifra
          return true;
       }
 
+      namespace details
+      {
+         /*
+            Interleave the stacks selected (all of them when selected is
+            null) as one batch of the executor: a stack is interleaved by
+            the worker whose range holds its first row.
+         */
+         template <std::size_t code_length, std::size_t fec_length>
+         inline void interleave_stacks(codec_executor<code_length,fec_length>& executor,
+                                       block<code_length,fec_length> (*stacks)[code_length],
+                                       const std::size_t stack_count,
+                                       const char* selected = 0)
+         {
+            typedef typename codec_executor<code_length,fec_length>::context context_type;
+
+            executor.submit_range(stack_count * code_length,
+                                  [stacks, selected](const context_type&, const std::size_t begin, const std::size_t end) -> std::size_t
+                                  {
+                                     std::size_t interleaved = 0;
+
+                                     for (std::size_t s = (begin + code_length - 1) / code_length; (s * code_length) < end; ++s)
+                                     {
+                                        if (selected && !selected[s])
+                                           continue;
+
+                                        interleave<code_length,fec_length>(stacks[s]);
+                                        ++interleaved;
+                                     }
+
+                                     return interleaved;
+                                  }).get();
+         }
+
+      } // namespace details
+
+      /*
+         erasure_channel_stack_encode() of stack_count stacks at once: the
+         rows of every stack are encoded as one batch of the executor,
+         with its encoder, then each stack is interleaved. The rows of a
+         stack are split across workers when the executor's grain is
+         below code_length, and separate stacks always run concurrently.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      inline bool erasure_channel_stack_encode(codec_executor<code_length,fec_length>& executor,
+                                               block<code_length,fec_length> (*stacks)[code_length],
+                                               const std::size_t stack_count)
+      {
+         typedef typename codec_executor<code_length,fec_length>::context context_type;
+
+         const std::size_t rows = stack_count * code_length;
+
+         const std::size_t encoded = executor.submit_range(rows,
+                                        [stacks](const context_type& ctx, const std::size_t begin, const std::size_t end) -> std::size_t
+                                        {
+                                           std::size_t count = 0;
+
+                                           for (std::size_t r = begin; r < end; ++r)
+                                           {
+                                              if (ctx.encoder.encode(stacks[r / code_length][r % code_length]))
+                                                 ++count;
+                                           }
+
+                                           return count;
+                                        }).get();
+
+         if (encoded != rows)
+         {
+            std::cout << "erasure_channel_stack_encode() - Error: Failed to encode " << (rows - encoded) << " block(s)" << std::endl;
+
+            return false;
+         }
+
+         details::interleave_stacks<code_length,fec_length>(executor, stacks, stack_count);
+
+         return true;
+      }
+
+      template <std::size_t code_length, std::size_t fec_length>
+      inline bool erasure_channel_stack_encode(codec_executor<code_length,fec_length>& executor,
+                                               block<code_length,fec_length> (&output)[code_length])
+      {
+         return erasure_channel_stack_encode<code_length,fec_length>(executor, &output, 1);
+      }
+
+      /*
+         With exactly fec_length erasures and no errors, the value added to
+         each erased symbol is a fixed linear function of its codeword, as
+         both the syndromes and omega = gamma.S mod x^fec_length are linear
+         in the received symbols. That function depends only on the erasure
+         pattern, so it is folded into a code_length wide row of multipliers
+         per erased data symbol and kept in a small LRU cache keyed by the
+         (sorted) pattern. A stack whose pattern is cached is then recovered
+         with one matrix-vector product per codeword, skipping gamma, the
+         Chien search and the Forney evaluations altogether.
+      */
       template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
       class erasure_code_decoder : public decoder<code_length,fec_length,data_length>
       {
@@ -84,16 +184,16 @@ namespace schifra
          typedef decoder<code_length,fec_length,data_length> decoder_type;
          typedef typename decoder_type::block_type block_type;
          typedef std::vector<galois::field_polynomial> polynomial_list_type;
+         typedef typename decoder_type::locator_polynomial locator_polynomial;
 
          erasure_code_decoder(const galois::field& gfield,
-                              const unsigned int& gen_initial_index)
-         : decoder<code_length,fec_length,data_length>(gfield, gen_initial_index)
+                              const unsigned int& gen_initial_index,
+                              const std::size_t pattern_cache_size = 8)
+         : decoder<code_length,fec_length,data_length>(gfield, gen_initial_index),
+           pattern_cache_size_((0 == pattern_cache_size) ? 1 : pattern_cache_size),
+           pattern_clock_(0)
          {
-            for (std::size_t i = 0; i < code_length; ++i)
-            {
-               received_.push_back(galois::field_polynomial(decoder_type::field_, code_length - 1));
-               syndrome_.push_back(galois::field_polynomial(decoder_type::field_));
-            }
+            pattern_cache_.reserve(pattern_cache_size_);
          };
 
          bool decode(block_type rsblock[code_length], const erasure_locations_t& erasure_list) const
@@ -106,16 +206,190 @@ namespace schifra
                return false;
             }
 
-            for (std::size_t i = 0; i < code_length; ++i)
+            const erasure_pattern& pattern = lookup_pattern(erasure_list);
+
+            for (std::size_t j = 0; j < code_length; ++j)
             {
-               decoder_type::load_message    (received_[i], rsblock  [i]);
-               decoder_type::compute_syndrome(received_[i], syndrome_[i]);
+               correct(pattern, rsblock[j]);
             }
 
+            return pattern.valid;
+         }
+
+         /*
+            Decode stack_count interleaved stacks, stack s with the erased
+            rows erasure_lists[s], as one batch of the executor. Patterns
+            (gamma, its roots and the Forney weights) are built once per
+            distinct list on the calling thread, as the cache is not shared
+            safely, and copied so the workers only read them; the workers
+            then correct the codewords. Stacks with fewer than fec_length
+            erasures are decoded codeword by codeword by the decoder, and
+            stacks with none are left as they are.
+
+            Note: Those codewords are decoded with decode_erasures(), rows
+                  being lost whole, and a codeword with an error beyond the
+                  erased rows is reported rather than miscorrected.
+         */
+         bool decode(codec_executor<code_length,fec_length,data_length>& executor,
+                     block_type (*stacks)[code_length],
+                     const erasure_locations_t* erasure_lists,
+                     const std::size_t stack_count) const
+         {
+            typedef typename codec_executor<code_length,fec_length,data_length>::context context_type;
+
+            if (!decoder_type::decoder_valid_)
+               return false;
+
+            const std::size_t no_pattern = static_cast<std::size_t>(-1);
+
+            std::vector<erasure_pattern> patterns;
+            std::vector<std::size_t>     stack_pattern(stack_count, no_pattern);
+
+            for (std::size_t s = 0; s < stack_count; ++s)
+            {
+               if (erasure_lists[s].size() != fec_length)
+                  continue;
+
+               erasure_locations_t key = erasure_lists[s];
+               std::sort(key.begin(), key.end());
+
+               for (std::size_t p = 0; p < patterns.size(); ++p)
+               {
+                  if (patterns[p].erasures == key)
+                  {
+                     stack_pattern[s] = p;
+                     break;
+                  }
+               }
+
+               if (no_pattern == stack_pattern[s])
+               {
+                  stack_pattern[s] = patterns.size();
+                  patterns.push_back(lookup_pattern(key));
+               }
+            }
+
+            const std::size_t rows = stack_count * code_length;
+
+            const std::size_t decoded = executor.submit_range(rows,
+                                           [&](const context_type&, const std::size_t begin, const std::size_t end) -> std::size_t
+                                           {
+                                              std::size_t count = 0;
+
+                                              for (std::size_t r = begin; r < end; ++r)
+                                              {
+                                                 const std::size_t s = r / code_length;
+
+                                                 block_type& codeword = stacks[s][r % code_length];
+
+                                                 if (erasure_lists[s].empty())
+                                                    ++count;
+                                                 else if (no_pattern != stack_pattern[s])
+                                                 {
+                                                    const erasure_pattern& pattern = patterns[stack_pattern[s]];
+
+                                                    correct(pattern, codeword);
+
+                                                    if (pattern.valid)
+                                                       ++count;
+                                                 }
+                                                 else if (decoder_type::decode_erasures(codeword, erasure_lists[s]))
+                                                    ++count;
+                                              }
+
+                                              return count;
+                                           }).get();
+
+            return (decoded == rows);
+         }
+
+      private:
+
+         struct erasure_pattern
+         {
+            erasure_locations_t               erasures;
+            std::vector<std::size_t>          position;
+            std::vector<galois::field_symbol> multiplier;
+            unsigned long long                last_used;
+            bool                              valid;
+         };
+
+         /* Apply the corrections of a pattern to one codeword */
+         inline void correct(const erasure_pattern& pattern, block_type& codeword) const
+         {
+            const std::size_t           corrections = pattern.position.size();
+            const galois::field_symbol* multiplier  = pattern.multiplier.data();
+
+            /*
+               All of the corrections are computed before any of them is
+               applied, as each one reads the erased symbols as received.
+            */
+            galois::field_symbol correction[fec_length];
+
+            for (std::size_t k = 0; k < corrections; ++k)
+            {
+               const galois::field_symbol* row = multiplier + (k * code_length);
+               galois::field_symbol        sum = 0;
+
+               for (std::size_t i = 0; i < code_length; ++i)
+               {
+                  sum ^= decoder_type::field_.mul(row[i], codeword[i]);
+               }
+
+               correction[k] = sum;
+            }
+
+            for (std::size_t k = 0; k < corrections; ++k)
+            {
+               codeword[pattern.position[k]] ^= correction[k];
+            }
+         }
+
+         const erasure_pattern& lookup_pattern(const erasure_locations_t& erasure_list) const
+         {
+            erasure_locations_t key = erasure_list;
+            std::sort(key.begin(), key.end());
+
+            std::size_t victim = 0;
+
+            for (std::size_t i = 0; i < pattern_cache_.size(); ++i)
+            {
+               if (pattern_cache_[i].erasures == key)
+               {
+                  pattern_cache_[i].last_used = ++pattern_clock_;
+                  return pattern_cache_[i];
+               }
+               else if (pattern_cache_[i].last_used < pattern_cache_[victim].last_used)
+                  victim = i;
+            }
+
+            if (pattern_cache_.size() < pattern_cache_size_)
+            {
+               victim = pattern_cache_.size();
+               pattern_cache_.push_back(erasure_pattern());
+            }
+
+            erasure_pattern& pattern = pattern_cache_[victim];
+
+            create_pattern(key, pattern);
+            pattern.last_used = ++pattern_clock_;
+
+            return pattern;
+         }
+
+         void create_pattern(const erasure_locations_t& key, erasure_pattern& pattern) const
+         {
+            const galois::field& field = decoder_type::field_;
+
+            pattern.erasures = key;
+            pattern.position.clear();
+            pattern.multiplier.clear();
+            pattern.valid = true;
+
             erasure_locations_t erasure_locations;
-            decoder_type::prepare_erasure_list(erasure_locations,erasure_list);
+            decoder_type::prepare_erasure_list(erasure_locations,key);
 
-            galois::field_polynomial gamma(galois::field_element(decoder_type::field_, 1));
+            locator_polynomial gamma(field, galois::field_symbol(1));
 
             decoder_type::compute_gamma(gamma,erasure_locations);
 
@@ -123,44 +397,71 @@ namespace schifra
 
             find_roots_in_data(gamma,gamma_roots);
 
-            polynomial_list_type omega;
+            locator_polynomial gamma_derivative(field);
+
+            gamma.derivative_into(gamma_derivative);
+
+            galois::field_symbol gamma_term[fec_length];
 
-            for (std::size_t i = 0; i < code_length; ++i)
+            for (std::size_t t = 0; t < fec_length; ++t)
             {
-               omega.push_back((gamma * syndrome_[i]) % fec_length);
+               gamma_term[t] = (static_cast<int>(t) <= gamma.deg()) ? gamma[t] : 0;
             }
 
-            galois::field_polynomial gamma_derivative = gamma.derivative();
-
-            for (std::size_t i = 0; i < gamma_roots.size(); ++i)
+            for (std::size_t k = 0; k < gamma_roots.size(); ++k)
             {
-               int error_location                  = static_cast<int>(gamma_roots[i]);
-               galois::field_symbol  alpha_inverse = decoder_type::field_.alpha(error_location);
-               galois::field_element denominator   = gamma_derivative(alpha_inverse);
+               const int                  error_location = gamma_roots[k];
+               const galois::field_symbol alpha_inverse  = field.alpha(error_location);
+               const galois::field_symbol denominator    = gamma_derivative(alpha_inverse);
+
+               if (0 == denominator)
+               {
+                  pattern.valid = false;
+                  break;
+               }
 
-               if (denominator == 0)
+               /*
+                  omega(a) = sum_j S_j . sum_{t=j..fec_length-1} gamma_(t-j) . a^t,
+                  scaled by the Forney factor gives the weight of syndrome j.
+               */
+               const galois::field_symbol scale = field.div(decoder_type::root_exponent_table_[error_location], denominator);
+
+               galois::field_symbol syndrome_weight[fec_length];
+
+               for (std::size_t j = 0; j < fec_length; ++j)
                {
-                  return false;
+                  galois::field_symbol sum = 0;
+
+                  for (std::size_t t = j; t < fec_length; ++t)
+                  {
+                     sum ^= field.mul(gamma_term[t - j], field.exp(alpha_inverse, static_cast<int>(t)));
+                  }
+
+                  syndrome_weight[j] = field.mul(sum, scale);
                }
 
-               for (std::size_t j = 0; j < code_length; ++j)
+               /*
+                  Symbol i of a block adds itself times b_j^(code_length - 1 - i)
+                  to syndrome j, where b_j is the j-th generator root.
+               */
+               for (std::size_t i = 0; i < code_length; ++i)
                {
-                  galois::field_element numerator = (omega[j](alpha_inverse) * decoder_type::root_exponent_table_[error_location]);
-                  /*
-                    A minor optimization can be made in the event the
-                    numerator is equal to zero by not executing the
-                    following line.
-                  */
-                  rsblock[j][error_location - 1] ^= decoder_type::field_.div(numerator.poly(),denominator.poly());
+                  galois::field_symbol weight = 0;
+
+                  for (std::size_t j = 0; j < fec_length; ++j)
+                  {
+                     const galois::field_symbol root = decoder_type::syndrome_exponent_table_[j];
+                     weight ^= field.mul(syndrome_weight[j], field.exp(root, static_cast<int>(code_length - 1 - i)));
+                  }
+
+                  pattern.multiplier.push_back(weight);
                }
-            }
 
-            return true;
+               pattern.position.push_back(static_cast<std::size_t>(error_location - 1));
+            }
          }
 
-      private:
-
-         void find_roots_in_data(const galois::field_polynomial& poly, std::vector<int>& root_list) const
+         void find_roots_in_data(const locator_polynomial& poly, std::vector<int>& root_list) const
          {
             /*
                Chien Search, as described in parent, but only
@@ -174,7 +475,7 @@ namespace schifra
 
             for (int i = 1; i <= static_cast<int>(data_length); ++i)
             {
-               if (0 == poly(decoder_type::field_.alpha(i)).poly())
+               if (0 == poly(decoder_type::field_.alpha(i)))
                {
                   root_list.push_back(i);
                   root_list_size++;
@@ -187,8 +488,9 @@ namespace schifra
             }
          }
 
-         mutable polynomial_list_type received_;
-         mutable polynomial_list_type syndrome_;
+         const std::size_t                     pattern_cache_size_;
+         mutable std::vector<erasure_pattern>  pattern_cache_;
+         mutable unsigned long long            pattern_clock_;
 
       };
 
@@ -206,7 +508,7 @@ namespace schifra
 
          for (std::size_t i = 0; i < code_length; ++i)
          {
-            if (!general_decoder.decode(output[i],missing_row_index))
+            if (!general_decoder.decode_erasures(output[i],missing_row_index))
             {
                std::cout << "[2] erasure_channel_stack_decode() - Error: Failed to decode block[" << i <<"]" << std::endl;
 
@@ -248,6 +550,48 @@ namespace schifra
                       output);
       }
 
+      /*
+         erasure_channel_stack_decode() of stack_count stacks at once, the
+         same rules applying to each: stack s is missing the rows
+         missing_row_index[s]. The stacks with missing rows are
+         deinterleaved and their codewords corrected across the executor,
+         see erasure_code_decoder::decode().
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      inline bool erasure_channel_stack_decode(const erasure_code_decoder<code_length,fec_length>& erasure_decoder,
+                                               codec_executor<code_length,fec_length>& executor,
+                                               const erasure_locations_t* missing_row_index,
+                                                     block<code_length,fec_length> (*stacks)[code_length],
+                                               const std::size_t stack_count)
+      {
+         std::vector<char> selected(stack_count, 0);
+
+         for (std::size_t s = 0; s < stack_count; ++s)
+         {
+            selected[s] = missing_row_index[s].empty() ? 0 : 1;
+         }
+
+         details::interleave_stacks<code_length,fec_length>(executor, stacks, stack_count, selected.data());
+
+         if (!erasure_decoder.decode(executor, stacks, missing_row_index, stack_count))
+         {
+            std::cout << "erasure_channel_stack_decode() - Error: Failed to decode " << stack_count << " stack(s)" << std::endl;
+
+            return false;
+         }
+
+         return true;
+      }
+
+      template <std::size_t code_length, std::size_t fec_length>
+      inline bool erasure_channel_stack_decode(const erasure_code_decoder<code_length,fec_length>& erasure_decoder,
+                                               codec_executor<code_length,fec_length>& executor,
+                                               const erasure_locations_t& missing_row_index,
+                                                     block<code_length,fec_length> (&output)[code_length])
+      {
+         return erasure_channel_stack_decode<code_length,fec_length>(erasure_decoder, executor, &missing_row_index, &output, 1);
+      }
+
    } // namespace reed_solomon
 
 } // namepsace schifra
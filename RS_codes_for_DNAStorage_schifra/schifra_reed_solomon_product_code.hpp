@@ -24,9 +24,15 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_PRODUCT_CODE_HPP
 
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstddef>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "schifra_reed_solomon_block.hpp"
 #include "schifra_reed_solomon_encoder.hpp"
@@ -34,6 +40,7 @@
 #include "schifra_reed_solomon_interleaving.hpp"
 #include "schifra_reed_solomon_bitio.hpp"
 #include "schifra_ecc_traits.hpp"
+#include "schifra_span.hpp"
 
 
 namespace schifra
@@ -41,6 +48,146 @@ namespace schifra
 
    namespace reed_solomon
    {
+
+      namespace details
+      {
+
+         /*
+            Persistent workers for the passes of a product code decoder.
+            run() splits [0,count) into one slice per thread, the caller
+            taking the first, and only returns once every slice is done,
+            which is the barrier between a row and a column pass.
+         */
+         class product_pass_pool
+         {
+         public:
+
+            typedef std::function<void(std::size_t,std::size_t)> task_type;
+
+            explicit product_pass_pool(const std::size_t threads)
+            : task_(0),
+              count_(0),
+              pending_(0),
+              generation_(0),
+              stop_(false)
+            {
+               const std::size_t thread_count = (threads > 0) ? threads : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+               for (std::size_t w = 1; w < thread_count; ++w)
+               {
+                  workers_.push_back(std::thread([this, w]() { work(w); }));
+               }
+            }
+
+           ~product_pass_pool()
+            {
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  stop_ = true;
+               }
+
+               start_.notify_all();
+
+               for (std::size_t w = 0; w < workers_.size(); ++w)
+               {
+                  workers_[w].join();
+               }
+            }
+
+            inline std::size_t threads() const
+            {
+               return workers_.size() + 1;
+            }
+
+            void run(const std::size_t count, const task_type& task)
+            {
+               if (workers_.empty())
+               {
+                  task(0, count);
+                  return;
+               }
+
+               {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  task_    = &task;
+                  count_   = count;
+                  pending_ = workers_.size();
+                  ++generation_;
+               }
+
+               start_.notify_all();
+
+               run_slice(task, count, 0);
+
+               std::unique_lock<std::mutex> lock(mutex_);
+
+               done_.wait(lock, [this]() { return 0 == pending_; });
+
+               task_ = 0;
+            }
+
+         private:
+
+            product_pass_pool(const product_pass_pool&);
+            product_pass_pool& operator=(const product_pass_pool&);
+
+            inline void run_slice(const task_type& task, const std::size_t count, const std::size_t slice) const
+            {
+               const std::size_t begin = (count * (slice    )) / threads();
+               const std::size_t end   = (count * (slice + 1)) / threads();
+
+               if (begin < end)
+               {
+                  task(begin, end);
+               }
+            }
+
+            void work(const std::size_t slice)
+            {
+               std::size_t generation = 0;
+
+               for ( ; ; )
+               {
+                  const task_type* task  = 0;
+                  std::size_t      count = 0;
+
+                  {
+                     std::unique_lock<std::mutex> lock(mutex_);
+
+                     start_.wait(lock, [&]() { return stop_ || (generation != generation_); });
+
+                     if (stop_)
+                        return;
+
+                     generation = generation_;
+                     task       = task_;
+                     count      = count_;
+                  }
+
+                  run_slice(*task, count, slice);
+
+                  {
+                     std::lock_guard<std::mutex> lock(mutex_);
+
+                     if (0 == --pending_)
+                        done_.notify_one();
+                  }
+               }
+            }
+
+            std::vector<std::thread> workers_;
+            std::mutex               mutex_;
+            std::condition_variable  start_;
+            std::condition_variable  done_;
+            const task_type*         task_;
+            std::size_t              count_;
+            std::size_t              pending_;
+            std::size_t              generation_;
+            bool                     stop_;
+         };
+
+      } // namespace details
+
       template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
       class square_product_code_encoder
       {
@@ -89,7 +236,7 @@ namespace schifra
 
                for (std::size_t fec_index = 0; fec_index < fec_length; ++fec_index)
                {
-                  block_stack_[data_length + fec_index].fec(fec_index) = vertical_block.fec(fec_index);
+                  block_stack_[data_length + fec_index][col] = vertical_block.fec(fec_index);
                }
             }
 
@@ -133,6 +280,22 @@ namespace schifra
          const encoder_type& encoder_;
       };
 
+      /*
+         Every row, then if any row failed every column, is decoded. The
+         codewords of a pass are independent, so each pass is split over
+         threads threads (0 for one per hardware thread, 1 decodes on the
+         calling thread only), each slice going through decode_batch(),
+         and a pass only starts once the previous one has finished.
+
+         iterative_decode() instead alternates row and column passes until
+         a pass corrects nothing or max_iterations passes of each have
+         run. Only
+         the rows (columns) in which the previous pass corrected a symbol
+         are decoded again, tracked in dirty bitmaps, and the rows that
+         failed are given to the column pass as erasures (and the failed
+         columns to the row pass), as long as there are at most
+         fec_length of them.
+      */
       template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
       class square_product_code_decoder
       {
@@ -147,8 +310,15 @@ namespace schifra
          enum { data_size  = data_length * data_length };
          enum { total_size = code_length * code_length };
 
-         square_product_code_decoder(const decoder_type& decoder)
-         : decoder_(decoder)
+         typedef erasure_mask<code_length> bitmap_type;
+
+         static constexpr std::size_t default_max_iterations = 8;
+
+         square_product_code_decoder(const decoder_type& decoder, const std::size_t threads = 1)
+         : decoder_(decoder),
+           pool_(threads),
+           iterations_(0),
+           decodes_(0)
          {}
 
          void decode(data_ptr_type data)
@@ -164,6 +334,35 @@ namespace schifra
             decode_proxy();
          }
 
+         /*
+            Returns true when the last pass left every codeword it decoded
+            correctable, ie: the array is consistent along that dimension.
+         */
+         bool iterative_decode(data_ptr_type data, const std::size_t max_iterations = default_max_iterations)
+         {
+            copy_proxy(data);
+            return iterative_decode_proxy(max_iterations);
+         }
+
+         bool deinterleave_and_iterative_decode(data_ptr_type data, const std::size_t max_iterations = default_max_iterations)
+         {
+            copy_proxy(data);
+            interleave<code_length,fec_length>(block_stack_);
+            return iterative_decode_proxy(max_iterations);
+         }
+
+         /* Row and column passes run by the last iterative_decode() */
+         inline std::size_t iterations() const
+         {
+            return iterations_;
+         }
+
+         /* Codewords decoded by the last iterative_decode() */
+         inline std::size_t decodes() const
+         {
+            return decodes_;
+         }
+
          void output(data_ptr_type output_data)
          {
             for (std::size_t row = 0; row < data_length; ++row, output_data += data_length)
@@ -197,13 +396,19 @@ namespace schifra
          {
             bool first_iteration_failure = false;
 
-            for (std::size_t row = 0; row < data_length; ++row)
-            {
-               if (!decoder_.decode(block_stack_[row]))
-               {
-                  first_iteration_failure = true;
-               }
-            }
+            std::mutex failure_mutex;
+
+            pool_.run(code_length,
+                      [&](const std::size_t begin, const std::size_t end)
+                      {
+                         const std::size_t count = end - begin;
+
+                         if (decoder_.decode_batch(&block_stack_[begin], count) != count)
+                         {
+                            std::lock_guard<std::mutex> lock(failure_mutex);
+                            first_iteration_failure = true;
+                         }
+                      });
 
             if (!first_iteration_failure)
             {
@@ -214,21 +419,561 @@ namespace schifra
                return;
             }
 
-            block_type vertical_block;
+            /*
+               Note: Columns are gathered from, decoded and scattered back
+                     into the rows by the thread that owns them, the slices
+                     of a pass never share a column.
+            */
+            pool_.run(code_length,
+                      [&](const std::size_t begin, const std::size_t end)
+                      {
+                         for (std::size_t col = begin; col < end; ++col)
+                         {
+                            for (std::size_t row = 0; row < code_length; ++row)
+                            {
+                               column_stack_[col][row] = block_stack_[row][col];
+                            }
+                         }
+
+                         decoder_.decode_batch(&column_stack_[begin], end - begin);
+
+                         for (std::size_t col = begin; col < end; ++col)
+                         {
+                            if (column_stack_[col].unrecoverable)
+                               continue;
+
+                            for (std::size_t row = 0; row < code_length; ++row)
+                            {
+                               block_stack_[row][col] = column_stack_[col][row];
+                            }
+                         }
+                      });
+         }
 
-            for (std::size_t col = 0; col < code_length; ++col)
+         bool iterative_decode_proxy(const std::size_t max_iterations)
+         {
+            bitmap_type row_dirty;
+            bitmap_type col_dirty;
+            bitmap_type row_failed;
+            bitmap_type col_failed;
+
+            for (std::size_t i = 0; i < code_length; ++i)
             {
-               for (std::size_t row = 0; row < data_length; ++row)
+               row_dirty.set(i);
+               col_dirty.set(i);
+            }
+
+            iterations_ = 0;
+            decodes_    = 0;
+
+            bool consistent = false;
+
+            while ((iterations_ < max_iterations) && !row_dirty.empty())
+            {
+               ++iterations_;
+
+               /* Note: Codewords whose erasures change are retried, even if none of their symbols did */
+               if (iterative_pass(true, row_dirty, col_failed, row_failed, col_dirty))
                {
-                  vertical_block[row] = block_stack_[row][col];
+                  col_failed.for_each([&](const std::size_t col) { col_dirty.set(col); });
                }
 
-               decoder_.decode(vertical_block);
+               row_dirty.clear();
+
+               consistent = row_failed.empty();
+
+               /* Note: Columns touched by row corrections are checked too, a row can be miscorrected */
+               if (col_dirty.empty())
+                  break;
+
+               if (iterative_pass(false, col_dirty, row_failed, col_failed, row_dirty))
+               {
+                  row_failed.for_each([&](const std::size_t row) { row_dirty.set(row); });
+               }
+
+               col_dirty.clear();
+
+               consistent = col_failed.empty();
             }
+
+            return consistent;
+         }
+
+         /*
+            Decode the rows (or columns) set in dirty, with the positions in
+            erasures erased. The indices that fail are set in failed, those
+            that succeed reset, and the positions corrected are set in
+            other_dirty. Returns true when failed changed.
+         */
+         bool iterative_pass(const bool rows,
+                             const bitmap_type& dirty,
+                             const bitmap_type& erasures,
+                             bitmap_type& failed,
+                             bitmap_type& other_dirty)
+         {
+            dirty_list_.clear();
+            dirty.for_each([&](const std::size_t index) { dirty_list_.push_back(index); });
+
+            const bitmap_type erased = (erasures.size() <= fec_length) ? erasures : bitmap_type();
+
+            pool_.run(dirty_list_.size(),
+                      [&](const std::size_t begin, const std::size_t end)
+                      {
+                         for (std::size_t slot = begin; slot < end; ++slot)
+                         {
+                            const std::size_t index    = dirty_list_[slot];
+                            block_type&       codeword = column_stack_[slot];
+
+                            for (std::size_t i = 0; i < code_length; ++i)
+                            {
+                               codeword[i] = rows ? block_stack_[index][i] : block_stack_[i][index];
+                            }
+
+                            changed_[slot].clear();
+                            slot_failed_[slot] = !decoder_.decode(codeword, erased);
+
+                            if (slot_failed_[slot])
+                               continue;
+
+                            for (std::size_t i = 0; i < code_length; ++i)
+                            {
+                               typename block_type::symbol_type& symbol = rows ? block_stack_[index][i] : block_stack_[i][index];
+
+                               if (symbol != codeword[i])
+                               {
+                                  symbol = codeword[i];
+                                  changed_[slot].set(i);
+                               }
+                            }
+                         }
+                      });
+
+            bool failures_changed = false;
+
+            for (std::size_t slot = 0; slot < dirty_list_.size(); ++slot)
+            {
+               const std::size_t index = dirty_list_[slot];
+
+               if (failed.test(index) != slot_failed_[slot])
+               {
+                  failures_changed = true;
+
+                  if (slot_failed_[slot])
+                     failed.set(index);
+                  else
+                     failed.reset(index);
+               }
+
+               changed_[slot].for_each([&](const std::size_t position) { other_dirty.set(position); });
+            }
+
+            decodes_ += dirty_list_.size();
+
+            return failures_changed;
          }
 
          block_type block_stack_[code_length];
+         block_type column_stack_[code_length];
+         bitmap_type changed_[code_length];
+         bool slot_failed_[code_length];
+         std::vector<std::size_t> dirty_list_;
          const decoder_type& decoder_;
+         details::product_pass_pool pool_;
+         std::size_t iterations_;
+         std::size_t decodes_;
+      };
+
+      /*
+         Rectangular product code of rows x columns data symbols, each of
+         the rows encoded with the row code and then each column of the
+         result with the column code. The two codes, and their fields,
+         are chosen independently, eg: a short inner code per oligo and a
+         long outer code across oligos, and the dimensions are set at run
+         time: a row of columns + row_fec_length symbols is a shortened
+         codeword of the row code, a column of rows + column_fec_length
+         symbols one of the column code.
+
+         Only the data rows are row codewords: with two fields the column
+         parity rows hold symbols the row code knows nothing of, so those
+         rows are protected by the column code alone.
+
+         The encoded array is held as block_stack holds its symbols, ie:
+         column-major, symbol (r,c) at data()[c * total_rows() + r], so
+         every column is a contiguous span that is encoded and decoded in
+         place, only rows being gathered.
+      */
+      template <std::size_t row_code_length,    std::size_t row_fec_length,
+                std::size_t column_code_length, std::size_t column_fec_length,
+                typename symbol_t = galois::field_symbol>
+      class product_code_encoder
+      {
+      public:
+
+         typedef encoder<row_code_length,row_fec_length>       row_encoder_type;
+         typedef encoder<column_code_length,column_fec_length> column_encoder_type;
+         typedef symbol_t symbol_type;
+
+         product_code_encoder(const row_encoder_type& row_encoder,
+                              const column_encoder_type& column_encoder,
+                              const std::size_t rows,
+                              const std::size_t columns)
+         : row_encoder_(row_encoder),
+           column_encoder_(column_encoder),
+           rows_(rows),
+           columns_(columns),
+           symbols_((rows + column_fec_length) * (columns + row_fec_length), symbol_type(0)),
+           row_(columns + row_fec_length)
+         {}
+
+         /* False when the dimensions do not fit the codes */
+         inline bool valid() const
+         {
+            return (rows_    > 0) && (rows_    <= (column_code_length - column_fec_length)) &&
+                   (columns_ > 0) && (columns_ <= (row_code_length    - row_fec_length   ));
+         }
+
+         inline std::size_t rows         () const { return rows_;                        }
+         inline std::size_t columns      () const { return columns_;                     }
+         inline std::size_t total_rows   () const { return rows_    + column_fec_length; }
+         inline std::size_t total_columns() const { return columns_ + row_fec_length;    }
+
+         /* data holds the rows x columns data symbols, row-major */
+         bool encode(const symbol_type* data)
+         {
+            if (!valid())
+               return false;
+
+            const std::size_t height = total_rows();
+
+            for (std::size_t r = 0; r < rows_; ++r, data += columns_)
+            {
+               if (
+                    !row_encoder_.encode(utils::span<const symbol_type>(data, columns_),
+                                         utils::span<symbol_type>(&row_[columns_], row_fec_length))
+                  )
+               {
+                  return false;
+               }
+
+               std::copy(data, data + columns_, row_.begin());
+
+               for (std::size_t c = 0; c < total_columns(); ++c)
+               {
+                  symbols_[c * height + r] = row_[c];
+               }
+            }
+
+            for (std::size_t c = 0; c < total_columns(); ++c)
+            {
+               symbol_type* column = &symbols_[c * height];
+
+               if (
+                    !column_encoder_.encode(utils::span<const symbol_type>(column, rows_),
+                                            utils::span<symbol_type>(column + rows_, column_fec_length))
+                  )
+               {
+                  return false;
+               }
+            }
+
+            return true;
+         }
+
+         inline const symbol_type* data() const
+         {
+            return symbols_.data();
+         }
+
+         inline symbol_type symbol(const std::size_t row, const std::size_t column) const
+         {
+            return symbols_[column * total_rows() + row];
+         }
+
+         /* The total_rows() x total_columns() encoded array, row-major */
+         void output(symbol_type* output_data) const
+         {
+            for (std::size_t r = 0; r < total_rows(); ++r)
+            {
+               for (std::size_t c = 0; c < total_columns(); ++c)
+               {
+                  *output_data++ = symbol(r, c);
+               }
+            }
+         }
+
+      private:
+
+         product_code_encoder(const product_code_encoder&);
+         product_code_encoder& operator=(const product_code_encoder&);
+
+         const row_encoder_type&    row_encoder_;
+         const column_encoder_type& column_encoder_;
+         const std::size_t          rows_;
+         const std::size_t          columns_;
+         std::vector<symbol_type>   symbols_;
+         std::vector<symbol_type>   row_;
+      };
+
+      /*
+         Iterative decoder of product_code_encoder arrays, decoding rows
+         and columns as square_product_code_decoder::iterative_decode()
+         does, over threads threads.
+      */
+      template <std::size_t row_code_length,    std::size_t row_fec_length,
+                std::size_t column_code_length, std::size_t column_fec_length,
+                typename symbol_t = galois::field_symbol>
+      class product_code_decoder
+      {
+      public:
+
+         typedef decoder<row_code_length,row_fec_length>       row_decoder_type;
+         typedef decoder<column_code_length,column_fec_length> column_decoder_type;
+         typedef symbol_t symbol_type;
+
+         static constexpr std::size_t default_max_iterations = 8;
+
+         product_code_decoder(const row_decoder_type& row_decoder,
+                              const column_decoder_type& column_decoder,
+                              const std::size_t rows,
+                              const std::size_t columns,
+                              const std::size_t threads = 1)
+         : row_decoder_(row_decoder),
+           column_decoder_(column_decoder),
+           rows_(rows),
+           columns_(columns),
+           symbols_((rows + column_fec_length) * (columns + row_fec_length), symbol_type(0)),
+           pool_(threads),
+           iterations_(0),
+           decodes_(0)
+         {}
+
+         inline bool valid() const
+         {
+            return (rows_    > 0) && (rows_    <= (column_code_length - column_fec_length)) &&
+                   (columns_ > 0) && (columns_ <= (row_code_length    - row_fec_length   ));
+         }
+
+         inline std::size_t rows         () const { return rows_;                        }
+         inline std::size_t columns      () const { return columns_;                     }
+         inline std::size_t total_rows   () const { return rows_    + column_fec_length; }
+         inline std::size_t total_columns() const { return columns_ + row_fec_length;    }
+
+         /*
+            input holds the total_rows() x total_columns() encoded array,
+            row-major. Returns true when the last pass left every codeword
+            it decoded correctable.
+         */
+         bool decode(const symbol_type* input, const std::size_t max_iterations = default_max_iterations)
+         {
+            if (!valid())
+               return false;
+
+            for (std::size_t r = 0; r < total_rows(); ++r)
+            {
+               for (std::size_t c = 0; c < total_columns(); ++c)
+               {
+                  symbols_[c * total_rows() + r] = *input++;
+               }
+            }
+
+            return decode_proxy(max_iterations);
+         }
+
+         /* The rows x columns data symbols, row-major */
+         void output(symbol_type* output_data) const
+         {
+            for (std::size_t r = 0; r < rows_; ++r)
+            {
+               for (std::size_t c = 0; c < columns_; ++c)
+               {
+                  *output_data++ = symbols_[c * total_rows() + r];
+               }
+            }
+         }
+
+         inline const symbol_type* data() const
+         {
+            return symbols_.data();
+         }
+
+         inline std::size_t iterations() const
+         {
+            return iterations_;
+         }
+
+         inline std::size_t decodes() const
+         {
+            return decodes_;
+         }
+
+      private:
+
+         product_code_decoder(const product_code_decoder&);
+         product_code_decoder& operator=(const product_code_decoder&);
+
+         typedef std::vector<unsigned char> bitmap_type;
+
+         bool decode_proxy(const std::size_t max_iterations)
+         {
+            bitmap_type row_dirty (total_rows   (), 1);
+            bitmap_type col_dirty (total_columns(), 1);
+            bitmap_type row_failed(total_rows   (), 0);
+            bitmap_type col_failed(total_columns(), 0);
+
+            iterations_ = 0;
+            decodes_    = 0;
+
+            bool consistent = false;
+
+            while ((iterations_ < max_iterations) && any(row_dirty))
+            {
+               ++iterations_;
+
+               if (pass(true, row_dirty, col_failed, row_failed, col_dirty))
+               {
+                  merge(col_dirty, col_failed);
+               }
+
+               std::fill(row_dirty.begin(), row_dirty.end(), 0);
+
+               consistent = !any(row_failed);
+
+               if (!any(col_dirty))
+                  break;
+
+               if (pass(false, col_dirty, row_failed, col_failed, row_dirty))
+               {
+                  merge(row_dirty, row_failed);
+               }
+
+               std::fill(col_dirty.begin(), col_dirty.end(), 0);
+
+               consistent = !any(col_failed);
+            }
+
+            return consistent;
+         }
+
+         static inline bool any(const bitmap_type& bitmap)
+         {
+            return std::find(bitmap.begin(), bitmap.end(), 1) != bitmap.end();
+         }
+
+         static inline void merge(bitmap_type& bitmap, const bitmap_type& other)
+         {
+            for (std::size_t i = 0; i < bitmap.size(); ++i)
+            {
+               bitmap[i] |= other[i];
+            }
+         }
+
+         inline symbol_type& at(const bool rows, const std::size_t index, const std::size_t position)
+         {
+            return rows ? symbols_[position * total_rows() + index] : symbols_[index * total_rows() + position];
+         }
+
+         /*
+            Decode the rows (or columns) set in dirty, with the positions
+            set in erasures erased when there are at most fec_length of
+            them. Failures are recorded in failed, corrected positions set
+            in other_dirty. Returns true when failed changed.
+         */
+         bool pass(const bool rows,
+                   const bitmap_type& dirty,
+                   const bitmap_type& erasures,
+                   bitmap_type& failed,
+                   bitmap_type& other_dirty)
+         {
+            const std::size_t length     = rows ? total_columns() : total_rows();
+            const std::size_t fec_length = rows ? row_fec_length  : column_fec_length;
+
+            erasure_locations_t erased;
+
+            for (std::size_t i = 0; i < erasures.size(); ++i)
+            {
+               if (erasures[i])
+                  erased.push_back(i);
+            }
+
+            if (erased.size() > fec_length)
+               erased.clear();
+
+            dirty_list_.clear();
+
+            /* Note: The column parity rows are not row codewords */
+            for (std::size_t i = 0; i < (rows ? rows_ : dirty.size()); ++i)
+            {
+               if (dirty[i])
+                  dirty_list_.push_back(i);
+            }
+
+            const std::size_t slots = dirty_list_.size();
+
+            codewords_.resize(slots * length);
+            slot_failed_.assign(slots, 0);
+
+            pool_.run(slots,
+                      [&](const std::size_t begin, const std::size_t end)
+                      {
+                         for (std::size_t slot = begin; slot < end; ++slot)
+                         {
+                            const std::size_t index    = dirty_list_[slot];
+                            symbol_type*      codeword = &codewords_[slot * length];
+
+                            for (std::size_t i = 0; i < length; ++i)
+                            {
+                               codeword[i] = at(rows, index, i);
+                            }
+
+                            const bool decoded = rows ? row_decoder_   .decode(utils::span<symbol_type>(codeword, length), erased) :
+                                                        column_decoder_.decode(utils::span<symbol_type>(codeword, length), erased) ;
+
+                            slot_failed_[slot] = decoded ? 0 : 1;
+                         }
+                      });
+
+            bool failures_changed = false;
+
+            for (std::size_t slot = 0; slot < slots; ++slot)
+            {
+               const std::size_t index = dirty_list_[slot];
+
+               failures_changed |= (failed[index] != slot_failed_[slot]);
+               failed[index]     = slot_failed_[slot];
+
+               if (slot_failed_[slot])
+                  continue;
+
+               const symbol_type* codeword = &codewords_[slot * length];
+
+               for (std::size_t i = 0; i < length; ++i)
+               {
+                  symbol_type& symbol = at(rows, index, i);
+
+                  if (symbol != codeword[i])
+                  {
+                     symbol         = codeword[i];
+                     other_dirty[i] = 1;
+                  }
+               }
+            }
+
+            decodes_ += slots;
+
+            return failures_changed;
+         }
+
+         const row_decoder_type&       row_decoder_;
+         const column_decoder_type&    column_decoder_;
+         const std::size_t             rows_;
+         const std::size_t             columns_;
+         std::vector<symbol_type>      symbols_;
+         std::vector<symbol_type>      codewords_;
+         std::vector<std::size_t>      dirty_list_;
+         std::vector<unsigned char>    slot_failed_;
+         details::product_pass_pool    pool_;
+         std::size_t                   iterations_;
+         std::size_t                   decodes_;
       };
 
    } // namespace reed_solomon
@@ -24,19 +24,26 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_SPPED_EVALUATOR_HPP
 
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include "schifra_galois_field.hpp"
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
 #include "schifra_sequential_root_generator_polynomial_creator.hpp"
 #include "schifra_reed_solomon_block.hpp"
 #include "schifra_reed_solomon_encoder.hpp"
 #include "schifra_reed_solomon_decoder.hpp"
+#include "schifra_reed_solomon_codec_executor.hpp"
 #include "schifra_reed_solomon_file_encoder.hpp"
 #include "schifra_reed_solomon_file_decoder.hpp"
 #include "schifra_error_processes.hpp"
+#include "schifra_perf_counters.hpp"
 #include "schifra_utilities.hpp"
 
 
@@ -205,9 +212,16 @@ namespace schifra
             std::size_t blocks_decoded       = 0;
             std::size_t block_failures       = 0;
 
+            /* Note: Hardware counters are collected when SCHIFRA_PERF_COUNTERS is set */
+            schifra::utils::perf_counters counters;
+            const bool collect_counters = schifra::utils::perf_counters::requested() && counters.available();
+
             schifra::utils::timer timer;
             timer.start();
 
+            if (collect_counters)
+               counters.start();
+
             for (std::size_t j = 0; j < max_iterations; ++j)
             {
                for (std::size_t i = 0; i < rs_block.size(); ++i)
@@ -227,6 +241,9 @@ namespace schifra
                }
             }
 
+            if (collect_counters)
+               counters.stop();
+
             timer.stop();
 
             double time = timer.time();
@@ -241,6 +258,12 @@ namespace schifra
                       mbps);
             else
                std::cout << "Blocks decoded: " << blocks_decoded << "\tDecode Failures: " << block_failures <<"\tTime: " << time <<"sec\tRate: " << mbps << "Mbps" << std::endl;
+
+            if (collect_counters)
+            {
+               std::cout << std::flush;
+               counters.totals().print(stdout, static_cast<double>(max_iterations * rs_block.size() * data_length));
+            }
          }
 
          void print_codec_properties()
@@ -316,9 +339,16 @@ namespace schifra
             std::size_t blocks_decoded       =   0;
             std::size_t block_failures       =   0;
 
+            /* Note: Hardware counters are collected when SCHIFRA_PERF_COUNTERS is set */
+            schifra::utils::perf_counters counters;
+            const bool collect_counters = schifra::utils::perf_counters::requested() && counters.available();
+
             schifra::utils::timer timer;
             timer.start();
 
+            if (collect_counters)
+               counters.start();
+
             for (std::size_t j = 0; j < max_iterations; ++j)
             {
                for (std::size_t i = 0; i < rs_block.size(); ++i)
@@ -338,6 +368,9 @@ namespace schifra
                }
             }
 
+            if (collect_counters)
+               counters.stop();
+
             timer.stop();
 
             double time = timer.time();
@@ -352,6 +385,12 @@ namespace schifra
                       mbps);
             else
                std::cout << "Blocks decoded: " << blocks_decoded << "\tDecode Failures: " << block_failures <<"\tTime: " << time <<"sec\tRate: " << mbps << "Mbps" << std::endl;
+
+            if (collect_counters)
+            {
+               std::cout << std::flush;
+               counters.totals().print(stdout, static_cast<double>(max_iterations * rs_block.size() * data_length));
+            }
          }
 
          void print_codec_properties()
@@ -404,6 +443,316 @@ namespace schifra
          all_erasures_decoder_speed_test<8,120,255,128>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
       }
 
+      /*
+         One cell of a sweep's throughput matrix: a code, under a load of
+         errors or erasures, decoded through a codec_executor of so many
+         threads with the region kernels bound to one backend.
+      */
+      struct sweep_result
+      {
+         std::size_t              code_length;
+         std::size_t              fec_length;
+         bool                     erasures;
+         std::size_t              load;
+         galois::region::backend_t backend;
+         std::size_t              threads;
+         double                   mbps;
+         std::size_t              failures;
+      };
+
+      /*
+         Loads, thread counts and backends of a sweep. Loads are fractions
+         of the code's capacity, fec_length / 2 errors or fec_length
+         erasures, rounded down but at least one symbol. Backends the cpu
+         lacks are skipped, an empty list meaning every supported one.
+      */
+      struct sweep_options
+      {
+         sweep_options()
+         : error_loads  (1, 1.0),
+           erasure_loads(1, 1.0),
+           thread_counts(1, 1),
+           min_time     (0.25)
+         {
+            error_loads.insert(error_loads.begin(), 0.5);
+            erasure_loads.insert(erasure_loads.begin(), 0.5);
+
+            const std::size_t hardware_threads = std::thread::hardware_concurrency();
+
+            for (std::size_t t = 2; t <= hardware_threads; t <<= 1)
+            {
+               thread_counts.push_back(t);
+            }
+         }
+
+         std::vector<double>                    error_loads;
+         std::vector<double>                    erasure_loads;
+         std::vector<std::size_t>               thread_counts;
+         std::vector<galois::region::backend_t> backends;
+         double                                 min_time;
+      };
+
+      namespace details
+      {
+         inline std::vector<galois::region::backend_t> sweep_backends(const sweep_options& options)
+         {
+            std::vector<galois::region::backend_t> backends;
+
+            if (options.backends.empty())
+            {
+               for (int b = galois::region::e_scalar; b <= galois::region::e_sve; ++b)
+               {
+                  if (galois::region::backend_supported(static_cast<galois::region::backend_t>(b)))
+                     backends.push_back(static_cast<galois::region::backend_t>(b));
+               }
+            }
+            else
+            {
+               for (std::size_t i = 0; i < options.backends.size(); ++i)
+               {
+                  if (galois::region::backend_supported(options.backends[i]))
+                     backends.push_back(options.backends[i]);
+               }
+            }
+
+            return backends;
+         }
+      }
+
+      /*
+         Decode throughput of RS(code_length,fec_length) over every load,
+         backend and thread count of options, appended to results. For
+         each load the create_messages() blocks are corrupted at every
+         start position, as the speed tests above do, and the whole set is
+         decoded as one executor batch, again and again, until min_time
+         seconds of decoding have been timed; restoring the corrupted set
+         between passes is not timed.
+      */
+      template <std::size_t field_descriptor,
+                std::size_t gen_poly_index,
+                std::size_t code_length,
+                std::size_t fec_length>
+      inline void sweep_configuration(const std::size_t prim_poly_size, const unsigned int prim_poly[],
+                                      const sweep_options& options,
+                                      std::vector<sweep_result>& results)
+      {
+         typedef block<code_length,fec_length> block_type;
+         typedef codec_executor<code_length,fec_length> executor_type;
+
+         const std::size_t data_length = code_length - fec_length;
+
+         galois::field field(field_descriptor,prim_poly_size,prim_poly);
+         galois::field_polynomial generator_polynomial(field);
+
+         if (
+              !make_sequential_root_generator_polynomial(field,
+                                                         gen_poly_index,
+                                                         fec_length,
+                                                         generator_polynomial)
+            )
+         {
+            return;
+         }
+
+         const encoder<code_length,fec_length> rs_encoder(field,generator_polynomial);
+
+         std::vector<block_type> original_block;
+
+         create_messages<code_length,fec_length>(rs_encoder,original_block);
+
+         const std::vector<galois::region::backend_t> backends = details::sweep_backends(options);
+
+         for (std::size_t l = 0; l < (options.error_loads.size() + options.erasure_loads.size()); ++l)
+         {
+            const bool        erasures = (l >= options.error_loads.size());
+            const double      fraction = erasures ? options.erasure_loads[l - options.error_loads.size()] : options.error_loads[l];
+            const std::size_t capacity = erasures ? fec_length : (fec_length >> 1);
+            const std::size_t load     = std::min(capacity, std::max<std::size_t>(1, static_cast<std::size_t>(fraction * capacity)));
+
+            if (0 == capacity)
+               continue;
+
+            std::vector<block_type>          corrupted;
+            std::vector<erasure_locations_t> erasure_list;
+            std::vector<std::size_t>         block_index_list;
+
+            for (std::size_t block_index = 0; block_index < original_block.size(); ++block_index)
+            {
+               for (std::size_t start_position = 0; start_position < code_length; ++start_position)
+               {
+                  block_type block = original_block[block_index];
+                  erasure_locations_t block_erasures;
+
+                  if (erasures)
+                     corrupt_message_all_erasures(block,block_erasures,load,start_position,1);
+                  else
+                     corrupt_message_all_errors(block,load,start_position,1);
+
+                  corrupted.push_back(block);
+                  erasure_list.push_back(block_erasures);
+                  block_index_list.push_back(block_index);
+               }
+            }
+
+            for (std::size_t b = 0; b < backends.size(); ++b)
+            {
+               galois::region::force_backend(backends[b]);
+
+               for (std::size_t t = 0; t < options.thread_counts.size(); ++t)
+               {
+                  executor_type executor(field, generator_polynomial, gen_poly_index, options.thread_counts[t]);
+
+                  executor.warm_up();
+
+                  std::vector<block_type> rs_block;
+                  std::size_t             passes   = 0;
+                  std::size_t             failures = 0;
+                  double                  time     = 0.0;
+
+                  while ((time < options.min_time) || (0 == passes))
+                  {
+                     rs_block = corrupted;
+
+                     block_type* const blocks = &rs_block[0];
+                     const erasure_locations_t* const erasure_lists = &erasure_list[0];
+
+                     schifra::utils::timer timer;
+                     timer.start();
+
+                     if (erasures)
+                        executor.submit_range(rs_block.size(),
+                                              [blocks, erasure_lists](const typename executor_type::context& ctx, const std::size_t begin, const std::size_t end)
+                                              {
+                                                 std::size_t decoded = 0;
+
+                                                 for (std::size_t i = begin; i < end; ++i)
+                                                 {
+                                                    if (ctx.decoder.decode(blocks[i], erasure_lists[i]))
+                                                       ++decoded;
+                                                 }
+
+                                                 return decoded;
+                                              }).get();
+                     else
+                        executor.decode(blocks, rs_block.size()).get();
+
+                     timer.stop();
+
+                     time += timer.time();
+                     ++passes;
+                  }
+
+                  for (std::size_t i = 0; i < rs_block.size(); ++i)
+                  {
+                     if (!are_blocks_equivelent(rs_block[i],original_block[block_index_list[i]]))
+                        ++failures;
+                  }
+
+                  const sweep_result result =
+                                     {
+                                       code_length, fec_length, erasures, load, backends[b], options.thread_counts[t],
+                                       ((passes * rs_block.size() * data_length) * 8.0) / (1048576.0 * time),
+                                       failures
+                                     };
+
+                  results.push_back(result);
+               }
+            }
+         }
+
+         galois::region::reset_backend();
+      }
+
+      /* sweep_configuration() of RS(code_length,fec_length) for every fec_length of the pack */
+      template <std::size_t field_descriptor,
+                std::size_t gen_poly_index,
+                std::size_t code_length,
+                std::size_t... fec_lengths>
+      inline std::vector<sweep_result> speed_sweep(const std::size_t prim_poly_size, const unsigned int prim_poly[],
+                                                   const sweep_options& options = sweep_options())
+      {
+         std::vector<sweep_result> results;
+
+         (sweep_configuration<field_descriptor,gen_poly_index,code_length,fec_lengths>(prim_poly_size,prim_poly,options,results), ...);
+
+         return results;
+      }
+
+      /*
+         The results of a sweep as a matrix, one row per code and load and
+         one column per backend and thread count, cells in Mbps, a cell
+         with wrong decodes marked with a '!'.
+      */
+      inline void print_sweep_matrix(const std::vector<sweep_result>& results, std::FILE* out = stdout)
+      {
+         std::vector<std::pair<galois::region::backend_t,std::size_t> > columns;
+
+         for (std::size_t i = 0; i < results.size(); ++i)
+         {
+            const std::pair<galois::region::backend_t,std::size_t> column(results[i].backend, results[i].threads);
+
+            if (std::find(columns.begin(), columns.end(), column) == columns.end())
+               columns.push_back(column);
+         }
+
+         std::fprintf(out, "%-26s", "Codec / Load");
+
+         for (std::size_t c = 0; c < columns.size(); ++c)
+         {
+            std::fprintf(out, " %11s/%-3d", galois::region::backend_name(columns[c].first), static_cast<int>(columns[c].second));
+         }
+
+         std::fprintf(out, "\n");
+
+         for (std::size_t i = 0; i < results.size(); )
+         {
+            const sweep_result& row = results[i];
+
+            std::fprintf(out, "RS(%03d,%03d) %3d %-9s",
+                         static_cast<int>(row.code_length),
+                         static_cast<int>(row.code_length - row.fec_length),
+                         static_cast<int>(row.load),
+                         row.erasures ? "erasures" : "errors");
+
+            std::size_t j = i;
+
+            for (std::size_t c = 0; c < columns.size(); ++c)
+            {
+               bool found = false;
+
+               for (std::size_t k = i; (k < results.size()) &&
+                                       (results[k].code_length == row.code_length) &&
+                                       (results[k].fec_length  == row.fec_length ) &&
+                                       (results[k].erasures    == row.erasures   ) &&
+                                       (results[k].load        == row.load       ); ++k)
+               {
+                  if ((results[k].backend == columns[c].first) && (results[k].threads == columns[c].second))
+                  {
+                     std::fprintf(out, " %14.1f%c", results[k].mbps, (0 == results[k].failures) ? ' ' : '!');
+                     found = true;
+                  }
+
+                  j = std::max(j, k + 1);
+               }
+
+               if (!found)
+                  std::fprintf(out, " %15s", "-");
+            }
+
+            std::fprintf(out, "\n");
+
+            i = j;
+         }
+      }
+
+      void speed_test_02()
+      {
+         const std::vector<sweep_result> results =
+            speed_sweep<8,120,255,2,4,8,16,32,64,128>(galois::primitive_polynomial_size06,galois::primitive_polynomial06);
+
+         print_sweep_matrix(results);
+      }
+
    } // namespace reed_solomon
 
 } // namespace schifra
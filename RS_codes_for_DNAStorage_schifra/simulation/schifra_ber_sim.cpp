@@ -0,0 +1,858 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Monte Carlo estimation of the block (FER) and post decoding
+                bit (BER) error rates of Reed-Solomon codes, over a sweep of
+                codes, channel error rates and channel models.
+
+                Codewords of random data are encoded, corrupted by the
+                channel model (see schifra_channel_simulator.hpp), decoded
+                and compared with the data sent. Work is spread over a
+                codec_executor in chunks of codewords, each decoded with
+                decode_batch() (or with its erasure list), and each chunk
+                seeded from (seed, point, round, chunk) so that a run gives
+                the same results whatever the thread count.
+
+                Every point runs until the confidence interval of its FER is
+                within --target of the estimate and at least --min-errors
+                block errors were seen, or --max-blocks codewords were
+                simulated.
+
+                With --importance, points of the substitution model are
+                estimated by stratifying on the number of symbol errors e
+                of a codeword: P(e) is binomial and known exactly, e <= t
+                always decodes, so only the strata e > t are simulated,
+                with exactly e errors injected, and weighted by P(e). Rates
+                far below what direct simulation can reach then cost no
+                more than any other point.
+
+                schifra_ber_sim [--codes=n:k,...] [--model=substitution|erasure|burst]
+                                [--rates=r,...] [--burst-length=n] [--importance]
+                                [--target=0.1] [--confidence=0.95] [--min-errors=100]
+                                [--max-blocks=n] [--threads=n] [--seed=n] [--csv=file]
+
+                Codes: n = 15 (GF(2^4), n - k in {2, 4, 6}), 63 (GF(2^6),
+                n - k in {4, 8, 12, 16}) and 255 (GF(2^8), n - k in
+                {8, 16, 32}).
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_block.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_executor.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/utils/schifra_channel_simulator.hpp"
+
+
+namespace sim
+{
+   typedef schifra::utils::channel::channel_model     channel_model;
+   typedef schifra::utils::channel::channel_simulator channel_simulator;
+
+   enum model_t
+   {
+      e_substitution,
+      e_erasure,
+      e_burst
+   };
+
+   inline const char* model_name(const model_t model)
+   {
+      switch (model)
+      {
+         case e_substitution : return "substitution";
+         case e_erasure      : return "erasure";
+         case e_burst        : return "burst";
+      }
+
+      return "unknown";
+   }
+
+   struct options
+   {
+      options()
+      : model(e_substitution),
+        burst_length(8),
+        importance(false),
+        target(0.1),
+        confidence(0.95),
+        min_errors(100),
+        max_blocks(100000000),
+        threads(0),
+        seed(1)
+      {}
+
+      std::vector<std::pair<std::size_t,std::size_t> > codes;
+      std::vector<double> rates;
+      model_t             model;
+      std::size_t         burst_length;
+      bool                importance;
+      double              target;
+      double              confidence;
+      std::size_t         min_errors;
+      std::size_t         max_blocks;
+      std::size_t         threads;
+      std::uint64_t       seed;
+      std::string         csv_file;
+   };
+
+   /* Outcome counts of a set of codewords */
+   struct tally
+   {
+      tally()
+      : blocks(0),
+        block_errors(0),
+        miscorrections(0),
+        channel_errors(0),
+        bit_errors(0),
+        bit_errors_sq(0.0)
+      {}
+
+      tally& operator+=(const tally& t)
+      {
+         blocks         += t.blocks;
+         block_errors   += t.block_errors;
+         miscorrections += t.miscorrections;
+         channel_errors += t.channel_errors;
+         bit_errors     += t.bit_errors;
+         bit_errors_sq  += t.bit_errors_sq;
+         return *this;
+      }
+
+      std::uint64_t blocks;
+      std::uint64_t block_errors;
+      std::uint64_t miscorrections;  /* decoded, to the wrong codeword */
+      std::uint64_t channel_errors;  /* symbols the channel corrupted  */
+      std::uint64_t bit_errors;      /* data bits wrong after decoding */
+      double        bit_errors_sq;   /* sum of squares, per codeword   */
+   };
+
+   /* Channel of one simulation round */
+   struct channel_setup
+   {
+      channel_model model;
+      std::size_t   fixed_errors;  /* > 0: exactly that many substitutions per codeword instead */
+      bool          erasures;      /* decode with the erasure positions */
+   };
+
+   /* Point estimate and confidence interval */
+   struct estimate
+   {
+      estimate() : value(0.0), low(0.0), high(0.0) {}
+
+      double value;
+      double low;
+      double high;
+   };
+
+   inline std::uint64_t mix_seed(std::uint64_t seed, const std::uint64_t value)
+   {
+      seed ^= value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2);
+      return schifra::utils::channel::splitmix64(seed);
+   }
+
+   /* Two sided standard normal quantile of confidence, eg: 1.96 for 0.95 */
+   inline double z_score(const double confidence)
+   {
+      /* Acklam's rational approximation of the inverse normal cdf */
+      const double p = 1.0 - (1.0 - confidence) / 2.0;
+
+      static const double a[] = { -3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                   1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00 };
+      static const double b[] = { -5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                   6.680131188771972e+01, -1.328068155288572e+01 };
+      static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                  -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00 };
+      static const double d[] = {  7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                   3.754408661907416e+00 };
+
+      if (p > 0.97575)
+      {
+         const double q = std::sqrt(-2.0 * std::log(1.0 - p));
+
+         return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                 ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+      }
+
+      const double q = p - 0.5;
+      const double r = q * q;
+
+      return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+             (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+   }
+
+   /* Wilson score interval of x successes in n trials */
+   inline estimate wilson(const double x, const double n, const double z)
+   {
+      estimate e;
+
+      if (n <= 0.0)
+      {
+         e.high = 1.0;
+         return e;
+      }
+
+      const double z2     = z * z;
+      const double center = (x + z2 / 2.0) / (n + z2);
+      const double half   = (z / (n + z2)) * std::sqrt((x * (n - x)) / n + z2 / 4.0);
+
+      e.value = x / n;
+      e.low   = std::max(0.0, center - half);
+      e.high  = std::min(1.0, center + half);
+
+      return e;
+   }
+
+   /* Normal interval of the mean of per codeword values, given their sum and sum of squares */
+   inline estimate mean_interval(const double sum, const double sum_sq, const double n, const double z)
+   {
+      estimate e;
+
+      if (n <= 0.0)
+         return e;
+
+      const double mean     = sum / n;
+      const double variance = std::max(0.0, sum_sq / n - mean * mean);
+      const double half     = z * std::sqrt(variance / n);
+
+      e.value = mean;
+      e.low   = std::max(0.0, mean - half);
+      e.high  = mean + half;
+
+      return e;
+   }
+
+   inline double relative_width(const estimate& e)
+   {
+      return (e.value > 0.0) ? (e.high - e.low) / (2.0 * e.value) : 1.0;
+   }
+
+   /* Binomial probability of e symbol errors out of n at rate p */
+   inline double binomial(const std::size_t n, const std::size_t e, const double p)
+   {
+      if (p <= 0.0) return (0 == e) ? 1.0 : 0.0;
+      if (p >= 1.0) return (n == e) ? 1.0 : 0.0;
+
+      return std::exp(std::lgamma(n + 1.0) - std::lgamma(e + 1.0) - std::lgamma(n - e + 1.0) +
+                      e * std::log(p) + (n - e) * std::log1p(-p));
+   }
+
+   /* A code under simulation: its codec, executor and per chunk scratch */
+   class code_runner
+   {
+   public:
+
+      virtual ~code_runner() {}
+
+      virtual std::size_t code_length() const = 0;
+      virtual std::size_t data_length() const = 0;
+      virtual unsigned int symbol_bits() const = 0;
+
+      /* Simulate chunks chunks of codewords, chunk c seeded with mix_seed(seed, c) */
+      virtual tally run(const channel_setup& setup, const std::uint64_t seed, const std::size_t chunks) = 0;
+
+      /* Codewords per chunk */
+      virtual std::size_t chunk_size() const = 0;
+   };
+
+   template <std::size_t code_length_, std::size_t fec_length_>
+   class code_runner_impl : public code_runner
+   {
+   public:
+
+      static const std::size_t n = code_length_;
+      static const std::size_t k = code_length_ - fec_length_;
+
+      typedef schifra::reed_solomon::codec_executor<code_length_,fec_length_> executor_type;
+      typedef typename executor_type::block_type                             block_type;
+      typedef typename executor_type::context                                context_type;
+
+      /* About 16K symbols per chunk, enough to amortise seeding the channel */
+      static const std::size_t chunk_codewords = (16384 / n) > 16 ? (16384 / n) : 16;
+
+      code_runner_impl(const unsigned int bits, const std::size_t poly_size, const unsigned int* poly,
+                       const unsigned int gen_initial_index, const std::size_t threads)
+      : bits_(bits),
+        field_(schifra::galois::shared_field(static_cast<int>(bits), poly_size, poly)),
+        generator_(*field_)
+      {
+         if (!schifra::make_sequential_root_generator_polynomial(*field_, gen_initial_index, fec_length_, generator_))
+            throw std::runtime_error("Failed to create sequential root generator");
+
+         executor_.reset(new executor_type(*field_, generator_, gen_initial_index, threads, 1));
+      }
+
+      std::size_t  code_length() const { return n;     }
+      std::size_t  data_length() const { return k;     }
+      unsigned int symbol_bits() const { return bits_; }
+      std::size_t  chunk_size () const { return chunk_codewords; }
+
+      tally run(const channel_setup& setup, const std::uint64_t seed, const std::size_t chunks)
+      {
+         std::vector<tally> results(chunks);
+
+         executor_->submit_range(chunks,
+                                 [&](const context_type& ctx, const std::size_t begin, const std::size_t end)
+                                 {
+                                    for (std::size_t c = begin; c < end; ++c)
+                                    {
+                                       run_chunk(ctx, setup, mix_seed(seed, c), results[c]);
+                                    }
+
+                                    return std::size_t(0);
+                                 }).get();
+
+         tally total;
+
+         for (std::size_t c = 0; c < chunks; ++c)
+         {
+            total += results[c];
+         }
+
+         return total;
+      }
+
+   private:
+
+      struct scratch
+      {
+         scratch()
+         : blocks(chunk_codewords),
+           sent(chunk_codewords * k),
+           received(chunk_codewords * n)
+         {}
+
+         std::vector<block_type>   blocks;
+         std::vector<std::uint8_t> sent;
+         std::vector<std::uint8_t> received;
+         std::vector<std::size_t>  erased;
+         schifra::reed_solomon::erasure_locations_t erasure_list;
+      };
+
+      void run_chunk(const context_type& ctx, const channel_setup& setup, const std::uint64_t seed, tally& out) const
+      {
+         static thread_local scratch s;
+         channel_simulator channel(setup.model, seed);
+
+         const std::uint64_t mask = (std::uint64_t(1) << bits_) - 1;
+
+         /* Random data, encoded */
+         for (std::size_t c = 0; c < chunk_codewords; ++c)
+         {
+            block_type& block = s.blocks[c];
+
+            std::uint64_t word = 0;
+
+            for (std::size_t i = 0; i < k; ++i)
+            {
+               if (0 == (i & 7)) word = channel.next();
+
+               block.data[i] = static_cast<typename block_type::symbol_type>(word & mask);
+               s.sent[c * k + i] = static_cast<std::uint8_t>(word & mask);
+               word >>= 8;
+            }
+
+            ctx.encoder.encode(block);
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               s.received[c * n + i] = static_cast<std::uint8_t>(block.data[i]);
+            }
+         }
+
+         /* Channel */
+         s.erased.clear();
+
+         if (setup.fixed_errors > 0)
+         {
+            out.channel_errors += channel.corrupt_symbols_fixed(s.received.data(), n, n, chunk_codewords,
+                                                                setup.fixed_errors, bits_);
+         }
+         else
+         {
+            const schifra::utils::channel::channel_stats stats =
+               channel.corrupt_symbols(s.received.data(), s.received.size(), bits_,
+                                       setup.erasures ? &s.erased : 0);
+
+            out.channel_errors += stats.substitutions + stats.erasures;
+         }
+
+         for (std::size_t c = 0; c < chunk_codewords; ++c)
+         {
+            block_type& block = s.blocks[c];
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               block.data[i] = s.received[c * n + i];
+            }
+
+            block.unrecoverable = false;
+         }
+
+         /* Decoder */
+         if (setup.erasures)
+         {
+            std::size_t e = 0;
+
+            for (std::size_t c = 0; c < chunk_codewords; ++c)
+            {
+               s.erasure_list.clear();
+
+               for ( ; (e < s.erased.size()) && (s.erased[e] < (c + 1) * n); ++e)
+               {
+                  s.erasure_list.push_back(s.erased[e] - c * n);
+               }
+
+               if (!ctx.decoder.decode(s.blocks[c], s.erasure_list))
+                  s.blocks[c].unrecoverable = true;
+            }
+         }
+         else
+            ctx.decoder.decode_batch(s.blocks.data(), chunk_codewords);
+
+         /* Compare, a failed codeword delivering its data as received */
+         for (std::size_t c = 0; c < chunk_codewords; ++c)
+         {
+            const block_type& block  = s.blocks[c];
+            const bool        failed = block.unrecoverable;
+
+            std::uint64_t bits = 0;
+
+            for (std::size_t i = 0; i < k; ++i)
+            {
+               const std::uint64_t delivered = failed ? s.received[c * n + i] : static_cast<std::uint64_t>(block.data[i]);
+
+               bits += static_cast<std::uint64_t>(__builtin_popcountll(delivered ^ s.sent[c * k + i]));
+            }
+
+            ++out.blocks;
+
+            if (failed || (bits > 0))
+               ++out.block_errors;
+
+            if (!failed && (bits > 0))
+               ++out.miscorrections;
+
+            out.bit_errors    += bits;
+            out.bit_errors_sq += static_cast<double>(bits) * static_cast<double>(bits);
+         }
+      }
+
+      const unsigned int                                 bits_;
+      const schifra::galois::field_registry::field_ptr   field_;
+      schifra::galois::field_polynomial                  generator_;
+      std::unique_ptr<executor_type>                     executor_;
+   };
+
+   inline std::unique_ptr<code_runner> make_runner(const std::size_t n, const std::size_t k, const std::size_t threads)
+   {
+      using namespace schifra::galois;
+
+      typedef std::unique_ptr<code_runner> runner_ptr;
+
+      const std::size_t fec = n - k;
+
+      #define SIM_CODE(N, FEC, BITS, POLY, GEN)                                                                   \
+      if ((N == n) && (FEC == fec))                                                                               \
+         return runner_ptr(new code_runner_impl<N,FEC>(BITS, primitive_polynomial_size##POLY,                     \
+                                                       primitive_polynomial##POLY, GEN, threads));
+
+      SIM_CODE( 15,  2, 4, 01,   1)
+      SIM_CODE( 15,  4, 4, 01,   1)
+      SIM_CODE( 15,  6, 4, 01,   1)
+      SIM_CODE( 63,  4, 6, 03,   1)
+      SIM_CODE( 63,  8, 6, 03,   1)
+      SIM_CODE( 63, 12, 6, 03,   1)
+      SIM_CODE( 63, 16, 6, 03,   1)
+      SIM_CODE(255,  8, 8, 06, 120)
+      SIM_CODE(255, 16, 8, 06, 120)
+      SIM_CODE(255, 32, 8, 06, 120)
+
+      #undef SIM_CODE
+
+      return runner_ptr();
+   }
+
+   /* Result of one (code, rate) point */
+   struct point_result
+   {
+      point_result()
+      : miscorrection_rate(0.0),
+        importance(false),
+        seconds(0.0)
+      {}
+
+      tally    total;
+      estimate fer;
+      estimate ber;
+      double   miscorrection_rate;
+      bool     importance;
+      double   seconds;
+   };
+
+   /* Codewords per simulation round */
+   inline std::size_t round_chunks(const code_runner& runner)
+   {
+      return std::max<std::size_t>(64, (1 << 18) / (runner.chunk_size() * runner.code_length()));
+   }
+
+   inline channel_setup make_setup(const options& opt, const double rate)
+   {
+      channel_setup setup;
+
+      setup.fixed_errors = 0;
+      setup.erasures     = (e_erasure == opt.model);
+
+      switch (opt.model)
+      {
+         case e_substitution : setup.model.substitution_rate = rate; break;
+         case e_erasure      : setup.model.erasure_rate      = rate; break;
+         case e_burst        : setup.model.burst_rate        = rate;
+                               setup.model.burst_length      = opt.burst_length;
+                               break;
+      }
+
+      return setup;
+   }
+
+   point_result simulate_direct(code_runner& runner, const options& opt, const double rate, const std::uint64_t seed)
+   {
+      const double        z      = z_score(opt.confidence);
+      const double        bits   = static_cast<double>(runner.data_length() * runner.symbol_bits());
+      const channel_setup setup  = make_setup(opt, rate);
+      const std::size_t   chunks = round_chunks(runner);
+
+      point_result result;
+
+      for (std::uint64_t round = 0; result.total.blocks < opt.max_blocks; ++round)
+      {
+         result.total += runner.run(setup, mix_seed(seed, round), chunks);
+
+         result.fer = wilson(static_cast<double>(result.total.block_errors), static_cast<double>(result.total.blocks), z);
+
+         if ((result.total.block_errors >= opt.min_errors) && (relative_width(result.fer) <= opt.target))
+            break;
+      }
+
+      const estimate bit_mean = mean_interval(static_cast<double>(result.total.bit_errors), result.total.bit_errors_sq,
+                                              static_cast<double>(result.total.blocks), z);
+
+      result.ber.value = bit_mean.value / bits;
+      result.ber.low   = bit_mean.low   / bits;
+      result.ber.high  = bit_mean.high  / bits;
+
+      result.miscorrection_rate = result.total.blocks ?
+                                  static_cast<double>(result.total.miscorrections) / result.total.blocks : 0.0;
+
+      return result;
+   }
+
+   /*
+      Stratified on the number e of symbol errors per codeword, see the
+      description above. Strata are added from t + 1 up until their
+      probability falls below 1e-9 of the running total.
+   */
+   point_result simulate_importance(code_runner& runner, const options& opt, const double rate, const std::uint64_t seed)
+   {
+      const double      z      = z_score(opt.confidence);
+      const std::size_t n      = runner.code_length();
+      const std::size_t t      = (n - runner.data_length()) / 2;
+      const double      bits   = static_cast<double>(runner.data_length() * runner.symbol_bits());
+      const std::size_t chunks = round_chunks(runner);
+
+      point_result result;
+
+      result.importance = true;
+
+      double fer = 0.0, fer_var = 0.0;
+      double ber = 0.0, ber_var = 0.0;
+      double misc = 0.0;
+      double weight_total = 0.0;
+
+      for (std::size_t e = t + 1; e <= n; ++e)
+      {
+         const double weight = binomial(n, e, rate);
+
+         if ((weight_total > 0.0) && (weight < 1.0e-9 * weight_total))
+            break;
+
+         weight_total += weight;
+
+         channel_setup setup;
+
+         setup.fixed_errors = e;
+         setup.erasures     = false;
+
+         tally stratum;
+
+         for (std::uint64_t round = 0; stratum.blocks < opt.max_blocks; ++round)
+         {
+            stratum += runner.run(setup, mix_seed(mix_seed(seed, e), round), chunks);
+
+            const estimate bit_mean = mean_interval(static_cast<double>(stratum.bit_errors), stratum.bit_errors_sq,
+                                                    static_cast<double>(stratum.blocks), z);
+
+            if ((stratum.blocks >= opt.min_errors) && (relative_width(bit_mean) <= opt.target))
+               break;
+         }
+
+         const double blocks  = static_cast<double>(stratum.blocks);
+         const double p_error = stratum.block_errors / blocks;
+         const double mean    = stratum.bit_errors / blocks;
+         const double var     = std::max(0.0, stratum.bit_errors_sq / blocks - mean * mean);
+
+         fer     += weight * p_error;
+         fer_var += weight * weight * p_error * (1.0 - p_error) / blocks;
+         ber     += weight * mean / bits;
+         ber_var += weight * weight * var / (blocks * bits * bits);
+         misc    += weight * stratum.miscorrections / blocks;
+
+         result.total += stratum;
+      }
+
+      result.fer.value = fer;
+      result.fer.low   = std::max(0.0, fer - z * std::sqrt(fer_var));
+      result.fer.high  = fer + z * std::sqrt(fer_var);
+      result.ber.value = ber;
+      result.ber.low   = std::max(0.0, ber - z * std::sqrt(ber_var));
+      result.ber.high  = ber + z * std::sqrt(ber_var);
+      result.miscorrection_rate = misc;
+
+      return result;
+   }
+
+   std::vector<std::string> split(const std::string& s, const char separator)
+   {
+      std::vector<std::string> parts;
+      std::stringstream stream(s);
+      std::string part;
+
+      while (std::getline(stream, part, separator))
+      {
+         if (!part.empty())
+            parts.push_back(part);
+      }
+
+      return parts;
+   }
+
+   bool parse_options(int argc, char* argv[], options& opt)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg(argv[i]);
+         const std::size_t eq    = arg.find('=');
+         const std::string key   = arg.substr(0, eq);
+         const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+         if ("--codes" == key)
+         {
+            const std::vector<std::string> codes = split(value, ',');
+
+            for (std::size_t c = 0; c < codes.size(); ++c)
+            {
+               const std::size_t colon = codes[c].find(':');
+
+               if (std::string::npos == colon)
+               {
+                  std::cout << "schifra_ber_sim - Error: code " << codes[c] << " is not n:k" << std::endl;
+                  return false;
+               }
+
+               opt.codes.push_back(std::make_pair(std::strtoul(codes[c].substr(0, colon).c_str(), 0, 10),
+                                                  std::strtoul(codes[c].substr(colon + 1).c_str(), 0, 10)));
+            }
+         }
+         else if ("--rates" == key)
+         {
+            const std::vector<std::string> rates = split(value, ',');
+
+            for (std::size_t r = 0; r < rates.size(); ++r)
+            {
+               opt.rates.push_back(std::atof(rates[r].c_str()));
+            }
+         }
+         else if ("--model" == key)
+         {
+            if      ("substitution" == value) opt.model = e_substitution;
+            else if ("erasure"      == value) opt.model = e_erasure;
+            else if ("burst"        == value) opt.model = e_burst;
+            else
+            {
+               std::cout << "schifra_ber_sim - Error: unknown model " << value << std::endl;
+               return false;
+            }
+         }
+         else if ("--burst-length" == key) opt.burst_length = std::max<std::size_t>(1, std::strtoul(value.c_str(), 0, 10));
+         else if ("--importance"   == key) opt.importance   = true;
+         else if ("--target"       == key) opt.target       = std::atof(value.c_str());
+         else if ("--confidence"   == key) opt.confidence   = std::atof(value.c_str());
+         else if ("--min-errors"   == key) opt.min_errors   = std::strtoul(value.c_str(), 0, 10);
+         else if ("--max-blocks"   == key) opt.max_blocks   = std::strtoull(value.c_str(), 0, 10);
+         else if ("--threads"      == key) opt.threads      = std::strtoul(value.c_str(), 0, 10);
+         else if ("--seed"         == key) opt.seed         = std::strtoull(value.c_str(), 0, 10);
+         else if ("--csv"          == key) opt.csv_file     = value;
+         else
+         {
+            std::cout << "schifra_ber_sim - Error: unknown option " << arg << std::endl;
+            return false;
+         }
+      }
+
+      if ((opt.confidence <= 0.0) || (opt.confidence >= 1.0) || (opt.target <= 0.0))
+      {
+         std::cout << "schifra_ber_sim - Error: --confidence must be in (0,1) and --target positive" << std::endl;
+         return false;
+      }
+
+      if (opt.codes.empty())
+      {
+         opt.codes.push_back(std::make_pair(std::size_t( 15), std::size_t( 11)));
+         opt.codes.push_back(std::make_pair(std::size_t(255), std::size_t(223)));
+      }
+
+      if (opt.rates.empty())
+      {
+         const double rates[] = { 1.0e-1, 5.0e-2, 2.0e-2, 1.0e-2 };
+
+         opt.rates.assign(rates, rates + sizeof(rates) / sizeof(rates[0]));
+      }
+
+      return true;
+   }
+
+} // namespace sim
+
+
+int main(int argc, char* argv[])
+{
+   sim::options opt;
+
+   if (!sim::parse_options(argc, argv, opt))
+      return 1;
+
+   std::ofstream csv;
+
+   if (!opt.csv_file.empty())
+   {
+      csv.open(opt.csv_file.c_str());
+
+      if (!csv)
+      {
+         std::cout << "schifra_ber_sim - Error: cannot open " << opt.csv_file << std::endl;
+         return 1;
+      }
+
+      csv << "code,n,k,symbol_bits,model,rate,burst_length,method,blocks,block_errors,fer,fer_low,fer_high,"
+             "miscorrection_rate,bit_errors,ber,ber_low,ber_high,seconds\n";
+   }
+
+   std::cout << std::left  << std::setw(12) << "code"
+             << std::setw(14) << "model"
+             << std::right << std::setw(10) << "rate"
+             << std::setw(12) << "method"
+             << std::setw(14) << "blocks"
+             << std::setw(12) << "errors"
+             << std::setw(12) << "fer"
+             << std::setw(12) << "ber"
+             << std::setw(10) << "seconds" << std::endl;
+
+   std::uint64_t point = 0;
+
+   for (std::size_t c = 0; c < opt.codes.size(); ++c)
+   {
+      const std::size_t n = opt.codes[c].first;
+      const std::size_t k = opt.codes[c].second;
+
+      std::unique_ptr<sim::code_runner> runner = ((k > 0) && (k < n)) ? sim::make_runner(n, k, opt.threads)
+                                                                        : std::unique_ptr<sim::code_runner>();
+
+      if (!runner)
+      {
+         std::cout << "schifra_ber_sim - Error: unsupported code RS(" << n << "," << k << ")" << std::endl;
+         return 1;
+      }
+
+      std::ostringstream code_name;
+      code_name << "RS(" << n << "," << k << ")";
+
+      for (std::size_t r = 0; r < opt.rates.size(); ++r, ++point)
+      {
+         const double        rate = opt.rates[r];
+         const std::uint64_t seed = sim::mix_seed(opt.seed, point);
+
+         const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+         sim::point_result result = (opt.importance && (sim::e_substitution == opt.model)) ?
+                                    sim::simulate_importance(*runner, opt, rate, seed) :
+                                    sim::simulate_direct    (*runner, opt, rate, seed);
+
+         result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         const char* method = result.importance ? "importance" : "direct";
+
+         std::cout << std::left  << std::setw(12) << code_name.str()
+                   << std::setw(14) << sim::model_name(opt.model)
+                   << std::right << std::setw(10) << std::setprecision(3) << rate
+                   << std::setw(12) << method
+                   << std::setw(14) << result.total.blocks
+                   << std::setw(12) << result.total.block_errors
+                   << std::setw(12) << std::setprecision(4) << result.fer.value
+                   << std::setw(12) << std::setprecision(4) << result.ber.value
+                   << std::setw(10) << std::fixed << std::setprecision(2) << result.seconds
+                   << std::defaultfloat << std::endl;
+
+         if (csv)
+         {
+            csv << code_name.str() << ',' << n << ',' << k << ',' << runner->symbol_bits() << ','
+                << sim::model_name(opt.model) << ',' << std::setprecision(10) << rate << ','
+                << ((sim::e_burst == opt.model) ? opt.burst_length : 0) << ',' << method << ','
+                << result.total.blocks << ',' << result.total.block_errors << ','
+                << result.fer.value << ',' << result.fer.low << ',' << result.fer.high << ','
+                << result.miscorrection_rate << ',' << result.total.bit_errors << ','
+                << result.ber.value << ',' << result.ber.low << ',' << result.ber.high << ','
+                << result.seconds << '\n' << std::flush;
+         }
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,86 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Exhaustive validation of the encoder and decoder over the
+                error and erasure patterns of codec_validator, for the
+                natural RS(255,k) codes of codec_validation_test00 and the
+                shortened codes of codec_validation_test01. The patterns
+                of every code and message are spread over all threads,
+                see validation_suite.
+
+                schifra_codec_validation [--threads=n] [--shards=16] [--progress=10]
+                                         [--natural-only] [--shortened-only]
+*/
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "schifra/reed_solomon/schifra_reed_solomon_codec_validator.hpp"
+
+
+int main(int argc, char* argv[])
+{
+   std::size_t threads   = 0;
+   std::size_t shards    = schifra::reed_solomon::validation_suite::default_shards;
+   double      progress  = 10.0;
+   bool        natural   = true;
+   bool        shortened = true;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg(argv[i]);
+      const std::size_t eq    = arg.find('=');
+      const std::string key   = arg.substr(0, eq);
+      const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+      if      ("--threads"        == key) threads   = std::strtoul(value.c_str(), 0, 10);
+      else if ("--shards"         == key) shards    = std::strtoul(value.c_str(), 0, 10);
+      else if ("--progress"       == key) progress  = std::atof(value.c_str());
+      else if ("--natural-only"   == key) shortened = false;
+      else if ("--shortened-only" == key) natural   = false;
+      else
+      {
+         std::cout << "schifra_codec_validation - Error: unknown option " << arg << std::endl;
+         return 1;
+      }
+   }
+
+   schifra::reed_solomon::validation_suite suite(threads, shards, progress);
+
+   if (natural  ) schifra::reed_solomon::add_codec_validation_test00(suite);
+   if (shortened) schifra::reed_solomon::add_codec_validation_test01(suite);
+
+   if (suite.run())
+   {
+      std::cout << "Schifra Reed-Solomon Codec Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Codec Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,129 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+/*
+   Description: Regression check of the orientation detection of
+                dna_storage<15,4,11> in-band strands. The all 'A' (zero)
+                strand and its reverse complement, all 'T', are codewords
+                both ways with different data, so neither may decode, or
+                come back as forward. A strand read as encoded and reverse
+                complemented must decode in its own orientation. Checked
+                through decode_strand_oriented() and, with both batch
+                engines, decode_strands_oriented(). Exits with 1 otherwise.
+*/
+
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "schifra/dna_storage.hpp"
+#include "schifra/utils/schifra_dna_alphabet.hpp"
+
+
+typedef schifra::dna_storage<15,4,11> storage_t;
+
+struct oriented_case
+{
+   std::string name;
+   std::string read;
+   bool decodes;
+   storage_t::strand_orientation orientation;
+};
+
+int main()
+{
+   const storage_t storage;
+
+   const std::string data = "ACGTTGCAACGGTCAGTACCGA";
+
+   std::string strand(storage_t::strand_length(), 'A');
+
+   if (!storage.encode_strand(data, &strand[0]))
+   {
+      std::cout << "schifra_oriented_decode_regression - Error: encoding failed" << std::endl;
+      return 1;
+   }
+
+   std::string reversed(strand.size(), 'A');
+   schifra::utils::dna::reverse_complement(strand.data(), strand.size(), &reversed[0]);
+
+   const oriented_case cases[] =
+      {
+         { "all A"   , std::string(storage_t::strand_length(), 'A'), false, storage_t::strand_orientation::unknown },
+         { "all T"   , std::string(storage_t::strand_length(), 'T'), false, storage_t::strand_orientation::unknown },
+         { "forward" , strand                                      , true , storage_t::strand_orientation::forward },
+         { "reversed", reversed                                    , true , storage_t::strand_orientation::reverse }
+      };
+
+   const std::size_t case_count = sizeof(cases) / sizeof(oriented_case);
+
+   bool passed = true;
+
+   std::string reads;
+
+   for (std::size_t c = 0; c < case_count; ++c)
+   {
+      std::string decoded(storage_t::strand_data_length(), 'N');
+      storage_t::strand_orientation orientation = storage_t::strand_orientation::forward;
+
+      const bool decodes = static_cast<bool>(storage.decode_strand_oriented(cases[c].read, &decoded[0], &orientation));
+
+      const bool ok = (decodes == cases[c].decodes) &&
+                      (orientation == cases[c].orientation) &&
+                      (!decodes || (decoded == data));
+
+      std::cout << "decode_strand_oriented  " << cases[c].name << ": " << (ok ? "ok" : "WRONG") << std::endl;
+
+      passed = passed && ok;
+      reads += cases[c].read;
+   }
+
+   const storage_t::batch_engine engines[] = { storage_t::batch_engine::simd, storage_t::batch_engine::bitsliced };
+
+   for (std::size_t e = 0; e < 2; ++e)
+   {
+      storage_t::sequence_buffer out;
+
+      const std::size_t decoded = storage.decode_strands_oriented(reads, out, engines[e]);
+
+      bool ok = (2 == decoded);
+
+      for (std::size_t c = 0; c < case_count; ++c)
+      {
+         const bool decodes = (storage_t::block_status::ok == out.status[c]);
+
+         ok = ok && (decodes == cases[c].decodes) &&
+                    (out.orientation[c] == cases[c].orientation) &&
+                    (!decodes || (0 == out.dna.compare(c * storage_t::strand_data_length(), storage_t::strand_data_length(), data)));
+      }
+
+      std::cout << "decode_strands_oriented " << ((0 == e) ? "simd" : "bitsliced") << ": " << (ok ? "ok" : "WRONG") << std::endl;
+
+      passed = passed && ok;
+   }
+
+   std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+   return passed ? 0 : 1;
+}
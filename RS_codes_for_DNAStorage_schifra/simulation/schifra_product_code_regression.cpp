@@ -0,0 +1,202 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Regression check of square_product_code_decoder against
+                product_code_decoder on the same RS(255,247) x RS(255,247)
+                arrays, carrying error patterns that only decode when the
+                lines that failed are retried once their erasures change:
+
+                pattern A : rows 10-17 hold 6 errors each, in columns
+                            100-105, row 30 holds 6 errors in columns of
+                            their own. 9 rows fail, too many to erase, the
+                            columns then correct row 30 and leave 100-105
+                            failed, and rows 10-17 decode when retried with
+                            those 6 columns erased.
+
+                pattern B : as A but with rows 10-17 holding 9 errors, in
+                            columns 100-108. The rows fail again, 9 erased
+                            columns being too many, but row 30 decodes, so
+                            columns 100-108 decode when retried with rows
+                            10-17 erased.
+
+                Every array the rectangular decoder recovers, the square
+                decoder must recover too. Exits with 1 otherwise.
+
+                schifra_product_code_regression [--trials=20] [--seed=n]
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/polynomial.hpp"
+#include "schifra/reed_solomon/schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_product_code.hpp"
+
+
+int main(int argc, char* argv[])
+{
+   const std::size_t field_descriptor    =   8;
+   const std::size_t gen_poly_index      = 120;
+   const std::size_t code_length         = 255;
+   const std::size_t fec_length          =   8;
+   const std::size_t data_length         = code_length - fec_length;
+
+   typedef schifra::reed_solomon::encoder<code_length,fec_length> encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length> decoder_t;
+   typedef schifra::reed_solomon::square_product_code_decoder<code_length,fec_length> square_decoder_t;
+   typedef schifra::reed_solomon::product_code_encoder<code_length,fec_length,code_length,fec_length> product_encoder_t;
+   typedef schifra::reed_solomon::product_code_decoder<code_length,fec_length,code_length,fec_length> product_decoder_t;
+
+   std::size_t   trials = 20;
+   unsigned long seed   = 20240601;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg(argv[i]);
+      const std::size_t eq    = arg.find('=');
+      const std::string key   = arg.substr(0, eq);
+      const std::string value = (std::string::npos == eq) ? std::string() : arg.substr(eq + 1);
+
+      if      ("--trials" == key) trials = std::strtoul(value.c_str(), 0, 10);
+      else if ("--seed"   == key) seed   = std::strtoul(value.c_str(), 0, 10);
+      else
+      {
+         std::cout << "schifra_product_code_regression - Error: unknown option " << arg << std::endl;
+         return 1;
+      }
+   }
+
+   const schifra::galois::field field(field_descriptor,
+                                      schifra::galois::primitive_polynomial_size06,
+                                      schifra::galois::primitive_polynomial06);
+
+   schifra::galois::field_polynomial generator_polynomial(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator_polynomial))
+   {
+      std::cout << "schifra_product_code_regression - Error: failed to create generator polynomial" << std::endl;
+      return 1;
+   }
+
+   const encoder_t encoder(field, generator_polynomial);
+   const decoder_t decoder(field, gen_poly_index);
+
+   product_encoder_t product_encoder(encoder, encoder, data_length, data_length);
+   product_decoder_t product_decoder(decoder, decoder, data_length, data_length);
+
+   std::unique_ptr<square_decoder_t> square_decoder(new square_decoder_t(decoder));
+
+   std::vector<schifra::galois::field_symbol> data   (data_length * data_length);
+   std::vector<schifra::galois::field_symbol> encoded(code_length * code_length);
+   std::vector<schifra::galois::field_symbol> decoded(data_length * data_length);
+   std::vector<unsigned char>                 array  (code_length * code_length);
+   std::vector<unsigned char>                 output (data_length * data_length);
+
+   std::mt19937 rng(static_cast<std::mt19937::result_type>(seed));
+
+   std::uniform_int_distribution<int> symbol(0, 255);
+   std::uniform_int_distribution<int> error (1, 255);
+
+   const char* const pattern_name[] = { "A", "B" };
+
+   bool passed = true;
+
+   for (std::size_t pattern = 0; pattern < 2; ++pattern)
+   {
+      const std::size_t shared_columns = (0 == pattern) ? 6 : 9;
+
+      std::size_t square_recovered      = 0;
+      std::size_t rectangular_recovered = 0;
+      std::size_t regressions           = 0;
+
+      for (std::size_t t = 0; t < trials; ++t)
+      {
+         for (std::size_t i = 0; i < data.size(); ++i)
+         {
+            data[i] = symbol(rng);
+         }
+
+         if (!product_encoder.encode(data.data()))
+         {
+            std::cout << "schifra_product_code_regression - Error: encoding failed" << std::endl;
+            return 1;
+         }
+
+         product_encoder.output(encoded.data());
+
+         for (std::size_t row = 10; row < 18; ++row)
+         {
+            for (std::size_t col = 100; col < (100 + shared_columns); ++col)
+            {
+               encoded[row * code_length + col] ^= error(rng);
+            }
+         }
+
+         for (std::size_t col = 200; col < 206; ++col)
+         {
+            encoded[30 * code_length + col] ^= error(rng);
+         }
+
+         for (std::size_t i = 0; i < encoded.size(); ++i)
+         {
+            array[i] = static_cast<unsigned char>(encoded[i]);
+         }
+
+         product_decoder.decode(encoded.data());
+         product_decoder.output(decoded.data());
+
+         square_decoder->iterative_decode(array.data());
+         square_decoder->output(output.data());
+
+         const bool rectangular_ok = (decoded == data);
+         const bool square_ok      = std::equal(data.begin(), data.end(), output.begin());
+
+         if (rectangular_ok) ++rectangular_recovered;
+         if (square_ok     ) ++square_recovered;
+
+         if (rectangular_ok && !square_ok)
+            ++regressions;
+      }
+
+      std::cout << "pattern " << pattern_name[pattern]
+                << "  square: "      << square_recovered      << "/" << trials
+                << "  rectangular: " << rectangular_recovered << "/" << trials << std::endl;
+
+      if (regressions || (0 == rectangular_recovered))
+         passed = false;
+   }
+
+   std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+   return passed ? 0 : 1;
+}
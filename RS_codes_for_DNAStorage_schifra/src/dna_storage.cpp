@@ -8,10 +8,24 @@
 */
 
 #include "schifra/dna_storage.hpp"
+#include "schifra/dna_storage_gf2m.hpp"
+#include "schifra/dna_oligo_pool.hpp"
+#include "schifra/dna_oligo_address.hpp"
+#include "schifra/dna_object_store.hpp"
+#include "schifra/dna_oligo_stream.hpp"
+#include "schifra/dna_read_clustering.hpp"
 
 namespace schifra {
 
 // Explicit template instantiations for common Reed-Solomon codes
 template class dna_storage<15, 4, 11>;    // RS(15, 11) - For testing
+template class dna_storage_gf2m<3, 63, 12, 51>;    // RS(63, 51) over GF(2^6)
+template class dna_storage_gf2m<4, 255, 32, 223>;  // RS(255, 223) over GF(2^8)
+
+// RS(15, 11) strands under a GF(2^8) outer erasure code
+template class oligo_pool_codec<dna_storage<15, 4, 11>>;
+template class addressed_pool_codec<dna_storage<15, 4, 11>>;
+template class oligo_object_store<dna_storage<15, 4, 11>>;
+template class addressed_stream_decoder<dna_storage<15, 4, 11>>;
 
 } // namespace schifra
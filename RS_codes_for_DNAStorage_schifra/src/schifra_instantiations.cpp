@@ -0,0 +1,33 @@
+/*
+   schifra_instantiations.cpp - Precompiled Reed-Solomon codecs
+
+   Explicit instantiations of the encoder and decoder of the codes listed
+   in schifra_reed_solomon_instantiations.hpp, which consumers built with
+   SCHIFRA_EXTERN_TEMPLATES link against instead of instantiating.
+
+   Copyright (C) 2025 Schifra Project
+*/
+
+#include "schifra/reed_solomon/schifra_reed_solomon_encoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_decoder.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_instantiations.hpp"
+
+namespace schifra {
+namespace reed_solomon {
+
+#define SCHIFRA_INSTANTIATE_CODEC(n, fec) \
+    template class encoder<n, fec>;       \
+    template class decoder<n, fec>;
+
+#define SCHIFRA_INSTANTIATE_SHORTENED_CODEC(n, fec) \
+    template class shortened_encoder<n, fec>;       \
+    template class shortened_decoder<n, fec>;
+
+SCHIFRA_RS_COMMON_CODES(SCHIFRA_INSTANTIATE_CODEC)
+SCHIFRA_RS_COMMON_SHORTENED_CODES(SCHIFRA_INSTANTIATE_SHORTENED_CODEC)
+
+#undef SCHIFRA_INSTANTIATE_CODEC
+#undef SCHIFRA_INSTANTIATE_SHORTENED_CODEC
+
+} // namespace reed_solomon
+} // namespace schifra
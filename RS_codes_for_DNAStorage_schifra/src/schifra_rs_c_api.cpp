@@ -0,0 +1,259 @@
+/*
+   schifra_rs_c_api.cpp - C interface to the run time Reed-Solomon codec
+
+   Implements schifra_rs_c_api.h over reed_solomon::rs_codec. No C++
+   exception crosses the interface, every failure becomes an rs_result_t.
+
+   Copyright (C) 2025 Schifra Project
+*/
+
+#include "schifra/schifra_rs_c_api.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "schifra/core/galois_field/field.hpp"
+#include "schifra/core/galois_field/field_registry.hpp"
+#include "schifra/reed_solomon/schifra_reed_solomon_rs_codec.hpp"
+
+struct rs_codec {
+    schifra::galois::field_registry::field_ptr field;
+    std::unique_ptr<const schifra::reed_solomon::rs_codec> codec;
+    std::uint8_t symbol_mask = 0xFF;
+
+    mutable std::atomic<std::uint64_t> blocks_encoded{0};
+    mutable std::atomic<std::uint64_t> blocks_decoded{0};
+    mutable std::atomic<std::uint64_t> blocks_clean{0};
+    mutable std::atomic<std::uint64_t> blocks_corrected{0};
+    mutable std::atomic<std::uint64_t> blocks_uncorrectable{0};
+    mutable std::atomic<std::uint64_t> blocks_invalid{0};
+};
+
+namespace {
+
+// Default field polynomial per symbol size as a bit mask, the same as
+// primitive_polynomial00 .. 04 and 06 of field.hpp
+unsigned int default_primitive_poly(unsigned int symbol_bits) {
+    switch (symbol_bits) {
+        case 3: return 0x00B;  // x^3 + x + 1
+        case 4: return 0x013;  // x^4 + x + 1
+        case 5: return 0x025;  // x^5 + x^2 + 1
+        case 6: return 0x043;  // x^6 + x + 1
+        case 7: return 0x089;  // x^7 + x^3 + 1
+        case 8: return 0x187;  // x^8 + x^7 + x^2 + x + 1
+        default: return 0;
+    }
+}
+
+// True when poly, of degree symbol_bits, is primitive: x has order
+// 2^symbol_bits - 1 modulo poly
+bool is_primitive(unsigned int poly, unsigned int symbol_bits) {
+    const unsigned int top = 1u << symbol_bits;
+    if ((poly & ~((top << 1) - 1)) || !(poly & top) || !(poly & 1)) {
+        return false;
+    }
+
+    const unsigned int order = top - 1;
+    unsigned int power = 1;
+    for (unsigned int i = 1; i <= order; ++i) {
+        power <<= 1;
+        if (power & top) power ^= poly;
+        if (power == 1) return i == order;
+    }
+    return false;
+}
+
+bool fits(const std::uint8_t* symbols, std::size_t count, std::uint8_t mask) {
+    if (mask == 0xFF) return true;
+    std::uint8_t any = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        any |= symbols[i];
+    }
+    return (any & ~mask) == 0;
+}
+
+template <typename Call>
+rs_result_t guarded(Call call) {
+    try {
+        return call();
+    }
+    catch (const std::bad_alloc&) {
+        return RS_OUT_OF_MEMORY;
+    }
+    catch (...) {
+        return RS_INTERNAL_ERROR;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t rs_abi_version(void) {
+    return RS_ABI_VERSION;
+}
+
+const char* rs_result_string(rs_result_t result) {
+    switch (result) {
+        case RS_OK:               return "ok";
+        case RS_INVALID_ARGUMENT: return "invalid argument";
+        case RS_OUT_OF_MEMORY:    return "out of memory";
+        case RS_INTERNAL_ERROR:   return "internal error";
+        default:                  return "unknown result";
+    }
+}
+
+rs_result_t rs_codec_create(unsigned int symbol_bits, unsigned int primitive_poly,
+                            size_t n, size_t k, unsigned int fcr, rs_codec_t** codec) {
+    if (!codec) return RS_INVALID_ARGUMENT;
+    *codec = nullptr;
+
+    if ((symbol_bits < 3) || (symbol_bits > 8)) return RS_INVALID_ARGUMENT;
+    if (primitive_poly == 0) primitive_poly = default_primitive_poly(symbol_bits);
+    if (!is_primitive(primitive_poly, symbol_bits)) return RS_INVALID_ARGUMENT;
+    if ((k == 0) || (k >= n) || (n >= (std::size_t(1) << symbol_bits))) return RS_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        std::vector<unsigned int> coefficients(symbol_bits + 1);
+        for (unsigned int i = 0; i <= symbol_bits; ++i) {
+            coefficients[i] = (primitive_poly >> i) & 1;
+        }
+
+        std::unique_ptr<rs_codec_t> created(new rs_codec_t);
+        created->field = schifra::galois::shared_field(static_cast<int>(symbol_bits), coefficients.size(),
+                                                       coefficients.data());
+        created->codec.reset(new schifra::reed_solomon::rs_codec(*created->field, n, k, fcr));
+        created->symbol_mask = static_cast<std::uint8_t>((1u << symbol_bits) - 1);
+        if (!created->codec->valid()) return RS_INVALID_ARGUMENT;
+
+        *codec = created.release();
+        return RS_OK;
+    });
+}
+
+void rs_codec_destroy(rs_codec_t* codec) {
+    delete codec;
+}
+
+size_t rs_code_length(const rs_codec_t* codec) { return codec ? codec->codec->code_length() : 0; }
+size_t rs_data_length(const rs_codec_t* codec) { return codec ? codec->codec->data_length() : 0; }
+size_t rs_fec_length (const rs_codec_t* codec) { return codec ? codec->codec->fec_length()  : 0; }
+
+rs_result_t rs_encode_batch(const rs_codec_t* codec, const uint8_t* data, size_t data_stride,
+                            uint8_t* parity, size_t parity_stride, size_t blocks, uint8_t* status) {
+    if (!codec) return RS_INVALID_ARGUMENT;
+    if (blocks == 0) return RS_OK;
+
+    const schifra::reed_solomon::rs_codec& rs = *codec->codec;
+    const std::size_t data_length = rs.data_length();
+    const std::size_t fec_length = rs.fec_length();
+    if (!data || !parity) return RS_INVALID_ARGUMENT;
+    if ((blocks > 1) && ((data_stride < data_length) || (parity_stride < fec_length))) return RS_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        std::uint64_t invalid = 0;
+        for (std::size_t i = 0; i < blocks; ++i) {
+            const std::uint8_t* block_data = data + i * data_stride;
+            std::uint8_t* block_parity = parity + i * parity_stride;
+
+            rs_block_status_t outcome = RS_BLOCK_OK;
+            if (!fits(block_data, data_length, codec->symbol_mask)) {
+                outcome = RS_BLOCK_INVALID;
+                ++invalid;
+            }
+            else if (!rs.encode(schifra::utils::span<const std::uint8_t>(block_data, data_length),
+                                schifra::utils::span<std::uint8_t>(block_parity, fec_length))) {
+                return RS_INTERNAL_ERROR;
+            }
+            if (status) status[i] = static_cast<std::uint8_t>(outcome);
+        }
+
+        codec->blocks_encoded.fetch_add(blocks - invalid, std::memory_order_relaxed);
+        codec->blocks_invalid.fetch_add(invalid, std::memory_order_relaxed);
+        return RS_OK;
+    });
+}
+
+rs_result_t rs_decode_batch(const rs_codec_t* codec, uint8_t* codewords, size_t stride,
+                            size_t blocks, uint8_t* status, size_t* decoded) {
+    if (decoded) *decoded = 0;
+    if (!codec) return RS_INVALID_ARGUMENT;
+    if (blocks == 0) return RS_OK;
+
+    const schifra::reed_solomon::rs_codec& rs = *codec->codec;
+    const std::size_t code_length = rs.code_length();
+    if (!codewords) return RS_INVALID_ARGUMENT;
+    if ((blocks > 1) && (stride < code_length)) return RS_INVALID_ARGUMENT;
+
+    return guarded([&] {
+        // Decoded into a copy, so that corrected blocks are told apart from
+        // clean ones and failing blocks are left exactly as read
+        std::uint8_t scratch[256];
+        std::uint64_t clean = 0, corrected = 0, uncorrectable = 0, invalid = 0;
+
+        for (std::size_t i = 0; i < blocks; ++i) {
+            std::uint8_t* codeword = codewords + i * stride;
+
+            rs_block_status_t outcome;
+            if (!fits(codeword, code_length, codec->symbol_mask)) {
+                outcome = RS_BLOCK_INVALID;
+                ++invalid;
+            }
+            else {
+                std::memcpy(scratch, codeword, code_length);
+                if (!rs.decode(schifra::utils::span<std::uint8_t>(scratch, code_length))) {
+                    outcome = RS_BLOCK_UNCORRECTABLE;
+                    ++uncorrectable;
+                }
+                else if (std::memcmp(scratch, codeword, code_length) != 0) {
+                    std::memcpy(codeword, scratch, code_length);
+                    outcome = RS_BLOCK_CORRECTED;
+                    ++corrected;
+                }
+                else {
+                    outcome = RS_BLOCK_OK;
+                    ++clean;
+                }
+            }
+            if (status) status[i] = static_cast<std::uint8_t>(outcome);
+        }
+
+        codec->blocks_decoded.fetch_add(clean + corrected, std::memory_order_relaxed);
+        codec->blocks_clean.fetch_add(clean, std::memory_order_relaxed);
+        codec->blocks_corrected.fetch_add(corrected, std::memory_order_relaxed);
+        codec->blocks_uncorrectable.fetch_add(uncorrectable, std::memory_order_relaxed);
+        codec->blocks_invalid.fetch_add(invalid, std::memory_order_relaxed);
+
+        if (decoded) *decoded = static_cast<std::size_t>(clean + corrected);
+        return RS_OK;
+    });
+}
+
+rs_result_t rs_stats(const rs_codec_t* codec, rs_stats_t* stats) {
+    if (!codec || !stats) return RS_INVALID_ARGUMENT;
+
+    stats->blocks_encoded       = codec->blocks_encoded.load(std::memory_order_relaxed);
+    stats->blocks_decoded       = codec->blocks_decoded.load(std::memory_order_relaxed);
+    stats->blocks_clean         = codec->blocks_clean.load(std::memory_order_relaxed);
+    stats->blocks_corrected     = codec->blocks_corrected.load(std::memory_order_relaxed);
+    stats->blocks_uncorrectable = codec->blocks_uncorrectable.load(std::memory_order_relaxed);
+    stats->blocks_invalid       = codec->blocks_invalid.load(std::memory_order_relaxed);
+    return RS_OK;
+}
+
+rs_result_t rs_stats_reset(rs_codec_t* codec) {
+    if (!codec) return RS_INVALID_ARGUMENT;
+
+    codec->blocks_encoded.store(0, std::memory_order_relaxed);
+    codec->blocks_decoded.store(0, std::memory_order_relaxed);
+    codec->blocks_clean.store(0, std::memory_order_relaxed);
+    codec->blocks_corrected.store(0, std::memory_order_relaxed);
+    codec->blocks_uncorrectable.store(0, std::memory_order_relaxed);
+    codec->blocks_invalid.store(0, std::memory_order_relaxed);
+    return RS_OK;
+}
+
+} // extern "C"